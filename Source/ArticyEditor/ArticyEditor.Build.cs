@@ -67,6 +67,7 @@ public class ArticyEditor : ModuleRules
                 "Projects",
                 "InputCore",
                 "UnrealEd",
+                "EditorSubsystem",
                 "LevelEditor",
                 "CoreUObject",
                 "Engine",
@@ -95,5 +96,13 @@ public class ArticyEditor : ModuleRules
                 // ... add any modules that your module loads dynamically here ...
             }
             );
+
+#if UE_5_0_OR_LATER
+        // Script changes are patched with Live Coding, which is only loaded through its interface
+        if (target.bWithLiveCoding)
+        {
+            PrivateIncludePathModuleNames.Add("LiveCoding");
+        }
+#endif
     }
 }
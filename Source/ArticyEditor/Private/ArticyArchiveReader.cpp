@@ -7,17 +7,71 @@
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
 #include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Compression.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+
+namespace
+{
+	/** Reads values from the archive bytes, failing once the end is reached. */
+	struct FArchiveCursor
+	{
+		TArrayView<const uint8> Bytes;
+		uint64 Position = 0;
+
+		bool Read(void* Out, uint64 Size)
+		{
+			if (Position + Size > static_cast<uint64>(Bytes.Num()))
+				return false;
+
+			FMemory::Memcpy(Out, Bytes.GetData() + Position, Size);
+			Position += Size;
+			return true;
+		}
+	};
+
+	/**
+	 * A rough estimate of the memory a JSON DOM takes per byte of its UTF-8 file: the strings are stored as UTF-16,
+	 * and every value and object is a separate shared allocation.
+	 */
+	constexpr int64 ParsedJsonBytesPerFileByte = 8;
+}
 
 /**
  * Opens an archive file for reading.
+ * The archive is mapped (or, if it cannot be mapped, loaded once) and kept until the reader is closed.
  *
  * @param InArchiveFileName The name of the archive file to open.
  * @return True if the archive was successfully opened and read; otherwise, false.
  */
 bool UArticyArchiveReader::OpenArchive(const FString& InArchiveFileName)
 {
+	CloseArchive();
 	ArchiveFileName = InArchiveFileName;
 
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	MappedArchive.Reset(PlatformFile.OpenMapped(*ArchiveFileName));
+	if (MappedArchive && MappedArchive->GetFileSize() > 0)
+	{
+		MappedRegion.Reset(MappedArchive->MapRegion(0, MappedArchive->GetFileSize()));
+	}
+
+	if (MappedRegion)
+	{
+		ArchiveBytes = TArrayView<const uint8>(MappedRegion->GetMappedPtr(), static_cast<int32>(MappedRegion->GetMappedSize()));
+	}
+	else
+	{
+		MappedArchive.Reset();
+		if (!FFileHelper::LoadFileToArray(ArchiveData, *ArchiveFileName))
+		{
+			UE_LOG(LogArticyEditor, Error, TEXT("Could not load archive %s."), *ArchiveFileName);
+			return false;
+		}
+		ArchiveBytes = ArchiveData;
+	}
+
 	if (!ReadHeader())
 	{
 		UE_LOG(LogArticyEditor, Error, TEXT("Could not load archive %s."), *ArchiveFileName);
@@ -33,6 +87,93 @@ bool UArticyArchiveReader::OpenArchive(const FString& InArchiveFileName)
 	return true;
 }
 
+/**
+ * Releases the archive file, the views returned by ReadFileBytes become invalid.
+ */
+void UArticyArchiveReader::CloseArchive()
+{
+	ArchiveBytes = TArrayView<const uint8>();
+	MappedRegion.Reset();
+	MappedArchive.Reset();
+	ArchiveData.Empty();
+	FileDictionary.Reset();
+	PrefetchedJson.Reset();
+}
+
+void UArticyArchiveReader::BeginDestroy()
+{
+	CloseArchive();
+	Super::BeginDestroy();
+}
+
+/**
+ * Returns the bytes of a file in the archive.
+ * Stored files are not copied, compressed files are decompressed into OutStorage in one go,
+ * so the JSON readers work on the unpacked UTF-8 bytes either way.
+ *
+ * @param Filename The name of the file in the archive.
+ * @param OutStorage Receives the decompressed bytes of compressed files.
+ * @param OutBytes The bytes of the file, valid until the archive is closed or OutStorage is changed.
+ * @return True if the file was successfully read; otherwise, false.
+ */
+bool UArticyArchiveReader::ReadFileBytes(const FString& Filename, TArray<uint8>& OutStorage, TArrayView<const uint8>& OutBytes) const
+{
+	OutBytes = TArrayView<const uint8>();
+
+	const FArticyArchiveFileData* FileEntry = FileDictionary.Find(Filename);
+	if (!FileEntry)
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("File %s is not in archive %s."), *Filename, *ArchiveFileName);
+		return false;
+	}
+
+	if (FileEntry->PackedLength < 0 || FileEntry->FileStartPos + FileEntry->PackedLength > static_cast<uint64>(ArchiveBytes.Num()))
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("Could not read file %s from archive %s."), *Filename, *ArchiveFileName);
+		return false;
+	}
+
+	const TArrayView<const uint8> PackedBytes = ArchiveBytes.Slice(static_cast<int32>(FileEntry->FileStartPos), static_cast<int32>(FileEntry->PackedLength));
+	if (!FileEntry->IsCompressed())
+	{
+		OutBytes = PackedBytes;
+		return true;
+	}
+
+	if (FileEntry->UnpackedLength < 0 || FileEntry->UnpackedLength > MAX_int32)
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("File %s in archive %s is too large to decompress."), *Filename, *ArchiveFileName);
+		return false;
+	}
+
+	// Compressed entries are zlib or gzip streams, told apart by their header
+	FName Format;
+	if (PackedBytes.Num() >= 2 && PackedBytes[0] == 0x1F && PackedBytes[1] == 0x8B)
+	{
+		Format = NAME_Gzip;
+	}
+	else if (PackedBytes.Num() >= 2 && (PackedBytes[0] & 0x0F) == 8 && ((PackedBytes[0] << 8) | PackedBytes[1]) % 31 == 0)
+	{
+		Format = NAME_Zlib;
+	}
+	else
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("File %s in archive %s uses an unsupported compression."), *Filename, *ArchiveFileName);
+		return false;
+	}
+
+	OutStorage.SetNumUninitialized(static_cast<int32>(FileEntry->UnpackedLength));
+	if (!FCompression::UncompressMemory(Format, OutStorage.GetData(), OutStorage.Num(), PackedBytes.GetData(), PackedBytes.Num()))
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("Could not decompress file %s from archive %s."), *Filename, *ArchiveFileName);
+		OutStorage.Empty();
+		return false;
+	}
+
+	OutBytes = OutStorage;
+	return true;
+}
+
 /**
  * Reads a file from the archive.
  *
@@ -42,128 +183,88 @@ bool UArticyArchiveReader::OpenArchive(const FString& InArchiveFileName)
  */
 bool UArticyArchiveReader::ReadFile(const FString& Filename, FString& OutResult) const
 {
-	IPlatformFile& PlatformFile = FPlatformFileManager().GetPlatformFile();
-
-	if (IFileHandle* FileHandle = PlatformFile.OpenRead(*ArchiveFileName))
+	TArray<uint8> Storage;
+	TArrayView<const uint8> FileBytes;
+	if (!ReadFileBytes(Filename, Storage, FileBytes))
 	{
-		const FArticyArchiveFileData& FileEntry = FileDictionary[Filename];
-		uint8* FileBytes = new uint8[FileEntry.PackedLength];
-
-		// Read file data
-		FileHandle->Seek(FileEntry.FileStartPos);
-		if (!FileHandle->Read(FileBytes, FileEntry.PackedLength))
-		{
-			UE_LOG(LogArticyEditor, Error, TEXT("Could not read file %s from archive %s."), *Filename, *ArchiveFileName);
-			delete FileHandle;
-			return false;
-		}
-
-		// TODO: Handle decompression
-		OutResult = ArchiveBytesToString(FileBytes, FileEntry.PackedLength);
-		delete FileHandle;
+		return false;
 	}
 
+	OutResult = ArchiveBytesToString(FileBytes.GetData(), FileBytes.Num());
 	return true;
 }
 
 /**
- * Reads the header from the archive file.
+ * Reads the header from the archive bytes.
  *
  * @return True if the header was successfully read; otherwise, false.
  */
 bool UArticyArchiveReader::ReadHeader()
 {
-	IPlatformFile& PlatformFile = FPlatformFileManager().GetPlatformFile();
-
-	if (IFileHandle* FileHandle = PlatformFile.OpenRead(*ArchiveFileName))
+	FArchiveCursor Cursor{ ArchiveBytes };
+
+	// Store fields individually due to format tweaks and struct alignment
+	uint8 HeaderMagic[4];
+	uint8 Version;
+	uint8 Pad;
+	uint16 Flags;
+	int32 NumberOfFiles;
+	uint64 FileDictionaryPos;
+
+	// Read header, stopping if something fails
+	if (!Cursor.Read(HeaderMagic, sizeof(HeaderMagic)))
 	{
-		// Store fields individually due to format tweaks and struct alignment
-		uint8 HeaderMagic[4];
-		uint8 Version;
-		uint8 Pad;
-		uint16 Flags;
-		int32 NumberOfFiles;
-		uint64 FileDictionaryPos;
-
-		// Cast to uint8*
-		uint8* FlagsBuffer = reinterpret_cast<uint8*>(&Flags);
-		uint8* NumberOfFilesBuffer = reinterpret_cast<uint8*>(&NumberOfFiles);
-		uint8* FileDictionaryPosBuffer = reinterpret_cast<uint8*>(&FileDictionaryPos);
-
-		// Read header from the file, stopping if something fails
-		if (!FileHandle->Read(HeaderMagic, sizeof(HeaderMagic)))
-		{
-			delete FileHandle;
-			return false;
-		}
-		const FString MagicString = ArchiveBytesToString(HeaderMagic, 4);
-		if (!MagicString.Equals(TEXT("ADFA")))
-		{
-			UE_LOG(LogArticyEditor, Error, TEXT("Archive file is not valid."));
-			delete FileHandle;
-			return false;
-		}
-
-		if (!FileHandle->Read(&Version, 1))
-		{
-			delete FileHandle;
-			return false;
-		}
-		if (Version != 1)
-		{
-			UE_LOG(LogArticyEditor, Error, TEXT("Archive file is incorrect version."));
-			delete FileHandle;
-			return false;
-		}
+		return false;
+	}
+	const FString MagicString = ArchiveBytesToString(HeaderMagic, 4);
+	if (!MagicString.Equals(TEXT("ADFA")))
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("Archive file is not valid."));
+		return false;
+	}
 
-		if (!FileHandle->Read(&Pad, 1))
-		{
-			delete FileHandle;
-			return false;
-		}
-		if (!FileHandle->Read(FlagsBuffer, sizeof(Flags)))
-		{
-			delete FileHandle;
-			return false;
-		}
-		if (!FileHandle->Read(NumberOfFilesBuffer, sizeof(NumberOfFiles)))
-		{
-			delete FileHandle;
-			return false;
-		}
-		if (!FileHandle->Read(FileDictionaryPosBuffer, sizeof(FileDictionaryPos)))
-		{
-			delete FileHandle;
-			return false;
-		}
+	if (!Cursor.Read(&Version, 1))
+	{
+		return false;
+	}
+	if (Version != 1)
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("Archive file is incorrect version."));
+		return false;
+	}
 
-		// Store in the output struct
-		Header.Magic = MagicString;
-		Header.Version = Version;
-		Header.Pad = Pad;
-		Header.Flags = Flags;
-		Header.NumberOfFiles = NumberOfFiles;
-		Header.FileDictionaryPos = FileDictionaryPos;
-
-		// Close the file again
-		delete FileHandle;
-		return true;
+	if (!Cursor.Read(&Pad, 1)
+		|| !Cursor.Read(&Flags, sizeof(Flags))
+		|| !Cursor.Read(&NumberOfFiles, sizeof(NumberOfFiles))
+		|| !Cursor.Read(&FileDictionaryPos, sizeof(FileDictionaryPos)))
+	{
+		return false;
 	}
 
-	return false;
+	// Store in the output struct
+	Header.Magic = MagicString;
+	Header.Version = Version;
+	Header.Pad = Pad;
+	Header.Flags = Flags;
+	Header.NumberOfFiles = NumberOfFiles;
+	Header.FileDictionaryPos = FileDictionaryPos;
+
+	return true;
 }
 
 /**
- * Reads file data from the archive, populating the file dictionary.
+ * Reads file data from the archive bytes, populating the file dictionary.
  *
  * @return True if the file data was successfully read; otherwise, false.
  */
 bool UArticyArchiveReader::ReadFileData()
 {
 	FileDictionary.Reset();
-	IPlatformFile& PlatformFile = FPlatformFileManager().GetPlatformFile();
 
-	if (IFileHandle* FileHandle = PlatformFile.OpenRead(*ArchiveFileName))
+	FArchiveCursor Cursor{ ArchiveBytes, Header.FileDictionaryPos };
+	FileDictionary.Reserve(FMath::Max(0, Header.NumberOfFiles));
+
+	for (int32 Counter = 0; Counter < Header.NumberOfFiles; Counter++)
 	{
 		uint64 FileStartPos;
 		int64 UnpackedLength;
@@ -171,73 +272,37 @@ bool UArticyArchiveReader::ReadFileData()
 		int16 Flags;
 		int16 LengthOfName;
 
-		// Cast to uint8*
-		uint8* FileStartPosBuffer = reinterpret_cast<uint8*>(&FileStartPos);
-		uint8* UnpackedLengthBuffer = reinterpret_cast<uint8*>(&UnpackedLength);
-		uint8* PackedLengthBuffer = reinterpret_cast<uint8*>(&PackedLength);
-		uint8* FlagsBuffer = reinterpret_cast<uint8*>(&Flags);
-		uint8* LengthOfNameBuffer = reinterpret_cast<uint8*>(&LengthOfName);
-
-		FileHandle->Seek(Header.FileDictionaryPos);
+		// Read entry, stopping if something fails
+		if (!Cursor.Read(&FileStartPos, sizeof(FileStartPos))
+			|| !Cursor.Read(&UnpackedLength, sizeof(UnpackedLength))
+			|| !Cursor.Read(&PackedLength, sizeof(PackedLength))
+			|| !Cursor.Read(&Flags, sizeof(Flags))
+			|| !Cursor.Read(&LengthOfName, sizeof(LengthOfName)))
+		{
+			return false;
+		}
 
-		for (int32 Counter = 0; Counter < Header.NumberOfFiles; Counter++)
+		// Get the file name, straight from the archive bytes
+		if (LengthOfName < 0 || Cursor.Position + LengthOfName > static_cast<uint64>(ArchiveBytes.Num()))
 		{
-			// Read entry from the file, stopping if something fails
-			if (!FileHandle->Read(FileStartPosBuffer, sizeof(FileStartPos)))
-			{
-				delete FileHandle;
-				return false;
-			}
-			if (!FileHandle->Read(UnpackedLengthBuffer, sizeof(UnpackedLength)))
-			{
-				delete FileHandle;
-				return false;
-			}
-			if (!FileHandle->Read(PackedLengthBuffer, sizeof(PackedLength)))
-			{
-				delete FileHandle;
-				return false;
-			}
-			if (!FileHandle->Read(FlagsBuffer, sizeof(Flags)))
-			{
-				delete FileHandle;
-				return false;
-			}
-			if (!FileHandle->Read(LengthOfNameBuffer, sizeof(LengthOfName)))
-			{
-				delete FileHandle;
-				return false;
-			}
-
-			// Get the file name
-			uint8* Filename = new uint8[LengthOfName];
-			if (!FileHandle->Read(Filename, LengthOfName))
-			{
-				delete[] Filename;
-				delete FileHandle;
-				return false;
-			}
-			const FString& FilenameString = ArchiveBytesToString(Filename, LengthOfName);
-			delete[] Filename;
-
-			// Store in the output struct
-			FArticyArchiveFileData FileEntry;
-			FileEntry.FileStartPos = FileStartPos;
-			FileEntry.UnpackedLength = UnpackedLength;
-			FileEntry.PackedLength = PackedLength;
-			FileEntry.Flags = Flags;
-			FileEntry.Filename = FilenameString;
-
-			// Add to output map
-			FileDictionary.Add(FilenameString, FileEntry);
+			return false;
 		}
+		const FString FilenameString = ArchiveBytesToString(ArchiveBytes.GetData() + Cursor.Position, LengthOfName);
+		Cursor.Position += LengthOfName;
 
-		// Close the file again
-		delete FileHandle;
-		return true;
+		// Store in the output struct
+		FArticyArchiveFileData FileEntry;
+		FileEntry.FileStartPos = FileStartPos;
+		FileEntry.UnpackedLength = UnpackedLength;
+		FileEntry.PackedLength = PackedLength;
+		FileEntry.Flags = Flags;
+		FileEntry.Filename = FilenameString;
+
+		// Add to output map
+		FileDictionary.Add(FilenameString, FileEntry);
 	}
 
-	return false;
+	return true;
 }
 
 /**
@@ -291,20 +356,173 @@ bool UArticyArchiveReader::FetchJson(
 
 	const FString& FileName = FileInfo->GetStringField(TEXT("FileName"));
 
+	// Use the prefetched object, if any
+	TSharedPtr<FJsonObject> Prefetched;
+	if (PrefetchedJson.RemoveAndCopyValue(FileName, Prefetched))
+	{
+		OutJsonObject = Prefetched;
+		return Prefetched.IsValid();
+	}
+
+	OutJsonObject = ParseJson(FileName);
+	return OutJsonObject.IsValid();
+}
+
+/**
+ * Checks whether a file of the archive changed, comparing the hash in the manifest only.
+ * Used by the dry run of the import, which must not change the hashes of the import data.
+ *
+ * @param JsonRoot The root JSON object to search within.
+ * @param FieldName The field name containing the file info.
+ * @param Hash The hash of the already imported file.
+ * @return True if the file info was found and its hash differs; otherwise, false.
+ */
+bool UArticyArchiveReader::HasFileChanged(
+	const TSharedPtr<FJsonObject>& JsonRoot,
+	const FString& FieldName,
+	const FString& Hash) const
+{
+	const TSharedPtr<FJsonObject>* FileInfo = nullptr;
+	if (!JsonRoot.IsValid() || !JsonRoot->TryGetObjectField(FieldName, FileInfo))
+	{
+		return false;
+	}
+
+	FString NewHash;
+	return (*FileInfo)->TryGetStringField(TEXT("Hash"), NewHash) && !Hash.Equals(NewHash);
+}
+
+/**
+ * Fetches the bytes of a JSON file from the archive without parsing it, verifying the hash for changes.
+ *
+ * @param JsonRoot The root JSON object to search within.
+ * @param FieldName The field name containing the file info.
+ * @param Hash The hash value to check against.
+ * @param OutStorage Receives the decompressed bytes, if the file is compressed.
+ * @param OutBytes The UTF-8 bytes of the file, if found and changed; see ReadFileBytes.
+ * @return True if the file was found and changed; otherwise, false.
+ */
+bool UArticyArchiveReader::FetchBytes(
+	const TSharedPtr<FJsonObject>& JsonRoot,
+	const FString& FieldName,
+	FString& Hash,
+	TArray<uint8>& OutStorage,
+	TArrayView<const uint8>& OutBytes) const
+{
+	if (!JsonRoot.IsValid())
+	{
+		return false;
+	}
+
+	const TSharedPtr<FJsonObject> FileInfo = JsonRoot->GetObjectField(FieldName);
+	const FString& NewHash = FileInfo->GetStringField(TEXT("Hash"));
+	if (Hash.Equals(NewHash))
+	{
+		return false;
+	}
+	Hash = NewHash;
+
+	const FString& FileName = FileInfo->GetStringField(TEXT("FileName"));
+	if (!ReadFileBytes(FileName, OutStorage, OutBytes))
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("Failed to load file '%s' to string"), *FileName);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Reads and parses JSON files of the archive on worker threads.
+ * The archive bytes are only read, so the files can be decompressed, converted and parsed in parallel.
+ *
+ * @param Files The files to fetch.
+ * @param NumWorkers The maximum number of files parsed at the same time, 0 to use all worker threads.
+ * @param MemoryBudget The estimated memory (in bytes) the prefetched objects may take, 0 for no limit.
+ */
+void UArticyArchiveReader::PrefetchJson(const TArray<FArticyArchivePrefetch>& Files, int32 NumWorkers, int64 MemoryBudget) const
+{
+	// Resolve the file names on this thread, skipping unchanged and already prefetched files
+	TArray<FString> FileNames;
+	for (const FArticyArchivePrefetch& File : Files)
+	{
+		if (!File.JsonRoot.IsValid())
+			continue;
+
+		const TSharedPtr<FJsonObject> FileInfo = File.JsonRoot->GetObjectField(File.FieldName);
+		if (!FileInfo.IsValid() || File.Hash.Equals(FileInfo->GetStringField(TEXT("Hash"))))
+			continue;
+
+		const FString FileName = FileInfo->GetStringField(TEXT("FileName"));
+		if (!PrefetchedJson.Contains(FileName))
+			FileNames.AddUnique(FileName);
+	}
+
+	// The prefetched objects are held until they are fetched, so only the files fitting into the budget are prefetched.
+	// The others are parsed by FetchJson one at a time, and freed once the import integrated them.
+	if (MemoryBudget > 0)
+	{
+		const int32 NumFiles = FileNames.Num();
+		int64 Estimate = 0;
+		FileNames.RemoveAll([&](const FString& FileName)
+		{
+			const FArticyArchiveFileData* FileEntry = FileDictionary.Find(FileName);
+			const int64 FileEstimate = FileEntry ? FileEntry->UnpackedLength * ParsedJsonBytesPerFileByte : 0;
+			if (Estimate + FileEstimate > MemoryBudget)
+				return true;
+
+			Estimate += FileEstimate;
+			return false;
+		});
+
+		if (FileNames.Num() < NumFiles)
+		{
+			UE_LOG(LogArticyEditor, Log, TEXT("Prefetching %d of %d files within the import memory budget of %lld MB, the others are parsed one at a time."),
+				FileNames.Num(), NumFiles, MemoryBudget >> 20);
+		}
+	}
+
+	if (FileNames.Num() == 0)
+		return;
+
+	if (NumWorkers <= 0)
+		NumWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	NumWorkers = FMath::Clamp(NumWorkers, 1, FileNames.Num());
+
+	// Each worker takes every NumWorkers-th file, the files are of very different sizes so this spreads them out
+	TArray<TSharedPtr<FJsonObject>> Parsed;
+	Parsed.SetNum(FileNames.Num());
+	ParallelFor(NumWorkers, [&](int32 Worker)
+	{
+		for (int32 Index = Worker; Index < FileNames.Num(); Index += NumWorkers)
+			Parsed[Index] = ParseJson(FileNames[Index]);
+	}, NumWorkers == 1);
+
+	for (int32 Index = 0; Index < FileNames.Num(); ++Index)
+		PrefetchedJson.Add(FileNames[Index], Parsed[Index]);
+}
+
+/**
+ * Parses a JSON file of the archive.
+ *
+ * @param FileName The name of the file in the archive.
+ * @return The parsed JSON object, or null if the file could not be read or parsed.
+ */
+TSharedPtr<FJsonObject> UArticyArchiveReader::ParseJson(const FString& FileName) const
+{
 	FString Result;
 	if (!ReadFile(FileName, Result))
 	{
 		UE_LOG(LogArticyEditor, Error, TEXT("Failed to load file '%s' to string"), *FileName);
-		return false;
+		return nullptr;
 	}
 
 	TSharedPtr<FJsonObject> JsonParsed;
 	const TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(Result);
 	if (FJsonSerializer::Deserialize(JsonReader, JsonParsed))
 	{
-		OutJsonObject = JsonParsed;
-		return true;
+		return JsonParsed;
 	}
 
-	return false;
+	return nullptr;
 }
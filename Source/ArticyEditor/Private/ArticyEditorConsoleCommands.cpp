@@ -0,0 +1,82 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyEditorConsoleCommands.h"
+#include "ArticyRuntimeModule.h"
+#include "PackagesImport.h"
+#include "UObject/UObjectIterator.h"
+
+DECLARE_MEMORY_STAT(TEXT("Import data"), STAT_ArticyImportDataMemory, STATGROUP_Articy);
+
+namespace
+{
+	/** Measures a reflected property of a struct or object, by name. Returns 0 if there is no such property. */
+	SIZE_T GetPropertyAllocatedSize(const UStruct* Struct, const void* Container, const TCHAR* PropertyName)
+	{
+		const FProperty* Property = FindFProperty<FProperty>(Struct, PropertyName);
+		return Property ? FArticyMemoryReport::GetAllocatedSize(Property, Property->ContainerPtrToValuePtr<void>(Container)) : 0;
+	}
+}
+
+/**
+ * Adds the memory of the loaded import data to a memory report.
+ * @param Report The report to add the categories to.
+ */
+void FArticyEditorConsoleCommands::CollectImportDataMemory(FArticyMemoryReport& Report)
+{
+	const UStruct* PackageDefStruct = FArticyPackageDef::StaticStruct();
+	const FArrayProperty* PackagesProperty = FindFProperty<FArrayProperty>(FArticyPackageDefs::StaticStruct(), TEXT("Packages"));
+	const FArrayProperty* ModelsProperty = FindFProperty<FArrayProperty>(PackageDefStruct, TEXT("Models"));
+	const FMapProperty* TextsProperty = FindFProperty<FMapProperty>(PackageDefStruct, TEXT("Texts"));
+	if (!ensure(PackagesProperty && ModelsProperty && TextsProperty))
+		return;
+
+	SIZE_T ImportDataBytes = 0;
+	for (TObjectIterator<UArticyImportData> It; It; ++It)
+	{
+		const UArticyImportData* ImportData = *It;
+		if (ImportData->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+			continue;
+
+		const UClass* Class = ImportData->GetClass();
+		const SIZE_T TotalBytes = Class->GetStructureSize() + FArticyMemoryReport::GetAllocatedSize(Class, ImportData);
+
+		// the models and texts of the packages, walked like GetAllocatedSize does to count them on the way
+		SIZE_T ModelBytes = 0, TextBytes = 0;
+		int32 NumModels = 0, NumTexts = 0;
+		const FArticyPackageDefs& PackageDefs = ImportData->GetPackageDefs();
+		FScriptArrayHelper Packages(PackagesProperty, PackagesProperty->ContainerPtrToValuePtr<void>(&PackageDefs));
+		for (int32 Index = 0; Index < Packages.Num(); ++Index)
+		{
+			const void* PackageDef = Packages.GetRawPtr(Index);
+
+			const void* Models = ModelsProperty->ContainerPtrToValuePtr<void>(PackageDef);
+			ModelBytes += FArticyMemoryReport::GetAllocatedSize(ModelsProperty, Models);
+			NumModels += FScriptArrayHelper(ModelsProperty, Models).Num();
+
+			const void* Texts = TextsProperty->ContainerPtrToValuePtr<void>(PackageDef);
+			TextBytes += FArticyMemoryReport::GetAllocatedSize(TextsProperty, Texts);
+			NumTexts += FScriptMapHelper(TextsProperty, Texts).Num();
+		}
+
+		const SIZE_T ScriptFragmentBytes = GetPropertyAllocatedSize(Class, ImportData, TEXT("ScriptFragments"));
+		const SIZE_T ParentChildrenBytes = GetPropertyAllocatedSize(Class, ImportData, TEXT("ParentChildrenCache"));
+		const SIZE_T ObjectDefinitionBytes = GetPropertyAllocatedSize(Class, ImportData, TEXT("ObjectDefinitions"));
+		const SIZE_T CachedVersionBytes = GetPropertyAllocatedSize(Class, ImportData, TEXT("CachedData"));
+
+		const SIZE_T ListedBytes = ModelBytes + TextBytes + ScriptFragmentBytes + ParentChildrenBytes + ObjectDefinitionBytes + CachedVersionBytes;
+
+		Report.Add(TEXT("Import data: models"), NumModels, ModelBytes);
+		Report.Add(TEXT("Import data: texts"), NumTexts, TextBytes);
+		Report.Add(TEXT("Import data: script fragments"), ImportData->GetScriptFragments().Num(), ScriptFragmentBytes);
+		Report.Add(TEXT("Import data: ParentChildrenCache"), ImportData->GetParentChildrenCache().Num(), ParentChildrenBytes);
+		Report.Add(TEXT("Import data: object definitions"), 1, ObjectDefinitionBytes);
+		Report.Add(TEXT("Import data: cached version of the last import"), ImportData->HasCachedVersion() ? 1 : 0, CachedVersionBytes);
+		Report.Add(TEXT("Import data: other"), 1, TotalBytes > ListedBytes ? TotalBytes - ListedBytes : 0);
+
+		ImportDataBytes += TotalBytes;
+	}
+
+	SET_MEMORY_STAT(STAT_ArticyImportDataMemory, ImportDataBytes);
+}
@@ -6,11 +6,92 @@
 #include "ArticyPluginSettings.h"
 #include "ArticyEditorModule.h"
 #include "ArticyJSONFactory.h"
+#include "ArticyImportProfiler.h"
 #include "CodeGeneration/CodeGenerator.h"
 #include "ObjectTools.h"
 #include "FileHelpers.h"
 #include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "ISourceControlModule.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/PackageName.h"
 #include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "SourceControlHelpers.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "EditorFramework/AssetImportData.h"
+#include "UObject/SavePackage.h"
+
+namespace
+{
+	/** The options of the batch import which is running, see FArticyEditorFunctionLibrary::BatchImport. */
+	const FArticyBatchImportOptions* BatchImportOptions = nullptr;
+
+	/** Collects the errors, and the warnings of the importer, for the result of a batch import. */
+	class FBatchImportLog : public FOutputDevice
+	{
+	public:
+
+		explicit FBatchImportLog(FArticyBatchImportResult& InResult) : Result(InResult)
+		{
+			GLog->AddOutputDevice(this);
+		}
+
+		virtual ~FBatchImportLog()
+		{
+			GLog->RemoveOutputDevice(this);
+		}
+
+		// The importer logs from its worker threads too
+		virtual bool CanBeUsedOnAnyThread() const override { return true; }
+
+		virtual void Serialize(const TCHAR* Message, ELogVerbosity::Type Verbosity, const FName& Category) override
+		{
+			const ELogVerbosity::Type Level = static_cast<ELogVerbosity::Type>(Verbosity & ELogVerbosity::VerbosityMask);
+			const bool bIsError = Level == ELogVerbosity::Fatal || Level == ELogVerbosity::Error;
+			const bool bIsWarning = Level == ELogVerbosity::Warning && Category == LogArticyEditor.GetCategoryName();
+			if (!bIsError && !bIsWarning)
+				return;
+
+			FScopeLock Lock(&MessagesLock);
+			(bIsError ? Result.Errors : Result.Warnings).Add(FString::Printf(TEXT("%s: %s"), *Category.ToString(), Message));
+		}
+
+	private:
+
+		FArticyBatchImportResult& Result;
+		FCriticalSection MessagesLock;
+	};
+}
+
+/**
+ * Returns the result for logs and build reports.
+ *
+ * @return The result as JSON object.
+ */
+TSharedRef<FJsonObject> FArticyBatchImportResult::ToJson() const
+{
+	const auto ToJsonArray = [](const TArray<FString>& Messages)
+	{
+		TArray<TSharedPtr<FJsonValue>> Values;
+		for (const FString& Message : Messages)
+			Values.Add(MakeShared<FJsonValueString>(Message));
+		return Values;
+	};
+
+	const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetBoolField(TEXT("Succeeded"), bSucceeded);
+	Json->SetBoolField(TEXT("NeedsCompile"), bNeedsCompile);
+	Json->SetBoolField(TEXT("CreatedImportData"), bCreatedImportData);
+	Json->SetStringField(TEXT("SourceFile"), SourceFile);
+	Json->SetNumberField(TEXT("Seconds"), Seconds);
+	Json->SetArrayField(TEXT("Errors"), ToJsonArray(Errors));
+	Json->SetArrayField(TEXT("Warnings"), ToJsonArray(Warnings));
+	if (Stages.IsValid())
+		Json->SetObjectField(TEXT("Stages"), Stages);
+	return Json;
+}
 
 /**
  * Forces a complete reimport of the Articy data.
@@ -88,11 +169,148 @@ int32 FArticyEditorFunctionLibrary::RegenerateAssets(UArticyImportData* ImportDa
 		return -1;
 	}
 
-	CodeGenerator::GenerateAssets(ImportData);
+	CodeGenerator::GenerateAssets(ImportData, true);
 
 	return -1;
 }
 
+/**
+ * Imports the Articy data without any UI.
+ * While it runs, dialogs of the import are answered with the options, the generated code is not compiled, and
+ * GIsRunningUnattendedScript is set, so the engine does not show any dialogs either.
+ *
+ * @param Options What to import, and the answers to the questions the import would otherwise ask.
+ * @return The outcome of the import, with its errors and the timings of its stages.
+ */
+FArticyBatchImportResult FArticyEditorFunctionLibrary::BatchImport(const FArticyBatchImportOptions& Options)
+{
+	check(IsInGameThread());
+
+	FArticyBatchImportResult Result;
+	if (BatchImportOptions)
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("A batch import is already running."));
+		return Result;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	EImportDataEnsureResult EnsureResult;
+	{
+		TGuardValue<const FArticyBatchImportOptions*> GuardOptions(BatchImportOptions, &Options);
+		TGuardValue<bool> GuardUnattended(GIsRunningUnattendedScript, true);
+		FBatchImportLog Log(Result);
+
+		const TSharedPtr<FJsonObject> PreviousStages = FArticyImportProfiler::GetLastSummary();
+
+		UArticyImportData* ImportData = nullptr;
+		EnsureResult = EnsureImportDataAsset(&ImportData);
+		Result.bCreatedImportData = EnsureResult == Generation;
+
+		// A created import data asset has been imported completely already
+		if (EnsureResult == AssetRegistry)
+		{
+			if (Options.bRegenerateAssetsOnly)
+			{
+				// Imports are profiled from reading the file on, regenerating the assets is profiled here
+				FArticyImportProfiler::BeginImport(TEXT("ArticyRegenerate"));
+				RegenerateAssets(ImportData);
+				FArticyImportProfiler::EndImport(true);
+			}
+			else if (Options.bFullReimport)
+			{
+				ForceCompleteReimport(ImportData);
+			}
+			else
+			{
+				ReimportChanges(ImportData);
+			}
+		}
+
+		// The import waits for the compilation, which a batch import does not start, see CodeGenerator::Compile
+		if (FArticyImportProfiler::IsImportActive())
+		{
+			Result.bNeedsCompile = true;
+			FArticyImportProfiler::EndImport(false);
+		}
+
+		if (ImportData && ImportData->ImportData)
+		{
+			Result.SourceFile = ImportData->ImportData->GetFirstFilename();
+		}
+
+		const TSharedPtr<FJsonObject> Stages = FArticyImportProfiler::GetLastSummary();
+		if (Stages != PreviousStages)
+		{
+			Result.Stages = Stages;
+		}
+	}
+	Result.Seconds = FPlatformTime::Seconds() - StartTime;
+
+	bool bStagesSucceeded = false;
+	const bool bImportFinished = Result.Stages.IsValid() && Result.Stages->TryGetBoolField(TEXT("Succeeded"), bStagesSucceeded) && bStagesSucceeded;
+	Result.bSucceeded = EnsureResult != Failure && !Result.bNeedsCompile && bImportFinished && Result.Errors.Num() == 0;
+
+	UE_LOG(LogArticyEditor, Display, TEXT("Batch import of '%s' %s in %.2f s with %d errors and %d warnings."), *Result.SourceFile,
+		Result.bSucceeded ? TEXT("succeeded") : Result.bNeedsCompile ? TEXT("needs the project to be built") : TEXT("failed"),
+		Result.Seconds, Result.Errors.Num(), Result.Warnings.Num());
+
+	return Result;
+}
+
+/**
+ * Reports what a reimport would regenerate, see UArticyImportData::DryRunImportFromJson.
+ * Unlike the imports, a missing import data asset is not created, as the dry run must not change any assets.
+ *
+ * @param OutReport Receives what the import would regenerate.
+ * @param ImportData The Articy import data object to compare with, the import data asset if null.
+ * @return False if there is no import data or its export could not be read.
+ */
+bool FArticyEditorFunctionLibrary::DryRunImport(FArticyImportDryRunReport& OutReport, UArticyImportData* ImportData)
+{
+	if (!ImportData)
+	{
+		ImportData = UArticyImportData::GetImportData().Get();
+	}
+	if (!ImportData || !ImportData->ImportData)
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("No import data asset found to compare the export with, the first import imports everything."));
+		return false;
+	}
+
+	const FString FileName = ImportData->ImportData->GetFirstFilename();
+	UArticyArchiveReader* Archive = NewObject<UArticyArchiveReader>();
+	if (FileName.IsEmpty() || !Archive->OpenArchive(FileName))
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("Failed to open the export '%s' of the import data."), *FileName);
+		return false;
+	}
+
+	FString Json;
+	TSharedPtr<FJsonObject> Manifest;
+	if (!Archive->ReadFile(TEXT("manifest.json"), Json) || !FJsonSerializer::Deserialize(TJsonReaderFactory<TCHAR>::Create(Json), Manifest) || !Manifest.IsValid())
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("Failed to read the manifest of the export '%s'."), *FileName);
+		Archive->CloseArchive();
+		return false;
+	}
+
+	OutReport = ImportData->DryRunImportFromJson(*Archive, Manifest);
+	Archive->CloseArchive();
+
+	OutReport.Log();
+	return true;
+}
+
+/**
+ * Returns the options of the batch import which is running.
+ *
+ * @return The options, or null outside of BatchImport.
+ */
+const FArticyBatchImportOptions* FArticyEditorFunctionLibrary::GetBatchImportOptions()
+{
+	return BatchImportOptions;
+}
+
 /**
  * Ensures that the Articy import data asset is valid and available.
  * Generates a new import data asset if necessary.
@@ -189,8 +407,31 @@ UArticyImportData* FArticyEditorFunctionLibrary::GenerateImportDataAsset()
 		ImportData = Cast<UArticyImportData>(ImportDataAsset);
 
 		// automatically save the import data asset
-		TArray<UPackage*> FailedToSavePackages;
-		FEditorFileUtils::PromptForCheckoutAndSave({ Outer }, false, false, &FailedToSavePackages);
+		if (BatchImportOptions)
+		{
+			// Saved without prompting, the asset is new so there is nothing to check out
+			const FString PackageFilename = FPackageName::LongPackageNameToFilename(Outer->GetName(), FPackageName::GetAssetPackageExtension());
+#if ENGINE_MAJOR_VERSION >= 5
+			FSavePackageArgs SaveArgs;
+			SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+			const bool bSaved = UPackage::SavePackage(Outer, ImportDataAsset, *PackageFilename, SaveArgs);
+#else
+			const bool bSaved = UPackage::SavePackage(Outer, ImportDataAsset, RF_Public | RF_Standalone, *PackageFilename);
+#endif
+			if (!bSaved)
+			{
+				UE_LOG(LogArticyEditor, Error, TEXT("Failed to save the import data asset %s."), *Outer->GetName());
+			}
+			else if (ISourceControlModule::Get().IsEnabled())
+			{
+				USourceControlHelpers::MarkFileForAdd(PackageFilename);
+			}
+		}
+		else
+		{
+			TArray<UPackage*> FailedToSavePackages;
+			FEditorFileUtils::PromptForCheckoutAndSave({ Outer }, false, false, &FailedToSavePackages);
+		}
 
 		UE_LOG(LogArticyEditor, Warning, TEXT("Successfully created import data asset. Continuing process."));
 	}
@@ -8,6 +8,8 @@
 #include "ArticyEditorFunctionLibrary.h"
 #include "ArticyEditorStyle.h"
 #include "ArticyFlowClasses.h"
+#include "ArticyPackage.h"
+#include "Engine/AssetManager.h"
 #include "CodeGeneration/CodeGenerator.h"
 #include "Customizations/ArticyIdPropertyWidgetCustomizations/DefaultArticyIdPropertyWidgetCustomizations.h"
 #include "Developer/Settings/Public/ISettingsModule.h"
@@ -21,16 +23,21 @@
 #include "Editor.h"
 #include "DirectoryWatcherModule.h"
 #include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+#include "ArticyImporterHelpers.h"
 #include "Widgets/Images/SImage.h"
 #include "IDirectoryWatcher.h"
 #include "Customizations/ArticyPinFactory.h"
 #include "Customizations/AssetActions/AssetTypeActions_ArticyGv.h"
 #include "Customizations/AssetActions/AssetTypeActions_ArticyAlterativeGV.h"
 #include "Customizations/Details/ArticyGVCustomization.h"
+#include "Customizations/Details/ArticyObjectCustomization.h"
 #include "Customizations/Details/ArticyPluginSettingsCustomization.h"
 #include "Customizations/Details/ArticyIdCustomization.h"
 #include "Customizations/Details/ArticyRefCustomization.h"
 #include "Slate/GV/SArticyGlobalVariablesDebugger.h"
+#include "Slate/GV/SArticyGvProfiler.h"
 
 #if ENGINE_MAJOR_VERSION >= 5
 // In UE5, you use the ToolMenus API to extend the UI
@@ -46,6 +53,22 @@ DEFINE_LOG_CATEGORY(LogArticyEditor)
 #define LOCTEXT_NAMESPACE "FArticyImporterModule"
 static const FName ArticyWindowTabID("ArticyWindowTab");
 static const FName ArticyGVDebuggerTabID("ArticyGVDebuggerTab");
+static const FName ArticyGVProfilerTabID("ArticyGVProfilerTab");
+
+/**
+ * Opens a tab of the plugin, or brings it to the front if it is open already.
+ * Engines before 4.26 have no TryInvokeTab.
+ *
+ * @param TabID The ID of the tab.
+ */
+static void InvokeArticyTab(const FName& TabID)
+{
+#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION < 26
+	FGlobalTabmanager::Get()->InvokeTab(TabID);
+#else
+	FGlobalTabmanager::Get()->TryInvokeTab(TabID);
+#endif
+}
 
 /**
  * Initialize the Articy editor module by registering customizations, commands, and toolbars.
@@ -64,8 +87,12 @@ void FArticyEditorModule::StartupModule()
 	RegisterArticyToolbar();
 	// directory watcher has to be changed or removed as the results aren't quite deterministic
 	//RegisterDirectoryWatcher();
+	RegisterExportWatcher();
 	RegisterToolTabs();
 
+	// the asset manager only accepts rules once it has scanned for primary assets
+	UAssetManager::CallOrRegister_OnCompletedInitialScan(FSimpleMulticastDelegate::FDelegate::CreateStatic(&FArticyEditorModule::ApplyPackageChunkRules));
+
 	FArticyEditorStyle::Initialize();
 }
 
@@ -74,6 +101,8 @@ void FArticyEditorModule::StartupModule()
  */
 void FArticyEditorModule::ShutdownModule()
 {
+	UnregisterExportWatcher();
+
 	if (UObjectInitialized())
 	{
 		GetCustomizationManager()->Shutdown();
@@ -96,6 +125,99 @@ void FArticyEditorModule::RegisterDirectoryWatcher()
 	DirectoryWatcherModule.Get()->RegisterDirectoryChangedCallback_Handle(CodeGenerator::GetSourceFolder(), IDirectoryWatcher::FDirectoryChanged::CreateRaw(this, &FArticyEditorModule::OnGeneratedCodeChanged), GeneratedCodeWatcherHandle);
 }
 
+/**
+ * Register a directory watcher on the articy directory, which imports the changes of the export once it settled.
+ * Commandlets import explicitly, so they don't watch the export.
+ */
+void FArticyEditorModule::RegisterExportWatcher()
+{
+	if (IsRunningCommandlet())
+	{
+		return;
+	}
+
+	// the directory is moved to the location of the import data asset on import, so watch the new one then
+	if (!ExportDirectoryHandle.IsValid())
+	{
+		ExportDirectoryHandle = OnImportFinished.AddRaw(this, &FArticyEditorModule::OnExportDirectoryMaybeChanged);
+	}
+
+	FString ArticyDirectoryNonVirtual = GetDefault<UArticyPluginSettings>()->ArticyDirectory.Path;
+	ArticyDirectoryNonVirtual.RemoveFromStart(TEXT("/Game"));
+	ArticyDirectoryNonVirtual.RemoveFromStart(TEXT("/"));
+	const FString ExportDirectory = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*(FPaths::ProjectContentDir() + ArticyDirectoryNonVirtual));
+
+	if (ExportDirectory == WatchedExportDirectory || !IFileManager::Get().DirectoryExists(*ExportDirectory))
+	{
+		return;
+	}
+
+	UnregisterExportWatcher();
+
+	FDirectoryWatcherModule& DirectoryWatcherModule = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>("DirectoryWatcher");
+	if (DirectoryWatcherModule.Get()->RegisterDirectoryChangedCallback_Handle(ExportDirectory, IDirectoryWatcher::FDirectoryChanged::CreateRaw(this, &FArticyEditorModule::OnExportChanged), ExportWatcherHandle))
+	{
+		WatchedExportDirectory = ExportDirectory;
+	}
+}
+
+/**
+ * Unregister the directory watcher of the export, dropping a change which was not imported yet.
+ */
+void FArticyEditorModule::UnregisterExportWatcher()
+{
+	if (ExportChangeTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(ExportChangeTickerHandle);
+		ExportChangeTickerHandle.Reset();
+	}
+
+	if (WatchedExportDirectory.IsEmpty())
+	{
+		return;
+	}
+
+	if (FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>("DirectoryWatcher"))
+	{
+		DirectoryWatcherModule->Get()->UnregisterDirectoryChangedCallback_Handle(WatchedExportDirectory, ExportWatcherHandle);
+	}
+	ExportWatcherHandle.Reset();
+	WatchedExportDirectory.Reset();
+}
+
+/**
+ * Registers the articy packages as primary assets and assigns them to the chunks configured in the plugin settings.
+ * Packages are primary assets of type ArticyPackage (see UArticyPackage::GetPrimaryAssetId), their objects
+ * live in the same UPackage and therefore end up in the same chunk.
+ */
+void FArticyEditorModule::ApplyPackageChunkRules()
+{
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 3
+	UAssetManager* AssetManager = UAssetManager::GetIfInitialized();
+#else
+	UAssetManager* AssetManager = UAssetManager::GetIfValid();
+#endif
+	if (!AssetManager)
+		return;
+
+	const FPrimaryAssetType PackageType(TEXT("ArticyPackage"));
+	AssetManager->ScanPathForPrimaryAssets(PackageType, ArticyHelpers::GetArticyGeneratedFolder() / TEXT("Packages"), UArticyPackage::StaticClass(), false);
+
+	for (const TPair<FString, int32>& Chunk : UArticyPluginSettings::Get()->PackageChunkIds)
+	{
+		if (Chunk.Value < 0)
+			continue;
+
+		FPrimaryAssetRules Rules;
+		Rules.ChunkId = Chunk.Value;
+		Rules.CookRule = EPrimaryAssetCookRule::AlwaysCook;
+
+		// the package asset is named after its folder, see FArticyPackageDef::GetFolder
+		const FName AssetName(*Chunk.Key.Replace(TEXT(" "), TEXT("_")));
+		AssetManager->SetPrimaryAssetRules(FPrimaryAssetId(PackageType, AssetName), Rules);
+	}
+}
+
 /**
  * Register a custom graph pin factory for Articy references.
  */
@@ -139,6 +261,7 @@ void FArticyEditorModule::RegisterDetailCustomizations() const
 	PropertyModule.RegisterCustomPropertyTypeLayout("ArticyRef", FOnGetPropertyTypeCustomizationInstance::CreateStatic(&FArticyRefCustomization::MakeInstance));
 	PropertyModule.RegisterCustomClassLayout("ArticyPluginSettings", FOnGetDetailCustomizationInstance::CreateStatic(&FArticyPluginSettingsCustomization::MakeInstance));
 	PropertyModule.RegisterCustomClassLayout("ArticyGlobalVariables", FOnGetDetailCustomizationInstance::CreateStatic(&FArticyGVCustomization::MakeInstance));
+	PropertyModule.RegisterCustomClassLayout("ArticyObject", FOnGetDetailCustomizationInstance::CreateStatic(&FArticyObjectCustomization::MakeInstance));
 
 	PropertyModule.NotifyCustomizationModuleChanged();
 }
@@ -184,6 +307,7 @@ void FArticyEditorModule::RegisterArticyToolbar()
 		// Add buttons
 		Section.AddMenuEntryWithCommandList(FArticyEditorCommands::Get().OpenArticyImporter, PluginCommands);
 		Section.AddMenuEntryWithCommandList(FArticyEditorCommands::Get().OpenArticyGvDebugger, PluginCommands);
+		Section.AddMenuEntryWithCommandList(FArticyEditorCommands::Get().OpenArticyGvProfiler, PluginCommands);
 	}
 #else 
 	FLevelEditorModule& LevelEditorModule = FModuleManager::LoadModuleChecked<FLevelEditorModule>("LevelEditor");
@@ -210,6 +334,7 @@ TSharedRef<SWidget> FArticyEditorModule::OnGenerateArticyToolsMenu() const
 	MenuBuilder.BeginSection("ArticyTools", LOCTEXT("ArticyTools", "Articy Tools"));
 	MenuBuilder.AddMenuEntry(FArticyEditorCommands::Get().OpenArticyImporter);
 	MenuBuilder.AddMenuEntry(FArticyEditorCommands::Get().OpenArticyGVDebugger);
+	MenuBuilder.AddMenuEntry(FArticyEditorCommands::Get().OpenArticyGvProfiler);
 	MenuBuilder.EndSection();
 
 	return MenuBuilder.MakeWidget();
@@ -242,6 +367,10 @@ void FArticyEditorModule::RegisterPluginCommands()
 	PluginCommands->MapAction(FArticyEditorCommands::Get().OpenArticyGvDebugger,
 		FExecuteAction::CreateRaw(this, &FArticyEditorModule::OpenArticyGVDebugger),
 		FCanExecuteAction());
+
+	PluginCommands->MapAction(FArticyEditorCommands::Get().OpenArticyGvProfiler,
+		FExecuteAction::CreateRaw(this, &FArticyEditorModule::OpenArticyGVProfiler),
+		FCanExecuteAction());
 }
 
 /**
@@ -258,6 +387,11 @@ void FArticyEditorModule::RegisterToolTabs()
 		.SetDisplayName(LOCTEXT("ArticyGVDebuggerTitle", "Articy GV Debugger"))
 		.SetIcon(FSlateIcon(FArticyEditorStyle::GetStyleSetName(), "ArticyImporter.ArticyImporter.16", "ArticyImporter.ArticyImporter.8"))
 		.SetMenuType(ETabSpawnerMenuType::Hidden);
+
+	FGlobalTabmanager::Get()->RegisterNomadTabSpawner(ArticyGVProfilerTabID, FOnSpawnTab::CreateRaw(this, &FArticyEditorModule::OnSpawnArticyGVProfilerTab))
+		.SetDisplayName(LOCTEXT("ArticyGVProfilerTitle", "Articy GV Profiler"))
+		.SetIcon(FSlateIcon(FArticyEditorStyle::GetStyleSetName(), "ArticyImporter.ArticyImporter.16", "ArticyImporter.ArticyImporter.8"))
+		.SetMenuType(ETabSpawnerMenuType::Hidden);
 }
 
 /**
@@ -317,12 +451,7 @@ void FArticyEditorModule::QueueImport()
  */
 void FArticyEditorModule::OpenArticyWindow()
 {
-	// @TODO Engine versioning
-#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION < 26
-	FGlobalTabmanager::Get()->InvokeTab(ArticyWindowTabID);
-#else
-	FGlobalTabmanager::Get()->TryInvokeTab(ArticyWindowTabID);
-#endif
+	InvokeArticyTab(ArticyWindowTabID);
 }
 
 /**
@@ -330,12 +459,15 @@ void FArticyEditorModule::OpenArticyWindow()
  */
 void FArticyEditorModule::OpenArticyGVDebugger()
 {
-	// @TODO Engine versioning
-#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION < 26
-	FGlobalTabmanager::Get()->InvokeTab(ArticyGVDebuggerTabID);
-#else
-	FGlobalTabmanager::Get()->TryInvokeTab(ArticyGVDebuggerTabID);
-#endif
+	InvokeArticyTab(ArticyGVDebuggerTabID);
+}
+
+/**
+ * Open the Articy global variables profiler tab.
+ */
+void FArticyEditorModule::OpenArticyGVProfiler()
+{
+	InvokeArticyTab(ArticyGVProfilerTabID);
 }
 
 /**
@@ -394,6 +526,10 @@ EImportStatusValidity FArticyEditorModule::CheckImportStatusValidity() const
  */
 void FArticyEditorModule::OnGeneratedCodeChanged(const TArray<FFileChangeData>& FileChanges) const
 {
+	// The code changes while it is generated, a batch import must not prompt for a reimport
+	if (FArticyEditorFunctionLibrary::GetBatchImportOptions())
+		return;
+
 	const EImportStatusValidity Validity = CheckImportStatusValidity();
 
 	// only check for missing files, as the code changes mid-import process too and we'd need to manage state if we wanted to check for assets as well when code changes
@@ -438,6 +574,75 @@ void FArticyEditorModule::TriggerQueuedImport(bool b)
 	UnqueueImport();
 }
 
+/**
+ * Handle writes to the articy directory, starting or restarting the settle time if the export was written to.
+ *
+ * @param FileChanges Array of file change data.
+ */
+void FArticyEditorModule::OnExportChanged(const TArray<FFileChangeData>& FileChanges)
+{
+	if (!GetDefault<UArticyPluginSettings>()->bAutoImportExportChanges)
+	{
+		return;
+	}
+
+	// the generated assets are written below the articy directory too, only the export itself counts
+	const bool bExportChanged = FileChanges.ContainsByPredicate([](const FFileChangeData& Change)
+		{
+			return Change.Action != FFileChangeData::FCA_Removed && FPaths::GetExtension(Change.Filename).Equals(TEXT("articyue"), ESearchCase::IgnoreCase);
+		});
+	if (!bExportChanged)
+	{
+		return;
+	}
+
+	LastExportChangeTime = FPlatformTime::Seconds();
+
+	if (!ExportChangeTickerHandle.IsValid())
+	{
+		ExportChangeTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FArticyEditorModule::TickExportWatcher), 0.25f);
+	}
+}
+
+/**
+ * Import the changed export once it was not written to for the settle time.
+ *
+ * @param DeltaTime The time since the last tick.
+ * @return True to keep waiting, false once the import ran.
+ */
+bool FArticyEditorModule::TickExportWatcher(float DeltaTime)
+{
+	if (FPlatformTime::Seconds() - LastExportChangeTime < GetDefault<UArticyPluginSettings>()->AutoImportSettleTime)
+	{
+		return true;
+	}
+
+	// during play the change stays pending rather than queuing an import with a dialog for every write,
+	// unless content changes are hot-patched into the running game
+	const bool bWaitForPlayToEnd = ArticyImporterHelpers::IsPlayInEditor() && !GetDefault<UArticyPluginSettings>()->bHotPatchPackagesDuringPlay;
+	if (bWaitForPlayToEnd || IsImportQueued() || FArticyEditorFunctionLibrary::GetBatchImportOptions())
+	{
+		return true;
+	}
+
+	ExportChangeTickerHandle.Reset();
+
+	// An import still waiting for the compilation of its generated code is superseded by this one, see CodeGenerator::Compile,
+	// so the assets are generated once from the latest export rather than once per import
+	UE_LOG(LogArticyEditor, Display, TEXT("The articy:draft export changed, importing the changes."));
+	FArticyEditorFunctionLibrary::ReimportChanges();
+
+	return false;
+}
+
+/**
+ * Watch the articy directory again after an import, in case the import moved it.
+ */
+void FArticyEditorModule::OnExportDirectoryMaybeChanged()
+{
+	RegisterExportWatcher();
+}
+
 /**
  * Spawn the Articy menu tab, providing UI for reimporting and regenerating assets.
  *
@@ -538,6 +743,21 @@ TSharedRef<SDockTab> FArticyEditorModule::OnSpawnArticyGVDebuggerTab(const FSpaw
 		];
 }
 
+/**
+ * Spawn the Articy global variables profiler tab.
+ *
+ * @param SpawnTabArgs The arguments for spawning the tab.
+ * @return The created dock tab widget.
+ */
+TSharedRef<SDockTab> FArticyEditorModule::OnSpawnArticyGVProfilerTab(const FSpawnTabArgs& SpawnTabArgs) const
+{
+	return SNew(SDockTab)
+		.TabRole(ETabRole::NomadTab)
+		[
+			SNew(SArticyGvProfiler)
+		];
+}
+
 #undef LOCTEXT_NAMESPACE
 
 IMPLEMENT_MODULE(FArticyEditorModule, ArticyEditor)
@@ -0,0 +1,1659 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyExpressoTranslator.h"
+#include "ArticyHelpers.h"
+#include "Algo/AllOf.h"
+
+namespace
+{
+	bool IsIdentifierStart(TCHAR Char)
+	{
+		return (Char >= 'a' && Char <= 'z') || (Char >= 'A' && Char <= 'Z') || Char == '_';
+	}
+
+	bool IsDigit(TCHAR Char)
+	{
+		return Char >= '0' && Char <= '9';
+	}
+
+	bool IsIdentifierChar(TCHAR Char)
+	{
+		return IsIdentifierStart(Char) || IsDigit(Char);
+	}
+
+	bool FitsInt32(int64 Value)
+	{
+		return Value >= MIN_int32 && Value <= MAX_int32;
+	}
+
+	/** The operators, the longer ones first so the longest match wins. */
+	const TCHAR* const Operators[] = {
+		TEXT("=="), TEXT("!="), TEXT("<="), TEXT(">="), TEXT("&&"), TEXT("||"), TEXT("++"), TEXT("--"),
+		TEXT("+="), TEXT("-="), TEXT("*="), TEXT("/="), TEXT("%="),
+		TEXT("+"), TEXT("-"), TEXT("*"), TEXT("/"), TEXT("%"), TEXT("<"), TEXT(">"), TEXT("="), TEXT("!"),
+		TEXT("("), TEXT(")"), TEXT(","), TEXT("."), TEXT(";"), TEXT("?"), TEXT(":")
+	};
+
+	const TCHAR* const AssignmentOperators[] = { TEXT("="), TEXT("+="), TEXT("-="), TEXT("*="), TEXT("/="), TEXT("%=") };
+
+	/** The binary operators, with the precedence of C++. */
+	const struct
+	{
+		const TCHAR* Operator;
+		int32 Precedence;
+	} BinaryOperators[] = {
+		{ TEXT("||"), 1 },
+		{ TEXT("&&"), 2 },
+		{ TEXT("=="), 3 }, { TEXT("!="), 3 },
+		{ TEXT("<"), 4 }, { TEXT("<="), 4 }, { TEXT(">"), 4 }, { TEXT(">="), 4 },
+		{ TEXT("+"), 5 }, { TEXT("-"), 5 },
+		{ TEXT("*"), 6 }, { TEXT("/"), 6 }, { TEXT("%"), 6 }
+	};
+
+	/** Binary operators up to this precedence result in a bool. */
+	constexpr int32 MaxBooleanPrecedence = 4;
+
+	/** The builtin methods which only read state (see UArticyExpressoScripts), calls of all others may write it. */
+	const TCHAR* const ReadOnlyMethods[] = {
+		TEXT("getObj"), TEXT("getProp"), TEXT("getSeenCounter"), TEXT("isInRange"), TEXT("isPropInRange"), TEXT("random"), TEXT("print")
+	};
+
+	/** The builtin methods which access seen counters. */
+	const TCHAR* const SeenCounterMethods[] = {
+		TEXT("getSeenCounter"), TEXT("setSeenCounter"), TEXT("resetAllSeenCounters"), TEXT("fallback")
+	};
+
+	/** The builtin methods which access properties of objects. */
+	const TCHAR* const PropertyMethods[] = {
+		TEXT("getProp"), TEXT("setProp"), TEXT("incrementProp"), TEXT("decrementProp"), TEXT("isPropInRange")
+	};
+
+	using EType = FArticyExpressoSymbols::EType;
+
+	/** The builtin methods with their number of arguments and what they return (see UArticyExpressoScripts), Unknown if it depends on the arguments. */
+	const struct
+	{
+		const TCHAR* Method;
+		int32 MinArguments;
+		int32 MaxArguments;
+		EType Result;
+	} BuiltinMethods[] = {
+		{ TEXT("getObj"), 1, 2, EType::Object },
+		{ TEXT("getProp"), 2, 2, EType::Unknown },
+		{ TEXT("setProp"), 3, 3, EType::Void },
+		{ TEXT("random"), 1, 2, EType::Unknown },
+		{ TEXT("incrementProp"), 2, 3, EType::Void },
+		{ TEXT("decrementProp"), 2, 3, EType::Void },
+		{ TEXT("isInRange"), 3, 3, EType::Bool },
+		{ TEXT("isPropInRange"), 4, 4, EType::Bool },
+		{ TEXT("resetAllSeenCounters"), 0, 0, EType::Void },
+		{ TEXT("getSeenCounter"), 0, 1, EType::Int },
+		{ TEXT("setSeenCounter"), 0, 2, EType::Int },
+		{ TEXT("fallback"), 0, 1, EType::Bool },
+		{ TEXT("print"), 1, MAX_int32, EType::Void }
+	};
+
+	/** The identifiers the generated scripts provide besides the global variable namespaces. */
+	const TCHAR* const ScriptIdentifiers[] = {
+		TEXT("seen"), TEXT("unseen"), TEXT("seenCounter"), TEXT("self"), TEXT("speaker")
+	};
+
+	/** Returns true if the type of an expression is known and it has a value. */
+	bool IsValue(EType Type)
+	{
+		return Type != EType::Unknown && Type != EType::Void;
+	}
+
+	/** Returns true if a value can't be converted to a type, by the generated code or by ExpressoType. */
+	bool IsMismatch(EType Expected, EType Actual)
+	{
+		if (!IsValue(Expected) || !IsValue(Actual))
+			return false;
+
+		if (Expected == EType::String || Expected == EType::Object)
+			return Actual != Expected;
+
+		// Numbers and bools convert to each other, and objects to bools
+		return Actual == EType::String || (Actual == EType::Object && Expected != EType::Bool);
+	}
+}
+
+/**
+ * Returns the type of a parameter or result of a user method.
+ * @param Type The type as exported by articy: bool, int, float, string, object or void.
+ * @return The type, Unknown for any other.
+ */
+FArticyExpressoSymbols::EType FArticyExpressoSymbols::GetType(const FString& Type)
+{
+	if (Type == TEXT("bool"))
+		return EType::Bool;
+	if (Type == TEXT("int"))
+		return EType::Int;
+	if (Type == TEXT("float"))
+		return EType::Float;
+	if (Type == TEXT("string"))
+		return EType::String;
+	if (Type == TEXT("object"))
+		return EType::Object;
+	if (Type == TEXT("void"))
+		return EType::Void;
+	return EType::Unknown;
+}
+
+/** Returns the name of a type, for the diagnostics. */
+const TCHAR* FArticyExpressoSymbols::GetName(EType Type)
+{
+	switch (Type)
+	{
+	case EType::Bool:
+		return TEXT("bool");
+	case EType::Int:
+		return TEXT("int");
+	case EType::Float:
+		return TEXT("float");
+	case EType::String:
+		return TEXT("string");
+	case EType::Object:
+		return TEXT("object");
+	case EType::Void:
+		return TEXT("void");
+	default:
+		return TEXT("value");
+	}
+}
+
+/**
+ * Translates a fragment.
+ *
+ * Instructions are a list of statements separated by semicolons, each of them is terminated by a semicolon in the
+ * translation. Conditions are a single expression without a semicolon, as they are wrapped in ConditionOrTrue.
+ *
+ * @param InFragment The script fragment.
+ * @param bIsInstruction Whether the fragment is an instruction (statements) or a condition (a single expression).
+ * @param OutCode Receives the C++ code.
+ * @param OutPrologue Receives the statements binding the locals the code uses, to be emitted before it.
+ * @return False if the fragment is malformed, see GetError.
+ */
+bool FArticyExpressoTranslator::Translate(const FString& InFragment, bool bIsInstruction, FString& OutCode, FString& OutPrologue)
+{
+	Fragment = *InFragment;
+	FragmentLength = InFragment.Len();
+	Tokens.Reset();
+	Comments.Reset();
+	Current = 0;
+	Nodes.Reset();
+	CallArguments.Reset();
+	GlobalVariables.Reset();
+	GlobalVariableAccesses.Reset();
+	GlobalVariableLocals.Reset();
+	ReadVariables.Reset();
+	WrittenVariables.Reset();
+	ResolvedObjects.Reset();
+	bCallsUserMethods = false;
+	bWritesState = false;
+	bAccessesSeenCounters = false;
+	bAccessesObjectProperties = false;
+	Code.Reset();
+	Error.Reset();
+	Diagnostics.Reset();
+	bFailed = false;
+
+	if (!Tokenize())
+		return false;
+
+	// Empty statements are skipped
+	TArray<int32, TInlineAllocator<8>> Statements;
+	while (Peek().Type != ETokenType::End)
+	{
+		if (ConsumeOperator(TEXT(";")))
+			continue;
+
+		if (!bIsInstruction && Statements.Num() > 0)
+		{
+			Fail(Peek().Begin, TEXT("a condition must be a single expression"));
+			return false;
+		}
+
+		const int32 Statement = ParseAssignment();
+		if (bFailed)
+			return false;
+
+		// Checked before folding, so operands which are never evaluated are checked as well
+		if (Symbols)
+		{
+			Check(Statement);
+			if (!bIsInstruction)
+				CheckValue(Statement);
+		}
+		Statements.Add(Fold(Statement));
+
+		if (Peek().Type != ETokenType::End && !ExpectOperator(TEXT(";")))
+			return false;
+	}
+
+	for (const int32 Statement : Statements)
+		CountAccesses(Statement);
+
+	// The provider is fetched once rather than by each call (see GenerateUserMethods in ExpressoScriptsGenerator)
+	OutPrologue.Reset();
+	if (bCallsUserMethods)
+		OutPrologue += TEXT("UObject* const methodProvider = GetUserMethodsProviderObject();");
+
+	// Each access of a global variable resolves the weak pointer of its namespace, so repeated ones are bound once.
+	// This is a reference to the variable, so it still sees the assignments of the fragment and of method calls.
+	TSet<FString> LocalNames;
+	for (const FString& Variable : GlobalVariables)
+	{
+		if (GlobalVariableAccesses[Variable] < 2)
+			continue;
+
+		FString Namespace, Name;
+		Variable.Split(TEXT("."), &Namespace, &Name);
+		FString Local = FString::Printf(TEXT("GV_%s_%s"), *Namespace, *Name);
+		while (LocalNames.Contains(Local))
+			Local += TEXT("_");
+		LocalNames.Add(Local);
+
+		if (!OutPrologue.IsEmpty())
+			OutPrologue += TEXT("\n");
+		OutPrologue += FString::Printf(TEXT("auto& %s = *%s->%s;"), *Local, *Namespace, *Name);
+		GlobalVariableLocals.Add(Variable, MoveTemp(Local));
+	}
+
+	// All comments are put at the top
+	Code = Comments;
+	bool bFirstStatement = true;
+	for (const int32 Statement : Statements)
+	{
+		// Statements which were folded to a literal do nothing
+		if (bIsInstruction && Nodes[Statement].bConstant)
+			continue;
+
+		if (!bFirstStatement)
+			Code += TEXT("\n");
+		bFirstStatement = false;
+
+		Emit(Statement, false);
+
+		//script conditions don't have semicolons!
+		if (bIsInstruction)
+			Code += TEXT(";");
+	}
+
+	OutCode = Code;
+	return true;
+}
+
+/**
+ * Splits the fragment into tokens, and collects its comments.
+ * @return False on an unexpected character, or an unterminated string or comment.
+ */
+bool FArticyExpressoTranslator::Tokenize()
+{
+	int32 Position = 0;
+	while (Position < FragmentLength)
+	{
+		const TCHAR Char = Fragment[Position];
+		const TCHAR NextChar = Position + 1 < FragmentLength ? Fragment[Position + 1] : TCHAR(0);
+		if (FChar::IsWhitespace(Char))
+		{
+			++Position;
+			continue;
+		}
+
+		if (Char == '/' && (NextChar == '/' || NextChar == '*'))
+		{
+			int32 End = Position + 2;
+			if (NextChar == '/')
+			{
+				while (End < FragmentLength && Fragment[End] != '\n' && Fragment[End] != '\r')
+					++End;
+			}
+			else
+			{
+				while (End + 1 < FragmentLength && !(Fragment[End] == '*' && Fragment[End + 1] == '/'))
+					++End;
+				if (End + 1 >= FragmentLength)
+				{
+					Fail(Position, TEXT("unterminated comment"));
+					return false;
+				}
+				End += 2;
+			}
+
+			Comments.AppendChars(Fragment + Position, End - Position);
+			Comments += TEXT("\n");
+			Position = End;
+			continue;
+		}
+
+		const int32 Begin = Position;
+		ETokenType Type;
+		if (IsIdentifierStart(Char))
+		{
+			Type = ETokenType::Identifier;
+			while (Position < FragmentLength && IsIdentifierChar(Fragment[Position]))
+				++Position;
+		}
+		else if (IsDigit(Char) || (Char == '.' && IsDigit(NextChar)))
+		{
+			Type = ETokenType::Integer;
+			while (Position < FragmentLength && IsDigit(Fragment[Position]))
+				++Position;
+
+			if (Position + 1 < FragmentLength && Fragment[Position] == '.' && IsDigit(Fragment[Position + 1]))
+			{
+				Type = ETokenType::Float;
+				++Position;
+				while (Position < FragmentLength && IsDigit(Fragment[Position]))
+					++Position;
+			}
+
+			if (Position < FragmentLength && (Fragment[Position] == 'e' || Fragment[Position] == 'E'))
+			{
+				int32 Exponent = Position + 1;
+				if (Exponent < FragmentLength && (Fragment[Exponent] == '+' || Fragment[Exponent] == '-'))
+					++Exponent;
+				if (Exponent < FragmentLength && IsDigit(Fragment[Exponent]))
+				{
+					Type = ETokenType::Float;
+					Position = Exponent;
+					while (Position < FragmentLength && IsDigit(Fragment[Position]))
+						++Position;
+				}
+			}
+
+			if (Position < FragmentLength && (Fragment[Position] == 'f' || Fragment[Position] == 'F'))
+			{
+				Type = ETokenType::Float;
+				++Position;
+			}
+
+			if (Position < FragmentLength && IsIdentifierChar(Fragment[Position]))
+			{
+				Fail(Position, FString::Printf(TEXT("unexpected character '%c' in a number"), Fragment[Position]));
+				return false;
+			}
+		}
+		else if (Char == '"')
+		{
+			// Strings are emitted as they are written, so the escapes are only skipped
+			Type = ETokenType::String;
+			++Position;
+			while (Position < FragmentLength && Fragment[Position] != '"')
+				Position += Fragment[Position] == '\\' ? 2 : 1;
+			if (Position >= FragmentLength)
+			{
+				Fail(Begin, TEXT("unterminated string"));
+				return false;
+			}
+			++Position;
+		}
+		else
+		{
+			Type = ETokenType::Operator;
+			for (const TCHAR* Operator : Operators)
+			{
+				const int32 Length = FCString::Strlen(Operator);
+				if (Position + Length <= FragmentLength && FCString::Strncmp(Fragment + Position, Operator, Length) == 0)
+				{
+					Position += Length;
+					break;
+				}
+			}
+
+			if (Position == Begin)
+			{
+				Fail(Begin, FString::Printf(TEXT("unexpected character '%c'"), Char));
+				return false;
+			}
+		}
+
+		Tokens.Add({ Type, Begin, Position - Begin });
+	}
+
+	Tokens.Add({ ETokenType::End, FragmentLength, 0 });
+	return true;
+}
+
+/** Parses an assignment (right associative), or any expression of higher precedence. */
+int32 FArticyExpressoTranslator::ParseAssignment()
+{
+	const int32 Target = ParseTernary();
+	if (bFailed)
+		return INDEX_NONE;
+
+	for (const TCHAR* Operator : AssignmentOperators)
+	{
+		if (!IsOperator(Peek(), Operator))
+			continue;
+
+		const ENodeType TargetType = Nodes[Target].Type;
+		if (TargetType != ENodeType::Identifier && TargetType != ENodeType::Member)
+			return Fail(Peek().Begin, FString::Printf(TEXT("cannot assign to the left side of '%s'"), Operator));
+
+		const int32 OperatorToken = Current++;
+		const int32 Value = ParseAssignment();
+		if (bFailed)
+			return INDEX_NONE;
+
+		return AddNode(ENodeType::Assignment, OperatorToken, Target, Value);
+	}
+
+	return Target;
+}
+
+/** Parses a conditional expression, or any expression of higher precedence. */
+int32 FArticyExpressoTranslator::ParseTernary()
+{
+	const int32 Condition = ParseBinary(1);
+	if (bFailed || !ConsumeOperator(TEXT("?")))
+		return Condition;
+
+	const int32 OperatorToken = Current - 1;
+	const int32 IfTrue = ParseAssignment();
+	if (bFailed || !ExpectOperator(TEXT(":")))
+		return INDEX_NONE;
+
+	const int32 IfFalse = ParseAssignment();
+	if (bFailed)
+		return INDEX_NONE;
+
+	return AddNode(ENodeType::Ternary, OperatorToken, Condition, IfTrue, IfFalse);
+}
+
+/**
+ * Parses binary operations by precedence climbing, all binary operators are left associative.
+ * @param MinPrecedence The lowest precedence of an operator which is part of this expression.
+ */
+int32 FArticyExpressoTranslator::ParseBinary(int32 MinPrecedence)
+{
+	int32 Left = ParseUnary();
+	while (!bFailed)
+	{
+		const int32 Precedence = GetBinaryPrecedence(Peek());
+		if (Precedence < MinPrecedence)
+			break;
+
+		const int32 OperatorToken = Current++;
+		const int32 Right = ParseBinary(Precedence + 1);
+		if (bFailed)
+			break;
+
+		Left = AddNode(ENodeType::Binary, OperatorToken, Left, Right);
+	}
+
+	return bFailed ? INDEX_NONE : Left;
+}
+
+/** Parses a prefix operation, or a postfix expression. */
+int32 FArticyExpressoTranslator::ParseUnary()
+{
+	const FToken& Token = Peek();
+	if (IsOperator(Token, TEXT("!")) || IsOperator(Token, TEXT("-")) || IsOperator(Token, TEXT("+")) || IsOperator(Token, TEXT("++")) || IsOperator(Token, TEXT("--")))
+	{
+		const int32 OperatorToken = Current++;
+		const int32 Operand = ParseUnary();
+		if (bFailed)
+			return INDEX_NONE;
+
+		return AddNode(ENodeType::Unary, OperatorToken, Operand);
+	}
+
+	return ParsePostfix();
+}
+
+/** Parses member accesses, calls and postfix increments of a primary expression. */
+int32 FArticyExpressoTranslator::ParsePostfix()
+{
+	int32 Expression = ParsePrimary();
+	while (!bFailed)
+	{
+		if (ConsumeOperator(TEXT(".")))
+		{
+			if (Peek().Type != ETokenType::Identifier)
+				return Fail(Peek().Begin, TEXT("expected a member name but found ") + Describe(Peek()));
+
+			Expression = AddNode(ENodeType::Member, Current++, Expression);
+		}
+		else if (ConsumeOperator(TEXT("(")))
+		{
+			const int32 OperatorToken = Current - 1;
+			TArray<int32, TInlineAllocator<8>> Arguments;
+			if (!ConsumeOperator(TEXT(")")))
+			{
+				do
+				{
+					const int32 Argument = ParseAssignment();
+					if (bFailed)
+						return INDEX_NONE;
+					Arguments.Add(Argument);
+				}
+				while (ConsumeOperator(TEXT(",")));
+
+				if (!ExpectOperator(TEXT(")")))
+					return INDEX_NONE;
+			}
+
+			// The arguments of nested calls were added first, so the arguments of this call are contiguous
+			Expression = AddNode(ENodeType::Call, OperatorToken, Expression);
+			Nodes[Expression].ArgumentsBegin = CallArguments.Num();
+			Nodes[Expression].NumArguments = Arguments.Num();
+			CallArguments.Append(Arguments);
+		}
+		else if (IsOperator(Peek(), TEXT("++")) || IsOperator(Peek(), TEXT("--")))
+		{
+			Expression = AddNode(ENodeType::Postfix, Current++, Expression);
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	return bFailed ? INDEX_NONE : Expression;
+}
+
+/** Parses a literal, an identifier or a parenthesized expression. */
+int32 FArticyExpressoTranslator::ParsePrimary()
+{
+	const FToken& Token = Peek();
+	switch (Token.Type)
+	{
+	case ETokenType::Identifier:
+		if (IsIdentifier(Current, TEXT("true")) || IsIdentifier(Current, TEXT("false")))
+		{
+			const bool bValue = IsIdentifier(Current, TEXT("true"));
+			const int32 Node = AddNode(ENodeType::Boolean, Current++);
+			Nodes[Node].Value = bValue;
+			Nodes[Node].bConstant = true;
+			return Node;
+		}
+		return AddNode(ENodeType::Identifier, Current++);
+
+	case ETokenType::Integer:
+	{
+		// Integers beyond int32 are emitted as they are written, but not folded
+		const int32 Node = AddNode(ENodeType::Integer, Current++);
+		const int64 Value = Token.Length <= 10 ? FCString::Atoi64(Fragment + Token.Begin) : MAX_int64;
+		if (FitsInt32(Value))
+		{
+			Nodes[Node].Value = Value;
+			Nodes[Node].bConstant = true;
+		}
+		return Node;
+	}
+
+	case ETokenType::Float:
+		return AddNode(ENodeType::Float, Current++);
+
+	case ETokenType::String:
+		return AddNode(ENodeType::String, Current++);
+
+	default:
+		break;
+	}
+
+	if (ConsumeOperator(TEXT("(")))
+	{
+		const int32 OperatorToken = Current - 1;
+		const int32 Inner = ParseAssignment();
+		if (bFailed || !ExpectOperator(TEXT(")")))
+			return INDEX_NONE;
+
+		return AddNode(ENodeType::Paren, OperatorToken, Inner);
+	}
+
+	return Fail(Token.Begin, TEXT("expected an expression but found ") + Describe(Token));
+}
+
+/**
+ * Checks an expression against the symbols: the global variables must exist, the methods must exist and take the
+ * number of arguments they are called with, and the operands must have the types the operations take. Operands
+ * whose type isn't known, like object properties, are not checked.
+ * @param Node The expression, before it is simplified.
+ */
+void FArticyExpressoTranslator::Check(int32 Node)
+{
+	const FNode& Expression = Nodes[Node];
+	switch (Expression.Type)
+	{
+	case ENodeType::Identifier:
+	{
+		for (const TCHAR* Identifier : ScriptIdentifiers)
+		{
+			if (IsIdentifier(Expression.Token, Identifier))
+				return;
+		}
+
+		const FString Name = GetText(Expression.Token);
+		if (!Symbols->Variables.Contains(Name))
+			Report(Tokens[Expression.Token].Begin, FString::Printf(TEXT("unknown identifier '%s'"), *Name));
+		break;
+	}
+
+	case ENodeType::Member:
+	{
+		const FNode& Object = Nodes[Expression.First];
+		if (Object.Type != ENodeType::Identifier)
+		{
+			Check(Expression.First);
+			break;
+		}
+
+		// Member accesses of identifiers are global variables, see GetGlobalVariable
+		const FArticyExpressoSymbols::TNameMap<EType>* Variables = Symbols->Variables.Find(GetText(Object.Token));
+		if (!Variables)
+			Report(Tokens[Object.Token].Begin, FString::Printf(TEXT("unknown global variable namespace '%s'"), *GetText(Object.Token)));
+		else if (!Variables->Contains(GetText(Expression.Token)))
+			Report(Tokens[Expression.Token].Begin, FString::Printf(TEXT("unknown global variable '%s'"), *GetGlobalVariable(Node)));
+		break;
+	}
+
+	case ENodeType::Call:
+		CheckCall(Node);
+		break;
+
+	case ENodeType::Paren:
+		Check(Expression.First);
+		break;
+
+	case ENodeType::Unary:
+		Check(Expression.First);
+		CheckOperand(Expression.First, Expression.Token, !IsOperator(Tokens[Expression.Token], TEXT("!")));
+		break;
+
+	case ENodeType::Postfix:
+		Check(Expression.First);
+		CheckOperand(Expression.First, Expression.Token, true);
+		break;
+
+	case ENodeType::Binary:
+	{
+		Check(Expression.First);
+		Check(Expression.Second);
+
+		// && and || take bools, comparisons and + take two strings or two values which are none, the others numbers
+		const FToken& Operator = Tokens[Expression.Token];
+		const int32 Precedence = GetBinaryPrecedence(Operator);
+		if (Precedence > MaxBooleanPrecedence && !IsOperator(Operator, TEXT("+")))
+		{
+			CheckOperand(Expression.First, Expression.Token, true);
+			CheckOperand(Expression.Second, Expression.Token, true);
+		}
+		else if (IsOperator(Operator, TEXT("&&")) || IsOperator(Operator, TEXT("||")))
+		{
+			CheckOperand(Expression.First, Expression.Token, false);
+			CheckOperand(Expression.Second, Expression.Token, false);
+		}
+		else if (CheckValue(Expression.First) && CheckValue(Expression.Second))
+		{
+			const EType Left = GetType(Expression.First);
+			const EType Right = GetType(Expression.Second);
+			if (IsValue(Left) && IsValue(Right) && (Left == EType::String) != (Right == EType::String))
+			{
+				Report(Operator.Begin, FString::Printf(TEXT("'%s' cannot be applied to a %s and a %s"), *GetText(Expression.Token),
+					FArticyExpressoSymbols::GetName(Left), FArticyExpressoSymbols::GetName(Right)));
+			}
+		}
+		break;
+	}
+
+	case ENodeType::Assignment:
+	{
+		Check(Expression.First);
+		Check(Expression.Second);
+		if (!CheckValue(Expression.Second))
+			break;
+
+		// Only global variables have a known type as targets, strings can only be appended to
+		const FNode& Target = Nodes[Expression.First];
+		if (Target.Type != ENodeType::Member || Nodes[Target.First].Type != ENodeType::Identifier)
+			break;
+
+		const FToken& Operator = Tokens[Expression.Token];
+		const FString Variable = GetGlobalVariable(Expression.First);
+		const EType Type = GetType(Expression.First);
+		if (IsOperator(Operator, TEXT("=")))
+			CheckConversion(Expression.Second, Type, FString::Printf(TEXT("'%s'"), *Variable));
+		else if (Type == EType::String && !IsOperator(Operator, TEXT("+=")))
+			Report(Operator.Begin, FString::Printf(TEXT("'%s' cannot be applied to the string '%s'"), *GetText(Expression.Token), *Variable));
+		else if (IsValue(Type) && Type != EType::String)
+			CheckOperand(Expression.Second, Expression.Token, true);
+		break;
+	}
+
+	case ENodeType::Ternary:
+	{
+		Check(Expression.First);
+		Check(Expression.Second);
+		Check(Expression.Third);
+		CheckOperand(Expression.First, Expression.Token, false);
+
+		const EType IfTrue = GetType(Expression.Second);
+		const EType IfFalse = GetType(Expression.Third);
+		if (IsValue(IfTrue) && IsValue(IfFalse) && (IfTrue == EType::String) != (IfFalse == EType::String))
+		{
+			Report(Tokens[Expression.Token].Begin, FString::Printf(TEXT("the branches of '?' are a %s and a %s"),
+				FArticyExpressoSymbols::GetName(IfTrue), FArticyExpressoSymbols::GetName(IfFalse)));
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+/**
+ * Checks a call: user methods must have an overload with its number of arguments, whose parameters the arguments
+ * convert to, builtin methods must take its number of arguments, and other methods don't exist.
+ * @param Node The call.
+ */
+void FArticyExpressoTranslator::CheckCall(int32 Node)
+{
+	const FNode& Expression = Nodes[Node];
+	for (int32 Index = 0; Index < Expression.NumArguments; ++Index)
+		Check(CallArguments[Expression.ArgumentsBegin + Index]);
+
+	const FNode& Callee = Nodes[Expression.First];
+	if (Callee.Type != ENodeType::Identifier)
+	{
+		Check(Expression.First);
+		return;
+	}
+
+	const FString Name = GetText(Callee.Token);
+	const int32 Position = Tokens[Callee.Token].Begin;
+	if (const TArray<FArticyExpressoSymbols::FMethod>* Overloads = Symbols->Methods.Find(Name))
+	{
+		const FArticyExpressoSymbols::FMethod* Match = nullptr;
+		int32 NumMatches = 0;
+		TArray<int32, TInlineAllocator<4>> Arities;
+		for (const FArticyExpressoSymbols::FMethod& Overload : *Overloads)
+		{
+			if (Overload.Parameters.Num() == Expression.NumArguments)
+			{
+				Match = &Overload;
+				++NumMatches;
+			}
+			Arities.AddUnique(Overload.Parameters.Num());
+		}
+
+		if (!Match)
+		{
+			Arities.Sort();
+			FString Expected;
+			for (int32 Index = 0; Index < Arities.Num(); ++Index)
+				Expected += (Index == 0 ? TEXT("") : TEXT(" or ")) + FString::FromInt(Arities[Index]);
+			Report(Position, FString::Printf(TEXT("'%s' takes %s arguments but is called with %d"), *Name, *Expected, Expression.NumArguments));
+			return;
+		}
+
+		// Overloads with the same number of parameters differ by their types, so any of them may be the one called
+		for (int32 Index = 0; Index < Expression.NumArguments; ++Index)
+		{
+			const int32 Argument = CallArguments[Expression.ArgumentsBegin + Index];
+			if (CheckValue(Argument) && NumMatches == 1)
+				CheckConversion(Argument, Match->Parameters[Index], FString::Printf(TEXT("parameter %d of '%s'"), Index + 1, *Name));
+		}
+		return;
+	}
+
+	for (const auto& Builtin : BuiltinMethods)
+	{
+		if (!IsIdentifier(Callee.Token, Builtin.Method))
+			continue;
+
+		if (Expression.NumArguments < Builtin.MinArguments || Expression.NumArguments > Builtin.MaxArguments)
+		{
+			const FString Expected = Builtin.MaxArguments == MAX_int32 ? FString::Printf(TEXT("at least %d"), Builtin.MinArguments)
+				: Builtin.MinArguments == Builtin.MaxArguments ? FString::FromInt(Builtin.MinArguments)
+				: FString::Printf(TEXT("%d to %d"), Builtin.MinArguments, Builtin.MaxArguments);
+			Report(Position, FString::Printf(TEXT("'%s' takes %s arguments but is called with %d"), *Name, *Expected, Expression.NumArguments));
+			return;
+		}
+
+		for (int32 Index = 0; Index < Expression.NumArguments; ++Index)
+			CheckValue(CallArguments[Expression.ArgumentsBegin + Index]);
+		return;
+	}
+
+	Report(Position, FString::Printf(TEXT("unknown method '%s'"), *Name));
+}
+
+/**
+ * Reports an expression used as a value which has none, i.e. the call of a method which returns void.
+ * @param Node The expression.
+ * @return False if it has no value.
+ */
+bool FArticyExpressoTranslator::CheckValue(int32 Node)
+{
+	if (GetType(Node) != EType::Void)
+		return true;
+
+	Report(GetPosition(Node), TEXT("the method does not return a value"));
+	return false;
+}
+
+/**
+ * Reports an operand of the wrong type: strings can't be used as bools or numbers, objects can't be used as numbers.
+ * @param Node The operand.
+ * @param Operator The token of the operator.
+ * @param bNumeric Whether the operator takes numbers, rather than bools.
+ */
+void FArticyExpressoTranslator::CheckOperand(int32 Node, int32 Operator, bool bNumeric)
+{
+	if (!CheckValue(Node))
+		return;
+
+	const EType Type = GetType(Node);
+	if (Type == EType::String || (bNumeric && Type == EType::Object))
+		Report(Tokens[Operator].Begin, FString::Printf(TEXT("'%s' cannot be applied to a %s"), *GetText(Operator), FArticyExpressoSymbols::GetName(Type)));
+}
+
+/**
+ * Reports a value which is assigned or passed to something of a type it can't be converted to.
+ * @param Node The value.
+ * @param Expected The type of the target.
+ * @param Target The description of the target, e.g. the variable.
+ */
+void FArticyExpressoTranslator::CheckConversion(int32 Node, EType Expected, const FString& Target)
+{
+	const EType Actual = GetType(Node);
+	if (IsMismatch(Expected, Actual))
+	{
+		Report(GetPosition(Node), FString::Printf(TEXT("cannot convert a %s to the %s %s"), FArticyExpressoSymbols::GetName(Actual),
+			FArticyExpressoSymbols::GetName(Expected), *Target));
+	}
+}
+
+/**
+ * Returns the type of an expression as far as it is known from the literals, global variables and method results.
+ * @param Node The expression.
+ * @return The type, Unknown for e.g. object properties.
+ */
+FArticyExpressoSymbols::EType FArticyExpressoTranslator::GetType(int32 Node) const
+{
+	const FNode& Expression = Nodes[Node];
+	switch (Expression.Type)
+	{
+	case ENodeType::Boolean:
+		return EType::Bool;
+
+	case ENodeType::Integer:
+		return EType::Int;
+
+	case ENodeType::Float:
+		return EType::Float;
+
+	case ENodeType::String:
+		return EType::String;
+
+	case ENodeType::Identifier:
+		if (IsIdentifier(Expression.Token, TEXT("seen")) || IsIdentifier(Expression.Token, TEXT("unseen")))
+			return EType::Bool;
+		if (IsIdentifier(Expression.Token, TEXT("seenCounter")))
+			return EType::Int;
+		if (IsIdentifier(Expression.Token, TEXT("self")) || IsIdentifier(Expression.Token, TEXT("speaker")))
+			return EType::Object;
+		return EType::Unknown;
+
+	case ENodeType::Member:
+	{
+		if (Nodes[Expression.First].Type != ENodeType::Identifier)
+			return EType::Unknown;
+
+		const FArticyExpressoSymbols::TNameMap<EType>* Variables = Symbols->Variables.Find(GetText(Nodes[Expression.First].Token));
+		const EType* Type = Variables ? Variables->Find(GetText(Expression.Token)) : nullptr;
+		return Type ? *Type : EType::Unknown;
+	}
+
+	case ENodeType::Call:
+	{
+		const FNode& Callee = Nodes[Expression.First];
+		if (Callee.Type != ENodeType::Identifier)
+			return EType::Unknown;
+
+		// The overloads called with this number of arguments must agree on the result
+		if (const TArray<FArticyExpressoSymbols::FMethod>* Overloads = Symbols->Methods.Find(GetText(Callee.Token)))
+		{
+			TOptional<EType> Result;
+			for (const FArticyExpressoSymbols::FMethod& Overload : *Overloads)
+			{
+				if (Overload.Parameters.Num() != Expression.NumArguments)
+					continue;
+				if (Result.IsSet() && Result.GetValue() != Overload.Result)
+					return EType::Unknown;
+				Result = Overload.Result;
+			}
+			return Result.Get(EType::Unknown);
+		}
+
+		for (const auto& Builtin : BuiltinMethods)
+		{
+			if (IsIdentifier(Callee.Token, Builtin.Method))
+				return Builtin.Result;
+		}
+		return EType::Unknown;
+	}
+
+	case ENodeType::Paren:
+	case ENodeType::Postfix:
+	case ENodeType::Assignment:
+		return GetType(Expression.First);
+
+	case ENodeType::Unary:
+		return IsOperator(Tokens[Expression.Token], TEXT("!")) ? EType::Bool : GetType(Expression.First);
+
+	case ENodeType::Binary:
+	{
+		if (GetBinaryPrecedence(Tokens[Expression.Token]) <= MaxBooleanPrecedence)
+			return EType::Bool;
+
+		const EType Left = GetType(Expression.First);
+		const EType Right = GetType(Expression.Second);
+		if (Left == EType::String && Right == EType::String && IsOperator(Tokens[Expression.Token], TEXT("+")))
+			return EType::String;
+		if (Left == EType::String || Right == EType::String || Left == EType::Object || Right == EType::Object || !IsValue(Left) || !IsValue(Right))
+			return EType::Unknown;
+		return Left == EType::Float || Right == EType::Float ? EType::Float : EType::Int;
+	}
+
+	case ENodeType::Ternary:
+	{
+		const EType IfTrue = GetType(Expression.Second);
+		return IfTrue == GetType(Expression.Third) ? IfTrue : EType::Unknown;
+	}
+
+	default:
+		return EType::Unknown;
+	}
+}
+
+/** Returns the position of the first token of an expression in the fragment. */
+int32 FArticyExpressoTranslator::GetPosition(int32 Node) const
+{
+	const FNode& Expression = Nodes[Node];
+	switch (Expression.Type)
+	{
+	case ENodeType::Member:
+	case ENodeType::Call:
+	case ENodeType::Postfix:
+	case ENodeType::Binary:
+	case ENodeType::Assignment:
+	case ENodeType::Ternary:
+		return GetPosition(Expression.First);
+
+	default:
+		return Expression.Token == INDEX_NONE ? 0 : Tokens[Expression.Token].Begin;
+	}
+}
+
+/**
+ * Simplifies an expression: operations on integer and boolean literals are computed, and operands of && and ||
+ * which would never be evaluated are removed, as are the branches of conditional expressions with a literal condition.
+ * Each simplification replaces a node either by a literal or by one of its operands, which binds at least as
+ * strongly, so no parentheses have to be added.
+ *
+ * @param Node The expression.
+ * @return The simplified expression, which may be one of its operands or a new literal.
+ */
+int32 FArticyExpressoTranslator::Fold(int32 Node)
+{
+	switch (Nodes[Node].Type)
+	{
+	case ENodeType::Call:
+	{
+		for (int32 Index = Nodes[Node].ArgumentsBegin; Index < Nodes[Node].ArgumentsBegin + Nodes[Node].NumArguments; ++Index)
+		{
+			const int32 Argument = Fold(CallArguments[Index]);
+			CallArguments[Index] = Argument;
+		}
+		return Node;
+	}
+
+	case ENodeType::Paren:
+	{
+		const int32 Inner = Fold(Nodes[Node].First);
+		Nodes[Node].First = Inner;
+		return Nodes[Inner].bConstant ? Inner : Node;
+	}
+
+	case ENodeType::Unary:
+	{
+		const int32 Operand = Fold(Nodes[Node].First);
+		Nodes[Node].First = Operand;
+
+		const FToken& Operator = Tokens[Nodes[Node].Token];
+		int64 Value;
+		if (IsOperator(Operator, TEXT("!")) && Nodes[Operand].Type == ENodeType::Boolean)
+			return AddConstant(ENodeType::Boolean, !Nodes[Operand].Value);
+		if (IsOperator(Operator, TEXT("-")) && GetInteger(Operand, Value) && FitsInt32(-Value))
+			return AddConstant(ENodeType::Integer, -Value);
+		if (IsOperator(Operator, TEXT("+")) && GetInteger(Operand, Value))
+			return Operand;
+		return Node;
+	}
+
+	case ENodeType::Binary:
+	{
+		const int32 Left = Fold(Nodes[Node].First);
+		const int32 Right = Fold(Nodes[Node].Second);
+		Nodes[Node].First = Left;
+		Nodes[Node].Second = Right;
+
+		const FToken& Operator = Tokens[Nodes[Node].Token];
+		int64 LeftValue, RightValue;
+		if (GetInteger(Left, LeftValue) && GetInteger(Right, RightValue))
+		{
+			if (IsOperator(Operator, TEXT("==")))
+				return AddConstant(ENodeType::Boolean, LeftValue == RightValue);
+			if (IsOperator(Operator, TEXT("!=")))
+				return AddConstant(ENodeType::Boolean, LeftValue != RightValue);
+			if (IsOperator(Operator, TEXT("<")))
+				return AddConstant(ENodeType::Boolean, LeftValue < RightValue);
+			if (IsOperator(Operator, TEXT("<=")))
+				return AddConstant(ENodeType::Boolean, LeftValue <= RightValue);
+			if (IsOperator(Operator, TEXT(">")))
+				return AddConstant(ENodeType::Boolean, LeftValue > RightValue);
+			if (IsOperator(Operator, TEXT(">=")))
+				return AddConstant(ENodeType::Boolean, LeftValue >= RightValue);
+
+			// The operands are int32, so the result is only folded if C++ would compute the same int
+			TOptional<int64> Result;
+			if (IsOperator(Operator, TEXT("+")))
+				Result = LeftValue + RightValue;
+			else if (IsOperator(Operator, TEXT("-")))
+				Result = LeftValue - RightValue;
+			else if (IsOperator(Operator, TEXT("*")))
+				Result = LeftValue * RightValue;
+			else if (IsOperator(Operator, TEXT("/")) && RightValue != 0)
+				Result = LeftValue / RightValue;
+			else if (IsOperator(Operator, TEXT("%")) && RightValue != 0)
+				Result = LeftValue % RightValue;
+
+			if (Result.IsSet() && FitsInt32(Result.GetValue()))
+				return AddConstant(ENodeType::Integer, Result.GetValue());
+			return Node;
+		}
+
+		const bool bLeftLiteral = Nodes[Left].Type == ENodeType::Boolean;
+		const bool bRightLiteral = Nodes[Right].Type == ENodeType::Boolean;
+		if (bLeftLiteral && bRightLiteral && (IsOperator(Operator, TEXT("==")) || IsOperator(Operator, TEXT("!="))))
+			return AddConstant(ENodeType::Boolean, (Nodes[Left].Value == Nodes[Right].Value) == IsOperator(Operator, TEXT("==")));
+
+		// The right operand of && and || is only dropped if it is never evaluated, the left one if it has no side effects;
+		// an operand replacing the whole operation must be a bool already
+		const bool bAnd = IsOperator(Operator, TEXT("&&"));
+		if (bAnd || IsOperator(Operator, TEXT("||")))
+		{
+			// The value which decides the operation on its own, false for && and true for ||
+			const int64 Decisive = bAnd ? 0 : 1;
+			if (bLeftLiteral)
+				return Nodes[Left].Value == Decisive ? Left : (IsBoolean(Right) ? Right : Node);
+			if (bRightLiteral && Nodes[Right].Value == Decisive)
+				return HasSideEffects(Left) ? Node : Right;
+			if (bRightLiteral && IsBoolean(Left))
+				return Left;
+		}
+		return Node;
+	}
+
+	case ENodeType::Assignment:
+	{
+		const int32 Value = Fold(Nodes[Node].Second);
+		Nodes[Node].Second = Value;
+		return Node;
+	}
+
+	case ENodeType::Ternary:
+	{
+		const int32 Condition = Fold(Nodes[Node].First);
+		const int32 IfTrue = Fold(Nodes[Node].Second);
+		const int32 IfFalse = Fold(Nodes[Node].Third);
+		Nodes[Node].First = Condition;
+		Nodes[Node].Second = IfTrue;
+		Nodes[Node].Third = IfFalse;
+
+		if (Nodes[Condition].Type == ENodeType::Boolean)
+			return Nodes[Condition].Value ? IfTrue : IfFalse;
+		return Node;
+	}
+
+	default:
+		return Node;
+	}
+}
+
+/**
+ * Counts the accesses of global variables, and finds the calls of user methods, what may write state and what the
+ * fragment reads and writes.
+ * @param Node The expression.
+ * @param bAssignedTarget Whether the expression is the target of a plain assignment, which does not read it.
+ */
+void FArticyExpressoTranslator::CountAccesses(int32 Node, bool bAssignedTarget)
+{
+	if (Node == INDEX_NONE)
+		return;
+
+	const FNode& Expression = Nodes[Node];
+	if (Expression.Type == ENodeType::Member && Nodes[Expression.First].Type == ENodeType::Identifier)
+	{
+		const FString Variable = GetGlobalVariable(Node);
+		int32& Accesses = GlobalVariableAccesses.FindOrAdd(Variable);
+		if (Accesses++ == 0)
+			GlobalVariables.Add(Variable);
+		if (!bAssignedTarget)
+			ReadVariables.AddUnique(Variable);
+		return;
+	}
+
+	if (Expression.Type == ENodeType::Call)
+	{
+		bCallsUserMethods |= IsUserMethodCall(Node);
+		bWritesState |= !IsReadOnlyCall(Node);
+		bAccessesSeenCounters |= IsBuiltinCall(Node, SeenCounterMethods);
+		bAccessesObjectProperties |= IsBuiltinCall(Node, PropertyMethods);
+		for (int32 Index = 0; Index < Expression.NumArguments; ++Index)
+			CountAccesses(CallArguments[Expression.ArgumentsBegin + Index]);
+	}
+	else if (Expression.Type == ENodeType::Assignment)
+	{
+		bWritesState = true;
+		AddWrite(Expression.First);
+		CountAccesses(Expression.First, IsOperator(Tokens[Expression.Token], TEXT("=")));
+		CountAccesses(Expression.Second);
+		return;
+	}
+	else if (Expression.Type == ENodeType::Postfix)
+	{
+		bWritesState = true;
+		AddWrite(Expression.First);
+	}
+	else if (Expression.Type == ENodeType::Unary)
+	{
+		if (IsOperator(Tokens[Expression.Token], TEXT("++")) || IsOperator(Tokens[Expression.Token], TEXT("--")))
+		{
+			bWritesState = true;
+			AddWrite(Expression.First);
+		}
+	}
+	else if (Expression.Type == ENodeType::Identifier)
+	{
+		bAccessesSeenCounters |= IsIdentifier(Expression.Token, TEXT("seen")) || IsIdentifier(Expression.Token, TEXT("unseen"));
+	}
+
+	CountAccesses(Expression.First);
+	CountAccesses(Expression.Second);
+	CountAccesses(Expression.Third);
+}
+
+/** Adds the target of an assignment, increment or decrement to the written variables if it is a global variable. */
+void FArticyExpressoTranslator::AddWrite(int32 Target)
+{
+	// Increments of parenthesized variables are still writes of the variable
+	while (Target != INDEX_NONE && Nodes[Target].Type == ENodeType::Paren)
+		Target = Nodes[Target].First;
+
+	if (Target != INDEX_NONE && Nodes[Target].Type == ENodeType::Member && Nodes[Nodes[Target].First].Type == ENodeType::Identifier)
+		WrittenVariables.AddUnique(GetGlobalVariable(Target));
+}
+
+/** Returns true if a call is the call of one of the builtin methods, and isn't shadowed by a user method. */
+bool FArticyExpressoTranslator::IsBuiltinCall(int32 Node, TConstArrayView<const TCHAR*> Methods) const
+{
+	const FNode& Callee = Nodes[Nodes[Node].First];
+	if (Callee.Type != ENodeType::Identifier || IsUserMethodCall(Node))
+		return false;
+
+	for (const TCHAR* Method : Methods)
+	{
+		if (IsIdentifier(Callee.Token, Method))
+			return true;
+	}
+	return false;
+}
+
+/** Returns the Namespace.Variable of a member access of an identifier. */
+FString FArticyExpressoTranslator::GetGlobalVariable(int32 Member) const
+{
+	const FToken& Namespace = Tokens[Nodes[Nodes[Member].First].Token];
+	const FToken& Variable = Tokens[Nodes[Member].Token];
+	return FString(Namespace.Length, Fragment + Namespace.Begin) + TEXT(".") + FString(Variable.Length, Fragment + Variable.Begin);
+}
+
+/** Returns true if a call is the call of a user method. */
+bool FArticyExpressoTranslator::IsUserMethodCall(int32 Node) const
+{
+	const FNode& Callee = Nodes[Nodes[Node].First];
+	if (Callee.Type != ENodeType::Identifier)
+		return false;
+
+	const FToken& Name = Tokens[Callee.Token];
+	return UserMethods.Contains(FString(Name.Length, Fragment + Name.Begin));
+}
+
+/** Returns true if a call is the call of a pure user method, or of a builtin method which only reads state and isn't shadowed by a user method. */
+bool FArticyExpressoTranslator::IsReadOnlyCall(int32 Node) const
+{
+	const FNode& Callee = Nodes[Nodes[Node].First];
+	if (Callee.Type != ENodeType::Identifier)
+		return false;
+
+	if (IsUserMethodCall(Node))
+	{
+		const FToken& Name = Tokens[Callee.Token];
+		return PureUserMethods.Contains(FString(Name.Length, Fragment + Name.Begin));
+	}
+
+	for (const TCHAR* Method : ReadOnlyMethods)
+	{
+		if (IsIdentifier(Callee.Token, Method))
+			return true;
+	}
+	return false;
+}
+
+/** Returns true if evaluating an expression may change state, i.e. if it contains a call, an assignment or an increment. */
+bool FArticyExpressoTranslator::HasSideEffects(int32 Node) const
+{
+	const FNode& Expression = Nodes[Node];
+	switch (Expression.Type)
+	{
+	case ENodeType::Call:
+	case ENodeType::Assignment:
+	case ENodeType::Postfix:
+		return true;
+
+	case ENodeType::Unary:
+		return IsOperator(Tokens[Expression.Token], TEXT("++")) || IsOperator(Tokens[Expression.Token], TEXT("--")) || HasSideEffects(Expression.First);
+
+	case ENodeType::Member:
+	case ENodeType::Paren:
+		return HasSideEffects(Expression.First);
+
+	case ENodeType::Binary:
+		return HasSideEffects(Expression.First) || HasSideEffects(Expression.Second);
+
+	case ENodeType::Ternary:
+		return HasSideEffects(Expression.First) || HasSideEffects(Expression.Second) || HasSideEffects(Expression.Third);
+
+	default:
+		return false;
+	}
+}
+
+/** Returns true if an expression results in a bool, rather than e.g. a variable or ExpressoType. */
+bool FArticyExpressoTranslator::IsBoolean(int32 Node) const
+{
+	const FNode& Expression = Nodes[Node];
+	switch (Expression.Type)
+	{
+	case ENodeType::Boolean:
+		return true;
+
+	case ENodeType::Paren:
+		return IsBoolean(Expression.First);
+
+	case ENodeType::Unary:
+		return IsOperator(Tokens[Expression.Token], TEXT("!"));
+
+	case ENodeType::Binary:
+		return GetBinaryPrecedence(Tokens[Expression.Token]) <= MaxBooleanPrecedence;
+
+	case ENodeType::Identifier:
+		return IsIdentifier(Expression.Token, TEXT("seen")) || IsIdentifier(Expression.Token, TEXT("unseen"));
+
+	default:
+		return false;
+	}
+}
+
+/** Returns the value of an integer literal which can be folded. */
+bool FArticyExpressoTranslator::GetInteger(int32 Node, int64& OutValue) const
+{
+	if (Nodes[Node].Type != ENodeType::Integer || !Nodes[Node].bConstant)
+		return false;
+
+	OutValue = Nodes[Node].Value;
+	return true;
+}
+
+/**
+ * Resolves a string literal referring to an object, as getObj would at runtime: "0x" followed by the hex id, the
+ * decimal id, or the technical name of the object.
+ *
+ * Technical names are only resolved if a single object has them, getObj would return any of them otherwise.
+ * Resolved names are recorded, see GetResolvedObjects.
+ *
+ * @param Node The argument.
+ * @param OutId Receives the id of the object.
+ * @return False if the argument is no literal or could not be resolved.
+ */
+bool FArticyExpressoTranslator::ResolveObject(int32 Node, FArticyId& OutId)
+{
+	if (Nodes[Node].Type != ENodeType::String)
+		return false;
+
+	// The literal without its quotes, strings with escapes are left to the runtime
+	const FToken& Literal = Tokens[Nodes[Node].Token];
+	const FString Value(Literal.Length - 2, Fragment + Literal.Begin + 1);
+	if (Value.IsEmpty() || Value.Contains(TEXT("\\")))
+		return false;
+
+	if (Value.StartsWith(TEXT("0x")))
+	{
+		const FString Digits = Value.Mid(2);
+		if (Digits.IsEmpty() || Digits.Len() > 16 || !Algo::AllOf(Digits, FChar::IsHexDigit))
+			return false;
+
+		OutId = ArticyHelpers::HexToUint64(Digits);
+		return true;
+	}
+
+	if (Algo::AllOf(Value, FChar::IsDigit))
+	{
+		if (Value.Len() > 19)
+			return false;
+
+		OutId = FCString::Strtoui64(*Value, nullptr, 10);
+		return true;
+	}
+
+	const FName Name(*Value, FNAME_Find);
+	const FArticyId* Id = Name.IsNone() ? nullptr : ObjectIds.Find(Name);
+	if (!Id || Id->IsNull())
+		return false;
+
+	ResolvedObjects.Add(Name, *Id);
+	OutId = *Id;
+	return true;
+}
+
+/**
+ * Emits the C++ code of an expression.
+ *
+ * Global variables (Namespace.Variable) are emitted as the dereferenced variable, so they can be assigned and
+ * compared, except on the right side of an assignment, where their raw value is used.
+ *
+ * @param Node The expression.
+ * @param bAssignedValue Whether the expression is (part of) the right side of an assignment.
+ */
+void FArticyExpressoTranslator::Emit(int32 Node, bool bAssignedValue)
+{
+	const FNode& Expression = Nodes[Node];
+	switch (Expression.Type)
+	{
+	case ENodeType::Boolean:
+		Code += Expression.Value ? TEXT("true") : TEXT("false");
+		break;
+
+	case ENodeType::Integer:
+		if (Expression.bConstant)
+			Code += LexToString(Expression.Value);
+		else
+			EmitToken(Expression.Token);
+		break;
+
+	case ENodeType::Float:
+		EmitToken(Expression.Token);
+		break;
+
+	case ENodeType::String:
+		Code += TEXT("FString(TEXT(");
+		EmitToken(Expression.Token);
+		Code += TEXT("))");
+		break;
+
+	case ENodeType::Identifier:
+		// "seen" and "unseen" are shorthands for the seen counter of the current object
+		if (IsIdentifier(Expression.Token, TEXT("seen")))
+			Code += TEXT("(getSeenCounter() > 0)");
+		else if (IsIdentifier(Expression.Token, TEXT("unseen")))
+			Code += TEXT("(getSeenCounter() == 0)");
+		else if (IsIdentifier(Expression.Token, TEXT("seenCounter")))
+			Code += TEXT("getSeenCounter()");
+		else
+			EmitToken(Expression.Token);
+		break;
+
+	case ENodeType::Member:
+		if (Nodes[Expression.First].Type == ENodeType::Identifier)
+		{
+			if (const FString* Local = GlobalVariableLocals.Find(GetGlobalVariable(Node)))
+			{
+				Code += *Local;
+				if (bAssignedValue)
+					Code += TEXT(".Get()");
+				break;
+			}
+
+			if (!bAssignedValue)
+				Code += TEXT("(*");
+			EmitToken(Nodes[Expression.First].Token);
+			Code += TEXT("->");
+			EmitToken(Expression.Token);
+			Code += bAssignedValue ? TEXT("->Get()") : TEXT(")");
+		}
+		else
+		{
+			Emit(Expression.First, bAssignedValue);
+			Code += TEXT(".");
+			EmitToken(Expression.Token);
+		}
+		break;
+
+	case ENodeType::Call:
+	{
+		const FNode& Callee = Nodes[Expression.First];
+		if (Callee.Type == ENodeType::Identifier)
+			EmitToken(Callee.Token);
+		else
+			Emit(Expression.First, bAssignedValue);
+
+		// User methods get the provider which was fetched in the prologue
+		const bool bUserMethod = IsUserMethodCall(Node);
+		if (bUserMethod)
+			Code += TEXT("WithProvider(methodProvider");
+		else
+			Code += TEXT("(");
+
+		// Literal property paths of getProp and setProp are resolved once per call site (see ExpressoProperty)
+		const bool bPropertyAccess = Callee.Type == ENodeType::Identifier && (IsIdentifier(Callee.Token, TEXT("getProp")) || IsIdentifier(Callee.Token, TEXT("setProp")));
+
+		// Literal object references of the builtins are resolved to the id of the object (see ExpressoObjectId)
+		const bool bObjectAccess = !bUserMethod && Callee.Type == ENodeType::Identifier
+			&& (IsIdentifier(Callee.Token, TEXT("getObj")) || IsIdentifier(Callee.Token, TEXT("getSeenCounter")) || IsIdentifier(Callee.Token, TEXT("setSeenCounter")));
+
+		for (int32 Index = 0; Index < Expression.NumArguments; ++Index)
+		{
+			if (Index > 0 || bUserMethod)
+				Code += TEXT(", ");
+
+			const int32 Argument = CallArguments[Expression.ArgumentsBegin + Index];
+			FArticyId ObjectId;
+			if (Index == 0 && bObjectAccess && ResolveObject(Argument, ObjectId))
+			{
+				Code += FString::Printf(TEXT("ARTICY_EXPRESSO_OBJECT(0x%016llXull)"), (unsigned long long)ObjectId.Get());
+			}
+			else if (Index == 1 && bPropertyAccess && Nodes[Argument].Type == ENodeType::String)
+			{
+				Code += TEXT("ARTICY_EXPRESSO_PROPERTY(TEXT(");
+				EmitToken(Nodes[Argument].Token);
+				Code += TEXT("))");
+			}
+			else
+			{
+				Emit(Argument, bAssignedValue);
+			}
+		}
+		Code += TEXT(")");
+		break;
+	}
+
+	case ENodeType::Paren:
+		Code += TEXT("(");
+		Emit(Expression.First, bAssignedValue);
+		Code += TEXT(")");
+		break;
+
+	case ENodeType::Unary:
+	{
+		const bool bIncrement = IsOperator(Tokens[Expression.Token], TEXT("++")) || IsOperator(Tokens[Expression.Token], TEXT("--"));
+		EmitToken(Expression.Token);
+
+		// Keep "- -x" from becoming a decrement
+		const int32 OperandBegin = Code.Len();
+		Emit(Expression.First, bIncrement ? false : bAssignedValue);
+		if (Code.Len() > OperandBegin && (Code[OperandBegin] == '-' || Code[OperandBegin] == '+'))
+			Code.InsertAt(OperandBegin, TEXT(' '));
+		break;
+	}
+
+	case ENodeType::Postfix:
+		Emit(Expression.First, false);
+		EmitToken(Expression.Token);
+		break;
+
+	case ENodeType::Binary:
+		Emit(Expression.First, bAssignedValue);
+		Code += TEXT(" ");
+		EmitToken(Expression.Token);
+		Code += TEXT(" ");
+		Emit(Expression.Second, bAssignedValue);
+		break;
+
+	case ENodeType::Assignment:
+		Emit(Expression.First, false);
+		Code += TEXT(" ");
+		EmitToken(Expression.Token);
+		Code += TEXT(" ");
+		Emit(Expression.Second, true);
+		break;
+
+	case ENodeType::Ternary:
+		Emit(Expression.First, bAssignedValue);
+		Code += TEXT(" ? ");
+		Emit(Expression.Second, bAssignedValue);
+		Code += TEXT(" : ");
+		Emit(Expression.Third, bAssignedValue);
+		break;
+	}
+}
+
+bool FArticyExpressoTranslator::IsOperator(const FToken& Token, const TCHAR* Operator) const
+{
+	return Token.Type == ETokenType::Operator && Token.Length == FCString::Strlen(Operator) && FCString::Strncmp(Fragment + Token.Begin, Operator, Token.Length) == 0;
+}
+
+bool FArticyExpressoTranslator::IsIdentifier(int32 Token, const TCHAR* Name) const
+{
+	const FToken& Identifier = Tokens[Token];
+	return Identifier.Type == ETokenType::Identifier && Identifier.Length == FCString::Strlen(Name) && FCString::Strncmp(Fragment + Identifier.Begin, Name, Identifier.Length) == 0;
+}
+
+/** Returns the precedence of a binary operator, or 0 if the token is none. */
+int32 FArticyExpressoTranslator::GetBinaryPrecedence(const FToken& Token) const
+{
+	for (const auto& Binary : BinaryOperators)
+	{
+		if (IsOperator(Token, Binary.Operator))
+			return Binary.Precedence;
+	}
+	return 0;
+}
+
+bool FArticyExpressoTranslator::ConsumeOperator(const TCHAR* Operator)
+{
+	if (!IsOperator(Peek(), Operator))
+		return false;
+
+	++Current;
+	return true;
+}
+
+bool FArticyExpressoTranslator::ExpectOperator(const TCHAR* Operator)
+{
+	if (ConsumeOperator(Operator))
+		return true;
+
+	Fail(Peek().Begin, FString::Printf(TEXT("expected '%s' but found %s"), Operator, *Describe(Peek())));
+	return false;
+}
+
+FString FArticyExpressoTranslator::Describe(const FToken& Token) const
+{
+	if (Token.Type == ETokenType::End)
+		return TEXT("the end of the fragment");
+
+	return TEXT("'") + FString(Token.Length, Fragment + Token.Begin) + TEXT("'");
+}
+
+int32 FArticyExpressoTranslator::AddNode(ENodeType Type, int32 Token, int32 First, int32 Second, int32 Third)
+{
+	FNode& Node = Nodes.AddDefaulted_GetRef();
+	Node.Type = Type;
+	Node.Token = Token;
+	Node.First = First;
+	Node.Second = Second;
+	Node.Third = Third;
+	return Nodes.Num() - 1;
+}
+
+int32 FArticyExpressoTranslator::AddConstant(ENodeType Type, int64 Value)
+{
+	const int32 Node = AddNode(Type, INDEX_NONE);
+	Nodes[Node].Value = Value;
+	Nodes[Node].bConstant = true;
+	return Node;
+}
+
+/**
+ * Records the first error, with its line and column.
+ * @param Position The position of the error in the fragment.
+ * @param Message The description of the error.
+ * @return INDEX_NONE, for the parse functions.
+ */
+int32 FArticyExpressoTranslator::Fail(int32 Position, const FString& Message)
+{
+	if (bFailed)
+		return INDEX_NONE;
+
+	bFailed = true;
+	Error = GetLocation(Position) + TEXT(": ") + Message;
+	return INDEX_NONE;
+}
+
+/**
+ * Adds a diagnostic, with its line and column.
+ * @param Position The position of the problem in the fragment.
+ * @param Message The description of the problem.
+ */
+void FArticyExpressoTranslator::Report(int32 Position, const FString& Message)
+{
+	Diagnostics.Add(GetLocation(Position) + TEXT(": ") + Message);
+}
+
+/** Returns the line and column of a position of the fragment, as "line L, column C". */
+FString FArticyExpressoTranslator::GetLocation(int32 Position) const
+{
+	int32 Line = 1;
+	int32 Column = 1;
+	for (int32 Index = 0; Index < Position && Index < FragmentLength; ++Index)
+	{
+		if (Fragment[Index] == '\n')
+		{
+			++Line;
+			Column = 1;
+		}
+		else
+		{
+			++Column;
+		}
+	}
+
+	return FString::Printf(TEXT("line %d, column %d"), Line, Column);
+}
@@ -0,0 +1,286 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+
+/** Compares FString keys case sensitively, as C++ does, rather than like the default key funcs. */
+template<typename ValueType>
+struct TArticyCaseSensitiveKeyFuncs : TDefaultMapKeyFuncs<FString, ValueType, false>
+{
+	static bool Matches(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+	static uint32 GetKeyHash(const FString& Key) { return FCrc::StrCrc32(*Key); }
+};
+
+/**
+ * The global variables and user methods of the project with their types, which FArticyExpressoTranslator checks
+ * the fragments against, so mistakes are found at import rather than by the compiler in the generated code.
+ */
+struct FArticyExpressoSymbols
+{
+	enum class EType : uint8
+	{
+		Unknown,
+		Bool,
+		Int,
+		Float,
+		String,
+		Object,
+		Void
+	};
+
+	/** An overload of a user method. */
+	struct FMethod
+	{
+		TArray<EType> Parameters;
+		EType Result = EType::Unknown;
+	};
+
+	template<typename ValueType>
+	using TNameMap = TMap<FString, ValueType, FDefaultSetAllocator, TArticyCaseSensitiveKeyFuncs<ValueType>>;
+
+	/** The types of the variables, by namespace and variable name. */
+	TNameMap<TNameMap<EType>> Variables;
+
+	/** The overloads of the user methods, by name. */
+	TNameMap<TArray<FMethod>> Methods;
+
+	/** Returns the type of a parameter or result of a user method, as exported by articy (bool, int, float, string, object or void). */
+	static EType GetType(const FString& Type);
+
+	/** Returns the name of a type, for the diagnostics. */
+	static const TCHAR* GetName(EType Type);
+};
+
+/**
+ * @class FArticyExpressoTranslator
+ * @brief Translates Expresso script fragments into the C++ code of the generated expresso scripts class.
+ *
+ * The fragment is tokenized and parsed into a syntax tree in a single pass, which is then simplified (constant
+ * folding, and removal of operands which are never evaluated) and emitted as C++. Comments are moved to the top,
+ * as they were by the previous, text based translation.
+ *
+ * Global variables which are accessed more than once are bound to a local reference, and the user methods provider
+ * is fetched once, in a prologue which the generated script emits before the code.
+ *
+ * If symbols are given, the fragment is checked against them before it is simplified: unknown global variables,
+ * identifiers and methods, calls with the wrong number of arguments, and operands of the wrong type, as far as
+ * their types are known. The problems are collected as diagnostics (see GetDiagnostics), the fragment is still translated.
+ *
+ * A translator is not thread-safe, but cheap to construct, and keeps its buffers between fragments, so each thread
+ * should use its own.
+ */
+class FArticyExpressoTranslator
+{
+public:
+
+	/**
+	 * @param InUserMethods The names of the user methods, which are called through the methods provider.
+	 * @param InPureUserMethods The names of the user methods which only read state (see UArticyPluginSettings::PureScriptMethods).
+	 * @param InObjectIds The ids of the objects by technical name, to resolve literal object references. Names of several objects map to a null id.
+	 * @param InSymbols The global variables and user methods to check the fragments against, or nullptr to not check them.
+	 */
+	FArticyExpressoTranslator(const TSet<FString>& InUserMethods, const TSet<FString>& InPureUserMethods, const TMap<FName, FArticyId>& InObjectIds, const FArticyExpressoSymbols* InSymbols = nullptr)
+		: UserMethods(InUserMethods), PureUserMethods(InPureUserMethods), ObjectIds(InObjectIds), Symbols(InSymbols) {}
+
+	/**
+	 * Translates a fragment.
+	 * @param InFragment The script fragment.
+	 * @param bIsInstruction Whether the fragment is an instruction (statements) or a condition (a single expression).
+	 * @param OutCode Receives the C++ code.
+	 * @param OutPrologue Receives the statements binding the locals the code uses, to be emitted before it.
+	 * @return False if the fragment is malformed, see GetError.
+	 */
+	bool Translate(const FString& InFragment, bool bIsInstruction, FString& OutCode, FString& OutPrologue);
+
+	/** Returns the reason the last translation failed, with its line and column in the fragment. */
+	const FString& GetError() const { return Error; }
+
+	/** Returns the problems found by checking the last translated fragment against the symbols, each with its line and column. */
+	const TArray<FString>& GetDiagnostics() const { return Diagnostics; }
+
+	/**
+	 * Returns whether the last translated fragment may change state: assign or increment something, or call a method
+	 * other than the builtins and pure user methods, which only read. The flow player explores scripts which don't without a shadow state.
+	 */
+	bool WritesState() const { return bWritesState; }
+
+	/** Returns the global variables (Namespace.Variable) the last translated fragment reads, in the order they are first accessed. */
+	const TArray<FString>& GetReadVariables() const { return ReadVariables; }
+
+	/** Returns the global variables the last translated fragment assigns, increments or decrements. */
+	const TArray<FString>& GetWrittenVariables() const { return WrittenVariables; }
+
+	/** Returns whether the last translated fragment reads or writes seen counters. */
+	bool AccessesSeenCounters() const { return bAccessesSeenCounters; }
+
+	/** Returns whether the last translated fragment reads or writes properties of objects. */
+	bool AccessesObjectProperties() const { return bAccessesObjectProperties; }
+
+	/** Returns whether the last translated fragment calls user methods. */
+	bool CallsUserMethods() const { return bCallsUserMethods; }
+
+	/**
+	 * Returns the technical names the last translated fragment referred to, with the ids they were resolved to.
+	 * The translation is only valid as long as the names still resolve to these ids.
+	 */
+	const TMap<FName, FArticyId>& GetResolvedObjects() const { return ResolvedObjects; }
+
+private:
+
+	enum class ETokenType : uint8
+	{
+		Identifier,
+		Integer,
+		Float,
+		String,
+		Operator,
+		End
+	};
+
+	/** A token, referring to its text in the fragment. */
+	struct FToken
+	{
+		ETokenType Type;
+		int32 Begin;
+		int32 Length;
+	};
+
+	enum class ENodeType : uint8
+	{
+		Boolean,
+		Integer,
+		Float,
+		String,
+		Identifier,
+		Member,
+		Call,
+		Paren,
+		Unary,
+		Postfix,
+		Binary,
+		Assignment,
+		Ternary
+	};
+
+	/** A node of the syntax tree, the operands are indices of other nodes. */
+	struct FNode
+	{
+		ENodeType Type;
+
+		/** The literal, identifier or operator, or the member name of member accesses. INDEX_NONE for folded literals. */
+		int32 Token = INDEX_NONE;
+
+		/** The operands in source order, i.e. the object, callee, condition or target first. */
+		int32 First = INDEX_NONE;
+		int32 Second = INDEX_NONE;
+		int32 Third = INDEX_NONE;
+
+		/** The arguments of calls, a range of CallArguments. */
+		int32 ArgumentsBegin = 0;
+		int32 NumArguments = 0;
+
+		/** The value of boolean and integer literals, if bConstant is set. */
+		int64 Value = 0;
+		bool bConstant = false;
+	};
+
+	bool Tokenize();
+
+	int32 ParseAssignment();
+	int32 ParseTernary();
+	int32 ParseBinary(int32 MinPrecedence);
+	int32 ParseUnary();
+	int32 ParsePostfix();
+	int32 ParsePrimary();
+
+	using EType = FArticyExpressoSymbols::EType;
+
+	void Check(int32 Node);
+	void CheckCall(int32 Node);
+	bool CheckValue(int32 Node);
+	void CheckOperand(int32 Node, int32 Operator, bool bNumeric);
+	void CheckConversion(int32 Node, EType Expected, const FString& Target);
+	EType GetType(int32 Node) const;
+	int32 GetPosition(int32 Node) const;
+	FString GetText(int32 Token) const { return FString(Tokens[Token].Length, Fragment + Tokens[Token].Begin); }
+
+	/** Adds a diagnostic at a position of the fragment. */
+	void Report(int32 Position, const FString& Message);
+
+	/** Returns the line and column of a position of the fragment, as "line L, column C". */
+	FString GetLocation(int32 Position) const;
+
+	int32 Fold(int32 Node);
+	bool HasSideEffects(int32 Node) const;
+	bool IsBoolean(int32 Node) const;
+	bool GetInteger(int32 Node, int64& OutValue) const;
+
+	void CountAccesses(int32 Node, bool bAssignedTarget = false);
+	void AddWrite(int32 Target);
+	bool IsBuiltinCall(int32 Node, TConstArrayView<const TCHAR*> Methods) const;
+	FString GetGlobalVariable(int32 Member) const;
+	bool IsUserMethodCall(int32 Node) const;
+	bool IsReadOnlyCall(int32 Node) const;
+	bool ResolveObject(int32 Node, FArticyId& OutId);
+
+	void Emit(int32 Node, bool bAssignedValue);
+	void EmitToken(int32 Token) { Code.AppendChars(Fragment + Tokens[Token].Begin, Tokens[Token].Length); }
+
+	const FToken& Peek() const { return Tokens[Current]; }
+	bool IsOperator(const FToken& Token, const TCHAR* Operator) const;
+	bool IsIdentifier(int32 Token, const TCHAR* Name) const;
+	int32 GetBinaryPrecedence(const FToken& Token) const;
+	bool ConsumeOperator(const TCHAR* Operator);
+	bool ExpectOperator(const TCHAR* Operator);
+	FString Describe(const FToken& Token) const;
+	int32 AddNode(ENodeType Type, int32 Token, int32 First = INDEX_NONE, int32 Second = INDEX_NONE, int32 Third = INDEX_NONE);
+	int32 AddConstant(ENodeType Type, int64 Value);
+
+	/** Records the first error, at a position of the fragment, and returns INDEX_NONE. */
+	int32 Fail(int32 Position, const FString& Message);
+
+	const TCHAR* Fragment = nullptr;
+	int32 FragmentLength = 0;
+
+	TArray<FToken> Tokens;
+	FString Comments;
+	int32 Current = 0;
+
+	TArray<FNode> Nodes;
+	TArray<int32> CallArguments;
+
+	const TSet<FString>& UserMethods;
+	const TSet<FString>& PureUserMethods;
+	const TMap<FName, FArticyId>& ObjectIds;
+	const FArticyExpressoSymbols* Symbols;
+
+	/** The problems found by Check, see GetDiagnostics. */
+	TArray<FString> Diagnostics;
+
+	/** The technical names resolved by the fragment, see GetResolvedObjects. */
+	TMap<FName, FArticyId> ResolvedObjects;
+
+	/** The global variables (Namespace.Variable) in the order they are first accessed, with their number of accesses. */
+	TArray<FString> GlobalVariables;
+	TMap<FString, int32> GlobalVariableAccesses;
+
+	/** The local references of the global variables which are accessed more than once. */
+	TMap<FString, FString> GlobalVariableLocals;
+
+	/** The global variables the fragment reads and writes, see GetReadVariables and GetWrittenVariables. */
+	TArray<FString> ReadVariables;
+	TArray<FString> WrittenVariables;
+
+	bool bCallsUserMethods = false;
+	bool bWritesState = false;
+	bool bAccessesSeenCounters = false;
+	bool bAccessesObjectProperties = false;
+
+	FString Code;
+	FString Error;
+	bool bFailed = false;
+};
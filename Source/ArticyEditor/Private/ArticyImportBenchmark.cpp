@@ -0,0 +1,750 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyImportBenchmark.h"
+#include "ArticyEditorFunctionLibrary.h"
+#include "ArticyEditorModule.h"
+#include "ArticyHelpers.h"
+#include "ArticyImportData.h"
+#include "ArticyPluginSettings.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/MemoryWriter.h"
+
+const TCHAR* const FArticyImportBenchmark::ProjectName = TEXT("ArticyBenchmark");
+
+namespace
+{
+	/** The cultures of the languages, the first Languages of them are exported. */
+	const TCHAR* const Cultures[][2] =
+	{
+		{ TEXT("en"), TEXT("English") },
+		{ TEXT("de"), TEXT("German") },
+		{ TEXT("fr"), TEXT("French") },
+		{ TEXT("es"), TEXT("Spanish") },
+		{ TEXT("it"), TEXT("Italian") },
+		{ TEXT("ja"), TEXT("Japanese") },
+		{ TEXT("ko"), TEXT("Korean") },
+		{ TEXT("pt-BR"), TEXT("Portuguese (Brazil)") },
+		{ TEXT("ru"), TEXT("Russian") },
+		{ TEXT("zh-Hans"), TEXT("Chinese (Simplified)") },
+		{ TEXT("pl"), TEXT("Polish") },
+		{ TEXT("tr"), TEXT("Turkish") }
+	};
+
+	const TCHAR* const Words[] =
+	{
+		TEXT("the"), TEXT("old"), TEXT("harbor"), TEXT("glows"), TEXT("beneath"), TEXT("a"), TEXT("restless"), TEXT("sky"),
+		TEXT("and"), TEXT("every"), TEXT("sailor"), TEXT("knows"), TEXT("why"), TEXT("lanterns"), TEXT("never"), TEXT("sleep")
+	};
+
+	const int32 VariablesPerNamespace = 10;
+
+	/** The user method the conditions call. */
+	const TCHAR* const CheckMethod = TEXT("BenchmarkCheck");
+
+	/** The first id of the exported objects, pins and folders. */
+	const uint64 FirstId = 0x0100000000000000ull;
+
+	TSharedPtr<FJsonValue> MakeValue(const TSharedRef<FJsonObject>& Object)
+	{
+		return MakeShared<FJsonValueObject>(Object);
+	}
+
+	TSharedRef<FJsonObject> MakeProperty(const TCHAR* Property, const TCHAR* Type, const TCHAR* ItemType = nullptr)
+	{
+		const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+		Json->SetStringField(TEXT("Property"), Property);
+		Json->SetStringField(TEXT("Type"), Type);
+		if (ItemType)
+			Json->SetStringField(TEXT("ItemType"), ItemType);
+		Json->SetStringField(TEXT("DisplayName"), Property);
+		Json->SetStringField(TEXT("Tooltip"), TEXT(""));
+		return Json;
+	}
+
+	/**
+	 * Builds the files of a synthetic export, see FArticyImportBenchmark::WriteExport.
+	 * The random stream is used the same way for every revision, so the revisions only differ in their changes.
+	 */
+	class FSyntheticExport
+	{
+	public:
+
+		FSyntheticExport(const FArticyImportBenchmarkConfig& InConfig, int32 InRevision)
+			: Config(InConfig), Revision(InRevision), Random(InConfig.Seed)
+		{
+		}
+
+		void Build();
+		bool Write(const FString& ArchivePath, const FString& LooseDirectory) const;
+
+	private:
+
+		struct FFile
+		{
+			FString Name;
+			TArray<uint8> Bytes;
+		};
+
+		/** Serializes a file of the export and returns its info for the manifest. */
+		TSharedRef<FJsonObject> AddFile(const FString& Name, const TSharedRef<FJsonObject>& Json);
+
+		FString NextId() { return ArticyHelpers::Uint64ToPaddedHex(NextIdValue++); }
+
+		int32 GetNumNamespaces() const { return FMath::Max(1, Config.GlobalVariables / VariablesPerNamespace); }
+		int32 GetNumVariables(int32 Namespace) const;
+		FString GetVariable(int32 Index, int32 TypeOffset) const;
+
+		FString MakeSentence();
+		FString MakeScript(int32 ScriptIndex, bool bIsInstruction) const;
+
+		TSharedRef<FJsonObject> BuildGlobalVariables() const;
+		TSharedRef<FJsonObject> BuildScriptMethods() const;
+		TSharedRef<FJsonObject> BuildObjectDefinitions() const;
+		TSharedRef<FJsonObject> BuildObjectDefinitionTexts() const;
+		TSharedRef<FJsonObject> BuildPackage(int32 PackageIndex, int32 FirstObject, int32 NumObjects, const FString& FlowId, TArray<TSharedPtr<FJsonValue>>& OutHierarchy);
+		TSharedRef<FJsonObject> MakeTexts(const FString& Text);
+
+		const FArticyImportBenchmarkConfig& Config;
+		const int32 Revision;
+		FRandomStream Random;
+		uint64 NextIdValue = FirstId;
+
+		TArray<FFile> Files;
+	};
+
+	/**
+	 * Variables are typed by their index in the namespace: integers, booleans and strings take turns,
+	 * so every namespace has at least one integer and one boolean.
+	 */
+	int32 FSyntheticExport::GetNumVariables(int32 Namespace) const
+	{
+		const int32 NumNamespaces = GetNumNamespaces();
+		return Config.GlobalVariables / NumNamespaces + (Namespace < Config.GlobalVariables % NumNamespaces ? 1 : 0);
+	}
+
+	/**
+	 * Returns a variable of the export (Namespace.Variable) for a script.
+	 * @param Index Selects the namespace and the variable within it.
+	 * @param TypeOffset 0 for an integer, 1 for a boolean variable.
+	 */
+	FString FSyntheticExport::GetVariable(int32 Index, int32 TypeOffset) const
+	{
+		const int32 Namespace = Index % GetNumNamespaces();
+		const int32 NumOfType = (GetNumVariables(Namespace) - TypeOffset + 2) / 3;
+		const int32 Variable = (Index / GetNumNamespaces()) % NumOfType * 3 + TypeOffset;
+		return FString::Printf(TEXT("Benchmark%d.%s%d"), Namespace, TypeOffset == 0 ? TEXT("Int") : TEXT("Flag"), Variable);
+	}
+
+	FString FSyntheticExport::MakeSentence()
+	{
+		const int32 NumWords = Random.RandRange(4, 16);
+
+		FString Sentence;
+		Sentence.Reserve(NumWords * 8);
+		for (int32 Word = 0; Word < NumWords; ++Word)
+		{
+			if (Word > 0)
+				Sentence += TEXT(' ');
+			Sentence += Words[Random.RandHelper(static_cast<int32>(UE_ARRAY_COUNT(Words)))];
+		}
+		Sentence[0] = FChar::ToUpper(Sentence[0]);
+		return Sentence + TEXT('.');
+	}
+
+	/** Each script is different, so none of them is translated only once for several objects. */
+	FString FSyntheticExport::MakeScript(int32 ScriptIndex, bool bIsInstruction) const
+	{
+		const FString Integer = GetVariable(ScriptIndex, 0);
+		const FString Flag = GetVariable(ScriptIndex + 1, 1);
+
+		if (bIsInstruction)
+		{
+			return FString::Printf(TEXT("%s = %s + %d;\n%s = !%s; // step %d"), *Integer, *Integer, ScriptIndex % 7 + 1, *Flag, *Flag, ScriptIndex);
+		}
+		return FString::Printf(TEXT("%s > %d && (%s || %s(%d))"), *Integer, ScriptIndex, *Flag, CheckMethod, ScriptIndex);
+	}
+
+	TSharedRef<FJsonObject> FSyntheticExport::AddFile(const FString& Name, const TSharedRef<FJsonObject>& Json)
+	{
+		FString Text;
+		const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Text);
+		FJsonSerializer::Serialize(Json, Writer);
+
+		const FTCHARToUTF8 Utf8(*Text);
+		FFile& File = Files.AddDefaulted_GetRef();
+		File.Name = Name;
+		File.Bytes.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+
+		const TSharedRef<FJsonObject> Info = MakeShared<FJsonObject>();
+		Info->SetStringField(TEXT("FileName"), Name);
+		Info->SetStringField(TEXT("Hash"), FMD5::HashBytes(File.Bytes.GetData(), File.Bytes.Num()));
+		return Info;
+	}
+
+	TSharedRef<FJsonObject> FSyntheticExport::BuildGlobalVariables() const
+	{
+		static const TCHAR* const Types[] = { TEXT("Integer"), TEXT("Boolean"), TEXT("String") };
+		static const TCHAR* const Prefixes[] = { TEXT("Int"), TEXT("Flag"), TEXT("Text") };
+
+		TArray<TSharedPtr<FJsonValue>> Namespaces;
+		for (int32 Namespace = 0; Namespace < GetNumNamespaces(); ++Namespace)
+		{
+			TArray<TSharedPtr<FJsonValue>> Variables;
+			for (int32 Variable = 0; Variable < GetNumVariables(Namespace); ++Variable)
+			{
+				const int32 Type = Variable % 3;
+				const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+				Json->SetStringField(TEXT("Variable"), FString::Printf(TEXT("%s%d"), Prefixes[Type], Variable));
+				Json->SetStringField(TEXT("Type"), Types[Type]);
+				switch (Type)
+				{
+				case 0: Json->SetNumberField(TEXT("Value"), Variable); break;
+				case 1: Json->SetBoolField(TEXT("Value"), Variable % 2 == 0); break;
+				default: Json->SetStringField(TEXT("Value"), FString::Printf(TEXT("Value %d"), Variable)); break;
+				}
+				Json->SetStringField(TEXT("Description"), TEXT(""));
+				Variables.Add(MakeValue(Json));
+			}
+
+			const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetStringField(TEXT("Namespace"), FString::Printf(TEXT("Benchmark%d"), Namespace));
+			Json->SetStringField(TEXT("Description"), TEXT(""));
+			Json->SetArrayField(TEXT("Variables"), Variables);
+			Namespaces.Add(MakeValue(Json));
+		}
+
+		const TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetArrayField(JSON_SECTION_GLOBALVARS, Namespaces);
+		return Root;
+	}
+
+	TSharedRef<FJsonObject> FSyntheticExport::BuildScriptMethods() const
+	{
+		const TSharedRef<FJsonObject> Parameter = MakeShared<FJsonObject>();
+		Parameter->SetStringField(TEXT("Param"), TEXT("Value"));
+		Parameter->SetStringField(TEXT("Type"), TEXT("int"));
+
+		const TSharedRef<FJsonObject> Method = MakeShared<FJsonObject>();
+		Method->SetStringField(TEXT("Name"), CheckMethod);
+		Method->SetStringField(TEXT("ReturnType"), TEXT("bool"));
+		Method->SetArrayField(TEXT("Parameters"), { MakeValue(Parameter) });
+
+		const TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetArrayField(JSON_SECTION_SCRIPTMEETHODS, { MakeValue(Method) });
+		return Root;
+	}
+
+	/** The flow types of the export, with the properties articy:draft exports for them. */
+	TSharedRef<FJsonObject> FSyntheticExport::BuildObjectDefinitions() const
+	{
+		const auto MakeType = [](const TCHAR* Type, const TCHAR* ExpressionType, std::initializer_list<const TCHAR*> Strings)
+		{
+			TArray<TSharedPtr<FJsonValue>> Properties;
+			Properties.Add(MakeValue(MakeProperty(TEXT("TechnicalName"), TEXT("string"))));
+			Properties.Add(MakeValue(MakeProperty(TEXT("Id"), TEXT("id"))));
+			Properties.Add(MakeValue(MakeProperty(TEXT("Parent"), TEXT("id"))));
+			for (const TCHAR* String : Strings)
+				Properties.Add(MakeValue(MakeProperty(String, TEXT("string"))));
+			if (ExpressionType)
+				Properties.Add(MakeValue(MakeProperty(TEXT("Expression"), ExpressionType)));
+			Properties.Add(MakeValue(MakeProperty(TEXT("Position"), TEXT("point"))));
+			Properties.Add(MakeValue(MakeProperty(TEXT("InputPins"), TEXT("array"), TEXT("InputPin"))));
+			Properties.Add(MakeValue(MakeProperty(TEXT("OutputPins"), TEXT("array"), TEXT("OutputPin"))));
+
+			const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetStringField(TEXT("Type"), Type);
+			Json->SetStringField(TEXT("Class"), Type);
+			Json->SetArrayField(TEXT("Properties"), Properties);
+			return MakeValue(Json);
+		};
+
+		TArray<TSharedPtr<FJsonValue>> Types;
+		Types.Add(MakeType(TEXT("FlowFragment"), nullptr, { TEXT("DisplayName"), TEXT("Text") }));
+		Types.Add(MakeType(TEXT("DialogueFragment"), nullptr, { TEXT("Text"), TEXT("MenuText"), TEXT("StageDirections") }));
+		Types.Add(MakeType(TEXT("Instruction"), TEXT("script_instruction"), { TEXT("Text") }));
+		Types.Add(MakeType(TEXT("Condition"), TEXT("script_condition"), { TEXT("Text") }));
+
+		const TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetArrayField(JSON_SECTION_OBJECTDEFS, Types);
+		return Root;
+	}
+
+	/** The display names of the properties, which are localized like the texts of the objects. */
+	TSharedRef<FJsonObject> FSyntheticExport::BuildObjectDefinitionTexts() const
+	{
+		static const TCHAR* const DisplayNames[] =
+		{
+			TEXT("TechnicalName"), TEXT("Id"), TEXT("Parent"), TEXT("DisplayName"), TEXT("Text"), TEXT("MenuText"),
+			TEXT("StageDirections"), TEXT("Expression"), TEXT("Position"), TEXT("InputPins"), TEXT("OutputPins")
+		};
+
+		const TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		for (const TCHAR* DisplayName : DisplayNames)
+		{
+			const TSharedRef<FJsonObject> Texts = MakeShared<FJsonObject>();
+			Texts->SetStringField(TEXT("Context"), TEXT(""));
+			for (int32 Language = 0; Language < Config.Languages; ++Language)
+			{
+				const TSharedRef<FJsonObject> Text = MakeShared<FJsonObject>();
+				Text->SetStringField(TEXT("Text"), Language == 0 ? FString(DisplayName) : FString::Printf(TEXT("[%s] %s"), Cultures[Language][0], DisplayName));
+				Text->SetStringField(TEXT("VoAsset"), TEXT(""));
+				Texts->SetObjectField(Cultures[Language][0], Text);
+			}
+			Root->SetObjectField(DisplayName, Texts);
+		}
+		return Root;
+	}
+
+	/** Returns the texts of a loca key, the revision changes the texts of the first package. */
+	TSharedRef<FJsonObject> FSyntheticExport::MakeTexts(const FString& Text)
+	{
+		const TSharedRef<FJsonObject> Texts = MakeShared<FJsonObject>();
+		Texts->SetStringField(TEXT("Context"), TEXT(""));
+		for (int32 Language = 0; Language < Config.Languages; ++Language)
+		{
+			const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetStringField(TEXT("Text"), Language == 0 ? Text : FString::Printf(TEXT("[%s] %s"), Cultures[Language][0], *Text));
+			Json->SetStringField(TEXT("VoAsset"), TEXT(""));
+			Texts->SetObjectField(Cultures[Language][0], Json);
+		}
+		return Texts;
+	}
+
+	/**
+	 * Builds a package: a flow fragment containing a chain of dialogue fragments, instructions and conditions.
+	 * @param FlowId The id of the flow node, the parent of the flow fragment.
+	 * @param OutHierarchy Receives the hierarchy node of the package.
+	 * @return The package entry of the manifest.
+	 */
+	TSharedRef<FJsonObject> FSyntheticExport::BuildPackage(int32 PackageIndex, int32 FirstObject, int32 NumObjects, const FString& FlowId, TArray<TSharedPtr<FJsonValue>>& OutHierarchy)
+	{
+		const bool bChanged = Revision > 0 && PackageIndex == 0;
+
+		TArray<TSharedPtr<FJsonValue>> Objects;
+		TArray<TSharedPtr<FJsonValue>> Children;
+		const TSharedRef<FJsonObject> Texts = MakeShared<FJsonObject>();
+		FString Scripts;
+
+		const auto AddText = [&](const TSharedRef<FJsonObject>& Properties, const FString& TechnicalName, const TCHAR* Property)
+		{
+			const FString LocaKey = TechnicalName + TEXT(".") + Property;
+			const FString Sentence = MakeSentence();
+			Texts->SetObjectField(LocaKey, MakeTexts(bChanged ? Sentence + TEXT(" (revised)") : Sentence));
+			Properties->SetStringField(Property, LocaKey);
+		};
+
+		const auto MakePins = [&](const FString& PinId, const FString& Owner, const FString& Target, const FString& TargetPin)
+		{
+			const TSharedRef<FJsonObject> Pin = MakeShared<FJsonObject>();
+			Pin->SetStringField(TEXT("Text"), TEXT(""));
+			Pin->SetStringField(TEXT("Id"), PinId);
+			Pin->SetStringField(TEXT("Owner"), Owner);
+
+			TArray<TSharedPtr<FJsonValue>> Connections;
+			if (!Target.IsEmpty())
+			{
+				const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+				Json->SetStringField(TEXT("Label"), TEXT(""));
+				Json->SetStringField(TEXT("TargetPin"), TargetPin);
+				Json->SetStringField(TEXT("Target"), Target);
+				Connections.Add(MakeValue(Json));
+			}
+			Pin->SetArrayField(TEXT("Connections"), Connections);
+			return TArray<TSharedPtr<FJsonValue>>{ MakeValue(Pin) };
+		};
+
+		const auto AddObject = [&](const TCHAR* Type, const TCHAR* Prefix, const FString& Parent, TArray<TSharedPtr<FJsonValue>>& OutSiblings)
+		{
+			const FString Id = NextId();
+			const FString TechnicalName = FString::Printf(TEXT("%s_%s"), Prefix, *Id.RightChop(10));
+
+			const TSharedRef<FJsonObject> Position = MakeShared<FJsonObject>();
+			Position->SetNumberField(TEXT("x"), Random.RandRange(0, 10000) + (bChanged ? 10 : 0));
+			Position->SetNumberField(TEXT("y"), Random.RandRange(0, 10000));
+
+			const TSharedRef<FJsonObject> Properties = MakeShared<FJsonObject>();
+			Properties->SetStringField(TEXT("TechnicalName"), TechnicalName);
+			Properties->SetStringField(TEXT("Id"), Id);
+			Properties->SetStringField(TEXT("Parent"), Parent);
+			Properties->SetObjectField(TEXT("Position"), Position);
+
+			const TSharedRef<FJsonObject> Model = MakeShared<FJsonObject>();
+			Model->SetStringField(TEXT("Type"), Type);
+			Model->SetStringField(TEXT("AssetRef"), TEXT(""));
+			Model->SetStringField(TEXT("Category"), TEXT(""));
+			Model->SetObjectField(TEXT("Properties"), Properties);
+			Objects.Add(MakeValue(Model));
+
+			const TSharedRef<FJsonObject> Node = MakeShared<FJsonObject>();
+			Node->SetStringField(TEXT("Id"), Id);
+			Node->SetStringField(TEXT("TechnicalName"), TechnicalName);
+			Node->SetStringField(TEXT("Type"), Type);
+			OutSiblings.Add(MakeValue(Node));
+
+			return TTuple<FString, FString, TSharedRef<FJsonObject>, TSharedRef<FJsonObject>>(Id, TechnicalName, Properties, Node);
+		};
+
+		// The flow fragment which contains the objects of the package
+		const auto Fragment = AddObject(TEXT("FlowFragment"), TEXT("FFr"), FlowId, OutHierarchy);
+		AddText(Fragment.Get<2>(), Fragment.Get<1>(), TEXT("DisplayName"));
+		AddText(Fragment.Get<2>(), Fragment.Get<1>(), TEXT("Text"));
+		Fragment.Get<2>()->SetArrayField(TEXT("InputPins"), MakePins(NextId(), Fragment.Get<0>(), FString(), FString()));
+		Fragment.Get<2>()->SetArrayField(TEXT("OutputPins"), MakePins(NextId(), Fragment.Get<0>(), FString(), FString()));
+
+		// The objects are chained, each output pin connects to the input pin of the next object
+		TArray<TSharedRef<FJsonObject>> ChainProperties;
+		TArray<FString> ChainIds;
+		TArray<FString> ChainInputPins;
+		for (int32 Object = FirstObject; Object < FirstObject + NumObjects; ++Object)
+		{
+			// The scripts are spread evenly over the objects, instructions and conditions take turns
+			const int32 ScriptIndex = static_cast<int32>(static_cast<int64>(Object) * Config.Scripts / Config.Objects);
+			const bool bHasScript = static_cast<int64>(Object + 1) * Config.Scripts / Config.Objects > ScriptIndex;
+			const bool bIsInstruction = ScriptIndex % 2 == 0;
+
+			const TCHAR* Type = !bHasScript ? TEXT("DialogueFragment") : bIsInstruction ? TEXT("Instruction") : TEXT("Condition");
+			const TCHAR* Prefix = !bHasScript ? TEXT("DFr") : bIsInstruction ? TEXT("Ins") : TEXT("Cnd");
+			const auto Entry = AddObject(Type, Prefix, Fragment.Get<0>(), Children);
+
+			const TSharedRef<FJsonObject>& Properties = Entry.Get<2>();
+			AddText(Properties, Entry.Get<1>(), TEXT("Text"));
+			if (bHasScript)
+			{
+				const FString Script = MakeScript(ScriptIndex, bIsInstruction);
+				Properties->SetStringField(TEXT("Expression"), Script);
+				Scripts += Script;
+			}
+			else
+			{
+				AddText(Properties, Entry.Get<1>(), TEXT("MenuText"));
+				Properties->SetStringField(TEXT("StageDirections"), TEXT(""));
+			}
+
+			ChainProperties.Add(Properties);
+			ChainIds.Add(Entry.Get<0>());
+			ChainInputPins.Add(NextId());
+		}
+
+		for (int32 Link = 0; Link < ChainIds.Num(); ++Link)
+		{
+			const bool bIsLast = Link + 1 == ChainIds.Num();
+			ChainProperties[Link]->SetArrayField(TEXT("InputPins"), MakePins(ChainInputPins[Link], ChainIds[Link], FString(), FString()));
+			ChainProperties[Link]->SetArrayField(TEXT("OutputPins"), MakePins(NextId(), ChainIds[Link],
+				bIsLast ? FString() : ChainIds[Link + 1], bIsLast ? FString() : ChainInputPins[Link + 1]));
+		}
+		Fragment.Get<3>()->SetArrayField(TEXT("Children"), Children);
+
+		const TSharedRef<FJsonObject> ObjectsRoot = MakeShared<FJsonObject>();
+		ObjectsRoot->SetArrayField(JSON_SUBSECTION_OBJECTS, Objects);
+
+		const FString FilePrefix = FString::Printf(TEXT("package_%d"), PackageIndex);
+		const TSharedRef<FJsonObject> PackageFiles = MakeShared<FJsonObject>();
+		PackageFiles->SetObjectField(JSON_SUBSECTION_OBJECTS, AddFile(FilePrefix + TEXT("_objects.json"), ObjectsRoot));
+		PackageFiles->SetObjectField(JSON_SUBSECTION_TEXTS, AddFile(FilePrefix + TEXT("_localization.json"), Texts));
+
+		const FTCHARToUTF8 ScriptsUtf8(*Scripts);
+		const TSharedRef<FJsonObject> Package = MakeShared<FJsonObject>();
+		Package->SetStringField(TEXT("Id"), ArticyHelpers::Uint64ToPaddedHex(FirstId - 1 - PackageIndex));
+		Package->SetStringField(TEXT("Name"), FString::Printf(TEXT("Benchmark Package %d"), PackageIndex));
+		Package->SetStringField(TEXT("Description"), TEXT(""));
+		Package->SetBoolField(TEXT("IsDefaultPackage"), PackageIndex == 0);
+		Package->SetBoolField(TEXT("IsIncluded"), true);
+		Package->SetStringField(TEXT("ScriptFragmentHash"), FMD5::HashBytes(reinterpret_cast<const uint8*>(ScriptsUtf8.Get()), ScriptsUtf8.Length()));
+		Package->SetObjectField(TEXT("Files"), PackageFiles);
+		return Package;
+	}
+
+	void FSyntheticExport::Build()
+	{
+		const TSharedRef<FJsonObject> Settings = MakeShared<FJsonObject>();
+		Settings->SetStringField(TEXT("set_IncludedNodes"), TEXT("Settings, Project, GlobalVariables, ObjectDefinitions, Packages, ScriptMethods, Hierarchy"));
+		Settings->SetStringField(TEXT("RuleSetId"), TEXT("0x00000000B3C4D5E6"));
+		Settings->SetBoolField(TEXT("set_Localization"), true);
+		Settings->SetStringField(TEXT("set_TextFormatter"), TEXT(""));
+		Settings->SetBoolField(TEXT("set_UseScriptSupport"), true);
+		Settings->SetStringField(TEXT("ExportVersion"), TEXT("1.0"));
+
+		const TSharedRef<FJsonObject> Project = MakeShared<FJsonObject>();
+		Project->SetStringField(TEXT("Guid"), TEXT("a7c1f0b4-0000-4e6b-9d2a-8f3b5c6d7e80"));
+		Project->SetStringField(TEXT("TechnicalName"), FArticyImportBenchmark::ProjectName);
+		Project->SetStringField(TEXT("Name"), TEXT("Articy Import Benchmark"));
+		Project->SetStringField(TEXT("DetailName"), TEXT(""));
+
+		TArray<TSharedPtr<FJsonValue>> Languages;
+		for (int32 Language = 0; Language < Config.Languages; ++Language)
+		{
+			const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetStringField(TEXT("CultureName"), Cultures[Language][0]);
+			Json->SetStringField(TEXT("ArticyLanguageId"), Cultures[Language][0]);
+			Json->SetStringField(TEXT("LanguageName"), Cultures[Language][1]);
+			Json->SetBoolField(TEXT("IsVoiceOver"), false);
+			Languages.Add(MakeValue(Json));
+		}
+
+		const TSharedRef<FJsonObject> ObjectDefinitions = MakeShared<FJsonObject>();
+		ObjectDefinitions->SetObjectField(JSON_SUBSECTION_TYPES, AddFile(TEXT("object_definitions.json"), BuildObjectDefinitions()));
+		ObjectDefinitions->SetObjectField(JSON_SUBSECTION_TEXTS, AddFile(TEXT("object_definitions_localization.json"), BuildObjectDefinitionTexts()));
+
+		const FString FlowId = ArticyHelpers::Uint64ToPaddedHex(FirstId - 1 - Config.Packages);
+		TArray<TSharedPtr<FJsonValue>> Packages;
+		TArray<TSharedPtr<FJsonValue>> PackageNodes;
+		for (int32 Package = 0; Package < Config.Packages; ++Package)
+		{
+			const int32 FirstObject = static_cast<int32>(static_cast<int64>(Package) * Config.Objects / Config.Packages);
+			const int32 EndObject = static_cast<int32>(static_cast<int64>(Package + 1) * Config.Objects / Config.Packages);
+			Packages.Add(MakeValue(BuildPackage(Package, FirstObject, EndObject - FirstObject, FlowId, PackageNodes)));
+		}
+
+		const TSharedRef<FJsonObject> Flow = MakeShared<FJsonObject>();
+		Flow->SetStringField(TEXT("Id"), FlowId);
+		Flow->SetStringField(TEXT("TechnicalName"), TEXT("Flow"));
+		Flow->SetStringField(TEXT("Type"), TEXT("Flow"));
+		Flow->SetArrayField(TEXT("Children"), PackageNodes);
+
+		const TSharedRef<FJsonObject> Hierarchy = MakeShared<FJsonObject>();
+		Hierarchy->SetStringField(TEXT("Id"), ArticyHelpers::Uint64ToPaddedHex(FirstId - 2 - Config.Packages));
+		Hierarchy->SetStringField(TEXT("TechnicalName"), FArticyImportBenchmark::ProjectName);
+		Hierarchy->SetStringField(TEXT("Type"), TEXT("Project"));
+		Hierarchy->SetArrayField(TEXT("Children"), { MakeValue(Flow) });
+
+		const TSharedRef<FJsonObject> Manifest = MakeShared<FJsonObject>();
+		Manifest->SetObjectField(JSON_SECTION_SETTINGS, Settings);
+		Manifest->SetObjectField(JSON_SECTION_PROJECT, Project);
+		Manifest->SetArrayField(JSON_SECTION_LANGUAGES, Languages);
+		Manifest->SetObjectField(JSON_SECTION_GLOBALVARS, AddFile(TEXT("global_variables.json"), BuildGlobalVariables()));
+		Manifest->SetObjectField(JSON_SECTION_SCRIPTMEETHODS, AddFile(TEXT("script_methods.json"), BuildScriptMethods()));
+		Manifest->SetObjectField(JSON_SECTION_OBJECTDEFS, ObjectDefinitions);
+		Manifest->SetArrayField(JSON_SECTION_PACKAGES, Packages);
+		Manifest->SetObjectField(JSON_SECTION_HIERARCHY, AddFile(TEXT("hierarchy.json"), Hierarchy));
+		AddFile(TEXT("manifest.json"), Manifest);
+	}
+
+	/** Writes the files into an archive in the format UArticyArchiveReader reads, and optionally as loose files. */
+	bool FSyntheticExport::Write(const FString& ArchivePath, const FString& LooseDirectory) const
+	{
+		TArray<uint8> Archive;
+		FMemoryWriter Writer(Archive);
+
+		uint8 Magic[4] = { 'A', 'D', 'F', 'A' };
+		uint8 Version = 1;
+		uint8 Pad = 0;
+		uint16 Flags = 0;
+		int32 NumberOfFiles = Files.Num();
+		uint64 FileDictionaryPos = 0;
+		Writer.Serialize(Magic, sizeof(Magic));
+		Writer << Version << Pad << Flags << NumberOfFiles;
+		const int64 FileDictionaryPosOffset = Writer.Tell();
+		Writer << FileDictionaryPos;
+
+		TArray<int64> StartPositions;
+		TArray<int64> PackedLengths;
+		for (const FFile& File : Files)
+		{
+			StartPositions.Add(Writer.Tell());
+
+			TArray<uint8> Compressed;
+			if (Config.bCompress)
+			{
+				int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, File.Bytes.Num());
+				Compressed.SetNumUninitialized(CompressedSize);
+				// Entries which do not get smaller are stored, the reader tells them apart by their lengths
+				if (FCompression::CompressMemory(NAME_Zlib, Compressed.GetData(), CompressedSize, File.Bytes.GetData(), File.Bytes.Num())
+					&& CompressedSize < File.Bytes.Num())
+				{
+					Compressed.SetNum(CompressedSize);
+				}
+				else
+				{
+					Compressed.Reset();
+				}
+			}
+
+			const TArray<uint8>& Packed = Compressed.Num() > 0 ? Compressed : File.Bytes;
+			Writer.Serialize(const_cast<uint8*>(Packed.GetData()), Packed.Num());
+			PackedLengths.Add(Packed.Num());
+		}
+
+		FileDictionaryPos = Writer.Tell();
+		for (int32 Index = 0; Index < Files.Num(); ++Index)
+		{
+			FTCHARToUTF8 Name(*Files[Index].Name);
+			uint64 FileStartPos = StartPositions[Index];
+			int64 UnpackedLength = Files[Index].Bytes.Num();
+			int64 PackedLength = PackedLengths[Index];
+			int16 EntryFlags = 0;
+			int16 LengthOfName = static_cast<int16>(Name.Length());
+			Writer << FileStartPos << UnpackedLength << PackedLength << EntryFlags << LengthOfName;
+			Writer.Serialize(const_cast<ANSICHAR*>(Name.Get()), Name.Length());
+		}
+
+		Writer.Seek(FileDictionaryPosOffset);
+		Writer << FileDictionaryPos;
+
+		if (!FFileHelper::SaveArrayToFile(Archive, *ArchivePath))
+		{
+			UE_LOG(LogArticyEditor, Error, TEXT("Could not write the benchmark export to '%s'."), *ArchivePath);
+			return false;
+		}
+
+		if (LooseDirectory.IsEmpty())
+			return true;
+
+		for (const FFile& File : Files)
+		{
+			const FString FilePath = LooseDirectory / File.Name;
+			if (!FFileHelper::SaveArrayToFile(File.Bytes, *FilePath))
+			{
+				UE_LOG(LogArticyEditor, Error, TEXT("Could not write the benchmark export file '%s'."), *FilePath);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Returns the absolute path of the articy directory of the plugin settings, like GenerateImportDataAsset. */
+	FString GetArticyDirectory()
+	{
+		FString ArticyDirectory = GetDefault<UArticyPluginSettings>()->ArticyDirectory.Path;
+		ArticyDirectory.RemoveFromStart(TEXT("/Game"));
+		ArticyDirectory.RemoveFromStart(TEXT("/"));
+		return IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*(FPaths::ProjectContentDir() + ArticyDirectory));
+	}
+}
+
+/**
+ * Reads the configuration from the command line of the commandlet.
+ *
+ * @param Params The command line parameters.
+ * @return The configuration, with the defaults for the parameters which are not given.
+ */
+FArticyImportBenchmarkConfig FArticyImportBenchmarkConfig::FromCommandLine(const TCHAR* Params)
+{
+	FArticyImportBenchmarkConfig Config;
+	FParse::Value(Params, TEXT("Objects="), Config.Objects);
+	FParse::Value(Params, TEXT("Packages="), Config.Packages);
+	FParse::Value(Params, TEXT("Scripts="), Config.Scripts);
+	FParse::Value(Params, TEXT("Languages="), Config.Languages);
+	FParse::Value(Params, TEXT("GlobalVariables="), Config.GlobalVariables);
+	FParse::Value(Params, TEXT("Seed="), Config.Seed);
+	Config.bCompress = FParse::Param(Params, TEXT("Compress"));
+
+	Config.Packages = ArticyHelpers::ClampParameter(TEXT("Benchmark"), TEXT("Packages"), Config.Packages, 1, 1000);
+	Config.Objects = ArticyHelpers::ClampParameter(TEXT("Benchmark"), TEXT("Objects"), Config.Objects, Config.Packages, 10000000);
+	Config.Scripts = ArticyHelpers::ClampParameter(TEXT("Benchmark"), TEXT("Scripts"), Config.Scripts, 0, Config.Objects);
+	Config.Languages = ArticyHelpers::ClampParameter(TEXT("Benchmark"), TEXT("Languages"), Config.Languages, 1, static_cast<int32>(UE_ARRAY_COUNT(Cultures)));
+	// The scripts need an integer and a boolean variable in every namespace
+	Config.GlobalVariables = ArticyHelpers::ClampParameter(TEXT("Benchmark"), TEXT("GlobalVariables"), Config.GlobalVariables, 2, 100000);
+	return Config;
+}
+
+/** Returns the configuration for the benchmark results. */
+TSharedRef<FJsonObject> FArticyImportBenchmarkConfig::ToJson() const
+{
+	const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetNumberField(TEXT("Objects"), Objects);
+	Json->SetNumberField(TEXT("Packages"), Packages);
+	Json->SetNumberField(TEXT("Scripts"), Scripts);
+	Json->SetNumberField(TEXT("Languages"), Languages);
+	Json->SetNumberField(TEXT("GlobalVariables"), GlobalVariables);
+	Json->SetNumberField(TEXT("Seed"), Seed);
+	Json->SetBoolField(TEXT("Compress"), bCompress);
+	return Json;
+}
+
+/**
+ * Writes a synthetic export.
+ *
+ * @param Config The size of the export.
+ * @param Revision 0 for the export of the full import, 1 for the export with changes in the first package.
+ * @param ArchivePath The .articyue archive to write.
+ * @param LooseDirectory The directory to write the files of the archive to as loose JSON, or empty.
+ * @return False if a file could not be written.
+ */
+bool FArticyImportBenchmark::WriteExport(const FArticyImportBenchmarkConfig& Config, int32 Revision, const FString& ArchivePath, const FString& LooseDirectory)
+{
+	FSyntheticExport Export(Config, Revision);
+	Export.Build();
+	return Export.Write(ArchivePath, LooseDirectory);
+}
+
+/**
+ * Runs the full and the incremental import of the synthetic export, and writes the results.
+ *
+ * The generated code only depends on the configuration, so it has to be compiled once per configuration: if it
+ * changed, the commandlet cannot hot reload it, and the project has to be built before the benchmark is run again.
+ *
+ * @param Config The size of the export.
+ * @return The exit code of the commandlet, 0 if both imports succeeded.
+ */
+int32 FArticyImportBenchmark::Run(const FArticyImportBenchmarkConfig& Config)
+{
+	const FString ArticyDirectory = GetArticyDirectory();
+	const FString ArchiveName = FString(ProjectName) + TEXT(".articyue");
+
+	// The benchmark replaces the import data of the project, and reimports read the archive the import data was
+	// created from, so the project must not contain another articy export
+	TArray<FString> ArchiveFiles;
+	IFileManager::Get().FindFiles(ArchiveFiles, *ArticyDirectory, TEXT("articyue"));
+	ArchiveFiles.Remove(ArchiveName);
+
+	const TWeakObjectPtr<UArticyImportData> ImportData = UArticyImportData::GetImportData();
+	if (ArchiveFiles.Num() > 0 || (ImportData.IsValid() && ImportData->GetProject().TechnicalName != ProjectName))
+	{
+		UE_LOG(LogArticyEditor, Error, TEXT("The import benchmark replaces the articy import data of the project, run it in a project without an articy export."));
+		return 1;
+	}
+
+	const FString ResultsDirectory = ArticyHelpers::GetSavedPath(TEXT(""), TEXT("Benchmark"));
+	const FString ArchivePath = ArticyDirectory / ArchiveName;
+
+	UE_LOG(LogArticyEditor, Display, TEXT("Running the import benchmark with %d objects in %d packages, %d scripts, %d languages and %d global variables."),
+		Config.Objects, Config.Packages, Config.Scripts, Config.Languages, Config.GlobalVariables);
+
+	TArray<TSharedPtr<FJsonValue>> Runs;
+	const auto RunImport = [&](const TCHAR* RunName, int32 Revision, bool bFullReimport)
+	{
+		if (!WriteExport(Config, Revision, ArchivePath, ResultsDirectory / RunName))
+			return false;
+
+		FArticyBatchImportOptions Options;
+		Options.bFullReimport = bFullReimport;
+		const FArticyBatchImportResult Result = FArticyEditorFunctionLibrary::BatchImport(Options);
+
+		const TSharedRef<FJsonObject> Run = MakeShared<FJsonObject>();
+		Run->SetStringField(TEXT("Name"), RunName);
+		Run->SetObjectField(TEXT("Import"), Result.ToJson());
+		Runs.Add(MakeShared<FJsonValueObject>(Run));
+
+		if (Result.bNeedsCompile)
+		{
+			UE_LOG(LogArticyEditor, Error, TEXT("The generated code of the benchmark changed and cannot be compiled by the commandlet. Build the project and run the benchmark again."));
+		}
+		else
+		{
+			UE_LOG(LogArticyEditor, Display, TEXT("Benchmark %s import: %.1f ms"), RunName, Result.Seconds * 1000.0);
+		}
+		return Result.bSucceeded;
+	};
+
+	const bool bSucceeded = RunImport(TEXT("Full"), 0, true) && RunImport(TEXT("Incremental"), 1, false);
+
+	const TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+	Results->SetObjectField(TEXT("Config"), Config.ToJson());
+	Results->SetBoolField(TEXT("Succeeded"), bSucceeded);
+	Results->SetArrayField(TEXT("Runs"), Runs);
+
+	ArticyHelpers::SaveJsonReport(Results, ResultsDirectory / TEXT("BenchmarkResults.json"), TEXT("benchmark results"));
+
+	return bSucceeded ? 0 : 1;
+}
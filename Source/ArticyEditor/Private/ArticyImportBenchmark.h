@@ -0,0 +1,74 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonObject;
+
+/**
+ * @struct FArticyImportBenchmarkConfig
+ * @brief The size of the synthetic export the import benchmark generates.
+ */
+struct FArticyImportBenchmarkConfig
+{
+	/** The number of flow objects, spread over the packages. */
+	int32 Objects = 1000;
+	int32 Packages = 4;
+
+	/** The number of flow objects which are instructions or conditions, i.e. have a script. */
+	int32 Scripts = 200;
+	int32 Languages = 2;
+	int32 GlobalVariables = 50;
+
+	/** The seed of the texts, positions and scripts, the same seed always generates the same export. */
+	int32 Seed = 1;
+
+	/** Whether the files are stored compressed in the archive, like articy:draft does for large exports. */
+	bool bCompress = false;
+
+	/**
+	 * Reads the configuration from the command line of the commandlet, e.g. -Objects=5000 -Packages=10 -Compress.
+	 * Values out of range are clamped with a warning.
+	 */
+	static FArticyImportBenchmarkConfig FromCommandLine(const TCHAR* Params);
+
+	TSharedRef<FJsonObject> ToJson() const;
+};
+
+/**
+ * @class FArticyImportBenchmark
+ * @brief Measures the import with synthetic exports of a configurable size, so changes to the importer can be compared
+ * reproducibly without a real articy:draft project.
+ *
+ * The benchmark writes a synthetic .articyue archive into the articy directory and runs a full import, then changes
+ * the texts and positions of the first package and runs an incremental import. The stages of both imports are
+ * measured by FArticyImportProfiler, and written together with the configuration to
+ * Saved/Articy/Benchmark/BenchmarkResults.json. The files of the export are also written there as loose JSON.
+ */
+class FArticyImportBenchmark
+{
+public:
+
+	/** The technical name of the synthetic project, the benchmark only replaces import data of this project. */
+	static const TCHAR* const ProjectName;
+
+	/**
+	 * Runs the full and the incremental import, in a project which contains no other articy export.
+	 * @param Config The size of the export.
+	 * @return The exit code of the commandlet, 0 if both imports succeeded.
+	 */
+	static int32 Run(const FArticyImportBenchmarkConfig& Config);
+
+	/**
+	 * Writes a synthetic export.
+	 * @param Config The size of the export.
+	 * @param Revision 0 for the export of the full import, 1 for the export with changes in the first package.
+	 * @param ArchivePath The .articyue archive to write.
+	 * @param LooseDirectory The directory to write the files of the archive to as loose JSON, or empty.
+	 * @return False if a file could not be written.
+	 */
+	static bool WriteExport(const FArticyImportBenchmarkConfig& Config, int32 Revision, const FString& ArchivePath, const FString& LooseDirectory);
+};
@@ -1,5 +1,15 @@
 #include "ArticyImportCommandlet.h"
 #include "ArticyEditorFunctionLibrary.h"
+#include "ArticyEditorModule.h"
+#include "ArticyFlowSimulator.h"
+#include "ArticyHelpers.h"
+#include "ArticyImportBenchmark.h"
+#include "Dom/JsonObject.h"
+#include "Editor.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
 
 /**
  * Main function executed by the commandlet.
@@ -16,6 +26,9 @@ int32 UArticyImportCommandlet::Main(const FString& Params)
     // Determine which process to follow based on the switches
     bool CompleteReimport = false;
     bool RegenerateAssets = false;
+    bool RunBenchmark = false;
+    bool DryRun = false;
+    bool Simulate = false;
 
     // Check each switch to see which operation to perform
     for (int SwitchNum = 0; SwitchNum < Switches.Num(); SwitchNum++)
@@ -28,23 +41,65 @@ int32 UArticyImportCommandlet::Main(const FString& Params)
         {
             RegenerateAssets = true;  // Set flag for asset regeneration
         }
+        if (Switches[SwitchNum].Compare(TEXT("ArticyBenchmark"), ESearchCase::IgnoreCase) == 0)
+        {
+            RunBenchmark = true;  // Set flag for the import benchmark
+        }
+        if (Switches[SwitchNum].Compare(TEXT("ArticyDryRun"), ESearchCase::IgnoreCase) == 0)
+        {
+            DryRun = true;  // Set flag for the report-only import
+        }
+        if (Switches[SwitchNum].Compare(TEXT("ArticySimulate"), ESearchCase::IgnoreCase) == 0)
+        {
+            Simulate = true;  // Set flag for the flow simulation
+        }
     }
 
     GIsRunningUnattendedScript = true;
 
     int32 Outcome;
     // Execute the appropriate process based on the flags set
-    if (CompleteReimport)
+    if (RunBenchmark)
     {
-        Outcome = FArticyEditorFunctionLibrary::ForceCompleteReimport();  // Perform complete reimport
+        // Full and incremental import of a synthetic export, sized by -Objects=, -Packages=, -Scripts=, -Languages=,
+        // -GlobalVariables=, -Seed= and -Compress
+        Outcome = FArticyImportBenchmark::Run(FArticyImportBenchmarkConfig::FromCommandLine(*Params));
     }
-    else if (RegenerateAssets)
+    else if (Simulate)
     {
-        Outcome = FArticyEditorFunctionLibrary::RegenerateAssets();  // Regenerate assets
+        // Random playthroughs of the imported flow from -Start=, sized by -Playthroughs=, -MaxSteps=, -Workers=, -Seed=
+        // and -MaxSeconds=, with the database and variables of the editor world
+        UWorld* World = GEditor ? GEditor->GetEditorWorldContext().World() : nullptr;
+        Outcome = FArticyFlowSimulator::Run(World, FArticyFlowSimulatorConfig::FromArgs(*Params)) ? 0 : 1;
+    }
+    else if (DryRun)
+    {
+        // Only reports what an import would regenerate, nothing is imported
+        FArticyImportDryRunReport Report;
+        const bool bSucceeded = FArticyEditorFunctionLibrary::DryRunImport(Report);
+
+        FString ResultPath = ArticyHelpers::GetSavedPath(TEXT(""), TEXT("ImportDryRun.json"));
+        FParse::Value(*Params, TEXT("ArticyResult="), ResultPath);
+        if (bSucceeded)
+            ArticyHelpers::SaveJsonReport(Report.ToJson(), ResultPath, TEXT("dry run report"));
+
+        Outcome = bSucceeded ? 0 : 1;
     }
     else
     {
-        Outcome = FArticyEditorFunctionLibrary::ReimportChanges();  // Default to reimporting changes
+        // Commandlets run on build machines, so the import must not show any UI
+        FArticyBatchImportOptions Options;
+        Options.bFullReimport = CompleteReimport;  // Perform complete reimport
+        Options.bRegenerateAssetsOnly = RegenerateAssets && !CompleteReimport;  // Regenerate assets
+        const FArticyBatchImportResult Result = FArticyEditorFunctionLibrary::BatchImport(Options);
+
+        // Write the result for the build, e.g. to attach the errors and stage timings to a report
+        FString ResultPath = ArticyHelpers::GetSavedPath(TEXT(""), TEXT("ImportResult.json"));
+        FParse::Value(*Params, TEXT("ArticyResult="), ResultPath);
+        ArticyHelpers::SaveJsonReport(Result.ToJson(), ResultPath, TEXT("import result"));
+
+        // 0 if the import succeeded, 2 if the project has to be built and the import run again, 1 otherwise
+        Outcome = Result.bSucceeded ? 0 : Result.bNeedsCompile ? 2 : 1;
     }
 
     GIsRunningUnattendedScript = false;
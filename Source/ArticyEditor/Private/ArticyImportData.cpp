@@ -22,8 +22,18 @@
 #include "HAL/PlatformFileManager.h"
 #include "HAL/FileManager.h"
 #include "Misc/FileHelper.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "LocalizationPackGenerator.h"
+#include "ArticyExpressoTranslator.h"
 #include "Factories/SoundFactory.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Misc/SecureHash.h"
 #include "UObject/SavePackage.h"
+#include "ArticyImportProfiler.h"
+#include "ArticyEditorFunctionLibrary.h"
+#include "ArticyImporterHelpers.h"
+#include "ArticyDatabase.h"
 
 #define LOCTEXT_NAMESPACE "ArticyImportData"
 
@@ -463,61 +473,140 @@ void FAIDUserMethods::ImportFromJson(const TArray<TSharedPtr<FJsonValue>>* Json)
 //---------------------------------------------------------------------------//
 
 /**
- * Creates a hierarchy object from a JSON object.
+ * Creates the hierarchy objects of a node and its descendants, for views which need objects.
  *
  * @param Outer The outer object.
- * @param JsonObject The JSON object representing the hierarchy.
- * @return The created hierarchy object.
+ * @param Hierarchy The hierarchy.
+ * @param Index The index of the node.
+ * @return The created hierarchy object, nullptr if the node does not exist.
  */
-UADIHierarchyObject* UADIHierarchyObject::CreateFromJson(UObject* Outer, const TSharedPtr<FJsonObject> JsonObject)
+UADIHierarchyObject* UADIHierarchyObject::CreateFromHierarchy(UObject* Outer, const FADIHierarchy& Hierarchy, int32 Index)
 {
-	if (!JsonObject.IsValid())
+	if (!Hierarchy.GetNodes().IsValidIndex(Index))
 		return nullptr;
 
-	//extract properties
-	FString Id;
-	JSON_TRY_STRING(JsonObject, Id);
-	FString TechnicalName;
-	JSON_TRY_STRING(JsonObject, TechnicalName);
-	FString Type;
-	JSON_TRY_STRING(JsonObject, Type);
+	const FADIHierarchyNode& Node = Hierarchy.GetNodes()[Index];
 
 	//create new object, referenced by Outer (otherwise it is transient!), with name TechnicalName
-	auto obj = NewObject<UADIHierarchyObject>(Outer, *TechnicalName);
-	obj->Id = Id;
-	obj->TechnicalName = TechnicalName;
-	obj->Type = Type;
+	auto obj = NewObject<UADIHierarchyObject>(Outer, Node.TechnicalName);
+	obj->Id = Node.Id.ToString();
+	obj->TechnicalName = Node.TechnicalName.ToString();
+	obj->Type = Node.Type.ToString();
 
 	//fill in children
-	const TArray<TSharedPtr<FJsonValue>>* jsonChildren;
-	if (JsonObject->TryGetArrayField(TEXT("Children"), jsonChildren) && jsonChildren)
+	Hierarchy.ForEachChild(Index, [&](int32 Child)
 	{
-		obj->Children.Reset(jsonChildren->Num());
-		for (auto& jsonChild : *jsonChildren)
-		{
-			auto child = CreateFromJson(obj, jsonChild->AsObject());
-			obj->Children.Add(child);
-		}
-	}
+		obj->Children.Add(CreateFromHierarchy(obj, Hierarchy, Child));
+	});
 
 	return obj;
 }
 
 /**
- * Imports hierarchy data from a JSON object.
+ * Imports hierarchy data from a JSON object, into nodes in depth-first order.
  *
  * @param ImportData The import data object.
  * @param Json The JSON object representing the hierarchy.
  */
 void FADIHierarchy::ImportFromJson(UArticyImportData* ImportData, const TSharedPtr<FJsonObject> Json)
 {
+	Nodes.Reset();
 	RootObject = nullptr;
 
 	//find the "Hierarchy" section
 	if (!Json.IsValid())
 		return;
 
-	RootObject = UADIHierarchyObject::CreateFromJson(ImportData, Json);
+	//explicit stack of the open nodes and their next child, the hierarchy can be deep
+	struct FOpenNode
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Children;
+		int32 Index;
+		int32 NextChild;
+	};
+
+	TArray<FOpenNode> Stack;
+	const auto AddNode = [&](const TSharedPtr<FJsonObject>& JsonObject, int32 Parent)
+	{
+		FString Id;
+		JSON_TRY_STRING(JsonObject, Id);
+		FString TechnicalName;
+		JSON_TRY_STRING(JsonObject, TechnicalName);
+		FString Type;
+		JSON_TRY_STRING(JsonObject, Type);
+
+		FADIHierarchyNode& Node = Nodes.AddDefaulted_GetRef();
+		Node.Id = Id;
+		Node.TechnicalName = *TechnicalName;
+		Node.Type = *Type;
+		Node.Parent = Parent;
+
+		const TArray<TSharedPtr<FJsonValue>>* jsonChildren = nullptr;
+		JsonObject->TryGetArrayField(TEXT("Children"), jsonChildren);
+		Stack.Add({ jsonChildren, Nodes.Num() - 1, 0 });
+	};
+
+	AddNode(Json, INDEX_NONE);
+	while (Stack.Num() > 0)
+	{
+		FOpenNode& Top = Stack.Last();
+		if (!Top.Children || Top.NextChild >= Top.Children->Num())
+		{
+			Nodes[Top.Index].SubtreeEnd = Nodes.Num();
+			Stack.Pop();
+			continue;
+		}
+
+		const TSharedPtr<FJsonObject> Child = (*Top.Children)[Top.NextChild++]->AsObject();
+		if (Child.IsValid())
+			AddNode(Child, Top.Index);
+	}
+}
+
+/**
+ * Converts the objects of import data saved by previous versions into nodes, and drops the objects.
+ */
+void FADIHierarchy::ConvertLegacyObjects()
+{
+	if (!RootObject)
+		return;
+
+	Nodes.Reset();
+
+	struct FOpenNode
+	{
+		const UADIHierarchyObject* Object;
+		int32 Index;
+		int32 NextChild;
+	};
+
+	TArray<FOpenNode> Stack;
+	const auto AddNode = [&](const UADIHierarchyObject* Object, int32 Parent)
+	{
+		FADIHierarchyNode& Node = Nodes.AddDefaulted_GetRef();
+		Node.Id = Object->Id;
+		Node.TechnicalName = *Object->TechnicalName;
+		Node.Type = *Object->Type;
+		Node.Parent = Parent;
+		Stack.Add({ Object, Nodes.Num() - 1, 0 });
+	};
+
+	AddNode(RootObject, INDEX_NONE);
+	while (Stack.Num() > 0)
+	{
+		FOpenNode& Top = Stack.Last();
+		if (Top.NextChild >= Top.Object->Children.Num())
+		{
+			Nodes[Top.Index].SubtreeEnd = Nodes.Num();
+			Stack.Pop();
+			continue;
+		}
+
+		if (const UADIHierarchyObject* Child = Top.Object->Children[Top.NextChild++])
+			AddNode(Child, Top.Index);
+	}
+
+	RootObject = nullptr;
 }
 
 /**
@@ -571,6 +660,16 @@ void UArticyImportData::PostInitProperties()
 #endif
 }
 
+/**
+ * Converts data saved by previous versions after loading.
+ */
+void UArticyImportData::PostLoad()
+{
+	Super::PostLoad();
+
+	Hierarchy.ConvertLegacyObjects();
+}
+
 #if WITH_EDITORONLY_DATA
 /**
  * Retrieves asset registry tags for the import data.
@@ -591,6 +690,46 @@ void UArticyImportData::GetAssetRegistryTags(TArray<FAssetRegistryTag>& OutTags)
 }
 #endif
 
+namespace
+{
+	/** The members of the import data in the rollback journal, see UArticyImportData::RecordForRollback. */
+	enum EJournaledMember : uint32
+	{
+		JournaledSettings = 1 << 0,
+		JournaledProject = 1 << 1,
+		JournaledGlobalVariables = 1 << 2,
+		JournaledObjectDefinitions = 1 << 3,
+		JournaledPackageDefs = 1 << 4,
+		JournaledUserMethods = 1 << 5,
+		JournaledHierarchy = 1 << 6,
+		JournaledLanguages = 1 << 7,
+		JournaledScriptFragments = 1 << 8,
+		JournaledParentChildrenCache = 1 << 9
+	};
+}
+
+/**
+ * Records a member in the rollback journal before the import changes it, unless it already is.
+ * The journal keeps the first recorded value, i.e. the one of the last working import, until BuildCachedVersion.
+ *
+ * @param Member The bit of the member.
+ * @param Current The member.
+ * @param Journaled The member in CachedData.
+ * @param bMove Whether the import rebuilds the member, so it can be moved instead of copied.
+ */
+template<typename TMember>
+void UArticyImportData::RecordForRollback(uint32 Member, TMember& Current, TMember& Journaled, bool bMove)
+{
+	if (JournaledMembers & Member)
+		return;
+
+	if (bMove)
+		Journaled = MoveTemp(Current);
+	else
+		Journaled = Current;
+	JournaledMembers |= Member;
+}
+
 /**
  * Handles actions to perform after importing data.
  */
@@ -599,6 +738,8 @@ void UArticyImportData::PostImport()
 	FArticyEditorModule& ArticyEditorModule = FModuleManager::Get().GetModuleChecked<FArticyEditorModule>(
 		"ArticyEditor");
 	ArticyEditorModule.OnImportFinished.Broadcast();
+
+	FArticyImportProfiler::EndImport(true);
 }
 
 /**
@@ -611,25 +752,77 @@ void UArticyImportData::PostImport()
 bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, const TSharedPtr<FJsonObject> RootObject)
 {
 	// Abort if we will have broken packages
-	if (!PackageDefs.ValidateImport(Archive, &RootObject->GetArrayField(JSON_SECTION_PACKAGES)))
-		return false;
+	{
+		ARTICY_IMPORT_STAGE("ValidateImport");
+		if (!PackageDefs.ValidateImport(&RootObject->GetArrayField(JSON_SECTION_PACKAGES)))
+			return false;
+	}
 
 	// Record old script fragments hash
 	const FString& OldScriptFragmentsHash = Settings.ScriptFragmentsHash;
 
 	// import the main sections
+	RecordForRollback(JournaledSettings, Settings, CachedData.Settings, false);
 	Settings.ImportFromJson(RootObject->GetObjectField(JSON_SECTION_SETTINGS));
 
 	if (Settings.set_IncludedNodes.Contains(TEXT("Project")))
+	{
+		RecordForRollback(JournaledProject, Project, CachedData.Project, false);
 		Project.ImportFromJson(RootObject->GetObjectField(JSON_SECTION_PROJECT), Settings);
+	}
 
+	RecordForRollback(JournaledLanguages, Languages, CachedData.Languages, false);
 	Languages.ImportFromJson(RootObject);
 
+	// Fetch and parse the files of the changed sections on worker threads first (with the hashes of the last import),
+	// the sections below then integrate the parsed files one after another
+	{
+		ARTICY_IMPORT_STAGE("PrefetchJson");
+		const double PrefetchStartTime = FPlatformTime::Seconds();
+
+		TArray<FArticyArchivePrefetch> PrefetchFiles;
+		if (Settings.set_IncludedNodes.Contains(TEXT("Hierarchy")))
+			PrefetchFiles.Add({RootObject, JSON_SECTION_HIERARCHY, Settings.HierarchyHash});
+		PrefetchFiles.Add({RootObject, JSON_SECTION_SCRIPTMEETHODS, Settings.ScriptMethodsHash});
+		PrefetchFiles.Add({RootObject, JSON_SECTION_GLOBALVARS, Settings.GlobalVariablesHash});
+		PrefetchFiles.Add({RootObject->GetObjectField(JSON_SECTION_OBJECTDEFS), JSON_SUBSECTION_TYPES, Settings.ObjectDefinitionsHash});
+		PrefetchFiles.Add({RootObject->GetObjectField(JSON_SECTION_OBJECTDEFS), JSON_SUBSECTION_TEXTS, Settings.ObjectDefinitionsTextHash});
+
+		// Package definitions are imported from scratch, so their files are always fetched
+		for (const auto& Package : RootObject->GetArrayField(JSON_SECTION_PACKAGES))
+		{
+			if (!Settings.set_IncludedNodes.Contains(TEXT("Packages")))
+				break;
+
+			const TSharedPtr<FJsonObject> PackageObject = Package->AsObject();
+			bool bIsIncluded = false;
+			const TSharedPtr<FJsonObject>* Files = nullptr;
+			if (!PackageObject.IsValid() || !PackageObject->TryGetBoolField(TEXT("IsIncluded"), bIsIncluded) || !bIsIncluded
+				|| !PackageObject->TryGetObjectField(TEXT("Files"), Files))
+				continue;
+
+			// The objects files are scanned without a DOM, see FArticyPackageDef::ImportFromJson
+			PrefetchFiles.Add({*Files, JSON_SUBSECTION_TEXTS, FString()});
+		}
+
+		const UArticyPluginSettings* PluginSettings = UArticyPluginSettings::Get();
+		Archive.PrefetchJson(PrefetchFiles, PluginSettings->ImportWorkerCount, static_cast<int64>(PluginSettings->ImportMemoryBudgetMB) << 20);
+
+		UE_LOG(LogArticyEditor, Log, TEXT("Fetched and parsed the changed export files in %.1f ms"), (FPlatformTime::Seconds() - PrefetchStartTime) * 1000.0);
+	}
+
 	if (Settings.set_IncludedNodes.Contains(TEXT("Packages")))
-		PackageDefs.ImportFromJson(Archive, &RootObject->GetArrayField(JSON_SECTION_PACKAGES), Settings);
+	{
+		ARTICY_IMPORT_STAGE("PackageDefs.ImportFromJson");
+		// The packages are journaled by the import itself, which moves out the ones it replaces
+		FArticyPackageDefs* Journal = (JournaledMembers & JournaledPackageDefs) ? nullptr : &CachedData.PackageDefs;
+		PackageDefs.ImportFromJson(Archive, &RootObject->GetArrayField(JSON_SECTION_PACKAGES), Settings, Journal);
+		JournaledMembers |= JournaledPackageDefs;
+	}
 
 	if (Settings.set_IncludedNodes.Contains(TEXT("Hierarchy")))
 	{
+		ARTICY_IMPORT_STAGE("Hierarchy.ImportFromJson");
 		TSharedPtr<FJsonObject> HierarchyObject;
 		if (
 			Archive.FetchJson(
@@ -638,62 +831,78 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 				Settings.HierarchyHash,
 				HierarchyObject))
 		{
+			RecordForRollback(JournaledHierarchy, Hierarchy, CachedData.Hierarchy, true);
 			Hierarchy.ImportFromJson(this, HierarchyObject);
 		}
 	}
 
-	TSharedPtr<FJsonObject> UserMethodsObject;
-	if (
-		Archive.FetchJson(
-			RootObject,
-			JSON_SECTION_SCRIPTMEETHODS,
-			Settings.ScriptMethodsHash,
-			UserMethodsObject))
+	// Each parsed file is only held until its section is integrated
 	{
-		UserMethods.ImportFromJson(&UserMethodsObject->GetArrayField(JSON_SECTION_SCRIPTMEETHODS));
-		Settings.SetScriptFragmentsNeedRebuild();
+		TSharedPtr<FJsonObject> UserMethodsObject;
+		if (
+			Archive.FetchJson(
+				RootObject,
+				JSON_SECTION_SCRIPTMEETHODS,
+				Settings.ScriptMethodsHash,
+				UserMethodsObject))
+		{
+			RecordForRollback(JournaledUserMethods, UserMethods, CachedData.UserMethods, true);
+			UserMethods.ImportFromJson(&UserMethodsObject->GetArrayField(JSON_SECTION_SCRIPTMEETHODS));
+			Settings.SetScriptFragmentsNeedRebuild();
+		}
 	}
 
 	bool bNeedsCodeGeneration = false;
 
+	RecordForRollback(JournaledParentChildrenCache, ParentChildrenCache, CachedData.ParentChildrenCache, true);
 	ParentChildrenCache.Empty();
 
-	TSharedPtr<FJsonObject> GvObject;
-	if (Archive.FetchJson(
-		RootObject,
-		JSON_SECTION_GLOBALVARS,
-		Settings.GlobalVariablesHash,
-		GvObject))
 	{
-		GlobalVariables.ImportFromJson(&GvObject->GetArrayField(JSON_SECTION_GLOBALVARS), this);
-		Settings.SetObjectDefinitionsNeedRebuild();
-		bNeedsCodeGeneration = true;
+		TSharedPtr<FJsonObject> GvObject;
+		if (Archive.FetchJson(
+			RootObject,
+			JSON_SECTION_GLOBALVARS,
+			Settings.GlobalVariablesHash,
+			GvObject))
+		{
+			RecordForRollback(JournaledGlobalVariables, GlobalVariables, CachedData.GlobalVariables, true);
+			GlobalVariables.ImportFromJson(&GvObject->GetArrayField(JSON_SECTION_GLOBALVARS), this);
+			Settings.SetObjectDefinitionsNeedRebuild();
+			bNeedsCodeGeneration = true;
+		}
 	}
 
 	const TSharedPtr<FJsonObject> ObjectDefs = RootObject->GetObjectField(JSON_SECTION_OBJECTDEFS);
-	TSharedPtr<FJsonObject> ObjTypes;
-	if (Archive.FetchJson(
-		RootObject->GetObjectField(JSON_SECTION_OBJECTDEFS),
-		JSON_SUBSECTION_TYPES,
-		Settings.ObjectDefinitionsHash,
-		ObjTypes))
-	{
-		ObjectDefinitions.ImportFromJson(&ObjTypes->GetArrayField(JSON_SECTION_OBJECTDEFS), this);
-		Settings.SetObjectDefinitionsNeedRebuild();
-		bNeedsCodeGeneration = true;
+	{
+		TSharedPtr<FJsonObject> ObjTypes;
+		if (Archive.FetchJson(
+			ObjectDefs,
+			JSON_SUBSECTION_TYPES,
+			Settings.ObjectDefinitionsHash,
+			ObjTypes))
+		{
+			// The texts of the object definitions are kept when only the types changed, so they are copied
+			RecordForRollback(JournaledObjectDefinitions, ObjectDefinitions, CachedData.ObjectDefinitions, false);
+			ObjectDefinitions.ImportFromJson(&ObjTypes->GetArrayField(JSON_SECTION_OBJECTDEFS), this);
+			Settings.SetObjectDefinitionsNeedRebuild();
+			bNeedsCodeGeneration = true;
+		}
 	}
 
 	const FString OldObjectDefintionsTextHash = Settings.ObjectDefinitionsTextHash;
-	TSharedPtr<FJsonObject> ObjTexts;
-	if (Archive.FetchJson(
-		RootObject->GetObjectField(JSON_SECTION_OBJECTDEFS),
-		JSON_SUBSECTION_TEXTS,
-		Settings.ObjectDefinitionsTextHash,
-		ObjTexts))
-	{
-		ObjectDefinitions.GatherText(ObjTexts);
-		Settings.SetObjectDefinitionsNeedRebuild();
-		bNeedsCodeGeneration = true;
+	{
+		TSharedPtr<FJsonObject> ObjTexts;
+		if (Archive.FetchJson(
+			ObjectDefs,
+			JSON_SUBSECTION_TEXTS,
+			Settings.ObjectDefinitionsTextHash,
+			ObjTexts))
+		{
+			RecordForRollback(JournaledObjectDefinitions, ObjectDefinitions, CachedData.ObjectDefinitions, false);
+			ObjectDefinitions.GatherText(ObjTexts);
+			Settings.SetObjectDefinitionsNeedRebuild();
+			bNeedsCodeGeneration = true;
+		}
 	}
 
 	if (Settings.ScriptFragmentsHash.IsEmpty() || !Settings.ScriptFragmentsHash.Equals(OldScriptFragmentsHash))
@@ -716,26 +925,39 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 		BuildToolParser RefVerifier = BuildToolParser(path);
 		if (!RefVerifier.VerifyArticyRuntimeRef())
 		{
-			const FText RuntimeRefNotFoundTitle = FText::FromString(TEXT("ArticyRuntime reference not found."));
-			const FText RuntimeRefNotFound = LOCTEXT("ArticyRuntimeReferenceNotFound",
-				"The \"ArticyRuntime\" reference needs to be added inside the Unreal build tool.\nDo you want to add the reference automatically ?\nIf you use a custom build system or a custom build file, you can disable automatic reference verification inside the Articy Plugin settings from the Project settings.\n");
+			if (const FArticyBatchImportOptions* BatchOptions = FArticyEditorFunctionLibrary::GetBatchImportOptions())
+			{
+				// A batch import shows no dialog, the options answer it
+				UE_LOG(LogArticyEditor, Warning, TEXT("The \"ArticyRuntime\" reference is missing in %s%s."), *path,
+					BatchOptions->bAddRuntimeReference ? TEXT(", adding it") : TEXT(""));
+				if (BatchOptions->bAddRuntimeReference)
+				{
+					RefVerifier.AddArticyRuntimmeRef();
+				}
+			}
+			else
+			{
+				const FText RuntimeRefNotFoundTitle = FText::FromString(TEXT("ArticyRuntime reference not found."));
+				const FText RuntimeRefNotFound = LOCTEXT("ArticyRuntimeReferenceNotFound",
+					"The \"ArticyRuntime\" reference needs to be added inside the Unreal build tool.\nDo you want to add the reference automatically ?\nIf you use a custom build system or a custom build file, you can disable automatic reference verification inside the Articy Plugin settings from the Project settings.\n");
 #if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION <= 24
-			EAppReturnType::Type ReturnType = OpenMsgDlgInt(EAppMsgType::Ok, RuntimeRefNotFound, RuntimeRefNotFoundTitle);
+				EAppReturnType::Type ReturnType = OpenMsgDlgInt(EAppMsgType::Ok, RuntimeRefNotFound, RuntimeRefNotFoundTitle);
 #elif ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 3
-			EAppReturnType::Type ReturnType = FMessageDialog::Open(EAppMsgType::YesNoCancel, RuntimeRefNotFound,
-				RuntimeRefNotFoundTitle);
+				EAppReturnType::Type ReturnType = FMessageDialog::Open(EAppMsgType::YesNoCancel, RuntimeRefNotFound,
+					RuntimeRefNotFoundTitle);
 #else
-			EAppReturnType::Type ReturnType = FMessageDialog::Open(EAppMsgType::YesNoCancel, RuntimeRefNotFound,
-				&RuntimeRefNotFoundTitle);
+				EAppReturnType::Type ReturnType = FMessageDialog::Open(EAppMsgType::YesNoCancel, RuntimeRefNotFound,
+					&RuntimeRefNotFoundTitle);
 #endif
-			if (ReturnType == EAppReturnType::Yes)
-			{
-				RefVerifier.AddArticyRuntimmeRef();
-			}
-			else if (ReturnType == EAppReturnType::Cancel)
-			{
-				// Abort code generation
-				bNeedsCodeGeneration = false;
+				if (ReturnType == EAppReturnType::Yes)
+				{
+					RefVerifier.AddArticyRuntimmeRef();
+				}
+				else if (ReturnType == EAppReturnType::Cancel)
+				{
+					// Abort code generation
+					bNeedsCodeGeneration = false;
+				}
 			}
 		}
 	}
@@ -748,80 +970,150 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 		Languages.Languages.Add(TEXT(""), Elem.Value);
 	}
 
-	// Create string tables
-	if (!OldObjectDefintionsTextHash.Equals(Settings.ObjectDefinitionsTextHash))
+	// Create string tables and localization packs
 	{
-		const auto& ObjectDefsText = GetObjectDefs().GetTexts();
-		for (const auto& Language : Languages.Languages)
+		ARTICY_IMPORT_STAGE("StringTables");
+
+		// Create string tables
+		// The tables are generated in parallel, then moved into place and registered with source control on this thread
+		struct FStringTableJob
 		{
-			StringTableGenerator(TEXT("ARTICY"), Language.Key, [&](StringTableGenerator* CsvOutput)
-				{
-					return ProcessStrings(CsvOutput, ObjectDefsText, Language);
-				});
-		}
-	}
+			FString TableName;
+			const TPair<FString, FArticyLanguageDef>* Language;
+			const TMap<FString, FArticyTexts>* Texts;
+		};
+		TArray<FStringTableJob> StringTableJobs;
 
-	for (const auto& Language : Languages.Languages)
-	{
-		// Handle packages
-		for (const auto& Package : GetPackageDefs().GetPackages())
+		const auto& ObjectDefsText = GetObjectDefs().GetTexts();
+		if (!OldObjectDefintionsTextHash.Equals(Settings.ObjectDefinitionsTextHash))
 		{
-			const FString PackageName = Package.GetName();
-			const FString StringTableFileName = PackageName.Replace(TEXT(" "), TEXT("_"));
-			if (!Package.GetName().Equals(Package.GetPreviousName()))
+			for (const auto& Language : Languages.Languages)
 			{
-				// Needs rename
-				const FString OldStringTableFileName = Package.GetPreviousName().Replace(TEXT(" "), TEXT("_"));
-				IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-				ISourceControlModule& SCModule = ISourceControlModule::Get();
+				StringTableJobs.Add({TEXT("ARTICY"), &Language, &ObjectDefsText});
+			}
+		}
 
-				bool bCheckOutEnabled = false;
-				if (SCModule.IsEnabled())
-				{
-					bCheckOutEnabled = ISourceControlModule::Get().GetProvider().UsesCheckout();
-				}
+		// The definitions are only read from here on, so the jobs refer to their texts instead of copying them
+		const TArray<FArticyPackageDef>& PackageDefs = GetPackageDefs().GetPackages();
 
-				// Work out the old and new file paths
-				FString OldPath, NewPath;
-				const FString OldFilePath = TEXT("ArticyContent/Generated") / OldStringTableFileName;
-				const FString NewFilePath = TEXT("ArticyContent/Generated") / StringTableFileName;
-				if (Language.Key.IsEmpty())
+		for (const auto& Language : Languages.Languages)
+		{
+			// Handle packages
+			for (int32 PackageIndex = 0; PackageIndex < PackageDefs.Num(); ++PackageIndex)
+			{
+				const auto& Package = PackageDefs[PackageIndex];
+				const FString PackageName = Package.GetName();
+				const FString StringTableFileName = PackageName.Replace(TEXT(" "), TEXT("_"));
+				if (!Package.GetName().Equals(Package.GetPreviousName()))
 				{
-					OldPath = FPaths::ProjectContentDir() / OldFilePath;
-					NewPath = FPaths::ProjectContentDir() / NewFilePath;
-				}
-				else {
-					OldPath = FPaths::ProjectContentDir() / TEXT("L10N") / Language.Key / OldFilePath;
-					NewPath = FPaths::ProjectContentDir() / TEXT("L10N") / Language.Key / NewFilePath;
-				}
-				OldPath += TEXT(".csv");
-				NewPath += TEXT(".csv");
+					// Needs rename
+					const FString OldStringTableFileName = Package.GetPreviousName().Replace(TEXT(" "), TEXT("_"));
+					IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+					ISourceControlModule& SCModule = ISourceControlModule::Get();
 
-				// Check out and rename
-				if (PlatformFile.FileExists(*OldPath))
-				{
-					if (bCheckOutEnabled)
-						USourceControlHelpers::CheckOutFile(*OldPath);
+					bool bCheckOutEnabled = false;
+					if (SCModule.IsEnabled())
+					{
+						bCheckOutEnabled = ISourceControlModule::Get().GetProvider().UsesCheckout();
+					}
 
-					// Rename the file
-					PlatformFile.MoveFile(*NewPath, *OldPath);
+					// Work out the old and new file paths
+					FString OldPath, NewPath;
+					const FString OldFilePath = TEXT("ArticyContent/Generated") / OldStringTableFileName;
+					const FString NewFilePath = TEXT("ArticyContent/Generated") / StringTableFileName;
+					if (Language.Key.IsEmpty())
+					{
+						OldPath = FPaths::ProjectContentDir() / OldFilePath;
+						NewPath = FPaths::ProjectContentDir() / NewFilePath;
+					}
+					else {
+						OldPath = FPaths::ProjectContentDir() / TEXT("L10N") / Language.Key / OldFilePath;
+						NewPath = FPaths::ProjectContentDir() / TEXT("L10N") / Language.Key / NewFilePath;
+					}
+					OldPath += TEXT(".csv");
+					NewPath += TEXT(".csv");
 
-					if (bCheckOutEnabled)
+					// Check out and rename
+					if (PlatformFile.FileExists(*OldPath))
 					{
-						USourceControlHelpers::MarkFileForAdd(*NewPath);
-						USourceControlHelpers::MarkFileForDelete(*OldPath);
+						if (bCheckOutEnabled)
+							USourceControlHelpers::CheckOutFile(*OldPath);
+
+						// Rename the file
+						PlatformFile.MoveFile(*NewPath, *OldPath);
+
+						if (bCheckOutEnabled)
+						{
+							USourceControlHelpers::MarkFileForAdd(*NewPath);
+							USourceControlHelpers::MarkFileForDelete(*OldPath);
+						}
 					}
 				}
-			}
 
-			if (!Package.GetIsIncluded())
-				continue;
+				if (!Package.GetIsIncluded())
+					continue;
+
+				StringTableJobs.Add({StringTableFileName, &Language, &Package.GetTexts()});
+			}
+		}
 
-			StringTableGenerator(StringTableFileName, Language.Key,
+		TArray<TUniquePtr<StringTableGenerator>> StringTables;
+		StringTables.SetNum(StringTableJobs.Num());
+		ParallelFor(StringTableJobs.Num(), [&](int32 JobIndex)
+		{
+			const FStringTableJob& Job = StringTableJobs[JobIndex];
+			StringTables[JobIndex] = MakeUnique<StringTableGenerator>(Job.TableName, Job.Language->Key,
 				[&](StringTableGenerator* CsvOutput)
 				{
-					return ProcessStrings(CsvOutput, Package.GetTexts(), Language);
-				});
+					return ProcessStrings([CsvOutput](const FString& Key, const FString& SourceString) { CsvOutput->Line(Key, SourceString); }, *Job.Texts, *Job.Language);
+				}, true);
+		});
+
+		for (const TUniquePtr<StringTableGenerator>& StringTable : StringTables)
+		{
+			StringTable->Finish();
+		}
+		StringTables.Empty();
+
+		// Create the binary localization packs, each holds all string tables of its culture
+		if (UArticyPluginSettings::Get()->bUseLocalizationPacks)
+		{
+			ARTICY_IMPORT_STAGE("LocalizationPacks");
+			TArray<const TPair<FString, FArticyLanguageDef>*> PackLanguages;
+			for (const auto& Language : Languages.Languages)
+			{
+				PackLanguages.Add(&Language);
+			}
+
+			const bool bCompressPacks = UArticyPluginSettings::Get()->bCompressLocalizationPacks;
+			TArray<TUniquePtr<LocalizationPackGenerator>> Packs;
+			Packs.SetNum(PackLanguages.Num());
+			ParallelFor(PackLanguages.Num(), [&](int32 LanguageIndex)
+			{
+				const TPair<FString, FArticyLanguageDef>& Language = *PackLanguages[LanguageIndex];
+				TUniquePtr<LocalizationPackGenerator> Pack = MakeUnique<LocalizationPackGenerator>(Language.Key, bCompressPacks);
+				const auto AddLine = [&Pack](const FString& Key, const FString& SourceString) { Pack->Line(Key, SourceString); };
+
+				Pack->Table(TEXT("ARTICY"));
+				ProcessStrings(AddLine, ObjectDefsText, Language);
+
+				for (int32 PackageIndex = 0; PackageIndex < PackageDefs.Num(); ++PackageIndex)
+				{
+					if (!PackageDefs[PackageIndex].GetIsIncluded())
+						continue;
+
+					Pack->Table(PackageDefs[PackageIndex].GetName().Replace(TEXT(" "), TEXT("_")));
+					ProcessStrings(AddLine, PackageDefs[PackageIndex].GetTexts(), Language);
+				}
+
+				Pack->Build();
+				Packs[LanguageIndex] = MoveTemp(Pack);
+			});
+
+			for (const TUniquePtr<LocalizationPackGenerator>& Pack : Packs)
+			{
+				Pack->Finish();
+			}
 		}
 	}
 
@@ -830,6 +1122,7 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 	ImportAudioAssets(AssetBaseDirectory);
 
 	// if we are generating code, generate and compile it; after it has finished, generate assets and perform post import logic
+	bool bRegenerateAllPackages = false;
 	if (bNeedsCodeGeneration)
 	{
 		const bool bAnyCodeGenerated = CodeGenerator::GenerateCode(this);
@@ -844,38 +1137,337 @@ bool UArticyImportData::ImportFromJson(const UArticyArchiveReader& Archive, cons
 				PostImportHandle.Reset();
 			}
 
+			// The generated classes changed, so every package is regenerated, unless only the script bodies changed
+			// and are patched with Live Coding; the classes are the same then, like when no code changed at all
+			const bool bRegenerateAll = !CodeGenerator::CanPatchWithLiveCoding(this) || Settings.DidObjectDefsOrGVsChange();
+
 			// this will have either the current import data or the cached version
 			PostImportHandle = FArticyEditorModule::Get().OnCompilationFinished.AddLambda(
-				[this](UArticyImportData* Data)
+				[this, bRegenerateAll](UArticyImportData* Data)
 				{
+					FArticyImportProfiler::EndStage(TEXT("Compile"));
+
 					BuildCachedVersion();
-					CodeGenerator::GenerateAssets(Data);
+					CodeGenerator::GenerateAssets(Data, bRegenerateAll);
 					PostImport();
 				});
 
+			FArticyImportProfiler::BeginStage(TEXT("Compile"));
 			CodeGenerator::Recompile(this);
+			return true;
 		}
+
+		// The generated code is the same as before, so there is nothing to compile.
+		// The object definitions may still have changed in ways the code does not reflect, so all packages are regenerated then.
+		bRegenerateAllPackages = Settings.DidObjectDefsOrGVsChange();
+		Settings.SetObjectDefinitionsRebuilt();
+		Settings.SetScriptFragmentsRebuilt();
 	}
-	// if we are importing but no code needed to be generated, generate assets immediately and perform post import
-	else
+
+	// During play, only imports without code changes run (see UArticyJSONFactory::HandleImportDuringPlay).
+	// The running databases unload the packages which are regenerated, and load them again afterwards.
+	TMap<FString, FString> HotPatchedPackages;
+	if (ArticyImporterHelpers::IsPlayInEditor())
+	{
+		for (const FArticyPackageDef& Package : PackageDefs.GetPackages())
+		{
+			if (Package.GetIsIncluded() && (bRegenerateAllPackages || Package.GetAssetsChanged()))
+				HotPatchedPackages.Add(Package.GetPreviousName(), Package.GetName());
+		}
+		UArticyDatabase::BeginPackageHotPatch(HotPatchedPackages);
+	}
+
+	// if we are importing but no code needed to be (re)compiled, generate assets immediately and perform post import
+	BuildCachedVersion();
+	CodeGenerator::GenerateAssets(this, bRegenerateAllPackages);
+	if (HotPatchedPackages.Num() > 0)
 	{
-		BuildCachedVersion();
-		CodeGenerator::GenerateAssets(this);
-		PostImport();
+		UArticyDatabase::EndPackageHotPatch();
 	}
+	PostImport();
 
 	return true;
 }
 
 /**
- * Processes strings and writes them to a CSV output.
+ * Compares the file hashes of an export with the ones of the last import, like ImportFromJson does with FetchJson,
+ * and reports what an import would regenerate. The settings and the project are imported into copies, so the hashes
+ * are reset like in ImportFromJson if the export belongs to another project. Nothing of this object is changed.
  *
- * @param CsvOutput The CSV output generator.
+ * @param Archive The archive reader, only the manifest info is read.
+ * @param RootObject The root JSON object, i.e. the manifest.
+ * @return What an import would regenerate.
+ */
+FArticyImportDryRunReport UArticyImportData::DryRunImportFromJson(const UArticyArchiveReader& Archive, const TSharedPtr<FJsonObject> RootObject) const
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	FArticyImportDryRunReport Report;
+	Report.SourceFile = ImportData ? ImportData->GetFirstFilename() : FString();
+
+	FAdiSettings NewSettings = Settings;
+	NewSettings.ImportFromJson(RootObject->GetObjectField(JSON_SECTION_SETTINGS));
+
+	FArticyProjectDef NewProject = Project;
+	if (NewSettings.set_IncludedNodes.Contains(TEXT("Project")))
+		NewProject.ImportFromJson(RootObject->GetObjectField(JSON_SECTION_PROJECT), NewSettings);
+
+	Report.bProjectChanged = NewSettings.RuleSetId != Settings.RuleSetId
+		|| !NewProject.Guid.Equals(Project.Guid)
+		|| !NewProject.TechnicalName.Equals(Project.TechnicalName);
+	Report.bScriptSupportChanged = NewSettings.set_UseScriptSupport != Settings.set_UseScriptSupport;
+
+	// The same hashes ImportFromJson passes to FetchJson
+	const TSharedPtr<FJsonObject> ObjectDefs = RootObject->GetObjectField(JSON_SECTION_OBJECTDEFS);
+	Report.bGlobalVariablesChanged = Archive.HasFileChanged(RootObject, JSON_SECTION_GLOBALVARS, NewSettings.GlobalVariablesHash);
+	Report.bObjectDefinitionsChanged = Archive.HasFileChanged(ObjectDefs, JSON_SUBSECTION_TYPES, NewSettings.ObjectDefinitionsHash);
+	Report.bObjectDefinitionsTextsChanged = Archive.HasFileChanged(ObjectDefs, JSON_SUBSECTION_TEXTS, NewSettings.ObjectDefinitionsTextHash);
+	Report.bScriptMethodsChanged = Archive.HasFileChanged(RootObject, JSON_SECTION_SCRIPTMEETHODS, NewSettings.ScriptMethodsHash);
+	Report.bHierarchyChanged = NewSettings.set_IncludedNodes.Contains(TEXT("Hierarchy"))
+		&& Archive.HasFileChanged(RootObject, JSON_SECTION_HIERARCHY, NewSettings.HierarchyHash);
+
+	// Reconcile the packages like FArticyPackageDefs::ImportFromJson, with the hashes of the package files
+	bool bPackageScriptsChanged = false;
+	if (NewSettings.set_IncludedNodes.Contains(TEXT("Packages")))
+	{
+		const TArray<FArticyPackageDef>& OldPackages = PackageDefs.GetPackages();
+		TSet<FString> OldPackageScriptHashes;
+		for (const FArticyPackageDef& OldPackage : OldPackages)
+		{
+			OldPackageScriptHashes.Add(OldPackage.GetScriptFragmentHash());
+		}
+
+		TSet<FArticyId> NewPackageIds;
+		TArray<FString> NewPackageScriptHashes;
+		for (const auto& Package : RootObject->GetArrayField(JSON_SECTION_PACKAGES))
+		{
+			const TSharedPtr<FJsonObject> PackageObject = Package->AsObject();
+			if (!PackageObject.IsValid())
+				continue;
+
+			FArticyId Id;
+			JSON_TRY_HEX_ID(PackageObject, Id);
+
+			// The first package with an Id wins, like in the import
+			if (NewPackageIds.Contains(Id))
+				continue;
+			NewPackageIds.Add(Id);
+
+			const FArticyPackageDef* OldPackage = OldPackages.FindByPredicate([&Id](const FArticyPackageDef& Def) { return Def.GetId() == Id; });
+
+			bool IsIncluded = false;
+			JSON_TRY_BOOL(PackageObject, IsIncluded);
+
+			FArticyImportDryRunReport::FPackage& PackageReport = Report.Packages.AddDefaulted_GetRef();
+			PackageReport.bIncluded = IsIncluded;
+			PackageReport.bNew = !OldPackage;
+			PackageReport.Name = OldPackage ? OldPackage->GetName() : FString();
+
+			if (!IsIncluded)
+			{
+				// Packages without data keep their assets and script fragments
+				NewPackageScriptHashes.Add(OldPackage ? OldPackage->GetScriptFragmentHash() : FString());
+				continue;
+			}
+
+			FString Name;
+			JSON_TRY_STRING(PackageObject, Name);
+			FString ScriptFragmentHash;
+			JSON_TRY_STRING(PackageObject, ScriptFragmentHash);
+			NewPackageScriptHashes.Add(ScriptFragmentHash);
+
+			PackageReport.Name = Name;
+			if (OldPackage && !Name.Equals(OldPackage->GetName()))
+			{
+				PackageReport.bRenamed = true;
+				PackageReport.PreviousName = OldPackage->GetName();
+			}
+
+			const TSharedPtr<FJsonObject>* Files = nullptr;
+			if (!PackageObject->TryGetObjectField(TEXT("Files"), Files))
+				continue;
+
+			// A package whose objects were never imported is always regenerated, see FArticyPackageDef::HasSameContent
+			const FString OldObjectsHash = OldPackage ? OldPackage->GetObjectsHash() : FString();
+			const FString OldTextsHash = OldPackage ? OldPackage->GetTextsHash() : FString();
+			PackageReport.bObjectsChanged = OldObjectsHash.IsEmpty() || Archive.HasFileChanged(*Files, JSON_SUBSECTION_OBJECTS, OldObjectsHash);
+			PackageReport.bTextsChanged = OldTextsHash.IsEmpty() || Archive.HasFileChanged(*Files, JSON_SUBSECTION_TEXTS, OldTextsHash);
+		}
+
+		for (const FArticyPackageDef& OldPackage : OldPackages)
+		{
+			if (NewPackageIds.Contains(OldPackage.GetId()))
+				continue;
+
+			FArticyImportDryRunReport::FPackage& PackageReport = Report.Packages.AddDefaulted_GetRef();
+			PackageReport.Name = OldPackage.GetName();
+			PackageReport.bRemoved = true;
+		}
+
+		// Same check of the set of script hashes as in FArticyPackageDefs::ImportFromJson
+		bPackageScriptsChanged = OldPackageScriptHashes.Num() != NewPackageScriptHashes.Num();
+		for (const FString& ScriptHash : NewPackageScriptHashes)
+		{
+			bPackageScriptsChanged |= !OldPackageScriptHashes.Contains(ScriptHash);
+		}
+	}
+	Report.bScriptFragmentsChanged = bPackageScriptsChanged || Report.bScriptMethodsChanged;
+
+	// The string tables of the cultures, with the invariant culture added like in ImportFromJson
+	FArticyLanguages NewLanguages = Languages;
+	NewLanguages.ImportFromJson(RootObject);
+	if (!NewLanguages.Languages.Contains(TEXT("")) && NewLanguages.Languages.Num() > 0)
+	{
+		NewLanguages.Languages.Add(TEXT(""), NewLanguages.Languages.CreateConstIterator()->Value);
+	}
+
+	for (const auto& Language : NewLanguages.Languages)
+	{
+		// The tables of new cultures are all created
+		const bool bNewLanguage = !Languages.Languages.Contains(Language.Key);
+		const auto AddStringTable = [&Report, &Language](const FString& TableName)
+		{
+			Report.StringTables.Add(Language.Key.IsEmpty() ? TableName : Language.Key / TableName);
+		};
+
+		if (bNewLanguage || Report.bObjectDefinitionsTextsChanged)
+		{
+			AddStringTable(TEXT("ARTICY"));
+		}
+
+		for (const FArticyImportDryRunReport::FPackage& Package : Report.Packages)
+		{
+			if (Package.bIncluded && (bNewLanguage || Package.bNew || Package.bRenamed || Package.bTextsChanged))
+			{
+				AddStringTable(Package.Name.Replace(TEXT(" "), TEXT("_")));
+			}
+		}
+	}
+
+	// The conditions of ImportFromJson. The script fragments hash is not exported, so the scripts are always gathered
+	const bool bGatherScripts = NewSettings.set_UseScriptSupport
+		&& (NewSettings.ScriptFragmentsHash.IsEmpty() || Report.bScriptFragmentsChanged);
+	Report.bNeedsCodeGeneration = Report.bGlobalVariablesChanged || Report.bObjectDefinitionsChanged
+		|| Report.bObjectDefinitionsTextsChanged || bGatherScripts;
+	Report.bNeedsRecompile = Report.bGlobalVariablesChanged || Report.bObjectDefinitionsChanged
+		|| Report.bObjectDefinitionsTextsChanged || Report.bScriptSupportChanged
+		|| (NewSettings.set_UseScriptSupport && Report.bScriptFragmentsChanged);
+
+	Report.Seconds = FPlatformTime::Seconds() - StartTime;
+	return Report;
+}
+
+/**
+ * Returns true if an import would change anything.
+ *
+ * @return True if any section, package or string table changed, false otherwise.
+ */
+bool FArticyImportDryRunReport::HasChanges() const
+{
+	return bProjectChanged || bGlobalVariablesChanged || bObjectDefinitionsChanged || bObjectDefinitionsTextsChanged
+		|| bScriptMethodsChanged || bHierarchyChanged || bScriptFragmentsChanged || bScriptSupportChanged
+		|| StringTables.Num() > 0
+		|| Packages.ContainsByPredicate([](const FPackage& Package) { return Package.bRemoved || Package.NeedsRegeneration(); });
+}
+
+/**
+ * Logs the report as a summary, listing only the packages which changed.
+ */
+void FArticyImportDryRunReport::Log() const
+{
+	const auto Changed = [](bool bChanged) { return bChanged ? TEXT("changed") : TEXT("unchanged"); };
+
+	UE_LOG(LogArticyEditor, Display, TEXT("Dry run of the Articy import of '%s' in %.1f ms:"), *SourceFile, Seconds * 1000.0);
+	if (bProjectChanged)
+	{
+		UE_LOG(LogArticyEditor, Display, TEXT("  The export belongs to another project or rule set, everything is imported again."));
+	}
+	UE_LOG(LogArticyEditor, Display, TEXT("  Global variables %s, object definitions %s, object definition texts %s, hierarchy %s"),
+		Changed(bGlobalVariablesChanged), Changed(bObjectDefinitionsChanged), Changed(bObjectDefinitionsTextsChanged), Changed(bHierarchyChanged));
+	UE_LOG(LogArticyEditor, Display, TEXT("  Script fragments %s, script methods %s, script support %s"),
+		Changed(bScriptFragmentsChanged), Changed(bScriptMethodsChanged), Changed(bScriptSupportChanged));
+
+	int32 NumRegenerated = 0;
+	for (const FPackage& Package : Packages)
+	{
+		if (Package.bRemoved)
+		{
+			UE_LOG(LogArticyEditor, Display, TEXT("  Package '%s' was removed"), *Package.Name);
+		}
+		else if (Package.NeedsRegeneration())
+		{
+			++NumRegenerated;
+			UE_LOG(LogArticyEditor, Display, TEXT("  Package '%s' is regenerated:%s%s%s%s"), *Package.Name,
+				Package.bNew ? TEXT(" new") : TEXT(""),
+				Package.bRenamed ? *FString::Printf(TEXT(" renamed from '%s'"), *Package.PreviousName) : TEXT(""),
+				Package.bObjectsChanged ? TEXT(" objects changed") : TEXT(""),
+				Package.bTextsChanged ? TEXT(" texts changed") : TEXT(""));
+		}
+	}
+	UE_LOG(LogArticyEditor, Display, TEXT("  %d of %d packages are regenerated"), NumRegenerated, Packages.Num());
+
+	UE_LOG(LogArticyEditor, Display, TEXT("  %d string tables change%s%s"), StringTables.Num(),
+		StringTables.Num() > 0 ? TEXT(": ") : TEXT(""), *FString::Join(StringTables, TEXT(", ")));
+	UE_LOG(LogArticyEditor, Display, TEXT("  Code generation %s, C++ recompile %s"),
+		bNeedsCodeGeneration ? TEXT("runs") : TEXT("is skipped"), bNeedsRecompile ? TEXT("likely") : TEXT("not needed"));
+}
+
+/**
+ * Returns the report for build machines and tools.
+ *
+ * @return The report as JSON object.
+ */
+TSharedRef<FJsonObject> FArticyImportDryRunReport::ToJson() const
+{
+	TArray<TSharedPtr<FJsonValue>> PackageValues;
+	for (const FPackage& Package : Packages)
+	{
+		const TSharedRef<FJsonObject> PackageObject = MakeShared<FJsonObject>();
+		PackageObject->SetStringField(TEXT("Name"), Package.Name);
+		if (Package.bRenamed)
+			PackageObject->SetStringField(TEXT("PreviousName"), Package.PreviousName);
+		PackageObject->SetBoolField(TEXT("Included"), Package.bIncluded);
+		PackageObject->SetBoolField(TEXT("New"), Package.bNew);
+		PackageObject->SetBoolField(TEXT("Removed"), Package.bRemoved);
+		PackageObject->SetBoolField(TEXT("Renamed"), Package.bRenamed);
+		PackageObject->SetBoolField(TEXT("ObjectsChanged"), Package.bObjectsChanged);
+		PackageObject->SetBoolField(TEXT("TextsChanged"), Package.bTextsChanged);
+		PackageObject->SetBoolField(TEXT("Regenerated"), Package.NeedsRegeneration());
+		PackageValues.Add(MakeShared<FJsonValueObject>(PackageObject));
+	}
+
+	TArray<TSharedPtr<FJsonValue>> StringTableValues;
+	for (const FString& StringTable : StringTables)
+		StringTableValues.Add(MakeShared<FJsonValueString>(StringTable));
+
+	const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetStringField(TEXT("SourceFile"), SourceFile);
+	Json->SetBoolField(TEXT("HasChanges"), HasChanges());
+	Json->SetBoolField(TEXT("ProjectChanged"), bProjectChanged);
+	Json->SetBoolField(TEXT("GlobalVariablesChanged"), bGlobalVariablesChanged);
+	Json->SetBoolField(TEXT("ObjectDefinitionsChanged"), bObjectDefinitionsChanged);
+	Json->SetBoolField(TEXT("ObjectDefinitionsTextsChanged"), bObjectDefinitionsTextsChanged);
+	Json->SetBoolField(TEXT("ScriptMethodsChanged"), bScriptMethodsChanged);
+	Json->SetBoolField(TEXT("HierarchyChanged"), bHierarchyChanged);
+	Json->SetBoolField(TEXT("ScriptFragmentsChanged"), bScriptFragmentsChanged);
+	Json->SetBoolField(TEXT("ScriptSupportChanged"), bScriptSupportChanged);
+	Json->SetArrayField(TEXT("Packages"), PackageValues);
+	Json->SetArrayField(TEXT("StringTables"), StringTableValues);
+	Json->SetBoolField(TEXT("NeedsCodeGeneration"), bNeedsCodeGeneration);
+	Json->SetBoolField(TEXT("NeedsRecompile"), bNeedsRecompile);
+	Json->SetNumberField(TEXT("Seconds"), Seconds);
+	return Json;
+}
+
+/**
+ * Processes strings and writes them to a CSV output or localization pack.
+ *
+ * @param AddLine Adds a key and its source string to the output.
  * @param Data The map of strings and their associated text data.
  * @param Language The language information.
  * @return The number of processed strings.
  */
-int UArticyImportData::ProcessStrings(StringTableGenerator* CsvOutput, const TMap<FString, FArticyTexts>& Data, const TPair<FString, FArticyLanguageDef>& Language)
+int UArticyImportData::ProcessStrings(TFunctionRef<void(const FString& Key, const FString& SourceString)> AddLine, const TMap<FString, FArticyTexts>& Data, const TPair<FString, FArticyLanguageDef>& Language)
 {
 	int Counter = 0;
 
@@ -888,10 +1480,10 @@ int UArticyImportData::ProcessStrings(StringTableGenerator* CsvOutput, const TMa
 			if (Text.Value.Content.Contains(Language.Key))
 			{
 				// Specific language data
-				CsvOutput->Line(Text.Key, Text.Value.Content[Language.Key].Text);
+				AddLine(Text.Key, Text.Value.Content[Language.Key].Text);
 				if (!Text.Value.Content[Language.Key].VoAsset.IsEmpty())
 				{
-					CsvOutput->Line(Text.Key + ".VOAsset", Text.Value.Content[Language.Key].VoAsset);
+					AddLine(Text.Key + ".VOAsset", Text.Value.Content[Language.Key].VoAsset);
 				}
 			}
 			else
@@ -899,10 +1491,10 @@ int UArticyImportData::ProcessStrings(StringTableGenerator* CsvOutput, const TMa
 				// Infer default from iterator
 				const auto& Iterator = Text.Value.Content.CreateConstIterator();
 				const auto& Elem = *Iterator;
-				CsvOutput->Line(Text.Key, Elem.Value.Text);
+				AddLine(Text.Key, Elem.Value.Text);
 				if (!Elem.Value.VoAsset.IsEmpty())
 				{
-					CsvOutput->Line(Text.Key + ".VOAsset", Elem.Value.VoAsset);
+					AddLine(Text.Key + ".VOAsset", Elem.Value.VoAsset);
 				}
 			}
 			Counter++;
@@ -915,93 +1507,176 @@ int UArticyImportData::ProcessStrings(StringTableGenerator* CsvOutput, const TMa
 /**
  * Imports audio assets from a directory.
  *
+ * Files are only imported if they changed since the existing asset was imported from them, by timestamp or, if the
+ * timestamp differs, by content hash (which is computed in parallel). The imported packages are written asynchronously.
+ *
  * @param BaseContentDir The base content directory.
  */
 void UArticyImportData::ImportAudioAssets(const FString& BaseContentDir)
 {
-    TArray<FString> FilesToImport;
+    ARTICY_IMPORT_STAGE("ImportAudioAssets");
 
-    // Recursively find all .wav and .ogg files in the base directory
-    IFileManager& FileManager = IFileManager::Get();
-    FileManager.FindFilesRecursive(FilesToImport, *BaseContentDir, TEXT("*.wav"), true, false, false);
-    FileManager.FindFilesRecursive(FilesToImport, *BaseContentDir, TEXT("*.ogg"), true, false, false);
+    struct FAudioFile
+    {
+        FString FilePath;
+        FDateTime Timestamp;
+        FString PackageName;
+        FString AssetName;
+        FMD5Hash ImportedHash;
+        bool bUpToDate = false;
+    };
+    TArray<FAudioFile> Files;
+
+    // Find all .wav and .ogg files in the base directory, with their timestamps, in one pass
+    IFileManager::Get().IterateDirectoryStatRecursively(*BaseContentDir, [&Files](const TCHAR* FilePath, const FFileStatData& StatData)
+    {
+        const FString Extension = FPaths::GetExtension(FilePath);
+        if (!StatData.bIsDirectory && (Extension.Equals(TEXT("wav"), ESearchCase::IgnoreCase) || Extension.Equals(TEXT("ogg"), ESearchCase::IgnoreCase)))
+        {
+            FAudioFile& File = Files.AddDefaulted_GetRef();
+            File.FilePath = FilePath;
+            File.Timestamp = StatData.ModificationTime;
+        }
+        return true;
+    });
+
+    if (Files.Num() == 0)
+    {
+        return;
+    }
 
+    const FString AssetsPath = TEXT("/Game/ArticyContent/Resources/Assets");
     IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+    AssetRegistry.ScanPathsSynchronous({ AssetsPath });
 
-    for (const FString& FilePath : FilesToImport)
+    TArray<int32> FilesToHash;
+    for (int32 Index = 0; Index < Files.Num(); ++Index)
     {
+        FAudioFile& File = Files[Index];
+
         // Calculate the relative path from the base directory
-        FString RelativePath = FilePath;
+        FString RelativePath = File.FilePath;
         FPaths::MakePathRelativeTo(RelativePath, *BaseContentDir);
 
         // Determine the package path based on the relative path
-        FString PackagePath = TEXT("/Game/ArticyContent/Resources/Assets/") + FPaths::GetPath(RelativePath);
-        FString FileName = FPaths::GetBaseFilename(FilePath);
-        FString PackageFileName = FPaths::Combine(PackagePath, FileName + TEXT(".uasset"));
+        File.AssetName = FPaths::GetBaseFilename(File.FilePath);
+        File.PackageName = FPaths::Combine(AssetsPath, FPaths::GetPath(RelativePath), File.AssetName);
+        const FString ObjectPath = File.PackageName + TEXT(".") + File.AssetName;
 
 #if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 1
-        FAssetData AssetData = AssetRegistry.GetAssetByObjectPath(FSoftObjectPath(*PackageFileName));
+        FAssetData AssetData = AssetRegistry.GetAssetByObjectPath(FSoftObjectPath(*ObjectPath));
 #else
-        FAssetData AssetData = AssetRegistry.GetAssetByObjectPath(FName(*PackageFileName));
+        FAssetData AssetData = AssetRegistry.GetAssetByObjectPath(FName(*ObjectPath));
 #endif
 
         if (!AssetData.IsValid())
         {
             // Check if the .uasset file exists on disk and delete it if stale
             FString PackageFilename;
-            if (FPackageName::TryConvertLongPackageNameToFilename(PackageFileName, PackageFilename))
+            if (FPackageName::TryConvertLongPackageNameToFilename(File.PackageName, PackageFilename, FPackageName::GetAssetPackageExtension()))
             {
-                FString FullPackageFilename = PackageFilename;
-                if (FPaths::FileExists(FullPackageFilename))
+                if (FPaths::FileExists(PackageFilename))
                 {
-                    UE_LOG(LogArticyEditor, Warning, TEXT("Deleting stale .uasset: %s"), *FullPackageFilename);
-                    IFileManager::Get().Delete(*FullPackageFilename);
+                    UE_LOG(LogArticyEditor, Warning, TEXT("Deleting stale .uasset: %s"), *PackageFilename);
+                    IFileManager::Get().Delete(*PackageFilename);
                 }
             }
+            continue;
         }
 
-        // Create a new package
-        UPackage* Package = CreatePackage(*FPaths::Combine(PackagePath, FileName));
-        if (!Package)
+        // The sound factory records the source file of the import, which the asset registry has without loading the asset
+        FString ImportInfoJson;
+        if (!AssetData.GetTagValue(UAssetImportData::SourceFileTagName(), ImportInfoJson))
         {
-            UE_LOG(LogArticyEditor, Error, TEXT("Failed to create package for: %s"), *FileName);
             continue;
         }
 
-        Package->FullyLoad();
-
-        // Create a new USoundWave object
-        USoundWave* NewSoundWave = NewObject<USoundWave>(Package, FName(*FileName), RF_Public | RF_Standalone);
-        if (!NewSoundWave)
+        const TOptional<FAssetImportInfo> ImportInfo = FAssetImportInfo::FromJson(ImportInfoJson);
+        if (!ImportInfo.IsSet() || ImportInfo->SourceFiles.Num() == 0)
         {
-            UE_LOG(LogArticyEditor, Error, TEXT("Failed to create USoundWave for: %s"), *FileName);
             continue;
         }
 
-        // Import the sound file
-        bool bCancelled = false;
-        USoundFactory* Factory = NewObject<USoundFactory>();
-        if (!Factory)
+        const FAssetImportInfo::FSourceFile& SourceFile = ImportInfo->SourceFiles[0];
+        if (SourceFile.Timestamp == File.Timestamp)
+        {
+            File.bUpToDate = true;
+        }
+        else if (SourceFile.FileHash.IsValid())
+        {
+            File.ImportedHash = SourceFile.FileHash;
+            FilesToHash.Add(Index);
+        }
+    }
+
+    // Files which were touched but not changed (e.g. by a fresh checkout) are found by their content
+    ParallelFor(FilesToHash.Num(), [&](int32 Index)
+    {
+        FAudioFile& File = Files[FilesToHash[Index]];
+        File.bUpToDate = FMD5Hash::HashFile(*File.FilePath) == File.ImportedHash;
+    });
+
+    TArray<FAudioFile*> FilesToImport;
+    for (FAudioFile& File : Files)
+    {
+        if (!File.bUpToDate)
+        {
+            FilesToImport.Add(&File);
+        }
+    }
+
+    UE_LOG(LogArticyEditor, Log, TEXT("Importing %d of %d audio assets, the others are up to date."), FilesToImport.Num(), Files.Num());
+    if (FilesToImport.Num() == 0)
+    {
+        return;
+    }
+
+    FScopedSlowTask SlowTask(FilesToImport.Num(), LOCTEXT("ImportingAudioAssets", "Importing audio assets"));
+    if (!FArticyEditorFunctionLibrary::GetBatchImportOptions())
+    {
+        SlowTask.MakeDialogDelayed(1.0f);
+    }
+
+    // Created once, it is only configured for the imports
+    USoundFactory* Factory = NewObject<USoundFactory>();
+    if (!Factory)
+    {
+        UE_LOG(LogArticyEditor, Error, TEXT("Failed to create USoundFactory for the audio assets"));
+        return;
+    }
+
+    Factory->SuppressImportDialogs(); // Suppress overwrite prompts
+    Factory->bAutoCreateCue = false;
+
+    int32 NumImported = 0;
+    for (const FAudioFile* File : FilesToImport)
+    {
+        SlowTask.EnterProgressFrame(1.0f, FText::FromString(File->AssetName));
+
+        // Create a new package
+        UPackage* Package = CreatePackage(*File->PackageName);
+        if (!Package)
         {
-            UE_LOG(LogArticyEditor, Error, TEXT("Failed to create USoundFactory for: %s"), *FileName);
+            UE_LOG(LogArticyEditor, Error, TEXT("Failed to create package for: %s"), *File->AssetName);
             continue;
         }
 
-        Factory->SuppressImportDialogs(); // Suppress overwrite prompts
-        Factory->bAutoCreateCue = false;
+        Package->FullyLoad();
 
-        UObject* ImportedAsset = Factory->ImportObject(NewSoundWave->GetClass(), Package, FName(*FileName), RF_Public | RF_Standalone, FilePath, nullptr, bCancelled);
+        // Import the sound file
+        bool bCancelled = false;
+        UObject* ImportedAsset = Factory->ImportObject(USoundWave::StaticClass(), Package, FName(*File->AssetName), RF_Public | RF_Standalone, File->FilePath, nullptr, bCancelled);
         if (!ImportedAsset || bCancelled)
         {
-            UE_LOG(LogArticyEditor, Error, TEXT("Failed to import sound file: %s"), *FilePath);
+            UE_LOG(LogArticyEditor, Error, TEXT("Failed to import sound file: %s"), *File->FilePath);
             continue;
         }
 
         // Notify the asset registry
-        FAssetRegistryModule::AssetCreated(NewSoundWave);
+        FAssetRegistryModule::AssetCreated(ImportedAsset);
         Package->MarkPackageDirty();
 
-        // Save the package
+        // Save the package, the files are written in the background while the next sounds are imported
         FString PackageOutFileName = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
 
 #if (ENGINE_MAJOR_VERSION >= 5)
@@ -1010,17 +1685,22 @@ void UArticyImportData::ImportAudioAssets(const FString& BaseContentDir)
         SaveArgs.Error = GError;
         SaveArgs.bForceByteSwapping = false;
         SaveArgs.bWarnOfLongFilename = false;
-        if (!UPackage::SavePackage(Package, NewSoundWave, *PackageOutFileName, SaveArgs))
+        SaveArgs.SaveFlags = SAVE_Async;
+        if (!UPackage::SavePackage(Package, ImportedAsset, *PackageOutFileName, SaveArgs))
 #else
-        if (!UPackage::SavePackage(Package, NewSoundWave, RF_Public | RF_Standalone, *PackageOutFileName, GError))
+        if (!UPackage::SavePackage(Package, ImportedAsset, RF_Public | RF_Standalone, *PackageOutFileName, GError, nullptr, false, false, SAVE_Async))
 #endif
         {
             UE_LOG(LogArticyEditor, Error, TEXT("Failed to save package: %s"), *PackageOutFileName);
             continue;
         }
 
-        UE_LOG(LogArticyEditor, Log, TEXT("Successfully imported and saved sound asset: %s"), *FileName);
+        ++NumImported;
+        UE_LOG(LogArticyEditor, Verbose, TEXT("Successfully imported and saved sound asset: %s"), *File->AssetName);
     }
+
+    UPackage::WaitForAsyncFileWrites();
+    UE_LOG(LogArticyEditor, Log, TEXT("Imported %d audio assets."), NumImported);
 }
 
 /**
@@ -1086,46 +1766,315 @@ TArray<UArticyPackage*> UArticyImportData::GetPackagesDirect()
 	return Packages;
 }
 
+namespace
+{
+	/**
+	 * Translates script fragments into C++ code by rewriting their text, for fragments FArticyExpressoTranslator can't parse.
+	 * Holds the compiled patterns; they can't be static as that crashes on application quit, so each thread uses its own translator.
+	 */
+	struct FScriptFragmentTranslator
+	{
+		FString Translate(const FString& Fragment, const bool bIsInstruction) const;
+		FString ResolveLiteralPropertyAccess(const FString& Line) const;
+
+		//match any group of two words separated by a dot, that does not start with a double quote
+		// (?<!["a-zA-Z])(\w+\.\w+)
+		const FRegexPattern unquotedWordDotWord{ TEXT("(?<![\"a-zA-Z_])([a-zA-Z_]{1}\\w+\\.\\w+)") };
+		//match an assignment operator (an = sign that does not have any of [ = < > ] before it, and no = after it)
+		const FRegexPattern assignmentOperator{ TEXT("(?<![=<>])=(?!=)") };
+
+		// regex pattern to find literal string, even if they contain escaped quotes (looks nasty if string escaped...): "([^"\\]|\\[\s\S])*" 
+		const FRegexPattern literalStringPattern{ TEXT("\"([^\"\\\\]|\\\\[\\s\\S])*\"") };
+
+		// regex patterns to match exact words "seen", "unseen" and "seenCounter"
+		const FRegexPattern seenPattern{ TEXT("\\bseen\\b") };
+		const FRegexPattern unseenPattern{ TEXT("\\bunseen\\b") };
+		const FRegexPattern seenCounterPattern{ TEXT("\\bseenCounter\\b") };
+
+		// regex pattern to find getProp and setProp calls
+		const FRegexPattern propertyCall{ TEXT("\\b(getProp|setProp)\\s*\\(") };
+	};
+
+	/** Change this whenever the translation changes, so the fragments of previous imports are translated again. */
+	constexpr int32 ScriptFragmentsTranslationVersion = 6;
+
+	/** The number of places a problem of a fragment is reported for, fragments can be used by many objects. */
+	constexpr int32 MaxReportedScriptSources = 10;
+}
+
 /**
  * Gathers scripts from the import data.
+ * Fragments which were already translated in the previous import are reused, only new ones are translated, on worker threads.
+ * Each fragment is checked against the global variables and user methods, and the problems are reported with the
+ * objects and pins the fragment is used in, before the code is generated and compiled.
  */
 void UArticyImportData::GatherScripts()
 {
-	ScriptFragments.Empty();
+	ARTICY_IMPORT_STAGE("GatherScripts");
+
+	PreviousScriptFragments = MoveTemp(ScriptFragments);
+	ScriptFragments.Reset();
+	PendingScriptFragments.Reset();
+	ScriptFragmentSources.Reset();
+
+	// The fragments are checked against the types of the variables and methods, so they are part of the hash
+	FArticyExpressoSymbols Symbols;
+	TSet<FString> UserMethodNames;
+	uint32 UserMethodsHash = 0;
+	for (const FAIDScriptMethod& Method : GetUserMethods())
+	{
+		UserMethodNames.Add(Method.Name);
+		UserMethodsHash = HashCombine(UserMethodsHash, GetTypeHash(Method.Name));
+
+		FArticyExpressoSymbols::FMethod& Overload = Symbols.Methods.FindOrAdd(Method.Name).AddDefaulted_GetRef();
+		Overload.Result = FArticyExpressoSymbols::GetType(Method.GetReturnType());
+		UserMethodsHash = HashCombine(UserMethodsHash, GetTypeHash(Overload.Result));
+		for (const FAIDScriptMethodParameter& Parameter : Method.ParameterList)
+		{
+			Overload.Parameters.Add(FArticyExpressoSymbols::GetType(Parameter.Type));
+			UserMethodsHash = HashCombine(UserMethodsHash, GetTypeHash(Overload.Parameters.Last()));
+		}
+	}
+
+	for (const FArticyGVNamespace& Namespace : GetGlobalVars().Namespaces)
+	{
+		auto& Variables = Symbols.Variables.FindOrAdd(Namespace.Namespace);
+		UserMethodsHash = HashCombine(UserMethodsHash, FCrc::StrCrc32(*Namespace.Namespace));
+		for (const FArticyGVar& Variable : Namespace.Variables)
+		{
+			Variables.Add(Variable.Variable, Variable.Type == EArticyType::ADT_Boolean ? FArticyExpressoSymbols::EType::Bool
+				: Variable.Type == EArticyType::ADT_Integer ? FArticyExpressoSymbols::EType::Int : FArticyExpressoSymbols::EType::String);
+			UserMethodsHash = HashCombine(UserMethodsHash, HashCombine(FCrc::StrCrc32(*Variable.Variable), GetTypeHash(Variable.Type)));
+		}
+	}
+
+	// Calls of pure methods don't make a fragment write state, so the fragments are translated again when they change
+	TSet<FString> PureUserMethodNames;
+	for (const FString& Method : UArticyPluginSettings::Get()->PureScriptMethods)
+	{
+		if (UserMethodNames.Contains(Method) && !PureUserMethodNames.Contains(Method))
+		{
+			PureUserMethodNames.Add(Method);
+			UserMethodsHash = HashCombine(UserMethodsHash, GetTypeHash(Method) + 1);
+		}
+	}
+
+	// Fragments which are not reused still go to the rollback journal below
+	TArray<FArticyExpressoFragment> RetiredFragments;
+	if (ScriptFragmentsVersion != ScriptFragmentsTranslationVersion || ScriptFragmentsUserMethodsHash != UserMethodsHash)
+	{
+		RetiredFragments.Reserve(PreviousScriptFragments.Num());
+		for (FArticyExpressoFragment& Fragment : PreviousScriptFragments)
+			RetiredFragments.Add(MoveTemp(Fragment));
+		PreviousScriptFragments.Reset();
+		ScriptFragmentsVersion = ScriptFragmentsTranslationVersion;
+		ScriptFragmentsUserMethodsHash = UserMethodsHash;
+	}
+
+	// Fragments referring to objects by a name which now resolves to another object (or none) are translated again
+	const TMap<FName, FArticyId> ObjectIds = PackageDefs.GetObjectIds();
+	for (auto It = PreviousScriptFragments.CreateIterator(); It; ++It)
+	{
+		for (const TPair<FName, FArticyId>& Resolved : It->ResolvedObjects)
+		{
+			const FArticyId* Id = ObjectIds.Find(Resolved.Key);
+			if (!Id || *Id != Resolved.Value)
+			{
+				RetiredFragments.Add(*It);
+				It.RemoveCurrent();
+				break;
+			}
+		}
+	}
+
 	PackageDefs.GatherScripts(this);
+
+	TArray<FArticyExpressoFragment> NewFragments = PendingScriptFragments.Array();
+	const int32 NumReused = ScriptFragments.Num();
+	PendingScriptFragments.Empty();
+
+	// The reused fragments were copied, so the previous ones can be moved to the journal
+	if (!(JournaledMembers & JournaledScriptFragments))
+	{
+		for (FArticyExpressoFragment& Fragment : RetiredFragments)
+			PreviousScriptFragments.Add(MoveTemp(Fragment));
+		RecordForRollback(JournaledScriptFragments, PreviousScriptFragments, CachedData.ScriptFragments, true);
+	}
+	RetiredFragments.Empty();
+	PreviousScriptFragments.Empty();
+
+	// Each worker takes every NumWorkers-th fragment, with its own translator
+	const int32 NumWorkers = FMath::Clamp(FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, 1, FMath::Max(NewFragments.Num(), 1));
+	ParallelFor(NumWorkers, [&](int32 Worker)
+	{
+		FArticyExpressoTranslator Translator(UserMethodNames, PureUserMethodNames, ObjectIds, &Symbols);
+		TOptional<FScriptFragmentTranslator> TextTranslator;
+		for (int32 Index = Worker; Index < NewFragments.Num(); Index += NumWorkers)
+		{
+			FArticyExpressoFragment& Fragment = NewFragments[Index];
+			if (Translator.Translate(Fragment.OriginalFragment, Fragment.bIsInstruction, Fragment.ParsedFragment, Fragment.ParsedPrologue))
+			{
+				Fragment.bWritesState = Translator.WritesState();
+				Fragment.ResolvedObjects = Translator.GetResolvedObjects();
+				Fragment.bAccessesKnown = true;
+				Fragment.ReadVariables = Translator.GetReadVariables();
+				Fragment.WrittenVariables = Translator.GetWrittenVariables();
+				Fragment.bAccessesSeenCounters = Translator.AccessesSeenCounters();
+				Fragment.bAccessesObjectProperties = Translator.AccessesObjectProperties();
+				Fragment.bCallsUserMethods = Translator.CallsUserMethods();
+				Fragment.Diagnostics = Translator.GetDiagnostics();
+				continue;
+			}
+
+			// Fragments which can't be parsed still get the text based translation, and the compiler reports what is wrong
+			Fragment.Diagnostics = { Translator.GetError() };
+			if (!TextTranslator.IsSet())
+				TextTranslator.Emplace();
+			Fragment.ParsedFragment = TextTranslator->Translate(Fragment.OriginalFragment, Fragment.bIsInstruction);
+			Fragment.ParsedPrologue.Reset();
+			Fragment.ResolvedObjects.Reset();
+			Fragment.bWritesState = true;
+			Fragment.bAccessesKnown = false;
+			Fragment.ReadVariables.Reset();
+			Fragment.WrittenVariables.Reset();
+		}
+	}, NumWorkers == 1);
+
+	for (FArticyExpressoFragment& Fragment : NewFragments)
+	{
+		ScriptFragments.Add(MoveTemp(Fragment));
+	}
+
+	UE_LOG(LogArticyEditor, Log, TEXT("Translated %d new script fragments, reused %d"), NewFragments.Num(), NumReused);
+
+	// The problems of reused fragments are reported again, they are still in the project
+	int32 NumProblems = 0;
+	for (const FArticyExpressoFragment& Fragment : ScriptFragments)
+	{
+		if (Fragment.Diagnostics.Num() == 0)
+			continue;
+
+		const TArray<FString>* Sources = ScriptFragmentSources.Find(TPair<FString, bool>(Fragment.OriginalFragment, Fragment.bIsInstruction));
+		const int32 NumSources = Sources ? Sources->Num() : 0;
+		for (const FString& Diagnostic : Fragment.Diagnostics)
+		{
+			for (int32 Index = 0; Index < FMath::Min(NumSources, MaxReportedScriptSources); ++Index)
+			{
+				if (Fragment.bAccessesKnown)
+				{
+					UE_LOG(LogArticyEditor, Error, TEXT("Script error in %s at %s: %s"), *(*Sources)[Index], *Diagnostic, *Fragment.OriginalFragment);
+				}
+				else
+				{
+					UE_LOG(LogArticyEditor, Warning, TEXT("Could not parse the script in %s (%s), translating it as text: %s"), *(*Sources)[Index], *Diagnostic, *Fragment.OriginalFragment);
+				}
+			}
+
+			if (NumSources > MaxReportedScriptSources)
+				UE_LOG(LogArticyEditor, Warning, TEXT("The script is used by %d more objects: %s"), NumSources - MaxReportedScriptSources, *Fragment.OriginalFragment);
+		}
+		NumProblems += Fragment.Diagnostics.Num();
+	}
+
+	if (NumProblems > 0)
+		UE_LOG(LogArticyEditor, Warning, TEXT("Found %d problems in the script fragments, the generated scripts may not compile."), NumProblems);
+
+	ScriptFragmentSources.Empty();
+	ScriptFragmentOwner.Reset();
 }
 
 /**
- * Adds a script fragment to the import data.
+ * Replaces a literal property argument of getProp and setProp calls with a static property access,
+ * which parses the path once and caches the reflected property (see ExpressoProperty).
+ * Calls with a property computed at runtime keep using the string overloads.
  *
- * @param Fragment The script fragment to add.
- * @param bIsInstruction Whether the fragment is an instruction.
+ * @param Line The statement to process.
+ * @return The statement with the literal property arguments replaced.
  */
-void UArticyImportData::AddScriptFragment(const FString& Fragment, const bool bIsInstruction)
+FString FScriptFragmentTranslator::ResolveLiteralPropertyAccess(const FString& Line) const
 {
-	//match any group of two words separated by a dot, that does not start with a double quote
-	// (?<!["a-zA-Z])(\w+\.\w+)
-	//NOTE: static is no good here! crashes on application quit...
-	const FRegexPattern unquotedWordDotWord(TEXT("(?<![\"a-zA-Z_])([a-zA-Z_]{1}\\w+\\.\\w+)"));
-	//match an assignment operator (an = sign that does not have any of [ = < > ] before it, and no = after it)
-	const FRegexPattern assignmentOperator(TEXT("(?<![=<>])=(?!=)"));
+	FRegexMatcher calls(propertyCall, Line);
+
+	FString result;
+	int32 copied = 0;
+	while (calls.FindNext())
+	{
+		//calls nested in the first argument of another call are not replaced
+		if (calls.GetMatchBeginning() < copied)
+			continue;
+
+		//skip the first argument
+		int32 pos = calls.GetMatchEnding();
+		int32 depth = 0;
+		bool bInLiteral = false;
+		for (; pos < Line.Len(); ++pos)
+		{
+			const TCHAR c = Line[pos];
+			if (bInLiteral)
+			{
+				if (c == '\\')
+					++pos;
+				else if (c == '"')
+					bInLiteral = false;
+			}
+			else if (c == '"')
+				bInLiteral = true;
+			else if (c == '(' || c == '[')
+				++depth;
+			else if (c == ')' || c == ']')
+			{
+				if (depth == 0)
+					break;
+				--depth;
+			}
+			else if (c == ',' && depth == 0)
+				break;
+		}
+		if (pos >= Line.Len() || Line[pos] != ',')
+			continue;
 
-	// regex pattern to find literal string, even if they contain escaped quotes (looks nasty if string escaped...): "([^"\\]|\\[\s\S])*" 
-	const FRegexPattern literalStringPattern(TEXT("\"([^\"\\\\]|\\\\[\\s\\S])*\""));
+		//the second argument has to be a literal string, and nothing else
+		int32 start = pos + 1;
+		while (start < Line.Len() && FChar::IsWhitespace(Line[start]))
+			++start;
+		if (start >= Line.Len() || Line[start] != '"')
+			continue;
 
-	// regex patterns to match exact words "seen", "unseen" and "seenCounter"
-	const FRegexPattern seenPattern(TEXT("\\bseen\\b"));
-	const FRegexPattern unseenPattern(TEXT("\\bunseen\\b"));
-	const FRegexPattern seenCounterPattern(TEXT("\\bseenCounter\\b"));
+		int32 end = start + 1;
+		while (end < Line.Len() && Line[end] != '"')
+			end += Line[end] == '\\' ? 2 : 1;
+		if (end >= Line.Len())
+			continue;
+		++end;
 
-	bool bCreateBlueprintableUserMethods = UArticyPluginSettings::Get()->bCreateBlueprintTypeForScriptMethods;
+		int32 next = end;
+		while (next < Line.Len() && FChar::IsWhitespace(Line[next]))
+			++next;
+		if (next >= Line.Len() || (Line[next] != ',' && Line[next] != ')'))
+			continue;
 
+		result += Line.Mid(copied, start - copied) + TEXT("ARTICY_EXPRESSO_PROPERTY(") + Line.Mid(start, end - start) + TEXT(")");
+		copied = end;
+	}
+
+	result += Line.Mid(copied);
+	return result;
+}
+
+/**
+ * Translates a script fragment into C++ code.
+ *
+ * @param Fragment The script fragment to translate.
+ * @param bIsInstruction Whether the fragment is an instruction.
+ * @return The translated fragment.
+ */
+FString FScriptFragmentTranslator::Translate(const FString& Fragment, const bool bIsInstruction) const
+{
 	FString string = Fragment; //Fragment.Replace(TEXT("\n"), TEXT(""));
 
 	if (string.Len() > 0)
 	{
-		static TArray<FString> lines;
-		lines.Reset();
+		TArray<FString> lines;
 		//split into lines
 		string.ParseIntoArray(lines, TEXT("\n"));
 
@@ -1163,6 +2112,9 @@ void UArticyImportData::AddScriptFragment(const FString& Fragment, const bool bI
 			// we need to offset the values from the matcher based on the changes done to "line" in the loop
 			auto offset = 0;
 
+			// literal property paths of getProp/setProp are resolved once per call site
+			line = ResolveLiteralPropertyAccess(line);
+
 			// create FStrings from literal strings
 			FRegexMatcher literalStrings(literalStringPattern, line);
 			while (literalStrings.FindNext())
@@ -1277,11 +2229,47 @@ void UArticyImportData::AddScriptFragment(const FString& Fragment, const bool bI
 		}
 	}
 
+	return string;
+}
+
+/**
+ * Adds a script fragment to the import data.
+ * The fragment is translated by GatherScripts, unless it was already translated in the previous import.
+ *
+ * @param Fragment The script fragment to add.
+ * @param bIsInstruction Whether the fragment is an instruction.
+ * @param Location The pin or property of the current owner the fragment is in, see SetScriptFragmentOwner.
+ */
+void UArticyImportData::AddScriptFragment(const FString& Fragment, const bool bIsInstruction, const FString& Location)
+{
+	if (!Fragment.IsEmpty())
+		ScriptFragmentSources.FindOrAdd(TPair<FString, bool>(Fragment, bIsInstruction)).Add(ScriptFragmentOwner + TEXT(" ") + Location);
+
 	FArticyExpressoFragment frag;
 	frag.bIsInstruction = bIsInstruction;
 	frag.OriginalFragment = *Fragment;
-	frag.ParsedFragment = string;
-	ScriptFragments.Add(frag);
+
+	if (ScriptFragments.Contains(frag) || PendingScriptFragments.Contains(frag))
+		return;
+
+	if (const FArticyExpressoFragment* Previous = PreviousScriptFragments.Find(frag))
+	{
+		ScriptFragments.Add(*Previous);
+		return;
+	}
+
+	PendingScriptFragments.Add(frag);
+}
+
+/**
+ * Sets the object the fragments added next are in, to name it in the problems GatherScripts reports.
+ *
+ * @param Id The id of the object.
+ * @param TechnicalName The technical name of the object.
+ */
+void UArticyImportData::SetScriptFragmentOwner(const FArticyId& Id, const FString& TechnicalName)
+{
+	ScriptFragmentOwner = FString::Printf(TEXT("0x%016llX (%s)"), Id.Get(), *TechnicalName);
 }
 
 /**
@@ -1294,48 +2282,54 @@ void UArticyImportData::AddChildToParentCache(const FArticyId Parent, const FArt
 {
 	// Changed because of the way Map.Find works. In original version there were cases, when first element wasn't added because children was declared out of the scope.
 	// It lead to situation when first element of children array wasn't added and for example Codex Locations weren't properly initialized
+	// The cache is rebuilt on each generation and every model is added once, so there is no need to look for duplicates
 	auto& childrenRef = ParentChildrenCache.FindOrAdd(Parent);
-	childrenRef.Values.AddUnique(Child);
+	childrenRef.Values.Add(Child);
 }
 
 /**
- * Builds a cached version of the import data.
+ * Marks the current data as the version of the last working import.
+ * The rollback journal of the import is dropped, as there is nothing to roll back to anymore.
  */
 void UArticyImportData::BuildCachedVersion()
 {
-	CachedData.Settings = this->Settings;
-	CachedData.Project = this->Project;
-	CachedData.GlobalVariables = this->GlobalVariables;
-	CachedData.ObjectDefinitions = this->ObjectDefinitions;
-	CachedData.PackageDefs = this->PackageDefs;
-	CachedData.UserMethods = this->UserMethods;
-	CachedData.Hierarchy = this->Hierarchy;
-	CachedData.Languages = this->Languages;
-	CachedData.ScriptFragments = this->ScriptFragments;
-	CachedData.ImportedPackages = this->ImportedPackages;
-	CachedData.ParentChildrenCache = this->ParentChildrenCache;
+	CachedData = FArticyImportDataStruct();
+	JournaledMembers = 0;
+	bHasCachedVersion = true;
 }
 
 /**
- * Resolves the cached version of the import data.
+ * Restores the version of the last working import, after the code generated by an import failed to compile.
+ * The members the import changed are moved back from the rollback journal, see RecordForRollback.
  */
 void UArticyImportData::ResolveCachedVersion()
 {
 	ensure(HasCachedVersion());
 
-	this->Settings = CachedData.Settings;
-	this->Project = CachedData.Project;
-	this->GlobalVariables = CachedData.GlobalVariables;
-	this->ObjectDefinitions = CachedData.ObjectDefinitions;
-	this->PackageDefs = CachedData.PackageDefs;
-	this->UserMethods = CachedData.UserMethods;
-	this->Hierarchy = CachedData.Hierarchy;
-	this->Languages = CachedData.Languages;
-	this->ScriptFragments = CachedData.ScriptFragments;
-	this->ImportedPackages = CachedData.ImportedPackages;
-	this->ParentChildrenCache = CachedData.ParentChildrenCache;
-	this->CachedData = FArticyImportDataStruct();
-	this->bHasCachedVersion = false;
+	if (JournaledMembers & JournaledSettings)
+		Settings = MoveTemp(CachedData.Settings);
+	if (JournaledMembers & JournaledProject)
+		Project = MoveTemp(CachedData.Project);
+	if (JournaledMembers & JournaledGlobalVariables)
+		GlobalVariables = MoveTemp(CachedData.GlobalVariables);
+	if (JournaledMembers & JournaledObjectDefinitions)
+		ObjectDefinitions = MoveTemp(CachedData.ObjectDefinitions);
+	if (JournaledMembers & JournaledPackageDefs)
+		PackageDefs.Rollback(CachedData.PackageDefs);
+	if (JournaledMembers & JournaledUserMethods)
+		UserMethods = MoveTemp(CachedData.UserMethods);
+	if (JournaledMembers & JournaledHierarchy)
+		Hierarchy = MoveTemp(CachedData.Hierarchy);
+	if (JournaledMembers & JournaledLanguages)
+		Languages = MoveTemp(CachedData.Languages);
+	if (JournaledMembers & JournaledScriptFragments)
+		ScriptFragments = MoveTemp(CachedData.ScriptFragments);
+	if (JournaledMembers & JournaledParentChildrenCache)
+		ParentChildrenCache = MoveTemp(CachedData.ParentChildrenCache);
+
+	CachedData = FArticyImportDataStruct();
+	JournaledMembers = 0;
+	bHasCachedVersion = false;
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,224 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyImportProfiler.h"
+#include "ArticyEditorModule.h"
+#include "ArticyHelpers.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+	/** A stage of the import, the time and calls of all its runs are summed up. */
+	struct FImportStage
+	{
+		FString Name;
+
+		/** The number of stages which were running when this one was started first. */
+		int32 Depth = 0;
+
+		int32 Calls = 0;
+		double Seconds = 0.0;
+		double StartTime = 0.0;
+
+		/** The number of runs which have not ended, a stage which runs within itself is measured by its outermost run. */
+		int32 NumRunning = 0;
+
+		/** The physical memory used by the process before the first and after the last run. */
+		uint64 UsedPhysicalBefore = 0;
+		uint64 UsedPhysicalAfter = 0;
+
+		/** The peak physical memory of the process before the first and after the last run. */
+		uint64 PeakPhysicalBefore = 0;
+		uint64 PeakPhysicalAfter = 0;
+	};
+
+	struct FImportSession
+	{
+		FString Source;
+		FDateTime Date;
+		double StartTime = 0.0;
+		TArray<FImportStage> Stages;
+		int32 NumRunningStages = 0;
+	};
+
+	TOptional<FImportSession> Session;
+
+	TSharedPtr<FJsonObject> LastSummary;
+
+	double ToMegabytes(uint64 Bytes)
+	{
+		return Bytes / (1024.0 * 1024.0);
+	}
+
+	double ToMegabytes(uint64 After, uint64 Before)
+	{
+		return ToMegabytes(After) - ToMegabytes(Before);
+	}
+
+	FImportStage* FindStage(const TCHAR* Name)
+	{
+		return Session->Stages.FindByPredicate([Name](const FImportStage& Stage) { return Stage.Name == Name; });
+	}
+
+	/** Logs the stages as a table, in the order they were started first. */
+	void LogSummary(bool bSucceeded, double TotalSeconds, const FPlatformMemoryStats& MemoryStats)
+	{
+		UE_LOG(LogArticyEditor, Log, TEXT("Articy import of '%s' %s after %.2f s, peak memory %.1f MB:"), *Session->Source,
+			bSucceeded ? TEXT("finished") : TEXT("failed"), TotalSeconds, ToMegabytes(MemoryStats.PeakUsedPhysical));
+		UE_LOG(LogArticyEditor, Log, TEXT("  %-36s %6s %12s %12s %12s"), TEXT("Stage"), TEXT("Calls"), TEXT("Time (ms)"), TEXT("Memory (MB)"), TEXT("Peak (MB)"));
+
+		for (const FImportStage& Stage : Session->Stages)
+		{
+			const FString IndentedName = FString::ChrN(Stage.Depth * 2, TEXT(' ')) + Stage.Name;
+			UE_LOG(LogArticyEditor, Log, TEXT("  %-36s %6d %12.1f %12.1f %12.1f"), *IndentedName, Stage.Calls, Stage.Seconds * 1000.0,
+				ToMegabytes(Stage.UsedPhysicalAfter, Stage.UsedPhysicalBefore), ToMegabytes(Stage.PeakPhysicalAfter));
+		}
+	}
+
+	/** Writes the stages as JSON, overwriting the summary of the previous import, and keeps it as LastSummary. */
+	void WriteSummary(bool bSucceeded, double TotalSeconds, const FPlatformMemoryStats& MemoryStats)
+	{
+		const TSharedRef<FJsonObject> Summary = MakeShared<FJsonObject>();
+		Summary->SetStringField(TEXT("Source"), Session->Source);
+		Summary->SetStringField(TEXT("Date"), Session->Date.ToIso8601());
+		Summary->SetBoolField(TEXT("Succeeded"), bSucceeded);
+		Summary->SetNumberField(TEXT("TotalMs"), TotalSeconds * 1000.0);
+		Summary->SetNumberField(TEXT("PeakUsedPhysicalMB"), ToMegabytes(MemoryStats.PeakUsedPhysical));
+
+		TArray<TSharedPtr<FJsonValue>> Stages;
+		for (const FImportStage& Stage : Session->Stages)
+		{
+			const TSharedRef<FJsonObject> StageObject = MakeShared<FJsonObject>();
+			StageObject->SetStringField(TEXT("Name"), Stage.Name);
+			StageObject->SetNumberField(TEXT("Depth"), Stage.Depth);
+			StageObject->SetNumberField(TEXT("Calls"), Stage.Calls);
+			StageObject->SetNumberField(TEXT("Ms"), Stage.Seconds * 1000.0);
+			StageObject->SetNumberField(TEXT("UsedPhysicalDeltaMB"), ToMegabytes(Stage.UsedPhysicalAfter, Stage.UsedPhysicalBefore));
+			StageObject->SetNumberField(TEXT("PeakUsedPhysicalMB"), ToMegabytes(Stage.PeakPhysicalAfter));
+			StageObject->SetNumberField(TEXT("PeakUsedPhysicalDeltaMB"), ToMegabytes(Stage.PeakPhysicalAfter, Stage.PeakPhysicalBefore));
+			Stages.Add(MakeShared<FJsonValueObject>(StageObject));
+		}
+		Summary->SetArrayField(TEXT("Stages"), Stages);
+		LastSummary = Summary;
+
+		ArticyHelpers::SaveJsonReport(Summary, ArticyHelpers::GetSavedPath(TEXT(""), TEXT("ImportTimings.json")), TEXT("import timings"));
+	}
+}
+
+/**
+ * Starts collecting the stages of an import, discarding an import which never finished.
+ * @param Source The file or operation which is imported, for the summary.
+ */
+void FArticyImportProfiler::BeginImport(const FString& Source)
+{
+	check(IsInGameThread());
+
+	if (Session.IsSet())
+	{
+		UE_LOG(LogArticyEditor, Verbose, TEXT("The Articy import of '%s' did not finish, discarding its timings."), *Session->Source);
+	}
+
+	Session.Emplace();
+	Session->Source = Source;
+	Session->Date = FDateTime::UtcNow();
+	Session->StartTime = FPlatformTime::Seconds();
+}
+
+/**
+ * Finishes the import, and logs and writes its summary. Stages which are still running end now.
+ * @param bSucceeded Whether the import succeeded.
+ */
+void FArticyImportProfiler::EndImport(bool bSucceeded)
+{
+	check(IsInGameThread());
+
+	if (!Session.IsSet())
+		return;
+
+	for (FImportStage& Stage : Session->Stages)
+	{
+		if (Stage.NumRunning > 0)
+		{
+			Stage.NumRunning = 1;
+			EndStage(*Stage.Name);
+		}
+	}
+
+	const double TotalSeconds = FPlatformTime::Seconds() - Session->StartTime;
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	LogSummary(bSucceeded, TotalSeconds, MemoryStats);
+	WriteSummary(bSucceeded, TotalSeconds, MemoryStats);
+
+	Session.Reset();
+}
+
+/** Starts a stage, or another run of it, if an import is being profiled. */
+void FArticyImportProfiler::BeginStage(const TCHAR* Name)
+{
+	check(IsInGameThread());
+
+	if (!Session.IsSet())
+		return;
+
+	FImportStage* Stage = FindStage(Name);
+	if (!Stage)
+	{
+		const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+
+		Stage = &Session->Stages.AddDefaulted_GetRef();
+		Stage->Name = Name;
+		Stage->Depth = Session->NumRunningStages;
+		Stage->UsedPhysicalBefore = MemoryStats.UsedPhysical;
+		Stage->PeakPhysicalBefore = MemoryStats.PeakUsedPhysical;
+	}
+
+	if (Stage->NumRunning++ > 0)
+		return;
+
+	Stage->StartTime = FPlatformTime::Seconds();
+	++Session->NumRunningStages;
+}
+
+/** Ends the current run of a stage, sampling the memory of the process. */
+void FArticyImportProfiler::EndStage(const TCHAR* Name)
+{
+	check(IsInGameThread());
+
+	if (!Session.IsSet())
+		return;
+
+	FImportStage* Stage = FindStage(Name);
+	if (!Stage || Stage->NumRunning == 0 || --Stage->NumRunning > 0)
+		return;
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+
+	Stage->Seconds += FPlatformTime::Seconds() - Stage->StartTime;
+	++Stage->Calls;
+	Stage->UsedPhysicalAfter = MemoryStats.UsedPhysical;
+	Stage->PeakPhysicalAfter = MemoryStats.PeakUsedPhysical;
+	--Session->NumRunningStages;
+}
+
+/** Returns true if an import was started and has not finished yet. */
+bool FArticyImportProfiler::IsImportActive()
+{
+	check(IsInGameThread());
+
+	return Session.IsSet();
+}
+
+/** Returns the summary of the last finished import, or null if no import finished yet. */
+TSharedPtr<FJsonObject> FArticyImportProfiler::GetLastSummary()
+{
+	check(IsInGameThread());
+
+	return LastSummary;
+}
@@ -0,0 +1,75 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/StatsMisc.h"
+#include "Runtime/Launch/Resources/Version.h"
+#if ENGINE_MAJOR_VERSION >= 5 || ENGINE_MINOR_VERSION >= 26
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#define ARTICY_IMPORT_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_STR(Name)
+#else
+#define ARTICY_IMPORT_TRACE_SCOPE(Name)
+#endif
+
+class FJsonObject;
+
+/**
+ * Measures an import stage until the end of the scope: as trace event for Unreal Insights, in the log (SCOPE_LOG_TIME)
+ * and in the summary of the import, see FArticyImportProfiler.
+ * @param Name The name of the stage, a string literal.
+ */
+#define ARTICY_IMPORT_STAGE(Name) \
+	ARTICY_IMPORT_TRACE_SCOPE(TEXT("ArticyImport.") TEXT(Name)); \
+	SCOPE_LOG_TIME(TEXT("Articy import stage ") TEXT(Name), nullptr); \
+	const FArticyImportProfiler::FStageScope PREPROCESSOR_JOIN(ArticyImportStage, __LINE__)(TEXT(Name))
+
+/**
+ * @class FArticyImportProfiler
+ * @brief Collects the time and memory of the stages of an import, and reports them once the import is finished.
+ *
+ * The summary is logged as a table and written as JSON to Saved/Articy/ImportTimings.json, so imports can be compared
+ * over time. Stages which run outside of an import (e.g. when regenerating assets) are only traced and logged.
+ * All functions must be called on the game thread.
+ */
+class FArticyImportProfiler
+{
+public:
+
+	/** Measures a stage for the lifetime of the scope, see ARTICY_IMPORT_STAGE. */
+	class FStageScope
+	{
+	public:
+		explicit FStageScope(const TCHAR* InName) : Name(InName) { BeginStage(Name); }
+		~FStageScope() { EndStage(Name); }
+
+	private:
+		const TCHAR* Name;
+	};
+
+	/**
+	 * Starts collecting the stages of an import. An import which was started before and never finished is discarded.
+	 * @param Source The file or operation which is imported, for the summary.
+	 */
+	static void BeginImport(const FString& Source);
+
+	/**
+	 * Finishes the import, and logs and writes its summary. Does nothing if no import was started.
+	 * @param bSucceeded Whether the import succeeded.
+	 */
+	static void EndImport(bool bSucceeded);
+
+	/** Starts a stage which does not end in the same scope, e.g. the compilation of the generated code. */
+	static void BeginStage(const TCHAR* Name);
+
+	/** Ends a stage started with BeginStage. */
+	static void EndStage(const TCHAR* Name);
+
+	/** Returns true if an import was started and has not finished yet, e.g. because the generated code is compiling. */
+	static bool IsImportActive();
+
+	/** Returns the summary of the last finished import, as written to ImportTimings.json, or null if there was none. */
+	static TSharedPtr<FJsonObject> GetLastSummary();
+};
@@ -15,6 +15,9 @@
 #include "Runtime/Launch/Resources/Version.h"
 #include "EditorFramework/AssetImportData.h"
 #include "Misc/ConfigCacheIni.h"
+#include "ArticyImportProfiler.h"
+#include "ArticyEditorFunctionLibrary.h"
+#include "ArticyPluginSettings.h"
 
 #define LOCTEXT_NAMESPACE "ArticyJSONFactory"
 
@@ -198,25 +201,41 @@ EReimportResult::Type UArticyJSONFactory::Reimport(UObject* Obj)
  */
 bool UArticyJSONFactory::ImportFromFile(const FString& FileName, UArticyImportData* Asset) const
 {
-    UArticyArchiveReader* Archive = NewObject<UArticyArchiveReader>();
-    Archive->OpenArchive(*FileName);
+    // The import is finished by UArticyImportData::PostImport, which may only run once the generated code is compiled
+    FArticyImportProfiler::BeginImport(FileName);
 
-    // Load file as text file
-    FString JSON;
-    if (!Archive->ReadFile(TEXT("manifest.json"), JSON))
+    UArticyArchiveReader* Archive = NewObject<UArticyArchiveReader>();
+    TSharedPtr<FJsonObject> JsonParsed;
     {
-        UE_LOG(LogArticyEditor, Error, TEXT("Failed to load file '%s' to string"), *FileName);
-        return false;
+        ARTICY_IMPORT_STAGE("ReadManifest");
+        Archive->OpenArchive(*FileName);
+
+        // Load file as text file
+        FString JSON;
+        if (!Archive->ReadFile(TEXT("manifest.json"), JSON))
+        {
+            UE_LOG(LogArticyEditor, Error, TEXT("Failed to load file '%s' to string"), *FileName);
+            Archive->CloseArchive();
+            FArticyImportProfiler::EndImport(false);
+            return false;
+        }
+
+        // Parse outermost JSON object
+        const TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(JSON);
+        if (!FJsonSerializer::Deserialize(JsonReader, JsonParsed))
+        {
+            JsonParsed.Reset();
+        }
     }
 
-    // Parse outermost JSON object
-    TSharedPtr<FJsonObject> JsonParsed;
-    const TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(JSON);
-    if (FJsonSerializer::Deserialize(JsonReader, JsonParsed))
+    if (!JsonParsed.IsValid() || !Asset->ImportFromJson(*Archive, JsonParsed))
     {
-        Asset->ImportFromJson(*Archive, JsonParsed);
+        FArticyImportProfiler::EndImport(false);
     }
 
+    // Release the archive file now, rather than when the reader gets garbage collected
+    Archive->CloseArchive();
+
     return true;
 }
 
@@ -234,6 +253,12 @@ bool UArticyJSONFactory::HandleImportDuringPlay(UObject* Obj)
     // If we are already queued, that means we just ended play mode. bIsPlaying will still be true in this case, so we need another check
     if (bIsPlaying && !ArticyImporterModule.IsImportQueued())
     {
+        // Content changes are imported right away, and the import reloads the changed packages into the running game
+        if (CanHotPatchDuringPlay(Obj))
+        {
+            return false;
+        }
+
         // We have to abuse the module to queue the import since this factory might not exist later on
         ArticyImporterModule.QueueImport();
         return true;
@@ -242,4 +267,30 @@ bool UArticyJSONFactory::HandleImportDuringPlay(UObject* Obj)
     return false;
 }
 
+/**
+ * Checks whether a reimport during play can be patched into the running game: the export must belong to the
+ * same project and must not change anything the generated code depends on, as code cannot be compiled during play.
+ *
+ * @param Obj The object to reimport.
+ * @return true if the import can run now, false if it has to wait until play ends.
+ */
+bool UArticyJSONFactory::CanHotPatchDuringPlay(UObject* Obj)
+{
+    UArticyImportData* ImportData = Cast<UArticyImportData>(Obj);
+    if (!UArticyPluginSettings::Get()->bHotPatchPackagesDuringPlay || !ImportData || !ImportData->ImportData
+        || ImportData->ImportData->GetFirstFilename().IsEmpty())
+    {
+        return false;
+    }
+
+    FArticyImportDryRunReport Report;
+    if (!FArticyEditorFunctionLibrary::DryRunImport(Report, ImportData) || Report.bProjectChanged || Report.bNeedsCodeGeneration)
+    {
+        return false;
+    }
+
+    UE_LOG(LogArticyEditor, Display, TEXT("Only the content of packages changed, hot-patching them into the running game."));
+    return true;
+}
+
 #undef LOCTEXT_NAMESPACE
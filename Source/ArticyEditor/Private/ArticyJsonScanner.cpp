@@ -0,0 +1,327 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyJsonScanner.h"
+#include "Containers/StringConv.h"
+
+namespace
+{
+	bool IsWhitespace(uint8 Char)
+	{
+		return Char == ' ' || Char == '\t' || Char == '\n' || Char == '\r';
+	}
+
+	/** Appends UTF-8 bytes to a string. */
+	void AppendUTF8(FString& Out, const uint8* Begin, int32 Count)
+	{
+		if (Count <= 0)
+			return;
+
+		const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Begin), Count);
+		Out.AppendChars(Converted.Get(), Converted.Length());
+	}
+
+	int32 HexDigit(uint8 Char)
+	{
+		if (Char >= '0' && Char <= '9') return Char - '0';
+		if (Char >= 'a' && Char <= 'f') return Char - 'a' + 10;
+		if (Char >= 'A' && Char <= 'F') return Char - 'A' + 10;
+		return -1;
+	}
+}
+
+FArticyJsonScanner::FArticyJsonScanner(TArrayView<const uint8> InBytes) : Bytes(InBytes)
+{
+	// Skip the byte order mark, if any
+	if (Bytes.Num() >= 3 && Bytes[0] == 0xEF && Bytes[1] == 0xBB && Bytes[2] == 0xBF)
+		Position = 3;
+}
+
+void FArticyJsonScanner::SkipWhitespace()
+{
+	while (Position < Bytes.Num() && IsWhitespace(Bytes[Position]))
+		++Position;
+}
+
+bool FArticyJsonScanner::Expect(uint8 Char)
+{
+	SkipWhitespace();
+	if (bError || Position >= Bytes.Num() || Bytes[Position] != Char)
+		return Fail();
+
+	++Position;
+	return true;
+}
+
+/**
+ * Advances to the next member of the current object.
+ * @param OutKey Receives the key of the member, the scanner is then positioned at its value.
+ * @return False at the end of the object (which is consumed) or on an error.
+ */
+bool FArticyJsonScanner::NextMember(FString& OutKey)
+{
+	SkipWhitespace();
+	if (bError || Position >= Bytes.Num())
+		return Fail();
+
+	if (Bytes[Position] == '}')
+	{
+		++Position;
+		return false;
+	}
+
+	if (Bytes[Position] == ',')
+	{
+		++Position;
+		SkipWhitespace();
+	}
+
+	if (Position >= Bytes.Num() || Bytes[Position] != '"' || !ReadString(OutKey))
+		return Fail();
+
+	return Expect(':');
+}
+
+/**
+ * Advances to the next element of the current array.
+ * @return False at the end of the array (which is consumed) or on an error.
+ */
+bool FArticyJsonScanner::NextElement()
+{
+	SkipWhitespace();
+	if (bError || Position >= Bytes.Num())
+		return Fail();
+
+	if (Bytes[Position] == ']')
+	{
+		++Position;
+		return false;
+	}
+
+	if (Bytes[Position] == ',')
+	{
+		++Position;
+		SkipWhitespace();
+	}
+
+	return Position < Bytes.Num() || Fail();
+}
+
+/**
+ * Reads a value as string, unescaping it. Runs without escapes are converted from UTF-8 in one go.
+ * @param OutString Receives the string.
+ * @return False if the value is an object or array (which is skipped), or on an error.
+ */
+bool FArticyJsonScanner::ReadString(FString& OutString)
+{
+	OutString.Reset();
+
+	SkipWhitespace();
+	if (bError || Position >= Bytes.Num())
+		return Fail();
+
+	const uint8 First = Bytes[Position];
+	if (First == '{' || First == '[')
+	{
+		SkipValue();
+		return false;
+	}
+
+	if (First != '"')
+	{
+		int32 Begin, End;
+		if (!ReadToken(Begin, End))
+			return false;
+
+		AppendUTF8(OutString, Bytes.GetData() + Begin, End - Begin);
+		return true;
+	}
+
+	int32 RunStart = ++Position;
+	while (Position < Bytes.Num())
+	{
+		const uint8 Char = Bytes[Position];
+		if (Char == '"')
+		{
+			AppendUTF8(OutString, Bytes.GetData() + RunStart, Position - RunStart);
+			++Position;
+			return true;
+		}
+
+		if (Char != '\\')
+		{
+			++Position;
+			continue;
+		}
+
+		AppendUTF8(OutString, Bytes.GetData() + RunStart, Position - RunStart);
+		if (Position + 1 >= Bytes.Num())
+			return Fail();
+
+		const uint8 Escaped = Bytes[Position + 1];
+		Position += 2;
+		switch (Escaped)
+		{
+		case '"': OutString.AppendChar(TEXT('"')); break;
+		case '\\': OutString.AppendChar(TEXT('\\')); break;
+		case '/': OutString.AppendChar(TEXT('/')); break;
+		case 'b': OutString.AppendChar(TEXT('\b')); break;
+		case 'f': OutString.AppendChar(TEXT('\f')); break;
+		case 'n': OutString.AppendChar(TEXT('\n')); break;
+		case 'r': OutString.AppendChar(TEXT('\r')); break;
+		case 't': OutString.AppendChar(TEXT('\t')); break;
+		case 'u':
+		{
+			// TCHAR is UTF-16, so surrogate pairs are appended as the two escapes they are written as
+			if (Position + 4 > Bytes.Num())
+				return Fail();
+
+			int32 CodeUnit = 0;
+			for (int32 Digit = 0; Digit < 4; ++Digit)
+			{
+				const int32 Value = HexDigit(Bytes[Position + Digit]);
+				if (Value < 0)
+					return Fail();
+				CodeUnit = CodeUnit * 16 + Value;
+			}
+			Position += 4;
+			OutString.AppendChar(static_cast<TCHAR>(CodeUnit));
+			break;
+		}
+		default:
+			return Fail();
+		}
+		RunStart = Position;
+	}
+
+	return Fail();
+}
+
+/** Skips a value of any type. */
+bool FArticyJsonScanner::SkipValue()
+{
+	SkipWhitespace();
+	if (bError || Position >= Bytes.Num())
+		return Fail();
+
+	const uint8 First = Bytes[Position];
+	if (First == '"')
+		return SkipString();
+
+	if (First != '{' && First != '[')
+	{
+		int32 Begin, End;
+		return ReadToken(Begin, End);
+	}
+
+	// Objects and arrays only need their brackets balanced, strings are skipped as a whole
+	int32 Depth = 0;
+	while (Position < Bytes.Num())
+	{
+		const uint8 Char = Bytes[Position];
+		if (Char == '"')
+		{
+			if (!SkipString())
+				return false;
+			continue;
+		}
+
+		++Position;
+		if (Char == '{' || Char == '[')
+		{
+			++Depth;
+		}
+		else if (Char == '}' || Char == ']')
+		{
+			if (--Depth == 0)
+				return true;
+		}
+	}
+
+	return Fail();
+}
+
+/**
+ * Reads a value of any type as condensed JSON text.
+ * @param OutJson Receives the JSON text.
+ */
+bool FArticyJsonScanner::ReadRawValue(FString& OutJson)
+{
+	const int32 Begin = GetPosition();
+	if (!SkipValue())
+		return false;
+
+	OutJson = GetCondensed(Begin, Position);
+	return true;
+}
+
+/**
+ * Reads a value of any type as condensed UTF-8 JSON text.
+ * @param OutUtf8 Receives the JSON text.
+ */
+bool FArticyJsonScanner::ReadRawValue(TArray<uint8>& OutUtf8)
+{
+	const int32 Begin = GetPosition();
+	if (!SkipValue())
+		return false;
+
+	OutUtf8 = GetCondensedUTF8(Begin, Position);
+	return true;
+}
+
+/** Returns the condensed JSON text between two positions. */
+FString FArticyJsonScanner::GetCondensed(int32 Begin, int32 End) const
+{
+	FString Result;
+	if (Begin < 0 || End > Bytes.Num() || Begin >= End)
+		return Result;
+
+	Result.Reserve(End - Begin);
+	ForEachCondensedRun(Begin, End, [&](const uint8* Run, int32 Count) { AppendUTF8(Result, Run, Count); });
+
+	return Result;
+}
+
+/** Returns the condensed JSON text between two positions as UTF-8. */
+TArray<uint8> FArticyJsonScanner::GetCondensedUTF8(int32 Begin, int32 End) const
+{
+	TArray<uint8> Result;
+	if (Begin < 0 || End > Bytes.Num() || Begin >= End)
+		return Result;
+
+	Result.Reserve(End - Begin);
+	ForEachCondensedRun(Begin, End, [&](const uint8* Run, int32 Count) { Result.Append(Run, Count); });
+
+	return Result;
+}
+
+bool FArticyJsonScanner::SkipString()
+{
+	++Position;
+	while (Position < Bytes.Num())
+	{
+		const uint8 Char = Bytes[Position++];
+		if (Char == '\\')
+			++Position;
+		else if (Char == '"')
+			return true;
+	}
+
+	return Fail();
+}
+
+bool FArticyJsonScanner::ReadToken(int32& OutBegin, int32& OutEnd)
+{
+	OutBegin = Position;
+	while (Position < Bytes.Num())
+	{
+		const uint8 Char = Bytes[Position];
+		if (IsWhitespace(Char) || Char == ',' || Char == '}' || Char == ']' || Char == ':')
+			break;
+		++Position;
+	}
+	OutEnd = Position;
+
+	return OutEnd > OutBegin || Fail();
+}
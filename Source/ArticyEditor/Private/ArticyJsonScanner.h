@@ -0,0 +1,121 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @class FArticyJsonScanner
+ * @brief A forward-only JSON reader working directly on UTF-8 bytes, without building a DOM.
+ *
+ * Used for the large files of the export, where only a few fields are needed right away and the rest is kept as
+ * raw JSON. All functions return false on malformed input, after which the scanner stays in the error state.
+ */
+class FArticyJsonScanner
+{
+public:
+
+	explicit FArticyJsonScanner(TArrayView<const uint8> InBytes);
+
+	/** Consumes the '{' of an object. */
+	bool BeginObject() { return Expect('{'); }
+
+	/**
+	 * Advances to the next member of the current object.
+	 * @param OutKey Receives the key of the member, the scanner is then positioned at its value.
+	 * @return False at the end of the object (which is consumed) or on an error.
+	 */
+	bool NextMember(FString& OutKey);
+
+	/** Consumes the '[' of an array. */
+	bool BeginArray() { return Expect('['); }
+
+	/**
+	 * Advances to the next element of the current array.
+	 * @return False at the end of the array (which is consumed) or on an error.
+	 */
+	bool NextElement();
+
+	/**
+	 * Reads a value as string. Numbers, booleans and null are returned as they are written, like TryGetStringField.
+	 * @param OutString Receives the string.
+	 * @return False if the value is an object or array (which is skipped), or on an error.
+	 */
+	bool ReadString(FString& OutString);
+
+	/** Returns true if the next value is an object. */
+	bool IsObjectNext() { SkipWhitespace(); return !bError && Position < Bytes.Num() && Bytes[Position] == '{'; }
+
+	/** Skips a value of any type. */
+	bool SkipValue();
+
+	/**
+	 * Reads a value of any type as condensed JSON text, i.e. without insignificant whitespace.
+	 * @param OutJson Receives the JSON text.
+	 */
+	bool ReadRawValue(FString& OutJson);
+
+	/** Reads a value of any type as condensed UTF-8 JSON text, see ReadRawValue. */
+	bool ReadRawValue(TArray<uint8>& OutUtf8);
+
+	/** Returns the position of the next value, see ReadRawValue. */
+	int32 GetPosition() { SkipWhitespace(); return Position; }
+
+	/** Returns the condensed JSON text between two positions, e.g. of a value which was scanned member by member. */
+	FString GetCondensed(int32 Begin, int32 End) const;
+
+	/** Returns the condensed JSON text between two positions as UTF-8, like it is in the input. */
+	TArray<uint8> GetCondensedUTF8(int32 Begin, int32 End) const;
+
+	/** Returns true if malformed input was found. */
+	bool HasError() const { return bError; }
+
+private:
+
+	void SkipWhitespace();
+	bool Expect(uint8 Char);
+	bool Fail() { bError = true; return false; }
+
+	/** Skips a string, the scanner is positioned at its opening quote. */
+	bool SkipString();
+
+	/** Skips a number or literal, returning its text. */
+	bool ReadToken(int32& OutBegin, int32& OutEnd);
+
+	/** Calls Append for the runs of bytes between two positions which are not whitespace between tokens. */
+	template<typename TAppend>
+	void ForEachCondensedRun(int32 Begin, int32 End, TAppend&& Append) const
+	{
+		bool bInString = false;
+		int32 RunStart = Begin;
+		for (int32 Index = Begin; Index < End; ++Index)
+		{
+			const uint8 Char = Bytes[Index];
+			if (bInString)
+			{
+				if (Char == '\\')
+					++Index;
+				else if (Char == '"')
+					bInString = false;
+			}
+			else if (Char == '"')
+			{
+				bInString = true;
+			}
+			else if (Char == ' ' || Char == '\t' || Char == '\n' || Char == '\r')
+			{
+				if (Index > RunStart)
+					Append(Bytes.GetData() + RunStart, Index - RunStart);
+				RunStart = Index + 1;
+			}
+		}
+		if (End > RunStart)
+			Append(Bytes.GetData() + RunStart, End - RunStart);
+	}
+
+	TArrayView<const uint8> Bytes;
+	int32 Position = 0;
+	bool bError = false;
+};
@@ -0,0 +1,422 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyObjectIndexSubsystem.h"
+#include "ArticyEditorModule.h"
+#include "ArticyObject.h"
+#include "ArticyPackage.h"
+#include "Interfaces/ArticyObjectWithSpeaker.h"
+#include "Slate/ArticyFilterHelpers.h"
+#include "Editor.h"
+#include "Runtime/Launch/Resources/Version.h"
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
+#include "AssetRegistry/AssetRegistryModule.h"
+#else
+#include "AssetRegistryModule.h"
+#endif
+
+/**
+ * Registers for the events which outdate the index. The index itself is built on the first lookup.
+ *
+ * @param Collection The collection of subsystems.
+ */
+void UArticyObjectIndexSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	AssetsGeneratedHandle = FArticyEditorModule::Get().OnAssetsGenerated.AddUObject(this, &UArticyObjectIndexSubsystem::Invalidate);
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(AssetRegistryConstants::ModuleName).Get();
+	AssetAddedHandle = AssetRegistry.OnAssetAdded().AddUObject(this, &UArticyObjectIndexSubsystem::OnAssetChanged);
+	AssetRemovedHandle = AssetRegistry.OnAssetRemoved().AddUObject(this, &UArticyObjectIndexSubsystem::OnAssetChanged);
+	AssetRenamedHandle = AssetRegistry.OnAssetRenamed().AddUObject(this, &UArticyObjectIndexSubsystem::OnAssetRenamed);
+}
+
+/**
+ * Unregisters from the events, the modules may already be unloaded when the editor shuts down.
+ */
+void UArticyObjectIndexSubsystem::Deinitialize()
+{
+	if (FArticyEditorModule* ArticyEditorModule = FModuleManager::GetModulePtr<FArticyEditorModule>(TEXT("ArticyEditor")))
+	{
+		ArticyEditorModule->OnAssetsGenerated.Remove(AssetsGeneratedHandle);
+	}
+
+	if (FAssetRegistryModule* AssetRegistryModule = FModuleManager::GetModulePtr<FAssetRegistryModule>(AssetRegistryConstants::ModuleName))
+	{
+		IAssetRegistry& AssetRegistry = AssetRegistryModule->Get();
+		AssetRegistry.OnAssetAdded().Remove(AssetAddedHandle);
+		AssetRegistry.OnAssetRemoved().Remove(AssetRemovedHandle);
+		AssetRegistry.OnAssetRenamed().Remove(AssetRenamedHandle);
+	}
+
+	Packages.Empty();
+	ObjectsById.Empty();
+	ObjectsByName.Empty();
+	SearchIndex.Reset();
+
+	Super::Deinitialize();
+}
+
+/**
+ * Returns the index of the editor.
+ *
+ * @return The index, or null if there is no editor.
+ */
+UArticyObjectIndexSubsystem* UArticyObjectIndexSubsystem::Get()
+{
+	return GEditor ? GEditor->GetEditorSubsystem<UArticyObjectIndexSubsystem>() : nullptr;
+}
+
+/**
+ * Finds an articy object by its ID, falling back to UArticyObject::FindAsset if there is no editor.
+ *
+ * @param Id The ID of the articy object.
+ * @return The articy object, or nullptr if there is none with this ID.
+ */
+UArticyObject* UArticyObjectIndexSubsystem::FindAsset(const FArticyId& Id)
+{
+	if (UArticyObjectIndexSubsystem* Index = Get())
+	{
+		return Index->FindObject(Id);
+	}
+
+	return UArticyObject::FindAsset(Id);
+}
+
+/**
+ * Finds an articy object by its technical name, falling back to UArticyObject::FindAsset if there is no editor.
+ *
+ * @param TechnicalName The technical name of the articy object.
+ * @return The articy object, or nullptr if there is none with this name.
+ */
+UArticyObject* UArticyObjectIndexSubsystem::FindAsset(const FName& TechnicalName)
+{
+	if (UArticyObjectIndexSubsystem* Index = Get())
+	{
+		return Index->FindObject(TechnicalName);
+	}
+
+	return UArticyObject::FindAsset(TechnicalName.ToString());
+}
+
+/**
+ * Finds an articy object of the index by its ID.
+ * An object which was destroyed (e.g. its package was unloaded) outdates the index, so it is looked up once more.
+ *
+ * @param Id The ID of the articy object.
+ * @return The articy object, or nullptr if there is none with this ID.
+ */
+UArticyObject* UArticyObjectIndexSubsystem::FindObject(const FArticyId& Id)
+{
+	if (Id.IsNull())
+		return nullptr;
+
+	if (!bOutdated)
+	{
+		const TWeakObjectPtr<UArticyObject>* Object = ObjectsById.Find(Id);
+		if (!Object)
+			return nullptr;
+		if (Object->IsValid())
+			return Object->Get();
+
+		bOutdated = true;
+	}
+
+	Update();
+
+	const TWeakObjectPtr<UArticyObject>* Object = ObjectsById.Find(Id);
+	return Object ? Object->Get() : nullptr;
+}
+
+/**
+ * Finds an articy object of the index by its technical name.
+ *
+ * @param TechnicalName The technical name of the articy object.
+ * @return The articy object, or nullptr if there is none with this name.
+ */
+UArticyObject* UArticyObjectIndexSubsystem::FindObject(const FName& TechnicalName)
+{
+	if (TechnicalName.IsNone())
+		return nullptr;
+
+	if (!bOutdated)
+	{
+		const TWeakObjectPtr<UArticyObject>* Object = ObjectsByName.Find(TechnicalName);
+		if (!Object)
+			return nullptr;
+		if (Object->IsValid())
+			return Object->Get();
+
+		bOutdated = true;
+	}
+
+	Update();
+
+	const TWeakObjectPtr<UArticyObject>* Object = ObjectsByName.Find(TechnicalName);
+	return Object ? Object->Get() : nullptr;
+}
+
+/**
+ * Returns the references to an articy object from the indexed packages.
+ *
+ * @param Id The ID of the referenced object.
+ * @return The references, empty if there are none or the packages were imported before the references were indexed.
+ */
+TArray<FArticyIncomingReference> UArticyObjectIndexSubsystem::GetIncomingReferences(const FArticyId& Id)
+{
+	if (bOutdated)
+	{
+		Update();
+	}
+
+	TArray<FArticyIncomingReference> References;
+	for (const TPair<FName, FIndexedPackage>& Pair : Packages)
+	{
+		const UArticyPackage* Package = Pair.Value.Package.Get();
+		if (const TArray<FArticyIncomingReference>* Found = Package ? Package->GetReferenceIndex().Find(Id) : nullptr)
+		{
+			References.Append(*Found);
+		}
+	}
+
+	return References;
+}
+
+/**
+ * Returns the search entries of all indexed objects. The entries of the packages which were indexed again are
+ * gathered now, the ones of the other packages are shared with the previous search index.
+ *
+ * @return The search index, which is not changed anymore once returned.
+ */
+TSharedRef<const FArticyObjectSearchIndex, ESPMode::ThreadSafe> UArticyObjectIndexSubsystem::GetSearchIndex()
+{
+	if (bOutdated)
+	{
+		Update();
+	}
+
+	bool bChanged = !SearchIndex.IsValid() || SearchIndex->Packages.Num() != Packages.Num();
+	for (TPair<FName, FIndexedPackage>& Pair : Packages)
+	{
+		FIndexedPackage& Indexed = Pair.Value;
+		if (Indexed.SearchEntries.IsValid())
+			continue;
+
+		TSharedRef<TArray<FArticyObjectSearchEntry>, ESPMode::ThreadSafe> Entries = MakeShared<TArray<FArticyObjectSearchEntry>, ESPMode::ThreadSafe>();
+		Entries->Reserve(Indexed.Objects.Num());
+		for (const TWeakObjectPtr<UArticyObject>& Object : Indexed.Objects)
+		{
+			UArticyObject* Asset = Object.Get();
+			if (!Asset)
+				continue;
+
+			// The speaker is looked up without FindObject, which could update the packages while they are iterated
+			const IArticyObjectWithSpeaker* ObjectWithSpeaker = Cast<IArticyObjectWithSpeaker>(Asset);
+			const TWeakObjectPtr<UArticyObject>* Speaker = ObjectWithSpeaker ? ObjectsById.Find(ObjectWithSpeaker->GetSpeakerId()) : nullptr;
+			Entries->Emplace(Asset, Speaker ? Speaker->Get() : nullptr);
+		}
+
+		Indexed.SearchEntries = Entries;
+		bChanged = true;
+	}
+
+	if (bChanged)
+	{
+		TSharedRef<FArticyObjectSearchIndex, ESPMode::ThreadSafe> NewSearchIndex = MakeShared<FArticyObjectSearchIndex, ESPMode::ThreadSafe>();
+		NewSearchIndex->Packages.Reserve(Packages.Num());
+		for (const TPair<FName, FIndexedPackage>& Pair : Packages)
+		{
+			NewSearchIndex->Packages.Add(Pair.Value.SearchEntries.ToSharedRef());
+			NewSearchIndex->NumEntries += Pair.Value.SearchEntries->Num();
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		NewSearchIndex->TokenIndex.Build(NewSearchIndex->Packages);
+		UE_LOG(LogArticyEditor, Verbose, TEXT("Indexed %d words of %d articy objects for searching in %.1f ms"), NewSearchIndex->TokenIndex.GetNumTokens(),
+			NewSearchIndex->NumEntries, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+		SearchIndex = NewSearchIndex;
+	}
+
+	return SearchIndex.ToSharedRef();
+}
+
+/**
+ * Brings the index up to date with the packages of the asset registry.
+ * Packages are only loaded if they are not loaded yet, and only indexed again if their objects changed.
+ */
+void UArticyObjectIndexSubsystem::Update()
+{
+	bOutdated = false;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(AssetRegistryConstants::ModuleName).Get();
+	TArray<FAssetData> AssetData;
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
+	AssetRegistry.GetAssetsByClass(UArticyPackage::StaticClass()->GetClassPathName(), AssetData, true);
+#else
+	AssetRegistry.GetAssetsByClass(UArticyPackage::StaticClass()->GetFName(), AssetData, true);
+#endif
+
+	TSet<FName> PackageNames;
+	int32 NumIndexed = 0;
+	for (const FAssetData& PackageData : AssetData)
+	{
+		PackageNames.Add(PackageData.PackageName);
+
+		FIndexedPackage* Indexed = Packages.Find(PackageData.PackageName);
+		UArticyPackage* Package = Indexed && Indexed->Package.IsValid() ? Indexed->Package.Get() : Cast<UArticyPackage>(PackageData.GetAsset());
+		if (Indexed && IsIndexed(*Indexed, Package))
+			continue;
+
+		if (Indexed)
+		{
+			RemovePackage(*Indexed);
+			Indexed->SearchEntries.Reset();
+		}
+		else
+		{
+			Indexed = &Packages.Add(PackageData.PackageName);
+		}
+
+		if (Package)
+		{
+			AddPackage(*Indexed, Package);
+			++NumIndexed;
+		}
+	}
+
+	// Remove the packages which are not in the asset registry anymore
+	for (auto It = Packages.CreateIterator(); It; ++It)
+	{
+		if (!PackageNames.Contains(It->Key))
+		{
+			RemovePackage(It->Value);
+			It.RemoveCurrent();
+		}
+	}
+
+	UE_LOG(LogArticyEditor, Verbose, TEXT("Indexed %d of %d articy packages with %d objects in %.1f ms"), NumIndexed, AssetData.Num(),
+		ObjectsById.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+/**
+ * Checks whether the objects of the package are still the indexed ones.
+ * Generated packages reuse their objects, so their IDs and names are compared as well.
+ *
+ * @param Indexed The package as it was indexed.
+ * @param Package The package as it is now, may be null.
+ * @return True if the package does not need to be indexed again.
+ */
+bool UArticyObjectIndexSubsystem::IsIndexed(const FIndexedPackage& Indexed, UArticyPackage* Package)
+{
+	if (!Package || Indexed.Package.Get() != Package)
+		return false;
+
+	const TArray<UArticyObject*> Assets = Package->GetAssets();
+	int32 ObjectIndex = 0;
+	for (const UArticyObject* Asset : Assets)
+	{
+		if (!Asset || !Asset->WasLoaded())
+			continue;
+
+		if (!Indexed.Objects.IsValidIndex(ObjectIndex)
+			|| Indexed.Objects[ObjectIndex].Get() != Asset
+			|| Indexed.Ids[ObjectIndex] != Asset->GetId()
+			|| Indexed.Names[ObjectIndex] != Asset->GetTechnicalName())
+		{
+			return false;
+		}
+		++ObjectIndex;
+	}
+
+	return ObjectIndex == Indexed.Objects.Num();
+}
+
+/**
+ * Adds the objects of a package to the index. Like in UArticyObject::FindAsset, the first package with an object wins.
+ *
+ * @param Indexed Receives the indexed objects of the package.
+ * @param Package The package to index.
+ */
+void UArticyObjectIndexSubsystem::AddPackage(FIndexedPackage& Indexed, UArticyPackage* Package)
+{
+	Indexed.Package = Package;
+	Indexed.SearchEntries.Reset();
+
+	const TArray<UArticyObject*> Assets = Package->GetAssets();
+	Indexed.Objects.Reset(Assets.Num());
+	Indexed.Ids.Reset(Assets.Num());
+	Indexed.Names.Reset(Assets.Num());
+	ObjectsById.Reserve(ObjectsById.Num() + Assets.Num());
+	ObjectsByName.Reserve(ObjectsByName.Num() + Assets.Num());
+
+	for (UArticyObject* Asset : Assets)
+	{
+		if (!Asset || !Asset->WasLoaded())
+			continue;
+
+		const FArticyId Id = Asset->GetId();
+		const FName Name = Asset->GetTechnicalName();
+		Indexed.Objects.Add(Asset);
+		Indexed.Ids.Add(Id);
+		Indexed.Names.Add(Name);
+
+		if (!ObjectsById.Contains(Id))
+			ObjectsById.Add(Id, Asset);
+		if (!ObjectsByName.Contains(Name))
+			ObjectsByName.Add(Name, Asset);
+	}
+}
+
+/**
+ * Removes the objects of a package from the index, unless they were indexed from another package.
+ *
+ * @param Indexed The package as it was indexed.
+ */
+void UArticyObjectIndexSubsystem::RemovePackage(const FIndexedPackage& Indexed)
+{
+	for (int32 ObjectIndex = 0; ObjectIndex < Indexed.Objects.Num(); ++ObjectIndex)
+	{
+		const TWeakObjectPtr<UArticyObject>& Object = Indexed.Objects[ObjectIndex];
+
+		const TWeakObjectPtr<UArticyObject>* ById = ObjectsById.Find(Indexed.Ids[ObjectIndex]);
+		if (ById && *ById == Object)
+			ObjectsById.Remove(Indexed.Ids[ObjectIndex]);
+
+		const TWeakObjectPtr<UArticyObject>* ByName = ObjectsByName.Find(Indexed.Names[ObjectIndex]);
+		if (ByName && *ByName == Object)
+			ObjectsByName.Remove(Indexed.Names[ObjectIndex]);
+	}
+}
+
+/**
+ * Outdates the index if a package was added to or removed from the asset registry.
+ *
+ * @param AssetData The asset which was added or removed.
+ */
+void UArticyObjectIndexSubsystem::OnAssetChanged(const FAssetData& AssetData)
+{
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
+	if (AssetData.AssetClassPath == UArticyPackage::StaticClass()->GetClassPathName())
+#else
+	if (AssetData.AssetClass == UArticyPackage::StaticClass()->GetFName())
+#endif
+	{
+		bOutdated = true;
+	}
+}
+
+/**
+ * Outdates the index if a package was renamed.
+ *
+ * @param AssetData The renamed asset.
+ * @param OldObjectPath The previous path of the asset.
+ */
+void UArticyObjectIndexSubsystem::OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath)
+{
+	OnAssetChanged(AssetData);
+}
@@ -0,0 +1,171 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyPreviewCacheSubsystem.h"
+#include "ArticyAsset.h"
+#include "ArticyEditorModule.h"
+#include "ArticyObjectIndexSubsystem.h"
+#include "Editor.h"
+#include "Engine/Texture2D.h"
+
+/**
+ * Registers for the events which outdate the cached images.
+ *
+ * @param Collection The collection of subsystems.
+ */
+void UArticyPreviewCacheSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	AssetsGeneratedHandle = FArticyEditorModule::Get().OnAssetsGenerated.AddUObject(this, &UArticyPreviewCacheSubsystem::Empty);
+	AssetsPreDeleteHandle = FEditorDelegates::OnAssetsPreDelete.AddUObject(this, &UArticyPreviewCacheSubsystem::OnAssetsPreDelete);
+}
+
+/**
+ * Unregisters from the events, the modules may already be unloaded when the editor shuts down.
+ */
+void UArticyPreviewCacheSubsystem::Deinitialize()
+{
+	if (FArticyEditorModule* ArticyEditorModule = FModuleManager::GetModulePtr<FArticyEditorModule>(TEXT("ArticyEditor")))
+	{
+		ArticyEditorModule->OnAssetsGenerated.Remove(AssetsGeneratedHandle);
+	}
+	FEditorDelegates::OnAssetsPreDelete.Remove(AssetsPreDeleteHandle);
+
+	Images.Empty();
+
+	Super::Deinitialize();
+}
+
+/**
+ * Returns the cache of the editor.
+ *
+ * @return The cache, or null if there is no editor.
+ */
+UArticyPreviewCacheSubsystem* UArticyPreviewCacheSubsystem::Get()
+{
+	return GEditor ? GEditor->GetEditorSubsystem<UArticyPreviewCacheSubsystem>() : nullptr;
+}
+
+/**
+ * Finds the preview image of an articy asset, loading it synchronously if there is no editor.
+ *
+ * @param AssetId The ID of the articy asset of the preview image.
+ * @return The texture, or null if it is still loading or there is none.
+ */
+UTexture2D* UArticyPreviewCacheSubsystem::FindPreviewImage(const FArticyId& AssetId)
+{
+	if (UArticyPreviewCacheSubsystem* Cache = Get())
+	{
+		return Cache->FindOrLoad(AssetId);
+	}
+
+	const UArticyAsset* Asset = Cast<UArticyAsset>(UArticyObjectIndexSubsystem::FindAsset(AssetId));
+	return Asset ? Asset->LoadAsTexture2D() : nullptr;
+}
+
+/**
+ * Finds a preview image of the cache, and starts loading it in the background if it is not cached yet.
+ *
+ * @param AssetId The ID of the articy asset of the preview image.
+ * @return The texture, or null if it is still loading or there is none.
+ */
+UTexture2D* UArticyPreviewCacheSubsystem::FindOrLoad(const FArticyId& AssetId)
+{
+	if (AssetId.IsNull())
+		return nullptr;
+
+	if (FArticyCachedPreviewImage* Image = Images.Find(AssetId))
+	{
+		Image->LastUsed = ++UseCounter;
+		return Image->Texture;
+	}
+
+	const UArticyAsset* Asset = Cast<UArticyAsset>(UArticyObjectIndexSubsystem::FindAsset(AssetId));
+	if (!Asset)
+		return nullptr;
+
+	RemoveLeastRecentlyUsed();
+
+	FArticyCachedPreviewImage& Image = Images.Add(AssetId);
+	Image.bLoading = true;
+	Image.LastUsed = ++UseCounter;
+
+	// the callback runs right away if the texture is loaded already
+	TWeakObjectPtr<UArticyPreviewCacheSubsystem> WeakThis(this);
+	Asset->LoadAssetAsync([WeakThis, AssetId](UObject* Loaded)
+	{
+		if (UArticyPreviewCacheSubsystem* This = WeakThis.Get())
+		{
+			This->OnImageLoaded(AssetId, Loaded);
+		}
+	});
+
+	const FArticyCachedPreviewImage* LoadedImage = Images.Find(AssetId);
+	return LoadedImage ? LoadedImage->Texture : nullptr;
+}
+
+/**
+ * Stores a texture which finished loading, and notifies the widgets which show its placeholder.
+ *
+ * @param AssetId The ID of the articy asset of the preview image.
+ * @param Loaded The loaded asset, or null if it could not be loaded.
+ */
+void UArticyPreviewCacheSubsystem::OnImageLoaded(const FArticyId& AssetId, UObject* Loaded)
+{
+	// the image may have been removed from the cache while it was loading
+	FArticyCachedPreviewImage* Image = Images.Find(AssetId);
+	if (!Image || !Image->bLoading)
+		return;
+
+	Image->Texture = Cast<UTexture2D>(Loaded);
+	Image->bLoading = false;
+
+	if (Image->Texture)
+	{
+		OnPreviewImageLoaded.Broadcast(AssetId);
+	}
+}
+
+/**
+ * Removes the least recently used image if the cache is full, so the unused textures can be garbage collected.
+ */
+void UArticyPreviewCacheSubsystem::RemoveLeastRecentlyUsed()
+{
+	if (Images.Num() < MaxImages)
+		return;
+
+	const FArticyId* LeastRecentlyUsed = nullptr;
+	uint64 LeastRecentUse = TNumericLimits<uint64>::Max();
+	for (const TPair<FArticyId, FArticyCachedPreviewImage>& Pair : Images)
+	{
+		if (Pair.Value.LastUsed < LeastRecentUse)
+		{
+			LeastRecentUse = Pair.Value.LastUsed;
+			LeastRecentlyUsed = &Pair.Key;
+		}
+	}
+
+	if (LeastRecentlyUsed)
+	{
+		const FArticyId Id = *LeastRecentlyUsed;
+		Images.Remove(Id);
+	}
+}
+
+/**
+ * Releases the textures which are about to be deleted, so the cache does not keep them referenced.
+ *
+ * @param Objects The objects which are about to be deleted.
+ */
+void UArticyPreviewCacheSubsystem::OnAssetsPreDelete(const TArray<UObject*>& Objects)
+{
+	for (auto It = Images.CreateIterator(); It; ++It)
+	{
+		if (It->Value.Texture && Objects.Contains(It->Value.Texture))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
@@ -0,0 +1,509 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyReachabilityAnalysis.h"
+#include "ArticyEditorModule.h"
+#include "ArticyBuiltinTypes.h"
+#include "ArticyFlowClasses.h"
+#include "ArticyHelpers.h"
+#include "ArticyImportData.h"
+#include "ArticyImportProfiler.h"
+#include "ArticyObject.h"
+#include "ArticyPackage.h"
+#include "ArticyPluginSettings.h"
+#include "ArticyRef.h"
+#include "ArticyReferenceIndex.h"
+#include "ArticyScriptFragment.h"
+#include "Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/UObjectHash.h"
+
+namespace
+{
+	void CollectIds(const UStruct* Struct, const void* Data, TArray<FArticyId>& OutIds);
+
+	/**
+	 * Collects the ids a property value holds, following structs and containers but not objects.
+	 * @param Property The property.
+	 * @param Value The value of the property.
+	 * @param OutIds Receives the ids.
+	 */
+	void CollectIds(const FProperty* Property, const void* Value, TArray<FArticyId>& OutIds)
+	{
+		if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+		{
+			if (StructProperty->Struct == FArticyId::StaticStruct())
+				OutIds.Add(*static_cast<const FArticyId*>(Value));
+			else if (StructProperty->Struct == FArticyRef::StaticStruct())
+				OutIds.Add(static_cast<const FArticyRef*>(Value)->GetId());
+			else
+				CollectIds(StructProperty->Struct, Value, OutIds);
+		}
+		else if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+		{
+			FScriptArrayHelper Helper(ArrayProperty, Value);
+			for (int32 Index = 0; Index < Helper.Num(); ++Index)
+				CollectIds(ArrayProperty->Inner, Helper.GetRawPtr(Index), OutIds);
+		}
+		else if (const FMapProperty* MapProperty = CastField<FMapProperty>(Property))
+		{
+			FScriptMapHelper Helper(MapProperty, Value);
+			for (int32 Index = 0; Index < Helper.GetMaxIndex(); ++Index)
+			{
+				if (Helper.IsValidIndex(Index))
+				{
+					CollectIds(MapProperty->KeyProp, Helper.GetKeyPtr(Index), OutIds);
+					CollectIds(MapProperty->ValueProp, Helper.GetValuePtr(Index), OutIds);
+				}
+			}
+		}
+		else if (const FSetProperty* SetProperty = CastField<FSetProperty>(Property))
+		{
+			FScriptSetHelper Helper(SetProperty, Value);
+			for (int32 Index = 0; Index < Helper.GetMaxIndex(); ++Index)
+			{
+				if (Helper.IsValidIndex(Index))
+					CollectIds(SetProperty->ElementProp, Helper.GetElementPtr(Index), OutIds);
+			}
+		}
+	}
+
+	/**
+	 * Collects the ids the reflected properties of a struct or object hold.
+	 * The children of articy objects are skipped, being the child of a reachable object doesn't make an object reachable.
+	 */
+	void CollectIds(const UStruct* Struct, const void* Data, TArray<FArticyId>& OutIds)
+	{
+		static const FName ChildrenName = TEXT("Children");
+		for (TFieldIterator<FProperty> It(Struct); It; ++It)
+		{
+			if (It->GetFName() == ChildrenName && It->GetOwnerStruct() == UArticyObject::StaticClass())
+				continue;
+
+			for (int32 Index = 0; Index < It->ArrayDim; ++Index)
+				CollectIds(*It, It->ContainerPtrToValuePtr<void>(Data, Index), OutIds);
+		}
+	}
+
+	/** Appends the contents of the string literals of a script, the names and ids a script refers to objects by. */
+	void CollectLiterals(const FString& Script, TArray<FString>& OutLiterals)
+	{
+		for (int32 Index = 0; Index < Script.Len(); ++Index)
+		{
+			if (Script[Index] != TEXT('"'))
+				continue;
+
+			FString Literal;
+			for (++Index; Index < Script.Len() && Script[Index] != TEXT('"'); ++Index)
+			{
+				if (Script[Index] == TEXT('\\') && Index + 1 < Script.Len())
+					++Index;
+				Literal.AppendChar(Script[Index]);
+			}
+			if (!Literal.IsEmpty())
+				OutLiterals.Add(MoveTemp(Literal));
+		}
+	}
+
+	/** Returns the objects of a package which are not reachable, in the order of the package. */
+	TArray<UArticyObject*> GetStrippedAssets(UArticyPackage* Package)
+	{
+		TArray<UArticyObject*> Stripped = Package->GetAssets();
+		Stripped.RemoveAll([](const UArticyObject* Asset) { return !Asset || !Asset->IsStrippedFromCook(); });
+		return Stripped;
+	}
+}
+
+/**
+ * Finds the object with an id, or the owner of the pin, connection or script with the id.
+ * @param Id The id.
+ * @return The object, or nullptr if the id is not one of the packages.
+ */
+UArticyObject* FArticyReachabilityAnalysis::FIndex::Find(const FArticyId& Id) const
+{
+	if (Id.Get() == 0)
+		return nullptr;
+
+	if (UArticyObject* const* Object = ObjectsById.Find(Id))
+		return *Object;
+
+	UArticyObject* const* Owner = OwnersBySubobjectId.Find(Id);
+	return Owner ? *Owner : nullptr;
+}
+
+/**
+ * Finds the object a script literal or entry point names.
+ * @param Name A technical name, or an id in hex with 0x or in decimal, optionally followed by _ and a clone id.
+ * @return The object, or nullptr if nothing of the packages has the name.
+ */
+UArticyObject* FArticyReachabilityAnalysis::FIndex::FindByName(const FString& Name) const
+{
+	if (UArticyObject* const* Named = ObjectsByName.Find(*Name))
+		return *Named;
+
+	FString Id = Name, CloneId;
+	Name.Split(TEXT("_"), &Id, &CloneId);
+
+	if (Id.StartsWith(TEXT("0x")))
+		return Find(FCString::Strtoui64(*Id + 2, nullptr, 16));
+	if (Id.IsNumeric())
+		return Find(FCString::Strtoui64(*Id, nullptr, 10));
+	return nullptr;
+}
+
+/**
+ * Adds the objects of a package by id, technical name and package, and the owners of their pins and connections.
+ *
+ * @param Package The package.
+ * @return The number of objects of the package.
+ */
+int32 FArticyReachabilityAnalysis::FIndex::AddPackage(UArticyPackage* Package)
+{
+	int32 NumObjects = 0;
+	TArray<UArticyObject*>& PackageObjects = ObjectsByPackage.FindOrAdd(Package->Name);
+	for (UArticyObject* Asset : Package->GetAssets())
+	{
+		if (!Asset)
+			continue;
+
+		++NumObjects;
+		PackageObjects.Add(Asset);
+		ObjectsById.Add(Asset->GetId(), Asset);
+		ObjectsByName.Add(Asset->GetTechnicalName(), Asset);
+
+		TArray<UObject*> Subobjects;
+		GetObjectsWithOuter(Asset, Subobjects, true);
+		for (const UObject* Subobject : Subobjects)
+		{
+			if (const UArticyPrimitive* Primitive = Cast<UArticyPrimitive>(Subobject))
+				OwnersBySubobjectId.Add(Primitive->GetId(), Asset);
+		}
+	}
+
+	return NumObjects;
+}
+
+/**
+ * Returns the generated packages of the import.
+ *
+ * @param Data The import data.
+ * @return The packages which could be loaded.
+ */
+TArray<UArticyPackage*> FArticyReachabilityAnalysis::LoadPackages(UArticyImportData* Data)
+{
+	TArray<UArticyPackage*> Packages;
+	for (const TSoftObjectPtr<UArticyPackage>& Package : Data->GetPackages())
+	{
+		if (UArticyPackage* Loaded = Package.LoadSynchronous())
+			Packages.Add(Loaded);
+	}
+
+	return Packages;
+}
+
+/**
+ * Analyzes the generated packages and marks their unreachable objects as stripped, see the declaration.
+ *
+ * @param Data The import data, with the generated packages.
+ */
+void FArticyReachabilityAnalysis::Run(UArticyImportData* Data)
+{
+	ARTICY_IMPORT_STAGE("Reachability");
+
+	const TArray<UArticyPackage*> Packages = LoadPackages(Data);
+
+	const UArticyPluginSettings* Settings = UArticyPluginSettings::Get();
+	const bool bStrip = Settings->bStripUnreachableObjects && Settings->ReachabilityEntryPoints.Num() > 0;
+	if (Settings->bStripUnreachableObjects && !bStrip)
+	{
+		UE_LOG(LogArticyEditor, Warning, TEXT("Unreachable objects are not stripped, as no reachability entry points are set in the plugin settings."));
+	}
+
+	// the marks of the previous import are updated in place, so only the packages whose marks change are saved
+	const auto SetStripped = [](UArticyPackage* Package, UArticyObject* Asset, bool bStripped)
+	{
+		if (Asset->IsStrippedFromCook() != bStripped)
+		{
+			Asset->SetStrippedFromCook(bStripped);
+			Package->MarkPackageDirty();
+		}
+	};
+
+	if (!bStrip)
+	{
+		for (UArticyPackage* Package : Packages)
+		{
+			for (UArticyObject* Asset : Package->GetAssets())
+			{
+				if (Asset)
+					SetStripped(Package, Asset, false);
+			}
+		}
+		return;
+	}
+
+	FIndex Index;
+	int32 NumObjects = 0;
+	for (UArticyPackage* Package : Packages)
+		NumObjects += Index.AddPackage(Package);
+
+	TSet<const UArticyObject*> Reachable;
+	TArray<UArticyObject*> Worklist;
+	const auto Reach = [&Reachable, &Worklist](UArticyObject* Object)
+	{
+		if (Object && !Reachable.Contains(Object))
+		{
+			Reachable.Add(Object);
+			Worklist.Add(Object);
+		}
+	};
+
+	TArray<FString> UnresolvedEntryPoints;
+	for (const FString& EntryPoint : Settings->ReachabilityEntryPoints)
+	{
+		const FString Trimmed = EntryPoint.TrimStartAndEnd();
+		if (const TArray<UArticyObject*>* PackageObjects = Index.ObjectsByPackage.Find(Trimmed))
+		{
+			for (UArticyObject* Object : *PackageObjects)
+				Reach(Object);
+		}
+		else if (UArticyObject* Object = Index.FindByName(Trimmed))
+		{
+			Reach(Object);
+		}
+		else
+		{
+			UE_LOG(LogArticyEditor, Warning, TEXT("The reachability entry point '%s' is neither an object nor a package of the import."), *Trimmed);
+			UnresolvedEntryPoints.Add(Trimmed);
+		}
+	}
+
+	TArray<FArticyId> Ids;
+	TArray<FString> Literals;
+	for (int32 Next = 0; Next < Worklist.Num(); ++Next)
+	{
+		Ids.Reset();
+		Literals.Reset();
+		CollectReferences(Worklist[Next], Ids, Literals);
+
+		for (const FArticyId& Id : Ids)
+			Reach(Index.Find(Id));
+		for (const FString& Literal : Literals)
+			Reach(Index.FindByName(Literal));
+	}
+
+	for (UArticyPackage* Package : Packages)
+	{
+		for (UArticyObject* Asset : Package->GetAssets())
+		{
+			if (Asset)
+				SetStripped(Package, Asset, !Reachable.Contains(Asset));
+		}
+	}
+
+	UE_LOG(LogArticyEditor, Log, TEXT("%d of %d objects are reachable from the %d entry points, %d are stripped from cooked builds."),
+		Reachable.Num(), NumObjects, Settings->ReachabilityEntryPoints.Num(), NumObjects - Reachable.Num());
+
+	ArticyHelpers::SaveJsonReport(MakeReport(Packages, UnresolvedEntryPoints, NumObjects, Reachable.Num()),
+		ArticyHelpers::GetSavedPath(TEXT(""), TEXT("ReachabilityReport.json")), TEXT("reachability report"));
+}
+
+/**
+ * Collects the ids referenced by an object and its subobjects (pins, connections and scripts), and the string
+ * literals of the scripts.
+ *
+ * @param Object The object.
+ * @param OutIds Receives the ids.
+ * @param OutLiterals Receives the string literals.
+ */
+void FArticyReachabilityAnalysis::CollectReferences(const UArticyObject* Object, TArray<FArticyId>& OutIds, TArray<FString>& OutLiterals)
+{
+	CollectIds(Object->GetClass(), Object, OutIds);
+
+	TArray<UObject*> Subobjects;
+	GetObjectsWithOuter(Object, Subobjects, true);
+	for (const UObject* Subobject : Subobjects)
+	{
+		CollectIds(Subobject->GetClass(), Subobject, OutIds);
+
+		if (const UArticyScriptFragment* Script = Cast<UArticyScriptFragment>(Subobject))
+			CollectLiterals(Script->GetExpression(), OutLiterals);
+	}
+}
+
+/**
+ * Writes the reference index of each generated package. The indices are rebuilt for all packages, as the ids and
+ * names their objects refer to are resolved with the objects of the other packages.
+ *
+ * @param Data The import data, with the generated packages.
+ */
+void FArticyReachabilityAnalysis::BuildReferenceIndices(UArticyImportData* Data)
+{
+	ARTICY_IMPORT_STAGE("ReferenceIndex");
+
+	const TArray<UArticyPackage*> Packages = LoadPackages(Data);
+
+	FIndex Index;
+	for (UArticyPackage* Package : Packages)
+		Index.AddPackage(Package);
+
+	int32 NumTargets = 0;
+	for (UArticyPackage* Package : Packages)
+	{
+		FArticyReferenceIndex References;
+		for (const UArticyObject* Asset : Package->GetAssets())
+		{
+			if (Asset)
+				AddReferences(Asset, Index, References);
+		}
+
+		NumTargets += References.Num();
+
+		// the indices of the previous import are only replaced if they changed, so unchanged packages are not saved
+		if (References != Package->GetReferenceIndex())
+		{
+			Package->SetReferenceIndex(MoveTemp(References));
+			Package->MarkPackageDirty();
+		}
+	}
+
+	UE_LOG(LogArticyEditor, Log, TEXT("Indexed the references to %d objects in %d packages."), NumTargets, Packages.Num());
+}
+
+/**
+ * Adds the references from an object to the reference index of its package. Ids are resolved to the objects
+ * owning them, so references to pins are references to their objects, and references within the object (like the
+ * ones of its pins to it) are left out. The parent and the children are left out as well, they are the hierarchy.
+ *
+ * @param Object The object.
+ * @param Index The objects of all packages.
+ * @param OutReferences The index of the package of the object.
+ */
+void FArticyReachabilityAnalysis::AddReferences(const UArticyObject* Object, const FIndex& Index, FArticyReferenceIndex& OutReferences)
+{
+	static const FName ChildrenName = TEXT("Children");
+	static const FName ParentName = TEXT("Parent");
+	static const FName TargetName = TEXT("Target");
+	static const FName TargetPinName = TEXT("TargetPin");
+
+	const auto AddReference = [Object, &OutReferences](const UArticyObject* Target, EArticyReferenceKind Kind, FName Property)
+	{
+		if (!Target || Target == Object)
+			return;
+
+		FArticyIncomingReference Reference;
+		Reference.Source = Object->GetId();
+		Reference.Kind = Kind;
+		Reference.Property = Property;
+		OutReferences.Add(Target->GetId(), Reference);
+	};
+
+	TArray<FArticyId> Ids;
+	const auto AddProperties = [&](const UObject* Container, const FString& Prefix, bool bJump)
+	{
+		for (TFieldIterator<FProperty> It(Container->GetClass()); It; ++It)
+		{
+			if ((It->GetFName() == ChildrenName || It->GetFName() == ParentName) && It->GetOwnerStruct() == UArticyObject::StaticClass())
+				continue;
+
+			Ids.Reset();
+			for (int32 ArrayIndex = 0; ArrayIndex < It->ArrayDim; ++ArrayIndex)
+				CollectIds(*It, It->ContainerPtrToValuePtr<void>(Container, ArrayIndex), Ids);
+
+			const bool bJumpTarget = bJump && (It->GetFName() == TargetName || It->GetFName() == TargetPinName);
+			const FName Property = bJumpTarget ? NAME_None : FName(*(Prefix + It->GetName()));
+			for (const FArticyId& Id : Ids)
+				AddReference(Index.Find(Id), bJumpTarget ? EArticyReferenceKind::Jump : EArticyReferenceKind::Property, Property);
+		}
+	};
+
+	AddProperties(Object, FString(), Object->IsA<UArticyJump>());
+
+	// the features are named by the property holding them
+	TMap<const UObject*, FString> FeaturePrefixes;
+	for (TFieldIterator<FObjectProperty> It(Object->GetClass()); It; ++It)
+	{
+		if (const UArticyBaseFeature* Feature = Cast<UArticyBaseFeature>(It->GetObjectPropertyValue_InContainer(Object)))
+			FeaturePrefixes.Add(Feature, It->GetName() + TEXT("."));
+	}
+
+	TArray<UObject*> Subobjects;
+	GetObjectsWithOuter(Object, Subobjects, true);
+
+	TArray<FString> Literals;
+	for (const UObject* Subobject : Subobjects)
+	{
+		if (const UArticyOutgoingConnection* Connection = Cast<UArticyOutgoingConnection>(Subobject))
+		{
+			AddReference(Index.Find(Connection->GetTargetID()), EArticyReferenceKind::Connection, NAME_None);
+		}
+		else if (Subobject->IsA<UArticyIncomingConnection>())
+		{
+			// the mirror of an outgoing connection of the source, which indexes it
+			continue;
+		}
+		else if (const UArticyScriptFragment* Script = Cast<UArticyScriptFragment>(Subobject))
+		{
+			Literals.Reset();
+			CollectLiterals(Script->GetExpression(), Literals);
+			for (const FString& Literal : Literals)
+				AddReference(Index.FindByName(Literal), EArticyReferenceKind::Script, NAME_None);
+		}
+		else
+		{
+			const FString* Prefix = FeaturePrefixes.Find(Subobject);
+			AddProperties(Subobject, Prefix ? *Prefix : FString(), false);
+		}
+	}
+}
+
+/**
+ * Creates the report of the analysis.
+ *
+ * @param Packages The analyzed packages, with the stripped objects marked.
+ * @param UnresolvedEntryPoints The entry points which named nothing of the import.
+ * @param NumObjects The number of objects of the packages.
+ * @param NumReachable The number of reachable objects.
+ * @return The report, with the stripped objects by package.
+ */
+TSharedRef<FJsonObject> FArticyReachabilityAnalysis::MakeReport(const TArray<UArticyPackage*>& Packages, const TArray<FString>& UnresolvedEntryPoints, int32 NumObjects, int32 NumReachable)
+{
+	TArray<TSharedPtr<FJsonValue>> EntryPoints, Unresolved, JsonPackages;
+	for (const FString& EntryPoint : UArticyPluginSettings::Get()->ReachabilityEntryPoints)
+		EntryPoints.Add(MakeShared<FJsonValueString>(EntryPoint));
+	for (const FString& EntryPoint : UnresolvedEntryPoints)
+		Unresolved.Add(MakeShared<FJsonValueString>(EntryPoint));
+
+	for (UArticyPackage* Package : Packages)
+	{
+		TArray<TSharedPtr<FJsonValue>> Stripped;
+		for (const UArticyObject* Asset : GetStrippedAssets(Package))
+		{
+			const TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+			Object->SetStringField(TEXT("Id"), ArticyHelpers::Uint64ToPaddedHex(Asset->GetId()));
+			Object->SetStringField(TEXT("TechnicalName"), Asset->GetTechnicalName().ToString());
+			Object->SetStringField(TEXT("Class"), Asset->GetClass()->GetName());
+			Stripped.Add(MakeShared<FJsonValueObject>(Object));
+		}
+
+		const TSharedRef<FJsonObject> JsonPackage = MakeShared<FJsonObject>();
+		JsonPackage->SetStringField(TEXT("Name"), Package->Name);
+		JsonPackage->SetNumberField(TEXT("Objects"), Package->AssetNum());
+		JsonPackage->SetNumberField(TEXT("StrippedObjects"), Stripped.Num());
+		JsonPackage->SetArrayField(TEXT("Stripped"), Stripped);
+		JsonPackages.Add(MakeShared<FJsonValueObject>(JsonPackage));
+	}
+
+	const TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetArrayField(TEXT("EntryPoints"), EntryPoints);
+	Report->SetArrayField(TEXT("UnresolvedEntryPoints"), Unresolved);
+	Report->SetNumberField(TEXT("Objects"), NumObjects);
+	Report->SetNumberField(TEXT("ReachableObjects"), NumReachable);
+	Report->SetNumberField(TEXT("StrippedObjects"), NumObjects - NumReachable);
+	Report->SetArrayField(TEXT("Packages"), JsonPackages);
+	return Report;
+}
@@ -0,0 +1,92 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+
+class FJsonObject;
+struct FArticyReferenceIndex;
+class UArticyImportData;
+class UArticyObject;
+class UArticyPackage;
+
+/**
+ * @class FArticyReachabilityAnalysis
+ * @brief Finds the objects of the import which cannot be reached from the configured entry points, and excludes them
+ * from cooked builds (see UArticyPluginSettings::bStripUnreachableObjects).
+ *
+ * Starting at the entry points, the analysis follows every id an object or its pins, connections and scripts hold:
+ * connections and jumps, references like speakers and parents, and the string literals of scripts which name an
+ * object, e.g. getObj("Chr_Manfred"). The children of an object are not followed, so a flow fragment does not keep
+ * nodes which are not connected to anything. Objects which are not reached are marked as stripped, which makes them
+ * editor only: they stay in the editor, but are left out of the cooked packages.
+ *
+ * The result is logged and written to Saved/Articy/ReachabilityReport.json, with the stripped objects by package.
+ *
+ * The same references, by the object they refer to, are written into the packages as their reference index (see
+ * BuildReferenceIndices), so the runtime and the editor can find the references to an object without a scan.
+ */
+class FArticyReachabilityAnalysis
+{
+public:
+
+	/**
+	 * Analyzes the generated packages of the import, and marks the unreachable objects as stripped.
+	 * If stripping is disabled, the marks of a previous import are removed.
+	 * Packages whose marks change are marked dirty, so they are saved with the import.
+	 * @param Data The import data, with the generated packages.
+	 */
+	static void Run(UArticyImportData* Data);
+
+	/**
+	 * Writes the reference index of each generated package, with the references from its objects, see FArticyReferenceIndex.
+	 * Packages whose index changes are marked dirty, so they are saved with the import.
+	 * @param Data The import data, with the generated packages.
+	 */
+	static void BuildReferenceIndices(UArticyImportData* Data);
+
+private:
+
+	/** The objects of the packages by id, technical name and package, and the owners of the pins by their ids. */
+	struct FIndex
+	{
+		TMap<FArticyId, UArticyObject*> ObjectsById;
+		TMap<FName, UArticyObject*> ObjectsByName;
+		TMap<FString, TArray<UArticyObject*>> ObjectsByPackage;
+		TMap<FArticyId, UArticyObject*> OwnersBySubobjectId;
+
+		/** The object with the id, or the owner of the pin or connection with the id. */
+		UArticyObject* Find(const FArticyId& Id) const;
+
+		/** The object named by a script literal or entry point: an id, in hex with 0x or decimal, or a technical name. */
+		UArticyObject* FindByName(const FString& Name) const;
+
+		/** Adds the objects of a package and their pins and connections, returns the number of objects added. */
+		int32 AddPackage(UArticyPackage* Package);
+	};
+
+	/** Returns the generated packages of the import, loading them if needed. */
+	static TArray<UArticyPackage*> LoadPackages(UArticyImportData* Data);
+
+	/**
+	 * Adds the references from an object, its pins, connections, features and scripts to the reference index.
+	 * @param Object The object.
+	 * @param Index The objects of all packages, to resolve the ids and names the object refers to.
+	 * @param OutReferences The index of the package of the object.
+	 */
+	static void AddReferences(const UArticyObject* Object, const FIndex& Index, FArticyReferenceIndex& OutReferences);
+
+	/**
+	 * Collects the ids referenced by an object and its subobjects, and the string literals of their scripts.
+	 * @param Object The object.
+	 * @param OutIds Receives the ids.
+	 * @param OutLiterals Receives the string literals.
+	 */
+	static void CollectReferences(const UArticyObject* Object, TArray<FArticyId>& OutIds, TArray<FString>& OutLiterals);
+
+	/** Writes the entry points, the counts and the stripped objects by package. */
+	static TSharedRef<FJsonObject> MakeReport(const TArray<UArticyPackage*>& Packages, const TArray<FString>& UnresolvedEntryPoints, int32 NumObjects, int32 NumReachable);
+};
@@ -19,6 +19,8 @@
 #include "Internationalization/Internationalization.h"
 #include "Internationalization/Culture.h"
 #include "Misc/ConfigCacheIni.h"
+#include "HAL/FileManager.h"
+#include "ArticyTextExtension.h"
 
 void ArticyLocalizerGenerator::GenerateCode(const UArticyImportData* Data, FString& OutFile)
 {
@@ -52,12 +54,22 @@ void ArticyLocalizerGenerator::GenerateCode(const UArticyImportData* Data, FStri
                             header->Line(TEXT("FString LocaleName = FInternationalization::Get().GetCurrentCulture()->GetName();"));
                             header->Line(TEXT("FString LangName = FInternationalization::Get().GetCurrentCulture()->GetTwoLetterISOLanguageName();"));
 
+                            // Prefer the binary localization pack of the culture, if enabled and generated
+                            header->Line(TEXT("if (LoadLocalizationPack(LocaleName, LangName)) {"));
+                            header->Line(TEXT("bDataLoaded = true;"), true, true, 1);
+                            header->Line(TEXT("return;"), true, true, 1);
+                            header->Line(TEXT("}"));
+
+                            // Add the string table files on every reload so a reimport refreshes them, SwitchCulture only registers the tables of the culture
+                            header->Line(TEXT("ResetStringTableFiles();"));
+
                             // Fallback to default generated string tables if no localization is found
-                            IterateStringTables(header, FPaths::ProjectContentDir() / "ArticyContent/Generated");
+                            IterateStringTables(header, FPaths::ProjectContentDir() / "ArticyContent/Generated", FString());
 
-                            // Generate code to load the string tables for all available languages and locales.
+                            // Generate code to add the string tables for all available languages and locales.
                             IterateLocalizationDirectories(header, FPaths::ProjectContentDir() / "L10N");
 
+                            header->Line(TEXT("SwitchCulture(LocaleName, LangName);"));
                             header->Line(TEXT("bDataLoaded = true;"), true);
                         });
                 });
@@ -84,19 +96,8 @@ void ArticyLocalizerGenerator::IterateLocalizationDirectories(CodeFileGenerator*
                 // Now that we have the language code, we can create the path to its string tables
                 FString LangPath = FString(FilenameOrDirectory) / "ArticyContent/Generated";
 
-                // Generate code to load locale-specific files at runtime
-                Header->Line(FString::Printf(TEXT("if (LocaleName == TEXT(\"%s\")) {"), *LangCode));
-                IterateStringTables(Header, LangPath, true);
-                Header->Line(TEXT("}"));
-
-                // Handle fallback to general language if applicable
-                FString GeneralLang = LangCode.Left(2);  // First two letters (e.g., "en" from "en-US")
-                if (GeneralLang != LangCode) // Only generate if locale and language differ
-                {
-                    Header->Line(FString::Printf(TEXT("else if (LangName == TEXT(\"%s\")) {"), *GeneralLang));
-                    IterateStringTables(Header, LangPath, true);
-                    Header->Line(TEXT("}"));
-                }
+                // Generate code to add the locale-specific files, SwitchCulture falls back to the general language (e.g., "en" from "en-US")
+                IterateStringTables(Header, LangPath, LangCode);
             }
             return true;  // Continue iterating
             });
@@ -136,10 +137,9 @@ void ArticyLocalizerGenerator::AddIniKeyValue(const FString& Key, const FString&
     }
 }
 
-void ArticyLocalizerGenerator::IterateStringTables(CodeFileGenerator* Header, const FString& DirectoryPath, bool Indent)
+void ArticyLocalizerGenerator::IterateStringTables(CodeFileGenerator* Header, const FString& DirectoryPath, const FString& Culture)
 {
     IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-    int IndentOffset = Indent ? 1 : 0;
 
     if (PlatformFile.DirectoryExists(*DirectoryPath))
     {
@@ -151,12 +151,38 @@ void ArticyLocalizerGenerator::IterateStringTables(CodeFileGenerator* Header, co
         for (const FString& FilePath : FoundFiles)
         {
             FString StringTable = FPaths::GetBaseFilename(*FilePath, true);
-            Header->Line(FString::Printf(TEXT("FStringTableRegistry::Get().UnregisterStringTable(FName(\"%s\"));"), *StringTable), true, Indent, IndentOffset);
-            Header->Line(FString::Printf(TEXT("LOCTABLE_FROMFILE_GAME(\"%s\", \"%s\", \"%s/%s.csv\");"), *StringTable, *StringTable, *RelPath, *StringTable), true, Indent, IndentOffset);
+
+            // Tables written before the texts with tokens were flagged are resolved entirely, like before
+            const TCHAR* MarksTokens = HasTokensColumn(FilePath) ? TEXT(", true") : TEXT("");
+            Header->Line(FString::Printf(TEXT("AddStringTableFile(TEXT(\"%s\"), TEXT(\"%s\"), TEXT(\"%s/%s.csv\")%s);"), *Culture, *StringTable, *RelPath, *StringTable, MarksTokens), true, true, 0);
         }
     }
 }
 
+/**
+ * @brief Checks whether a string table was generated with the Tokens metadata column.
+ *
+ * Only the header row is read, it is written by StringTableGenerator.
+ *
+ * @param FilePath The path of the CSV file.
+ * @return True if the header row names the FArticyTextTemplate::TokensMetaData column.
+ */
+bool ArticyLocalizerGenerator::HasTokensColumn(const FString& FilePath)
+{
+    TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*FilePath));
+    if (!Reader)
+        return false;
+
+    TArray<ANSICHAR> HeaderRow;
+    HeaderRow.SetNumZeroed(FMath::Min<int64>(Reader->TotalSize(), 64) + 1);
+    Reader->Serialize(HeaderRow.GetData(), HeaderRow.Num() - 1);
+
+    const FString Column = FString::Printf(TEXT("\"%s\""), FArticyTextTemplate::TokensMetaData);
+    FString FirstLine;
+    FString(UTF8_TO_TCHAR(HeaderRow.GetData())).Split(TEXT("\n"), &FirstLine, nullptr);
+    return FirstLine.Contains(Column, ESearchCase::CaseSensitive);
+}
+
 /**
  * @brief Modifies an INI file to add a new value to a specified section and key.
  *
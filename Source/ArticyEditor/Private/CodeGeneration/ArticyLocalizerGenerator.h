@@ -50,22 +50,29 @@ private:
      * @brief Iterates through string tables in a given directory and generates code for each.
      *
      * This function finds CSV files in the specified directory and generates
-     * code to register and load these string tables.
+     * code to add these string tables to the localizer system, which registers them when their culture is active.
      *
      * @param Header The code file generator used to output the generated code.
      * @param DirectoryPath The path to the directory containing string table CSV files.
-     * @param Indent Whether to indent the generated code lines (default is false).
+     * @param Culture The culture of the string tables, empty for the default tables.
      */
-    static void IterateStringTables(CodeFileGenerator* Header, const FString& DirectoryPath, bool Indent = false);
+    static void IterateStringTables(CodeFileGenerator* Header, const FString& DirectoryPath, const FString& Culture);
+
+    /**
+     * @brief Checks whether a string table flags the texts with tokens in its Tokens metadata column.
+     *
+     * @param FilePath The path of the CSV file.
+     * @return True if the file was generated with the column.
+     */
+    static bool HasTokensColumn(const FString& FilePath);
 
     /**
      * @brief Iterates over string tables in a given directory and generates code for each table.
      *
-     * This function registers and loads string tables from CSV files found in the specified directory path.
+     * This function adds the string tables of every culture directory found in the specified directory path.
      *
      * @param Header The code file generator to write string table registration code.
-     * @param DirectoryPath The path to the directory containing string table CSV files.
-     * @param Indent Whether to indent the generated code lines.
+     * @param LocalizationRoot The path to the directory containing the culture directories.
      */
     static void IterateLocalizationDirectories(CodeFileGenerator* Header, const FString& LocalizationRoot);
 
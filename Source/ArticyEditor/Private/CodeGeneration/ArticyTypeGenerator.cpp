@@ -64,7 +64,7 @@ void ArticyTypeGenerator::GenerateAsset(const UArticyImportData* Data)
 			CreatedAsset->Types.Reset();
 			for (const auto& type : Data->GetObjectDefs().GetTypes())
 			{
-				CreatedAsset->Types.Add(type.Key.ToString(), type.Value.ArticyType);
+				CreatedAsset->AddType(type.Key.ToString(), type.Value.ArticyType);
 			}
 
 			// Notify the asset registry
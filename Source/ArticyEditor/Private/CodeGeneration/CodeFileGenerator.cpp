@@ -9,38 +9,97 @@
 #include "ISourceControlModule.h"
 #include "ISourceControlProvider.h"
 #include "HAL/PlatformFilemanager.h"
+#include "HAL/FileManager.h"
 #include "SourceControlHelpers.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeLock.h"
 
-void CodeFileGenerator::Line(const FString& Line, const bool bSemicolon, const bool bIndent, const int IndentOffset)
+namespace
 {
-	if(bIndent)
+	/** A changed file, which is yet to be written. */
+	struct FPendingCodeFile
+	{
+		FString Path;
+		FString Content;
+		bool bExisted;
+	};
+
+	FCriticalSection DeferredWritesLock;
+	bool bDeferWrites = false;
+	TArray<FPendingCodeFile> DeferredFiles;
+
+	/**
+	 * Writes files concurrently. The source control operations are done in one batch, before and after.
+	 * @param Files The files to write.
+	 */
+	void WritePendingFiles(const TArray<FPendingCodeFile>& Files)
 	{
-		//add indenting tabs
-		for(int i = 0; i < IndentCount + IndentOffset; ++i)
-			FileContent += TEXT("\t");
+		if (Files.Num() == 0)
+			return;
+
+		ISourceControlModule& SCModule = ISourceControlModule::Get();
+		const bool bSourceControlEnabled = SCModule.IsEnabled();
+
+		// try check out the files which existed
+		if (bSourceControlEnabled && SCModule.GetProvider().UsesCheckout())
+		{
+			TArray<FString> ExistingFiles;
+			for (const FPendingCodeFile& File : Files)
+			{
+				if (File.bExisted)
+					ExistingFiles.Add(File.Path);
+			}
+
+			if (ExistingFiles.Num() > 0)
+				USourceControlHelpers::CheckOutFiles(ExistingFiles);
+		}
+
+		TArray<bool> FilesWritten;
+		FilesWritten.SetNumZeroed(Files.Num());
+		ParallelFor(Files.Num(), [&](int32 Index)
+		{
+			FilesWritten[Index] = FFileHelper::SaveStringToFile(Files[Index].Content, *Files[Index].Path, FFileHelper::EEncodingOptions::ForceUTF8);
+		});
+
+		// mark the files for add if it's the first time we've written them
+		if (bSourceControlEnabled)
+		{
+			TArray<FString> NewFiles;
+			for (int32 Index = 0; Index < Files.Num(); ++Index)
+			{
+				if (!Files[Index].bExisted && FilesWritten[Index])
+					NewFiles.Add(Files[Index].Path);
+			}
+
+			if (NewFiles.Num() > 0)
+				USourceControlHelpers::MarkFilesForAdd(NewFiles);
+		}
 	}
+}
 
-	FileContent += Line + (bSemicolon ? TEXT(";") : TEXT("")) + TEXT("\n");
+void CodeFileGenerator::Line(const FString& Line, const bool bSemicolon, const bool bIndent, const int IndentOffset)
+{
+	AppendLine(bSemicolon, bIndent, IndentOffset, Line);
 }
 
 void CodeFileGenerator::Comment(const FString& Text)
 {
-	Line(TEXT("/** ") + Text + TEXT(" */"));
+	AppendLine(false, true, 0, TEXT("/** "), Text, TEXT(" */"));
 }
 
 void CodeFileGenerator::AccessModifier(const FString& Text)
 {
-	Line(Text + (Text.EndsWith(TEXT(":")) ? TEXT("") : TEXT(":")), false, true, -1);
+	AppendLine(false, true, -1, Text, Text.EndsWith(TEXT(":")) ? TEXT("") : TEXT(":"));
 }
 
 void CodeFileGenerator::UPropertyMacro(const FString& Specifiers)
 {
-	Line(TEXT("UPROPERTY(") + Specifiers + TEXT(")"));
+	AppendLine(false, true, 0, TEXT("UPROPERTY("), Specifiers, TEXT(")"));
 }
 
 void CodeFileGenerator::UFunctionMacro(const FString& Specifiers)
 {
-	Line(TEXT("UFUNCTION(") + Specifiers + TEXT(")"));
+	AppendLine(false, true, 0, TEXT("UFUNCTION("), Specifiers, TEXT(")"));
 }
 
 void CodeFileGenerator::Variable(const FString& Type, const FString& Name, const FString& Value, const FString& Comment, const bool bUproperty, const FString& UpropertySpecifiers)
@@ -53,13 +112,11 @@ void CodeFileGenerator::Variable(const FString& Type, const FString& Name, const
 		this->UPropertyMacro(UpropertySpecifiers);
 	}
 
-	//type and name
-	auto str = Type + TEXT(" ") + Name;
-	//default value if set
-	if(!Value.IsEmpty())
-		str += TEXT(" = ") + Value;
-	
-	Line(str, true);
+	//type and name, and default value if set
+	if(Value.IsEmpty())
+		AppendLine(true, true, 0, Type, TEXT(" "), Name);
+	else
+		AppendLine(true, true, 0, Type, TEXT(" "), Name, TEXT(" = "), Value);
 
 	if(bUproperty && Type.Equals(TEXT("FText")))
 	{
@@ -67,8 +124,8 @@ void CodeFileGenerator::Variable(const FString& Type, const FString& Name, const
 
 		if(!ReservedNames.Contains(Name))
 		{
-			Line(TEXT("UFUNCTION(BlueprintPure, meta=(DisplayName=\"Get ") + SplitName(Name) + TEXT(" (Localized)\"))"));
-			Line(Type + TEXT(" Get") + Name + TEXT("() { return GetPropertyText(") + Name + "); }");
+			AppendLine(false, true, 0, TEXT("UFUNCTION(BlueprintPure, meta=(DisplayName=\"Get "), SplitName(Name), TEXT(" (Localized)\"))"));
+			AppendLine(false, true, 0, Type, TEXT(" Get"), Name, TEXT("() { return GetPropertyText("), Name, TEXT("); }"));
 		}
 	}
 }
@@ -105,8 +162,8 @@ void CodeFileGenerator::StartClass(const FString& Classname, const FString& Comm
 	if(!Comment.IsEmpty())
 		this->Comment(Comment);
 	if(bUClass)
-		Line(TEXT("UCLASS(") + UClassSpecifiers + TEXT(")"));
-	Line(TEXT("class ") + ExportMacro + Classname);
+		AppendLine(false, true, 0, TEXT("UCLASS("), UClassSpecifiers, TEXT(")"));
+	AppendLine(false, true, 0, TEXT("class "), ExportMacro, Classname);
 
 	StartBlock(true);
 	if(bUClass)
@@ -124,7 +181,7 @@ void CodeFileGenerator::StartStruct(const FString& Structname, const FString& Co
 		this->Comment(Comment);
 	if(bUStruct)
 		Line(TEXT("USTRUCT(BlueprintType)"));
-	Line(TEXT("struct ") + ExportMacro + Structname);
+	AppendLine(false, true, 0, TEXT("struct "), ExportMacro, Structname);
 
 	StartBlock(true);
 	if(bUStruct)
@@ -141,13 +198,41 @@ void CodeFileGenerator::EndStruct(const FString& InlineDeclaration)
 		Line(InlineDeclaration, true);
 }
 
+void CodeFileGenerator::ReserveContent()
+{
+	// The previous version of the file is the best estimate, its UTF-8 size is at least its length
+	const int64 PreviousSize = IFileManager::Get().FileSize(*Path);
+	const int64 Estimate = PreviousSize > 0 ? PreviousSize + PreviousSize / 8 : 16 * 1024;
+	FileContent.Reserve(static_cast<int32>(FMath::Min<int64>(Estimate, MAX_int32)));
+}
+
 FString CodeFileGenerator::GetExportMacro()
 {
 	// added space
 	return FString(FApp::GetProjectName()).ToUpper() + FString(TEXT("_API "));
 }
 
-void CodeFileGenerator::WriteToFile() const
+void CodeFileGenerator::BeginDeferredWrites()
+{
+	FScopeLock Lock(&DeferredWritesLock);
+	bDeferWrites = true;
+}
+
+void CodeFileGenerator::EndDeferredWrites()
+{
+	check(IsInGameThread());
+
+	TArray<FPendingCodeFile> Files;
+	{
+		FScopeLock Lock(&DeferredWritesLock);
+		bDeferWrites = false;
+		Files = MoveTemp(DeferredFiles);
+	}
+
+	WritePendingFiles(Files);
+}
+
+void CodeFileGenerator::WriteToFile()
 {
 	if(FileContent.IsEmpty())
 		return;
@@ -156,10 +241,9 @@ void CodeFileGenerator::WriteToFile() const
 		UE_LOG(LogArticyEditor, Warning, TEXT("Block count is %d when writing to file!"), BlockCount);
 
 	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-	ISourceControlModule& SCModule = ISourceControlModule::Get();
 
-	bool bFileExisted = false;
-	if(PlatformFile.FileExists(*Path))
+	const bool bFileExisted = PlatformFile.FileExists(*Path);
+	if(bFileExisted)
 	{
 		// If the content won't change, don't write the file
 		FString OldContent;
@@ -168,27 +252,24 @@ void CodeFileGenerator::WriteToFile() const
 		{
 			return;
 		}
+
+		// Keep the previous content in case the generated code has to be restored
+		CodeGenerator::BackupCodeFile(Path, MoveTemp(OldContent));
 	}
-	
-	bool bCheckOutEnabled = false;
-	if(SCModule.IsEnabled())
-	{
-		bCheckOutEnabled = ISourceControlModule::Get().GetProvider().UsesCheckout();
-	}
-	
-	// try check out the file if it existed
-	if(bFileExisted && bCheckOutEnabled)
-	{
-		USourceControlHelpers::CheckOutFile(*Path);
-	}
-	
-	const bool bFileWritten = FFileHelper::SaveStringToFile(FileContent, *Path, FFileHelper::EEncodingOptions::ForceUTF8);
 
-	// mark the file for add if it's the first time we've written it
-	if(!bFileExisted && bFileWritten && SCModule.IsEnabled())
+	FPendingCodeFile File{ Path, MoveTemp(FileContent), bFileExisted };
 	{
-		USourceControlHelpers::MarkFileForAdd(*Path);
+		FScopeLock Lock(&DeferredWritesLock);
+		if (bDeferWrites)
+		{
+			DeferredFiles.Add(MoveTemp(File));
+			return;
+		}
 	}
+
+	TArray<FPendingCodeFile> Files;
+	Files.Add(MoveTemp(File));
+	WritePendingFiles(Files);
 }
 
 FString CodeFileGenerator::SplitName(const FString& Name)
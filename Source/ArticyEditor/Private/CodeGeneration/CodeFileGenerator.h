@@ -40,6 +40,20 @@ public:
 	template<typename Lambda>
 	CodeFileGenerator(const FString& Path, const bool bHeader, Lambda ContentGenerator);
 
+	/**
+	 * @brief Starts collecting the changed files instead of writing them right away.
+	 *
+	 * Code files can then be generated on several threads, until EndDeferredWrites writes them.
+	 */
+	static void BeginDeferredWrites();
+
+	/**
+	 * @brief Writes the files collected since BeginDeferredWrites concurrently, and writes files right away again.
+	 *
+	 * Must be called on the game thread, which checks out and adds the files in source control.
+	 */
+	static void EndDeferredWrites();
+
 	/**
 	 * @brief Adds a line to the file content.
 	 *
@@ -182,6 +196,23 @@ private:
 	int IndentCount = 0; ///< The current indentation level.
 	uint8 BlockCount = 0; ///< The current block count.
 
+	/**
+	 * @brief Reserves the content, estimating its size from the previous version of the file.
+	 */
+	void ReserveContent();
+
+	/**
+	 * @brief Adds a line made of several parts, appending them to the content without building the line first.
+	 *
+	 * @tparam TParts FString or TCHAR string types.
+	 * @param bSemicolon Whether to append a semicolon at the end of the line.
+	 * @param bIndent Whether to indent the line.
+	 * @param IndentOffset The number of additional indentations to apply.
+	 * @param Parts The parts of the line.
+	 */
+	template<typename... TParts>
+	void AppendLine(const bool bSemicolon, const bool bIndent, const int IndentOffset, const TParts&... Parts);
+
 	/**
 	 * @brief Increases the indentation level.
 	 */
@@ -262,9 +293,9 @@ private:
 	static FString GetExportMacro();
 
 	/**
-	 * @brief Writes the content to the specified file path.
+	 * @brief Writes the content to the specified file path, or collects it if writes are deferred.
 	 */
-	void WriteToFile() const;
+	void WriteToFile();
 
 	/**
 	 * @brief Splits a camel-case property name into a human-readable format.
@@ -302,6 +333,8 @@ inline void CodeFileGenerator::SafeExecute(nullptr_t Lamb)
 template <typename Lambda>
 CodeFileGenerator::CodeFileGenerator(const FString& Path, const bool bHeader, Lambda ContentGenerator) : Path(CodeGenerator::GetSourceFolder() / Path)
 {
+	ReserveContent();
+
 	Line("// articy Software GmbH & Co. KG");
 	Comment("This code file was generated by ArticyImporter. Changes to this file will get lost once the code is regenerated.");
 
@@ -319,6 +352,33 @@ CodeFileGenerator::CodeFileGenerator(const FString& Path, const bool bHeader, La
 	WriteToFile();
 }
 
+/**
+ * @brief Adds a line made of several parts, appending them to the content without building the line first.
+ *
+ * @tparam TParts FString or TCHAR string types.
+ * @param bSemicolon Whether to append a semicolon at the end of the line.
+ * @param bIndent Whether to indent the line.
+ * @param IndentOffset The number of additional indentations to apply.
+ * @param Parts The parts of the line.
+ */
+template<typename... TParts>
+void CodeFileGenerator::AppendLine(const bool bSemicolon, const bool bIndent, const int IndentOffset, const TParts&... Parts)
+{
+	if (bIndent)
+	{
+		//add indenting tabs
+		for (int i = 0; i < IndentCount + IndentOffset; ++i)
+			FileContent.AppendChar(TEXT('\t'));
+	}
+
+	const int Appended[] = { 0, ((FileContent += Parts), 0)... };
+	(void)Appended;
+
+	if (bSemicolon)
+		FileContent.AppendChar(TEXT(';'));
+	FileContent.AppendChar(TEXT('\n'));
+}
+
 /**
  * @brief Adds a block of code with optional indentation and semicolon.
  *
@@ -422,7 +482,7 @@ void CodeFileGenerator::Enum(const FString& Enumname, const FString& Comment, co
 		Line("UENUM(BlueprintType)");
 
 	Line("enum");
-	StartClass(Enumname + (bUEnum ? " : uint8" : ""), Comment, false);
+	StartClass(bUEnum ? Enumname + TEXT(" : uint8") : Enumname, Comment, false);
 	{
 		// Add the values
 		for (auto val : Values)
@@ -438,7 +498,7 @@ void CodeFileGenerator::Enum(const FString& Enumname, const FString& Comment, co
  */
 inline void CodeFileGenerator::AddEnumEntry(FString Name)
 {
-	Line(FString::Printf(TEXT("%s,"), *Name));
+	AppendLine(false, true, 0, Name, TEXT(","));
 }
 
 /**
@@ -485,7 +545,7 @@ void CodeFileGenerator::Method(const FString& ReturnType, const FString& Name, c
 
 	// ReturnType Name(Parameters..)
 	// Only add the semicolon if there is no definition
-	Line(FString::Printf(TEXT("%s %s(%s) %s"), *ReturnType, *Name, *Parameters, *MethodSpecifiers), !hasDefinition);
+	AppendLine(!hasDefinition, true, 0, ReturnType, TEXT(" "), Name, TEXT("("), Parameters, TEXT(") "), MethodSpecifiers);
 
 	// Add definition, if any
 	if (hasDefinition)
@@ -19,6 +19,8 @@
 #include "ArticyPluginSettings.h"
 #include "ArticyTypeGenerator.h"
 #include "ArticyLocalizerGenerator.h"
+#include "ArticyLocalizerSystem.h"
+#include "ArticyExpressoScripts.h"
 #include "AssetToolsModule.h"
 #include "UObject/ConstructorHelpers.h"
 #include "Misc/FileHelper.h"
@@ -28,8 +30,19 @@
 #include "Misc/MessageDialog.h"
 #include "Dialogs/Dialogs.h"
 #include "ISourceControlModule.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeLock.h"
+#include "CodeFileGenerator.h"
+#include "ArticyImportProfiler.h"
+#include "ArticyEditorFunctionLibrary.h"
+#include "Misc/PackageName.h"
+#if ENGINE_MAJOR_VERSION >= 5
+#include "UObject/SavePackage.h"
+#endif
 #if WITH_LIVE_CODING && ENGINE_MAJOR_VERSION == 4
 #include "Windows/LiveCoding/Public/ILiveCodingModule.h"
+#elif WITH_LIVE_CODING
+#include "ILiveCodingModule.h"
 #endif
 
 //---------------------------------------------------------------------------//
@@ -37,7 +50,71 @@
 //---------------------------------------------------------------------------// 
 #define LOCTEXT_NAMESPACE "CodeGenerator"
 
+TSet<FString> CodeGenerator::SnapshotFiles;
 TMap<FString, FString> CodeGenerator::CachedFiles;
+FCriticalSection CodeGenerator::CachedFilesLock;
+
+namespace
+{
+	/**
+	 * @brief Saves packages to disk, writing the files asynchronously while the next package is serialized.
+	 *
+	 * @param Packages The packages to save.
+	 * @return true if all packages were saved, false otherwise.
+	 */
+	bool SaveGeneratedPackages(const TArray<UPackage*>& Packages)
+	{
+		ARTICY_IMPORT_STAGE("SavePackages");
+
+		bool bAllSaved = true;
+		for (UPackage* Package : Packages)
+		{
+			const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+
+#if ENGINE_MAJOR_VERSION >= 5
+			FSavePackageArgs SaveArgs;
+			SaveArgs.TopLevelFlags = RF_Standalone;
+			SaveArgs.SaveFlags = SAVE_Async | SAVE_NoError;
+			const bool bSaved = UPackage::SavePackage(Package, nullptr, *Filename, SaveArgs);
+#else
+			const bool bSaved = UPackage::SavePackage(Package, nullptr, RF_Standalone, *Filename, GError, nullptr, false, true, SAVE_Async | SAVE_NoError);
+#endif
+
+			if (!bSaved)
+			{
+				UE_LOG(LogArticyEditor, Error, TEXT("Failed to save package %s."), *Package->GetName());
+				bAllSaved = false;
+			}
+		}
+
+		UPackage::WaitForAsyncFileWrites();
+		return bAllSaved;
+	}
+
+	/**
+	 * @brief Stores the path of a generated singleton asset or class in the plugin settings and the config file,
+	 * so the runtime can load it directly without querying the asset registry or iterating the classes.
+	 *
+	 * @param Key The name of the settings property.
+	 * @param Setting The settings property to update.
+	 * @param Asset The generated asset or class.
+	 */
+	void StoreGeneratedAssetPath(const TCHAR* Key, FSoftObjectPath& Setting, const UObject* Asset)
+	{
+		const FSoftObjectPath Path(Asset);
+		if (Setting == Path)
+		{
+			return;
+		}
+
+		Setting = Path;
+		UArticyPluginSettings* CDO_Settings = GetMutableDefault<UArticyPluginSettings>();
+		FString ConfigName = CDO_Settings->GetDefaultConfigFilename();
+		GConfig->SetString(TEXT("/Script/ArticyRuntime.ArticyPluginSettings"), Key, *Path.ToString(), ConfigName);
+		GConfig->FindConfigFile(ConfigName)->Dirty = true;
+		GConfig->Flush(false, ConfigName);
+	}
+}
 
 /**
  * @brief Retrieves the main source folder for all generated code.
@@ -73,6 +150,44 @@ FString CodeGenerator::GetGeneratedTypesFilename(const UArticyImportData* Data)
 	return Data->GetProject().TechnicalName + "ArticyTypes";
 }
 
+/**
+ * @brief Gets the filename of the generated header of one object definition.
+ *
+ * The shards start with the filename of the generated types, which includes all of them.
+ *
+ * @param Data The import data containing project details.
+ * @param OriginalType The original type of the object definition.
+ * @return The filename for the generated header of the type.
+ */
+FString CodeGenerator::GetGeneratedTypeShardFilename(const UArticyImportData* Data, const FName& OriginalType)
+{
+	return GetGeneratedTypesFilename(Data) + "_" + OriginalType.ToString();
+}
+
+/**
+ * @brief Gets the filename of the generated header of one feature class.
+ *
+ * @param Data The import data containing project details.
+ * @param Feature The feature definition.
+ * @return The filename for the generated header of the feature.
+ */
+FString CodeGenerator::GetGeneratedFeatureShardFilename(const UArticyImportData* Data, const FArticyTemplateFeatureDef& Feature)
+{
+	return GetGeneratedTypesFilename(Data) + "_Feature_" + Feature.GetTechnicalName();
+}
+
+/**
+ * @brief Gets the filename of the generated header of one feature interface.
+ *
+ * @param Data The import data containing project details.
+ * @param Feature The feature definition.
+ * @return The filename for the generated header of the feature interface.
+ */
+FString CodeGenerator::GetGeneratedInterfaceShardFilename(const UArticyImportData* Data, const FArticyTemplateFeatureDef& Feature)
+{
+	return GetGeneratedInterfacesFilename(Data) + "_" + Feature.GetTechnicalName();
+}
+
 /**
  * @brief Gets the class name for global variables based on import data.
  *
@@ -183,7 +298,27 @@ bool CodeGenerator::DeleteGeneratedCode(const FString& Filename)
 	if (Filename.IsEmpty())
 		return FPlatformFileManager::Get().GetPlatformFile().DeleteDirectoryRecursively(*GetSourceFolder());
 
-	return FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*(GetSourceFolder() / Filename));
+	const FString FilePath = GetSourceFolder() / Filename;
+	BackupCodeFileBeforeDelete(FilePath);
+	return FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*FilePath);
+}
+
+/**
+ * @brief Deletes the files of a previous generation which match a wildcard but were not generated again,
+ * e.g. the shards of types which were removed from the project.
+ *
+ * @param Wildcard The wildcard of the files inside the source folder.
+ * @param GeneratedFiles The filenames (with extension) generated this time.
+ */
+void CodeGenerator::DeleteStaleCode(const FString& Wildcard, const TArray<FString>& GeneratedFiles)
+{
+	TArray<FString> existingFiles;
+	IFileManager::Get().FindFiles(existingFiles, *(GetSourceFolder() / Wildcard), true, false);
+	for (const FString& existingFile : existingFiles)
+	{
+		if (!GeneratedFiles.Contains(existingFile))
+			DeleteGeneratedCode(existingFile);
+	}
 }
 
 /**
@@ -237,6 +372,7 @@ bool CodeGenerator::DeleteExtraCode(const TArray<FString>& GeneratedFiles)
 				// Delete file if it does not match any prefix
 				if (!bShouldKeep)
 				{
+					CodeGenerator::BackupCodeFileBeforeDelete(FilePath);
 					return FileManager.Delete(*FilePath);
 				}
 			}
@@ -252,66 +388,114 @@ bool CodeGenerator::DeleteExtraCode(const TArray<FString>& GeneratedFiles)
 }
 
 /**
- * @brief Caches the content of code files in the source folder.
+ * @brief Takes a snapshot of the code files in the source folder.
  *
- * Loads the content of each file into memory for later restoration if needed.
+ * Only the file names are recorded. Reading every file up front would scale with the size of the generated code,
+ * so the content of a file is only backed up once a generator overwrites or deletes it, see BackupCodeFile.
  */
 void CodeGenerator::CacheCodeFiles()
 {
+	FScopeLock Lock(&CachedFilesLock);
+
+	// Only the files of this generation are restored or compared, see DidCodeFilesChange
+	SnapshotFiles.Reset();
+	CachedFiles.Reset();
+
 	TArray<FString> FileNames;
 	IFileManager::Get().FindFiles(FileNames, *GetSourceFolder());
-	TArray<FString> FileContents;
-	FileContents.SetNumZeroed(FileNames.Num());
-
-	for (int32 i = 0; i < FileNames.Num(); i++)
+	SnapshotFiles.Reserve(FileNames.Num());
+	for (const FString& FileName : FileNames)
 	{
-		FileNames[i] = GetSourceFolder() / FileNames[i];
+		SnapshotFiles.Add(GetSourceFolder() / FileName);
 	}
+}
 
-	for (int32 i = 0; i < FileNames.Num(); i++)
+/**
+ * @brief Backs up the previous content of a code file before it is overwritten.
+ *
+ * Only the first backup of a file is kept, as it holds the content of the snapshot.
+ * Files created by this generation have no previous content, they are deleted when restoring instead.
+ *
+ * @param FilePath The full path of the file.
+ * @param Content The content of the file before the generation.
+ */
+void CodeGenerator::BackupCodeFile(const FString& FilePath, FString&& Content)
+{
+	FScopeLock Lock(&CachedFilesLock);
+
+	if (SnapshotFiles.Contains(FilePath) && !CachedFiles.Contains(FilePath))
+		CachedFiles.Add(FilePath, MoveTemp(Content));
+}
+
+/**
+ * @brief Backs up the content of a code file before it is deleted.
+ *
+ * @param FilePath The full path of the file.
+ */
+void CodeGenerator::BackupCodeFileBeforeDelete(const FString& FilePath)
+{
 	{
-		FFileHelper::LoadFileToString(FileContents[i], *FileNames[i]);
-		CachedFiles.Add(FileNames[i], FileContents[i]);
+		FScopeLock Lock(&CachedFilesLock);
+		if (!SnapshotFiles.Contains(FilePath) || CachedFiles.Contains(FilePath))
+			return;
 	}
+
+	FString Content;
+	if (FFileHelper::LoadFileToString(Content, *FilePath))
+		BackupCodeFile(FilePath, MoveTemp(Content));
 }
 
 /**
  * @brief Generates code files based on the provided import data.
  *
  * This function manages the code generation process for various components such as global variables, databases, and scripts.
+ * Unchanged files are not rewritten, and if no file changed at all there is nothing to compile.
  *
  * @param Data The import data used for code generation.
- * @return true if code was generated successfully, false otherwise.
+ * @return true if the generated code changed and needs to be compiled, false otherwise.
  */
 bool CodeGenerator::GenerateCode(UArticyImportData* Data)
 {
 	if (!Data)
 		return false;
 
+	ARTICY_IMPORT_STAGE("GenerateCode");
+
 	bool bCodeGenerated = false;
 
 	CacheCodeFiles();
 
+	// The generators resolve the same C++ types over and over
+	Data->GetObjectDefs().BeginCppTypeCache(Data);
+
 	// Generate all files if ObjectDefs or GVs changed
 	if (Data->GetSettings().DidObjectDefsOrGVsChange())
 	{
+		using FGenerateCode = void(*)(const UArticyImportData*, FString&);
+		const FGenerateCode Generators[] =
+		{
+			&GlobalVarsGenerator::GenerateCode,
+			&DatabaseGenerator::GenerateCode,
+			&InterfacesGenerator::GenerateCode,
+			&ObjectDefinitionsGenerator::GenerateCode,
+			/* Generate scripts as well due to them including the generated global variables
+			 * if we remove a GV set but don't regenerate expresso scripts, the resulting class won't compile */
+			&ExpressoScriptsGenerator::GenerateCode,
+			&ArticyTypeGenerator::GenerateCode,
+		};
+
+		// The generators only read the import data, so they run concurrently, and the changed files are written together
 		TArray<FString> OutFiles;
-		FString OutFile;
+		OutFiles.SetNum(UE_ARRAY_COUNT(Generators));
+		CodeFileGenerator::BeginDeferredWrites();
+		ParallelFor(UE_ARRAY_COUNT(Generators), [&](int32 Index)
+		{
+			Generators[Index](Data, OutFiles[Index]);
+		});
+		CodeFileGenerator::EndDeferredWrites();
 
-		GlobalVarsGenerator::GenerateCode(Data, OutFile);
-		OutFiles.Add(OutFile);
-		DatabaseGenerator::GenerateCode(Data, OutFile);
-		OutFiles.Add(OutFile);
-		InterfacesGenerator::GenerateCode(Data, OutFile);
-		OutFiles.Add(OutFile);
-		ObjectDefinitionsGenerator::GenerateCode(Data, OutFile);
-		OutFiles.Add(OutFile);
-		/* Generate scripts as well due to them including the generated global variables
-		 * if we remove a GV set but don't regenerate expresso scripts, the resulting class won't compile */
-		ExpressoScriptsGenerator::GenerateCode(Data, OutFile);
-		OutFiles.Add(OutFile);
-		ArticyTypeGenerator::GenerateCode(Data, OutFile);
-		OutFiles.Add(OutFile);
+		// The localizer also updates the project config, which is done on the game thread
+		FString OutFile;
 		ArticyLocalizerGenerator::GenerateCode(Data, OutFile);
 		OutFiles.Add(OutFile);
 
@@ -326,9 +510,65 @@ bool CodeGenerator::GenerateCode(UArticyImportData* Data)
 		bCodeGenerated = true;
 	}
 
+	Data->GetObjectDefs().EndCppTypeCache();
+
+	if (bCodeGenerated && !DidCodeFilesChange())
+	{
+		UE_LOG(LogArticyEditor, Log, TEXT("Generated code did not change, skipping compilation."));
+		return false;
+	}
+
 	return bCodeGenerated;
 }
 
+/**
+ * @brief Compares the code files in the source folder with the snapshot taken by CacheCodeFiles.
+ *
+ * Files are only backed up when their content changes, so a backup means a changed or deleted file,
+ * and a file missing from the snapshot means a new one.
+ *
+ * @return true if a file was added, removed or its content changed, false otherwise.
+ */
+bool CodeGenerator::DidCodeFilesChange()
+{
+	{
+		FScopeLock Lock(&CachedFilesLock);
+		if (CachedFiles.Num() > 0)
+		{
+			return true;
+		}
+	}
+
+	return DidCodeFileNamesChange();
+}
+
+/**
+ * @brief Compares the names of the code files in the source folder with the snapshot taken by CacheCodeFiles.
+ *
+ * @return true if a file was added or removed, false otherwise.
+ */
+bool CodeGenerator::DidCodeFileNamesChange()
+{
+	FScopeLock Lock(&CachedFilesLock);
+
+	TArray<FString> FileNames;
+	IFileManager::Get().FindFiles(FileNames, *GetSourceFolder());
+	if (FileNames.Num() != SnapshotFiles.Num())
+	{
+		return true;
+	}
+
+	for (const FString& FileName : FileNames)
+	{
+		if (!SnapshotFiles.Contains(GetSourceFolder() / FileName))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 /**
  * @brief Initiates the recompilation process for the generated code.
  *
@@ -339,20 +579,105 @@ void CodeGenerator::Recompile(UArticyImportData* Data)
 	Compile(Data);
 }
 
+/**
+ * @brief Returns true if the generated code can be compiled by patching it with Live Coding.
+ *
+ * The script bodies are generated into .cpp files of their own (see ExpressoScriptsGenerator), so if only these
+ * changed and no file was added or removed, the headers and with them the classes and their layout are the same.
+ * Live Coding then only compiles the changed files and patches the functions, which takes seconds where a hot
+ * reload or a restart of the editor takes minutes. Other generated .cpp files register classes or hold static
+ * data, which Live Coding does not update, so changes to them are compiled as usual.
+ *
+ * @param Data The import data the code was generated for.
+ * @return true if Recompile patches the code with Live Coding.
+ */
+bool CodeGenerator::CanPatchWithLiveCoding(const UArticyImportData* Data)
+{
+#if WITH_LIVE_CODING && (ENGINE_MAJOR_VERSION > 5 || (ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1))
+	if (!Data || !UArticyPluginSettings::Get()->bPatchScriptsWithLiveCoding || FArticyEditorFunctionLibrary::GetBatchImportOptions())
+	{
+		return false;
+	}
+
+	const ILiveCodingModule* LiveCoding = FModuleManager::GetModulePtr<ILiveCodingModule>(LIVE_CODING_MODULE_NAME);
+	if (!LiveCoding || !LiveCoding->IsEnabledForSession() || LiveCoding->IsCompiling() || DidCodeFileNamesChange())
+	{
+		return false;
+	}
+
+	const FString ScriptFiles = GetSourceFolder() / GetExpressoScriptsClassname(Data, true);
+	FScopeLock Lock(&CachedFilesLock);
+	for (const TPair<FString, FString>& File : CachedFiles)
+	{
+		if (!File.Key.StartsWith(ScriptFiles) || !File.Key.EndsWith(TEXT(".cpp")))
+		{
+			return false;
+		}
+	}
+
+	return CachedFiles.Num() > 0;
+#else
+	return false;
+#endif
+}
+
+/**
+ * @brief Compiles the changed script bodies with Live Coding and patches them into the editor.
+ *
+ * The compilation is waited for, so the import goes on with the patched scripts. If it fails, the previous
+ * import is restored like after a failed hot reload, as only the generated scripts changed.
+ *
+ * @param Data The import data used for compilation.
+ */
+void CodeGenerator::PatchWithLiveCoding(UArticyImportData* Data)
+{
+#if WITH_LIVE_CODING && (ENGINE_MAJOR_VERSION > 5 || (ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1))
+	UE_LOG(LogArticyEditor, Display, TEXT("Only the generated script bodies changed, patching them with Live Coding."));
+
+	ILiveCodingModule& LiveCoding = FModuleManager::LoadModuleChecked<ILiveCodingModule>(LIVE_CODING_MODULE_NAME);
+	ELiveCodingCompileResult Result = ELiveCodingCompileResult::NotStarted;
+	LiveCoding.Compile(ELiveCodingCompileFlags::WaitForCompletion, &Result);
+
+	if (Result == ELiveCodingCompileResult::Success || Result == ELiveCodingCompileResult::NoChanges)
+	{
+		OnCompiled(Data);
+		return;
+	}
+
+	UE_LOG(LogArticyEditor, Error, TEXT("Live Coding could not patch the generated scripts, restoring the previous import."));
+	if (RestorePreviousImport(Data, true, ECompilationResult::OtherCompilationError))
+	{
+		OnCompiled(Data);
+	}
+#endif
+}
+
 /**
  * @brief Deletes generated assets based on package definitions.
  *
- * Removes assets not included in the import, handling invalid assets appropriately.
+ * Removes assets not included in the import in one delete operation, handling invalid assets appropriately.
  *
  * @param PackageDefs The package definitions used to determine which assets to delete.
+ * @param bRegenerateAllPackages If false, the assets of packages which did not change are kept as well.
  * @return true if all invalid assets were successfully deleted, false otherwise.
  */
-bool CodeGenerator::DeleteGeneratedAssets(const FArticyPackageDefs& PackageDefs)
+bool CodeGenerator::DeleteGeneratedAssets(const FArticyPackageDefs& PackageDefs, bool bRegenerateAllPackages)
 {
 	FAssetRegistryModule& AssetRegistry = FModuleManager::Get().GetModuleChecked<FAssetRegistryModule>("AssetRegistry");
 	TArray<FAssetData> OutAssets;
 	AssetRegistry.Get().GetAssetsByPath(FName(*ArticyHelpers::GetArticyGeneratedFolder()), OutAssets, true, false);
 
+	// Don't delete package assets that are not included in the import, or that are kept as they are
+	TSet<FString> KeptPackages;
+	for (const FArticyPackageDef& PackageDef : PackageDefs.GetPackages())
+	{
+		if (!PackageDef.GetIsIncluded() || (!bRegenerateAllPackages && !PackageDef.GetAssetsChanged()))
+		{
+			KeptPackages.Add(PackageDef.GetName());
+		}
+	}
+
+	// All assets are deleted in one operation, so the references and source control are handled once
 	TArray<UObject*> ExistingAssets;
 	TArray<FAssetData> InvalidAssets;
 	for (const FAssetData& Data : OutAssets)
@@ -367,20 +692,8 @@ bool CodeGenerator::DeleteGeneratedAssets(const FArticyPackageDefs& PackageDefs)
 				continue;
 			}
 
-			bool ExcludeAsset = false;
-			if (const UArticyPackage* PackageAsset = Cast<UArticyPackage>(Asset))
-			{
-				for (const FArticyPackageDef& PackageDef : PackageDefs.GetPackages())
-				{
-					// Don't delete package assets that are not included in the import
-					if (!PackageDef.GetIsIncluded() && PackageAsset->Name.Equals(PackageDef.GetName()))
-					{
-						ExcludeAsset = true;
-					}
-				}
-			}
-
-			if (!ExcludeAsset)
+			const UArticyPackage* PackageAsset = Cast<UArticyPackage>(Asset);
+			if (!PackageAsset || !KeptPackages.Contains(PackageAsset->Name))
 			{
 				ExistingAssets.Add(Asset);
 			}
@@ -405,63 +718,74 @@ bool CodeGenerator::DeleteGeneratedAssets(const FArticyPackageDefs& PackageDefs)
 /**
  * @brief Renames generated assets based on package definitions.
  *
- * This function handles renaming of package assets when their names have changed.
+ * This function handles renaming of package assets when their names have changed, all in one rename operation.
  *
  * @param PackageDefs The package definitions containing the new asset names.
  * @return true if all renaming operations succeeded, false otherwise.
  */
 bool CodeGenerator::RenameGeneratedAssets(const FArticyPackageDefs& PackageDefs)
 {
+	// The renamed packages which are not included - included packages are deleted and generated again anyway
+	TMap<FString, const FArticyPackageDef*> RenamedPackages;
+	for (const FArticyPackageDef& PackageDef : PackageDefs.GetPackages())
+	{
+		if (!PackageDef.GetIsIncluded() && !PackageDef.GetName().Equals(PackageDef.GetPreviousName()))
+		{
+			RenamedPackages.Add(PackageDef.GetPreviousName(), &PackageDef);
+		}
+	}
+
+	if (RenamedPackages.Num() == 0)
+	{
+		return true;
+	}
+
 	const FAssetRegistryModule& AssetRegistry = FModuleManager::Get().GetModuleChecked<FAssetRegistryModule>("AssetRegistry");
 	TArray<FAssetData> OutAssets;
 	AssetRegistry.Get().GetAssetsByPath(FName(*ArticyHelpers::GetArticyGeneratedFolder()), OutAssets, true, false);
 
+	TArray<FAssetRenameData> AssetsAndNames;
+	TArray<TPair<UArticyPackage*, FString>> RenamedAssets;
 	for (const FAssetData& Data : OutAssets)
 	{
-		if (Data.IsValid())
+		// Only package assets are renamed, the others don't need to be loaded
+		const UClass* AssetClass = Data.IsValid() ? Data.GetClass() : nullptr;
+		if (!AssetClass || !AssetClass->IsChildOf(UArticyPackage::StaticClass()))
 		{
-			UObject* Asset = Data.GetAsset();
+			continue;
+		}
 
-			// Skip invalid assets
-			if (!Asset)
-			{
-				continue;
-			}
+		UArticyPackage* PackageAsset = Cast<UArticyPackage>(Data.GetAsset());
+		const FArticyPackageDef* const* PackageDef = PackageAsset ? RenamedPackages.Find(PackageAsset->Name) : nullptr;
+		if (!PackageDef)
+		{
+			continue;
+		}
 
-			if (UArticyPackage* PackageAsset = Cast<UArticyPackage>(Asset))
-			{
-				for (const FArticyPackageDef& PackageDef : PackageDefs.GetPackages())
-				{
-					// Skip included packages - we delete them anyway
-					if (PackageDef.GetIsIncluded())
-					{
-						continue;
-					}
+		const FString PackagePath = FPackageName::GetLongPackagePath(PackageAsset->GetOutermost()->GetName());
+		new(AssetsAndNames)FAssetRenameData(PackageAsset, PackagePath, (*PackageDef)->GetName());
+		RenamedAssets.Emplace(PackageAsset, PackagePath / PackageAsset->GetName());
+	}
 
-					// Only check packages with name changes
-					if (PackageDef.GetName().Equals(PackageDef.GetPreviousName()))
-					{
-						continue;
-					}
+	if (AssetsAndNames.Num() == 0)
+	{
+		return true;
+	}
 
-					// Rename the asset
-					FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
-					TArray<FAssetRenameData> AssetsAndNames;
-					const FString OldName = PackageAsset->GetName();
-					const FString PackagePath = FPackageName::GetLongPackagePath(PackageAsset->GetOutermost()->GetName());
-					new(AssetsAndNames)FAssetRenameData(PackageAsset, PackagePath, PackageDef.GetName());
-					AssetToolsModule.Get().RenameAssets(AssetsAndNames);
-
-					FAssetRegistryModule::AssetRenamed(PackageAsset, PackagePath / OldName);
-					PackageAsset->MarkPackageDirty();
-					PackageAsset->GetOuter()->MarkPackageDirty();
-				}
-			}
-		}
+	// Rename all assets at once, so the redirectors, the registry and source control are updated in one operation
+	FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+	const bool bSuccess = AssetToolsModule.Get().RenameAssets(AssetsAndNames);
+
+	for (const TPair<UArticyPackage*, FString>& Renamed : RenamedAssets)
+	{
+		FAssetRegistryModule::AssetRenamed(Renamed.Key, Renamed.Value);
+		Renamed.Key->MarkPackageDirty();
+		Renamed.Key->GetOuter()->MarkPackageDirty();
 	}
 
-	// Returns true if there are no failures
-	return true;
+	UE_LOG(LogArticyEditor, Log, TEXT("Renamed %d Articy package assets"), AssetsAndNames.Num());
+
+	return bSuccess;
 }
 
 /**
@@ -473,6 +797,19 @@ bool CodeGenerator::RenameGeneratedAssets(const FArticyPackageDefs& PackageDefs)
  */
 void CodeGenerator::Compile(UArticyImportData* Data)
 {
+	// A batch import shows no UI and does not hot reload, the project is built before the next import instead
+	if (FArticyEditorFunctionLibrary::GetBatchImportOptions())
+	{
+		UE_LOG(LogArticyEditor, Display, TEXT("The generated Articy code changed. Build the project and import again to generate the assets."));
+		return;
+	}
+
+	if (CanPatchWithLiveCoding(Data))
+	{
+		PatchWithLiveCoding(Data);
+		return;
+	}
+
 #if WITH_LIVE_CODING && ENGINE_MAJOR_VERSION == 4
 	ILiveCodingModule& LiveCodingModule = FModuleManager::LoadModuleChecked<ILiveCodingModule>("LiveCoding");
 	if (LiveCodingModule.IsEnabledForSession())
@@ -574,11 +911,15 @@ void CodeGenerator::Compile(UArticyImportData* Data)
  * @brief Generates assets based on the provided import data.
  *
  * This function handles asset generation, including handling renaming and deletion of generated assets.
+ * Only the packages whose objects or texts changed are regenerated and saved, unless all packages are regenerated.
  *
  * @param Data The import data used for asset generation.
+ * @param bRegenerateAllPackages If true, the assets of all packages are regenerated, e.g. after the generated code changed.
  */
-void CodeGenerator::GenerateAssets(UArticyImportData* Data)
+void CodeGenerator::GenerateAssets(UArticyImportData* Data, bool bRegenerateAllPackages)
 {
+	ARTICY_IMPORT_STAGE("GenerateAssets");
+
 	TGuardValue<bool> GuardIsInitialLoad(GIsInitialLoad, false);
 
 	ensure(Data);
@@ -602,7 +943,7 @@ void CodeGenerator::GenerateAssets(UArticyImportData* Data)
 		return;
 	}
 
-	if (!ensureAlwaysMsgf(DeleteGeneratedAssets(Data->GetPackageDefs()),
+	if (!ensureAlwaysMsgf(DeleteGeneratedAssets(Data->GetPackageDefs(), bRegenerateAllPackages),
 		TEXT("DeletedGeneratedAssets() has failed. The Articy X Importer can not proceed without\n"
 			"being able to delete the previously generated assets to replace them with new ones.\n"
 			"Please make sure the Generated folder in ArticyContent is editable.")))
@@ -612,7 +953,7 @@ void CodeGenerator::GenerateAssets(UArticyImportData* Data)
 	}
 
 	// Generate the global variables asset
-	GlobalVarsGenerator::GenerateAsset(Data);
+	UArticyGlobalVariables* GlobalVariables = GlobalVarsGenerator::GenerateAsset(Data);
 	// Generate the database asset
 	UArticyDatabase* ArticyDatabase = DatabaseGenerator::GenerateAsset(Data);
 	if (!ensureAlwaysMsgf(ArticyDatabase != nullptr, TEXT("Could not create ArticyDatabase asset!")))
@@ -622,26 +963,57 @@ void CodeGenerator::GenerateAssets(UArticyImportData* Data)
 		//  have to settle with the ensures.
 		return;
 	}
+
+	// Remember where the database and global variables are, so they are loaded without asset registry queries
+	UArticyPluginSettings* Settings = GetMutableDefault<UArticyPluginSettings>();
+	StoreGeneratedAssetPath(TEXT("DatabaseAssetPath"), Settings->DatabaseAssetPath, ArticyDatabase);
+	if (GlobalVariables)
+	{
+		StoreGeneratedAssetPath(TEXT("GlobalVariablesAssetPath"), Settings->GlobalVariablesAssetPath, GlobalVariables);
+	}
+
+	// Same for the generated classes the runtime would otherwise find by iterating all classes
+	const FString ExpressoScriptsClassName = FString::Printf(TEXT("Class'/Script/%s.%s'"), FApp::GetProjectName(), *GetExpressoScriptsClassname(Data, true));
+	if (UClass* ExpressoScriptsClass = ConstructorHelpersInternal::FindOrLoadClass(ExpressoScriptsClassName, UArticyExpressoScripts::StaticClass()))
+	{
+		StoreGeneratedAssetPath(TEXT("ExpressoScriptsClassPath"), Settings->ExpressoScriptsClassPath, ExpressoScriptsClass);
+	}
+	const FString LocalizerSystemClassName = FString::Printf(TEXT("Class'/Script/%s.%s'"), FApp::GetProjectName(), *GetArticyLocalizerClassname(Data, true));
+	if (UClass* LocalizerSystemClass = ConstructorHelpersInternal::FindOrLoadClass(LocalizerSystemClassName, UArticyLocalizerSystem::StaticClass()))
+	{
+		StoreGeneratedAssetPath(TEXT("LocalizerSystemClassPath"), Settings->LocalizerSystemClassPath, LocalizerSystemClass);
+	}
+	// Every generated object resolves the C++ type of its class
+	Data->GetObjectDefs().BeginCppTypeCache(Data);
+
 	ArticyTypeGenerator::GenerateAsset(Data);
 
 	// Generate assets for all the imported objects
-	PackagesGenerator::GenerateAssets(Data);
+	PackagesGenerator::GenerateAssets(Data, bRegenerateAllPackages);
+
+	Data->GetObjectDefs().EndCppTypeCache();
 	ArticyDatabase->SetLoadedPackages(Data->GetPackagesDirect());
 
-	// Gather all Articy assets to save them
+	// Gather the Articy assets which were (re)generated to save them.
+	// Generated assets are marked dirty, assets which were kept as they are (or are not loaded at all) don't need saving.
 	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
 	TArray<FAssetData> GeneratedAssets;
 	AssetRegistryModule.Get().GetAssetsByPath(FName(*ArticyHelpers::GetArticyGeneratedFolder()), GeneratedAssets, true);
 
 	TArray<UPackage*> PackagesToSave;
-
 	PackagesToSave.Add(Data->GetOutermost());
 	for (const FAssetData& AssetData : GeneratedAssets)
 	{
-		PackagesToSave.Add(AssetData.GetAsset()->GetOutermost());
+		UPackage* Package = FindPackage(nullptr, *AssetData.PackageName.ToString());
+		if (Package && Package->IsDirty())
+		{
+			PackagesToSave.AddUnique(Package);
+		}
 	}
 
-	// Check out all the assets we want to save (if source control is enabled)
+	UE_LOG(LogArticyEditor, Log, TEXT("Saving %d changed Articy packages"), PackagesToSave.Num());
+
+	// Check out all the assets we want to save (if source control is enabled), in a single source control operation
 	ISourceControlProvider& SourceControlProvider = ISourceControlModule::Get().GetProvider();
 	if (SourceControlProvider.IsEnabled())
 	{
@@ -650,8 +1022,8 @@ void CodeGenerator::GenerateAssets(UArticyImportData* Data)
 	}
 
 	// Save the packages to disk
-	for (auto Package : PackagesToSave) { Package->SetDirtyFlag(true); }
-	if (!UEditorLoadingAndSavingUtils::SavePackages(PackagesToSave, true))
+	Data->GetOutermost()->SetDirtyFlag(true);
+	if (!SaveGeneratedPackages(PackagesToSave))
 	{
 		UE_LOG(LogArticyEditor, Error, TEXT("Failed to save packages. Make sure to save before submitting in Perforce."));
 	}
@@ -807,15 +1179,31 @@ bool CodeGenerator::RestorePreviousImport(UArticyImportData* Data, const bool& b
 }
 
 /**
- * @brief Restores cached files from previous import sessions.
+ * @brief Restores the code files of the previous import session.
  *
- * This function attempts to write the cached file content back to disk.
+ * Writes the backed up content of the overwritten and deleted files back to disk.
+ * The files which were not changed since the snapshot are still in place.
  *
  * @return true if all files were restored successfully, false otherwise.
  */
 bool CodeGenerator::RestoreCachedFiles()
 {
-	bool bFilesRestored = CachedFiles.Num() > 0 ? true : false;
+	FScopeLock Lock(&CachedFilesLock);
+
+	bool bFilesRestored = SnapshotFiles.Num() > 0 ? true : false;
+
+	// Files which did not exist before would not match the restored ones (e.g. new script shards)
+	if (bFilesRestored)
+	{
+		TArray<FString> FileNames;
+		IFileManager::Get().FindFiles(FileNames, *GetSourceFolder());
+		for (const FString& FileName : FileNames)
+		{
+			const FString FilePath = GetSourceFolder() / FileName;
+			if (!SnapshotFiles.Contains(FilePath))
+				FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*FilePath);
+		}
+	}
 
 	for (auto& CachedFile : CachedFiles)
 	{
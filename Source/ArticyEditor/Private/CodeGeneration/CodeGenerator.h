@@ -7,6 +7,7 @@
 #include "CoreMinimal.h"
 #include "ArticyImportData.h"
 #include "Misc/CompilationResult.h"
+#include "HAL/CriticalSection.h"
 
 
 class UArticyImportData;
@@ -22,21 +23,36 @@ public:
 	 * @brief Generates code files based on the provided import data.
 	 *
 	 * @param Data The import data used for code generation.
-	 * @return true if code was generated successfully, false otherwise.
+	 * @return true if the generated code changed and needs to be compiled, false otherwise.
 	 */
 	static bool GenerateCode(UArticyImportData* Data);
 
 	/**
-	 * @brief Caches the content of code files in the source folder.
+	 * @brief Takes a snapshot of the code files in the source folder.
 	 *
-	 * Loads the content of each file into memory for later restoration if needed.
+	 * Only the file names are recorded; the content of a file is backed up once it is overwritten or deleted.
 	 */
 	static void CacheCodeFiles();
 
 	/**
-	 * @brief Restores cached files from previous import sessions.
+	 * @brief Backs up the previous content of a code file before it is overwritten, if it was not backed up yet.
 	 *
-	 * Attempts to write the cached file content back to disk.
+	 * @param FilePath The full path of the file.
+	 * @param Content The content of the file before the generation.
+	 */
+	static void BackupCodeFile(const FString& FilePath, FString&& Content);
+
+	/**
+	 * @brief Backs up the content of a code file before it is deleted, if it was not backed up yet.
+	 *
+	 * @param FilePath The full path of the file.
+	 */
+	static void BackupCodeFileBeforeDelete(const FString& FilePath);
+
+	/**
+	 * @brief Restores the code files of the previous import session.
+	 *
+	 * Writes the backed up files back to disk, and deletes the files which were not part of the snapshot.
 	 *
 	 * @return true if all files were restored successfully, false otherwise.
 	 */
@@ -46,10 +62,12 @@ public:
 	 * @brief Generates assets based on the provided import data.
 	 *
 	 * Handles asset generation, including handling renaming and deletion of generated assets.
+	 * Only the packages whose objects or texts changed are regenerated and saved, unless all packages are regenerated.
 	 *
 	 * @param Data The import data used for asset generation.
+	 * @param bRegenerateAllPackages If true, the assets of all packages are regenerated, e.g. after the generated code changed.
 	 */
-	static void GenerateAssets(UArticyImportData* Data);
+	static void GenerateAssets(UArticyImportData* Data, bool bRegenerateAllPackages);
 
 	/**
 	 * @brief Initiates the recompilation process for the generated code.
@@ -58,6 +76,17 @@ public:
 	 */
 	static void Recompile(UArticyImportData* Data);
 
+	/**
+	 * @brief Returns true if the generated code can be compiled by patching it with Live Coding.
+	 *
+	 * That is the case if Live Coding is enabled and only the bodies of the generated scripts changed since the
+	 * snapshot, so the classes stay the same. Only the packages which changed need to be generated again then.
+	 *
+	 * @param Data The import data the code was generated for.
+	 * @return true if Recompile patches the code with Live Coding.
+	 */
+	static bool CanPatchWithLiveCoding(const UArticyImportData* Data);
+
 	/**
 	 * @brief Returns the main source folder for all the generated code.
 	 *
@@ -70,6 +99,9 @@ public:
 	 */
 	static FString GetGeneratedInterfacesFilename(const UArticyImportData* Data);
 	static FString GetGeneratedTypesFilename(const UArticyImportData* Data);
+	static FString GetGeneratedTypeShardFilename(const UArticyImportData* Data, const FName& OriginalType);
+	static FString GetGeneratedFeatureShardFilename(const UArticyImportData* Data, const FArticyTemplateFeatureDef& Feature);
+	static FString GetGeneratedInterfaceShardFilename(const UArticyImportData* Data, const FArticyTemplateFeatureDef& Feature);
 	static FString GetGeneratedTypeInformationFilename(const UArticyImportData* Data);
 	static FString GetGlobalVarsClassname(const UArticyImportData* Data, const bool bOmittPrefix = false);
 	static FString GetGVNamespaceClassname(const UArticyImportData* Data, const FString& Namespace);
@@ -88,6 +120,14 @@ public:
 	 */
 	static bool DeleteGeneratedCode(const FString& Filename = "");
 
+	/**
+	 * @brief Deletes the files of a previous generation which match a wildcard but were not generated again.
+	 *
+	 * @param Wildcard The wildcard of the files inside the source folder, e.g. the shards of a generated file.
+	 * @param GeneratedFiles The filenames (with extension) generated this time.
+	 */
+	static void DeleteStaleCode(const FString& Wildcard, const TArray<FString>& GeneratedFiles);
+
 	/**
 	 * @brief Deletes extra generated code files that are not in the provided list.
 	 *
@@ -101,17 +141,18 @@ public:
 	/**
 	 * @brief Deletes generated assets based on package definitions.
 	 *
-	 * Removes assets not included in the import, handling invalid assets appropriately.
+	 * Removes assets not included in the import in one delete operation, handling invalid assets appropriately.
 	 *
 	 * @param PackageDefs The package definitions used to determine which assets to delete.
+	 * @param bRegenerateAllPackages If false, the assets of packages which did not change are kept as well.
 	 * @return true if all invalid assets were successfully deleted, false otherwise.
 	 */
-	static bool DeleteGeneratedAssets(const FArticyPackageDefs& PackageDefs);
+	static bool DeleteGeneratedAssets(const FArticyPackageDefs& PackageDefs, bool bRegenerateAllPackages);
 
 	/**
 	 * @brief Renames generated assets based on package definitions.
 	 *
-	 * This function handles renaming of package assets when their names have changed.
+	 * This function handles renaming of package assets when their names have changed, all in one rename operation.
 	 *
 	 * @param PackageDefs The package definitions containing the new asset names.
 	 * @return true if all renaming operations succeeded, false otherwise.
@@ -128,6 +169,13 @@ private:
 	 */
 	static void Compile(UArticyImportData* Data);
 
+	/**
+	 * @brief Compiles the changed script bodies with Live Coding and patches them into the editor.
+	 *
+	 * @param Data The import data used for compilation.
+	 */
+	static void PatchWithLiveCoding(UArticyImportData* Data);
+
 	/**
 	 * @brief Callback function called when compilation is completed.
 	 *
@@ -137,6 +185,20 @@ private:
 	 */
 	static void OnCompiled(UArticyImportData* Data);
 
+	/**
+	 * @brief Compares the code files in the source folder with the snapshot taken by CacheCodeFiles.
+	 *
+	 * @return true if a file was added, removed or its content changed, false otherwise.
+	 */
+	static bool DidCodeFilesChange();
+
+	/**
+	 * @brief Compares the names of the code files in the source folder with the snapshot taken by CacheCodeFiles.
+	 *
+	 * @return true if a file was added or removed, false otherwise.
+	 */
+	static bool DidCodeFileNamesChange();
+
 	/**
 	 * @brief Parses a log to detect errors related to Articy-generated code.
 	 *
@@ -157,9 +219,15 @@ private:
 	 */
 	static bool RestorePreviousImport(UArticyImportData* Data, const bool& bNotifyUser = true, ECompilationResult::Type Reason = ECompilationResult::Unknown);
 
-	// Cached files, mapped from FileName to FileContent
+	// The full paths of the files in the source folder before the generation
+	static TSet<FString> SnapshotFiles;
+
+	// The previous content of the files overwritten or deleted since the snapshot, mapped from FilePath to FileContent
 	static TMap<FString, FString> CachedFiles;
 
+	// The generators write and delete files concurrently
+	static FCriticalSection CachedFilesLock;
+
 	//========================================//
 
 	CodeGenerator() {}
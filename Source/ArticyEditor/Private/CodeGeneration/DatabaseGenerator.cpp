@@ -4,6 +4,7 @@
 
 #include "DatabaseGenerator.h"
 #include "CodeGenerator.h"
+#include "ArticyAsset.h"
 #include "ArticyDatabase.h"
 #include "ArticyImportData.h"
 #include "CodeFileGenerator.h"
@@ -74,5 +75,100 @@ void DatabaseGenerator::GenerateCode(const UArticyImportData* Data, FString& Out
 UArticyDatabase* DatabaseGenerator::GenerateAsset(const UArticyImportData* Data)
 {
 	const auto& className = CodeGenerator::GetDatabaseClassname(Data, true);
-	return ArticyImporterHelpers::GenerateAsset<UArticyDatabase>(*className, FApp::GetProjectName(), "", "", RF_ArchetypeObject, true);
+	UArticyDatabase* Database = ArticyImporterHelpers::GenerateAsset<UArticyDatabase>(*className, FApp::GetProjectName(), "", "", RF_ArchetypeObject, true);
+
+	if (Database)
+	{
+		Database->SetHierarchy(FlattenHierarchy(Data->GetHierarchy()));
+		Database->SetVoiceOverIndex(BuildVoiceOverIndex(Data));
+	}
+
+	return Database;
+}
+
+/**
+ * @brief Flattens the imported project hierarchy into a depth-first order.
+ *
+ * The descendants of each object follow it, so they are a contiguous range at runtime.
+ *
+ * @param Hierarchy The hierarchy of the import data.
+ * @return The flattened hierarchy, empty if the hierarchy was not imported.
+ */
+FArticyHierarchy DatabaseGenerator::FlattenHierarchy(const FADIHierarchy& Hierarchy)
+{
+	FArticyHierarchy Flat;
+
+	//the nodes already are in depth-first order, each subtree is ended once the nodes after it are added
+	TArray<int32> OpenNodes;
+	const TArray<FADIHierarchyNode>& Nodes = Hierarchy.GetNodes();
+	for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+	{
+		while (OpenNodes.Num() > 0 && Nodes[OpenNodes.Last()].SubtreeEnd <= Index)
+			Flat.EndNode(OpenNodes.Pop());
+
+		OpenNodes.Add(Flat.BeginNode(Nodes[Index].Id));
+	}
+
+	while (OpenNodes.Num() > 0)
+		Flat.EndNode(OpenNodes.Pop());
+
+	return Flat;
+}
+
+/**
+ * @brief Collects the voice over assets of the imported texts by culture.
+ *
+ * Each culture gets the asset its string tables reference (see UArticyImportData::ProcessStrings), as the object
+ * path of the imported sound wave, so the runtime does not resolve the articy asset for each line.
+ *
+ * @param Data The import data.
+ * @return The index, empty if no text has a voice over asset.
+ */
+FArticyVoiceOverIndex DatabaseGenerator::BuildVoiceOverIndex(const UArticyImportData* Data)
+{
+	FArticyVoiceOverIndex Index;
+
+	TMap<FArticyId, FString> AssetRefs;
+	TArray<const TMap<FString, FArticyTexts>*> TextMaps;
+	TextMaps.Add(&Data->GetObjectDefs().GetTexts());
+	for (const FArticyPackageDef& Package : Data->GetPackageDefs().GetPackages())
+	{
+		Package.GatherAudioAssetRefs(AssetRefs);
+		if (Package.GetIsIncluded())
+			TextMaps.Add(&Package.GetTexts());
+	}
+
+	if (AssetRefs.Num() == 0)
+		return Index;
+
+	//the invariant culture first, the other cultures only store the assets which differ from it
+	TArray<FString> Cultures;
+	Data->Languages.Languages.GetKeys(Cultures);
+	Cultures.Remove(FString());
+	Cultures.Insert(FString(), 0);
+
+	for (const FString& Culture : Cultures)
+	{
+		for (const TMap<FString, FArticyTexts>* Texts : TextMaps)
+		{
+			for (const auto& Text : *Texts)
+			{
+				if (Text.Value.Content.Num() == 0)
+					continue;
+
+				//the asset of the culture, or the first one like the string tables
+				const FArticyTextDef* TextDef = Text.Value.Content.Find(Culture);
+				if (!TextDef)
+					TextDef = &Text.Value.Content.CreateConstIterator()->Value;
+
+				if (TextDef->VoAsset.IsEmpty())
+					continue;
+
+				if (const FString* AssetRef = AssetRefs.Find(FArticyId{ TextDef->VoAsset }))
+					Index.Add(Culture, Text.Key, UArticyAsset::GetAssetPathFromRef(*AssetRef));
+			}
+		}
+	}
+
+	return Index;
 }
@@ -6,6 +6,9 @@
 
 class UArticyImportData;
 struct FArticyGVInfo;
+struct FArticyHierarchy;
+struct FArticyVoiceOverIndex;
+struct FADIHierarchy;
 class FString;
 
 /**
@@ -30,4 +33,21 @@ public:
 	 * @return A pointer to the generated Articy database asset.
 	 */
 	static class UArticyDatabase* GenerateAsset(const UArticyImportData* Data);
+
+private:
+	/**
+	 * @brief Flattens the imported project hierarchy into a depth-first order.
+	 *
+	 * @param Hierarchy The hierarchy of the import data.
+	 * @return The flattened hierarchy.
+	 */
+	static FArticyHierarchy FlattenHierarchy(const FADIHierarchy& Hierarchy);
+
+	/**
+	 * @brief Collects the voice over assets of the imported texts by culture.
+	 *
+	 * @param Data The import data.
+	 * @return The voice over index of the database.
+	 */
+	static FArticyVoiceOverIndex BuildVoiceOverIndex(const UArticyImportData* Data);
 };
@@ -5,6 +5,7 @@
 #include "ExpressoScriptsGenerator.h"
 #include "CodeFileGenerator.h"
 #include "ArticyPluginSettings.h"
+#include "ArticyExpressoScripts.h"
 
 /**
  * @brief Generates a method interface for Articy user methods.
@@ -48,10 +49,49 @@ void GenerateMethodInterface(CodeFileGenerator* header, const UArticyImportData*
 		});
 }
 
+/**
+ * @brief Returns the types of the memo key of a pure user method: the methods provider and the arguments.
+ *
+ * @param method The user method.
+ * @param OutKeyType Receives the TTuple of the key.
+ * @param OutValueType Receives the type of the memoized result.
+ * @return False if the results of the method can't be memoized, e.g. because it returns nothing.
+ */
+bool GetUserMethodMemoTypes(const FAIDScriptMethod& method, FString& OutKeyType, FString& OutValueType)
+{
+	const FString& returnType = method.GetCPPReturnType();
+	if (returnType == TEXT("const FString"))
+		OutValueType = TEXT("FString");
+	else if (returnType == TEXT("bool") || returnType == TEXT("int") || returnType == TEXT("float") || returnType == TEXT("UArticyPrimitive*"))
+		OutValueType = returnType;
+	else
+		return false;
+
+	OutKeyType = TEXT("TTuple<UObject*");
+	for (const auto& parameter : method.ParameterList)
+	{
+		if (parameter.Type == TEXT("string"))
+			OutKeyType += TEXT(", FString");
+		else if (parameter.Type == TEXT("object"))
+			OutKeyType += TEXT(", UArticyPrimitive*");
+		else if (parameter.Type == TEXT("bool") || parameter.Type == TEXT("int") || parameter.Type == TEXT("float"))
+			OutKeyType += TEXT(", ") + parameter.Type;
+		else
+			return false;
+	}
+	OutKeyType += TEXT(">");
+	return true;
+}
+
 /**
  * @brief Generates user methods for Articy expresso scripts.
  *
  * This function creates user methods for the expresso scripts, allowing them to be blueprintable if specified.
+ * Each method has a variant taking the methods provider, which the translated scripts fetch once per script
+ * (see FArticyExpressoTranslator). Blueprintable methods of native providers are called without the blueprint VM.
+ * The results of pure methods (see UArticyPluginSettings::PureScriptMethods)
+ * are memoized by the methods provider and arguments while the flow player explores.
+ * The results are recorded to the method log of a flow capture, and returned from it in replays (see FArticyFlowReplay).
  *
  * @param header The code file generator for creating the methods.
  * @param Data The import data containing user methods.
@@ -62,17 +102,37 @@ void GenerateUserMethods(CodeFileGenerator* header, const UArticyImportData* Dat
 	header->Line("private:", false, true, -1);
 	header->Line();
 
+	const TArray<FString>& pureMethods = UArticyPluginSettings::Get()->PureScriptMethods;
+	TArray<FString> memos;
+
 	auto iClass = "I" + CodeGenerator::GetMethodsProviderClassname(Data, true);
 	for (const auto& method : Data->GetUserMethods())
 	{
 		const bool bIsVoid = method.GetCPPReturnType() == "void";
-		header->Method(method.GetCPPReturnType(), method.Name, method.GetCPPParameters(), [&]
-			{
-				header->Line(FString::Printf(TEXT("auto methodProvider = GetUserMethodsProviderObject();")));
-				header->Line(FString::Printf(TEXT("if(!methodProvider) return %s;"), *method.GetCPPDefaultReturn()));
+		const FString returnOrEmpty = bIsVoid ? TEXT("") : TEXT("return ");
 
-				const FString returnOrEmpty = bIsVoid ? TEXT("") : TEXT("return ");
+		FString memoKeyType, memoValueType;
+		const bool bMemoized = pureMethods.Contains(method.Name) && GetUserMethodMemoTypes(method, memoKeyType, memoValueType);
+		const FString memoName = TEXT("Memo_") + method.BlueprintName;
+		if (bMemoized)
+		{
+			header->Variable(FString::Printf(TEXT("mutable TMap<%s, %s>"), *memoKeyType, *memoValueType), memoName);
+			memos.Add(memoName);
+		}
+
+		FString providerParameters = TEXT("UObject* methodProvider");
+		if (method.ArgumentList.Num() != 0)
+			providerParameters += TEXT(", ") + method.GetCPPParameters();
+
+		header->Method(method.GetCPPReturnType(), method.Name + TEXT("WithProvider"), providerParameters, [&]
+			{
+				// replays return the recorded results without a provider, void methods have none and are skipped
+				if (bIsVoid)
+					header->Line(TEXT("if(!methodProvider || IsReplayingMethods()) return;"));
+				else
+					header->Line(FString::Printf(TEXT("if(!methodProvider && !IsReplayingMethods()) return %s;"), *method.GetCPPDefaultReturn()));
 
+				FString call;
 				if (bCreateBlueprintableUserMethods)
 				{
 					FString args = "";
@@ -80,12 +140,49 @@ void GenerateUserMethods(CodeFileGenerator* header, const UArticyImportData* Dat
 					{
 						args = FString::Printf(TEXT(", %s"), *method.GetArguments());
 					}
-					header->Line(FString::Printf(TEXT("%s%s::Execute_%s(methodProvider%s);"), *returnOrEmpty, *iClass, *method.BlueprintName, *args));
+
+					// Execute_ always goes through ProcessEvent, native providers can't be overridden by blueprints and are called directly
+					header->Line(FString::Printf(TEXT("auto* nativeProvider = methodProvider && methodProvider->GetClass()->HasAnyClassFlags(CLASS_Native) ? Cast<%s>(methodProvider) : nullptr;"), *iClass));
+					call = FString::Printf(TEXT("(nativeProvider ? nativeProvider->%s_Implementation(%s) : %s::Execute_%s(methodProvider%s))"),
+						*method.BlueprintName, *method.GetArguments(), *iClass, *method.BlueprintName, *args);
 				}
 				else
-					header->Line(FString::Printf(TEXT("%sCast<%s>(methodProvider)->%s(%s);"), *returnOrEmpty, *iClass, *method.Name, *method.GetArguments()));
+					call = FString::Printf(TEXT("Cast<%s>(methodProvider)->%s(%s)"), *iClass, *method.Name, *method.GetArguments());
+
+				// the results are recorded to or replayed from the method log, see FArticyFlowReplay
+				if (!bIsVoid)
+					call = FString::Printf(TEXT("CallUserMethod(TEXT(\"%s\"), [&] { return %s; })"), *method.Name, *call);
+
+				if (bMemoized)
+				{
+					const FString args = method.ArgumentList.Num() != 0 ? TEXT(", ") + method.GetArguments() : FString();
+					header->Line("if(IsMemoizingMethods())");
+					header->Line("{");
+					header->Line(FString::Printf(TEXT("const %s key(methodProvider%s);"), *memoKeyType, *args), false, true, 1);
+					header->Line(FString::Printf(TEXT("if(const auto* memo = %s.Find(key)) return *memo;"), *memoName), false, true, 1);
+					header->Line(FString::Printf(TEXT("return %s.Add(key, %s);"), *memoName, *call), false, true, 1);
+					header->Line("}");
+				}
+
+				header->Line(FString::Printf(TEXT("%s%s;"), *returnOrEmpty, *call));
 
 			}, "", false, "", "const");
+
+		header->Method(method.GetCPPReturnType(), method.Name, method.GetCPPParameters(), [&]
+			{
+				const FString args = method.ArgumentList.Num() != 0 ? TEXT(", ") + method.GetArguments() : FString();
+				header->Line(FString::Printf(TEXT("%s%sWithProvider(GetUserMethodsProviderObject()%s);"), *returnOrEmpty, *method.Name, *args));
+			}, "", false, "", "const");
+	}
+
+	if (memos.Num() > 0)
+	{
+		header->Line();
+		header->Method("void", "ResetMethodMemos", "", [&]
+			{
+				for (const FString& memo : memos)
+					header->Line(memo + TEXT(".Reset();"));
+			}, "", false, "", "const override");
 	}
 }
 
@@ -142,56 +239,274 @@ void GenerateExpressoScripts(CodeFileGenerator* header, const UArticyImportData*
 		}, "", false, "", "override");
 
 	header->Line();
-	header->Line("public:", false, true, -1);
 
+	/**
+	 * The scripts are specializations of these templates, keyed by the hash of the script.
+	 * They are defined in the script shards, and the tables in the .cpp of the class,
+	 * so a change to the scripts does not touch this header.
+	 */
+	header->Line("template<uint32 Hash> bool Condition();");
+	header->Line("template<uint32 Hash> void Instruction();");
 	header->Line();
-	// Disable "optimization cannot be applied due to function size" compile error. This error is caused by the huge constructor when all expresso
-	// scripts are added to the collection and this pragma disables the optimizations. 
-	header->Line("#if !((defined(PLATFORM_PS4) && PLATFORM_PS4) || (defined(PLATFORM_PS5) && PLATFORM_PS5))");
-	header->Line("#pragma warning(push)");
-	header->Line("#pragma warning(disable: 4883) //<disable \"optimization cannot be applied due to function size\" compile error.");
-	header->Line("#endif");
-	header->Method("", CodeGenerator::GetExpressoScriptsClassname(Data), "", [&]
+	header->Line("int32 FindCondition(uint32 Hash) const override;");
+	header->Line("bool EvaluateCondition(int32 Index) const override;");
+	header->Line("int32 FindInstruction(uint32 Hash) const override;");
+	header->Line("void ExecuteInstruction(int32 Index) const override;");
+	header->Line("bool ConditionWritesState(int32 Index) const override;");
+	header->Line("bool InstructionWritesState(int32 Index) const override;");
+	header->Line("FArticyScriptAccess GetConditionAccess(int32 Index) const override;");
+	header->Line("FArticyScriptAccess GetInstructionAccess(int32 Index) const override;");
+}
+
+/** A script fragment, and the hash it is found by at runtime. */
+using FExpressoScript = TPair<uint32, const FArticyExpressoFragment*>;
+
+/**
+ * @brief Collects the conditions and instructions of the import data, sorted by hash.
+ *
+ * Scripts are sorted so the runtime can find them with a binary search. Empty scripts are skipped,
+ * they are handled by the base class.
+ *
+ * @param Data The import data containing the script fragments.
+ * @param OutConditions The collected conditions.
+ * @param OutInstructions The collected instructions.
+ */
+void CollectExpressoScripts(const UArticyImportData* Data, TArray<FExpressoScript>& OutConditions, TArray<FExpressoScript>& OutInstructions)
+{
+	for (const auto& script : Data->GetScriptFragments())
+	{
+		if (script.OriginalFragment.IsEmpty())
+			continue;
+
+		const uint32 cleanScriptHash = GetTypeHash(script.OriginalFragment);
+		(script.bIsInstruction ? OutInstructions : OutConditions).Add(FExpressoScript(cleanScriptHash, &script));
+	}
+
+	for (auto* scripts : { &OutConditions, &OutInstructions })
+	{
+		scripts->StableSort([](const FExpressoScript& A, const FExpressoScript& B) { return A.Key < B.Key; });
+
+		// Scripts with the same hash cannot be told apart at runtime, keep the first one
+		for (int32 i = scripts->Num() - 1; i > 0; --i)
 		{
-			const auto& fragments = Data->GetScriptFragments();
-			for (auto& script : fragments)
+			if ((*scripts)[i].Key == (*scripts)[i - 1].Key)
+				scripts->RemoveAt(i);
+		}
+	}
+}
+
+/**
+ * @brief Generates the hash tables and dispatch tables of the expresso scripts class.
+ *
+ * Each table is a sorted array of hashes, an array of pointers to the script specializations
+ * at the same index, whether each script may change state, and what each script reads and writes.
+ *
+ * @param file The code file generator for the .cpp of the class.
+ * @param Data The import data used for code generation.
+ * @param Conditions The conditions, sorted by hash.
+ * @param Instructions The instructions, sorted by hash.
+ */
+void GenerateExpressoScriptTables(CodeFileGenerator* file, const UArticyImportData* Data, const TArray<FExpressoScript>& Conditions, const TArray<FExpressoScript>& Instructions)
+{
+	const auto& className = CodeGenerator::GetExpressoScriptsClassname(Data);
+
+	// Declare the specializations, they are defined in the shards
+	for (const auto& script : Conditions)
+		file->Line(FString::Printf(TEXT("template<> bool %s::Condition<%uu>();"), *className, script.Key));
+	for (const auto& script : Instructions)
+		file->Line(FString::Printf(TEXT("template<> void %s::Instruction<%uu>();"), *className, script.Key));
+
+	// The dense indices of the global variables, see UArticyGlobalVariables::GetVariableIndex
+	TMap<FString, int32> variableIndices;
+	for (const auto& ns : Data->GetGlobalVars().Namespaces)
+	{
+		for (const auto& var : ns.Variables)
+			variableIndices.Add(ns.Namespace + TEXT(".") + var.Variable, variableIndices.Num());
+	}
+
+	auto generateTable = [&](const TArray<FExpressoScript>& scripts, const FString& kind, const FString& returnType, const FString& dispatchName)
+	{
+		file->Line();
+		file->Method("int32", className + "::Find" + kind, "uint32 Hash", [&]
 			{
-				if (script.OriginalFragment.IsEmpty())
-					continue;
+				// Empty arrays are not allowed
+				if (scripts.Num() == 0)
+				{
+					file->Line("return INDEX_NONE;");
+					return;
+				}
 
+				file->Line("static constexpr uint32 Hashes[] =");
+				file->Line("{");
+				for (const auto& script : scripts)
+					file->Line(FString::Printf(TEXT("%uu,"), script.Key), false, true, 1);
+				file->Line("};");
+				file->Line("return FindScriptIndex(Hashes, Hash);");
+			}, "", false, "", "const");
 
-				int cleanScriptHash = GetTypeHash(script.OriginalFragment);
+		file->Line();
+		file->Method(returnType, className + "::" + dispatchName, "int32 Index", [&]
+			{
+				if (scripts.Num() == 0)
+				{
+					file->Line(returnType == TEXT("bool") ? TEXT("return true;") : TEXT("return;"));
+					return;
+				}
+
+				file->Line(FString::Printf(TEXT("using FScript = %s (%s::*)();"), *returnType, *className));
+				file->Line("static constexpr FScript Scripts[] =");
+				file->Line("{");
+				for (const auto& script : scripts)
+					file->Line(FString::Printf(TEXT("&%s::%s<%uu>,"), *className, *kind, script.Key), false, true, 1);
+				file->Line("};");
+				file->Comment("Scripts may modify the state of the instance (e.g. random), like they did as lambdas");
+				file->Line(FString::Printf(TEXT("return (const_cast<%s*>(this)->*Scripts[Index])();"), *className));
+			}, "", false, "", "const");
 
-				if (script.bIsInstruction)
+		file->Line();
+		file->Method("bool", className + "::" + kind + "WritesState", "int32 Index", [&]
+			{
+				if (scripts.Num() == 0)
 				{
-					header->Line(FString::Printf(TEXT("Instructions.Add(%d, [&]"), cleanScriptHash));
-					header->Line("{");
-					{
-						header->Line(script.ParsedFragment, false, true, 1);
-					}
-					header->Line("});");
+					file->Line("return true;");
+					return;
 				}
-				else
+
+				// Found by the importer, see FArticyExpressoTranslator::WritesState
+				file->Line("static constexpr bool WritesState[] =");
+				file->Line("{");
+				for (const auto& script : scripts)
+					file->Line(script.Value->bWritesState ? TEXT("true,") : TEXT("false,"), false, true, 1);
+				file->Line("};");
+				file->Line("return WritesState[Index];");
+			}, "", false, "", "const");
+
+		file->Line();
+		file->Method("FArticyScriptAccess", className + "::Get" + kind + "Access", "int32 Index", [&]
+			{
+				if (scripts.Num() == 0)
 				{
-					header->Line(FString::Printf(TEXT("Conditions.Add(%d, [&]"), cleanScriptHash));
-					header->Line("{");
+					file->Line("return FArticyScriptAccess();");
+					return;
+				}
+
+				// Found by the importer, see FArticyExpressoTranslator::GetReadVariables
+				TArray<FString> variableLines;
+				TArray<FString> entryLines;
+				int32 numVariables = 0;
+				for (const auto& script : scripts)
+				{
+					const FArticyExpressoFragment& fragment = *script.Value;
+					bool bKnown = fragment.bAccessesKnown;
+
+					auto getIndices = [&](const TArray<FString>& names)
+					{
+						TArray<int32> indices;
+						for (const FString& name : names)
+						{
+							const int32* index = variableIndices.Find(name);
+							if (index)
+								indices.Add(*index);
+							else
+								bKnown = false;
+						}
+						indices.Sort();
+						return indices;
+					};
+					TArray<int32> reads = getIndices(fragment.ReadVariables);
+					TArray<int32> writes = getIndices(fragment.WrittenVariables);
+
+					EArticyScriptAccess flags = EArticyScriptAccess::None;
+					if (fragment.bAccessesSeenCounters)
+						flags |= EArticyScriptAccess::SeenCounters;
+					if (fragment.bAccessesObjectProperties)
+						flags |= EArticyScriptAccess::ObjectProperties;
+					if (fragment.bCallsUserMethods)
+						flags |= EArticyScriptAccess::UserMethods;
+					if (!bKnown || reads.Num() > MAX_uint16 || writes.Num() > MAX_uint16)
+					{
+						flags |= EArticyScriptAccess::Unknown;
+						reads.Reset();
+						writes.Reset();
+					}
+
+					entryLines.Add(FString::Printf(TEXT("{ %d, %d, %d, %d },"), numVariables, reads.Num(), writes.Num(), static_cast<uint8>(flags)));
+					if (reads.Num() + writes.Num() > 0)
 					{
-						// The fragment might be empty or contain only a comment, so we need to wrap it in
-						// the ConditionOrTrue method
-						header->Line("return ConditionOrTrue(", false, true, 1);
-						// Now comes the fragment (in next line and indented)
-						header->Line(script.ParsedFragment, false, true, 2);
-						// Make sure there is a final semicolon
-						// We put it into the next line, since the fragment might contain a line-comment
-						header->Line(");", false, true, 1);
+						FString line;
+						for (const int32 index : reads)
+							line += FString::Printf(TEXT("%d, "), index);
+						for (const int32 index : writes)
+							line += FString::Printf(TEXT("%d, "), index);
+						variableLines.Add(line.TrimEnd());
+						numVariables += reads.Num() + writes.Num();
 					}
-					header->Line("});");
 				}
-			}
-		});
-	header->Line("#if !((defined(PLATFORM_PS4) && PLATFORM_PS4) || (defined(PLATFORM_PS5) && PLATFORM_PS5))");
-	header->Line("#pragma warning(pop)");
-	header->Line("#endif");
+
+				// The variables read by each script followed by the ones it writes, empty arrays are not allowed
+				if (variableLines.Num() == 0)
+					variableLines.Add(TEXT("INDEX_NONE"));
+
+				file->Line("static constexpr int32 Variables[] =");
+				file->Line("{");
+				for (const FString& line : variableLines)
+					file->Line(line, false, true, 1);
+				file->Line("};");
+				file->Line("static constexpr FArticyScriptAccessEntry Entries[] =");
+				file->Line("{");
+				for (const FString& line : entryLines)
+					file->Line(line, false, true, 1);
+				file->Line("};");
+				file->Line("return MakeScriptAccess(Variables, Entries[Index]);");
+			}, "", false, "", "const");
+	};
+
+	generateTable(Conditions, TEXT("Condition"), TEXT("bool"), TEXT("EvaluateCondition"));
+	generateTable(Instructions, TEXT("Instruction"), TEXT("void"), TEXT("ExecuteInstruction"));
+}
+
+/**
+ * @brief Generates the definitions of the scripts in one shard.
+ *
+ * @param file The code file generator for the shard.
+ * @param Data The import data used for code generation.
+ * @param Conditions The conditions of the shard.
+ * @param Instructions The instructions of the shard.
+ */
+void GenerateExpressoScriptShard(CodeFileGenerator* file, const UArticyImportData* Data, const TArray<const FExpressoScript*>& Conditions, const TArray<const FExpressoScript*>& Instructions)
+{
+	const auto& className = CodeGenerator::GetExpressoScriptsClassname(Data);
+
+	for (const FExpressoScript* script : Conditions)
+	{
+		file->Line();
+		file->Method("template<> bool", FString::Printf(TEXT("%s::Condition<%uu>"), *className, script->Key), "", [&]
+			{
+				// The fragment might be empty or contain only a comment, so we need to wrap it in
+				// the ConditionOrTrue method
+				if (!script->Value->ParsedPrologue.IsEmpty())
+					file->Line(script->Value->ParsedPrologue);
+
+				file->Line("return ConditionOrTrue(");
+				// Now comes the fragment (in next line and indented)
+				file->Line(script->Value->ParsedFragment, false, true, 1);
+				// Make sure there is a final semicolon
+				// We put it into the next line, since the fragment might contain a line-comment
+				file->Line(");");
+			});
+	}
+
+	for (const FExpressoScript* script : Instructions)
+	{
+		file->Line();
+		file->Method("template<> void", FString::Printf(TEXT("%s::Instruction<%uu>"), *className, script->Key), "", [&]
+			{
+				if (!script->Value->ParsedPrologue.IsEmpty())
+					file->Line(script->Value->ParsedPrologue);
+
+				file->Line(script->Value->ParsedFragment);
+			});
+	}
 }
 
 /**
@@ -240,6 +555,52 @@ void ExpressoScriptsGenerator::GenerateCode(const UArticyImportData* Data, FStri
 				}, "BlueprintType, Blueprintable");
 		});
 	OutFile = filename.Replace(TEXT(".h"), TEXT(""));
+
+	// The script bodies go into .cpp files, so they compile in parallel
+	TArray<FString> sourceFiles;
+	if (Data->GetSettings().set_UseScriptSupport)
+	{
+		TArray<FExpressoScript> conditions;
+		TArray<FExpressoScript> instructions;
+		CollectExpressoScripts(Data, conditions, instructions);
+
+		const FString tablesFilename = OutFile + ".cpp";
+		CodeFileGenerator(tablesFilename, false, [&](CodeFileGenerator* file)
+			{
+				file->Line("#include \"" + filename + "\"");
+				file->Line();
+				GenerateExpressoScriptTables(file, Data, conditions, instructions);
+			});
+		sourceFiles.Add(tablesFilename);
+
+		/**
+		 * Scripts are assigned to a shard by their hash, so a changed script only changes its own shard.
+		 * All shards are written even if they are empty, so the set of files only changes with the setting.
+		 */
+		const int32 numShards = FMath::Max(1, UArticyPluginSettings::Get()->ExpressoScriptShards);
+		TArray<TArray<const FExpressoScript*>> shardConditions;
+		TArray<TArray<const FExpressoScript*>> shardInstructions;
+		shardConditions.SetNum(numShards);
+		shardInstructions.SetNum(numShards);
+		for (const auto& script : conditions)
+			shardConditions[script.Key % numShards].Add(&script);
+		for (const auto& script : instructions)
+			shardInstructions[script.Key % numShards].Add(&script);
+
+		for (int32 shard = 0; shard < numShards; ++shard)
+		{
+			const FString shardFilename = FString::Printf(TEXT("%s_%d.cpp"), *OutFile, shard);
+			CodeFileGenerator(shardFilename, false, [&](CodeFileGenerator* file)
+				{
+					file->Line("#include \"" + filename + "\"");
+					GenerateExpressoScriptShard(file, Data, shardConditions[shard], shardInstructions[shard]);
+				});
+			sourceFiles.Add(shardFilename);
+		}
+	}
+
+	// Delete the source files of a previous generation with more shards (or with script support)
+	CodeGenerator::DeleteStaleCode(OutFile + TEXT("*.cpp"), sourceFiles);
 }
 
 /**
@@ -36,6 +36,9 @@ void GlobalVarsGenerator::GenerateCode(const UArticyImportData* Data, FString& O
 			header->Line("#pragma warning(disable: 4883) //<disable \"optimization cannot be applied due to function size\" compile error.");
 			header->Line("#endif");
 
+			// The dense index of the first variable of the current namespace, see UArticyGlobalVariables::GetVariableIndex
+			int32 firstVariableIndex = 0;
+
 			// Generate all the namespaces (with comment)
 			for (const auto& ns : Data->GetGlobalVars().Namespaces)
 			{
@@ -51,6 +54,14 @@ void GlobalVarsGenerator::GenerateCode(const UArticyImportData* Data, FString& O
 
 						header->Line();
 
+						// The dense indices of the variables, in the order they are added in Init
+						header->Comment("the indices of the variables in UArticyGlobalVariables::GetVariableByIndex");
+						for (int32 i = 0; i < ns.Variables.Num(); ++i)
+							header->Line(FString::Printf(TEXT("static constexpr int32 %sIndex = %d;"), *ns.Variables[i].Variable, firstVariableIndex + i));
+						firstVariableIndex += ns.Variables.Num();
+
+						header->Line();
+
 						// In the constructor, create the subobject for all the variables
 						header->Method("", ns.CppTypename, "", [&]
 							{
@@ -90,6 +101,13 @@ void GlobalVarsGenerator::GenerateCode(const UArticyImportData* Data, FString& O
 							FString::Printf(TEXT("VisibleAnywhere, BlueprintReadOnly, Category=\"%s\""), *ns.Namespace));
 					}
 
+					header->Line();
+
+					// The indices of the namespaces, in the order they are added in Init
+					header->Comment(TEXT("the indices of the namespaces in GetVariableSets"));
+					for (int32 i = 0; i < Data->GetGlobalVars().Namespaces.Num(); ++i)
+						header->Line(FString::Printf(TEXT("static constexpr int32 %sIndex = %d;"), *Data->GetGlobalVars().Namespaces[i].Namespace, i));
+
 					//---------------------------------------------------------------------------//
 					header->Line();
 
@@ -138,9 +156,10 @@ void GlobalVarsGenerator::GenerateCode(const UArticyImportData* Data, FString& O
  * This function creates the project-specific global variables asset for Articy.
  *
  * @param Data The import data used for asset generation.
+ * @return A pointer to the generated global variables asset.
  */
-void GlobalVarsGenerator::GenerateAsset(const UArticyImportData* Data)
+UArticyGlobalVariables* GlobalVarsGenerator::GenerateAsset(const UArticyImportData* Data)
 {
 	const auto& className = CodeGenerator::GetGlobalVarsClassname(Data, true);
-	ArticyImporterHelpers::GenerateAsset<UArticyGlobalVariables>(*className, FApp::GetProjectName(), TEXT(""), TEXT(""), RF_ArchetypeObject);
+	return ArticyImporterHelpers::GenerateAsset<UArticyGlobalVariables>(*className, FApp::GetProjectName(), TEXT(""), TEXT(""), RF_ArchetypeObject);
 }
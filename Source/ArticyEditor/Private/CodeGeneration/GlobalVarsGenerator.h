@@ -5,6 +5,7 @@
 #pragma once
 
 class UArticyImportData;
+class UArticyGlobalVariables;
 struct FArticyGVInfo;
 class FString;
 
@@ -31,8 +32,9 @@ public:
 	 * Creates the project-specific global variables asset for Articy.
 	 *
 	 * @param Data The import data used for asset generation.
+	 * @return A pointer to the generated global variables asset.
 	 */
-	static void GenerateAsset(const UArticyImportData* Data);
+	static UArticyGlobalVariables* GenerateAsset(const UArticyImportData* Data);
 
 private:
 	GlobalVarsGenerator() {}
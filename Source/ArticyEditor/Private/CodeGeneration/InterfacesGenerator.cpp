@@ -10,7 +10,8 @@
 /**
  * @brief Generates code for Articy interfaces based on import data.
  *
- * This function creates header files for interfaces associated with Articy features.
+ * Every feature interface is written into a header of its own, which the headers of the templates with the feature
+ * include, and the generated interfaces header merely includes all of them.
  *
  * @param Data The import data used for code generation.
  * @param OutFile The output filename for the generated code.
@@ -18,18 +19,19 @@
 void InterfacesGenerator::GenerateCode(const UArticyImportData* Data, FString& OutFile)
 {
 	OutFile = CodeGenerator::GetGeneratedInterfacesFilename(Data);
-	CodeFileGenerator(OutFile + ".h", true, [&](CodeFileGenerator* header)
-		{
-			header->Line("#include \"CoreUObject.h\"");
-			if (Data->GetObjectDefs().GetFeatures().Num() > 0)
-				header->Line("#include \"" + CodeGenerator::GetGeneratedInterfacesFilename(Data) + ".generated.h\"");
-			header->Line();
 
-			for (auto pair : Data->GetObjectDefs().GetFeatures())
-			{
-				FArticyTemplateFeatureDef feature = pair.Value;
+	TArray<FString> shardFiles;
+	for (const auto& pair : Data->GetObjectDefs().GetFeatures())
+	{
+		const FArticyTemplateFeatureDef& feature = pair.Value;
+		const FString shardFilename = CodeGenerator::GetGeneratedInterfaceShardFilename(Data, feature);
 
+		CodeFileGenerator(shardFilename + ".h", true, [&](CodeFileGenerator* header)
+			{
+				header->Line("#include \"CoreUObject.h\"");
+				header->Line("#include \"" + shardFilename + ".generated.h\"");
 				header->Line();
+
 				header->UInterface(CodeGenerator::GetFeatureInterfaceClassName(Data, feature, true),
 					"MinimalAPI, BlueprintType, Category=\"" + Data->GetProject().TechnicalName + " Feature Interfaces\", meta=(CannotImplementInterfaceInBlueprint)",
 					"UNINTERFACE generated from Articy " + feature.GetDisplayName() + " Feature", [&]
@@ -41,6 +43,20 @@ void InterfacesGenerator::GenerateCode(const UArticyImportData* Data, FString& O
 								header->Line("return nullptr", true);
 							}, "", true, "BlueprintCallable", "const");
 					});
-			}
+			});
+		shardFiles.Add(shardFilename + ".h");
+	}
+
+	// The interfaces header only bundles the shards
+	CodeFileGenerator(OutFile + ".h", true, [&](CodeFileGenerator* header)
+		{
+			header->Line("#include \"CoreUObject.h\"");
+			header->Line();
+
+			for (const FString& shardFile : shardFiles)
+				header->Line("#include \"" + shardFile + "\"");
 		});
+
+	// Delete the shards of features which were removed
+	CodeGenerator::DeleteStaleCode(OutFile + TEXT("_*.h"), shardFiles);
 }
@@ -6,11 +6,50 @@
 #include "CodeFileGenerator.h"
 #include "ObjectDefinitionsImport.h"
 #include "ArticyImportData.h"
+#include "ArticyEditorModule.h"
+#include "PredefinedTypes.h"
+
+namespace
+{
+	/**
+	 * @brief Writes the includes and forward declarations of the imported types a shard depends on.
+	 *
+	 * @param header The generator of the shard.
+	 * @param Data The import data used for code generation.
+	 * @param Self The original type declared by the shard, or none for feature shards.
+	 * @param Includes The types whose shards are included.
+	 * @param Declarations The types which are forward declared.
+	 */
+	void GenerateShardDependencies(CodeFileGenerator* header, const UArticyImportData* Data, const FName& Self, const TSet<FName>& Includes, const TSet<FName>& Declarations)
+	{
+		for (const FName& type : Includes)
+		{
+			if (type != Self)
+				header->Line("#include \"" + CodeGenerator::GetGeneratedTypeShardFilename(Data, type) + ".h\"");
+		}
+
+		bool bDeclared = false;
+		for (const FName& type : Declarations)
+		{
+			if (type == Self || Includes.Contains(type))
+				continue;
+
+			if (!bDeclared)
+			{
+				header->Line();
+				bDeclared = true;
+			}
+			header->Line("class " + Data->GetObjectDefs().GetCppType(type, Data, false), true);
+		}
+	}
+}
 
 /**
  * @brief Generates code for Articy object definitions based on import data.
  *
- * This function creates header files for object types defined in the Articy project.
+ * Every object definition and every feature class is written into a header of its own, so a change of a template only
+ * recompiles the files including it, and the generated types header merely includes all of them.
+ * Each header includes the headers declaring its base class, its features and the enums it uses.
  *
  * @param Data The import data used for code generation.
  * @param OutFile The output filename for the generated code.
@@ -18,15 +57,79 @@
 void ObjectDefinitionsGenerator::GenerateCode(const UArticyImportData* Data, FString& OutFile)
 {
 	OutFile = CodeGenerator::GetGeneratedTypesFilename(Data);
+	const auto& objectDefs = Data->GetObjectDefs();
+
+	TArray<FString> shardFiles;
+
+	// The features are defined by every template using them, their classes are generated once
+	for (const auto& pair : objectDefs.GetFeatures())
+	{
+		const FArticyTemplateFeatureDef& feature = pair.Value;
+		const FString shardFilename = CodeGenerator::GetGeneratedFeatureShardFilename(Data, feature);
+
+		TSet<FName> includes;
+		TSet<FName> declarations;
+		feature.GatherCodeDependencies(Data, includes, declarations);
+
+		CodeFileGenerator(shardFilename + ".h", true, [&](CodeFileGenerator* header)
+			{
+				header->Line("#include \"CoreUObject.h\"");
+				header->Line("#include \"ArticyBaseInclude.h\"");
+				GenerateShardDependencies(header, Data, NAME_None, includes, declarations);
+				header->Line("#include \"" + shardFilename + ".generated.h\"");
+				header->Line();
+
+				feature.GenerateDefCode(*header, Data);
+			});
+		shardFiles.Add(shardFilename + ".h");
+	}
+
+	TArray<FString> typeShards;
+	for (const auto& type : objectDefs.GetTypes())
+	{
+		if (FArticyPredefTypes::IsPredefinedType(type.Key))
+		{
+			UE_LOG(LogArticyEditor, Log, TEXT("Skipped import of %s as it is a predefined type (%s)."), *type.Key.ToString(), *objectDefs.GetCppType(type.Key, Data, false));
+			continue;
+		}
+
+		const FString shardFilename = CodeGenerator::GetGeneratedTypeShardFilename(Data, type.Key);
+
+		TSet<FName> includes;
+		TSet<FName> declarations;
+		type.Value.GatherCodeDependencies(Data, includes, declarations);
+
+		CodeFileGenerator(shardFilename + ".h", true, [&](CodeFileGenerator* header)
+			{
+				header->Line("#include \"CoreUObject.h\"");
+				header->Line("#include \"ArticyBaseInclude.h\"");
+				for (const auto& feature : type.Value.GetFeatures())
+				{
+					header->Line("#include \"" + CodeGenerator::GetGeneratedFeatureShardFilename(Data, feature) + ".h\"");
+					header->Line("#include \"" + CodeGenerator::GetGeneratedInterfaceShardFilename(Data, feature) + ".h\"");
+				}
+				GenerateShardDependencies(header, Data, type.Key, includes, declarations);
+				header->Line("#include \"" + shardFilename + ".generated.h\"");
+				header->Line();
+
+				type.Value.GenerateCode(*header, Data);
+			});
+		shardFiles.Add(shardFilename + ".h");
+		typeShards.Add(shardFilename);
+	}
+
+	// The types header only bundles the shards, for the code including all generated types
 	CodeFileGenerator(OutFile + ".h", true, [&](CodeFileGenerator* header)
 		{
 			header->Line("#include \"CoreUObject.h\"");
 			header->Line("#include \"ArticyBaseInclude.h\"");
 			header->Line("#include \"" + CodeGenerator::GetGeneratedInterfacesFilename(Data) + ".h\"");
-			header->Line("#include \"" + CodeGenerator::GetGeneratedTypesFilename(Data) + ".generated.h\"");
 			header->Line();
 
-			for (const auto& type : Data->GetObjectDefs().GetTypes())
-				type.Value.GenerateCode(*header, Data);
+			for (const FString& shard : typeShards)
+				header->Line("#include \"" + shard + ".h\"");
 		});
+
+	// Delete the shards of types and features which were removed
+	CodeGenerator::DeleteStaleCode(OutFile + TEXT("_*.h"), shardFiles);
 }
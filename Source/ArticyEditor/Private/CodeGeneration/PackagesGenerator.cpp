@@ -4,21 +4,28 @@
 
 #include "PackagesGenerator.h"
 #include "ArticyImportData.h"
+#include "ArticyReachabilityAnalysis.h"
 
 #define LOCTEXT_NAMESPACE "PackagesGenerator"
 
 /**
  * @brief Generates package assets for Articy import data.
  *
- * This function creates new Articy package objects based on the definitions in the import data.
+ * This function creates new Articy package objects based on the definitions in the import data,
+ * marks the objects which are not reachable from the configured entry points as stripped from cooked builds,
+ * and writes the reference index of each package.
  *
  * @param Data The import data used for asset generation.
+ * @param bRegenerateAll If true, unchanged packages are regenerated as well.
  */
-void PackagesGenerator::GenerateAssets(UArticyImportData* Data)
+void PackagesGenerator::GenerateAssets(UArticyImportData* Data, bool bRegenerateAll)
 {
 	// Generate new Articy objects
 	const auto& ArticyPackageDefs = Data->GetPackageDefs();
-	ArticyPackageDefs.GenerateAssets(Data);
+	ArticyPackageDefs.GenerateAssets(Data, bRegenerateAll);
+
+	FArticyReachabilityAnalysis::Run(Data);
+	FArticyReachabilityAnalysis::BuildReferenceIndices(Data);
 }
 
 #undef LOCTEXT_NAMESPACE
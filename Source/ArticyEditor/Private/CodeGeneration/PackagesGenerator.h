@@ -17,8 +17,9 @@ public:
 	 * Creates new Articy package objects based on the definitions in the import data.
 	 *
 	 * @param Data The import data used for asset generation.
+	 * @param bRegenerateAll If true, unchanged packages are regenerated as well.
 	 */
-	static void GenerateAssets(class UArticyImportData* Data);
+	static void GenerateAssets(class UArticyImportData* Data, bool bRegenerateAll);
 
 private:
 	PackagesGenerator() {}
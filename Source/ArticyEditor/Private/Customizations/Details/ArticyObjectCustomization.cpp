@@ -0,0 +1,112 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "Customizations/Details/ArticyObjectCustomization.h"
+#include "ArticyObject.h"
+#include "ArticyObjectIndexSubsystem.h"
+#include "ArticyReferenceIndex.h"
+#include "DetailCategoryBuilder.h"
+#include "DetailLayoutBuilder.h"
+#include "DetailWidgetRow.h"
+#include "Slate/UserInterfaceHelperFunctions.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Text/STextBlock.h"
+
+#define LOCTEXT_NAMESPACE "ArticyObjectCustomization"
+
+/**
+ * @brief Creates an instance of the ArticyObjectCustomization.
+ *
+ * @return A shared pointer to a new instance of the ArticyObjectCustomization class.
+ */
+TSharedRef<IDetailCustomization> FArticyObjectCustomization::MakeInstance()
+{
+	return MakeShareable(new FArticyObjectCustomization());
+}
+
+/**
+ * @brief Adds the incoming references of a single articy object to the details panel.
+ *
+ * Each reference is a row with the referring object, how it refers to the object, and a button showing it in
+ * articy:draft. The references are looked up in the reference indices of the packages written by the import.
+ *
+ * @param DetailBuilder The detail layout builder used to customize the details panel.
+ */
+void FArticyObjectCustomization::CustomizeDetails(IDetailLayoutBuilder& DetailBuilder)
+{
+	TArray<TWeakObjectPtr<UObject>> WeakObjects;
+	DetailBuilder.GetObjectsBeingCustomized(WeakObjects);
+
+	if (WeakObjects.Num() != 1) return;
+
+	const UArticyObject* ArticyObject = Cast<UArticyObject>(WeakObjects[0].Get());
+	UArticyObjectIndexSubsystem* ObjectIndex = UArticyObjectIndexSubsystem::Get();
+	if (!ArticyObject || !ObjectIndex) return;
+
+	const TArray<FArticyIncomingReference> References = ObjectIndex->GetIncomingReferences(ArticyObject->GetId());
+
+	IDetailCategoryBuilder& CategoryBuilder = DetailBuilder.EditCategory(TEXT("Incoming References"),
+		FText::Format(LOCTEXT("IncomingReferences", "Incoming References ({0})"), References.Num()), ECategoryPriority::Uncommon);
+	CategoryBuilder.InitiallyCollapsed(true);
+
+	if (References.Num() == 0)
+	{
+		CategoryBuilder.AddCustomRow(LOCTEXT("NoReferences", "No references"))
+			.WholeRowContent()
+			[
+				SNew(STextBlock)
+					.Font(IDetailLayoutBuilder::GetDetailFont())
+					.Text(LOCTEXT("NoReferencesText", "No object refers to this one, or the packages were imported before the references were indexed."))
+			];
+		return;
+	}
+
+	const UEnum* KindEnum = StaticEnum<EArticyReferenceKind>();
+	for (const FArticyIncomingReference& Reference : References)
+	{
+		const UArticyObject* Source = ObjectIndex->FindObject(Reference.Source);
+		const FText SourceName = Source ? FText::FromName(Source->GetTechnicalName()) : FText::FromString(FString::Printf(TEXT("0x%016llX"), Reference.Source.Get()));
+
+		const FText KindText = KindEnum->GetDisplayNameTextByValue(static_cast<int64>(Reference.Kind));
+		const FText Description = Reference.Property.IsNone() ? KindText
+			: FText::Format(LOCTEXT("PropertyReference", "{0} {1}"), KindText, FText::FromName(Reference.Property));
+
+		const FArticyId SourceId = Reference.Source;
+		CategoryBuilder.AddCustomRow(SourceName)
+			.NameContent()
+			[
+				SNew(STextBlock)
+					.Font(IDetailLayoutBuilder::GetDetailFont())
+					.Text(SourceName)
+			]
+			.ValueContent()
+			.MinDesiredWidth(150)
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.FillWidth(1.f)
+				.VAlign(VAlign_Center)
+				[
+					SNew(STextBlock)
+						.Font(IDetailLayoutBuilder::GetDetailFont())
+						.Text(Description)
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				[
+					SNew(SButton)
+						.Text(LOCTEXT("ShowInArticy", "Show"))
+						.ToolTipText(LOCTEXT("ShowInArticyTooltip", "Show the referring object in articy:draft"))
+						.OnClicked_Lambda([SourceId]()
+						{
+							UserInterfaceHelperFunctions::ShowObjectInArticy(SourceId, false);
+							return FReply::Handled();
+						})
+				]
+			];
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,263 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "LocalizationPackGenerator.h"
+#include "ArticyLocalizationPack.h"
+#include "ArticyTextExtension.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "ISourceControlModule.h"
+#include "ISourceControlProvider.h"
+#include "SourceControlHelpers.h"
+
+using namespace ArticyLocalizationPackFormat;
+
+namespace
+{
+    /** Appends the bytes of a value to the content. */
+    template<typename T>
+    void AppendBytes(TArray<uint8>& Content, const T& Value)
+    {
+        Content.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+    }
+
+    /** Appends the UTF-16 code units of a string to the content. */
+    void AppendChars(TArray<uint8>& Content, const FString& String)
+    {
+        Content.Append(reinterpret_cast<const uint8*>(*String), String.Len() * sizeof(TCHAR));
+    }
+
+    /** Pools the texts of a section by their exact (case-sensitive) content. */
+    struct FTextPoolKeyFuncs : BaseKeyFuncs<TPair<FString, uint32>, FString>
+    {
+        static const FString& GetSetKey(const TPair<FString, uint32>& Element) { return Element.Key; }
+        static bool Matches(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+        static uint32 GetKeyHash(const FString& Key) { return Hash(*Key, Key.Len()); }
+    };
+
+    /**
+     * Appends the blocks of compressed texts of a section and their data.
+     *
+     * @param Content The content, ending with the keys of the section.
+     * @param SectionOffset The offset of the section, the offsets of the data are relative to it.
+     * @param Texts The distinct texts of the section, in the order of their offsets.
+     * @param BlockStarts The first code unit of each block.
+     * @param NumTextChars The number of code units of all texts.
+     */
+    void AppendCompressedBlocks(TArray<uint8>& Content, uint64 SectionOffset, const TArray<const FString*>& Texts, const TArray<uint32>& BlockStarts, uint32 NumTextChars)
+    {
+        TArray<TCHAR> TextChars;
+        TextChars.Reserve(NumTextChars);
+        for (const FString* Text : Texts)
+            TextChars.Append(**Text, Text->Len());
+
+        Content.AddZeroed(Align(Content.Num(), alignof(FBlock)) - Content.Num());
+        const int32 BlocksOffset = Content.Num();
+        Content.AddZeroed(BlockStarts.Num() * sizeof(FBlock));
+
+        TArray<FBlock> Blocks;
+        Blocks.SetNumZeroed(BlockStarts.Num());
+        TArray<uint8> Compressed;
+        for (int32 Index = 0; Index < BlockStarts.Num(); ++Index)
+        {
+            FBlock& Block = Blocks[Index];
+            Block.FirstChar = BlockStarts[Index];
+            Block.NumChars = (Index + 1 < BlockStarts.Num() ? BlockStarts[Index + 1] : NumTextChars) - Block.FirstChar;
+
+            const int32 RawSize = Block.NumChars * sizeof(TCHAR);
+            int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, RawSize);
+            Compressed.SetNumUninitialized(CompressedSize);
+            if (!ensure(FCompression::CompressMemory(NAME_Zlib, Compressed.GetData(), CompressedSize, TextChars.GetData() + Block.FirstChar, RawSize)))
+                CompressedSize = 0;
+
+            Block.DataOffset = Content.Num() - SectionOffset;
+            Block.DataSize = CompressedSize;
+            Content.Append(Compressed.GetData(), CompressedSize);
+        }
+
+        FMemory::Memcpy(Content.GetData() + BlocksOffset, Blocks.GetData(), Blocks.Num() * sizeof(FBlock));
+    }
+
+    /** Pads the content with zeros up to the section alignment. */
+    void PadToSectionAlignment(TArray<uint8>& Content)
+    {
+        Content.AddZeroed(Align(Content.Num(), SectionAlignment) - Content.Num());
+    }
+}
+
+LocalizationPackGenerator::LocalizationPackGenerator(const FString& Culture, bool bInCompressTexts)
+    : bCompressTexts(bInCompressTexts)
+{
+    Path = FPaths::ProjectContentDir() / GetRelativePath(Culture);
+}
+
+void LocalizationPackGenerator::Table(const FString& TableName)
+{
+    Tables.AddDefaulted_GetRef().Name = TableName;
+}
+
+void LocalizationPackGenerator::Line(const FString& Key, const FString& SourceString)
+{
+    // Empty keys mark empty buckets in the index
+    if (ensure(Tables.Num() > 0) && !Key.IsEmpty())
+        Tables.Last().Entries.Emplace(Key, SourceString);
+}
+
+void LocalizationPackGenerator::Build()
+{
+    Content.Reset();
+
+    FHeader Header;
+    Header.Magic = Magic;
+    Header.Version = Version;
+    Header.NumTables = Tables.Num();
+    Header.Flags = TokensMarked | (bCompressTexts ? CompressedTexts : 0);
+    AppendBytes(Content, Header);
+
+    // The directory is filled in once the offsets of the names and sections are known
+    const int32 DirectoryOffset = Content.Num();
+    Content.AddZeroed(Tables.Num() * sizeof(FTable));
+
+    TArray<FTable> Directory;
+    Directory.SetNumZeroed(Tables.Num());
+    for (int32 Index = 0; Index < Tables.Num(); ++Index)
+    {
+        const FString& Name = Tables[Index].Name;
+        Directory[Index].NameHash = Hash(*Name, Name.Len());
+        Directory[Index].NameLength = Name.Len();
+        Directory[Index].NameOffset = Content.Num();
+        AppendChars(Content, Name);
+    }
+
+    for (int32 Index = 0; Index < Tables.Num(); ++Index)
+    {
+        const TArray<TPair<FString, FString>>& Entries = Tables[Index].Entries;
+        FTable& Table = Directory[Index];
+
+        PadToSectionAlignment(Content);
+        Table.SectionOffset = Content.Num();
+        Table.NumEntries = Entries.Num();
+
+        // At most half of the buckets are used, which keeps the probe sequences short
+        Table.NumBuckets = Entries.Num() > 0 ? FMath::RoundUpToPowerOfTwo(Entries.Num() * 2) : 0;
+        TArray<FBucket> Buckets;
+        Buckets.SetNumZeroed(Table.NumBuckets);
+
+        // Texts repeat a lot within a package (speaker lines, menu texts, placeholders), so each distinct text of
+        // the table is stored once and all buckets with it point to the same characters
+        TMap<FString, uint32, FDefaultSetAllocator, FTextPoolKeyFuncs> TextOffsets;
+        TArray<const FString*> Strings;
+        Strings.Reserve(Entries.Num() * 2);
+
+        // Compressed packs store the texts apart from the keys, in blocks which start at these code units
+        TArray<const FString*> Texts;
+        TArray<uint32> BlockStarts;
+        uint32 TextCharOffset = 0;
+
+        uint32 CharOffset = 0;
+        const uint32 Mask = Table.NumBuckets - 1;
+        for (const TPair<FString, FString>& Entry : Entries)
+        {
+            const uint32 KeyHash = Hash(*Entry.Key, Entry.Key.Len());
+            uint32 BucketIndex = KeyHash & Mask;
+            while (Buckets[BucketIndex].KeyLength != 0)
+                BucketIndex = (BucketIndex + 1) & Mask;
+
+            FBucket& Bucket = Buckets[BucketIndex];
+            Bucket.KeyHash = KeyHash;
+            Bucket.KeyLength = Entry.Key.Len();
+            Bucket.KeyOffset = CharOffset;
+            Bucket.TextLength = Entry.Value.Len();
+            if (FArticyTextTemplate::HasTokens(Entry.Value))
+                Bucket.TextLength |= TextHasTokens;
+            CharOffset += Entry.Key.Len();
+            Strings.Add(&Entry.Key);
+
+            if (Entry.Value.IsEmpty())
+                continue;
+
+            if (const uint32* PooledOffset = TextOffsets.Find(Entry.Value))
+            {
+                Bucket.TextOffset = *PooledOffset;
+                continue;
+            }
+
+            if (bCompressTexts)
+            {
+                // A text never spans two blocks, so a lookup decompresses a single one
+                if (BlockStarts.Num() == 0 || (TextCharOffset > BlockStarts.Last() && TextCharOffset - BlockStarts.Last() + Entry.Value.Len() > TextBlockChars))
+                    BlockStarts.Add(TextCharOffset);
+
+                Bucket.TextOffset = TextCharOffset;
+                TextOffsets.Add(Entry.Value, TextCharOffset);
+                TextCharOffset += Entry.Value.Len();
+                Texts.Add(&Entry.Value);
+                continue;
+            }
+
+            Bucket.TextOffset = CharOffset;
+            TextOffsets.Add(Entry.Value, CharOffset);
+            CharOffset += Entry.Value.Len();
+            Strings.Add(&Entry.Value);
+        }
+
+        if (bCompressTexts)
+        {
+            FCompressedSection SectionHeader;
+            SectionHeader.NumKeyChars = CharOffset;
+            SectionHeader.NumBlocks = BlockStarts.Num();
+            SectionHeader.NumTextChars = TextCharOffset;
+            SectionHeader.Reserved = 0;
+            AppendBytes(Content, SectionHeader);
+        }
+
+        Content.Append(reinterpret_cast<const uint8*>(Buckets.GetData()), Buckets.Num() * sizeof(FBucket));
+        for (const FString* String : Strings)
+            AppendChars(Content, *String);
+
+        if (bCompressTexts)
+            AppendCompressedBlocks(Content, Table.SectionOffset, Texts, BlockStarts, TextCharOffset);
+
+        Table.SectionSize = Content.Num() - Table.SectionOffset;
+    }
+
+    FMemory::Memcpy(Content.GetData() + DirectoryOffset, Directory.GetData(), Directory.Num() * sizeof(FTable));
+
+    // The entries are not needed anymore once they are laid out
+    Tables.Empty();
+}
+
+void LocalizationPackGenerator::Finish()
+{
+    // Like the string tables, unchanged packs are neither rewritten nor checked out
+    TArray<uint8> ExistingContent;
+    if (IFileManager::Get().FileSize(*Path) == Content.Num() && FFileHelper::LoadFileToArray(ExistingContent, *Path) && ExistingContent == Content)
+        return;
+
+    ISourceControlModule& SCModule = ISourceControlModule::Get();
+
+    bool bCheckOutEnabled = false;
+    if (SCModule.IsEnabled())
+    {
+        bCheckOutEnabled = ISourceControlModule::Get().GetProvider().UsesCheckout();
+    }
+
+    // Try to check out the file if it exists
+    bool bFileExisted = false;
+    if (IFileManager::Get().FileExists(*Path) && bCheckOutEnabled)
+    {
+        USourceControlHelpers::CheckOutFile(*Path);
+        bFileExisted = true;
+    }
+
+    const bool bFileWritten = FFileHelper::SaveArrayToFile(Content, *Path);
+
+    // Mark the file for addition if it is newly created
+    if (!bFileExisted && bFileWritten && SCModule.IsEnabled())
+    {
+        USourceControlHelpers::MarkFileForAdd(*Path);
+    }
+}
@@ -0,0 +1,75 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "Containers/UnrealString.h"
+
+/**
+ * @class LocalizationPackGenerator
+ * @brief Writes the binary localization pack of one culture, see ArticyLocalizationPackFormat.
+ *
+ * The string tables are collected with Table and Line, in the same way the CSV string tables are generated.
+ * Build lays out the pack in memory and is thread-safe, Finish writes it and talks to source control and is not.
+ */
+class LocalizationPackGenerator
+{
+public:
+
+    /**
+     * @brief Constructs a generator for the pack of a culture.
+     *
+     * @param Culture The culture/language code for localization.
+     * @param bInCompressTexts Whether the texts are stored in compressed blocks, see ArticyLocalizationPackFormat::CompressedTexts.
+     */
+    explicit LocalizationPackGenerator(const FString& Culture, bool bInCompressTexts = false);
+
+    /**
+     * @brief Starts a string table, the following lines are added to it.
+     *
+     * @param TableName The name of the string table.
+     */
+    void Table(const FString& TableName);
+
+    /**
+     * @brief Adds an entry to the current string table.
+     *
+     * @param Key The key for the string entry.
+     * @param SourceString The source string for the entry.
+     */
+    void Line(const FString& Key, const FString& SourceString);
+
+    /**
+     * @brief Lays out the pack in memory.
+     */
+    void Build();
+
+    /**
+     * @brief Writes the built pack and registers it with source control.
+     *
+     * Does nothing if the existing pack already has the same content. Must be called on the game thread.
+     */
+    void Finish();
+
+private:
+
+    /** A string table of the pack, with its entries in the order they were added. */
+    struct FTableEntries
+    {
+        FString Name;
+        TArray<TPair<FString, FString>> Entries;
+    };
+
+    /** The file path where the pack will be saved. */
+    FString Path;
+
+    /** Whether the texts are compressed. */
+    bool bCompressTexts = false;
+
+    /** The string tables, see Table. */
+    TArray<FTableEntries> Tables;
+
+    /** The content of the pack, see Build. */
+    TArray<uint8> Content;
+};
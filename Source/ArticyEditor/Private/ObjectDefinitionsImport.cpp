@@ -12,6 +12,8 @@
 #include "ArticyFlowClasses.h"
 #include "ArticyScriptFragment.h"
 #include "ArticyEntity.h"
+#include "ArticyAsset.h"
+#include "ArticyPluginSettings.h"
 #include "JsonObjectConverter.h"
 #include "UObject/ConstructorHelpers.h"
 
@@ -44,18 +46,6 @@ void FArticyTemplateDef::ImportFromJson(const TSharedPtr<FJsonObject> JsonObject
     ArticyType.LocaKey_DisplayName = DisplayName;
 }
 
-/**
- * Generates feature definitions in the header file using CodeFileGenerator.
- *
- * @param header A reference to the CodeFileGenerator.
- * @param Data A pointer to the UArticyImportData object.
- */
-void FArticyTemplateDef::GenerateFeaturesDefs(CodeFileGenerator& header, const UArticyImportData* Data) const
-{
-    for (const auto& feat : Features)
-        feat.GenerateDefCode(header, Data);
-}
-
 /**
  * Generates property definitions in the header file using CodeFileGenerator.
  *
@@ -184,12 +174,6 @@ bool FArticyObjectDef::IsBaseProperty(FName Property, const UArticyImportData* D
  */
 void FArticyObjectDef::GenerateCode(CodeFileGenerator& header, const UArticyImportData* Data) const
 {
-    if (FArticyPredefTypes::IsPredefinedType(GetOriginalType()))
-    {
-        UE_LOG(LogArticyEditor, Log, TEXT("Skipped import of %s as it is a predefined type (%s)."), *GetOriginalType().ToString(), *Data->GetObjectDefs().GetCppType(GetOriginalType(), Data, false));
-        return;
-    }
-
     header.Line();
     header.Comment("--------------------------------------------------------------------------------");
     header.Line();
@@ -200,12 +184,7 @@ void FArticyObjectDef::GenerateCode(CodeFileGenerator& header, const UArticyImpo
     }
     else
     {
-        if (DefType == EObjectDefType::Template)
-        {
-            //generate the template features
-            Template.GenerateFeaturesDefs(header, Data);
-        }
-
+        //the feature classes are generated once for all templates, see ObjectDefinitionsGenerator
         header.Class(GetCppType(Data, false) + " : public " + GetCppBaseClasses(Data), "UCLASS generated from ArticyObjectDef " + Type.ToString(), true, [&]
             {
                 header.Line("public:", false, true, -1);
@@ -236,6 +215,26 @@ void FArticyObjectDef::GenerateCode(CodeFileGenerator& header, const UArticyImpo
     }
 }
 
+/**
+ * Adds the imported types the generated class (or enum) depends on: the base type and the types of the properties.
+ *
+ * @param Data A pointer to the UArticyImportData object.
+ * @param OutIncludes Receives the types whose headers have to be included.
+ * @param OutDeclarations Receives the types which only need a forward declaration.
+ */
+void FArticyObjectDef::GatherCodeDependencies(const UArticyImportData* Data, TSet<FName>& OutIncludes, TSet<FName>& OutDeclarations) const
+{
+    //the base class has to be complete
+    if (!InheritsFrom.IsNone() && Data->GetObjectDefs().GetTypes().Contains(InheritsFrom) && !FArticyPredefTypes::IsPredefinedType(InheritsFrom))
+        OutIncludes.Add(InheritsFrom);
+
+    for (const auto& prop : Properties)
+    {
+        if (!IsBaseProperty(prop.GetPropetyName(), Data))
+            Data->GetObjectDefs().GatherPropertyDependencies(prop, OutIncludes, OutDeclarations);
+    }
+}
+
 /**
  * Gather scripts from model definition and adds them to the UArticyImportData.
  *
@@ -301,6 +300,9 @@ void FArticyObjectDef::InitializeModel(
         const auto& Category = FName{ TEXT("Category") };
         Model->SetProp(AssetRef, Vals.GetAssetRef());
         Model->SetProp(Category, Vals.GetAssetCat());
+
+        if (UArticyAsset* ArticyAsset = Cast<UArticyAsset>(Model))
+            ArticyAsset->UpdateAssetPath();
     }
 
     const auto& nameAndId = Vals.GetNameAndId();
@@ -330,6 +332,9 @@ void FArticyObjectDef::InitializeModel(
  */
 FString FArticyObjectDef::GetCppType(const UArticyImportData* Data, const bool bForProperty) const
 {
+    if (const FString* Cached = Data->GetObjectDefs().FindCachedCppType(Type, bForProperty))
+        return *Cached;
+
     switch (DefType)
     {
     case EObjectDefType::Enum:
@@ -408,6 +413,8 @@ void FArticyPropertyDef::ImportFromJson(const TSharedPtr<FJsonObject> JsonProper
     if (!JsonProperty.IsValid())
         return;
 
+    Setter = FCompiledSetter();
+
     JSON_TRY_FNAME(JsonProperty, Property);
 
     JSON_TRY_FNAME(JsonProperty, Type);
@@ -431,14 +438,7 @@ void FArticyPropertyDef::ImportFromJson(const TSharedPtr<FJsonObject> JsonProper
         else if (Type == string)
         {
             //this properties are always localized
-            static TArray<FName> LocalizedProperties;
-            if (LocalizedProperties.Num() == 0)
-            {
-                LocalizedProperties.Add(TEXT("StageDirections"));
-                LocalizedProperties.Add(TEXT("DisplayName"));
-                LocalizedProperties.Add(TEXT("MenuText"));
-                LocalizedProperties.Add(TEXT("Text"));
-            }
+            static const TArray<FName> LocalizedProperties = { TEXT("StageDirections"), TEXT("DisplayName"), TEXT("MenuText"), TEXT("Text") };
 
             //check if the property is one of the LocalizedProperties
             bIsLocalized = LocalizedProperties.Contains(Property);
@@ -466,15 +466,53 @@ void FArticyPropertyDef::ImportFromJson(const TSharedPtr<FJsonObject> JsonProper
 
 /**
  * Generates code for the property definition using CodeFileGenerator.
+ * Blueprints write the property through a generated setter calling SetProp, so the write goes to the writable
+ * instance of the object (see UArticyDatabase::GetWritableObject) like the writes of the scripts. Editor-only
+ * properties get no setter, as functions cannot be editor-only data. C++ code writing the member directly bypasses
+ * the writable instance and changes shared package assets, it has to use SetProp as well.
  *
  * @param header A reference to the CodeFileGenerator.
  * @param Data A pointer to the UArticyImportData object.
  */
 void FArticyPropertyDef::GenerateCode(CodeFileGenerator& header, const UArticyImportData* Data) const
 {
+    const bool bEditorOnly = IsEditorOnly();
+    if (bEditorOnly)
+        header.Line("#if WITH_EDITORONLY_DATA");
+
+    const FString cppType = GetCppType(Data);
+    const FString name = Property.ToString();
+    const FString setterName = "K2_Set" + name;
+
     //generate a variable for each Property
-    header.Variable(GetCppType(Data), Property.ToString(), FArticyObjectDefinitions::GetCppDefaultValue(Type), "", true,
-        FString::Printf(TEXT("EditAnywhere, BlueprintReadWrite, meta=(DisplayName=\"%s\")"), *DisplayName));
+    const FString setter = bEditorOnly ? FString() : FString::Printf(TEXT(", BlueprintSetter=%s"), *setterName);
+    header.Variable(cppType, name, FArticyObjectDefinitions::GetCppDefaultValue(Type), "", true,
+        FString::Printf(TEXT("EditAnywhere, BlueprintReadWrite%s, meta=(DisplayName=\"%s\")"), *setter, *DisplayName));
+
+    if (bEditorOnly)
+    {
+        header.Line("#endif");
+        return;
+    }
+
+    //pointers are passed by value, the other types by const reference
+    const FString parameter = cppType.EndsWith(TEXT("*")) ? cppType + " NewValue" : "const " + cppType + "& NewValue";
+    header.Method("void", setterName, parameter, [&]
+        {
+            header.Line(FString::Printf(TEXT("SetProp<%s>(TEXT(\"%s\"), NewValue)"), *cppType, *name), true);
+        }, "Sets " + name + " on the writable instance of this object, see IArticyReflectable::SetProp", true, "BlueprintSetter");
+}
+
+/**
+ * Returns whether the property is generated as editor-only data, see UArticyPluginSettings::EditorOnlyProperties.
+ * The comparison ignores the case, like the property names of the export.
+ *
+ * @return True if cooked builds do not have the property.
+ */
+bool FArticyPropertyDef::IsEditorOnly() const
+{
+    const UArticyPluginSettings* Settings = UArticyPluginSettings::Get();
+    return Settings->bGenerateEditorOnlyProperties && Settings->EditorOnlyProperties.Contains(Property.ToString());
 }
 
 /**
@@ -503,15 +541,16 @@ void FArticyPropertyDef::GatherScript(const TSharedPtr<FJsonObject>& JsonObject,
             const TArray<TSharedPtr<FJsonValue>>* pins;
             if (JsonObject->TryGetArrayField(Property.ToString(), pins) && pins)
             {
-                for (auto pin : *pins)
+                for (int32 index = 0; index < pins->Num(); ++index)
                 {
+                    const auto& pin = (*pins)[index];
                     if (!pin.IsValid() || !ensure(pin->Type == EJson::Object))
                         continue;
 
                     FString value;
                     //property may not be contained in values
                     if (pin->AsObject()->TryGetStringField(TEXT("Text"), value))
-                        Data->AddScriptFragment(value, isOutputPin);
+                        Data->AddScriptFragment(value, isOutputPin, FString::Printf(TEXT("%s[%d]"), *Property.ToString(), index));
                 }
             }
         }
@@ -531,7 +570,7 @@ void FArticyPropertyDef::GatherScript(const TSharedPtr<FJsonObject>& JsonObject,
             //property may not be contained in values
             FString value;
             if (JsonObject->TryGetStringField(Property.ToString(), value))
-                Data->AddScriptFragment(value, isInstruction);
+                Data->AddScriptFragment(value, isInstruction, Property.ToString());
         }
     }
 }
@@ -552,17 +591,60 @@ void FArticyPropertyDef::InitializeModel(
     const UArticyImportData* Data,
     const FString& PackageName) const
 {
-    auto jsonValue = JsonObject.IsValid() ? JsonObject->TryGetField(Property.ToString()) : nullptr;
+    const FCompiledSetter& Compiled = GetSetter(Model);
+    auto jsonValue = JsonObject.IsValid() ? JsonObject->TryGetField(Compiled.JsonKey) : nullptr;
 
     //property may not be contained in values
     if (!jsonValue.IsValid() || jsonValue->IsNull())
         return;
 
-    FArticyObjectDefinitions::SetProp(ItemType.IsNone() ? Type : ItemType, GetPropetyName(), Model, Path + "." + Property.ToString(), jsonValue, PackageName);
+    if (ensure(Compiled.Type))
+    {
+        const FString ValuePath = Path + Compiled.PathSuffix;
+        const TArray<TSharedPtr<FJsonValue>>* jArray;
+        if (Compiled.Slot == INDEX_NONE)
+        {
+            //the class has no such property, the named setters report it
+            if (jsonValue->TryGetArray(jArray))
+                Compiled.Type->SetArray(GetPropetyName(), Model, ValuePath, *jArray, PackageName);
+            else
+                Compiled.Type->SetProp(GetPropetyName(), Model, ValuePath, jsonValue, PackageName);
+        }
+        else if (jsonValue->TryGetArray(jArray))
+            Compiled.Type->SetArrayBySlot(Compiled.Slot, Model, ValuePath, *jArray, PackageName);
+        else
+            Compiled.Type->SetPropBySlot(Compiled.Slot, Model, ValuePath, jsonValue, PackageName);
+    }
 
     Model->ArticyType.MergeParent(ArticyType);
 }
 
+/**
+ * Returns the compiled setter of the property, compiling it on first use.
+ * The slots of inherited properties are the same in all derived classes, so the slot is only resolved again
+ * if a model of another class has a different property in it, e.g. after the classes were recompiled.
+ *
+ * @param Model The model about to be initialized.
+ * @return The compiled setter.
+ */
+const FArticyPropertyDef::FCompiledSetter& FArticyPropertyDef::GetSetter(const UArticyBaseObject* Model) const
+{
+    if (!Setter.Type)
+    {
+        Setter.Type = FArticyObjectDefinitions::GetSetterType(ItemType.IsNone() ? Type : ItemType);
+        Setter.JsonKey = Property.ToString();
+        Setter.PathSuffix = TEXT(".") + Setter.JsonKey;
+    }
+
+    if (Setter.Slot == INDEX_NONE || Model->GetPropertyBySlot(Setter.Slot) != Setter.Property)
+    {
+        Setter.Slot = Model->GetPropertySlot(GetPropetyName());
+        Setter.Property = Model->GetPropertyBySlot(Setter.Slot);
+    }
+
+    return Setter;
+}
+
 /**
  * Returns the C++ type of the property definition.
  *
@@ -679,9 +761,6 @@ void FArticyTemplateFeatureDef::ImportFromJson(const TSharedPtr<FJsonObject> Jso
  */
 void FArticyTemplateFeatureDef::GenerateDefCode(CodeFileGenerator& header, const UArticyImportData* Data) const
 {
-    if (!Data->GetObjectDefs().IsNewFeatureType(*GetCppType(Data, false)))
-        return;
-
     //generate feature type
     header.Class(GetCppType(Data, false) + " : public UArticyBaseFeature", "UCLASS generated from Articy " + DisplayName + " Feature", true, [&]
         {
@@ -696,6 +775,19 @@ void FArticyTemplateFeatureDef::GenerateDefCode(CodeFileGenerator& header, const
         });
 }
 
+/**
+ * Adds the imported types the generated feature class depends on.
+ *
+ * @param Data A pointer to the UArticyImportData object.
+ * @param OutIncludes Receives the types whose headers have to be included.
+ * @param OutDeclarations Receives the types which only need a forward declaration.
+ */
+void FArticyTemplateFeatureDef::GatherCodeDependencies(const UArticyImportData* Data, TSet<FName>& OutIncludes, TSet<FName>& OutDeclarations) const
+{
+    for (const auto& prop : Properties)
+        Data->GetObjectDefs().GatherPropertyDependencies(prop, OutIncludes, OutDeclarations);
+}
+
 /**
  * Generates property code for the template feature using CodeFileGenerator.
  *
@@ -771,6 +863,9 @@ UClass* FArticyTemplateFeatureDef::GetUClass(const UArticyImportData* Data) cons
  */
 FString FArticyTemplateFeatureDef::GetCppType(const UArticyImportData* Data, bool bAsVariable) const
 {
+    if (const FString* Cached = Data->GetObjectDefs().FindCachedFeatureCppType(TechnicalName, bAsVariable))
+        return *Cached;
+
     return FString::Printf(TEXT("U%s%sFeature%s"), *Data->GetProject().TechnicalName, *TechnicalName, bAsVariable ? TEXT("*") : TEXT(""));
 }
 
@@ -785,7 +880,6 @@ FString FArticyTemplateFeatureDef::GetCppType(const UArticyImportData* Data, boo
 void FArticyObjectDefinitions::ImportFromJson(const TArray<TSharedPtr<FJsonValue>>* Json, const UArticyImportData* Data)
 {
     Types.Reset();
-    FeatureTypes.Reset();
     FeatureDefs.Reset();
 
     if (!Json)
@@ -838,7 +932,11 @@ void FArticyObjectDefinitions::GatherScripts(const FArticyModelDef& Values, UArt
 {
     const auto& def = Types.Find(Values.GetType());
     if (ensure(def))
+    {
+        //the problems found in the scripts name the object they are in
+        Data->SetScriptFragmentOwner(Values.GetId(), Values.GetTechnicalName());
         def->GatherScripts(Values, Data);
+    }
     else
     {
         UE_LOG(LogArticyEditor, Error, TEXT("Model type %s for Model %s not found in definitions!"), *Values.GetType().ToString(), *Values.GetTechnicalName());
@@ -884,6 +982,9 @@ FString FArticyObjectDefinitions::GetCppType(const FName& OriginalType, const UA
         return bForProperty ? (*predefType)->CppPropertyType : (*predefType)->CppType;
 
     //not a predefined type, look up in imported Types
+    if (const FString* cached = FindCachedCppType(OriginalType, bForProperty))
+        return *cached;
+
     auto type = Types.Find(OriginalType);
     if (ensureMsgf(type, TEXT("Type %s was not found in PredefinedTypes or imported Types!"), *OriginalType.ToString()))
         return type->GetCppType(Data, bForProperty);
@@ -891,6 +992,69 @@ FString FArticyObjectDefinitions::GetCppType(const FName& OriginalType, const UA
     return FString::Printf(TEXT("%s_NOT_FOUND"), *OriginalType.ToString());
 }
 
+/**
+ * Resolves the C++ types of all object definitions and features once, before the code or the assets are generated.
+ * The types are formatted from the project name and the type names, so they stay the same until the definitions change.
+ *
+ * @param Data A pointer to the UArticyImportData object.
+ */
+void FArticyObjectDefinitions::BeginCppTypeCache(const UArticyImportData* Data) const
+{
+    EndCppTypeCache();
+
+    CachedCppTypes.Reserve(Types.Num());
+    for (const auto& pair : Types)
+        CachedCppTypes.Add(pair.Key, { pair.Value.GetCppType(Data, false), pair.Value.GetCppType(Data, true) });
+
+    CachedFeatureCppTypes.Reserve(FeatureDefs.Num());
+    for (const auto& pair : FeatureDefs)
+        CachedFeatureCppTypes.Add(pair.Value.GetTechnicalName(), { pair.Value.GetCppType(Data, false), pair.Value.GetCppType(Data, true) });
+
+    bCppTypesCached = true;
+}
+
+/**
+ * Clears the C++ types resolved by BeginCppTypeCache.
+ */
+void FArticyObjectDefinitions::EndCppTypeCache() const
+{
+    bCppTypesCached = false;
+    CachedCppTypes.Reset();
+    CachedFeatureCppTypes.Reset();
+}
+
+/**
+ * Returns the C++ type of an object definition resolved by BeginCppTypeCache.
+ *
+ * @param OriginalType The original type of the object definition.
+ * @param bForProperty Whether the type is for a property.
+ * @return The C++ type, nullptr if it is not cached.
+ */
+const FString* FArticyObjectDefinitions::FindCachedCppType(const FName& OriginalType, const bool bForProperty) const
+{
+    if (!bCppTypesCached)
+        return nullptr;
+
+    const auto* cached = CachedCppTypes.Find(OriginalType);
+    return cached ? (bForProperty ? &cached->Value : &cached->Key) : nullptr;
+}
+
+/**
+ * Returns the C++ type of a feature resolved by BeginCppTypeCache.
+ *
+ * @param TechnicalName The technical name of the feature.
+ * @param bAsVariable Whether the type is for a variable.
+ * @return The C++ type, nullptr if it is not cached.
+ */
+const FString* FArticyObjectDefinitions::FindCachedFeatureCppType(const FString& TechnicalName, const bool bAsVariable) const
+{
+    if (!bCppTypesCached)
+        return nullptr;
+
+    const auto* cached = CachedFeatureCppTypes.Find(TechnicalName);
+    return cached ? (bAsVariable ? &cached->Value : &cached->Key) : nullptr;
+}
+
 /**
  * Returns the default base class for an object definition.
  *
@@ -900,9 +1064,10 @@ FString FArticyObjectDefinitions::GetCppType(const FName& OriginalType, const UA
  */
 const FArticyObjectDefinitions::FClassInfo& FArticyObjectDefinitions::GetDefaultBaseClass(const FName& OriginalType, const UArticyImportData* Data)
 {
-    static TMap<FName, FClassInfo> DefaultBaseClasses;
-    if (DefaultBaseClasses.Num() == 0)
+    // Initialized once, as the code generators call this concurrently
+    static const TMap<FName, FClassInfo> DefaultBaseClasses = []
     {
+        TMap<FName, FClassInfo> DefaultBaseClasses;
         DefaultBaseClasses.Add("Asset", FClassInfo{ "UArticyAsset", UArticyAsset::StaticClass() });
         DefaultBaseClasses.Add("Condition", FClassInfo{ "UArticyCondition", UArticyCondition::StaticClass() });
         DefaultBaseClasses.Add("Comment", FClassInfo{ "UArticyComment", UArticyComment::StaticClass() });
@@ -923,7 +1088,8 @@ const FArticyObjectDefinitions::FClassInfo& FArticyObjectDefinitions::GetDefault
         DefaultBaseClasses.Add("TextObject", FClassInfo{ "UArticyTextObject", UArticyTextObject::StaticClass() });
         DefaultBaseClasses.Add("UserFolder", FClassInfo{ "UArticyUserFolder", UArticyUserFolder::StaticClass() });
         DefaultBaseClasses.Add("Zone", FClassInfo{ "UArticyZone", UArticyZone::StaticClass() });
-    }
+        return DefaultBaseClasses;
+    }();
 
     auto base = DefaultBaseClasses.Find(OriginalType);
     if (base)
@@ -942,9 +1108,10 @@ const FArticyObjectDefinitions::FClassInfo& FArticyObjectDefinitions::GetDefault
  */
 const FName& FArticyObjectDefinitions::GetProviderInterface(const FArticyPropertyDef& Property)
 {
-    static TMap<FName, FName> ProviderInterfaces;
-    if (ProviderInterfaces.Num() == 0)
+    // Initialized once, as the code generators call this concurrently
+    static const TMap<FName, FName> ProviderInterfaces = []
     {
+        TMap<FName, FName> ProviderInterfaces;
 #define OBJECT_WITH_X(x) TEXT(x), TEXT("IArticyObjectWith" x)
 
         ProviderInterfaces.Add(OBJECT_WITH_X("Attachments"));
@@ -963,7 +1130,10 @@ const FName& FArticyObjectDefinitions::GetProviderInterface(const FArticyPropert
         ProviderInterfaces.Add(OBJECT_WITH_X("Transform"));
         ProviderInterfaces.Add(OBJECT_WITH_X("Vertices"));
         ProviderInterfaces.Add(OBJECT_WITH_X("ZIndex"));
-    }
+
+#undef OBJECT_WITH_X
+        return ProviderInterfaces;
+    }();
 
     auto i = ProviderInterfaces.Find(Property.GetPropetyName());
     if (i)
@@ -999,9 +1169,7 @@ const FString& FArticyObjectDefinitions::GetCppDefaultValue(const FName& Origina
  */
 void FArticyObjectDefinitions::SetProp(const FName& OriginalType, const FName& Property, PROP_SETTER_PARAMS)
 {
-    auto typePtr = FArticyPredefTypes::Get().Find(OriginalType);
-    //if it's not a predefined type, it must be an enum - or an error ;)
-    auto type = typePtr ? *typePtr : FArticyPredefTypes::GetEnum();
+    auto type = GetSetterType(OriginalType);
 
     if (ensure(type))
     {
@@ -1014,15 +1182,34 @@ void FArticyObjectDefinitions::SetProp(const FName& OriginalType, const FName& P
 }
 
 /**
- * Checks if a feature type is new.
+ * Returns the type which converts the JSON values of a property type.
  *
- * @param CppType The C++ type of the feature.
- * @return True if the feature type is new, false otherwise.
+ * @param OriginalType The original type of the property.
+ * @return The predefined type, or the enum type for all other types.
  */
-bool FArticyObjectDefinitions::IsNewFeatureType(const FName& CppType) const
+FArticyPredefinedTypeBase* FArticyObjectDefinitions::GetSetterType(const FName& OriginalType)
 {
-    bool bAlreadyPresent;
-    FeatureTypes.Add(CppType, &bAlreadyPresent);
+    auto typePtr = FArticyPredefTypes::Get().Find(OriginalType);
+    //if it's not a predefined type, it must be an enum - or an error ;)
+    return typePtr ? *typePtr : FArticyPredefTypes::GetEnum();
+}
 
-    return !bAlreadyPresent;
+/**
+ * Adds the imported type (and item type) of a property to the dependencies of the generated code declaring it.
+ * Enums have to be included, models and templates are only referenced by pointer and declared.
+ *
+ * @param Property The property definition.
+ * @param OutIncludes Receives the types whose headers have to be included.
+ * @param OutDeclarations Receives the types which only need a forward declaration.
+ */
+void FArticyObjectDefinitions::GatherPropertyDependencies(const FArticyPropertyDef& Property, TSet<FName>& OutIncludes, TSet<FName>& OutDeclarations) const
+{
+    for (const FName& type : { Property.GetOriginalType(), Property.GetOriginalItemType() })
+    {
+        if (type.IsNone() || FArticyPredefTypes::IsPredefinedType(type))
+            continue;
+
+        if (const FArticyObjectDef* def = Types.Find(type))
+            (def->IsEnum() ? OutIncludes : OutDeclarations).Add(type);
+    }
 }
@@ -13,14 +13,93 @@
 #include "Serialization/JsonWriter.h"
 #include "Misc/Paths.h"
 #include "Misc/App.h"
+#include "Misc/Compression.h"
+#include "HAL/PlatformTime.h"
+#include "Async/ParallelFor.h"
 #include "UObject/ConstructorHelpers.h"
 #include <string>
 
 #include "ArticyArchiveReader.h"
+#include "ArticyJsonScanner.h"
 #include "ArticyPluginSettings.h"
 
 #define STRINGIFY(x) #x
 
+/**
+ * Sets the JSON text, uncompressed until Compress is called.
+ *
+ * @param InUtf8 The condensed UTF-8 JSON text.
+ */
+void FArticyJsonPayload::Set(TArray<uint8>&& InUtf8)
+{
+	Data = MoveTemp(InUtf8);
+	Size = Data.Num();
+}
+
+/**
+ * Sets the JSON text from a string.
+ *
+ * @param Json The condensed JSON text.
+ */
+void FArticyJsonPayload::Set(const FString& Json)
+{
+	const FTCHARToUTF8 Converted(*Json, Json.Len());
+	TArray<uint8> Utf8(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length());
+	Set(MoveTemp(Utf8));
+}
+
+/**
+ * Compresses the text with zlib, if that makes it smaller. Short texts are kept as they are.
+ */
+void FArticyJsonPayload::Compress()
+{
+	constexpr int32 MinCompressedSize = 256;
+	if (Data.Num() != Size || Size < MinCompressedSize)
+		return;
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Size);
+	TArray<uint8> Compressed;
+	Compressed.SetNumUninitialized(CompressedSize);
+	if (FCompression::CompressMemory(NAME_Zlib, Compressed.GetData(), CompressedSize, Data.GetData(), Size) && CompressedSize < Size)
+	{
+		Compressed.SetNum(CompressedSize);
+		Data = MoveTemp(Compressed);
+	}
+}
+
+/**
+ * Parses the JSON text, decompressing it first if needed.
+ *
+ * @return The JSON object, nullptr if there is no text or it is not a JSON object.
+ */
+TSharedPtr<FJsonObject> FArticyJsonPayload::Parse() const
+{
+	if (Size == 0)
+		return nullptr;
+
+	TArray<uint8> Uncompressed;
+	const uint8* Utf8 = Data.GetData();
+	if (Data.Num() != Size)
+	{
+		Uncompressed.SetNumUninitialized(Size);
+		if (!FCompression::UncompressMemory(NAME_Zlib, Uncompressed.GetData(), Size, Data.GetData(), Data.Num()))
+		{
+			UE_LOG(LogArticyEditor, Error, TEXT("Could not decompress the JSON of a model definition."));
+			return nullptr;
+		}
+		Utf8 = Uncompressed.GetData();
+	}
+
+	const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Utf8), Size);
+	TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(FString(Converted.Length(), Converted.Get()));
+
+	TSharedPtr<FJsonObject> Json;
+	FJsonSerializer::Deserialize(JsonReader, Json);
+	return Json;
+}
+
+//---------------------------------------------------------------------------//
+
 /**
  * Imports model definition data from a JSON object.
  *
@@ -35,8 +114,11 @@ void FArticyModelDef::ImportFromJson(const TSharedPtr<FJsonObject> JsonModel)
 	JSON_TRY_STRING(JsonModel, Category);
 	this->AssetCategory = GetAssetCategoryFromString(Category);
 
+	PropertiesJsonString.Empty();
+	TemplateJsonString.Empty();
+
 	{
-		PropertiesJsonString = "";
+		PropertiesPayload.Reset();
 		TSharedPtr<FJsonObject> Properties = JsonModel->GetObjectField(TEXT("Properties"));
 		if (Properties.IsValid())
 		{
@@ -44,25 +126,129 @@ void FArticyModelDef::ImportFromJson(const TSharedPtr<FJsonObject> JsonModel)
 			JSON_TRY_HEX_ID(Properties, Id);
 			JSON_TRY_HEX_ID(Properties, Parent);
 
+			const TSharedPtr<FJsonValue> PositionJson = Properties->TryGetField(TEXT("Position"));
+			bHasPosition = PositionJson.IsValid() && PositionJson->Type == EJson::Object;
+			Position = bHasPosition ? ArticyHelpers::ParseFVector2DFromJson(PositionJson) : FVector2D::ZeroVector;
+
 			FString stringId;
 			Properties->TryGetStringField(TEXT("Id"), stringId);
 			NameAndId = FString::Printf(TEXT("%s_%s"), *TechnicalName, *stringId);
 
 			// Serialize the Properties to string, using the condensed writer to save memory
-			TSharedRef< TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>> > Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&PropertiesJsonString);
+			FString Json;
+			TSharedRef< TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>> > Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Json);
 			FJsonSerializer::Serialize(Properties.ToSharedRef(), Writer);
+			PropertiesPayload.Set(Json);
 		}
 	}
 
 	{
-		TemplateJsonString = "";
+		TemplatePayload.Reset();
 		const TSharedPtr<FJsonObject>* Template;
 		if (JsonModel->TryGetObjectField(TEXT("Template"), Template))
 		{
-			TSharedRef< TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>> > Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&TemplateJsonString);
+			FString Json;
+			TSharedRef< TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>> > Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Json);
 			FJsonSerializer::Serialize(Template->ToSharedRef(), Writer);
+			TemplatePayload.Set(Json);
+		}
+	}
+
+	ReleaseJson();
+}
+
+/**
+ * Imports model definition data straight from the JSON text, without building a DOM.
+ *
+ * @param Scanner The scanner, positioned at the JSON object of the model definition.
+ * @return True if the model definition was read; otherwise, false.
+ */
+bool FArticyModelDef::ImportFromJson(FArticyJsonScanner& Scanner)
+{
+	PropertiesPayload.Reset();
+	TemplatePayload.Reset();
+	PropertiesJsonString.Empty();
+	TemplateJsonString.Empty();
+
+	if (!Scanner.BeginObject())
+		return false;
+
+	FString Key;
+	FString Value;
+	FString Category;
+	while (Scanner.NextMember(Key))
+	{
+		if (Key == TEXT("Type"))
+		{
+			if (Scanner.ReadString(Value))
+				Type = *Value;
+		}
+		else if (Key == TEXT("AssetRef"))
+		{
+			Scanner.ReadString(AssetRef);
+		}
+		else if (Key == TEXT("Category"))
+		{
+			Scanner.ReadString(Category);
+		}
+		else if (Key == TEXT("Properties") && Scanner.IsObjectNext())
+		{
+			// Pick the fields needed right away while scanning, and keep the whole object as text
+			const int32 Begin = Scanner.GetPosition();
+			Scanner.BeginObject();
+
+			FString stringId;
+			FString stringParent;
+			bHasPosition = false;
+			Position = FVector2D::ZeroVector;
+			while (Scanner.NextMember(Key))
+			{
+				if (Key == TEXT("TechnicalName"))
+					Scanner.ReadString(TechnicalName);
+				else if (Key == TEXT("Id"))
+					Scanner.ReadString(stringId);
+				else if (Key == TEXT("Parent"))
+					Scanner.ReadString(stringParent);
+				else if (Key == TEXT("Position") && Scanner.IsObjectNext())
+				{
+					// Kept as the sort key of the children of the parent
+					Scanner.BeginObject();
+					while (Scanner.NextMember(Key))
+					{
+						if (Key == TEXT("x") && Scanner.ReadString(Value))
+							Position.X = FCString::Atod(*Value);
+						else if (Key == TEXT("y") && Scanner.ReadString(Value))
+							Position.Y = FCString::Atod(*Value);
+						else
+							Scanner.SkipValue();
+					}
+					bHasPosition = true;
+				}
+				else
+					Scanner.SkipValue();
+			}
+
+			Id = ArticyHelpers::HexToUint64(stringId);
+			Parent = ArticyHelpers::HexToUint64(stringParent);
+			NameAndId = FString::Printf(TEXT("%s_%s"), *TechnicalName, *stringId);
+			PropertiesPayload.Set(Scanner.GetCondensedUTF8(Begin, Scanner.GetPosition()));
+		}
+		else if (Key == TEXT("Template") && Scanner.IsObjectNext())
+		{
+			TArray<uint8> Template;
+			if (Scanner.ReadRawValue(Template))
+				TemplatePayload.Set(MoveTemp(Template));
+		}
+		else
+		{
+			Scanner.SkipValue();
 		}
 	}
+
+	this->AssetCategory = GetAssetCategoryFromString(Category);
+	ReleaseJson();
+
+	return !Scanner.HasError();
 }
 
 /**
@@ -104,13 +290,16 @@ UArticyObject* FArticyModelDef::GenerateSubAsset(const UArticyImportData* Data,
 			obj->MarkPackageDirty();
 		}
 
+		// The parsed properties are only needed to initialize the asset
+		ReleaseJson();
+
 		return obj;
 	}
 	return nullptr;
 }
 
 /**
- * Gets the properties JSON object from the cached properties JSON string.
+ * Gets the properties JSON object, parsed from the payload on first use until ReleaseJson is called.
  *
  * @return A shared pointer to the properties JSON object.
  */
@@ -118,8 +307,15 @@ TSharedPtr<FJsonObject> FArticyModelDef::GetPropertiesJson() const
 {
 	if (!CachedPropertiesJson.IsValid())
 	{
-		TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(PropertiesJsonString);
-		FJsonSerializer::Deserialize(JsonReader, CachedPropertiesJson);
+		if (PropertiesPayload.IsEmpty() && !PropertiesJsonString.IsEmpty())
+		{
+			TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(PropertiesJsonString);
+			FJsonSerializer::Deserialize(JsonReader, CachedPropertiesJson);
+		}
+		else
+		{
+			CachedPropertiesJson = PropertiesPayload.Parse();
+		}
 
 		if (!CachedPropertiesJson.IsValid())
 			CachedPropertiesJson = MakeShareable(new FJsonObject);
@@ -129,7 +325,7 @@ TSharedPtr<FJsonObject> FArticyModelDef::GetPropertiesJson() const
 }
 
 /**
- * Gets the templates JSON object from the cached templates JSON string.
+ * Gets the templates JSON object, parsed from the payload on first use until ReleaseJson is called.
  *
  * @return A shared pointer to the templates JSON object.
  */
@@ -137,8 +333,15 @@ TSharedPtr<FJsonObject> FArticyModelDef::GetTemplatesJson() const
 {
 	if (!CachedTemplateJson.IsValid())
 	{
-		TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(TemplateJsonString);
-		FJsonSerializer::Deserialize(JsonReader, CachedTemplateJson);
+		if (TemplatePayload.IsEmpty() && !TemplateJsonString.IsEmpty())
+		{
+			TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(TemplateJsonString);
+			FJsonSerializer::Deserialize(JsonReader, CachedTemplateJson);
+		}
+		else
+		{
+			CachedTemplateJson = TemplatePayload.Parse();
+		}
 
 		if (!CachedTemplateJson.IsValid())
 			CachedTemplateJson = MakeShareable(new FJsonObject);
@@ -147,6 +350,43 @@ TSharedPtr<FJsonObject> FArticyModelDef::GetTemplatesJson() const
 	return CachedTemplateJson;
 }
 
+/**
+ * Parses the properties and templates JSON ahead of GenerateSubAsset.
+ * Only touches this model definition, so different models can be parsed on different threads.
+ */
+void FArticyModelDef::ParseJson() const
+{
+	GetPropertiesJson();
+	GetTemplatesJson();
+}
+
+/**
+ * Releases the parsed properties and templates JSON, the payloads are parsed again when needed.
+ */
+void FArticyModelDef::ReleaseJson() const
+{
+	CachedPropertiesJson.Reset();
+	CachedTemplateJson.Reset();
+}
+
+/**
+ * Compresses the payloads of the properties and templates.
+ * Only touches this model definition, so different models can be compressed on different threads.
+ */
+void FArticyModelDef::CompressPayloads()
+{
+	// Import data of previous versions kept the JSON as strings
+	if (PropertiesPayload.IsEmpty() && !PropertiesJsonString.IsEmpty())
+		PropertiesPayload.Set(PropertiesJsonString);
+	if (TemplatePayload.IsEmpty() && !TemplateJsonString.IsEmpty())
+		TemplatePayload.Set(TemplateJsonString);
+	PropertiesJsonString.Empty();
+	TemplateJsonString.Empty();
+
+	PropertiesPayload.Compress();
+	TemplatePayload.Compress();
+}
+
 /**
  * Converts a category string to an EArticyAssetCategory enum value.
  *
@@ -190,26 +430,56 @@ void FArticyPackageDef::ImportFromJson(const UArticyArchiveReader& Archive, cons
 
 	TSharedPtr<FJsonObject> Files;
 	JSON_TRY_OBJECT(JsonPackage, Files, {
-		TSharedPtr<FJsonObject> Objects;
-		if (!Archive.FetchJson(
+		// The objects file is by far the largest one, so it is scanned as it is instead of building a DOM of it
+		TArray<uint8> ObjectsStorage;
+		TArrayView<const uint8> Objects;
+		if (!Archive.FetchBytes(
 			*obj,
 			JSON_SUBSECTION_OBJECTS,
 			PackageObjectsHash,
+			ObjectsStorage,
 			Objects))
 		{
 			return;
 		}
 
 		Models.Reset();
-		JSON_TRY_ARRAY(Objects, Objects,
+		FArticyJsonScanner Scanner(Objects);
+		FString Key;
+		if (Scanner.BeginObject())
 		{
-			auto innerObj = item->AsObject();
-			if (innerObj.IsValid())
+			while (Scanner.NextMember(Key))
 			{
-				FArticyModelDef model;
-				model.ImportFromJson(innerObj);
-				Models.Add(model);
+				if (Key != TEXT("Objects") || !Scanner.BeginArray())
+				{
+					Scanner.SkipValue();
+					continue;
+				}
+
+				while (Scanner.NextElement())
+				{
+					if (!Scanner.IsObjectNext())
+					{
+						Scanner.SkipValue();
+						continue;
+					}
+
+					FArticyModelDef model;
+					if (model.ImportFromJson(Scanner))
+						Models.Add(MoveTemp(model));
+				}
 			}
+		}
+
+		if (Scanner.HasError())
+		{
+			UE_LOG(LogArticyEditor, Error, TEXT("Failed to parse the objects of package '%s'"), *Name);
+		}
+
+		// The payloads are only parsed again for the scripts and the assets, one model at a time
+		ParallelFor(Models.Num(), [this](int32 Index)
+		{
+			Models[Index].CompressPayloads();
 		});
 
 		TSharedPtr<FJsonObject> TextData;
@@ -235,7 +505,10 @@ void FArticyPackageDef::ImportFromJson(const UArticyArchiveReader& Archive, cons
 void FArticyPackageDef::GatherScripts(UArticyImportData* Data) const
 {
 	for (const auto& model : Models)
+	{
 		Data->GetObjectDefs().GatherScripts(model, Data);
+		model.ReleaseJson();
+	}
 }
 
 /**
@@ -266,20 +539,35 @@ UArticyPackage* FArticyPackageDef::GeneratePackageAsset(UArticyImportData* Data)
 	ArticyPackage->Name = Name;
 	ArticyPackage->Description = Description;
 	ArticyPackage->bIsDefaultPackage = IsDefaultPackage;
+	ArticyPackage->ChunkId = UArticyPluginSettings::Get()->GetPackageChunkId(Name);
 
-	// Create all contained subassets and register them in the package
-	for (const auto& model : Models)
+	// Create all contained subassets and register them in the package.
+	// The JSON of the models is parsed on worker threads, in batches to bound the memory of the parsed objects;
+	// creating and initializing the objects has to stay on the game thread.
+	constexpr int32 ParseBatchSize = 1024;
+	for (int32 BatchStart = 0; BatchStart < Models.Num(); BatchStart += ParseBatchSize)
 	{
-		UArticyObject* asset = model.GenerateSubAsset(Data, ArticyPackage); //MM_CHANGE
+		const int32 BatchEnd = FMath::Min(BatchStart + ParseBatchSize, Models.Num());
+		ParallelFor(BatchEnd - BatchStart, [&](int32 Index)
+		{
+			Models[BatchStart + Index].ParseJson();
+		});
 
-		if (asset)
+		for (int32 Index = BatchStart; Index < BatchEnd; ++Index)
 		{
-			FString id = ArticyHelpers::Uint64ToHex(asset->GetId());
-			ArticyPackage->AddAsset(asset);
-			Data->AddChildToParentCache(model.GetParent(), model.GetId());
+			const auto& model = Models[Index];
+			UArticyObject* asset = model.GenerateSubAsset(Data, ArticyPackage); //MM_CHANGE
+
+			if (asset)
+			{
+				ArticyPackage->AddAsset(asset);
+				Data->AddChildToParentCache(model.GetParent(), model.GetId());
+			}
 		}
 	}
 
+	ArticyPackage->BuildNameIndex();
+
 	FAssetRegistryModule::AssetCreated(ArticyPackage);
 
 	AssetPackage->MarkPackageDirty();
@@ -287,6 +575,93 @@ UArticyPackage* FArticyPackageDef::GeneratePackageAsset(UArticyImportData* Data)
 	return ArticyPackage;
 }
 
+/**
+ * Loads the previously generated package asset, without regenerating it.
+ *
+ * @return A pointer to the existing UArticyPackage asset, or nullptr if there is none.
+ */
+UArticyPackage* FArticyPackageDef::FindPackageAsset() const
+{
+	const FString PackageName = GetFolder();
+	const FString PackagePath = ArticyHelpers::GetArticyGeneratedFolder() / PackageName;
+	const FString AssetName = FPaths::GetBaseFilename(PackageName);
+
+	return LoadObject<UArticyPackage>(nullptr, *FString::Printf(TEXT("%s.%s"), *PackagePath, *AssetName), nullptr, LOAD_NoWarn);
+}
+
+/**
+ * Adds the objects of the package to the parent-children cache of the ArticyImportData, like GeneratePackageAsset does.
+ *
+ * @param Data A pointer to the UArticyImportData object.
+ */
+void FArticyPackageDef::AddToParentCache(UArticyImportData* Data) const
+{
+	for (const auto& model : Models)
+	{
+		Data->AddChildToParentCache(model.GetParent(), model.GetId());
+	}
+}
+
+/**
+ * Adds the positions of the objects of the package to a map, for the objects which have one.
+ *
+ * @param OutPositions The map of object positions by ID.
+ */
+void FArticyPackageDef::GatherPositions(TMap<FArticyId, FVector2D>& OutPositions) const
+{
+	FVector2D Position;
+	for (const auto& model : Models)
+	{
+		if (model.GetPosition(Position))
+		{
+			OutPositions.Add(model.GetId(), Position);
+		}
+	}
+}
+
+/**
+ * Adds the ids of the objects of the package to a map by technical name.
+ * Names which more than one object has are mapped to a null id, as they can't be resolved to a single object.
+ *
+ * @param OutObjectIds The map of object ids by technical name.
+ */
+void FArticyPackageDef::GatherObjectIds(TMap<FName, FArticyId>& OutObjectIds) const
+{
+	for (const auto& model : Models)
+	{
+		if (model.GetTechnicalName().IsEmpty())
+			continue;
+
+		const FName Name = *model.GetTechnicalName();
+		if (FArticyId* Existing = OutObjectIds.Find(Name))
+		{
+			if (*Existing != model.GetId())
+				*Existing = FArticyId();
+		}
+		else
+		{
+			OutObjectIds.Add(Name, model.GetId());
+		}
+	}
+}
+
+/**
+ * Adds the asset references of the audio assets of the package to a map, the .wav and .ogg files ImportAudioAssets imports.
+ *
+ * @param OutAssetRefs The map of asset references by ID.
+ */
+void FArticyPackageDef::GatherAudioAssetRefs(TMap<FArticyId, FString>& OutAssetRefs) const
+{
+	for (const auto& model : Models)
+	{
+		const FString Extension = FPaths::GetExtension(model.GetAssetRef());
+		if (Extension.Equals(TEXT("wav"), ESearchCase::IgnoreCase) || Extension.Equals(TEXT("ogg"), ESearchCase::IgnoreCase))
+		{
+			OutAssetRefs.Add(model.GetId(), model.GetAssetRef());
+		}
+	}
+}
+
 /**
  * Gets the folder path for the package.
  *
@@ -383,104 +758,128 @@ bool FArticyPackageDef::GetIsIncluded() const
  * @param Archive A reference to the ArticyArchiveReader object.
  * @param Json A pointer to the JSON array containing the package definitions.
  * @param Settings A reference to the FADISettings object.
+ * @param Journal If set, receives the packages the import replaces or removes, moved out instead of copied. Packages
+ * the import keeps in place are only recorded with their previous name and state.
  */
 void FArticyPackageDefs::ImportFromJson(
 	const UArticyArchiveReader& Archive,
 	const TArray<TSharedPtr<FJsonValue>>* Json,
-	FAdiSettings& Settings)
+	FAdiSettings& Settings,
+	FArticyPackageDefs* Journal)
 {
 	if (!Json)
 		return;
 
-	TSet<FString> OldPackageScriptHashes;
-	TArray<FArticyPackageDef> PackagesToRemove;
+	// Parse every package of the new package list once, the objects and texts files are the expensive part
+	const double ParseStartTime = FPlatformTime::Seconds();
 
-	// Iterate over existing packages
-	for (auto& ExistingPackage : Packages)
+	TArray<FArticyPackageDef> NewPackages;
+	TMap<FArticyId, int32> NewPackageIndices;
+	NewPackages.Reserve(Json->Num());
+	for (const auto& pack : *Json)
 	{
-		OldPackageScriptHashes.Add(ExistingPackage.GetScriptFragmentHash());
-
-		bool bExistingPackageFound = false;
-
-		// Iterate over new package list
-		for (const auto& pack : *Json)
-		{
-			const auto& obj = pack->AsObject();
-			if (!obj.IsValid())
-				continue;
-
-			FArticyPackageDef package;
-			package.ImportFromJson(Archive, obj);
-
-			// If package with the same Id is found
-			if (ExistingPackage.GetId() == package.GetId())
-			{
-				bExistingPackageFound = true;
-
-				const FString& OldName = ExistingPackage.GetName();
-				const FString& NewName = package.GetName();
-
-				// If IsIncluded is set on the new package, replace the existing package
-				if (package.GetIsIncluded())
-				{
-					ExistingPackage = package;
+		const auto& obj = pack->AsObject();
+		if (!obj.IsValid())
+			continue;
 
-					// Useful if we ever decide to rename included packages 
-					ExistingPackage.SetName(OldName);
-				}
+		const double PackageStartTime = FPlatformTime::Seconds();
 
-				if (!NewName.Equals(OldName))
-				{
-					// Name has changed
-					ExistingPackage.SetName(NewName);
-				}
+		FArticyPackageDef package;
+		package.ImportFromJson(Archive, obj);
 
-				break;
-			}
-		}
+		UE_LOG(LogArticyEditor, Verbose, TEXT("Parsed package '%s' in %.1f ms"), *package.GetName(), (FPlatformTime::Seconds() - PackageStartTime) * 1000.0);
 
-		// If existing package was not found in the new package list, mark it for removal
-		if (!bExistingPackageFound)
+		// The first package with an Id wins, like with the previous lookups
+		if (!NewPackageIndices.Contains(package.GetId()))
 		{
-			PackagesToRemove.Add(ExistingPackage);
+			NewPackageIndices.Add(package.GetId(), NewPackages.Num());
+			NewPackages.Add(MoveTemp(package));
 		}
 	}
 
-	// Remove packages that don't exist in the new package list
-	for (const auto& PackageToRemove : PackagesToRemove)
+	const double ReconcileStartTime = FPlatformTime::Seconds();
+
+	TSet<FString> OldPackageScriptHashes;
+	TSet<FArticyId> ExistingPackageIds;
+
+	// The journal holds the previous packages in their order
+	if (Journal)
 	{
-		Packages.RemoveSingle(PackageToRemove);
+		Journal->Packages.Reset(Packages.Num());
+		Journal->KeptPackages.Reset();
 	}
 
-	// Iterate over new package list
-	for (const auto& pack : *Json)
+	// Update existing packages from the new package list, and remove the ones which are not in it anymore
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
 	{
-		const auto& obj = pack->AsObject();
-		if (!obj.IsValid())
+		auto& ExistingPackage = Packages[Index];
+		OldPackageScriptHashes.Add(ExistingPackage.GetScriptFragmentHash());
+
+		const int32* NewIndex = NewPackageIndices.Find(ExistingPackage.GetId());
+		if (!NewIndex)
+		{
+			if (Journal)
+				Journal->Packages.Add(MoveTemp(ExistingPackage));
+			Packages.RemoveAt(Index--);
 			continue;
+		}
 
-		FArticyPackageDef package;
-		package.ImportFromJson(Archive, obj);
+		ExistingPackageIds.Add(ExistingPackage.GetId());
 
-		bool bExistingPackageFound = false;
+		// Each new package replaces at most one existing package, the others are added below
+		FArticyPackageDef& package = NewPackages[*NewIndex];
+		const FString OldName = ExistingPackage.GetName();
+		const FString NewName = package.GetName();
 
-		// Check if package already exists in the Packages array
-		for (const auto& ExistingPackage : Packages)
+		// If IsIncluded is set on the new package, replace the existing package
+		if (package.GetIsIncluded())
+		{
+			const bool bContentChanged = !ExistingPackage.HasSameContent(package);
+			if (Journal)
+				Journal->Packages.Add(MoveTemp(ExistingPackage));
+			ExistingPackage = MoveTemp(package);
+			ExistingPackage.SetAssetsChanged(bContentChanged);
+
+			// Useful if we ever decide to rename included packages 
+			ExistingPackage.SetName(OldName);
+		}
+		else
 		{
-			if (ExistingPackage.GetId() == package.GetId())
+			if (Journal)
 			{
-				bExistingPackageFound = true;
-				break;
+				Journal->KeptPackages.Add(Journal->Packages.Num(), { ExistingPackage.Name, ExistingPackage.PreviousName, ExistingPackage.bAssetsChanged });
+				Journal->Packages.AddDefaulted_GetRef().Id = ExistingPackage.GetId();
 			}
+
+			// Packages without data keep their assets
+			ExistingPackage.SetAssetsChanged(false);
+
+			// and their models, which may still be in the format of a previous version
+			for (FArticyModelDef& model : ExistingPackage.Models)
+				model.CompressPayloads();
 		}
 
-		// If package doesn't exist, add it to the Packages array
-		if (!bExistingPackageFound)
+		if (!NewName.Equals(OldName))
 		{
-			Packages.Add(package);
+			// Name has changed
+			ExistingPackage.SetName(NewName);
+			ExistingPackage.SetAssetsChanged(true);
 		}
 	}
 
+	// Add the packages which don't exist yet, in the order of the new package list
+	for (FArticyPackageDef& package : NewPackages)
+	{
+		if (!ExistingPackageIds.Contains(package.GetId()))
+		{
+			Packages.Add(MoveTemp(package));
+		}
+	}
+
+	const double EndTime = FPlatformTime::Seconds();
+	UE_LOG(LogArticyEditor, Log, TEXT("Imported %d packages: parsing %.1f ms, reconciling %.1f ms"),
+		NewPackages.Num(), (ReconcileStartTime - ParseStartTime) * 1000.0, (EndTime - ReconcileStartTime) * 1000.0);
+
 	// Check if set of hashes are the same
 	if (OldPackageScriptHashes.Num() == Packages.Num())
 	{
@@ -506,91 +905,113 @@ void FArticyPackageDefs::ImportFromJson(
 }
 
 /**
- * Validates the import of package definitions from a JSON array.
+ * Undoes an import which recorded a journal, see ImportFromJson.
+ * The replaced and removed packages are moved back from the journal, the kept ones get their previous name and state,
+ * and the added ones are removed, so the packages are in their previous order again.
+ *
+ * @param Journal The journal of the import, empty afterwards.
+ */
+void FArticyPackageDefs::Rollback(FArticyPackageDefs& Journal)
+{
+	TMap<FArticyId, int32> CurrentIndices;
+	CurrentIndices.Reserve(Packages.Num());
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
+		CurrentIndices.Add(Packages[Index].GetId(), Index);
+
+	TArray<FArticyPackageDef> Restored;
+	Restored.Reserve(Journal.Packages.Num());
+	for (int32 Index = 0; Index < Journal.Packages.Num(); ++Index)
+	{
+		const FKeptPackage* Kept = Journal.KeptPackages.Find(Index);
+		if (!Kept)
+		{
+			Restored.Add(MoveTemp(Journal.Packages[Index]));
+			continue;
+		}
+
+		const int32* Current = CurrentIndices.Find(Journal.Packages[Index].GetId());
+		if (!ensure(Current))
+			continue;
+
+		FArticyPackageDef& Package = Restored.Add_GetRef(MoveTemp(Packages[*Current]));
+		Package.Name = Kept->Name;
+		Package.PreviousName = Kept->PreviousName;
+		Package.bAssetsChanged = Kept->bAssetsChanged;
+	}
+
+	Packages = MoveTemp(Restored);
+	Journal.Packages.Reset();
+	Journal.KeptPackages.Reset();
+}
+
+/**
+ * Validates the import of package definitions from the package list of the manifest.
+ * Only the ids and the IsIncluded flags of the list are read, the files of the packages are neither fetched nor parsed.
  *
- * @param Archive A reference to the ArticyArchiveReader object.
  * @param Json A pointer to the JSON array containing the package definitions.
  * @return True if the import is valid, false otherwise.
  */
-bool FArticyPackageDefs::ValidateImport(
-	const UArticyArchiveReader& Archive,
-	const TArray<TSharedPtr<FJsonValue>>* Json)
+bool FArticyPackageDefs::ValidateImport(const TArray<TSharedPtr<FJsonValue>>* Json) const
 {
 	if (!Json)
 		return false;
 
-	// Iterate over existing packages
-	for (auto& ExistingPackage : Packages)
+	// The packages of the manifest, and the first of them for each id
+	struct FManifestPackage
 	{
-		// Old package has data
-		if (ExistingPackage.GetIsIncluded())
+		FArticyId Id;
+		bool IsIncluded = false;
+		FString Name;
+	};
+	TArray<FManifestPackage> ManifestPackages;
+	ManifestPackages.Reserve(Json->Num());
+	TMap<FArticyId, int32> ManifestIndices;
+	ManifestIndices.Reserve(Json->Num());
+	for (const auto& pack : *Json)
+	{
+		const auto& obj = pack->AsObject();
+		if (!obj.IsValid())
 			continue;
 
-		bool bPackageDataFound = false;
-
-		// Iterate over new package list
-		for (const auto& pack : *Json)
-		{
-			const auto& obj = pack->AsObject();
-			if (!obj.IsValid())
-				continue;
-
-			FArticyPackageDef package;
-			package.ImportFromJson(Archive, obj);
+		FArticyId Id;
+		bool IsIncluded = false;
+		JSON_TRY_HEX_ID(obj, Id);
+		JSON_TRY_BOOL(obj, IsIncluded);
 
-			// If package with the same Id is found
-			if (ExistingPackage.GetId() == package.GetId())
-			{
-				// If IsIncluded is set on the new package, we are safe to continue
-				if (package.GetIsIncluded())
-				{
-					bPackageDataFound = true;
-				}
+		FManifestPackage& Package = ManifestPackages.AddDefaulted_GetRef();
+		Package.Id = Id;
+		Package.IsIncluded = IsIncluded;
+		obj->TryGetStringField(TEXT("Name"), Package.Name);
+		ManifestIndices.FindOrAdd(Id, ManifestPackages.Num() - 1);
+	}
 
-				break;
-			}
-		}
+	// Existing packages without data need the new export to include them
+	TMap<FArticyId, bool> ExistingPackages;
+	ExistingPackages.Reserve(Packages.Num());
+	for (const auto& ExistingPackage : Packages)
+	{
+		ExistingPackages.FindOrAdd(ExistingPackage.GetId(), ExistingPackage.GetIsIncluded());
+		if (ExistingPackage.GetIsIncluded())
+			continue;
 
-		if (!bPackageDataFound)
+		const int32* ManifestIndex = ManifestIndices.Find(ExistingPackage.GetId());
+		if (!ManifestIndex || !ManifestPackages[*ManifestIndex].IsIncluded)
 		{
 			UE_LOG(LogArticyEditor, Error, TEXT("No data for package %s"), *ExistingPackage.GetName());
 			return false;
 		}
 	}
 
-	// Iterate over new package list
-	for (const auto& pack : *Json)
+	// New packages without data need an existing package with data
+	for (const FManifestPackage& Package : ManifestPackages)
 	{
-		const auto& obj = pack->AsObject();
-		if (!obj.IsValid())
-			continue;
-
-		FArticyPackageDef package;
-		package.ImportFromJson(Archive, obj);
-
-		// New package has data
-		if (package.GetIsIncluded())
+		if (Package.IsIncluded)
 			continue;
 
-		bool bPackageDataFound = false;
-
-		// Check if package already exists in the Packages array
-		for (const auto& ExistingPackage : Packages)
+		const bool* bExistingIncluded = ExistingPackages.Find(Package.Id);
+		if (!bExistingIncluded || !*bExistingIncluded)
 		{
-			if (ExistingPackage.GetId() == package.GetId())
-			{
-				// Old package has data
-				if (ExistingPackage.GetIsIncluded())
-				{
-					bPackageDataFound = true;
-				}
-				break;
-			}
-		}
-
-		if (!bPackageDataFound)
-		{
-			UE_LOG(LogArticyEditor, Error, TEXT("No data for package %s"), *package.GetName());
+			UE_LOG(LogArticyEditor, Error, TEXT("No data for package %s"), *Package.Name);
 			return false;
 		}
 	}
@@ -610,6 +1031,20 @@ void FArticyPackageDefs::GatherScripts(UArticyImportData* Data) const
 		pack.GatherScripts(Data);
 }
 
+/**
+ * Gets the ids of the objects of all packages by technical name, to resolve object references in scripts.
+ * Names which more than one object has are mapped to a null id.
+ *
+ * @return The map of object ids by technical name.
+ */
+TMap<FName, FArticyId> FArticyPackageDefs::GetObjectIds() const
+{
+	TMap<FName, FArticyId> ObjectIds;
+	for (const auto& pack : Packages)
+		pack.GatherObjectIds(ObjectIds);
+	return ObjectIds;
+}
+
 /**
  * Gathers text data from a JSON object and adds it to the package definition.
  *
@@ -631,9 +1066,9 @@ void FArticyPackageDef::GatherText(const TSharedPtr<FJsonObject>& Json)
 /**
  * Gets the texts map from the package definition.
  *
- * @return A map of text data.
+ * @return A constant reference to the map of text data.
  */
-TMap<FString, FArticyTexts> FArticyPackageDef::GetTexts() const
+const TMap<FString, FArticyTexts>& FArticyPackageDef::GetTexts() const
 {
 	return Texts;
 }
@@ -642,46 +1077,113 @@ TMap<FString, FArticyTexts> FArticyPackageDef::GetTexts() const
  * Gets the texts map from a specific package definition.
  *
  * @param Package The package definition to retrieve texts from.
- * @return A map of text data.
+ * @return A constant reference to the map of text data.
  */
-TMap<FString, FArticyTexts> FArticyPackageDefs::GetTexts(const FArticyPackageDef& Package)
+const TMap<FString, FArticyTexts>& FArticyPackageDefs::GetTexts(const FArticyPackageDef& Package)
 {
 	return Package.GetTexts();
 }
 
 /**
- * Generates assets for all package definitions and stores them in the ArticyImportData.
+ * Generates assets for the package definitions and stores them in the ArticyImportData.
+ * Packages whose assets did not change are kept as they are, unless all packages are regenerated.
  *
  * @param Data A pointer to the UArticyImportData object.
+ * @param bRegenerateAll If true, the assets of all packages are regenerated.
  */
-void FArticyPackageDefs::GenerateAssets(UArticyImportData* Data) const
+void FArticyPackageDefs::GenerateAssets(UArticyImportData* Data, bool bRegenerateAll) const
 {
 	auto& ArticyPackages = Data->GetPackages();
 
 	ArticyPackages.Reset(Packages.Num());
 
-	for (auto pack : Packages)
+	// The cache is filled from scratch while the packages are generated
+	auto& parentChildrenCache = Data->GetParentChildrenCache();
+	parentChildrenCache.Reset();
+
+	TSet<const UArticyPackage*> KeptPackages;
+	for (const auto& pack : Packages)
 	{
+		if (!bRegenerateAll && !pack.GetAssetsChanged())
+		{
+			if (UArticyPackage* ExistingPackage = pack.FindPackageAsset())
+			{
+				// Objects of other packages may still have children in this package
+				pack.AddToParentCache(Data);
+				ArticyPackages.Add(ExistingPackage);
+				KeptPackages.Add(ExistingPackage);
+				continue;
+			}
+		}
+
 		ArticyPackages.Add(pack.GeneratePackageAsset(Data));
 	}
 
+	UE_LOG(LogArticyEditor, Log, TEXT("Regenerated %d of %d packages"), Packages.Num() - KeptPackages.Num(), Packages.Num());
+
+	// new packages need to be registered with the asset manager to be assigned to their chunks
+	FArticyEditorModule::ApplyPackageChunkRules();
+
+	// If the setting is enabled, sort the children by the positions read on import. Will only work with exported position properties.
+	if (GetDefault<UArticyPluginSettings>()->bSortChildrenAtGeneration)
+	{
+		TMap<FArticyId, FVector2D> Positions;
+		for (const auto& pack : Packages)
+		{
+			pack.GatherPositions(Positions);
+		}
+
+		// Children with a position come first, ordered by X and then Y; the others keep their order
+		const auto ComparePositions = [&Positions](const FArticyId& A, const FArticyId& B)
+		{
+			const FVector2D* APos = Positions.Find(A);
+			const FVector2D* BPos = Positions.Find(B);
+			if (!APos || !BPos)
+			{
+				return APos != nullptr && BPos == nullptr;
+			}
+
+			if (APos->X == BPos->X)
+			{
+				return APos->Y < BPos->Y;
+			}
+
+			return APos->X < BPos->X;
+		};
+
+		for (auto& children : parentChildrenCache)
+		{
+			children.Value.Values.StableSort(ComparePositions);
+		}
+	}
+
 	// Store gathered information about who has which children in generated assets
-	auto parentChildrenCache = Data->GetParentChildrenCache();
 	const auto& childrenProp = FName{ TEXT("Children") };
 	for (auto& pack : ArticyPackages)
 	{
+		const bool bKept = KeptPackages.Contains(pack.Get());
 		for (auto obj : pack->GetAssets())
 		{
 			if (auto articyObj = Cast<UArticyObject>(obj))
 			{
-				if (auto children = parentChildrenCache.Find(articyObj->GetId()))
+				const auto children = parentChildrenCache.Find(articyObj->GetId());
+
+				if (!bKept)
 				{
-					// If the setting is enabled, try to sort. Will only work with exported position properties.
-					if (GetDefault<UArticyPluginSettings>()->bSortChildrenAtGeneration)
+					if (children)
 					{
-						children->Values.Sort(ArticyImporterHelpers::FCompareArticyNodeXLocation());
+						articyObj->SetProp(childrenProp, children->Values);
 					}
-					articyObj->SetProp(childrenProp, children->Values);
+					continue;
+				}
+
+				// Kept packages are only touched (and saved) if the children changed in another package
+				static const TArray<FArticyId> NoChildren;
+				const TArray<FArticyId>& NewChildren = children ? children->Values : NoChildren;
+				if (articyObj->GetChildrenIDs() != NewChildren)
+				{
+					articyObj->SetProp(childrenProp, NewChildren);
+					pack->MarkPackageDirty();
 				}
 			}
 		}
@@ -705,11 +1207,11 @@ TSet<FString> FArticyPackageDefs::GetPackageNames() const
 }
 
 /**
- * Gets an array of package definitions.
+ * Gets the package definitions, without copying their models and texts.
  *
- * @return An array of package definitions.
+ * @return A constant reference to the array of package definitions.
  */
-TArray<FArticyPackageDef> FArticyPackageDefs::GetPackages() const
+const TArray<FArticyPackageDef>& FArticyPackageDefs::GetPackages() const
 {
 	return Packages;
 }
@@ -722,6 +1224,40 @@ void FArticyPackageDefs::ResetPackages()
 	Packages.Empty();
 }
 
+/**
+ * Checks if the package has the same objects and texts as another package definition, based on the file hashes.
+ *
+ * @param Other The other package definition to compare with.
+ * @return True if both the objects and texts hashes are equal, false otherwise.
+ */
+bool FArticyPackageDef::HasSameContent(const FArticyPackageDef& Other) const
+{
+	return !PackageObjectsHash.IsEmpty()
+		&& PackageObjectsHash.Equals(Other.PackageObjectsHash)
+		&& PackageTextsHash.Equals(Other.PackageTextsHash);
+}
+
+/**
+ * Checks if the assets of the package need to be regenerated, i.e. if the package is new,
+ * was renamed or its objects or texts changed in the last import.
+ *
+ * @return True if the package assets need to be regenerated, false otherwise.
+ */
+bool FArticyPackageDef::GetAssetsChanged() const
+{
+	return bAssetsChanged;
+}
+
+/**
+ * Sets whether the assets of the package need to be regenerated.
+ *
+ * @param bChanged True if the package assets need to be regenerated.
+ */
+void FArticyPackageDef::SetAssetsChanged(bool bChanged)
+{
+	bAssetsChanged = bChanged;
+}
+
 /**
  * Gets the script fragment hash for the package definition.
  *
@@ -731,3 +1267,23 @@ FString FArticyPackageDef::GetScriptFragmentHash() const
 {
 	return ScriptFragmentHash;
 }
+
+/**
+ * Gets the hash of the objects file the package was imported from.
+ *
+ * @return The objects hash as a string, empty if the objects were not imported.
+ */
+const FString& FArticyPackageDef::GetObjectsHash() const
+{
+	return PackageObjectsHash;
+}
+
+/**
+ * Gets the hash of the texts file the package was imported from.
+ *
+ * @return The texts hash as a string, empty if the texts were not imported.
+ */
+const FString& FArticyPackageDef::GetTextsHash() const
+{
+	return PackageTextsHash;
+}
@@ -4,354 +4,168 @@
 
 #include "Slate/ArticyFilterHelpers.h"
 #include "ArticyObject.h"
+#include "ArticyObjectIndexSubsystem.h"
 #include "Interfaces/ArticyObjectWithDisplayName.h"
 #include "Interfaces/ArticyObjectWithText.h"
 #include "Interfaces/ArticyObjectWithSpeaker.h"
 #include "ArticyEditorModule.h"
+#include "Misc/PackageName.h"
+#include "Algo/BinarySearch.h"
 
 #define LOCTEXT_NAMESPACE "ArticyObjectSearchBoxHelpers"
 
 /**
- * Expression context to test the given asset data against the current text filter.
- * This class evaluates whether an Articy object matches the provided filter criteria.
+ * Gathers the searchable texts of an articy object.
+ *
+ * @param InObject The object to gather the texts of.
+ * @param Speaker The speaker of the object, if it has one.
  */
-class FFrontendFilter_ArticyObjectFilterExpressionContext : public ITextFilterExpressionContext
+FArticyObjectSearchEntry::FArticyObjectSearchEntry(UArticyObject* InObject, const UArticyObject* Speaker)
+	: Object(InObject)
+	, Class(InObject->GetClass())
+	, AssetName(InObject->GetFName())
+	, TechnicalName(InObject->GetTechnicalName())
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION > 0
+	, ClassPath(InObject->GetClass()->GetPathName())
+#else
+	, ClassPath(InObject->GetClass()->GetFName())
+#endif
+	, ObjectPath(InObject->GetPathName())
+	, PackageName(InObject->GetOutermost()->GetFName())
+	, PackagePath(FPackageName::GetLongPackagePath(InObject->GetOutermost()->GetName()))
 {
-public:
-	// Define a pointer type for FArticyObjectFilterType without const and reference qualifiers.
-	typedef TRemoveReference<FArticyObjectFilterType>::Type* FArticyObjectFilterTypePtr;
-
-	/** Default constructor for FFrontendFilter_ArticyObjectFilterExpressionContext. */
-	FFrontendFilter_ArticyObjectFilterExpressionContext()
-		: AssetPtr(nullptr)
-		, bIncludeClassName(true)
-		, NameKeyName("Name")
-		, PathKeyName("Path")
-		, ClassKeyName("Class")
-		, TypeKeyName("Type")
-		, TagKeyName("Tag")
-	{
-	}
-
-	/**
-	 * Sets the asset to be filtered.
-	 *
-	 * @param InAsset Pointer to the asset being filtered.
-	 */
-	void SetAsset(FArticyObjectFilterTypePtr InAsset)
+	if (const IArticyObjectWithDisplayName* ArticyObjectWithDisplayName = Cast<IArticyObjectWithDisplayName>(InObject))
 	{
-		AssetPtr = InAsset;
+		DisplayName = FTextFilterString(ArticyObjectWithDisplayName->GetDisplayName().ToString());
 	}
 
-	/** Clears the current asset from the context. */
-	void ClearAsset()
+	if (const IArticyObjectWithText* ArticyObjectWithText = Cast<IArticyObjectWithText>(InObject))
 	{
-		AssetPtr = nullptr;
+		const FText& ObjectText = ArticyObjectWithText->GetText();
+		if (!ObjectText.IsEmptyOrWhitespace())
+		{
+			Text = FTextFilterString(ObjectText.ToString());
+		}
 	}
 
-	/**
-	 * Sets whether the class name should be included in the filter.
-	 *
-	 * @param InIncludeClassName Boolean value indicating inclusion of class name.
-	 */
-	void SetIncludeClassName(const bool InIncludeClassName)
+	if (const IArticyObjectWithDisplayName* SpeakerWithDisplayName = Cast<IArticyObjectWithDisplayName>(Speaker))
 	{
-		bIncludeClassName = InIncludeClassName;
+		SpeakerDisplayName = FTextFilterString(SpeakerWithDisplayName->GetDisplayName().ToString());
 	}
+}
 
-	/**
-	 * Gets whether the class name is included in the filter.
-	 *
-	 * @return Boolean value indicating inclusion of class name.
-	 */
-	bool GetIncludeClassName() const
+/**
+ * Expression context to test the given search entry against the current text filter.
+ * This class evaluates whether an Articy object matches the provided filter criteria, using only the texts gathered
+ * in the entry, so it can be used on any thread.
+ */
+class FFrontendFilter_ArticyObjectFilterExpressionContext : public ITextFilterExpressionContext
+{
+public:
+	/** Constructor for FFrontendFilter_ArticyObjectFilterExpressionContext. */
+	FFrontendFilter_ArticyObjectFilterExpressionContext(const FArticyObjectSearchEntry& InEntry, const bool bInIncludeClassName)
+		: Entry(InEntry)
+		, bIncludeClassName(bInIncludeClassName)
 	{
-		return bIncludeClassName;
 	}
 
 	/**
-	 * Tests the asset against a basic string expression.
+	 * Tests the entry against a basic string expression.
 	 *
 	 * @param InValue The value to test against.
 	 * @param InTextComparisonMode The mode of text comparison.
-	 * @return True if the asset matches the string expression, false otherwise.
+	 * @return True if the entry matches the string expression, false otherwise.
 	 */
 	virtual bool TestBasicStringExpression(const FTextFilterString& InValue, const ETextFilterTextComparisonMode InTextComparisonMode) const override
 	{
-		// Cast the asset pointer to UArticyObject type.
-		UArticyObject* ArticyObject = Cast<UArticyObject>(AssetPtr->GetAsset());
-
-		// Check the asset's display name, technical name, text, and speaker display name.
-		if (CheckDisplayName(InValue, InTextComparisonMode) ||
-			CheckTechnicalName(InValue, InTextComparisonMode) ||
-			CheckTextOfArticyObject(InValue, InTextComparisonMode) ||
-			CheckSpeakerDisplayName(InValue, InTextComparisonMode))
+		// Check the object's display name, technical name, text, and speaker display name.
+		const auto Compare = [&InValue, InTextComparisonMode](const FTextFilterString& TextToCompare)
+		{
+			return !TextToCompare.IsEmpty() && TextToCompare.CompareText(InValue, InTextComparisonMode);
+		};
+
+		if (Compare(Entry.DisplayName) ||
+			Compare(Entry.TechnicalName) ||
+			Compare(Entry.Text) ||
+			Compare(Entry.SpeakerDisplayName))
 		{
 			return true;
 		}
 
 		// Compare asset name.
-		const FTextFilterString AssetName(AssetPtr->AssetName);
-		if (AssetName.CompareText(InValue, InTextComparisonMode))
+		if (Entry.AssetName.CompareText(InValue, InTextComparisonMode))
 		{
 			return true;
 		}
 
 		// Optionally include class name in the filter.
-		if (bIncludeClassName)
-		{
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION > 0
-			const FTextFilterString AssetClassFilter(AssetPtr->AssetClassPath.ToString());
-#else
-			const FTextFilterString AssetClassFilter(AssetPtr->AssetClass);
-#endif
-			if (AssetClassFilter.CompareText(InValue, InTextComparisonMode))
-			{
-				return true;
-			}
-		}
-
-		return false;
+		return bIncludeClassName && Entry.ClassPath.CompareText(InValue, InTextComparisonMode);
 	}
 
 	/**
-	 * Tests the asset against a complex expression.
+	 * Tests the entry against a complex expression.
 	 *
 	 * @param InKey The key for the expression.
 	 * @param InValue The value to test against.
 	 * @param InComparisonOperation The comparison operation to use.
 	 * @param InTextComparisonMode The mode of text comparison.
-	 * @return True if the asset matches the complex expression, false otherwise.
+	 * @return True if the entry matches the complex expression, false otherwise.
 	 */
 	virtual bool TestComplexExpression(const FName& InKey, const FTextFilterString& InValue, const ETextFilterComparisonOperation InComparisonOperation, const ETextFilterTextComparisonMode InTextComparisonMode) const override
 	{
-		// Special handling for the asset name, path, and type keys.
-		if (InKey == NameKeyName)
+		static const FName NameKeyName("Name");
+		static const FName PathKeyName("Path");
+		static const FName ClassKeyName("Class");
+		static const FName TypeKeyName("Type");
+
+		// Only Equal or NotEqual operations are allowed for the asset name, path, and type keys.
+		if (InComparisonOperation != ETextFilterComparisonOperation::Equal && InComparisonOperation != ETextFilterComparisonOperation::NotEqual)
 		{
-			// Only Equal or NotEqual operations are allowed.
-			if (InComparisonOperation != ETextFilterComparisonOperation::Equal && InComparisonOperation != ETextFilterComparisonOperation::NotEqual)
-			{
-				return false;
-			}
+			return false;
+		}
 
+		bool bIsMatch = false;
+		if (InKey == NameKeyName)
+		{
 			// Compare the asset name against the filter value.
-			const bool bIsMatch = TextFilterUtils::TestBasicStringExpression(AssetPtr->AssetName, InValue, InTextComparisonMode);
-			return (InComparisonOperation == ETextFilterComparisonOperation::Equal) ? bIsMatch : !bIsMatch;
+			bIsMatch = TextFilterUtils::TestBasicStringExpression(Entry.AssetName, InValue, InTextComparisonMode);
 		}
-
-		if (InKey == PathKeyName)
+		else if (InKey == PathKeyName)
 		{
-			// Only Equal or NotEqual operations are allowed.
-			if (InComparisonOperation != ETextFilterComparisonOperation::Equal && InComparisonOperation != ETextFilterComparisonOperation::NotEqual)
-			{
-				return false;
-			}
-
 			// Compare the asset path in either Partial or Exact mode.
-			bool bIsMatch = false;
-			if (InTextComparisonMode == ETextFilterTextComparisonMode::Partial)
+			bIsMatch = TextFilterUtils::TestBasicStringExpression(Entry.ObjectPath, InValue, InTextComparisonMode);
+			if (InTextComparisonMode != ETextFilterTextComparisonMode::Partial)
 			{
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION > 0
-				bIsMatch = TextFilterUtils::TestBasicStringExpression(AssetPtr->GetObjectPathString(), InValue, InTextComparisonMode);
-#else
-				bIsMatch = TextFilterUtils::TestBasicStringExpression(AssetPtr->ObjectPath, InValue, InTextComparisonMode);
-#endif
-			}
-			else
-			{
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION > 0
-				bIsMatch = TextFilterUtils::TestBasicStringExpression(AssetPtr->GetObjectPathString(), InValue, InTextComparisonMode)
-#else
-				bIsMatch = TextFilterUtils::TestBasicStringExpression(AssetPtr->ObjectPath, InValue, InTextComparisonMode)
-#endif
-					|| TextFilterUtils::TestBasicStringExpression(AssetPtr->PackageName, InValue, InTextComparisonMode)
-					|| TextFilterUtils::TestBasicStringExpression(AssetPtr->PackagePath, InValue, InTextComparisonMode);
+				bIsMatch = bIsMatch
+					|| TextFilterUtils::TestBasicStringExpression(Entry.PackageName, InValue, InTextComparisonMode)
+					|| TextFilterUtils::TestBasicStringExpression(Entry.PackagePath, InValue, InTextComparisonMode);
 			}
-			return (InComparisonOperation == ETextFilterComparisonOperation::Equal) ? bIsMatch : !bIsMatch;
 		}
-
-		if (InKey == ClassKeyName || InKey == TypeKeyName)
+		else if (InKey == ClassKeyName || InKey == TypeKeyName)
 		{
-			// Only Equal or NotEqual operations are allowed.
-			if (InComparisonOperation != ETextFilterComparisonOperation::Equal && InComparisonOperation != ETextFilterComparisonOperation::NotEqual)
-			{
-				return false;
-			}
-
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION > 0
-			const bool bIsMatch = TextFilterUtils::TestBasicStringExpression(AssetPtr->AssetClassPath.ToString(), InValue, InTextComparisonMode);
-#else
-			const bool bIsMatch = TextFilterUtils::TestBasicStringExpression(AssetPtr->AssetClass, InValue, InTextComparisonMode);
-#endif	
-			return (InComparisonOperation == ETextFilterComparisonOperation::Equal) ? bIsMatch : !bIsMatch;
+			bIsMatch = TextFilterUtils::TestBasicStringExpression(Entry.ClassPath, InValue, InTextComparisonMode);
 		}
-
-		// Generic handling for anything in the asset meta-data
+		else
 		{
-			auto GetMetaDataValue = [this, &InKey](FString& OutMetaDataValue) -> bool
-				{
-					// Check for a literal key
-					if (AssetPtr->GetTagValue(InKey, OutMetaDataValue))
-					{
-						return true;
-					}
-
-					return false;
-				};
-
-			FString MetaDataValue;
-			if (GetMetaDataValue(MetaDataValue))
-			{
-				return TextFilterUtils::TestComplexExpression(MetaDataValue, InValue, InComparisonOperation, InTextComparisonMode);
-			}
+			// Articy objects have no asset meta-data to test against
+			return false;
 		}
 
-		return false;
+		return (InComparisonOperation == ETextFilterComparisonOperation::Equal) ? bIsMatch : !bIsMatch;
 	}
 
 private:
 
-	/** Pointer to the asset currently being filtered */
-	FArticyObjectFilterTypePtr AssetPtr;
+	/** The entry currently being filtered */
+	const FArticyObjectSearchEntry& Entry;
 
 	/** Boolean to indicate if the class name should be included in string tests */
-	bool bIncludeClassName;
-
-	/** Keys used for complex expression tests */
-	const FName NameKeyName;
-	const FName PathKeyName;
-	const FName ClassKeyName;
-	const FName TypeKeyName;
-	const FName TagKeyName;
-
-	/**
-	 * Checks if the display name of the asset matches the filter value.
-	 *
-	 * @param InValue The filter value to compare against.
-	 * @param InTextComparisonMode The mode of text comparison.
-	 * @return True if the display name matches, false otherwise.
-	 */
-	bool CheckDisplayName(const FTextFilterString& InValue, const ETextFilterTextComparisonMode InTextComparisonMode) const
-	{
-		// Check if the asset implements IArticyObjectWithDisplayName
-		IArticyObjectWithDisplayName* ArticyObjectWithDisplayName = Cast<IArticyObjectWithDisplayName>(AssetPtr->GetAsset());
-
-		if (ArticyObjectWithDisplayName)
-		{
-			// Get the display name and compare it with the filter value.
-			const FTextFilterString TextToCompare(ArticyObjectWithDisplayName->GetDisplayName().ToString());
-
-			if (TextToCompare.IsEmpty())
-			{
-				return false;
-			}
-
-			return TextToCompare.CompareText(InValue, InTextComparisonMode);
-		}
-
-		return false;
-	}
-
-	/**
-	 * Checks if the text of the Articy object matches the filter value.
-	 *
-	 * @param InValue The filter value to compare against.
-	 * @param InTextComparisonMode The mode of text comparison.
-	 * @return True if the text matches, false otherwise.
-	 */
-	bool CheckTextOfArticyObject(const FTextFilterString& InValue, const ETextFilterTextComparisonMode InTextComparisonMode) const
-	{
-		// Check if the asset implements IArticyObjectWithText
-		IArticyObjectWithText* ArticyObjectWithText = Cast<IArticyObjectWithText>(AssetPtr->GetAsset());
-
-		if (ArticyObjectWithText)
-		{
-			// Get the text and compare it with the filter value.
-			const FText Text = ArticyObjectWithText->GetText();
-			const FTextFilterString FilterString(Text.ToString());
-
-			const bool bTextIsEmptyOrWhitespace = Text.IsEmptyOrWhitespace();
-
-			if (!bTextIsEmptyOrWhitespace && FilterString.CompareText(InValue, InTextComparisonMode))
-			{
-				return true;
-			}
-		}
-
-		return false;
-	}
-
-	/**
-	 * Checks if the technical name of the Articy object matches the filter value.
-	 *
-	 * @param InValue The filter value to compare against.
-	 * @param InTextComparisonMode The mode of text comparison.
-	 * @return True if the technical name matches, false otherwise.
-	 */
-	bool CheckTechnicalName(const FTextFilterString& InValue, const ETextFilterTextComparisonMode InTextComparisonMode) const
-	{
-		// Cast the asset pointer to UArticyObject
-		UArticyObject* ArticyObject = Cast<UArticyObject>(AssetPtr->GetAsset());
-
-		if (ArticyObject)
-		{
-			// Get the technical name and compare it with the filter value.
-			const FTextFilterString TextToCompare(ArticyObject->GetTechnicalName());
-
-			if (TextToCompare.IsEmpty())
-			{
-				return false;
-			}
-
-			return TextToCompare.CompareText(InValue, InTextComparisonMode);
-		}
-
-		return false;
-	}
-
-	/**
-	 * Checks if the speaker display name of the Articy object matches the filter value.
-	 *
-	 * @param InValue The filter value to compare against.
-	 * @param InTextComparisonMode The mode of text comparison.
-	 * @return True if the speaker display name matches, false otherwise.
-	 */
-	bool CheckSpeakerDisplayName(const FTextFilterString& InValue, const ETextFilterTextComparisonMode InTextComparisonMode) const
-	{
-		// Check if the asset implements IArticyObjectWithSpeaker
-		IArticyObjectWithSpeaker* ArticyObjectWithSpeaker = Cast<IArticyObjectWithSpeaker>(AssetPtr->GetAsset());
-
-		if (ArticyObjectWithSpeaker)
-		{
-			// Find the speaker asset and check its display name.
-			IArticyObjectWithDisplayName* SpeakerDisplayName = Cast<IArticyObjectWithDisplayName>(UArticyObject::FindAsset(ArticyObjectWithSpeaker->GetSpeakerId()));
-
-			if (!SpeakerDisplayName)
-			{
-				UE_LOG(LogArticyEditor, Error, TEXT("Articy filter: Speaker object does not exist"));
-				return false;
-			}
-
-			// Compare the speaker's display name with the filter value.
-			const FText& SpeakerName = SpeakerDisplayName->GetDisplayName();
-			const FTextFilterString TextToCompare(SpeakerName.ToString());
-
-			if (TextToCompare.IsEmpty())
-			{
-				return false;
-			}
-
-			return TextToCompare.CompareText(InValue, InTextComparisonMode);
-		}
-
-		return false;
-	}
+	const bool bIncludeClassName;
 };
 
 /** Constructor for FFrontendFilter_ArticyObject. */
 FFrontendFilter_ArticyObject::FFrontendFilter_ArticyObject() :
-	TextFilterExpressionContext(MakeShareable(new FFrontendFilter_ArticyObjectFilterExpressionContext()))
-	, TextFilterExpressionEvaluator(ETextFilterExpressionEvaluatorMode::Complex)
+	TextFilterExpressionEvaluator(ETextFilterExpressionEvaluatorMode::Complex)
 {
 }
 
@@ -369,11 +183,9 @@ FFrontendFilter_ArticyObject::~FFrontendFilter_ArticyObject()
  */
 bool FFrontendFilter_ArticyObject::PassesFilter(FArticyObjectFilterType InItem) const
 {
-	// Set the asset to be filtered and evaluate the filter expression.
-	TextFilterExpressionContext->SetAsset(&InItem);
-	const bool bMatched = TextFilterExpressionEvaluator.TestTextFilter(*TextFilterExpressionContext);
-	TextFilterExpressionContext->ClearAsset();
-	return bMatched;
+	// The context only reads the entry, so the filter may be evaluated on several threads at once.
+	const FFrontendFilter_ArticyObjectFilterExpressionContext TextFilterExpressionContext(InItem, bIncludeClassName);
+	return TextFilterExpressionEvaluator.TestTextFilter(TextFilterExpressionContext);
 }
 
 /**
@@ -417,15 +229,202 @@ FText FFrontendFilter_ArticyObject::GetFilterErrorText() const
  */
 void FFrontendFilter_ArticyObject::SetIncludeClassName(const bool InIncludeClassName)
 {
-	if (TextFilterExpressionContext->GetIncludeClassName() != InIncludeClassName)
+	if (bIncludeClassName != InIncludeClassName)
 	{
-		TextFilterExpressionContext->SetIncludeClassName(InIncludeClassName);
+		bIncludeClassName = InIncludeClassName;
 
 		// Will trigger a re-filter with the new setting
 		BroadcastChangedEvent();
 	}
 }
 
+/**
+ * Checks whether a filter text is a plain search term, i.e. contains no operators, quotes or key-value pairs which
+ * could make a longer text match items the shorter one did not.
+ *
+ * @param FilterText The filter text to check.
+ * @return True if the filter text only consists of plain words.
+ */
+static bool IsPlainFilterText(const FString& FilterText)
+{
+	for (const TCHAR Character : FilterText)
+	{
+		if (!FChar::IsAlnum(Character) && Character != TEXT('_') && Character != TEXT(' '))
+			return false;
+	}
+
+	TArray<FString> Terms;
+	FilterText.ParseIntoArray(Terms, TEXT(" "));
+	for (const FString& Term : Terms)
+	{
+		if (Term.Equals(TEXT("OR"), ESearchCase::IgnoreCase) || Term.Equals(TEXT("AND"), ESearchCase::IgnoreCase) || Term.Equals(TEXT("NOT"), ESearchCase::IgnoreCase))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Builds the index over the entries of the packages.
+ *
+ * @param Packages The entries of each package, which must outlive the index.
+ */
+void FArticyObjectTokenIndex::Build(const TArray<TSharedRef<const TArray<FArticyObjectSearchEntry>, ESPMode::ThreadSafe>>& Packages)
+{
+	Entries.Reset();
+	Tokens.Reset();
+	Postings.Reset();
+	Suffixes.Reset();
+
+	TMap<FString, int32> TokenIndices;
+	for (const TSharedRef<const TArray<FArticyObjectSearchEntry>, ESPMode::ThreadSafe>& PackageEntries : Packages)
+	{
+		for (const FArticyObjectSearchEntry& Entry : *PackageEntries)
+		{
+			const int32 EntryIndex = Entries.Add(&Entry);
+			AddTokens(Entry.AssetName, EntryIndex, TokenIndices);
+			AddTokens(Entry.TechnicalName, EntryIndex, TokenIndices);
+			AddTokens(Entry.DisplayName, EntryIndex, TokenIndices);
+			AddTokens(Entry.Text, EntryIndex, TokenIndices);
+			AddTokens(Entry.SpeakerDisplayName, EntryIndex, TokenIndices);
+			AddTokens(Entry.ClassPath, EntryIndex, TokenIndices);
+		}
+	}
+
+	for (int32 TokenIndex = 0; TokenIndex < Tokens.Num(); ++TokenIndex)
+	{
+		for (int32 Offset = 0; Offset < Tokens[TokenIndex].Len(); ++Offset)
+		{
+			Suffixes.Add({ TokenIndex, Offset });
+		}
+	}
+
+	Suffixes.Sort([this](const FSuffix& A, const FSuffix& B)
+	{
+		return FCString::Strcmp(*Tokens[A.Token] + A.Offset, *Tokens[B.Token] + B.Offset) < 0;
+	});
+}
+
+/**
+ * Adds the words of a text of an entry to the index.
+ *
+ * @param Text The text, which is in upper case like all filter strings.
+ * @param EntryIndex The index of the entry.
+ * @param TokenIndices The indices of the words added so far.
+ */
+void FArticyObjectTokenIndex::AddTokens(const FTextFilterString& Text, int32 EntryIndex, TMap<FString, int32>& TokenIndices)
+{
+	const FString& String = Text.AsString();
+	int32 Start = 0;
+	while (Start < String.Len())
+	{
+		if (!FChar::IsAlnum(String[Start]) && String[Start] != TEXT('_'))
+		{
+			++Start;
+			continue;
+		}
+
+		int32 End = Start + 1;
+		while (End < String.Len() && (FChar::IsAlnum(String[End]) || String[End] == TEXT('_')))
+		{
+			++End;
+		}
+
+		const FString Token = String.Mid(Start, End - Start);
+		const int32* ExistingIndex = TokenIndices.Find(Token);
+		const int32 TokenIndex = ExistingIndex ? *ExistingIndex : TokenIndices.Add(Token, Tokens.Add(Token));
+		if (!ExistingIndex)
+		{
+			Postings.AddDefaulted();
+		}
+
+		// The entries are added in order, so the postings stay sorted
+		TArray<int32>& Posting = Postings[TokenIndex];
+		if (Posting.Num() == 0 || Posting.Last() != EntryIndex)
+		{
+			Posting.Add(EntryIndex);
+		}
+
+		Start = End;
+	}
+}
+
+/**
+ * Finds the entries which contain all words of a plain filter text. Each word of the filter text is looked up among
+ * the sorted suffixes of the indexed words, which finds all words containing it.
+ *
+ * @param FilterText The filter text.
+ * @param OutCandidates Receives the entries which may pass the filter text, in the order of the packages.
+ * @return False if the filter text is empty or uses operators or quotes, which the index cannot answer.
+ */
+bool FArticyObjectTokenIndex::FindCandidates(const FString& FilterText, TArray<const FArticyObjectSearchEntry*>& OutCandidates) const
+{
+	if (!IsPlainFilterText(FilterText))
+		return false;
+
+	TArray<FString> Terms;
+	FilterText.ToUpper().ParseIntoArray(Terms, TEXT(" "));
+	if (Terms.Num() == 0)
+		return false;
+
+	TBitArray<> Matches(true, Entries.Num());
+	for (const FString& Term : Terms)
+	{
+		const int32 First = Algo::LowerBound(Suffixes, Term, [this](const FSuffix& Suffix, const FString& Value)
+		{
+			return FCString::Strcmp(*Tokens[Suffix.Token] + Suffix.Offset, *Value) < 0;
+		});
+
+		TBitArray<> TermMatches(false, Entries.Num());
+		TBitArray<> VisitedTokens(false, Tokens.Num());
+		for (int32 SuffixIndex = First; SuffixIndex < Suffixes.Num(); ++SuffixIndex)
+		{
+			const FSuffix& Suffix = Suffixes[SuffixIndex];
+			if (FCString::Strncmp(*Tokens[Suffix.Token] + Suffix.Offset, *Term, Term.Len()) != 0)
+				break;
+
+			if (VisitedTokens[Suffix.Token])
+				continue;
+			VisitedTokens[Suffix.Token] = true;
+
+			for (const int32 EntryIndex : Postings[Suffix.Token])
+			{
+				TermMatches[EntryIndex] = true;
+			}
+		}
+
+		Matches.CombineWithBitwiseAND(TermMatches, EBitwiseOperatorFlags::MaintainSize);
+	}
+
+	OutCandidates.Reset();
+	for (TConstSetBitIterator<> It(Matches); It; ++It)
+	{
+		OutCandidates.Add(Entries[It.GetIndex()]);
+	}
+
+	return true;
+}
+
+/**
+ * Checks whether every item which passes this filter passed the previous filter text too.
+ * Plain terms are combined with AND and matched partially, so appending characters or terms only removes items.
+ *
+ * @param PreviousFilterText The previous filter text.
+ * @return True if the items which passed the previous filter text are a superset of the ones passing this one.
+ */
+bool FFrontendFilter_ArticyObject::IsNarrowerThan(const FText& PreviousFilterText) const
+{
+	const FString Previous = PreviousFilterText.ToString().TrimStartAndEnd();
+	if (Previous.IsEmpty())
+		return true;
+
+	const FString Current = GetRawFilterText().ToString().TrimStartAndEnd();
+	if (!IsPlainFilterText(Previous) || !IsPlainFilterText(Current))
+		return false;
+
+	return Current.StartsWith(Previous, ESearchCase::IgnoreCase);
+}
+
 /**
  * Constructor for FArticyClassRestrictionFilter.
  *
@@ -447,10 +446,10 @@ bool FArticyClassRestrictionFilter::PassesFilter(FArticyObjectFilterType InItem)
 	// Check if the asset matches the allowed class type.
 	if (bExactClass)
 	{
-		return InItem.GetClass() == AllowedClass;
+		return InItem.Class == AllowedClass.Get();
 	}
 
-	return InItem.GetAsset()->IsA(AllowedClass.Get());
+	return InItem.Class && InItem.Class->IsChildOf(AllowedClass.Get());
 }
 
 /** Expression context to test the given variable data against the current text filter */
@@ -20,6 +20,8 @@
 #include "Layout/WidgetPath.h"
 #include "Framework/Application/SlateApplication.h"
 #include "ArticyEditorModule.h"
+#include "ArticyObjectIndexSubsystem.h"
+#include "Async/Async.h"
 #include "HAL/PlatformApplicationMisc.h"
 
 #define LOCTEXT_NAMESPACE "ArticyObjectAssetPicker"
@@ -29,6 +31,7 @@
  */
 SArticyObjectAssetPicker::~SArticyObjectAssetPicker()
 {
+	CancelFilterTask();
 }
 
 /**
@@ -122,6 +125,8 @@ void SArticyObjectAssetPicker::Tick(const FGeometry& AllottedGeometry, const dou
 		RefreshSourceItems();
 		bSlowFullListRefreshRequested = false;
 	}
+
+	DrainFilterTask();
 }
 
 /**
@@ -337,47 +342,219 @@ void SArticyObjectAssetPicker::OnClear() const
 	SelectAsset(nullptr, ESelectInfo::Direct);
 }
 
+/**
+ * @brief The state of a filter run on a worker, shared by the worker and the asset picker.
+ *
+ * The worker only reads the search entries and its own copies of the filters, and hands its matches over in chunks.
+ */
+struct FArticyObjectAssetPickerFilterTask
+{
+	/** The search index the candidates belong to, kept alive while the worker runs. */
+	TSharedPtr<const FArticyObjectSearchIndex, ESPMode::ThreadSafe> SearchIndex;
+	TArray<const FArticyObjectSearchEntry*> Candidates;
+
+	/** Copies of the filters of the picker, which may change while the worker runs. */
+	TSharedPtr<FArticyClassRestrictionFilter> ClassFilter;
+	TSharedPtr<FFrontendFilter_ArticyObject> TextFilter;
+
+	/** The matches which were not added to the tile view yet. */
+	FCriticalSection PendingMatchesLock;
+	TArray<const FArticyObjectSearchEntry*> PendingMatches;
+
+	TAtomic<bool> bCancelled { false };
+	TAtomic<bool> bDone { false };
+
+	/** Tests the candidates against the filters, until all are tested or the task was cancelled. */
+	void Run()
+	{
+		TArray<const FArticyObjectSearchEntry*> Matches;
+		for (int32 ChunkStart = 0; ChunkStart < Candidates.Num() && !bCancelled; ChunkStart += FArticyObjectAssetPicketConstants::FilterChunkSize)
+		{
+			const int32 ChunkEnd = FMath::Min(ChunkStart + FArticyObjectAssetPicketConstants::FilterChunkSize, Candidates.Num());
+			for (int32 CandidateIndex = ChunkStart; CandidateIndex < ChunkEnd; ++CandidateIndex)
+			{
+				const FArticyObjectSearchEntry& Candidate = *Candidates[CandidateIndex];
+				if (ClassFilter->PassesFilter(Candidate) && (!TextFilter.IsValid() || TextFilter->PassesFilter(Candidate)))
+				{
+					Matches.Add(&Candidate);
+				}
+			}
+
+			if (Matches.Num() > 0)
+			{
+				FScopeLock Lock(&PendingMatchesLock);
+				PendingMatches.Append(Matches);
+				Matches.Reset();
+			}
+		}
+
+		bDone = true;
+	}
+};
+
 /**
  * @brief Refreshes the source items for the asset picker.
  *
- * This method retrieves and filters Articy package assets to display in the asset picker.
+ * This method filters the search index of the articy objects. If the filters only got narrower since the last
+ * refresh, e.g. because characters were appended to the search text, only the previous matches are filtered again.
+ * Otherwise the objects containing the words of a plain search text are taken from the word index.
+ * Large sets of candidates are filtered on a worker, and its matches are added to the tile view while it runs.
  */
 void SArticyObjectAssetPicker::RefreshSourceItems()
 {
-	ArticyPackageDataAssets.Reset();
+	CancelFilterTask();
 	FilteredObjects.Reset();
 
-	// Load the asset registry module
-	static const FName AssetRegistryName(TEXT("AssetRegistry"));
-	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(
-		AssetRegistryName);
+	UArticyObjectIndexSubsystem* ObjectIndex = UArticyObjectIndexSubsystem::Get();
+	if (!ObjectIndex)
+	{
+		SearchIndex.Reset();
+		MatchedEntries.Reset();
+		bMatchesComplete = false;
+		AssetView->RequestListRefresh();
+		return;
+	}
 
-	// retrieve all articy packages
+	const TSharedRef<const FArticyObjectSearchIndex, ESPMode::ThreadSafe> NewSearchIndex = ObjectIndex->GetSearchIndex();
+	const FText FilterText = ArticyObjectFilter->GetRawFilterText();
+	const UClass* FilterClass = ClassFilter->GetAllowedClass().Get();
+	const bool bFilterExactClass = ClassFilter->IsExactClass();
+
+	// The previous matches are a superset of the new ones if the index is the same and the filters only got narrower
+	const bool bNarrowed = bMatchesComplete
+		&& SearchIndex.Get() == &NewSearchIndex.Get()
+		&& MatchedClass == FilterClass
+		&& (bMatchedExactClass == bFilterExactClass || bFilterExactClass)
+		&& ArticyObjectFilter->IsNarrowerThan(MatchedFilterText);
+
+	// Plain search texts are looked up in the words of the entries, which leaves few candidates for the text filter
+	TArray<const FArticyObjectSearchEntry*> Candidates;
+	if (bNarrowed)
+	{
+		Candidates = MoveTemp(MatchedEntries);
+	}
+	else if (!NewSearchIndex->TokenIndex.FindCandidates(FilterText.ToString(), Candidates))
+	{
+		Candidates.Reserve(NewSearchIndex->NumEntries);
+		for (const TSharedRef<const TArray<FArticyObjectSearchEntry>, ESPMode::ThreadSafe>& PackageEntries : NewSearchIndex->Packages)
+		{
+			for (const FArticyObjectSearchEntry& Entry : *PackageEntries)
+			{
+				Candidates.Add(&Entry);
+			}
+		}
+	}
 
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
-	AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetClassPathName(), ArticyPackageDataAssets);
-#else
-	AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetFName(), ArticyPackageDataAssets);
-#endif
+	SearchIndex = NewSearchIndex;
+	MatchedEntries.Reset();
+	MatchedFilterText = FilterText;
+	MatchedClass = FilterClass;
+	bMatchedExactClass = bFilterExactClass;
+	bMatchesComplete = false;
 
-	// test the contained articy objects against the frontend filters
-	for (const FAssetData& ArticyPackageAssetData : ArticyPackageDataAssets)
+	if (Candidates.Num() <= FArticyObjectAssetPicketConstants::MaxSynchronousFilterCandidates)
 	{
-		UArticyPackage* ArticyPackage = Cast<UArticyPackage>(ArticyPackageAssetData.GetAsset());
-
-		for (const TWeakObjectPtr<UArticyObject> ArticyObject : ArticyPackage->GetAssets())
+		TArray<const FArticyObjectSearchEntry*> Matches;
+		for (const FArticyObjectSearchEntry* Candidate : Candidates)
 		{
-			FAssetData AssetItem(ArticyObject.Get());
-			if (ArticyObject.IsValid() && TestAgainstFrontendFilters(AssetItem))
+			if (TestAgainstFrontendFilters(*Candidate))
 			{
-				FilteredObjects.Add(ArticyObject);
+				Matches.Add(Candidate);
 			}
 		}
+
+		AddMatches(Matches);
+		bMatchesComplete = true;
+		AssetView->RequestListRefresh();
+		return;
+	}
+
+	// The worker gets its own filters, the ones of the picker change while the user types
+	FilterTask = MakeShared<FArticyObjectAssetPickerFilterTask, ESPMode::ThreadSafe>();
+	FilterTask->SearchIndex = NewSearchIndex;
+	FilterTask->Candidates = MoveTemp(Candidates);
+	FilterTask->ClassFilter = MakeShareable(new FArticyClassRestrictionFilter(ClassFilter->GetAllowedClass(), bFilterExactClass));
+	if (!FilterText.IsEmpty())
+	{
+		FilterTask->TextFilter = MakeShareable(new FFrontendFilter_ArticyObject());
+		FilterTask->TextFilter->SetIncludeClassName(ArticyObjectFilter->GetIncludeClassName());
+		FilterTask->TextFilter->SetRawFilterText(FilterText);
 	}
 
+	TSharedPtr<FArticyObjectAssetPickerFilterTask, ESPMode::ThreadSafe> Task = FilterTask;
+	Async(EAsyncExecution::ThreadPool, [Task]()
+	{
+		Task->Run();
+	});
+
 	AssetView->RequestListRefresh();
 }
 
+/**
+ * @brief Adds the matches a filter task found so far to the tile view, and finishes the task once it is done.
+ */
+void SArticyObjectAssetPicker::DrainFilterTask()
+{
+	if (!FilterTask.IsValid())
+	{
+		return;
+	}
+
+	// Read the state before taking the matches, so no matches of a finished task are left behind
+	const bool bDone = FilterTask->bDone;
+
+	TArray<const FArticyObjectSearchEntry*> Matches;
+	{
+		FScopeLock Lock(&FilterTask->PendingMatchesLock);
+		Matches = MoveTemp(FilterTask->PendingMatches);
+		FilterTask->PendingMatches.Reset();
+	}
+
+	if (Matches.Num() > 0)
+	{
+		AddMatches(Matches);
+		AssetView->RequestListRefresh();
+	}
+
+	if (bDone)
+	{
+		bMatchesComplete = true;
+		FilterTask.Reset();
+	}
+}
+
+/**
+ * @brief Cancels the running filter task, if any. The worker stops after its current chunk.
+ */
+void SArticyObjectAssetPicker::CancelFilterTask()
+{
+	if (FilterTask.IsValid())
+	{
+		FilterTask->bCancelled = true;
+		FilterTask.Reset();
+	}
+}
+
+/**
+ * @brief Adds matched search entries to the filtered objects.
+ *
+ * The objects are resolved here on the game thread, entries of objects which were destroyed meanwhile are skipped.
+ *
+ * @param Entries The matched entries.
+ */
+void SArticyObjectAssetPicker::AddMatches(const TArray<const FArticyObjectSearchEntry*>& Entries)
+{
+	MatchedEntries.Append(Entries);
+	FilteredObjects.Reserve(FilteredObjects.Num() + Entries.Num());
+	for (const FArticyObjectSearchEntry* Entry : Entries)
+	{
+		if (Entry->Object.IsValid())
+		{
+			FilteredObjects.Add(Entry->Object);
+		}
+	}
+}
+
 /**
  * @brief Sets the search box text for filtering assets.
  *
@@ -413,12 +590,12 @@ void SArticyObjectAssetPicker::OnFrontendFiltersChanged()
 }
 
 /**
- * @brief Tests an asset item against frontend filters.
+ * @brief Tests a search entry against frontend filters.
  *
- * @param Item The asset item to test.
+ * @param Item The search entry to test.
  * @return True if the item passes all filters, false otherwise.
  */
-bool SArticyObjectAssetPicker::TestAgainstFrontendFilters(const FAssetData& Item) const
+bool SArticyObjectAssetPicker::TestAgainstFrontendFilters(const FArticyObjectSearchEntry& Item) const
 {
 	if (FrontendFilters.IsValid() && !FrontendFilters->PassesAllFilters(Item))
 	{
@@ -11,6 +11,8 @@
 #include "ArticyEditorStyle.h"
 #include "Editor.h"
 #include "ArticyEditorModule.h"
+#include "ArticyObjectIndexSubsystem.h"
+#include "ArticyPreviewCacheSubsystem.h"
 #include "Slate/UserInterfaceHelperFunctions.h"
 #include "HAL/PlatformApplicationMisc.h"
 #include "Framework/MultiBox/MultiBoxBuilder.h"
@@ -29,7 +31,7 @@
 void SArticyObjectTileView::Update(const FArticyId& NewArticyId)
 {
 	CachedArticyId = NewArticyId;
-	CachedArticyObject = UArticyObject::FindAsset(CachedArticyId);
+	CachedArticyObject = UArticyObjectIndexSubsystem::FindAsset(CachedArticyId);
 
 	UpdateWidget();
 }
@@ -92,6 +94,15 @@ void SArticyObjectTileView::Construct(const FArguments& InArgs)
 
 	Update(ArticyIdToDisplay.Get(FArticyId()));
 
+	// the displayed ID only changes by events, so there is no need to poll it every frame
+	SetCanTick(false);
+	FArticyEditorModule::Get().OnAssetsGenerated.AddSP(this, &SArticyObjectTileView::OnAssetsGenerated);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.AddSP(this, &SArticyObjectTileView::OnObjectPropertyChanged);
+	if (UArticyPreviewCacheSubsystem* PreviewCache = UArticyPreviewCacheSubsystem::Get())
+	{
+		PreviewCache->OnPreviewImageLoaded.AddSP(this, &SArticyObjectTileView::OnPreviewImageLoaded);
+	}
+
 	SetToolTip(SNew(SArticyObjectToolTip).ObjectToDisplay(ArticyIdToDisplay));
 
 	this->SetOnMouseDoubleClick(InArgs._OnMouseDoubleClick);
@@ -167,20 +178,48 @@ void SArticyObjectTileView::Construct(const FArguments& InArgs)
 }
 
 /**
- * @brief Ticks the widget for updates.
+ * @brief Updates the widget if the Articy ID to display changed, or its object is not loaded anymore.
+ */
+void SArticyObjectTileView::Refresh()
+{
+	// if the Id is different from the cached Id, update the widget
+	const FArticyId CurrentId = ArticyIdToDisplay.Get(FArticyId());
+	if (CachedArticyId != CurrentId || (!CachedArticyObject.IsValid() && !CachedArticyId.IsNull()))
+	{
+		Update(CurrentId);
+	}
+}
+
+/**
+ * @brief Looks up the object again after the assets were generated, its preview or type may have changed.
+ */
+void SArticyObjectTileView::OnAssetsGenerated()
+{
+	Update(ArticyIdToDisplay.Get(FArticyId()));
+}
+
+/**
+ * @brief Refreshes the widget after a property of any object changed, which may be the displayed ID.
  *
- * This method is called each frame and updates the widget if the Articy ID has changed.
+ * @param Object The object whose property changed.
+ * @param PropertyChangedEvent The change.
+ */
+void SArticyObjectTileView::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Refresh();
+}
+
+/**
+ * @brief Replaces the placeholder with the preview image once it is loaded.
  *
- * @param AllottedGeometry The geometry of the widget.
- * @param InCurrentTime The current time.
- * @param InDeltaTime The time elapsed since the last tick.
+ * @param AssetId The ID of the articy asset of the loaded preview image.
  */
-void SArticyObjectTileView::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
+void SArticyObjectTileView::OnPreviewImageLoaded(const FArticyId& AssetId)
 {
-	// if the Id is different from the cached Id, update the widget
-	if (CachedArticyId != ArticyIdToDisplay.Get() || (!CachedArticyObject.IsValid() && !CachedArticyId.IsNull()))
+	// the type image is shown as placeholder until the preview image is loaded, other tiles ignore it
+	if (!bHasPreviewImage && CachedArticyObject.IsValid() && UserInterfaceHelperFunctions::GetPreviewImageAssetId(CachedArticyObject.Get()) == AssetId)
 	{
-		Update(ArticyIdToDisplay.Get());
+		UpdateWidget();
 	}
 }
 
@@ -15,6 +15,8 @@
 #include "Slate/UserInterfaceHelperFunctions.h"
 #include "Interfaces/ArticyObjectWithSpeaker.h"
 #include "ArticyEditorModule.h"
+#include "ArticyObjectIndexSubsystem.h"
+#include "ArticyPreviewCacheSubsystem.h"
 
 #define LOCTEXT_NAMESPACE "ArticyObjectToolTip"
 
@@ -24,6 +26,11 @@ void SArticyObjectToolTip::Construct(const FArguments& InArgs)
 
 	TooltipBrush.ImageSize = FVector2D(64.f, 64.f);
 
+	if (UArticyPreviewCacheSubsystem* PreviewCache = UArticyPreviewCacheSubsystem::Get())
+	{
+		PreviewCache->OnPreviewImageLoaded.AddSP(this, &SArticyObjectToolTip::OnPreviewImageLoaded);
+	}
+
 	SToolTip::Construct(
 		SToolTip::FArguments()
 		.TextMargin(1.f)
@@ -144,7 +151,7 @@ TSharedRef<SWidget> SArticyObjectToolTip::CreateTooltipWidget(FText NameText, TS
 		];
 }
 
-TSharedRef<SWidget> SArticyObjectToolTip::CreateToolTipContent()
+void SArticyObjectToolTip::UpdateTooltipBrush()
 {
 	// use the preview image if available
 	const bool bHasPreviewImage = UserInterfaceHelperFunctions::RetrievePreviewImage(CachedArticyObject.Get(), TooltipBrush);
@@ -154,12 +161,28 @@ TSharedRef<SWidget> SArticyObjectToolTip::CreateToolTipContent()
 	{
 		const bool bHasSpeakerPreviewImage = UserInterfaceHelperFunctions::RetrieveSpeakerPreviewImage(CachedArticyObject.Get(), TooltipBrush);
 
-		// if there is no speaker preview image, use the type image instead
+		// if there is no speaker preview image, use the type image instead; it is also the placeholder while an image loads
 		if (!bHasSpeakerPreviewImage)
 		{
 			TooltipBrush = *UserInterfaceHelperFunctions::GetArticyTypeImage(CachedArticyObject.Get(), UserInterfaceHelperFunctions::Large);
 		}
 	}
+}
+
+void SArticyObjectToolTip::OnPreviewImageLoaded(const FArticyId& AssetId)
+{
+	// the tooltip shows the preview image of the object or of its speaker, images of other objects are ignored
+	if (CachedArticyObject.IsValid()
+		&& (UserInterfaceHelperFunctions::GetPreviewImageAssetId(CachedArticyObject.Get()) == AssetId
+			|| UserInterfaceHelperFunctions::GetPreviewImageAssetId(CachedArticyObject.Get(), true) == AssetId))
+	{
+		UpdateTooltipBrush();
+	}
+}
+
+TSharedRef<SWidget> SArticyObjectToolTip::CreateToolTipContent()
+{
+	UpdateTooltipBrush();
 
 	const FString AssetName = CachedArticyObject.Get()->GetName();
 	const UClass* ClassOfObject = CachedArticyObject.Get()->UObject::GetClass();
@@ -188,7 +211,7 @@ TSharedRef<SWidget> SArticyObjectToolTip::CreateToolTipContent()
 	IArticyObjectWithSpeaker* ArticyObjectWithSpeaker = Cast<IArticyObjectWithSpeaker>(CachedArticyObject);
 	if (ArticyObjectWithSpeaker)
 	{
-		const UArticyObject* Speaker = UArticyObject::FindAsset(ArticyObjectWithSpeaker->GetSpeakerId());
+		const UArticyObject* Speaker = UArticyObjectIndexSubsystem::FindAsset(ArticyObjectWithSpeaker->GetSpeakerId());
 		// Speaker can be nullptr in case a speaker that does not exist as an entity was specified, i.e. in the scriptwriting documents
 		if (Speaker)
 		{
@@ -230,7 +253,7 @@ TSharedRef<SWidget> SArticyObjectToolTip::CreateToolTipContent()
 	const FArticyId* TargetID = UserInterfaceHelperFunctions::GetTargetID(CachedArticyObject.Get());
 	if (TargetID)
 	{
-		UArticyObject* TargetObject = UArticyObject::FindAsset(*TargetID);
+		UArticyObject* TargetObject = UArticyObjectIndexSubsystem::FindAsset(*TargetID);
 		if (TargetObject)
 		{
 			AddToToolTipInfoBox(InfoBox, LOCTEXT("ArticyObjectToolTipTarget", "Target"), FText::FromString(UserInterfaceHelperFunctions::GetDisplayName(TargetObject)), false);
@@ -303,7 +326,7 @@ void SArticyObjectToolTip::AddToToolTipInfoBox(const TSharedRef<SVerticalBox>& I
 void SArticyObjectToolTip::UpdateWidget()
 {
 	CachedArticyId = ArticyIdAttribute.Get();
-	CachedArticyObject = UArticyObject::FindAsset(CachedArticyId);
+	CachedArticyObject = UArticyObjectIndexSubsystem::FindAsset(CachedArticyId);
 
 	if (CachedArticyObject.IsValid())
 	{
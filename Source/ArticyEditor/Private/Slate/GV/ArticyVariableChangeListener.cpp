@@ -0,0 +1,42 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "Slate/GV/ArticyVariableChangeListener.h"
+#include "ArticyGlobalVariables.h"
+
+/**
+ * Starts forwarding the changes of the variables of a set.
+ *
+ * @param VariableSet The variable set to listen to.
+ */
+void UArticyVariableChangeListener::Listen(UArticyBaseVariableSet* VariableSet)
+{
+	if (VariableSet)
+	{
+		VariableSet->OnVariableChanged.AddUniqueDynamic(this, &UArticyVariableChangeListener::HandleVariableChanged);
+	}
+}
+
+/**
+ * Stops forwarding the changes of the variables of a set.
+ *
+ * @param VariableSet The variable set to stop listening to.
+ */
+void UArticyVariableChangeListener::StopListening(UArticyBaseVariableSet* VariableSet)
+{
+	if (VariableSet)
+	{
+		VariableSet->OnVariableChanged.RemoveDynamic(this, &UArticyVariableChangeListener::HandleVariableChanged);
+	}
+}
+
+/**
+ * Forwards a changed variable to the native delegate.
+ *
+ * @param Variable The changed variable.
+ */
+void UArticyVariableChangeListener::HandleVariableChanged(UArticyVariable* Variable)
+{
+	OnVariableChanged.ExecuteIfBound(Variable);
+}
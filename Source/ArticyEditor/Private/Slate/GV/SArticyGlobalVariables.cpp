@@ -8,10 +8,10 @@
 #include "Widgets/Input/SNumericEntryBox.h"
 #include "Widgets/Input/SSearchBox.h"
 #include "Widgets/Input/SCheckBox.h"
-#include "Widgets/Layout/SScrollBox.h"
 #include "Widgets/Layout/SBox.h"
 #include "Editor.h"
 #include "ScopedTransaction.h"
+#include "UObject/UObjectGlobals.h"
 
 #define LOCTEXT_NAMESPACE "ArticyGlobalVariables"
 
@@ -23,226 +23,186 @@ using SplitterSlotType = SSplitter::FSlot&;
 using HorizontalBoxSlotType = SHorizontalBox::FSlot&;
 #endif
 
-void SArticyVariableSet::Construct(const FArguments& Args, TWeakObjectPtr<UArticyBaseVariableSet> InVariableSet)
+void SArticyGlobalVariableRow::Construct(const FArguments& Args, const TSharedRef<STableViewBase>& OwnerTable, FArticyGlobalVariablesItemPtr InItem)
 {
-	VariableSet = InVariableSet;
-
-	ensure(VariableSet.IsValid());
-
+	Item = InItem;
 	SizeData = Args._SizeData;
 
-	VariableContainer = SNew(SVerticalBox);
-
-	NamespaceExpansion = SNew(SExpandableArea)
-		.InitiallyCollapsed(Args._bInitiallyCollapsed)
-		.BorderBackgroundColor(FLinearColor(0.7f, 0.7f, 0.7f))
-		.HeaderContent()
-		[
-			SNew(SHorizontalBox)
-				+ SHorizontalBox::Slot()
-				.FillWidth(1.f)
-				[
-					SNew(STextBlock)
-						.Text(FText::FromString(VariableSet->GetName()))
-						.TextStyle(FArticyEditorStyle::Get(), TEXT("ArticyImporter.GlobalVariables.Namespace"))
-				]
-		]
-		.BodyContent()
-		[
-			VariableContainer.ToSharedRef()
-		];
-
-	BuildVariableWidgets();
+	TSharedPtr<SWidget> Content;
+	if (Item->IsNamespace())
+	{
+		Content = SNew(STextBlock)
+			.Text(FText::FromString(Item->VariableSet.IsValid() ? Item->VariableSet->GetName() : FString()))
+			.TextStyle(FArticyEditorStyle::Get(), TEXT("ArticyImporter.GlobalVariables.Namespace"));
+	}
+	else
+	{
+		Refresh();
+		Content = BuildVariableWidget();
+	}
 
-	ChildSlot
+	STableRow<FArticyGlobalVariablesItemPtr>::Construct(
+		STableRow<FArticyGlobalVariablesItemPtr>::FArguments()
+		.Padding(5.f)
 		[
-			NamespaceExpansion.ToSharedRef()
-		];
+			Content.ToSharedRef()
+		],
+		OwnerTable);
 }
 
-void SArticyVariableSet::SetExpanded(bool bInExpanded) const
+void SArticyGlobalVariableRow::Refresh()
 {
-	NamespaceExpansion->SetExpanded(bInExpanded);
-}
-
-bool SArticyVariableSet::IsExpanded() const
-{
-	return NamespaceExpansion->IsExpanded();
-}
-
-void SArticyVariableSet::BuildVariableWidgets()
-{
-	if (bVariableWidgetsBuilt)
+	UArticyVariable* Var = GetVariable();
+	if (!Var)
 	{
 		return;
 	}
 
-	TArray<UArticyVariable*> SortedVars = VariableSet->Variables;
-	SortedVars.Sort([](const UArticyVariable& LHS, const UArticyVariable& RHS)
-		{
-			return LHS.GetName().Compare(RHS.GetName(), ESearchCase::IgnoreCase) < 0 ? true : false;
-		});
-
-	for (UArticyVariable* Var : SortedVars)
+	if (UArticyString* StringVar = Cast<UArticyString>(Var))
 	{
-		TSharedRef<SSplitter> LocalSplitter = SNew(SSplitter);
+		StringValue = FText::FromString(StringVar->Get());
+	}
+	else if (UArticyInt* IntVar = Cast<UArticyInt>(Var))
+	{
+		IntValue = IntVar->Get();
+	}
+	else if (UArticyBool* BoolVar = Cast<UArticyBool>(Var))
+	{
+		BoolValue = BoolVar->Get() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+	}
+}
 
-		// left variable slot
-		LocalSplitter->AddSlot()
-			.Value(SizeData->LeftColumnWidth)
-			.OnSlotResized(SizeData->OnWidthChanged)
-			[
-				SNew(STextBlock).Text_Lambda([Var]()
-					{
-						return FText::FromString(Var->GetName());
-					})
-			];
+TSharedRef<SWidget> SArticyGlobalVariableRow::BuildVariableWidget()
+{
+	UArticyVariable* Var = GetVariable();
 
-		// right variable slot
-		SplitterSlotType RightVariableSlot = LocalSplitter->AddSlot();
-		RightVariableSlot.Value(SizeData->RightColumnWidth);
-		RightVariableSlot.OnSlotResized(SizeData->OnWidthChanged);
+	TSharedRef<SSplitter> LocalSplitter = SNew(SSplitter);
 
-		TSharedRef<SHorizontalBox> ConstrainBox = SNew(SHorizontalBox);
-		HorizontalBoxSlotType InnerVarSlot = ConstrainBox->AddSlot();
-		InnerVarSlot.AutoWidth();
+	// left variable slot
+	LocalSplitter->AddSlot()
+		.Value(SizeData->LeftColumnWidth)
+		.OnSlotResized(SizeData->OnWidthChanged)
+		[
+			SNew(STextBlock).Text(FText::FromString(Var->GetName()))
+		];
 
-		RightVariableSlot
-			[
-				SNew(SBox)
-					.MinDesiredWidth(150.f)
-					.MaxDesiredWidth(300.f)
-					[
-						ConstrainBox
-					]
-			];
+	// right variable slot
+	SplitterSlotType RightVariableSlot = LocalSplitter->AddSlot();
+	RightVariableSlot.Value(SizeData->RightColumnWidth);
+	RightVariableSlot.OnSlotResized(SizeData->OnWidthChanged);
 
-		if (Var->GetClass() == UArticyString::StaticClass())
-		{
-			UArticyString* StringVar = Cast<UArticyString>(Var);
-			InnerVarSlot
+	TSharedRef<SHorizontalBox> ConstrainBox = SNew(SHorizontalBox);
+	HorizontalBoxSlotType InnerVarSlot = ConstrainBox->AddSlot();
+	InnerVarSlot.AutoWidth();
+
+	RightVariableSlot
+		[
+			SNew(SBox)
+				.MinDesiredWidth(150.f)
+				.MaxDesiredWidth(300.f)
 				[
-					SNew(SEditableTextBox)
-						.MinDesiredWidth(30.f)
-						.Text_Lambda([StringVar]()
-							{
-								return FText::FromString(StringVar->Get());
-							})
-						.OnTextCommitted_Lambda([StringVar](const FText& Text, ETextCommit::Type CommitType)
+					ConstrainBox
+				]
+		];
+
+	if (Var->GetClass() == UArticyString::StaticClass())
+	{
+		UArticyString* StringVar = Cast<UArticyString>(Var);
+		InnerVarSlot
+			[
+				SNew(SEditableTextBox)
+					.MinDesiredWidth(30.f)
+					.Text(this, &SArticyGlobalVariableRow::GetStringValue)
+					.OnTextCommitted_Lambda([StringVar](const FText& Text, ETextCommit::Type CommitType)
+						{
+							if (StringVar->Get().Equals(Text.ToString()))
 							{
-								if (StringVar->Get().Equals(Text.ToString()))
-								{
-									return;
-								}
-
-								const FScopedTransaction Transaction(LOCTEXT("ModifyGV", "Modified GV"));
-								StringVar->Modify();
-								*StringVar = Text.ToString();
-							})
-				];
-		}
-		else if (Var->GetClass() == UArticyInt::StaticClass())
-		{
-			UArticyInt* IntVar = Cast<UArticyInt>(Var);
-			InnerVarSlot
-				[
-					SNew(SNumericEntryBox<int32>)
-						.AllowSpin(true)
-						.MaxSliderValue(TOptional<int32>())
-						.MinSliderValue(TOptional<int32>())
-						.MinDesiredValueWidth(80.f)
+								return;
+							}
+
+							const FScopedTransaction Transaction(LOCTEXT("ModifyGV", "Modified GV"));
+							StringVar->Modify();
+							*StringVar = Text.ToString();
+						})
+			];
+	}
+	else if (Var->GetClass() == UArticyInt::StaticClass())
+	{
+		UArticyInt* IntVar = Cast<UArticyInt>(Var);
+		InnerVarSlot
+			[
+				SNew(SNumericEntryBox<int32>)
+					.AllowSpin(true)
+					.MaxSliderValue(TOptional<int32>())
+					.MinSliderValue(TOptional<int32>())
+					.MinDesiredValueWidth(80.f)
 #if __cplusplus >= 202002L
-						.OnBeginSliderMovement_Lambda([=, this]()
+					.OnBeginSliderMovement_Lambda([=, this]()
 #else
-							.OnBeginSliderMovement_Lambda([=]()
+					.OnBeginSliderMovement_Lambda([=]()
 #endif
-								{
-									bSliderMoving = true;
-									GEditor->BeginTransaction(TEXT("Articy GV"), FText::FromString(TEXT("Modify Articy GV by Slider")), IntVar);
-								})
+						{
+							bSliderMoving = true;
+							GEditor->BeginTransaction(TEXT("Articy GV"), FText::FromString(TEXT("Modify Articy GV by Slider")), IntVar);
+						})
 #if __cplusplus >= 202002L
-							.OnEndSliderMovement_Lambda([=, this](int32 Value)
+					.OnEndSliderMovement_Lambda([=, this](int32 Value)
 #else
-								.OnEndSliderMovement_Lambda([=](int32 Value)
+					.OnEndSliderMovement_Lambda([=](int32 Value)
 #endif
-									{
-										bSliderMoving = false;
-										IntVar->Modify();
-										*IntVar = Value;
-										GEditor->EndTransaction();
-									})
-								.Value_Lambda([IntVar]()
-									{
-										return IntVar->Get();
-									})
-										// on value changed is only used for slider value updates
-										.OnValueChanged(this, &SArticyVariableSet::OnValueChanged, IntVar)
+						{
+							bSliderMoving = false;
+							IntVar->Modify();
+							*IntVar = Value;
+							GEditor->EndTransaction();
+						})
+					.Value(this, &SArticyGlobalVariableRow::GetIntValue)
+					// on value changed is only used for slider value updates
+					.OnValueChanged(this, &SArticyGlobalVariableRow::OnValueChanged, IntVar)
 #if __cplusplus >= 202002L
-										.OnValueCommitted_Lambda([=, this](int32 Value, ETextCommit::Type Type)
+					.OnValueCommitted_Lambda([=, this](int32 Value, ETextCommit::Type Type)
 #else
-											.OnValueCommitted_Lambda([=](int32 Value, ETextCommit::Type Type)
+					.OnValueCommitted_Lambda([=](int32 Value, ETextCommit::Type Type)
 #endif
-												{
-													if (bSliderMoving || Value == IntVar->Get())
-													{
-														return;
-													}
-
-													const FScopedTransaction Transaction(LOCTEXT("ModifyGV", "Modified GV"));
-													IntVar->Modify();
-													*IntVar = Value;
-												})
-				];
-		}
-		else if (Var->GetClass() == UArticyBool::StaticClass())
-		{
-			UArticyBool* BoolVar = Cast<UArticyBool>(Var);
-			InnerVarSlot
-				[
-					SNew(SCheckBox)
-						.IsChecked_Lambda([BoolVar]()
-							{
-								return BoolVar->Get() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
-							})
-						.OnCheckStateChanged_Lambda([BoolVar](const ECheckBoxState& State)
+						{
+							if (bSliderMoving || Value == IntVar->Get())
 							{
-								if (*BoolVar == (State == ECheckBoxState::Checked))
-								{
-									return;
-								}
-
-								const FScopedTransaction Transaction(TEXT("ArticyGV"), LOCTEXT("ModifyGV", "Modified GV"), BoolVar);
-								bool bSavedInTranactionBuffer = BoolVar->Modify();
-								*BoolVar = State == ECheckBoxState::Checked;
-							})
-				];
-		}
+								return;
+							}
 
-		VariableWidgetMapping.Add(Var, LocalSplitter);
-
-		VariableContainer->AddSlot()
-			.AutoHeight()
-			.Padding(25.f, 5.f, 5.f, 5.f)
-			[
-				LocalSplitter
+							const FScopedTransaction Transaction(LOCTEXT("ModifyGV", "Modified GV"));
+							IntVar->Modify();
+							*IntVar = Value;
+						})
 			];
 	}
-
-	bVariableWidgetsBuilt = true;
-}
-
-void SArticyVariableSet::UpdateVisibility(const UArticyVariable* Variable, EVisibility InVisibility)
-{
-	if (VariableWidgetMapping.Contains(Variable))
+	else if (Var->GetClass() == UArticyBool::StaticClass())
 	{
-		TWeakPtr<SWidget> VarWidget = VariableWidgetMapping[Variable];
-		VarWidget.Pin()->SetVisibility(InVisibility);
+		UArticyBool* BoolVar = Cast<UArticyBool>(Var);
+		InnerVarSlot
+			[
+				SNew(SCheckBox)
+					.IsChecked(this, &SArticyGlobalVariableRow::GetBoolValue)
+					.OnCheckStateChanged_Lambda([BoolVar](const ECheckBoxState& State)
+						{
+							if (*BoolVar == (State == ECheckBoxState::Checked))
+							{
+								return;
+							}
+
+							const FScopedTransaction Transaction(TEXT("ArticyGV"), LOCTEXT("ModifyGV", "Modified GV"), BoolVar);
+							bool bSavedInTranactionBuffer = BoolVar->Modify();
+							*BoolVar = State == ECheckBoxState::Checked;
+						})
+			];
 	}
+
+	return LocalSplitter;
 }
 
-TArray<UArticyVariable*> SArticyVariableSet::GetVariables()
+SArticyGlobalVariables::~SArticyGlobalVariables()
 {
-	return VariableSet->GetVariables();
+	StopListening();
 }
 
 void SArticyGlobalVariables::Construct(const FArguments& Args, TWeakObjectPtr<UArticyGlobalVariables> GV)
@@ -259,14 +219,21 @@ void SArticyGlobalVariables::Construct(const FArguments& Args, TWeakObjectPtr<UA
 
 	bInitiallyCollapsed = Args._bInitiallyCollapsed;
 
+	ChangeListener.Reset(NewObject<UArticyVariableChangeListener>());
+	ChangeListener->OnVariableChanged.BindSP(this, &SArticyGlobalVariables::OnVariableChanged);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.AddSP(this, &SArticyGlobalVariables::OnObjectPropertyChanged);
+
+	// a namespace without gathered variables only needs any child to be expandable, the placeholder is never shown
+	PlaceholderChildren.Add(MakeShared<FArticyGlobalVariablesItem>());
+
 	TSharedRef<SVerticalBox> ParentWidget = SNew(SVerticalBox);
-	SetContainer = SNew(SVerticalBox);
 
-	TSharedRef<SScrollBox> ScrollBox = SNew(SScrollBox).ScrollBarAlwaysVisible(true)
-		+ SScrollBox::Slot()
-		[
-			SetContainer.ToSharedRef()
-		];
+	TreeView = SNew(STreeView<FArticyGlobalVariablesItemPtr>)
+		.TreeItemsSource(&RootItems)
+		.SelectionMode(ESelectionMode::None)
+		.OnGenerateRow(this, &SArticyGlobalVariables::OnGenerateRow)
+		.OnGetChildren(this, &SArticyGlobalVariables::OnGetChildren)
+		.OnRowReleased(this, &SArticyGlobalVariables::OnRowReleased);
 
 	if (GlobalVariables.IsValid())
 	{
@@ -279,7 +246,7 @@ void SArticyGlobalVariables::Construct(const FArguments& Args, TWeakObjectPtr<UA
 		.DelayChangeNotificationsWhileTyping(true);
 
 	ParentWidget->AddSlot().AutoHeight()[SearchBox];
-	ParentWidget->AddSlot().FillHeight(1.f)[ScrollBox];
+	ParentWidget->AddSlot().FillHeight(1.f)[TreeView.ToSharedRef()];
 
 	ChildSlot
 		[
@@ -291,11 +258,22 @@ void SArticyGlobalVariables::Construct(const FArguments& Args, TWeakObjectPtr<UA
 
 void SArticyGlobalVariables::UpdateDisplayedGlobalVariables(TWeakObjectPtr<UArticyGlobalVariables> InGV)
 {
-	VariableSetWidgets.Empty();
-	SetContainer->ClearChildren();
+	// keep the expansion states of the namespaces if other global variables of the same project are displayed
+	const bool bRestoreExpansion = NamespaceItems.Num() > 0 && FrontendFilters->Num() == 0;
+	if (bRestoreExpansion)
+	{
+		CacheExpansionStates();
+	}
+
+	StopListening();
+	NamespaceItems.Empty();
+	RootItems.Empty();
+	VariableRows.Empty();
+	TreeView->ClearExpandedItems();
 
 	if (!InGV.IsValid())
 	{
+		TreeView->RequestTreeRefresh();
 		return;
 	}
 
@@ -307,22 +285,149 @@ void SArticyGlobalVariables::UpdateDisplayedGlobalVariables(TWeakObjectPtr<UArti
 
 	for (UArticyBaseVariableSet* Set : SortedSets)
 	{
-		TSharedRef<SArticyVariableSet> VarSetWidget = SNew(SArticyVariableSet, Set)
-			.bInitiallyCollapsed(bInitiallyCollapsed)
-			.SizeData(&SizeData);
+		FArticyGlobalVariablesItemPtr NamespaceItem = MakeShared<FArticyGlobalVariablesItem>();
+		NamespaceItem->VariableSet = Set;
+		NamespaceItems.Add(NamespaceItem);
 
-		VariableSetWidgets.Add(VarSetWidget);
+		ChangeListener->Listen(Set);
 
-		SetContainer->AddSlot().AutoHeight()
-			[
-				VarSetWidget
-			];
+		if (!bRestoreExpansion)
+		{
+			TreeView->SetItemExpansion(NamespaceItem, !bInitiallyCollapsed);
+		}
+	}
+
+	if (bRestoreExpansion)
+	{
+		RestoreExpansionStates();
 	}
 
 	// retrigger the currently active filters
 	FrontendFilters->OnChanged().Broadcast();
 }
 
+TSharedRef<ITableRow> SArticyGlobalVariables::OnGenerateRow(FArticyGlobalVariablesItemPtr Item, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	TSharedRef<SArticyGlobalVariableRow> Row = SNew(SArticyGlobalVariableRow, OwnerTable, Item)
+		.SizeData(&SizeData);
+
+	if (const UArticyVariable* Var = Row->GetVariable())
+	{
+		VariableRows.Add(Var, Row);
+	}
+
+	return Row;
+}
+
+void SArticyGlobalVariables::OnRowReleased(const TSharedRef<ITableRow>& Row)
+{
+	const TSharedRef<SArticyGlobalVariableRow> VariableRow = StaticCastSharedRef<SArticyGlobalVariableRow>(Row);
+	if (const UArticyVariable* Var = VariableRow->GetVariable())
+	{
+		// the variable may already be in view again with a new row
+		const TWeakPtr<SArticyGlobalVariableRow>* Mapped = VariableRows.Find(Var);
+		if (Mapped && Mapped->Pin() == VariableRow)
+		{
+			VariableRows.Remove(Var);
+		}
+	}
+}
+
+void SArticyGlobalVariables::OnGetChildren(FArticyGlobalVariablesItemPtr Item, TArray<FArticyGlobalVariablesItemPtr>& OutChildren)
+{
+	if (!Item->IsNamespace())
+	{
+		return;
+	}
+
+	if (!Item->bVariablesGathered)
+	{
+		// the tree asks for the children of collapsed items too, only gather them once they are displayed
+		if (!TreeView->IsItemExpanded(Item))
+		{
+			if (Item->VariableSet.IsValid() && Item->VariableSet->GetVariables().Num() > 0)
+			{
+				OutChildren = PlaceholderChildren;
+			}
+			return;
+		}
+
+		GatherVariables(Item);
+	}
+
+	OutChildren = Item->Children;
+}
+
+void SArticyGlobalVariables::GatherVariables(const FArticyGlobalVariablesItemPtr& NamespaceItem) const
+{
+	if (NamespaceItem->bVariablesGathered)
+	{
+		return;
+	}
+
+	NamespaceItem->bVariablesGathered = true;
+
+	if (!NamespaceItem->VariableSet.IsValid())
+	{
+		return;
+	}
+
+	TArray<UArticyVariable*> SortedVars = NamespaceItem->VariableSet->Variables;
+	SortedVars.Sort([](const UArticyVariable& LHS, const UArticyVariable& RHS)
+		{
+			return LHS.GetName().Compare(RHS.GetName(), ESearchCase::IgnoreCase) < 0 ? true : false;
+		});
+
+	NamespaceItem->Variables.Reserve(SortedVars.Num());
+	for (UArticyVariable* Var : SortedVars)
+	{
+		FArticyGlobalVariablesItemPtr VariableItem = MakeShared<FArticyGlobalVariablesItem>();
+		VariableItem->VariableSet = NamespaceItem->VariableSet;
+		VariableItem->Variable = Var;
+		NamespaceItem->Variables.Add(VariableItem);
+	}
+
+	ApplyFilters(NamespaceItem);
+}
+
+void SArticyGlobalVariables::ApplyFilters(const FArticyGlobalVariablesItemPtr& NamespaceItem) const
+{
+	if (FrontendFilters->Num() == 0)
+	{
+		NamespaceItem->Children = NamespaceItem->Variables;
+		return;
+	}
+
+	NamespaceItem->Children.Reset();
+	for (const FArticyGlobalVariablesItemPtr& VariableItem : NamespaceItem->Variables)
+	{
+		if (TestAgainstFrontendFilters(VariableItem->Variable.Get()))
+		{
+			NamespaceItem->Children.Add(VariableItem);
+		}
+	}
+}
+
+void SArticyGlobalVariables::OnVariableChanged(UArticyVariable* Variable)
+{
+	if (const TWeakPtr<SArticyGlobalVariableRow>* Row = VariableRows.Find(Variable))
+	{
+		if (TSharedPtr<SArticyGlobalVariableRow> PinnedRow = Row->Pin())
+		{
+			PinnedRow->Refresh();
+		}
+	}
+}
+
+void SArticyGlobalVariables::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	// undo and redo restore the values without broadcasting OnVariableChanged
+	if (UArticyVariable* Var = Cast<UArticyVariable>(Object))
+	{
+		OnVariableChanged(Var);
+	}
+}
+
 void SArticyGlobalVariables::OnSearchBoxChanged(const FText& InSearchText)
 {
 	SetSearchBoxText(InSearchText);
@@ -365,39 +470,38 @@ void SArticyGlobalVariables::OnFrontendFiltersChanged()
 		bShouldForceExpand = false;
 	}
 
-	for (TSharedPtr<SArticyVariableSet> SetWidget : VariableSetWidgets)
+	RootItems.Reset();
+	for (const FArticyGlobalVariablesItemPtr& NamespaceItem : NamespaceItems)
 	{
-		uint32 NumVisible = 0;
-		TArray<UArticyVariable*> Vars = SetWidget->GetVariables();
+		// filtering needs all variables, without filters the namespace keeps gathering them on expansion
+		if (bShouldForceExpand)
+		{
+			GatherVariables(NamespaceItem);
+		}
 
-		for (UArticyVariable* Var : Vars)
+		if (!NamespaceItem->bVariablesGathered)
 		{
-			const UArticyVariable* VarTmp = Var;
-			if (TestAgainstFrontendFilters(Var))
+			if (NamespaceItem->VariableSet.IsValid() && NamespaceItem->VariableSet->GetVariables().Num() > 0)
 			{
-				SetWidget->UpdateVisibility(VarTmp, EVisibility::Visible);
-				NumVisible++;
-			}
-			else
-			{
-				SetWidget->UpdateVisibility(VarTmp, EVisibility::Collapsed);
+				RootItems.Add(NamespaceItem);
 			}
+			continue;
 		}
 
-		if (NumVisible > 0)
+		ApplyFilters(NamespaceItem);
+
+		if (NamespaceItem->Children.Num() > 0)
 		{
 			if (bShouldForceExpand)
 			{
-				SetWidget->SetExpanded(true);
+				TreeView->SetItemExpansion(NamespaceItem, true);
 			}
 
-			SetWidget->SetVisibility(EVisibility::Visible);
-		}
-		else
-		{
-			SetWidget->SetVisibility(EVisibility::Collapsed);
+			RootItems.Add(NamespaceItem);
 		}
 	}
+
+	TreeView->RequestTreeRefresh();
 }
 
 bool SArticyGlobalVariables::TestAgainstFrontendFilters(const UArticyVariable* Item) const
@@ -412,18 +516,36 @@ bool SArticyGlobalVariables::TestAgainstFrontendFilters(const UArticyVariable* I
 
 void SArticyGlobalVariables::CacheExpansionStates()
 {
-	for (TSharedPtr<SArticyVariableSet>& SetWidget : VariableSetWidgets)
+	ExpansionCache.Reset();
+	for (const FArticyGlobalVariablesItemPtr& NamespaceItem : NamespaceItems)
 	{
-		ExpansionCache.Add(SetWidget, SetWidget->IsExpanded());
+		if (NamespaceItem->VariableSet.IsValid())
+		{
+			ExpansionCache.Add(NamespaceItem->VariableSet->GetName(), TreeView->IsItemExpanded(NamespaceItem));
+		}
 	}
 }
 
 void SArticyGlobalVariables::RestoreExpansionStates()
 {
 	// restore the previous expansion state from the forced expansion
-	for (auto It = ExpansionCache.CreateIterator(); It; ++It)
+	for (const FArticyGlobalVariablesItemPtr& NamespaceItem : NamespaceItems)
+	{
+		const bool* bExpanded = NamespaceItem->VariableSet.IsValid() ? ExpansionCache.Find(NamespaceItem->VariableSet->GetName()) : nullptr;
+		TreeView->SetItemExpansion(NamespaceItem, bExpanded ? *bExpanded : !bInitiallyCollapsed);
+	}
+}
+
+void SArticyGlobalVariables::StopListening()
+{
+	if (!ChangeListener.IsValid())
+	{
+		return;
+	}
+
+	for (const FArticyGlobalVariablesItemPtr& NamespaceItem : NamespaceItems)
 	{
-		It.Key()->SetExpanded(It.Value());
+		ChangeListener->StopListening(NamespaceItem->VariableSet.Get());
 	}
 }
 
@@ -0,0 +1,372 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "Slate/GV/SArticyGvProfiler.h"
+#include "ArticyDatabase.h"
+#include "ArticyScriptProfiler.h"
+#include "Editor.h"
+#include "HAL/IConsoleManager.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SCheckBox.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Views/STableRow.h"
+
+#define LOCTEXT_NAMESPACE "ArticyGvProfiler"
+
+namespace
+{
+	const FName VariableColumn(TEXT("Variable"));
+	const FName FragmentColumn(TEXT("Fragment"));
+	const FName OwnerColumn(TEXT("Owner"));
+	const FName TextColumn(TEXT("Text"));
+	const FName ReadsColumn(TEXT("Reads"));
+	const FName ShadowedReadsColumn(TEXT("ShadowedReads"));
+	const FName WritesColumn(TEXT("Writes"));
+	const FName ShadowedWritesColumn(TEXT("ShadowedWrites"));
+	const FName TotalColumn(TEXT("Total"));
+
+	/** Returns the count of an item shown in a column, 0 for the text columns. */
+	uint64 GetCount(const FArticyGvProfilerItem& Item, const FName& Column)
+	{
+		const FArticyGvProfiler::FAccessCounts& Counts = Item.Row.Counts;
+		if (Column == ReadsColumn)
+			return Counts.Reads;
+		if (Column == ShadowedReadsColumn)
+			return Counts.ShadowedReads;
+		if (Column == WritesColumn)
+			return Counts.Writes;
+		if (Column == ShadowedWritesColumn)
+			return Counts.ShadowedWrites;
+		return Counts.GetTotal();
+	}
+
+	/** Returns the text of an item shown in a column. */
+	FString GetLabel(const FArticyGvProfilerItem& Item, const FName& Column)
+	{
+		if (Column == VariableColumn)
+			return Item.Row.Variable.ToString();
+		if (Column == FragmentColumn)
+			return !Item.Row.bInScript ? FString(TEXT("(outside scripts)")) : FString::Printf(TEXT("%s %d"), Item.Row.bInstruction ? TEXT("instruction") : TEXT("condition"), Item.Row.FragmentHash);
+		if (Column == OwnerColumn)
+			return Item.Owner;
+		if (Column == TextColumn)
+			return Item.Text;
+		return FString::Printf(TEXT("%llu"), GetCount(Item, Column));
+	}
+
+	/** A row of the table. */
+	class SArticyGvProfilerRow : public SMultiColumnTableRow<TSharedPtr<FArticyGvProfilerItem>>
+	{
+	public:
+		SLATE_BEGIN_ARGS(SArticyGvProfilerRow) {}
+		SLATE_END_ARGS()
+
+		void Construct(const FArguments& Args, const TSharedRef<STableViewBase>& OwnerTable, TSharedPtr<FArticyGvProfilerItem> InItem)
+		{
+			Item = InItem;
+			SMultiColumnTableRow<TSharedPtr<FArticyGvProfilerItem>>::Construct(FSuperRowType::FArguments(), OwnerTable);
+		}
+
+		virtual TSharedRef<SWidget> GenerateWidgetForColumn(const FName& ColumnName) override
+		{
+			return SNew(SBox)
+				.Padding(FMargin(4.f, 1.f))
+				[
+					SNew(STextBlock)
+					.Text(FText::FromString(GetLabel(*Item, ColumnName)))
+					.ToolTipText(ColumnName == TextColumn ? FText::FromString(Item->Text) : FText::GetEmpty())
+				];
+		}
+
+	private:
+		TSharedPtr<FArticyGvProfilerItem> Item;
+	};
+}
+
+/**
+ * Constructs the GV profiler widget.
+ *
+ * @param Args The construction arguments.
+ */
+void SArticyGvProfiler::Construct(const FArguments& Args)
+{
+	SortColumn = TotalColumn;
+
+	ChildSlot
+	[
+		SNew(SVerticalBox)
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(4.f)
+		[
+			SNew(SHorizontalBox)
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			.Padding(0.f, 0.f, 8.f, 0.f)
+			[
+				SNew(SCheckBox)
+				.IsChecked(this, &SArticyGvProfiler::IsRecording)
+				.OnCheckStateChanged(this, &SArticyGvProfiler::OnRecordingChanged)
+				[
+					SNew(STextBlock).Text(LOCTEXT("Record", "Record (Articy.ProfileGVs)"))
+				]
+			]
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			.Padding(0.f, 0.f, 4.f, 0.f)
+			[
+				SNew(SButton)
+				.Text(LOCTEXT("Refresh", "Refresh"))
+				.OnClicked_Lambda([this]() { Refresh(); return FReply::Handled(); })
+			]
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			.Padding(0.f, 0.f, 4.f, 0.f)
+			[
+				SNew(SButton)
+				.Text(LOCTEXT("Reset", "Reset"))
+				.OnClicked(this, &SArticyGvProfiler::OnReset)
+			]
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			[
+				SNew(SButton)
+				.Text(LOCTEXT("ExportCsv", "Export CSV"))
+				.ToolTipText(LOCTEXT("ExportCsvTooltip", "Writes the table to Saved/Articy/Profiles/GVProfile.csv"))
+				.OnClicked(this, &SArticyGvProfiler::OnExportCsv)
+			]
+		]
+		+ SVerticalBox::Slot()
+		.FillHeight(1.f)
+		[
+			SAssignNew(ListView, SListView<TSharedPtr<FArticyGvProfilerItem>>)
+			.ListItemsSource(&Items)
+			.OnGenerateRow(this, &SArticyGvProfiler::OnGenerateRow)
+			.SelectionMode(ESelectionMode::Single)
+			.HeaderRow
+			(
+				SNew(SHeaderRow)
+				+ SHeaderRow::Column(VariableColumn)
+				.DefaultLabel(LOCTEXT("VariableColumn", "Variable"))
+				.FillWidth(2.f)
+				.SortMode(this, &SArticyGvProfiler::GetSortMode, VariableColumn)
+				.OnSort(this, &SArticyGvProfiler::OnSortColumn)
+				+ SHeaderRow::Column(FragmentColumn)
+				.DefaultLabel(LOCTEXT("FragmentColumn", "Fragment"))
+				.FillWidth(1.5f)
+				.SortMode(this, &SArticyGvProfiler::GetSortMode, FragmentColumn)
+				.OnSort(this, &SArticyGvProfiler::OnSortColumn)
+				+ SHeaderRow::Column(OwnerColumn)
+				.DefaultLabel(LOCTEXT("OwnerColumn", "Owner"))
+				.FillWidth(1.5f)
+				.SortMode(this, &SArticyGvProfiler::GetSortMode, OwnerColumn)
+				.OnSort(this, &SArticyGvProfiler::OnSortColumn)
+				+ SHeaderRow::Column(TextColumn)
+				.DefaultLabel(LOCTEXT("TextColumn", "Text"))
+				.FillWidth(3.f)
+				.SortMode(this, &SArticyGvProfiler::GetSortMode, TextColumn)
+				.OnSort(this, &SArticyGvProfiler::OnSortColumn)
+				+ SHeaderRow::Column(ReadsColumn)
+				.DefaultLabel(LOCTEXT("ReadsColumn", "Reads"))
+				.FillWidth(1.f)
+				.SortMode(this, &SArticyGvProfiler::GetSortMode, ReadsColumn)
+				.OnSort(this, &SArticyGvProfiler::OnSortColumn)
+				+ SHeaderRow::Column(ShadowedReadsColumn)
+				.DefaultLabel(LOCTEXT("ShadowedReadsColumn", "Shadowed Reads"))
+				.FillWidth(1.f)
+				.SortMode(this, &SArticyGvProfiler::GetSortMode, ShadowedReadsColumn)
+				.OnSort(this, &SArticyGvProfiler::OnSortColumn)
+				+ SHeaderRow::Column(WritesColumn)
+				.DefaultLabel(LOCTEXT("WritesColumn", "Writes"))
+				.FillWidth(1.f)
+				.SortMode(this, &SArticyGvProfiler::GetSortMode, WritesColumn)
+				.OnSort(this, &SArticyGvProfiler::OnSortColumn)
+				+ SHeaderRow::Column(ShadowedWritesColumn)
+				.DefaultLabel(LOCTEXT("ShadowedWritesColumn", "Shadowed Writes"))
+				.FillWidth(1.f)
+				.SortMode(this, &SArticyGvProfiler::GetSortMode, ShadowedWritesColumn)
+				.OnSort(this, &SArticyGvProfiler::OnSortColumn)
+				+ SHeaderRow::Column(TotalColumn)
+				.DefaultLabel(LOCTEXT("TotalColumn", "Total"))
+				.FillWidth(1.f)
+				.SortMode(this, &SArticyGvProfiler::GetSortMode, TotalColumn)
+				.OnSort(this, &SArticyGvProfiler::OnSortColumn)
+			)
+		]
+	];
+
+	Refresh();
+}
+
+/**
+ * Refreshes the table once per second while recording.
+ *
+ * @param AllottedGeometry The geometry of the widget.
+ * @param InCurrentTime The current time.
+ * @param InDeltaTime The time since the last tick.
+ */
+void SArticyGvProfiler::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
+{
+	SCompoundWidget::Tick(AllottedGeometry, InCurrentTime, InDeltaTime);
+
+	TimeSinceRefresh += InDeltaTime;
+	if (FArticyGvProfiler::IsEnabled() && TimeSinceRefresh >= 1.f)
+		Refresh();
+}
+
+/**
+ * Reads the rows of the profiler again, with the owner and text of their fragments in the database of the play session.
+ */
+void SArticyGvProfiler::Refresh()
+{
+	TimeSinceRefresh = 0.f;
+
+	const TArray<FArticyGvProfiler::FRow> Rows = FArticyGvProfiler::GetRows();
+
+	TSet<int32> Hashes;
+	for (const FArticyGvProfiler::FRow& Row : Rows)
+	{
+		if (Row.bInScript)
+			Hashes.Add(Row.FragmentHash);
+	}
+	const TMap<int32, TPair<FString, FString>> Sources = FArticyScriptProfiler::FindSources(GetPlayDatabase(), Hashes);
+
+	Items.Reset(Rows.Num());
+	for (const FArticyGvProfiler::FRow& Row : Rows)
+	{
+		TSharedPtr<FArticyGvProfilerItem> Item = MakeShared<FArticyGvProfilerItem>();
+		Item->Row = Row;
+		if (const TPair<FString, FString>* Source = Row.bInScript ? Sources.Find(Row.FragmentHash) : nullptr)
+		{
+			Item->Owner = Source->Key;
+			Item->Text = Source->Value.Replace(TEXT("\n"), TEXT(" "));
+		}
+		Items.Add(Item);
+	}
+
+	SortItems();
+}
+
+/**
+ * Sorts the items by the current sort column, the counts numerically and the other columns by their text.
+ */
+void SArticyGvProfiler::SortItems()
+{
+	const bool bAscending = SortMode == EColumnSortMode::Ascending;
+	const bool bTextColumn = SortColumn == VariableColumn || SortColumn == FragmentColumn || SortColumn == OwnerColumn || SortColumn == TextColumn;
+	const FName Column = SortColumn;
+
+	Items.StableSort([bAscending, bTextColumn, Column](const TSharedPtr<FArticyGvProfilerItem>& A, const TSharedPtr<FArticyGvProfilerItem>& B)
+	{
+		if (bTextColumn)
+		{
+			const int32 Compare = GetLabel(*A, Column).Compare(GetLabel(*B, Column), ESearchCase::IgnoreCase);
+			return bAscending ? Compare < 0 : Compare > 0;
+		}
+
+		const uint64 CountA = GetCount(*A, Column);
+		const uint64 CountB = GetCount(*B, Column);
+		return bAscending ? CountA < CountB : CountA > CountB;
+	});
+
+	if (ListView.IsValid())
+		ListView->RequestListRefresh();
+}
+
+/**
+ * Sorts the table by the clicked column.
+ *
+ * @param SortPriority Unused, the table is sorted by one column.
+ * @param ColumnId The column clicked.
+ * @param NewSortMode The new sort mode of the column.
+ */
+void SArticyGvProfiler::OnSortColumn(EColumnSortPriority::Type SortPriority, const FName& ColumnId, EColumnSortMode::Type NewSortMode)
+{
+	SortColumn = ColumnId;
+	SortMode = NewSortMode;
+	SortItems();
+}
+
+/**
+ * Returns the sort mode of a column.
+ *
+ * @param ColumnId The column.
+ * @return The sort mode, or none if the table is sorted by another column.
+ */
+EColumnSortMode::Type SArticyGvProfiler::GetSortMode(FName ColumnId) const
+{
+	return ColumnId == SortColumn ? SortMode : EColumnSortMode::None;
+}
+
+/**
+ * Generates the widget of a row.
+ *
+ * @param Item The item of the row.
+ * @param OwnerTable The table.
+ * @return The row widget.
+ */
+TSharedRef<ITableRow> SArticyGvProfiler::OnGenerateRow(TSharedPtr<FArticyGvProfilerItem> Item, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	return SNew(SArticyGvProfilerRow, OwnerTable, Item);
+}
+
+/**
+ * Enables or disables the recording through the console variable, so the console shows the same state.
+ *
+ * @param NewState The new state of the checkbox.
+ */
+void SArticyGvProfiler::OnRecordingChanged(ECheckBoxState NewState)
+{
+	if (IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(TEXT("Articy.ProfileGVs")))
+		Variable->Set(NewState == ECheckBoxState::Checked);
+}
+
+/**
+ * Returns whether the accesses are recorded.
+ *
+ * @return The state of the checkbox.
+ */
+ECheckBoxState SArticyGvProfiler::IsRecording() const
+{
+	return FArticyGvProfiler::IsEnabled() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+}
+
+/**
+ * Discards the recorded counts.
+ *
+ * @return Handled.
+ */
+FReply SArticyGvProfiler::OnReset()
+{
+	FArticyGvProfiler::Reset();
+	Refresh();
+	return FReply::Handled();
+}
+
+/**
+ * Writes the counts to Saved/Articy/Profiles/GVProfile.csv.
+ *
+ * @return Handled.
+ */
+FReply SArticyGvProfiler::OnExportCsv()
+{
+	FArticyGvProfiler::WriteCsv(TEXT("GVProfile.csv"), GetPlayDatabase());
+	return FReply::Handled();
+}
+
+/**
+ * Returns the database of the play session, whose flow graph knows the fragments.
+ *
+ * @return The database, or nullptr if no play session is running.
+ */
+const UArticyDatabase* SArticyGvProfiler::GetPlayDatabase() const
+{
+	const FWorldContext* Context = GEditor ? GEditor->GetPIEWorldContext() : nullptr;
+	return Context && Context->World() ? UArticyDatabase::Get(Context->World()) : nullptr;
+}
+
+#undef LOCTEXT_NAMESPACE
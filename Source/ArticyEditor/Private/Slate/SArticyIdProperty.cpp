@@ -10,6 +10,7 @@
 #include <ContentBrowserModule.h>
 #include <Widgets/Input/SComboButton.h>
 #include "ArticyObject.h"
+#include "ArticyObjectIndexSubsystem.h"
 #include "ArticyEditorModule.h"
 #include "Slate/AssetPicker/SArticyObjectAssetPicker.h"
 #include "Editor.h"
@@ -72,12 +73,17 @@ void SArticyIdProperty::Construct(const FArguments& InArgs)
 	SetCursor(EMouseCursor::Hand);
 
 	CachedArticyId = ArticyIdToDisplay.Get(FArticyId());
-	CachedArticyObject = !CachedArticyId.IsNull() ? UArticyObject::FindAsset(CachedArticyId) : nullptr;
+	CachedArticyObject = !CachedArticyId.IsNull() ? UArticyObjectIndexSubsystem::FindAsset(CachedArticyId) : nullptr;
 
 	CreateInternalWidgets();
 
 	UpdateWidget();
 
+	// the displayed ID only changes by events, so there is no need to poll it every frame
+	SetCanTick(false);
+	FArticyEditorModule::Get().OnAssetsGenerated.AddSP(this, &SArticyIdProperty::OnAssetsGenerated);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.AddSP(this, &SArticyIdProperty::OnObjectPropertyChanged);
+
 	this->ChildSlot
 		[
 			ChildBox.ToSharedRef()
@@ -85,21 +91,36 @@ void SArticyIdProperty::Construct(const FArguments& InArgs)
 }
 
 /**
- * Ticks the SArticyIdProperty widget, updating it if necessary.
- *
- * @param AllottedGeometry The allotted geometry of the widget.
- * @param InCurrentTime The current time.
- * @param InDeltaTime The time delta since the last tick.
+ * Updates the SArticyIdProperty widget if the Articy ID to display changed, or its object is not loaded anymore.
  */
-void SArticyIdProperty::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
+void SArticyIdProperty::Refresh()
 {
-	const FArticyId CurrentRefId = ArticyIdToDisplay.Get() ? ArticyIdToDisplay.Get() : FArticyId();
+	const FArticyId CurrentRefId = ArticyIdToDisplay.Get(FArticyId());
 	if (CurrentRefId != CachedArticyId || (!CurrentRefId.IsNull() && !CachedArticyObject.IsValid()))
 	{
 		Update(CurrentRefId);
 	}
 }
 
+/**
+ * Looks up the object again after the assets were generated, and rebuilds its customizations.
+ */
+void SArticyIdProperty::OnAssetsGenerated()
+{
+	Update(ArticyIdToDisplay.Get(FArticyId()));
+}
+
+/**
+ * Refreshes the widget after a property of any object changed, which may be the displayed ID.
+ *
+ * @param Object The object whose property changed.
+ * @param PropertyChangedEvent The change.
+ */
+void SArticyIdProperty::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Refresh();
+}
+
 /**
  * Creates the internal widgets for the SArticyIdProperty.
  */
@@ -217,9 +238,14 @@ void SArticyIdProperty::Update(const FArticyId& NewId)
 {
 	// the actual update. This will be forwarded into the tile view and will cause an update
 	CachedArticyId = NewId;
-	CachedArticyObject = !CachedArticyId.IsNull() ? UArticyObject::FindAsset(CachedArticyId) : nullptr;
+	CachedArticyObject = !CachedArticyId.IsNull() ? UArticyObjectIndexSubsystem::FindAsset(CachedArticyId) : nullptr;
 
 	UpdateWidget();
+
+	if (TileView.IsValid())
+	{
+		TileView->Refresh();
+	}
 }
 
 /**
@@ -320,7 +346,7 @@ bool SArticyIdProperty::IsClassFilterEditable() const
  *
  * @param ArticyObjectData The data of the picked Articy object.
  */
-void SArticyIdProperty::OnArticyObjectPicked(const FAssetData& ArticyObjectData) const
+void SArticyIdProperty::OnArticyObjectPicked(const FAssetData& ArticyObjectData)
 {
 	UArticyObject* NewObject = Cast<UArticyObject>(ArticyObjectData.GetAsset());
 
@@ -332,6 +358,9 @@ void SArticyIdProperty::OnArticyObjectPicked(const FAssetData& ArticyObjectData)
 	{
 		OnArticyIdChanged.ExecuteIfBound(FArticyId());
 	}
+
+	// not every owner changes a property, e.g. a pin changes its default value
+	Refresh();
 }
 
 /**
@@ -341,7 +370,7 @@ void SArticyIdProperty::OnArticyObjectPicked(const FAssetData& ArticyObjectData)
  */
 FReply SArticyIdProperty::OnArticyButtonClicked() const
 {
-	UserInterfaceHelperFunctions::ShowObjectInArticy(UArticyObject::FindAsset(CachedArticyId));
+	UserInterfaceHelperFunctions::ShowObjectInArticy(UArticyObjectIndexSubsystem::FindAsset(CachedArticyId));
 	return FReply::Handled();
 }
 
@@ -432,7 +461,7 @@ bool SArticyIdProperty::CanPasteProperty() const
 	FArticyId CandidateId;
 	if (CandidateId.InitFromString(ClipboardContent))
 	{
-		UArticyObject* Object = UArticyObject::FindAsset(CandidateId);
+		UArticyObject* Object = UArticyObjectIndexSubsystem::FindAsset(CandidateId);
 		if (!Object)
 		{
 			return false;
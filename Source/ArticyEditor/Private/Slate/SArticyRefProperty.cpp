@@ -7,6 +7,7 @@
 #include <Kismet2/KismetEditorUtilities.h>
 #include <Kismet2/SClassPickerDialog.h>
 #include "ArticyObject.h"
+#include "ArticyObjectIndexSubsystem.h"
 #include "ArticyEditorModule.h"
 #include "ArticyEditorStyle.h"
 #include "Slate/AssetPicker/SArticyObjectAssetPicker.h"
@@ -42,7 +43,12 @@ void SArticyRefProperty::Construct(const FArguments& InArgs)
 
 	CreateInternalWidgets();
 
-	UpdateWidget();
+	Update(ArticyRefToDisplay.Get(FArticyRef()));
+
+	// the displayed ref only changes by events, so there is no need to poll it every frame
+	SetCanTick(false);
+	FArticyEditorModule::Get().OnAssetsGenerated.AddSP(this, &SArticyRefProperty::OnAssetsGenerated);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.AddSP(this, &SArticyRefProperty::OnObjectPropertyChanged);
 
 	this->ChildSlot
 		[
@@ -51,21 +57,36 @@ void SArticyRefProperty::Construct(const FArguments& InArgs)
 }
 
 /**
- * Updates the widget state on each tick.
- *
- * @param AllottedGeometry The geometry allocated for this widget.
- * @param InCurrentTime The current time.
- * @param InDeltaTime The time elapsed since the last tick.
+ * Updates the widget if the ArticyRef to display changed, or its object is not loaded anymore.
  */
-void SArticyRefProperty::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
+void SArticyRefProperty::Refresh()
 {
-	const FArticyRef& CurrentRef = ArticyRefToDisplay.IsBound() || ArticyRefToDisplay.IsSet() ? ArticyRefToDisplay.Get() : FArticyRef();
+	const FArticyRef CurrentRef = ArticyRefToDisplay.Get(FArticyRef());
 	if (CurrentRef != CachedArticyRef || (!CurrentRef.GetId().IsNull() && !CachedArticyObject.IsValid()))
 	{
 		Update(CurrentRef);
 	}
 }
 
+/**
+ * Looks up the object again after the assets were generated.
+ */
+void SArticyRefProperty::OnAssetsGenerated()
+{
+	Update(ArticyRefToDisplay.Get(FArticyRef()));
+}
+
+/**
+ * Refreshes the widget after a property of any object changed, which may be the displayed ref.
+ *
+ * @param Object The object whose property changed.
+ * @param PropertyChangedEvent The change.
+ */
+void SArticyRefProperty::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Refresh();
+}
+
 /**
  * Creates the internal widgets used within the ArticyRefProperty.
  */
@@ -243,9 +264,14 @@ void SArticyRefProperty::CreateAdditionalRefWidgets(FToolBarBuilder& Builder)
 void SArticyRefProperty::Update(const FArticyRef& NewRef)
 {
 	CachedArticyRef = NewRef;
-	CachedArticyObject = !CachedArticyRef.GetId().IsNull() ? UArticyObject::FindAsset(CachedArticyRef.GetId()) : nullptr;
+	CachedArticyObject = !CachedArticyRef.GetId().IsNull() ? UArticyObjectIndexSubsystem::FindAsset(CachedArticyRef.GetId()) : nullptr;
 
 	UpdateWidget();
+
+	if (ArticyIdProperty.IsValid())
+	{
+		ArticyIdProperty->Refresh();
+	}
 }
 
 /**
@@ -306,7 +332,7 @@ bool SArticyRefProperty::CanPasteProperty() const
 	FArticyId CandidateId;
 	if (CandidateId.InitFromString(ClipboardContent))
 	{
-		UArticyObject* Object = UArticyObject::FindAsset(CandidateId);
+		UArticyObject* Object = UArticyObjectIndexSubsystem::FindAsset(CandidateId);
 		if (!Object)
 		{
 			return false;
@@ -4,6 +4,8 @@
 
 #include "Slate/UserInterfaceHelperFunctions.h"
 #include "ArticyObject.h"
+#include "ArticyObjectIndexSubsystem.h"
+#include "ArticyPreviewCacheSubsystem.h"
 #include "Interfaces/ArticyObjectWithPreviewImage.h"
 #include "ArticyAsset.h"
 #include "Interfaces/ArticyObjectWithSpeaker.h"
@@ -151,7 +153,7 @@ UTexture2D* UserInterfaceHelperFunctions::GetDisplayImage(const UArticyObject* A
 	if (ObjectWithPreviewImage)
 	{
 		const FArticyId AssetID = ObjectWithPreviewImage->GetPreviewImage()->Asset;
-		const UArticyObject* AssetObject = UArticyObject::FindAsset(AssetID);
+		const UArticyObject* AssetObject = UArticyObjectIndexSubsystem::FindAsset(AssetID);
 
 		if (AssetObject)
 		{
@@ -165,14 +167,21 @@ UTexture2D* UserInterfaceHelperFunctions::GetDisplayImage(const UArticyObject* A
 
 /**
  * Retrieves the preview image associated with an Articy object and assigns it to the specified Slate brush.
+ * The image is taken from the preview image cache, which loads it in the background the first time.
  *
  * @param ArticyObject The Articy object for which to retrieve the preview image.
  * @param OutSlateBrush The Slate brush to which the preview image will be assigned.
- * @return True if a preview image was successfully retrieved and assigned; otherwise, false.
+ * @return True if a preview image was successfully retrieved and assigned; false if there is none or it is still loading.
  */
 bool UserInterfaceHelperFunctions::RetrievePreviewImage(const UArticyObject* ArticyObject, FSlateBrush& OutSlateBrush)
 {
-	UTexture2D* PreviewImage = GetDisplayImage(ArticyObject);
+	const FArticyId AssetId = GetPreviewImageAssetId(ArticyObject);
+	if (AssetId.IsNull())
+	{
+		return false;
+	}
+
+	UTexture2D* PreviewImage = UArticyPreviewCacheSubsystem::FindPreviewImage(AssetId);
 
 	if (PreviewImage)
 	{
@@ -183,6 +192,31 @@ bool UserInterfaceHelperFunctions::RetrievePreviewImage(const UArticyObject* Art
 	return false;
 }
 
+/**
+ * Retrieves the ID of the articy asset of the preview image of an Articy object, or of its speaker.
+ * The widgets compare it with the ID broadcast by UArticyPreviewCacheSubsystem::OnPreviewImageLoaded.
+ *
+ * @param ArticyObject The Articy object for which to retrieve the ID.
+ * @param bSpeaker Whether to retrieve the ID of the preview image of the speaker instead.
+ * @return The ID of the asset, or a null ID if there is no preview image.
+ */
+FArticyId UserInterfaceHelperFunctions::GetPreviewImageAssetId(const UArticyObject* ArticyObject, bool bSpeaker)
+{
+	if (bSpeaker)
+	{
+		const IArticyObjectWithSpeaker* ArticyObjectWithSpeaker = Cast<IArticyObjectWithSpeaker>(ArticyObject);
+		ArticyObject = ArticyObjectWithSpeaker ? UArticyObjectIndexSubsystem::FindAsset(ArticyObjectWithSpeaker->GetSpeakerId()) : nullptr;
+	}
+
+	const IArticyObjectWithPreviewImage* ObjectWithPreviewImage = Cast<IArticyObjectWithPreviewImage>(ArticyObject);
+	if (!ObjectWithPreviewImage || !ObjectWithPreviewImage->GetPreviewImage())
+	{
+		return FArticyId();
+	}
+
+	return ObjectWithPreviewImage->GetPreviewImage()->Asset;
+}
+
 /**
  * Retrieves the preview image associated with the speaker of an Articy object and assigns it to the specified Slate brush.
  *
@@ -196,7 +230,7 @@ bool UserInterfaceHelperFunctions::RetrieveSpeakerPreviewImage(const UArticyObje
 
 	if (ArticyObjectWithSpeaker)
 	{
-		UArticyObject* Speaker = UArticyObject::FindAsset(ArticyObjectWithSpeaker->GetSpeakerId());
+		UArticyObject* Speaker = UArticyObjectIndexSubsystem::FindAsset(ArticyObjectWithSpeaker->GetSpeakerId());
 		return RetrievePreviewImage(Speaker, OutSlateBrush);
 	}
 
@@ -252,7 +286,7 @@ const FString UserInterfaceHelperFunctions::GetDisplayName(const UArticyObject*
 	const FArticyId* TargetID = UserInterfaceHelperFunctions::GetTargetID(ArticyObject);
 	if (TargetID)
 	{
-		const UArticyObject* TargetObject = UArticyObject::FindAsset(*TargetID);
+		const UArticyObject* TargetObject = UArticyObjectIndexSubsystem::FindAsset(*TargetID);
 
 		if (TargetObject)
 		{
@@ -316,7 +350,7 @@ const FLinearColor UserInterfaceHelperFunctions::GetColor(const UArticyObject* A
 
 	if (TargetID)
 	{
-		const UArticyObject* TargetObject = UArticyObject::FindAsset(*TargetID);
+		const UArticyObject* TargetObject = UArticyObjectIndexSubsystem::FindAsset(*TargetID);
 
 		if (TargetObject)
 		{
@@ -3,23 +3,140 @@
 //
 
 #include "StringTableGenerator.h"
+#include "ArticyTextExtension.h"
 #include "Misc/App.h"
 #include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+#include "Containers/StringConv.h"
 #include "ISourceControlModule.h"
 #include "ISourceControlProvider.h"
 #include "HAL/PlatformFilemanager.h"
 #include "SourceControlHelpers.h"
 
+namespace
+{
+    /** The buffer is written to the temporary file once it reaches this size. */
+    constexpr int32 FlushSize = 1 << 20;
+}
+
+StringTableGenerator::~StringTableGenerator()
+{
+    // A deferred table that never got finished
+    if (Writer || IFileManager::Get().FileExists(*TempPath))
+    {
+        Writer.Reset();
+        IFileManager::Get().Delete(*TempPath, false, false, true);
+    }
+}
+
+void StringTableGenerator::Begin()
+{
+    Buffer.Reserve(FlushSize + FlushSize / 4);
+
+    // The string tables have always been written with a BOM
+    Buffer.Add(static_cast<ANSICHAR>(0xEF));
+    Buffer.Add(static_cast<ANSICHAR>(0xBB));
+    Buffer.Add(static_cast<ANSICHAR>(0xBF));
+
+    // The third column used to be unnamed, as FArticyTextTemplate::TokensMetaData it is imported as metadata
+    static const ANSICHAR Header[] = "\"Key\",\"SourceString\",\"Tokens\"\n";
+    Buffer.Append(Header, UE_ARRAY_COUNT(Header) - 1);
+}
+
 void StringTableGenerator::Line(const FString& Key, const FString& SourceString)
 {
-    FileContent += TEXT("\"") + Key.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\",\"") + SourceString.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\",\"") + TEXT("\"\n");
+    static const ANSICHAR Separator[] = "\",\"";
+    static const ANSICHAR Ending[] = "\",\"\"\n";
+    static const ANSICHAR TokensEnding[] = "\",\"1\"\n";
+
+    Buffer.Add('"');
+    AppendEscaped(Key);
+    Buffer.Append(Separator, UE_ARRAY_COUNT(Separator) - 1);
+    AppendEscaped(SourceString);
+    if (FArticyTextTemplate::HasTokens(SourceString))
+        Buffer.Append(TokensEnding, UE_ARRAY_COUNT(TokensEnding) - 1);
+    else
+        Buffer.Append(Ending, UE_ARRAY_COUNT(Ending) - 1);
+
+    if (Buffer.Num() >= FlushSize)
+        Flush();
+}
+
+void StringTableGenerator::AppendEscaped(const FString& Field)
+{
+    if (Field.IsEmpty())
+        return;
+
+    // Quotes are single bytes in UTF-8, so they can be doubled after the conversion
+    const FTCHARToUTF8 Utf8(*Field, Field.Len());
+    const ANSICHAR* Data = Utf8.Get();
+    const int32 Len = Utf8.Length();
+
+    int32 Start = 0;
+    for (int32 Index = 0; Index < Len; ++Index)
+    {
+        if (Data[Index] == '"')
+        {
+            Buffer.Append(Data + Start, Index - Start + 1);
+            Buffer.Add('"');
+            Start = Index + 1;
+        }
+    }
+    Buffer.Append(Data + Start, Len - Start);
 }
 
-void StringTableGenerator::WriteToFile() const
+void StringTableGenerator::Flush()
 {
-    if (FileContent.IsEmpty())
+    if (Buffer.Num() == 0 || bWriteFailed)
         return;
 
+    if (!Writer)
+    {
+        Writer.Reset(IFileManager::Get().CreateFileWriter(*TempPath));
+        if (!Writer)
+        {
+            bWriteFailed = true;
+            Buffer.Empty();
+            return;
+        }
+    }
+
+    ContentHash.Update(reinterpret_cast<const uint8*>(Buffer.GetData()), Buffer.Num());
+    ContentSize += Buffer.Num();
+
+    Writer->Serialize(Buffer.GetData(), Buffer.Num());
+    Buffer.Reset();
+}
+
+void StringTableGenerator::End()
+{
+    if (bContentWritten)
+        Flush();
+
+    if (Writer)
+    {
+        bWriteFailed |= !Writer->Close();
+        Writer.Reset();
+    }
+
+    if (!bContentWritten)
+        IFileManager::Get().Delete(*TempPath, false, false, true);
+
+    Buffer.Empty();
+}
+
+void StringTableGenerator::Finish()
+{
+    if (!bContentWritten || bWriteFailed || !IFileManager::Get().FileExists(*TempPath))
+        return;
+
+    // Re-imports usually leave most tables as they are, skip the write and the checkout for those
+    if (IsUnchanged())
+    {
+        IFileManager::Get().Delete(*TempPath, false, false, true);
+        return;
+    }
+
     IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
     ISourceControlModule& SCModule = ISourceControlModule::Get();
 
@@ -37,7 +154,7 @@ void StringTableGenerator::WriteToFile() const
         bFileExisted = true;
     }
 
-    const bool bFileWritten = FFileHelper::SaveStringToFile(FileContent, *Path, FFileHelper::EEncodingOptions::ForceUTF8);
+    const bool bFileWritten = IFileManager::Get().Move(*Path, *TempPath, true, true);
 
     // Mark the file for addition if it is newly created
     if (!bFileExisted && bFileWritten && SCModule.IsEnabled())
@@ -45,3 +162,15 @@ void StringTableGenerator::WriteToFile() const
         USourceControlHelpers::MarkFileForAdd(*Path);
     }
 }
+
+bool StringTableGenerator::IsUnchanged()
+{
+    // Differing sizes are caught without reading the existing file
+    if (IFileManager::Get().FileSize(*Path) != ContentSize)
+        return false;
+
+    FMD5Hash GeneratedHash;
+    GeneratedHash.Set(ContentHash);
+
+    return FMD5Hash::HashFile(*Path) == GeneratedHash;
+}
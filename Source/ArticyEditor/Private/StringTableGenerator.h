@@ -6,14 +6,20 @@
 
 #include "Containers/UnrealString.h"
 #include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/Archive.h"
+#include "Templates/UniquePtr.h"
 
 /**
  * @class StringTableGenerator
  * @brief A class to generate and manage string tables in CSV format.
  *
- * This class holds a content string that can be written to a CSV file.
+ * The CSV rows are encoded as UTF-8 into a buffer, which is streamed into a temporary file whenever it fills up.
  * It is used for generating string tables for localization purposes, where each
- * entry consists of a key and its corresponding source string.
+ * entry consists of a key and its corresponding source string. The Tokens metadata column flags the entries
+ * whose text has tokens or placeholders (see FArticyTextTemplate::HasTokens), the others are not resolved at runtime.
+ * Generating is thread-safe, finishing (which moves the file into place and talks to source control) is not.
+ * Tables whose content matches the existing file are neither rewritten nor checked out.
  */
 class StringTableGenerator
 {
@@ -41,32 +47,69 @@ public:
      * @param TableName The name of the string table.
      * @param Culture The culture/language code for localization.
      * @param ContentGenerator A lambda function to generate the content of the string table.
+     * @param bDeferFinish If true, Finish has to be called on the game thread afterwards, so the table can be generated on any thread.
      */
     template<typename Lambda>
-    StringTableGenerator(const FString& TableName, const FString& Culture, Lambda ContentGenerator);
+    StringTableGenerator(const FString& TableName, const FString& Culture, Lambda ContentGenerator, bool bDeferFinish = false);
+
+    ~StringTableGenerator();
 
     /**
      * @brief Adds a line to the content string.
      *
      * @param Key The key for the string entry.
-     * @param SourceString The source string for the entry.
+     * @param SourceString The source string for the entry, its Tokens column is set if it has tokens.
      */
     void Line(const FString& Key = "", const FString& SourceString = "");
 
+    /**
+     * @brief Moves the generated file to its path and registers it with source control.
+     *
+     * Does nothing if no content was generated or if the existing file already has the same content.
+     * Must be called on the game thread.
+     */
+    void Finish();
+
 private:
 
     /** The file path where the CSV will be saved. */
     FString Path;
 
-    /** The accumulated content of the CSV file. */
-    FString FileContent = "";
+    /** The file the content is streamed into, until it is moved to Path. */
+    FString TempPath;
 
-    /**
-     * @brief Writes the content to a file.
-     *
-     * This method saves the accumulated file content to the specified file path.
-     */
-    void WriteToFile() const;
+    /** The UTF-8 encoded content which is not written to the temporary file yet. */
+    TArray<ANSICHAR> Buffer;
+
+    /** The writer of the temporary file, opened with the first flush. */
+    TUniquePtr<FArchive> Writer;
+
+    /** The hash of the content written to the temporary file. */
+    FMD5 ContentHash;
+
+    /** The number of bytes written to the temporary file. */
+    int64 ContentSize = 0;
+
+    /** Whether the content generator added any content. */
+    bool bContentWritten = false;
+
+    /** Whether the temporary file could not be written. */
+    bool bWriteFailed = false;
+
+    /** Prepares the buffer and the CSV header. */
+    void Begin();
+
+    /** Appends a string to the buffer, doubling its quotes. */
+    void AppendEscaped(const FString& Field);
+
+    /** Writes the buffer to the temporary file. */
+    void Flush();
+
+    /** Writes the rest of the content, or discards the temporary file if there is no content. */
+    void End();
+
+    /** Returns true if the file at Path already has the generated content. */
+    bool IsUnchanged();
 };
 
 //---------------------------------------------------------------------------//
@@ -85,7 +128,7 @@ inline void StringTableGenerator::SafeExecute(nullptr_t Lamb)
 }
 
 template <typename Lambda>
-StringTableGenerator::StringTableGenerator(const FString& TableName, const FString& Culture, Lambda ContentGenerator)
+StringTableGenerator::StringTableGenerator(const FString& TableName, const FString& Culture, Lambda ContentGenerator, bool bDeferFinish)
 {
     const FString FilePath = TEXT("ArticyContent/Generated") / TableName;
     if (Culture.IsEmpty())
@@ -97,12 +140,13 @@ StringTableGenerator::StringTableGenerator(const FString& TableName, const FStri
         Path = FPaths::ProjectContentDir() / TEXT("L10N") / Culture / FilePath;
     }
     Path += TEXT(".csv");
+    TempPath = Path + TEXT(".tmp");
 
-    Line("Key", "SourceString");
-    bool bContentWritten = false;
+    Begin();
     if (ensure(!std::is_null_pointer<Lambda>::value))
         bContentWritten = ContentGenerator(this) != 0;
+    End();
 
-    if (bContentWritten)
-        WriteToFile();
+    if (!bDeferFinish)
+        Finish();
 }
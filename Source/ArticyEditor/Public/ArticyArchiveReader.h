@@ -7,6 +7,8 @@
 #include "CoreMinimal.h"
 #include "UObject/Object.h"
 #include "Dom/JsonObject.h"
+#include "Async/MappedFileHandle.h"
+#include "Templates/UniquePtr.h"
 #include "ArticyArchiveReader.generated.h"
 
 /**
@@ -49,6 +51,22 @@ struct ARTICYEDITOR_API FArticyArchiveFileData
 	int16 Flags;
 	/** The filename of the file. */
 	FString Filename;
+
+	/** Returns true if the file is stored compressed, i.e. its packed length differs from its unpacked length. */
+	bool IsCompressed() const { return PackedLength != UnpackedLength; }
+};
+
+/**
+ * A JSON file of the archive to fetch ahead of time, see UArticyArchiveReader::PrefetchJson.
+ */
+struct FArticyArchivePrefetch
+{
+	/** The JSON object containing the file info, as passed to FetchJson. */
+	TSharedPtr<FJsonObject> JsonRoot;
+	/** The field name of the file info, as passed to FetchJson. */
+	FString FieldName;
+	/** The hash of the already imported file, the file is skipped if it did not change. */
+	FString Hash;
 };
 
 /**
@@ -68,6 +86,22 @@ public:
 	 */
 	bool OpenArchive(const FString& InArchiveFileName);
 
+	/**
+	 * Releases the archive file, the views returned by ReadFileBytes become invalid.
+	 */
+	void CloseArchive();
+
+	/**
+	 * Returns the bytes of a file in the archive.
+	 * Stored files are not copied, compressed files are decompressed into OutStorage.
+	 *
+	 * @param Filename The name of the file in the archive.
+	 * @param OutStorage Receives the decompressed bytes of compressed files.
+	 * @param OutBytes The bytes of the file, valid until the archive is closed or OutStorage is changed.
+	 * @return True if the file was successfully read; otherwise, false.
+	 */
+	bool ReadFileBytes(const FString& Filename, TArray<uint8>& OutStorage, TArrayView<const uint8>& OutBytes) const;
+
 	/**
 	 * Reads a file from the archive.
 	 *
@@ -77,6 +111,8 @@ public:
 	 */
 	bool ReadFile(const FString& Filename, FString& OutResult) const;
 
+	virtual void BeginDestroy() override;
+
 	/**
 	 * Converts an array of bytes to a string, assuming UTF-8 encoding.
 	 *
@@ -101,6 +137,47 @@ public:
 		FString& Hash,
 		TSharedPtr<FJsonObject>& OutJsonObject) const;
 
+	/**
+	 * Checks whether a file of the archive changed, without fetching it or updating the hash like FetchJson does.
+	 *
+	 * @param JsonRoot The root JSON object to search within.
+	 * @param FieldName The field name containing the file info.
+	 * @param Hash The hash of the already imported file.
+	 * @return True if the file info was found and its hash differs; otherwise, false.
+	 */
+	bool HasFileChanged(
+		const TSharedPtr<FJsonObject>& JsonRoot,
+		const FString& FieldName,
+		const FString& Hash) const;
+
+	/**
+	 * Fetches the bytes of a JSON file from the archive without parsing it, verifying the hash for changes.
+	 *
+	 * @param JsonRoot The root JSON object to search within.
+	 * @param FieldName The field name containing the file info.
+	 * @param Hash The hash value to check against.
+	 * @param OutStorage Receives the decompressed bytes, if the file is compressed.
+	 * @param OutBytes The UTF-8 bytes of the file, if found and changed; see ReadFileBytes.
+	 * @return True if the file was found and changed; otherwise, false.
+	 */
+	bool FetchBytes(
+		const TSharedPtr<FJsonObject>& JsonRoot,
+		const FString& FieldName,
+		FString& Hash,
+		TArray<uint8>& OutStorage,
+		TArrayView<const uint8>& OutBytes) const;
+
+	/**
+	 * Reads and parses JSON files of the archive on worker threads.
+	 * The parsed objects are handed out by the next FetchJson of each file, instead of parsing the file then.
+	 *
+	 * @param Files The files to fetch.
+	 * @param NumWorkers The maximum number of files parsed at the same time, 0 to use all worker threads.
+	 * @param MemoryBudget The estimated memory (in bytes) the prefetched objects may take, 0 for no limit.
+	 *		The files which do not fit are left to FetchJson.
+	 */
+	void PrefetchJson(const TArray<FArticyArchivePrefetch>& Files, int32 NumWorkers, int64 MemoryBudget = 0) const;
+
 protected:
 	/**
 	 * Reads the header from the archive file.
@@ -116,10 +193,31 @@ protected:
 	 */
 	bool ReadFileData();
 
+	/**
+	 * Parses a JSON file of the archive.
+	 *
+	 * @param FileName The name of the file in the archive.
+	 * @return The parsed JSON object, or null if the file could not be read or parsed.
+	 */
+	TSharedPtr<FJsonObject> ParseJson(const FString& FileName) const;
+
 	/** The name of the archive file. */
 	FString ArchiveFileName;
 	/** The header information of the archive. */
 	FArticyArchiveHeader Header;
 	/** The dictionary of files contained in the archive. */
 	TMap<FString, FArticyArchiveFileData> FileDictionary;
+
+	/** The mapped archive, which stays open for the lifetime of the reader. */
+	TUniquePtr<IMappedFileHandle> MappedArchive;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	/** The archive content, if the archive could not be mapped. */
+	TArray<uint8> ArchiveData;
+
+	/** The content of the archive, either the mapped region or ArchiveData. */
+	TArrayView<const uint8> ArchiveBytes;
+
+	/** The JSON files parsed by PrefetchJson which were not fetched yet, by file name. */
+	mutable TMap<FString, TSharedPtr<FJsonObject>> PrefetchedJson;
 };
@@ -7,6 +7,7 @@
 #include "CoreMinimal.h"
 #include "ArticyEditorFunctionLibrary.h"
 #include "ArticyImportData.h"
+#include "ArticyMemoryReport.h"
 
 #define LOCTEXT_NAMESPACE "ArticyImporter"
 
@@ -20,6 +21,7 @@ class FArticyEditorModule;
  *
  * This class defines and implements console commands for the Articy Editor module, allowing
  * users to interact with and reimport Articy data into Unreal Engine through the console.
+ * It also adds the import data to the runtime Articy.MemReport command and "stat Articy".
  */
 class FArticyEditorConsoleCommands
 {
@@ -38,7 +40,14 @@ public:
 			*LOCTEXT("CommandText_Reimport", "Reimport articy data into Unreal").ToString(),
 			FConsoleCommandDelegate::CreateRaw(this, &FArticyEditorConsoleCommands::Reimport))
 
-	{}
+	{
+		MemoryReportHandle = FArticyMemoryReport::OnCollect.AddStatic(&FArticyEditorConsoleCommands::CollectImportDataMemory);
+	}
+
+	~FArticyEditorConsoleCommands()
+	{
+		FArticyMemoryReport::OnCollect.Remove(MemoryReportHandle);
+	}
 
 	/**
 	 * @brief Reimports Articy data into Unreal Engine.
@@ -61,6 +70,17 @@ public:
 		}
 	}
 
+	/**
+	 * @brief Adds the memory of the loaded import data to a memory report.
+	 *
+	 * Breaks the import data down into the models and texts of the packages, the script fragments,
+	 * the ParentChildrenCache, the object definitions, the cached version of the last import and the rest.
+	 * The import data is not loaded for this, it is only reported if it is already loaded.
+	 *
+	 * @param Report The report to add the categories to.
+	 */
+	static void CollectImportDataMemory(FArticyMemoryReport& Report);
+
 private:
 
 	/** Reference to the ArticyEditorModule instance associated with these console commands. */
@@ -68,6 +88,9 @@ private:
 
 	/** Console command for reimporting Articy data. */
 	FAutoConsoleCommand ReimportCommand;
+
+	/** The binding of CollectImportDataMemory to FArticyMemoryReport::OnCollect. */
+	FDelegateHandle MemoryReportHandle;
 };
 
 #undef LOCTEXT_NAMESPACE
@@ -7,6 +7,8 @@
 #include "CoreMinimal.h"
 #include "ArticyImportData.h"
 
+class FJsonObject;
+
 /**
  * Enumerates the possible results of ensuring that an import data asset is valid.
  */
@@ -22,6 +24,51 @@ enum EImportDataEnsureResult
 	Failure
 };
 
+/**
+ * The options of a batch import, see FArticyEditorFunctionLibrary::BatchImport.
+ * The defaults are the answers the import would otherwise ask the user for.
+ */
+struct FArticyBatchImportOptions
+{
+	/** Reimports everything, rather than only the files which changed since the last import. */
+	bool bFullReimport = false;
+
+	/** Only regenerates the assets from the current import data, without reading the export. */
+	bool bRegenerateAssetsOnly = false;
+
+	/** Adds the ArticyRuntime reference to the build file of the project if it is missing, instead of asking. */
+	bool bAddRuntimeReference = true;
+};
+
+/**
+ * The outcome of a batch import.
+ */
+struct ARTICYEDITOR_API FArticyBatchImportResult
+{
+	/** Whether the import finished without errors. */
+	bool bSucceeded = false;
+
+	/** The generated code changed: the project has to be built, then the import run again to generate the assets. */
+	bool bNeedsCompile = false;
+
+	/** Whether the import data asset did not exist and was created from the export. */
+	bool bCreatedImportData = false;
+
+	/** The export which was imported. */
+	FString SourceFile;
+
+	double Seconds = 0.0;
+
+	/** The errors of all log categories, and the warnings of the importer, logged during the import. */
+	TArray<FString> Errors;
+	TArray<FString> Warnings;
+
+	/** The time and memory of the import stages, see FArticyImportProfiler. Null if the import did not start. */
+	TSharedPtr<FJsonObject> Stages;
+
+	TSharedRef<FJsonObject> ToJson() const;
+};
+
 /**
  * FArticyEditorFunctionLibrary provides static functions for handling Articy data imports and asset management.
  */
@@ -62,6 +109,32 @@ public:
 	 */
 	static EImportDataEnsureResult EnsureImportDataAsset(UArticyImportData**);
 
+	/**
+	 * Imports the Articy data without any UI, for build machines: dialogs are answered with the defaults of the
+	 * options, nothing is compiled, and the packages are saved without prompting for checkout.
+	 * Must be called on the game thread, e.g. from the ArticyImport commandlet.
+	 *
+	 * @param Options What to import, and the answers to the questions the import would otherwise ask.
+	 * @return The outcome of the import, with its errors and the timings of its stages.
+	 */
+	static FArticyBatchImportResult BatchImport(const FArticyBatchImportOptions& Options = FArticyBatchImportOptions());
+
+	/**
+	 * Reports what a reimport of the export of the import data would regenerate, without changing anything.
+	 * Only the manifest of the export is read, so this finishes in a fraction of the time of an import.
+	 *
+	 * @param OutReport Receives what the import would regenerate.
+	 * @param UArticyImportData The Articy import data object to compare with, the import data asset if null.
+	 * @return False if there is no import data or its export could not be read.
+	 */
+	static bool DryRunImport(FArticyImportDryRunReport& OutReport, UArticyImportData* = nullptr);
+
+	/**
+	 * Returns the options of the batch import which is running, or null outside of BatchImport.
+	 * The import must not show any UI while a batch import is running.
+	 */
+	static const FArticyBatchImportOptions* GetBatchImportOptions();
+
 private:
 	/**
 	 * Generates a new Articy import data asset.
@@ -7,6 +7,7 @@
 #include "Modules/ModuleInterface.h"
 #include "Modules/ModuleManager.h"
 #include "Delegates/IDelegateInstance.h"
+#include "Containers/Ticker.h"
 #include "ArticyEditorConsoleCommands.h"
 #include "Customizations/ArticyEditorCustomizationManager.h"
 #include "Framework/Commands/UICommandList.h"
@@ -72,11 +73,20 @@ public:
 	void RegisterDefaultArticyIdPropertyWidgetExtensions() const;
 	void RegisterDetailCustomizations() const;
 	void RegisterDirectoryWatcher();
+	/** Watches the articy directory for changes of the export, see UArticyPluginSettings::bAutoImportExportChanges */
+	void RegisterExportWatcher();
+	void UnregisterExportWatcher();
 	void RegisterGraphPinFactory() const;
 	void RegisterPluginCommands();
 	void RegisterPluginSettings() const;
 	void RegisterToolTabs();
 
+	/**
+	 * Registers the articy packages as primary assets with the asset manager and applies the chunk
+	 * ids of UArticyPluginSettings::PackageChunkIds to them, so the cooker splits them into their chunks.
+	 */
+	static void ARTICYEDITOR_API ApplyPackageChunkRules();
+
 	void UnregisterPluginSettings() const;
 
 	void QueueImport();
@@ -90,6 +100,7 @@ public:
 private:
 	void OpenArticyWindow();
 	void OpenArticyGVDebugger();
+	void OpenArticyGVProfiler();
 
 	EImportStatusValidity CheckImportStatusValidity() const;
 	void OnGeneratedCodeChanged(const TArray<struct FFileChangeData>& FileChanges) const;
@@ -97,6 +108,10 @@ private:
 	void UnqueueImport();
 	void TriggerQueuedImport(bool b);
 
+	void OnExportChanged(const TArray<struct FFileChangeData>& FileChanges);
+	bool TickExportWatcher(float DeltaTime);
+	void OnExportDirectoryMaybeChanged();
+
 	// Old tool UI hook callbacks required for UE4
 #if ENGINE_MAJOR_VERSION == 4
 	void AddToolbarExtension(FToolBarBuilder& Builder);
@@ -105,11 +120,21 @@ private:
 
 	TSharedRef<class SDockTab> OnSpawnArticyMenuTab(const class FSpawnTabArgs& SpawnTabArgs) const;
 	TSharedRef<class SDockTab> OnSpawnArticyGVDebuggerTab(const class FSpawnTabArgs& SpawnTabArgs) const;
+	TSharedRef<class SDockTab> OnSpawnArticyGVProfilerTab(const class FSpawnTabArgs& SpawnTabArgs) const;
 
 private:
 	bool bIsImportQueued = false;
 	FDelegateHandle QueuedImportHandle;
 	FDelegateHandle GeneratedCodeWatcherHandle;
+
+	/** The absolute directory the export watcher watches, empty if it is not registered. */
+	FString WatchedExportDirectory;
+	FDelegateHandle ExportWatcherHandle;
+	FDelegateHandle ExportDirectoryHandle;
+	/** Ticks while a change of the export waits to be imported. */
+	FTSTicker::FDelegateHandle ExportChangeTickerHandle;
+	/** The time of the last write to the export, the import starts once the settle time passed since. */
+	double LastExportChangeTime = 0.0;
 	FArticyEditorConsoleCommands* ConsoleCommands = nullptr;
 	TSharedPtr<FUICommandList> PluginCommands;
 	/** The CustomizationManager registers and owns all customization factories */
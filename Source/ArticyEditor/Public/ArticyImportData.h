@@ -228,6 +228,8 @@ public:
 	TArray<FString> OriginalParameterTypes;
 
 	const FString& GetCPPReturnType() const;
+	/** Returns the return type as exported by articy, e.g. bool or string. */
+	const FString& GetReturnType() const { return ReturnType; }
 	const FString& GetCPPDefaultReturn() const;
 	const FString GetCPPParameters() const;
 	const FString GetArguments() const;
@@ -304,8 +306,34 @@ public:
 
 //---------------------------------------------------------------------------//
 
+/**
+ * A node of the imported project hierarchy, see FADIHierarchy.
+ */
+USTRUCT()
+struct FADIHierarchyNode
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(VisibleAnywhere, Category = "HierarchyNode")
+	FArticyId Id;
+	UPROPERTY(VisibleAnywhere, Category = "HierarchyNode")
+	FName TechnicalName;
+	UPROPERTY(VisibleAnywhere, Category = "HierarchyNode")
+	FName Type;
+
+	/** The index of the parent node, INDEX_NONE for the root. */
+	UPROPERTY(VisibleAnywhere, Category = "HierarchyNode")
+	int32 Parent = INDEX_NONE;
+
+	/** The index after the last descendant of the node. Its first child, if any, is the next node. */
+	UPROPERTY(VisibleAnywhere, Category = "HierarchyNode")
+	int32 SubtreeEnd = 0;
+};
+
 /**
  * Represents a hierarchy object in the Articy import data.
+ * Only created for views which need objects, see CreateFromHierarchy; the import data stores the nodes of FADIHierarchy.
  */
 UCLASS(BlueprintType)
 class UADIHierarchyObject : public UObject
@@ -323,11 +351,11 @@ public:
 	UPROPERTY(VisibleAnywhere, Category = "HierarchyObject")
 	TArray<UADIHierarchyObject*> Children;
 
-	static UADIHierarchyObject* CreateFromJson(UObject* Outer, const TSharedPtr<FJsonObject> JsonObject);
+	static UADIHierarchyObject* CreateFromHierarchy(UObject* Outer, const struct FADIHierarchy& Hierarchy, int32 Index = 0);
 };
 
 /**
- * Represents a hierarchy of Articy objects.
+ * Represents a hierarchy of Articy objects, as a flat array of nodes in depth-first order.
  */
 USTRUCT()
 struct FADIHierarchy
@@ -335,10 +363,32 @@ struct FADIHierarchy
 	GENERATED_BODY()
 
 public:
+	void ImportFromJson(UArticyImportData* ImportData, const TSharedPtr<FJsonObject> JsonRoot);
+
+	/** Converts the objects of import data saved by previous versions into nodes. */
+	void ConvertLegacyObjects();
+
+	/** Returns true if the hierarchy was not imported. */
+	bool IsEmpty() const { return Nodes.Num() == 0; }
+
+	/** Returns the nodes in depth-first order, the root first. */
+	const TArray<FADIHierarchyNode>& GetNodes() const { return Nodes; }
+
+	/** Calls Visitor with the index of each child of a node, in order. */
+	template<typename TVisitor>
+	void ForEachChild(int32 Index, TVisitor&& Visitor) const
+	{
+		for (int32 Child = Index + 1; Child < Nodes[Index].SubtreeEnd; Child = Nodes[Child].SubtreeEnd)
+			Visitor(Child);
+	}
+
+private:
 	UPROPERTY(VisibleAnywhere, Category = "Hierarchy")
-	UADIHierarchyObject* RootObject = nullptr;
+	TArray<FADIHierarchyNode> Nodes;
 
-	void ImportFromJson(UArticyImportData* ImportData, const TSharedPtr<FJsonObject> JsonRoot);
+	/** The hierarchy of import data saved by previous versions, see ConvertLegacyObjects. */
+	UPROPERTY()
+	UADIHierarchyObject* RootObject = nullptr;
 };
 
 /**
@@ -354,8 +404,34 @@ public:
 	FString OriginalFragment = "";
 	UPROPERTY(VisibleAnywhere, Category = "Script")
 	FString ParsedFragment = "";
+	/** Statements binding the locals ParsedFragment uses, emitted before it. */
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	FString ParsedPrologue = "";
 	UPROPERTY(VisibleAnywhere, Category = "Script")
 	bool bIsInstruction = false;
+	/** Whether the fragment may change state, see FArticyExpressoTranslator::WritesState. */
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	bool bWritesState = true;
+	/** Whether the accesses below were found by the translator, they are unknown for fragments translated as text. */
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	bool bAccessesKnown = false;
+	/** The global variables (Namespace.Variable) the fragment reads and writes, see FArticyExpressoTranslator::GetReadVariables. */
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	TArray<FString> ReadVariables;
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	TArray<FString> WrittenVariables;
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	bool bAccessesSeenCounters = true;
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	bool bAccessesObjectProperties = true;
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	bool bCallsUserMethods = true;
+	/** The technical names of objects the translation resolved to their ids, see FArticyExpressoTranslator::GetResolvedObjects. */
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	TMap<FName, FArticyId> ResolvedObjects;
+	/** The problems found by checking the fragment against the global variables and user methods, see FArticyExpressoTranslator::GetDiagnostics. */
+	UPROPERTY(VisibleAnywhere, Category = "Script")
+	TArray<FString> Diagnostics;
 
 	bool operator==(const FArticyExpressoFragment& Other) const
 	{
@@ -403,6 +479,72 @@ struct ARTICYEDITOR_API FArticyImportDataStruct
 	TMap<FArticyId, FArticyIdArray> ParentChildrenCache;
 };
 
+/**
+ * What an import of an export would regenerate, see UArticyImportData::DryRunImportFromJson.
+ */
+struct ARTICYEDITOR_API FArticyImportDryRunReport
+{
+	/** A package of the export or of the last import. */
+	struct FPackage
+	{
+		FString Name;
+		/** The name of the package in the last import, if it was renamed. */
+		FString PreviousName;
+
+		/** Whether the export contains the data of the package. Packages without data keep their assets. */
+		bool bIncluded = false;
+		bool bNew = false;
+		bool bRemoved = false;
+		bool bRenamed = false;
+		bool bObjectsChanged = false;
+		bool bTextsChanged = false;
+
+		/** Returns true if the assets of the package would be regenerated. */
+		bool NeedsRegeneration() const { return bNew || bRenamed || bObjectsChanged || bTextsChanged; }
+	};
+
+	/** The export which was compared with the import data. */
+	FString SourceFile;
+
+	/** The export belongs to another project or rule set, so everything is imported as if it was the first import. */
+	bool bProjectChanged = false;
+
+	bool bGlobalVariablesChanged = false;
+	bool bObjectDefinitionsChanged = false;
+	bool bObjectDefinitionsTextsChanged = false;
+	bool bScriptMethodsChanged = false;
+	bool bHierarchyChanged = false;
+
+	/** The script fragments of the packages or the script methods changed. */
+	bool bScriptFragmentsChanged = false;
+	bool bScriptSupportChanged = false;
+
+	/** The packages of the export, followed by the packages of the last import which are not in it anymore. */
+	TArray<FPackage> Packages;
+
+	/** The string tables whose texts would change, as Culture/Table or just Table for the invariant culture. */
+	TArray<FString> StringTables;
+
+	/** Whether the code generator would run. It only writes the files whose content changed. */
+	bool bNeedsCodeGeneration = false;
+
+	/**
+	 * Whether the generated code would likely change, so the import has to compile and hot reload it.
+	 * Based on the changed sections only, so it is a false positive if e.g. only the description of a variable changed.
+	 */
+	bool bNeedsRecompile = false;
+
+	double Seconds = 0.0;
+
+	/** Returns true if an import would change anything. */
+	bool HasChanges() const;
+
+	/** Logs the report as a summary. */
+	void Log() const;
+
+	TSharedRef<FJsonObject> ToJson() const;
+};
+
 /**
  * Main class for handling Articy import data.
  */
@@ -413,6 +555,7 @@ class ARTICYEDITOR_API UArticyImportData : public UDataAsset
 
 public:
 	void PostInitProperties() override;
+	void PostLoad() override;
 
 	UPROPERTY(VisibleAnywhere, Instanced, Category = ImportSettings)
 	class UAssetImportData* ImportData;
@@ -423,6 +566,12 @@ public:
 
 	bool ImportFromJson(const UArticyArchiveReader& Archive, const TSharedPtr<FJsonObject> RootObject);
 
+	/**
+	 * Compares the file hashes of an export with the ones of the last import, and reports what an import would
+	 * regenerate. Only the manifest is read, nothing of the import data, the assets or the code is changed.
+	 */
+	FArticyImportDryRunReport DryRunImportFromJson(const UArticyArchiveReader& Archive, const TSharedPtr<FJsonObject> RootObject) const;
+
 	const static TWeakObjectPtr<UArticyImportData> GetImportData();
 	const FAdiSettings& GetSettings() const { return Settings; }
 	FAdiSettings& GetSettings() { return Settings; }
@@ -439,13 +588,18 @@ public:
 	const TArray<FAIDScriptMethod>& GetUserMethods() const { return UserMethods.ScriptMethods; }
 
 	void GatherScripts();
-	void AddScriptFragment(const FString& Fragment, const bool bIsInstruction);
+	void AddScriptFragment(const FString& Fragment, const bool bIsInstruction, const FString& Location);
+	/** Sets the object the fragments added next are in, to name it in the problems GatherScripts reports. */
+	void SetScriptFragmentOwner(const FArticyId& Id, const FString& TechnicalName);
 	const TSet<FArticyExpressoFragment>& GetScriptFragments() const { return ScriptFragments; }
 
 	void AddChildToParentCache(FArticyId Parent, FArticyId Child);
 	const TMap<FArticyId, FArticyIdArray>& GetParentChildrenCache() const { return ParentChildrenCache; }
+	TMap<FArticyId, FArticyIdArray>& GetParentChildrenCache() { return ParentChildrenCache; }
 
+	/** Marks the current data as the version of the last working import, and drops the rollback journal. */
 	void BuildCachedVersion();
+	/** Restores the version of the last working import from the rollback journal, after a failed compile. */
 	void ResolveCachedVersion();
 	bool HasCachedVersion() const { return bHasCachedVersion; }
 
@@ -456,9 +610,27 @@ public:
 
 protected:
 
-	UPROPERTY(VisibleAnywhere, Category = "Articy")
+	/**
+	 * The rollback journal: the members of the last working import which the current import replaced. Each member is
+	 * moved in (or copied, if the import updates it in place) the first time the import changes it, so the members an
+	 * import leaves alone are not held twice, and nothing is held once the import worked.
+	 */
+	UPROPERTY(VisibleAnywhere, Transient, Category = "Articy")
 	FArticyImportDataStruct CachedData;
 
+	/** The members recorded in CachedData, see RecordForRollback. */
+	uint32 JournaledMembers = 0;
+
+	/**
+	 * Records a member in the rollback journal before the import changes it, unless it already is.
+	 * @param Member The bit of the member.
+	 * @param Current The member.
+	 * @param Journaled The member in CachedData.
+	 * @param bMove Whether the import rebuilds the member, so it can be moved instead of copied.
+	 */
+	template<typename TMember>
+	void RecordForRollback(uint32 Member, TMember& Current, TMember& Journaled, bool bMove);
+
 	// indicates whether we've had at least one working import. Used to determine if we want to re
 	UPROPERTY()
 	bool bHasCachedVersion = false;
@@ -485,6 +657,22 @@ private:
 	UPROPERTY(VisibleAnywhere, Category = "ImportData")
 	TSet<FArticyExpressoFragment> ScriptFragments;
 
+	/** The version of the script translation the parsed fragments were created with, see GatherScripts. */
+	UPROPERTY()
+	int32 ScriptFragmentsVersion = 0;
+	/** The hash of the user methods and global variables the parsed fragments were created with, as their calls are translated differently and they are checked against both. */
+	UPROPERTY()
+	uint32 ScriptFragmentsUserMethodsHash = 0;
+
+	/** The translated fragments of the previous import, reused by AddScriptFragment while the scripts are gathered. */
+	TSet<FArticyExpressoFragment> PreviousScriptFragments;
+	/** The fragments found by AddScriptFragment which still need to be translated, see GatherScripts. */
+	TSet<FArticyExpressoFragment> PendingScriptFragments;
+	/** Where each fragment is used while the scripts are gathered, as the object and the pin or property. */
+	TMap<TPair<FString, bool>, TArray<FString>> ScriptFragmentSources;
+	/** The object the fragments added next are in, see SetScriptFragmentOwner. */
+	FString ScriptFragmentOwner;
+
 	UPROPERTY(VisibleAnywhere, Category = "Imported")
 	TArray<TSoftObjectPtr<UArticyPackage>> ImportedPackages;
 
@@ -492,5 +680,5 @@ private:
 	TMap<FArticyId, FArticyIdArray> ParentChildrenCache;
 
 	void ImportAudioAssets(const FString& BaseContentDir);
-	int ProcessStrings(StringTableGenerator* CsvOutput, const TMap<FString, FArticyTexts>& Data, const TPair<FString, FArticyLanguageDef>& Language);
+	int ProcessStrings(TFunctionRef<void(const FString& Key, const FString& SourceString)> AddLine, const TMap<FString, FArticyTexts>& Data, const TPair<FString, FArticyLanguageDef>& Language);
 };
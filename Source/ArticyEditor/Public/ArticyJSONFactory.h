@@ -101,4 +101,12 @@ private:
      * @return true if the import is queued for later, false otherwise.
      */
     bool HandleImportDuringPlay(UObject* Obj);
+
+    /**
+     * Checks whether a reimport during play only changes the content of packages, so it can be patched into the running game.
+     *
+     * @param Obj The object to reimport.
+     * @return true if the import can run now, false if it has to wait until play ends.
+     */
+    static bool CanHotPatchDuringPlay(UObject* Obj);
 };
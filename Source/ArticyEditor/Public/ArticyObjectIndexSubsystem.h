@@ -0,0 +1,120 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EditorSubsystem.h"
+#include "ArticyBaseTypes.h"
+#include "ArticyObjectIndexSubsystem.generated.h"
+
+class UArticyObject;
+class UArticyPackage;
+struct FAssetData;
+struct FArticyIncomingReference;
+struct FArticyObjectSearchEntry;
+struct FArticyObjectSearchIndex;
+
+/**
+ * An index of all articy objects in the generated packages, by ID and by technical name, shared by the editor widgets.
+ *
+ * Unlike UArticyObject::FindAsset, a lookup of an object which does not exist does not scan the packages again.
+ * The index is brought up to date on the next lookup after assets were generated or packages were added, removed or
+ * renamed in the asset registry; only the packages whose objects changed are indexed again.
+ */
+UCLASS()
+class ARTICYEDITOR_API UArticyObjectIndexSubsystem : public UEditorSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Returns the index of the editor, or null if there is no editor, e.g. in some commandlets. */
+	static UArticyObjectIndexSubsystem* Get();
+
+	/**
+	 * Finds an articy object by its ID, using the index of the editor if there is one.
+	 *
+	 * @param Id The ID of the articy object.
+	 * @return The articy object, or nullptr if there is none with this ID.
+	 */
+	static UArticyObject* FindAsset(const FArticyId& Id);
+
+	/**
+	 * Finds an articy object by its technical name, using the index of the editor if there is one.
+	 *
+	 * @param TechnicalName The technical name of the articy object.
+	 * @return The articy object, or nullptr if there is none with this name.
+	 */
+	static UArticyObject* FindAsset(const FName& TechnicalName);
+
+	/** Finds an articy object of the index by its ID, see FindAsset. */
+	UArticyObject* FindObject(const FArticyId& Id);
+
+	/** Finds an articy object of the index by its technical name, see FindAsset. */
+	UArticyObject* FindObject(const FName& TechnicalName);
+
+	/**
+	 * Returns the search entries of all indexed objects, for filtering the objects by text without loading them again.
+	 * The entries of a package are only gathered again if its objects changed, e.g. after an import.
+	 *
+	 * @return The search index, which is not changed anymore once returned and may be used on any thread.
+	 */
+	TSharedRef<const FArticyObjectSearchIndex, ESPMode::ThreadSafe> GetSearchIndex();
+
+	/**
+	 * Returns the references to an articy object from the objects of all indexed packages, looked up in the
+	 * reference indices the import wrote into the packages (see UArticyPackage::GetReferenceIndex).
+	 *
+	 * @param Id The ID of the referenced object.
+	 * @return The references, grouped by package.
+	 */
+	TArray<FArticyIncomingReference> GetIncomingReferences(const FArticyId& Id);
+
+	/** Marks the index outdated, it is brought up to date on the next lookup. */
+	void Invalidate() { bOutdated = true; }
+
+private:
+	/** The objects of a package, as they were indexed. */
+	struct FIndexedPackage
+	{
+		TWeakObjectPtr<UArticyPackage> Package;
+		TArray<TWeakObjectPtr<UArticyObject>> Objects;
+		TArray<FArticyId> Ids;
+		TArray<FName> Names;
+
+		/** The search entries of the objects, gathered on the first search after the package was indexed. */
+		TSharedPtr<const TArray<FArticyObjectSearchEntry>, ESPMode::ThreadSafe> SearchEntries;
+	};
+
+	/** Brings the index up to date with the packages of the asset registry. */
+	void Update();
+
+	/** Returns true if the objects of the package are still the indexed ones, with the same IDs and names. */
+	static bool IsIndexed(const FIndexedPackage& Indexed, UArticyPackage* Package);
+
+	void AddPackage(FIndexedPackage& Indexed, UArticyPackage* Package);
+	void RemovePackage(const FIndexedPackage& Indexed);
+
+	void OnAssetChanged(const FAssetData& AssetData);
+	void OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath);
+
+	/** The indexed packages, by package name. */
+	TMap<FName, FIndexedPackage> Packages;
+
+	TMap<FArticyId, TWeakObjectPtr<UArticyObject>> ObjectsById;
+	TMap<FName, TWeakObjectPtr<UArticyObject>> ObjectsByName;
+
+	/** The search index returned last, kept until a package has other search entries. */
+	TSharedPtr<const FArticyObjectSearchIndex, ESPMode::ThreadSafe> SearchIndex;
+
+	bool bOutdated = true;
+
+	FDelegateHandle AssetsGeneratedHandle;
+	FDelegateHandle AssetAddedHandle;
+	FDelegateHandle AssetRemovedHandle;
+	FDelegateHandle AssetRenamedHandle;
+};
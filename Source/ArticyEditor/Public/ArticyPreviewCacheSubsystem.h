@@ -0,0 +1,88 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EditorSubsystem.h"
+#include "ArticyBaseTypes.h"
+#include "ArticyPreviewCacheSubsystem.generated.h"
+
+class UTexture2D;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnArticyPreviewImageLoaded, const FArticyId&);
+
+/** A preview image of the cache, by the ID of its articy asset. */
+USTRUCT()
+struct FArticyCachedPreviewImage
+{
+	GENERATED_BODY()
+
+	/** The texture, null while it is loading or if the asset is no texture. */
+	UPROPERTY(Transient)
+	UTexture2D* Texture = nullptr;
+
+	bool bLoading = false;
+
+	/** When the image was used last, the least recently used images are removed first. */
+	uint64 LastUsed = 0;
+};
+
+/**
+ * A cache of the preview images of the articy objects, shared by the tile views and tooltips of the editor.
+ *
+ * The textures are loaded in the background, a widget shows its placeholder until OnPreviewImageLoaded is broadcast
+ * for its image. The cache keeps the most recently used textures loaded, and is emptied when assets were generated.
+ */
+UCLASS()
+class ARTICYEDITOR_API UArticyPreviewCacheSubsystem : public UEditorSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Returns the cache of the editor, or null if there is no editor, e.g. in some commandlets. */
+	static UArticyPreviewCacheSubsystem* Get();
+
+	/**
+	 * Finds the preview image of an articy asset, using the cache of the editor if there is one and loading the
+	 * texture synchronously otherwise.
+	 *
+	 * @param AssetId The ID of the articy asset of the preview image.
+	 * @return The texture, or null if it is still loading or there is none.
+	 */
+	static UTexture2D* FindPreviewImage(const FArticyId& AssetId);
+
+	/**
+	 * Finds a preview image of the cache, and starts loading it if it is not cached yet.
+	 *
+	 * @param AssetId The ID of the articy asset of the preview image.
+	 * @return The texture, or null if it is still loading or there is none.
+	 */
+	UTexture2D* FindOrLoad(const FArticyId& AssetId);
+
+	/** Called with the ID of the articy asset when a preview image finished loading. */
+	FOnArticyPreviewImageLoaded OnPreviewImageLoaded;
+
+	/** The number of preview images the cache keeps before it removes the least recently used ones. */
+	static constexpr int32 MaxImages = 256;
+
+private:
+	void OnImageLoaded(const FArticyId& AssetId, UObject* Loaded);
+	void RemoveLeastRecentlyUsed();
+	void OnAssetsPreDelete(const TArray<UObject*>& Objects);
+
+	/** Removes all images, the IDs may refer to other assets after assets were generated. */
+	void Empty() { Images.Empty(); }
+
+	UPROPERTY(Transient)
+	TMap<FArticyId, FArticyCachedPreviewImage> Images;
+
+	uint64 UseCounter = 0;
+
+	FDelegateHandle AssetsGeneratedHandle;
+	FDelegateHandle AssetsPreDeleteHandle;
+};
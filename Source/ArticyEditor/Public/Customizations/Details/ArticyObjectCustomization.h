@@ -0,0 +1,35 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IDetailCustomization.h"
+
+/**
+ * @class FArticyObjectCustomization
+ * @brief Adds the references to an articy object to its details panel.
+ *
+ * This class adds an Incoming References category to the details of articy objects, listing the objects which connect
+ * or jump to it, refer to it by a property, or name it in a script, from the reference indices of the packages.
+ */
+class FArticyObjectCustomization : public IDetailCustomization
+{
+public:
+	/**
+	 * @brief Creates an instance of the ArticyObjectCustomization.
+	 *
+	 * @return A shared pointer to a new instance of the ArticyObjectCustomization class.
+	 */
+	static TSharedRef<IDetailCustomization> MakeInstance();
+
+	/**
+	 * @brief Adds the incoming references of a single articy object to the details panel.
+	 *
+	 * The other categories are kept, nothing is shown if several objects are selected.
+	 *
+	 * @param DetailBuilder The detail layout builder used to customize the details panel.
+	 */
+	virtual void CustomizeDetails(IDetailLayoutBuilder& DetailBuilder) override;
+};
@@ -99,6 +99,13 @@ public:
      */
     const FName& GetPropetyName() const { return Property; }
 
+    /**
+     * Returns whether the property is generated as editor-only data, see UArticyPluginSettings::EditorOnlyProperties.
+     *
+     * @return True if cooked builds do not have the property.
+     */
+    bool IsEditorOnly() const;
+
     /**
      * Returns the original type of the property.
      *
@@ -122,6 +129,30 @@ public:
     FString GetCppType(const UArticyImportData* Data) const;
 
 private:
+    /**
+     * The setter of the property, compiled on its first use by InitializeModel: the type converting the JSON value,
+     * and the property with its slot in the property table of the models.
+     */
+    struct FCompiledSetter
+    {
+        FArticyPredefinedTypeBase* Type = nullptr;
+        FProperty* Property = nullptr;
+        int32 Slot = INDEX_NONE;
+        /** The key of the property in the JSON of the models, and the suffix of its localization path. */
+        FString JsonKey;
+        FString PathSuffix;
+    };
+
+    /**
+     * Returns the compiled setter, after resolving the property for the class of a model.
+     *
+     * @param Model The model about to be initialized.
+     * @return The compiled setter.
+     */
+    const FCompiledSetter& GetSetter(const UArticyBaseObject* Model) const;
+
+    mutable FCompiledSetter Setter;
+
     UPROPERTY(VisibleAnywhere, Category = "ObjectProperty")
     FName Property = "";
     UPROPERTY(VisibleAnywhere, Category = "ObjectProperty")
@@ -187,6 +218,15 @@ public:
      */
     void GenerateDefCode(CodeFileGenerator& header, const UArticyImportData* Data) const;
 
+    /**
+     * Adds the imported types the generated feature class depends on.
+     *
+     * @param Data A pointer to the UArticyImportData object.
+     * @param OutIncludes Receives the types whose headers have to be included.
+     * @param OutDeclarations Receives the types which only need a forward declaration.
+     */
+    void GatherCodeDependencies(const UArticyImportData* Data, TSet<FName>& OutIncludes, TSet<FName>& OutDeclarations) const;
+
     /**
      * Generates property code for the template feature using CodeFileGenerator.
      *
@@ -283,14 +323,6 @@ public:
      */
     void ImportFromJson(const TSharedPtr<FJsonObject> JsonObject, const UArticyImportData* Data);
 
-    /**
-     * Generates feature definitions in the header file using CodeFileGenerator.
-     *
-     * @param header A reference to the CodeFileGenerator.
-     * @param Data A pointer to the UArticyImportData object.
-     */
-    void GenerateFeaturesDefs(CodeFileGenerator& header, const UArticyImportData* Data) const;
-
     /**
      * Generates property definitions in the header file using CodeFileGenerator.
      *
@@ -398,6 +430,16 @@ public:
      */
     void GenerateCode(CodeFileGenerator& header, const UArticyImportData* Data) const;
 
+    /**
+     * Adds the imported types the generated class (or enum) depends on: the base type and the types of the properties.
+     * The features are not added, see GetFeatures.
+     *
+     * @param Data A pointer to the UArticyImportData object.
+     * @param OutIncludes Receives the types whose headers have to be included.
+     * @param OutDeclarations Receives the types which only need a forward declaration.
+     */
+    void GatherCodeDependencies(const UArticyImportData* Data, TSet<FName>& OutIncludes, TSet<FName>& OutDeclarations) const;
+
     /**
      * Find all script fragments, add them to the UArticyImportData, and replace them with an id.
      *
@@ -444,6 +486,13 @@ public:
      */
     const FName& GetOriginalType() const { return Type; }
 
+    /**
+     * Returns whether the object definition is an enum.
+     *
+     * @return True for enums, false for models and templates.
+     */
+    bool IsEnum() const { return DefType == EObjectDefType::Enum; }
+
     /**
      * Returns the features of the object definition.
      *
@@ -529,6 +578,36 @@ public:
      */
     FString GetCppType(const FName& OriginalType, const UArticyImportData* Data, const bool bForProperty) const;
 
+    /**
+     * Resolves the C++ types of all object definitions and features once, before the code or the assets are generated.
+     * Until EndCppTypeCache is called, GetCppType returns the resolved types instead of formatting them again.
+     * The definitions must not change in between; the cache is only read, so the generators can use it concurrently.
+     *
+     * @param Data A pointer to the UArticyImportData object.
+     */
+    void BeginCppTypeCache(const UArticyImportData* Data) const;
+
+    /** Clears the C++ types resolved by BeginCppTypeCache. */
+    void EndCppTypeCache() const;
+
+    /**
+     * Returns the C++ type of an object definition resolved by BeginCppTypeCache.
+     *
+     * @param OriginalType The original type of the object definition.
+     * @param bForProperty Whether the type is for a property.
+     * @return The C++ type, nullptr if it is not cached.
+     */
+    const FString* FindCachedCppType(const FName& OriginalType, const bool bForProperty) const;
+
+    /**
+     * Returns the C++ type of a feature resolved by BeginCppTypeCache.
+     *
+     * @param TechnicalName The technical name of the feature.
+     * @param bAsVariable Whether the type is for a variable.
+     * @return The C++ type, nullptr if it is not cached.
+     */
+    const FString* FindCachedFeatureCppType(const FString& TechnicalName, const bool bAsVariable) const;
+
     /**
      * Returns the default C++ value for a given type.
      *
@@ -576,12 +655,22 @@ public:
     static void SetProp(const FName& OriginalType, const FName& Property, PROP_SETTER_PARAMS);
 
     /**
-     * Checks if a feature type is new.
+     * Returns the type which converts the JSON values of a property type.
      *
-     * @param CppType The C++ type of the feature.
-     * @return True if the feature type is new, false otherwise.
+     * @param OriginalType The original type of the property.
+     * @return The predefined type, or the enum type for all other types.
      */
-    bool IsNewFeatureType(const FName& CppType) const;
+    static FArticyPredefinedTypeBase* GetSetterType(const FName& OriginalType);
+
+    /**
+     * Adds the imported type (and item type) of a property to the dependencies of the generated code declaring it.
+     * Enums have to be included, models and templates are only referenced by pointer and declared.
+     *
+     * @param Property The property definition.
+     * @param OutIncludes Receives the types whose headers have to be included.
+     * @param OutDeclarations Receives the types which only need a forward declaration.
+     */
+    void GatherPropertyDependencies(const FArticyPropertyDef& Property, TSet<FName>& OutIncludes, TSet<FName>& OutDeclarations) const;
 
     /**
      * Returns the types map.
@@ -631,12 +720,14 @@ private:
     TMap<FString, FArticyTexts> Texts;
 
     /**
-     * Contains the CPP type of all defined features.
-     * This is needed to prevent feature types from being imported multiple times (as they are defined multiple times in the json).
+     * The first definition of each feature, by technical name.
+     * Features are defined again by every template using them, but their classes are only generated once.
      */
-    UPROPERTY(VisibleAnywhere, Category = "ObjectDefinitions")
-    mutable TSet<FName> FeatureTypes;
-
     UPROPERTY(VisibleAnywhere, Category = "ObjectDefinitions")
     TMap<FName, FArticyTemplateFeatureDef> FeatureDefs;
+
+    /** The C++ types resolved by BeginCppTypeCache, as the class (or enum) type and the property type. */
+    mutable TMap<FName, TPair<FString, FString>> CachedCppTypes;
+    mutable TMap<FString, TPair<FString, FString>> CachedFeatureCppTypes;
+    mutable bool bCppTypesCached = false;
 };
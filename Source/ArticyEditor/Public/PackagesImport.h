@@ -14,8 +14,61 @@
 
 
 class UArticyImportData;
+class FArticyJsonScanner;
 struct FAdiSettings;
 
+/**
+ * A JSON object kept as condensed UTF-8 text, zlib compressed once the import is done with it.
+ * Only parsed on demand, so the import data does not keep the DOMs of all objects in memory.
+ */
+USTRUCT()
+struct FArticyJsonPayload
+{
+	GENERATED_BODY()
+
+public:
+
+	/**
+	 * Sets the JSON text, uncompressed until Compress is called.
+	 *
+	 * @param InUtf8 The condensed UTF-8 JSON text.
+	 */
+	void Set(TArray<uint8>&& InUtf8);
+
+	/**
+	 * Sets the JSON text from a string.
+	 *
+	 * @param Json The condensed JSON text.
+	 */
+	void Set(const FString& Json);
+
+	/** Compresses the text, if that makes it smaller. */
+	void Compress();
+
+	/** Removes the text. */
+	void Reset() { Data.Reset(); Size = 0; }
+
+	/** Returns true if there is no text. */
+	bool IsEmpty() const { return Size == 0; }
+
+	/**
+	 * Parses the JSON text.
+	 *
+	 * @return The JSON object, nullptr if there is no text or it is not a JSON object.
+	 */
+	TSharedPtr<FJsonObject> Parse() const;
+
+private:
+
+	/** The UTF-8 text, compressed if it is shorter than Size. */
+	UPROPERTY()
+	TArray<uint8> Data;
+
+	/** The length of the uncompressed UTF-8 text. */
+	UPROPERTY()
+	int32 Size = 0;
+};
+
 /**
  * Represents a model definition in Articy with properties for asset reference, category, and JSON strings for properties and templates.
  */
@@ -33,6 +86,15 @@ public:
 	 */
 	void ImportFromJson(const TSharedPtr<FJsonObject> JsonModel);
 
+	/**
+	 * Imports model definition data straight from the JSON text, without building a DOM.
+	 * The properties and template are kept as condensed JSON text, like ImportFromJson does.
+	 *
+	 * @param Scanner The scanner, positioned at the JSON object of the model definition.
+	 * @return True if the model definition was read; otherwise, false.
+	 */
+	bool ImportFromJson(FArticyJsonScanner& Scanner);
+
 	/**
 	 * Gathers scripts from the model definition and adds them to the ArticyImportData.
 	 *
@@ -99,19 +161,42 @@ public:
 	const EArticyAssetCategory& GetAssetCat() const { return AssetCategory; }
 
 	/**
-	 * Gets the properties JSON object from the cached properties JSON string.
+	 * Gets the position of the model, extracted from the properties.
+	 *
+	 * @param OutPosition Receives the position of the model.
+	 * @return True if the model has a position, false otherwise.
+	 */
+	bool GetPosition(FVector2D& OutPosition) const { OutPosition = Position; return bHasPosition; }
+
+	/**
+	 * Gets the properties JSON object, parsed from the payload on first use until ReleaseJson is called.
 	 *
 	 * @return A shared pointer to the properties JSON object.
 	 */
 	TSharedPtr<FJsonObject> GetPropertiesJson() const;
 
 	/**
-	 * Gets the templates JSON object from the cached templates JSON string.
+	 * Gets the templates JSON object, parsed from the payload on first use until ReleaseJson is called.
 	 *
 	 * @return A shared pointer to the templates JSON object.
 	 */
 	TSharedPtr<FJsonObject> GetTemplatesJson() const;
 
+	/**
+	 * Parses the properties and templates JSON ahead of GenerateSubAsset.
+	 * Only touches this model definition, so different models can be parsed on different threads.
+	 */
+	void ParseJson() const;
+
+	/** Releases the parsed properties and templates JSON, the payloads are parsed again when needed. */
+	void ReleaseJson() const;
+
+	/**
+	 * Compresses the payloads of the properties and templates.
+	 * Only touches this model definition, so different models can be compressed on different threads.
+	 */
+	void CompressPayloads();
+
 private:
 
 	/**
@@ -126,11 +211,11 @@ private:
 	UPROPERTY(VisibleAnywhere, Category = "Model")
 	FName Type;
 
-	/** The TechnicalName of the model, extracted from the PropertiesJsonString. */
+	/** The TechnicalName of the model, extracted from the properties. */
 	UPROPERTY(VisibleAnywhere, Category = "Model")
 	FString TechnicalName;
 
-	/** The Id of the model, extracted from the PropertiesJsonString. */
+	/** The Id of the model, extracted from the properties. */
 	UPROPERTY(VisibleAnywhere, Category = "Model")
 	FArticyId Id = -1;
 
@@ -138,7 +223,7 @@ private:
 	UPROPERTY(VisibleAnywhere, Category = "Model")
 	FString NameAndId;
 
-	/** The Id of the parent of this model, extracted from the PropertiesJsonString. */
+	/** The Id of the parent of this model, extracted from the properties. */
 	UPROPERTY(VisibleAnywhere, Category = "Model")
 	FArticyId Parent = 0;
 
@@ -150,9 +235,24 @@ private:
 	UPROPERTY(VisibleAnywhere, Category = "Model Meta")
 	EArticyAssetCategory AssetCategory = EArticyAssetCategory::None;
 
+	/** The position of the model, extracted from the properties. Used to sort the children of the parent. */
 	UPROPERTY(VisibleAnywhere, Category = "Model")
-	FString PropertiesJsonString;
+	FVector2D Position = FVector2D::ZeroVector;
+
+	/** Whether the model has a position. */
 	UPROPERTY(VisibleAnywhere, Category = "Model")
+	bool bHasPosition = false;
+
+	/** The properties and template of the model as JSON. */
+	UPROPERTY()
+	FArticyJsonPayload PropertiesPayload;
+	UPROPERTY()
+	FArticyJsonPayload TemplatePayload;
+
+	/** The properties and template of import data saved by previous versions, used until the next import. */
+	UPROPERTY()
+	FString PropertiesJsonString;
+	UPROPERTY()
 	FString TemplateJsonString;
 
 	mutable TSharedPtr<FJsonObject> CachedPropertiesJson = nullptr;
@@ -199,12 +299,48 @@ public:
 	 */
 	UArticyPackage* GeneratePackageAsset(UArticyImportData* Data) const;//MM_CHANGE
 
+	/**
+	 * Loads the previously generated package asset, without regenerating it.
+	 *
+	 * @return A pointer to the existing UArticyPackage asset, or nullptr if there is none.
+	 */
+	UArticyPackage* FindPackageAsset() const;
+
+	/**
+	 * Adds the objects of the package to the parent-children cache of the ArticyImportData, like GeneratePackageAsset does.
+	 *
+	 * @param Data A pointer to the UArticyImportData object.
+	 */
+	void AddToParentCache(UArticyImportData* Data) const;
+
+	/**
+	 * Adds the positions of the objects of the package to a map, for the objects which have one.
+	 *
+	 * @param OutPositions The map of object positions by ID.
+	 */
+	void GatherPositions(TMap<FArticyId, FVector2D>& OutPositions) const;
+
+	/**
+	 * Adds the ids of the objects of the package to a map by technical name.
+	 * Names which more than one object has are mapped to a null id.
+	 *
+	 * @param OutObjectIds The map of object ids by technical name.
+	 */
+	void GatherObjectIds(TMap<FName, FArticyId>& OutObjectIds) const;
+
+	/**
+	 * Adds the asset references of the audio assets of the package to a map, the .wav and .ogg files ImportAudioAssets imports.
+	 *
+	 * @param OutAssetRefs The map of asset references by ID.
+	 */
+	void GatherAudioAssetRefs(TMap<FArticyId, FString>& OutAssetRefs) const;
+
 	/**
 	 * Gets the texts map from the package definition.
 	 *
-	 * @return A map of text data.
+	 * @return A constant reference to the map of text data.
 	 */
-	TMap<FString, FArticyTexts> GetTexts() const;
+	const TMap<FString, FArticyTexts>& GetTexts() const;
 
 	/**
 	 * Gets the folder path for the package.
@@ -262,6 +398,43 @@ public:
 	 */
 	FString GetScriptFragmentHash() const;
 
+	/**
+	 * Gets the hash of the objects file the package was imported from.
+	 *
+	 * @return The objects hash as a string, empty if the objects were not imported.
+	 */
+	const FString& GetObjectsHash() const;
+
+	/**
+	 * Gets the hash of the texts file the package was imported from.
+	 *
+	 * @return The texts hash as a string, empty if the texts were not imported.
+	 */
+	const FString& GetTextsHash() const;
+
+	/**
+	 * Checks if the package has the same objects and texts as another package definition, based on the file hashes.
+	 *
+	 * @param Other The other package definition to compare with.
+	 * @return True if both the objects and texts hashes are equal, false otherwise.
+	 */
+	bool HasSameContent(const FArticyPackageDef& Other) const;
+
+	/**
+	 * Checks if the assets of the package need to be regenerated, i.e. if the package is new,
+	 * was renamed or its objects or texts changed in the last import.
+	 *
+	 * @return True if the package assets need to be regenerated, false otherwise.
+	 */
+	bool GetAssetsChanged() const;
+
+	/**
+	 * Sets whether the assets of the package need to be regenerated.
+	 *
+	 * @param bChanged True if the package assets need to be regenerated.
+	 */
+	void SetAssetsChanged(bool bChanged);
+
 	/**
 	 * Equality operator for package definitions based on ID.
 	 *
@@ -302,6 +475,11 @@ private:
 
 	bool IsIncluded = false;
 	FString PreviousName = TEXT("");
+
+	/** Not saved, so any package which was not imported in this session is regenerated. */
+	bool bAssetsChanged = true;
+
+	friend struct FArticyPackageDefs;
 };
 
 /**
@@ -320,17 +498,24 @@ public:
 	 * @param Archive A reference to the ArticyArchiveReader object.
 	 * @param Json A pointer to the JSON array containing the package definitions.
 	 * @param Settings A reference to the FADISettings object.
+	 * @param Journal If set, receives the packages the import replaces or removes, to undo it with Rollback.
 	 */
-	void ImportFromJson(const UArticyArchiveReader& Archive, const TArray<TSharedPtr<FJsonValue>>* Json, FAdiSettings& Settings);
+	void ImportFromJson(const UArticyArchiveReader& Archive, const TArray<TSharedPtr<FJsonValue>>* Json, FAdiSettings& Settings, FArticyPackageDefs* Journal = nullptr);
 
 	/**
-	 * Validates the import of package definitions from a JSON array.
+	 * Undoes an import which recorded a journal (see ImportFromJson), without copying the packages.
+	 *
+	 * @param Journal The journal of the import, empty afterwards.
+	 */
+	void Rollback(FArticyPackageDefs& Journal);
+
+	/**
+	 * Validates the import of package definitions from the package list of the manifest, without reading the package files.
 	 *
-	 * @param Archive A reference to the ArticyArchiveReader object.
 	 * @param Json A pointer to the JSON array containing the package definitions.
 	 * @return True if the import is valid, false otherwise.
 	 */
-	bool ValidateImport(const UArticyArchiveReader& Archive, const TArray<TSharedPtr<FJsonValue>>* Json);
+	bool ValidateImport(const TArray<TSharedPtr<FJsonValue>>* Json) const;
 
 	/**
 	 * Gathers scripts from all package definitions and adds them to the ArticyImportData.
@@ -340,19 +525,29 @@ public:
 	void GatherScripts(UArticyImportData* Data) const;
 
 	/**
-	 * Generates assets for all package definitions and stores them in the ArticyImportData.
+	 * Gets the ids of the objects of all packages by technical name, to resolve object references in scripts.
+	 * Names which more than one object has are mapped to a null id.
+	 *
+	 * @return The map of object ids by technical name.
+	 */
+	TMap<FName, FArticyId> GetObjectIds() const;
+
+	/**
+	 * Generates assets for the package definitions and stores them in the ArticyImportData.
+	 * Packages whose assets did not change are kept as they are, unless all packages are regenerated.
 	 *
 	 * @param Data A pointer to the UArticyImportData object.
+	 * @param bRegenerateAll If true, the assets of all packages are regenerated.
 	 */
-	void GenerateAssets(UArticyImportData* Data) const;//MM_CHANGE
+	void GenerateAssets(UArticyImportData* Data, bool bRegenerateAll) const;//MM_CHANGE
 
 	/**
 	 * Gets the texts map from a specific package definition.
 	 *
 	 * @param Package The package definition to retrieve texts from.
-	 * @return A map of text data.
+	 * @return A constant reference to the map of text data.
 	 */
-	static TMap<FString, FArticyTexts> GetTexts(const FArticyPackageDef& Package);
+	static const TMap<FString, FArticyTexts>& GetTexts(const FArticyPackageDef& Package);
 
 	/**
 	 * Gets a set of package names from the package definitions.
@@ -362,11 +557,11 @@ public:
 	TSet<FString> GetPackageNames() const;
 
 	/**
-	 * Gets an array of package definitions.
+	 * Gets the package definitions, without copying their models and texts.
 	 *
-	 * @return An array of package definitions.
+	 * @return A constant reference to the array of package definitions.
 	 */
-	TArray<FArticyPackageDef> GetPackages() const;
+	const TArray<FArticyPackageDef>& GetPackages() const;
 
 	/**
 	 * Resets the packages array, clearing all package definitions.
@@ -376,4 +571,15 @@ private:
 
 	UPROPERTY(VisibleAnywhere, Category = "Packages")
 	TArray<FArticyPackageDef> Packages;
+
+	/** A package a journal does not hold, as the import kept it in place, with the state the import changes. */
+	struct FKeptPackage
+	{
+		FString Name;
+		FString PreviousName;
+		bool bAssetsChanged;
+	};
+
+	/** For journals: the kept packages by their index in Packages, which only holds their ids. */
+	TMap<int32, FKeptPackage> KeptPackages;
 };
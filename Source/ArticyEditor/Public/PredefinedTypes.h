@@ -20,8 +20,8 @@ class UArticyImportData;
 //same as PREDEFINED_TYPE_EX, but creates a ArticyObjectTypeInfo, which has a default deserializer
 #define PREDEFINE_ARTICYOBJECT_TYPE(Type) new ArticyObjectTypeInfo<Type, Type*>(#Type, #Type"*")
 
-#define PROP_SETTER_PARAMS UArticyBaseObject* Model, const FString& Path, const TSharedPtr<FJsonValue> Json, const FString& PackageName
-#define ARRAY_SETTER_PARAMS UArticyBaseObject* Model, const FString& Path, const TArray<TSharedPtr<FJsonValue>> JsonArray, const FString& PackageName
+#define PROP_SETTER_PARAMS UArticyBaseObject* Model, const FString& Path, const TSharedPtr<FJsonValue>& Json, const FString& PackageName
+#define ARRAY_SETTER_PARAMS UArticyBaseObject* Model, const FString& Path, const TArray<TSharedPtr<FJsonValue>>& JsonArray, const FString& PackageName
 #define PROP_SETTER_ARGS Model, Path, Json, PackageName
 
 // Converts Unity rich text markup to Unreal rich text markup.
@@ -46,6 +46,10 @@ struct FArticyPredefinedTypeBase
 
 	virtual void SetProp(FName Property, PROP_SETTER_PARAMS) { ensureMsgf(false, TEXT("SetProp not implemented in derived class!")); }
 	virtual void SetArray(FName ArrayProperty, ARRAY_SETTER_PARAMS) { ensureMsgf(false, TEXT("SetProp not implemented in derived class!")); }
+
+	/** Like SetProp and SetArray, for a property resolved to its slot in the property table of the class of Model. */
+	virtual void SetPropBySlot(int32 Slot, PROP_SETTER_PARAMS) { ensureMsgf(false, TEXT("SetPropBySlot not implemented in derived class!")); }
+	virtual void SetArrayBySlot(int32 Slot, ARRAY_SETTER_PARAMS) { ensureMsgf(false, TEXT("SetArrayBySlot not implemented in derived class!")); }
 };
 
 /**
@@ -78,16 +82,33 @@ struct ArticyPredefinedTypeInfo : FArticyPredefinedTypeBase
 	/** This is used to set an array property with ItemType = PropType. */
 	virtual void SetArray(FName ArrayProperty, ARRAY_SETTER_PARAMS) override
 	{
-		if (!ensure(Deserializer))
-			return;
+		if (ensure(Deserializer))
+			Model->SetProp(ArrayProperty, DeserializeArray(Model, Path, JsonArray, PackageName));
+	}
+
+	virtual void SetPropBySlot(int32 Slot, PROP_SETTER_PARAMS) override
+	{
+		if (ensure(Deserializer))
+			Model->SetPropBySlot<PropType>(Slot, Deserializer(PROP_SETTER_ARGS));
+	}
+
+	virtual void SetArrayBySlot(int32 Slot, ARRAY_SETTER_PARAMS) override
+	{
+		if (ensure(Deserializer))
+			Model->SetPropBySlot(Slot, DeserializeArray(Model, Path, JsonArray, PackageName));
+	}
 
+private:
+
+	const TArray<PropType>& DeserializeArray(ARRAY_SETTER_PARAMS) const
+	{
 		static TArray<PropType> PropArray;
 
 		PropArray.Reset(JsonArray.Num());
 		for (auto j : JsonArray)
 			PropArray.Add(Deserializer(Model, Path, j, PackageName));
 
-		Model->SetProp(ArrayProperty, PropArray);
+		return PropArray;
 	}
 };
 
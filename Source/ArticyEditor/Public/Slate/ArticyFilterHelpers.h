@@ -7,12 +7,104 @@
 #include "ArticyGlobalVariables.h"
 #include "FrontendFilterBase.h"
 #include "Misc/TextFilterExpressionEvaluator.h"
+#include "Misc/TextFilterUtils.h"
 #include "ArticyObject.h"
 
 #define LOCTEXT_NAMESPACE "ArticyFilterHelpers"
 
+/**
+ * The searchable texts of an articy object, gathered once per import by UArticyObjectIndexSubsystem::GetSearchIndex.
+ * The filters only read these, so the objects are filtered without touching them, also on worker threads.
+ */
+struct FArticyObjectSearchEntry
+{
+	/** The object, may only be resolved on the game thread. */
+	TWeakObjectPtr<UArticyObject> Object;
+	const UClass* Class = nullptr;
+
+	FTextFilterString AssetName;
+	FTextFilterString TechnicalName;
+	FTextFilterString DisplayName;
+	FTextFilterString Text;
+	FTextFilterString SpeakerDisplayName;
+	FTextFilterString ClassPath;
+	FTextFilterString ObjectPath;
+	FTextFilterString PackageName;
+	FTextFilterString PackagePath;
+
+	/**
+	 * Gathers the searchable texts of an object, must be called on the game thread.
+	 *
+	 * @param InObject The object to gather the texts of.
+	 * @param Speaker The speaker of the object, if it has one.
+	 */
+	FArticyObjectSearchEntry(UArticyObject* InObject, const UArticyObject* Speaker);
+};
+
+/**
+ * An inverted index of the words in the search entries, i.e. of the names, texts, speaker names and class paths.
+ *
+ * A word is a run of letters, digits and underscores. A plain search term consists of such characters only, so it
+ * can only be found within a single word of an entry; looking it up among the suffixes of the words gives all
+ * entries which may contain it, without comparing the texts of all entries.
+ */
+class FArticyObjectTokenIndex
+{
+public:
+	/**
+	 * Builds the index over the entries of the packages.
+	 *
+	 * @param Packages The entries of each package, which must outlive the index.
+	 */
+	void Build(const TArray<TSharedRef<const TArray<FArticyObjectSearchEntry>, ESPMode::ThreadSafe>>& Packages);
+
+	/**
+	 * Finds the entries which contain all words of a plain filter text, the text filter still has to be applied to them.
+	 *
+	 * @param FilterText The filter text.
+	 * @param OutCandidates Receives the entries which may pass the filter text, in the order of the packages.
+	 * @return False if the filter text is empty or uses operators or quotes, which the index cannot answer.
+	 */
+	bool FindCandidates(const FString& FilterText, TArray<const FArticyObjectSearchEntry*>& OutCandidates) const;
+
+	/** Returns the number of distinct words in the index. */
+	int32 GetNumTokens() const { return Tokens.Num(); }
+
+private:
+	/** The position of a suffix of a word, the suffixes are sorted by their text. */
+	struct FSuffix
+	{
+		int32 Token;
+		int32 Offset;
+	};
+
+	void AddTokens(const FTextFilterString& Text, int32 EntryIndex, TMap<FString, int32>& TokenIndices);
+
+	TArray<const FArticyObjectSearchEntry*> Entries;
+
+	/** The distinct words in upper case, and the sorted indices of the entries containing each of them. */
+	TArray<FString> Tokens;
+	TArray<TArray<int32>> Postings;
+
+	TArray<FSuffix> Suffixes;
+};
+
+/**
+ * The search entries of all articy objects of the generated packages. Immutable once created, so a filter running on
+ * a worker thread can keep using it while the index is updated.
+ */
+struct FArticyObjectSearchIndex
+{
+	/** The entries of each package, the arrays of unchanged packages are shared with the previous index. */
+	TArray<TSharedRef<const TArray<FArticyObjectSearchEntry>, ESPMode::ThreadSafe>> Packages;
+	int32 NumEntries = 0;
+
+	/** The words of all entries, built with the index once per import. */
+	FArticyObjectTokenIndex TokenIndex;
+};
+
 // Define the filter types used for Articy objects and variables.
-typedef const FAssetData& FArticyObjectFilterType;
+typedef const FArticyObjectSearchEntry& FArticyObjectFilterType;
 typedef TFilterCollection<FArticyObjectFilterType> FArticyObjectFilterCollectionType;
 
 typedef const UArticyVariable*& FArticyVariableFilterType;
@@ -86,10 +178,23 @@ public:
 	 */
 	void SetIncludeClassName(const bool InIncludeClassName);
 
+	/** Returns whether the text filter includes an asset's class name in the search. */
+	bool GetIncludeClassName() const { return bIncludeClassName; }
+
+	/**
+	 * Checks whether every item which passes this filter passed a previous filter text too, i.e. whether the items
+	 * which passed the previous text can be filtered instead of all items. True if the text only grew by characters or
+	 * terms at its end, without any operators.
+	 *
+	 * @param PreviousFilterText The previous filter text.
+	 * @return True if the items which passed the previous filter text are a superset of the ones passing this one.
+	 */
+	bool IsNarrowerThan(const FText& PreviousFilterText) const;
+
 private:
 
-	/** Transient context data, used when calling PassesFilter. Kept around to minimize re-allocations between multiple calls to PassesFilter */
-	TSharedRef<class FFrontendFilter_ArticyObjectFilterExpressionContext> TextFilterExpressionContext;
+	/** Whether the class name is included in the search, see SetIncludeClassName. */
+	bool bIncludeClassName = true;
 
 	/** Expression evaluator that can be used to perform complex text filter queries */
 	FTextFilterExpressionEvaluator TextFilterExpressionEvaluator;
@@ -118,6 +223,10 @@ public:
 	 * @param bNewExactClass Whether the class restriction is exact.
 	 */
 	void UpdateExactClass(bool bNewExactClass) { bExactClass = bNewExactClass; OnChanged().Broadcast(); }
+	/** Gets the class allowed by the filter. */
+	TSubclassOf<UArticyObject> GetAllowedClass() const { return AllowedClass; }
+	/** Gets whether the class restriction is exact. */
+	bool IsExactClass() const { return bExactClass; }
 	// IFilter implementation
 	/** Determines if the given item passes the class restriction filter.
 	 *
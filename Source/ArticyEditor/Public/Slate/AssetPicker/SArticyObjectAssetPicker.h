@@ -28,8 +28,16 @@ namespace FArticyObjectAssetPicketConstants {
 	const FVector2D TileSize(96.f, 96.f);
 	const int32 ThumbnailPadding = 2;
 
+	/** The number of objects up to which the picker filters on the game thread instead of on a worker. */
+	const int32 MaxSynchronousFilterCandidates = 2048;
+
+	/** The number of objects a worker filters before handing its matches to the picker. */
+	const int32 FilterChunkSize = 512;
+
 }
 
+struct FArticyObjectAssetPickerFilterTask;
+
 /**
  * @brief A widget for picking Articy object assets.
  *
@@ -174,6 +182,23 @@ private:
 	 */
 	void RefreshSourceItems();
 
+	/**
+	 * @brief Adds the matches a filter task found so far to the tile view, and finishes the task once it is done.
+	 */
+	void DrainFilterTask();
+
+	/**
+	 * @brief Cancels the running filter task, if any.
+	 */
+	void CancelFilterTask();
+
+	/**
+	 * @brief Adds matched search entries to the filtered objects.
+	 *
+	 * @param Entries The matched entries.
+	 */
+	void AddMatches(const TArray<const FArticyObjectSearchEntry*>& Entries);
+
 	/**
 	 * @brief Sets the search box text for filtering assets.
 	 *
@@ -187,12 +212,12 @@ private:
 	void OnFrontendFiltersChanged();
 
 	/**
-	 * @brief Tests an asset item against frontend filters.
+	 * @brief Tests a search entry against frontend filters.
 	 *
-	 * @param Item The asset item to test.
+	 * @param Item The search entry to test.
 	 * @return True if the item passes all filters, false otherwise.
 	 */
-	bool TestAgainstFrontendFilters(const FAssetData& Item) const;
+	bool TestAgainstFrontendFilters(const FArticyObjectSearchEntry& Item) const;
 
 	/**
 	 * @brief Focuses the search field widget.
@@ -224,9 +249,16 @@ private: // Internal Data
 	TSharedPtr<FArticyClassRestrictionFilter> ClassFilter; //!< Shared pointer to the class restriction filter.
 	TSharedPtr<FFrontendFilter_ArticyObject> ArticyObjectFilter; //!< Shared pointer to the frontend filter for Articy objects.
 
-	TArray<FAssetData> ArticyPackageDataAssets; //!< Array of asset data for Articy packages.
 	TArray<TWeakObjectPtr<UArticyObject>> FilteredObjects; //!< Array of filtered Articy objects.
 	bool bSlowFullListRefreshRequested = false; //!< Flag indicating whether a slow full list refresh is requested.
+
+	TSharedPtr<const FArticyObjectSearchIndex, ESPMode::ThreadSafe> SearchIndex; //!< The search index of the last refresh, keeps the matched entries alive.
+	TArray<const FArticyObjectSearchEntry*> MatchedEntries; //!< The entries of the search index which passed the filters.
+	FText MatchedFilterText; //!< The filter text the entries were matched with.
+	const UClass* MatchedClass = nullptr; //!< The class restriction the entries were matched with.
+	bool bMatchedExactClass = false; //!< Whether the entries were matched with an exact class restriction.
+	bool bMatchesComplete = false; //!< Whether all candidates were tested, only then the matches can be narrowed by the next refresh.
+	TSharedPtr<FArticyObjectAssetPickerFilterTask, ESPMode::ThreadSafe> FilterTask; //!< The filter task running on a worker, if any.
 };
 
 #undef LOCTEXT_NAMESPACE
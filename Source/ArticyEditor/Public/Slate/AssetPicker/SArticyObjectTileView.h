@@ -50,15 +50,11 @@ public:
 	void Construct(const FArguments& InArgs);
 
 	/**
-	 * @brief Ticks the widget for updates.
+	 * @brief Updates the widget if the Articy ID to display changed, or its object is not loaded anymore.
 	 *
-	 * This method is called each frame to update the widget.
-	 *
-	 * @param AllottedGeometry The geometry of the widget.
-	 * @param InCurrentTime The current time.
-	 * @param InDeltaTime The time elapsed since the last tick.
+	 * The widget does not tick; this is called when a property was changed and by the widgets owning the tile view.
 	 */
-	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+	void Refresh();
 
 	/**
 	 * @brief Updates the widget with a new Articy ID.
@@ -132,6 +128,26 @@ private:
 	 */
 	void UpdateWidget();
 
+	/**
+	 * @brief Looks up the object again after the assets were generated, its preview or type may have changed.
+	 */
+	void OnAssetsGenerated();
+
+	/**
+	 * @brief Refreshes the widget after a property of any object changed, which may be the displayed ID.
+	 *
+	 * @param Object The object whose property changed.
+	 * @param PropertyChangedEvent The change.
+	 */
+	void OnObjectPropertyChanged(UObject* Object, struct FPropertyChangedEvent& PropertyChangedEvent);
+
+	/**
+	 * @brief Replaces the placeholder with the preview image once it is loaded.
+	 *
+	 * @param AssetId The ID of the articy asset of the loaded preview image.
+	 */
+	void OnPreviewImageLoaded(const FArticyId& AssetId);
+
 	/**
 	 * @brief Gets the entity name to display.
 	 *
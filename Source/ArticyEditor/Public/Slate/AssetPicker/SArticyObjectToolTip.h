@@ -41,6 +41,16 @@ protected:
 	/** Updates the tooltip widget's content. */
 	void UpdateWidget();
 
+	/** Chooses the image of the tooltip: the preview image, the preview image of the speaker, or the type image. */
+	void UpdateTooltipBrush();
+
+	/**
+	 * Replaces the placeholder with the preview image once it is loaded.
+	 *
+	 * @param AssetId The ID of the articy asset of the loaded preview image.
+	 */
+	void OnPreviewImageLoaded(const FArticyId& AssetId);
+
 	/** The attribute containing the Articy ID to display. */
 	TAttribute<FArticyId> ArticyIdAttribute;
 
@@ -0,0 +1,38 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "ArticyVariableChangeListener.generated.h"
+
+class UArticyVariable;
+class UArticyBaseVariableSet;
+
+DECLARE_DELEGATE_OneParam(FOnArticyVariableChangedNative, UArticyVariable*);
+
+/**
+ * Forwards the OnVariableChanged events of variable sets to a native delegate, so Slate widgets can react to
+ * changed variables without polling them.
+ */
+UCLASS(Transient)
+class UArticyVariableChangeListener : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Starts forwarding the changes of the variables of a set. */
+	void Listen(UArticyBaseVariableSet* VariableSet);
+
+	/** Stops forwarding the changes of the variables of a set. */
+	void StopListening(UArticyBaseVariableSet* VariableSet);
+
+	/** Executed with every changed variable of the sets this listens to. */
+	FOnArticyVariableChangedNative OnVariableChanged;
+
+private:
+	UFUNCTION()
+	void HandleVariableChanged(UArticyVariable* Variable);
+};
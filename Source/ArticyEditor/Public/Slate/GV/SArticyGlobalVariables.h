@@ -9,9 +9,13 @@
 #include "ArticyGlobalVariables.h"
 #include "Misc/TextFilterExpressionEvaluator.h"
 #include "Slate/ArticyFilterHelpers.h"
+#include "Slate/GV/ArticyVariableChangeListener.h"
+#include "UObject/StrongObjectPtr.h"
 #include "Widgets/SCompoundWidget.h"
-#include "Widgets/Layout/SExpandableArea.h"
+#include "Widgets/Input/SCheckBox.h"
 #include "Widgets/Layout/SSplitter.h"
+#include "Widgets/Views/STableRow.h"
+#include "Widgets/Views/STreeView.h"
 #include "Widgets/SBoxPanel.h"
 
 /** ref: detailcategorygroupnode.cpp */
@@ -24,86 +28,95 @@ struct FGlobalVariablesSizeData
 	void SetColumnWidth(float InWidth) { OnWidthChanged.ExecuteIfBound(InWidth); }
 };
 
+/** An item of the global variables tree: a namespace, or one of the variables of a namespace. */
+struct FArticyGlobalVariablesItem
+{
+	/** The namespace of the item. */
+	TWeakObjectPtr<UArticyBaseVariableSet> VariableSet;
+
+	/** The variable of the item, explicitly null for namespace items. */
+	TWeakObjectPtr<UArticyVariable> Variable;
+
+	/** The items of all variables of a namespace, sorted by name. Only gathered once the namespace is expanded or filtered. */
+	TArray<TSharedPtr<FArticyGlobalVariablesItem>> Variables;
+
+	/** The items of the variables which pass the filters, the children of a namespace in the tree. */
+	TArray<TSharedPtr<FArticyGlobalVariablesItem>> Children;
+
+	/** Whether the variable items of a namespace have been gathered. */
+	bool bVariablesGathered = false;
+
+	/** Checks if the item is a namespace item. */
+	bool IsNamespace() const { return Variable.IsExplicitlyNull(); }
+};
+
+typedef TSharedPtr<FArticyGlobalVariablesItem> FArticyGlobalVariablesItemPtr;
+
 /**
- * A widget representing a set of Articy variables within an expandable area.
+ * A row of the global variables tree, showing the name of a namespace or the name and value of a variable.
+ * The value is cached and only read again from the variable when Refresh is called, e.g. after it changed.
  */
-class SArticyVariableSet : public SCompoundWidget
+class SArticyGlobalVariableRow : public STableRow<FArticyGlobalVariablesItemPtr>
 {
-	SLATE_BEGIN_ARGS(SArticyVariableSet) :
-		_bInitiallyCollapsed(true),
+	SLATE_BEGIN_ARGS(SArticyGlobalVariableRow) :
 		_SizeData(nullptr)
 		{}
 
-		/** Whether the variable set should be initially collapsed. */
-		SLATE_ARGUMENT(bool, bInitiallyCollapsed)
-
 		/** Pointer to size data for controlling column widths. */
 		SLATE_ARGUMENT(const FGlobalVariablesSizeData*, SizeData)
 
 	SLATE_END_ARGS()
 
 	/**
-	 * Constructs the variable set widget.
+	 * Constructs the row widget.
 	 *
 	 * @param Args The widget arguments.
-	 * @param VariableSet The variable set to represent.
+	 * @param OwnerTable The tree view owning the row.
+	 * @param InItem The item to represent.
 	 */
-	void Construct(const FArguments& Args, TWeakObjectPtr<UArticyBaseVariableSet> VariableSet);
+	void Construct(const FArguments& Args, const TSharedRef<STableViewBase>& OwnerTable, FArticyGlobalVariablesItemPtr InItem);
 
-	/**
-	 * Sets the expanded state of the variable set.
-	 *
-	 * @param bInExpanded Whether to expand or collapse the variable set.
-	 */
-	void SetExpanded(bool bInExpanded) const;
+	/** Reads the value of the variable again. */
+	void Refresh();
 
 	/**
-	 * Checks if the variable set is expanded.
+	 * Retrieves the variable of the row.
 	 *
-	 * @return True if expanded, false otherwise.
+	 * @return The variable, or nullptr for namespace rows.
 	 */
-	bool IsExpanded() const;
+	UArticyVariable* GetVariable() const { return Item->Variable.Get(); }
 
-	/**
-	 * Updates the visibility of a specific variable.
-	 *
-	 * @param Variable The variable to update visibility for.
-	 * @param InVisibility The desired visibility.
-	 */
-	void UpdateVisibility(const UArticyVariable* Variable, EVisibility InVisibility);
+private:
+	/** Builds the name and value widgets of a variable row. */
+	TSharedRef<SWidget> BuildVariableWidget();
 
-	/**
-	 * Retrieves the variables in the set.
-	 *
-	 * @return An array of variables.
-	 */
-	TArray<UArticyVariable*> GetVariables();
+	/** Retrieves the cached value of a string variable. */
+	FText GetStringValue() const { return StringValue; }
 
-private:
-	/** Builds the widgets for the variables in the set. */
-	void BuildVariableWidgets();
+	/** Retrieves the cached value of an int variable. */
+	TOptional<int32> GetIntValue() const { return IntValue; }
+
+	/** Retrieves the cached value of a bool variable. */
+	ECheckBoxState GetBoolValue() const { return BoolValue; }
 
 private:
-	/** Flag indicating whether the variable widgets have been built. */
-	bool bVariableWidgetsBuilt = false;
+	/** The item being represented. */
+	FArticyGlobalVariablesItemPtr Item;
+
+	/** Pointer to size data for controlling column widths. */
+	const FGlobalVariablesSizeData* SizeData = nullptr;
 
 	/** Flag indicating whether a slider is currently being moved. */
 	bool bSliderMoving = false;
 
-	/** The variable set being represented. */
-	TWeakObjectPtr<UArticyBaseVariableSet> VariableSet;
-
-	/** Mapping of variables to their corresponding widgets. */
-	TMap<UArticyVariable*, TWeakPtr<SWidget>> VariableWidgetMapping;
+	/** The cached value of a string variable. */
+	FText StringValue;
 
-	/** Container for the variable widgets. */
-	TSharedPtr<SVerticalBox> VariableContainer;
+	/** The cached value of an int variable. */
+	int32 IntValue = 0;
 
-	/** Expandable area for the namespace. */
-	TSharedPtr<SExpandableArea> NamespaceExpansion;
-
-	/** Pointer to size data for controlling column widths. */
-	const FGlobalVariablesSizeData* SizeData = nullptr;
+	/** The cached value of a bool variable. */
+	ECheckBoxState BoolValue = ECheckBoxState::Unchecked;
 
 	/**
 	 * Handles value changes for variables.
@@ -118,7 +131,7 @@ private:
 };
 
 template <typename T, typename T2>
-void SArticyVariableSet::OnValueChanged(T Value, T2* Var)
+void SArticyGlobalVariableRow::OnValueChanged(T Value, T2* Var)
 {
 	if (bSliderMoving)
 	{
@@ -133,6 +146,10 @@ void SArticyVariableSet::OnValueChanged(T Value, T2* Var)
 
 /**
  * A widget for displaying and managing Articy global variables.
+ *
+ * The namespaces and variables are shown in a virtualized tree, so only the rows in view have widgets. The variables
+ * of a namespace are only gathered once it is expanded or filtered, and the rows read their values again when the
+ * variables broadcast a change instead of on every paint.
  */
 class SArticyGlobalVariables : public SCompoundWidget
 {
@@ -143,6 +160,9 @@ class SArticyGlobalVariables : public SCompoundWidget
 		SLATE_ARGUMENT(bool, bInitiallyCollapsed)
 	SLATE_END_ARGS()
 
+	/** Stops listening to the changes of the displayed variables. */
+	virtual ~SArticyGlobalVariables();
+
 	/**
 	 * Constructs the global variables widget.
 	 *
@@ -183,6 +203,27 @@ private:
 	void OnSetColumnWidth(float InWidth) { ColumnWidth = InWidth; }
 
 private:
+	/** Generates the row widget of a tree item. */
+	TSharedRef<ITableRow> OnGenerateRow(FArticyGlobalVariablesItemPtr Item, const TSharedRef<STableViewBase>& OwnerTable);
+
+	/** Forgets a row widget which is no longer in view. */
+	void OnRowReleased(const TSharedRef<ITableRow>& Row);
+
+	/** Retrieves the children of a tree item, gathering the variables of a namespace once it is expanded. */
+	void OnGetChildren(FArticyGlobalVariablesItemPtr Item, TArray<FArticyGlobalVariablesItemPtr>& OutChildren);
+
+	/** Gathers the variable items of a namespace item, if not done yet. */
+	void GatherVariables(const FArticyGlobalVariablesItemPtr& NamespaceItem) const;
+
+	/** Sets the children of a namespace item to the gathered variables which pass the frontend filters. */
+	void ApplyFilters(const FArticyGlobalVariablesItemPtr& NamespaceItem) const;
+
+	/** Refreshes the row of a variable which changed, if it is in view. */
+	void OnVariableChanged(UArticyVariable* Variable);
+
+	/** Refreshes the row of a variable whose value was changed by an undo or redo. */
+	void OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
+
 	/** Handles changes in the search box text. */
 	void OnSearchBoxChanged(const FText& InSearchText);
 
@@ -198,24 +239,39 @@ private:
 	/** Tests a variable against the frontend filters. */
 	bool TestAgainstFrontendFilters(const UArticyVariable* Item) const;
 
-	/** Caches the expansion states of variable sets. */
+	/** Caches the expansion states of the namespaces. */
 	void CacheExpansionStates();
 
-	/** Restores the expansion states of variable sets. */
+	/** Restores the expansion states of the namespaces. */
 	void RestoreExpansionStates();
 
+	/** Stops listening to the changes of the variables of the displayed namespaces. */
+	void StopListening();
+
 private:
-	/** Container for the variable set widgets. */
-	TSharedPtr<SVerticalBox> SetContainer;
+	/** The tree view of the namespaces and variables. */
+	TSharedPtr<STreeView<FArticyGlobalVariablesItemPtr>> TreeView;
+
+	/** The items of all namespaces, sorted by name. */
+	TArray<FArticyGlobalVariablesItemPtr> NamespaceItems;
+
+	/** The items of the namespaces with variables which pass the filters, the root items of the tree. */
+	TArray<FArticyGlobalVariablesItemPtr> RootItems;
+
+	/** Stands in for the variables of a collapsed namespace which were not gathered yet, so it can be expanded. */
+	TArray<FArticyGlobalVariablesItemPtr> PlaceholderChildren;
+
+	/** The rows of the variables in view, refreshed when their variable changes. */
+	TMap<const UArticyVariable*, TWeakPtr<SArticyGlobalVariableRow>> VariableRows;
 
-	/** Array of variable set widgets. */
-	TArray<TSharedPtr<SArticyVariableSet>> VariableSetWidgets;
+	/** Forwards the changes of the variables of the displayed namespaces. */
+	TStrongObjectPtr<UArticyVariableChangeListener> ChangeListener;
 
 	/** Flag indicating whether sets should be force expanded. */
 	bool bShouldForceExpand = false;
 
-	/** Cache for the expansion states of variable sets. */
-	TMap<TSharedPtr<SArticyVariableSet>, bool> ExpansionCache;
+	/** Cache for the expansion states of the namespaces, by name. */
+	TMap<FString, bool> ExpansionCache;
 
 	/** Filter for variable names. */
 	TSharedPtr<FFrontendFilter_ArticyVariable> VariableFilter;
@@ -0,0 +1,101 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/DeclarativeSyntaxSupport.h"
+#include "Widgets/Views/SListView.h"
+#include "Widgets/Views/SHeaderRow.h"
+#include "ArticyGvProfiler.h"
+
+class UArticyDatabase;
+
+/** A row of the GV profiler table: the accesses of a variable from a fragment, with the source of the fragment. */
+struct FArticyGvProfilerItem
+{
+	FArticyGvProfiler::FRow Row;
+
+	/** The name of the object owning the fragment, and its text. */
+	FString Owner;
+	FString Text;
+};
+
+/**
+ * A widget showing the reads and writes of the global variables recorded by FArticyGvProfiler, as a table which
+ * can be sorted by each column. The table is refreshed once per second while recording.
+ */
+class SArticyGvProfiler : public SCompoundWidget
+{
+	SLATE_BEGIN_ARGS(SArticyGvProfiler) {}
+	SLATE_END_ARGS()
+
+	/**
+	 * Constructs the GV profiler widget.
+	 *
+	 * @param Args The construction arguments.
+	 */
+	void Construct(const FArguments& Args);
+
+	/**
+	 * Refreshes the table once per second while recording.
+	 *
+	 * @param AllottedGeometry The geometry of the widget.
+	 * @param InCurrentTime The current time.
+	 * @param InDeltaTime The time since the last tick.
+	 */
+	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+
+private:
+	/** Reads the rows of the profiler again, and sorts them. */
+	void Refresh();
+
+	/** Sorts the items by the current sort column. */
+	void SortItems();
+
+	/**
+	 * Handles a click on a column header.
+	 *
+	 * @param SortPriority Unused, the table is sorted by one column.
+	 * @param ColumnId The column clicked.
+	 * @param NewSortMode The new sort mode of the column.
+	 */
+	void OnSortColumn(EColumnSortPriority::Type SortPriority, const FName& ColumnId, EColumnSortMode::Type NewSortMode);
+
+	/** Returns the sort mode of a column. */
+	EColumnSortMode::Type GetSortMode(FName ColumnId) const;
+
+	/** Generates the widget of a row. */
+	TSharedRef<ITableRow> OnGenerateRow(TSharedPtr<FArticyGvProfilerItem> Item, const TSharedRef<STableViewBase>& OwnerTable);
+
+	/** Enables or disables the recording. */
+	void OnRecordingChanged(ECheckBoxState NewState);
+
+	/** Returns whether the accesses are recorded. */
+	ECheckBoxState IsRecording() const;
+
+	/** Discards the recorded counts. */
+	FReply OnReset();
+
+	/** Writes the counts to Saved/Articy/Profiles/GVProfile.csv. */
+	FReply OnExportCsv();
+
+	/** Returns the database of the play session, or nullptr if none is running. */
+	const UArticyDatabase* GetPlayDatabase() const;
+
+private:
+	/** The items shown. */
+	TArray<TSharedPtr<FArticyGvProfilerItem>> Items;
+
+	/** The table. */
+	TSharedPtr<SListView<TSharedPtr<FArticyGvProfilerItem>>> ListView;
+
+	/** The column the items are sorted by, and the direction. */
+	FName SortColumn;
+	EColumnSortMode::Type SortMode = EColumnSortMode::Descending;
+
+	/** The time since the last refresh. */
+	float TimeSinceRefresh = 0.f;
+};
@@ -70,13 +70,10 @@ public:
 	void Construct(const FArguments& InArgs);
 
 	/**
-	 * Tick function for the widget, updates the widget state.
-	 *
-	 * @param AllottedGeometry The allotted geometry for this widget.
-	 * @param InCurrentTime The current time.
-	 * @param InDeltaTime The time elapsed since the last tick.
+	 * Updates the widget if the Articy ID to display changed, or its object is not loaded anymore.
+	 * The widget does not tick; this is called when a property was changed or a new ID was picked.
 	 */
-	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+	void Refresh();
 
 	/**
 	 * Creates the internal widgets for the ArticyId property editor.
@@ -133,6 +130,19 @@ private:
 	 */
 	void ApplyArticyRefCustomizations(const TArray<FArticyIdPropertyWidgetCustomizationInfo>& Customizations);
 
+	/**
+	 * Looks up the object again after the assets were generated, and rebuilds its customizations.
+	 */
+	void OnAssetsGenerated();
+
+	/**
+	 * Refreshes the widget after a property of any object changed, which may be the displayed ID.
+	 *
+	 * @param Object The object whose property changed.
+	 * @param PropertyChangedEvent The change.
+	 */
+	void OnObjectPropertyChanged(UObject* Object, struct FPropertyChangedEvent& PropertyChangedEvent);
+
 private:
 	/**
 	 * Creates an Articy object asset picker widget.
@@ -153,7 +163,7 @@ private:
 	 *
 	 * @param ArticyObjectData The asset data of the picked object.
 	 */
-	void OnArticyObjectPicked(const FAssetData& ArticyObjectData) const;
+	void OnArticyObjectPicked(const FAssetData& ArticyObjectData);
 
 	/**
 	 * Handles the click event for the Articy button.
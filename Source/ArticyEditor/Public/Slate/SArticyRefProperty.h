@@ -46,13 +46,10 @@ public:
 	void Construct(const FArguments& InArgs);
 
 	/**
-	 * Updates the widget state on each tick.
-	 *
-	 * @param AllottedGeometry The geometry allocated for this widget.
-	 * @param InCurrentTime The current time.
-	 * @param InDeltaTime The time elapsed since the last tick.
+	 * Updates the widget if the ArticyRef to display changed, or its object is not loaded anymore.
+	 * The widget does not tick; this is called when a property was changed.
 	 */
-	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+	void Refresh();
 
 	/**
 	 * Creates internal widgets used in the ArticyRefProperty.
@@ -109,6 +106,19 @@ private:
 	 */
 	void UpdateWidget();
 
+	/**
+	 * Looks up the object again after the assets were generated.
+	 */
+	void OnAssetsGenerated();
+
+	/**
+	 * Refreshes the widget after a property of any object changed, which may be the displayed ref.
+	 *
+	 * @param Object The object whose property changed.
+	 * @param PropertyChangedEvent The change.
+	 */
+	void OnObjectPropertyChanged(UObject* Object, struct FPropertyChangedEvent& PropertyChangedEvent);
+
 private:
 	/**
 	 * Copies the property value to the clipboard.
@@ -45,13 +45,23 @@ namespace UserInterfaceHelperFunctions
 
 	/**
 	 * Retrieves the preview image associated with an Articy object and assigns it to the specified Slate brush.
+	 * The image is loaded in the background, UArticyPreviewCacheSubsystem::OnPreviewImageLoaded is broadcast once it is loaded.
 	 *
 	 * @param ArticyObject The Articy object for which to retrieve the preview image.
 	 * @param OutSlateBrush The Slate brush to which the preview image will be assigned.
-	 * @return True if a preview image was successfully retrieved and assigned; otherwise, false.
+	 * @return True if a preview image was successfully retrieved and assigned; false if there is none or it is still loading.
 	 */
 	ARTICYEDITOR_API bool RetrievePreviewImage(const UArticyObject* ArticyObject, FSlateBrush& OutSlateBrush);
 
+	/**
+	 * Retrieves the ID of the articy asset of the preview image of an Articy object, or of its speaker.
+	 *
+	 * @param ArticyObject The Articy object for which to retrieve the ID.
+	 * @param bSpeaker Whether to retrieve the ID of the preview image of the speaker instead.
+	 * @return The ID of the asset, or a null ID if there is no preview image.
+	 */
+	ARTICYEDITOR_API FArticyId GetPreviewImageAssetId(const UArticyObject* ArticyObject, bool bSpeaker = false);
+
 	/**
 	 * Retrieves the preview image associated with the speaker of an Articy object and assigns it to the specified Slate brush.
 	 *
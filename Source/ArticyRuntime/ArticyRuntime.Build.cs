@@ -47,6 +47,7 @@ public class ArticyRuntime : ModuleRules
 				"Engine",
 				"Slate",
 				"SlateCore",
+				"NetCore",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
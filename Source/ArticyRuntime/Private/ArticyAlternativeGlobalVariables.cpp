@@ -3,3 +3,24 @@
 //
 
 #include "ArticyAlternativeGlobalVariables.h"
+
+/**
+ * Returns the key of the runtime clone of these variables, which is their full name.
+ * @return The clone key.
+ */
+FName UArticyAlternativeGlobalVariables::GetCloneKey() const
+{
+    if (CloneKey.IsNone())
+        CloneKey = FName(*GetFullName());
+
+    return CloneKey;
+}
+
+/**
+ * Invalidates the cached clone key, as it contains the name.
+ */
+void UArticyAlternativeGlobalVariables::PostRename(UObject* OldOuter, const FName OldName)
+{
+    Super::PostRename(OldOuter, OldName);
+    CloneKey = NAME_None;
+}
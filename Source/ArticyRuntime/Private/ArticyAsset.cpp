@@ -3,45 +3,120 @@
 //
 
 #include "ArticyAsset.h"
-#include "UObject/ConstructorHelpers.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
 #include "Misc/Paths.h"
 
 /**
  * Loads the asset referenced by this Articy asset.
+ * The loaded asset is cached, so later calls only resolve the weak pointer.
  *
  * @return A pointer to the loaded UObject, or nullptr if the asset could not be loaded.
  */
 UObject* UArticyAsset::LoadAsset() const
 {
-	//if(!Asset.IsValid())
+	if (!Asset.IsValid())
 	{
-		/*static TArray<FAssetData> assets;
-
-		if(assets.Num() == 0)
-		{
-			static TWeakObjectPtr<UObjectLibrary> lib = nullptr;
-			if(!lib.IsValid())
-				lib = UObjectLibrary::CreateLibrary(UObject::StaticClass(), false, GIsEditor);
-
-			lib->LoadAssetDataFromPath(ArticyHelpers::ArticyAssetsFolder);
-			lib->GetAssetDataList(assets);
-		}*/
-
-		const auto& folder = FPaths::GetPath(AssetRef);
-		const auto& filename = FPaths::GetBaseFilename(AssetRef); //without extension
-
-		//construct the asset path like UE4 wants it
-		auto path = ArticyHelpers::GetArticyResourcesFolder() / folder / filename;
-		//UE_LOG(LogTemp, Warning, TEXT("Asset Path %s"), *path)
-#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION <= 24
-		Asset = ConstructorHelpersInternal::FindOrLoadObject<UObject>(path);
+		const FSoftObjectPath Path = GetAssetPath();
+		if (!Path.IsNull())
+			Asset = Path.TryLoad();
+	}
+
+	return Asset.Get();
+}
+
+/**
+ * Loads the asset referenced by this Articy asset in the background, using the streamable manager of the asset manager.
+ * Falls back to loading synchronously if there is no asset manager.
+ *
+ * @param OnLoaded Called with the loaded UObject, or nullptr if the asset could not be loaded.
+ */
+void UArticyAsset::LoadAssetAsync(TFunction<void(UObject*)> OnLoaded) const
+{
+	if (UObject* Loaded = Asset.Get())
+	{
+		OnLoaded(Loaded);
+		return;
+	}
+
+	const FSoftObjectPath Path = GetAssetPath();
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 3
+	const bool bHasAssetManager = UAssetManager::IsInitialized();
 #else
-		Asset = ConstructorHelpersInternal::FindOrLoadObject<UObject>(path, LOAD_None);
+	const bool bHasAssetManager = UAssetManager::IsValid();
 #endif
-
+	if (Path.IsNull() || !bHasAssetManager)
+	{
+		OnLoaded(LoadAsset());
+		return;
 	}
 
-	return Asset.Get();
+	//the streamable manager merges requests for the same asset
+	TWeakObjectPtr<const UArticyAsset> WeakThis(this);
+	UAssetManager::GetStreamableManager().RequestAsyncLoad(Path, [WeakThis, Path, OnLoaded]()
+	{
+		UObject* Loaded = Path.ResolveObject();
+		if (const UArticyAsset* This = WeakThis.Get())
+			This->Asset = Loaded;
+
+		OnLoaded(Loaded);
+	});
+}
+
+/**
+ * Loads the asset referenced by this Articy asset in the background, for Blueprints.
+ *
+ * @param OnLoaded Called with the loaded UObject, or nullptr if the asset could not be loaded.
+ */
+void UArticyAsset::K2_LoadAssetAsync(FOnArticyAssetLoaded OnLoaded) const
+{
+	LoadAssetAsync([OnLoaded](UObject* Loaded)
+	{
+		OnLoaded.ExecuteIfBound(Loaded);
+	});
+}
+
+/**
+ * Returns the object path of the referenced asset.
+ * Assets imported before AssetPath existed compute it from AssetRef.
+ *
+ * @return The object path, or a null path if there is no referenced asset.
+ */
+FSoftObjectPath UArticyAsset::GetAssetPath() const
+{
+	if (!AssetPath.IsNull() || AssetRef.IsEmpty())
+		return AssetPath;
+
+	return GetAssetPathFromRef(AssetRef);
+}
+
+/**
+ * Returns the object path of an asset imported from articy by its AssetRef.
+ *
+ * @param InAssetRef The path of the asset relative to the resources folder, with its file extension.
+ * @return The object path, or a null path if InAssetRef is empty.
+ */
+FSoftObjectPath UArticyAsset::GetAssetPathFromRef(const FString& InAssetRef)
+{
+	if (InAssetRef.IsEmpty())
+		return FSoftObjectPath();
+
+	const FString Folder = FPaths::GetPath(InAssetRef);
+	const FString Filename = FPaths::GetBaseFilename(InAssetRef); //without extension
+
+	//construct the asset path like UE wants it: /Game/<resources>/<folder>/<name>.<name>
+	const FString PackagePath = ArticyHelpers::GetArticyResourcesFolder() / Folder / Filename;
+	return FSoftObjectPath(PackagePath + TEXT(".") + Filename);
+}
+
+/**
+ * Updates AssetPath from AssetRef, so it is not computed with every load.
+ */
+void UArticyAsset::UpdateAssetPath()
+{
+	AssetPath.Reset();
+	AssetPath = GetAssetPath();
+	Asset = nullptr;
 }
 
 /**
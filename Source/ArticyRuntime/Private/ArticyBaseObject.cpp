@@ -4,8 +4,16 @@
 
 #include "ArticyBaseObject.h"
 #include "ArticyPrimitive.h"
+#include "ArticyDatabase.h"
+#include "ArticyObject.h"
 #include "ArticyTypeSystem.h"
 #include "ArticyHelpers.h"
+#include "ArticyRuntimeModule.h"
+#include "ArticyStats.h"
+#include "ArticyPluginSettings.h"
+#if WITH_EDITOR
+#include "Interfaces/ITargetPlatform.h"
+#endif
 
 /**
  * Retrieves a subobject of this Articy object using its unique identifier.
@@ -19,6 +27,56 @@ UArticyPrimitive* UArticyBaseObject::GetSubobject(FArticyId Id) const
 	return obj ? *obj : nullptr;
 }
 
+#if WITH_EDITOR
+/**
+ * Serializes the object. When cooking for a dedicated server with UArticyPluginSettings::bStripPresentationForServer,
+ * the properties listed in ServerStrippedProperties are saved with their default values; the editor keeps them.
+ *
+ * @param Ar The archive to serialize with.
+ */
+void UArticyBaseObject::Serialize(FArchive& Ar)
+{
+	const UArticyPluginSettings* Settings = UArticyPluginSettings::Get();
+	const ITargetPlatform* Target = Ar.IsSaving() && Ar.IsCooking() ? Ar.CookingTarget() : nullptr;
+	if (!Target || !Target->IsServerOnly() || !Settings->bStripPresentationForServer)
+	{
+		Super::Serialize(Ar);
+		return;
+	}
+
+	// the values are only cleared while saving
+	struct FStrippedValue
+	{
+		const FProperty* Property;
+		void* Value;
+		void* Saved;
+	};
+	TArray<FStrippedValue> Stripped;
+	for (const FString& Name : Settings->ServerStrippedProperties)
+	{
+		const FProperty* Property = GetClass()->FindPropertyByName(FName(*Name));
+		if (!Property)
+			continue;
+
+		void* Value = Property->ContainerPtrToValuePtr<void>(this);
+		void* Saved = FMemory::Malloc(Property->GetSize(), Property->GetMinAlignment());
+		Property->InitializeValue(Saved);
+		Property->CopyCompleteValue(Saved, Value);
+		Property->ClearValue(Value);
+		Stripped.Add({ Property, Value, Saved });
+	}
+
+	Super::Serialize(Ar);
+
+	for (const FStrippedValue& Entry : Stripped)
+	{
+		Entry.Property->CopyCompleteValue(Entry.Value, Entry.Saved);
+		Entry.Property->DestroyValue(Entry.Saved);
+		FMemory::Free(Entry.Saved);
+	}
+}
+#endif
+
 /**
  * Adds a subobject to this Articy object.
  *
@@ -29,6 +87,20 @@ void UArticyBaseObject::AddSubobject(UArticyPrimitive* Obj)
 	Subobjects.Add(Obj->GetId(), Obj);
 }
 
+/**
+ * Links the references of the subobjects, like the connections of the pins.
+ *
+ * @param Database The database the object is loaded into, or nullptr to unlink the references.
+ */
+void UArticyBaseObject::LinkReferences(const UArticyDatabase* Database)
+{
+	for (const auto& Subobject : Subobjects)
+	{
+		if (Subobject.Value)
+			Subobject.Value->LinkReferences(Database);
+	}
+}
+
 /**
  * Gets the Articy type of this object.
  *
@@ -49,3 +121,254 @@ FText UArticyBaseObject::GetPropertyText(const FText Property)
 {
 	return ArticyHelpers::LocalizeString(this, Property, true, &Property);
 }
+
+/**
+ * Returns a feature of this object for modification, copying it if it is shared with clones.
+ *
+ * @param Feature The name of the feature property.
+ * @return The feature of this object, or nullptr if there is no such feature.
+ */
+UArticyBaseFeature* UArticyBaseObject::GetFeatureForWrite(FName Feature)
+{
+	return GetFeatureForWrite(GetProperty(Feature));
+}
+
+/**
+ * Returns a feature of this object for modification, copying it if it is shared with clones.
+ * The copy replaces the shared feature in this object only, the others keep sharing it.
+ *
+ * @param FeatureProperty The feature property of this object's class.
+ * @return The feature of this object, or nullptr if the property is not a feature.
+ */
+UArticyBaseFeature* UArticyBaseObject::GetFeatureForWrite(const FProperty* FeatureProperty)
+{
+	const FObjectProperty* ObjectProperty = CastField<FObjectProperty>(FeatureProperty);
+	if (!ObjectProperty || !ObjectProperty->PropertyClass->IsChildOf(UArticyBaseFeature::StaticClass()))
+		return nullptr;
+
+	void* Value = ObjectProperty->ContainerPtrToValuePtr<void>(this);
+	UArticyBaseFeature* Feature = Cast<UArticyBaseFeature>(ObjectProperty->GetObjectPropertyValue(Value));
+	if (!Feature || !Feature->IsSharedWithClones())
+		return Feature;
+
+	ensureMsgf(IsInGameThread(), TEXT("Shared features can only be copied on the game thread, scripts run by a parallel exploration must not modify objects."));
+
+	UArticyBaseFeature* Copy = DuplicateObject<UArticyBaseFeature>(Feature, this);
+	Copy->CopyModifiedState(Feature);
+	ObjectProperty->SetObjectPropertyValue(Value, Copy);
+	INC_DWORD_STAT(STAT_ArticySharedFeatureCopies);
+
+	return Copy;
+}
+
+namespace
+{
+	/** Returns the feature held by a property of an object, or nullptr if the property does not hold one. */
+	UArticyBaseFeature* GetFeature(const UArticyBaseObject* Object, const FProperty* Property)
+	{
+		const FObjectProperty* ObjectProperty = CastField<FObjectProperty>(Property);
+		return ObjectProperty ? Cast<UArticyBaseFeature>(ObjectProperty->GetObjectPropertyValue_InContainer(Object)) : nullptr;
+	}
+}
+
+/**
+ * Returns the names of the properties written since the object was loaded or reset.
+ * A feature that was written is returned with its modified properties, or by its own name if it was replaced.
+ *
+ * @return The names of the modified properties, in the order of the property table.
+ */
+TArray<FString> UArticyBaseObject::GetModifiedProperties() const
+{
+	TArray<FString> Names;
+	const FArticyPropertyTable& Table = IArticyReflectable::GetPropertyTable(GetObjectClass());
+	for (TConstSetBitIterator<> It(ModifiedSlots); It; ++It)
+	{
+		const FProperty* Property = Table.Get(It.GetIndex());
+		if (!Property)
+			continue;
+
+		const UArticyBaseFeature* Feature = GetFeature(this, Property);
+		if (Feature && Feature->IsModified())
+		{
+			for (const FString& FeatureProperty : Feature->GetModifiedProperties())
+				Names.Add(Property->GetName() + TEXT(".") + FeatureProperty);
+		}
+		else
+		{
+			Names.Add(Property->GetName());
+		}
+	}
+
+	return Names;
+}
+
+/**
+ * Marks a property as modified. Objects which are not loaded into a database, like the package assets while they
+ * are imported, are not tracked.
+ *
+ * @param Property The written property.
+ * @param Slot The slot of the property, or INDEX_NONE if it is not known.
+ */
+void UArticyBaseObject::MarkModified(const FProperty* Property, int32 Slot)
+{
+	if (Slot == INDEX_NONE && Property)
+		Slot = GetPropertySlot(Property->GetFName());
+
+	if (Slot == INDEX_NONE || !GetTypedOuter<UArticyDatabase>())
+		return;
+
+	const bool bWasModified = IsModified();
+	if (ModifiedSlots.Num() <= Slot)
+		ModifiedSlots.Add(false, Slot + 1 - ModifiedSlots.Num());
+	ModifiedSlots[Slot] = true;
+
+	//the owner is modified as well, only the first write has to find the property holding the feature
+	UArticyBaseObject* Owner = !bWasModified && IsA<UArticyBaseFeature>() ? Cast<UArticyBaseObject>(GetOuter()) : nullptr;
+	if (Owner)
+	{
+		for (TFieldIterator<FObjectProperty> It(Owner->GetClass()); It; ++It)
+		{
+			if (It->GetObjectPropertyValue_InContainer(Owner) == this)
+			{
+				Owner->MarkModified(*It, INDEX_NONE);
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * Forgets the modified properties of this object, and of the features it owns.
+ */
+void UArticyBaseObject::ClearModified()
+{
+	const FArticyPropertyTable& Table = IArticyReflectable::GetPropertyTable(GetObjectClass());
+	for (TConstSetBitIterator<> It(ModifiedSlots); It; ++It)
+	{
+		UArticyBaseFeature* Feature = GetFeature(this, Table.Get(It.GetIndex()));
+		if (Feature && Feature->GetOuter() == this)
+			Feature->ClearModified();
+	}
+
+	ModifiedSlots.Empty();
+}
+
+/**
+ * Takes the modified properties of the object this one was duplicated from, including the ones of the features
+ * which were duplicated with it. Features shared with the source keep their own.
+ *
+ * @param Source The object this one is a duplicate of.
+ */
+void UArticyBaseObject::CopyModifiedState(const UArticyBaseObject* Source)
+{
+	if (!Source || Source == this)
+		return;
+
+	ModifiedSlots = Source->ModifiedSlots;
+
+	const FArticyPropertyTable& Table = IArticyReflectable::GetPropertyTable(GetObjectClass());
+	for (TConstSetBitIterator<> It(ModifiedSlots); It; ++It)
+	{
+		const FProperty* Property = Table.Get(It.GetIndex());
+		UArticyBaseFeature* Feature = GetFeature(this, Property);
+		UArticyBaseFeature* SourceFeature = GetFeature(Source, Property);
+		if (Feature && SourceFeature && Feature != SourceFeature)
+			Feature->ModifiedSlots = SourceFeature->ModifiedSlots;
+	}
+}
+
+/**
+ * Copies the modified properties back from the object this one was created from, and forgets them.
+ * Each restored property is reported like a write, so listeners and property indices see the change. Features
+ * owned by this object are restored property by property, features shared with another object are left to it.
+ *
+ * @param Original The object to copy the values from, of the same class.
+ */
+void UArticyBaseObject::RestoreModifiedProperties(const UArticyBaseObject* Original)
+{
+	if (!Original || Original->GetClass() != GetClass())
+		return;
+
+	const FArticyPropertyTable& Table = IArticyReflectable::GetPropertyTable(GetObjectClass());
+	for (TConstSetBitIterator<> It(ModifiedSlots); It; ++It)
+	{
+		FProperty* Property = Table.Get(It.GetIndex());
+		if (!Property)
+			continue;
+
+		//features are never copied from the original, which owns them
+		UArticyBaseFeature* Feature = GetFeature(this, Property);
+		UArticyBaseFeature* OriginalFeature = GetFeature(Original, Property);
+		if (Feature || OriginalFeature)
+		{
+			if (Feature && OriginalFeature && Feature != OriginalFeature && Feature->GetOuter() == this && Feature->GetClass() == OriginalFeature->GetClass())
+				Feature->RestoreModifiedProperties(OriginalFeature);
+			continue;
+		}
+
+		Property->CopyCompleteValue_InContainer(this, Original);
+		NotifyPropertyChanged(Property, It.GetIndex());
+	}
+
+	//the notifications marked the properties again
+	ClearModified();
+}
+
+/**
+ * Returns the instance SetProp writes to.
+ * If the owner of this feature is written to a copy, i.e. in a shadow state or if it is a shared package asset, the
+ * write goes to the feature of the copy, so it is undone with the shadow state and the package asset is not changed.
+ * The owner of a shared feature is not known here, so the write changes the feature of all objects sharing it.
+ *
+ * @return The feature of the writable instance of the owner.
+ */
+IArticyReflectable* UArticyBaseFeature::GetWritableInstance()
+{
+	UArticyObject* Owner = GetTypedOuter<UArticyObject>();
+	UArticyObject* Writable = UArticyDatabase::GetWritableObject(Owner);
+	if (Owner && !Writable)
+		return nullptr;
+	if (Writable && Writable != Owner)
+	{
+		for (TFieldIterator<FObjectProperty> It(Owner->GetClass()); It; ++It)
+		{
+			if (It->GetObjectPropertyValue_InContainer(Owner) == this)
+			{
+				if (UArticyBaseFeature* Feature = Writable->GetFeatureForWrite(*It))
+					return Feature;
+			}
+		}
+	}
+
+	if (bSharedWithClones)
+	{
+		UE_LOG(LogArticyRuntime, Verbose, TEXT("Feature %s is shared with clones, setting a property on it changes all of them. Use GetFeatureForWrite of the clone instead."), *GetName());
+	}
+
+	return this;
+}
+
+/**
+ * Returns the instance the scripts read from.
+ * If the owner of this feature was written to a shadow copy, this is the feature of that copy, see GetWritableInstance.
+ *
+ * @return The feature of the readable instance of the owner.
+ */
+IArticyReflectable* UArticyBaseFeature::GetReadableInstance()
+{
+	UArticyObject* Owner = GetTypedOuter<UArticyObject>();
+	UArticyObject* Readable = UArticyDatabase::GetReadableObject(Owner);
+	if (Readable && Readable != Owner)
+	{
+		for (TFieldIterator<FObjectProperty> It(Owner->GetClass()); It; ++It)
+		{
+			if (It->GetObjectPropertyValue_InContainer(Owner) == this)
+			{
+				if (UArticyBaseFeature* Feature = Cast<UArticyBaseFeature>(It->GetObjectPropertyValue_InContainer(Readable)))
+					return Feature;
+			}
+		}
+	}
+
+	return this;
+}
@@ -37,25 +37,23 @@ void UArticyConnection::InitFromJson(TSharedPtr<FJsonValue> Json)
 
 UArticyPrimitive* UArticyOutgoingConnection::GetTarget() const
 {
-	if(!TargetObj)
-	{
-		auto db = UArticyDatabase::Get(this);
-		TargetObj = db ? db->GetObject(Target) : nullptr;
-	}
+	if(auto linked = TargetLink.GetTarget())
+		return linked;
 
-	return TargetObj;
+	//not linked (yet), like the objects of a package that is still loading
+	auto db = UArticyDatabase::Get(this);
+	return db ? db->GetObject(Target) : nullptr;
 }
 
 UArticyFlowPin* UArticyOutgoingConnection::GetTargetPin() const
 {
-	if(!TargetPinObj)
-	{
-		auto target = GetTarget();
-		if(target)
-			TargetPinObj = Cast<UArticyFlowPin>(target->GetSubobject(TargetPin));
-	}
+	return TargetLink.GetPin(GetTarget(), TargetPin);
+}
 
-	return TargetPinObj;
+void UArticyOutgoingConnection::LinkReferences(const UArticyDatabase* Database)
+{
+	Super::LinkReferences(Database);
+	TargetLink.Link(Database, Target, TargetPin);
 }
 
 void UArticyOutgoingConnection::InitFromJson(TSharedPtr<FJsonValue> Json)
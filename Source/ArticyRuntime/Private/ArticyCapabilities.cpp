@@ -0,0 +1,71 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyCapabilities.h"
+#include "ArticyPins.h"
+#include "Interfaces/ArticyFlowObject.h"
+#include "Interfaces/ArticyInputPinsProvider.h"
+#include "Interfaces/ArticyOutputPinsProvider.h"
+#include "Interfaces/ArticyObjectWithSpeaker.h"
+#include "Interfaces/ArticyObjectWithText.h"
+#include "Interfaces/ArticyObjectWithPreviewImage.h"
+#include "Misc/ScopeRWLock.h"
+
+namespace
+{
+	FRWLock CapabilitiesLock;
+
+	/** The capabilities by class, allocated separately so the references handed out stay valid. */
+	TMap<const UClass*, TUniquePtr<FArticyCapabilities>> CapabilitiesByClass;
+}
+
+/**
+ * Returns the capabilities of the class of an object, finding them with casts of the object on first use.
+ * @param Object The object, must not be null.
+ * @return The capabilities, which stay valid as long as the class exists.
+ */
+const FArticyCapabilities& FArticyCapabilities::Find(const UObject* Object)
+{
+	check(Object);
+	const UClass* ObjectClass = Object->GetClass();
+
+	{
+		FReadScopeLock ReadLock(CapabilitiesLock);
+		const TUniquePtr<FArticyCapabilities>* Found = CapabilitiesByClass.Find(ObjectClass);
+		if (Found && (*Found)->Class.Get() == ObjectClass)
+			return **Found;
+	}
+
+	FWriteScopeLock WriteLock(CapabilitiesLock);
+	TUniquePtr<FArticyCapabilities>& Capabilities = CapabilitiesByClass.FindOrAdd(ObjectClass);
+	if (!Capabilities || Capabilities->Class.Get() != ObjectClass)
+	{
+		Capabilities = MakeUnique<FArticyCapabilities>();
+		Capabilities->Class = ObjectClass;
+		Capabilities->Add<IArticyFlowObject>(Object);
+		Capabilities->Add<UArticyFlowPin>(Object);
+		Capabilities->Add<IArticyInputPinsProvider>(Object);
+		Capabilities->Add<IArticyOutputPinsProvider>(Object);
+		Capabilities->Add<IArticyObjectWithSpeaker>(Object);
+		Capabilities->Add<IArticyObjectWithText>(Object);
+		Capabilities->Add<IArticyObjectWithPreviewImage>(Object);
+	}
+	return *Capabilities;
+}
+
+/**
+ * Adds a capability if the object has it.
+ * Interfaces only implemented by blueprints are not found, like they are not by a Cast.
+ * @param Object An object of the class.
+ */
+template<typename Type>
+void FArticyCapabilities::Add(const UObject* Object)
+{
+	if (const Type* Interface = Cast<Type>(Object))
+	{
+		const uint8 Index = static_cast<uint8>(TArticyCapability<Type>::Value);
+		Mask |= 1u << Index;
+		Offsets[Index] = static_cast<int32>(reinterpret_cast<const uint8*>(Interface) - reinterpret_cast<const uint8*>(Object));
+	}
+}
@@ -8,7 +8,22 @@
 #include "ArticyGlobalVariables.h"
 #include "ArticyPluginSettings.h"
 #include "ArticyExpressoScripts.h"
+#include "ArticyStats.h"
+#include "ArticyMemoryReport.h"
+#include "ArticyLocalizerSystem.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "Serialization/StructuredArchive.h"
 #include "Misc/Paths.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "HAL/PlatformTime.h"
+#include "Async/ParallelFor.h"
+#include "Interfaces/ArticyConditionProvider.h"
+#if WITH_EDITOR && ENGINE_MAJOR_VERSION >= 5
+#include "UObject/ObjectSaveContext.h"
+#endif
 
 /**
  * Gets the underlying Articy object.
@@ -27,12 +42,16 @@ UArticyObject* FArticyObjectShadow::GetObject()
  */
 FArticyShadowableObject::FArticyShadowableObject(UArticyObject* Object, int32 CloneId, UObject* Outer)
 {
-	Object->SetCloneID(CloneId);
+	//a package asset shared as clone 0 already has its id, and must not be modified
+	if (Object->GetCloneId() != CloneId)
+		Object->SetCloneID(CloneId);
 	ShadowCopies.Add(FArticyObjectShadow(0, Object, CloneId, Outer));
 }
 
 /**
  * Retrieves the shadowed Articy object based on the shadow manager and clone state.
+ * Reads never create shadow copies: the most recent copy is returned, which is the one of the
+ * current shadow level if the object was modified in it, or one of a lower level otherwise.
  * @param ShadowManager The manager for shadow states.
  * @param bForceUnshadowed Force retrieval of the unshadowed version.
  * @return A pointer to the shadowed or unshadowed UArticyObject.
@@ -42,40 +61,125 @@ UArticyObject* FArticyShadowableObject::Get(const IShadowStateManager* ShadowMan
 	if (bForceUnshadowed)
 		return ShadowCopies[0].GetObject();
 
-	const auto& ShadowLvl = ShadowManager->GetShadowLevel();
-	FArticyObjectShadow* info = ShadowCopies.FindByPredicate([&](const FArticyObjectShadow& item)
-		{
-			return item.ShadowLevel == ShadowLvl;
-		});
+	//copies of higher levels are removed when their state is popped, so this is the last one unless it is read mid-pop
+	const uint32 ShadowLvl = ShadowManager ? ShadowManager->GetShadowLevel() : 0;
+	for (int32 Index = ShadowCopies.Num() - 1; Index > 0; --Index)
+	{
+		if (ShadowCopies[Index].ShadowLevel <= ShadowLvl)
+			return ShadowCopies[Index].GetObject();
+	}
+
+	return ShadowCopies[0].GetObject();
+}
+
+/**
+ * Returns the copy of the current shadow level, which is created if the object was not modified in it yet.
+ * @param ShadowManager The manager for shadow states.
+ * @param bCreated Set to true if a new shadow copy was created.
+ * @return A pointer to the writable UArticyObject.
+ */
+UArticyObject* FArticyShadowableObject::GetForWrite(const IShadowStateManager* ShadowManager, bool& bCreated) const
+{
+	bCreated = false;
 
-	if (info)
-		return info->GetObject();
+	const uint32 ShadowLvl = ShadowManager->GetShadowLevel();
+	auto& mostRecentShadow = ShadowCopies.Last();
+	if (mostRecentShadow.ShadowLevel == ShadowLvl)
+		return mostRecentShadow.GetObject();
 
-	if (!ensureMsgf(ShadowLvl > 0 && ShadowCopies.Num() > 0, TEXT("Cannot get shadow level %d of FArticyShadowableObject!"), ShadowLvl))
+	if (!ensureMsgf(ShadowLvl > mostRecentShadow.ShadowLevel, TEXT("Cannot get shadow level %d of FArticyShadowableObject!"), ShadowLvl))
 		return nullptr;
 
 	//create a new shadow copy
-	auto& mostRecentShadow = ShadowCopies.Last();
 	auto SourceObject = mostRecentShadow.GetObject();
 	auto obj = DuplicateObject(SourceObject, SourceObject);
+	obj->CopyModifiedState(SourceObject);
 	ShadowCopies.Add(FArticyObjectShadow(ShadowLvl, obj, mostRecentShadow.GetCloneId()));
-
-#if __cplusplus >= 202002L
-	const_cast<IShadowStateManager*>(ShadowManager)->RegisterOnPopState([=, this]
-#else
-	const_cast<IShadowStateManager*>(ShadowManager)->RegisterOnPopState([=]
-#endif
-		{
-			//when the state is popped, remove the shadow copy again
-			//it is destroyed automatically, unless there is an owning reference to it
-			ensure(ShadowCopies.Last().ShadowLevel == ShadowLvl);
-			ShadowCopies.RemoveAt(ShadowCopies.Num() - 1);
-		});
+	bCreated = true;
+	INC_DWORD_STAT(STAT_ArticyObjectShadowCopies);
 
 	//return the new shadow copy
 	return obj;
 }
 
+/**
+ * Removes the most recent shadow copy, when its shadow state is popped.
+ * @param ShadowLevel The shadow level that is popped.
+ */
+void FArticyShadowableObject::PopShadow(uint32 ShadowLevel)
+{
+	//it is destroyed automatically, unless there is an owning reference to it
+	if (ensure(ShadowCopies.Num() > 1 && ShadowCopies.Last().ShadowLevel == ShadowLevel))
+		ShadowCopies.RemoveAt(ShadowCopies.Num() - 1);
+}
+
+/**
+ * Replaces the original [0] object, used when a shared object gets its own copy.
+ * @param NewOriginal The new unshadowed object.
+ */
+void FArticyShadowableObject::ReplaceOriginal(UArticyObject* NewOriginal)
+{
+	if (!ensure(NewOriginal && ShadowCopies.Num() > 0))
+		return;
+
+	ShadowCopies[0] = FArticyObjectShadow(0, NewOriginal, ShadowCopies[0].GetCloneId());
+}
+
+/**
+ * Calls Visitor for the original object and each of its shadow copies.
+ * @param Visitor Called with the object and its shadow level, 0 for the original.
+ */
+void FArticyShadowableObject::ForEachCopy(TFunctionRef<void(const UArticyObject*, uint32)> Visitor) const
+{
+	for (FArticyObjectShadow& Shadow : ShadowCopies)
+	{
+		if (const UArticyObject* Object = Shadow.GetObject())
+			Visitor(Object, Shadow.ShadowLevel);
+	}
+}
+
+/**
+ * Reports the original object and its shadow copies to the garbage collector.
+ * @param Collector The collector of the references.
+ * @param Referencer The database that holds the object.
+ */
+void FArticyShadowableObject::AddReferencedObjects(FReferenceCollector& Collector, const UObject* Referencer)
+{
+	for (FArticyObjectShadow& Shadow : ShadowCopies)
+		Collector.AddReferencedObject(Shadow.Object, Referencer);
+}
+
+namespace
+{
+	/**
+	 * Sets up the duplication of a clone of an object.
+	 * With bShareFeaturesBetweenClones, the features of the original are seeded as their own duplicates,
+	 * so the clone references them instead of copies (see UArticyBaseObject::GetFeatureForWrite).
+	 * @param Original The object that is cloned.
+	 * @return The duplication parameters.
+	 */
+	FObjectDuplicationParameters MakeCloneParameters(UArticyObject* Original)
+	{
+		FObjectDuplicationParameters Parameters = InitStaticDuplicateObjectParams(Original, Original);
+		if (!UArticyPluginSettings::Get()->bShareFeaturesBetweenClones)
+			return Parameters;
+
+		for (TFieldIterator<FObjectProperty> It(Original->GetClass()); It; ++It)
+		{
+			if (!It->PropertyClass->IsChildOf(UArticyBaseFeature::StaticClass()))
+				continue;
+
+			if (UArticyBaseFeature* Feature = Cast<UArticyBaseFeature>(It->GetObjectPropertyValue_InContainer(Original)))
+			{
+				Feature->SetSharedWithClones();
+				Parameters.DuplicationSeed.Add(Feature, Feature);
+			}
+		}
+
+		return Parameters;
+	}
+}
+
 /**
  * Retrieves a clone of the Articy object based on clone ID and shadow state.
  * @param ShadowManager The manager for shadow states.
@@ -83,11 +187,55 @@ UArticyObject* FArticyShadowableObject::Get(const IShadowStateManager* ShadowMan
  * @param bForceUnshadowed Force retrieval of the unshadowed version.
  * @return A pointer to the shadowed or unshadowed UArticyObject clone.
  */
-UArticyObject* UArticyCloneableObject::Get(const IShadowStateManager* ShadowManager, int32 CloneId,
+UArticyObject* FArticyCloneableObject::Get(const IShadowStateManager* ShadowManager, int32 CloneId,
 	bool bForceUnshadowed) const
 {
-	auto info = Clones.Find(CloneId);
-	return info ? info->Get(ShadowManager, bForceUnshadowed) : nullptr;
+	if (!Clones.IsValidIndex(CloneId) || !Clones[CloneId].IsValid())
+		return nullptr;
+
+	return Clones[CloneId].Get(ShadowManager, bForceUnshadowed);
+}
+
+/**
+ * Returns the clone with the given id for modification, creating a shadow copy of it if needed.
+ * @param ShadowManager The manager for shadow states.
+ * @param CloneId The ID of the clone.
+ * @return A pointer to the writable clone, or nullptr if the clone does not exist.
+ */
+UArticyObject* FArticyCloneableObject::GetForWrite(const IShadowStateManager* ShadowManager, int32 CloneId)
+{
+	if (!Clones.IsValidIndex(CloneId) || !Clones[CloneId].IsValid())
+		return nullptr;
+
+	//the shadow copy of a shared package asset would be outered to the asset
+	if (CloneId == 0 && ShadowManager->GetShadowLevel() > 0)
+		UnshareOriginal();
+
+	bool bCreated = false;
+	UArticyObject* Writable = Clones[CloneId].GetForWrite(ShadowManager, bCreated);
+
+	//when the state is popped, remove the shadow copy again
+	if (bCreated)
+	{
+		const_cast<IShadowStateManager*>(ShadowManager)->RecordUndo(&FArticyCloneableObject::UndoShadow, this, CloneId);
+		Writable->LinkReferences(Database);
+	}
+
+	return Writable;
+}
+
+/**
+ * Undo function for shadow copies, removes the copy of the popped level.
+ * The slot is looked up again, because the clones array might have been reallocated in the meantime.
+ * @param Context The container of the clone.
+ * @param CloneId The ID of the clone.
+ * @param ShadowLevel The shadow level that is popped.
+ */
+void FArticyCloneableObject::UndoShadow(void* Context, int32 CloneId, uint32 ShadowLevel)
+{
+	auto Container = static_cast<FArticyCloneableObject*>(Context);
+	if (Container->Clones.IsValidIndex(CloneId))
+		Container->Clones[CloneId].PopShadow(ShadowLevel);
 }
 
 /**
@@ -97,7 +245,7 @@ UArticyObject* UArticyCloneableObject::Get(const IShadowStateManager* ShadowMana
  * @param bFailIfExists Fails if the clone already exists.
  * @return A pointer to the newly created or existing clone, or nullptr if creation failed.
  */
-UArticyObject* UArticyCloneableObject::Clone(const IShadowStateManager* ShadowManager, int32 CloneId,
+UArticyObject* FArticyCloneableObject::Clone(const IShadowStateManager* ShadowManager, int32 CloneId,
 	bool bFailIfExists)
 {
 	auto clone = Get(ShadowManager, CloneId);
@@ -107,63 +255,233 @@ UArticyObject* UArticyCloneableObject::Clone(const IShadowStateManager* ShadowMa
 
 	if (!clone)
 	{
-		//get the original object (clone 0)
+		//get the original object (clone 0), the clone is outered to it so it must not be a shared package asset
+		UnshareOriginal();
 		auto original = Get(ShadowManager);
 		if (ensure(original))
 		{
 			//create the clone
-			clone = DuplicateObject(original, original);
+			FObjectDuplicationParameters Parameters = MakeCloneParameters(original);
+			clone = Cast<UArticyObject>(StaticDuplicateObjectEx(Parameters));
+			clone->CopyModifiedState(original);
 			AddClone(clone, CloneId);
+			clone->LinkReferences(Database);
 		}
 	}
 
 	return clone;
 }
 
+/**
+ * Creates Count new clones of the original object, using the next free clone ids.
+ * @param ShadowManager The manager for shadow states.
+ * @param Count The number of clones to create.
+ * @param OutClones The new clones are appended to this array.
+ */
+void FArticyCloneableObject::CloneBatch(const IShadowStateManager* ShadowManager, int32 Count, TArray<UArticyObject*>& OutClones)
+{
+	if (Count <= 0)
+		return;
+
+	//get the original object (clone 0), the clones are outered to it so it must not be a shared package asset
+	UnshareOriginal();
+	auto original = Get(ShadowManager);
+	if (!ensure(original))
+		return;
+
+	Clones.Reserve(Clones.Num() + Count);
+	OutClones.Reserve(OutClones.Num() + Count);
+
+	//all clones are duplicated the same way, so the parameters are only set up once
+	FObjectDuplicationParameters Parameters = MakeCloneParameters(original);
+
+	for (int32 i = 0; i < Count; ++i)
+	{
+		UArticyObject* clone = Cast<UArticyObject>(StaticDuplicateObjectEx(Parameters));
+		if (clone)
+			clone->CopyModifiedState(original);
+		if (AddClone(clone, -1) != -1)
+		{
+			clone->LinkReferences(Database);
+			OutClones.Add(clone);
+		}
+	}
+}
+
+/**
+ * Replaces clone 0 by a private copy if it is a package asset shared by the database, see
+ * UArticyDatabase::MaterializeSharedObject. Clones and shadow copies are outered to the object they are copied from,
+ * so they would not be part of the database, and their clone ids would not be resolved, if that was the asset.
+ */
+void FArticyCloneableObject::UnshareOriginal()
+{
+	if (!SharedAsset || !Database || Clones.Num() == 0 || !Clones[0].IsValid() || Clones[0].Get(Database, true) != SharedAsset)
+		return;
+
+	const TWeakObjectPtr<UArticyDatabase>* Owner = UArticyDatabase::SharedObjectOwners.Find(SharedAsset);
+	if (Owner && Owner->Get() == Database)
+		Database->MaterializeSharedObject(SharedAsset);
+}
+
+/**
+ * Replaces the unshadowed clone 0, used when a shared object gets its own copy.
+ * @param NewOriginal The new clone 0.
+ */
+void FArticyCloneableObject::ReplaceOriginal(UArticyObject* NewOriginal)
+{
+	if (Clones.Num() > 0 && Clones[0].IsValid())
+		Clones[0].ReplaceOriginal(NewOriginal);
+	++UArticyDatabase::ObjectResolveVersion;
+}
+
+/**
+ * Removes all clones except clone 0.
+ */
+void FArticyCloneableObject::RemoveClones()
+{
+	if (Clones.Num() <= 1)
+		return;
+
+	Clones.SetNum(1);
+	FreeCloneIds.Reset();
+	++UArticyDatabase::ObjectStateVersion;
+	++UArticyDatabase::ObjectResolveVersion;
+}
+
+/**
+ * Removes a clone and frees its id.
+ * @param CloneId The id of the clone, clone 0 cannot be removed.
+ * @return True if the clone existed.
+ */
+bool FArticyCloneableObject::RemoveClone(int32 CloneId)
+{
+	if (CloneId <= 0 || !Clones.IsValidIndex(CloneId) || !Clones[CloneId].IsValid())
+		return false;
+
+	//the undo logs restore the clone from its state before it was destroyed
+	if (Database && Database->ObjectUndoLogs.Num() > 0)
+		Database->RecordObjectUndo(Clones[CloneId].Get(Database, true), false);
+
+	//the clone is garbage collected, unless the game still references it
+	Clones[CloneId] = FArticyShadowableObject();
+	FreeCloneIds.HeapPush(CloneId);
+	++UArticyDatabase::ObjectStateVersion;
+	++UArticyDatabase::ObjectResolveVersion;
+	return true;
+}
+
+/**
+ * Removes the empty slots after the last clone, together with their free ids, and shrinks the arrays.
+ */
+void FArticyCloneableObject::Compact()
+{
+	int32 Num = Clones.Num();
+	while (Num > 1 && !Clones[Num - 1].IsValid())
+		--Num;
+
+	if (Num < Clones.Num())
+	{
+		Clones.SetNum(Num);
+		FreeCloneIds.RemoveAll([Num](const int32 CloneId) { return CloneId >= Num; });
+		FreeCloneIds.Heapify();
+	}
+
+	Clones.Shrink();
+	FreeCloneIds.Shrink();
+}
+
+/**
+ * Calls Visitor for every clone and each of its shadow copies.
+ * @param Visitor Called with the object and its shadow level, 0 for the clones themselves.
+ */
+void FArticyCloneableObject::ForEachCopy(TFunctionRef<void(const UArticyObject*, uint32)> Visitor) const
+{
+	for (const FArticyShadowableObject& Clone : Clones)
+	{
+		if (Clone.IsValid())
+			Clone.ForEachCopy(Visitor);
+	}
+}
+
+/**
+ * Drops the clones and the bookkeeping of the database, and invalidates the links to the container.
+ * The clones are garbage collected, unless the game still references them.
+ */
+void FArticyCloneableObject::Release()
+{
+	Clones.Empty();
+	FreeCloneIds.Empty();
+	SharedAsset = nullptr;
+	PackageRefCount = 0;
+	ClassBucketIndex = INDEX_NONE;
+	PackageUsageIndex = INDEX_NONE;
+	++Generation;
+}
+
 /**
  * Adds a clone to the clone map with a specified clone ID.
  * @param Clone The clone to add.
  * @param CloneId The ID for the clone.
  */
-void UArticyCloneableObject::AddClone(UArticyObject* Clone, int32 CloneId)
+int32 FArticyCloneableObject::AddClone(UArticyObject* Clone, int32 CloneId)
 {
 	if (!ensure(Clone))
-		return;
+		return -1;
+
+	++UArticyDatabase::ObjectStateVersion;
 
 	if (CloneId == -1)
 	{
-		//find the first free clone id
-		for (int i = 0; i != -1; ++i)
-		{
-			if (!Clones.Find(i))
-			{
-				CloneId = i;
-				break;
-			}
-		}
+		//take the lowest free clone id, or append a new slot
+		if (FreeCloneIds.Num() > 0)
+			FreeCloneIds.HeapPop(CloneId);
+		else
+			CloneId = Clones.Num();
+	}
+	else if (!ensureMsgf(CloneId >= 0, TEXT("Invalid clone id %d!"), CloneId))
+	{
+		return -1;
+	}
+	else if (CloneId < Clones.Num())
+	{
+		//the id was free (otherwise the clone would exist), so it is not available anymore
+		const int32 FreeIndex = FreeCloneIds.Find(CloneId);
+		if (FreeIndex != INDEX_NONE)
+			FreeCloneIds.HeapRemoveAt(FreeIndex);
 	}
 
-	Clones.Add(CloneId, FArticyShadowableObject{ Clone, CloneId });
+	if (CloneId >= Clones.Num())
+	{
+		//all skipped ids become free
+		for (int32 i = Clones.Num(); i < CloneId; ++i)
+			FreeCloneIds.HeapPush(i);
+
+		Clones.SetNum(CloneId + 1);
+	}
+
+	Clones[CloneId] = FArticyShadowableObject{ Clone, CloneId };
+
+	if (CloneId > 0 && Database && Database->ObjectUndoLogs.Num() > 0)
+		Database->RecordObjectUndo(Clone, true);
+
+	return CloneId;
 }
 
 //---------------------------------------------------------------------------//
 
 UArticyDatabase::UArticyDatabase()
 {
-	// Dynamically find the class that inherits from UArticyExpressoScripts
-	TArray<UClass*> ExpressoScriptClasses;
-	for (TObjectIterator<UClass> It; It; ++It)
+	// Find the generated class that inherits from UArticyExpressoScripts once, not for every duplicated database.
+	// It is looked up again if a hot reload replaced it.
+	static TWeakObjectPtr<UClass> GeneratedClass;
+	if (!GeneratedClass.IsValid() || GeneratedClass->HasAnyClassFlags(CLASS_NewerVersionExists))
 	{
-		if (It->IsChildOf(UArticyExpressoScripts::StaticClass()) && !It->HasAnyClassFlags(CLASS_Abstract))
-		{
-			ExpressoScriptClasses.Add(*It);
-		}
+		GeneratedClass = UArticyPluginSettings::FindGeneratedClass(GetDefault<UArticyPluginSettings>()->ExpressoScriptsClassPath, UArticyExpressoScripts::StaticClass());
 	}
 
-	if (ExpressoScriptClasses.Num() > 0)
+	if (GeneratedClass.IsValid())
 	{
-		// There should be only one, so we use the first one found
-		SetExpressoScriptsClass(ExpressoScriptClasses[0]);
+		SetExpressoScriptsClass(GeneratedClass.Get());
 	}
 	else
 	{
@@ -172,10 +490,13 @@ UArticyDatabase::UArticyDatabase()
 }
 
 /**
- * Initializes the Articy database, loading default packages.
+ * Initializes the Articy database, warming the reflection cache and loading default packages.
  */
 void UArticyDatabase::Init()
 {
+	//build the reflection cache up front, instead of on the first access of each class during gameplay
+	IArticyReflectable::WarmPropertyTables();
+
 	LoadDefaultPackages();
 }
 
@@ -186,21 +507,92 @@ void UArticyDatabase::Init()
  */
 UArticyDatabase* UArticyDatabase::Get(const UObject* WorldContext)
 {
+	INC_DWORD_STAT(STAT_ArticyDatabaseGetCalls);
+
+	//objects of the database (and their clones and shadows) are outered to it, which resolves without a world lookup
+	if (WorldContext)
+	{
+		UArticyDatabase* OuterDatabase = WorldContext->GetTypedOuter<UArticyDatabase>();
+		if (!OuterDatabase)
+			OuterDatabase = const_cast<UArticyDatabase*>(Cast<UArticyDatabase>(WorldContext));
+		if (OuterDatabase && !OuterDatabase->IsAsset())
+			return OuterDatabase;
+	}
+
+	const bool bKeepDatabaseBetweenWorlds = UArticyPluginSettings::Get()->bKeepDatabaseBetweenWorlds;
+	if (bKeepDatabaseBetweenWorlds && PersistentClone.IsValid())
+		return PersistentClone.Get();
+
+	auto world = GEngine->GetWorldFromContextObjectChecked(WorldContext);
+	if (!ensureMsgf(world, TEXT("Could not get world from WorldContext %s"), WorldContext ? *WorldContext->GetName() : TEXT("NULL")))
+		return nullptr;
+
 #if ENGINE_MAJOR_VERSION >= 5
-	bool bKeepBetweenWorlds = UArticyPluginSettings::Get()->bKeepDatabaseBetweenWorlds || WorldContext->GetWorld()->IsPartitionedWorld();
+	bool bKeepBetweenWorlds = bKeepDatabaseBetweenWorlds || world->IsPartitionedWorld();
 #else
-	bool bKeepBetweenWorlds = UArticyPluginSettings::Get()->bKeepDatabaseBetweenWorlds;
+	bool bKeepBetweenWorlds = bKeepDatabaseBetweenWorlds;
 #endif
 
 	if (bKeepBetweenWorlds && PersistentClone.IsValid())
 		return PersistentClone.Get();
 
-	//remove all clones who's world died (world == nullptr)
-	Clones.Remove(nullptr);
+	//worker threads (e.g. parallel explorations) only find the existing clone, the game thread waits for them, so
+	//the clones don't change meanwhile, but the last resolved world would be raced
+	if (!IsInGameThread())
+	{
+		if (bKeepBetweenWorlds)
+			return PersistentClone.Get();
 
-	auto world = GEngine->GetWorldFromContextObjectChecked(WorldContext);
-	if (!ensureMsgf(world, TEXT("Could not get world from WorldContext %s"), WorldContext ? *WorldContext->GetName() : TEXT("NULL")))
-		return nullptr;
+		const TWeakObjectPtr<UArticyDatabase>* Existing = Clones.Find(world);
+		return Existing ? Existing->Get() : nullptr;
+	}
+
+	//most calls come from the same world, so check the last resolved one before the clones map
+	if (!bKeepBetweenWorlds && LastResolvedWorld.Get() == world && LastResolvedClone.IsValid())
+		return LastResolvedClone.Get();
+
+	const bool bReuseWorldClones = !bKeepBetweenWorlds && UArticyPluginSettings::Get()->bReuseWorldClones;
+
+	//remove all clones who's world died (world == nullptr), only needed when a new world shows up
+	if (!bKeepBetweenWorlds && !Clones.Contains(world))
+	{
+		if (bReuseWorldClones)
+		{
+			//the clone of a world that is gone is reset and reused, instead of duplicating the asset again
+			UArticyDatabase* Reused = nullptr;
+			for (auto It = Clones.CreateIterator(); It; ++It)
+			{
+				if (It->Key.IsValid())
+					continue;
+
+				UArticyDatabase* Previous = It->Value.Get();
+				It.RemoveCurrent();
+				if (!Previous)
+					continue;
+
+				if (!Reused && Previous->GetOuter() == world->GetGameInstance())
+				{
+					Reused = Previous;
+				}
+				else
+				{
+					Previous->RemoveFromRoot();
+					Previous->ConditionalBeginDestroy();
+				}
+			}
+
+			if (Reused)
+			{
+				UE_LOG(LogArticyRuntime, Log, TEXT("Reusing the ArticyDatabase of a previous world."));
+				Reused->ResetToOriginal();
+				Clones.Add(world, Reused);
+			}
+		}
+		else
+		{
+			Clones.Remove(nullptr);
+		}
+	}
 
 	//find either the persistent clone or the clone that belongs to the world of the passed in context object
 	auto& clone = bKeepBetweenWorlds ? PersistentClone : Clones.FindOrAdd(world);
@@ -216,12 +608,15 @@ UArticyDatabase* UArticyDatabase::Get(const UObject* WorldContext)
 			return nullptr;
 
 		//duplicate the original asset
-		if (bKeepBetweenWorlds)
+		if (bKeepBetweenWorlds || (bReuseWorldClones && world->GetGameInstance()))
 		{
+			//reused clones outlive their world like the persistent one
 			clone = DuplicateObject((UArticyDatabase*)asset, world->GetGameInstance());
 #if !WITH_EDITOR
 			clone->AddToRoot();
 #endif
+			if (!bKeepBetweenWorlds)
+				clone->bTrackModifiedObjects = true;
 		}
 		else
 		{
@@ -230,7 +625,16 @@ UArticyDatabase* UArticyDatabase::Get(const UObject* WorldContext)
 
 		//make the clone load its default packages
 		if (clone.IsValid())
+		{
+			clone->FlowGraphImage = asset->FlowGraphImage;
 			clone->Init();
+		}
+	}
+
+	if (!bKeepBetweenWorlds)
+	{
+		LastResolvedWorld = world;
+		LastResolvedClone = clone;
 	}
 
 	return clone.Get();
@@ -254,6 +658,7 @@ void UArticyDatabase::UnloadDatabase()
 		(*dbPtr)->RemoveFromRoot();
 		(*dbPtr)->ConditionalBeginDestroy();
 		*dbPtr = NULL;
+		++ObjectResolveVersion;
 	}
 }
 
@@ -299,7 +704,7 @@ UArticyGlobalVariables* UArticyDatabase::GetRuntimeGVs(UArticyAlternativeGlobalV
 TArray<FString> UArticyDatabase::GetImportedPackageNames() const
 {
 	TArray<FString> outNames;
-	ImportedPackages.GenerateKeyArray(outNames);
+	ImportedPackageEntries.GenerateKeyArray(outNames);
 	return outNames;
 }
 
@@ -310,19 +715,20 @@ TArray<FString> UArticyDatabase::GetImportedPackageNames() const
  */
 bool UArticyDatabase::IsPackageDefaultPackage(FString PackageName)
 {
-	if (ImportedPackages.Contains(PackageName))
-	{
-		const UArticyPackage* Package = ImportedPackages[PackageName];
-		// in case the key exists but has no valid entry
-		if (!Package)
-		{
-			return false;
-		}
-
-		return Package->bIsDefaultPackage;
-	}
+	// the flag is stored in the entry, so the package doesn't need to be loaded
+	const FArticyPackageEntry* Entry = ImportedPackageEntries.Find(PackageName);
+	return Entry && !Entry->Package.IsNull() && Entry->bIsDefaultPackage;
+}
 
-	return false;
+/**
+ * Gets the chunk a package is cooked into, so it can be installed on demand before it is loaded.
+ * @param PackageName The name of the package.
+ * @return The chunk id of the package, or INDEX_NONE if the package is unknown or has no assigned chunk.
+ */
+int32 UArticyDatabase::GetPackageChunkId(FString PackageName) const
+{
+	const FArticyPackageEntry* Entry = ImportedPackageEntries.Find(PackageName);
+	return Entry ? Entry->ChunkId : INDEX_NONE;
 }
 
 /**
@@ -339,15 +745,37 @@ void UArticyDatabase::LoadAllObjects()
  */
 void UArticyDatabase::SetLoadedPackages(const TArray<UArticyPackage*> Packages)
 {
-	ImportedPackages.Reset();
+	ImportedPackageEntries.Reset();
 	UnloadAllPackages();
 
 	for (auto pkg : Packages)
 	{
-		ImportedPackages.Add(pkg->Name, pkg);
+		FArticyPackageEntry& Entry = ImportedPackageEntries.Add(pkg->Name);
+		Entry.Package = pkg;
+		Entry.bIsDefaultPackage = pkg->bIsDefaultPackage;
+		Entry.ChunkId = pkg->ChunkId;
 	}
 }
 
+/**
+ * Returns the asset of an imported package.
+ * Packages are referenced softly, so only the packages that get loaded into the database are in memory.
+ * @param PackageName The name of the package.
+ * @param bLoad Whether to load the package asset if it is not in memory yet.
+ * @return The package asset, or nullptr if the package is unknown or not loaded.
+ */
+UArticyPackage* UArticyDatabase::GetPackageAsset(const FString& PackageName, bool bLoad) const
+{
+	if (UArticyPackage* const* Resident = ResidentPackages.Find(PackageName))
+		return *Resident;
+
+	const FArticyPackageEntry* Entry = ImportedPackageEntries.Find(PackageName);
+	if (!Entry || Entry->Package.IsNull())
+		return nullptr;
+
+	return bLoad ? Entry->Package.LoadSynchronous() : Entry->Package.Get();
+}
+
 //---------------------------------------------------------------------------//
 
 /**
@@ -364,15 +792,69 @@ void UArticyDatabase::LoadDefaultPackages()
  */
 void UArticyDatabase::LoadAllPackages(bool bDefaultOnly)
 {
-	for (const TPair<FString, UArticyPackage*>& pack : ImportedPackages)
 	{
-		if (!bDefaultOnly || (pack.Value && pack.Value->bIsDefaultPackage)
+		TGuardValue<bool> DeferLinking(bDeferLinking, true);
+
+		TArray<FString> PackageNames;
+		PackageNames.Reserve(ImportedPackageEntries.Num());
+		for (const TPair<FString, FArticyPackageEntry>& pack : ImportedPackageEntries)
+		{
+			if (!bDefaultOnly || (!pack.Value.Package.IsNull() && pack.Value.bIsDefaultPackage)
 #if WITH_EDITOR
-			//TODO add "or is edit mode"
+				//TODO add "or is edit mode"
 #endif
-			)
-			LoadPackage(pack.Key);
+				)
+				PackageNames.Add(pack.Key);
+		}
+
+		LoadPackages(PackageNames);
+	}
+
+	//also links the objects of a database that was duplicated with its packages already loaded
+	LinkObjects();
+}
+
+/**
+ * Loads several packages at once, sizing the lookup tables for all of their objects first and linking once at the end.
+ * @param PackageNames The names of the packages to load.
+ */
+void UArticyDatabase::LoadPackages(const TArray<FString>& PackageNames)
+{
+	//the packages which are not loaded yet, loading ones are finished by LoadPackage
+	TArray<FString> NewPackages;
+	NewPackages.Reserve(PackageNames.Num());
+	int32 NumAssets = 0;
+	int32 NumNames = 0;
+	for (const FString& PackageName : PackageNames)
+	{
+		if (LoadedPackages.Contains(PackageName) || NewPackages.Contains(PackageName))
+			continue;
+
+		UArticyPackage* Package = IsPackageLoading(PackageName) ? nullptr : GetPackageAsset(PackageName);
+		if (Package)
+		{
+			NumAssets += Package->AssetNum();
+			NumNames += Package->GetNameIndex().Num();
+		}
+		NewPackages.Add(PackageName);
+	}
+
+	if (NewPackages.Num() == 0)
+		return;
+
+	//objects in several packages are counted once per package, so this may reserve a bit more than needed
+	LoadedObjectsById.Reserve(LoadedObjectsById.Num() + NumAssets);
+	LoadedObjectsByName.Reserve(LoadedObjectsByName.Num() + NumNames);
+	ReserveObjectTable(LoadedObjectsById.Num() + NumAssets);
+
+	{
+		TGuardValue<bool> DeferLinking(bDeferLinking, true);
+		for (const FString& PackageName : NewPackages)
+			LoadPackage(PackageName);
 	}
+
+	if (!bDeferLinking)
+		LinkObjects();
 }
 
 /**
@@ -381,19 +863,28 @@ void UArticyDatabase::LoadAllPackages(bool bDefaultOnly)
  */
 void UArticyDatabase::LoadPackage(FString PackageName)
 {
+	SCOPE_CYCLE_COUNTER(STAT_ArticyLoadPackage);
+
+	if (IsPackageLoading(PackageName))
+	{
+		FlushPendingLoad(PackageName);
+		return;
+	}
+
 	if (LoadedPackages.Contains(PackageName))
 	{
 		UE_LOG(LogArticyRuntime, Log, TEXT("Package %s already loaded."), *PackageName);
 		return;
 	}
 
-	if (!ImportedPackages.Contains(PackageName) || ImportedPackages[PackageName] == nullptr)
+	UArticyPackage* Package = GetPackageAsset(PackageName);
+	if (!Package)
 	{
 		UE_LOG(LogArticyRuntime, Error, TEXT("Failed to find Package %s in imported packages!"), *PackageName);
 		return;
 	}
 
-	UArticyPackage* Package = ImportedPackages[PackageName];
+	ResidentPackages.Add(PackageName, Package);
 
 	/*auto fileName = PackageName.Replace(TEXT(" "), TEXT("_"));
 	auto pkgFile = Cast<UPackage>(::LoadPackage(nullptr, *fileName, 0));
@@ -406,422 +897,2914 @@ void UArticyDatabase::LoadPackage(FString PackageName)
 	//load the package, to make sure all the contained objects are available
 	pkgFile->FullyLoad();*/
 
-	for (auto ArticyObject : Package->GetAssets())// MM_CHANGE
-	{
-		auto id = FArticyId(ArticyObject->GetId());
+	const TArray<UArticyObject*> Assets = Package->GetAssets();
+	ReserveObjectTable(LoadedObjectsById.Num() + Assets.Num());
 
-		if (!ensureMsgf(!LoadedObjectsById.Contains(id), TEXT("Object with id [%d,%d] already in list!"), id.High, id.Low))
-			continue;
+	//with the name index of the import, the objects are added to the name lookup once per name instead of per object
+	if (!Package->HasNameIndex())
+	{
+		for (auto ArticyObject : Assets)// MM_CHANGE
+		{
+			AddPackageReference(ArticyObject);
+		}
+	}
+	else
+	{
+		//the containers of the objects loaded here, objects loaded before are already in the name lookup
+		TArray<FArticyCloneableObject*> LoadedContainers;
+		LoadedContainers.SetNumZeroed(Assets.Num());
 
-		auto CloneContainer = NewObject<UArticyCloneableObject>(this);
-		UArticyObject* InitialClone = DuplicateObject<UArticyObject>(ArticyObject, this);
-		CloneContainer->Init(InitialClone);
+		for (int32 Index = 0; Index < Assets.Num(); ++Index)
+		{
+			UArticyObject* ArticyObject = Assets[Index];
+			if (ArticyObject && !LoadedObjectsById.Contains(ArticyObject->GetId()) && LoadObjectFromAsset(ArticyObject, false))
+				LoadedContainers[Index] = LoadedObjectsById.FindRef(ArticyObject->GetId());
 
-		LoadedObjectsById.Add(id, CloneContainer);
+			AddPackageReference(ArticyObject);
+		}
 
-		if (!ArticyObject->GetTechnicalName().ToString().IsEmpty())
+		const TArray<FArticyPackageNameIndexEntry>& NameIndex = Package->GetNameIndex();
+		LoadedObjectsByName.Reserve(LoadedObjectsByName.Num() + NameIndex.Num());
+		for (const FArticyPackageNameIndexEntry& Entry : NameIndex)
 		{
-			LoadedObjectsByName.FindOrAdd(ArticyObject->GetTechnicalName()).Objects.Add(CloneContainer);
+			if (Entry.TechnicalName.IsNone())
+				continue;
+
+			FArticyDatabaseObjectArray* Named = nullptr;
+			for (const int32 Index : Entry.Assets)
+			{
+				FArticyCloneableObject* Container = LoadedContainers.IsValidIndex(Index) ? LoadedContainers[Index] : nullptr;
+				if (!Container)
+					continue;
+
+				if (!Named)
+				{
+					Named = &LoadedObjectsByName.FindOrAdd(Entry.TechnicalName);
+					Named->Objects.Reserve(Named->Objects.Num() + Entry.Assets.Num());
+				}
+				Named->Objects.Add(Container);
+			}
 		}
 	}
 
 	LoadedPackages.Add(PackageName);
+	OnPackageResident(PackageName, Assets);
+	if (UArticyLocalizerSystem* Localizer = UArticyLocalizerSystem::Get())
+		Localizer->OnPackageLoaded(PackageName);
+
+	if (!bDeferLinking)
+		LinkObjects();
+
 	UE_LOG(LogArticyRuntime, Log, TEXT("Package %s loaded successfully."), *PackageName);
 }
 
 /**
- * Unloads a specific package by name.
- * @param PackageName The name of the package to unload.
- * @param bQuickUnload If true, perform a quick unload.
- * @return True if the package was successfully unloaded, false otherwise.
+ * Adds a reference from a loaded package to one of its objects, loading the object if necessary.
+ * @param ArticyObject The object asset of the package.
  */
-bool UArticyDatabase::UnloadPackage(const FString PackageName, const bool bQuickUnload)
+void UArticyDatabase::AddPackageReference(UArticyObject* ArticyObject)
 {
-	if (!LoadedPackages.Contains(PackageName))
-	{
-		UE_LOG(LogArticyRuntime, Log, TEXT("Package %s can't be unloaded due to not being loaded in the first place."), *PackageName);
-		return false;
-	}
+	if (!ArticyObject)
+		return;
 
-	if (!ImportedPackages.Contains(PackageName) || ImportedPackages[PackageName] == nullptr)
+	FArticyCloneableObject* const* Container = LoadedObjectsById.Find(ArticyObject->GetId());
+	if (!Container)
 	{
-		UE_LOG(LogArticyRuntime, Error, TEXT("Failed to find Package %s in imported packages!"), *PackageName);
-		return false;
+		LoadObjectFromAsset(ArticyObject);
+		Container = LoadedObjectsById.Find(ArticyObject->GetId());
 	}
 
-	UArticyPackage* Package = ImportedPackages[PackageName];
-
-	for (auto ArticyObject : Package->GetAssets())
-	{
-		FArticyId ArticyId = ArticyObject->GetId();
-		FName TechnicalName = ArticyObject->GetTechnicalName();
+	if (ensure(Container && *Container))
+		++(*Container)->PackageRefCount;
+}
 
-		bool bShouldUnload = false;
-		if (bQuickUnload)
-		{
-			bShouldUnload = true;
-		}
-		else
-		{
-			/*
-			 *	An exported object can exist multiple times in different packages
-			 *  In the database, there can only be one object with the same Id, so if we are unloading slowly, check if the object is contained in another package first
-			 *  Only unload if it is not contained in any other package
-			*/
-			bool bIsAssetContained = false;
-			for (const FString& LoadedPackageName : LoadedPackages)
-			{
-				if (!LoadedPackageName.Equals(Package->Name))
-				{
-					bIsAssetContained = bIsAssetContained || ImportedPackages[LoadedPackageName]->GetAssetsDict().Contains(TechnicalName);
-				}
-			}
+/**
+ * Duplicates an object asset into the database and registers it in all lookup tables.
+ * @param ArticyObject The object asset of a package.
+ * @param bAddToNameIndex False if the caller adds the object to LoadedObjectsByName.
+ * @return The unshadowed clone 0 of the object, or nullptr if an object with the same id is already loaded.
+ */
+UArticyObject* UArticyDatabase::LoadObjectFromAsset(UArticyObject* ArticyObject, bool bAddToNameIndex)
+{
+	auto id = FArticyId(ArticyObject->GetId());
 
-			if (!bIsAssetContained)
-			{
-				bShouldUnload = true;
-			}
-		}
+	if (!ensureMsgf(!LoadedObjectsById.Contains(id), TEXT("Object with id [%d,%d] already in list!"), id.High, id.Low))
+		return nullptr;
 
-		if (bShouldUnload)
+	UArticyObject* InitialClone = nullptr;
+	if (UArticyPluginSettings::Get()->bShareUnmodifiedObjectsWithPackages)
+	{
+		//share the asset until the first write, unless another database already does
+		TWeakObjectPtr<UArticyDatabase>& Owner = SharedObjectOwners.FindOrAdd(ArticyObject);
+		if (!Owner.IsValid())
 		{
-			LoadedObjectsById.FindAndRemoveChecked(ArticyId);
-			LoadedObjectsByName.FindAndRemoveChecked(TechnicalName);
+			Owner = this;
+			InitialClone = ArticyObject;
 		}
 	}
 
-	LoadedPackages.Remove(Package->Name);
-	UE_LOG(LogArticyRuntime, Log, TEXT("Package %s unloaded successfully."), *PackageName);
+	if (!InitialClone)
+		InitialClone = DuplicateObject<UArticyObject>(ArticyObject, this);
 
-	return true;
+	FArticyCloneableObject* CloneContainer = AllocateContainer();
+	CloneContainer->Init(InitialClone);
+	CloneContainer->SharedAsset = InitialClone == ArticyObject ? ArticyObject : nullptr;
+
+	LoadedObjectsById.Add(id, CloneContainer);
+	ReserveObjectTable(LoadedObjectsById.Num());
+	AddToObjectTable(id, InitialClone);
+	AddToClassIndex(CloneContainer, InitialClone->GetClass());
+
+	const FName TechnicalName = ArticyObject->GetTechnicalName();
+	if (bAddToNameIndex && !TechnicalName.IsNone())
+	{
+		LoadedObjectsByName.FindOrAdd(TechnicalName).Objects.Add(CloneContainer);
+	}
+
+	return InitialClone;
 }
 
 /**
- * Unloads all currently loaded packages, clearing object maps.
+ * Returns an empty container for an object that is loaded, reusing the container of an unloaded object if any.
+ * @return The container, owned by the database.
  */
-void UArticyDatabase::UnloadAllPackages()
+FArticyCloneableObject* UArticyDatabase::AllocateContainer()
 {
-	LoadedPackages.Reset();
-	LoadedObjectsById.Reset();
-	LoadedObjectsByName.Reset();
+	if (FreeContainerSlots.Num() > 0)
+		return ContainerSlots[FreeContainerSlots.Pop()].Get();
+
+	const int32 Slot = ContainerSlots.Num();
+	return ContainerSlots.Add_GetRef(MakeUnique<FArticyCloneableObject>(this, Slot)).Get();
 }
 
 /**
- * Sets the Expresso scripts class used for script execution.
- * @param NewClass The new Expresso scripts class to use.
+ * Releases the container of an object that is unloaded.
+ * The container is kept, so links to it detect the release by its generation instead of dangling.
+ * @param Container The container of the object.
  */
-void UArticyDatabase::SetExpressoScriptsClass(TSubclassOf<UArticyExpressoScripts> NewClass)
+void UArticyDatabase::ReleaseContainer(FArticyCloneableObject* Container)
 {
-	ExpressoScriptsClass = NewClass;
+	if (!Container || !ensure(ContainerSlots.IsValidIndex(Container->Slot) && ContainerSlots[Container->Slot].Get() == Container))
+		return;
+
+	Container->Release();
+	FreeContainerSlots.Add(Container->Slot);
 }
 
 /**
- * Retrieves the original database asset, optionally loading all packages.
- * @param bLoadAllPackages If true, loads all packages.
- * @return A pointer to the original UArticyDatabase asset.
+ * Loads a specific package by name, spreading the work over multiple frames.
+ * @param PackageName The name of the package to load.
+ * @param OnLoaded Called once the package is fully loaded.
  */
-const UArticyDatabase* UArticyDatabase::GetOriginal(bool bLoadAllPackages)
+void UArticyDatabase::LoadPackageAsync(FString PackageName, const FOnArticyPackageLoaded& OnLoaded)
 {
-	static TWeakObjectPtr<UArticyDatabase> Asset = nullptr;
+	if (LoadedPackages.Contains(PackageName))
+	{
+		UE_LOG(LogArticyRuntime, Log, TEXT("Package %s already loaded."), *PackageName);
+		OnLoaded.ExecuteIfBound(PackageName);
+		return;
+	}
 
-	if (!Asset.IsValid())
+	if (FPendingPackageLoad* Pending = PendingPackageLoads.FindByPredicate([&](const FPendingPackageLoad& Load) { return Load.PackageName == PackageName; }))
 	{
-		//create a clone of the database
-		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
-		TArray<FAssetData> AssetData;
+		Pending->Callbacks.Add(OnLoaded);
+		return;
+	}
 
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
-		AssetRegistryModule.Get().GetAssetsByClass(StaticClass()->GetClassPathName(), AssetData, true);
+	UArticyPackage* Package = GetPackageAsset(PackageName, false);
+	if (!Package)
+	{
+		const FArticyPackageEntry* Entry = ImportedPackageEntries.Find(PackageName);
+		if (!Entry || Entry->Package.IsNull())
+		{
+			UE_LOG(LogArticyRuntime, Error, TEXT("Failed to find Package %s in imported packages!"), *PackageName);
+			return;
+		}
+
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 3
+		const bool bHasAssetManager = UAssetManager::IsInitialized();
 #else
-		AssetRegistryModule.Get().GetAssetsByClass(StaticClass()->GetFName(), AssetData, true);
+		const bool bHasAssetManager = UAssetManager::IsValid();
 #endif
-
-		if (AssetData.Num() != 0)
+		if (!bHasAssetManager)
+		{
+			Package = Entry->Package.LoadSynchronous();
+		}
+		else
 		{
-			if (AssetData.Num() > 1)
+			//stream the package asset in first, the objects are added to the database once it is loaded
+			TWeakObjectPtr<UArticyDatabase> WeakThis(this);
+			UAssetManager::GetStreamableManager().RequestAsyncLoad(Entry->Package.ToSoftObjectPath(), [WeakThis, PackageName, OnLoaded]()
 			{
-				UE_LOG(LogArticyRuntime, Warning, TEXT("More than one ArticyDraftDatabase was found, this is not supported! The first one will be selected."));
-			}
-
-			Asset = Cast<UArticyDatabase>(AssetData[0].GetAsset());
+				if (UArticyDatabase* This = WeakThis.Get())
+				{
+					if (This->GetPackageAsset(PackageName, false))
+						This->LoadPackageAsync(PackageName, OnLoaded);
+					else
+						UE_LOG(LogArticyRuntime, Error, TEXT("Failed to load the asset of Package %s!"), *PackageName);
+				}
+			});
 
-			if (bLoadAllPackages && Asset.IsValid())
-				Asset.Get()->LoadAllPackages();
+			UE_LOG(LogArticyRuntime, Log, TEXT("Package %s queued for streaming."), *PackageName);
+			return;
 		}
-		else
+
+		if (!Package)
 		{
-			UE_LOG(LogArticyRuntime, Warning, TEXT("No ArticyDraftDatabase was found."));
+			UE_LOG(LogArticyRuntime, Error, TEXT("Failed to load the asset of Package %s!"), *PackageName);
+			return;
 		}
 	}
 
-	return Asset.Get();
+	ResidentPackages.Add(PackageName, Package);
+
+	FPendingPackageLoad& Load = PendingPackageLoads.AddDefaulted_GetRef();
+	Load.PackageName = PackageName;
+	Load.Assets = Package->GetAssets();
+	Load.Callbacks.Add(OnLoaded);
+
+	ReserveObjectTable(LoadedObjectsById.Num() + PendingObjectsById.Num() + Load.Assets.Num());
+
+	for (auto ArticyObject : Load.Assets)
+	{
+		const FArticyId id = ArticyObject->GetId();
+		if (!LoadedObjectsById.Contains(id))
+			PendingObjectsById.Add(id, ArticyObject);
+	}
+
+	if (!AsyncLoadTickerHandle.IsValid())
+	{
+		AsyncLoadTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateUObject(this, &UArticyDatabase::TickAsyncLoads), 0.0f);
+	}
+
+	UE_LOG(LogArticyRuntime, Log, TEXT("Package %s queued for async loading."), *PackageName);
 }
 
 /**
- * Retrieves a mutable original instance of the Articy database.
- * @return A weak pointer to the mutable UArticyDatabase instance.
+ * Checks if a package is currently being loaded by LoadPackageAsync.
+ * @param PackageName The name of the package to check.
+ * @return True if the package is still loading, false otherwise.
  */
-TWeakObjectPtr<UArticyDatabase> UArticyDatabase::GetMutableOriginal()
+bool UArticyDatabase::IsPackageLoading(const FString& PackageName) const
 {
-	static TWeakObjectPtr<UArticyDatabase> Asset = nullptr;
+	return PendingPackageLoads.ContainsByPredicate([&](const FPendingPackageLoad& Load) { return Load.PackageName == PackageName; });
+}
 
-	if (!Asset.IsValid())
-	{
-		//create a clone of the database
-		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
-		TArray<FAssetData> AssetData;
+/**
+ * Loads the next slice of the pending packages.
+ * @param DeltaTime The time since the last tick.
+ * @return True while there are pending packages left.
+ */
+bool UArticyDatabase::TickAsyncLoads(float DeltaTime)
+{
+	const double Deadline = FPlatformTime::Seconds() + UArticyPluginSettings::Get()->AsyncPackageLoadBudgetMs / 1000.0;
 
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
-		AssetRegistryModule.Get().GetAssetsByClass(StaticClass()->GetClassPathName(), AssetData, true);
-#else
-		AssetRegistryModule.Get().GetAssetsByClass(StaticClass()->GetFName(), AssetData, true);
-#endif
-		if (AssetData.Num() != 0)
-		{
-			if (AssetData.Num() > 1)
-			{
-				UE_LOG(LogArticyRuntime, Warning, TEXT("More than one ArticyDraftDatabase was found, this is not supported! The first one will be selected."));
-			}
+	while (PendingPackageLoads.Num() > 0)
+	{
+		if (!ContinuePendingLoad(PendingPackageLoads[0], Deadline))
+			break;
 
-			Asset = Cast<UArticyDatabase>(AssetData[0].GetAsset());
-		}
-		else
-		{
-			UE_LOG(LogArticyRuntime, Warning, TEXT("No ArticyDraftDatabase was found."));
-		}
+		FinishPendingLoad(0);
 	}
 
-	return Asset;
+	if (PendingPackageLoads.Num() > 0)
+		return true;
+
+	AsyncLoadTickerHandle.Reset();
+	return false;
 }
 
 /**
- * Changes the default package setting for a specific package.
- * @param PackageName The name of the package.
- * @param bIsDefaultPackage True to mark as default, false otherwise.
+ * Loads the remaining objects of a pending package up to a deadline.
+ * @param Load The pending package load.
+ * @param Deadline The platform time at which to stop, or 0 to load all remaining objects.
+ * @return True if all objects of the package are loaded.
  */
-void UArticyDatabase::ChangePackageDefault(FName PackageName, bool bIsDefaultPackage)
+bool UArticyDatabase::ContinuePendingLoad(FPendingPackageLoad& Load, double Deadline)
 {
-	if (ImportedPackages.Contains(PackageName.ToString()))
+	while (Load.NextAsset < Load.Assets.Num())
 	{
-		UArticyPackage* Package = ImportedPackages[PackageName.ToString()];
-
-		// additional check; maybe the map entry exists but has no value due to user error or bugs
-		if (!Package)
-		{
-			UE_LOG(LogArticyRuntime, Error, TEXT("Could not change package default setting of package %s: package not found"), *PackageName.ToString());
-			return;
-		}
+		UArticyObject* ArticyObject = Load.Assets[Load.NextAsset++];
 
-		// if the setting isn't going to change, return early
-		if (Package->bIsDefaultPackage == bIsDefaultPackage)
+		//objects might already be loaded on demand or by other packages, in which case only the reference is added
+		if (ArticyObject)
 		{
-			return;
+			PendingObjectsById.Remove(ArticyObject->GetId());
+			AddPackageReference(ArticyObject);
 		}
 
-		Package->bIsDefaultPackage = bIsDefaultPackage;
-		Package->MarkPackageDirty();
+		if (Deadline > 0 && FPlatformTime::Seconds() >= Deadline)
+			break;
 	}
-}
 
-//---------------------------------------------------------------------------//
+	return Load.NextAsset >= Load.Assets.Num();
+}
 
 /**
- * Retrieves an Articy object by its ID and clone ID.
- * @param Id The ID of the object to retrieve.
- * @param CloneId The clone ID of the object.
- * @param CastTo The class to cast the object to.
- * @return A pointer to the Articy object, or nullptr if not found.
+ * Marks the pending package load at the given index as loaded and fires its callbacks.
+ * @param Index The index into PendingPackageLoads.
  */
-UArticyObject* UArticyDatabase::GetObject(FArticyId Id, int32 CloneId, TSubclassOf<class UArticyObject> CastTo) const
+void UArticyDatabase::FinishPendingLoad(int32 Index)
 {
-	return GetObjectInternal(Id, CloneId);
+	//remove the entry before firing the callbacks, which might load or unload other packages
+	FPendingPackageLoad Load = MoveTemp(PendingPackageLoads[Index]);
+	PendingPackageLoads.RemoveAt(Index);
+
+	LoadedPackages.Add(Load.PackageName);
+	OnPackageResident(Load.PackageName, Load.Assets);
+	if (UArticyLocalizerSystem* Localizer = UArticyLocalizerSystem::Get())
+		Localizer->OnPackageLoaded(Load.PackageName);
+	LinkObjects();
+	UE_LOG(LogArticyRuntime, Log, TEXT("Package %s loaded successfully."), *Load.PackageName);
+
+	for (const FOnArticyPackageLoaded& Callback : Load.Callbacks)
+		Callback.ExecuteIfBound(Load.PackageName);
 }
 
 /**
- * Retrieves an unshadowed version of an Articy object.
- * @param Id The ID of the object to retrieve.
- * @param CloneId The clone ID of the object.
- * @return A pointer to the unshadowed Articy object, or nullptr if not found.
+ * Synchronously finishes loading a pending package, if it is pending.
+ * @param PackageName The name of the package.
  */
-UArticyObject* UArticyDatabase::GetObjectUnshadowed(FArticyId Id, int32 CloneId) const
+void UArticyDatabase::FlushPendingLoad(const FString& PackageName)
 {
-	return GetObjectInternal(Id, CloneId, true);
+	const int32 Index = PendingPackageLoads.IndexOfByPredicate([&](const FPendingPackageLoad& Load) { return Load.PackageName == PackageName; });
+	if (Index == INDEX_NONE)
+		return;
+
+	ContinuePendingLoad(PendingPackageLoads[Index], 0);
+	FinishPendingLoad(Index);
 }
 
 /**
- * Retrieves an Articy object by its ID and clone ID, with optional unshadowing.
- * @param Id The ID of the object to retrieve.
- * @param CloneId The clone ID of the object.
- * @param bForceUnshadowed If true, retrieves the unshadowed version.
- * @return A pointer to the Articy object, or nullptr if not found.
+ * Drops all pending package loads without loading them.
  */
-UArticyObject* UArticyDatabase::GetObjectInternal(FArticyId Id, int32 CloneId, bool bForceUnshadowed) const
+void UArticyDatabase::CancelPendingLoads()
 {
-	UArticyCloneableObject* const* info = LoadedObjectsById.Find(Id);
-	return info && (*info) ? (*info)->Get(this, CloneId, bForceUnshadowed) : nullptr;
+	for (const FPendingPackageLoad& Load : PendingPackageLoads)
+		UE_LOG(LogArticyRuntime, Log, TEXT("Async loading of package %s cancelled."), *Load.PackageName);
+
+	PendingPackageLoads.Reset();
+	PendingObjectsById.Reset();
+
+	if (AsyncLoadTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(AsyncLoadTickerHandle);
+		AsyncLoadTickerHandle.Reset();
+	}
 }
 
 /**
- * Retrieves an Articy object by its technical name and clone ID.
- * @param TechnicalName The technical name of the object to retrieve.
- * @param CloneId The clone ID of the object.
- * @param CastTo The class to cast the object to.
- * @return A pointer to the Articy object, or nullptr if not found.
+ * Loads an object of a package which is still loading out of order, so GetObject can return it.
+ * @param Id The id of the object.
+ * @return The unshadowed clone 0 of the object, or nullptr if no loading package contains it.
  */
-UArticyObject* UArticyDatabase::GetObjectByName(FName TechnicalName, int32 CloneId, TSubclassOf<class UArticyObject> CastTo) const
+UArticyObject* UArticyDatabase::ResolvePendingObject(const FArticyId& Id)
 {
-	auto arr = LoadedObjectsByName.Find(TechnicalName);
-	if (!arr || arr->Objects.Num() <= 0)
+	UArticyObject* ArticyObject = nullptr;
+	if (!PendingObjectsById.RemoveAndCopyValue(Id, ArticyObject) || !ArticyObject)
 		return nullptr;
 
-	auto info = arr->Objects[0];
-	return info ? Cast<UArticyObject>(info->Get(this, CloneId)) : nullptr;
+	return LoadObjectFromAsset(ArticyObject);
 }
 
 /**
- * Retrieves an Articy object from a string representation.
- * @param StringID_CloneID The string representation of the object's ID and clone ID.
- * @param CastTo The class to cast the object to.
- * @return A pointer to the Articy object, or nullptr if not found.
+ * Calls Visitor for every clone of the loaded objects and each of its shadow copies.
+ * @param Visitor Called with the object and its shadow level, 0 for the clones themselves.
  */
-UArticyObject* UArticyDatabase::GetObjectFromStringRepresentation(FString StringID_CloneID, TSubclassOf<class UArticyObject> CastTo) const
+void UArticyDatabase::ForEachObjectCopy(TFunctionRef<void(const UArticyObject*, uint32)> Visitor) const
 {
-	FString StringId, CloneId;
-	StringID_CloneID.Split(TEXT("_"), &StringId, &CloneId, ESearchCase::IgnoreCase, ESearchDir::FromEnd);
-	uint64 id = FCString::Strtoui64(*StringId, NULL, 10);
-
-	return GetObjectInternal(id, FCString::Atoi(*CloneId));
+	for (const TPair<FArticyId, FArticyCloneableObject*>& Loaded : LoadedObjectsById)
+	{
+		if (Loaded.Value)
+			Loaded.Value->ForEachCopy(Visitor);
+	}
 }
 
 /**
- * Retrieves all Articy objects with a given technical name and clone ID.
- * @param TechnicalName The technical name of the objects to retrieve.
- * @param CloneId The clone ID of the objects.
- * @param CastTo The class to cast the objects to.
- * @return An array of pointers to the Articy objects, or empty if none found.
+ * Reports the clones and shadow copies held by the object containers, which are no UObjects themselves.
+ * Released containers hold no clones, so all slots are reported without a lookup.
+ * @param InThis The database.
+ * @param Collector The collector of the references.
  */
-TArray<UArticyObject*> UArticyDatabase::GetObjects(FName TechnicalName, int32 CloneId, TSubclassOf<class UArticyObject> CastTo) const
+void UArticyDatabase::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
 {
-	return GetObjects<UArticyObject>(TechnicalName, CloneId);
+	UArticyDatabase* Database = CastChecked<UArticyDatabase>(InThis);
+	for (const TUniquePtr<FArticyCloneableObject>& Container : Database->ContainerSlots)
+	{
+		for (FArticyShadowableObject& Clone : Container->Clones)
+			Clone.AddReferencedObjects(Collector, Database);
+	}
+
+	Super::AddReferencedObjects(InThis, Collector);
 }
 
 /**
- * Retrieves all Articy objects of a specified class with a given clone ID.
- * @param Type The class type of the objects to retrieve.
- * @param CloneId The clone ID of the objects.
- * @return An array of pointers to the Articy objects, or empty if none found.
+ * Stops the async loading before the database is destroyed.
  */
-TArray<UArticyObject*> UArticyDatabase::GetObjectsOfClass(TSubclassOf<class UArticyObject> Type, int32 CloneId) const
+void UArticyDatabase::BeginDestroy()
 {
-	TArray<UArticyObject*> arr;
-	TArray<UArticyCloneableObject*> Objects;
-	LoadedObjectsById.GenerateValueArray(Objects);
+	CancelPendingLoads();
+	ReleaseSharedObjects();
 
-	for (auto ClonableObject : Objects)
+	if (EvictionTickerHandle.IsValid())
 	{
-		auto obj = ClonableObject->Get(this, CloneId, /*bForceUnshadowed = */ true);
-		if (obj && (obj->GetCloneId() == CloneId) && obj->IsA(Type))
-			arr.Add(Cast<UArticyObject>(obj));
+		FTSTicker::GetCoreTicker().RemoveTicker(EvictionTickerHandle);
+		EvictionTickerHandle.Reset();
 	}
 
-	return arr;
+	Super::BeginDestroy();
 }
 
 /**
- * Retrieves all Articy objects currently loaded in the database.
- * @return An array of pointers to all Articy objects.
+ * Moves the hard package references of databases saved by older versions into the soft package entries.
  */
-TArray<UArticyObject*> UArticyDatabase::GetAllObjects() const
+void UArticyDatabase::PostLoad()
 {
-	TArray<UArticyObject*> arr;
-	TArray<UArticyCloneableObject*> Objects;
-	LoadedObjectsById.GenerateValueArray(Objects);
-	for (auto ClonableObject : Objects)
+	Super::PostLoad();
+
+	for (const TPair<FString, UArticyPackage*>& pack : ImportedPackages_DEPRECATED)
 	{
-		auto obj = ClonableObject->Get(this, 0, /*bForceUnshadowed = */ true);
-		arr.Add(obj);
+		if (!pack.Value || ImportedPackageEntries.Contains(pack.Key))
+			continue;
+
+		FArticyPackageEntry& Entry = ImportedPackageEntries.Add(pack.Key);
+		Entry.Package = pack.Value;
+		Entry.bIsDefaultPackage = pack.Value->bIsDefaultPackage;
+		Entry.ChunkId = pack.Value->ChunkId;
 	}
-	return arr;
+	ImportedPackages_DEPRECATED.Empty();
 }
 
-//---------------------------------------------------------------------------//
-
 /**
- * Clones an Articy object by its ID, creating a new instance with the specified clone ID.
- * @param Id The ID of the object to clone.
- * @param NewCloneId The clone ID for the new instance.
- * @param CastTo The class to cast the clone to.
- * @return A pointer to the newly created clone, or nullptr if creation failed.
+ * Serializes the database. Cooked databases also carry the flow graph image of their default packages, which is
+ * built when the database is cooked (see PreSave) and restored by GetFlowGraph.
+ * @param Ar The archive to serialize with.
  */
-UArticyObject* UArticyDatabase::CloneFrom(FArticyId Id, int32 NewCloneId, TSubclassOf<class UArticyObject> CastTo)
+void UArticyDatabase::Serialize(FArchive& Ar)
 {
-	auto info = LoadedObjectsById.Find(Id);
-	return info ? (*info)->Clone(this, NewCloneId, true) : nullptr;
+	Super::Serialize(Ar);
+
+	if (!Ar.IsPersistent() || !Ar.IsFilterEditorOnly() || !(Ar.IsSaving() || Ar.IsLoading()))
+		return;
+
+	bool bHasImage = FlowGraphImage.IsValid();
+	Ar << bHasImage;
+	if (Ar.IsLoading())
+		FlowGraphImage = bHasImage ? MakeShared<FArticyFlowGraphImage>() : nullptr;
+	if (bHasImage)
+		Ar << *FlowGraphImage;
 }
 
+#if WITH_EDITOR
 /**
- * Clones an Articy object by its technical name, creating a new instance with the specified clone ID.
- * @param TechnicalName The technical name of the object to clone.
- * @param NewCloneId The clone ID for the new instance.
- * @param CastTo The class to cast the clone to.
- * @return A pointer to the newly created clone, or nullptr if creation failed.
+ * Builds the flow graph image before the database is cooked.
+ * @param SaveContext The context of the save.
  */
-UArticyObject* UArticyDatabase::CloneFromByName(FName TechnicalName, int32 NewCloneId, TSubclassOf<class UArticyObject> CastTo)
+#if ENGINE_MAJOR_VERSION >= 5
+void UArticyDatabase::PreSave(FObjectPreSaveContext SaveContext)
 {
-	auto arr = LoadedObjectsByName.Find(TechnicalName);
+	Super::PreSave(SaveContext);
+	if (SaveContext.IsCooking())
+		BuildFlowGraphImage();
+}
+#else
+void UArticyDatabase::PreSave(const ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+	if (TargetPlatform)
+		BuildFlowGraphImage();
+}
+#endif
+
+/**
+ * Builds the flow graph image of the default packages: a transient copy of this database loads them the way a new
+ * game does, and its graph is saved with the ids of the objects.
+ */
+void UArticyDatabase::BuildFlowGraphImage()
+{
+	UArticyDatabase* Copy = DuplicateObject(this, GetTransientPackage());
+	if (!Copy)
+		return;
+
+	//the asset may have loaded packages in the editor, the image covers the default ones only
+	Copy->UnloadAllPackages();
+	Copy->Init();
+
+	TSharedPtr<FArticyFlowGraphImage> Image = MakeShared<FArticyFlowGraphImage>();
+	Copy->GetFlowGraph().SaveImage(Copy, *Image);
+	FlowGraphImage = Image;
+
+	Copy->UnloadAllPackages();
+
+	UE_LOG(LogArticyRuntime, Log, TEXT("Built the flow graph image of %d default packages, %d nodes."), Image->Packages.Num(), Image->Nodes.Num());
+}
+#endif
+
+/**
+ * Unloads a specific package by name.
+ * @param PackageName The name of the package to unload.
+ * @param bQuickUnload If true, the objects are unloaded even if other loaded packages contain them too.
+ * @return True if the package was successfully unloaded, false otherwise.
+ */
+bool UArticyDatabase::UnloadPackage(const FString PackageName, const bool bQuickUnload)
+{
+	//finish an async load first, so all objects of the package are in the lookup tables
+	FlushPendingLoad(PackageName);
+
+	if (!LoadedPackages.Contains(PackageName))
+	{
+		//an evicted package is not loaded again on access after it was unloaded explicitly
+		if (const int32* UsageIndex = PackageUsageIndices.Find(PackageName))
+		{
+			for (const FArticyId& Id : PackageUsage[*UsageIndex].EvictedIds)
+				EvictedObjects.Remove(Id);
+			PackageUsage[*UsageIndex].EvictedIds.Reset();
+		}
+
+		UE_LOG(LogArticyRuntime, Log, TEXT("Package %s can't be unloaded due to not being loaded in the first place."), *PackageName);
+		return false;
+	}
+
+	UArticyPackage* Package = GetPackageAsset(PackageName, false);
+	if (!Package)
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Failed to find Package %s in imported packages!"), *PackageName);
+		return false;
+	}
+
+	OnPackageNotResident(PackageName);
+
+	for (auto ArticyObject : Package->GetAssets())
+	{
+		FArticyId ArticyId = ArticyObject->GetId();
+
+		FArticyCloneableObject* const* ContainerPtr = LoadedObjectsById.Find(ArticyId);
+		if (!ContainerPtr || !*ContainerPtr)
+			continue;
+
+		/*
+		 *	An exported object can exist multiple times in different packages
+		 *  In the database, there can only be one object with the same Id, so unless we are unloading quickly,
+		 *  it is only unloaded once no other loaded package references it anymore
+		*/
+		FArticyCloneableObject* Container = *ContainerPtr;
+		if (--Container->PackageRefCount > 0 && !bQuickUnload)
+			continue;
+
+		if (UArticyObject* Original = Container->Get(this, 0, true))
+			RemoveFromClassIndex(Container, Original->GetClass());
+
+		RemoveFromNameIndex(Container, ArticyObject->GetTechnicalName());
+		RemoveFromObjectTable(ArticyId);
+		ReleaseSharedObject(Container);
+		LoadedObjectsById.Remove(ArticyId);
+		ReleaseContainer(Container);
+	}
+
+	LoadedPackages.Remove(Package->Name);
+	//the package asset can be garbage collected now
+	ResidentPackages.Remove(PackageName);
+	if (UArticyLocalizerSystem* Localizer = UArticyLocalizerSystem::Get())
+		Localizer->OnPackageUnloaded(PackageName);
+
+	//unlink the references to the unloaded objects
+	if (!bDeferLinking)
+		LinkObjects();
+	UE_LOG(LogArticyRuntime, Log, TEXT("Package %s unloaded successfully."), *PackageName);
+
+	return true;
+}
+
+#if WITH_EDITOR
+/**
+ * Returns the databases of the running game.
+ * @return The world clones and the persistent clone.
+ */
+TArray<UArticyDatabase*> UArticyDatabase::GetRuntimeClones()
+{
+	TArray<UArticyDatabase*> Databases;
+	for (const auto& Clone : Clones)
+	{
+		if (Clone.Value.IsValid())
+			Databases.AddUnique(Clone.Value.Get());
+	}
+
+	if (PersistentClone.IsValid())
+		Databases.AddUnique(PersistentClone.Get());
+
+	return Databases;
+}
+
+/**
+ * Unloads packages from the databases of the running game, before an import during play regenerates their assets,
+ * so the databases do not reference the replaced assets. The clone ids of the unloaded objects are remembered.
+ * @param Packages The regenerated packages, by the name the databases loaded them with, with their new name.
+ */
+void UArticyDatabase::BeginPackageHotPatch(const TMap<FString, FString>& Packages)
+{
+	for (UArticyDatabase* Database : GetRuntimeClones())
+	{
+		{
+			TGuardValue<bool> DeferLinking(Database->bDeferLinking, true);
+			for (const TPair<FString, FString>& Package : Packages)
+			{
+				Database->FlushPendingLoad(Package.Key);
+				if (!Database->LoadedPackages.Contains(Package.Key))
+					continue;
+
+				if (UArticyPackage* Asset = Database->GetPackageAsset(Package.Key, false))
+				{
+					for (const UArticyObject* ArticyObject : Asset->GetAssets())
+					{
+						const FArticyCloneableObject* Container = ArticyObject ? Database->LoadedObjectsById.FindRef(ArticyObject->GetId()) : nullptr;
+						if (!Container)
+							continue;
+
+						for (int32 CloneId = 1; CloneId < Container->Clones.Num(); ++CloneId)
+						{
+							if (Container->Clones[CloneId].IsValid())
+								Database->HotPatchedCloneIds.FindOrAdd(ArticyObject->GetId()).AddUnique(CloneId);
+						}
+					}
+				}
+
+				if (Database->UnloadPackage(Package.Key, false))
+					Database->HotPatchedPackages.AddUnique(Package.Value);
+			}
+		}
+
+		//unlink the references to the unloaded objects until the packages are loaded again
+		if (Database->HotPatchedPackages.Num() > 0)
+			Database->LinkObjects();
+	}
+}
+
+/**
+ * Loads the packages unloaded by BeginPackageHotPatch from their regenerated assets, and clones their objects
+ * with the clone ids they had before. The clones start from the new content.
+ */
+void UArticyDatabase::EndPackageHotPatch()
+{
+	const UArticyDatabase* Original = GetOriginal();
+	for (UArticyDatabase* Database : GetRuntimeClones())
+	{
+		if (Database->HotPatchedPackages.Num() == 0)
+			continue;
+
+		//the package entries and the hierarchy of the running database are the ones of the database asset it was cloned from
+		if (Original)
+		{
+			Database->ImportedPackageEntries = Original->ImportedPackageEntries;
+			Database->Hierarchy = Original->Hierarchy;
+		}
+
+		{
+			TGuardValue<bool> DeferLinking(Database->bDeferLinking, true);
+			for (const FString& PackageName : Database->HotPatchedPackages)
+				Database->LoadPackage(PackageName);
+		}
+
+		for (const TPair<FArticyId, TArray<int32>>& CloneIds : Database->HotPatchedCloneIds)
+		{
+			FArticyCloneableObject* Container = Database->LoadedObjectsById.FindRef(CloneIds.Key);
+			if (!Container)
+				continue;
+
+			for (const int32 CloneId : CloneIds.Value)
+				Container->Clone(Database, CloneId, false);
+		}
+
+		Database->LinkObjects();
+
+		UE_LOG(LogArticyRuntime, Log, TEXT("Hot-patched %d packages of a running ArticyDatabase."), Database->HotPatchedPackages.Num());
+		Database->HotPatchedPackages.Reset();
+		Database->HotPatchedCloneIds.Reset();
+	}
+}
+#endif
+
+/**
+ * Unloads all currently loaded packages, clearing object maps.
+ */
+void UArticyDatabase::UnloadAllPackages()
+{
+	CancelPendingLoads();
+	ReleaseSharedObjects();
+	if (UArticyLocalizerSystem* Localizer = UArticyLocalizerSystem::Get())
+	{
+		for (const FString& PackageName : LoadedPackages)
+			Localizer->OnPackageUnloaded(PackageName);
+	}
+	LoadedPackages.Reset();
+	ResidentPackages.Reset();
+	for (const TPair<FArticyId, FArticyCloneableObject*>& Loaded : LoadedObjectsById)
+		ReleaseContainer(Loaded.Value);
+	LoadedObjectsById.Reset();
+	LoadedObjectsByName.Reset();
+	ObjectTable.Reset();
+	++ObjectResolveVersion;
+	ObjectsByClass.Reset();
+	MatchingClassesCache.Reset();
+
+	//the measured sizes and the pins are kept
+	for (FPackageUsage& Usage : PackageUsage)
+	{
+		Usage.bResident = false;
+		Usage.EvictedIds.Reset();
+	}
+	EvictedObjects.Reset();
+	ResidentPackageBytes = 0;
+}
+
+//---------------------------------------------------------------------------//
+
+/**
+ * Returns the usage entry of a package, adding it if needed.
+ * @param PackageName The name of the package.
+ * @return The index into PackageUsage.
+ */
+int32 UArticyDatabase::FindOrAddPackageUsage(const FString& PackageName)
+{
+	if (const int32* Index = PackageUsageIndices.Find(PackageName))
+		return *Index;
+
+	const int32 Index = PackageUsage.AddDefaulted();
+	PackageUsage[Index].Name = PackageName;
+	PackageUsageIndices.Add(PackageName, Index);
+	return Index;
+}
+
+/**
+ * Starts tracking the use of a package that was loaded, if there is a residency budget and it is no default package.
+ * Measures the objects of the package the first time, and evicts packages at the end of the frame if needed.
+ * @param PackageName The name of the package.
+ * @param Assets The object assets of the package.
+ */
+void UArticyDatabase::OnPackageResident(const FString& PackageName, TConstArrayView<UArticyObject*> Assets)
+{
+	if (UArticyPluginSettings::Get()->PackageResidencyBudgetMB <= 0 || IsPackageDefaultPackage(PackageName))
+		return;
+
+	bTrackPackageUsage = true;
+
+	const int32 UsageIndex = FindOrAddPackageUsage(PackageName);
+	FPackageUsage& Usage = PackageUsage[UsageIndex];
+	if (Usage.Bytes == 0)
+	{
+		for (const UArticyObject* Asset : Assets)
+			Usage.Bytes += FArticyMemoryReport::GetObjectSize(Asset);
+	}
+
+	for (const FArticyId& Id : Usage.EvictedIds)
+		EvictedObjects.Remove(Id);
+	Usage.EvictedIds.Reset();
+
+	//objects of several packages count for the one they were loaded with first
+	for (const UArticyObject* Asset : Assets)
+	{
+		FArticyCloneableObject* Container = Asset ? LoadedObjectsById.FindRef(Asset->GetId()) : nullptr;
+		if (Container && Container->PackageUsageIndex == INDEX_NONE)
+			Container->PackageUsageIndex = UsageIndex;
+	}
+
+	Usage.bResident = true;
+	Usage.LastUseFrame = GFrameCounter;
+	ResidentPackageBytes += Usage.Bytes;
+	ScheduleEviction();
+}
+
+/**
+ * Stops tracking a package that is unloaded.
+ * @param PackageName The name of the package.
+ */
+void UArticyDatabase::OnPackageNotResident(const FString& PackageName)
+{
+	const int32* UsageIndex = PackageUsageIndices.Find(PackageName);
+	if (!UsageIndex || !PackageUsage[*UsageIndex].bResident)
+		return;
+
+	PackageUsage[*UsageIndex].bResident = false;
+	ResidentPackageBytes -= PackageUsage[*UsageIndex].Bytes;
+}
+
+/**
+ * Schedules the eviction for the end of the frame, so the objects returned in this frame stay loaded.
+ */
+void UArticyDatabase::ScheduleEviction()
+{
+	const int64 Budget = (int64)UArticyPluginSettings::Get()->PackageResidencyBudgetMB << 20;
+	if (Budget <= 0 || ResidentPackageBytes <= Budget || EvictionTickerHandle.IsValid())
+		return;
+
+	EvictionTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &UArticyDatabase::EvictPackages), 0.0f);
+}
+
+/**
+ * Checks if objects carry state that reloading their package would lose: clones, or writes to the original.
+ * @param Ids The IDs of the objects.
+ * @return True if one of the objects has clones or was written.
+ */
+bool UArticyDatabase::HasRuntimeState(TConstArrayView<FArticyId> Ids) const
+{
+	for (const FArticyId& Id : Ids)
+	{
+		if (ModifiedObjectIds.Contains(Id))
+			return true;
+
+		const FArticyCloneableObject* Container = LoadedObjectsById.FindRef(Id);
+		if (!Container)
+			continue;
+
+		for (int32 CloneId = 1; CloneId < Container->Clones.Num(); ++CloneId)
+		{
+			if (Container->Clones[CloneId].IsValid())
+				return true;
+		}
+
+		const UArticyObject* Original = Container->Get(this, 0, true);
+		if (Original && Original->IsModified())
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * Unloads the least recently used, unpinned packages until the resident packages fit into the budget again.
+ * Packages whose objects have clones or were written are kept, as unloading would discard that state.
+ * The ids of the evicted objects are kept, so GetObject loads the packages again on demand.
+ * @param DeltaTime The time since the last tick.
+ * @return False, the ticker runs once.
+ */
+bool UArticyDatabase::EvictPackages(float DeltaTime)
+{
+	EvictionTickerHandle.Reset();
+
+	//unloading inside a shadow state would drop shadow copies the undo log still refers to
+	if (GetShadowLevel() > 0)
+	{
+		ScheduleEviction();
+		return false;
+	}
+
+	const int64 Budget = (int64)UArticyPluginSettings::Get()->PackageResidencyBudgetMB << 20;
+	int32 NumEvicted = 0;
+	{
+		TGuardValue<bool> DeferLinking(bDeferLinking, true);
+		while (Budget > 0 && ResidentPackageBytes > Budget)
+		{
+			int32 Oldest = INDEX_NONE;
+			for (int32 Index = 0; Index < PackageUsage.Num(); ++Index)
+			{
+				const FPackageUsage& Usage = PackageUsage[Index];
+				if (Usage.bResident && Usage.PinCount == 0 && Usage.LastUseFrame < GFrameCounter && !IsPackageLoading(Usage.Name)
+					&& (Oldest == INDEX_NONE || Usage.LastUseFrame < PackageUsage[Oldest].LastUseFrame))
+				{
+					Oldest = Index;
+				}
+			}
+
+			if (Oldest == INDEX_NONE)
+				break;
+
+			const FString PackageName = PackageUsage[Oldest].Name;
+			TArray<FArticyId> Ids;
+			if (UArticyPackage* Package = GetPackageAsset(PackageName, false))
+			{
+				for (const UArticyObject* Asset : Package->GetAssets())
+				{
+					if (Asset)
+						Ids.Add(Asset->GetId());
+				}
+			}
+
+			//marked as used, so this pass does not pick it again
+			if (HasRuntimeState(Ids))
+			{
+				PackageUsage[Oldest].LastUseFrame = GFrameCounter;
+				continue;
+			}
+
+			if (!UnloadPackage(PackageName, false))
+			{
+				OnPackageNotResident(PackageName);
+				continue;
+			}
+
+			for (const FArticyId& Id : Ids)
+				EvictedObjects.Add(Id, Oldest);
+			PackageUsage[Oldest].EvictedIds = MoveTemp(Ids);
+			++NumEvicted;
+
+			UE_LOG(LogArticyRuntime, Verbose, TEXT("Evicted package %s (%lld KB) to stay within the package residency budget."),
+				*PackageName, PackageUsage[Oldest].Bytes >> 10);
+		}
+	}
+
+	if (NumEvicted > 0)
+		LinkObjects();
+
+	return false;
+}
+
+/**
+ * Resolves an object like GetObjectInternal, marking its package as used in this frame.
+ * An object of an evicted package starts loading the package again with LoadPackageAsync and is not returned yet,
+ * as a synchronous load could add objects while the caller iterates them or inside a shadow state.
+ * @param Id The ID of the object.
+ * @param CloneId The clone ID.
+ * @param bForceUnshadowed Whether to return the unshadowed object.
+ * @return The object, or nullptr if it is not loaded.
+ */
+UArticyObject* UArticyDatabase::GetResidentObject(FArticyId Id, int32 CloneId, bool bForceUnshadowed)
+{
+	FArticyCloneableObject* Container = LoadedObjectsById.FindRef(Id);
+	if (!Container)
+	{
+		if (PendingObjectsById.Num() > 0 && ResolvePendingObject(Id))
+		{
+			Container = LoadedObjectsById.FindRef(Id);
+		}
+		else if (const int32* UsageIndex = EvictedObjects.Find(Id))
+		{
+			const FString PackageName = PackageUsage[*UsageIndex].Name;
+			if (!IsPackageLoading(PackageName))
+			{
+				UE_LOG(LogArticyRuntime, Verbose, TEXT("Loading evicted package %s again."), *PackageName);
+				LoadPackageAsync(PackageName, FOnArticyPackageLoaded());
+			}
+		}
+	}
+
+	if (!Container)
+		return nullptr;
+
+	if (PackageUsage.IsValidIndex(Container->PackageUsageIndex))
+		PackageUsage[Container->PackageUsageIndex].LastUseFrame = GFrameCounter;
+
+	return Container->Get(this, CloneId, bForceUnshadowed);
+}
+
+/**
+ * Pins a package, so the residency budget does not evict it.
+ * @param PackageName The name of the package.
+ */
+void UArticyDatabase::PinPackage(const FString& PackageName)
+{
+	++PackageUsage[FindOrAddPackageUsage(PackageName)].PinCount;
+}
+
+/**
+ * Removes a pin of a package, which may be evicted at the end of the frame then.
+ * @param PackageName The name of the package.
+ */
+void UArticyDatabase::UnpinPackage(const FString& PackageName)
+{
+	const int32* UsageIndex = PackageUsageIndices.Find(PackageName);
+	if (!UsageIndex || !ensureMsgf(PackageUsage[*UsageIndex].PinCount > 0, TEXT("Package %s is not pinned."), *PackageName))
+		return;
+
+	--PackageUsage[*UsageIndex].PinCount;
+	ScheduleEviction();
+}
+
+/**
+ * Returns the non-default package an object was loaded with.
+ * @param Id The ID of the object.
+ * @return The name of the package, or an empty string if the object is not loaded or its package is not tracked.
+ */
+FString UArticyDatabase::FindPackageOfObject(const FArticyId& Id) const
+{
+	const FArticyCloneableObject* Container = LoadedObjectsById.FindRef(Id);
+	return Container && PackageUsage.IsValidIndex(Container->PackageUsageIndex) ? PackageUsage[Container->PackageUsageIndex].Name : FString();
+}
+
+/**
+ * Adds a loaded object to the class index.
+ * @param Container The container of the object.
+ * @param Class The class of the object.
+ */
+void UArticyDatabase::AddToClassIndex(FArticyCloneableObject* Container, const UClass* Class)
+{
+	TArray<FArticyCloneableObject*>* Bucket = ObjectsByClass.Find(Class);
+	if (!Bucket)
+	{
+		//a new class might match any of the cached queries
+		MatchingClassesCache.Reset();
+		Bucket = &ObjectsByClass.Add(Class);
+	}
+
+	Container->ClassBucketIndex = Bucket->Add(Container);
+}
+
+/**
+ * Removes an unloaded object from the class index.
+ * @param Container The container of the object.
+ * @param Class The class of the object.
+ */
+void UArticyDatabase::RemoveFromClassIndex(FArticyCloneableObject* Container, const UClass* Class)
+{
+	TArray<FArticyCloneableObject*>* Bucket = ObjectsByClass.Find(Class);
+	const int32 Index = Container->ClassBucketIndex;
+	if (!Bucket || !ensure(Bucket->IsValidIndex(Index) && (*Bucket)[Index] == Container))
+		return;
+
+	//swap the last container into the gap, and update its index
+	Bucket->RemoveAtSwap(Index);
+	if (Bucket->IsValidIndex(Index))
+		(*Bucket)[Index]->ClassBucketIndex = Index;
+
+	Container->ClassBucketIndex = INDEX_NONE;
+}
+
+/**
+ * Removes an unloaded object from the name index.
+ * @param Container The container of the object.
+ * @param TechnicalName The technical name of the object.
+ */
+void UArticyDatabase::RemoveFromNameIndex(FArticyCloneableObject* Container, FName TechnicalName)
+{
+	FArticyDatabaseObjectArray* arr = LoadedObjectsByName.Find(TechnicalName);
+	if (!arr)
+		return;
+
+	//technical names are nearly unique, so the buckets are tiny
+	arr->Objects.RemoveSingleSwap(Container);
+	if (arr->Objects.Num() == 0)
+		LoadedObjectsByName.Remove(TechnicalName);
+}
+
+/**
+ * Returns the classes in ObjectsByClass which are Class or a subclass of it.
+ * @param Class The queried class.
+ * @return The matching classes.
+ */
+const TArray<const UClass*>& UArticyDatabase::GetMatchingClasses(const UClass* Class) const
+{
+	if (const TUniquePtr<TArray<const UClass*>>* Cached = MatchingClassesCache.Find(Class))
+		return **Cached;
+
+	TArray<const UClass*>& Matching = *MatchingClassesCache.Add(Class, MakeUnique<TArray<const UClass*>>());
+	for (const auto& Pair : ObjectsByClass)
+	{
+		if (Class && Pair.Key->IsChildOf(Class))
+			Matching.Add(Pair.Key);
+	}
+
+	return Matching;
+}
+
+//---------------------------------------------------------------------------//
+
+/**
+ * Creates the iterator and moves it to the first object.
+ * @param InDatabase The database to iterate.
+ * @param Class The class of the objects to iterate.
+ * @param InCloneId The clone ID of the objects.
+ * @param bInForceUnshadowed If true, the unshadowed objects are returned.
+ */
+FArticyObjectOfClassIterator::FArticyObjectOfClassIterator(const UArticyDatabase* InDatabase, const UClass* Class, int32 InCloneId, bool bInForceUnshadowed)
+	: Database(InDatabase), Classes(InDatabase->GetMatchingClasses(Class)), CloneId(InCloneId), bForceUnshadowed(bInForceUnshadowed)
+{
+	Advance();
+}
+
+/**
+ * Advances to the next object which has a clone with the requested id.
+ */
+void FArticyObjectOfClassIterator::Advance()
+{
+	Current = nullptr;
+
+	while (ClassIndex < Classes.Num())
+	{
+		if (!Bucket)
+			Bucket = Database->ObjectsByClass.Find(Classes[ClassIndex]);
+
+		if (Bucket && ++ObjectIndex < Bucket->Num())
+		{
+			Current = (*Bucket)[ObjectIndex]->Get(Database, CloneId, bForceUnshadowed);
+			if (Current)
+				return;
+			continue;
+		}
+
+		//move on to the next class bucket
+		++ClassIndex;
+		ObjectIndex = -1;
+		Bucket = nullptr;
+	}
+}
+
+/**
+ * Rebuilds the object table from LoadedObjectsById.
+ * @param MinNum The minimum number of objects the table should have room for.
+ */
+void UArticyDatabase::RebuildObjectTable(int32 MinNum)
+{
+	const int32 NumObjects = FMath::Max(MinNum, LoadedObjectsById.Num());
+
+	//keep the load factor at or below 50%, so that almost every lookup hits on the first probe
+	const int32 Capacity = NumObjects > 0 ? (int32)FMath::RoundUpToPowerOfTwo((uint32)NumObjects * 2) : 0;
+
+	++ObjectStateVersion;
+	++ObjectResolveVersion;
+	++ObjectTableVersion;
+	++ObjectTableIdsVersion;
+	ObjectTable.Reset();
+	ObjectTable.SetNum(Capacity);
+
+	for (const auto& Pair : LoadedObjectsById)
+	{
+		if (Pair.Value)
+			AddToObjectTable(Pair.Key, Pair.Value->Get(this, 0, true));
+	}
+}
+
+/**
+ * Makes sure the object table can hold NumObjects objects without exceeding its load factor.
+ * @param NumObjects The number of objects the table must be able to hold.
+ */
+void UArticyDatabase::ReserveObjectTable(int32 NumObjects)
+{
+	if (NumObjects * 2 > ObjectTable.Num())
+		RebuildObjectTable(NumObjects);
+}
+
+/**
+ * Inserts an object into the object table, the table must have enough room left.
+ * @param Id The id of the object.
+ * @param Object The unshadowed clone 0 of the object.
+ */
+void UArticyDatabase::AddToObjectTable(const FArticyId& Id, UArticyObject* Object)
+{
+	if (!Object || !ensure(ObjectTable.Num() > 0))
+		return;
+
+	++ObjectStateVersion;
+	++ObjectResolveVersion;
+	++ObjectTableVersion;
+	MarkForPropertyIndices(Id);
+	const uint32 Mask = ObjectTable.Num() - 1;
+	for (uint32 Index = GetTypeHash(Id) & Mask; ; Index = (Index + 1) & Mask)
+	{
+		FObjectTableSlot& Slot = ObjectTable[Index];
+		if (!Slot.Object || Slot.Id == Id)
+		{
+			//the flow graph keeps its structure if only the object of an id is replaced, e.g. by MaterializeSharedObject
+			if (!Slot.Object)
+				++ObjectTableIdsVersion;
+			else if (FlowGraph)
+				PendingFlowGraphUpdates.Add(Id);
+
+			Slot.Id = Id;
+			Slot.Object = Object;
+			return;
+		}
+	}
+}
+
+/**
+ * Removes an object from the object table (backward shift deletion).
+ * @param Id The id of the object.
+ */
+void UArticyDatabase::RemoveFromObjectTable(const FArticyId& Id)
+{
+	if (ObjectTable.Num() == 0)
+		return;
+
+	++ObjectStateVersion;
+	++ObjectResolveVersion;
+	++ObjectTableVersion;
+	++ObjectTableIdsVersion;
+	MarkForPropertyIndices(Id);
+	const uint32 Mask = ObjectTable.Num() - 1;
+
+	//find the slot of the object
+	uint32 Hole = GetTypeHash(Id) & Mask;
+	while (ObjectTable[Hole].Object && !(ObjectTable[Hole].Id == Id))
+		Hole = (Hole + 1) & Mask;
+
+	if (!ObjectTable[Hole].Object)
+		return;
+
+	//move following entries of the probe sequence into the hole, so lookups never hit a gap too early
+	for (uint32 Index = (Hole + 1) & Mask; ObjectTable[Index].Object; Index = (Index + 1) & Mask)
+	{
+		const uint32 Home = GetTypeHash(ObjectTable[Index].Id) & Mask;
+		const bool bHomeBetween = Hole <= Index ? (Hole < Home && Home <= Index) : (Hole < Home || Home <= Index);
+		if (bHomeBetween)
+			continue;
+
+		ObjectTable[Hole] = ObjectTable[Index];
+		Hole = Index;
+	}
+
+	ObjectTable[Hole] = FObjectTableSlot();
+}
+
+/**
+ * Looks up the unshadowed clone 0 of an object in the object table.
+ * @param Id The id of the object.
+ * @return The object, or nullptr if it is not in the table.
+ */
+UArticyObject* UArticyDatabase::FindInObjectTable(const FArticyId& Id) const
+{
+	if (ObjectTable.Num() == 0)
+		return nullptr;
+
+	const uint32 Mask = ObjectTable.Num() - 1;
+	for (uint32 Index = GetTypeHash(Id) & Mask; ; Index = (Index + 1) & Mask)
+	{
+		const FObjectTableSlot& Slot = ObjectTable[Index];
+		if (!Slot.Object)
+			return nullptr;
+		if (Slot.Id == Id)
+			return Slot.Object;
+	}
+}
+
+/**
+ * Links the references of all loaded objects, their clones and shadow copies to the loaded objects.
+ * The references are linked to the containers of the objects, so later clones and shadow copies of the referenced
+ * objects are resolved without linking again; only new copies of the referencing objects are linked when created.
+ */
+void UArticyDatabase::LinkObjects()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ArticyLinkObjects);
+
+	for (const auto& Pair : LoadedObjectsById)
+	{
+		if (!Pair.Value)
+			continue;
+
+		//the copies are owned by the database, ForEachCopy only hands them out as const
+		Pair.Value->ForEachCopy([this](const UArticyObject* Copy, uint32 ShadowLevel)
+		{
+			const_cast<UArticyObject*>(Copy)->LinkReferences(this);
+		});
+	}
+}
+
+/**
+ * Sets the Expresso scripts class used for script execution.
+ * @param NewClass The new Expresso scripts class to use.
+ */
+void UArticyDatabase::SetExpressoScriptsClass(TSubclassOf<UArticyExpressoScripts> NewClass)
+{
+	ExpressoScriptsClass = NewClass;
+	//the script indices of the flow graph depend on the class
+	FlowGraph.Reset();
+	PendingFlowGraphUpdates.Reset();
+}
+
+namespace
+{
+	/**
+	 * Finds the database asset. Loads the asset the import stored in the plugin settings,
+	 * and only searches the asset registry if there is none, e.g. for imports of older plugin versions.
+	 * @return The database asset, or nullptr if there is none.
+	 */
+	UArticyDatabase* FindDatabaseAsset()
+	{
+		const FSoftObjectPath& AssetPath = UArticyPluginSettings::Get()->DatabaseAssetPath;
+		if (AssetPath.IsValid())
+		{
+			if (UArticyDatabase* Asset = Cast<UArticyDatabase>(AssetPath.TryLoad()))
+				return Asset;
+
+			UE_LOG(LogArticyRuntime, Warning, TEXT("The ArticyDraftDatabase %s was not found, searching the asset registry."), *AssetPath.ToString());
+		}
+
+		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+		TArray<FAssetData> AssetData;
+
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
+		AssetRegistryModule.Get().GetAssetsByClass(UArticyDatabase::StaticClass()->GetClassPathName(), AssetData, true);
+#else
+		AssetRegistryModule.Get().GetAssetsByClass(UArticyDatabase::StaticClass()->GetFName(), AssetData, true);
+#endif
+
+		if (AssetData.Num() == 0)
+		{
+			UE_LOG(LogArticyRuntime, Warning, TEXT("No ArticyDraftDatabase was found."));
+			return nullptr;
+		}
+
+		if (AssetData.Num() > 1)
+		{
+			UE_LOG(LogArticyRuntime, Warning, TEXT("More than one ArticyDraftDatabase was found, this is not supported! The first one will be selected."));
+		}
+
+		return Cast<UArticyDatabase>(AssetData[0].GetAsset());
+	}
+}
+
+/**
+ * Retrieves the original database asset, optionally loading all packages.
+ * @param bLoadAllPackages If true, loads all packages.
+ * @return A pointer to the original UArticyDatabase asset.
+ */
+const UArticyDatabase* UArticyDatabase::GetOriginal(bool bLoadAllPackages)
+{
+	static TWeakObjectPtr<UArticyDatabase> Asset = nullptr;
+
+	if (!Asset.IsValid())
+	{
+		Asset = FindDatabaseAsset();
+
+		if (bLoadAllPackages && Asset.IsValid())
+			Asset.Get()->LoadAllPackages();
+	}
+
+	return Asset.Get();
+}
+
+/**
+ * Retrieves a mutable original instance of the Articy database.
+ * @return A weak pointer to the mutable UArticyDatabase instance.
+ */
+TWeakObjectPtr<UArticyDatabase> UArticyDatabase::GetMutableOriginal()
+{
+	static TWeakObjectPtr<UArticyDatabase> Asset = nullptr;
+
+	if (!Asset.IsValid())
+	{
+		Asset = FindDatabaseAsset();
+	}
+
+	return Asset;
+}
+
+/**
+ * Changes the default package setting for a specific package.
+ * @param PackageName The name of the package.
+ * @param bIsDefaultPackage True to mark as default, false otherwise.
+ */
+void UArticyDatabase::ChangePackageDefault(FName PackageName, bool bIsDefaultPackage)
+{
+	if (FArticyPackageEntry* Entry = ImportedPackageEntries.Find(PackageName.ToString()))
+	{
+		UArticyPackage* Package = GetPackageAsset(PackageName.ToString());
+
+		// additional check; maybe the map entry exists but has no value due to user error or bugs
+		if (!Package)
+		{
+			UE_LOG(LogArticyRuntime, Error, TEXT("Could not change package default setting of package %s: package not found"), *PackageName.ToString());
+			return;
+		}
+
+		// keep the copy of the flag in sync, it is what the database reads
+		if (Entry->bIsDefaultPackage != bIsDefaultPackage)
+		{
+			Entry->bIsDefaultPackage = bIsDefaultPackage;
+			MarkPackageDirty();
+		}
+
+		// if the setting isn't going to change, return early
+		if (Package->bIsDefaultPackage == bIsDefaultPackage)
+		{
+			return;
+		}
+
+		Package->bIsDefaultPackage = bIsDefaultPackage;
+		Package->MarkPackageDirty();
+	}
+}
+
+//---------------------------------------------------------------------------//
+
+/**
+ * Retrieves an Articy object by its ID and clone ID.
+ * @param Id The ID of the object to retrieve.
+ * @param CloneId The clone ID of the object.
+ * @param CastTo The class to cast the object to.
+ * @return A pointer to the Articy object, or nullptr if not found.
+ */
+UArticyObject* UArticyDatabase::GetObject(FArticyId Id, int32 CloneId, TSubclassOf<class UArticyObject> CastTo) const
+{
+	return GetObjectInternal(Id, CloneId);
+}
+
+/**
+ * Retrieves an unshadowed version of an Articy object.
+ * @param Id The ID of the object to retrieve.
+ * @param CloneId The clone ID of the object.
+ * @return A pointer to the unshadowed Articy object, or nullptr if not found.
+ */
+UArticyObject* UArticyDatabase::GetObjectUnshadowed(FArticyId Id, int32 CloneId) const
+{
+	return GetObjectInternal(Id, CloneId, true);
+}
+
+/**
+ * Retrieves an Articy object by its ID and clone ID, with optional unshadowing.
+ * @param Id The ID of the object to retrieve.
+ * @param CloneId The clone ID of the object.
+ * @param bForceUnshadowed If true, retrieves the unshadowed version.
+ * @return A pointer to the Articy object, or nullptr if not found.
+ */
+UArticyObject* UArticyDatabase::GetObjectInternal(FArticyId Id, int32 CloneId, bool bForceUnshadowed) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ArticyGetObject);
+	INC_DWORD_STAT(STAT_ArticyGetObjectCalls);
+
+	//with a package residency budget, the use of the packages is tracked, and evicted packages are loaded again
+	if (bTrackPackageUsage && IsInGameThread())
+		return const_cast<UArticyDatabase*>(this)->GetResidentObject(Id, CloneId, bForceUnshadowed);
+
+	//fast path: the unshadowed original is resolved with a single probe into the flat table
+	if (CloneId == 0 && (bForceUnshadowed || GetShadowLevel() == 0))
+	{
+		if (UArticyObject* Object = FindInObjectTable(Id))
+			return Object;
+	}
+
+	FArticyCloneableObject* const* info = LoadedObjectsById.Find(Id);
+	if (!info && PendingObjectsById.Num() > 0 && IsInGameThread())
+	{
+		//the object belongs to a package that is still loading, load it right away
+		if (const_cast<UArticyDatabase*>(this)->ResolvePendingObject(Id))
+			info = LoadedObjectsById.Find(Id);
+	}
+
+	return info && (*info) ? (*info)->Get(this, CloneId, bForceUnshadowed) : nullptr;
+}
+
+/**
+ * Retrieves an Articy object by its technical name and clone ID.
+ * @param TechnicalName The technical name of the object to retrieve.
+ * @param CloneId The clone ID of the object.
+ * @param CastTo The class to cast the object to.
+ * @return A pointer to the Articy object, or nullptr if not found.
+ */
+UArticyObject* UArticyDatabase::GetObjectByName(FName TechnicalName, int32 CloneId, TSubclassOf<class UArticyObject> CastTo) const
+{
+	auto arr = LoadedObjectsByName.Find(TechnicalName);
+	if (!arr || arr->Objects.Num() <= 0)
+		return nullptr;
+
+	auto info = arr->Objects[0];
+	return info ? Cast<UArticyObject>(info->Get(this, CloneId)) : nullptr;
+}
+
+/**
+ * Retrieves an Articy object from a string representation.
+ * @param StringID_CloneID The string representation of the object's ID and clone ID.
+ * @param CastTo The class to cast the object to.
+ * @return A pointer to the Articy object, or nullptr if not found.
+ */
+UArticyObject* UArticyDatabase::GetObjectFromStringRepresentation(FString StringID_CloneID, TSubclassOf<class UArticyObject> CastTo) const
+{
+	//parsed in place, the id ends at the underscore before the clone id
+	TCHAR* IdEnd = nullptr;
+	const uint64 id = FCString::Strtoui64(*StringID_CloneID, &IdEnd, 10);
+	if (!IdEnd || *IdEnd != TEXT('_'))
+		return nullptr;
+
+	return GetObjectInternal(id, FCString::Atoi(IdEnd + 1));
+}
+
+/**
+ * Retrieves all Articy objects with a given technical name and clone ID.
+ * @param TechnicalName The technical name of the objects to retrieve.
+ * @param CloneId The clone ID of the objects.
+ * @param CastTo The class to cast the objects to.
+ * @return An array of pointers to the Articy objects, or empty if none found.
+ */
+TArray<UArticyObject*> UArticyDatabase::GetObjects(FName TechnicalName, int32 CloneId, TSubclassOf<class UArticyObject> CastTo) const
+{
+	return GetObjects<UArticyObject>(TechnicalName, CloneId);
+}
+
+/**
+ * Retrieves all Articy objects of a specified class with a given clone ID.
+ * @param Type The class type of the objects to retrieve.
+ * @param CloneId The clone ID of the objects.
+ * @return An array of pointers to the Articy objects, or empty if none found.
+ */
+TArray<UArticyObject*> UArticyDatabase::GetObjectsOfClass(TSubclassOf<class UArticyObject> Type, int32 CloneId) const
+{
+	TArray<UArticyObject*> arr;
+
+	for (auto It = CreateObjectOfClassIterator(Type, CloneId, /*bForceUnshadowed = */ true); It; ++It)
+	{
+		if (It->GetCloneId() == CloneId)
+			arr.Add(*It);
+	}
+
+	return arr;
+}
+
+/**
+ * Creates an iterator over all objects of a class (including subclasses), which does not allocate.
+ * @param Class The class of the objects to iterate.
+ * @param CloneId The clone ID of the objects.
+ * @param bForceUnshadowed If true, the unshadowed objects are returned.
+ * @return The iterator.
+ */
+FArticyObjectOfClassIterator UArticyDatabase::CreateObjectOfClassIterator(const UClass* Class, int32 CloneId, bool bForceUnshadowed) const
+{
+	return FArticyObjectOfClassIterator(this, Class, CloneId, bForceUnshadowed);
+}
+
+/**
+ * Retrieves all Articy objects currently loaded in the database.
+ * @return An array of pointers to all Articy objects.
+ */
+TArray<UArticyObject*> UArticyDatabase::GetAllObjects() const
+{
+	TArray<UArticyObject*> arr;
+	arr.Reserve(LoadedObjectsById.Num());
+	for (const auto& Pair : LoadedObjectsById)
+	{
+		auto obj = Pair.Value->Get(this, 0, /*bForceUnshadowed = */ true);
+		arr.Add(obj);
+	}
+	return arr;
+}
+
+/**
+ * Returns a view of the containers of all loaded objects with a given TechnicalName.
+ * @param TechnicalName The technical name of the objects.
+ * @return The containers, or an empty view if there are none.
+ */
+TConstArrayView<FArticyCloneableObject*> UArticyDatabase::GetObjectContainersByName(FName TechnicalName) const
+{
+	const FArticyDatabaseObjectArray* arr = LoadedObjectsByName.Find(TechnicalName);
+	return arr ? TConstArrayView<FArticyCloneableObject*>(arr->Objects) : TConstArrayView<FArticyCloneableObject*>();
+}
+
+//---------------------------------------------------------------------------//
+
+/**
+ * Clones an Articy object by its ID, creating a new instance with the specified clone ID.
+ * @param Id The ID of the object to clone.
+ * @param NewCloneId The clone ID for the new instance.
+ * @param CastTo The class to cast the clone to.
+ * @return A pointer to the newly created clone, or nullptr if creation failed.
+ */
+UArticyObject* UArticyDatabase::CloneFrom(FArticyId Id, int32 NewCloneId, TSubclassOf<class UArticyObject> CastTo)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ArticyCloneFrom);
+
+	auto info = LoadedObjectsById.Find(Id);
+	return info ? (*info)->Clone(this, NewCloneId, true) : nullptr;
+}
+
+/**
+ * Clones an Articy object by its technical name, creating a new instance with the specified clone ID.
+ * @param TechnicalName The technical name of the object to clone.
+ * @param NewCloneId The clone ID for the new instance.
+ * @param CastTo The class to cast the clone to.
+ * @return A pointer to the newly created clone, or nullptr if creation failed.
+ */
+UArticyObject* UArticyDatabase::CloneFromByName(FName TechnicalName, int32 NewCloneId, TSubclassOf<class UArticyObject> CastTo)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ArticyCloneFrom);
+
+	auto arr = LoadedObjectsByName.Find(TechnicalName);
+	if (!arr || arr->Objects.Num() <= 0)
+		return nullptr;
+
+	auto info = arr->Objects[0];
+	return info ? Cast<UArticyObject>(info->Clone(this, NewCloneId, true)) : nullptr;
+}
+
+/**
+ * Clones each of the given objects Count times, using the next free clone ids.
+ * @param Ids The IDs of the objects to clone.
+ * @param Count The number of clones to create per object.
+ * @return The new clones, all clones of Ids[0] first. Unknown ids are skipped.
+ */
+TArray<UArticyObject*> UArticyDatabase::CloneBatch(TConstArrayView<FArticyId> Ids, int32 Count)
+{
+	TArray<UArticyObject*> NewClones;
+	if (Count <= 0)
+		return NewClones;
+
+	NewClones.Reserve(Ids.Num() * Count);
+	for (const FArticyId& Id : Ids)
+	{
+		FArticyCloneableObject* const* info = LoadedObjectsById.Find(Id);
+		if (info && *info)
+			(*info)->CloneBatch(this, Count, NewClones);
+	}
+
+	return NewClones;
+}
+
+//---------------------------------------------------------------------------//
+
+/**
+ * Destroys a clone of an object.
+ * Not possible in a shadow state, as popping the state would still restore the shadow copies of the clone.
+ * @param Id The ID of the object.
+ * @param CloneId The clone ID of the clone to destroy.
+ * @return True if the clone existed and was destroyed.
+ */
+bool UArticyDatabase::DestroyClone(FArticyId Id, int32 CloneId)
+{
+	if (!ensureMsgf(GetShadowLevel() == 0, TEXT("Clones cannot be destroyed in a shadow state.")))
+		return false;
+
+	FArticyCloneableObject* const* info = LoadedObjectsById.Find(Id);
+	return info && *info && (*info)->RemoveClone(CloneId);
+}
+
+/**
+ * Destroys the clones with a clone ID of all loaded objects.
+ * @param CloneId The clone ID of the clones to destroy.
+ * @return The number of destroyed clones.
+ */
+int32 UArticyDatabase::DestroyAllClones(int32 CloneId)
+{
+	if (!ensureMsgf(GetShadowLevel() == 0, TEXT("Clones cannot be destroyed in a shadow state.")) || CloneId <= 0)
+		return 0;
+
+	int32 NumDestroyed = 0;
+	for (const auto& Pair : LoadedObjectsById)
+	{
+		if (Pair.Value && Pair.Value->RemoveClone(CloneId))
+			++NumDestroyed;
+	}
+
+	return NumDestroyed;
+}
+
+/**
+ * Releases the memory of the clone slots which are not used anymore, for all loaded objects.
+ */
+void UArticyDatabase::CompactClones()
+{
+	for (const auto& Pair : LoadedObjectsById)
+	{
+		if (Pair.Value)
+			Pair.Value->Compact();
+	}
+}
+
+namespace
+{
+	/** The first bytes of an object changes snapshot. */
+	constexpr uint32 ObjectChangesMagic = 0x43434F41; // "AOCC"
+
+	/** Increment when the layout of the snapshot changes, LoadObjectChanges rejects newer versions. */
+	constexpr int32 ObjectChangesVersion = 1;
+
+	/** The paths (Property or Feature.Property) and types of the saved properties, referenced by index. */
+	struct FObjectChangesTable
+	{
+		TArray<FString> Paths;
+		TArray<FString> Types;
+		TMap<FString, int32> Indices;
+
+		int32 FindOrAdd(const FString& Path, const FProperty* Property)
+		{
+			if (const int32* Index = Indices.Find(Path))
+				return *Index;
+
+			Paths.Add(Path);
+			Types.Add(Property->GetCPPType());
+			return Indices.Add(Path, Paths.Num() - 1);
+		}
+	};
+
+	/** The serialized value of a changed property. */
+	struct FObjectChangesValue
+	{
+		uint32 PathIndex = 0;
+		TArray<uint8> Bytes;
+	};
+
+	/** The changed properties of one clone of an object. */
+	struct FObjectChangesRecord
+	{
+		FArticyId Id;
+		uint32 CloneId = 0;
+		TArray<FObjectChangesValue> Values;
+	};
+
+	/**
+	 * Returns true if a property is saved. The identity of a clone is not, nor are the containers of subobjects
+	 * (like the pins), which never match between the copies of an object.
+	 */
+	bool IsSavedProperty(const FProperty* Property)
+	{
+		if (Property->HasAnyPropertyFlags(CPF_Transient | CPF_DuplicateTransient) || Property->GetOwnerClass() == UArticyPrimitive::StaticClass())
+			return false;
+
+		if (const FArrayProperty* Array = CastField<FArrayProperty>(Property))
+			return !Array->Inner->IsA<FObjectPropertyBase>();
+		if (const FSetProperty* Set = CastField<FSetProperty>(Property))
+			return !Set->ElementProp->IsA<FObjectPropertyBase>();
+		if (const FMapProperty* Map = CastField<FMapProperty>(Property))
+			return !Map->KeyProp->IsA<FObjectPropertyBase>() && !Map->ValueProp->IsA<FObjectPropertyBase>();
+
+		return true;
+	}
+
+	/** Serializes all elements of a property, object references and names as strings. */
+	void SerializePropertyValue(FArchive& Ar, const FProperty* Property, UObject* Container)
+	{
+		FObjectAndNameAsStringProxyArchive Proxy(Ar, false);
+		FStructuredArchiveFromArchive Structured(Proxy);
+		FStructuredArchive::FStream Stream = Structured.GetSlot().EnterStream();
+		for (int32 Index = 0; Index < Property->ArrayDim; ++Index)
+			Property->SerializeItem(Stream.EnterElement(), Property->ContainerPtrToValuePtr<void>(Container, Index), nullptr);
+
+		if (Proxy.IsError())
+			Ar.SetError();
+	}
+
+	/**
+	 * Adds the properties of an object which differ from its package asset to OutValues.
+	 * Features are subobjects, so the properties of the feature are compared instead of the feature itself.
+	 */
+	void CollectChangedProperties(const UObject* Object, const UObject* Original, const FString& Prefix, FObjectChangesTable& Table, TArray<FObjectChangesValue>& OutValues)
+	{
+		for (TFieldIterator<FProperty> It(Object->GetClass()); It; ++It)
+		{
+			const FProperty* Property = *It;
+			if (!IsSavedProperty(Property))
+				continue;
+
+			if (const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property))
+			{
+				//features shared with clones are outered to the object they were cloned from
+				const UObject* Subobject = ObjectProperty->GetObjectPropertyValue_InContainer(Object);
+				if (Subobject && (Subobject->GetOuter() == Object || Subobject->IsA<UArticyBaseFeature>()))
+				{
+					const UObject* OriginalSubobject = ObjectProperty->GetObjectPropertyValue_InContainer(Original);
+					if (OriginalSubobject && OriginalSubobject->GetClass() == Subobject->GetClass())
+						CollectChangedProperties(Subobject, OriginalSubobject, Prefix + Property->GetName() + TEXT("."), Table, OutValues);
+					continue;
+				}
+			}
+
+			bool bIdentical = true;
+			for (int32 Index = 0; Index < Property->ArrayDim && bIdentical; ++Index)
+				bIdentical = Property->Identical_InContainer(Object, Original, Index);
+			if (bIdentical)
+				continue;
+
+			FObjectChangesValue& Value = OutValues.AddDefaulted_GetRef();
+			Value.PathIndex = Table.FindOrAdd(Prefix + Property->GetName(), Property);
+			FMemoryWriter Writer(Value.Bytes);
+			SerializePropertyValue(Writer, Property, const_cast<UObject*>(Object));
+		}
+	}
+
+	/**
+	 * Sets a saved property of an object, through the features for Feature.Property paths.
+	 * Features shared with clones are copied first, see UArticyBaseObject::GetFeatureForWrite.
+	 * The property is marked as modified, unless it is set back to the value of the package asset.
+	 * @return false if the property does not exist anymore or has another type.
+	 */
+	bool ApplyPropertyValue(UObject* Object, const FString& Path, const FString& Type, const TArray<uint8>& Bytes, bool bMarkModified = true)
+	{
+		TArray<FString> Names;
+		Path.ParseIntoArray(Names, TEXT("."));
+		if (Names.Num() == 0)
+			return false;
+
+		UObject* Container = Object;
+		for (int32 Index = 0; Index < Names.Num() - 1; ++Index)
+		{
+			const FObjectPropertyBase* ObjectProperty = FindFProperty<FObjectPropertyBase>(Container->GetClass(), *Names[Index]);
+			UArticyBaseObject* ArticyContainer = Cast<UArticyBaseObject>(Container);
+			UObject* Subobject = ArticyContainer ? ArticyContainer->GetFeatureForWrite(ObjectProperty) : nullptr;
+			if (!Subobject && ObjectProperty)
+			{
+				Subobject = ObjectProperty->GetObjectPropertyValue_InContainer(Container);
+				if (Subobject && Subobject->GetOuter() != Container)
+					Subobject = nullptr;
+			}
+
+			if (!Subobject)
+				return false;
+
+			Container = Subobject;
+		}
+
+		const FProperty* Property = FindFProperty<FProperty>(Container->GetClass(), *Names.Last());
+		if (!Property || !IsSavedProperty(Property) || Property->GetCPPType() != Type)
+			return false;
+
+		FMemoryReader Reader(Bytes);
+		SerializePropertyValue(Reader, Property, Container);
+		if (Reader.IsError())
+			return false;
+
+		UArticyBaseObject* ArticyContainer = Cast<UArticyBaseObject>(Container);
+		if (ArticyContainer && bMarkModified)
+			ArticyContainer->MarkModified(Property, INDEX_NONE);
+		return true;
+	}
+}
+
+/**
+ * Writes the state of the loaded objects which differs from their package assets into a binary snapshot.
+ *
+ * The snapshot starts with a header holding the version, followed by the paths and types of all saved properties.
+ * Then there is one record per changed object and per clone, holding the id, the clone id and the changed values,
+ * each of them with the index of its property and its size, so LoadObjectChanges can skip values it cannot apply.
+ * Clone 0 is compared with the package asset of the object, and so are the other clones, as they are created from it.
+ *
+ * @param OutSnapshot The array to write the snapshot to, its previous content is replaced.
+ * @return false if the snapshot could not be written, because a shadow state is active.
+ */
+bool UArticyDatabase::SaveObjectChanges(TArray<uint8>& OutSnapshot) const
+{
+	OutSnapshot.Reset();
+	if (!ensureMsgf(GetShadowLevel() == 0, TEXT("Objects cannot be saved while a shadow state is active.")))
+		return false;
+
+	//the package asset of each loaded object, the state the changes are relative to
+	TMap<FArticyId, const UArticyObject*> Originals;
+	Originals.Reserve(LoadedObjectsById.Num());
+	for (const TPair<FString, UArticyPackage*>& Resident : ResidentPackages)
+	{
+		if (!Resident.Value)
+			continue;
+
+		for (const UArticyObject* Asset : Resident.Value->GetAssets())
+		{
+			if (Asset && !Originals.Contains(Asset->GetId()))
+				Originals.Add(Asset->GetId(), Asset);
+		}
+	}
+
+	FObjectChangesTable Table;
+	TArray<FObjectChangesRecord> Records;
+	for (const TPair<FArticyId, FArticyCloneableObject*>& Loaded : LoadedObjectsById)
+	{
+		const UArticyObject* const* Original = Originals.Find(Loaded.Key);
+		if (!Loaded.Value || !Original)
+			continue;
+
+		const TArray<FArticyShadowableObject>& Clones = Loaded.Value->Clones;
+		for (int32 CloneId = 0; CloneId < Clones.Num(); ++CloneId)
+		{
+			const UArticyObject* Object = Clones[CloneId].IsValid() ? Clones[CloneId].Get(this, true) : nullptr;
+
+			//a clone 0 shared with its package asset is unchanged
+			if (!Object || Object == *Original)
+				continue;
+
+			FObjectChangesRecord Record;
+			Record.Id = Loaded.Key;
+			Record.CloneId = CloneId;
+			CollectChangedProperties(Object, *Original, FString(), Table, Record.Values);
+
+			//the other clones are saved even if unchanged, so they exist again after loading
+			if (Record.Values.Num() > 0 || CloneId > 0)
+				Records.Add(MoveTemp(Record));
+		}
+	}
+
+	FMemoryWriter Writer(OutSnapshot);
+
+	uint32 Magic = ObjectChangesMagic;
+	int32 Version = ObjectChangesVersion;
+	int32 NumPaths = Table.Paths.Num();
+	Writer << Magic << Version << NumPaths;
+	for (int32 Index = 0; Index < NumPaths; ++Index)
+		Writer << Table.Paths[Index] << Table.Types[Index];
+
+	int32 NumRecords = Records.Num();
+	Writer << NumRecords;
+	for (FObjectChangesRecord& Record : Records)
+	{
+		uint32 NumValues = Record.Values.Num();
+		Writer << Record.Id.Low << Record.Id.High;
+		Writer.SerializeIntPacked(Record.CloneId);
+		Writer.SerializeIntPacked(NumValues);
+		for (FObjectChangesValue& Value : Record.Values)
+		{
+			uint32 NumBytes = Value.Bytes.Num();
+			Writer.SerializeIntPacked(Value.PathIndex);
+			Writer.SerializeIntPacked(NumBytes);
+			Writer.Serialize(Value.Bytes.GetData(), NumBytes);
+		}
+	}
+
+	return !Writer.IsError();
+}
+
+/**
+ * Applies the object changes of a snapshot written by SaveObjectChanges.
+ *
+ * The whole snapshot is read before anything is changed. The clones are created before the changes of clone 0 are
+ * applied, as they are copies of clone 0. The objects are written through GetWritableObject, so they stop sharing
+ * their package assets and the property indices are updated, and the references are linked once at the end.
+ *
+ * @param Snapshot The snapshot written by SaveObjectChanges.
+ * @return false if the snapshot is invalid or a shadow state is active, in which case nothing is changed.
+ */
+bool UArticyDatabase::LoadObjectChanges(const TArray<uint8>& Snapshot)
+{
+	if (!ensureMsgf(GetShadowLevel() == 0, TEXT("Objects cannot be loaded while a shadow state is active.")))
+		return false;
+
+	FMemoryReader Reader(Snapshot);
+
+	uint32 Magic = 0;
+	int32 Version = 0, NumPaths = 0;
+	Reader << Magic << Version << NumPaths;
+
+	if (Reader.IsError() || Magic != ObjectChangesMagic || Version < 1 || Version > ObjectChangesVersion
+		|| NumPaths < 0 || NumPaths > Reader.TotalSize() - Reader.Tell())
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Unable to load object changes: invalid snapshot (version %d)."), Version);
+		return false;
+	}
+
+	TArray<FString> Paths, Types;
+	Paths.SetNum(NumPaths);
+	Types.SetNum(NumPaths);
+	for (int32 Index = 0; Index < NumPaths; ++Index)
+		Reader << Paths[Index] << Types[Index];
+
+	int32 NumRecords = 0;
+	Reader << NumRecords;
+	TArray<FObjectChangesRecord> Records;
+	if (NumRecords >= 0 && NumRecords <= Reader.TotalSize() - Reader.Tell())
+		Records.SetNum(NumRecords);
+	else
+		Reader.SetError();
+
+	for (FObjectChangesRecord& Record : Records)
+	{
+		uint32 NumValues = 0;
+		Reader << Record.Id.Low << Record.Id.High;
+		Reader.SerializeIntPacked(Record.CloneId);
+		Reader.SerializeIntPacked(NumValues);
+		if (Reader.IsError() || NumValues > static_cast<uint64>(Reader.TotalSize() - Reader.Tell()))
+		{
+			Reader.SetError();
+			break;
+		}
+
+		Record.Values.SetNum(NumValues);
+		for (FObjectChangesValue& Value : Record.Values)
+		{
+			uint32 NumBytes = 0;
+			Reader.SerializeIntPacked(Value.PathIndex);
+			Reader.SerializeIntPacked(NumBytes);
+			if (Reader.IsError() || Value.PathIndex >= static_cast<uint32>(NumPaths) || NumBytes > static_cast<uint64>(Reader.TotalSize() - Reader.Tell()))
+			{
+				Reader.SetError();
+				break;
+			}
+
+			Value.Bytes.SetNumUninitialized(NumBytes);
+			Reader.Serialize(Value.Bytes.GetData(), NumBytes);
+		}
+	}
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Unable to load object changes: the snapshot is truncated."));
+		return false;
+	}
+
+	int32 NumApplied = 0, NumSkipped = 0;
+	for (const bool bClones : { true, false })
+	{
+		for (const FObjectChangesRecord& Record : Records)
+		{
+			if ((Record.CloneId > 0) != bClones)
+				continue;
+
+			FArticyCloneableObject* Container = LoadedObjectsById.FindRef(Record.Id);
+			UArticyObject* Object = nullptr;
+			if (Container)
+				Object = Record.CloneId == 0 ? Container->Get(this, 0, true) : Container->Clone(this, Record.CloneId, false);
+
+			if (!Object)
+			{
+				NumSkipped += FMath::Max(Record.Values.Num(), 1);
+				continue;
+			}
+
+			if (Record.Values.Num() == 0)
+				continue;
+
+			Object = GetWritableObject(Object);
+			for (const FObjectChangesValue& Value : Record.Values)
+			{
+				if (ApplyPropertyValue(Object, Paths[Value.PathIndex], Types[Value.PathIndex], Value.Bytes))
+					++NumApplied;
+				else
+					++NumSkipped;
+			}
+		}
+	}
+
+	if (NumSkipped > 0)
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("The objects changed since the object changes were saved, or are not loaded (%d changes skipped)."), NumSkipped);
+	}
+
+	//changed references are resolved again
+	if (NumApplied > 0)
+		LinkObjects();
+
+	++ObjectStateVersion;
+	return true;
+}
+
+/**
+ * Discards the records and the paths of the log.
+ */
+void FArticyObjectUndoLog::Reset()
+{
+	Paths.Reset();
+	Types.Reset();
+	PathIndices.Reset();
+	Records.Reset();
+	Recorded.Reset();
+}
+
+/**
+ * Returns the memory held by the log.
+ * @return The size of the arrays and of the recorded values, in bytes.
+ */
+SIZE_T FArticyObjectUndoLog::GetAllocatedSize() const
+{
+	SIZE_T Size = Paths.GetAllocatedSize() + Types.GetAllocatedSize() + PathIndices.GetAllocatedSize()
+		+ Records.GetAllocatedSize() + Recorded.GetAllocatedSize();
+	for (int32 Index = 0; Index < Paths.Num(); ++Index)
+		Size += Paths[Index].GetAllocatedSize() + Types[Index].GetAllocatedSize();
+	for (const FRecord& Record : Records)
+	{
+		Size += Record.Values.GetAllocatedSize();
+		for (const TPair<int32, TArray<uint8>>& Value : Record.Values)
+			Size += Value.Value.GetAllocatedSize();
+	}
+
+	return Size;
+}
+
+/**
+ * Starts recording the state of the objects into a log before they are changed.
+ * @param Log The log to record into, it must stay valid until it is removed.
+ */
+void UArticyDatabase::AddObjectUndoLog(FArticyObjectUndoLog* Log)
+{
+	if (ensure(Log))
+		ObjectUndoLogs.AddUnique(Log);
+}
+
+/**
+ * Stops recording into a log.
+ * @param Log The log added with AddObjectUndoLog.
+ */
+void UArticyDatabase::RemoveObjectUndoLog(FArticyObjectUndoLog* Log)
+{
+	ObjectUndoLogs.Remove(Log);
+}
+
+/**
+ * Records the state of a clone in each undo log which did not record it yet.
+ * The properties which differ from the package asset are collected once and copied into each log.
+ * @param Object The clone which is about to be written or destroyed, or which was just created.
+ * @param bCreated Whether the clone was just created, its values are not needed then.
+ */
+void UArticyDatabase::RecordObjectUndo(const UArticyObject* Object, bool bCreated) const
+{
+	if (!Object || GetShadowLevel() > 0)
+		return;
+
+	const TPair<FArticyId, int32> Key(Object->GetId(), Object->GetCloneId());
+
+	FObjectChangesTable Table;
+	TArray<FObjectChangesValue> Values;
+	bool bCollected = bCreated;
+
+	for (FArticyObjectUndoLog* Log : ObjectUndoLogs)
+	{
+		bool bAlreadyRecorded = false;
+		Log->Recorded.Add(Key, &bAlreadyRecorded);
+		if (bAlreadyRecorded)
+			continue;
+
+		FArticyObjectUndoLog::FRecord& Record = Log->Records.AddDefaulted_GetRef();
+		Record.Id = Key.Key;
+		Record.CloneId = Key.Value;
+		Record.bExisted = !bCreated;
+
+		//a clone 0 shared with its package asset is unchanged
+		if (!bCollected)
+		{
+			bCollected = true;
+			const UArticyObject* Asset = FindPackageAsset(Key.Key);
+			if (Asset && Asset != Object)
+				CollectChangedProperties(Object, Asset, FString(), Table, Values);
+		}
+
+		Record.Values.Reserve(Values.Num());
+		for (const FObjectChangesValue& Value : Values)
+		{
+			const FString& Path = Table.Paths[Value.PathIndex];
+			int32 PathIndex;
+			if (const int32* Existing = Log->PathIndices.Find(Path))
+			{
+				PathIndex = *Existing;
+			}
+			else
+			{
+				PathIndex = Log->Paths.Add(Path);
+				Log->Types.Add(Table.Types[Value.PathIndex]);
+				Log->PathIndices.Add(Path, PathIndex);
+			}
+
+			Record.Values.Emplace(PathIndex, Value.Bytes);
+		}
+	}
+}
+
+/**
+ * Returns the package asset of an object.
+ * @param Id The id of the object.
+ * @return The asset from the first resident package that contains it, or nullptr.
+ */
+const UArticyObject* UArticyDatabase::FindPackageAsset(const FArticyId& Id) const
+{
+	for (const TPair<FString, UArticyPackage*>& Resident : ResidentPackages)
+	{
+		if (Resident.Value)
+		{
+			if (const UArticyObject* Asset = Resident.Value->GetAssetById(Id))
+				return Asset;
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+ * Reverts the objects recorded in a log.
+ * Each recorded clone is first reset to its package asset, by setting the properties which differ from it, and then
+ * gets the values it had when it was recorded. Clones destroyed since are created again, clones created since are
+ * destroyed. The references are linked once at the end.
+ * @param Log The log to apply.
+ * @return false if a shadow state is active.
+ */
+bool UArticyDatabase::ApplyObjectUndoLog(const FArticyObjectUndoLog& Log)
+{
+	if (!ensureMsgf(GetShadowLevel() == 0, TEXT("Objects cannot be reverted while a shadow state is active.")))
+		return false;
+
+	bool bChanged = false;
+	for (const FArticyObjectUndoLog::FRecord& Record : Log.Records)
+	{
+		FArticyCloneableObject* Container = LoadedObjectsById.FindRef(Record.Id);
+		if (!Container)
+			continue;
+
+		if (!Record.bExisted)
+		{
+			bChanged |= Container->RemoveClone(Record.CloneId);
+			continue;
+		}
+
+		const UArticyObject* Asset = FindPackageAsset(Record.Id);
+		UArticyObject* Object = Record.CloneId == 0 ? Container->Get(this, 0, true) : Container->Clone(this, Record.CloneId, false);
+		if (!Asset || !Object || (Object == Asset && Record.Values.Num() == 0))
+			continue;
+
+		Object = GetWritableObject(Object);
+
+		FObjectChangesTable Table;
+		TArray<FObjectChangesValue> AssetValues;
+		CollectChangedProperties(Asset, Object, FString(), Table, AssetValues);
+		for (const FObjectChangesValue& Value : AssetValues)
+			ApplyPropertyValue(Object, Table.Paths[Value.PathIndex], Table.Types[Value.PathIndex], Value.Bytes, false);
+		Object->ClearModified();
+
+		for (const TPair<int32, TArray<uint8>>& Value : Record.Values)
+			ApplyPropertyValue(Object, Log.Paths[Value.Key], Log.Types[Value.Key], Value.Value);
+
+		bChanged = true;
+	}
+
+	//changed references are resolved again
+	if (bChanged)
+	{
+		LinkObjects();
+		++ObjectStateVersion;
+	}
+
+	return true;
+}
+
+/**
+ * Retrieves or clones an Articy object by its ID and clone ID.
+ * @param Id The ID of the object to retrieve or clone.
+ * @param NewCloneId The clone ID for the new instance.
+ * @return A pointer to the retrieved or newly created clone, or nullptr if not found.
+ */
+UArticyObject* UArticyDatabase::GetOrClone(FArticyId Id, int32 NewCloneId)
+{
+	auto info = LoadedObjectsById.Find(Id);
+	return info ? (*info)->Clone(this, NewCloneId, false) : nullptr;
+}
+
+/**
+ * Retrieves or clones an Articy object by its technical name and clone ID.
+ * @param TechnicalName The technical name of the object to retrieve or clone.
+ * @param NewCloneId The clone ID for the new instance.
+ * @return A pointer to the retrieved or newly created clone, or nullptr if not found.
+ */
+UArticyObject* UArticyDatabase::GetOrCloneByName(const FName& TechnicalName, int32 NewCloneId)
+{
+	auto arr = LoadedObjectsByName.Find(TechnicalName);
 	if (!arr || arr->Objects.Num() <= 0)
 		return nullptr;
 
-	auto info = arr->Objects[0];
-	return info ? Cast<UArticyObject>(info->Clone(this, NewCloneId, true)) : nullptr;
+	auto info = arr->Objects[0];
+	return info ? Cast<UArticyObject>(info->Clone(this, NewCloneId, false)) : nullptr;
+}
+
+/**
+ * Retrieves the Expresso scripts instance for script execution.
+ * @return A pointer to the UArticyExpressoScripts instance.
+ */
+UArticyExpressoScripts* UArticyDatabase::GetExpressoInstance() const
+{
+	if (!CachedExpressoScripts)
+	{
+		if (ensure(ExpressoScriptsClass))
+		{
+			CachedExpressoScripts = NewObject<UArticyExpressoScripts>(const_cast<UArticyDatabase*>(this), ExpressoScriptsClass);
+			CachedExpressoScripts->Init(const_cast<UArticyDatabase*>(this));
+		}
+	}
+
+	return CachedExpressoScripts;
+}
+
+/**
+ * Retrieves an additional Expresso scripts instance for a parallel exploration, creating it on first use.
+ * @param Index The index of the parallel exploration.
+ * @return A pointer to the UArticyExpressoScripts instance.
+ */
+UArticyExpressoScripts* UArticyDatabase::GetParallelExpressoInstance(int32 Index) const
+{
+	check(IsInGameThread());
+
+	if (ParallelExpressoScripts.Num() <= Index)
+		ParallelExpressoScripts.SetNumZeroed(Index + 1);
+
+	UArticyExpressoScripts*& Instance = ParallelExpressoScripts[Index];
+	if (!Instance || Instance->GetClass() != ExpressoScriptsClass)
+	{
+		Instance = nullptr;
+		if (ensure(ExpressoScriptsClass))
+		{
+			Instance = NewObject<UArticyExpressoScripts>(const_cast<UArticyDatabase*>(this), ExpressoScriptsClass);
+			Instance->Init(const_cast<UArticyDatabase*>(this));
+		}
+	}
+
+	//calls without a methods provider fall back to the same default as the main instance
+	if (Instance)
+		Instance->SetDefaultUserMethodsProvider(GetExpressoInstance()->GetDefaultUserMethodsProvider());
+
+	return Instance;
+}
+
+/**
+ * Evaluates many conditions with a single setup of the script context, optionally split across workers.
+ * @param Providers The conditions to evaluate.
+ * @param GV The global variables, nullptr for the current ones.
+ * @param MethodProvider The methods provider, nullptr for the default one.
+ * @param OutResults Receives the result of each condition.
+ * @param WorkerGVs The global variables of each worker, empty to evaluate on the game thread.
+ */
+void UArticyDatabase::EvaluateConditions(TConstArrayView<IArticyConditionProvider*> Providers, UArticyGlobalVariables* GV,
+	UObject* MethodProvider, TArray<bool>& OutResults, TConstArrayView<UArticyGlobalVariables*> WorkerGVs) const
+{
+	check(IsInGameThread());
+
+	OutResults.SetNumUninitialized(Providers.Num());
+	if (Providers.Num() == 0)
+		return;
+
+	if (!GV)
+		GV = GetGVs();
+
+	//the scripts of the conditions, and the index of the result of each
+	TArray<int32> Hashes;
+	TArray<int32> Slots;
+	Hashes.Reserve(Providers.Num());
+	Slots.Reserve(Providers.Num());
+	for (int32 i = 0; i < Providers.Num(); ++i)
+	{
+		IArticyConditionProvider* Provider = Providers[i];
+		int Hash = 0;
+		if (!Provider)
+		{
+			OutResults[i] = true;
+		}
+		else if (Provider->GetConditionScript(Hash))
+		{
+			Hashes.Add(Hash);
+			Slots.Add(i);
+		}
+		else
+		{
+			OutResults[i] = Provider->Evaluate(GV, MethodProvider);
+		}
+	}
+
+	if (Hashes.Num() == 0)
+		return;
+
+	TArray<bool> Results;
+	Results.SetNumZeroed(Hashes.Num());
+
+	//a worker is only worth its setup for a few dozen conditions
+	constexpr int32 MinConditionsPerWorker = 32;
+	const int32 NumWorkers = FMath::Min(WorkerGVs.Num(), Hashes.Num() / MinConditionsPerWorker);
+	if (NumWorkers <= 1)
+	{
+		GetExpressoInstance()->EvaluateMany(Hashes, GV, MethodProvider, Results);
+	}
+	else
+	{
+		//the instances are created on the game thread, see GetParallelExpressoInstance
+		TArray<UArticyExpressoScripts*> Instances;
+		Instances.SetNumUninitialized(NumWorkers);
+		for (int32 w = 0; w < NumWorkers; ++w)
+			Instances[w] = GetParallelExpressoInstance(w);
+
+		const int32 ChunkSize = FMath::DivideAndRoundUp(Hashes.Num(), NumWorkers);
+		ParallelFor(NumWorkers, [&](int32 w)
+		{
+			const int32 Start = w * ChunkSize;
+			const int32 Count = FMath::Min(ChunkSize, Hashes.Num() - Start);
+			if (Count > 0 && Instances[w])
+			{
+				Instances[w]->EvaluateMany(TConstArrayView<int32>(Hashes).Slice(Start, Count), WorkerGVs[w], MethodProvider,
+					TArrayView<bool>(Results).Slice(Start, Count));
+			}
+		});
+	}
+
+	for (int32 i = 0; i < Slots.Num(); ++i)
+		OutResults[Slots[i]] = Results[i];
+}
+
+/**
+ * Returns the object that writes to Object should go to, copying shared package assets.
+ * @param Object The object that is about to be modified.
+ * @return The object to modify, or nullptr off the game thread, where objects must not be modified.
+ */
+UArticyObject* UArticyDatabase::GetWritableObject(UArticyObject* Object)
+{
+	if (!Object)
+		return Object;
+
+	//explorations running in parallel (see UArticyFlowPlayer::UpdateAvailableBranchesInParallel) only read objects,
+	//the write is dropped rather than racing the shadow copies and tables of the database
+	if (!ensureMsgf(IsInGameThread(), TEXT("Articy objects can only be modified on the game thread, scripts run by a parallel exploration must not modify objects.")))
+		return nullptr;
+
+	UArticyDatabase* Database = nullptr;
+
+	//shared package assets are copied first
+	if (SharedObjectOwners.Num() > 0)
+	{
+		if (const TWeakObjectPtr<UArticyDatabase>* Owner = SharedObjectOwners.Find(Object))
+		{
+			if (Owner->IsValid())
+			{
+				Database = Owner->Get();
+				Object = Database->MaterializeSharedObject(Object);
+			}
+			else
+			{
+				SharedObjectOwners.Remove(Object);
+			}
+		}
+	}
+
+	if (!Database)
+		Database = Object->GetTypedOuter<UArticyDatabase>();
+
+	if (Database)
+		Database->MarkForPropertyIndices(Object->GetId());
+
+	//in a shadow state, the write goes to a shadow copy of the current level
+	if (!Database || Database->GetShadowLevel() == 0)
+	{
+		if (Database && Database->bTrackModifiedObjects && Object->GetCloneId() == 0)
+			Database->ModifiedObjectIds.Add(Object->GetId());
+
+		if (Database && Database->ObjectUndoLogs.Num() > 0)
+			Database->RecordObjectUndo(Object, false);
+
+		++ObjectStateVersion;
+		return Object;
+	}
+
+	return Database->GetShadowForWrite(Object);
 }
 
-//---------------------------------------------------------------------------//
+/**
+ * Registers a secondary index on a property of the objects of a class, or returns the one registered already.
+ * The index is built from the loaded objects right away.
+ * @param Class The class of the indexed objects.
+ * @param Property The indexed property, its name or Feature.Property.
+ * @param Kind Whether equal values are looked up by hash or by binary search.
+ * @return The index, or nullptr if the class has no such property.
+ */
+const FArticyPropertyIndex* UArticyDatabase::RegisterPropertyIndex(TSubclassOf<UArticyObject> Class, const FString& Property, EArticyPropertyIndexKind Kind)
+{
+	if (const FArticyPropertyIndex* Existing = GetPropertyIndex(Class, Property))
+	{
+		ensureMsgf(Existing->GetKind() == Kind, TEXT("The property index on %s is registered with another kind already."), *Property);
+		return Existing;
+	}
+
+	FString Feature;
+	FString Name = Property;
+	Property.Split(TEXT("."), &Feature, &Name);
+	if (!Class || !IArticyReflectable::HasProperty(Class, FName(Feature.IsEmpty() ? *Name : *Feature)))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Cannot index %s: class %s has no such property."), *Property, Class ? *Class->GetName() : TEXT("None"));
+		return nullptr;
+	}
+
+	TSharedPtr<FArticyPropertyIndex> Index = MakeShared<FArticyPropertyIndex>(Class.Get(), Property, Kind);
+	Index->Rebuild(this);
+	PropertyIndices.Add(Index);
+
+	return Index.Get();
+}
 
 /**
- * Retrieves or clones an Articy object by its ID and clone ID.
- * @param Id The ID of the object to retrieve or clone.
- * @param NewCloneId The clone ID for the new instance.
- * @return A pointer to the retrieved or newly created clone, or nullptr if not found.
+ * Returns a registered property index, after updating all indices with the objects changed since the last update.
+ * @param Class The class of the indexed objects.
+ * @param Property The indexed property.
+ * @return The index, or nullptr if it is not registered.
  */
-UArticyObject* UArticyDatabase::GetOrClone(FArticyId Id, int32 NewCloneId)
+const FArticyPropertyIndex* UArticyDatabase::GetPropertyIndex(TSubclassOf<UArticyObject> Class, const FString& Property) const
 {
-	auto info = LoadedObjectsById.Find(Id);
-	return info ? (*info)->Clone(this, NewCloneId, false) : nullptr;
+	for (const TSharedPtr<FArticyPropertyIndex>& Index : PropertyIndices)
+	{
+		if (Index->GetClass() == Class.Get() && Index->GetPropertyPath() == Property)
+		{
+			UpdatePropertyIndices();
+			return Index.Get();
+		}
+	}
+
+	return nullptr;
 }
 
 /**
- * Retrieves or clones an Articy object by its technical name and clone ID.
- * @param TechnicalName The technical name of the object to retrieve or clone.
- * @param NewCloneId The clone ID for the new instance.
- * @return A pointer to the retrieved or newly created clone, or nullptr if not found.
+ * Removes a registered property index.
+ * @param Class The class of the indexed objects.
+ * @param Property The indexed property.
  */
-UArticyObject* UArticyDatabase::GetOrCloneByName(const FName& TechnicalName, int32 NewCloneId)
+void UArticyDatabase::UnregisterPropertyIndex(TSubclassOf<UArticyObject> Class, const FString& Property)
 {
-	auto arr = LoadedObjectsByName.Find(TechnicalName);
-	if (!arr || arr->Objects.Num() <= 0)
+	PropertyIndices.RemoveAll([&](const TSharedPtr<FArticyPropertyIndex>& Index)
+	{
+		return Index->GetClass() == Class.Get() && Index->GetPropertyPath() == Property;
+	});
+
+	if (PropertyIndices.Num() == 0)
+		PendingIndexUpdates.Reset();
+}
+
+/**
+ * Reports that an object was modified, so the property indices of its database read it again.
+ * @param Object The modified object.
+ */
+void UArticyDatabase::ReportObjectChanged(const UArticyObject* Object)
+{
+	if (!Object)
+		return;
+
+	UArticyDatabase* Database = Object->GetTypedOuter<UArticyDatabase>();
+	if (!Database)
+	{
+		//shared package assets are not owned by the database
+		const TWeakObjectPtr<UArticyDatabase>* Owner = SharedObjectOwners.Find(Object);
+		Database = Owner ? Owner->Get() : nullptr;
+	}
+
+	if (Database)
+		Database->MarkForPropertyIndices(Object->GetId());
+}
+
+/**
+ * Updates the property indices with the objects changed since the last update.
+ * Each changed object is moved to its new position, unless so many changed (e.g. after loading a package)
+ * that rebuilding the indices is cheaper.
+ */
+void UArticyDatabase::UpdatePropertyIndices() const
+{
+	if (PendingIndexUpdates.Num() == 0)
+		return;
+
+	check(IsInGameThread());
+
+	for (const TSharedPtr<FArticyPropertyIndex>& Index : PropertyIndices)
+	{
+		if (PendingIndexUpdates.Num() > FMath::Max(16, Index->Num() / 8))
+		{
+			Index->Rebuild(this);
+			continue;
+		}
+
+		bool bChanged = false;
+		for (const FArticyId& Id : PendingIndexUpdates)
+			bChanged |= Index->Update(Id, FindInObjectTable(Id));
+
+		if (bChanged)
+			Index->RebuildBuckets();
+	}
+
+	PendingIndexUpdates.Reset();
+}
+
+/**
+ * Returns the spatial index of a location, building it on first use or if the object table changed since.
+ * @param LocationId The id of the location.
+ * @return The index, or nullptr if the location is not loaded.
+ */
+const FArticyLocationIndex* UArticyDatabase::GetLocationIndex(const FArticyId& LocationId) const
+{
+	check(IsInGameThread());
+
+	if (LocationIndicesVersion != ObjectTableVersion)
+	{
+		LocationIndices.Reset();
+		LocationIndicesVersion = ObjectTableVersion;
+	}
+
+	if (const TSharedPtr<const FArticyLocationIndex>* Existing = LocationIndices.Find(LocationId))
+		return Existing->Get();
+
+	if (!FindInObjectTable(LocationId))
 		return nullptr;
 
-	auto info = arr->Objects[0];
-	return info ? Cast<UArticyObject>(info->Clone(this, NewCloneId, false)) : nullptr;
+	TSharedPtr<const FArticyLocationIndex> Index = MakeShared<FArticyLocationIndex>(this, LocationId);
+	LocationIndices.Add(LocationId, Index);
+	return Index.Get();
 }
 
 /**
- * Retrieves the Expresso scripts instance for script execution.
- * @return A pointer to the UArticyExpressoScripts instance.
+ * Returns the dialogue table of a package, building it on first use or if the object table changed since, and
+ * reading the fragments written since the last call again.
+ * @param PackageName The name of the package.
+ * @return The table, or nullptr if the package is not loaded.
  */
-UArticyExpressoScripts* UArticyDatabase::GetExpressoInstance() const
+const FArticyDialogueTable* UArticyDatabase::GetDialogueTable(const FString& PackageName) const
 {
-	if (!CachedExpressoScripts)
+	check(IsInGameThread());
+
+	if (DialogueTablesVersion != ObjectTableVersion)
 	{
-		if (ensure(ExpressoScriptsClass))
+		DialogueTables.Reset();
+		PendingDialogueUpdates.Reset();
+		DialogueTablesVersion = ObjectTableVersion;
+	}
+
+	if (PendingDialogueUpdates.Num() > 0)
+	{
+		for (const TPair<FString, TSharedPtr<FArticyDialogueTable>>& Table : DialogueTables)
 		{
-			CachedExpressoScripts = NewObject<UArticyExpressoScripts>(const_cast<UArticyDatabase*>(this), ExpressoScriptsClass);
-			CachedExpressoScripts->Init(const_cast<UArticyDatabase*>(this));
+			for (const FArticyId& Id : PendingDialogueUpdates)
+				Table.Value->Update(Id, FindInObjectTable(Id));
 		}
+		PendingDialogueUpdates.Reset();
 	}
 
-	return CachedExpressoScripts;
+	if (const TSharedPtr<FArticyDialogueTable>* Existing = DialogueTables.Find(PackageName))
+		return Existing->Get();
+
+	if (!LoadedPackages.Contains(PackageName))
+		return nullptr;
+
+	TSharedPtr<FArticyDialogueTable> Table = MakeShared<FArticyDialogueTable>(this, PackageName);
+	DialogueTables.Add(PackageName, Table);
+	return Table.Get();
+}
+
+/**
+ * Returns the references to an object from the reference indices of the loaded packages.
+ * @param Target The id of the referenced object.
+ * @param PackageName The package to look in, or empty for all loaded packages.
+ * @return The references.
+ */
+TArray<FArticyIncomingReference> UArticyDatabase::GetIncomingReferences(FArticyId Target, const FString& PackageName) const
+{
+	TArray<FArticyIncomingReference> References;
+	for (const FString& Loaded : LoadedPackages)
+	{
+		if (!PackageName.IsEmpty() && Loaded != PackageName)
+			continue;
+
+		const UArticyPackage* Package = ResidentPackages.FindRef(Loaded);
+		if (const TArray<FArticyIncomingReference>* Found = Package ? Package->GetReferenceIndex().Find(Target) : nullptr)
+			References.Append(*Found);
+	}
+
+	return References;
+}
+
+/**
+ * Returns the loaded objects referring to an object.
+ * @param Target The id of the referenced object.
+ * @param PackageName The package to look in, or empty for all loaded packages.
+ * @return The referring objects, in the order of their first reference.
+ */
+TArray<UArticyObject*> UArticyDatabase::GetReferencingObjects(FArticyId Target, const FString& PackageName) const
+{
+	TArray<UArticyObject*> Objects;
+	for (const FArticyIncomingReference& Reference : GetIncomingReferences(Target, PackageName))
+	{
+		if (UArticyObject* Object = GetObject(Reference.Source))
+			Objects.AddUnique(Object);
+	}
+
+	return Objects;
+}
+
+/**
+ * Returns the zone of a location which contains a point.
+ * @param Location The location.
+ * @param Point The point, in location coordinates.
+ * @return The zone, or nullptr.
+ */
+UArticyObject* UArticyDatabase::FindZoneAt(const UArticyObject* Location, FVector2D Point) const
+{
+	const FArticyLocationIndex* Index = Location ? GetLocationIndex(Location->GetId()) : nullptr;
+	return Index ? Index->FindZoneAt(Point) : nullptr;
+}
+
+/**
+ * Returns the spot of a location closest to a point.
+ * @param Location The location.
+ * @param Point The point, in location coordinates.
+ * @param MaxDistance Spots further away are ignored, 0 for no limit.
+ * @return The spot, or nullptr.
+ */
+UArticyObject* UArticyDatabase::FindNearestSpot(const UArticyObject* Location, FVector2D Point, float MaxDistance) const
+{
+	const FArticyLocationIndex* Index = Location ? GetLocationIndex(Location->GetId()) : nullptr;
+	return Index ? Index->FindNearestSpot(Point, MaxDistance) : nullptr;
+}
+
+/**
+ * Returns the flow graph of the loaded packages, (re)building it if objects were added to or removed from the
+ * object table since. Objects which were only replaced (e.g. by MaterializeSharedObject or ResetToOriginal) just
+ * update their nodes, so writes to shared objects don't rebuild the graph.
+ * @return The flow graph of this database.
+ */
+const FArticyFlowGraph& UArticyDatabase::GetFlowGraph() const
+{
+	if (FlowGraph && FlowGraphVersion == ObjectTableIdsVersion && PendingFlowGraphUpdates.Num() > 0)
+	{
+		for (const FArticyId& Id : PendingFlowGraphUpdates)
+		{
+			if (!FlowGraph->UpdateObject(this, Id))
+			{
+				//build the graph again below
+				++FlowGraphVersion;
+				break;
+			}
+		}
+	}
+	PendingFlowGraphUpdates.Reset();
+
+	if (!FlowGraph || FlowGraphVersion != ObjectTableIdsVersion)
+	{
+		if (!FlowGraph)
+			FlowGraph = MakeUnique<FArticyFlowGraph>();
+
+		//a cooked database restores the graph of its default packages, the image is rejected for other packages
+		if (!FlowGraphImage.IsValid() || !FlowGraph->LoadImage(this, *FlowGraphImage))
+			FlowGraph->Build(this);
+		FlowGraphVersion = ObjectTableIdsVersion;
+	}
+
+	return *FlowGraph;
+}
+
+/**
+ * Returns the flow graph if it was built for the loaded packages, without building it.
+ * @return The flow graph, or nullptr if it was not built yet or packages were loaded or unloaded since.
+ */
+const FArticyFlowGraph* UArticyDatabase::FindFlowGraph() const
+{
+	if (!FlowGraph || FlowGraphVersion != ObjectTableIdsVersion)
+		return nullptr;
+
+	//applies the updates of the replaced objects
+	return &GetFlowGraph();
+}
+
+/**
+ * Returns the copy of an object that reads should see, so a script reading an object after writing it sees its write.
+ * @param Object Any copy of the object (original or shadow).
+ * @return The most recent copy at or below the current shadow level, or Object outside of shadow states.
+ */
+UArticyObject* UArticyDatabase::GetReadableObject(UArticyObject* Object)
+{
+	if (!Object)
+		return Object;
+
+	UArticyDatabase* Database = Object->GetTypedOuter<UArticyDatabase>();
+	if (!Database)
+	{
+		//a shared package asset, which may have been replaced by a private copy since
+		const TWeakObjectPtr<UArticyDatabase>* Owner = SharedObjectOwners.Num() > 0 ? SharedObjectOwners.Find(Object) : nullptr;
+		Database = Owner ? Owner->Get() : nullptr;
+		if (!Database)
+			return Object;
+	}
+	else if (Database->GetShadowLevel() == 0)
+	{
+		return Object;
+	}
+
+	FArticyCloneableObject* const* Container = Database->LoadedObjectsById.Find(Object->GetId());
+	UArticyObject* Readable = Container && *Container ? (*Container)->Get(Database, Object->GetCloneId()) : nullptr;
+
+	//objects which are not managed by this database are read directly
+	return Readable ? Readable : Object;
+}
+
+/**
+ * Returns the shadow copy of the current shadow level of an object, creating it if needed.
+ * @param Object Any copy of the object (original or shadow).
+ * @return The writable shadow copy.
+ */
+UArticyObject* UArticyDatabase::GetShadowForWrite(UArticyObject* Object)
+{
+	FArticyCloneableObject* const* Container = LoadedObjectsById.Find(Object->GetId());
+	UArticyObject* Writable = Container && *Container ? (*Container)->GetForWrite(this, Object->GetCloneId()) : nullptr;
+
+	//objects which are not managed by this database are written directly
+	return Writable ? Writable : Object;
+}
+
+/**
+ * Replaces a shared package asset by a private copy. The copy is outered to the database and gets the clone id, the
+ * asset is not modified. Clones and shadow copies are only made from the copy, see FArticyCloneableObject::UnshareOriginal.
+ * @param Shared The shared package asset.
+ * @return The private copy, also if the asset was replaced already.
+ */
+UArticyObject* UArticyDatabase::MaterializeSharedObject(UArticyObject* Shared)
+{
+	FArticyCloneableObject* const* Container = LoadedObjectsById.Find(Shared->GetId());
+	if (!ensure(Container && *Container && (*Container)->SharedAsset == Shared))
+	{
+		SharedObjectOwners.Remove(Shared);
+		return Shared;
+	}
+
+	//the entry of the asset is kept until the object is unloaded (see ReleaseSharedObject), so pointers to the asset
+	//which were taken before it was replaced still resolve to the copy
+	UArticyObject* Current = (*Container)->Get(this, 0, true);
+	if (Current != Shared)
+		return Current;
+
+	//the copy is outered to the database, and the asset itself is left untouched
+	UArticyObject* Copy = DuplicateObject<UArticyObject>(Shared, this);
+	Copy->SetCloneID(0);
+	Copy->CopyModifiedState(Shared);
+
+	//listeners registered on the shared object should keep receiving change notifications
+	Copy->ReportChanged = Shared->ReportChanged;
+	Shared->ReportChanged.Clear();
+
+	//every table which resolves the object by id gets the copy, the indices and cached references resolve it again
+	(*Container)->ReplaceOriginal(Copy);
+	AddToObjectTable(Shared->GetId(), Copy);
+
+	//duplicates are not linked, and the asset is not part of the database anymore
+	Copy->LinkReferences(this);
+	Shared->LinkReferences(nullptr);
+
+	return Copy;
+}
+
+/**
+ * Stops sharing the package asset of a container, whether it is still its clone 0 or was replaced by a copy.
+ * @param Container The container of the object that gets unloaded.
+ */
+void UArticyDatabase::ReleaseSharedObject(FArticyCloneableObject* Container)
+{
+	if (!Container || !Container->SharedAsset)
+		return;
+
+	UArticyObject* Asset = Container->SharedAsset;
+	Container->SharedAsset = nullptr;
+
+	const TWeakObjectPtr<UArticyDatabase>* Owner = SharedObjectOwners.Find(Asset);
+	if (Owner && Owner->Get() == this)
+	{
+		SharedObjectOwners.Remove(Asset);
+		//the asset outlives the database, so it must not keep its links
+		Asset->LinkReferences(nullptr);
+	}
+}
+
+/**
+ * Stops sharing all package assets shared by this database.
+ */
+void UArticyDatabase::ReleaseSharedObjects()
+{
+	for (auto It = SharedObjectOwners.CreateIterator(); It; ++It)
+	{
+		//also drop entries of databases that are already gone
+		if (!It->Value.IsValid() || It->Value.Get() == this)
+		{
+			const_cast<UArticyObject*>(It->Key)->LinkReferences(nullptr);
+			It.RemoveCurrent();
+		}
+	}
+}
+
+/**
+ * Resets a world clone to the state of a new clone, so the next world can reuse it.
+ * Only the objects recorded in ModifiedObjectIds are duplicated again, all others are kept as they are.
+ */
+void UArticyDatabase::ResetToOriginal()
+{
+	CancelPendingLoads();
+	ensureMsgf(GetShadowLevel() == 0, TEXT("The ArticyDatabase is reset while a shadow state is active."));
+
+	bool bRelink = false;
+	{
+		TGuardValue<bool> DeferLinking(bDeferLinking, true);
+
+		//a new clone has the default packages loaded, and no others
+		for (const FString& PackageName : LoadedPackages.Array())
+		{
+			if (!IsPackageDefaultPackage(PackageName))
+				bRelink |= UnloadPackage(PackageName, false);
+		}
+
+		for (const TPair<FString, FArticyPackageEntry>& pack : ImportedPackageEntries)
+		{
+			if (!pack.Value.Package.IsNull() && pack.Value.bIsDefaultPackage && !LoadedPackages.Contains(pack.Key))
+			{
+				LoadPackage(pack.Key);
+				bRelink = true;
+			}
+		}
+	}
+
+	//the written objects are copied from their package assets again
+	if (ModifiedObjectIds.Num() > 0)
+	{
+		for (const TPair<FString, UArticyPackage*>& Resident : ResidentPackages)
+		{
+			if (!Resident.Value)
+				continue;
+
+			for (UArticyObject* Asset : Resident.Value->GetAssets())
+			{
+				if (!Asset || ModifiedObjectIds.Remove(Asset->GetId()) == 0)
+					continue;
+
+				FArticyCloneableObject* const* Container = LoadedObjectsById.Find(Asset->GetId());
+				if (!Container || !*Container)
+					continue;
+
+				UArticyObject* Copy = DuplicateObject<UArticyObject>(Asset, this);
+				(*Container)->ReplaceOriginal(Copy);
+				AddToObjectTable(Asset->GetId(), Copy);
+				bRelink = true;
+			}
+		}
+
+		ModifiedObjectIds.Reset();
+	}
+
+	for (const TPair<FArticyId, FArticyCloneableObject*>& Loaded : LoadedObjectsById)
+	{
+		if (Loaded.Value)
+			Loaded.Value->RemoveClones();
+	}
+
+	if (bRelink)
+		LinkObjects();
+
+	++ObjectStateVersion;
+	++ObjectResolveVersion;
 }
 
 /**
@@ -847,3 +3830,12 @@ UArticyDatabase::FAssetId UArticyDatabase::ResolveIDs(const FString& articyAsset
 TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<UArticyDatabase>> UArticyDatabase::Clones;
 /** Static persistent clone instance. */
 TWeakObjectPtr<UArticyDatabase> UArticyDatabase::PersistentClone;
+/** Static cache of the last world resolved by Get, and its clone. */
+TWeakObjectPtr<UWorld> UArticyDatabase::LastResolvedWorld;
+TWeakObjectPtr<UArticyDatabase> UArticyDatabase::LastResolvedClone;
+/** Static map of shared package assets to the database sharing them. */
+TMap<const UArticyObject*, TWeakObjectPtr<UArticyDatabase>> UArticyDatabase::SharedObjectOwners;
+/** Static counter of changes to the unshadowed object state of all databases. */
+std::atomic<uint32> UArticyDatabase::ObjectStateVersion{ 0 };
+/** Static counter of changes that may make the objects resolved by FArticyRef stale. */
+std::atomic<uint32> UArticyDatabase::ObjectResolveVersion{ 0 };
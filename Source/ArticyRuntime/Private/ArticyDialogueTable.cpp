@@ -0,0 +1,109 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyDialogueTable.h"
+#include "ArticyBuiltinTypes.h"
+#include "ArticyDatabase.h"
+#include "ArticyFlowClasses.h"
+#include "ArticyPackage.h"
+#include "UObject/TextProperty.h"
+
+namespace
+{
+	const FName TextName(TEXT("Text"));
+	const FName MenuTextName(TEXT("MenuText"));
+	const FName StageDirectionsName(TEXT("StageDirections"));
+	const FName SpeakerName(TEXT("Speaker"));
+	const FName PreviewImageName(TEXT("PreviewImage"));
+
+	/** Returns a property of an object if it has the expected type, e.g. not a user property of the same name. */
+	template<typename TProperty, typename TValue>
+	const TValue* FindField(const UArticyObject* Object, const FName& Name)
+	{
+		const FProperty* Property = Object->GetProperty(Name);
+		return CastField<TProperty>(Property) ? Property->ContainerPtrToValuePtr<TValue>(Object) : nullptr;
+	}
+}
+
+/**
+ * Builds the table from the current unshadowed clone 0 of the dialogue fragments among the assets of a package.
+ * @param Database The database the package is loaded into.
+ * @param PackageName The name of the package.
+ */
+FArticyDialogueTable::FArticyDialogueTable(const UArticyDatabase* Database, const FString& PackageName)
+{
+	UArticyPackage* Package = Database ? Database->GetPackageAsset(PackageName, false) : nullptr;
+	if (!Package)
+		return;
+
+	const FArticyFlowGraph& Graph = Database->GetFlowGraph();
+	for (UArticyObject* Asset : Package->GetAssets())
+	{
+		if (!Asset || !Asset->IsA<UArticyDialogueFragment>())
+			continue;
+
+		//shared package assets are replaced by their copy once they are written
+		const UArticyObject* Object = Database->FindInObjectTable(Asset->GetId());
+		if (!Object)
+			continue;
+
+		const int32 Row = Ids.Add(Asset->GetId());
+		NodeIndices.Add(Graph.FindNode(Object));
+		RowById.Add(Asset->GetId(), Row);
+	}
+
+	Texts.SetNum(Ids.Num());
+	MenuTexts.SetNum(Ids.Num());
+	StageDirections.SetNum(Ids.Num());
+	Speakers.SetNum(Ids.Num());
+	PreviewImageAssets.SetNum(Ids.Num());
+	for (int32 Row = 0; Row < Ids.Num(); ++Row)
+		ReadRow(Row, Database->FindInObjectTable(Ids[Row]));
+}
+
+/**
+ * Returns the row of a dialogue fragment.
+ * @param Id The id of the fragment.
+ * @return The row, or INDEX_NONE if the fragment is not part of the table.
+ */
+int32 FArticyDialogueTable::FindRow(const FArticyId& Id) const
+{
+	const int32* Row = RowById.Find(Id);
+	return Row ? *Row : INDEX_NONE;
+}
+
+/**
+ * Reads the row of a fragment again, if it is part of the table.
+ * @param Id The id of the fragment.
+ * @param Object The current unshadowed clone 0 of the fragment, nullptr if it is not loaded anymore.
+ */
+void FArticyDialogueTable::Update(const FArticyId& Id, const UArticyObject* Object)
+{
+	const int32 Row = FindRow(Id);
+	if (Row != INDEX_NONE && Object)
+		ReadRow(Row, Object);
+}
+
+/**
+ * Reads the fields of a fragment into a row, fields the class of the fragment does not have are left empty.
+ * @param Row The row.
+ * @param Object The fragment.
+ */
+void FArticyDialogueTable::ReadRow(int32 Row, const UArticyObject* Object)
+{
+	const FText* Text = FindField<FTextProperty, FText>(Object, TextName);
+	Texts[Row] = Text ? *Text : FText::GetEmpty();
+
+	const FText* MenuText = FindField<FTextProperty, FText>(Object, MenuTextName);
+	MenuTexts[Row] = MenuText ? *MenuText : FText::GetEmpty();
+
+	const FText* Directions = FindField<FTextProperty, FText>(Object, StageDirectionsName);
+	StageDirections[Row] = Directions ? *Directions : FText::GetEmpty();
+
+	const FArticyId* Speaker = FindField<FStructProperty, FArticyId>(Object, SpeakerName);
+	Speakers[Row] = Speaker ? *Speaker : FArticyId();
+
+	UArticyPreviewImage* const* PreviewImage = FindField<FObjectProperty, UArticyPreviewImage*>(Object, PreviewImageName);
+	PreviewImageAssets[Row] = PreviewImage && *PreviewImage ? (*PreviewImage)->Asset : FArticyId();
+}
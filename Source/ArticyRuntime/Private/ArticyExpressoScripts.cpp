@@ -6,11 +6,23 @@
 #include "ArticyRuntimeModule.h"
 #include "ArticyFlowPlayer.h"
 #include <ArticyPins.h>
+#include "Algo/BinarySearch.h"
+#include "Misc/ScopeRWLock.h"
+#include "ArticyScriptProfiler.h"
+#include "ArticyGvProfiler.h"
+#include "ArticyStats.h"
 
 TMap<FName, ExpressoType::Definition> ExpressoType::Definitions;
 
-ExpressoType::ExpressoType() {}
-ExpressoType::~ExpressoType() {}
+namespace
+{
+	/** The hash of the empty condition and instruction, which every fragment without a script has. */
+	int GetEmptyScriptHash()
+	{
+		static const int EmptyHash = static_cast<int>(GetTypeHash(FString{ "" }));
+		return EmptyHash;
+	}
+}
 
 /**
  * @brief Constructs an ExpressoType from an object and a property name.
@@ -22,6 +34,10 @@ ExpressoType::~ExpressoType() {}
  */
 ExpressoType::ExpressoType(UArticyBaseObject* Object, const FString& Property)
 {
+	//reads see the writes of the script, e.g. to the shadow copy of an exploration
+	if (Object)
+		Object = Cast<UArticyBaseObject>(Object->GetReadableInstance()->_getUObject());
+
 	auto propName = Property;
 	Object = TryFeatureReroute(Object, propName);
 
@@ -86,28 +102,37 @@ ExpressoType::ExpressoType(const FString& Value)
 	Type = String;
 }
 
+/**
+ * @brief Constructs an ExpressoType from a temporary string, taking over its storage.
+ *
+ * @param Value The string value to initialize the ExpressoType with.
+ */
+ExpressoType::ExpressoType(FString&& Value)
+{
+	StringValue = MoveTemp(Value);
+	Type = String;
+}
+
 //========================================//
 
 /**
  * @brief Constructs an ExpressoType from an ArticyPrimitive object.
  *
  * This constructor initializes an ExpressoType instance based on the ID and clone ID of the specified object.
+ * Null objects have the id 0, like the "0_0" of their string representation.
  *
  * @param Object The ArticyPrimitive object.
  */
 ExpressoType::ExpressoType(const UArticyPrimitive* Object)
 {
-	Type = String;
+	Type = ExpressoType::Object;
 
-	if (!Object)
+	if (Object)
 	{
-		// Return "Null" ID to avoid crashes expecting this to be in the %11u_%d format
-		StringValue = "0_0";
-		return;
+		// Make sure to use the full 64-bit ID
+		IntValue = static_cast<int64>(Object->GetId().Get());
+		CloneIdValue = Object->GetCloneId();
 	}
-
-	// Make sure to use the full 64-bit ID
-	StringValue = FString::Printf(TEXT("%llu_%d"), Object->GetId().Get(), Object->GetCloneId());
 }
 
 /**
@@ -150,18 +175,11 @@ ExpressoType::ExpressoType(const UArticyBool& Value)
  */
 ExpressoType::ExpressoType(const FArticyId& Value)
 {
-	Type = String;
-
-	if (!Value)
-	{
-		// Return "Null" ID to avoid crashes expecting this to be in the %11u_%d format
-		StringValue = "0_0";
-		return;
-	}
+	Type = Object;
 
 	// Make sure to use the full 64-bit ID
 	// > always 0 for clone ID... PB...
-	StringValue = FString::Printf(TEXT("%llu_0"), Value.Get());
+	IntValue = static_cast<int64>(Value.Get());
 }
 
 /**
@@ -186,7 +204,11 @@ ExpressoType::operator bool() const
  */
 ExpressoType::operator int64() const
 {
-	ensure(Type == Float || Type == Int || Type == String);
+	ensure(Type == Float || Type == Int || Type == String || Type == Object);
+
+	// the id of an object, e.g. to assign the result of getObj to a slot
+	if (Type == Object)
+		return GetInt();
 
 	if (Type == String)
 	{
@@ -240,6 +262,9 @@ ExpressoType::operator double() const
  */
 ExpressoType::operator FString() const
 {
+	if (Type == Object)
+		return ToString();
+
 	ensure(Type == String);
 	return GetString();
 }
@@ -265,6 +290,10 @@ FString ExpressoType::ToString() const
 	if (Type == Float)
 		return FString::SanitizeFloat(GetFloat());
 
+	// Objects use the Id_CloneId format of the scripts
+	if (Type == Object)
+		return FString::Printf(TEXT("%llu_%d"), static_cast<uint64>(GetInt()), GetCloneId());
+
 	ensureMsgf(false, TEXT("Unknown ArticyExpressoType!"));
 	return FString();
 }
@@ -292,6 +321,7 @@ ExpressoType ExpressoType::operator-() const
 	case Float:
 		return ExpressoType(-GetFloat());
 	case String:
+	case Object:
 		return ExpressoType(FString(""));
 
 	default:
@@ -341,7 +371,14 @@ bool ExpressoType::operator==(const ExpressoType& Other) const
 			ensureMsgf(false, TEXT("Uncomparable expresso types!"));
 		}
 	case String:
+		// a string variable holding an object, compared with the object
+		if (Other.Type == Object)
+			return GetString() == Other.ToString();
 		return GetString() == Other.GetString();
+	case Object:
+		if (Other.Type == Object)
+			return GetInt() == Other.GetInt() && GetCloneId() == Other.GetCloneId();
+		return ToString() == Other.GetString();
 
 	default:
 		ensureMsgf(false, TEXT("Unknown ArticyExpressoType!"));
@@ -401,7 +438,9 @@ bool ExpressoType::operator<(const ExpressoType& Other) const
 			ensureMsgf(false, TEXT("Uncomparable expresso types!"));
 		}
 	case String:
-		return GetString() < Other.GetString();
+		return GetString() < (Other.Type == Object ? Other.ToString() : Other.GetString());
+	case Object:
+		return ToString() < Other.ToString();
 
 	default:
 		ensureMsgf(false, TEXT("Unknown ArticyExpressoType!"));
@@ -448,7 +487,9 @@ bool ExpressoType::operator>(const ExpressoType& Other) const
 			ensureMsgf(false, TEXT("Uncomparable expresso types!"));
 		}
 	case String:
-		return GetString() > Other.GetString();
+		return GetString() > (Other.Type == Object ? Other.ToString() : Other.GetString());
+	case Object:
+		return ToString() > Other.ToString();
 
 	default:
 		ensureMsgf(false, TEXT("Unknown ArticyExpressoType!"));
@@ -479,6 +520,7 @@ ExpressoType ExpressoType::operator&&(const ExpressoType& Other) const
 		return ExpressoType(GetFloat() && Other.GetFloat());
 
 	case String:
+	case Object:
 	case Undefined:
 		break;
 
@@ -509,6 +551,7 @@ ExpressoType ExpressoType::operator||(const ExpressoType& Other) const
 		return ExpressoType(GetFloat() || Other.GetFloat());
 
 	case String:
+	case Object:
 	case Undefined:
 		break;
 
@@ -538,6 +581,7 @@ ExpressoType ExpressoType::operator^(const ExpressoType& Other) const
 
 	case Float:
 	case String:
+	case Object:
 	case Undefined:
 		break;
 
@@ -570,7 +614,9 @@ ExpressoType ExpressoType::operator+(const ExpressoType& Other) const
 	case Float:
 		return ExpressoType(GetFloat() + Other.GetFloat());
 	case String:
-		return ExpressoType(GetString() + Other.GetString());
+		return ExpressoType(GetString() + (Other.Type == Object ? Other.ToString() : Other.GetString()));
+	case Object:
+		return ExpressoType(ToString() + Other.ToString());
 
 	default:
 		ensureMsgf(false, TEXT("Unknown ArticyExpressoType!"));
@@ -612,6 +658,7 @@ ExpressoType ExpressoType::operator*(const ExpressoType& Other) const
 		return ExpressoType(GetFloat() * Other.GetFloat());
 
 	case String:
+	case Object:
 	case Undefined:
 		break;
 
@@ -641,6 +688,7 @@ ExpressoType ExpressoType::operator/(const ExpressoType& Other) const
 
 	case Bool:
 	case String:
+	case Object:
 	case Undefined:
 		break;
 
@@ -671,6 +719,7 @@ ExpressoType ExpressoType::operator%(const ExpressoType& Other) const
 
 	case Bool:
 	case String:
+	case Object:
 	case Undefined:
 		break;
 
@@ -721,7 +770,8 @@ ExpressoType ExpressoType::operator--(int)
  */
 const ExpressoType::Definition& ExpressoType::GetDefinition(const FName& CppType) const
 {
-	if (Definitions.Num() == 0)
+	//the definitions are added once by the first call, which may come from a parallel exploration on a worker thread
+	static const bool bDefinitionsAdded = []
 	{
 #define ADD_DEFINITION(Type) AddDefinition<Type>(#Type);
 
@@ -748,9 +798,10 @@ const ExpressoType::Definition& ExpressoType::GetDefinition(const FName& CppType
 		ADD_DEFINITION(FName);
 
 		ADD_DEFINITION(FArticyId);
-	}
+		return true;
+	}();
 
-	auto def = Definitions.Find(CppType);
+	auto def = bDefinitionsAdded ? Definitions.Find(CppType) : nullptr;
 	if (def)
 		return *def;
 
@@ -768,7 +819,14 @@ const ExpressoType::Definition& ExpressoType::GetDefinition(const FName& CppType
  */
 void ExpressoType::SetValue(UArticyBaseObject* Object, FString Property) const
 {
-	Object = TryFeatureReroute(Object, Property);
+	//writes go to the writable instance, e.g. the shadow copy of an exploration
+	if (Object)
+	{
+		IArticyReflectable* Writable = Object->GetWritableInstance();
+		Object = Writable ? Cast<UArticyBaseObject>(Writable->_getUObject()) : nullptr;
+	}
+
+	Object = TryFeatureReroute(Object, Property, true);
 
 	if (!Object)
 		return;
@@ -786,7 +844,10 @@ void ExpressoType::SetValue(UArticyBaseObject* Object, FString Property) const
 	auto setter = GetDefinition(type).Setter;
 
 	if (ensureMsgf(setter, TEXT("Property %s has unknown type %s!"), *Property, *type.ToString()))
+	{
 		setter(Object, prop, *this);
+		Object->NotifyPropertyChanged(prop, INDEX_NONE);
+	}
 }
 
 /**
@@ -797,9 +858,10 @@ void ExpressoType::SetValue(UArticyBaseObject* Object, FString Property) const
  *
  * @param Object The object containing the property.
  * @param Property The name of the property.
+ * @param bForWrite If true, a feature shared with clones is copied into Object first.
  * @return The feature object, if rerouted, or the original object if not rerouted.
  */
-UArticyBaseObject* ExpressoType::TryFeatureReroute(UArticyBaseObject* Object, FString& Property)
+UArticyBaseObject* ExpressoType::TryFeatureReroute(UArticyBaseObject* Object, FString& Property, bool bForWrite)
 {
 	if (Object)
 	{
@@ -808,7 +870,7 @@ UArticyBaseObject* ExpressoType::TryFeatureReroute(UArticyBaseObject* Object, FS
 		{
 			//the property contains a dot
 			//take the part before the dot to extract the feature, and use it as Object to get the actual property from
-			UArticyBaseFeature* Feature = Object->GetProp<UArticyBaseFeature*>(*feature);
+			UArticyBaseFeature* Feature = bForWrite ? Object->GetFeatureForWrite(*feature) : Object->GetProp<UArticyBaseFeature*>(*feature);
 			if (!ensure(Feature))
 			{
 				UE_LOG(LogArticyRuntime, Warning, TEXT("Feature %s on Object %s is null, cannot access property %s!"),
@@ -823,61 +885,170 @@ UArticyBaseObject* ExpressoType::TryFeatureReroute(UArticyBaseObject* Object, FS
 	return Object;
 }
 
-/**
- * @brief Retrieves the boolean value of the ExpressoType.
- *
- * @return The boolean value.
- */
-bool& ExpressoType::GetBool() { return BoolValue; }
+//---------------------------------------------------------------------------//
 
 /**
- * @brief Retrieves the boolean value of the ExpressoType.
+ * @brief Constructs a property access from a path.
  *
- * @return The boolean value.
- */
-const bool& ExpressoType::GetBool() const { return BoolValue; }
-
-/**
- * @brief Retrieves the int64 value of the ExpressoType.
+ * The path is split into feature and property name here, instead of on every access.
  *
- * @return The int64 value.
+ * @param InPath The property name, or Feature.Property for feature properties.
  */
-int64& ExpressoType::GetInt() { return IntValue; }
+ExpressoProperty::ExpressoProperty(const FString& InPath) : Path(InPath)
+{
+	FString feature, property;
+	if (Path.Split(TEXT("."), &feature, &property))
+	{
+		Feature = *feature;
+		Property = *property;
+	}
+	else
+	{
+		Property = *Path;
+	}
+}
 
 /**
- * @brief Retrieves the int64 value of the ExpressoType.
+ * @brief Retrieves the value of the property on an object.
  *
- * @return The int64 value.
+ * @param Object The object containing the property (or its feature).
+ * @return The value of the property.
  */
-const int64& ExpressoType::GetInt() const { return IntValue; }
+ExpressoType ExpressoProperty::Get(UArticyBaseObject* Object) const
+{
+	FProperty* prop = nullptr;
+	const ExpressoType::Definition* definition = nullptr;
+	Object = Resolve(Object, prop, definition);
 
-/**
- * @brief Retrieves the double value of the ExpressoType.
- *
- * @return The double value.
- */
-double& ExpressoType::GetFloat() { return FloatValue; }
+	if (!Object || !definition)
+		return ExpressoType{};
+
+	return definition->Factory(Object, prop);
+}
 
 /**
- * @brief Retrieves the double value of the ExpressoType.
+ * @brief Sets the value of the property on an object.
  *
- * @return The double value.
+ * @param Object The object containing the property (or its feature).
+ * @param Value The value to set.
  */
-const double& ExpressoType::GetFloat() const { return FloatValue; }
+void ExpressoProperty::Set(UArticyBaseObject* Object, const ExpressoType& Value) const
+{
+	FProperty* prop = nullptr;
+	const ExpressoType::Definition* definition = nullptr;
+	Object = Resolve(Object, prop, definition, true);
+
+	if (Object && definition)
+	{
+		definition->Setter(Object, prop, Value);
+		Object->NotifyPropertyChanged(prop, INDEX_NONE);
+	}
+}
 
 /**
- * @brief Retrieves the string value of the ExpressoType.
+ * @brief Finds the object holding the property, and the property with its type definition.
+ *
+ * The reflection data is only looked up if the class differs from the one of the last access.
  *
- * @return The string value.
+ * @param Object The object containing the property (or its feature).
+ * @param OutProperty The reflected property.
+ * @param OutDefinition The type definition of the property.
+ * @param bForWrite If true, the writable instance of Object is resolved and a feature shared with clones is copied into it
+ * first, otherwise the readable instance.
+ * @return The object holding the property (the feature for feature properties), or nullptr.
  */
-FString& ExpressoType::GetString() { return StringValue; }
+UArticyBaseObject* ExpressoProperty::Resolve(UArticyBaseObject* Object, FProperty*& OutProperty, const ExpressoType::Definition*& OutDefinition, bool bForWrite) const
+{
+	if (!Object)
+		return nullptr;
+
+	//writes go to the writable instance, e.g. the shadow copy of an exploration, and reads see them
+	IArticyReflectable* Instance = bForWrite ? Object->GetWritableInstance() : Object->GetReadableInstance();
+	Object = Instance ? Cast<UArticyBaseObject>(Instance->_getUObject()) : nullptr;
+	if (!Object)
+		return nullptr;
+
+	if (!Feature.IsNone())
+	{
+		const UClass* objectClass = Object->GetClass();
+		FProperty* featureProp = nullptr;
+		{
+			FReadScopeLock ReadLock(CacheLock);
+			if (CachedFeature.Class == objectClass)
+				featureProp = CachedFeature.Property;
+		}
+
+		if (!featureProp)
+		{
+			featureProp = Object->GetProperty(Feature);
+			if (featureProp)
+			{
+				FWriteScopeLock WriteLock(CacheLock);
+				CachedFeature.Class = objectClass;
+				CachedFeature.Property = featureProp;
+			}
+		}
+
+		UArticyBaseFeature* feature = nullptr;
+		if (featureProp)
+			feature = bForWrite ? Object->GetFeatureForWrite(featureProp) : *featureProp->ContainerPtrToValuePtr<UArticyBaseFeature*>(Object);
+
+		if (!ensure(feature))
+		{
+			UE_LOG(LogArticyRuntime, Warning, TEXT("Feature %s on Object %s is null, cannot access property %s!"),
+				*Feature.ToString(), *Object->GetName(), *Property.ToString());
+			return nullptr;
+		}
+
+		Object = feature;
+	}
+
+	const UClass* propertyClass = Object->GetClass();
+	{
+		FReadScopeLock ReadLock(CacheLock);
+		if (CachedProperty.Class == propertyClass)
+		{
+			OutProperty = CachedProperty.Property;
+			OutDefinition = CachedProperty.Definition;
+			return Object;
+		}
+	}
+
+	OutProperty = Object->GetProperty(Property);
+	if (!ensure(OutProperty))
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("Property %s not found on Object %s!"), *Path, *Object->GetName());
+		return nullptr;
+	}
+
+	const FName type = *OutProperty->GetCPPType();
+	const ExpressoType::Definition& definition = ExpressoType{}.GetDefinition(type);
+	if (!ensureMsgf(definition.Factory, TEXT("Property %s has unknown type %s!"), *Path, *type.ToString()))
+		return nullptr;
+
+	OutDefinition = &definition;
+
+	FWriteScopeLock WriteLock(CacheLock);
+	CachedProperty.Class = propertyClass;
+	CachedProperty.Property = OutProperty;
+	CachedProperty.Definition = OutDefinition;
+	return Object;
+}
+
+//---------------------------------------------------------------------------//
 
 /**
- * @brief Retrieves the string value of the ExpressoType.
+ * @brief Constructs an object reference from an id.
  *
- * @return The string value.
+ * The seen counter slot is assigned here, as slots are process wide and never reused.
+ *
+ * @param InId The id of the object.
  */
-const FString& ExpressoType::GetString() const { return StringValue; }
+ExpressoObjectId::ExpressoObjectId(uint64 InId) : Id(InId), SeenCounterSlot(FArticySeenCounterSlots::FindOrAdd(Id))
+{
+}
+
+//---------------------------------------------------------------------------//
 
 /**
  * @brief Constructs an ExpressoType from an int32 value.
@@ -1083,11 +1254,57 @@ bool ExpressoType::operator>=(const ExpressoType& Other) const { return !(*this
 bool UArticyExpressoScripts::Evaluate(const int& ConditionFragmentHash, UArticyGlobalVariables* GV,
 	UObject* MethodProvider) const
 {
+	return EvaluateByIndex(GetConditionIndex(ConditionFragmentHash), ConditionFragmentHash, GV, MethodProvider);
+}
+
+/**
+ * @brief Finds a hash in a sorted hash table of the generated scripts.
+ *
+ * @param SortedHashes The hashes of the scripts, in ascending order.
+ * @param Hash The hash to find.
+ * @return The index of the hash, or INDEX_NONE.
+ */
+int32 UArticyExpressoScripts::FindScriptIndex(TConstArrayView<uint32> SortedHashes, uint32 Hash)
+{
+	return Algo::BinarySearch(SortedHashes, Hash);
+}
+
+/**
+ * @brief Evaluates a condition fragment by its index in the generated script table.
+ *
+ * Conditions which are not part of the table (INDEX_NONE) are empty, or looked up in Conditions by their hash.
+ *
+ * @param ConditionIndex The index of the condition, or INDEX_NONE.
+ * @param ConditionFragmentHash The hash of the condition fragment.
+ * @param GV The global variables used in the evaluation.
+ * @param MethodProvider The method provider used in the evaluation.
+ * @return The result of the evaluation.
+ */
+bool UArticyExpressoScripts::EvaluateByIndex(int32 ConditionIndex, const int& ConditionFragmentHash, UArticyGlobalVariables* GV,
+	UObject* MethodProvider) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ArticyEvaluateCondition);
+	ARTICY_SCRIPT_TRACE_SCOPE("ArticyEvaluateCondition");
+	FArticyScriptProfiler::FScope ProfileScope(ConditionFragmentHash, false);
+	FArticyGvProfiler::FFragmentScope GvProfileScope(ConditionFragmentHash, false);
+
 	SetGV(GV);
 	UserMethodsProvider = MethodProvider;
 
-	auto condition = Conditions.Find(ConditionFragmentHash);
-	bool result = ensure(condition) && (*condition)();
+	bool result;
+	if (ConditionIndex != INDEX_NONE)
+	{
+		result = EvaluateCondition(ConditionIndex);
+	}
+	else if (ConditionFragmentHash == GetEmptyScriptHash())
+	{
+		result = true;
+	}
+	else
+	{
+		auto condition = Conditions.Find(ConditionFragmentHash);
+		result = ensure(condition) && (*condition)();
+	}
 
 	// Clear methods provider
 	UserMethodsProvider = nullptr;
@@ -1095,6 +1312,60 @@ bool UArticyExpressoScripts::Evaluate(const int& ConditionFragmentHash, UArticyG
 	return result;
 }
 
+/**
+ * @brief Evaluates several condition fragments with the same context.
+ *
+ * The global variables and the methods provider are set once for all conditions, and the results of the pure
+ * user methods are memoized across them.
+ *
+ * @param ConditionFragmentHashes The hashes of the condition fragments.
+ * @param GV The global variables used in the evaluation.
+ * @param MethodProvider The method provider used in the evaluation.
+ * @param OutResults Receives the result of each condition, must have as many elements as there are hashes.
+ */
+void UArticyExpressoScripts::EvaluateMany(TConstArrayView<int32> ConditionFragmentHashes, UArticyGlobalVariables* GV,
+	UObject* MethodProvider, TArrayView<bool> OutResults) const
+{
+	check(OutResults.Num() == ConditionFragmentHashes.Num());
+
+	SCOPE_CYCLE_COUNTER(STAT_ArticyEvaluateCondition);
+	ARTICY_SCRIPT_TRACE_SCOPE("ArticyEvaluateConditions");
+
+	SetGV(GV);
+	UserMethodsProvider = MethodProvider;
+
+	{
+		FMethodMemoScope MemoScope(this);
+		const int EmptyHash = GetEmptyScriptHash();
+
+		for (int32 i = 0; i < ConditionFragmentHashes.Num(); ++i)
+		{
+			const int Hash = ConditionFragmentHashes[i];
+			FArticyScriptProfiler::FScope ProfileScope(Hash, false);
+			FArticyGvProfiler::FFragmentScope GvProfileScope(Hash, false);
+
+			const int32 ConditionIndex = GetConditionIndex(Hash);
+			if (ConditionIndex != INDEX_NONE)
+			{
+				OutResults[i] = EvaluateCondition(ConditionIndex);
+			}
+			else if (Hash == EmptyHash)
+			{
+				OutResults[i] = true;
+			}
+			else
+			{
+				auto condition = Conditions.Find(Hash);
+				OutResults[i] = ensure(condition) && (*condition)();
+			}
+		}
+	}
+
+	// Clear methods provider
+	UserMethodsProvider = nullptr;
+	SetGV(nullptr);
+}
+
 /**
  * @brief Executes an instruction fragment.
  *
@@ -1108,16 +1379,50 @@ bool UArticyExpressoScripts::Evaluate(const int& ConditionFragmentHash, UArticyG
 bool UArticyExpressoScripts::Execute(const int& InstructionFragmentHash, UArticyGlobalVariables* GV,
 	UObject* MethodProvider) const
 {
+	return ExecuteByIndex(GetInstructionIndex(InstructionFragmentHash), InstructionFragmentHash, GV, MethodProvider);
+}
+
+/**
+ * @brief Executes an instruction fragment by its index in the generated script table.
+ *
+ * Instructions which are not part of the table (INDEX_NONE) are empty, or looked up in Instructions by their hash.
+ *
+ * @param InstructionIndex The index of the instruction, or INDEX_NONE.
+ * @param InstructionFragmentHash The hash of the instruction fragment.
+ * @param GV The global variables used in the execution.
+ * @param MethodProvider The method provider used in the execution.
+ * @return True if the execution was successful, false otherwise.
+ */
+bool UArticyExpressoScripts::ExecuteByIndex(int32 InstructionIndex, const int& InstructionFragmentHash, UArticyGlobalVariables* GV,
+	UObject* MethodProvider) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ArticyExecuteInstruction);
+	ARTICY_SCRIPT_TRACE_SCOPE("ArticyExecuteInstruction");
+	FArticyScriptProfiler::FScope ProfileScope(InstructionFragmentHash, true);
+	FArticyGvProfiler::FFragmentScope GvProfileScope(InstructionFragmentHash, true);
+
 	SetGV(GV);
 	UserMethodsProvider = MethodProvider;
 
 	bool result = false;
-	auto instruction = Instructions.Find(InstructionFragmentHash);
-	if (ensure(instruction))
+	if (InstructionIndex != INDEX_NONE)
 	{
-		(*instruction)();
+		ExecuteInstruction(InstructionIndex);
 		result = true;
 	}
+	else if (InstructionFragmentHash == GetEmptyScriptHash())
+	{
+		result = true;
+	}
+	else
+	{
+		auto instruction = Instructions.Find(InstructionFragmentHash);
+		if (ensure(instruction))
+		{
+			(*instruction)();
+			result = true;
+		}
+	}
 
 	// Clear methods provider
 	UserMethodsProvider = nullptr;
@@ -1125,6 +1430,78 @@ bool UArticyExpressoScripts::Execute(const int& InstructionFragmentHash, UArticy
 	return result;
 }
 
+/**
+ * @brief Starts memoizing the results of the pure user methods, unless an outer scope did already.
+ *
+ * @param InScripts The scripts whose methods are memoized, may be null.
+ */
+UArticyExpressoScripts::FMethodMemoScope::FMethodMemoScope(const UArticyExpressoScripts* InScripts) : Scripts(InScripts)
+{
+	if (Scripts)
+		++Scripts->MethodMemoDepth;
+}
+
+/**
+ * @brief Discards the memoized results if this is the outermost scope.
+ */
+UArticyExpressoScripts::FMethodMemoScope::~FMethodMemoScope()
+{
+	if (Scripts && --Scripts->MethodMemoDepth == 0)
+		Scripts->ResetMethodMemos();
+}
+
+/**
+ * @brief Returns whether a script may change state when it runs.
+ *
+ * @param ScriptIndex The index of the script in the generated table, or INDEX_NONE.
+ * @param FragmentHash The hash of the fragment.
+ * @param bIsInstruction Whether the script is an instruction.
+ * @return False for empty scripts and for scripts the importer found to only read state.
+ */
+bool UArticyExpressoScripts::ScriptWritesState(int32 ScriptIndex, const int& FragmentHash, bool bIsInstruction) const
+{
+	if (ScriptIndex != INDEX_NONE)
+		return bIsInstruction ? InstructionWritesState(ScriptIndex) : ConditionWritesState(ScriptIndex);
+
+	// the empty scripts are the only ones the base class knows
+	return FragmentHash != GetEmptyScriptHash();
+}
+
+/**
+ * @brief Returns the variables a script reads and writes, and what else it accesses.
+ *
+ * @param ScriptIndex The index of the script in the generated table, or INDEX_NONE.
+ * @param FragmentHash The hash of the fragment.
+ * @param bIsInstruction Whether the script is an instruction.
+ * @return Nothing for empty scripts, unknown accesses for scripts which are not part of the table.
+ */
+FArticyScriptAccess UArticyExpressoScripts::GetScriptAccess(int32 ScriptIndex, const int& FragmentHash, bool bIsInstruction) const
+{
+	if (ScriptIndex != INDEX_NONE)
+		return bIsInstruction ? GetInstructionAccess(ScriptIndex) : GetConditionAccess(ScriptIndex);
+
+	FArticyScriptAccess Access;
+	if (FragmentHash == GetEmptyScriptHash())
+		Access.Flags = EArticyScriptAccess::None;
+	return Access;
+}
+
+/**
+ * @brief Returns an entry of a generated access table.
+ *
+ * @param Variables The variable table, holding the variables read by each script followed by the ones it writes.
+ * @param Entry The entry of the script.
+ * @return The accesses of the script.
+ */
+FArticyScriptAccess UArticyExpressoScripts::MakeScriptAccess(TConstArrayView<int32> Variables, const FArticyScriptAccessEntry& Entry)
+{
+	FArticyScriptAccess Access;
+	Access.ReadVariables = Variables.Slice(Entry.Begin, Entry.NumReads);
+	Access.WrittenVariables = Variables.Slice(Entry.Begin + Entry.NumReads, Entry.NumWrites);
+	Access.Flags = static_cast<EArticyScriptAccess>(Entry.Flags);
+	return Access;
+}
+
 /**
  * @brief Retrieves an Articy object by name or ID.
  *
@@ -1144,6 +1521,18 @@ UArticyObject* UArticyExpressoScripts::getObj(const FString& NameOrId, const uin
 	return OwningDatabase->GetObjectByName(*NameOrId, CloneId);
 }
 
+/**
+ * @brief Retrieves an Articy object by an id resolved when the scripts were generated.
+ *
+ * @param Object The object reference of the call site.
+ * @param CloneId The clone ID of the object.
+ * @return The Articy object.
+ */
+UArticyObject* UArticyExpressoScripts::getObj(const ExpressoObjectId& Object, const uint32& CloneId) const
+{
+	return OwningDatabase->GetObject<UArticyObject>(Object.GetId(), CloneId);
+}
+
 /**
  * @brief Retrieves an Articy object by a compound ID.
  *
@@ -1154,9 +1543,12 @@ UArticyObject* UArticyExpressoScripts::getObj(const FString& NameOrId, const uin
  */
 UArticyObject* UArticyExpressoScripts::getObjInternal(const ExpressoType& Id_CloneId) const
 {
-	//only works for strings!
+	//objects are looked up directly, strings (e.g. from string variables) are parsed
+	if (Id_CloneId.Type == ExpressoType::Object)
+		return OwningDatabase->GetObject<UArticyObject>(Id_CloneId.GetObjectId(), Id_CloneId.GetCloneId());
+
 	if (!ensureMsgf(Id_CloneId.Type == ExpressoType::String,
-		TEXT("getObj(Id_CloneId) only works for string-ExpressoType!")))
+		TEXT("getObj(Id_CloneId) only works for object- and string-ExpressoType!")))
 		return nullptr;
 
 	//parse id and cloneId from the compound id
@@ -1278,6 +1670,54 @@ ExpressoType UArticyExpressoScripts::getProp(const ExpressoType& Id_CloneId, con
 	return getProp(getObjInternal(Id_CloneId), Property);
 }
 
+/**
+ * @brief Sets the value of a property on an Articy object, for a property path known at generation time.
+ *
+ * @param Object The Articy object containing the property.
+ * @param Property The property access of the call site.
+ * @param Value The value to set.
+ */
+void UArticyExpressoScripts::setProp(UArticyBaseObject* Object, const ExpressoProperty& Property, const ExpressoType& Value)
+{
+	Property.Set(Object, Value);
+}
+
+/**
+ * @brief Sets the value of a property on an Articy object, for a property path known at generation time.
+ *
+ * @param Id_CloneId The compound ID of the object.
+ * @param Property The property access of the call site.
+ * @param Value The value to set.
+ */
+void UArticyExpressoScripts::setProp(const ExpressoType& Id_CloneId, const ExpressoProperty& Property, const ExpressoType& Value) const
+{
+	Property.Set(getObjInternal(Id_CloneId), Value);
+}
+
+/**
+ * @brief Retrieves the value of a property on an Articy object, for a property path known at generation time.
+ *
+ * @param Object The Articy object containing the property.
+ * @param Property The property access of the call site.
+ * @return The value of the property.
+ */
+ExpressoType UArticyExpressoScripts::getProp(UArticyBaseObject* Object, const ExpressoProperty& Property)
+{
+	return Property.Get(Object);
+}
+
+/**
+ * @brief Retrieves the value of a property on an Articy object, for a property path known at generation time.
+ *
+ * @param Id_CloneId The compound ID of the object.
+ * @param Property The property access of the call site.
+ * @return The value of the property.
+ */
+ExpressoType UArticyExpressoScripts::getProp(const ExpressoType& Id_CloneId, const ExpressoProperty& Property) const
+{
+	return Property.Get(getObjInternal(Id_CloneId));
+}
+
 /**
  * @brief Generates a random integer between Min and Max.
  *
@@ -1635,6 +2075,20 @@ int UArticyExpressoScripts::getSeenCounter(const FString& NameOrId)
 	return getSeenCounter(getObj(NameOrId, 0));
 }
 
+/**
+ * @brief Retrieves the seen counter for an Articy object resolved when the scripts were generated.
+ *
+ * The counter is read from the seen counter slot of the object, without looking the object up.
+ *
+ * @param Object The object reference of the call site.
+ * @return The seen counter value.
+ */
+int UArticyExpressoScripts::getSeenCounter(const ExpressoObjectId& Object)
+{
+	UArticyGlobalVariables* GVs = GetGV();
+	return GVs ? GVs->GetSeenCounterOfSlot(Object.GetSeenCounterSlot()) : 0;
+}
+
 /**
  * @brief Sets the seen counter for an Articy object by name or ID.
  *
@@ -1649,6 +2103,22 @@ int UArticyExpressoScripts::setSeenCounter(const FString& NameOrId, const int Va
 	return setSeenCounter(getObj(NameOrId, 0), Value);
 }
 
+/**
+ * @brief Sets the seen counter for an Articy object resolved when the scripts were generated.
+ *
+ * Nothing is set if the object is not loaded.
+ *
+ * @param Object The object reference of the call site.
+ * @param Value The value to set.
+ * @return The updated seen counter value.
+ */
+int UArticyExpressoScripts::setSeenCounter(const ExpressoObjectId& Object, const int Value)
+{
+	//an object which is not loaded must not fall back to the current object
+	UArticyObject* Obj = getObj(Object, 0);
+	return Obj ? setSeenCounter(Obj, Value) : 0;
+}
+
 /**
  * @brief Performs a fallback operation for an Articy object.
  *
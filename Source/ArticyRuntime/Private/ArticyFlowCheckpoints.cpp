@@ -0,0 +1,183 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyFlowCheckpoints.h"
+#include "ArticyRuntimeModule.h"
+
+/**
+ * Allocates the ring buffer, the state is recorded by the first Record.
+ * @param InDatabase The database whose objects are recorded.
+ * @param InGVs The global variables whose values are recorded.
+ * @param MaxCheckpoints The number of checkpoints kept.
+ */
+FArticyFlowCheckpoints::FArticyFlowCheckpoints(UArticyDatabase* InDatabase, UArticyGlobalVariables* InGVs, int32 MaxCheckpoints)
+	: Database(InDatabase), GVs(InGVs)
+{
+	Ring.SetNum(FMath::Max(MaxCheckpoints, 1));
+}
+
+FArticyFlowCheckpoints::~FArticyFlowCheckpoints()
+{
+	SetRecording(false);
+}
+
+/**
+ * Returns true if the checkpoints record the state of a database and global variables.
+ * @param InDatabase The database.
+ * @param InGVs The global variables.
+ * @param MaxCheckpoints The number of checkpoints kept.
+ * @return True if they are the ones the checkpoints were created for.
+ */
+bool FArticyFlowCheckpoints::Matches(const UArticyDatabase* InDatabase, const UArticyGlobalVariables* InGVs, int32 MaxCheckpoints) const
+{
+	return Database.Get() == InDatabase && GVs.Get() == InGVs && Ring.Num() == FMath::Max(MaxCheckpoints, 1);
+}
+
+/**
+ * Adds a checkpoint. The variables are compared with the ones of the previous checkpoint, which keeps their
+ * previous values, and the undo log of the previous checkpoint is closed.
+ * @param Cursor The node the flow player is at.
+ */
+void FArticyFlowCheckpoints::Record(const FArticyId& Cursor)
+{
+	UArticyGlobalVariables* Variables = GVs.Get();
+	if (!Variables || !Database.IsValid())
+		return;
+
+	SetRecording(false);
+
+	//the new oldest checkpoint does not need the values of the dropped one
+	if (NumCheckpoints == Ring.Num())
+	{
+		Head = (Head + 1) % Ring.Num();
+		--NumCheckpoints;
+		if (NumCheckpoints > 0)
+			Get(0).GvUndo = FArticyGvDelta();
+	}
+
+	FCheckpoint& Checkpoint = Get(NumCheckpoints);
+	Checkpoint.Cursor = Cursor;
+	Checkpoint.ObjectUndo.Reset();
+	if (NumCheckpoints == 0)
+	{
+		Checkpoint.GvUndo = FArticyGvDelta();
+		Variables->CaptureState(NewestState);
+	}
+	else
+	{
+		Variables->UpdateState(NewestState, Checkpoint.GvUndo);
+	}
+
+	++NumCheckpoints;
+	SetRecording(true);
+}
+
+/**
+ * Restores the state of a checkpoint. The undo logs are applied from the newest one back to the one of the
+ * checkpoint, and the variables of the checkpoint are rebuilt from the ones of the newest checkpoint by applying
+ * the deltas in the same order, so only what changed since is set.
+ * The checkpoint before becomes the newest one, with its undo log recording again.
+ * @param CheckpointIndex The checkpoint, 0 for the oldest one.
+ * @param OutCursor Receives the node the flow player was at.
+ * @return false if there is no such checkpoint or a shadow state is active.
+ */
+bool FArticyFlowCheckpoints::RewindTo(int32 CheckpointIndex, FArticyId& OutCursor)
+{
+	UArticyDatabase* DB = Database.Get();
+	UArticyGlobalVariables* Variables = GVs.Get();
+	if (!DB || !Variables || CheckpointIndex < 0 || CheckpointIndex >= NumCheckpoints)
+		return false;
+
+	if (DB->GetShadowLevel() > 0 || Variables->GetShadowLevel() > 0)
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("Cannot rewind the flow while a shadow state is active."));
+		return false;
+	}
+
+	SetRecording(false);
+
+	for (int32 Index = NumCheckpoints - 1; Index >= CheckpointIndex; --Index)
+	{
+		DB->ApplyObjectUndoLog(Get(Index).ObjectUndo);
+		Get(Index).ObjectUndo.Reset();
+
+		if (Index > CheckpointIndex)
+			NewestState.Apply(Get(Index).GvUndo);
+	}
+
+	Variables->RestoreState(NewestState);
+	OutCursor = Get(CheckpointIndex).Cursor;
+
+	//the state of the checkpoint before is the one the next Record compares with
+	if (CheckpointIndex > 0)
+		NewestState.Apply(Get(CheckpointIndex).GvUndo);
+	Get(CheckpointIndex).GvUndo = FArticyGvDelta();
+
+	NumCheckpoints = CheckpointIndex;
+	if (NumCheckpoints > 0)
+		SetRecording(true);
+
+	return true;
+}
+
+/**
+ * Drops all checkpoints and stops recording the objects.
+ */
+void FArticyFlowCheckpoints::Reset()
+{
+	SetRecording(false);
+
+	for (FCheckpoint& Checkpoint : Ring)
+	{
+		Checkpoint.GvUndo = FArticyGvDelta();
+		Checkpoint.ObjectUndo.Reset();
+	}
+
+	Head = 0;
+	NumCheckpoints = 0;
+	NewestState = FArticyGvState();
+}
+
+/**
+ * Returns the node the flow player was at when a checkpoint was recorded.
+ * @param CheckpointIndex The checkpoint, 0 for the oldest one.
+ * @return The id of the node, or an invalid id if there is no such checkpoint.
+ */
+FArticyId FArticyFlowCheckpoints::GetCursor(int32 CheckpointIndex) const
+{
+	return CheckpointIndex >= 0 && CheckpointIndex < NumCheckpoints ? Get(CheckpointIndex).Cursor : FArticyId();
+}
+
+/**
+ * Returns the memory held by the checkpoints.
+ * @return The size of the ring buffer, the deltas, the undo logs and the variables of the newest checkpoint, in bytes.
+ */
+SIZE_T FArticyFlowCheckpoints::GetAllocatedSize() const
+{
+	SIZE_T Size = Ring.GetAllocatedSize() + NewestState.GetAllocatedSize();
+	for (int32 Index = 0; Index < NumCheckpoints; ++Index)
+		Size += Get(Index).GvUndo.GetAllocatedSize() + Get(Index).ObjectUndo.GetAllocatedSize();
+
+	return Size;
+}
+
+/**
+ * Registers the undo log of the newest checkpoint with the database, or unregisters it.
+ * @param bInRecording Whether the log records the changes of the objects.
+ */
+void FArticyFlowCheckpoints::SetRecording(bool bInRecording)
+{
+	if (bRecording == bInRecording)
+		return;
+
+	bRecording = bInRecording;
+	if (UArticyDatabase* DB = Database.Get())
+	{
+		FArticyObjectUndoLog* Log = &Get(NumCheckpoints - 1).ObjectUndo;
+		if (bRecording)
+			DB->AddObjectUndoLog(Log);
+		else
+			DB->RemoveObjectUndoLog(Log);
+	}
+}
@@ -7,40 +7,42 @@
 /**
  * Retrieves the target object of the jump.
  *
- * This function will return the target object if it has been resolved,
- * otherwise, it will attempt to resolve it from the Articy database.
+ * This function will return the linked target object, which is the copy of the current shadow state,
+ * otherwise (if the jump is not linked yet), it will look it up in the Articy database.
  *
  * @return Pointer to the target UArticyPrimitive object.
  */
 UArticyPrimitive* UArticyJump::GetTarget() const
 {
-    if (!TargetObj)
-    {
-        auto db = UArticyDatabase::Get(this);
-        TargetObj = db ? db->GetObject(Target) : nullptr;
-    }
+    if (auto linked = TargetLink.GetTarget())
+        return linked;
 
-    return TargetObj;
+    auto db = UArticyDatabase::Get(this);
+    return db ? db->GetObject(Target) : nullptr;
 }
 
 /**
  * Retrieves the target pin of the jump.
  *
- * This function will return the target pin object if it has been resolved,
- * otherwise, it will attempt to resolve it from the target object.
+ * This function will return the linked target pin if it belongs to the current target object,
+ * otherwise, it will look it up in the subobjects of the target object.
  *
  * @return Pointer to the target UArticyFlowPin object.
  */
 UArticyFlowPin* UArticyJump::GetTargetPin() const
 {
-    if (!TargetPinObj)
-    {
-        auto target = GetTarget();
-        if (target)
-            TargetPinObj = Cast<UArticyFlowPin>(target->GetSubobject(TargetPin));
-    }
+    return TargetLink.GetPin(GetTarget(), TargetPin);
+}
 
-    return TargetPinObj;
+/**
+ * Links the target and the target pin, in addition to the references of the node.
+ *
+ * @param Database The database the jump is loaded into, or nullptr to unlink the references.
+ */
+void UArticyJump::LinkReferences(const UArticyDatabase* Database)
+{
+    Super::LinkReferences(Database);
+    TargetLink.Link(Database, Target, TargetPin);
 }
 
 /**
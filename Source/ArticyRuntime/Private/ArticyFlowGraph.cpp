@@ -0,0 +1,578 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyFlowGraph.h"
+#include "ArticyDatabase.h"
+#include "ArticyExpressoScripts.h"
+#include "ArticyFlowClasses.h"
+#include "ArticyPins.h"
+#include "ArticyScriptFragment.h"
+#include "ArticyBuiltinTypes.h"
+#include "Interfaces/ArticyFlowObject.h"
+#include "Interfaces/ArticyNode.h"
+#include "Interfaces/ArticyObjectWithSpeaker.h"
+
+/**
+ * Builds the graph from the unshadowed objects of a database.
+ * Nodes and their pins are added first, then the connections and jump targets are resolved by id.
+ * @param Database The database to build the graph from.
+ */
+void FArticyFlowGraph::Build(const UArticyDatabase* Database)
+{
+	Nodes.Reset();
+	Links.Reset();
+	IndexById.Reset();
+
+	if (!Database)
+		return;
+
+	TArray<int32> PinIndices;
+
+	auto AddPin = [&](UArticyFlowPin* Pin, int32 OwnerIndex, EArticyFlowGraphNodeKind Kind)
+	{
+		const int32 Index = Nodes.AddDefaulted();
+		FArticyFlowGraphNode& PinNode = Nodes[Index];
+		PinNode.Object = Pin;
+		PinNode.FlowObject = Pin->GetCapability<IArticyFlowObject>();
+		PinNode.Container = Nodes[OwnerIndex].Container;
+		PinNode.Kind = Kind;
+		PinNode.PauseMask = static_cast<uint8>(1 << static_cast<uint8>(Pin->GetType()));
+		PinNode.bHasSpeaker = Nodes[OwnerIndex].bHasSpeaker;
+		PinNode.bHasScript = true;
+		PinNode.ScriptHash = Pin->GetScriptHash();
+		PinNode.Owner = OwnerIndex;
+
+		IndexById.Add(Pin->GetId(), Index);
+		return Index;
+	};
+
+	for (auto It = Database->CreateObjectOfClassIterator(UArticyNode::StaticClass(), 0, true); It; ++It)
+	{
+		UArticyNode* ArticyNode = Cast<UArticyNode>(*It);
+		if (!ArticyNode)
+			continue;
+
+		const int32 NodeIndex = Nodes.AddDefaulted();
+		{
+			FArticyFlowGraphNode& Node = Nodes[NodeIndex];
+			Node.Object = ArticyNode;
+			Node.FlowObject = ArticyNode->GetCapability<IArticyFlowObject>();
+			FArticyCloneableObject* const* Container = Database->LoadedObjectsById.Find(ArticyNode->GetId());
+			Node.Container = Container ? *Container : nullptr;
+			Node.PauseMask = static_cast<uint8>(1 << static_cast<uint8>(ArticyNode->GetType()));
+			Node.bHasSpeaker = ArticyNode->GetCapabilities().Has(EArticyCapability::ObjectWithSpeaker);
+		}
+		IndexById.Add(ArticyNode->GetId(), NodeIndex);
+
+		//input pins
+		PinIndices.Reset();
+		if (const TArray<UArticyInputPin*>* InputPins = ArticyNode->GetInputPinsPtr())
+		{
+			for (UArticyInputPin* Pin : *InputPins)
+			{
+				if (Pin)
+					PinIndices.Add(AddPin(Pin, NodeIndex, EArticyFlowGraphNodeKind::InputPin));
+			}
+		}
+		Nodes[NodeIndex].FirstInput = Links.Num();
+		Nodes[NodeIndex].NumInputs = PinIndices.Num();
+		Links.Append(PinIndices);
+
+		//output pins
+		PinIndices.Reset();
+		if (const TArray<UArticyOutputPin*>* OutputPins = ArticyNode->GetOutputPinsPtr())
+		{
+			for (UArticyOutputPin* Pin : *OutputPins)
+			{
+				if (Pin)
+					PinIndices.Add(AddPin(Pin, NodeIndex, EArticyFlowGraphNodeKind::OutputPin));
+			}
+		}
+		Nodes[NodeIndex].FirstOutput = Links.Num();
+		Nodes[NodeIndex].NumOutputs = PinIndices.Num();
+		Links.Append(PinIndices);
+
+		//the kind and script of the node
+		FArticyFlowGraphNode& Node = Nodes[NodeIndex];
+		if (UArticyCondition* Condition = Cast<UArticyCondition>(ArticyNode))
+		{
+			//conditions without exactly two output pins continue on their output pins
+			if (Node.NumOutputs == 2)
+			{
+				Node.Kind = EArticyFlowGraphNodeKind::Condition;
+				if (UArticyScriptCondition* Script = Condition->GetCondition())
+				{
+					Node.bHasScript = true;
+					Node.ScriptHash = Script->GetExpressionHash();
+				}
+			}
+		}
+		else if (UArticyInstruction* Instruction = Cast<UArticyInstruction>(ArticyNode))
+		{
+			Node.Kind = EArticyFlowGraphNodeKind::Instruction;
+			if (UArticyScriptInstruction* Script = Instruction->GetInstruction())
+			{
+				Node.bHasScript = true;
+				Node.ScriptHash = Script->GetExpressionHash();
+			}
+		}
+		else if (Cast<UArticyJump>(ArticyNode))
+		{
+			Node.Kind = EArticyFlowGraphNodeKind::Jump;
+		}
+	}
+
+	//resolve connections and jump targets, now that all pins have an index
+	const UArticyExpressoScripts* ExpressoScripts = Database->GetExpressoInstance();
+	for (FArticyFlowGraphNode& Node : Nodes)
+	{
+		Node.FirstTarget = Links.Num();
+
+		if (Node.Kind == EArticyFlowGraphNodeKind::Jump)
+		{
+			const int32* Target = IndexById.Find(CastChecked<UArticyJump>(Node.Object)->GetTargetPinID());
+			if (Target)
+				Links.Add(*Target);
+		}
+		else if (Node.Kind == EArticyFlowGraphNodeKind::InputPin || Node.Kind == EArticyFlowGraphNodeKind::OutputPin)
+		{
+			for (UArticyOutgoingConnection* Connection : CastChecked<UArticyFlowPin>(Node.Object)->Connections)
+			{
+				const int32* Target = Connection ? IndexById.Find(Connection->GetTargetPinID()) : nullptr;
+				Links.Add(Target ? *Target : INDEX_NONE);
+			}
+		}
+
+		Node.NumTargets = Links.Num() - Node.FirstTarget;
+
+		//input pins and conditions are conditions, output pins and instructions are instructions
+		if (Node.bHasScript && ExpressoScripts)
+		{
+			const bool bCondition = Node.Kind == EArticyFlowGraphNodeKind::InputPin || Node.Kind == EArticyFlowGraphNodeKind::Condition;
+			Node.ScriptIndex = bCondition ? ExpressoScripts->GetConditionIndex(Node.ScriptHash) : ExpressoScripts->GetInstructionIndex(Node.ScriptHash);
+		}
+
+		//assign the seen counter slot up front, so parallel explorations do not need to
+		Node.Object->GetSeenCounterSlot();
+	}
+
+	Links.Shrink();
+
+	FindReadOnlySubgraphs(ExpressoScripts);
+	FindSkipAheadChains(ExpressoScripts);
+}
+
+/**
+ * Sets the pass children of the nodes which ExploreGraphTargets of the flow player continues on a single child
+ * without running a script, and the skip-aheads through the chains of them.
+ * Whether a node pauses depends on the flow player, so the pause masks of the skipped nodes are collected instead.
+ * @param ExpressoScripts The scripts of the database, may be null.
+ */
+void FArticyFlowGraph::FindSkipAheadChains(const UArticyExpressoScripts* ExpressoScripts)
+{
+	//scripts which are not part of the generated tables are only known to be empty by the base class
+	auto IsEmptyScript = [ExpressoScripts](const FArticyFlowGraphNode& Node)
+	{
+		const bool bInstruction = Node.Kind == EArticyFlowGraphNodeKind::OutputPin || Node.Kind == EArticyFlowGraphNodeKind::Instruction;
+		return !Node.bHasScript || (Node.ScriptIndex == INDEX_NONE && ExpressoScripts
+			&& ExpressoScripts->GetScriptAccess(INDEX_NONE, Node.ScriptHash, bInstruction).Flags == EArticyScriptAccess::None);
+	};
+
+	for (FArticyFlowGraphNode& Node : Nodes)
+	{
+		switch (Node.Kind)
+		{
+		case EArticyFlowGraphNodeKind::Jump:
+			if (Node.NumTargets == 1)
+				Node.PassChild = Links[Node.FirstTarget];
+			Node.PassDepth = 2;
+			break;
+
+		case EArticyFlowGraphNodeKind::OutputPin:
+			if (Node.NumTargets == 1 && IsEmptyScript(Node))
+				Node.PassChild = Links[Node.FirstTarget];
+			Node.PassDepth = 2;
+			break;
+
+		//input pins with connections submerge, or continue with their owner depending on the depth
+		case EArticyFlowGraphNodeKind::InputPin:
+			if (Node.NumTargets == 0 && IsEmptyScript(Node))
+				Node.PassChild = Node.Owner;
+			Node.PassDepth = 2;
+			break;
+
+		case EArticyFlowGraphNodeKind::Condition:
+			if (!Node.bHasScript)
+				Node.PassChild = Links[Node.FirstOutput];
+			Node.PassDepth = 2;
+			break;
+
+		case EArticyFlowGraphNodeKind::Instruction:
+		case EArticyFlowGraphNodeKind::Node:
+			if (Node.NumOutputs == 1 && IsEmptyScript(Node))
+				Node.PassChild = Links[Node.FirstOutput];
+			Node.PassDepth = 3;
+			break;
+		}
+	}
+
+	//follow the chain of each node up to a node whose skip-ahead is known, then set it for the chain backwards
+	enum class EState : uint8 { Unknown, Visiting, Done };
+	TArray<EState> States;
+	States.SetNumZeroed(Nodes.Num());
+	TArray<int32> Chain;
+	for (int32 Start = 0; Start < Nodes.Num(); ++Start)
+	{
+		Chain.Reset();
+		int32 Index = Start;
+		while (Index != INDEX_NONE && Nodes[Index].PassChild != INDEX_NONE && States[Index] == EState::Unknown)
+		{
+			States[Index] = EState::Visiting;
+			Chain.Add(Index);
+			Index = Nodes[Index].PassChild;
+		}
+
+		//a chain running into itself, or into a chain which loops, is never skipped
+		const bool bLoops = Index != INDEX_NONE && (States[Index] == EState::Visiting
+			|| (States[Index] == EState::Done && Nodes[Index].PassChild != INDEX_NONE && Nodes[Index].NumSkipped == 0 && Nodes[Index].SkipTarget == INDEX_NONE));
+
+		for (int32 i = Chain.Num() - 1; i >= 0; --i)
+		{
+			FArticyFlowGraphNode& Node = Nodes[Chain[i]];
+			States[Chain[i]] = EState::Done;
+			if (bLoops)
+				continue;
+
+			const FArticyFlowGraphNode& Child = Nodes[Node.PassChild];
+			if (Child.PassChild == INDEX_NONE)
+			{
+				//the chain ends at the child, it is explored as usual
+				Node.SkipTarget = Node.PassChild;
+				Node.SkipDepth = Node.PassDepth;
+			}
+			else
+			{
+				Node.SkipTarget = Child.SkipTarget;
+				Node.NumSkipped = Child.NumSkipped + 1;
+				Node.SkipDepth = Node.PassDepth + Child.SkipDepth;
+				Node.SkipPauseMask = Child.PauseMask | Child.SkipPauseMask;
+			}
+		}
+	}
+}
+
+/**
+ * Sets bReadOnly of the nodes from which no script that may change state can be reached, by following the edges
+ * ExploreGraphTargets of the flow player follows backwards, starting at the nodes whose own script may change state.
+ * bMayWriteObjects is set the same way, starting at the nodes whose own script may write objects.
+ * Pauses are ignored, so a node may be marked as writing although the exploration stops before any script writes.
+ * @param ExpressoScripts The scripts of the database, may be null.
+ */
+void FArticyFlowGraph::FindReadOnlySubgraphs(const UArticyExpressoScripts* ExpressoScripts)
+{
+	//the children the flow player explores a node with
+	auto ForEachChild = [this](const FArticyFlowGraphNode& Node, auto&& Visit)
+	{
+		if (Node.Kind == EArticyFlowGraphNodeKind::InputPin || Node.Kind == EArticyFlowGraphNodeKind::OutputPin || Node.Kind == EArticyFlowGraphNodeKind::Jump)
+		{
+			for (const int32 Target : GetTargets(Node))
+			{
+				if (Target != INDEX_NONE)
+					Visit(Target);
+			}
+			if (Node.Kind == EArticyFlowGraphNodeKind::InputPin)
+				Visit(Node.Owner);
+		}
+		else
+		{
+			for (const int32 Output : GetOutputs(Node))
+				Visit(Output);
+		}
+	};
+
+	//the parents of each node, as ranges of an array
+	TArray<int32> FirstParent, Parents;
+	FirstParent.SetNumZeroed(Nodes.Num() + 1);
+	for (const FArticyFlowGraphNode& Node : Nodes)
+		ForEachChild(Node, [&](int32 Child) { ++FirstParent[Child + 1]; });
+	for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+		FirstParent[Index + 1] += FirstParent[Index];
+
+	Parents.SetNumUninitialized(FirstParent[Nodes.Num()]);
+	TArray<int32> NumParents;
+	NumParents.SetNumZeroed(Nodes.Num());
+	for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+		ForEachChild(Nodes[Index], [&](int32 Child) { Parents[FirstParent[Child] + NumParents[Child]++] = Index; });
+
+	//input pins and conditions are conditions, output pins and instructions are instructions
+	//the accesses don't tell object reads from writes, so a script which may change state and accesses objects at all
+	//is taken to write them
+	const EArticyScriptAccess ObjectAccess = EArticyScriptAccess::ObjectProperties | EArticyScriptAccess::SeenCounters
+		| EArticyScriptAccess::UserMethods | EArticyScriptAccess::Unknown;
+	TArray<int32> Writing, WritingObjects;
+	for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+	{
+		FArticyFlowGraphNode& Node = Nodes[Index];
+		const bool bInstruction = Node.Kind == EArticyFlowGraphNodeKind::OutputPin || Node.Kind == EArticyFlowGraphNodeKind::Instruction;
+		const bool bWritesState = Node.bHasScript && (!ExpressoScripts || ExpressoScripts->ScriptWritesState(Node.ScriptIndex, Node.ScriptHash, bInstruction));
+		const bool bWritesObjects = bWritesState
+			&& (!ExpressoScripts || EnumHasAnyFlags(ExpressoScripts->GetScriptAccess(Node.ScriptIndex, Node.ScriptHash, bInstruction).Flags, ObjectAccess));
+
+		Node.bReadOnly = !bWritesState;
+		Node.bMayWriteObjects = bWritesObjects;
+		if (bWritesState)
+			Writing.Add(Index);
+		if (bWritesObjects)
+			WritingObjects.Add(Index);
+	}
+
+	//everything a marked node can be reached from is marked as well
+	auto MarkParents = [&](TArray<int32>& Marked, auto&& Mark)
+	{
+		for (int32 Next = 0; Next < Marked.Num(); ++Next)
+		{
+			const int32 Index = Marked[Next];
+			for (int32 Parent = FirstParent[Index]; Parent < FirstParent[Index + 1]; ++Parent)
+			{
+				if (Mark(Nodes[Parents[Parent]]))
+					Marked.Add(Parents[Parent]);
+			}
+		}
+	};
+
+	MarkParents(Writing, [](FArticyFlowGraphNode& Node)
+	{
+		const bool bWasReadOnly = Node.bReadOnly;
+		Node.bReadOnly = false;
+		return bWasReadOnly;
+	});
+	MarkParents(WritingObjects, [](FArticyFlowGraphNode& Node)
+	{
+		const bool bWasMarked = Node.bMayWriteObjects;
+		Node.bMayWriteObjects = true;
+		return !bWasMarked;
+	});
+}
+
+/**
+ * Saves the graph with the ids of its objects, which LoadImage resolves again.
+ * @param Database The database the graph was built from.
+ * @param OutImage Receives the image.
+ */
+void FArticyFlowGraph::SaveImage(const UArticyDatabase* Database, FArticyFlowGraphImage& OutImage) const
+{
+	OutImage = FArticyFlowGraphImage();
+	if (!Database)
+		return;
+
+	OutImage.Packages = Database->LoadedPackages.Array();
+	OutImage.Packages.Sort();
+	OutImage.NumObjects = Database->LoadedObjectsById.Num();
+
+	const UArticyExpressoScripts* ExpressoScripts = Database->GetExpressoInstance();
+	OutImage.ExpressoScriptsClass = ExpressoScripts ? ExpressoScripts->GetClass()->GetPathName() : FString();
+
+	OutImage.Ids.Reserve(Nodes.Num());
+	OutImage.Nodes.Reserve(Nodes.Num());
+	for (const FArticyFlowGraphNode& Node : Nodes)
+	{
+		OutImage.Ids.Add(Node.Object->GetId());
+
+		FArticyFlowGraphNode& Saved = OutImage.Nodes.Add_GetRef(Node);
+		Saved.Object = nullptr;
+		Saved.FlowObject = nullptr;
+		Saved.Container = nullptr;
+	}
+	OutImage.Links = Links;
+}
+
+/**
+ * Restores the graph from an image. The objects of the nodes are the unshadowed clone 0 of their containers, the pins
+ * are looked up in the pin lists of their owners, in the order Build added them.
+ * @param Database The database to restore the graph for.
+ * @param Image The image.
+ * @return False if the image does not match the database, the graph is then empty.
+ */
+bool FArticyFlowGraph::LoadImage(const UArticyDatabase* Database, const FArticyFlowGraphImage& Image)
+{
+	Nodes.Reset();
+	Links.Reset();
+	IndexById.Reset();
+
+	if (!Database || Image.Ids.Num() != Image.Nodes.Num() || Image.NumObjects != Database->LoadedObjectsById.Num()
+		|| Image.Packages.Num() != Database->LoadedPackages.Num())
+		return false;
+
+	for (const FString& Package : Image.Packages)
+	{
+		if (!Database->LoadedPackages.Contains(Package))
+			return false;
+	}
+
+	const UArticyExpressoScripts* ExpressoScripts = Database->GetExpressoInstance();
+	if (!ExpressoScripts || ExpressoScripts->GetClass()->GetPathName() != Image.ExpressoScriptsClass)
+		return false;
+
+	Nodes = Image.Nodes;
+	Links = Image.Links;
+	IndexById.Reserve(Nodes.Num());
+
+	//assigns the pins of an owner to their nodes, which follow the owner
+	auto ResolvePins = [&](const auto* Pins, int32 First, int32 Num)
+	{
+		int32 Link = First;
+		if (Pins)
+		{
+			for (UArticyFlowPin* Pin : *Pins)
+			{
+				if (!Pin)
+					continue;
+				if (Link >= First + Num || !Links.IsValidIndex(Link) || !Nodes.IsValidIndex(Links[Link]) || Image.Ids[Links[Link]] != Pin->GetId())
+					return false;
+				Nodes[Links[Link++]].Object = Pin;
+			}
+		}
+		return Link == First + Num;
+	};
+
+	bool bValid = true;
+	for (int32 Index = 0; bValid && Index < Nodes.Num(); ++Index)
+	{
+		FArticyFlowGraphNode& Node = Nodes[Index];
+		if (Node.Kind == EArticyFlowGraphNodeKind::InputPin || Node.Kind == EArticyFlowGraphNodeKind::OutputPin)
+		{
+			bValid = Node.Object && Nodes.IsValidIndex(Node.Owner) && Node.Owner < Index;
+			if (bValid)
+				Node.Container = Nodes[Node.Owner].Container;
+		}
+		else
+		{
+			FArticyCloneableObject* const* Container = Database->LoadedObjectsById.Find(Image.Ids[Index]);
+			Node.Container = Container ? *Container : nullptr;
+			UArticyNode* ArticyNode = Cast<UArticyNode>(Node.Container ? Node.Container->Get(Database, 0, true) : nullptr);
+			Node.Object = ArticyNode;
+			bValid = ArticyNode
+				&& ResolvePins(ArticyNode->GetInputPinsPtr(), Node.FirstInput, Node.NumInputs)
+				&& ResolvePins(ArticyNode->GetOutputPinsPtr(), Node.FirstOutput, Node.NumOutputs);
+		}
+
+		if (bValid)
+		{
+			Node.FlowObject = Node.Object->GetCapability<IArticyFlowObject>();
+			IndexById.Add(Image.Ids[Index], Index);
+
+			//assign the seen counter slot up front, so parallel explorations do not need to
+			Node.Object->GetSeenCounterSlot();
+		}
+	}
+
+	if (!bValid)
+	{
+		Nodes.Reset();
+		Links.Reset();
+		IndexById.Reset();
+	}
+	return bValid;
+}
+
+/**
+ * Points the node of an object and its pins at the current clone 0 of the object. The pins of the new object are
+ * matched to the pin nodes by id, the previous objects of the nodes may already be gone.
+ * @param Database The database the graph was built from.
+ * @param Id The id of the object.
+ * @return False if the pins of the object don't match the graph anymore.
+ */
+bool FArticyFlowGraph::UpdateObject(const UArticyDatabase* Database, const FArticyId& Id)
+{
+	const int32* Index = IndexById.Find(Id);
+	if (!Index)
+		return true;
+
+	FArticyFlowGraphNode& Node = Nodes[*Index];
+	UArticyNode* ArticyNode = Cast<UArticyNode>(Node.Container ? Node.Container->Get(Database, 0, true) : nullptr);
+	if (!ArticyNode)
+		return false;
+
+	Node.Object = ArticyNode;
+	Node.FlowObject = ArticyNode->GetCapability<IArticyFlowObject>();
+	ArticyNode->GetSeenCounterSlot();
+
+	auto UpdatePins = [&](const auto* Pins, int32 First, int32 Num)
+	{
+		int32 Link = First;
+		if (Pins)
+		{
+			for (UArticyFlowPin* Pin : *Pins)
+			{
+				if (!Pin)
+					continue;
+				const int32* PinIndex = IndexById.Find(Pin->GetId());
+				if (Link >= First + Num || !PinIndex || *PinIndex != Links[Link++])
+					return false;
+
+				FArticyFlowGraphNode& PinNode = Nodes[*PinIndex];
+				PinNode.Object = Pin;
+				PinNode.FlowObject = Pin->GetCapability<IArticyFlowObject>();
+				Pin->GetSeenCounterSlot();
+			}
+		}
+		return Link == First + Num;
+	};
+
+	return UpdatePins(ArticyNode->GetInputPinsPtr(), Node.FirstInput, Node.NumInputs)
+		&& UpdatePins(ArticyNode->GetOutputPinsPtr(), Node.FirstOutput, Node.NumOutputs);
+}
+
+/**
+ * Serializes a flow graph image, the object pointers of the nodes are not part of it.
+ * @param Ar The archive.
+ * @param Image The image.
+ * @return The archive.
+ */
+FArchive& operator<<(FArchive& Ar, FArticyFlowGraphImage& Image)
+{
+	Ar << Image.Packages;
+	Ar << Image.NumObjects;
+	Ar << Image.ExpressoScriptsClass;
+
+	int32 NumNodes = Image.Nodes.Num();
+	Ar << NumNodes;
+	if (Ar.IsLoading())
+	{
+		Image.Ids.SetNum(NumNodes);
+		Image.Nodes.SetNum(NumNodes);
+	}
+
+	for (int32 Index = 0; Index < NumNodes && !Ar.IsError(); ++Index)
+	{
+		Ar << Image.Ids[Index].Low << Image.Ids[Index].High;
+
+		FArticyFlowGraphNode& Node = Image.Nodes[Index];
+		uint8 Kind = static_cast<uint8>(Node.Kind);
+		Ar << Kind;
+		Node.Kind = static_cast<EArticyFlowGraphNodeKind>(Kind);
+		Ar << Node.PauseMask << Node.bHasSpeaker << Node.bHasScript << Node.ScriptHash << Node.ScriptIndex;
+		Ar << Node.FirstInput << Node.NumInputs << Node.FirstOutput << Node.NumOutputs << Node.FirstTarget << Node.NumTargets;
+		Ar << Node.Owner << Node.bReadOnly << Node.bMayWriteObjects << Node.PassChild << Node.PassDepth;
+		Ar << Node.SkipTarget << Node.NumSkipped << Node.SkipDepth << Node.SkipPauseMask;
+	}
+
+	Ar << Image.Links;
+	return Ar;
+}
+
+/**
+ * Finds the node of an object.
+ * @param Object A flow node or pin.
+ * @return The index of the node, or INDEX_NONE if the object is not part of the graph.
+ */
+int32 FArticyFlowGraph::FindNode(const UArticyPrimitive* Object) const
+{
+	if (!Object)
+		return INDEX_NONE;
+
+	//clones and stale copies of an object are not part of the graph
+	const int32* Index = IndexById.Find(Object->GetId());
+	return Index && Nodes[*Index].Object == Object ? *Index : INDEX_NONE;
+}
@@ -3,14 +3,52 @@
 //
 
 #include "ArticyFlowPlayer.h"
+#include "ArticyFlowPlayerSubsystem.h"
 #include "ArticyRuntimeModule.h"
 #include "Interfaces/ArticyFlowObject.h"
 #include "Interfaces/ArticyObjectWithSpeaker.h"
+#include "Interfaces/ArticyObjectWithPreviewImage.h"
+#include "Interfaces/ArticyObjectWithText.h"
+#include "Interfaces/ArticyObjectWithMenuText.h"
+#include "ArticyBuiltinTypes.h"
+#include "ArticyPins.h"
+#include "ArticyAsset.h"
 #include "ArticyExpressoScripts.h"
 #include "UObject/ConstructorHelpers.h"
 #include "Interfaces/ArticyInputPinsProvider.h"
 #include "Interfaces/ArticyOutputPinsProvider.h"
+#include "ArticyFlowGraph.h"
+#include "ArticyFlowReplay.h"
+#include "ArticyFlowCheckpoints.h"
+#include "ArticyFlowRecorder.h"
 #include "Engine/Texture2D.h"
+#include "HAL/PlatformTime.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "Net/UnrealNetwork.h"
+
+namespace
+{
+    TAutoConsoleVariable<int32> CVarSharedExplorationCacheSize(
+        TEXT("Articy.SharedExplorationCacheSize"),
+        64,
+        TEXT("The maximum number of exploration results shared by the flow players using bShareExplorationCache."));
+
+    /** Writes or reads an id as two packed ints, the high part of the ids of a project is mostly the same small value. */
+    void SerializeIdPacked(FArchive& Ar, FArticyId& Id)
+    {
+        uint32 low = static_cast<uint32>(Id.Low);
+        uint32 high = static_cast<uint32>(Id.High);
+        Ar.SerializeIntPacked(low);
+        Ar.SerializeIntPacked(high);
+        Id.Low = static_cast<int32>(low);
+        Id.High = static_cast<int32>(high);
+    }
+}
+
+TArray<UArticyFlowPlayer::FCachedExploration> UArticyFlowPlayer::SharedExplorationCache;
+FCriticalSection UArticyFlowPlayer::SharedExplorationLock;
 
 /**
  * Retrieves the target of this branch.
@@ -22,6 +60,53 @@ TScriptInterface<IArticyFlowObject> FArticyBranch::GetTarget() const
     return Path.Num() > 0 ? Path.Last() : nullptr;
 }
 
+/**
+ * Serializes the replicated flow state: the version, the cursor and the chosen branch, followed by the number of
+ * available branches, their validity bits and their targets.
+ *
+ * @param Ar The archive to write to or read from.
+ * @param Map Unused, the state holds ids only.
+ * @param bOutSuccess Set to false if the archive was corrupt.
+ * @return True, the state is always serialized.
+ */
+bool FArticyFlowReplicationState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+    Ar.SerializeIntPacked(Version);
+    SerializeIdPacked(Ar, Cursor);
+
+    //offset by one, so INDEX_NONE is a single byte
+    uint32 chosen = static_cast<uint32>(ChosenBranch + 1);
+    Ar.SerializeIntPacked(chosen);
+    ChosenBranch = static_cast<int32>(chosen) - 1;
+
+    uint32 numTargets = Targets.Num();
+    Ar.SerializeIntPacked(numTargets);
+    if (Ar.IsLoading())
+    {
+        //far more branches than a node has, so a corrupt count does not allocate
+        if (numTargets > 1024)
+        {
+            Ar.SetError();
+            bOutSuccess = false;
+            return true;
+        }
+        Targets.SetNum(numTargets);
+        ValidBits.Init(false, numTargets);
+    }
+
+    for (uint32 i = 0; i < numTargets; ++i)
+    {
+        uint8 bit = ValidBits[i] ? 1 : 0;
+        Ar.SerializeBits(&bit, 1);
+        ValidBits[i] = bit != 0;
+    }
+    for (FArticyId& target : Targets)
+        SerializeIdPacked(Ar, target);
+
+    bOutSuccess = !Ar.IsError();
+    return true;
+}
+
 /**
  * Called when the game starts or when spawned.
  */
@@ -29,11 +114,25 @@ void UArticyFlowPlayer::BeginPlay()
 {
     Super::BeginPlay();
 
+    //resolve the methods provider once, the components it is searched in are set up by now
+    InvalidateMethodsProvider();
+    GetMethodsProvider();
+
+    //the scheduler ticks the player while it has branches to traverse, registered before the cursor is set
+    //so the branches the start node fast-forwards to are traversed as well
+    if (auto* scheduler = UArticyFlowPlayerSubsystem::Get(this))
+        scheduler->Register(this);
+
+    //the server replicates the flow, the clients receive their cursor from it
+    if (bReplicateFlow)
+    {
+        if (IsReplicatedClient())
+            return;
+        SetIsReplicated(true);
+    }
+
     //update Cursor to object referenced by StartOn
     SetCursorToStartNode();
-
-    TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
-        FTickerDelegate::CreateUObject(this, &UArticyFlowPlayer::OnTick), 0.0f);
 }
 
 /**
@@ -41,10 +140,30 @@ void UArticyFlowPlayer::BeginPlay()
  */
 void UArticyFlowPlayer::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    if (auto* scheduler = UArticyFlowPlayerSubsystem::Get(this))
+        scheduler->Unregister(this);
+
+    if (PinnedDatabase.IsValid() && !PinnedPackage.IsEmpty())
+        PinnedDatabase->UnpinPackage(PinnedPackage);
+    PinnedPackage.Reset();
+    PinnedDatabase.Reset();
+
+    //stops recording the objects into the undo log of the last checkpoint
+    Checkpoints.Reset();
+
     Super::EndPlay(EndPlayReason);
 }
 
+/**
+ * Registers the replicated flow state, which is only replicated if bReplicateFlow made the component replicated.
+ */
+void UArticyFlowPlayer::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    DOREPLIFETIME(UArticyFlowPlayer, ReplicatedFlowState);
+}
+
 //---------------------------------------------------------------------------//
 
 /**
@@ -94,7 +213,18 @@ void UArticyFlowPlayer::SetCursorTo(TScriptInterface<IArticyFlowObject> Node)
         return;
     }
 
+    if (IsReplicatedClient())
+    {
+        if (const UArticyPrimitive* primitive = Cast<UArticyPrimitive>(Node.GetObject()))
+            ServerSetCursorTo(primitive->GetId());
+        return;
+    }
+
     Cursor = Node;
+    ReplicatedFlowState.ChosenBranch = INDEX_NONE;
+    if (Capture)
+        AddCaptureStep(Node, INDEX_NONE);
+
     UpdateAvailableBranchesInternal(true);
 }
 
@@ -105,34 +235,225 @@ void UArticyFlowPlayer::SetCursorTo(TScriptInterface<IArticyFlowObject> Node)
  */
 void UArticyFlowPlayer::Play(int BranchIndex)
 {
-    static const TArray<FArticyBranch>* branchesPtr = &AvailableBranches;
+    //the server plays the branch and replicates the branches it leads to
+    if (IsReplicatedClient())
+    {
+        ServerPlay(BranchIndex);
+        return;
+    }
 
-    if (IgnoresInvalidBranches())
+    const int32 Index = GetPlayableBranchIndex(BranchIndex);
+    if (Index == INDEX_NONE)
     {
-        // Only create a new array if filtering is needed
-        static TArray<FArticyBranch> ValidBranches;
-        ValidBranches.Reset(); // Clear the array without reallocating memory
+        UE_LOG(LogArticyRuntime, Error, TEXT("Branch with index %d does not exist!"), BranchIndex);
+        return;
+    }
 
-        // Filter valid branches
-        for (const auto& branch : AvailableBranches)
-        {
-            if (branch.bIsValid)
-            {
-                ValidBranches.Add(branch);
-            }
-        }
+    if (Capture)
+        AddCaptureStep(AvailableBranches[Index].GetTarget(), BranchIndex);
+
+    if (MaxCheckpoints > 0)
+        RecordCheckpoint();
+
+    ReplicatedFlowState.ChosenBranch = BranchIndex;
+    PlayBranch(AvailableBranches[Index]);
+}
+
+/**
+ * Records a checkpoint with the state before the branch Play is about to queue.
+ */
+void UArticyFlowPlayer::RecordCheckpoint()
+{
+    UArticyDatabase* db = GetDB();
+    UArticyGlobalVariables* gvs = GetGVs();
+    if (!db || !gvs)
+        return;
+
+    if (!Checkpoints || !Checkpoints->Matches(db, gvs, MaxCheckpoints))
+        Checkpoints = MakeShared<FArticyFlowCheckpoints>(db, gvs, MaxCheckpoints);
 
-        branchesPtr = &ValidBranches;
+    const UArticyPrimitive* cursor = Cast<UArticyPrimitive>(Cursor.GetObject());
+    Checkpoints->Record(cursor ? cursor->GetId() : FArticyId());
+}
+
+/**
+ * Restores the state of a checkpoint and sets the cursor to the node the player was at.
+ * The branches queued by Play but not traversed yet are dropped.
+ *
+ * @param CheckpointIndex The checkpoint, 0 for the oldest one.
+ * @return True if the checkpoint was restored.
+ */
+bool UArticyFlowPlayer::RewindTo(int32 CheckpointIndex)
+{
+    if (IsReplicatedClient())
+    {
+        UE_LOG(LogArticyRuntime, Warning, TEXT("A replicated flow can only be rewound on the server."));
+        return false;
     }
 
-    // Use branchesPtr instead of branches
-    if (!branchesPtr->IsValidIndex(BranchIndex))
+    if (!Checkpoints || CheckpointIndex < 0 || CheckpointIndex >= Checkpoints->Num())
     {
-        UE_LOG(LogArticyRuntime, Error, TEXT("Branch with index %d does not exist!"), BranchIndex);
+        UE_LOG(LogArticyRuntime, Error, TEXT("Checkpoint with index %d does not exist!"), CheckpointIndex);
+        return false;
+    }
+
+    FArticyId cursorId;
+    if (!Checkpoints->RewindTo(CheckpointIndex, cursorId))
+        return false;
+
+    BranchQueue.Empty();
+
+    UArticyDatabase* db = GetDB();
+    SetCursorTo(TScriptInterface<IArticyFlowObject>(db ? db->GetObject(cursorId) : nullptr));
+    return true;
+}
+
+/**
+ * Returns the number of checkpoints.
+ *
+ * @return The number of checkpoints RewindTo can restore.
+ */
+int32 UArticyFlowPlayer::GetNumCheckpoints() const
+{
+    return Checkpoints ? Checkpoints->Num() : 0;
+}
+
+/**
+ * Drops all checkpoints and stops recording the objects.
+ */
+void UArticyFlowPlayer::ClearCheckpoints()
+{
+    Checkpoints.Reset();
+}
+
+/**
+ * Plays a branch on the server, as requested by a client through Play.
+ *
+ * @param BranchIndex The index of the branch, as passed to Play.
+ */
+void UArticyFlowPlayer::ServerPlay_Implementation(int32 BranchIndex)
+{
+    Play(BranchIndex);
+}
+
+/**
+ * Sets the cursor on the server, as requested by a client through SetCursorTo.
+ *
+ * @param NodeId The id of the node.
+ */
+void UArticyFlowPlayer::ServerSetCursorTo_Implementation(FArticyId NodeId)
+{
+    UArticyDatabase* db = GetDB();
+    SetCursorTo(TScriptInterface<IArticyFlowObject>(db ? db->GetObject(NodeId) : nullptr));
+}
+
+/**
+ * Checks whether this player is the client of a flow the server replicates (see bReplicateFlow).
+ *
+ * @return True if the player must not explore, but waits for the replicated state.
+ */
+bool UArticyFlowPlayer::IsReplicatedClient() const
+{
+    return bReplicateFlow && GetNetMode() == NM_Client;
+}
+
+/**
+ * Writes the cursor and the targets and validity of the available branches to the replicated state.
+ */
+void UArticyFlowPlayer::UpdateReplicatedFlowState()
+{
+    const UArticyPrimitive* cursor = Cast<UArticyPrimitive>(Cursor.GetObject());
+    ReplicatedFlowState.Cursor = cursor ? cursor->GetId() : FArticyId();
+
+    ReplicatedFlowState.Targets.Reset(AvailableBranches.Num());
+    ReplicatedFlowState.ValidBits.Reset();
+    for (const FArticyBranch& branch : AvailableBranches)
+    {
+        const UArticyPrimitive* target = Cast<UArticyPrimitive>(branch.GetTarget().GetObject());
+        ReplicatedFlowState.Targets.Add(target ? target->GetId() : FArticyId());
+        ReplicatedFlowState.ValidBits.Add(branch.bIsValid);
+    }
+
+    ++ReplicatedFlowState.Version;
+}
+
+/**
+ * Applies the replicated state on a client: the cursor and the available branches are looked up in the database,
+ * each branch with its target as the only node of its path. Then they are broadcast like explored branches.
+ */
+void UArticyFlowPlayer::OnRep_FlowState()
+{
+    if (!IsReplicatedClient())
+        return;
+
+    UArticyDatabase* db = GetDB();
+    if (!db)
         return;
+
+    Cursor = TScriptInterface<IArticyFlowObject>(db->GetObject(ReplicatedFlowState.Cursor));
+    PinCursorPackage();
+
+    AvailableBranches.Reset(ReplicatedFlowState.Targets.Num());
+    for (int32 i = 0; i < ReplicatedFlowState.Targets.Num(); ++i)
+    {
+        FArticyBranch& branch = AvailableBranches.AddDefaulted_GetRef();
+        branch.Path.Add(TScriptInterface<IArticyFlowObject>(db->GetObject(ReplicatedFlowState.Targets[i])));
+        branch.bIsValid = ReplicatedFlowState.ValidBits.IsValidIndex(i) && ReplicatedFlowState.ValidBits[i];
+        branch.Index = i;
     }
 
-    PlayBranch((*branchesPtr)[BranchIndex]);
+    BroadcastAvailableBranches();
+}
+
+/**
+ * Maps the index of a branch as passed to Play to its index in AvailableBranches.
+ * If invalid branches are ignored, the index counts the valid branches only. The exploration skips them already then,
+ * so this only differs if bIgnoreInvalidBranches was changed since the branches were updated.
+ *
+ * @param Index The index passed to Play.
+ * @return The index in AvailableBranches, or INDEX_NONE.
+ */
+int32 UArticyFlowPlayer::GetPlayableBranchIndex(int32 Index) const
+{
+    if (Index < 0)
+        return INDEX_NONE;
+
+    if (!IgnoresInvalidBranches())
+        return AvailableBranches.IsValidIndex(Index) ? Index : INDEX_NONE;
+
+    for (int32 i = 0; i < AvailableBranches.Num(); ++i)
+    {
+        if (AvailableBranches[i].bIsValid && Index-- == 0)
+            return i;
+    }
+
+    return INDEX_NONE;
+}
+
+/**
+ * Gets the last node of an available branch.
+ *
+ * @param Index The index of the branch in AvailableBranches.
+ * @return The target of the branch, or nullptr if there is no branch with this index.
+ */
+TScriptInterface<IArticyFlowObject> UArticyFlowPlayer::GetBranchTarget(int32 Index) const
+{
+    return AvailableBranches.IsValidIndex(Index) ? AvailableBranches[Index].GetTarget() : nullptr;
+}
+
+/**
+ * Gets a node in the path of an available branch.
+ *
+ * @param Index The index of the branch in AvailableBranches.
+ * @param NodeIndex The index of the node in the path of the branch.
+ * @return The node, or nullptr if there is no such node.
+ */
+TScriptInterface<IArticyFlowObject> UArticyFlowPlayer::GetBranchPathNode(int32 Index, int32 NodeIndex) const
+{
+    if (!AvailableBranches.IsValidIndex(Index) || !AvailableBranches[Index].Path.IsValidIndex(NodeIndex))
+        return nullptr;
+
+    return AvailableBranches[Index].Path[NodeIndex];
 }
 
 /**
@@ -146,6 +467,7 @@ void UArticyFlowPlayer::FinishCurrentPausedObject(int PinIndex)
     if (outputPinOwner)
     {
         auto outputPins = outputPinOwner->GetOutputPinsPtr();
+        FArticyGvChangeBatch ChangeBatch(GetGVs());
 
         int numPins = outputPins->Num();
         if (numPins > 0 && PinIndex < numPins)
@@ -193,9 +515,25 @@ bool UArticyFlowPlayer::ShouldPauseOn(TScriptInterface<IArticyFlowObject> Node)
  */
 UArticyDatabase* UArticyFlowPlayer::GetDB() const
 {
+    if (ExploreContext.Database)
+        return ExploreContext.Database;
+
     return UArticyDatabase::Get(this);
 }
 
+/**
+ * Retrieves the expresso scripts instance explorations of this flow player use.
+ *
+ * @return The instance of the parallel exploration this player is part of, or the one of the database.
+ */
+UArticyExpressoScripts* UArticyFlowPlayer::GetExpressoInstance() const
+{
+    if (ExploreContext.ExpressoInstance)
+        return ExploreContext.ExpressoInstance;
+
+    return GetDB()->GetExpressoInstance();
+}
+
 /**
  * Retrieves the global variables used by this flow player.
  *
@@ -203,6 +541,9 @@ UArticyDatabase* UArticyFlowPlayer::GetDB() const
  */
 UArticyGlobalVariables* UArticyFlowPlayer::GetGVs() const
 {
+    if (ExploreContext.GVs)
+        return ExploreContext.GVs;
+
     // If we have an custom GV set, make sure we're using a runtime clone of it
     if (OverrideGV) {
         return UArticyGlobalVariables::GetRuntimeClone(this, OverrideGV);
@@ -214,11 +555,18 @@ UArticyGlobalVariables* UArticyFlowPlayer::GetGVs() const
 
 /**
  * Retrieves the user methods provider for this flow player.
+ * The provider is resolved once and cached, until UserMethodsProvider is changed or InvalidateMethodsProvider is called.
  *
  * @return A pointer to the methods provider object.
  */
 UObject* UArticyFlowPlayer::GetMethodsProvider()
 {
+    if (ExploreContext.Database)
+        return ExploreContext.MethodsProvider;
+
+    if (bMethodsProviderResolved && ResolvedMethodsProvider == UserMethodsProvider)
+        return UserMethodsProvider;
+
     if (!CachedExpressoInstance)
     {
         CachedExpressoInstance = GetDB()->GetExpressoInstance();
@@ -267,11 +615,24 @@ UObject* UArticyFlowPlayer::GetMethodsProvider()
         }
     }
 
+    bMethodsProviderResolved = true;
+    ResolvedMethodsProvider = UserMethodsProvider;
+
     return UserMethodsProvider;
 }
 
+/**
+ * Discards the cached methods provider, so that the next GetMethodsProvider call resolves it again.
+ */
+void UArticyFlowPlayer::InvalidateMethodsProvider()
+{
+    bMethodsProviderResolved = false;
+    ResolvedMethodsProvider = nullptr;
+}
+
 /**
  * Retrieves the unshadowed node for a specified node.
+ * Pins are not in the database, they are looked up in the subobjects of their unshadowed owner, which are indexed by id.
  *
  * @param Node The node to unshadow.
  * @return A pointer to the unshadowed IArticyFlowObject.
@@ -279,56 +640,109 @@ UObject* UArticyFlowPlayer::GetMethodsProvider()
 IArticyFlowObject* UArticyFlowPlayer::GetUnshadowedNode(IArticyFlowObject* Node)
 {
     auto db = UArticyDatabase::Get(this);
-    UArticyPrimitive* UnshadowedObject = db->GetObjectUnshadowed(Cast<UArticyPrimitive>(Node)->GetId());
+    auto object = Cast<UArticyPrimitive>(Node);
+    if (!object)
+        return nullptr;
 
-    // Handle pins, because we can not request them directly from the db 
-    if (!UnshadowedObject)
+    auto pin = object->GetCapability<UArticyFlowPin>();
+    if (!pin)
     {
-        auto pinOwner = db->GetObjectUnshadowed(Cast<UArticyFlowPin>(Node)->GetOwner()->GetId());
-
-        TArray<UArticyFlowPin*> pins;
-        auto inputPinsOwner = Cast<IArticyInputPinsProvider>(pinOwner);
-        if (inputPinsOwner)
-        {
-            pins.Append(*inputPinsOwner->GetInputPinsPtr());
-        }
-        auto outputPinsOwner = Cast<IArticyOutputPinsProvider>(pinOwner);
-        if (outputPinsOwner)
-        {
-            pins.Append(*outputPinsOwner->GetOutputPinsPtr());
-        }
-
-        auto targetId = Cast<UArticyPrimitive>(Node)->GetId();
-        for (auto pin : pins)
-        {
-            if (pin->GetId() == targetId)
-            {
-                UnshadowedObject = pin;
-                break;
-            }
-        }
+        auto unshadowed = db->GetObjectUnshadowed(object->GetId());
+        return unshadowed ? unshadowed->GetCapability<IArticyFlowObject>() : nullptr;
     }
 
-    return Cast<IArticyFlowObject>(UnshadowedObject);
+    auto pinOwner = db->GetObjectUnshadowed(pin->Owner);
+    auto unshadowedPin = pinOwner ? pinOwner->GetSubobject(pin->GetId()) : nullptr;
+    return unshadowedPin ? unshadowedPin->GetCapability<IArticyFlowObject>() : nullptr;
 }
 
 //---------------------------------------------------------------------------//
 
 /**
  * Explores the flow starting from a specified node.
+ * While exploring, paths are kept as chains of shared path nodes, so branches with a common
+ * prefix share it. The call with Depth 0 materializes the Path arrays of the resulting branches once.
  *
  * @param Node The node to start exploring from.
  * @param bShadowed Whether the exploration should be shadowed.
  * @param Depth The current depth of exploration.
  * @param IncludeCurrent Whether to include the current node in the exploration.
+ * @param Continuation If set, the explore budget applies. A pending continuation continues the exploration
+ *                     where it stopped, and it is updated with where this exploration stopped.
  * @return An array of branches resulting from the exploration.
  */
-TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool bShadowed, int32 Depth, bool IncludeCurrent)
+TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool bShadowed, int32 Depth, bool IncludeCurrent, FArticyExploreContinuation* Continuation)
 {
+    //the nested explorations are part of the outermost one
+    CONDITIONAL_SCOPE_CYCLE_COUNTER(STAT_ArticyFlowExplore, Depth == 0);
+
     TArray<FArticyBranch> OutBranches;
 
+    //the outermost exploration starts with empty paths
+    const int32 OuterPathTail = ExplorePathTail;
+    if (Depth == 0)
+    {
+        ExplorePathNodes.Reset();
+        ExplorePathTail = INDEX_NONE;
+        ExploreVisited.Reset();
+        ExploreInvalidDepth = 0;
+    }
+
+    //explore the flow graph instead of the flow objects, if the node is a part of it
+    const FArticyFlowGraph* graph = nullptr;
+    int32 graphIndex = INDEX_NONE;
+    if (Depth == 0 && bUseFlowGraph && Node)
+    {
+        graph = &GetDB()->GetFlowGraph();
+        graphIndex = graph->FindNode(Cast<UArticyPrimitive>(Node));
+    }
+
+    //converges with a path explored already (see bMergeConvergingBranches)
+    if (bMergeConvergingBranches && Depth > 0 && Node && !MarkExploreVisited(GetUnshadowedNode(Node)->_getUObject()))
+        return OutBranches;
+
+    //the nodes of the flow graph are counted by ExploreGraphNode
+    if (graphIndex == INDEX_NONE)
+    {
+        INC_DWORD_STAT(STAT_ArticyExploredNodes);
+    }
+
+    if (graphIndex != INDEX_NONE)
+    {
+        ExploreBudget.bActive = Continuation && (ExploreNodeBudget > 0 || ExploreTimeBudget > 0.f);
+        if (ExploreBudget.bActive)
+        {
+            ExploreBudget.bExhausted = false;
+            ExploreBudget.NumVisited = 0;
+            ExploreBudget.Deadline = ExploreTimeBudget > 0.f ? FPlatformTime::Seconds() + ExploreTimeBudget / 1000.0 : 0.0;
+            ExploreBudget.ChildPath.Reset();
+            ExploreBudget.bOnResumePath = Continuation->bPending;
+            ExploreBudget.PathResults.Reset();
+            ExploreBudget.ResumeResults.Reset();
+            if (Continuation->bPending)
+            {
+                ExploreBudget.ResumePath = MoveTemp(Continuation->ChildPath);
+                ExploreBudget.ResumeResults = MoveTemp(Continuation->ScriptResults);
+            }
+        }
+
+        ExploreGraphNode(*graph, graphIndex, bShadowed, Depth, IncludeCurrent, OutBranches);
+
+        if (Continuation)
+        {
+            Continuation->bPending = ExploreBudget.bActive && ExploreBudget.bExhausted;
+            Continuation->ChildPath.Reset();
+            Continuation->ScriptResults.Reset();
+            if (Continuation->bPending)
+            {
+                Continuation->ChildPath = MoveTemp(ExploreBudget.ResumePath);
+                Continuation->ScriptResults = MoveTemp(ExploreBudget.ResumeResults);
+            }
+        }
+        ExploreBudget.bActive = false;
+    }
     //check stop condition
-    if ((Depth > ExploreLimit || !Node || (Node != Cursor.GetInterface() && ShouldPauseOn(Node))))
+    else if ((Depth > ExploreLimit || !Node || (Node != Cursor.GetInterface() && ShouldPauseOn(Node))))
     {
         if (Depth > ExploreLimit)
             UE_LOG(LogArticyRuntime, Warning, TEXT("ExploreDepthLimit (%d) reached, stopping exploration!"), ExploreLimit);
@@ -344,6 +758,7 @@ TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool b
 
         //target reached, create a branch
         auto branch = FArticyBranch{};
+        branch.PathTail = ExplorePathTail;
         if (Node)
         {
             /* NOTE: This check must not be done, as the last node in a branch never affects
@@ -351,12 +766,7 @@ TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool b
             * with invalid condition, instead of just UP TO that node.
             branch.bIsValid = Node->Execute(this); */
 
-            auto unshadowedNode = GetUnshadowedNode(Node);
-
-            TScriptInterface<IArticyFlowObject> ptr;
-            ptr.SetObject(unshadowedNode->_getUObject());
-            ptr.SetInterface(unshadowedNode);
-            branch.Path.Add(ptr);
+            branch.PathTail = AddExplorePathNode(Node);
         }
 
         OutBranches.Add(branch);
@@ -364,30 +774,41 @@ TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool b
     else
     {
         //set speaker on expresso scripts
-        auto xp = GetDB()->GetExpressoInstance();
+        auto obj = Cast<UArticyPrimitive>(Node);
+        auto xp = GetExpressoInstance();
         if (ensure(xp))
         {
-            auto obj = Cast<UArticyPrimitive>(Node);
             if (obj)
             {
                 xp->SetCurrentObject(obj);
 
                 IArticyObjectWithSpeaker* speaker;
-                if (auto flowPin = Cast<UArticyFlowPin>(Node))
-                    speaker = Cast<IArticyObjectWithSpeaker>(flowPin->GetOwner());
+                if (auto flowPin = obj->GetCapability<UArticyFlowPin>())
+                {
+                    auto owner = flowPin->GetOwner();
+                    speaker = owner ? owner->GetCapability<IArticyObjectWithSpeaker>() : nullptr;
+                }
                 else
-                    speaker = Cast<IArticyObjectWithSpeaker>(obj);
+                    speaker = obj->GetCapability<IArticyObjectWithSpeaker>();
 
                 if (speaker)
                     xp->SetSpeaker(speaker->GetSpeaker());
             }
         }
 
+        // add this node to the paths of all the branches found below
+        // 
+        // Only do this if IncludeCurrent is true. 
+        // See https://github.com/ArticySoftware/ArticyImporterForUnreal/issues/50
+        const int32 ParentPathTail = ExplorePathTail;
+        if (IncludeCurrent)
+            ExplorePathTail = AddExplorePathNode(Node);
+
         //if this is the first node, try to submerge
         bool bSubmerged = false;
         if (Depth == 0)
         {
-            auto inputPinProvider = Cast<IArticyInputPinsProvider>(Node);
+            auto inputPinProvider = obj ? obj->GetCapability<IArticyInputPinsProvider>() : Cast<IArticyInputPinsProvider>(Node);
             if (inputPinProvider)
                 bSubmerged = inputPinProvider->TrySubmerge(this, OutBranches, Depth + 1, bShadowed); //NOTE: bShadowed will always be true if Depth == 0
         }
@@ -407,131 +828,1284 @@ TArray<FArticyBranch> UArticyFlowPlayer::Explore(IArticyFlowObject* Node, bool b
             }
         }
 
-        // add this node to the head of all the branches
-        // 
-        // Only do this if IncludeCurrent is true. 
-        // See https://github.com/ArticySoftware/ArticyImporterForUnreal/issues/50
-        if (IncludeCurrent)
+        //dead ends added by the node itself end here
+        for (auto& branch : OutBranches)
         {
-            for (auto& branch : OutBranches)
-            {
-                auto unshadowedNode = GetUnshadowedNode(Node);
-                TScriptInterface<IArticyFlowObject> ptr;
-                ptr.SetObject(unshadowedNode->_getUObject());
-                ptr.SetInterface(unshadowedNode);
+            if (branch.PathTail == INDEX_NONE)
+                branch.PathTail = ExplorePathTail;
+        }
 
-                branch.Path.Insert(ptr, 0); //TODO inserting at front is not ideal performance wise
-            }
+        ExplorePathTail = ParentPathTail;
+    }
+
+    if (Depth == 0)
+    {
+        //only flow graph explorations can stop early
+        if (Continuation && graphIndex == INDEX_NONE)
+        {
+            Continuation->bPending = false;
+            Continuation->ChildPath.Reset();
         }
+
+        for (auto& branch : OutBranches)
+            MaterializePath(branch);
+
+        //paths converging on a target which is not reached through a common node are merged here
+        if (bMergeConvergingBranches)
+            MergeConvergingBranches(OutBranches);
+
+        ExplorePathTail = OuterPathTail;
     }
 
     return OutBranches;
 }
 
 /**
- * Sets the nodes on which the flow player should pause.
+ * Records that the current exploration reached a node, see bMergeConvergingBranches.
  *
- * @param Types The types of nodes to pause on.
+ * @param Node The unshadowed node.
+ * @return False if the node was reached on a path with the same validity already.
  */
-void UArticyFlowPlayer::SetPauseOn(EArticyPausableType Types)
+bool UArticyFlowPlayer::MarkExploreVisited(const UObject* Node)
 {
-    PauseOn = 1 << uint8(Types & EArticyPausableType::DialogueFragment)
-        | 1 << uint8(Types & EArticyPausableType::Dialogue)
-        | 1 << uint8(Types & EArticyPausableType::FlowFragment)
-        | 1 << uint8(Types & EArticyPausableType::Hub)
-        | 1 << uint8(Types & EArticyPausableType::Jump)
-        | 1 << uint8(Types & EArticyPausableType::Condition)
-        | 1 << uint8(Types & EArticyPausableType::Instruction)
-        | 1 << uint8(Types & EArticyPausableType::Pin);
+    //objects are aligned, so the lowest bit is free for the validity
+    bool bVisited = false;
+    ExploreVisited.Add(reinterpret_cast<UPTRINT>(Node) | (ExploreInvalidDepth > 0 ? 1 : 0), &bVisited);
+    return !bVisited;
 }
 
-//---------------------------------------------------------------------------//
-
 /**
- * Updates the available branches from the current cursor position.
+ * Removes the branches ending at the same target with the same validity as an earlier one, keeping the order.
+ *
+ * @param Branches The branches, with their paths.
  */
-void UArticyFlowPlayer::UpdateAvailableBranches()
+void UArticyFlowPlayer::MergeConvergingBranches(TArray<FArticyBranch>& Branches)
 {
-    UpdateAvailableBranchesInternal(false);
-}
+    TSet<UPTRINT> Targets;
+    Targets.Reserve(Branches.Num());
 
-bool UArticyFlowPlayer::OnTick(float DeltaTime)
-{
-    FArticyBranch Branch;
-    while (BranchQueue.Dequeue(Branch))
+    int32 NumKept = 0;
+    for (int32 i = 0; i < Branches.Num(); ++i)
     {
-        if (!ensure(ShadowLevel == 0))
-        {
-            UE_LOG(LogArticyRuntime, Error, TEXT("ArticyFlowPlayer::Traverse was called inside a ShadowedOperation! Aborting Play."))
-                return true;
-        }
+        bool bDuplicate = false;
+        Targets.Add(reinterpret_cast<UPTRINT>(Branches[i].GetTarget().GetObject()) | (Branches[i].bIsValid ? 0 : 1), &bDuplicate);
+        if (bDuplicate)
+            continue;
+
+        if (NumKept != i)
+            Branches[NumKept] = MoveTemp(Branches[i]);
+        ++NumKept;
+    }
 
-        for (auto& node : Branch.Path)
-        {
-            node->Execute(GetGVs(), GetMethodsProvider());
+    Branches.RemoveAt(NumKept, Branches.Num() - NumKept);
+}
 
-            // update nodes visited
-            auto* GVs = GetGVs();
-            if (GVs)
+/**
+ * Appends a node to the current explore path.
+ *
+ * @param Node The (possibly shadowed) node.
+ * @return The index of the new path node.
+ */
+int32 UArticyFlowPlayer::AddExplorePathNode(IArticyFlowObject* Node)
+{
+    auto unshadowedNode = GetUnshadowedNode(Node);
+
+    FExplorePathNode& pathNode = ExplorePathNodes.AddDefaulted_GetRef();
+    pathNode.Node.SetObject(unshadowedNode->_getUObject());
+    pathNode.Node.SetInterface(unshadowedNode);
+    pathNode.Previous = ExplorePathTail;
+
+    return ExplorePathNodes.Num() - 1;
+}
+
+/**
+ * Appends a node of the flow graph to the current explore path.
+ * Graph nodes are unshadowed already, so no lookup is needed.
+ *
+ * @param Node The graph node.
+ * @return The index of the new path node.
+ */
+int32 UArticyFlowPlayer::AddExplorePathNode(const FArticyFlowGraphNode& Node)
+{
+    FExplorePathNode& pathNode = ExplorePathNodes.AddDefaulted_GetRef();
+    pathNode.Node.SetObject(Node.Object);
+    pathNode.Node.SetInterface(Node.FlowObject);
+    pathNode.Previous = ExplorePathTail;
+
+    return ExplorePathNodes.Num() - 1;
+}
+
+/**
+ * Explores a node of the flow graph, the same way Explore explores a flow object.
+ * The branches are appended to OutBranches directly instead of being returned and appended by the caller.
+ *
+ * @param Graph The flow graph of the database.
+ * @param Index The index of the node, or INDEX_NONE for a missing node.
+ * @param bShadowed Whether the exploration should be shadowed.
+ * @param Depth The current depth of exploration.
+ * @param IncludeCurrent Whether to include the current node in the exploration.
+ * @param OutBranches The array the branches are appended to.
+ */
+void UArticyFlowPlayer::ExploreGraphNode(const FArticyFlowGraph& Graph, int32 Index, bool bShadowed, int32 Depth, bool IncludeCurrent, TArray<FArticyBranch>& OutBranches)
+{
+    //converges with a path explored already (see bMergeConvergingBranches)
+    if (bMergeConvergingBranches && Depth > 0 && Index != INDEX_NONE && !MarkExploreVisited(Graph.GetNode(Index).Object))
+        return;
+
+    //a budgeted exploration stops at the first node over the budget, and skips everything after it
+    if (ExploreBudget.bActive && !ConsumeExploreBudget())
+        return;
+
+    INC_DWORD_STAT(STAT_ArticyExploredNodes);
+
+    const FArticyFlowGraphNode* node = Index != INDEX_NONE ? &Graph.GetNode(Index) : nullptr;
+
+    //check stop condition
+    if (Depth > ExploreLimit || !node || (node->FlowObject != Cursor.GetInterface() && (node->PauseMask & PauseOn)))
+    {
+        if (Depth > ExploreLimit)
+            UE_LOG(LogArticyRuntime, Warning, TEXT("ExploreDepthLimit (%d) reached, stopping exploration!"), ExploreLimit);
+        if (!node)
+            UE_LOG(LogArticyRuntime, Warning, TEXT("Found a nullptr Node when exploring a branch!"));
+
+        //target reached, create a branch
+        auto& branch = OutBranches.AddDefaulted_GetRef();
+        branch.PathTail = node ? AddExplorePathNode(*node) : ExplorePathTail;
+        return;
+    }
+
+    //set speaker on expresso scripts
+    SetScriptContext(Graph, *node);
+
+    // add this node to the paths of all the branches found below
+    const int32 ParentPathTail = ExplorePathTail;
+    if (IncludeCurrent)
+        ExplorePathTail = AddExplorePathNode(*node);
+
+    //if this is the first node, try to submerge (see IArticyInputPinsProvider::TrySubmerge)
+    bool bSubmerged = false;
+    if (Depth == 0)
+    {
+        const auto inPins = node->Owner == INDEX_NONE ? Graph.GetInputs(*node) : TConstArrayView<int32>();
+        if (inPins.Num() > 0)
+        {
+            const auto bSubmergeShadowed = bShadowed
+                || inPins.Num() > 1
+                || Graph.GetNode(inPins[0]).NumTargets > 1;
+
+            for (int32 i = 0; i < inPins.Num(); ++i)
             {
-                GVs->IncrementSeenCounter(Cast<IArticyFlowObject>(node.GetObject()));
+                if (Graph.GetNode(inPins[i]).NumTargets > 0)
+                {
+                    bSubmerged = true;
+                    ExploreGraphChild(Graph, i, inPins[i], bSubmergeShadowed, Depth + 2, OutBranches);
+                }
             }
         }
+    }
 
-        Cursor = Branch.Path.Last();
-        UpdateAvailableBranches();
+    //explore this node, subgraphs whose scripts only read state need no shadow state to be restored
+    if (!bSubmerged)
+    {
+        if (bShadowed && !node->bReadOnly)
+            ShadowedOperation([&] { ExploreGraphTargets(Graph, *node, Depth + 1, OutBranches); });
+        else
+            ExploreGraphTargets(Graph, *node, Depth + 1, OutBranches);
+    }
+
+    ExplorePathTail = ParentPathTail;
+}
+
+/**
+ * Sets the current object and speaker of the expresso scripts to the ones of a graph node, before its scripts run.
+ *
+ * @param Graph The flow graph of the database.
+ * @param Node The node whose scripts run next.
+ */
+void UArticyFlowPlayer::SetScriptContext(const FArticyFlowGraph& Graph, const FArticyFlowGraphNode& Node)
+{
+    auto db = GetDB();
+    auto xp = GetExpressoInstance();
+    if (!ensure(xp))
+        return;
+
+    //nodes may have a shadow copy, pins are read from the graph like TrySubmerge and Explore read them from their owner
+    auto getCurrentObject = [db](const FArticyFlowGraphNode& graphNode) -> UArticyPrimitive*
+    {
+        UArticyPrimitive* current = graphNode.Container ? graphNode.Container->Get(db) : nullptr;
+        return current ? current : graphNode.Object;
+    };
+
+    const bool bIsPin = Node.Owner != INDEX_NONE;
+    xp->SetCurrentObject(bIsPin ? Node.Object : getCurrentObject(Node));
+
+    if (Node.bHasSpeaker)
+    {
+        auto speaker = getCurrentObject(bIsPin ? Graph.GetNode(Node.Owner) : Node)->GetCapability<IArticyObjectWithSpeaker>();
+        if (speaker)
+            xp->SetSpeaker(speaker->GetSpeaker());
+    }
+}
+
+/**
+ * Explores a child of a graph node, keeping track of the child indices leading to it for the explore budget.
+ * While a continued exploration is on its way to the node it stopped at, the children before it were
+ * explored by the previous explorations already and are skipped, and the nodes on the way take the recorded
+ * results of their scripts instead of running them again (see RunGraphScript).
+ * Every child of a node with more than one child is explored in its own shadow state, so skipping them
+ * does not change the outcome of the others.
+ *
+ * @param Graph The flow graph of the database.
+ * @param ChildIndex The index of the child among the children of its parent.
+ * @param Index The index of the child node.
+ * @param bShadowed Whether the exploration should be shadowed.
+ * @param Depth The current depth of exploration.
+ * @param OutBranches The array the branches are appended to.
+ */
+void UArticyFlowPlayer::ExploreGraphChild(const FArticyFlowGraph& Graph, int32 ChildIndex, int32 Index, bool bShadowed, int32 Depth, TArray<FArticyBranch>& OutBranches)
+{
+    if (!ExploreBudget.bActive)
+    {
+        ExploreGraphNode(Graph, Index, bShadowed, Depth, true, OutBranches);
+        return;
+    }
+
+    if (ExploreBudget.bExhausted)
+        return;
+
+    if (ExploreBudget.bOnResumePath)
+    {
+        const int32 level = ExploreBudget.ChildPath.Num();
+        const int32 resumeIndex = ExploreBudget.ResumePath.IsValidIndex(level) ? ExploreBudget.ResumePath[level] : INDEX_NONE;
+        if (ChildIndex < resumeIndex)
+            return;
+        if (ChildIndex > resumeIndex)
+            ExploreBudget.bOnResumePath = false;
+    }
+
+    ExploreBudget.ChildPath.Add(ChildIndex);
+    ExploreGraphNode(Graph, Index, bShadowed, Depth, true, OutBranches);
+    ExploreBudget.ChildPath.Pop();
+}
+
+/**
+ * Counts a visited node against the explore budget.
+ * The nodes on the way to where a continued exploration stopped were counted by the previous exploration,
+ * so every exploration makes progress even with the smallest budget.
+ *
+ * @return False if the budget is exhausted and the node must not be explored.
+ */
+bool UArticyFlowPlayer::ConsumeExploreBudget()
+{
+    if (ExploreBudget.bExhausted)
+        return false;
+
+    if (ExploreBudget.bOnResumePath)
+    {
+        if (ExploreBudget.ChildPath.Num() < ExploreBudget.ResumePath.Num())
+            return true;
+
+        //this is the node the previous exploration stopped at
+        ExploreBudget.bOnResumePath = false;
+    }
+
+    ++ExploreBudget.NumVisited;
+
+    //reading the time is not free, so the deadline is only checked every few nodes
+    const bool bOverBudget = (ExploreNodeBudget > 0 && ExploreBudget.NumVisited > ExploreNodeBudget)
+        || (ExploreBudget.Deadline > 0.0 && (ExploreBudget.NumVisited & 15) == 0 && FPlatformTime::Seconds() > ExploreBudget.Deadline);
+
+    if (bOverBudget)
+    {
+        ExploreBudget.bExhausted = true;
+        ExploreBudget.ResumePath = ExploreBudget.ChildPath;
+
+        //the nodes on the way to this one ran their scripts, this one did not
+        ExploreBudget.ResumeResults = ExploreBudget.PathResults;
+        if (ExploreBudget.ResumeResults.Num() > ExploreBudget.ResumePath.Num())
+            ExploreBudget.ResumeResults.SetNum(ExploreBudget.ResumePath.Num());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Continues the exploration of a graph node on its targets, the same way the Explore
+ * implementations of the flow classes do.
+ *
+ * @param Graph The flow graph of the database.
+ * @param Node The node to continue from.
+ * @param Depth The depth the Explore implementation of the node would be called with.
+ * @param OutBranches The array the branches are appended to.
+ */
+void UArticyFlowPlayer::ExploreGraphTargets(const FArticyFlowGraph& Graph, const FArticyFlowGraphNode& Node, int32 Depth, TArray<FArticyBranch>& OutBranches)
+{
+    //chains of nodes without scripts and branches are not explored node by node
+    if (ExploreGraphSkipAhead(Graph, Node, Depth, OutBranches))
+        return;
+
+    //branches ending at a dead end continue the current path
+    auto addDeadEnd = [&]
+    {
+        OutBranches.AddDefaulted_GetRef().PathTail = ExplorePathTail;
+    };
+
+    //continue on the output pins (see UArticyNode::Explore), which are explored one level below
+    //IArticyOutputPinsProvider::Explore; the targets of conditions and jumps are explored by the node itself
+    auto exploreOutputPins = [&]
+    {
+        const auto pins = Graph.GetOutputs(Node);
+        if (pins.Num() > 0)
+        {
+            const auto bShadowed = pins.Num() > 1;
+            for (int32 i = 0; i < pins.Num(); ++i)
+                ExploreGraphChild(Graph, i, pins[i], bShadowed, Depth + 2, OutBranches);
+        }
+        else
+        {
+            //DEAD-END!
+            addDeadEnd();
+        }
+    };
+
+    switch (Node.Kind)
+    {
+    case EArticyFlowGraphNodeKind::Condition:
+    {
+        const bool bResult = !Node.bHasScript || RunGraphScript(Node, true);
+        const auto pins = Graph.GetOutputs(Node);
+        ExploreGraphChild(Graph, 0, pins[bResult ? 0 : 1], false, Depth + 1, OutBranches);
+        break;
+    }
+
+    case EArticyFlowGraphNodeKind::Instruction:
+        if (Node.bHasScript)
+            RunGraphScript(Node, false);
+        exploreOutputPins();
+        break;
+
+    case EArticyFlowGraphNodeKind::Node:
+        exploreOutputPins();
+        break;
+
+    case EArticyFlowGraphNodeKind::Jump:
+    {
+        const auto targets = Graph.GetTargets(Node);
+        if (targets.Num() > 0)
+            ExploreGraphChild(Graph, 0, targets[0], false, Depth + 1, OutBranches);
+        else
+            addDeadEnd();
+        break;
+    }
+
+    case EArticyFlowGraphNodeKind::InputPin:
+    {
+        //evaluate first, as the evaluate method could have side-effects
+        const bool bIsValid = RunGraphScript(Node, true);
+
+        //we can stop here if the branch is invalid and should be ignored
+        if (!bIsValid && IgnoresInvalidBranches())
+            return;
+
+        const int32 firstBranch = OutBranches.Num();
+        const auto targets = Graph.GetTargets(Node);
+        if (!bIsValid)
+            BeginInvalidExplorePath();
+
+        if (Depth > 3 && (Graph.GetNode(Node.Owner).PauseMask & PauseOn))
+        {
+            // if the owner of this input pin is a stop node, we directly continue with it instead of submerging
+            ExploreGraphChild(Graph, 0, Node.Owner, false, Depth + 1, OutBranches);
+        }
+        else if (targets.Num() > 0)
+        {
+            const auto bShadowed = targets.Num() > 1;
+            for (int32 i = 0; i < targets.Num(); ++i)
+                ExploreGraphChild(Graph, i, targets[i], bShadowed, Depth + 1, OutBranches);
+        }
+        else
+        {
+            //no connections, so continue with the owner itself
+            ExploreGraphChild(Graph, 0, Node.Owner, false, Depth + 1, OutBranches);
+        }
+
+        //all branches that lead THROUGH this pin are invalid if the pin's condition is not valid
+        if (!bIsValid)
+        {
+            EndInvalidExplorePath();
+            for (int32 i = firstBranch; i < OutBranches.Num(); ++i)
+                OutBranches[i].bIsValid = false;
+        }
+        break;
+    }
+
+    case EArticyFlowGraphNodeKind::OutputPin:
+    {
+        RunGraphScript(Node, false);
+
+        const auto targets = Graph.GetTargets(Node);
+        if (targets.Num() > 0)
+        {
+            const auto bShadowed = targets.Num() > 1;
+            for (int32 i = 0; i < targets.Num(); ++i)
+                ExploreGraphChild(Graph, i, targets[i], bShadowed, Depth + 1, OutBranches);
+        }
+        else
+        {
+            //DEAD-END!
+            addDeadEnd();
+        }
+        break;
+    }
+    }
+}
+
+/**
+ * Runs the script of a graph node. A budgeted exploration records the result of the script, with the values it wrote,
+ * for the level of the node. On the way to the node a continued exploration stopped at, the recorded result is used
+ * instead, so the instructions and user methods of the nodes explored already do not run again. The recorded values
+ * are written in the same shadow states the script wrote them in. Scripts which wrote seen counters are not recorded,
+ * and run again.
+ *
+ * @param Node The node whose script runs.
+ * @param bIsCondition Whether the script is a condition, or an instruction.
+ * @return The result of the condition, true for an instruction.
+ */
+bool UArticyFlowPlayer::RunGraphScript(const FArticyFlowGraphNode& Node, bool bIsCondition)
+{
+    auto xp = GetExpressoInstance();
+    auto run = [&]
+    {
+        if (bIsCondition)
+            return xp->EvaluateByIndex(Node.ScriptIndex, Node.ScriptHash, GetGVs(), GetMethodsProvider());
+
+        xp->ExecuteByIndex(Node.ScriptIndex, Node.ScriptHash, GetGVs(), GetMethodsProvider());
+        return true;
+    };
+
+    if (!ExploreBudget.bActive)
+        return run();
+
+    const int32 level = ExploreBudget.ChildPath.Num();
+    ExploreBudget.PathResults.SetNum(level + 1);
+    FArticyExploreScriptResult& result = ExploreBudget.PathResults[level];
+
+    //on the way to where the exploration continues, the result is known already
+    if (ExploreBudget.bOnResumePath && ExploreBudget.ResumeResults.IsValidIndex(level) && ExploreBudget.ResumeResults[level].Object == Node.Object)
+    {
+        result = ExploreBudget.ResumeResults[level];
+        for (const auto& value : result.Ints)
+        {
+            if (UArticyInt* variable = value.Key.Get())
+                variable->Set(value.Value);
+        }
+        for (const auto& value : result.Bools)
+        {
+            if (UArticyBool* variable = value.Key.Get())
+                variable->Set(value.Value);
+        }
+        for (const auto& value : result.Strings)
+        {
+            if (UArticyString* variable = value.Key.Get())
+                variable->Set(value.Value);
+        }
+        return result.bResult;
+    }
+
+    auto* GVs = GetGVs();
+    FArticyGvWriteSet writes;
+    FArticyGvWriteSet* previousRecorder = GVs->GetWriteRecorder();
+    GVs->SetWriteRecorder(&writes);
+    const bool bResult = run();
+    GVs->SetWriteRecorder(previousRecorder);
+
+    result.Reset();
+    if (writes.bWroteSeenCounters)
+        return bResult;
+
+    result.Object = Node.Object;
+    result.bResult = bResult;
+
+    //the values written are not read by the exploration
+    FArticyGvReadSet* previousReads = GVs->GetReadRecorder();
+    GVs->SetReadRecorder(nullptr);
+    for (UArticyVariable* variable : writes.Variables)
+    {
+        if (UArticyInt* intVariable = Cast<UArticyInt>(variable))
+            result.Ints.Emplace(intVariable, intVariable->Get());
+        else if (UArticyBool* boolVariable = Cast<UArticyBool>(variable))
+            result.Bools.Emplace(boolVariable, boolVariable->Get());
+        else if (UArticyString* stringVariable = Cast<UArticyString>(variable))
+            result.Strings.Emplace(stringVariable, stringVariable->Get());
+    }
+    GVs->SetReadRecorder(previousReads);
+
+    return bResult;
+}
+
+/**
+ * Explores the skip-ahead target of a graph node directly, instead of exploring each node of the chain leading to
+ * it. The skipped nodes are still added to the explore path, as the branches run through them when played.
+ * Budgeted explorations, and chains with a node to pause on or reaching the explore limit, are explored node by node.
+ *
+ * @param Graph The flow graph of the database.
+ * @param Node The node to continue from.
+ * @param Depth The depth the Explore implementation of the node would be called with.
+ * @param OutBranches The array the branches are appended to.
+ * @return False if the node has no skip-ahead, or it can't be used.
+ */
+bool UArticyFlowPlayer::ExploreGraphSkipAhead(const FArticyFlowGraph& Graph, const FArticyFlowGraphNode& Node, int32 Depth, TArray<FArticyBranch>& OutBranches)
+{
+    //budgeted explorations count every node, and continue by the child indices leading to a node
+    if (Node.NumSkipped == 0 || ExploreBudget.bActive || (Node.SkipPauseMask & PauseOn))
+        return false;
+
+    //Depth is one more than the depth of the node itself
+    const int32 targetDepth = Depth - 1 + Node.SkipDepth;
+    if (targetDepth > ExploreLimit)
+        return false;
+
+    const int32 parentPathTail = ExplorePathTail;
+    int32 index = Node.PassChild;
+    for (int32 i = 0; i < Node.NumSkipped; ++i)
+    {
+        const FArticyFlowGraphNode& skipped = Graph.GetNode(index);
+
+        //converges with a path explored already (see bMergeConvergingBranches)
+        if (bMergeConvergingBranches && !MarkExploreVisited(skipped.Object))
+        {
+            ExplorePathTail = parentPathTail;
+            return true;
+        }
+
+        ExplorePathTail = AddExplorePathNode(skipped);
+        index = skipped.PassChild;
     }
+    INC_DWORD_STAT_BY(STAT_ArticyExploredNodes, Node.NumSkipped);
+
+    ExploreGraphNode(Graph, Node.SkipTarget, false, targetDepth, true, OutBranches);
+
+    ExplorePathTail = parentPathTail;
+    return true;
+}
+
+/**
+ * Fills the Path of a branch from its chain of explore path nodes.
+ *
+ * @param Branch The branch to materialize.
+ */
+void UArticyFlowPlayer::MaterializePath(FArticyBranch& Branch) const
+{
+    int32 length = 0;
+    for (int32 i = Branch.PathTail; i != INDEX_NONE; i = ExplorePathNodes[i].Previous)
+        ++length;
+
+    Branch.Path.SetNum(length);
+    for (int32 i = Branch.PathTail; i != INDEX_NONE; i = ExplorePathNodes[i].Previous)
+        Branch.Path[--length] = ExplorePathNodes[i].Node;
+
+    Branch.PathTail = INDEX_NONE;
+}
+
+
+/**
+ * Sets the nodes on which the flow player should pause.
+ *
+ * @param Types The types of nodes to pause on.
+ */
+void UArticyFlowPlayer::SetPauseOn(EArticyPausableType Types)
+{
+    PauseOn = 1 << uint8(Types & EArticyPausableType::DialogueFragment)
+        | 1 << uint8(Types & EArticyPausableType::Dialogue)
+        | 1 << uint8(Types & EArticyPausableType::FlowFragment)
+        | 1 << uint8(Types & EArticyPausableType::Hub)
+        | 1 << uint8(Types & EArticyPausableType::Jump)
+        | 1 << uint8(Types & EArticyPausableType::Condition)
+        | 1 << uint8(Types & EArticyPausableType::Instruction)
+        | 1 << uint8(Types & EArticyPausableType::Pin);
+}
+
+//---------------------------------------------------------------------------//
+
+/**
+ * Updates the available branches from the current cursor position.
+ */
+void UArticyFlowPlayer::UpdateAvailableBranches()
+{
+    UpdateAvailableBranchesInternal(false);
+}
+
+/**
+ * Traverses the queued branches, including the ones queued by the updates of the available branches
+ * in between, and continues a budgeted exploration.
+ *
+ * @param DeltaTime Unused.
+ * @return True, to keep ticking.
+ */
+bool UArticyFlowPlayer::OnTick(float DeltaTime)
+{
+    while (TraverseQueuedBranches())
+        UpdateAvailableBranches();
+
+    //continue a budgeted exploration of the available branches
+    if (PendingExploration.bPending && ShadowLevel == 0)
+        ContinuePendingExploration();
+
+    ContinueTextWarmups();
+
     return true;
 }
 
+/**
+ * Traverses the queued branches, updating the available branches between two of them.
+ *
+ * @return True if a branch was traversed, and the available branches need to be updated.
+ */
+bool UArticyFlowPlayer::TraverseQueuedBranches()
+{
+    bool bTraversed = false;
+    FArticyBranch Branch;
+    while (!BranchQueue.IsEmpty())
+    {
+        if (!ensure(ShadowLevel == 0))
+        {
+            UE_LOG(LogArticyRuntime, Error, TEXT("ArticyFlowPlayer::Traverse was called inside a ShadowedOperation! Aborting Play."))
+            break;
+        }
+
+        //the branches are played from the available branches the previous one leads to
+        if (bTraversed)
+            UpdateAvailableBranches();
+
+        if (!BranchQueue.Dequeue(Branch))
+            break;
+
+        TraverseBranch(Branch);
+        bTraversed = true;
+    }
+    return bTraversed;
+}
+
+/**
+ * Executes the nodes of a branch, counts them as seen and moves the cursor to the end of the branch.
+ *
+ * @param Branch The branch to traverse.
+ */
+void UArticyFlowPlayer::TraverseBranch(const FArticyBranch& Branch)
+{
+    auto* GVs = GetGVs();
+    auto* methodsProvider = GetMethodsProvider();
+    const UArticyDatabase* db = FArticyFlowRecorder::IsEnabled() ? GetDB() : nullptr;
+    //recording doesn't build the flow graph, the nodes are recorded without index if it isn't built
+    const FArticyFlowGraph* recordGraph = db ? db->FindFlowGraph() : nullptr;
+    {
+        SCOPE_CYCLE_COUNTER(STAT_ArticyFlowExecuteBranch);
+        UArticyExpressoScripts::FMethodLogScope methodLogScope(GetExpressoInstance(), MethodLog);
+
+        // the variables changed along the branch are broadcast once it was traversed
+        FArticyGvChangeBatch ChangeBatch(GVs);
+        for (auto& node : Branch.Path)
+        {
+            if (db)
+                FArticyFlowRecorder::Record(EArticyFlowRecordType::Visit, recordGraph ? recordGraph->FindNode(Cast<UArticyPrimitive>(node.GetObject())) : INDEX_NONE, Branch.Index);
+
+            node->Execute(GVs, methodsProvider);
+
+            // update nodes visited
+            if (GVs)
+            {
+                GVs->IncrementSeenCounter(Cast<IArticyFlowObject>(node.GetObject()));
+            }
+        }
+
+        // the changes made by the listeners of the batch are made outside of the flow, the capture saves them
+        if (Capture && GVs)
+            Capture->ValuesVersion = GVs->GetValuesVersion();
+    }
+
+    Cursor = Branch.Path.Last();
+}
+
+/**
+ * Schedules a tick of the scheduler, if the player is registered with it and not scheduled yet.
+ */
+void UArticyFlowPlayer::WakeScheduler()
+{
+    if (!bRegisteredWithScheduler || bScheduled)
+        return;
+
+    if (auto* scheduler = UArticyFlowPlayerSubsystem::Get(this))
+        scheduler->Wake(this);
+}
+
 //---------------------------------------------------------------------------//
 
+/**
+ * Pins the package of the cursor object, so the package residency budget of the database does not evict the package
+ * which is played. The package of the previous cursor is unpinned.
+ */
+void UArticyFlowPlayer::PinCursorPackage()
+{
+    UArticyDatabase* db = GetDB();
+    UObject* cursorObject = Cursor.GetObject();
+    const UArticyPrimitive* primitive = Cast<UArticyPrimitive>(cursorObject);
+    const FString package = db && primitive ? db->FindPackageOfObject(primitive->GetId()) : FString();
+
+    if (package == PinnedPackage && PinnedDatabase.Get() == db)
+        return;
+
+    if (PinnedDatabase.IsValid() && !PinnedPackage.IsEmpty())
+        PinnedDatabase->UnpinPackage(PinnedPackage);
+
+    PinnedPackage = package;
+    PinnedDatabase = db;
+    if (db && !package.IsEmpty())
+        db->PinPackage(package);
+}
+
 /**
  * Updates the available branches from the current cursor position.
  *
  * @param Startup Whether this is a startup update.
  */
 void UArticyFlowPlayer::UpdateAvailableBranchesInternal(bool Startup)
+{
+    //clients receive the branches explored by the server
+    if (IsReplicatedClient())
+        return;
+
+    SCOPE_CYCLE_COUNTER(STAT_ArticyFlowUpdateBranches);
+
+    PinCursorPackage();
+
+    //a new exploration replaces one which is still pending
+    PendingExploration = FArticyExploreContinuation{};
+    FArticyExploreContinuation* continuation = (ExploreNodeBudget > 0 || ExploreTimeBudget > 0.f) ? &PendingExploration : nullptr;
+
+    if (!ExploreAvailableBranches(Startup, continuation))
+        return;
+
+    //the rest of the branches is explored on the next ticks
+    if (PendingExploration.bPending)
+    {
+        bPendingStartup = Startup;
+        WakeScheduler();
+        return;
+    }
+
+    FinishAvailableBranches(Startup);
+}
+
+/**
+ * Explores the available branches from the cursor, or takes them from the exploration cache.
+ * This does not broadcast anything, so it can run on a worker thread (see UpdateAvailableBranchesInParallel).
+ *
+ * @param Startup Whether this is a startup update.
+ * @param Continuation If set, the explore budget applies (see Explore).
+ * @return False if the flow cannot be explored.
+ */
+bool UArticyFlowPlayer::ExploreAvailableBranches(bool Startup, FArticyExploreContinuation* Continuation)
 {
     AvailableBranches.Reset();
 
     if (PauseOn == 0)
-        UE_LOG(LogArticyRuntime, Warning, TEXT("PauseOn is not set, not exploring the Flow as it would not pause on any node."))
-    else if (!Cursor)
-        UE_LOG(LogArticyRuntime, Warning, TEXT("Cannot explore flow, cursor is not set!"))
-    else
     {
-        const bool bMustBeShadowed = true;
-        AvailableBranches = Explore(&*Cursor, bMustBeShadowed, 0, Startup);
+        UE_LOG(LogArticyRuntime, Warning, TEXT("PauseOn is not set, not exploring the Flow as it would not pause on any node."));
+        return false;
+    }
+    if (!Cursor)
+    {
+        UE_LOG(LogArticyRuntime, Warning, TEXT("Cannot explore flow, cursor is not set!"));
+        return false;
+    }
+
+    //the pure user methods return the same for the same arguments on every branch of this exploration
+    UArticyExpressoScripts::FMethodMemoScope memoScope(GetExpressoInstance());
+
+    bool bCached = bCacheExploration && FindCachedExploration(ExplorationCache, Startup, AvailableBranches);
+    if (!bCached && bCacheExploration && bShareExplorationCache)
+    {
+        FScopeLock lock(&SharedExplorationLock);
+        bCached = FindCachedExploration(SharedExplorationCache, Startup, AvailableBranches);
+    }
+
+    if (!bCached && bCacheExploration)
+    {
+        //record everything the scripts read while exploring
+        auto* GVs = GetGVs();
+        FCachedExploration entry;
+        entry.Node = Cursor.GetObject();
+        entry.bIncludeCurrent = Startup;
+        entry.PauseOn = PauseOn;
+        entry.GVs = GVs;
+        entry.ObjectStateVersion = UArticyDatabase::GetObjectStateVersion();
+        entry.SeenVersion = GVs->GetSeenVersion();
+        entry.ExploreLimit = ExploreLimit;
+        entry.ShadowLevelLimit = ShadowLevelLimit;
+        entry.bIgnoreInvalidBranches = bIgnoreInvalidBranches;
+        entry.bMergeConvergingBranches = bMergeConvergingBranches;
+        entry.bUseFlowGraph = bUseFlowGraph;
+
+        FArticyGvReadSet* previousRecorder = GVs->GetReadRecorder();
+        GVs->SetReadRecorder(&entry.Reads);
+        ExploreFromCursor(Startup, AvailableBranches, Continuation);
+        GVs->SetReadRecorder(previousRecorder);
+
+        //an exploration that changed the live state (e.g. a user method) cannot be reused, nor can an incomplete one
+        if (!(Continuation && Continuation->bPending)
+            && entry.ObjectStateVersion == UArticyDatabase::GetObjectStateVersion() && entry.SeenVersion == GVs->GetSeenVersion())
+        {
+            entry.Branches = AvailableBranches;
+            if (bShareExplorationCache)
+            {
+                FScopeLock lock(&SharedExplorationLock);
+                AddCachedExploration(SharedExplorationCache, CVarSharedExplorationCacheSize.GetValueOnAnyThread(), entry);
+            }
+            AddCachedExploration(ExplorationCache, ExplorationCacheSize, entry);
+        }
+    }
+    else if (!bCached)
+    {
+        ExploreFromCursor(Startup, AvailableBranches, Continuation);
+    }
+
+    return true;
+}
+
+/**
+ * Updates the available branches of several flow players at once, exploring on worker threads where possible.
+ * Each group of players sharing a GV instance explores in one task, with its own expresso scripts instance.
+ * The game thread waits for all of them, then broadcasts the results.
+ *
+ * @param Players The flow players to update.
+ */
+void UArticyFlowPlayer::UpdateAvailableBranchesInParallel(const TArray<UArticyFlowPlayer*>& Players)
+{
+    check(IsInGameThread());
 
-        // Prune empty branches
-        AvailableBranches.RemoveAllSwap([](const FArticyBranch& branch) { return branch.Path.Num() == 0; });
+    //group the players by GV instance, the others explore right away
+    TArray<TArray<UArticyFlowPlayer*>> groups;
+    TMap<UArticyGlobalVariables*, int32> groupOfGVs;
+    for (UArticyFlowPlayer* player : Players)
+    {
+        if (!player)
+            continue;
 
-        if (AvailableBranches.IsEmpty())
+        if (!player->CanExploreInParallel())
         {
-            // no valid branches, check for fallback
-            auto* GVs = GetGVs();
-            GVs->SetFallbackEvaluation(&*Cursor, true);
-            auto WithFallback = Explore(&*Cursor, bMustBeShadowed, 0, Startup);
-            GVs->SetFallbackEvaluation(&*Cursor, false);
-            AvailableBranches = WithFallback;
+            player->UpdateAvailableBranches();
+            continue;
         }
 
-        // NP: Every branch needs the index so that Play() can actually take a branch as input
-        for (int32 i = 0; i < AvailableBranches.Num(); i++)
-            AvailableBranches[i].Index = i;
+        UArticyGlobalVariables* GVs = player->GetGVs();
+        int32 group;
+        if (const int32* existing = groupOfGVs.Find(GVs))
+        {
+            group = *existing;
+        }
+        else
+        {
+            group = groups.AddDefaulted();
+            groupOfGVs.Add(GVs, group);
+        }
+        groups[group].Add(player);
+    }
 
-        // If we're just starting up, check if we should fast-forward
-        if (Startup && FastForwardToPause())
+    //resolve everything an exploration would look up, as only the game thread may do so
+    for (int32 i = 0; i < groups.Num(); ++i)
+    {
+        for (UArticyFlowPlayer* player : groups[i])
         {
-            //fast-forwarding will call UpdateAvailableBranches again, can abort here
-            return;
+            player->PendingExploration = FArticyExploreContinuation{};
+
+            FExploreContext context;
+            context.MethodsProvider = player->GetMethodsProvider();
+            context.Database = player->GetDB();
+            context.GVs = player->GetGVs();
+            context.ExpressoInstance = context.Database->GetParallelExpressoInstance(i);
+            context.Database->GetFlowGraph();
+            player->ExploreContext = context;
+        }
+    }
+
+    ParallelFor(groups.Num(), [&groups](int32 i)
+    {
+        for (UArticyFlowPlayer* player : groups[i])
+            player->ExploreAvailableBranches(false, nullptr);
+    });
+
+    for (const auto& group : groups)
+    {
+        for (UArticyFlowPlayer* player : group)
+        {
+            player->ExploreContext = FExploreContext{};
+            player->FinishAvailableBranches(false);
+        }
+    }
+}
+
+/**
+ * Checks whether this flow player can explore on a worker thread: it must allow it, and its
+ * cursor must be part of the flow graph, as only flow graph explorations avoid the shared lookups.
+ * The objects are shared by all explorations, so no script reachable from the cursor may write them
+ * (see FArticyFlowGraphNode::bMayWriteObjects), and no package may be loading, as the objects of
+ * loading packages are only loaded on the game thread.
+ *
+ * @return True if the player can explore in parallel.
+ */
+bool UArticyFlowPlayer::CanExploreInParallel() const
+{
+    if (!bAllowParallelExploration || !bUseFlowGraph || !Cursor || PauseOn == 0 || ShadowLevel > 0 || MethodLog || IsReplicatedClient() || !GetGVs())
+        return false;
+
+    UArticyDatabase* db = GetDB();
+    if (!db || db->HasPendingPackageLoads())
+        return false;
+
+    const FArticyFlowGraph& graph = db->GetFlowGraph();
+    const int32 index = graph.FindNode(Cast<UArticyPrimitive>(Cursor.GetObject()));
+    return index != INDEX_NONE && !graph.GetNode(index).bMayWriteObjects;
+}
+
+/**
+ * Explores the next part of the pending exploration of the available branches, within the explore budget.
+ */
+void UArticyFlowPlayer::ContinuePendingExploration()
+{
+    if (!Cursor)
+    {
+        PendingExploration = FArticyExploreContinuation{};
+        return;
+    }
+
+    ExploreFromCursor(bPendingStartup, AvailableBranches, &PendingExploration);
+
+    if (!PendingExploration.bPending)
+        FinishAvailableBranches(bPendingStartup);
+}
+
+/**
+ * Indexes the available branches once they are complete, fast-forwards on startup and broadcasts them.
+ *
+ * @param Startup Whether this is a startup update.
+ */
+void UArticyFlowPlayer::FinishAvailableBranches(bool Startup)
+{
+    //a budgeted exploration merged the branches of each frame only
+    if (bMergeConvergingBranches)
+        MergeConvergingBranches(AvailableBranches);
+
+    // NP: Every branch needs the index so that Play() can actually take a branch as input
+    for (int32 i = 0; i < AvailableBranches.Num(); i++)
+        AvailableBranches[i].Index = i;
+
+    // If we're just starting up, check if we should fast-forward
+    if (Startup && FastForwardToPause())
+    {
+        //fast-forwarding will call UpdateAvailableBranches again, can abort here
+        return;
+    }
+
+    if (bReplicateFlow)
+        UpdateReplicatedFlowState();
+
+    BroadcastAvailableBranches();
+}
+
+/**
+ * Prefetches the media and prewarms the texts of the available branches if set up, and broadcasts
+ * the cursor and the branches.
+ */
+void UArticyFlowPlayer::BroadcastAvailableBranches()
+{
+    if (bPrefetchBranchMedia)
+        PrefetchBranchMedia();
+
+    if (bPrewarmBranchTexts)
+        QueueTextWarmups();
+
+    //broadcast and return result
+    OnPlayerPaused.Broadcast(Cursor);
+    OnBranchesUpdated.Broadcast(AvailableBranches);
+    OnBranchCountUpdated.Broadcast(AvailableBranches.Num());
+    OnBranchesUpdatedNative.Broadcast(AvailableBranches);
+}
+
+/**
+ * Issues the asynchronous loads of the media referenced by the last PrefetchDepth nodes of each available branch.
+ * Media which are already loaded only count as recently used.
+ */
+void UArticyFlowPlayer::PrefetchBranchMedia()
+{
+    UArticyDatabase* Database = GetDB();
+    if (!Database)
+        return;
+
+    TArray<const UArticyAsset*, TInlineAllocator<16>> Assets;
+    auto AddPreviewImage = [&](const UObject* Object)
+    {
+        const IArticyObjectWithPreviewImage* WithPreviewImage = Cast<IArticyObjectWithPreviewImage>(Object);
+        const UArticyPreviewImage* PreviewImage = WithPreviewImage ? WithPreviewImage->GetPreviewImage() : nullptr;
+        if (const UArticyAsset* Asset = PreviewImage ? Cast<UArticyAsset>(Database->GetObject(PreviewImage->Asset)) : nullptr)
+            Assets.AddUnique(Asset);
+    };
+
+    for (const FArticyBranch& Branch : AvailableBranches)
+    {
+        const int32 First = FMath::Max(0, Branch.Path.Num() - PrefetchDepth);
+        for (int32 i = Branch.Path.Num() - 1; i >= First; --i)
+        {
+            UObject* Object = Branch.Path[i].GetObject();
+            AddPreviewImage(Object);
+
+            if (const IArticyObjectWithSpeaker* WithSpeaker = Cast<IArticyObjectWithSpeaker>(Object))
+                AddPreviewImage(WithSpeaker->GetSpeaker());
+
+            if (IArticyObjectWithText* WithText = Cast<IArticyObjectWithText>(Object))
+            {
+                if (const UArticyAsset* VOAsset = WithText->GetVOAssetObject(this))
+                    Assets.AddUnique(VOAsset);
+            }
+        }
+    }
+
+    TWeakObjectPtr<UArticyFlowPlayer> WeakThis(this);
+    for (const UArticyAsset* Asset : Assets)
+    {
+        Asset->LoadAssetAsync([WeakThis](UObject* Loaded)
+        {
+            if (Loaded && WeakThis.IsValid())
+                WeakThis->AddPrefetchedMedia(Loaded);
+        });
+    }
+}
+
+/**
+ * Queues the targets of the available branches and, up to PrewarmTextDepth, the nodes they are connected to,
+ * whose texts are resolved by ContinueTextWarmups in the next frames. The previous queue is dropped.
+ */
+void UArticyFlowPlayer::QueueTextWarmups()
+{
+    PendingTextWarmups.Reset();
+    NextTextWarmup = 0;
+
+    TSet<const UObject*> Queued;
+    TArray<UObject*> Frontier, Next;
+    for (const FArticyBranch& Branch : AvailableBranches)
+    {
+        UObject* Target = Branch.GetTarget().GetObject();
+        if (Target && !Queued.Contains(Target))
+        {
+            Queued.Add(Target);
+            Frontier.Add(Target);
+        }
+    }
+
+    for (int32 Depth = 0; Depth < PrewarmTextDepth && Frontier.Num() > 0; ++Depth)
+    {
+        Next.Reset();
+        for (UObject* Object : Frontier)
+        {
+            if (Cast<IArticyObjectWithText>(Object) || Cast<IArticyObjectWithMenuText>(Object))
+                PendingTextWarmups.Add(Object);
+
+            //the nodes the output pins are connected to are the ones shown after this one
+            const IArticyOutputPinsProvider* Outputs = Depth + 1 < PrewarmTextDepth ? Cast<IArticyOutputPinsProvider>(Object) : nullptr;
+            const TArray<UArticyOutputPin*>* Pins = Outputs ? Outputs->GetOutputPinsPtr() : nullptr;
+            if (!Pins)
+                continue;
+
+            for (const UArticyOutputPin* Pin : *Pins)
+            {
+                for (const UArticyOutgoingConnection* Connection : Pin->Connections)
+                {
+                    UObject* Following = Connection ? Connection->GetTarget() : nullptr;
+                    if (Following && !Queued.Contains(Following))
+                    {
+                        Queued.Add(Following);
+                        Next.Add(Following);
+                    }
+                }
+            }
+        }
+        Swap(Frontier, Next);
+    }
+
+    if (PrewarmTextsPerFrame <= 0)
+        ContinueTextWarmups();
+    else if (PendingTextWarmups.Num() > 0)
+        WakeScheduler();
+}
+
+/**
+ * Resolves the texts and menu texts of the next PrewarmTextsPerFrame queued objects, or of all of them
+ * if there is no limit. The results end up in the cache of UArticyTextExtension::ResolveCached.
+ */
+void UArticyFlowPlayer::ContinueTextWarmups()
+{
+    //shadow states are not cached
+    if (PendingTextWarmups.Num() == 0 || ShadowLevel > 0)
+        return;
+
+    const int32 End = PrewarmTextsPerFrame > 0 ? FMath::Min(PendingTextWarmups.Num(), NextTextWarmup + PrewarmTextsPerFrame) : PendingTextWarmups.Num();
+    for (; NextTextWarmup < End; ++NextTextWarmup)
+    {
+        UObject* Object = PendingTextWarmups[NextTextWarmup].Get();
+        if (IArticyObjectWithMenuText* WithMenuText = Cast<IArticyObjectWithMenuText>(Object))
+            WithMenuText->GetMenuText();
+        if (IArticyObjectWithText* WithText = Cast<IArticyObjectWithText>(Object))
+            WithText->GetText();
+    }
+
+    if (NextTextWarmup >= PendingTextWarmups.Num())
+    {
+        PendingTextWarmups.Reset();
+        NextTextWarmup = 0;
+    }
+}
+
+/**
+ * Marks a prefetched media as most recently used and evicts the least recently used media above PrefetchMemoryBudget.
+ * The newest media is kept even if it exceeds the budget on its own.
+ *
+ * @param Media The loaded media.
+ */
+void UArticyFlowPlayer::AddPrefetchedMedia(UObject* Media)
+{
+    const int32 Existing = PrefetchedMedia.Find(Media);
+    if (Existing != INDEX_NONE)
+    {
+        const SIZE_T Size = PrefetchedMediaSizes[Existing];
+        PrefetchedMedia.RemoveAt(Existing);
+        PrefetchedMediaSizes.RemoveAt(Existing);
+        PrefetchedMedia.Add(Media);
+        PrefetchedMediaSizes.Add(Size);
+        return;
+    }
+
+    const SIZE_T Size = Media->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+    PrefetchedMedia.Add(Media);
+    PrefetchedMediaSizes.Add(Size);
+    PrefetchedMediaSize += Size;
+
+    const SIZE_T Budget = static_cast<SIZE_T>(FMath::Max(0.f, PrefetchMemoryBudget) * 1024.f * 1024.f);
+    int32 NumEvicted = 0;
+    while (PrefetchedMediaSize > Budget && NumEvicted < PrefetchedMedia.Num() - 1)
+        PrefetchedMediaSize -= PrefetchedMediaSizes[NumEvicted++];
+
+    if (NumEvicted > 0)
+    {
+        PrefetchedMedia.RemoveAt(0, NumEvicted);
+        PrefetchedMediaSizes.RemoveAt(0, NumEvicted);
+    }
+}
+
+/**
+ * Explores the branches from the cursor, including the fallback exploration if no branch is found.
+ * The fallback exploration only runs once the exploration is complete, and is not budgeted.
+ *
+ * @param bIncludeCurrent Whether to include the cursor in the branches.
+ * @param OutBranches The array the non-empty branches from the cursor are appended to.
+ * @param Continuation If set, the explore budget applies (see Explore).
+ */
+void UArticyFlowPlayer::ExploreFromCursor(bool bIncludeCurrent, TArray<FArticyBranch>& OutBranches, FArticyExploreContinuation* Continuation)
+{
+    const bool bMustBeShadowed = true;
+    UArticyExpressoScripts::FMethodLogScope methodLogScope(GetExpressoInstance(), MethodLog);
+    TArray<FArticyBranch> branches = Explore(&*Cursor, bMustBeShadowed, 0, bIncludeCurrent, Continuation);
+
+    // Prune empty branches
+    branches.RemoveAllSwap([](const FArticyBranch& branch) { return branch.Path.Num() == 0; });
+
+    const bool bPending = Continuation && Continuation->bPending;
+    if (branches.IsEmpty() && OutBranches.IsEmpty() && !bPending)
+    {
+        // no valid branches, check for fallback
+        auto* GVs = GetGVs();
+        GVs->SetFallbackEvaluation(&*Cursor, true);
+        branches = Explore(&*Cursor, bMustBeShadowed, 0, bIncludeCurrent);
+        GVs->SetFallbackEvaluation(&*Cursor, false);
+    }
+
+    OutBranches.Append(MoveTemp(branches));
+}
+
+/**
+ * Discards the exploration results shared by the players.
+ */
+void UArticyFlowPlayer::InvalidateSharedExplorationCache()
+{
+    FScopeLock lock(&SharedExplorationLock);
+    SharedExplorationCache.Reset();
+}
+
+/**
+ * Copies the cached branches from the cursor, if they are still valid.
+ * An entry is valid as long as the global variables, seen counters and objects its exploration read are unchanged.
+ * Entries of other global variables or settings are skipped, as the shared cache holds those of other players.
+ *
+ * @param Cache The cache to search, the entry found is moved to its back.
+ * @param bIncludeCurrent Whether the cursor is included in the branches.
+ * @param OutBranches Receives the cached branches.
+ * @return True if a valid entry was found.
+ */
+bool UArticyFlowPlayer::FindCachedExploration(TArray<FCachedExploration>& Cache, bool bIncludeCurrent, TArray<FArticyBranch>& OutBranches) const
+{
+    const UObject* node = Cursor.GetObject();
+    const UArticyGlobalVariables* GVs = GetGVs();
+
+    for (int32 i = Cache.Num() - 1; i >= 0; --i)
+    {
+        FCachedExploration& entry = Cache[i];
+        if (entry.Node.Get() != node || entry.bIncludeCurrent != bIncludeCurrent || entry.GVs.Get() != GVs
+            || entry.PauseOn != PauseOn || entry.ExploreLimit != ExploreLimit || entry.ShadowLevelLimit != ShadowLevelLimit
+            || entry.bIgnoreInvalidBranches != bIgnoreInvalidBranches || entry.bMergeConvergingBranches != bMergeConvergingBranches
+            || entry.bUseFlowGraph != bUseFlowGraph)
+            continue;
+
+        bool bValid = entry.ObjectStateVersion == UArticyDatabase::GetObjectStateVersion()
+            && (!entry.Reads.bReadSeenCounters || entry.SeenVersion == GVs->GetSeenVersion());
+
+        for (auto it = entry.Reads.Variables.CreateConstIterator(); bValid && it; ++it)
+        {
+            const UArticyVariable* variable = it.Key().Get();
+            bValid = variable && variable->GetChangeVersion() == it.Value();
+        }
+
+        if (!bValid)
+        {
+            Cache.RemoveAt(i);
+            return false;
         }
 
-        //broadcast and return result
-        OnPlayerPaused.Broadcast(Cursor);
-        OnBranchesUpdated.Broadcast(AvailableBranches);
+        //move the entry to the back, so that the least recently used one is evicted first
+        if (i != Cache.Num() - 1)
+        {
+            FCachedExploration used = MoveTemp(entry);
+            Cache.RemoveAt(i);
+            Cache.Add(MoveTemp(used));
+        }
+        OutBranches = Cache.Last().Branches;
+        return true;
     }
+
+    return false;
+}
+
+/**
+ * Adds an entry to a cache of exploration results, evicting the least recently used one if the cache is full.
+ *
+ * @param Cache The cache.
+ * @param MaxSize The maximum number of entries.
+ * @param Entry The entry.
+ */
+void UArticyFlowPlayer::AddCachedExploration(TArray<FCachedExploration>& Cache, int32 MaxSize, const FCachedExploration& Entry)
+{
+    while (Cache.Num() > 0 && Cache.Num() >= MaxSize)
+        Cache.RemoveAt(0);
+    if (MaxSize > 0)
+        Cache.Add(Entry);
 }
 
 /**
@@ -630,7 +2204,98 @@ bool UArticyFlowPlayer::FastForwardToPause()
  */
 void UArticyFlowPlayer::PlayBranch(const FArticyBranch& Branch)
 {
+    if (FArticyFlowRecorder::IsEnabled())
+    {
+        const UArticyDatabase* db = GetDB();
+        const FArticyFlowGraph* recordGraph = db ? db->FindFlowGraph() : nullptr;
+        FArticyFlowRecorder::Record(EArticyFlowRecordType::Choice, recordGraph ? recordGraph->FindNode(Cast<UArticyPrimitive>(Branch.GetTarget().GetObject())) : INDEX_NONE, Branch.Index);
+    }
+
     BranchQueue.Enqueue(Branch);
+    WakeScheduler();
+}
+
+/**
+ * Starts capturing the flow of this player for a replay, see FArticyFlowReplay.
+ * The available branches are explored again with the capture, so its method results cover them.
+ */
+void UArticyFlowPlayer::StartCapture()
+{
+    UArticyGlobalVariables* GVs = GetGVs();
+    const UArticyPrimitive* cursor = Cast<UArticyPrimitive>(Cursor.GetObject());
+    if (!GVs || !cursor)
+    {
+        UE_LOG(LogArticyRuntime, Warning, TEXT("Could not start a flow capture: the flow player has no cursor or global variables."));
+        return;
+    }
+
+    Capture = MakeShared<FArticyFlowCapture>();
+    Capture->SchemaHash = GVs->GetSchemaHash();
+    GVs->SaveSnapshot(Capture->InitialState);
+    Capture->ValuesVersion = GVs->GetValuesVersion();
+    Capture->StartId = cursor->GetId();
+    Capture->bStartup = AvailableBranches.Num() > 0 && AvailableBranches[0].Path.Num() > 0 && AvailableBranches[0].Path[0] == Cursor;
+
+    Capture->PauseOn = PauseOn;
+    Capture->ExploreLimit = ExploreLimit;
+    Capture->ShadowLevelLimit = ShadowLevelLimit;
+    Capture->bIgnoreInvalidBranches = bIgnoreInvalidBranches;
+    Capture->bMergeConvergingBranches = bMergeConvergingBranches;
+    Capture->bCacheExploration = bCacheExploration;
+    Capture->ExplorationCacheSize = ExplorationCacheSize;
+    Capture->bUseFlowGraph = bUseFlowGraph;
+
+    MethodLog = &Capture->MethodResults;
+
+    // a replay starts without cached explorations
+    InvalidateExplorationCache();
+    UpdateAvailableBranchesInternal(Capture->bStartup);
+}
+
+/**
+ * Stops capturing and saves the capture.
+ *
+ * @param FilePath The file, relative paths are relative to Saved/Articy/Captures. Empty to discard the capture.
+ * @return True if the capture was saved.
+ */
+bool UArticyFlowPlayer::StopCapture(const FString& FilePath)
+{
+    TSharedPtr<FArticyFlowCapture> capture = TakeCapture();
+    return capture && !FilePath.IsEmpty() && capture->SaveToFile(FilePath);
+}
+
+/**
+ * Stops capturing.
+ *
+ * @return The capture, or nullptr if the player was not capturing.
+ */
+TSharedPtr<FArticyFlowCapture> UArticyFlowPlayer::TakeCapture()
+{
+    if (Capture)
+        MethodLog = nullptr;
+
+    return MoveTemp(Capture);
+}
+
+/**
+ * Adds a step to the capture, with the state of the global variables if they were changed outside of the flow.
+ *
+ * @param Node The target of the played branch, or the node the cursor was set to.
+ * @param BranchIndex The index passed to Play, or INDEX_NONE if the cursor was set.
+ */
+void UArticyFlowPlayer::AddCaptureStep(const TScriptInterface<IArticyFlowObject>& Node, int32 BranchIndex)
+{
+    FArticyFlowCaptureStep& step = Capture->Steps.AddDefaulted_GetRef();
+    const UArticyPrimitive* primitive = Cast<UArticyPrimitive>(Node.GetObject());
+    step.NodeId = primitive ? primitive->GetId() : FArticyId{};
+    step.BranchIndex = BranchIndex;
+
+    const UArticyGlobalVariables* GVs = GetGVs();
+    if (GVs && GVs->GetValuesVersion() != Capture->ValuesVersion)
+    {
+        GVs->SaveSnapshot(step.State);
+        Capture->ValuesVersion = GVs->GetValuesVersion();
+    }
 }
 
 /**
@@ -0,0 +1,192 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyFlowPlayerSubsystem.h"
+#include "ArticyFlowPlayer.h"
+#include "ArticyGlobalVariables.h"
+#include "ArticyPluginSettings.h"
+#include "ArticyStats.h"
+#include "Engine/World.h"
+
+namespace
+{
+	/**
+	 * How often the players are ticked again in the same tick, for the branches played by the updates of the
+	 * available branches (e.g. the fast forward on startup). The rest waits until the next tick.
+	 */
+	constexpr int32 MaxRoundsPerTick = 16;
+}
+
+/**
+ * Returns the flow player subsystem of the world of an object.
+ * @param WorldContext An object of the world.
+ * @return The subsystem, or null if the object is not part of a world.
+ */
+UArticyFlowPlayerSubsystem* UArticyFlowPlayerSubsystem::Get(const UObject* WorldContext)
+{
+	const UWorld* World = WorldContext ? WorldContext->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UArticyFlowPlayerSubsystem>() : nullptr;
+}
+
+/**
+ * Registers a player which begins play, it is ticked whenever it is woken from now on.
+ * @param Player The player.
+ */
+void UArticyFlowPlayerSubsystem::Register(UArticyFlowPlayer* Player)
+{
+	if (!Player || Player->bRegisteredWithScheduler)
+		return;
+
+	Player->bRegisteredWithScheduler = true;
+	++NumPlayers;
+
+	if (Player->HasPendingWork())
+		Wake(Player);
+}
+
+/**
+ * Unregisters a player which ends play. It stays in the schedule until the next tick, which skips it.
+ * @param Player The player.
+ */
+void UArticyFlowPlayerSubsystem::Unregister(UArticyFlowPlayer* Player)
+{
+	if (!Player || !Player->bRegisteredWithScheduler)
+		return;
+
+	Player->bRegisteredWithScheduler = false;
+	Player->bScheduled = false;
+	--NumPlayers;
+}
+
+/**
+ * Schedules a registered player for the next tick, or for the current one if it is ticking.
+ * @param Player The player, which has branches to traverse or an exploration to continue.
+ */
+void UArticyFlowPlayerSubsystem::Wake(UArticyFlowPlayer* Player)
+{
+	if (!Player || !Player->bRegisteredWithScheduler || Player->bScheduled)
+		return;
+
+	Player->bScheduled = true;
+	ScheduledPlayers.Add(Player);
+}
+
+/**
+ * Ticks the players which were woken since the last tick, and the ones their ticks wake.
+ * @param DeltaTime Unused.
+ */
+void UArticyFlowPlayerSubsystem::Tick(float DeltaTime)
+{
+	if (ScheduledPlayers.Num() == 0 && NextTickPlayers.Num() == 0)
+		return;
+
+	SCOPE_CYCLE_COUNTER(STAT_ArticyFlowScheduler);
+
+	ScheduledPlayers.Append(MoveTemp(NextTickPlayers));
+	NextTickPlayers.Reset();
+
+	//a budgeted exploration continues once per tick, even if the player is woken again
+	TSet<UArticyFlowPlayer*> Continued;
+	TArray<UArticyFlowPlayer*> Players;
+	for (int32 Round = 0; Round < MaxRoundsPerTick && ScheduledPlayers.Num() > 0; ++Round)
+	{
+		Players.Reset();
+		for (const TWeakObjectPtr<UArticyFlowPlayer>& Scheduled : ScheduledPlayers)
+		{
+			UArticyFlowPlayer* Player = Scheduled.Get();
+			if (Player && Player->bScheduled)
+			{
+				Player->bScheduled = false;
+				Players.Add(Player);
+			}
+		}
+		ScheduledPlayers.Reset();
+
+		TickPlayers(Players, Continued);
+	}
+
+	//the players which still have something to do are ticked again on the next tick
+	for (UArticyFlowPlayer* Player : Continued)
+	{
+		if (Player->bRegisteredWithScheduler && !Player->bScheduled && Player->HasPendingWork())
+		{
+			Player->bScheduled = true;
+			NextTickPlayers.Add(Player);
+		}
+	}
+	for (const TWeakObjectPtr<UArticyFlowPlayer>& Scheduled : ScheduledPlayers)
+	{
+		if (Scheduled.IsValid() && Scheduled->bScheduled)
+			NextTickPlayers.Add(Scheduled);
+	}
+	ScheduledPlayers.Reset();
+}
+
+/**
+ * Traverses the queued branches of the players, updates the available branches of the ones which traversed
+ * one, and continues their budgeted explorations.
+ * @param Players The woken players.
+ * @param Continued The players which ticked this tick already, the ones of this round are added.
+ */
+void UArticyFlowPlayerSubsystem::TickPlayers(const TArray<UArticyFlowPlayer*>& Players, TSet<UArticyFlowPlayer*>& Continued)
+{
+	//the players sharing a GV instance traverse in one change batch, so its listeners are notified once
+	TArray<TPair<UArticyGlobalVariables*, UArticyFlowPlayer*>> ByGVs;
+	ByGVs.Reserve(Players.Num());
+	for (UArticyFlowPlayer* Player : Players)
+		ByGVs.Emplace(Player->GetGVs(), Player);
+	ByGVs.StableSort([](const TPair<UArticyGlobalVariables*, UArticyFlowPlayer*>& A, const TPair<UArticyGlobalVariables*, UArticyFlowPlayer*>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	TArray<UArticyFlowPlayer*> Traversed;
+	{
+		TOptional<FArticyGvChangeBatch> ChangeBatch;
+		UArticyGlobalVariables* BatchGVs = nullptr;
+		for (const auto& Entry : ByGVs)
+		{
+			if (!ChangeBatch.IsSet() || Entry.Key != BatchGVs)
+			{
+				ChangeBatch.Reset();
+				ChangeBatch.Emplace(Entry.Key);
+				BatchGVs = Entry.Key;
+			}
+
+			if (Entry.Value->TraverseQueuedBranches())
+				Traversed.Add(Entry.Value);
+		}
+	}
+
+	if (Traversed.Num() > 1 && UArticyPluginSettings::Get()->bUpdateFlowPlayersInParallel)
+	{
+		UArticyFlowPlayer::UpdateAvailableBranchesInParallel(Traversed);
+	}
+	else
+	{
+		for (UArticyFlowPlayer* Player : Traversed)
+			Player->UpdateAvailableBranches();
+	}
+
+	//continue the budgeted explorations of the available branches and the text warmups
+	for (UArticyFlowPlayer* Player : Players)
+	{
+		bool bAlreadyContinued = false;
+		Continued.Add(Player, &bAlreadyContinued);
+		if (bAlreadyContinued || !IsValid(Player))
+			continue;
+
+		if (Player->PendingExploration.bPending && Player->ShadowLevel == 0)
+			Player->ContinuePendingExploration();
+
+		//the texts of the branch targets are resolved in the ticks after the update, see bPrewarmBranchTexts
+		Player->ContinueTextWarmups();
+	}
+}
+
+/** Returns the stat the tick is counted as. */
+TStatId UArticyFlowPlayerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UArticyFlowPlayerSubsystem, STATGROUP_Tickables);
+}
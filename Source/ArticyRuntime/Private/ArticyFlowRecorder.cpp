@@ -0,0 +1,247 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyFlowRecorder.h"
+#include "ArticyRuntimeModule.h"
+#include "Containers/CircularQueue.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include <atomic>
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarRecordFlow(
+		TEXT("Articy.RecordFlow"),
+		false,
+		TEXT("Records the flow nodes visited and the branches picked by the articy flow players, see Articy.RecordFlowFile."));
+
+	TAutoConsoleVariable<FString> CVarRecordFlowFile(
+		TEXT("Articy.RecordFlowFile"),
+		TEXT("Articy/FlowRecords.bin"),
+		TEXT("The file the articy flow records are written to, relative to the saved directory. Read when recording starts, empty to only pass the records to the sinks."));
+
+	/** The size of the ring buffer, the writer is woken well before it is full. */
+	constexpr uint32 RingCapacity = 1 << 14;
+	constexpr uint32 WakeInterval = 1024;
+
+	/** The most records taken out of the ring buffer per batch. */
+	constexpr int32 BatchSize = 1024;
+
+	/** How long the writer waits for more records before it writes the ones it has, in milliseconds. */
+	constexpr uint32 WriteInterval = 250;
+
+	constexpr uint32 FileMagic = 0x43524641; //"AFRC" in little endian
+	constexpr uint32 FileVersion = 1;
+
+	FCriticalSection SinksLock;
+	TArray<TSharedRef<IArticyFlowRecordSink, ESPMode::ThreadSafe>> Sinks;
+
+	std::atomic<uint64> NumDropped{ 0 };
+
+	/**
+	 * Owns the ring buffer and the thread which takes the records out of it.
+	 * The game thread is the only producer, the writer thread the only consumer.
+	 */
+	class FFlowRecordWriter : public FRunnable
+	{
+	public:
+
+		explicit FFlowRecordWriter(const FString& FilePath)
+			: Records(RingCapacity)
+		{
+			if (!FilePath.IsEmpty())
+			{
+				File.Reset(IFileManager::Get().CreateFileWriter(*FilePath));
+				if (File)
+				{
+					uint32 Magic = FileMagic, Version = FileVersion, RecordSize = sizeof(FArticyFlowRecord);
+					*File << Magic << Version << RecordSize;
+				}
+				else
+				{
+					UE_LOG(LogArticyRuntime, Warning, TEXT("Could not open the flow record file '%s', the records are only passed to the sinks."), *FilePath);
+				}
+			}
+
+			Batch.Reserve(BatchSize);
+			WakeEvent = FPlatformProcess::GetSynchEventFromPool();
+			Thread = FRunnableThread::Create(this, TEXT("ArticyFlowRecorder"), 0, TPri_BelowNormal);
+		}
+
+		virtual ~FFlowRecordWriter() override
+		{
+			if (Thread)
+			{
+				Thread->Kill(true);
+				delete Thread;
+			}
+
+			//the records added after the thread stopped, or all of them without multithreading
+			WriteQueued();
+			File.Reset();
+
+			FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		}
+
+		/** Adds a record, returns false if the ring buffer is full. Game thread only. */
+		bool Enqueue(const FArticyFlowRecord& Record)
+		{
+			if (!Records.Enqueue(Record))
+				return false;
+
+			if (++NumSinceWake >= WakeInterval)
+			{
+				NumSinceWake = 0;
+				if (Thread)
+					WakeEvent->Trigger();
+				else
+					WriteQueued();
+			}
+			return true;
+		}
+
+		virtual uint32 Run() override
+		{
+			while (!bStopping)
+			{
+				WakeEvent->Wait(WriteInterval);
+				WriteQueued();
+			}
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			bStopping = true;
+			WakeEvent->Trigger();
+		}
+
+	private:
+
+		/** Takes the records out of the ring buffer in batches, and writes them to the file and the sinks. */
+		void WriteQueued()
+		{
+			bool bWritten = false;
+			FArticyFlowRecord Record;
+			do
+			{
+				Batch.Reset();
+				while (Batch.Num() < BatchSize && Records.Dequeue(Record))
+					Batch.Add(Record);
+
+				if (Batch.Num() == 0)
+					break;
+
+				if (File)
+					File->Serialize(Batch.GetData(), Batch.Num() * sizeof(FArticyFlowRecord));
+
+				FScopeLock Lock(&SinksLock);
+				for (const auto& Sink : Sinks)
+					Sink->ConsumeRecords(Batch);
+
+				bWritten = true;
+			}
+			while (Batch.Num() == BatchSize);
+
+			if (bWritten && File)
+				File->Flush();
+		}
+
+		TCircularQueue<FArticyFlowRecord> Records;
+		uint32 NumSinceWake = 0;
+
+		/** Only used by the consumer. */
+		TArray<FArticyFlowRecord> Batch;
+		TUniquePtr<FArchive> File;
+
+		FEvent* WakeEvent = nullptr;
+		FRunnableThread* Thread = nullptr;
+		std::atomic<bool> bStopping{ false };
+	};
+
+	/** Created by the first record, destroyed by FArticyFlowRecorder::Shutdown. */
+	TUniquePtr<FFlowRecordWriter> Writer;
+}
+
+/**
+ * Returns true if flow events are recorded.
+ */
+bool FArticyFlowRecorder::IsEnabled()
+{
+	return CVarRecordFlow.GetValueOnAnyThread();
+}
+
+/**
+ * Adds an event to the ring buffer, or counts it as dropped if the buffer is full.
+ * The ring buffer has a single producer, so events of other threads are ignored.
+ * @param Type What the event stands for.
+ * @param NodeIndex The dense index of the node in the flow graph.
+ * @param BranchIndex The index of the branch, or INDEX_NONE.
+ */
+void FArticyFlowRecorder::Record(EArticyFlowRecordType Type, int32 NodeIndex, int32 BranchIndex)
+{
+	if (!IsInGameThread())
+		return;
+
+	if (!Writer)
+	{
+		const FString FileName = CVarRecordFlowFile.GetValueOnGameThread();
+		Writer = MakeUnique<FFlowRecordWriter>(FileName.IsEmpty() ? FString() : FPaths::ProjectSavedDir() / FileName);
+	}
+
+	FArticyFlowRecord Record;
+	Record.Timestamp = FPlatformTime::Seconds();
+	Record.NodeIndex = NodeIndex;
+	Record.BranchIndex = static_cast<int16>(FMath::Clamp<int32>(BranchIndex, INDEX_NONE, MAX_int16));
+	Record.Type = Type;
+
+	if (!Writer->Enqueue(Record))
+		NumDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Adds a sink, which receives the batches written from then on on the writer thread.
+ * @param Sink The sink.
+ */
+void FArticyFlowRecorder::AddSink(const TSharedRef<IArticyFlowRecordSink, ESPMode::ThreadSafe>& Sink)
+{
+	FScopeLock Lock(&SinksLock);
+	Sinks.AddUnique(Sink);
+}
+
+/**
+ * Removes a sink. Batches are passed to the sinks under the same lock, so the sink is not called once this returns.
+ * @param Sink The sink.
+ */
+void FArticyFlowRecorder::RemoveSink(const TSharedRef<IArticyFlowRecordSink, ESPMode::ThreadSafe>& Sink)
+{
+	FScopeLock Lock(&SinksLock);
+	Sinks.Remove(Sink);
+}
+
+/**
+ * Returns the number of records dropped because the ring buffer was full.
+ */
+uint64 FArticyFlowRecorder::GetNumDropped()
+{
+	return NumDropped.load(std::memory_order_relaxed);
+}
+
+/**
+ * Stops the writer thread after it wrote the remaining records, and closes the file. Called on module shutdown.
+ */
+void FArticyFlowRecorder::Shutdown()
+{
+	Writer.Reset();
+
+	FScopeLock Lock(&SinksLock);
+	Sinks.Reset();
+}
@@ -0,0 +1,442 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyFlowReplay.h"
+#include "ArticyDatabase.h"
+#include "ArticyFlowPlayer.h"
+#include "ArticyGlobalVariables.h"
+#include "ArticyHelpers.h"
+#include "ArticyPrimitive.h"
+#include "ArticyRuntimeModule.h"
+#include "Interfaces/ArticyFlowObject.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace
+{
+	/** The magic "AFCP" and the version of the capture files. */
+	constexpr uint32 CaptureMagic = 0x50434641;
+	constexpr uint32 CaptureVersion = 1;
+
+	void SerializeId(FArchive& Ar, FArticyId& Id)
+	{
+		Ar << Id.High;
+		Ar << Id.Low;
+	}
+
+	/** Returns the id of a flow object, or a null id. */
+	FArticyId GetNodeId(const TScriptInterface<IArticyFlowObject>& Node)
+	{
+		const UArticyPrimitive* Primitive = Cast<UArticyPrimitive>(Node.GetObject());
+		return Primitive ? Primitive->GetId() : FArticyId{};
+	}
+}
+
+void FArticyMethodResultLog::Record(const TCHAR* Method, bool Value)
+{
+	uint8 Byte = Value ? 1 : 0;
+	Write(Method, EValueType::Bool, Byte);
+}
+
+void FArticyMethodResultLog::Record(const TCHAR* Method, int32 Value)
+{
+	Write(Method, EValueType::Int, Value);
+}
+
+void FArticyMethodResultLog::Record(const TCHAR* Method, float Value)
+{
+	Write(Method, EValueType::Float, Value);
+}
+
+void FArticyMethodResultLog::Record(const TCHAR* Method, const FString& Value)
+{
+	FString Copy = Value;
+	Write(Method, EValueType::String, Copy);
+}
+
+void FArticyMethodResultLog::Record(const TCHAR* Method, const UArticyPrimitive* Value)
+{
+	FArticyId Id = Value ? Value->GetId() : FArticyId{};
+	uint64 Packed = ((uint64)Id.High << 32) | Id.Low;
+	Write(Method, EValueType::Object, Packed);
+}
+
+void FArticyMethodResultLog::Replay(const TCHAR* Method, bool& OutValue)
+{
+	uint8 Byte = 0;
+	if (Read(Method, EValueType::Bool, Byte))
+		OutValue = Byte != 0;
+}
+
+void FArticyMethodResultLog::Replay(const TCHAR* Method, int32& OutValue)
+{
+	Read(Method, EValueType::Int, OutValue);
+}
+
+void FArticyMethodResultLog::Replay(const TCHAR* Method, float& OutValue)
+{
+	Read(Method, EValueType::Float, OutValue);
+}
+
+void FArticyMethodResultLog::Replay(const TCHAR* Method, FString& OutValue)
+{
+	Read(Method, EValueType::String, OutValue);
+}
+
+void FArticyMethodResultLog::Replay(const TCHAR* Method, UArticyPrimitive*& OutValue)
+{
+	uint64 Packed = 0;
+	if (!Read(Method, EValueType::Object, Packed))
+		return;
+
+	FArticyId Id;
+	Id.High = (uint32)(Packed >> 32);
+	Id.Low = (uint32)Packed;
+	const UArticyDatabase* Db = Database.Get();
+	OutValue = Db && !Id.IsNull() ? Db->GetObject(Id) : nullptr;
+}
+
+/**
+ * Rewinds the streams and switches to replaying.
+ * @param InDatabase The database the recorded objects are looked up in.
+ */
+void FArticyMethodResultLog::StartReplay(const UArticyDatabase* InDatabase)
+{
+	for (auto& Pair : Streams)
+		Pair.Value.ReadOffset = 0;
+
+	Database = InDatabase;
+	bReplaying = true;
+	NumDivergences = 0;
+}
+
+/**
+ * Returns the number of results recorded.
+ * @return The results of all methods.
+ */
+int32 FArticyMethodResultLog::GetNumResults() const
+{
+	int32 NumResults = 0;
+	for (const auto& Pair : Streams)
+		NumResults += Pair.Value.NumValues;
+	return NumResults;
+}
+
+/**
+ * Saves or loads the streams, by the names of the methods.
+ * @param Ar The archive.
+ */
+void FArticyMethodResultLog::Serialize(FArchive& Ar)
+{
+	int32 NumStreams = Streams.Num();
+	Ar << NumStreams;
+
+	if (Ar.IsLoading())
+	{
+		Streams.Reset();
+		for (int32 Index = 0; Index < NumStreams && !Ar.IsError(); ++Index)
+		{
+			FString Name;
+			uint8 Type = 0;
+			Ar << Name;
+			Ar << Type;
+
+			FStream& Stream = Streams.Add(FName(*Name));
+			Stream.Type = (EValueType)Type;
+			Ar << Stream.NumValues;
+			Ar << Stream.Bytes;
+		}
+		return;
+	}
+
+	for (auto& Pair : Streams)
+	{
+		FString Name = Pair.Key.ToString();
+		uint8 Type = (uint8)Pair.Value.Type;
+		Ar << Name;
+		Ar << Type;
+		Ar << Pair.Value.NumValues;
+		Ar << Pair.Value.Bytes;
+	}
+}
+
+/**
+ * Appends a value to the stream of a method.
+ * @param Method The name of the method.
+ * @param Type The type of the results of the method.
+ * @param Value The value, serialized as it is.
+ */
+template<typename T>
+void FArticyMethodResultLog::Write(const TCHAR* Method, EValueType Type, T& Value)
+{
+	const FName Name(Method);
+	FStream* Stream = Streams.Find(Name);
+	if (!Stream)
+	{
+		Stream = &Streams.Add(Name);
+		Stream->Type = Type;
+	}
+	else if (Stream->Type != Type)
+	{
+		return;
+	}
+
+	FMemoryWriter Writer(Stream->Bytes);
+	Writer.Seek(Stream->Bytes.Num());
+	Writer << Value;
+	++Stream->NumValues;
+}
+
+/**
+ * Reads the next value of the stream of a method.
+ * @param Method The name of the method.
+ * @param Type The type of the results of the method.
+ * @param OutValue Receives the value.
+ * @return False if the replay diverged: the stream is missing, exhausted or of another type.
+ */
+template<typename T>
+bool FArticyMethodResultLog::Read(const TCHAR* Method, EValueType Type, T& OutValue)
+{
+	//FNAME_Find: a method without results has no name to add
+	FStream* Stream = Streams.Find(FName(Method, FNAME_Find));
+	if (!Stream || Stream->Type != Type || Stream->ReadOffset >= Stream->Bytes.Num())
+	{
+		++NumDivergences;
+		return false;
+	}
+
+	FMemoryReader Reader(Stream->Bytes);
+	Reader.Seek(Stream->ReadOffset);
+	Reader << OutValue;
+	Stream->ReadOffset = Reader.Tell();
+	return !Reader.IsError();
+}
+
+//---------------------------------------------------------------------------//
+
+/**
+ * Saves or loads the capture.
+ * @param Ar The archive, set to error if it does not contain a capture of this version.
+ */
+void FArticyFlowCapture::Serialize(FArchive& Ar)
+{
+	uint32 Magic = CaptureMagic;
+	uint32 Version = CaptureVersion;
+	Ar << Magic;
+	Ar << Version;
+	if (Magic != CaptureMagic || Version != CaptureVersion)
+	{
+		Ar.SetError();
+		return;
+	}
+
+	Ar << SchemaHash;
+	Ar << InitialState;
+	SerializeId(Ar, StartId);
+	Ar << bStartup;
+
+	Ar << PauseOn;
+	Ar << ExploreLimit;
+	Ar << ShadowLevelLimit;
+	Ar << bIgnoreInvalidBranches;
+	Ar << bMergeConvergingBranches;
+	Ar << bCacheExploration;
+	Ar << ExplorationCacheSize;
+	Ar << bUseFlowGraph;
+
+	int32 NumSteps = Steps.Num();
+	Ar << NumSteps;
+	if (Ar.IsLoading())
+		Steps.SetNum(FMath::Max(0, NumSteps));
+	for (FArticyFlowCaptureStep& Step : Steps)
+	{
+		if (Ar.IsError())
+			break;
+
+		SerializeId(Ar, Step.NodeId);
+		Ar << Step.BranchIndex;
+		Ar << Step.State;
+	}
+
+	MethodResults.Serialize(Ar);
+}
+
+/**
+ * Saves the capture to a file.
+ * @param Filename The file, relative paths are relative to Saved/Articy/Captures.
+ * @return True if the file was written.
+ */
+bool FArticyFlowCapture::SaveToFile(const FString& Filename)
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	Serialize(Writer);
+
+	const FString Path = GetCapturePath(Filename);
+	if (!FFileHelper::SaveArrayToFile(Bytes, *Path))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Failed to write the flow capture %s."), *Path);
+		return false;
+	}
+
+	UE_LOG(LogArticyRuntime, Display, TEXT("Wrote the flow capture with %d steps and %d method results to %s."), Steps.Num(), MethodResults.GetNumResults(), *Path);
+	return true;
+}
+
+/**
+ * Loads a capture written by SaveToFile.
+ * @param Filename The file, relative paths are relative to Saved/Articy/Captures.
+ * @return False if the file is missing or invalid.
+ */
+bool FArticyFlowCapture::LoadFromFile(const FString& Filename)
+{
+	const FString Path = GetCapturePath(Filename);
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Failed to read the flow capture %s."), *Path);
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	Serialize(Reader);
+	if (Reader.IsError())
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("%s is not a flow capture of this version."), *Path);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Returns the path of a capture file.
+ * @param Filename The file.
+ * @return The file, relative to Saved/Articy/Captures if it is relative.
+ */
+FString FArticyFlowCapture::GetCapturePath(const FString& Filename)
+{
+	return ArticyHelpers::GetSavedPath(TEXT("Captures"), Filename);
+}
+
+//---------------------------------------------------------------------------//
+
+/**
+ * Replays a capture with a headless flow player, and logs the result.
+ * @param WorldContext The world whose database and global variables are used.
+ * @param Capture The capture to replay.
+ * @param OutResult Receives the outcome.
+ * @return False if the capture could not be replayed.
+ */
+bool FArticyFlowReplay::Run(const UObject* WorldContext, const FArticyFlowCapture& Capture, FArticyFlowReplayResult& OutResult)
+{
+	OutResult = FArticyFlowReplayResult{};
+
+	UArticyDatabase* Database = UArticyDatabase::Get(WorldContext);
+	UArticyGlobalVariables* WorldGVs = UArticyGlobalVariables::GetDefault(WorldContext);
+	if (!Database || !WorldGVs)
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Could not replay the flow capture: no articy database or global variables."));
+		return false;
+	}
+
+	if (WorldGVs->GetSchemaHash() != Capture.SchemaHash)
+		UE_LOG(LogArticyRuntime, Warning, TEXT("The flow capture was made with other global variables, they are restored by name."));
+
+	UObject* Start = Database->GetObject(Capture.StartId);
+	if (!Start || !Start->Implements<UArticyFlowObject>())
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Could not replay the flow capture: the start node %s does not exist."), *Capture.StartId.ToString());
+		return false;
+	}
+
+	// the replay runs on a fork of the variables of the world, so it doesn't change them
+	TStrongObjectPtr<UArticyGlobalVariables> GVs(WorldGVs->Fork(Database, TEXT("ArticyReplayVariables")));
+	if (!GVs->LoadSnapshot(Capture.InitialState))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Could not replay the flow capture: the initial state is invalid."));
+		return false;
+	}
+
+	UArticyFlowPlayer* Player = NewObject<UArticyFlowPlayer>(Database);
+	TStrongObjectPtr<UArticyFlowPlayer> PlayerReference(Player);
+	Player->PauseOn = Capture.PauseOn;
+	Player->ExploreLimit = Capture.ExploreLimit;
+	Player->ShadowLevelLimit = Capture.ShadowLevelLimit;
+	Player->bIgnoreInvalidBranches = Capture.bIgnoreInvalidBranches;
+	Player->bMergeConvergingBranches = Capture.bMergeConvergingBranches;
+	Player->bCacheExploration = Capture.bCacheExploration;
+	Player->ExplorationCacheSize = Capture.ExplorationCacheSize;
+	Player->bUseFlowGraph = Capture.bUseFlowGraph;
+
+	// the player has no actor to find a methods provider on, the methods return the recorded results
+	Player->UserMethodsProvider = nullptr;
+	Player->ResolvedMethodsProvider = nullptr;
+	Player->bMethodsProviderResolved = true;
+
+	Player->ExploreContext.GVs = GVs.Get();
+	Player->ExploreContext.ExpressoInstance = Database->GetExpressoInstance();
+
+	// the object writes of the replay go to a shadow state of the database, which is popped at the end
+	const uint32 DatabaseShadowLevel = Database->GetShadowLevel() + 1;
+	Database->PushState(DatabaseShadowLevel);
+	Player->ExploreContext.DatabaseShadowLevel = DatabaseShadowLevel;
+
+	FArticyMethodResultLog MethodResults = Capture.MethodResults;
+	MethodResults.StartReplay(Database);
+	Player->MethodLog = &MethodResults;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	Player->Cursor = TScriptInterface<IArticyFlowObject>(Start);
+	Player->UpdateAvailableBranchesInternal(Capture.bStartup);
+	for (const FArticyFlowCaptureStep& Step : Capture.Steps)
+	{
+		++OutResult.NumSteps;
+
+		if (Step.State.Num() > 0)
+			GVs->LoadSnapshot(Step.State);
+
+		if (Step.BranchIndex == INDEX_NONE)
+		{
+			UObject* Node = Database->GetObject(Step.NodeId);
+			if (Node && Node->Implements<UArticyFlowObject>())
+				Player->SetCursorTo(TScriptInterface<IArticyFlowObject>(Node));
+			else
+				++OutResult.NumFailedSteps;
+		}
+		else
+		{
+			const int32 Index = Player->GetPlayableBranchIndex(Step.BranchIndex);
+			if (Index != INDEX_NONE && GetNodeId(Player->AvailableBranches[Index].GetTarget()) == Step.NodeId)
+				Player->PlayBranch(Player->AvailableBranches[Index]);
+			else
+				++OutResult.NumFailedSteps;
+		}
+
+		while (Player->HasPendingWork())
+			Player->OnTick(0.f);
+
+		OutResult.Cursors.Add(GetNodeId(Player->Cursor));
+	}
+
+	OutResult.Seconds = FPlatformTime::Seconds() - StartTime;
+	OutResult.NumDivergences = MethodResults.GetNumDivergences();
+	Player->MethodLog = nullptr;
+
+	Database->PopState(DatabaseShadowLevel);
+	Player->ExploreContext.DatabaseShadowLevel = 0;
+
+	TArray<uint8> FinalState;
+	if (GVs->SaveSnapshot(FinalState))
+		OutResult.FinalStateHash = FCrc::MemCrc32(FinalState.GetData(), FinalState.Num());
+
+	UE_LOG(LogArticyRuntime, Display, TEXT("Replayed %d steps in %.3f ms: %d failed steps, %d diverged method calls, final state 0x%08x."),
+		OutResult.NumSteps, OutResult.Seconds * 1000.0, OutResult.NumFailedSteps, OutResult.NumDivergences, OutResult.FinalStateHash);
+	return true;
+}
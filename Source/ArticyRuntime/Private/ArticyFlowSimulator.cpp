@@ -0,0 +1,503 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyFlowSimulator.h"
+#include "ArticyDatabase.h"
+#include "ArticyExpressoScripts.h"
+#include "ArticyFlowGraph.h"
+#include "ArticyFlowPlayer.h"
+#include "ArticyGlobalVariables.h"
+#include "ArticyHelpers.h"
+#include "ArticyObject.h"
+#include "ArticyRuntimeModule.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/StrongObjectPtr.h"
+#include <atomic>
+
+namespace
+{
+	/** Nodes are reported, the pins are attributed to the node they belong to. */
+	bool IsPin(const FArticyFlowGraphNode& Node)
+	{
+		return Node.Owner != INDEX_NONE;
+	}
+
+	/**
+	 * Finds the unshadowed start object, which is the one the flow graph knows.
+	 * @param Start The id, in decimal or with a 0x prefix in hex, or the technical name of the object.
+	 */
+	UArticyObject* FindStart(const UArticyDatabase* Database, const FString& Start)
+	{
+		uint64 Id = 0;
+		if (Start.StartsWith(TEXT("0x")))
+			Id = FCString::Strtoui64(*Start + 2, nullptr, 16);
+		else if (Start.IsNumeric())
+			Id = FCString::Strtoui64(*Start, nullptr, 10);
+		else if (const UArticyObject* Named = Database->GetObjectByName(*Start))
+			Id = Named->GetId();
+
+		return Id ? Database->GetObjectUnshadowed(Id) : nullptr;
+	}
+
+	/**
+	 * Marks the nodes which can be reached from the start by following the connections, regardless of the scripts.
+	 * Nodes continue on their input pins (submerging) and output pins, pins and jumps on their targets, and input
+	 * pins without connections on their owner.
+	 */
+	TBitArray<> FindReachableNodes(const FArticyFlowGraph& Graph, int32 StartIndex)
+	{
+		TBitArray<> Reachable(false, Graph.Num());
+		TArray<int32> Worklist;
+		Worklist.Add(StartIndex);
+		Reachable[StartIndex] = true;
+
+		const auto Visit = [&](int32 Index)
+		{
+			if (Index != INDEX_NONE && !Reachable[Index])
+			{
+				Reachable[Index] = true;
+				Worklist.Add(Index);
+			}
+		};
+
+		for (int32 Next = 0; Next < Worklist.Num(); ++Next)
+		{
+			const FArticyFlowGraphNode& Node = Graph.GetNode(Worklist[Next]);
+			if (IsPin(Node) || Node.Kind == EArticyFlowGraphNodeKind::Jump)
+			{
+				for (const int32 Target : Graph.GetTargets(Node))
+					Visit(Target);
+				if (Node.Kind == EArticyFlowGraphNodeKind::InputPin)
+					Visit(Node.Owner);
+			}
+			else
+			{
+				for (const int32 Pin : Graph.GetInputs(Node))
+					Visit(Pin);
+				for (const int32 Pin : Graph.GetOutputs(Node))
+					Visit(Pin);
+			}
+		}
+		return Reachable;
+	}
+
+	FString GetNodeName(const FArticyFlowGraphNode& Node)
+	{
+		const UArticyObject* Object = Cast<UArticyObject>(Node.Object);
+		return Object ? Object->GetTechnicalName().ToString() : FString();
+	}
+}
+
+/**
+ * Reads the configuration from the arguments of the console command, or from the command line of the commandlet.
+ *
+ * @param Params The arguments, separated by spaces.
+ * @return The configuration, with the defaults for the parameters which are not given.
+ */
+FArticyFlowSimulatorConfig FArticyFlowSimulatorConfig::FromArgs(const TCHAR* Params)
+{
+	FArticyFlowSimulatorConfig Config;
+	FParse::Value(Params, TEXT("Start="), Config.Start);
+	FParse::Value(Params, TEXT("Playthroughs="), Config.Playthroughs);
+	FParse::Value(Params, TEXT("MaxSteps="), Config.MaxSteps);
+	FParse::Value(Params, TEXT("Workers="), Config.Workers);
+	FParse::Value(Params, TEXT("Seed="), Config.Seed);
+	FParse::Value(Params, TEXT("MaxSeconds="), Config.MaxSeconds);
+	FParse::Value(Params, TEXT("Results="), Config.ResultsPath);
+
+	Config.Playthroughs = ArticyHelpers::ClampParameter(TEXT("Flow simulation"), TEXT("Playthroughs"), Config.Playthroughs, 1, MAX_int32 - 1024);
+	Config.MaxSteps = ArticyHelpers::ClampParameter(TEXT("Flow simulation"), TEXT("MaxSteps"), Config.MaxSteps, 1, 1000000);
+	Config.Workers = ArticyHelpers::ClampParameter(TEXT("Flow simulation"), TEXT("Workers"), Config.Workers, 0, 256);
+	Config.MaxSeconds = FMath::Max(Config.MaxSeconds, 0.0);
+	return Config;
+}
+
+/** Returns the configuration for the simulation results. */
+TSharedRef<FJsonObject> FArticyFlowSimulatorConfig::ToJson() const
+{
+	const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetStringField(TEXT("Start"), Start);
+	Json->SetNumberField(TEXT("Playthroughs"), Playthroughs);
+	Json->SetNumberField(TEXT("MaxSteps"), MaxSteps);
+	Json->SetNumberField(TEXT("Workers"), Workers);
+	Json->SetNumberField(TEXT("Seed"), Seed);
+	Json->SetNumberField(TEXT("MaxSeconds"), MaxSeconds);
+	return Json;
+}
+
+/**
+ * Adds the playthroughs of another worker.
+ * @param Other The stats of the worker, with nodes indexed like these.
+ */
+void FArticyFlowSimulator::FStats::Append(const FStats& Other)
+{
+	Playthroughs += Other.Playthroughs;
+	Steps += Other.Steps;
+	DeadEnds += Other.DeadEnds;
+	Endings += Other.Endings;
+	StepLimits += Other.StepLimits;
+
+	Nodes.SetNum(FMath::Max(Nodes.Num(), Other.Nodes.Num()));
+	for (int32 Index = 0; Index < Other.Nodes.Num(); ++Index)
+	{
+		FNodeStats& Node = Nodes[Index];
+		const FNodeStats& OtherNode = Other.Nodes[Index];
+		Node.Visits += OtherNode.Visits;
+		Node.DeadEnds += OtherNode.DeadEnds;
+		Node.Endings += OtherNode.Endings;
+		Node.Explorations += OtherNode.Explorations;
+		Node.ExploreCycles += OtherNode.ExploreCycles;
+		Node.ExecuteCycles += OtherNode.ExecuteCycles;
+	}
+}
+
+/**
+ * Runs the playthroughs on worker threads, see the declaration.
+ *
+ * @param WorldContext The object to get the database and global variables from.
+ * @param Config The start node and number of playthroughs.
+ * @return False if the simulation could not be run.
+ */
+bool FArticyFlowSimulator::Run(const UObject* WorldContext, const FArticyFlowSimulatorConfig& Config)
+{
+	check(IsInGameThread());
+
+	UArticyDatabase* Database = UArticyDatabase::Get(WorldContext);
+	UArticyGlobalVariables* WorldGVs = Database ? UArticyGlobalVariables::GetDefault(WorldContext) : nullptr;
+	if (!Database || !WorldGVs)
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("The flow simulation needs the database and global variables of an articy import."));
+		return false;
+	}
+
+	const FArticyFlowGraph& Graph = Database->GetFlowGraph();
+	const UArticyObject* Start = FindStart(Database, Config.Start);
+	const int32 StartIndex = Graph.FindNode(Start);
+	if (StartIndex == INDEX_NONE)
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("The start node '%s' of the flow simulation is not part of the flow graph, pass its id or technical name with Start=."), *Config.Start);
+		return false;
+	}
+
+	// writes to the objects are only possible on the game thread, and are undone by a shadow state of the database
+	const bool bWritesObjects = Graph.GetNode(StartIndex).bMayWriteObjects;
+	int32 NumWorkers = FMath::Min(Config.Workers > 0 ? Config.Workers : FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads()), Config.Playthroughs);
+	if (bWritesObjects && NumWorkers > 1)
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("Scripts reachable from '%s' may write objects, the playthroughs run on the game thread one after another."), *Config.Start);
+		NumWorkers = 1;
+	}
+	UE_LOG(LogArticyRuntime, Display, TEXT("Simulating %d playthroughs from %s on %d workers..."), Config.Playthroughs, *ArticyHelpers::Uint64ToPaddedHex(Start->GetId()), NumWorkers);
+
+	// every playthrough starts with the state the variables of the world have now
+	TStrongObjectPtr<UArticyGlobalVariables> InitialGVs(WorldGVs->Fork(Database, TEXT("ArticySimulationVariables")));
+	UObject* MethodsProvider = Database->GetExpressoInstance()->GetDefaultUserMethodsProvider();
+
+	// resolve everything the players would look up, as only the game thread may do so
+	TArray<FWorker> Workers;
+	TArray<TStrongObjectPtr<UObject>> References;
+	Workers.SetNum(NumWorkers);
+	for (int32 Index = 0; Index < NumWorkers; ++Index)
+	{
+		FWorker& Worker = Workers[Index];
+		Worker.GVs = InitialGVs->Fork(Database, *FString::Printf(TEXT("ArticySimulationVariables%d"), Index));
+		Worker.Player = NewObject<UArticyFlowPlayer>(Database);
+		References.Emplace(Worker.GVs);
+		References.Emplace(Worker.Player);
+
+		UArticyFlowPlayer* Player = Worker.Player;
+		Player->bUseFlowGraph = true;
+		Player->bCacheExploration = false;
+
+		// the player has no actor to find a methods provider on, the default one of the database is used
+		Player->UserMethodsProvider = nullptr;
+		Player->ResolvedMethodsProvider = nullptr;
+		Player->bMethodsProviderResolved = true;
+
+		Player->ExploreContext.Database = Database;
+		Player->ExploreContext.GVs = Worker.GVs;
+		Player->ExploreContext.ExpressoInstance = Database->GetParallelExpressoInstance(Index);
+		Player->ExploreContext.MethodsProvider = MethodsProvider;
+		Player->ExploreContext.bShadowDatabase = bWritesObjects;
+		Worker.bShadowObjects = bWritesObjects;
+
+		Worker.Stats.Nodes.SetNum(Graph.Num());
+	}
+
+	// the workers take the next playthrough until all are done, so the seeds don't depend on the number of workers
+	std::atomic<int32> NextPlaythrough{ 0 };
+	std::atomic<int32> NumCompleted{ 0 };
+	const int32 ProgressInterval = FMath::Max(1, Config.Playthroughs / 10);
+	const double StartTime = FPlatformTime::Seconds();
+	const double Deadline = Config.MaxSeconds > 0.0 ? StartTime + Config.MaxSeconds : 0.0;
+
+	ParallelFor(NumWorkers, [&](int32 Index)
+	{
+		FWorker& Worker = Workers[Index];
+		for (int32 Playthrough = NextPlaythrough++; Playthrough < Config.Playthroughs; Playthrough = NextPlaythrough++)
+		{
+			if (Deadline > 0.0 && FPlatformTime::Seconds() > Deadline)
+				break;
+
+			RunPlaythrough(Graph, StartIndex, InitialGVs.Get(), Config, static_cast<int32>(HashCombine(Config.Seed, Playthrough)), Worker);
+
+			const int32 Completed = ++NumCompleted;
+			if (Completed % ProgressInterval == 0)
+			{
+				UE_LOG(LogArticyRuntime, Display, TEXT("  %d of %d playthroughs done."), Completed, Config.Playthroughs);
+			}
+		}
+	}, bWritesObjects ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	FStats Stats;
+	for (FWorker& Worker : Workers)
+	{
+		Worker.Player->ExploreContext = UArticyFlowPlayer::FExploreContext{};
+		Stats.Append(Worker.Stats);
+	}
+
+	WriteResults(Graph, StartIndex, Config, Stats, Seconds);
+	return true;
+}
+
+/**
+ * Walks one playthrough: plays random valid branches from the start until none is left or the step limit is reached.
+ * The branches are traversed like UArticyFlowPlayer::TraverseBranch does, but with the expresso scripts instance
+ * of the worker, so no shared state is touched. If the scripts may write objects, the playthrough runs in a shadow
+ * state of the database, which undoes the writes when it is popped.
+ *
+ * @param Graph The flow graph of the database.
+ * @param StartIndex The node the playthrough starts at.
+ * @param InitialGVs The state of the variables and seen counters the playthrough starts with.
+ * @param Config The step limit.
+ * @param Seed The seed of the branch choices.
+ * @param Worker The player and variables to use, and the stats to record the playthrough in.
+ */
+void FArticyFlowSimulator::RunPlaythrough(const FArticyFlowGraph& Graph, int32 StartIndex, const UArticyGlobalVariables* InitialGVs, const FArticyFlowSimulatorConfig& Config, int32 Seed, FWorker& Worker)
+{
+	UArticyFlowPlayer* Player = Worker.Player;
+	UArticyGlobalVariables* GVs = Worker.GVs;
+	UArticyExpressoScripts* ExpressoInstance = Player->GetExpressoInstance();
+	UObject* MethodsProvider = Player->GetMethodsProvider();
+	FStats& Stats = Worker.Stats;
+
+	GVs->CopyStateFrom(InitialGVs);
+	FRandomStream Random(Seed);
+
+	const FArticyFlowGraphNode& StartNode = Graph.GetNode(StartIndex);
+	Player->Cursor.SetObject(StartNode.Object);
+	Player->Cursor.SetInterface(StartNode.FlowObject);
+
+	++Stats.Playthroughs;
+
+	// the object writes of a playthrough which may write objects go to a shadow state, which is popped at the end
+	auto Play = [&]
+	{
+		int32 CursorIndex = StartIndex;
+		TArray<int32, TInlineAllocator<16>> ValidBranches;
+		for (int32 Step = 0; Step < Config.MaxSteps; ++Step)
+		{
+			// the first exploration includes the start node, like the one of a player starting on it
+			FNodeStats& CursorStats = Stats.Nodes[CursorIndex];
+			const uint64 ExploreStart = FPlatformTime::Cycles64();
+			Player->ExploreAvailableBranches(Step == 0, nullptr);
+			CursorStats.ExploreCycles += FPlatformTime::Cycles64() - ExploreStart;
+			++CursorStats.Explorations;
+
+			const TArray<FArticyBranch>& Branches = Player->AvailableBranches;
+			ValidBranches.Reset();
+			for (int32 Index = 0; Index < Branches.Num(); ++Index)
+			{
+				if (Branches[Index].bIsValid && Branches[Index].Path.Num() > 0)
+					ValidBranches.Add(Index);
+			}
+
+			if (ValidBranches.Num() == 0)
+			{
+				if (HasConnections(Graph, CursorIndex))
+				{
+					++CursorStats.DeadEnds;
+					++Stats.DeadEnds;
+				}
+				else
+				{
+					++CursorStats.Endings;
+					++Stats.Endings;
+				}
+				return;
+			}
+
+			const FArticyBranch& Branch = Branches[ValidBranches[Random.RandHelper(ValidBranches.Num())]];
+			int32 NodeIndex = INDEX_NONE;
+			for (const TScriptInterface<IArticyFlowObject>& PathNode : Branch.Path)
+			{
+				NodeIndex = Graph.FindNode(Cast<UArticyPrimitive>(PathNode.GetObject()));
+				if (NodeIndex == INDEX_NONE)
+					continue;
+
+				const FArticyFlowGraphNode& Node = Graph.GetNode(NodeIndex);
+				if (Node.Kind == EArticyFlowGraphNodeKind::OutputPin || (Node.Kind == EArticyFlowGraphNodeKind::Instruction && Node.bHasScript))
+				{
+					const uint64 ExecuteStart = FPlatformTime::Cycles64();
+					Player->SetScriptContext(Graph, Node);
+					ExpressoInstance->ExecuteByIndex(Node.ScriptIndex, Node.ScriptHash, GVs, MethodsProvider);
+					Stats.Nodes[IsPin(Node) ? Node.Owner : NodeIndex].ExecuteCycles += FPlatformTime::Cycles64() - ExecuteStart;
+				}
+
+				GVs->IncrementSeenCounter(Node.FlowObject);
+				++Stats.Nodes[NodeIndex].Visits;
+			}
+			++Stats.Steps;
+
+			// the paths consist of graph nodes, a branch ending elsewhere cannot be continued
+			if (NodeIndex == INDEX_NONE)
+			{
+				++CursorStats.DeadEnds;
+				++Stats.DeadEnds;
+				return;
+			}
+
+			Player->Cursor = Branch.Path.Last();
+			CursorIndex = NodeIndex;
+		}
+
+		++Stats.StepLimits;
+	};
+
+	if (Worker.bShadowObjects)
+		Player->ShadowedOperation(Play);
+	else
+		Play();
+}
+
+/**
+ * Checks whether a graph node continues somewhere, so that an exploration from it which finds no valid branch
+ * is a dead end rather than the end of the flow.
+ *
+ * @param Graph The flow graph of the database.
+ * @param Index The node.
+ * @return True if the node has connected input or output pins, or the pin or jump has targets.
+ */
+bool FArticyFlowSimulator::HasConnections(const FArticyFlowGraph& Graph, int32 Index)
+{
+	const FArticyFlowGraphNode& Node = Graph.GetNode(Index);
+	if (IsPin(Node) || Node.Kind == EArticyFlowGraphNodeKind::Jump)
+		return Node.NumTargets > 0;
+
+	for (const int32 Pin : Graph.GetInputs(Node))
+	{
+		if (Graph.GetNode(Pin).NumTargets > 0)
+			return true;
+	}
+	for (const int32 Pin : Graph.GetOutputs(Node))
+	{
+		if (Graph.GetNode(Pin).NumTargets > 0)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Logs the results and writes them to Saved/Articy/Simulation/FlowSimulationResults.json and .csv.
+ * The json has the totals, the coverage and the nodes which ended playthroughs most often, the csv has every node.
+ *
+ * @param Graph The flow graph the stats are indexed like.
+ * @param StartIndex The node the playthroughs started at.
+ * @param Config The configuration, written along with the results.
+ * @param Stats The merged stats of all workers.
+ * @param Seconds The time the playthroughs took.
+ */
+void FArticyFlowSimulator::WriteResults(const FArticyFlowGraph& Graph, int32 StartIndex, const FArticyFlowSimulatorConfig& Config, const FStats& Stats, double Seconds)
+{
+	const TBitArray<> Reachable = FindReachableNodes(Graph, StartIndex);
+
+	int32 NumNodes = 0, NumReachable = 0, NumVisited = 0;
+	TArray<int32> DeadEndNodes, UnvisitedNodes;
+	FString Csv = TEXT("Id,TechnicalName,Class,Reachable,Visits,DeadEnds,Endings,Explorations,ExploreNsPerExploration,ExecuteNsPerVisit\n");
+
+	for (int32 Index = 0; Index < Graph.Num(); ++Index)
+	{
+		const FArticyFlowGraphNode& Node = Graph.GetNode(Index);
+		if (IsPin(Node) || !Node.Object)
+			continue;
+
+		const FNodeStats& NodeStats = Stats.Nodes[Index];
+		++NumNodes;
+		if (Reachable[Index])
+		{
+			++NumReachable;
+			if (NodeStats.Visits == 0)
+				UnvisitedNodes.Add(Index);
+		}
+		if (NodeStats.Visits > 0)
+			++NumVisited;
+		if (NodeStats.DeadEnds > 0)
+			DeadEndNodes.Add(Index);
+
+		const double ExploreNs = NodeStats.Explorations > 0 ? FPlatformTime::ToSeconds64(NodeStats.ExploreCycles) / NodeStats.Explorations * 1e9 : 0.0;
+		const double ExecuteNs = NodeStats.Visits > 0 ? FPlatformTime::ToSeconds64(NodeStats.ExecuteCycles) / NodeStats.Visits * 1e9 : 0.0;
+		Csv += FString::Printf(TEXT("%s,%s,%s,%d,%lld,%lld,%lld,%lld,%.1f,%.1f\n"), *ArticyHelpers::Uint64ToPaddedHex(Node.Object->GetId()), *GetNodeName(Node), *Node.Object->GetClass()->GetName(),
+			Reachable[Index] ? 1 : 0, NodeStats.Visits, NodeStats.DeadEnds, NodeStats.Endings, NodeStats.Explorations, ExploreNs, ExecuteNs);
+	}
+
+	DeadEndNodes.Sort([&Stats](int32 A, int32 B) { return Stats.Nodes[A].DeadEnds > Stats.Nodes[B].DeadEnds; });
+
+	const double Coverage = NumReachable > 0 ? 100.0 * (NumReachable - UnvisitedNodes.Num()) / NumReachable : 0.0;
+	UE_LOG(LogArticyRuntime, Display, TEXT("Simulated %lld playthroughs with %lld branches in %.1f s."), Stats.Playthroughs, Stats.Steps, Seconds);
+	UE_LOG(LogArticyRuntime, Display, TEXT("  %lld ended, %lld at dead ends, %lld at the step limit."), Stats.Endings, Stats.DeadEnds, Stats.StepLimits);
+	UE_LOG(LogArticyRuntime, Display, TEXT("  %d of %d nodes reachable from the start were visited (%.1f%%), %d flow nodes in total."), NumReachable - UnvisitedNodes.Num(), NumReachable, Coverage, NumNodes);
+
+	const int32 NumLogged = FMath::Min(DeadEndNodes.Num(), 10);
+	for (int32 Rank = 0; Rank < NumLogged; ++Rank)
+	{
+		const FArticyFlowGraphNode& Node = Graph.GetNode(DeadEndNodes[Rank]);
+		UE_LOG(LogArticyRuntime, Display, TEXT("  dead end %s %s: %lld times"), *ArticyHelpers::Uint64ToPaddedHex(Node.Object->GetId()), *GetNodeName(Node), Stats.Nodes[DeadEndNodes[Rank]].DeadEnds);
+	}
+
+	const auto MakeNodes = [&Graph, &Stats](const TArray<int32>& Indices)
+	{
+		TArray<TSharedPtr<FJsonValue>> Nodes;
+		for (const int32 Index : Indices)
+		{
+			const FArticyFlowGraphNode& Node = Graph.GetNode(Index);
+			const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetStringField(TEXT("Id"), ArticyHelpers::Uint64ToPaddedHex(Node.Object->GetId()));
+			Json->SetStringField(TEXT("TechnicalName"), GetNodeName(Node));
+			Json->SetNumberField(TEXT("DeadEnds"), Stats.Nodes[Index].DeadEnds);
+			Nodes.Add(MakeShared<FJsonValueObject>(Json));
+		}
+		return Nodes;
+	};
+
+	const TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetObjectField(TEXT("Config"), Config.ToJson());
+	Root->SetStringField(TEXT("BuildConfiguration"), LexToString(FApp::GetBuildConfiguration()));
+	Root->SetNumberField(TEXT("Seconds"), Seconds);
+	Root->SetNumberField(TEXT("Playthroughs"), Stats.Playthroughs);
+	Root->SetNumberField(TEXT("Steps"), Stats.Steps);
+	Root->SetNumberField(TEXT("Endings"), Stats.Endings);
+	Root->SetNumberField(TEXT("DeadEnds"), Stats.DeadEnds);
+	Root->SetNumberField(TEXT("StepLimits"), Stats.StepLimits);
+	Root->SetNumberField(TEXT("Nodes"), NumNodes);
+	Root->SetNumberField(TEXT("ReachableNodes"), NumReachable);
+	Root->SetNumberField(TEXT("VisitedNodes"), NumVisited);
+	Root->SetNumberField(TEXT("Coverage"), Coverage);
+	Root->SetArrayField(TEXT("DeadEndNodes"), MakeNodes(DeadEndNodes));
+	Root->SetArrayField(TEXT("UnvisitedNodes"), MakeNodes(UnvisitedNodes));
+
+	const FString ResultsPath = !Config.ResultsPath.IsEmpty() ? Config.ResultsPath : ArticyHelpers::GetSavedPath(TEXT("Simulation"), TEXT("FlowSimulationResults"));
+	ArticyHelpers::SaveJsonReport(Root, ResultsPath + TEXT(".json"), TEXT("flow simulation results"));
+	ArticyHelpers::SaveReport(Csv, ResultsPath + TEXT(".csv"), TEXT("flow simulation results"));
+}
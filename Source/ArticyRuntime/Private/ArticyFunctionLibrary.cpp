@@ -14,7 +14,7 @@
  * @param WorldContext The context within which the object is retrieved.
  * @return The referenced UArticyObject.
  */
-UArticyObject* UArticyFunctionLibrary::ArticyRef_GetObject(FArticyRef Ref, TSubclassOf<class UArticyObject> CastTo, const UObject* WorldContext)
+UArticyObject* UArticyFunctionLibrary::ArticyRef_GetObject(const FArticyRef& Ref, TSubclassOf<class UArticyObject> CastTo, const UObject* WorldContext)
 {
     return Ref.GetObject(WorldContext);
 }
@@ -0,0 +1,281 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyGVReplicationComponent.h"
+#include "ArticyGlobalVariables.h"
+#include "ArticyRuntimeModule.h"
+#include "Net/UnrealNetwork.h"
+
+namespace
+{
+	/** The state of the variables last sent to a connection. */
+	class FArticyGvNetBaseState : public INetDeltaBaseState
+	{
+	public:
+
+		/** The instance the change versions belong to, only compared. */
+		const UArticyGlobalVariables* Source = nullptr;
+		uint32 SchemaHash = 0;
+		uint32 ValuesVersion = 0;
+
+		/** The change version of each variable by dense index, shared by the states of all connections sent the same update. */
+		TSharedPtr<const TArray<uint32>> ChangeVersions;
+
+		virtual bool IsStateEqual(INetDeltaBaseState* OtherState) override
+		{
+			const FArticyGvNetBaseState* Other = static_cast<const FArticyGvNetBaseState*>(OtherState);
+			return Other && Source == Other->Source && SchemaHash == Other->SchemaHash && ValuesVersion == Other->ValuesVersion;
+		}
+	};
+
+	/** Writes the value of a variable, with the encoding of its type. */
+	void WriteValue(FArchive& Ar, const UArticyVariable* Variable)
+	{
+		if (const UArticyBool* Bool = Cast<UArticyBool>(Variable))
+		{
+			uint8 Bit = Bool->Get() ? 1 : 0;
+			Ar.SerializeBits(&Bit, 1);
+		}
+		else if (const UArticyInt* Int = Cast<UArticyInt>(Variable))
+		{
+			//zigzag, so small negative values are short var-ints too
+			const int32 Value = Int->Get();
+			uint32 ZigZag = ((uint32)Value << 1) ^ (uint32)(Value >> 31);
+			Ar.SerializeIntPacked(ZigZag);
+		}
+		else if (const UArticyString* String = Cast<UArticyString>(Variable))
+		{
+			FString Value = String->Get();
+			Ar << Value;
+		}
+	}
+
+	/** Reads the value of a variable written by WriteValue, and sets it if it differs. */
+	void ReadValue(FArchive& Ar, UArticyVariable* Variable)
+	{
+		if (UArticyBool* Bool = Cast<UArticyBool>(Variable))
+		{
+			uint8 Bit = 0;
+			Ar.SerializeBits(&Bit, 1);
+			if (!Ar.IsError() && Bool->Get() != (Bit != 0))
+				Bool->Set(Bit != 0);
+		}
+		else if (UArticyInt* Int = Cast<UArticyInt>(Variable))
+		{
+			uint32 ZigZag = 0;
+			Ar.SerializeIntPacked(ZigZag);
+			const int32 Value = (int32)(ZigZag >> 1) ^ -(int32)(ZigZag & 1);
+			if (!Ar.IsError() && Int->Get() != Value)
+				Int->Set(Value);
+		}
+		else if (UArticyString* String = Cast<UArticyString>(Variable))
+		{
+			FString Value;
+			Ar << Value;
+			if (!Ar.IsError() && !String->Get().Equals(Value, ESearchCase::CaseSensitive))
+				String->Set(Value);
+		}
+	}
+}
+
+/**
+ * Writes the changes of the variables since the last update sent to a connection, or applies the ones received.
+ * The changes are written as a payload prefixed with its size, so a client whose variables do not match the ones
+ * of the server can skip it.
+ * @param DeltaParms The delta serialization parameters.
+ * @return True if an update was written or read.
+ */
+bool FArticyGvReplicationState::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	//the initial update can be received before BeginPlay binds the instance
+	UArticyGlobalVariables* GVs = GlobalVariables.Get();
+	if (!GVs)
+	{
+		if (const UArticyGVReplicationComponent* Component = Cast<UArticyGVReplicationComponent>(DeltaParms.Object))
+			GlobalVariables = GVs = Component->GetGVs();
+	}
+
+	if (DeltaParms.Writer)
+	{
+		//the values of shadow states are not sent, they are sent once the state is popped
+		if (!GVs || GVs->GetShadowLevel() > 0)
+			return false;
+
+		const FArticyGvNetBaseState* OldState = static_cast<const FArticyGvNetBaseState*>(DeltaParms.OldState);
+		if (OldState && OldState->Source == GVs && OldState->SchemaHash == GVs->GetSchemaHash() && OldState->ValuesVersion == GVs->GetValuesVersion())
+			return false;
+
+		const int32 NumVariables = GVs->GetNumVariables();
+		TSharedRef<TArray<uint32>> ChangeVersions = MakeShared<TArray<uint32>>();
+		ChangeVersions->SetNumUninitialized(NumVariables);
+		for (int32 Index = 0; Index < NumVariables; ++Index)
+			(*ChangeVersions)[Index] = GVs->GetVariableByIndex(Index)->GetChangeVersion();
+
+		const bool bFull = !OldState || OldState->Source != GVs || OldState->SchemaHash != GVs->GetSchemaHash()
+			|| !OldState->ChangeVersions.IsValid() || OldState->ChangeVersions->Num() != NumVariables;
+
+		FBitWriter Payload(0, true);
+		if (bFull)
+		{
+			for (int32 Index = 0; Index < NumVariables; ++Index)
+				WriteValue(Payload, GVs->GetVariableByIndex(Index));
+		}
+		else
+		{
+			//the variables whose change version changed since the last update of the connection
+			const TArray<uint32>& OldVersions = *OldState->ChangeVersions;
+			TBitArray<> Dirty(false, NumVariables);
+			uint32 NumDirty = 0;
+			for (int32 Index = 0; Index < NumVariables; ++Index)
+			{
+				if ((*ChangeVersions)[Index] != OldVersions[Index])
+				{
+					Dirty[Index] = true;
+					++NumDirty;
+				}
+			}
+
+			Payload.SerializeIntPacked(NumDirty);
+			int32 Previous = -1;
+			for (TConstSetBitIterator<> It(Dirty); It; ++It)
+			{
+				uint32 IndexDelta = It.GetIndex() - Previous - 1;
+				Payload.SerializeIntPacked(IndexDelta);
+				WriteValue(Payload, GVs->GetVariableByIndex(It.GetIndex()));
+				Previous = It.GetIndex();
+			}
+		}
+
+		FBitWriter& Writer = *DeltaParms.Writer;
+		uint8 bFullBit = bFull ? 1 : 0;
+		Writer.SerializeBits(&bFullBit, 1);
+		if (bFull)
+		{
+			uint32 SchemaHash = GVs->GetSchemaHash();
+			Writer << SchemaHash;
+		}
+
+		uint32 NumBits = (uint32)Payload.GetNumBits();
+		Writer.SerializeIntPacked(NumBits);
+		Writer.SerializeBits(Payload.GetData(), NumBits);
+
+		TSharedRef<FArticyGvNetBaseState> NewState = MakeShared<FArticyGvNetBaseState>();
+		NewState->Source = GVs;
+		NewState->SchemaHash = GVs->GetSchemaHash();
+		NewState->ValuesVersion = GVs->GetValuesVersion();
+		NewState->ChangeVersions = ChangeVersions;
+		*DeltaParms.NewState = NewState;
+
+		return true;
+	}
+
+	if (DeltaParms.Reader)
+	{
+		FBitReader& Reader = *DeltaParms.Reader;
+		uint8 bFullBit = 0;
+		Reader.SerializeBits(&bFullBit, 1);
+		uint32 SchemaHash = 0;
+		if (bFullBit)
+			Reader << SchemaHash;
+
+		uint32 NumBits = 0;
+		Reader.SerializeIntPacked(NumBits);
+		if (Reader.IsError() || NumBits > (uint32)Reader.GetBitsLeft())
+		{
+			Reader.SetError();
+			return false;
+		}
+
+		TArray<uint8> Bytes;
+		Bytes.SetNumZeroed((NumBits + 7) >> 3);
+		Reader.SerializeBits(Bytes.GetData(), NumBits);
+
+		if (bFullBit)
+		{
+			bSchemaMatches = GVs && GVs->GetSchemaHash() == SchemaHash;
+			if (GVs && !bSchemaMatches)
+				UE_LOG(LogArticyRuntime, Warning, TEXT("The replicated global variables do not match the ones of the server, the updates are ignored."));
+		}
+
+		if (!GVs || !bSchemaMatches)
+			return true;
+
+		//the listeners get a single notification with all variables of the update
+		FArticyGvChangeBatch Batch(GVs);
+
+		FBitReader Payload(Bytes.GetData(), NumBits);
+		const int32 NumVariables = GVs->GetNumVariables();
+		if (bFullBit)
+		{
+			for (int32 Index = 0; Index < NumVariables && !Payload.IsError(); ++Index)
+				ReadValue(Payload, GVs->GetVariableByIndex(Index));
+		}
+		else
+		{
+			uint32 NumDirty = 0;
+			Payload.SerializeIntPacked(NumDirty);
+			int32 Index = -1;
+			for (uint32 i = 0; i < NumDirty && !Payload.IsError(); ++i)
+			{
+				uint32 IndexDelta = 0;
+				Payload.SerializeIntPacked(IndexDelta);
+				Index += (int32)IndexDelta + 1;
+				if (Index >= NumVariables)
+				{
+					Payload.SetError();
+					break;
+				}
+
+				ReadValue(Payload, GVs->GetVariableByIndex(Index));
+			}
+		}
+
+		if (Payload.IsError())
+			UE_LOG(LogArticyRuntime, Warning, TEXT("Failed to read a global variables update."));
+
+		return true;
+	}
+
+	return false;
+}
+
+//---------------------------------------------------------------------------//
+
+UArticyGVReplicationComponent::UArticyGVReplicationComponent()
+{
+	SetIsReplicatedByDefault(true);
+}
+
+/**
+ * Binds the replicated state to the GV instance, on the server and on the clients.
+ */
+void UArticyGVReplicationComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ReplicatedState.GlobalVariables = GetGVs();
+}
+
+/**
+ * Registers the replicated state.
+ * @param OutLifetimeProps The replicated properties.
+ */
+void UArticyGVReplicationComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UArticyGVReplicationComponent, ReplicatedState);
+}
+
+/**
+ * Returns the replicated GV instance.
+ * @return The runtime clone of OverrideGV if it is set, the default instance otherwise.
+ */
+UArticyGlobalVariables* UArticyGVReplicationComponent::GetGVs() const
+{
+	if (OverrideGV)
+		return UArticyGlobalVariables::GetRuntimeClone(this, OverrideGV);
+
+	return UArticyGlobalVariables::GetDefault(this);
+}
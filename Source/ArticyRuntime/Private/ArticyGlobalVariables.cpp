@@ -10,6 +10,9 @@
 #include "ArticyFlowPlayer.h"
 #include "ArticyAlternativeGlobalVariables.h"
 #include "AssetRegistry/AssetData.h"
+#include "Misc/ScopeRWLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 #include <ArticyPins.h>
 
 /**
@@ -37,6 +40,8 @@ FArticyGvName::FArticyGvName(const FName VariableNamespace, const FName Variable
  */
 void FArticyGvName::SetByFullName(const FName FullVariableName)
 {
+    CachedIndex = INDEX_NONE;
+
     FString variableString;
     FString namespaceString;
     if (FullVariableName.ToString().Split(TEXT("."), &namespaceString, &variableString))
@@ -54,6 +59,8 @@ void FArticyGvName::SetByFullName(const FName FullVariableName)
  */
 void FArticyGvName::SetByNamespaceAndVariable(const FName VariableNamespace, const FName VariableName)
 {
+    CachedIndex = INDEX_NONE;
+
     if (!VariableNamespace.IsNone() && !VariableName.IsNone())
     {
         Namespace = VariableNamespace;
@@ -112,6 +119,30 @@ uint32 UArticyVariable::GetStoreShadowLevel() const
     return Store->GetShadowLevel();
 }
 
+/**
+ * Counts an access of this variable with the GV profiler.
+ * @param bWrite Whether the variable was written.
+ */
+void UArticyVariable::ProfileAccess(bool bWrite) const
+{
+    const bool bShadowed = Store && Store->GetShadowLevel() > 0;
+    if (bWrite)
+        FArticyGvProfiler::RecordWrite(GVName, bShadowed);
+    else
+        FArticyGvProfiler::RecordRead(GVName, bShadowed);
+}
+
+/**
+ * Broadcasts that the value of this variable changed, which the store defers while it batches changes.
+ */
+void UArticyVariable::BroadcastChanged()
+{
+    if (Store)
+        Store->NotifyVariableChanged(this);
+    else
+        OnVariableChanged.Broadcast(this);
+}
+
 /**
  * Broadcasts a notification that a variable has changed.
  * @param Variable The variable that changed.
@@ -121,8 +152,76 @@ void UArticyBaseVariableSet::BroadcastOnVariableChanged(UArticyVariable* Variabl
     OnVariableChanged.Broadcast(Variable);
 }
 
+/**
+ * Returns the variables of this namespace which are of a given type.
+ * @param Type The type of the variables, all variables are returned for UArticyVariable or nullptr.
+ * @return The variables in the order of Variables.
+ */
+const TArray<UArticyVariable*>& UArticyBaseVariableSet::GetVariablesOfType(TSubclassOf<UArticyVariable> Type) const
+{
+    if (!Type || Type == UArticyVariable::StaticClass())
+        return Variables;
+
+    static const TArray<UArticyVariable*> Empty;
+    const TArray<UArticyVariable*>* Found = VariablesByType.Find(Type.Get());
+    return Found ? *Found : Empty;
+}
+
+/**
+ * Rebuilds the lists of variables by type.
+ * Each variable is added to the list of its class and the ones of its super classes up to UArticyVariable.
+ */
+void UArticyBaseVariableSet::BuildVariablesByType()
+{
+    VariablesByType.Reset();
+    for (UArticyVariable* Var : Variables)
+    {
+        if (!Var)
+            continue;
+
+        for (const UClass* Class = Var->GetClass(); Class && Class != UArticyVariable::StaticClass(); Class = Class->GetSuperClass())
+            VariablesByType.FindOrAdd(Class).Add(Var);
+    }
+}
+
 //---------------------------------------------------------------------------//
 
+namespace
+{
+    /**
+     * Finds the global variables asset. Loads the asset the import stored in the plugin settings,
+     * and only searches the asset registry if there is none, e.g. for imports of older plugin versions.
+     * @return The global variables asset, or nullptr if there is none.
+     */
+    UArticyGlobalVariables* FindGlobalVariablesAsset()
+    {
+        const FSoftObjectPath& AssetPath = UArticyPluginSettings::Get()->GlobalVariablesAssetPath;
+        if (AssetPath.IsValid())
+        {
+            if (UArticyGlobalVariables* Asset = Cast<UArticyGlobalVariables>(AssetPath.TryLoad()))
+                return Asset;
+
+            UE_LOG(LogArticyRuntime, Warning, TEXT("The ArticyGlobalVariables %s were not found, searching the asset registry."), *AssetPath.ToString());
+        }
+
+        FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+        TArray<FAssetData> AssetData;
+
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
+        AssetRegistryModule.Get().GetAssetsByClass(UArticyGlobalVariables::StaticClass()->GetClassPathName(), AssetData, true);
+#else
+        AssetRegistryModule.Get().GetAssetsByClass(UArticyGlobalVariables::StaticClass()->GetFName(), AssetData, true);
+#endif
+        if (AssetData.Num() == 0)
+            return nullptr;
+
+        if (AssetData.Num() > 1)
+            UE_LOG(LogArticyRuntime, Warning, TEXT("More than one ArticyGlobalVariables asset was found, this is not supported! The first one will be selected."));
+
+        return Cast<UArticyGlobalVariables>(AssetData[0].GetAsset());
+    }
+}
+
 /**
  * Retrieves the default global variables object, creating a clone if necessary.
  * @param WorldContext The context within which the object is retrieved.
@@ -130,6 +229,24 @@ void UArticyBaseVariableSet::BroadcastOnVariableChanged(UArticyVariable* Variabl
  */
 UArticyGlobalVariables* UArticyGlobalVariables::GetDefault(const UObject* WorldContext)
 {
+    //a reused clone whose world is gone is reset to the initial values for the next world
+    if (Clone.IsValid() && bCloneReused && !CloneWorld.IsValid())
+    {
+        UWorld* world = GEngine->GetWorldFromContextObjectChecked(WorldContext);
+        if (world && Clone->GetOuter() == world->GetGameInstance())
+        {
+            UE_LOG(LogArticyRuntime, Log, TEXT("Reusing the GVs of a previous world."));
+            Clone->ResetToDefaults();
+            CloneWorld = world;
+        }
+        else
+        {
+            Clone->RemoveFromRoot();
+            Clone->ConditionalBeginDestroy();
+            Clone = nullptr;
+        }
+    }
+
     if (!Clone.IsValid())
     {
 #if ENGINE_MAJOR_VERSION >= 5
@@ -137,24 +254,10 @@ UArticyGlobalVariables* UArticyGlobalVariables::GetDefault(const UObject* WorldC
 #else
         bool keepBetweenWorlds = UArticyPluginSettings::Get()->bKeepGlobalVariablesBetweenWorlds;
 #endif
+        const bool bReuseWorldClones = !keepBetweenWorlds && UArticyPluginSettings::Get()->bReuseWorldClones;
 
-        FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
-        TArray<FAssetData> AssetData;
-
-
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
-        AssetRegistryModule.Get().GetAssetsByClass(UArticyGlobalVariables::StaticClass()->GetClassPathName(), AssetData, true);
-#else
-        AssetRegistryModule.Get().GetAssetsByClass(UArticyGlobalVariables::StaticClass()->GetFName(), AssetData, true);
-#endif        
-        UArticyGlobalVariables* asset = nullptr;
-        if (ensureMsgf(AssetData.Num() != 0, TEXT("ArticyGlobalVariables asset not found!")))
-        {
-            if (AssetData.Num() > 1)
-                UE_LOG(LogTemp, Warning, TEXT("More than one ArticyGlobalVariables asset was found, this is not supported! The first one will be selected."));
-
-            asset = Cast<UArticyGlobalVariables>(AssetData[0].GetAsset());
-        }
+        UArticyGlobalVariables* asset = FindGlobalVariablesAsset();
+        ensureMsgf(asset, TEXT("ArticyGlobalVariables asset not found!"));
 
         if (!asset)
             return nullptr;
@@ -175,6 +278,14 @@ UArticyGlobalVariables* UArticyGlobalVariables::GetDefault(const UObject* WorldC
             Clone = DuplicateObject<UArticyGlobalVariables>(assetPtr, Cast<UObject>(world->GetGameInstance()), TEXT("Persistent Runtime GV"));
 #if !WITH_EDITOR
             Clone->AddToRoot();
+#endif
+        }
+        else if (bReuseWorldClones && world->GetGameInstance())
+        {
+            //reused clones outlive their world like the persistent one
+            Clone = DuplicateObject<UArticyGlobalVariables>(assetPtr, Cast<UObject>(world->GetGameInstance()), TEXT("Reused Runtime GV"));
+#if !WITH_EDITOR
+            Clone->AddToRoot();
 #endif
         }
         else
@@ -182,6 +293,9 @@ UArticyGlobalVariables* UArticyGlobalVariables::GetDefault(const UObject* WorldC
             Clone = DuplicateObject<UArticyGlobalVariables>(assetPtr, Cast<UObject>(world), *FString::Printf(TEXT("%s GV"), *world->GetName()));
         }
 
+        bCloneReused = bReuseWorldClones && world->GetGameInstance() != nullptr;
+        CloneWorld = world;
+
         ensureMsgf(Clone.IsValid(), TEXT("Cloning GV asset failed!"));
     }
 
@@ -198,25 +312,8 @@ UArticyGlobalVariables* UArticyGlobalVariables::GetMutableOriginal()
 
     if (!Asset.IsValid())
     {
-        //create a clone of the database
-        FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
-        TArray<FAssetData> AssetData;
-
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
-        AssetRegistryModule.Get().GetAssetsByClass(StaticClass()->GetClassPathName(), AssetData, true);
-#else
-        AssetRegistryModule.Get().GetAssetsByClass(StaticClass()->GetFName(), AssetData, true);
-#endif        
-        if (AssetData.Num() != 0)
-        {
-            if (AssetData.Num() > 1)
-            {
-                UE_LOG(LogArticyRuntime, Warning, TEXT("More than one ArticyGV was found, this is not supported! The first one will be selected."));
-            }
-
-            Asset = Cast<UArticyGlobalVariables>(AssetData[0].GetAsset());
-        }
-        else
+        Asset = FindGlobalVariablesAsset();
+        if (!Asset.IsValid())
         {
             UE_LOG(LogArticyRuntime, Warning, TEXT("No ArticyDraftGV was found."));
         }
@@ -237,8 +334,7 @@ UArticyGlobalVariables* UArticyGlobalVariables::GetRuntimeClone(const UObject* W
     if (GVs == nullptr) { return GetDefault(WorldContext); }
 
     // Get unique name of GV set
-    const FString Name = GVs->GetFullName();
-    const FName Key = FName(*Name);
+    const FName Key = GVs->GetCloneKey();
 
     // Check if we already have a clone
     const auto& Existing = OtherClones.Find(Key);
@@ -248,7 +344,8 @@ UArticyGlobalVariables* UArticyGlobalVariables::GetRuntimeClone(const UObject* W
         return Existing->Get();
     }
 
-    UE_LOG(LogTemp, Warning, TEXT("Cloning Override GVs %s"), *GVs->GetFullName());
+    const FString Name = Key.ToString();
+    UE_LOG(LogTemp, Warning, TEXT("Cloning Override GVs %s"), *Name);
 
     // Get world context
     auto world = GEngine->GetWorldFromContextObjectChecked(WorldContext);
@@ -263,16 +360,13 @@ UArticyGlobalVariables* UArticyGlobalVariables::GetRuntimeClone(const UObject* W
     // If so, duplicate and add to root
     UArticyGlobalVariables* NewClone = nullptr;
 
-#if ENGINE_MAJOR_VERSION >= 5
-    TObjectPtr<UArticyGlobalVariables> assetPtr = asset;
-#else
-    UArticyGlobalVariables* assetPtr = asset;
-#endif        
+    if (!asset)
+        return nullptr;
 
     if (keepBetweenWorlds)
     {
         FString NewName = TEXT("Persistent Runtime GV Clone of ") + Name;
-        NewClone = DuplicateObject<UArticyGlobalVariables>(assetPtr, Cast<UObject>(world->GetGameInstance()), *NewName);
+        NewClone = asset->Fork(Cast<UObject>(world->GetGameInstance()), *NewName);
 #if !WITH_EDITOR
         NewClone->AddToRoot();
 #endif
@@ -280,7 +374,7 @@ UArticyGlobalVariables* UArticyGlobalVariables::GetRuntimeClone(const UObject* W
     else
     {
         // Otherwise, add it to the active world
-        NewClone = DuplicateObject(assetPtr, Cast<UObject>(world), *FString::Printf(TEXT("%s %s GV"), *world->GetName(), *Name));
+        NewClone = asset->Fork(Cast<UObject>(world), *FString::Printf(TEXT("%s %s GV"), *world->GetName(), *Name));
     }
 
     // Store and return
@@ -288,6 +382,312 @@ UArticyGlobalVariables* UArticyGlobalVariables::GetRuntimeClone(const UObject* W
     return NewClone;
 }
 
+namespace
+{
+    /** Strings are compared case sensitively, unlike with operator==. */
+    template<typename ValueType>
+    bool IsSameValue(const ValueType& A, const ValueType& B) { return A == B; }
+    bool IsSameValue(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+
+    /** Copies the value of a variable from Source if it is a T and differs from the value of Target. */
+    template<typename T>
+    bool CopyChangedValue(UArticyVariable* Target, const UArticyVariable* Source)
+    {
+        const T* TypedSource = Cast<T>(Source);
+        T* TypedTarget = Cast<T>(Target);
+        if (!TypedSource || !TypedTarget)
+            return false;
+
+        if (!IsSameValue(TypedTarget->Get(), TypedSource->GetUnshadowed()))
+            TypedTarget->Set(TypedSource->GetUnshadowed());
+        return true;
+    }
+}
+
+/**
+ * Creates a new instance with the current state of this one, outside of its shadow states.
+ * The generated constructor initializes all variables, so only the values which were changed are copied.
+ * @param Outer The outer of the new instance.
+ * @param Name The name of the new instance.
+ * @return The new instance.
+ */
+UArticyGlobalVariables* UArticyGlobalVariables::Fork(UObject* Outer, const FName Name) const
+{
+    UArticyGlobalVariables* Forked = NewObject<UArticyGlobalVariables>(Outer, GetClass(), Name, RF_Transient);
+    Forked->bLogVariableAccess = bLogVariableAccess;
+    Forked->CopyStateFrom(this);
+
+    return Forked;
+}
+
+/**
+ * Sets the values and seen counters to the ones of another instance of the same class, outside of its shadow states.
+ * Only the values which differ are set, so this may run on a worker thread for an instance nothing listens to.
+ * @param Source The instance to copy from.
+ */
+void UArticyGlobalVariables::CopyStateFrom(const UArticyGlobalVariables* Source)
+{
+    if (!ensure(Source && Source->GetClass() == GetClass()) || Source == this)
+        return;
+
+    ensureMsgf(GetShadowLevel() == 0 && NumVisitLayers == 0, TEXT("Global variables are copied while a shadow state of the target is active."));
+
+    //both are instances of the same generated class, so the dense indices match
+    for (int32 i = 0; i < IndexedVariables.Num() && i < Source->IndexedVariables.Num(); ++i)
+    {
+        UArticyVariable* Target = IndexedVariables[i];
+        const UArticyVariable* SourceVariable = Source->IndexedVariables[i];
+        if (!CopyChangedValue<UArticyInt>(Target, SourceVariable) && !CopyChangedValue<UArticyBool>(Target, SourceVariable))
+            CopyChangedValue<UArticyString>(Target, SourceVariable);
+    }
+
+    Source->GetUnshadowedVisitStates(VisitStates, NumFallbackEvaluations);
+}
+
+/**
+ * Restores the initial values of all variables and resets the seen counters.
+ * The initial values are compared in the order of the dense indices, and only the values which differ are set.
+ */
+void UArticyGlobalVariables::ResetToDefaults()
+{
+    if (GetShadowLevel() > 0 || NumVisitLayers > 0)
+    {
+        UE_LOG(LogArticyRuntime, Warning, TEXT("Global variables are reset while a shadow state is active, the shadow states are dropped."));
+        while (NumVisitLayers > 0)
+            PopSeen();
+        PopAllStates();
+    }
+
+    const FArticyGvDefaults& Initial = GetDefaults();
+    if (!ensure(Initial.Ints.Num() == IntVariableIndices.Num() && Initial.Bools.Num() == BoolVariableIndices.Num() && Initial.Strings.Num() == StringVariableIndices.Num()))
+        return;
+
+    //the listeners get a single notification with all changed variables
+    FArticyGvChangeBatch Batch(this);
+
+    for (int32 i = 0; i < IntVariableIndices.Num(); ++i)
+    {
+        UArticyInt* Variable = static_cast<UArticyInt*>(IndexedVariables[IntVariableIndices[i]]);
+        if (Variable->Get() != Initial.Ints[i])
+            Variable->Set(Initial.Ints[i]);
+    }
+    for (int32 i = 0; i < BoolVariableIndices.Num(); ++i)
+    {
+        UArticyBool* Variable = static_cast<UArticyBool*>(IndexedVariables[BoolVariableIndices[i]]);
+        if (Variable->Get() != Initial.Bools[i])
+            Variable->Set(Initial.Bools[i]);
+    }
+    for (int32 i = 0; i < StringVariableIndices.Num(); ++i)
+    {
+        UArticyString* Variable = static_cast<UArticyString*>(IndexedVariables[StringVariableIndices[i]]);
+        if (!Variable->Get().Equals(Initial.Strings[i], ESearchCase::CaseSensitive))
+            Variable->Set(Initial.Strings[i]);
+    }
+
+    VisitStates.Reset();
+    NumFallbackEvaluations = 0;
+    ++SeenVersion;
+}
+
+/**
+ * Returns the initial values of the class. They are taken from the class default object, which the generated
+ * constructor initializes, once per class and shared by all instances.
+ * @return The initial values, by type in the order of the dense indices.
+ */
+const FArticyGvDefaults& UArticyGlobalVariables::GetDefaults() const
+{
+    if (!Defaults.IsValid())
+    {
+        const UArticyGlobalVariables* DefaultObject = GetClass()->GetDefaultObject<UArticyGlobalVariables>();
+        if (DefaultObject != this && DefaultObject->SchemaHash == SchemaHash)
+        {
+            DefaultObject->GetDefaults();
+            Defaults = DefaultObject->Defaults;
+        }
+        else
+        {
+            TSharedRef<FArticyGvDefaults> Built = MakeShared<FArticyGvDefaults>();
+            for (const int32 Index : IntVariableIndices)
+                Built->Ints.Add(static_cast<const UArticyInt*>(IndexedVariables[Index])->Get());
+            for (const int32 Index : BoolVariableIndices)
+                Built->Bools.Add(static_cast<const UArticyBool*>(IndexedVariables[Index])->Get());
+            for (const int32 Index : StringVariableIndices)
+                Built->Strings.Add(static_cast<const UArticyString*>(IndexedVariables[Index])->Get());
+            Defaults = Built;
+        }
+    }
+
+    return *Defaults;
+}
+
+/**
+ * Returns the memory held by the delta.
+ * @return The size of the arrays and of the strings, in bytes.
+ */
+SIZE_T FArticyGvDelta::GetAllocatedSize() const
+{
+    SIZE_T Size = Ints.GetAllocatedSize() + Bools.GetAllocatedSize() + Strings.GetAllocatedSize() + VisitStates.GetAllocatedSize();
+    for (const TPair<int32, FString>& String : Strings)
+        Size += String.Value.GetAllocatedSize();
+    return Size;
+}
+
+/**
+ * Sets the previous values of a delta.
+ * @param Delta The delta recorded by UArticyGlobalVariables::UpdateState when this state was updated.
+ */
+void FArticyGvState::Apply(const FArticyGvDelta& Delta)
+{
+    for (const TPair<int32, int32>& Int : Delta.Ints)
+        Ints[Int.Key] = Int.Value;
+    for (const TPair<int32, bool>& Bool : Delta.Bools)
+        Bools[Bool.Key] = Bool.Value;
+    for (const TPair<int32, FString>& String : Delta.Strings)
+        Strings[String.Key] = String.Value;
+
+    //slots added since are dropped, slots removed since start out unvisited
+    VisitStates.SetNum(Delta.NumVisitStates);
+    for (const TPair<int32, FArticyNodeVisitState>& Visit : Delta.VisitStates)
+        VisitStates[Visit.Key] = Visit.Value;
+    NumFallbackEvaluations = Delta.NumFallbackEvaluations;
+}
+
+/**
+ * Returns the memory held by the state.
+ * @return The size of the arrays and of the strings, in bytes.
+ */
+SIZE_T FArticyGvState::GetAllocatedSize() const
+{
+    SIZE_T Size = Ints.GetAllocatedSize() + Bools.GetAllocatedSize() + Strings.GetAllocatedSize() + VisitStates.GetAllocatedSize();
+    for (const FString& String : Strings)
+        Size += String.GetAllocatedSize();
+    return Size;
+}
+
+/**
+ * Copies the values and the node visit states.
+ * @param OutState Receives the values by type in the order of the dense indices.
+ */
+void UArticyGlobalVariables::CaptureState(FArticyGvState& OutState) const
+{
+    ensureMsgf(GetShadowLevel() == 0 && NumVisitLayers == 0, TEXT("Global variables are captured while a shadow state is active, the shadowed values are copied."));
+
+    OutState.Ints.Reset(IntVariableIndices.Num());
+    for (const int32 Index : IntVariableIndices)
+        OutState.Ints.Add(static_cast<const UArticyInt*>(IndexedVariables[Index])->Get());
+    OutState.Bools.Reset(BoolVariableIndices.Num());
+    for (const int32 Index : BoolVariableIndices)
+        OutState.Bools.Add(static_cast<const UArticyBool*>(IndexedVariables[Index])->Get());
+    OutState.Strings.Reset(StringVariableIndices.Num());
+    for (const int32 Index : StringVariableIndices)
+        OutState.Strings.Add(static_cast<const UArticyString*>(IndexedVariables[Index])->Get());
+
+    OutState.VisitStates = VisitStates;
+    OutState.NumFallbackEvaluations = NumFallbackEvaluations;
+}
+
+namespace
+{
+    bool IsSameVisitState(const FArticyNodeVisitState& A, const FArticyNodeVisitState& B)
+    {
+        return A.SeenCounter == B.SeenCounter && A.bFallbackEvaluation == B.bFallbackEvaluation;
+    }
+}
+
+/**
+ * Updates a state to the current values, recording the previous values of the changed ones.
+ * The values are compared in the order of the dense indices, so the delta only holds what changed.
+ * @param State A state captured from this instance.
+ * @param OutUndo Receives the previous values, its previous content is replaced.
+ */
+void UArticyGlobalVariables::UpdateState(FArticyGvState& State, FArticyGvDelta& OutUndo) const
+{
+    OutUndo = FArticyGvDelta();
+    if (!ensure(State.Ints.Num() == IntVariableIndices.Num() && State.Bools.Num() == BoolVariableIndices.Num() && State.Strings.Num() == StringVariableIndices.Num()))
+    {
+        CaptureState(State);
+        return;
+    }
+
+    for (int32 i = 0; i < IntVariableIndices.Num(); ++i)
+    {
+        const int32 Value = static_cast<const UArticyInt*>(IndexedVariables[IntVariableIndices[i]])->Get();
+        if (State.Ints[i] != Value)
+        {
+            OutUndo.Ints.Emplace(i, State.Ints[i]);
+            State.Ints[i] = Value;
+        }
+    }
+    for (int32 i = 0; i < BoolVariableIndices.Num(); ++i)
+    {
+        const bool Value = static_cast<const UArticyBool*>(IndexedVariables[BoolVariableIndices[i]])->Get();
+        if (State.Bools[i] != Value)
+        {
+            OutUndo.Bools.Emplace(i, State.Bools[i]);
+            State.Bools[i] = Value;
+        }
+    }
+    for (int32 i = 0; i < StringVariableIndices.Num(); ++i)
+    {
+        const FString& Value = static_cast<const UArticyString*>(IndexedVariables[StringVariableIndices[i]])->Get();
+        if (!State.Strings[i].Equals(Value, ESearchCase::CaseSensitive))
+        {
+            OutUndo.Strings.Emplace(i, MoveTemp(State.Strings[i]));
+            State.Strings[i] = Value;
+        }
+    }
+
+    //only the previous slots are recorded, the ones added since are dropped when the delta is applied
+    OutUndo.NumVisitStates = State.VisitStates.Num();
+    for (int32 Slot = 0; Slot < State.VisitStates.Num(); ++Slot)
+    {
+        const FArticyNodeVisitState Current = GetNodeVisitState(Slot);
+        if (!IsSameVisitState(State.VisitStates[Slot], Current))
+            OutUndo.VisitStates.Emplace(Slot, State.VisitStates[Slot]);
+    }
+    State.VisitStates = VisitStates;
+
+    OutUndo.NumFallbackEvaluations = State.NumFallbackEvaluations;
+    State.NumFallbackEvaluations = NumFallbackEvaluations;
+}
+
+/**
+ * Sets the values and the node visit states of a state. Only the values which differ are set.
+ * @param State A state captured from this instance.
+ */
+void UArticyGlobalVariables::RestoreState(const FArticyGvState& State)
+{
+    if (!ensureMsgf(GetShadowLevel() == 0 && NumVisitLayers == 0, TEXT("Global variables cannot be restored while a shadow state is active."))
+        || !ensure(State.Ints.Num() == IntVariableIndices.Num() && State.Bools.Num() == BoolVariableIndices.Num() && State.Strings.Num() == StringVariableIndices.Num()))
+        return;
+
+    //the listeners get a single notification with all changed variables
+    FArticyGvChangeBatch Batch(this);
+
+    for (int32 i = 0; i < IntVariableIndices.Num(); ++i)
+    {
+        UArticyInt* Variable = static_cast<UArticyInt*>(IndexedVariables[IntVariableIndices[i]]);
+        if (Variable->Get() != State.Ints[i])
+            Variable->Set(State.Ints[i]);
+    }
+    for (int32 i = 0; i < BoolVariableIndices.Num(); ++i)
+    {
+        UArticyBool* Variable = static_cast<UArticyBool*>(IndexedVariables[BoolVariableIndices[i]]);
+        if (Variable->Get() != State.Bools[i])
+            Variable->Set(State.Bools[i]);
+    }
+    for (int32 i = 0; i < StringVariableIndices.Num(); ++i)
+    {
+        UArticyString* Variable = static_cast<UArticyString*>(IndexedVariables[StringVariableIndices[i]]);
+        if (!Variable->Get().Equals(State.Strings[i], ESearchCase::CaseSensitive))
+            Variable->Set(State.Strings[i]);
+    }
+
+    VisitStates = State.VisitStates;
+    NumFallbackEvaluations = State.NumFallbackEvaluations;
+    ++SeenVersion;
+}
+
 /**
  * Unloads the global variables, removing all changes.
  */
@@ -301,6 +701,367 @@ void UArticyGlobalVariables::UnloadGlobalVariables()
     }
 }
 
+/**
+ * Builds the variable index once the generated constructor created and initialized the namespaces.
+ */
+void UArticyGlobalVariables::PostInitProperties()
+{
+    Super::PostInitProperties();
+    BuildVariableIndex();
+}
+
+/**
+ * Rebuilds the variable index, as loading may replace the namespaces.
+ */
+void UArticyGlobalVariables::PostLoad()
+{
+    Super::PostLoad();
+    BuildVariableIndex();
+}
+
+/**
+ * Rebuilds the variable index of a runtime clone, which must point to its own variables.
+ * @param bDuplicateForPIE Whether the object is duplicated for PIE.
+ */
+void UArticyGlobalVariables::PostDuplicate(bool bDuplicateForPIE)
+{
+    Super::PostDuplicate(bDuplicateForPIE);
+    BuildVariableIndex();
+}
+
+/**
+ * Rebuilds the dense variable index from the namespaces.
+ * The order matches the one of the generated Init methods, which is the one the generated indices are based on.
+ */
+void UArticyGlobalVariables::BuildVariableIndex()
+{
+    IndexedVariables.Reset();
+    VariableIndices.Reset();
+    NamespaceIndices.Reset();
+    FullNameIndices.Reset();
+    VariableNamespaces.Reset();
+    IntVariableIndices.Reset();
+    BoolVariableIndices.Reset();
+    StringVariableIndices.Reset();
+    SchemaHash = 0;
+
+    for (int32 s = 0; s < VariableSets.Num(); ++s)
+    {
+        UArticyBaseVariableSet* Set = VariableSets[s];
+        if (!Set)
+            continue;
+
+        NamespaceIndices.Add(Set->GetFName(), s);
+        Set->BuildVariablesByType();
+        for (UArticyVariable* Var : Set->Variables)
+        {
+            const int32 Index = IndexedVariables.Add(Var);
+            VariableNamespaces.Add(s);
+            if (!Var)
+                continue;
+
+            VariableIndices.Add(TPair<FName, FName>(Set->GetFName(), Var->GetFName()), Index);
+            FullNameIndices.Add(Var->GetGVName(), Index);
+
+            if (Var->IsA<UArticyInt>())
+                IntVariableIndices.Add(Index);
+            else if (Var->IsA<UArticyBool>())
+                BoolVariableIndices.Add(Index);
+            else if (Var->IsA<UArticyString>())
+                StringVariableIndices.Add(Index);
+
+            //FName hashes are not stable between sessions, the strings are
+            SchemaHash = FCrc::StrCrc32(*Var->GetGVName().ToString(), SchemaHash);
+            SchemaHash = FCrc::StrCrc32(*Var->GetClass()->GetName(), SchemaHash);
+        }
+    }
+}
+
+/**
+ * Returns the dense index of a variable.
+ * @param Namespace The name of the namespace.
+ * @param Variable The name of the variable in the namespace.
+ * @return The index of the variable, or INDEX_NONE if there is no such variable.
+ */
+int32 UArticyGlobalVariables::GetVariableIndex(const FName Namespace, const FName Variable) const
+{
+    const int32* Index = VariableIndices.Find(TPair<FName, FName>(Namespace, Variable));
+    return Index ? *Index : INDEX_NONE;
+}
+
+/**
+ * Returns the dense index of a variable, using and updating the index cached in the name.
+ * Looking up an uncached name does not split or build any strings: the namespace and variable are looked up if
+ * both are set, the full name otherwise.
+ * @param GvName The name of the variable.
+ * @return The index of the variable, or INDEX_NONE if there is no such variable.
+ */
+int32 UArticyGlobalVariables::GetVariableIndex(const FArticyGvName& GvName) const
+{
+    //the name fields may have been changed directly, e.g. from a blueprint, so the cached index is verified
+    if (GvName.CachedSchemaHash == SchemaHash && MatchesVariable(GvName, GvName.CachedIndex))
+        return GvName.CachedIndex;
+
+    int32 Index = INDEX_NONE;
+    if (!GvName.Namespace.IsNone() && !GvName.Variable.IsNone())
+    {
+        Index = GetVariableIndex(GvName.Namespace, GvName.Variable);
+    }
+    else if (const int32* Found = FullNameIndices.Find(GvName.FullName))
+    {
+        Index = *Found;
+    }
+
+    if (Index != INDEX_NONE)
+    {
+        GvName.CachedIndex = Index;
+        GvName.CachedSchemaHash = SchemaHash;
+    }
+    return Index;
+}
+
+/**
+ * Checks whether a variable has the given name.
+ * @param GvName The name to check, the namespace and variable take precedence over the full name as in FArticyGvName.
+ * @param Index The dense index of the variable.
+ * @return True if the variable exists and has the name.
+ */
+bool UArticyGlobalVariables::MatchesVariable(const FArticyGvName& GvName, const int32 Index) const
+{
+    const UArticyVariable* Var = GetVariableByIndex(Index);
+    if (!Var)
+        return false;
+
+    if (!GvName.Namespace.IsNone() && !GvName.Variable.IsNone())
+        return Var->GetFName() == GvName.Variable && VariableSets[VariableNamespaces[Index]]->GetFName() == GvName.Namespace;
+
+    return Var->GetGVName() == GvName.FullName;
+}
+
+/**
+ * Returns the index of a namespace in the variable sets.
+ * @param Namespace The name of the namespace.
+ * @return The index of the namespace, or INDEX_NONE if there is no such namespace.
+ */
+int32 UArticyGlobalVariables::GetNamespaceIndex(const FName Namespace) const
+{
+    const int32* Index = NamespaceIndices.Find(Namespace);
+    return Index ? *Index : INDEX_NONE;
+}
+
+namespace
+{
+    /** The first bytes of a GV snapshot. */
+    constexpr uint32 GvSnapshotMagic = 0x53564741; // "AGVS"
+
+    /** Increment when the layout of the snapshot changes, LoadSnapshot rejects newer versions. */
+    constexpr int32 GvSnapshotVersion = 1;
+
+    /** The values of one snapshot section, in the order of the typed variable indices. */
+    template<typename ValueType>
+    struct FGvSnapshotSection
+    {
+        TArray<ValueType> Values;
+        TArray<FString> Names;
+    };
+
+    /** Applies the values of a section by dense index, or by name if the schema changed. */
+    template<typename VariableType, typename ValueType>
+    int32 ApplySnapshotSection(UArticyGlobalVariables* GV, const TArray<int32>& Indices, const FGvSnapshotSection<ValueType>& Section, const bool bSameSchema)
+    {
+        int32 NumSkipped = 0;
+        for (int32 i = 0; i < Section.Values.Num(); ++i)
+        {
+            VariableType* Var = nullptr;
+            if (bSameSchema)
+            {
+                Var = GV->GetVariableByIndex<VariableType>(Indices[i]);
+            }
+            else
+            {
+                FString Namespace, Variable;
+                if (Section.Names[i].Split(TEXT("."), &Namespace, &Variable))
+                    Var = GV->GetVariableByIndex<VariableType>(GV->GetVariableIndex(*Namespace, *Variable));
+            }
+
+            if (!Var)
+            {
+                ++NumSkipped;
+                continue;
+            }
+
+            //unchanged variables are not set, so they don't broadcast
+            if (!IsSameValue(Var->Get(), Section.Values[i]))
+                Var->Set(Section.Values[i]);
+        }
+        return NumSkipped;
+    }
+}
+
+/**
+ * Writes the values of all variables and the seen counters into a binary snapshot.
+ *
+ * The snapshot starts with a header holding the version and schema hash, followed by one section per variable type.
+ * The int and bool values are written as one block each. The names of the variables come last, they are only read
+ * if the schema changed.
+ *
+ * @param OutSnapshot The array to write the snapshot to, its previous content is replaced.
+ * @return false if the snapshot could not be written, because a shadow state is active.
+ */
+bool UArticyGlobalVariables::SaveSnapshot(TArray<uint8>& OutSnapshot) const
+{
+    OutSnapshot.Reset();
+    if (!ensureMsgf(GetShadowLevel() == 0 && NumVisitLayers == 0, TEXT("Global variables cannot be saved while a shadow state is active.")))
+        return false;
+
+    TArray<int32> IntValues;
+    IntValues.Reserve(IntVariableIndices.Num());
+    for (const int32 Index : IntVariableIndices)
+        IntValues.Add(GetVariableByIndex<UArticyInt>(Index)->Get());
+
+    TArray<uint8> BoolValues;
+    BoolValues.Reserve(BoolVariableIndices.Num());
+    for (const int32 Index : BoolVariableIndices)
+        BoolValues.Add(GetVariableByIndex<UArticyBool>(Index)->Get() ? 1 : 0);
+
+    FMemoryWriter Writer(OutSnapshot);
+
+    uint32 Magic = GvSnapshotMagic;
+    int32 Version = GvSnapshotVersion;
+    uint32 Schema = SchemaHash;
+    int32 NumInts = IntValues.Num(), NumBools = BoolValues.Num(), NumStrings = StringVariableIndices.Num();
+    Writer << Magic << Version << Schema << NumInts << NumBools << NumStrings;
+
+    Writer.Serialize(IntValues.GetData(), IntValues.Num() * sizeof(int32));
+    Writer.Serialize(BoolValues.GetData(), BoolValues.Num());
+    for (const int32 Index : StringVariableIndices)
+    {
+        FString Value = GetVariableByIndex<UArticyString>(Index)->Get();
+        Writer << Value;
+    }
+
+    //the seen counters outside of shadow states
+    TArray<TPair<FArticyId, int32>> SeenCounters;
+    for (int32 Slot = 0; Slot < VisitStates.Num(); ++Slot)
+    {
+        if (VisitStates[Slot].SeenCounter != 0)
+            SeenCounters.Emplace(FArticySeenCounterSlots::GetId(Slot), VisitStates[Slot].SeenCounter);
+    }
+
+    int32 NumSeenCounters = SeenCounters.Num();
+    Writer << NumSeenCounters;
+    for (auto& SeenCounter : SeenCounters)
+        Writer << SeenCounter.Key.Low << SeenCounter.Key.High << SeenCounter.Value;
+
+    for (const TArray<int32>* Indices : { &IntVariableIndices, &BoolVariableIndices, &StringVariableIndices })
+    {
+        for (const int32 Index : *Indices)
+        {
+            FString Name = IndexedVariables[Index]->GetGVName().ToString();
+            Writer << Name;
+        }
+    }
+
+    return !Writer.IsError();
+}
+
+/**
+ * Restores the values of all variables and the seen counters from a snapshot.
+ *
+ * The whole snapshot is read before anything is changed. If the schema hash matches, the values are applied by their
+ * dense index, otherwise by the variable names stored in the snapshot.
+ *
+ * @param Snapshot The snapshot written by SaveSnapshot.
+ * @return false if the snapshot is invalid or a shadow state is active, in which case nothing is changed.
+ */
+bool UArticyGlobalVariables::LoadSnapshot(const TArray<uint8>& Snapshot)
+{
+    if (!ensureMsgf(GetShadowLevel() == 0, TEXT("Global variables cannot be loaded while a shadow state is active.")))
+        return false;
+
+    FMemoryReader Reader(Snapshot);
+
+    uint32 Magic = 0, Schema = 0;
+    int32 Version = 0, NumInts = 0, NumBools = 0, NumStrings = 0;
+    Reader << Magic << Version << Schema << NumInts << NumBools << NumStrings;
+
+    if (Reader.IsError() || Magic != GvSnapshotMagic || Version < 1 || Version > GvSnapshotVersion || NumInts < 0 || NumBools < 0 || NumStrings < 0
+        || (NumInts + static_cast<uint64>(NumStrings)) * sizeof(int32) + NumBools > static_cast<uint64>(Reader.TotalSize() - Reader.Tell()))
+    {
+        UE_LOG(LogArticyRuntime, Error, TEXT("Unable to load global variables: invalid snapshot (version %d)."), Version);
+        return false;
+    }
+
+    const bool bSameSchema = Schema == SchemaHash && NumInts == IntVariableIndices.Num()
+        && NumBools == BoolVariableIndices.Num() && NumStrings == StringVariableIndices.Num();
+
+    FGvSnapshotSection<int32> Ints;
+    FGvSnapshotSection<bool> Bools;
+    FGvSnapshotSection<FString> Strings;
+
+    Ints.Values.SetNumUninitialized(NumInts);
+    Reader.Serialize(Ints.Values.GetData(), NumInts * sizeof(int32));
+
+    TArray<uint8> BoolValues;
+    BoolValues.SetNumUninitialized(NumBools);
+    Reader.Serialize(BoolValues.GetData(), NumBools);
+    Bools.Values.Reserve(NumBools);
+    for (const uint8 Value : BoolValues)
+        Bools.Values.Add(Value != 0);
+
+    Strings.Values.SetNum(NumStrings);
+    for (FString& Value : Strings.Values)
+        Reader << Value;
+
+    int32 NumSeenCounters = 0;
+    Reader << NumSeenCounters;
+    TArray<TPair<FArticyId, int32>> SeenCounters;
+    if (NumSeenCounters > 0 && static_cast<uint64>(NumSeenCounters) * 3 * sizeof(int32) <= static_cast<uint64>(Reader.TotalSize() - Reader.Tell()))
+    {
+        SeenCounters.SetNum(NumSeenCounters);
+        for (auto& SeenCounter : SeenCounters)
+            Reader << SeenCounter.Key.Low << SeenCounter.Key.High << SeenCounter.Value;
+    }
+    else if (NumSeenCounters != 0)
+    {
+        Reader.SetError();
+    }
+
+    if (!bSameSchema)
+    {
+        Ints.Names.SetNum(NumInts);
+        Bools.Names.SetNum(NumBools);
+        Strings.Names.SetNum(NumStrings);
+        for (TArray<FString>* Names : { &Ints.Names, &Bools.Names, &Strings.Names })
+        {
+            for (FString& Name : *Names)
+                Reader << Name;
+        }
+    }
+
+    if (Reader.IsError())
+    {
+        UE_LOG(LogArticyRuntime, Error, TEXT("Unable to load global variables: the snapshot is truncated."));
+        return false;
+    }
+
+    const int32 NumSkipped = ApplySnapshotSection<UArticyInt>(this, IntVariableIndices, Ints, bSameSchema)
+        + ApplySnapshotSection<UArticyBool>(this, BoolVariableIndices, Bools, bSameSchema)
+        + ApplySnapshotSection<UArticyString>(this, StringVariableIndices, Strings, bSameSchema);
+
+    if (!bSameSchema)
+    {
+        UE_LOG(LogArticyRuntime, Warning, TEXT("The global variables changed since the snapshot was saved, restored them by name (%d values skipped)."), NumSkipped);
+    }
+
+    ResetVisited();
+    for (const auto& SeenCounter : SeenCounters)
+        GetNodeVisitStateForWrite(FArticySeenCounterSlots::FindOrAdd(SeenCounter.Key)).SeenCounter = SeenCounter.Value;
+    ++SeenVersion;
+
+    return true;
+}
+
 /**
  * Retrieves a namespace variable set by name.
  * @param Namespace The name of the namespace.
@@ -308,7 +1069,8 @@ void UArticyGlobalVariables::UnloadGlobalVariables()
  */
 UArticyBaseVariableSet* UArticyGlobalVariables::GetNamespace(const FName Namespace)
 {
-    auto set = GetProp<UArticyBaseVariableSet*>(Namespace);
+    const int32 Index = GetNamespaceIndex(Namespace);
+    auto set = Index != INDEX_NONE ? VariableSets[Index] : nullptr;
     if (!set)
     {
         if (bLogVariableAccess)
@@ -377,7 +1139,7 @@ void UArticyGlobalVariables::PrintGlobalVariable(FArticyGvName GvName)
  */
 const bool& UArticyGlobalVariables::GetBoolVariable(FArticyGvName GvName, bool& bSucceeded)
 {
-    return GetVariableValue<UArticyBool, bool>(GvName.GetNamespace(), GvName.GetVariable(), bSucceeded);
+    return GetVariableValue<UArticyBool, bool>(GvName, bSucceeded);
 }
 
 /**
@@ -388,7 +1150,7 @@ const bool& UArticyGlobalVariables::GetBoolVariable(FArticyGvName GvName, bool&
  */
 const int32& UArticyGlobalVariables::GetIntVariable(FArticyGvName GvName, bool& bSucceeded)
 {
-    return GetVariableValue<UArticyInt, int32>(GvName.GetNamespace(), GvName.GetVariable(), bSucceeded);
+    return GetVariableValue<UArticyInt, int32>(GvName, bSucceeded);
 }
 
 /**
@@ -399,7 +1161,7 @@ const int32& UArticyGlobalVariables::GetIntVariable(FArticyGvName GvName, bool&
  */
 const FString& UArticyGlobalVariables::GetStringVariable(FArticyGvName GvName, bool& bSucceeded)
 {
-    return GetVariableValue<UArticyString, FString>(GvName.GetNamespace(), GvName.GetVariable(), bSucceeded);
+    return GetVariableValue<UArticyString, FString>(GvName, bSucceeded);
 }
 
 /**
@@ -409,7 +1171,7 @@ const FString& UArticyGlobalVariables::GetStringVariable(FArticyGvName GvName, b
  */
 void UArticyGlobalVariables::SetBoolVariable(FArticyGvName GvName, const bool Value)
 {
-    SetVariableValue<UArticyBool>(GvName.GetNamespace(), GvName.GetVariable(), Value);
+    SetVariableValue<UArticyBool>(GvName, Value);
 }
 
 /**
@@ -419,7 +1181,7 @@ void UArticyGlobalVariables::SetBoolVariable(FArticyGvName GvName, const bool Va
  */
 void UArticyGlobalVariables::SetIntVariable(FArticyGvName GvName, const int32 Value)
 {
-    SetVariableValue<UArticyInt>(GvName.GetNamespace(), GvName.GetVariable(), Value);
+    SetVariableValue<UArticyInt>(GvName, Value);
 }
 
 /**
@@ -429,7 +1191,7 @@ void UArticyGlobalVariables::SetIntVariable(FArticyGvName GvName, const int32 Va
  */
 void UArticyGlobalVariables::SetStringVariable(FArticyGvName GvName, const FString Value)
 {
-    SetVariableValue<UArticyString>(GvName.GetNamespace(), GvName.GetVariable(), Value);
+    SetVariableValue<UArticyString>(GvName, Value);
 }
 
 /**
@@ -448,14 +1210,143 @@ void UArticyGlobalVariables::DisableDebugLogging()
     bLogVariableAccess = false;
 }
 
+/**
+ * Ends a change batch. When the outermost batch ends, the deferred notifications are broadcast.
+ */
+void UArticyGlobalVariables::EndChangeBatch()
+{
+    if (!ensure(ChangeBatchDepth > 0) || --ChangeBatchDepth > 0 || PendingChanges.Num() == 0)
+        return;
+
+    //moved out, as the listeners may change variables again
+    const TArray<UArticyVariable*> Changed = MoveTemp(PendingChanges);
+    PendingChanges.Reset();
+
+    for (UArticyVariable* Variable : Changed)
+        Variable->OnVariableChanged.Broadcast(Variable);
+    OnVariablesChanged.Broadcast(Changed);
+}
+
+/**
+ * Broadcasts the change of a variable, or defers it until the current change batch ends.
+ * @param Variable The variable whose layer zero value changed.
+ */
+void UArticyGlobalVariables::NotifyVariableChanged(UArticyVariable* Variable)
+{
+    ++ValuesVersion;
+
+    if (ChangeBatchDepth > 0)
+    {
+        PendingChanges.AddUnique(Variable);
+        return;
+    }
+
+    Variable->OnVariableChanged.Broadcast(Variable);
+    if (OnVariablesChanged.IsBound())
+        OnVariablesChanged.Broadcast(TArray<UArticyVariable*>{ Variable });
+}
+
+namespace
+{
+    /** See FArticySeenCounterSlots. */
+    TMap<FArticyId, int32> SeenCounterSlotsById;
+    TArray<FArticyId> SeenCounterSlotIds;
+
+    /** Slots are assigned on the game thread when the flow graph is built, lookups during parallel explorations only read. */
+    FRWLock SeenCounterSlotsLock;
+}
+
+/**
+ * Returns the seen counter slot of an id.
+ * @param Id The id of the node.
+ * @return The slot, which is assigned if the id has none yet.
+ */
+int32 FArticySeenCounterSlots::FindOrAdd(const FArticyId& Id)
+{
+    {
+        FReadScopeLock ReadLock(SeenCounterSlotsLock);
+        if (const int32* Slot = SeenCounterSlotsById.Find(Id))
+            return *Slot;
+    }
+
+    FWriteScopeLock WriteLock(SeenCounterSlotsLock);
+    if (const int32* Slot = SeenCounterSlotsById.Find(Id))
+        return *Slot;
+
+    const int32 Slot = SeenCounterSlotIds.Add(Id);
+    SeenCounterSlotsById.Add(Id, Slot);
+    return Slot;
+}
+
+/**
+ * Returns the id of a seen counter slot.
+ * @param Slot The slot.
+ * @return The id the slot was assigned to.
+ */
+FArticyId FArticySeenCounterSlots::GetId(int32 Slot)
+{
+    FReadScopeLock ReadLock(SeenCounterSlotsLock);
+    return SeenCounterSlotIds.IsValidIndex(Slot) ? SeenCounterSlotIds[Slot] : FArticyId();
+}
+
 /**
  * Resets the visited state for all nodes.
+ * In a shadow state, the current states are saved in its layer first, so they are restored when it is popped.
+ * Fallback evaluation states are kept.
  */
 void UArticyGlobalVariables::ResetVisited()
 {
-    VisitedNodes.Reset();
-    TMap<FArticyId, int> Empty;
-    VisitedNodes.Add(Empty);
+    if (WriteRecorder)
+        WriteRecorder->bWroteSeenCounters = true;
+
+    if (NumVisitLayers > 0)
+    {
+        FArticyNodeVisitLayer& Top = VisitLayers[NumVisitLayers - 1];
+        if (!Top.bSavedAll)
+        {
+            //save the states from before the layer, which undoes the changes made in it so far
+            Top.SavedStates = VisitStates;
+            INC_DWORD_STAT(STAT_ArticySeenMapCopies);
+            for (int32 i = Top.Undo.Num() - 1; i >= 0; --i)
+                Top.SavedStates[Top.Undo[i].Key] = Top.Undo[i].Value;
+            Top.Undo.Reset();
+            Top.bSavedAll = true;
+        }
+    }
+    else
+    {
+        ++SeenVersion;
+    }
+
+    for (FArticyNodeVisitState& State : VisitStates)
+        State.SeenCounter = 0;
+}
+
+/**
+ * Returns the visit state of a node for writing, recording its previous state in the current layer.
+ * @param Slot The seen counter slot of the node.
+ * @return The writable visit state.
+ */
+FArticyNodeVisitState& UArticyGlobalVariables::GetNodeVisitStateForWrite(const int32 Slot)
+{
+    check(Slot >= 0);
+    if (Slot >= VisitStates.Num())
+        VisitStates.SetNum(Slot + 1);
+
+    if (WriteRecorder)
+        WriteRecorder->bWroteSeenCounters = true;
+
+    if (NumVisitLayers > 0)
+    {
+        FArticyNodeVisitLayer& Top = VisitLayers[NumVisitLayers - 1];
+        if (!Top.bSavedAll)
+        {
+            Top.Undo.Emplace(Slot, VisitStates[Slot]);
+            INC_DWORD_STAT(STAT_ArticySeenMapUndoEntries);
+        }
+    }
+
+    return VisitStates[Slot];
 }
 
 /**
@@ -468,20 +1359,24 @@ int UArticyGlobalVariables::GetSeenCounter(const IArticyFlowObject* Object) cons
     auto* Obj = Cast<UArticyPrimitive>(Object);
     if (Obj)
     {
-        FArticyId targetId;
-        targetId = Obj->GetId();
-
-        if (VisitedNodes.IsEmpty())
-            return 0;
-
-        if (auto* counter = VisitedNodes.Top().Find(targetId))
-        {
-            return *counter;
-        }
+        return GetSeenCounterOfSlot(Obj->GetSeenCounterSlot());
     }
     return 0;
 }
 
+/**
+ * Gets the seen counter of a seen counter slot.
+ * @param Slot The slot, see FArticySeenCounterSlots.
+ * @return The seen counter value, 0 if the slot was never counted.
+ */
+int UArticyGlobalVariables::GetSeenCounterOfSlot(int32 Slot) const
+{
+    if (ReadRecorder)
+        ReadRecorder->bReadSeenCounters = true;
+
+    return GetNodeVisitState(Slot).SeenCounter;
+}
+
 /**
  * Sets the seen counter for a specific object.
  * @param Object The object to modify.
@@ -493,24 +1388,10 @@ int UArticyGlobalVariables::SetSeenCounter(const IArticyFlowObject* Object, int
     auto* Obj = Cast<UArticyPrimitive>(Object);
     if (Obj)
     {
-        FArticyId targetId;
-        targetId = Obj->GetId();
+        if (NumVisitLayers == 0)
+            ++SeenVersion;
 
-        if (VisitedNodes.IsEmpty())
-        {
-            TMap<FArticyId, int> Empty;
-            VisitedNodes.Add(Empty);
-        }
-
-        // update if already tracked
-        if (auto* counter = VisitedNodes.Top().Find(targetId))
-        {
-            return *counter = Value;
-        }
-
-        // add and return
-        VisitedNodes.Top().Add(targetId, Value);
-        return Value;
+        return GetNodeVisitStateForWrite(Obj->GetSeenCounterSlot()).SeenCounter = Value;
     }
     return 0;
 }
@@ -525,30 +1406,17 @@ int UArticyGlobalVariables::IncrementSeenCounter(const IArticyFlowObject* Object
     auto* Obj = Cast<UArticyPrimitive>(Object);
     if (Obj)
     {
-        FArticyId targetId;
-        targetId = Obj->GetId();
-
-        if (VisitedNodes.IsEmpty())
-        {
-            TMap<FArticyId, int> Empty;
-            VisitedNodes.Add(Empty);
-        }
+        if (NumVisitLayers == 0)
+            ++SeenVersion;
 
-        // update if already tracked
-        if (auto* counter = VisitedNodes.Top().Find(targetId))
-        {
-            return ++(*counter);
-        }
-        // add and return
-        VisitedNodes.Top().Add(targetId, 1);
-        return 1;
+        return ++GetNodeVisitStateForWrite(Obj->GetSeenCounterSlot()).SeenCounter;
     }
     return 0;
 }
 
 /**
  * Checks if a fallback evaluation is active for a specific object.
- * @param Object The object to query.
+ * @param Object The object to query, or nullptr to check whether any fallback evaluation is active.
  * @return True if fallback evaluation is active, otherwise false.
  */
 bool UArticyGlobalVariables::Fallback(const IArticyFlowObject* Object)
@@ -556,32 +1424,10 @@ bool UArticyGlobalVariables::Fallback(const IArticyFlowObject* Object)
     auto* Obj = Cast<UArticyPrimitive>(Object);
     if (Obj)
     {
-        FArticyId targetId;
-        targetId = Obj->GetId();
-
-        if (bIsFallbackEvaluation.IsEmpty())
-            return false;
-
-        if (auto* state = bIsFallbackEvaluation.Top().Find(targetId))
-        {
-            return *state;
-        }
-    }
-    else
-    {
-        if (!bIsFallbackEvaluation.IsEmpty())
-        {
-            for (const auto& Elem : bIsFallbackEvaluation.Top())
-            {
-                if (Elem.Value)
-                {
-                    return true;
-                }
-            }
-        }
+        return GetNodeVisitState(Obj->GetSeenCounterSlot()).bFallbackEvaluation;
     }
 
-    return false;
+    return NumFallbackEvaluations > 0;
 }
 
 /**
@@ -592,57 +1438,78 @@ bool UArticyGlobalVariables::Fallback(const IArticyFlowObject* Object)
 void UArticyGlobalVariables::SetFallbackEvaluation(const IArticyFlowObject* Object, bool Value)
 {
     auto* Obj = Cast<UArticyPrimitive>(Object);
-    if (Obj)
+    if (Obj && GetNodeVisitState(Obj->GetSeenCounterSlot()).bFallbackEvaluation != Value)
     {
-        FArticyId targetId;
-        targetId = Obj->GetId();
-
-        if (bIsFallbackEvaluation.IsEmpty())
-        {
-            TMap<FArticyId, bool> Empty;
-            bIsFallbackEvaluation.Add(Empty);
-        }
-
-        // update if already tracked
-        if (auto* state = bIsFallbackEvaluation.Top().Find(targetId))
-        {
-            *state = Value;
-        }
-        else
-        {
-            bIsFallbackEvaluation.Top().Add(targetId, Value);
-        }
+        GetNodeVisitStateForWrite(Obj->GetSeenCounterSlot()).bFallbackEvaluation = Value;
+        NumFallbackEvaluations += Value ? 1 : -1;
     }
     return;
 }
 
 /**
  * Pushes the current seen state onto the stack.
+ * The new state gets an empty undo layer, which records the states changed in it.
  */
 void UArticyGlobalVariables::PushSeen()
 {
-    if (!VisitedNodes.IsEmpty())
-    {
-        TMap<FArticyId, int> Copy(VisitedNodes.Top());
-        VisitedNodes.Push(Copy);
-    }
-    if (!bIsFallbackEvaluation.IsEmpty())
+    //layers of popped states are kept, so their memory is reused
+    if (NumVisitLayers == VisitLayers.Num())
+        VisitLayers.AddDefaulted();
+
+    VisitLayers[NumVisitLayers++].NumFallbackEvaluations = NumFallbackEvaluations;
+}
+
+/**
+ * Pops the current seen state from the stack, discarding the changes made in it.
+ */
+void UArticyGlobalVariables::PopSeen()
+{
+    if (ensure(NumVisitLayers > 0))
     {
-        TMap<FArticyId, bool> Copy(bIsFallbackEvaluation.Top());
-        bIsFallbackEvaluation.Push(Copy);
+        FArticyNodeVisitLayer& Top = VisitLayers[--NumVisitLayers];
+        if (Top.bSavedAll)
+        {
+            VisitStates = MoveTemp(Top.SavedStates);
+        }
+        else
+        {
+            for (int32 i = Top.Undo.Num() - 1; i >= 0; --i)
+                VisitStates[Top.Undo[i].Key] = Top.Undo[i].Value;
+        }
+        NumFallbackEvaluations = Top.NumFallbackEvaluations;
+
+        Top.Undo.Reset();
+        Top.SavedStates.Reset();
+        Top.bSavedAll = false;
     }
 }
 
 /**
- * Pops the current seen state from the stack.
+ * Returns the node visit states outside of the pushed seen states, by undoing the layers on a copy like PopSeen does.
+ * @param OutStates Receives the visit states by seen counter slot.
+ * @param OutNumFallbackEvaluations Receives the number of nodes with an active fallback evaluation.
  */
-void UArticyGlobalVariables::PopSeen()
+void UArticyGlobalVariables::GetUnshadowedVisitStates(TArray<FArticyNodeVisitState>& OutStates, int32& OutNumFallbackEvaluations) const
 {
-    if (!bIsFallbackEvaluation.IsEmpty())
-        bIsFallbackEvaluation.Pop();
-    if (!VisitedNodes.IsEmpty())
-        VisitedNodes.Pop();
+    OutStates = VisitStates;
+    OutNumFallbackEvaluations = NumVisitLayers > 0 ? VisitLayers[0].NumFallbackEvaluations : NumFallbackEvaluations;
+
+    for (int32 Layer = NumVisitLayers - 1; Layer >= 0; --Layer)
+    {
+        const FArticyNodeVisitLayer& Top = VisitLayers[Layer];
+        if (Top.bSavedAll)
+        {
+            OutStates = Top.SavedStates;
+        }
+        else
+        {
+            for (int32 i = Top.Undo.Num() - 1; i >= 0; --i)
+                OutStates[Top.Undo[i].Key] = Top.Undo[i].Value;
+        }
+    }
 }
 
 TWeakObjectPtr<UArticyGlobalVariables> UArticyGlobalVariables::Clone;
+TWeakObjectPtr<UWorld> UArticyGlobalVariables::CloneWorld;
+bool UArticyGlobalVariables::bCloneReused = false;
 TMap<FName, TWeakObjectPtr< UArticyGlobalVariables>> UArticyGlobalVariables::OtherClones;
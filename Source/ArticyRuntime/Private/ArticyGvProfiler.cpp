@@ -0,0 +1,192 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyGvProfiler.h"
+#include "ArticyHelpers.h"
+#include "ArticyRuntimeModule.h"
+#include "ArticyScriptProfiler.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+bool FArticyGvProfiler::bEnabled = false;
+FAutoConsoleVariableRef FArticyGvProfiler::CVarProfileGVs(
+	TEXT("Articy.ProfileGVs"),
+	FArticyGvProfiler::bEnabled,
+	TEXT("Counts the reads and writes of the articy global variables by script fragment, see Articy.DumpGVProfile."));
+TMap<FName, FArticyGvProfiler::FVariableCounts> FArticyGvProfiler::Variables;
+FCriticalSection FArticyGvProfiler::VariablesLock;
+
+namespace
+{
+	/** The fragment the accesses of this thread are attributed to, see FFragmentScope. */
+	thread_local bool bInFragment = false;
+	thread_local int32 CurrentFragmentHash = 0;
+	thread_local bool bCurrentFragmentIsInstruction = false;
+
+	/** Quotes a CSV field, doubling the quotes in it. */
+	FString QuoteCsv(const FString& Value)
+	{
+		return TEXT("\"") + Value.Replace(TEXT("\""), TEXT("\"\"")).Replace(TEXT("\n"), TEXT(" ")) + TEXT("\"");
+	}
+}
+
+/**
+ * Attributes the accesses on this thread to a fragment until the scope ends.
+ * @param Hash The hash of the fragment.
+ * @param bInstruction Whether the fragment is an instruction.
+ */
+FArticyGvProfiler::FFragmentScope::FFragmentScope(int32 Hash, bool bInstruction)
+	: bActive(IsEnabled() && !bInFragment)
+{
+	//the fragments don't nest, a script calling back into the scripts keeps the outer one
+	if (!bActive)
+		return;
+
+	bInFragment = true;
+	CurrentFragmentHash = Hash;
+	bCurrentFragmentIsInstruction = bInstruction;
+}
+
+FArticyGvProfiler::FFragmentScope::~FFragmentScope()
+{
+	if (bActive)
+		bInFragment = false;
+}
+
+/**
+ * Returns the counts of a variable for the fragment of the current thread, or for the accesses outside of the scripts.
+ * @param Variable The name of the variable.
+ * @return The counts to increment.
+ */
+FArticyGvProfiler::FAccessCounts& FArticyGvProfiler::FindOrAddCounts(const FName& Variable)
+{
+	FVariableCounts& Counts = Variables.FindOrAdd(Variable);
+	if (!bInFragment)
+		return Counts.OutsideScripts;
+
+	FFragmentCounts& Fragment = Counts.Fragments.FindOrAdd(CurrentFragmentHash);
+	Fragment.bInstruction = bCurrentFragmentIsInstruction;
+	return Fragment.Counts;
+}
+
+/**
+ * Counts a read of a variable.
+ * @param Variable The name of the variable.
+ * @param bShadowed Whether the variable was read in a shadow state.
+ */
+void FArticyGvProfiler::RecordRead(const FName& Variable, bool bShadowed)
+{
+	FScopeLock Lock(&VariablesLock);
+
+	FAccessCounts& Counts = FindOrAddCounts(Variable);
+	++(bShadowed ? Counts.ShadowedReads : Counts.Reads);
+}
+
+/**
+ * Counts a write of a variable.
+ * @param Variable The name of the variable.
+ * @param bShadowed Whether the variable was written in a shadow state.
+ */
+void FArticyGvProfiler::RecordWrite(const FName& Variable, bool bShadowed)
+{
+	FScopeLock Lock(&VariablesLock);
+
+	FAccessCounts& Counts = FindOrAddCounts(Variable);
+	++(bShadowed ? Counts.ShadowedWrites : Counts.Writes);
+}
+
+/**
+ * Discards all recorded counts.
+ */
+void FArticyGvProfiler::Reset()
+{
+	FScopeLock Lock(&VariablesLock);
+	Variables.Reset();
+}
+
+/**
+ * Returns a row for the accesses of each variable from each fragment, and one for the accesses outside of the
+ * scripts if there are any.
+ * @return The rows, the most accessed first.
+ */
+TArray<FArticyGvProfiler::FRow> FArticyGvProfiler::GetRows()
+{
+	TArray<FRow> Rows;
+	{
+		FScopeLock Lock(&VariablesLock);
+		for (const auto& Variable : Variables)
+		{
+			for (const auto& Fragment : Variable.Value.Fragments)
+			{
+				FRow& Row = Rows.AddDefaulted_GetRef();
+				Row.Variable = Variable.Key;
+				Row.bInScript = true;
+				Row.FragmentHash = Fragment.Key;
+				Row.bInstruction = Fragment.Value.bInstruction;
+				Row.Counts = Fragment.Value.Counts;
+			}
+
+			if (Variable.Value.OutsideScripts.GetTotal() > 0)
+			{
+				FRow& Row = Rows.AddDefaulted_GetRef();
+				Row.Variable = Variable.Key;
+				Row.Counts = Variable.Value.OutsideScripts;
+			}
+		}
+	}
+
+	Rows.Sort([](const FRow& A, const FRow& B) { return A.Counts.GetTotal() > B.Counts.GetTotal(); });
+	return Rows;
+}
+
+/**
+ * Writes the counts to a CSV file, one line per variable and fragment, the most accessed first.
+ * @param FilePath The file, relative paths are relative to Saved/Articy/Profiles.
+ * @param Database The database to look up the fragments in, may be null.
+ * @return True if the file was written.
+ */
+bool FArticyGvProfiler::WriteCsv(const FString& FilePath, const UArticyDatabase* Database)
+{
+	const TArray<FRow> Rows = GetRows();
+
+	TSet<int32> Hashes;
+	for (const FRow& Row : Rows)
+	{
+		if (Row.bInScript)
+			Hashes.Add(Row.FragmentHash);
+	}
+	const TMap<int32, TPair<FString, FString>> Sources = FArticyScriptProfiler::FindSources(Database, Hashes);
+
+	FString Csv = TEXT("Variable,Fragment,Kind,Owner,Text,Reads,ShadowedReads,Writes,ShadowedWrites,Total\n");
+	for (const FRow& Row : Rows)
+	{
+		const TPair<FString, FString>* Source = Row.bInScript ? Sources.Find(Row.FragmentHash) : nullptr;
+		Csv += FString::Printf(TEXT("%s,%s,%s,%s,%s,%llu,%llu,%llu,%llu,%llu\n"), *Row.Variable.ToString(),
+			Row.bInScript ? *FString::FromInt(Row.FragmentHash) : TEXT(""),
+			!Row.bInScript ? TEXT("none") : Row.bInstruction ? TEXT("instruction") : TEXT("condition"),
+			*QuoteCsv(Source ? Source->Key : FString()), *QuoteCsv(Source ? Source->Value : FString()),
+			Row.Counts.Reads, Row.Counts.ShadowedReads, Row.Counts.Writes, Row.Counts.ShadowedWrites, Row.Counts.GetTotal());
+	}
+
+	const FString Path = GetProfilePath(FilePath);
+	if (!FFileHelper::SaveStringToFile(Csv, *Path))
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("Failed to write the GV profile %s."), *Path);
+		return false;
+	}
+
+	UE_LOG(LogArticyRuntime, Display, TEXT("Wrote the GV profile with %d rows to %s."), Rows.Num(), *Path);
+	return true;
+}
+
+/**
+ * Returns the path of a profile file.
+ * @param FilePath The file.
+ * @return The file, relative to Saved/Articy/Profiles if it is relative.
+ */
+FString FArticyGvProfiler::GetProfilePath(const FString& FilePath)
+{
+	return ArticyHelpers::GetSavedPath(TEXT("Profiles"), FilePath);
+}
@@ -0,0 +1,30 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyHierarchy.h"
+
+/**
+ * Removes all nodes, before the import adds them again.
+ */
+void FArticyHierarchy::Reset()
+{
+	Nodes.Reset();
+	SubtreeEnds.Reset();
+	NodeIndices.Reset();
+}
+
+/**
+ * Adds a node in depth-first order. Its subtree is empty until EndNode is called.
+ * Each object must only be added once.
+ * @param Id The object of the node.
+ * @return The index of the node, to pass to EndNode.
+ */
+int32 FArticyHierarchy::BeginNode(const FArticyId& Id)
+{
+	const int32 Index = Nodes.Add(Id);
+	SubtreeEnds.Add(Index + 1);
+	ensureMsgf(!NodeIndices.Contains(Id), TEXT("Object %s is in the hierarchy twice."), *Id.ToString());
+	NodeIndices.Add(Id, Index);
+	return Index;
+}
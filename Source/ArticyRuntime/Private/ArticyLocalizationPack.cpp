@@ -0,0 +1,323 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyLocalizationPack.h"
+#include "ArticyRuntimeModule.h"
+#include "ArticyPluginSettings.h"
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+static_assert(sizeof(TCHAR) == sizeof(uint16), "The localization packs store UTF-16 text, which is used as TCHAR directly.");
+
+using namespace ArticyLocalizationPackFormat;
+
+FArticyLocalizationPack::FArticyLocalizationPack()
+{
+}
+
+FArticyLocalizationPack::~FArticyLocalizationPack()
+{
+	// The regions have to go before the file they map
+	for (FTableSlot& Slot : Tables)
+	{
+		delete Slot.Region;
+		Slot.Region = nullptr;
+	}
+}
+
+/**
+ * Opens the pack of a culture, reading its header and table directory.
+ * @param Culture The culture name, as used by the importer (e.g. "en" or "pt-BR").
+ * @return The pack, or null if there is no valid pack for the culture.
+ */
+TSharedPtr<FArticyLocalizationPack> FArticyLocalizationPack::Open(const FString& Culture)
+{
+	const FString Path = FPaths::ProjectContentDir() / GetRelativePath(Culture);
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*Path))
+		return nullptr;
+
+	TUniquePtr<IFileHandle> File(PlatformFile.OpenRead(*Path));
+	if (!File)
+		return nullptr;
+
+	TSharedPtr<FArticyLocalizationPack> Pack = MakeShareable(new FArticyLocalizationPack());
+	Pack->Culture = Culture;
+	Pack->FileSize = File->Size();
+
+	FHeader Header;
+	if (Pack->FileSize < static_cast<int64>(sizeof(FHeader))
+		|| !File->Read(reinterpret_cast<uint8*>(&Header), sizeof(FHeader))
+		|| Header.Magic != Magic || Header.Version < 1 || Header.Version > Version)
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("Ignoring the localization pack %s, it is not a valid pack of this version."), *Path);
+		return nullptr;
+	}
+
+	Pack->bCompressedTexts = Header.Version >= 2 && (Header.Flags & CompressedTexts) != 0;
+	Pack->bTokensMarked = Header.Version >= 3 && (Header.Flags & TokensMarked) != 0;
+	Pack->MaxCachedBlocks = FMath::Max(1, UArticyPluginSettings::Get()->LocalizationPackCachedBlocks);
+	const uint64 SectionHeaderSize = Pack->bCompressedTexts ? sizeof(FCompressedSection) : 0;
+
+	// Check the directory fits into the file before allocating it, the header may be damaged
+	if (sizeof(FHeader) + static_cast<uint64>(Header.NumTables) * sizeof(FTable) > static_cast<uint64>(Pack->FileSize))
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("Ignoring the localization pack %s, its table directory is truncated."), *Path);
+		return nullptr;
+	}
+
+	TArray<FTable> Directory;
+	Directory.SetNumUninitialized(static_cast<int32>(Header.NumTables));
+	if (!File->Read(reinterpret_cast<uint8*>(Directory.GetData()), Directory.Num() * sizeof(FTable)))
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("Ignoring the localization pack %s, its table directory is truncated."), *Path);
+		return nullptr;
+	}
+
+	Pack->Tables.SetNum(Directory.Num());
+	for (int32 Index = 0; Index < Directory.Num(); ++Index)
+	{
+		const FTable& Table = Directory[Index];
+		FTableSlot& Slot = Pack->Tables[Index];
+		Slot.Table = Table;
+
+		const int64 NameSize = static_cast<int64>(Table.NameLength) * sizeof(TCHAR);
+		const bool bValid = (Table.NumBuckets & (Table.NumBuckets - 1)) == 0
+			&& static_cast<int64>(Table.NameOffset) + NameSize <= Pack->FileSize
+			&& static_cast<int64>(Table.SectionOffset + Table.SectionSize) <= Pack->FileSize
+			&& SectionHeaderSize + static_cast<uint64>(Table.NumBuckets) * sizeof(FBucket) <= Table.SectionSize;
+		if (!bValid)
+		{
+			UE_LOG(LogArticyRuntime, Warning, TEXT("Ignoring the localization pack %s, table %d is out of bounds."), *Path, Index);
+			return nullptr;
+		}
+
+		TArray<TCHAR> Name;
+		Name.SetNumUninitialized(Table.NameLength + 1);
+		if (!File->Seek(Table.NameOffset) || !File->Read(reinterpret_cast<uint8*>(Name.GetData()), NameSize))
+			return nullptr;
+		Name[Table.NameLength] = TCHAR(0);
+		Slot.Name = Name.GetData();
+	}
+
+	// Prefer mapping the file, the sections are then paged in by the OS
+	Pack->MappedFile.Reset(PlatformFile.OpenMapped(*Path));
+	if (!Pack->MappedFile)
+		Pack->File = MoveTemp(File);
+
+	return Pack;
+}
+
+/**
+ * Looks up a text, probing the key index of its table.
+ * @param TableName The string table of the key.
+ * @param Key The key of the text.
+ * @param OutText Receives the text, if the key is found.
+ * @return True if the key is in the pack.
+ */
+bool FArticyLocalizationPack::Find(const FString& TableName, const FString& Key, FString& OutText) const
+{
+	bool bHasTokens;
+	return Find(TableName, Key, OutText, bHasTokens);
+}
+
+/**
+ * Looks up a text, probing the key index of its table, and whether it has tokens.
+ * @param TableName The string table of the key.
+ * @param Key The key of the text.
+ * @param OutText Receives the text, if the key is found.
+ * @param bOutHasTokens Receives false if the pack flags the text as one without tokens.
+ * @return True if the key is in the pack.
+ */
+bool FArticyLocalizationPack::Find(const FString& TableName, const FString& Key, FString& OutText, bool& bOutHasTokens) const
+{
+	bOutHasTokens = true;
+	if (Key.IsEmpty())
+		return false;
+
+	const uint32 TableHash = Hash(*TableName, TableName.Len());
+	FTableSlot* Slot = Tables.FindByPredicate([&](const FTableSlot& Candidate)
+	{
+		return Candidate.Table.NameHash == TableHash && Candidate.Name.Equals(TableName, ESearchCase::CaseSensitive);
+	});
+	if (!Slot || Slot->Table.NumBuckets == 0)
+		return false;
+
+	const uint8* Section = GetSection(*Slot);
+	if (!Section)
+		return false;
+
+	// Compressed sections keep the keys apart from the texts, which are in the blocks
+	const uint64 SectionHeaderSize = bCompressedTexts ? sizeof(FCompressedSection) : 0;
+	const FBucket* Buckets = reinterpret_cast<const FBucket*>(Section + SectionHeaderSize);
+	const TCHAR* Chars = reinterpret_cast<const TCHAR*>(Section + SectionHeaderSize + Slot->Table.NumBuckets * sizeof(FBucket));
+	uint64 NumChars = (Slot->Table.SectionSize - SectionHeaderSize - Slot->Table.NumBuckets * sizeof(FBucket)) / sizeof(TCHAR);
+	if (bCompressedTexts)
+		NumChars = FMath::Min<uint64>(NumChars, reinterpret_cast<const FCompressedSection*>(Section)->NumKeyChars);
+
+	const uint32 KeyHash = Hash(*Key, Key.Len());
+	const uint32 Mask = Slot->Table.NumBuckets - 1;
+	for (uint32 Probe = 0, Index = KeyHash & Mask; Probe < Slot->Table.NumBuckets; ++Probe, Index = (Index + 1) & Mask)
+	{
+		if (Buckets[Index].KeyLength == 0)
+			return false;
+
+		if (Buckets[Index].KeyHash != KeyHash || Buckets[Index].KeyLength != static_cast<uint32>(Key.Len()))
+			continue;
+
+		// The flag is masked out of the length of a candidate, so the reads below see the plain length
+		FBucket Bucket = Buckets[Index];
+		const bool bHasTokens = !bTokensMarked || (Bucket.TextLength & TextHasTokens) != 0;
+		if (bTokensMarked)
+			Bucket.TextLength &= ~TextHasTokens;
+
+		if (static_cast<uint64>(Bucket.KeyOffset) + Bucket.KeyLength > NumChars)
+			return false;
+		if (!bCompressedTexts && static_cast<uint64>(Bucket.TextOffset) + Bucket.TextLength > NumChars)
+			return false;
+
+		if (FMemory::Memcmp(Chars + Bucket.KeyOffset, *Key, Bucket.KeyLength * sizeof(TCHAR)) == 0)
+		{
+			bOutHasTokens = bHasTokens;
+			if (bCompressedTexts)
+				return ReadCompressedText(static_cast<int32>(Slot - Tables.GetData()), Section, Bucket, OutText);
+
+			OutText = FString(Bucket.TextLength, Chars + Bucket.TextOffset);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Copies a text of a section with compressed texts. The block of the text is decompressed unless it is among the
+ * most recently used ones, the least recently used block is dropped if the cache is full.
+ * @param TableIndex The index of the table of the section.
+ * @param Section The section.
+ * @param Bucket The bucket of the key of the text.
+ * @param OutText Receives the text.
+ * @return True if the text could be read.
+ */
+bool FArticyLocalizationPack::ReadCompressedText(int32 TableIndex, const uint8* Section, const FBucket& Bucket, FString& OutText) const
+{
+	if (Bucket.TextLength == 0)
+	{
+		OutText.Reset();
+		return true;
+	}
+
+	const FTable& Table = Tables[TableIndex].Table;
+	const FCompressedSection& SectionHeader = *reinterpret_cast<const FCompressedSection*>(Section);
+	const uint64 BlocksOffset = Align(sizeof(FCompressedSection) + static_cast<uint64>(Table.NumBuckets) * sizeof(FBucket) + static_cast<uint64>(SectionHeader.NumKeyChars) * sizeof(TCHAR), alignof(FBlock));
+	if (BlocksOffset + static_cast<uint64>(SectionHeader.NumBlocks) * sizeof(FBlock) > Table.SectionSize)
+		return false;
+
+	// The block which starts last at or before the text holds all of it
+	const TConstArrayView<FBlock> Blocks(reinterpret_cast<const FBlock*>(Section + BlocksOffset), SectionHeader.NumBlocks);
+	const int32 BlockIndex = Algo::UpperBoundBy(Blocks, Bucket.TextOffset, &FBlock::FirstChar) - 1;
+	if (BlockIndex < 0)
+		return false;
+
+	const FBlock& Block = Blocks[BlockIndex];
+	if (static_cast<uint64>(Bucket.TextOffset) + Bucket.TextLength > static_cast<uint64>(Block.FirstChar) + Block.NumChars
+		|| static_cast<uint64>(Block.DataOffset) + Block.DataSize > Table.SectionSize)
+		return false;
+
+	FScopeLock Lock(&PagingLock);
+
+	int32 CacheIndex = BlockCache.IndexOfByPredicate([&](const FCachedBlock& Cached)
+	{
+		return Cached.TableIndex == TableIndex && Cached.BlockIndex == BlockIndex;
+	});
+	if (CacheIndex == INDEX_NONE)
+	{
+		FCachedBlock Cached;
+		Cached.TableIndex = TableIndex;
+		Cached.BlockIndex = BlockIndex;
+		Cached.Chars.SetNumUninitialized(Block.NumChars);
+		if (!FCompression::UncompressMemory(NAME_Zlib, Cached.Chars.GetData(), Block.NumChars * sizeof(TCHAR), Section + Block.DataOffset, Block.DataSize))
+		{
+			UE_LOG(LogArticyRuntime, Warning, TEXT("Could not decompress block %d of the string table %s of the %s localization pack."), BlockIndex, *Tables[TableIndex].Name, *Culture);
+			return false;
+		}
+
+		if (BlockCache.Num() >= MaxCachedBlocks)
+			BlockCache.RemoveAt(0);
+		CacheIndex = BlockCache.Add(MoveTemp(Cached));
+	}
+	else if (CacheIndex != BlockCache.Num() - 1)
+	{
+		FCachedBlock Used = MoveTemp(BlockCache[CacheIndex]);
+		BlockCache.RemoveAt(CacheIndex);
+		CacheIndex = BlockCache.Add(MoveTemp(Used));
+	}
+
+	OutText = FString(Bucket.TextLength, BlockCache[CacheIndex].Chars.GetData() + (Bucket.TextOffset - Block.FirstChar));
+	return true;
+}
+
+/**
+ * Returns the memory allocated by the pack: the table directory, the sections which had to be read
+ * because the file could not be mapped, and the decompressed blocks.
+ * @return The allocated size in bytes.
+ */
+SIZE_T FArticyLocalizationPack::GetAllocatedSize() const
+{
+	FScopeLock Lock(&PagingLock);
+
+	SIZE_T Bytes = Culture.GetAllocatedSize() + Tables.GetAllocatedSize();
+	for (const FTableSlot& Slot : Tables)
+	{
+		Bytes += Slot.Name.GetAllocatedSize() + Slot.Data.GetAllocatedSize();
+	}
+	Bytes += BlockCache.GetAllocatedSize();
+	for (const FCachedBlock& Cached : BlockCache)
+	{
+		Bytes += Cached.Chars.GetAllocatedSize();
+	}
+	return Bytes;
+}
+
+/**
+ * Returns the section of a table, paging it in on first use.
+ * @param Slot The table to get the section of.
+ * @return The section, or null if it cannot be mapped or read.
+ */
+const uint8* FArticyLocalizationPack::GetSection(FTableSlot& Slot) const
+{
+	FScopeLock Lock(&PagingLock);
+
+	if (Slot.Section || Slot.bPagingFailed)
+		return Slot.Section;
+
+	if (MappedFile)
+	{
+		Slot.Region = MappedFile->MapRegion(Slot.Table.SectionOffset, Slot.Table.SectionSize);
+		if (Slot.Region)
+			Slot.Section = Slot.Region->GetMappedPtr();
+	}
+	else if (File)
+	{
+		Slot.Data.SetNumUninitialized(Slot.Table.SectionSize);
+		if (File->Seek(Slot.Table.SectionOffset) && File->Read(Slot.Data.GetData(), Slot.Data.Num()))
+			Slot.Section = Slot.Data.GetData();
+		else
+			Slot.Data.Empty();
+	}
+
+	if (!Slot.Section)
+	{
+		Slot.bPagingFailed = true;
+		UE_LOG(LogArticyRuntime, Warning, TEXT("Could not page in the string table %s of the %s localization pack."), *Slot.Name, *Culture);
+	}
+
+	return Slot.Section;
+}
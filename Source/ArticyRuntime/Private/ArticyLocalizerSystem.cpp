@@ -0,0 +1,287 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyLocalizerSystem.h"
+#include "ArticyRuntimeModule.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+
+DECLARE_CYCLE_STAT(TEXT("Localization culture switch"), STAT_ArticyCultureSwitch, STATGROUP_Articy);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last localization culture switch (ms)"), STAT_ArticyCultureSwitchMs, STATGROUP_Articy);
+
+/**
+ * Adds a generated string table file.
+ * @param Culture The culture of the file, empty for the default tables.
+ * @param TableName The name of the string table.
+ * @param RelativePath The path of the CSV file, relative to the project content directory.
+ * @param bMarksTokens Whether the file has the Tokens metadata column.
+ */
+void UArticyLocalizerSystem::AddStringTableFile(const FString& Culture, const FString& TableName, const FString& RelativePath, bool bMarksTokens)
+{
+	StringTableFiles.FindOrAdd(Culture).Add(TableName, RelativePath);
+	if (bMarksTokens)
+	{
+		TokenMarkedFiles.Add(RelativePath);
+	}
+}
+
+/**
+ * Removes the string table files, the generated Reload adds the ones of the current import again.
+ * In the editor, the warm tables whose files were written since they were loaded, e.g. by a reimport, are released.
+ */
+void UArticyLocalizerSystem::ResetStringTableFiles()
+{
+	StringTableFiles.Reset();
+	TokenMarkedFiles.Reset();
+
+#if WITH_EDITOR
+	IFileManager& FileManager = IFileManager::Get();
+	for (auto It = WarmTableTimestamps.CreateIterator(); It; ++It)
+	{
+		if (!WarmTables.Contains(It.Key()) || FileManager.GetTimeStamp(*(FPaths::ProjectContentDir() / It.Key())) != It.Value)
+		{
+			WarmTables.Remove(It.Key());
+			It.RemoveCurrent();
+		}
+	}
+#endif
+}
+
+/**
+ * Switches the registered string tables to a culture, keeping the tables of the previous culture warm.
+ * @param LocaleName The name of the current culture (e.g. "pt-BR").
+ * @param LangName The two letter language of the current culture, used if there are no tables of the locale.
+ */
+void UArticyLocalizerSystem::SwitchCulture(const FString& LocaleName, const FString& LangName)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ArticyCultureSwitch);
+	const double StartTime = FPlatformTime::Seconds();
+
+	// The tables of the locale, otherwise of a culture of the same language, otherwise the default tables
+	FString Culture;
+	if (StringTableFiles.Contains(LocaleName))
+	{
+		Culture = LocaleName;
+	}
+	else
+	{
+		// The order of the map is not defined, so pick the culture the locale specializes the most (e.g. "zh-Hans"
+		// or "zh" for "zh-Hans-CN"), and the first one by name among the other cultures of the language
+		int32 BestPrefixLength = INDEX_NONE;
+		for (const auto& CultureFiles : StringTableFiles)
+		{
+			const FString& Candidate = CultureFiles.Key;
+			FString CandidateLanguage;
+			if (!Candidate.Split(TEXT("-"), &CandidateLanguage, nullptr))
+			{
+				CandidateLanguage = Candidate;
+			}
+			if (Candidate.IsEmpty() || !CandidateLanguage.Equals(LangName, ESearchCase::IgnoreCase))
+			{
+				continue;
+			}
+
+			const int32 PrefixLength = LocaleName.StartsWith(Candidate + TEXT("-"), ESearchCase::IgnoreCase) ? Candidate.Len() : 0;
+			if (PrefixLength > BestPrefixLength || (PrefixLength == BestPrefixLength && Candidate < Culture))
+			{
+				BestPrefixLength = PrefixLength;
+				Culture = Candidate;
+			}
+		}
+	}
+
+	// Switching to the active culture again refreshes its tables, e.g. after a reimport, and keeps the previous one
+	if (!ActiveCulture.IsSet() || ActiveCulture.GetValue() != Culture)
+	{
+		PreviousCulture = ActiveCulture;
+		ActiveCulture = Culture;
+	}
+
+	ActiveTableFiles.Reset();
+	if (const TMap<FString, FString>* DefaultFiles = StringTableFiles.Find(FString()))
+	{
+		ActiveTableFiles.Append(*DefaultFiles);
+	}
+	if (const TMap<FString, FString>* CultureFiles = StringTableFiles.Find(Culture))
+	{
+		ActiveTableFiles.Append(*CultureFiles);
+	}
+
+	// Swap out the tables which were in use, the others are registered once they are looked up
+	TSet<FString> UsedTables = MoveTemp(RegisteredTables);
+	UsedTables.Add(TEXT("ARTICY"));
+	RegisteredTables.Reset();
+	StringTables.Reset();
+	for (const FString& TableName : UsedTables)
+	{
+		FStringTableRegistry::Get().UnregisterStringTable(FName(TableName));
+		RegisterStringTable(TableName);
+	}
+
+	// Only the tables of the active and the previous culture stay warm
+	TSet<FString> WarmFiles;
+	for (const TOptional<FString>& KeptCulture : { ActiveCulture, PreviousCulture })
+	{
+		if (!KeptCulture.IsSet())
+		{
+			continue;
+		}
+
+		for (const FString& KeptFileCulture : { FString(), KeptCulture.GetValue() })
+		{
+			if (const TMap<FString, FString>* Files = StringTableFiles.Find(KeptFileCulture))
+			{
+				for (const auto& File : *Files)
+				{
+					WarmFiles.Add(File.Value);
+				}
+			}
+		}
+	}
+	for (auto It = WarmTables.CreateIterator(); It; ++It)
+	{
+		if (!WarmFiles.Contains(It.Key()))
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	const float SwitchMs = static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	SET_FLOAT_STAT(STAT_ArticyCultureSwitchMs, SwitchMs);
+	UE_LOG(LogArticyRuntime, Verbose, TEXT("Switched the articy string tables to culture '%s' in %.2f ms (%d tables registered)."), *Culture, SwitchMs, RegisteredTables.Num());
+}
+
+/**
+ * Registers a string table of the active culture, loading it unless it is still warm.
+ * @param TableName The name of the string table.
+ * @return The registered table, or null if the active culture has no such table.
+ */
+FStringTableConstPtr UArticyLocalizerSystem::RegisterStringTable(const FString& TableName)
+{
+	const FString* File = ActiveTableFiles.Find(TableName);
+	if (!File)
+	{
+		return nullptr;
+	}
+
+	FStringTableRegistry& Registry = FStringTableRegistry::Get();
+	const FName TableId(TableName);
+
+	FStringTablePtr& Table = WarmTables.FindOrAdd(*File);
+	if (Table.IsValid())
+	{
+		Registry.UnregisterStringTable(TableId);
+		Registry.RegisterStringTable(TableId, Table.ToSharedRef());
+	}
+	else
+	{
+		Registry.UnregisterStringTable(TableId);
+		Registry.Internal_LocTableFromFile(TableId, TableName, *File, FPaths::ProjectContentDir());
+		Table = Registry.FindMutableStringTable(TableId);
+#if WITH_EDITOR
+		WarmTableTimestamps.Add(*File, IFileManager::Get().GetTimeStamp(*(FPaths::ProjectContentDir() / *File)));
+#endif
+	}
+
+	RegisteredTables.Add(TableName);
+	return Table;
+}
+
+/**
+ * Registers the string table of a package which was loaded, counting the databases which loaded it.
+ * @param PackageName The name of the package.
+ */
+void UArticyLocalizerSystem::OnPackageLoaded(const FString& PackageName)
+{
+	if (UsesKeysOnly())
+	{
+		return;
+	}
+
+	const FString TableName = GetPackageTableName(PackageName);
+	++LoadedPackageTables.FindOrAdd(TableName);
+
+	if (!bDataLoaded)
+	{
+		Reload();
+	}
+
+	if (!LocalizationPack.IsValid())
+	{
+		bool bTableMarksTokens;
+		FindStringTable(TableName, bTableMarksTokens);
+	}
+}
+
+/**
+ * Unregisters the string table of a package once the last database which loaded it unloads it.
+ * @param PackageName The name of the package.
+ */
+void UArticyLocalizerSystem::OnPackageUnloaded(const FString& PackageName)
+{
+	const FString TableName = GetPackageTableName(PackageName);
+	int32* NumLoaded = LoadedPackageTables.Find(TableName);
+	if (!NumLoaded || --(*NumLoaded) > 0)
+	{
+		return;
+	}
+
+	LoadedPackageTables.Remove(TableName);
+	UnregisterStringTable(TableName);
+}
+
+/**
+ * Unregisters a string table registered by RegisterStringTable, and releases its warm copy of the active culture.
+ * The warm copy of the previous culture is kept, so switching back doesn't parse it again.
+ * @param TableName The name of the string table.
+ */
+void UArticyLocalizerSystem::UnregisterStringTable(const FString& TableName)
+{
+	if (!RegisteredTables.Remove(TableName))
+	{
+		return;
+	}
+
+	FStringTableRegistry::Get().UnregisterStringTable(FName(TableName));
+	StringTables.Remove(TableName);
+
+	if (const FString* File = ActiveTableFiles.Find(TableName))
+	{
+		WarmTables.Remove(*File);
+	}
+}
+
+/**
+ * Returns the memory of the loaded string tables, the warm tables and the registered ones.
+ * @param OutNumTables Receives the number of loaded tables.
+ * @return The size of the keys and source strings of the tables.
+ */
+SIZE_T UArticyLocalizerSystem::GetStringTablesAllocatedSize(int32& OutNumTables) const
+{
+	TSet<const FStringTable*> Tables;
+	for (const TPair<FString, FStringTablePtr>& Warm : WarmTables)
+	{
+		if (Warm.Value.IsValid())
+			Tables.Add(Warm.Value.Get());
+	}
+	for (const FString& TableName : RegisteredTables)
+	{
+		if (FStringTableConstPtr Table = FStringTableRegistry::Get().FindStringTable(FName(TableName)))
+			Tables.Add(Table.Get());
+	}
+
+	SIZE_T Bytes = 0;
+	for (const FStringTable* Table : Tables)
+	{
+		Table->EnumerateSourceStrings([&Bytes](const FString& Key, const FString& SourceString)
+		{
+			Bytes += sizeof(FStringTableEntry) + Key.GetAllocatedSize() + SourceString.GetAllocatedSize();
+			return true;
+		});
+	}
+
+	OutNumTables = Tables.Num();
+	return Bytes;
+}
@@ -0,0 +1,291 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyLocationIndex.h"
+#include "ArticyBuiltinTypes.h"
+#include "ArticyDatabase.h"
+#include "ArticyObject.h"
+#include "Interfaces/ArticyObjectWithPosition.h"
+#include "Interfaces/ArticyObjectWithVertices.h"
+#include "Interfaces/ArticyObjectWithZIndex.h"
+#include "Algo/StableSort.h"
+
+namespace
+{
+	/** The most cells a grid has per axis. */
+	constexpr int32 MaxCellsPerAxis = 64;
+
+	/**
+	 * Calls Visitor for the loaded descendants of a location, through the flattened hierarchy of the database
+	 * or, if it was not imported, by following the children.
+	 */
+	template<typename TVisitor>
+	void ForEachLocationObject(const UArticyDatabase* Database, const FArticyId& LocationId, TVisitor&& Visitor)
+	{
+		if (Database->GetHierarchy().Find(LocationId) != INDEX_NONE)
+		{
+			Database->ForEachDescendant(LocationId, 0, Visitor);
+			return;
+		}
+
+		const UArticyObject* Location = Database->GetObject(LocationId);
+		TArray<FArticyId> Open = Location ? Location->GetChildrenIDs() : TArray<FArticyId>();
+		while (Open.Num() > 0)
+		{
+			if (UArticyObject* Object = Database->GetObject(Open.Pop()))
+			{
+				Visitor(Object);
+				Open.Append(Object->GetChildrenIDs());
+			}
+		}
+	}
+}
+
+/**
+ * Builds the index of the loaded zones and spots below a location.
+ * @param Database The database the location is loaded into.
+ * @param LocationId The id of the location.
+ */
+FArticyLocationIndex::FArticyLocationIndex(const UArticyDatabase* Database, const FArticyId& LocationId)
+{
+	if (!Database)
+		return;
+
+	ForEachLocationObject(Database, LocationId, [this](UArticyObject* Object)
+	{
+		if (Object->IsA<UArticyZone>())
+		{
+			const IArticyObjectWithVertices* WithVertices = Cast<IArticyObjectWithVertices>(Object);
+			const TArray<FVector2D>* ZoneVertices = WithVertices ? &WithVertices->GetVertices() : nullptr;
+			if (!ZoneVertices || ZoneVertices->Num() < 3)
+				return;
+
+			FZone& Zone = Zones.AddDefaulted_GetRef();
+			Zone.Object = Object;
+			Zone.Bounds = FBox2D(*ZoneVertices);
+			Zone.FirstVertex = Vertices.Num();
+			Zone.NumVertices = ZoneVertices->Num();
+			Vertices.Append(*ZoneVertices);
+
+			if (const IArticyObjectWithZIndex* WithZIndex = Cast<IArticyObjectWithZIndex>(Object))
+				Zone.ZIndex = WithZIndex->GetZIndex();
+
+			//shoelace formula
+			double Area = 0.0;
+			for (int32 i = 0, j = ZoneVertices->Num() - 1; i < ZoneVertices->Num(); j = i++)
+				Area += (double)(*ZoneVertices)[j].X * (*ZoneVertices)[i].Y - (double)(*ZoneVertices)[i].X * (*ZoneVertices)[j].Y;
+			Zone.Area = (float)(FMath::Abs(Area) * 0.5);
+		}
+		else if (Object->IsA<UArticySpot>())
+		{
+			if (const IArticyObjectWithPosition* WithPosition = Cast<IArticyObjectWithPosition>(Object))
+				Spots.Add({ Object, WithPosition->GetPosition() });
+		}
+	});
+
+	TArray<FBox2D> Bounds;
+	Bounds.Reserve(Zones.Num());
+	for (const FZone& Zone : Zones)
+		Bounds.Add(Zone.Bounds);
+	ZoneGrid.Build(Bounds);
+
+	Bounds.Reset(Spots.Num());
+	for (const FSpot& Spot : Spots)
+		Bounds.Add(FBox2D(Spot.Position, Spot.Position));
+	SpotGrid.Build(Bounds);
+}
+
+/**
+ * Returns the zone containing a point.
+ * @param Point The point, in location coordinates.
+ * @return The containing zone with the highest z-index, the smallest of them on ties, or nullptr.
+ */
+UArticyObject* FArticyLocationIndex::FindZoneAt(const FVector2D& Point) const
+{
+	if (Zones.Num() == 0 || !ZoneGrid.Bounds.IsInside(Point))
+		return nullptr;
+
+	const FIntPoint Cell = ZoneGrid.GetCell(Point);
+	const FZone* Best = nullptr;
+	for (const int32 Index : ZoneGrid.GetItems(Cell.X, Cell.Y))
+	{
+		const FZone& Zone = Zones[Index];
+		if (Best && (Zone.ZIndex < Best->ZIndex || (Zone.ZIndex == Best->ZIndex && Zone.Area >= Best->Area)))
+			continue;
+
+		if (Contains(Zone, Point))
+			Best = &Zone;
+	}
+
+	return Best ? Best->Object : nullptr;
+}
+
+/**
+ * Adds all zones containing a point.
+ * @param Point The point, in location coordinates.
+ * @param OutZones Receives the zones, ordered by z-index from highest to lowest.
+ * @return The number of zones added.
+ */
+int32 FArticyLocationIndex::FindZonesAt(const FVector2D& Point, TArray<UArticyObject*>& OutZones) const
+{
+	if (Zones.Num() == 0 || !ZoneGrid.Bounds.IsInside(Point))
+		return 0;
+
+	const int32 First = OutZones.Num();
+	const FIntPoint Cell = ZoneGrid.GetCell(Point);
+	for (const int32 Index : ZoneGrid.GetItems(Cell.X, Cell.Y))
+	{
+		if (Contains(Zones[Index], Point))
+			OutZones.Add(Zones[Index].Object);
+	}
+
+	//the cells hold the zones in index order, so sort the (few) matches by z-index
+	TArrayView<UArticyObject*> Found(OutZones.GetData() + First, OutZones.Num() - First);
+	Algo::StableSortBy(Found, [](const UArticyObject* Zone)
+	{
+		const IArticyObjectWithZIndex* WithZIndex = Cast<IArticyObjectWithZIndex>(Zone);
+		return WithZIndex ? -WithZIndex->GetZIndex() : 0.f;
+	});
+
+	return Found.Num();
+}
+
+/**
+ * Returns the spot closest to a point, searching the cells around the point in rings until no closer spot can follow.
+ * @param Point The point, in location coordinates.
+ * @param MaxDistance Spots further away are ignored, 0 for no limit.
+ * @return The spot, or nullptr if there is none within MaxDistance.
+ */
+UArticyObject* FArticyLocationIndex::FindNearestSpot(const FVector2D& Point, float MaxDistance) const
+{
+	if (Spots.Num() == 0)
+		return nullptr;
+
+	const FIntPoint Center = SpotGrid.GetCell(Point);
+	const double MinCellSize = FMath::Min(SpotGrid.CellSize.X, SpotGrid.CellSize.Y);
+	const int32 MaxRing = FMath::Max(SpotGrid.NumX, SpotGrid.NumY);
+
+	const FSpot* Best = nullptr;
+	double BestDistSq = MaxDistance > 0.f ? FMath::Square((double)MaxDistance) : TNumericLimits<double>::Max();
+
+	for (int32 Ring = 0; Ring <= MaxRing; ++Ring)
+	{
+		//the cells of this ring are at least Ring - 1 cells away from the point
+		if (Ring > 0 && FMath::Square((Ring - 1) * MinCellSize) > BestDistSq)
+			break;
+
+		for (int32 Y = Center.Y - Ring; Y <= Center.Y + Ring; ++Y)
+		{
+			if (Y < 0 || Y >= SpotGrid.NumY)
+				continue;
+
+			//inner rows only have the two cells at the edges of the ring
+			const bool bEdgeRow = Y == Center.Y - Ring || Y == Center.Y + Ring;
+			const int32 Step = bEdgeRow || Ring == 0 ? 1 : 2 * Ring;
+			for (int32 X = Center.X - Ring; X <= Center.X + Ring; X += Step)
+			{
+				if (X < 0 || X >= SpotGrid.NumX)
+					continue;
+
+				for (const int32 Index : SpotGrid.GetItems(X, Y))
+				{
+					const double DistSq = FVector2D::DistSquared(Spots[Index].Position, Point);
+					if (DistSq <= BestDistSq)
+					{
+						BestDistSq = DistSq;
+						Best = &Spots[Index];
+					}
+				}
+			}
+		}
+	}
+
+	return Best ? Best->Object : nullptr;
+}
+
+/**
+ * Checks whether a point is inside of a zone, by the even-odd rule.
+ * @param Zone The zone.
+ * @param Point The point.
+ * @return True if the point is inside.
+ */
+bool FArticyLocationIndex::Contains(const FZone& Zone, const FVector2D& Point) const
+{
+	if (!Zone.Bounds.IsInside(Point))
+		return false;
+
+	const FVector2D* Polygon = Vertices.GetData() + Zone.FirstVertex;
+	bool bInside = false;
+	for (int32 i = 0, j = Zone.NumVertices - 1; i < Zone.NumVertices; j = i++)
+	{
+		const FVector2D& A = Polygon[i];
+		const FVector2D& B = Polygon[j];
+		if ((A.Y > Point.Y) != (B.Y > Point.Y)
+			&& Point.X < (B.X - A.X) * (Point.Y - A.Y) / (B.Y - A.Y) + A.X)
+		{
+			bInside = !bInside;
+		}
+	}
+
+	return bInside;
+}
+
+//---------------------------------------------------------------------------//
+
+/**
+ * Builds the grid from the bounds of the items, with roughly one item per cell.
+ * Each item is stored in every cell its bounds overlap.
+ * @param ItemBounds The bounds of the items, indexed like the items.
+ */
+void FArticyLocationIndex::FGrid::Build(const TArray<FBox2D>& ItemBounds)
+{
+	Bounds = FBox2D(ForceInit);
+	for (const FBox2D& Item : ItemBounds)
+		Bounds += Item;
+
+	const int32 NumPerAxis = FMath::Clamp(FMath::CeilToInt(FMath::Sqrt((float)ItemBounds.Num())), 1, MaxCellsPerAxis);
+	NumX = NumPerAxis;
+	NumY = NumPerAxis;
+
+	const FVector2D Size = Bounds.bIsValid ? Bounds.GetSize() : FVector2D::ZeroVector;
+	CellSize = FVector2D(Size.X > 0 ? Size.X / NumX : 1.0, Size.Y > 0 ? Size.Y / NumY : 1.0);
+
+	//count the items per cell, then store them contiguously
+	CellStarts.Reset();
+	CellStarts.SetNumZeroed(NumX * NumY + 1);
+	for (const FBox2D& Item : ItemBounds)
+	{
+		const FIntPoint Min = GetCell(Item.Min);
+		const FIntPoint Max = GetCell(Item.Max);
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+			for (int32 X = Min.X; X <= Max.X; ++X)
+				++CellStarts[Y * NumX + X + 1];
+	}
+
+	for (int32 Cell = 1; Cell < CellStarts.Num(); ++Cell)
+		CellStarts[Cell] += CellStarts[Cell - 1];
+
+	Items.SetNumUninitialized(CellStarts.Last());
+	TArray<int32> Next(CellStarts.GetData(), NumX * NumY);
+	for (int32 Index = 0; Index < ItemBounds.Num(); ++Index)
+	{
+		const FIntPoint Min = GetCell(ItemBounds[Index].Min);
+		const FIntPoint Max = GetCell(ItemBounds[Index].Max);
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+			for (int32 X = Min.X; X <= Max.X; ++X)
+				Items[Next[Y * NumX + X]++] = Index;
+	}
+}
+
+/**
+ * Returns the cell coordinates of a point, clamped to the grid.
+ * @param Point The point.
+ * @return The cell.
+ */
+FIntPoint FArticyLocationIndex::FGrid::GetCell(const FVector2D& Point) const
+{
+	const int32 X = FMath::FloorToInt((Point.X - Bounds.Min.X) / CellSize.X);
+	const int32 Y = FMath::FloorToInt((Point.Y - Bounds.Min.Y) / CellSize.Y);
+	return FIntPoint(FMath::Clamp(X, 0, NumX - 1), FMath::Clamp(Y, 0, NumY - 1));
+}
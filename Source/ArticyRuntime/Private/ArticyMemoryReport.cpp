@@ -0,0 +1,298 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyMemoryReport.h"
+#include "ArticyRuntimeModule.h"
+#include "ArticyDatabase.h"
+#include "ArticyGlobalVariables.h"
+#include "ArticyLocalizerSystem.h"
+#include "ArticyObject.h"
+#include "ArticyPackage.h"
+#include "Misc/OutputDevice.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "UObject/UObjectIterator.h"
+
+DECLARE_MEMORY_STAT(TEXT("Generated packages"), STAT_ArticyPackagesMemory, STATGROUP_Articy);
+DECLARE_MEMORY_STAT(TEXT("Database clones"), STAT_ArticyClonesMemory, STATGROUP_Articy);
+DECLARE_MEMORY_STAT(TEXT("Shadow copies"), STAT_ArticyShadowsMemory, STATGROUP_Articy);
+DECLARE_MEMORY_STAT(TEXT("Global variables"), STAT_ArticyGlobalVariablesMemory, STATGROUP_Articy);
+DECLARE_MEMORY_STAT(TEXT("String tables"), STAT_ArticyStringTablesMemory, STATGROUP_Articy);
+
+FArticyMemoryReport::FOnCollect FArticyMemoryReport::OnCollect;
+FTSTicker::FDelegateHandle FArticyMemoryReport::StatsTickerHandle;
+
+namespace
+{
+	/** Returns true for the class default objects and archetypes, which are not articy data. */
+	bool IsTemplate(const UObject* Object)
+	{
+		return Object->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject);
+	}
+}
+
+/**
+ * Measures the memory of the loaded articy data, see the declaration.
+ * @return The report, with one entry per category.
+ */
+FArticyMemoryReport FArticyMemoryReport::Collect()
+{
+	check(IsInGameThread());
+
+	FArticyMemoryReport Report;
+
+	SIZE_T PackageBytes = 0;
+	int32 NumPackageObjects = 0;
+	for (TObjectIterator<UArticyPackage> It; It; ++It)
+	{
+		if (IsTemplate(*It))
+			continue;
+
+		PackageBytes += GetObjectSize(*It);
+		for (const UArticyObject* Asset : It->GetAssets())
+		{
+			PackageBytes += GetObjectSize(Asset);
+			++NumPackageObjects;
+		}
+	}
+	Report.Add(TEXT("Generated packages (objects)"), NumPackageObjects, PackageBytes);
+
+	SIZE_T CloneBytes = 0, ShadowBytes = 0;
+	int32 NumClones = 0, NumShadows = 0;
+	for (TObjectIterator<UArticyDatabase> It; It; ++It)
+	{
+		if (IsTemplate(*It))
+			continue;
+
+		const UPackage* DatabasePackage = It->GetOutermost();
+		It->ForEachObjectCopy([&](const UArticyObject* Copy, uint32 ShadowLevel)
+		{
+			if (ShadowLevel > 0)
+			{
+				ShadowBytes += GetObjectSize(Copy);
+				++NumShadows;
+			}
+			// clones shared with the package (see bShareUnmodifiedObjectsWithPackages) are counted with the packages
+			else if (Copy->GetOutermost() == DatabasePackage)
+			{
+				CloneBytes += GetObjectSize(Copy);
+				++NumClones;
+			}
+		});
+	}
+	Report.Add(TEXT("Database clones"), NumClones, CloneBytes);
+	Report.Add(TEXT("Shadow copies"), NumShadows, ShadowBytes);
+
+	SIZE_T VariableBytes = 0, VariableShadowBytes = 0;
+	int32 NumVariables = 0;
+	for (TObjectIterator<UArticyBaseVariableSet> It; It; ++It)
+	{
+		if (IsTemplate(*It))
+			continue;
+
+		VariableBytes += GetObjectSize(*It);
+		for (const UArticyVariable* Variable : It->GetVariables())
+		{
+			if (!Variable)
+				continue;
+
+			VariableBytes += GetObjectSize(Variable);
+			VariableShadowBytes += Variable->GetShadowsAllocatedSize();
+			++NumVariables;
+		}
+	}
+	Report.Add(TEXT("Global variables"), NumVariables, VariableBytes);
+	Report.Add(TEXT("Global variable shadow states"), NumVariables, VariableShadowBytes);
+
+	SIZE_T StringTableBytes = 0;
+	int32 NumStringTables = 0;
+	if (const UArticyLocalizerSystem* Localizer = UArticyLocalizerSystem::Get())
+	{
+		StringTableBytes = Localizer->GetStringTablesAllocatedSize(NumStringTables);
+		Report.Add(TEXT("String tables"), NumStringTables, StringTableBytes);
+		Report.Add(TEXT("Localization pack"), 1, Localizer->GetLocalizationPackAllocatedSize());
+	}
+
+	SET_MEMORY_STAT(STAT_ArticyPackagesMemory, PackageBytes);
+	SET_MEMORY_STAT(STAT_ArticyClonesMemory, CloneBytes);
+	SET_MEMORY_STAT(STAT_ArticyShadowsMemory, ShadowBytes + VariableShadowBytes);
+	SET_MEMORY_STAT(STAT_ArticyGlobalVariablesMemory, VariableBytes);
+	SET_MEMORY_STAT(STAT_ArticyStringTablesMemory, StringTableBytes);
+
+	OnCollect.Broadcast(Report);
+
+	return Report;
+}
+
+/**
+ * Adds a category, or adds to it if it was added before.
+ * @param Category The name of the category.
+ * @param Count The number of items of the category.
+ * @param Bytes The size of the items.
+ */
+void FArticyMemoryReport::Add(const FString& Category, int32 Count, SIZE_T Bytes)
+{
+	FEntry* Entry = Entries.FindByPredicate([&Category](const FEntry& Existing) { return Existing.Category == Category; });
+	if (!Entry)
+	{
+		Entry = &Entries.AddDefaulted_GetRef();
+		Entry->Category = Category;
+	}
+
+	Entry->Count += Count;
+	Entry->Bytes += Bytes;
+}
+
+/** Returns the size of all categories. */
+SIZE_T FArticyMemoryReport::GetTotalBytes() const
+{
+	SIZE_T Total = 0;
+	for (const FEntry& Entry : Entries)
+		Total += Entry.Bytes;
+	return Total;
+}
+
+/**
+ * Logs the categories, largest first.
+ * @param Ar The device to log to.
+ */
+void FArticyMemoryReport::Log(FOutputDevice& Ar) const
+{
+	TArray<FEntry> Sorted = Entries;
+	Sorted.Sort([](const FEntry& A, const FEntry& B) { return A.Bytes > B.Bytes; });
+
+	Ar.Logf(TEXT("Articy memory (estimated):"));
+	Ar.Logf(TEXT("  %-40s %10s %12s"), TEXT("Category"), TEXT("Count"), TEXT("KB"));
+	for (const FEntry& Entry : Sorted)
+	{
+		Ar.Logf(TEXT("  %-40s %10d %12.1f"), *Entry.Category, Entry.Count, Entry.Bytes / 1024.0);
+	}
+	Ar.Logf(TEXT("  %-40s %10s %12.1f"), TEXT("Total"), TEXT(""), GetTotalBytes() / 1024.0);
+}
+
+/**
+ * Measures an object like "obj list" does.
+ * @param Object The object, may be null.
+ * @return The native size of its class and what its serialized properties allocate.
+ */
+SIZE_T FArticyMemoryReport::GetObjectSize(const UObject* Object)
+{
+	if (!Object)
+		return 0;
+
+	FArchiveCountMem Count(const_cast<UObject*>(Object));
+	return Object->GetClass()->GetStructureSize() + Count.GetMax();
+}
+
+/**
+ * Measures the memory allocated by the reflected properties of a struct or object.
+ * @param Struct The type of the data.
+ * @param Data The struct or object.
+ * @return The allocated size, excluding the size of the data itself.
+ */
+SIZE_T FArticyMemoryReport::GetAllocatedSize(const UStruct* Struct, const void* Data)
+{
+	SIZE_T Bytes = 0;
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		for (int32 Index = 0; Index < It->ArrayDim; ++Index)
+		{
+			Bytes += GetAllocatedSize(*It, It->ContainerPtrToValuePtr<void>(Data, Index));
+		}
+	}
+	return Bytes;
+}
+
+/**
+ * Measures the memory allocated by a property value. Strings, texts, containers and structs are followed,
+ * objects are not.
+ * @param Property The property.
+ * @param Value The value of the property.
+ * @return The allocated size, excluding the size of the value itself.
+ */
+SIZE_T FArticyMemoryReport::GetAllocatedSize(const FProperty* Property, const void* Value)
+{
+	if (const FStrProperty* StrProperty = CastField<FStrProperty>(Property))
+	{
+		return static_cast<const FString*>(Value)->GetAllocatedSize();
+	}
+
+	if (const FTextProperty* TextProperty = CastField<FTextProperty>(Property))
+	{
+		return static_cast<const FText*>(Value)->ToString().GetAllocatedSize();
+	}
+
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+	{
+		return GetAllocatedSize(StructProperty->Struct, Value);
+	}
+
+	if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		FScriptArrayHelper Helper(ArrayProperty, Value);
+		SIZE_T Bytes = Helper.Num() * ArrayProperty->Inner->GetSize();
+		for (int32 Index = 0; Index < Helper.Num(); ++Index)
+		{
+			Bytes += GetAllocatedSize(ArrayProperty->Inner, Helper.GetRawPtr(Index));
+		}
+		return Bytes;
+	}
+
+	if (const FMapProperty* MapProperty = CastField<FMapProperty>(Property))
+	{
+		FScriptMapHelper Helper(MapProperty, Value);
+		SIZE_T Bytes = Helper.Num() * (MapProperty->KeyProp->GetSize() + MapProperty->ValueProp->GetSize());
+		for (int32 Index = 0; Index < Helper.GetMaxIndex(); ++Index)
+		{
+			if (Helper.IsValidIndex(Index))
+			{
+				Bytes += GetAllocatedSize(MapProperty->KeyProp, Helper.GetKeyPtr(Index));
+				Bytes += GetAllocatedSize(MapProperty->ValueProp, Helper.GetValuePtr(Index));
+			}
+		}
+		return Bytes;
+	}
+
+	if (const FSetProperty* SetProperty = CastField<FSetProperty>(Property))
+	{
+		FScriptSetHelper Helper(SetProperty, Value);
+		SIZE_T Bytes = Helper.Num() * SetProperty->ElementProp->GetSize();
+		for (int32 Index = 0; Index < Helper.GetMaxIndex(); ++Index)
+		{
+			if (Helper.IsValidIndex(Index))
+			{
+				Bytes += GetAllocatedSize(SetProperty->ElementProp, Helper.GetElementPtr(Index));
+			}
+		}
+		return Bytes;
+	}
+
+	return 0;
+}
+
+/**
+ * Updates the memory stats once a second, but only while stats are collected, as measuring walks all articy objects.
+ */
+void FArticyMemoryReport::StartStatsUpdates()
+{
+#if STATS
+	StatsTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([](float DeltaTime)
+	{
+		if (FThreadStats::IsCollectingData())
+		{
+			Collect();
+		}
+		return true;
+	}), 1.0f);
+#endif
+}
+
+/** Stops the updates of the memory stats. */
+void FArticyMemoryReport::StopStatsUpdates()
+{
+	if (StatsTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(StatsTickerHandle);
+		StatsTickerHandle.Reset();
+	}
+}
@@ -36,7 +36,98 @@ void UArticyObject::InitFromJson(TSharedPtr<FJsonValue> Json)
 		return;
 
 	JSON_TRY_HEX_ID(obj, Parent);
-	JSON_TRY_STRING(obj, TechnicalName);
+	JSON_TRY_FNAME(obj, TechnicalName);
+}
+
+/**
+ * Links the object with the given id, or unlinks if the database has not loaded it.
+ * Objects of packages that are still loading asynchronously are linked when their package finished loading.
+ *
+ * @param InDatabase The database to link to, or nullptr to unlink.
+ * @param Id The id of the referenced object.
+ */
+void FArticyObjectLink::Link(const UArticyDatabase* InDatabase, FArticyId Id)
+{
+	FArticyCloneableObject* const* Found = InDatabase && Id.Get() ? InDatabase->LoadedObjectsById.Find(Id) : nullptr;
+	Container = Found ? *Found : nullptr;
+	Generation = Container ? Container->GetGeneration() : 0;
+	Database = Container ? InDatabase : nullptr;
+}
+
+/**
+ * Gets the linked object.
+ *
+ * @return The current copy of clone 0 of the linked object, or nullptr if not linked.
+ */
+UArticyObject* FArticyObjectLink::Get() const
+{
+	//the containers live as long as their database, and are reused for other objects once released
+	const UArticyDatabase* LinkedDatabase = Container ? Database.Get() : nullptr;
+	if (!LinkedDatabase || Container->GetGeneration() != Generation)
+		return nullptr;
+
+	return Container->Get(LinkedDatabase);
+}
+
+//---------------------------------------------------------------------------//
+
+/**
+ * Returns the instance SetProp writes to.
+ * If this object is a package asset that a database shares as clone 0, the database copies it first.
+ *
+ * @return The writable instance of this object.
+ */
+IArticyReflectable* UArticyObject::GetWritableInstance()
+{
+	return UArticyDatabase::GetWritableObject(this);
+}
+
+/**
+ * Returns the instance the scripts read from.
+ * In a shadow state of the database, this is the shadow copy of the current or a lower level the object was written to.
+ *
+ * @return The readable instance of this object.
+ */
+IArticyReflectable* UArticyObject::GetReadableInstance()
+{
+	return UArticyDatabase::GetReadableObject(this);
+}
+
+/**
+ * Links the parent and the references of the subobjects, see UArticyDatabase::LinkObjects.
+ *
+ * @param Database The database the object is loaded into, or nullptr to unlink the references.
+ */
+void UArticyObject::LinkReferences(const UArticyDatabase* Database)
+{
+	Super::LinkReferences(Database);
+	ParentLink.Link(Database, Parent);
+}
+
+/**
+ * Copies the modified properties back from the package asset. The object is written through
+ * UArticyDatabase::GetWritableObject, so the reset is recorded like any other write, e.g. by the flow checkpoints.
+ *
+ * @return false if the object was not modified, is not loaded into a database or its package asset is not resident.
+ */
+bool UArticyObject::ResetToOriginal()
+{
+	UArticyDatabase* Database = IsModified() ? GetTypedOuter<UArticyDatabase>() : nullptr;
+	const UArticyObject* Asset = Database ? Database->FindPackageAsset(Id) : nullptr;
+	if (!Asset || Asset == this)
+		return false;
+
+	if (!ensureMsgf(Database->GetShadowLevel() == 0 && !IsShadowCopy(), TEXT("Object %s cannot be reset in a shadow state."), *GetName()))
+		return false;
+
+	UArticyObject* Writable = UArticyDatabase::GetWritableObject(this);
+	if (!Writable)
+		return false;
+	Writable->RestoreModifiedProperties(Asset);
+
+	//the restored references are resolved again
+	Writable->LinkReferences(Database);
+	return true;
 }
 
 //---------------------------------------------------------------------------//
@@ -48,7 +139,7 @@ void UArticyObject::InitFromJson(TSharedPtr<FJsonValue> Json)
  */
 FName UArticyObject::GetTechnicalName() const
 {
-	return *TechnicalName;
+	return TechnicalName;
 }
 
 /**
@@ -58,6 +149,9 @@ FName UArticyObject::GetTechnicalName() const
  */
 UArticyObject* UArticyObject::GetParent() const
 {
+	if (UArticyObject* Linked = ParentLink.Get())
+		return Linked;
+
 	return UArticyDatabase::Get(this)->GetObject<UArticyObject>(Parent);
 }
 
@@ -101,6 +195,32 @@ TArray<FArticyId> UArticyObject::GetChildrenIDs() const
 	return Children;
 }
 
+/**
+ * Checks whether this object is a descendant of another in the project hierarchy.
+ * With the flattened hierarchy of the database this takes two lookups, otherwise the parents are followed.
+ *
+ * @param Ancestor The potential ancestor.
+ * @return True if Ancestor is the parent of this object, or one of its ancestors.
+ */
+bool UArticyObject::IsDescendantOf(const UArticyObject* Ancestor) const
+{
+	if (!Ancestor)
+		return false;
+
+	const UArticyDatabase* Database = UArticyDatabase::Get(this);
+	if (Database && Database->GetHierarchy().Find(GetId()) != INDEX_NONE)
+		return Database->GetHierarchy().IsDescendantOf(GetId(), Ancestor->GetId());
+
+	//not part of the imported hierarchy
+	for (const UArticyObject* Current = GetParent(); Current; Current = Current->GetParent())
+	{
+		if (Current->GetId() == Ancestor->GetId())
+			return true;
+	}
+
+	return false;
+}
+
 #if WITH_EDITOR
 
 /**
@@ -123,6 +243,29 @@ TArray<FArticyId> UArticyObject::GetArticyObjectChildrenIDs() const
 	return OutIDs;
 }
 
+/**
+ * Caches the package assets of the original database, which the import keeps up to date,
+ * so no asset registry query is needed to find them.
+ */
+void UArticyObject::CachePackages()
+{
+	CachedPackages.Empty();
+
+	const UArticyDatabase* Database = UArticyDatabase::GetOriginal();
+	if (!Database)
+	{
+		return;
+	}
+
+	for (const FString& PackageName : Database->GetImportedPackageNames())
+	{
+		if (UArticyPackage* Package = Database->GetPackageAsset(PackageName))
+		{
+			CachedPackages.Add(Package);
+		}
+	}
+}
+
 /**
  * Finds an Articy object by its ID. Caches and refreshes packages if necessary.
  *
@@ -158,26 +301,7 @@ UArticyObject* UArticyObject::FindAsset(const FArticyId& Id)
 	// refresh packages if needed 
 	if (bRefreshPackages)
 	{
-		CachedPackages.Empty();
-
-		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(AssetRegistryConstants::ModuleName);
-		TArray<FAssetData> AssetData;
-
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
-		AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetClassPathName(), AssetData, true);
-#else
-		AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetFName(), AssetData, true);
-#endif
-
-		for (const auto& ArticyPackage : AssetData)
-		{
-			const auto& Package = Cast<UArticyPackage>(ArticyPackage.GetAsset());
-
-			if (Package != nullptr)
-			{
-				CachedPackages.Add(Package);
-			}
-		}
+		CachePackages();
 	}
 
 	for (TWeakObjectPtr<UArticyPackage> ArticyPackage : CachedPackages)
@@ -239,25 +363,7 @@ UArticyObject* UArticyObject::FindAsset(const FString& TechnicalName)// MM_CHANG
 	// refresh packages if needed 
 	if (bRefreshPackages)
 	{
-		CachedPackages.Empty();
-
-		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(AssetRegistryConstants::ModuleName);
-		TArray<FAssetData> AssetData;
-
-#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0
-		AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetClassPathName(), AssetData, true);
-#else
-		AssetRegistryModule.Get().GetAssetsByClass(UArticyPackage::StaticClass()->GetFName(), AssetData, true);
-#endif
-		for (const auto& ArticyPackage : AssetData)
-		{
-			const auto& Package = Cast<UArticyPackage>(ArticyPackage.GetAsset());
-
-			if (Package != nullptr)
-			{
-				CachedPackages.Add(Package);
-			}
-		}
+		CachePackages();
 	}
 
 	for (TWeakObjectPtr<UArticyPackage> ArticyPackage : CachedPackages)
@@ -5,10 +5,13 @@
 #include "ArticyObjectNotificationManager.h"
 #include "ArticyBaseObject.h"
 #include "ArticyDatabase.h"
+#include "ArticyObject.h"
+#include "ArticyRuntimeModule.h"
+#include "UObject/UObjectIterator.h"
 
 /**
  * Gets the singleton instance of the notification manager.
- * Creates a new instance if one does not exist.
+ * Creates a new instance if one does not exist, which is never garbage collected.
  * @return Pointer to the singleton instance.
  */
 UArticyObjectNotificationManager* UArticyObjectNotificationManager::Get()
@@ -18,6 +21,8 @@ UArticyObjectNotificationManager* UArticyObjectNotificationManager::Get()
     if (!ArticyObjectNotificationManager.IsValid())
     {
         ArticyObjectNotificationManager = TWeakObjectPtr<UArticyObjectNotificationManager>(NewObject<UArticyObjectNotificationManager>());
+        //the subscriptions live as long as the module
+        ArticyObjectNotificationManager->AddToRoot();
     }
 
     return ArticyObjectNotificationManager.Get();
@@ -57,31 +62,35 @@ void UArticyObjectNotificationManager::SplitInstance(const FString& InString, FS
 }
 
 /**
- * Adds a listener for changes to Articy objects matching the given filter.
- * Resolves the object based on the filter and adds the listener.
- * @param Filter The filter string for identifying Articy objects.
- * @param ChangedFunction The function to call when a property changes.
+ * Resolves an object filter: a technical name, or an id in hex (0x...) or decimal, with an optional <CloneId>.
+ * @param Filter The filter string.
+ * @return The object, or nullptr if it is not loaded.
  */
-void UArticyObjectNotificationManager::AddListener(const FString& Filter, FArticyPropertyChangedFunction ChangedFunction)
+UArticyObject* UArticyObjectNotificationManager::ResolveFilter(const FString& Filter)
 {
     FString ObjectName, ObjectInstance;
     SplitInstance(Filter, ObjectName, ObjectInstance);
-    UArticyObject* Object;
     auto DB = UArticyDatabase::Get(this);
+    if (!DB)
+        return nullptr;
+
     if (Filter.StartsWith(TEXT("0x")))
-    {
-        Object = DB->GetObject<UArticyObject>(FArticyId{ ArticyHelpers::HexToUint64(ObjectName) }, FCString::Atod(*ObjectInstance));
-    }
-    else if (Filter.IsNumeric())
-    {
-        Object = DB->GetObject<UArticyObject>(FArticyId{ FCString::Strtoui64(*ObjectName, nullptr, 10) }, FCString::Atod(*ObjectInstance));
-    }
-    else
-    {
-        Object = DB->GetObjectByName(*ObjectName, FCString::Atod(*ObjectInstance));
-    }
+        return DB->GetObject<UArticyObject>(FArticyId{ ArticyHelpers::HexToUint64(ObjectName) }, FCString::Atoi(*ObjectInstance));
+    if (Filter.IsNumeric())
+        return DB->GetObject<UArticyObject>(FArticyId{ FCString::Strtoui64(*ObjectName, nullptr, 10) }, FCString::Atoi(*ObjectInstance));
 
-    if (Object)
+    return DB->GetObjectByName(*ObjectName, FCString::Atoi(*ObjectInstance));
+}
+
+/**
+ * Adds a listener for changes to Articy objects matching the given filter.
+ * Resolves the object based on the filter and adds the listener.
+ * @param Filter The filter string for identifying Articy objects.
+ * @param ChangedFunction The function to call when a property changes.
+ */
+void UArticyObjectNotificationManager::AddListener(const FString& Filter, FArticyPropertyChangedFunction ChangedFunction)
+{
+    if (UArticyObject* Object = ResolveFilter(Filter))
     {
         AddListener(Object, ChangedFunction);
     }
@@ -89,27 +98,90 @@ void UArticyObjectNotificationManager::AddListener(const FString& Filter, FArtic
 
 /**
  * Adds a listener for changes to Articy objects matching the given filter and property flags.
+ * With ArticyObject, the filter names an object like in AddListener(Filter). Otherwise it names the generated class
+ * of a template, and the listener gets the changes of its objects, including the ones of subclasses with
+ * IncludeBaseType. General includes the changes of the properties of the objects, Template the ones of their features.
  * @param Filter The filter string for identifying Articy objects.
  * @param Flags The types of properties to include in notifications.
  * @param ChangedFunction The function to call when a property changes.
  */
 void UArticyObjectNotificationManager::AddListener(const FString& Filter, EArticyTypeProperties Flags, FArticyPropertyChangedFunction ChangedFunction)
 {
-    // Implementation can be added here if required.
+    const uint8 Bits = static_cast<uint8>(Flags);
+    const bool bGeneral = (Bits & static_cast<uint8>(EArticyTypeProperties::General)) != 0;
+    const bool bTemplate = (Bits & static_cast<uint8>(EArticyTypeProperties::Template)) != 0;
+
+    FOnArticyPropertiesChanged OnChanged = FOnArticyPropertiesChanged::CreateLambda([ChangedFunction, bGeneral, bTemplate](const TArray<FArticyPropertyChange>& Changes)
+    {
+        for (const FArticyPropertyChange& Change : Changes)
+        {
+            if (Change.bFeature ? !bTemplate : !bGeneral)
+                continue;
+
+            FArticyChangedProperty ChangedProperty;
+            ChangedProperty.ObjectReference = Change.Object;
+            ChangedProperty.Property = Change.Property;
+            ChangedFunction(ChangedProperty);
+        }
+    });
+
+    if (Bits & static_cast<uint8>(EArticyTypeProperties::ArticyObject))
+    {
+        if (UArticyObject* Object = ResolveFilter(Filter))
+            SubscribeToObject(Object->GetId(), Object->GetCloneId(), MoveTemp(OnChanged));
+        else
+            UE_LOG(LogArticyRuntime, Warning, TEXT("No object matches the listener filter %s."), *Filter);
+        return;
+    }
+
+    const UClass* Class = nullptr;
+    for (TObjectIterator<UClass> It; It && !Class; ++It)
+    {
+        if (It->IsChildOf(UArticyObject::StaticClass()) && !It->HasAnyClassFlags(CLASS_NewerVersionExists) && It->GetName() == Filter)
+            Class = *It;
+    }
+
+    if (!Class)
+    {
+        UE_LOG(LogArticyRuntime, Warning, TEXT("No template class matches the listener filter %s."), *Filter);
+        return;
+    }
+
+    if (Bits & static_cast<uint8>(EArticyTypeProperties::IncludeBaseType))
+        SubscribeToClass(Class, MoveTemp(OnChanged));
+    else
+        SubscribeToTemplate(Class, MoveTemp(OnChanged));
 }
 
 /**
  * Adds a listener for changes to a specific Articy object.
- * Registers a lambda function to handle property changes.
+ * The listener subscribes to the id and clone id of the object, so it keeps getting the changes when the object is
+ * copied. Other objects, like features, get the changes reported to their ReportChanged delegate.
  * @param Object The Articy object to listen to.
  * @param ChangedFunction The function to call when a property changes.
  */
 void UArticyObjectNotificationManager::AddListener(UArticyBaseObject* Object, FArticyPropertyChangedFunction ChangedFunction)
 {
-    Object->ReportChanged.AddLambda([ChangedFunction](FArticyChangedProperty ChangedProperty)
+    const UArticyObject* ArticyObject = Cast<UArticyObject>(Object);
+    if (!ArticyObject)
+    {
+        Object->ReportChanged.AddLambda([ChangedFunction](FArticyChangedProperty ChangedProperty)
+            {
+                ChangedFunction(ChangedProperty);
+            });
+        return;
+    }
+
+    SubscribeToObject(ArticyObject->GetId(), ArticyObject->GetCloneId(), FOnArticyPropertiesChanged::CreateLambda([ChangedFunction](const TArray<FArticyPropertyChange>& Changes)
         {
-            ChangedFunction(ChangedProperty);
-        });
+            for (const FArticyPropertyChange& Change : Changes)
+            {
+                FArticyChangedProperty ChangedProperty;
+                ChangedProperty.ObjectReference = Change.Object;
+                ChangedProperty.Property = Change.Property;
+                ChangedFunction(ChangedProperty);
+            }
+        }));
 }
 
 /**
@@ -119,35 +191,266 @@ void UArticyObjectNotificationManager::AddListener(UArticyBaseObject* Object, FA
  */
 void UArticyObjectNotificationManager::RemoveListeners(const FString& Filter)
 {
-    FString ObjectName, ObjectInstance;
-    SplitInstance(Filter, ObjectName, ObjectInstance);
-    UArticyObject* Object;
-    auto DB = UArticyDatabase::Get(this);
-    if (Filter.StartsWith(TEXT("0x")))
+    if (UArticyObject* Object = ResolveFilter(Filter))
     {
-        Object = DB->GetObject<UArticyObject>(FArticyId{ ArticyHelpers::HexToUint64(ObjectName) }, FCString::Atod(*ObjectInstance));
+        RemoveListeners(Object);
     }
-    else if (Filter.IsNumeric())
+}
+
+/**
+ * Removes listeners from a specific Articy object.
+ * Clears all change notifications for the given object, and the subscriptions to its clone.
+ * @param Object The Articy object to remove listeners from.
+ */
+void UArticyObjectNotificationManager::RemoveListeners(UArticyBaseObject* Object)
+{
+    Object->ReportChanged.Clear();
+
+    const UArticyObject* ArticyObject = Cast<UArticyObject>(Object);
+    const TArray<int32>* Handles = ArticyObject ? ObjectSubscriptions.Find(ArticyObject->GetId()) : nullptr;
+    if (!Handles)
+        return;
+
+    for (const int32 Handle : TArray<int32>(*Handles))
     {
-        Object = DB->GetObject<UArticyObject>(FArticyId{ FCString::Strtoui64(*ObjectName, nullptr, 10) }, FCString::Atod(*ObjectInstance));
+        if (Subscriptions.FindChecked(Handle).CloneId == ArticyObject->GetCloneId())
+            Unsubscribe(Handle);
     }
-    else
+}
+
+//---------------------------------------------------------------------------//
+
+/**
+ * Subscribes to the property changes of an object.
+ * @param Id The id of the object.
+ * @param CloneId The clone to subscribe to, or -1 for all clones.
+ * @param OnChanged Called once per frame with the changes of the object.
+ * @return The handle to unsubscribe with.
+ */
+int32 UArticyObjectNotificationManager::SubscribeToObject(const FArticyId& Id, int32 CloneId, FOnArticyPropertiesChanged OnChanged)
+{
+    FSubscription Subscription;
+    Subscription.OnChanged = MoveTemp(OnChanged);
+    Subscription.Kind = ESubscriptionKind::Object;
+    Subscription.Id = Id;
+    Subscription.CloneId = CloneId;
+    return AddSubscription(MoveTemp(Subscription));
+}
+
+/**
+ * Subscribes to the property changes of all objects of exactly a class.
+ * @param Template The class of the objects.
+ * @param OnChanged Called once per frame with the changes of the objects.
+ * @return The handle to unsubscribe with, or INDEX_NONE if there is no class.
+ */
+int32 UArticyObjectNotificationManager::SubscribeToTemplate(const UClass* Template, FOnArticyPropertiesChanged OnChanged)
+{
+    if (!ensure(Template))
+        return INDEX_NONE;
+
+    FSubscription Subscription;
+    Subscription.OnChanged = MoveTemp(OnChanged);
+    Subscription.Kind = ESubscriptionKind::Template;
+    Subscription.Class = Template;
+    return AddSubscription(MoveTemp(Subscription));
+}
+
+/**
+ * Subscribes to the property changes of all objects of a class and its subclasses.
+ * @param Class The class of the objects.
+ * @param OnChanged Called once per frame with the changes of the objects.
+ * @return The handle to unsubscribe with, or INDEX_NONE if there is no class.
+ */
+int32 UArticyObjectNotificationManager::SubscribeToClass(const UClass* Class, FOnArticyPropertiesChanged OnChanged)
+{
+    if (!ensure(Class))
+        return INDEX_NONE;
+
+    FSubscription Subscription;
+    Subscription.OnChanged = MoveTemp(OnChanged);
+    Subscription.Kind = ESubscriptionKind::Class;
+    Subscription.Class = Class;
+    return AddSubscription(MoveTemp(Subscription));
+}
+
+/**
+ * Adds a subscription to the lookup of its kind, and lets SetProp report its writes.
+ * @param Subscription The subscription.
+ * @return The handle of the subscription.
+ */
+int32 UArticyObjectNotificationManager::AddSubscription(FSubscription&& Subscription)
+{
+    const int32 Handle = NextHandle++;
+    switch (Subscription.Kind)
+    {
+    case ESubscriptionKind::Object: ObjectSubscriptions.FindOrAdd(Subscription.Id).Add(Handle); break;
+    case ESubscriptionKind::Template: TemplateSubscriptions.FindOrAdd(Subscription.Class).Add(Handle); break;
+    case ESubscriptionKind::Class: ClassSubscriptions.FindOrAdd(Subscription.Class).Add(Handle); break;
+    }
+
+    Subscriptions.Add(Handle, MoveTemp(Subscription));
+    IArticyReflectable::bDispatchPropertyChanges = true;
+    return Handle;
+}
+
+/**
+ * Removes a subscription. Once there are none, SetProp stops reporting writes.
+ * @param Handle The handle returned when subscribing.
+ */
+void UArticyObjectNotificationManager::Unsubscribe(int32 Handle)
+{
+    FSubscription Subscription;
+    if (!Subscriptions.RemoveAndCopyValue(Handle, Subscription))
+        return;
+
+    auto RemoveHandle = [Handle](auto& Lookup, const auto& Key)
     {
-        Object = DB->GetObjectByName(*ObjectName, FCString::Atod(*ObjectInstance));
+        if (TArray<int32>* Handles = Lookup.Find(Key))
+        {
+            Handles->Remove(Handle);
+            if (Handles->Num() == 0)
+                Lookup.Remove(Key);
+        }
+    };
+
+    switch (Subscription.Kind)
+    {
+    case ESubscriptionKind::Object: RemoveHandle(ObjectSubscriptions, Subscription.Id); break;
+    case ESubscriptionKind::Template: RemoveHandle(TemplateSubscriptions, Subscription.Class); break;
+    case ESubscriptionKind::Class: RemoveHandle(ClassSubscriptions, Subscription.Class); break;
     }
 
-    if (Object)
+    IArticyReflectable::bDispatchPropertyChanges = Subscriptions.Num() > 0;
+    if (Subscriptions.Num() == 0)
     {
-        RemoveListeners(Object);
+        PendingChanges.Reset();
+        PendingObjects.Reset();
+        PendingKeys.Reset();
     }
 }
 
 /**
- * Removes listeners from a specific Articy object.
- * Clears all change notifications for the given object.
- * @param Object The Articy object to remove listeners from.
+ * Collects a write for the dispatch at the end of the frame, once per written property of each clone.
+ * Writes to shadow copies are not reported by SetProp, as they are undone when the shadow state is popped.
+ * @param Written The object or feature which was written.
+ * @param Property The written property.
+ * @param Slot The slot of the property, or INDEX_NONE to look it up.
  */
-void UArticyObjectNotificationManager::RemoveListeners(UArticyBaseObject* Object)
+void UArticyObjectNotificationManager::ReportPropertyChanged(IArticyReflectable* Written, const FProperty* Property, int32 Slot)
 {
-    Object->ReportChanged.Clear();
+    UObject* WrittenObject = Written ? Written->_getUObject() : nullptr;
+    if (!WrittenObject || !Property)
+        return;
+
+    //the properties of features are reported for the object owning the feature
+    UArticyObject* Object = Cast<UArticyObject>(WrittenObject);
+    const bool bFeature = !Object;
+    if (bFeature)
+        Object = WrittenObject->GetTypedOuter<UArticyObject>();
+
+    if (!Object)
+        return;
+
+    bool bAlreadyPending = false;
+    PendingKeys.Add(FPendingChange{ Object->GetId(), Object->GetCloneId(), Property }, &bAlreadyPending);
+    if (bAlreadyPending)
+        return;
+
+    FArticyPropertyChange& Change = PendingChanges.AddDefaulted_GetRef();
+    Change.Id = Object->GetId();
+    Change.CloneId = Object->GetCloneId();
+    Change.Property = Property->GetFName();
+    Change.Slot = Slot != INDEX_NONE ? Slot : Written->GetPropertySlot(Property->GetFName());
+    Change.bFeature = bFeature;
+    PendingObjects.Add(Object);
+
+    if (!DispatchTickerHandle.IsValid())
+    {
+        DispatchTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+            FTickerDelegate::CreateUObject(this, &UArticyObjectNotificationManager::DispatchTick), 0.0f);
+    }
+}
+
+/**
+ * Dispatches the collected changes, once per subscription with all its changes.
+ * The subscriptions are found by the id, the class and the super classes of each written object.
+ */
+void UArticyObjectNotificationManager::DispatchPendingChanges()
+{
+    if (DispatchTickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(DispatchTickerHandle);
+        DispatchTickerHandle.Reset();
+    }
+
+    if (PendingChanges.Num() == 0)
+        return;
+
+    //moved out, as the subscribers may write properties again, which are dispatched with the next batch
+    TArray<FArticyPropertyChange> Changes = MoveTemp(PendingChanges);
+    const TArray<TWeakObjectPtr<UArticyObject>> Objects = MoveTemp(PendingObjects);
+    PendingChanges.Reset();
+    PendingObjects.Reset();
+    PendingKeys.Reset();
+
+    TMap<int32, TArray<FArticyPropertyChange>> Batches;
+    auto AddToBatches = [this, &Batches](const TArray<int32>* Handles, const FArticyPropertyChange& Change)
+    {
+        if (!Handles)
+            return;
+
+        for (const int32 Handle : *Handles)
+        {
+            const FSubscription& Subscription = Subscriptions.FindChecked(Handle);
+            if (Subscription.CloneId == INDEX_NONE || Subscription.CloneId == Change.CloneId)
+                Batches.FindOrAdd(Handle).Add(Change);
+        }
+    };
+
+    for (int32 Index = 0; Index < Changes.Num(); ++Index)
+    {
+        FArticyPropertyChange& Change = Changes[Index];
+        Change.Object = Objects[Index].Get();
+
+        AddToBatches(ObjectSubscriptions.Find(Change.Id), Change);
+        if (!Change.Object)
+            continue;
+
+        const UClass* Class = Change.Object->GetClass();
+        AddToBatches(TemplateSubscriptions.Find(Class), Change);
+        for (const UClass* Super = Class; Super && ClassSubscriptions.Num() > 0; Super = Super->GetSuperClass())
+            AddToBatches(ClassSubscriptions.Find(Super), Change);
+    }
+
+    for (const TPair<int32, TArray<FArticyPropertyChange>>& Batch : Batches)
+    {
+        //copied, as the subscriber may change the subscriptions
+        const FSubscription* Subscription = Subscriptions.Find(Batch.Key);
+        const FOnArticyPropertiesChanged OnChanged = Subscription ? Subscription->OnChanged : FOnArticyPropertiesChanged();
+        OnChanged.ExecuteIfBound(Batch.Value);
+    }
+}
+
+/**
+ * Dispatches the changes of the last frame.
+ * @param DeltaTime The time since the last tick.
+ * @return False, the ticker is added again by the next write.
+ */
+bool UArticyObjectNotificationManager::DispatchTick(float DeltaTime)
+{
+    DispatchTickerHandle.Reset();
+    DispatchPendingChanges();
+    return false;
+}
+
+void UArticyObjectNotificationManager::BeginDestroy()
+{
+    if (DispatchTickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(DispatchTickerHandle);
+        DispatchTickerHandle.Reset();
+    }
+
+    IArticyReflectable::bDispatchPropertyChanges = false;
+    Super::BeginDestroy();
 }
@@ -0,0 +1,95 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyPackage.h"
+
+/**
+ * Groups the assets by technical name. The entries are in the order the names first appear in, and each lists its
+ * assets in the order of the package, which is the order the database would index them in one by one.
+ */
+void UArticyPackage::BuildNameIndex()
+{
+	NameIndex.Reset();
+
+	TMap<FName, int32> Entries;
+	Entries.Reserve(Assets.Num());
+	for (int32 Index = 0; Index < Assets.Num(); ++Index)
+	{
+		const FName TechnicalName = Assets[Index] ? Assets[Index]->GetTechnicalName() : NAME_None;
+		int32& Entry = Entries.FindOrAdd(TechnicalName, INDEX_NONE);
+		if (Entry == INDEX_NONE)
+		{
+			Entry = NameIndex.Num();
+			NameIndex.AddDefaulted_GetRef().TechnicalName = TechnicalName;
+		}
+		NameIndex[Entry].Assets.Add(Index);
+	}
+}
+
+/**
+ * Checks that every asset is in the name index exactly once, which is not the case if assets were added after it
+ * was built, or for packages of older imports.
+ *
+ * @return True if the name index can be used instead of the technical names of the assets.
+ */
+bool UArticyPackage::HasNameIndex() const
+{
+	int32 NumIndexed = 0;
+	for (const FArticyPackageNameIndexEntry& Entry : NameIndex)
+		NumIndexed += Entry.Assets.Num();
+
+	return NameIndex.Num() > 0 && NumIndexed == Assets.Num();
+}
+
+#if WITH_EDITOR
+/**
+ * Serializes the package. When cooking, the objects stripped by the reachability analysis of the import are left out
+ * of the lists, as they are editor only (see UArticyObject::IsEditorOnly) and the cooked package must not refer to them.
+ * Their references are left out of the reference index as well.
+ *
+ * @param Ar The archive to serialize with.
+ */
+void UArticyPackage::Serialize(FArchive& Ar)
+{
+	const auto IsStripped = [](const UArticyObject* Asset) { return Asset && Asset->IsStrippedFromCook(); };
+	if (!Ar.IsSaving() || !Ar.IsCooking() || !Assets.ContainsByPredicate(IsStripped))
+	{
+		Super::Serialize(Ar);
+		return;
+	}
+
+	// the lists are only filtered while saving, the editor keeps the stripped objects
+	TArray<UArticyObject*> AllAssets = Assets;
+	TMap<FName, TSoftObjectPtr<UArticyObject>> AllAssetsByTechnicalName = AssetsByTechnicalName;
+	TMap<FArticyId, TSoftObjectPtr<UArticyObject>> AllAssetsById = AssetsById;
+
+	TArray<FArticyPackageNameIndexEntry> AllNameIndex = NameIndex;
+	FArticyReferenceIndex AllReferenceIndex = ReferenceIndex;
+
+	TSet<FArticyId> StrippedIds;
+	Assets.RemoveAll(IsStripped);
+	for (const UArticyObject* Asset : AllAssets)
+	{
+		if (IsStripped(Asset))
+		{
+			AssetsByTechnicalName.Remove(Asset->GetTechnicalName());
+			AssetsById.Remove(Asset->GetId());
+			StrippedIds.Add(Asset->GetId());
+		}
+	}
+	ReferenceIndex.RemoveSources([&StrippedIds](const FArticyId& Source) { return StrippedIds.Contains(Source); });
+
+	// the indices refer to the filtered list
+	if (AllNameIndex.Num() > 0)
+		BuildNameIndex();
+
+	Super::Serialize(Ar);
+
+	Assets = MoveTemp(AllAssets);
+	AssetsByTechnicalName = MoveTemp(AllAssetsByTechnicalName);
+	AssetsById = MoveTemp(AllAssetsById);
+	NameIndex = MoveTemp(AllNameIndex);
+	ReferenceIndex = MoveTemp(AllReferenceIndex);
+}
+#endif
@@ -16,6 +16,7 @@ void UArticyFlowPin::InitFromJson(TSharedPtr<FJsonValue> Json)
 
 	auto obj = Json->AsObject();
 	JSON_TRY_FNAME(obj, Text);
+	ScriptHash = GetTypeHash(Text);
 
 	auto id = obj->TryGetField(TEXT("Owner"));
 	Owner = FArticyId{id};
@@ -35,16 +36,54 @@ void UArticyFlowPin::InitFromJson(TSharedPtr<FJsonValue> Json)
 
 UArticyObject* UArticyFlowPin::GetOwner()
 {
+	//pins are subobjects of their owner, and each clone and shadow copy of it has pins of its own
+	auto outer = Cast<UArticyObject>(GetOuter());
+	if(outer && outer->GetId() == Owner)
+		return outer;
+
 	auto db = UArticyDatabase::Get(this);
 	return ensure(db) ? db->GetObject<UArticyObject>(Owner) : nullptr;
 }
 
+void UArticyFlowPin::LinkReferences(const UArticyDatabase* Database)
+{
+	Super::LinkReferences(Database);
+
+	for(auto conn : Connections)
+	{
+		if(conn)
+			conn->LinkReferences(Database);
+	}
+}
+
+//---------------------------------------------------------------------------//
+
+void FArticyPinLink::Link(const UArticyDatabase* Database, FArticyId TargetId, FArticyId PinId)
+{
+	Target.Link(Database, TargetId);
+
+	auto target = Target.Get();
+	Pin = target ? Cast<UArticyFlowPin>(target->GetSubobject(PinId)) : nullptr;
+}
+
+UArticyFlowPin* FArticyPinLink::GetPin(const UArticyPrimitive* CurrentTarget, FArticyId PinId) const
+{
+	if(!CurrentTarget)
+		return nullptr;
+
+	auto pin = Pin.Get();
+	if(pin && pin->GetOuter() == CurrentTarget)
+		return pin;
+
+	return Cast<UArticyFlowPin>(CurrentTarget->GetSubobject(PinId));
+}
+
 //---------------------------------------------------------------------------//
 
 bool UArticyInputPin::Evaluate(class UArticyGlobalVariables* GV, class UObject* MethodProvider)
 {
 	auto db = UArticyDatabase::Get(this);
-	return db->GetExpressoInstance()->Evaluate(GetTypeHash(Text), GV ? GV : db->GetGVs(), MethodProvider);
+	return db->GetExpressoInstance()->Evaluate(GetScriptHash(), GV ? GV : db->GetGVs(), MethodProvider);
 }
 
 void UArticyInputPin::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
@@ -56,7 +95,11 @@ void UArticyInputPin::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>&
 	if(!bIsValid && Player->IgnoresInvalidBranches())
 		return;
 
-	IArticyFlowObject* owner = Cast<IArticyFlowObject>(GetOwner());
+	UArticyObject* ownerObject = GetOwner();
+	IArticyFlowObject* owner = ownerObject ? ownerObject->GetCapability<IArticyFlowObject>() : nullptr;
+
+	if(!bIsValid)
+		Player->BeginInvalidExplorePath();
 
 	if(Depth > 3 && Player->ShouldPauseOn(owner))
 	{
@@ -88,6 +131,7 @@ void UArticyInputPin::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>&
 	 */
 	if(!bIsValid)
 	{
+		Player->EndInvalidExplorePath();
 		for(auto& branch : OutBranches)
 			branch.bIsValid = false;
 	}
@@ -98,7 +142,7 @@ void UArticyInputPin::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>&
 void UArticyOutputPin::Execute(class UArticyGlobalVariables* GV, class UObject* MethodProvider)
 {
 	auto db = UArticyDatabase::Get(this);
-	db->GetExpressoInstance()->Execute(GetTypeHash(Text), GV ? GV : db->GetGVs(), MethodProvider);
+	db->GetExpressoInstance()->Execute(GetScriptHash(), GV ? GV : db->GetGVs(), MethodProvider);
 }
 
 void UArticyOutputPin::Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth)
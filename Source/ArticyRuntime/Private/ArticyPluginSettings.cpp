@@ -11,15 +11,38 @@
 #include "AssetRegistryModule.h"
 #endif
 #include "Misc/ConfigCacheIni.h"
+#include "UObject/UObjectIterator.h"
 
 UArticyPluginSettings::UArticyPluginSettings()
 {
 	bCreateBlueprintTypeForScriptMethods = true;
 	bKeepDatabaseBetweenWorlds = true;
 	bKeepGlobalVariablesBetweenWorlds = true;
+	bReuseWorldClones = false;
 	bConvertUnityToUnrealRichText = false;
+	bUseLocalizationPacks = false;
+	bCompressLocalizationPacks = false;
+	LocalizationPackCachedBlocks = 32;
 	bVerifyArticyReferenceBeforeImport = true;
 	bUseLegacyImporter = false;
+	ExpressoScriptShards = 8;
+	bPatchScriptsWithLiveCoding = true;
+	bStripUnreachableObjects = false;
+	bGenerateEditorOnlyProperties = false;
+	EditorOnlyProperties = { TEXT("Position"), TEXT("Size"), TEXT("Color"), TEXT("ZIndex"), TEXT("PreviewImage") };
+	bStripPresentationForServer = false;
+	ServerStrippedProperties = { TEXT("Text"), TEXT("MenuText"), TEXT("StageDirections"), TEXT("PreviewImage"),
+		TEXT("Position"), TEXT("Size"), TEXT("Color"), TEXT("ZIndex") };
+	ImportWorkerCount = 0;
+	ImportMemoryBudgetMB = 0;
+	bAutoImportExportChanges = false;
+	AutoImportSettleTime = 2.0f;
+	bHotPatchPackagesDuringPlay = false;
+	AsyncPackageLoadBudgetMs = 2.0f;
+	PackageResidencyBudgetMB = 0;
+	bUpdateFlowPlayersInParallel = false;
+	bShareUnmodifiedObjectsWithPackages = false;
+	bShareFeaturesBetweenClones = false;
 
 	bSortChildrenAtGeneration = false;
 	ArticyDirectory.Path = TEXT("/Game");
@@ -33,6 +56,12 @@ bool UArticyPluginSettings::DoesPackageSettingExist(FString packageName)
 	return PackageLoadSettings.Contains(packageName);
 }
 
+int32 UArticyPluginSettings::GetPackageChunkId(const FString& PackageName) const
+{
+	const int32* ChunkId = PackageChunkIds.Find(PackageName);
+	return ChunkId ? *ChunkId : INDEX_NONE;
+}
+
 const UArticyPluginSettings* UArticyPluginSettings::Get()
 {
 	static TWeakObjectPtr<UArticyPluginSettings> Settings;
@@ -45,6 +74,23 @@ const UArticyPluginSettings* UArticyPluginSettings::Get()
 	return Settings.Get();
 }
 
+UClass* UArticyPluginSettings::FindGeneratedClass(const FSoftClassPath& ClassPath, const UClass* BaseClass)
+{
+	if (UClass* Class = ClassPath.ResolveClass())
+	{
+		if (Class->IsChildOf(BaseClass) && !Class->HasAnyClassFlags(CLASS_NewerVersionExists))
+			return Class;
+	}
+
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		if (*It != BaseClass && It->IsChildOf(BaseClass) && !It->HasAnyClassFlags(CLASS_Abstract | CLASS_NewerVersionExists))
+			return *It;
+	}
+
+	return nullptr;
+}
+
 void UArticyPluginSettings::UpdatePackageSettings()
 {
 	TWeakObjectPtr<UArticyDatabase> ArticyDatabase = UArticyDatabase::GetMutableOriginal();
@@ -0,0 +1,37 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyPrimitive.h"
+#include "ArticyGlobalVariables.h"
+
+/**
+ * Returns the seen counter slot of this object, assigning it on first use.
+ * Clones share the slot of their original, as they have the same id.
+ * @return The slot of the seen counter.
+ */
+int32 UArticyPrimitive::GetSeenCounterSlot() const
+{
+	int32 Slot = SeenCounterSlot.load(std::memory_order_relaxed);
+	if (Slot == INDEX_NONE)
+	{
+		Slot = FArticySeenCounterSlots::FindOrAdd(Id);
+		SeenCounterSlot.store(Slot, std::memory_order_relaxed);
+	}
+	return Slot;
+}
+
+/**
+ * Returns the capabilities of the class of this object, looking them up on first use.
+ * @return The capabilities.
+ */
+const FArticyCapabilities& UArticyPrimitive::GetCapabilities() const
+{
+	const FArticyCapabilities* Cached = Capabilities.load(std::memory_order_acquire);
+	if (!Cached)
+	{
+		Cached = &FArticyCapabilities::Find(this);
+		Capabilities.store(Cached, std::memory_order_release);
+	}
+	return *Cached;
+}
@@ -0,0 +1,329 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyPropertyIndex.h"
+#include "ArticyDatabase.h"
+#include "ArticyObject.h"
+#include "ArticyRuntimeModule.h"
+#include "Algo/BinarySearch.h"
+
+namespace
+{
+	/** The values which can be compared with each other: bools, numbers (int and float), strings and objects. */
+	enum class EValueClass : uint8 { None, Bool, Number, String, Object };
+
+	EValueClass GetValueClass(const ExpressoType& Value)
+	{
+		switch (Value.Type)
+		{
+		case ExpressoType::Bool: return EValueClass::Bool;
+		case ExpressoType::Int:
+		case ExpressoType::Float: return EValueClass::Number;
+		case ExpressoType::String: return EValueClass::String;
+		case ExpressoType::Object: return EValueClass::Object;
+		default: return EValueClass::None;
+		}
+	}
+
+	/**
+	 * Compares two values of the same value class, without the string conversions and ensures of the
+	 * ExpressoType operators. Strings compare case insensitive, like FString.
+	 * @return Less than, equal to or greater than 0.
+	 */
+	int32 CompareValues(const ExpressoType& A, const ExpressoType& B)
+	{
+		switch (GetValueClass(A))
+		{
+		case EValueClass::Bool:
+			return (int32)A.GetBool() - (int32)B.GetBool();
+		case EValueClass::Number:
+			if (A.Type == ExpressoType::Int && B.Type == ExpressoType::Int)
+				return A.GetInt() < B.GetInt() ? -1 : (A.GetInt() > B.GetInt() ? 1 : 0);
+			else
+			{
+				const double a = A.Type == ExpressoType::Int ? (double)A.GetInt() : A.GetFloat();
+				const double b = B.Type == ExpressoType::Int ? (double)B.GetInt() : B.GetFloat();
+				return a < b ? -1 : (a > b ? 1 : 0);
+			}
+		case EValueClass::String:
+			return A.GetString().Compare(B.GetString(), ESearchCase::IgnoreCase);
+		case EValueClass::Object:
+			if (A.GetInt() != B.GetInt())
+				return (uint64)A.GetInt() < (uint64)B.GetInt() ? -1 : 1;
+			return A.GetCloneId() - B.GetCloneId();
+		default:
+			return 0;
+		}
+	}
+}
+
+bool FArticyPropertyIndex::FBucketKeyFuncs::Matches(const ExpressoType& A, const ExpressoType& B)
+{
+	return GetValueClass(A) == GetValueClass(B) && CompareValues(A, B) == 0;
+}
+
+uint32 FArticyPropertyIndex::FBucketKeyFuncs::GetKeyHash(const ExpressoType& Key)
+{
+	switch (GetValueClass(Key))
+	{
+	case EValueClass::Bool:
+		return GetTypeHash(Key.GetBool());
+	case EValueClass::Number:
+		//ints and floats with the same value must hash the same
+		return GetTypeHash(Key.Type == ExpressoType::Int ? (double)Key.GetInt() : Key.GetFloat());
+	case EValueClass::String:
+		return GetTypeHash(Key.GetString());
+	case EValueClass::Object:
+		return HashCombine(GetTypeHash(Key.GetInt()), GetTypeHash(Key.GetCloneId()));
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Returns the objects whose property equals a value.
+ * @param Value The value, which must be comparable with the indexed values.
+ * @return The objects, ordered by id.
+ */
+TConstArrayView<UArticyObject*> FArticyPropertyIndex::FindEqual(const ExpressoType& Value) const
+{
+	if (!IsComparable(Value))
+		return {};
+
+	if (Kind == EArticyPropertyIndexKind::Hashed)
+	{
+		const TPair<int32, int32>* Bucket = Buckets.Find(Value);
+		return Bucket ? View(Bucket->Key, Bucket->Key + Bucket->Value) : TConstArrayView<UArticyObject*>();
+	}
+
+	return View(LowerBound(Value), UpperBound(Value));
+}
+
+/**
+ * Returns the objects whose property is within a range.
+ * @param Min The smallest value.
+ * @param Max The largest value.
+ * @return The objects, ordered by value.
+ */
+TConstArrayView<UArticyObject*> FArticyPropertyIndex::FindInRange(const ExpressoType& Min, const ExpressoType& Max) const
+{
+	if (!IsComparable(Min) || !IsComparable(Max))
+		return {};
+
+	return View(LowerBound(Min), UpperBound(Max));
+}
+
+/**
+ * Returns the objects whose property is at least a value.
+ * @param Value The smallest value.
+ * @return The objects, ordered by value.
+ */
+TConstArrayView<UArticyObject*> FArticyPropertyIndex::FindAtLeast(const ExpressoType& Value) const
+{
+	if (!IsComparable(Value))
+		return {};
+
+	return View(LowerBound(Value), Objects.Num());
+}
+
+/**
+ * Returns the objects whose property is at most a value.
+ * @param Value The largest value.
+ * @return The objects, ordered by value.
+ */
+TConstArrayView<UArticyObject*> FArticyPropertyIndex::FindAtMost(const ExpressoType& Value) const
+{
+	if (!IsComparable(Value))
+		return {};
+
+	return View(0, UpperBound(Value));
+}
+
+/**
+ * Returns the indexed value of an object.
+ * @param Id The id of the object.
+ * @return The value, undefined if the object is not indexed.
+ */
+const ExpressoType& FArticyPropertyIndex::GetIndexedValue(const FArticyId& Id) const
+{
+	static const ExpressoType Undefined;
+	const ExpressoType* Value = ValuesById.Find(Id);
+	return Value ? *Value : Undefined;
+}
+
+/**
+ * Rebuilds the index from all loaded objects of the class.
+ * The values of the first object decide the value class, objects with values of another class are left out.
+ * @param Database The database whose objects are indexed.
+ */
+void FArticyPropertyIndex::Rebuild(const UArticyDatabase* Database)
+{
+	struct FEntry
+	{
+		ExpressoType Value;
+		FArticyId Id;
+		UArticyObject* Object;
+	};
+
+	TArray<FEntry> Entries;
+	EValueClass ValueClass = EValueClass::None;
+	for (auto It = Database->CreateObjectOfClassIterator(Class, 0, true); It; ++It)
+	{
+		ExpressoType Value = ReadValue(*It);
+		const EValueClass Current = GetValueClass(Value);
+		if (Current == EValueClass::None || (ValueClass != EValueClass::None && Current != ValueClass))
+			continue;
+
+		ValueClass = Current;
+		Entries.Add({ MoveTemp(Value), (*It)->GetId(), *It });
+	}
+
+	Entries.Sort([](const FEntry& A, const FEntry& B)
+	{
+		const int32 Order = CompareValues(A.Value, B.Value);
+		return Order != 0 ? Order < 0 : A.Id.Get() < B.Id.Get();
+	});
+
+	Values.Reset(Entries.Num());
+	Ids.Reset(Entries.Num());
+	Objects.Reset(Entries.Num());
+	ValuesById.Reset();
+	ValuesById.Reserve(Entries.Num());
+	for (FEntry& Entry : Entries)
+	{
+		ValuesById.Add(Entry.Id, Entry.Value);
+		Values.Add(MoveTemp(Entry.Value));
+		Ids.Add(Entry.Id);
+		Objects.Add(Entry.Object);
+	}
+
+	RebuildBuckets();
+}
+
+/**
+ * Updates the entry of an object after it was written, loaded or unloaded.
+ * The entry is moved to the position of its new value, which shifts the entries in between.
+ * @param Id The id of the object.
+ * @param Object The current unshadowed clone 0 of the object, nullptr if it is not loaded anymore.
+ * @return True if the entries changed.
+ */
+bool FArticyPropertyIndex::Update(const FArticyId& Id, UArticyObject* Object)
+{
+	ExpressoType Value;
+	if (Object && Object->IsA(Class))
+	{
+		Value = ReadValue(Object);
+		if (Values.Num() > 0 && !IsComparable(Value))
+			Value = ExpressoType();
+	}
+
+	const ExpressoType* Old = ValuesById.Find(Id);
+	if (Old)
+	{
+		//find the entry of the object among the ones with its old value, by id as the object may have been replaced
+		int32 Index = LowerBound(*Old);
+		const int32 End = UpperBound(*Old);
+		while (Index < End && !(Ids[Index] == Id))
+			++Index;
+
+		if (!ensure(Index < End))
+			return false;
+
+		if (Value.Type != ExpressoType::Undefined && CompareValues(*Old, Value) == 0 && Objects[Index] == Object)
+			return false;
+
+		Values.RemoveAt(Index);
+		Ids.RemoveAt(Index);
+		Objects.RemoveAt(Index);
+		ValuesById.Remove(Id);
+	}
+	else if (Value.Type == ExpressoType::Undefined)
+	{
+		return false;
+	}
+
+	if (Value.Type != ExpressoType::Undefined)
+	{
+		int32 Index = LowerBound(Value);
+		const int32 End = UpperBound(Value);
+		while (Index < End && Ids[Index].Get() < Id.Get())
+			++Index;
+
+		Values.Insert(Value, Index);
+		Ids.Insert(Id, Index);
+		Objects.Insert(Object, Index);
+		ValuesById.Add(Id, MoveTemp(Value));
+	}
+
+	return true;
+}
+
+/**
+ * Rebuilds the buckets of a hashed index from the sorted entries, one per distinct value.
+ */
+void FArticyPropertyIndex::RebuildBuckets()
+{
+	Buckets.Reset();
+	if (Kind != EArticyPropertyIndexKind::Hashed)
+		return;
+
+	for (int32 Begin = 0; Begin < Values.Num(); )
+	{
+		int32 End = Begin + 1;
+		while (End < Values.Num() && CompareValues(Values[Begin], Values[End]) == 0)
+			++End;
+
+		Buckets.Add(Values[Begin], TPair<int32, int32>(Begin, End - Begin));
+		Begin = End;
+	}
+}
+
+/**
+ * Reads the indexed value of an object, like getProp.
+ * @param Object The object.
+ * @return The value, undefined if it cannot be read.
+ */
+ExpressoType FArticyPropertyIndex::ReadValue(UArticyObject* Object) const
+{
+	FString PropertyName = Property;
+	FString Feature;
+	if (Property.Split(TEXT("."), &Feature, &PropertyName) && !Object->GetProp<UArticyBaseFeature*>(*Feature))
+	{
+		//objects which do not have the feature are not indexed
+		return ExpressoType();
+	}
+
+	return ExpressoType(Object, Property);
+}
+
+/**
+ * Returns the first entry whose value is not less than a value.
+ * @param Value The value.
+ * @return The index of the entry, or the number of entries if there is none.
+ */
+int32 FArticyPropertyIndex::LowerBound(const ExpressoType& Value) const
+{
+	return Algo::LowerBound(Values, Value, [](const ExpressoType& A, const ExpressoType& B) { return CompareValues(A, B) < 0; });
+}
+
+/**
+ * Returns the first entry whose value is greater than a value.
+ * @param Value The value.
+ * @return The index of the entry, or the number of entries if there is none.
+ */
+int32 FArticyPropertyIndex::UpperBound(const ExpressoType& Value) const
+{
+	return Algo::UpperBound(Values, Value, [](const ExpressoType& A, const ExpressoType& B) { return CompareValues(A, B) < 0; });
+}
+
+/**
+ * Returns true if a query value can be compared with the indexed values.
+ * An empty index is comparable with anything, all its queries return nothing.
+ * @param Value The value.
+ */
+bool FArticyPropertyIndex::IsComparable(const ExpressoType& Value) const
+{
+	const EValueClass ValueClass = GetValueClass(Value);
+	return ValueClass != EValueClass::None && (Values.Num() == 0 || GetValueClass(Values[0]) == ValueClass);
+}
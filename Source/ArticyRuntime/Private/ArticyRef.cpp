@@ -29,8 +29,35 @@ const FArticyId& FArticyRef::GetId() const
 	return Id;
 }
 
-UArticyObject* FArticyRef::GetObjectInternal(const UObject* WorldContext) const
+UArticyObject* FArticyRef::GetCachedObject(const UObject* WorldContext) const
 {
+	const int32 EffectiveCloneId = bReferenceBaseObject ? 0 : CloneId;
+
+	// Refs are usually resolved over and over from the same context, e.g. by a HUD every tick
+	UArticyObject* Object = CachedObject.Get();
+	if (Object && CachedResolveVersion == UArticyDatabase::GetObjectResolveVersion() && CachedId == Id && CachedCloneId == EffectiveCloneId && CachedWorldContext.Get() == WorldContext)
+		return Object;
+
+	bool bCacheable = false;
+	Object = GetObjectInternal(WorldContext, bCacheable);
+
+	// Parallel explorations resolve refs on worker threads, which must not race each other on the cache
+	if (!IsInGameThread())
+		return Object;
+
+	CachedObject = bCacheable ? Object : nullptr;
+	CachedId = Id;
+	CachedCloneId = EffectiveCloneId;
+	CachedWorldContext = WorldContext;
+	// Resolving may load an evicted package, which is part of the state the object was resolved in
+	CachedResolveVersion = UArticyDatabase::GetObjectResolveVersion();
+	return Object;
+}
+
+UArticyObject* FArticyRef::GetObjectInternal(const UObject* WorldContext, bool& bOutCacheable) const
+{
+	bOutCacheable = false;
+
 	if(bReferenceBaseObject)
 		CloneId = 0;
 
@@ -47,6 +74,8 @@ UArticyObject* FArticyRef::GetObjectInternal(const UObject* WorldContext) const
 		
 
 
+	// Copies of shadow states are gone once the state is popped, so they are not cached
+	bOutCacheable = !database->IsInShadowState();
 	return database->GetOrClone<UArticyObject>(GetId(), CloneId);
 }
 
@@ -0,0 +1,61 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyReferenceIndex.h"
+
+/**
+ * Returns the references to an object.
+ * @param Target The id of the referenced object.
+ * @return The references, or nullptr if the object is not referenced from the package.
+ */
+const TArray<FArticyIncomingReference>* FArticyReferenceIndex::Find(const FArticyId& Target) const
+{
+	const FArticyIncomingReferences* Entry = Targets.Find(Target);
+	return Entry ? &Entry->References : nullptr;
+}
+
+/**
+ * Compares the references of each object, used by the import to only save the packages whose references changed.
+ * @param Other The index to compare with.
+ * @return True if both have the same references to the same objects.
+ */
+bool FArticyReferenceIndex::operator==(const FArticyReferenceIndex& Other) const
+{
+	if (Targets.Num() != Other.Targets.Num())
+		return false;
+
+	for (const TPair<FArticyId, FArticyIncomingReferences>& Target : Targets)
+	{
+		const TArray<FArticyIncomingReference>* OtherReferences = Other.Find(Target.Key);
+		if (!OtherReferences || *OtherReferences != Target.Value.References)
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Adds a reference to an object. An object refers to another one through a few properties at most, so the
+ * references of the target are searched for a duplicate.
+ * @param Target The id of the referenced object.
+ * @param Reference The reference.
+ */
+void FArticyReferenceIndex::Add(const FArticyId& Target, const FArticyIncomingReference& Reference)
+{
+	Targets.FindOrAdd(Target).References.AddUnique(Reference);
+}
+
+/**
+ * Removes the references of some sources, and the objects which are not referenced anymore.
+ * @param Predicate Returns true for the sources to remove.
+ */
+void FArticyReferenceIndex::RemoveSources(TFunctionRef<bool(const FArticyId&)> Predicate)
+{
+	for (auto It = Targets.CreateIterator(); It; ++It)
+	{
+		It->Value.References.RemoveAll([&Predicate](const FArticyIncomingReference& Reference) { return Predicate(Reference.Source); });
+		if (It->Value.References.Num() == 0)
+			It.RemoveCurrent();
+	}
+}
@@ -8,7 +8,6 @@
 #include "Components/PanelWidget.h"
 #include "Widgets/Input/SHyperlink.h"
 #include "Interfaces/ArticyHyperlinkHandler.h"
-#include "Internationalization/Regex.h"
 #include "ArticyDatabase.h"
 
 class FArticyRichTextDecorator : public FRichTextDecorator
@@ -62,15 +61,10 @@ protected:
 		InOutString += RunInfo.Content.ToString();
 
 		// Check if this style is defined in our table
-		UDataTable* StyleTable = GetStyleTable();
-		if (StyleTable)
+		if (const FTextBlockStyle* Style = FindStyle(*RunInfo.Name))
 		{
-			// If it is, use its text styling by copying the row in
-			const FRichTextStyleRow* row = StyleTable->FindRow<FRichTextStyleRow>(*RunInfo.Name, "ArticyStyleTableCheck");
-			if (row)
-			{
-				InOutTextStyle = row->TextStyle;
-			}
+			// If it is, use its text styling
+			InOutTextStyle = *Style;
 		}
 
 		// If we have a color attribute
@@ -115,6 +109,47 @@ private:
 	// Pointer to our parent decorator
 	UArticyRichTextDecorator* Decorator = nullptr;
 
+	// The style table the cached styles are from
+	mutable TWeakObjectPtr<UDataTable> CachedStyleTable;
+
+	// The text styles of the style table by run name, unset for names without a row
+	mutable TMap<FName, TOptional<FTextBlockStyle>> CachedStyles;
+
+	/**
+	 * Finds the text style of a run in the style table, looking every name up only once.
+	 *
+	 * @param Name The name of the run.
+	 * @return The text style, or nullptr if the style table has no row with the name.
+	 */
+	const FTextBlockStyle* FindStyle(const FName Name) const
+	{
+		UDataTable* StyleTable = GetStyleTable();
+		if (StyleTable != CachedStyleTable.Get())
+		{
+			CachedStyleTable = StyleTable;
+			CachedStyles.Reset();
+		}
+
+		if (!StyleTable)
+		{
+			return nullptr;
+		}
+
+		TOptional<FTextBlockStyle>* Style = CachedStyles.Find(Name);
+		if (!Style)
+		{
+			Style = &CachedStyles.Add(Name);
+
+			const FRichTextStyleRow* row = StyleTable->FindRow<FRichTextStyleRow>(Name, "ArticyStyleTableCheck");
+			if (row)
+			{
+				*Style = row->TextStyle;
+			}
+		}
+
+		return Style->IsSet() ? &Style->GetValue() : nullptr;
+	}
+
 	/**
 	 * Gets the style table from the owning rich text block.
 	 *
@@ -184,15 +219,16 @@ UObject* UArticyRichTextDecorator::GetHyperlinkHandler(URichTextBlock* RichTextB
  */
 UArticyObject* UArticyRichTextDecorator::GetLinkDestination(URichTextBlock* Owner, const FString& Link)
 {
-	static FRegexPattern Pattern(TEXT("articy:\\/\\/localhost\\/view\\/~\\/(\\d+)"));
-	FRegexMatcher myMatcher(Pattern, Link);
+	// Links have the form articy://localhost/view/~/<id>
+	static const FString Prefix = TEXT("articy://localhost/view/~/");
+	const int32 PrefixIndex = Link.Find(Prefix, ESearchCase::CaseSensitive);
 
 	// If the link doesn't match the expected format, abort.
-	if (!myMatcher.FindNext()) { return nullptr; }
+	const int32 IdIndex = PrefixIndex + Prefix.Len();
+	if (PrefixIndex == INDEX_NONE || IdIndex >= Link.Len() || !FChar::IsDigit(Link[IdIndex])) { return nullptr; }
 
 	// Get numeric id
-	FString Id = myMatcher.GetCaptureGroup(1);
-	uint64 id = FCString::Strtoui64(*Id, nullptr, 10);
+	uint64 id = FCString::Strtoui64(*Link + IdIndex, nullptr, 10);
 
 	// Resolve
 	return UArticyDatabase::Get(Owner)->GetObject(id);
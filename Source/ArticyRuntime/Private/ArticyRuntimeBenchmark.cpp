@@ -0,0 +1,467 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyRuntimeBenchmark.h"
+#include "ArticyDatabase.h"
+#include "ArticyExpressoScripts.h"
+#include "ArticyFlowClasses.h"
+#include "ArticyFlowPlayer.h"
+#include "ArticyGlobalVariables.h"
+#include "ArticyHelpers.h"
+#include "ArticyPackage.h"
+#include "ArticyPins.h"
+#include "ArticyPluginSettings.h"
+#include "ArticyRuntimeModule.h"
+#include "ArticyTextExtension.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/Package.h"
+#include "UObject/StrongObjectPtr.h"
+#include "UObject/UObjectIterator.h"
+
+const TCHAR* const FArticyRuntimeBenchmark::PackageName = TEXT("ArticyRuntimeBenchmark");
+int64 FArticyRuntimeBenchmark::Checksum = 0;
+
+namespace
+{
+	/** The first id of the synthetic objects and pins, far from the ids articy:draft assigns. */
+	const uint64 FirstId = 0x0200000000000000ull;
+
+	TSharedPtr<FJsonValue> MakeValue(const TSharedRef<FJsonObject>& Object)
+	{
+		return MakeShared<FJsonValueObject>(Object);
+	}
+
+	/** The input pins of an object, the targets of the connections. */
+	TArray<UArticyInputPin*>* GetInputPins(const UArticyObject* Object)
+	{
+		return Object->GetPropPtr<TArray<UArticyInputPin*>>(TEXT("InputPins"));
+	}
+
+	/**
+	 * Finds the generated class below BaseClass which has input and output pins.
+	 * If there are several, the first by name is used, so the flows are the same on every run.
+	 */
+	UClass* FindFlowClass(const UClass* BaseClass)
+	{
+		UClass* Found = nullptr;
+		for (TObjectIterator<UClass> It; It; ++It)
+		{
+			UClass* Class = *It;
+			if (Class == BaseClass || !Class->IsChildOf(BaseClass) || Class->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists))
+				continue;
+			if (!FindFProperty<FArrayProperty>(Class, TEXT("InputPins")) || !FindFProperty<FArrayProperty>(Class, TEXT("OutputPins")))
+				continue;
+
+			if (!Found || Class->GetName() < Found->GetName())
+				Found = Class;
+		}
+		return Found;
+	}
+}
+
+/**
+ * Reads the configuration from the arguments of the console command.
+ *
+ * @param Params The arguments, separated by spaces.
+ * @return The configuration, with the defaults for the parameters which are not given.
+ */
+FArticyRuntimeBenchmarkConfig FArticyRuntimeBenchmarkConfig::FromArgs(const TCHAR* Params)
+{
+	FArticyRuntimeBenchmarkConfig Config;
+	FParse::Value(Params, TEXT("Objects="), Config.Objects);
+	FParse::Value(Params, TEXT("ChainLength="), Config.ChainLength);
+	FParse::Value(Params, TEXT("HubWidth="), Config.HubWidth);
+	FParse::Value(Params, TEXT("TreeDepth="), Config.TreeDepth);
+	FParse::Value(Params, TEXT("Iterations="), Config.Iterations);
+	FParse::Value(Params, TEXT("Passes="), Config.Passes);
+	FParse::Value(Params, TEXT("Clones="), Config.Clones);
+	FParse::Value(Params, TEXT("Seed="), Config.Seed);
+
+	// Explore recurses along the chain without the flow graph, which is limited by the stack
+	Config.ChainLength = ArticyHelpers::ClampParameter(TEXT("Benchmark"), TEXT("ChainLength"), Config.ChainLength, 1, 1000);
+	Config.HubWidth = ArticyHelpers::ClampParameter(TEXT("Benchmark"), TEXT("HubWidth"), Config.HubWidth, 1, 10000);
+	Config.TreeDepth = ArticyHelpers::ClampParameter(TEXT("Benchmark"), TEXT("TreeDepth"), Config.TreeDepth, 1, 16);
+
+	// The chain and its two fragments, the hub with its start and targets, and the tree with its start and leaves
+	const int32 FlowObjects = Config.ChainLength + 2 + Config.HubWidth + 2 + (2 << Config.TreeDepth);
+	Config.Objects = ArticyHelpers::ClampParameter(TEXT("Benchmark"), TEXT("Objects"), Config.Objects, FlowObjects, 10000000);
+	Config.Iterations = ArticyHelpers::ClampParameter(TEXT("Benchmark"), TEXT("Iterations"), Config.Iterations, 1, 100000000);
+	Config.Passes = ArticyHelpers::ClampParameter(TEXT("Benchmark"), TEXT("Passes"), Config.Passes, 1, 1000000);
+	Config.Clones = ArticyHelpers::ClampParameter(TEXT("Benchmark"), TEXT("Clones"), Config.Clones, 1, 1000000);
+	return Config;
+}
+
+/** Returns the configuration for the benchmark results. */
+TSharedRef<FJsonObject> FArticyRuntimeBenchmarkConfig::ToJson() const
+{
+	const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetNumberField(TEXT("Objects"), Objects);
+	Json->SetNumberField(TEXT("ChainLength"), ChainLength);
+	Json->SetNumberField(TEXT("HubWidth"), HubWidth);
+	Json->SetNumberField(TEXT("TreeDepth"), TreeDepth);
+	Json->SetNumberField(TEXT("Iterations"), Iterations);
+	Json->SetNumberField(TEXT("Passes"), Passes);
+	Json->SetNumberField(TEXT("Clones"), Clones);
+	Json->SetNumberField(TEXT("Seed"), Seed);
+	return Json;
+}
+
+/**
+ * Creates an object of the synthetic package, initialized from JSON like the importer does.
+ *
+ * @param Synthetic The package to add the object to.
+ * @param Class The generated class of the object.
+ * @param Targets The objects the output pin connects to, their input pins are the targets of the connections.
+ * @return The object.
+ */
+UArticyObject* FArticyRuntimeBenchmark::CreateObject(FSyntheticPackage& Synthetic, UClass* Class, const TArray<UArticyObject*>& Targets)
+{
+	const uint64 Id = Synthetic.NextId++;
+	const FString TechnicalName = FString::Printf(TEXT("Benchmark_%d"), Synthetic.Ids.Num());
+
+	UArticyObject* Object = NewObject<UArticyObject>(Synthetic.Package, Class, *TechnicalName);
+	UArticyBaseObject* BaseObject = Object;
+
+	const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetStringField(TEXT("Id"), ArticyHelpers::Uint64ToPaddedHex(Id));
+	Json->SetStringField(TEXT("TechnicalName"), TechnicalName);
+	Json->SetStringField(TEXT("Parent"), ArticyHelpers::Uint64ToPaddedHex(0));
+	BaseObject->InitFromJson(MakeValue(Json));
+	BaseObject->Initialize();
+
+	// the pins are subobjects of the object, like ArticyObjectTypeInfo creates them
+	const auto MakePinJson = [&](TArray<TSharedPtr<FJsonValue>> Connections)
+	{
+		const TSharedRef<FJsonObject> Pin = MakeShared<FJsonObject>();
+		Pin->SetStringField(TEXT("Text"), TEXT(""));
+		Pin->SetStringField(TEXT("Id"), ArticyHelpers::Uint64ToPaddedHex(Synthetic.NextId++));
+		Pin->SetStringField(TEXT("Owner"), ArticyHelpers::Uint64ToPaddedHex(Id));
+		Pin->SetArrayField(TEXT("Connections"), Connections);
+		return MakeValue(Pin);
+	};
+
+	UArticyInputPin* InputPin = NewObject<UArticyInputPin>(Object);
+	InputPin->InitFromJson(MakePinJson({}));
+	BaseObject->AddSubobject(InputPin);
+	GetInputPins(Object)->Add(InputPin);
+
+	TArray<TSharedPtr<FJsonValue>> Connections;
+	for (const UArticyObject* Target : Targets)
+	{
+		const TSharedRef<FJsonObject> Connection = MakeShared<FJsonObject>();
+		Connection->SetStringField(TEXT("Label"), TEXT(""));
+		Connection->SetStringField(TEXT("TargetPin"), ArticyHelpers::Uint64ToPaddedHex((*GetInputPins(Target))[0]->GetId().Get()));
+		Connection->SetStringField(TEXT("Target"), ArticyHelpers::Uint64ToPaddedHex(Target->GetId().Get()));
+		Connections.Add(MakeValue(Connection));
+	}
+
+	UArticyOutputPin* OutputPin = NewObject<UArticyOutputPin>(Object);
+	OutputPin->InitFromJson(MakePinJson(Connections));
+	BaseObject->AddSubobject(OutputPin);
+	Object->GetPropPtr<TArray<UArticyOutputPin*>>(TEXT("OutputPins"))->Add(OutputPin);
+
+	Synthetic.Package->AddAsset(Object);
+	Synthetic.Ids.Add(Id);
+	return Object;
+}
+
+/**
+ * Creates a level of the tree: a hub connected to the two hubs of the level below, or a fragment at the leaves.
+ *
+ * @param Synthetic The package to add the objects to.
+ * @param Depth The number of levels below this one.
+ * @return The hub or fragment of this level.
+ */
+UArticyObject* FArticyRuntimeBenchmark::CreateTree(FSyntheticPackage& Synthetic, int32 Depth)
+{
+	if (Depth == 0)
+		return CreateObject(Synthetic, Synthetic.FragmentClass, {});
+
+	UArticyObject* Left = CreateTree(Synthetic, Depth - 1);
+	UArticyObject* Right = CreateTree(Synthetic, Depth - 1);
+	return CreateObject(Synthetic, Synthetic.HubClass, { Left, Right });
+}
+
+/**
+ * Builds the flows of the synthetic package, and fills it up with unconnected objects.
+ *
+ * The flows start with a fragment and end at fragments, where the flow player pauses. The hubs between them don't
+ * pause, so each exploration explores the whole flow, and the pins evaluate and execute their (empty) scripts.
+ *
+ * @param Config The size of the flows.
+ * @param Synthetic The package to build.
+ * @return False if the generated code has no dialogue fragment or hub class with pins.
+ */
+bool FArticyRuntimeBenchmark::BuildPackage(const FArticyRuntimeBenchmarkConfig& Config, FSyntheticPackage& Synthetic)
+{
+	Synthetic.FragmentClass = FindFlowClass(UArticyDialogueFragment::StaticClass());
+	Synthetic.HubClass = FindFlowClass(UArticyHub::StaticClass());
+	if (!Synthetic.FragmentClass || !Synthetic.HubClass)
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("The runtime benchmark needs the generated dialogue fragment and hub classes of an articy import."));
+		return false;
+	}
+
+	Synthetic.NextId = FirstId;
+	Synthetic.Ids.Reserve(Config.Objects);
+
+	// linear chain: fragment, hubs, fragment
+	UArticyObject* Chain = CreateObject(Synthetic, Synthetic.FragmentClass, {});
+	for (int32 Link = 0; Link < Config.ChainLength; ++Link)
+		Chain = CreateObject(Synthetic, Synthetic.HubClass, { Chain });
+	Synthetic.ChainStart = CreateObject(Synthetic, Synthetic.FragmentClass, { Chain });
+
+	// wide hub: fragment, hub, one output pin connected to HubWidth fragments
+	TArray<UArticyObject*> HubTargets;
+	for (int32 Target = 0; Target < Config.HubWidth; ++Target)
+		HubTargets.Add(CreateObject(Synthetic, Synthetic.FragmentClass, {}));
+	Synthetic.HubStart = CreateObject(Synthetic, Synthetic.FragmentClass, { CreateObject(Synthetic, Synthetic.HubClass, HubTargets) });
+
+	// deep tree: fragment, binary tree of hubs, fragments at the leaves
+	Synthetic.TreeStart = CreateObject(Synthetic, Synthetic.FragmentClass, { CreateTree(Synthetic, Config.TreeDepth) });
+
+	// the rest of the package, mostly fragments like in a real project
+	while (Synthetic.Ids.Num() < Config.Objects)
+		CreateObject(Synthetic, Synthetic.Ids.Num() % 8 == 0 ? Synthetic.HubClass : Synthetic.FragmentClass, {});
+
+	return true;
+}
+
+/**
+ * Creates a database which has only the synthetic package loaded.
+ * It is duplicated from the imported one for its expresso scripts class, and is not the database of any world,
+ * so the objects of the package resolve it as their database.
+ *
+ * @param Package The synthetic package.
+ * @return The database, or nullptr if there is no imported database.
+ */
+UArticyDatabase* FArticyRuntimeBenchmark::CreateDatabase(UArticyPackage* Package)
+{
+	const UArticyDatabase* Original = UArticyDatabase::GetOriginal();
+	if (!Original)
+		return nullptr;
+
+	UObject* Outer = GetTransientPackage();
+	UArticyDatabase* Database = DuplicateObject(const_cast<UArticyDatabase*>(Original), Outer, MakeUniqueObjectName(Outer, UArticyDatabase::StaticClass(), TEXT("ArticyBenchmarkDatabase")));
+	Database->SetLoadedPackages({ Package });
+	Database->LoadPackage(Package->Name);
+	return Database;
+}
+
+/**
+ * Runs an operation and records the time it took.
+ *
+ * @param Results The results to add the time to.
+ * @param Name The name of the operation in the results.
+ * @param Operations How often the operation is run.
+ * @param Operation Called with the index of the run, returns a value for the checksum.
+ */
+template<typename OperationType>
+void FArticyRuntimeBenchmark::Measure(TArray<FResult>& Results, const FString& Name, int32 Operations, OperationType Operation)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < Operations; ++Index)
+	{
+		Checksum += static_cast<int64>(Operation(Index));
+	}
+
+	FResult& Result = Results.AddDefaulted_GetRef();
+	Result.Name = Name;
+	Result.Operations = Operations;
+	Result.Seconds = FMath::Max(FPlatformTime::Seconds() - StartTime, SMALL_NUMBER);
+}
+
+/**
+ * Builds the synthetic flows, measures the operations and writes the results.
+ *
+ * @param World The world whose global variables and texts are measured.
+ * @param Config The size of the flows.
+ * @return False if the benchmark could not be run.
+ */
+bool FArticyRuntimeBenchmark::Run(UWorld* World, const FArticyRuntimeBenchmarkConfig& Config)
+{
+	UArticyGlobalVariables* WorldGVs = World && UArticyDatabase::GetOriginal() ? UArticyGlobalVariables::GetDefault(World) : nullptr;
+	if (!WorldGVs)
+	{
+		UE_LOG(LogArticyRuntime, Error, TEXT("The runtime benchmark needs a world and the assets of an articy import."));
+		return false;
+	}
+
+	UE_LOG(LogArticyRuntime, Display, TEXT("Running the runtime benchmark with %d objects, a chain of %d hubs, a hub with %d targets and a tree of depth %d."),
+		Config.Objects, Config.ChainLength, Config.HubWidth, Config.TreeDepth);
+
+	// objects shared with their package would resolve the database of the world, so the database copies them all
+	UArticyPluginSettings* Settings = GetMutableDefault<UArticyPluginSettings>();
+	const bool bShareUnmodifiedObjects = Settings->bShareUnmodifiedObjectsWithPackages;
+	Settings->bShareUnmodifiedObjectsWithPackages = false;
+
+	const double BuildStartTime = FPlatformTime::Seconds();
+
+	FSyntheticPackage Synthetic;
+	UObject* TransientPackage = GetTransientPackage();
+	TStrongObjectPtr<UArticyPackage> Package(NewObject<UArticyPackage>(TransientPackage, MakeUniqueObjectName(TransientPackage, UArticyPackage::StaticClass(), TEXT("ArticyBenchmarkPackage"))));
+	Package->Name = PackageName;
+	Synthetic.Package = Package.Get();
+
+	const bool bBuilt = BuildPackage(Config, Synthetic);
+	TStrongObjectPtr<UArticyDatabase> Database(bBuilt ? CreateDatabase(Package.Get()) : nullptr);
+	Settings->bShareUnmodifiedObjectsWithPackages = bShareUnmodifiedObjects;
+	if (!Database.IsValid())
+		return false;
+
+	UE_LOG(LogArticyRuntime, Display, TEXT("Built and loaded the synthetic package in %.1f ms."), (FPlatformTime::Seconds() - BuildStartTime) * 1000.0);
+
+	TArray<FResult> Results;
+	Checksum = 0;
+
+	// the objects are looked up and cloned in a random order, the same for every run with the same seed
+	FRandomStream Random(Config.Seed);
+	TArray<FArticyId> LookupIds;
+	LookupIds.Reserve(Config.Iterations);
+	for (int32 Index = 0; Index < Config.Iterations; ++Index)
+		LookupIds.Add(Synthetic.Ids[Random.RandHelper(Synthetic.Ids.Num())]);
+
+	TArray<FArticyId> CloneIds;
+	CloneIds.Reserve(Config.Clones);
+	for (int32 Index = 0; Index < Config.Clones; ++Index)
+		CloneIds.Add(Synthetic.Ids[Random.RandHelper(Synthetic.Ids.Num())]);
+
+	Measure(Results, TEXT("GetObject"), Config.Iterations, [&](int32 Index) { return Database->GetObject(LookupIds[Index]) != nullptr; });
+	Measure(Results, TEXT("GetObjectsOfClass"), Config.Passes, [&](int32) { return Database->GetObjectsOfClass(Synthetic.FragmentClass).Num(); });
+	Measure(Results, TEXT("CloneFrom"), Config.Clones, [&](int32 Index) { return Database->CloneFrom(CloneIds[Index]) != nullptr; });
+
+	// the flow player explores with a fork of the variables of the world, so the benchmark doesn't change them
+	UArticyFlowPlayer* Player = NewObject<UArticyFlowPlayer>(Database.Get());
+	TStrongObjectPtr<UArticyGlobalVariables> GVs(WorldGVs->Fork(Database.Get(), TEXT("ArticyBenchmarkVariables")));
+	TStrongObjectPtr<UArticyFlowPlayer> PlayerReference(Player);
+	Player->ExploreContext.GVs = GVs.Get();
+	Player->ExploreContext.ExpressoInstance = Database->GetExpressoInstance();
+	Player->ExploreLimit = Config.ChainLength * 4 + 64;
+
+	// the player has no actor to find a methods provider on, and the flows call no methods
+	Player->UserMethodsProvider = nullptr;
+	Player->ResolvedMethodsProvider = nullptr;
+	Player->bMethodsProviderResolved = true;
+
+	struct FFlow
+	{
+		const TCHAR* Name;
+		const UArticyObject* Start;
+	};
+	const FFlow Flows[] = { { TEXT("chain"), Synthetic.ChainStart }, { TEXT("hub"), Synthetic.HubStart }, { TEXT("tree"), Synthetic.TreeStart } };
+
+	for (const FFlow& Flow : Flows)
+	{
+		UArticyObject* Start = Database->GetObject(Flow.Start->GetId());
+		TScriptInterface<IArticyFlowObject> Cursor;
+		Cursor.SetObject(Start);
+		Cursor.SetInterface(Cast<IArticyFlowObject>(Start));
+
+		for (const bool bUseFlowGraph : { true, false })
+		{
+			Player->bUseFlowGraph = bUseFlowGraph;
+			Player->SetCursorTo(Cursor);
+			UE_LOG(LogArticyRuntime, Display, TEXT("  The %s has %d branches."), Flow.Name, Player->GetAvailableBranches().Num());
+
+			Measure(Results, FString::Printf(TEXT("Explore %s (%s)"), Flow.Name, bUseFlowGraph ? TEXT("flow graph") : TEXT("objects")), Config.Passes, [&](int32)
+			{
+				return Player->Explore(Cursor.GetInterface(), false, 0, false).Num();
+			});
+		}
+
+		// playing a branch traverses it, executes its scripts and explores from its end
+		if (Flow.Start != Synthetic.TreeStart)
+		{
+			Player->bUseFlowGraph = true;
+			Measure(Results, FString::Printf(TEXT("Play %s"), Flow.Name), Config.Passes, [&](int32 Index)
+			{
+				Player->SetCursorTo(Cursor);
+				Player->Play(Index % FMath::Max(1, Player->GetAvailableBranches().Num()));
+				Player->OnTick(0.f);
+				return Player->GetAvailableBranches().Num();
+			});
+		}
+	}
+
+	// texts and variables, with the first integer variable
+	const UArticyInt* Variable = nullptr;
+	int32 VariableIndex = INDEX_NONE;
+	for (int32 Index = 0; Index < GVs->GetNumVariables() && !Variable; ++Index)
+	{
+		Variable = GVs->GetVariableByIndex<UArticyInt>(Index);
+		VariableIndex = Index;
+	}
+
+	UArticyTextExtension* TextExtension = UArticyTextExtension::Get();
+	const FText Text = FText::FromString(Variable ? FString::Printf(TEXT("The value of the variable is {%s}."), *Variable->GetGVName().ToString()) : FString(TEXT("A text without tokens.")));
+	Measure(Results, TEXT("Resolve text"), Config.Iterations, [&](int32) { return TextExtension->Resolve(World, &Text).ToString().Len(); });
+	Measure(Results, TEXT("ResolveCached text"), Config.Iterations, [&](int32) { return TextExtension->ResolveCached(World, &Text).ToString().Len(); });
+
+	if (Variable)
+	{
+		const FName VariableName = Variable->GetGVName();
+		const FArticyGvName GvName(VariableName);
+		bool bSucceeded = false;
+
+		Measure(Results, TEXT("GV get by name"), Config.Iterations, [&](int32) { return GVs->GetIntVariable(GvName, bSucceeded); });
+		Measure(Results, TEXT("GV get by new name"), Config.Iterations, [&](int32) { return GVs->GetIntVariable(FArticyGvName(VariableName), bSucceeded); });
+		Measure(Results, TEXT("GV get by index"), Config.Iterations, [&](int32) { return GVs->GetVariableByIndex<UArticyInt>(VariableIndex)->Get(); });
+		Measure(Results, TEXT("GV set by name"), Config.Iterations, [&](int32 Index) { GVs->SetIntVariable(GvName, Index); return 0; });
+		Measure(Results, TEXT("GV set by index"), Config.Iterations, [&](int32 Index) { return *GVs->GetVariableByIndex<UArticyInt>(VariableIndex) = Index; });
+	}
+	else
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("The global variables have no integer variable, their access is not measured."));
+	}
+
+	WriteResults(Config, Results);
+	return true;
+}
+
+/**
+ * Logs the results and writes them to Saved/Articy/Benchmark/RuntimeBenchmarkResults.json and .csv.
+ *
+ * @param Config The configuration, written along with the results.
+ * @param Results The times of the operations.
+ */
+void FArticyRuntimeBenchmark::WriteResults(const FArticyRuntimeBenchmarkConfig& Config, const TArray<FResult>& Results)
+{
+	TArray<TSharedPtr<FJsonValue>> JsonResults;
+	FString Csv = TEXT("Name,Operations,Seconds,NsPerOperation,OperationsPerSecond\n");
+
+	UE_LOG(LogArticyRuntime, Display, TEXT("  %-32s %10s %12s %14s"), TEXT("Operation"), TEXT("Count"), TEXT("ns/op"), TEXT("ops/s"));
+	for (const FResult& Result : Results)
+	{
+		const double NsPerOperation = Result.Seconds / Result.Operations * 1e9;
+		const double OperationsPerSecond = Result.Operations / Result.Seconds;
+		UE_LOG(LogArticyRuntime, Display, TEXT("  %-32s %10lld %12.1f %14.0f"), *Result.Name, Result.Operations, NsPerOperation, OperationsPerSecond);
+
+		const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+		Json->SetStringField(TEXT("Name"), Result.Name);
+		Json->SetNumberField(TEXT("Operations"), Result.Operations);
+		Json->SetNumberField(TEXT("Seconds"), Result.Seconds);
+		Json->SetNumberField(TEXT("NsPerOperation"), NsPerOperation);
+		Json->SetNumberField(TEXT("OperationsPerSecond"), OperationsPerSecond);
+		JsonResults.Add(MakeValue(Json));
+
+		Csv += FString::Printf(TEXT("%s,%lld,%.6f,%.2f,%.1f\n"), *Result.Name, Result.Operations, Result.Seconds, NsPerOperation, OperationsPerSecond);
+	}
+	UE_LOG(LogArticyRuntime, Display, TEXT("  (checksum %lld)"), Checksum);
+
+	const TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetObjectField(TEXT("Config"), Config.ToJson());
+	Root->SetStringField(TEXT("BuildConfiguration"), LexToString(FApp::GetBuildConfiguration()));
+	Root->SetArrayField(TEXT("Results"), JsonResults);
+
+	const FString ResultsPath = ArticyHelpers::GetSavedPath(TEXT("Benchmark"), TEXT("RuntimeBenchmarkResults"));
+	ArticyHelpers::SaveJsonReport(Root, ResultsPath + TEXT(".json"), TEXT("benchmark results"));
+	ArticyHelpers::SaveReport(Csv, ResultsPath + TEXT(".csv"), TEXT("benchmark results"));
+}
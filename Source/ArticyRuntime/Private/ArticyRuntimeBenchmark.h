@@ -0,0 +1,133 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonObject;
+class UArticyDatabase;
+class UArticyObject;
+class UArticyPackage;
+class UWorld;
+
+/**
+ * @struct FArticyRuntimeBenchmarkConfig
+ * @brief The size of the synthetic flows the runtime benchmark builds, and how often each operation is measured.
+ */
+struct FArticyRuntimeBenchmarkConfig
+{
+	/** The number of objects in the synthetic package, including the ones of the flows. */
+	int32 Objects = 100000;
+
+	/** The number of hubs between the start and the end of the linear chain. */
+	int32 ChainLength = 200;
+
+	/** The number of connections of the output pin of the wide hub. */
+	int32 HubWidth = 256;
+
+	/** The depth of the binary tree of hubs, each level shadows the exploration once more. */
+	int32 TreeDepth = 12;
+
+	/** How often the cheap operations are measured: the object lookups, text resolves and variable accesses. */
+	int32 Iterations = 100000;
+
+	/** How often the expensive operations are measured: the explorations, plays and class queries. */
+	int32 Passes = 100;
+	int32 Clones = 10000;
+
+	/** The seed of the looked up and cloned objects, the same seed always measures the same objects. */
+	int32 Seed = 1;
+
+	/**
+	 * Reads the configuration from the arguments of the console command, e.g. Objects=20000 TreeDepth=8.
+	 * Values out of range are clamped with a warning.
+	 */
+	static FArticyRuntimeBenchmarkConfig FromArgs(const TCHAR* Params);
+
+	TSharedRef<FJsonObject> ToJson() const;
+};
+
+/**
+ * @class FArticyRuntimeBenchmark
+ * @brief Measures the hot paths of the runtime with synthetic flows built in memory, so changes can be compared
+ * reproducibly and regressions caught without the content of a project.
+ *
+ * The benchmark builds a package of generated dialogue fragment and hub classes: a linear chain, a wide hub, a deep
+ * tree whose branches are shadowed at every level, and plain objects up to the configured number. The package is
+ * loaded into a database of its own, next to the one of the world. Measured are GetObject, GetObjectsOfClass and
+ * CloneFrom, Explore with and without the flow graph, Play, text resolution and global variable access.
+ *
+ * The results are logged and written, together with the configuration, to
+ * Saved/Articy/Benchmark/RuntimeBenchmarkResults.json and .csv, which CI can compare against a baseline.
+ */
+class FArticyRuntimeBenchmark
+{
+public:
+
+	/** The name of the synthetic package. */
+	static const TCHAR* const PackageName;
+
+	/**
+	 * Builds the synthetic flows, measures the operations and writes the results.
+	 * Needs the generated code and the assets of an articy import, the flows use its classes and scripts.
+	 * @param World The world whose global variables and texts are measured.
+	 * @param Config The size of the flows.
+	 * @return False if the benchmark could not be run, e.g. without an articy import.
+	 */
+	static bool Run(UWorld* World, const FArticyRuntimeBenchmarkConfig& Config);
+
+private:
+
+	/** The time an operation took. */
+	struct FResult
+	{
+		FString Name;
+		int64 Operations = 0;
+		double Seconds = 0.0;
+	};
+
+	/** The synthetic package, the starts of its flows, and the objects the lookups pick from. */
+	struct FSyntheticPackage
+	{
+		UArticyPackage* Package = nullptr;
+		UClass* FragmentClass = nullptr;
+		UClass* HubClass = nullptr;
+
+		UArticyObject* ChainStart = nullptr;
+		UArticyObject* HubStart = nullptr;
+		UArticyObject* TreeStart = nullptr;
+
+		TArray<uint64> Ids;
+		uint64 NextId = 0;
+	};
+
+	/** Finds the generated classes of the flows, and builds the package. */
+	static bool BuildPackage(const FArticyRuntimeBenchmarkConfig& Config, FSyntheticPackage& Synthetic);
+
+	/**
+	 * Creates an object of the package with an input pin, and an output pin connected to the input pins of Targets.
+	 * @return The object, which is added to the package.
+	 */
+	static UArticyObject* CreateObject(FSyntheticPackage& Synthetic, UClass* Class, const TArray<UArticyObject*>& Targets);
+
+	/** Creates the hubs of a level of the tree and the levels below, and returns the hub of this level. */
+	static UArticyObject* CreateTree(FSyntheticPackage& Synthetic, int32 Depth);
+
+	/** Creates a database which has only the synthetic package loaded, using the classes of the imported one. */
+	static UArticyDatabase* CreateDatabase(UArticyPackage* Package);
+
+	/**
+	 * Runs an operation Operations times and records the time it took.
+	 * @param Operation Called with the index of the operation, returns a value for the checksum.
+	 */
+	template<typename OperationType>
+	static void Measure(TArray<FResult>& Results, const FString& Name, int32 Operations, OperationType Operation);
+
+	/** Logs the results and writes them to the results files. */
+	static void WriteResults(const FArticyRuntimeBenchmarkConfig& Config, const TArray<FResult>& Results);
+
+	/** Sums up the values of the operations so they cannot be optimized away, logged with the results. */
+	static int64 Checksum;
+};
@@ -0,0 +1,239 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyRuntimeConsoleCommands.h"
+#include "ArticyBaseTypes.h"
+#include "ArticyRuntimeModule.h"
+#include "ArticyDatabase.h"
+#include "ArticyFlowReplay.h"
+#include "ArticyFlowSimulator.h"
+#include "ArticyGvProfiler.h"
+#include "ArticyMemoryReport.h"
+#include "ArticyRuntimeBenchmark.h"
+#include "ArticyScriptProfiler.h"
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+	/** The hash FArticyId used before switching to 64 bit mixing, kept for comparison. */
+	uint32 LegacyArticyIdHash(const FArticyId& Id)
+	{
+		return Id.Low ^ Id.High;
+	}
+
+	/** Map key funcs using the legacy hash. */
+	struct FLegacyArticyIdKeyFuncs : TDefaultMapKeyFuncs<FArticyId, int32, false>
+	{
+		static FORCEINLINE uint32 GetKeyHash(const FArticyId& Key) { return LegacyArticyIdHash(Key); }
+	};
+
+	/**
+	 * Generates ids the way articy does: a common prefix in the high word, and low words
+	 * which are either sequential or change together with the high word.
+	 */
+	TArray<FArticyId> GenerateSyntheticIds(int32 NumObjects)
+	{
+		TArray<FArticyId> Ids;
+		Ids.Reserve(NumObjects);
+		for (int32 i = 0; i < NumObjects; ++i)
+		{
+			FArticyId Id;
+			if (i % 2 == 0)
+			{
+				//objects created in one session: same high word, sequential low word
+				Id.High = 0x01000001;
+				Id.Low = 0x00001000 + i;
+			}
+			else
+			{
+				//objects created by different users: high and low word correlated
+				Id.High = 0x01000000 + (i >> 4);
+				Id.Low = Id.High ^ (i & 0xF);
+			}
+			Ids.Add(Id);
+		}
+		return Ids;
+	}
+
+	/**
+	 * Inserts all ids into a linear probing table with the same layout as the database object table,
+	 * and logs the average and maximum probe lengths.
+	 */
+	template<typename HashFunc>
+	void ReportProbeLengths(const TCHAR* HashName, const TArray<FArticyId>& Ids, HashFunc Hash)
+	{
+		const uint32 Capacity = FMath::RoundUpToPowerOfTwo((uint32)Ids.Num() * 2);
+		const uint32 Mask = Capacity - 1;
+
+		TArray<bool> Occupied;
+		Occupied.SetNumZeroed(Capacity);
+
+		uint64 TotalProbes = 0;
+		uint32 MaxProbes = 0;
+		for (const FArticyId& Id : Ids)
+		{
+			uint32 Probes = 1;
+			uint32 Index = Hash(Id) & Mask;
+			while (Occupied[Index])
+			{
+				Index = (Index + 1) & Mask;
+				++Probes;
+			}
+			Occupied[Index] = true;
+
+			TotalProbes += Probes;
+			MaxProbes = FMath::Max(MaxProbes, Probes);
+		}
+
+		UE_LOG(LogArticyRuntime, Display, TEXT("  [%s] object table: capacity %u, avg probe length %.3f, max probe length %u"),
+			HashName, Capacity, (double)TotalProbes / FMath::Max(1, Ids.Num()), MaxProbes);
+	}
+
+	/** Fills a map with all ids, and logs the throughput of looking all of them up. */
+	template<typename MapType>
+	void ReportMapThroughput(const TCHAR* HashName, const TArray<FArticyId>& Ids)
+	{
+		constexpr int32 NumPasses = 10;
+
+		MapType Map;
+		Map.Reserve(Ids.Num());
+		for (int32 i = 0; i < Ids.Num(); ++i)
+			Map.Add(Ids[i], i);
+
+		int64 Checksum = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+		{
+			for (const FArticyId& Id : Ids)
+			{
+				if (const int32* Value = Map.Find(Id))
+					Checksum += *Value;
+			}
+		}
+		const double Elapsed = FMath::Max(FPlatformTime::Seconds() - StartTime, SMALL_NUMBER);
+		const double NumLookups = (double)Ids.Num() * NumPasses;
+
+		UE_LOG(LogArticyRuntime, Display, TEXT("  [%s] TMap: %.2f M lookups/s, %.1f ns/lookup (checksum %lld)"),
+			HashName, NumLookups / Elapsed / 1e6, Elapsed / NumLookups * 1e9, Checksum);
+	}
+}
+
+/**
+ * Benchmarks the id maps used by the database and the global variables.
+ * @param Args Optional number of objects to generate.
+ */
+void FArticyRuntimeConsoleCommands::BenchmarkIdMaps(const TArray<FString>& Args)
+{
+	const int32 NumObjects = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+	const TArray<FArticyId> Ids = GenerateSyntheticIds(NumObjects);
+
+	UE_LOG(LogArticyRuntime, Display, TEXT("Articy id map benchmark with %d synthetic objects:"), NumObjects);
+
+	ReportProbeLengths(TEXT("current"), Ids, [](const FArticyId& Id) { return GetTypeHash(Id); });
+	ReportProbeLengths(TEXT("legacy"), Ids, &LegacyArticyIdHash);
+
+	ReportMapThroughput<TMap<FArticyId, int32>>(TEXT("current"), Ids);
+	ReportMapThroughput<TMap<FArticyId, int32, FDefaultSetAllocator, FLegacyArticyIdKeyFuncs>>(TEXT("legacy"), Ids);
+}
+
+/**
+ * Logs the most expensive expresso script fragments.
+ * @param Args Optional number of fragments, and "reset".
+ * @param World The world to get the database from.
+ */
+void FArticyRuntimeConsoleCommands::DumpScriptProfile(const TArray<FString>& Args, UWorld* World)
+{
+	int32 NumFragments = 20;
+	bool bReset = false;
+	for (const FString& Arg : Args)
+	{
+		if (Arg.Equals(TEXT("reset"), ESearchCase::IgnoreCase))
+			bReset = true;
+		else if (Arg.IsNumeric())
+			NumFragments = FMath::Max(1, FCString::Atoi(*Arg));
+	}
+
+	if (!FArticyScriptProfiler::IsEnabled())
+		UE_LOG(LogArticyRuntime, Display, TEXT("Script profiling is disabled, enable it with Articy.ProfileScripts 1."));
+
+	FArticyScriptProfiler::DumpTopFragments(World ? UArticyDatabase::Get(World) : nullptr, NumFragments);
+
+	if (bReset)
+		FArticyScriptProfiler::Reset();
+}
+
+/**
+ * Writes the reads and writes of the global variables by script fragment to a CSV file.
+ * @param Args Optional file, and "reset".
+ * @param World The world to get the database from.
+ */
+void FArticyRuntimeConsoleCommands::DumpGVProfile(const TArray<FString>& Args, UWorld* World)
+{
+	FString File = TEXT("GVProfile.csv");
+	bool bReset = false;
+	for (const FString& Arg : Args)
+	{
+		if (Arg.Equals(TEXT("reset"), ESearchCase::IgnoreCase))
+			bReset = true;
+		else
+			File = Arg;
+	}
+
+	if (!FArticyGvProfiler::IsEnabled())
+		UE_LOG(LogArticyRuntime, Display, TEXT("GV profiling is disabled, enable it with Articy.ProfileGVs 1."));
+
+	FArticyGvProfiler::WriteCsv(File, World ? UArticyDatabase::Get(World) : nullptr);
+
+	if (bReset)
+		FArticyGvProfiler::Reset();
+}
+
+/**
+ * Logs the memory used by the articy data, by category.
+ */
+void FArticyRuntimeConsoleCommands::MemReport()
+{
+	FArticyMemoryReport::Collect().Log(*GLog);
+}
+
+/**
+ * Measures the hot paths of the runtime with synthetic flows, and writes the results.
+ * @param Args The size of the flows.
+ * @param World The world whose global variables and texts are measured.
+ */
+void FArticyRuntimeConsoleCommands::BenchmarkRuntime(const TArray<FString>& Args, UWorld* World)
+{
+	FArticyRuntimeBenchmark::Run(World, FArticyRuntimeBenchmarkConfig::FromArgs(*FString::Join(Args, TEXT(" "))));
+}
+
+/**
+ * Walks random playthroughs of the flow from a start node and writes the results.
+ * @param Args The start node and number of playthroughs.
+ * @param World The world whose database and global variables are used.
+ */
+void FArticyRuntimeConsoleCommands::SimulateFlow(const TArray<FString>& Args, UWorld* World)
+{
+	FArticyFlowSimulator::Run(World, FArticyFlowSimulatorConfig::FromArgs(*FString::Join(Args, TEXT(" "))));
+}
+
+/**
+ * Replays a flow capture with a headless flow player.
+ * @param Args The capture file.
+ * @param World The world whose database and global variables are used.
+ */
+void FArticyRuntimeConsoleCommands::ReplayFlow(const TArray<FString>& Args, UWorld* World)
+{
+	if (Args.Num() == 0)
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("Usage: Articy.ReplayFlow <File>"));
+		return;
+	}
+
+	FArticyFlowCapture Capture;
+	if (!Capture.LoadFromFile(Args[0]))
+		return;
+
+	FArticyFlowReplayResult Result;
+	FArticyFlowReplay::Run(World, Capture, Result);
+}
@@ -3,6 +3,10 @@
 //
 
 #include "ArticyRuntimeModule.h"
+#include "ArticyRuntimeConsoleCommands.h"
+#include "ArticyFlowRecorder.h"
+#include "ArticyMemoryReport.h"
+#include "ArticyStats.h"
 #include "Internationalization/StringTableRegistry.h"
 #include "Misc/Paths.h"
 #include "HAL/PlatformFilemanager.h"
@@ -16,22 +20,55 @@
 
 DEFINE_LOG_CATEGORY(LogArticyRuntime)
 
+DEFINE_STAT(STAT_ArticyFlowExplore);
+DEFINE_STAT(STAT_ArticyFlowUpdateBranches);
+DEFINE_STAT(STAT_ArticyFlowExecuteBranch);
+DEFINE_STAT(STAT_ArticyFlowScheduler);
+DEFINE_STAT(STAT_ArticyShadowPush);
+DEFINE_STAT(STAT_ArticyShadowPop);
+DEFINE_STAT(STAT_ArticyGetObject);
+DEFINE_STAT(STAT_ArticyCloneFrom);
+DEFINE_STAT(STAT_ArticyLoadPackage);
+DEFINE_STAT(STAT_ArticyLinkObjects);
+DEFINE_STAT(STAT_ArticyResolveText);
+DEFINE_STAT(STAT_ArticyEvaluateCondition);
+DEFINE_STAT(STAT_ArticyExecuteInstruction);
+
+DEFINE_STAT(STAT_ArticyExploredNodes);
+DEFINE_STAT(STAT_ArticyObjectShadowCopies);
+DEFINE_STAT(STAT_ArticySharedFeatureCopies);
+DEFINE_STAT(STAT_ArticyVariableShadowStates);
+DEFINE_STAT(STAT_ArticySeenMapCopies);
+DEFINE_STAT(STAT_ArticySeenMapUndoEntries);
+DEFINE_STAT(STAT_ArticyGetObjectCalls);
+DEFINE_STAT(STAT_ArticyDatabaseGetCalls);
+
 /**
  * Called when the module is loaded into memory.
  * This is where you should initialize any resources or set up any state necessary for your module.
- * Currently, this method does not perform any actions.
+ * Registers the runtime console commands and starts updating the articy memory stats.
  */
 void FArticyRuntimeModule::StartupModule()
 {
+	ConsoleCommands = new FArticyRuntimeConsoleCommands();
+	FArticyMemoryReport::StartStatsUpdates();
 }
 
 /**
  * Called when the module is unloaded from memory.
  * This is where you should clean up any resources or state that was initialized in StartupModule.
- * Currently, this method does not perform any actions.
+ * Stops the memory stats and the flow recorder, and destroys the runtime console commands.
  */
 void FArticyRuntimeModule::ShutdownModule()
 {
+	FArticyMemoryReport::StopStatsUpdates();
+	FArticyFlowRecorder::Shutdown();
+
+	if (ConsoleCommands != nullptr)
+	{
+		delete ConsoleCommands;
+		ConsoleCommands = nullptr;
+	}
 }
 
 IMPLEMENT_MODULE(FArticyRuntimeModule, ArticyRuntime)
@@ -6,17 +6,16 @@
 #include "ArticyExpressoScripts.h"
 
 /**
- * Computes and returns a hash of the expression.
- * The hash is cached for performance optimization.
+ * Returns the hash of the expression, which is computed on import.
  *
  * @return The hash value of the expression.
  */
 int UArticyScriptFragment::GetExpressionHash() const
 {
-    if (!CachedExpressionHash)
-        CachedExpressionHash = GetTypeHash(Expression);
+    if (!ExpressionHash)
+        ExpressionHash = GetTypeHash(Expression);
 
-    return CachedExpressionHash;
+    return ExpressionHash;
 }
 
 /**
@@ -36,6 +35,8 @@ void UArticyScriptFragment::InitFromJson(TSharedPtr<FJsonValue> Json)
     auto exp = Json->AsString();
     if (!exp.IsEmpty())
         Expression = *exp;
+
+    ExpressionHash = GetTypeHash(Expression);
 }
 
 //---------------------------------------------------------------------------//
@@ -67,6 +68,18 @@ bool UArticyCondition::Evaluate(UArticyGlobalVariables* GV, UObject* MethodProvi
     return !GetCondition() || GetCondition()->Evaluate(GV, MethodProvider);
 }
 
+/**
+ * Returns the script of the script condition of the node.
+ *
+ * @param OutHash Receives the hash of the condition fragment.
+ * @return False if the node has no script condition.
+ */
+bool UArticyCondition::GetConditionScript(int& OutHash) const
+{
+    const UArticyScriptCondition* condition = GetCondition();
+    return condition && condition->GetConditionScript(OutHash);
+}
+
 /**
  * Explores the condition node and appends the resulting branches to the output array.
  * The exploration follows the output pins based on the condition evaluation result.
@@ -0,0 +1,154 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyScriptProfiler.h"
+#include "ArticyDatabase.h"
+#include "ArticyFlowClasses.h"
+#include "ArticyFlowGraph.h"
+#include "ArticyPins.h"
+#include "ArticyRuntimeModule.h"
+#include "ArticyScriptFragment.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+#if defined(UE_TRACE_ENABLED) && UE_TRACE_ENABLED
+UE_TRACE_CHANNEL_DEFINE(ArticyScriptsChannel);
+#endif
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarProfileScripts(
+		TEXT("Articy.ProfileScripts"),
+		false,
+		TEXT("Records call counts and timings of the articy expresso script fragments, see Articy.DumpScriptProfile."));
+}
+
+TMap<int32, FArticyScriptProfiler::FFragmentStats> FArticyScriptProfiler::Fragments;
+FCriticalSection FArticyScriptProfiler::FragmentsLock;
+
+/**
+ * Returns true if script fragments are recorded.
+ */
+bool FArticyScriptProfiler::IsEnabled()
+{
+	return CVarProfileScripts.GetValueOnAnyThread();
+}
+
+/**
+ * Adds one call of a fragment to its statistics.
+ * @param Hash The hash of the fragment.
+ * @param bInstruction Whether the fragment is an instruction.
+ * @param Cycles The time spent in the call, in cycles.
+ */
+void FArticyScriptProfiler::Record(int32 Hash, bool bInstruction, uint64 Cycles)
+{
+	FScopeLock Lock(&FragmentsLock);
+
+	FFragmentStats& Stats = Fragments.FindOrAdd(Hash);
+	Stats.bInstruction = bInstruction;
+	++Stats.Calls;
+	Stats.Cycles += Cycles;
+}
+
+/**
+ * Discards all recorded statistics.
+ */
+void FArticyScriptProfiler::Reset()
+{
+	FScopeLock Lock(&FragmentsLock);
+	Fragments.Reset();
+}
+
+/**
+ * Returns the fragments with the most cumulative time, most expensive first.
+ * @param Num The maximum number of fragments to return.
+ * @return The hashes and statistics of the fragments.
+ */
+TArray<TPair<int32, FArticyScriptProfiler::FFragmentStats>> FArticyScriptProfiler::GetTopFragments(int32 Num)
+{
+	TArray<TPair<int32, FFragmentStats>> Result;
+	{
+		FScopeLock Lock(&FragmentsLock);
+		Result.Reserve(Fragments.Num());
+		for (const auto& Fragment : Fragments)
+			Result.Emplace(Fragment.Key, Fragment.Value);
+	}
+
+	Result.Sort([](const TPair<int32, FFragmentStats>& A, const TPair<int32, FFragmentStats>& B) { return A.Value.Cycles > B.Value.Cycles; });
+	if (Result.Num() > Num)
+		Result.SetNum(FMath::Max(0, Num));
+
+	return Result;
+}
+
+/**
+ * Finds the first object and text using each of the fragments.
+ * The text and owner are found in the flow graph, which knows the script hash of every pin and script node.
+ * @param Database The database to look up fragments in.
+ * @param Hashes The hashes of the fragments.
+ * @return The name of the owner and the text of each fragment found, by hash.
+ */
+TMap<int32, TPair<FString, FString>> FArticyScriptProfiler::FindSources(const UArticyDatabase* Database, const TSet<int32>& Hashes)
+{
+	TMap<int32, TPair<FString, FString>> Sources;
+	if (!Database || Hashes.Num() == 0)
+		return Sources;
+
+	const FArticyFlowGraph& Graph = Database->GetFlowGraph();
+	for (int32 i = 0; i < Graph.Num(); ++i)
+	{
+		const FArticyFlowGraphNode& Node = Graph.GetNode(i);
+		if (!Node.bHasScript || !Hashes.Contains(Node.ScriptHash) || Sources.Contains(Node.ScriptHash))
+			continue;
+
+		TPair<FString, FString>& Source = Sources.Add(Node.ScriptHash);
+		const UObject* Owner = Node.Object;
+		if (const UArticyFlowPin* Pin = Cast<UArticyFlowPin>(Node.Object))
+		{
+			Source.Value = Pin->Text;
+			Owner = Node.Owner != INDEX_NONE ? Graph.GetNode(Node.Owner).Object : Pin;
+		}
+		else if (const UArticyCondition* Condition = Cast<UArticyCondition>(Node.Object))
+		{
+			Source.Value = Condition->GetCondition() ? Condition->GetCondition()->GetExpression() : FString();
+		}
+		else if (const UArticyInstruction* Instruction = Cast<UArticyInstruction>(Node.Object))
+		{
+			Source.Value = Instruction->GetInstruction() ? Instruction->GetInstruction()->GetExpression() : FString();
+		}
+
+		Source.Key = Owner ? Owner->GetName() : TEXT("?");
+	}
+
+	return Sources;
+}
+
+/**
+ * Logs the most expensive fragments, with their text and owning object in the database.
+ * @param Database The database to look up fragments in, may be null.
+ * @param Num The maximum number of fragments to log.
+ */
+void FArticyScriptProfiler::DumpTopFragments(const UArticyDatabase* Database, int32 Num)
+{
+	const TArray<TPair<int32, FFragmentStats>> Top = GetTopFragments(Num);
+
+	TSet<int32> Hashes;
+	for (const auto& Fragment : Top)
+		Hashes.Add(Fragment.Key);
+	const TMap<int32, TPair<FString, FString>> Sources = FindSources(Database, Hashes);
+
+	UE_LOG(LogArticyRuntime, Display, TEXT("Top %d articy script fragments by time:"), Top.Num());
+	for (const auto& Fragment : Top)
+	{
+		const FFragmentStats& Stats = Fragment.Value;
+		const double TotalMs = FPlatformTime::ToMilliseconds64(Stats.Cycles);
+		const TPair<FString, FString>* Source = Sources.Find(Fragment.Key);
+
+		UE_LOG(LogArticyRuntime, Display, TEXT("  %s %d: %llu calls, %.3f ms total, %.3f us/call, owner %s: %s"),
+			Stats.bInstruction ? TEXT("instruction") : TEXT("condition"), Fragment.Key, Stats.Calls, TotalMs,
+			Stats.Calls > 0 ? TotalMs * 1000.0 / Stats.Calls : 0.0,
+			Source && !Source->Key.IsEmpty() ? *Source->Key : TEXT("?"),
+			Source ? *Source->Value.Replace(TEXT("\n"), TEXT(" ")) : TEXT(""));
+	}
+}
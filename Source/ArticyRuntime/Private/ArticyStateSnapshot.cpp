@@ -0,0 +1,214 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyStateSnapshot.h"
+#include "ArticyDatabase.h"
+#include "ArticyGlobalVariables.h"
+#include "ArticyObject.h"
+#include "ArticyRuntimeModule.h"
+
+const ExpressoType FArticyStateSnapshot::Undefined;
+
+namespace
+{
+	/**
+	 * Returns the full name to dense index map of the variables, shared by all snapshots of the same schema.
+	 * Only called on the game thread, the snapshots just hold on to the map.
+	 *
+	 * @param GVs The global variables to index.
+	 * @return The map, rebuilt if the schema of the variables changed.
+	 */
+	TSharedPtr<const TMap<FName, int32>, ESPMode::ThreadSafe> GetVariableIndices(const UArticyGlobalVariables* GVs)
+	{
+		static uint32 CachedSchemaHash = 0;
+		static TSharedPtr<const TMap<FName, int32>, ESPMode::ThreadSafe> CachedIndices;
+
+		if (!CachedIndices.IsValid() || CachedSchemaHash != GVs->GetSchemaHash())
+		{
+			TSharedRef<TMap<FName, int32>, ESPMode::ThreadSafe> Indices = MakeShared<TMap<FName, int32>, ESPMode::ThreadSafe>();
+			Indices->Reserve(GVs->GetNumVariables());
+			for (int32 Index = 0; Index < GVs->GetNumVariables(); ++Index)
+			{
+				if (const UArticyVariable* Var = GVs->GetVariableByIndex(Index))
+				{
+					Indices->Add(Var->GetGVName(), Index);
+				}
+			}
+
+			CachedSchemaHash = GVs->GetSchemaHash();
+			CachedIndices = Indices;
+		}
+
+		return CachedIndices;
+	}
+
+	/**
+	 * Returns the value of a variable as an expresso type, which does not reference the variable.
+	 *
+	 * @param Var The variable to read.
+	 * @return The value, undefined if the variable is null or of an unknown type.
+	 */
+	ExpressoType GetVariableValue(const UArticyVariable* Var)
+	{
+		if (const UArticyInt* Int = Cast<UArticyInt>(Var))
+		{
+			return ExpressoType(*Int);
+		}
+		if (const UArticyBool* Bool = Cast<UArticyBool>(Var))
+		{
+			return ExpressoType(*Bool);
+		}
+		if (const UArticyString* String = Cast<UArticyString>(Var))
+		{
+			return ExpressoType(*String);
+		}
+		return ExpressoType();
+	}
+}
+
+/**
+ * Captures the global variables and the requested objects of the database of a world.
+ *
+ * @param WorldContext The object to get the database and its global variables from.
+ * @param Request The objects and properties to capture.
+ * @return The snapshot, empty if there is no database.
+ */
+TSharedRef<const FArticyStateSnapshot, ESPMode::ThreadSafe> FArticyStateSnapshot::Capture(const UObject* WorldContext, const FArticyStateSnapshotRequest& Request)
+{
+	const UArticyDatabase* Database = UArticyDatabase::Get(WorldContext);
+	const UArticyGlobalVariables* GVs = Database ? UArticyGlobalVariables::GetDefault(WorldContext) : nullptr;
+	if (!Database)
+	{
+		UE_LOG(LogArticyRuntime, Warning, TEXT("Could not capture a state snapshot, there is no articy database."));
+	}
+
+	return Capture(Database, GVs, Request);
+}
+
+/**
+ * Captures the global variables and the requested objects. The values are copied, so the snapshot does not
+ * reference any UObject afterwards. Must not be called during a shadow state.
+ *
+ * @param Database The database to capture the objects of, may be null to capture the variables only.
+ * @param GVs The global variables to capture, may be null to capture the objects only.
+ * @param Request The objects and properties to capture.
+ * @return The snapshot.
+ */
+TSharedRef<const FArticyStateSnapshot, ESPMode::ThreadSafe> FArticyStateSnapshot::Capture(const UArticyDatabase* Database, const UArticyGlobalVariables* GVs, const FArticyStateSnapshotRequest& Request)
+{
+	check(IsInGameThread());
+
+	TSharedRef<FArticyStateSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FArticyStateSnapshot, ESPMode::ThreadSafe>();
+	Snapshot->FrameNumber = GFrameCounter;
+
+	if (GVs)
+	{
+		// during a shadow state, the values are the ones of the exploration, not of the game
+		ensureMsgf(GVs->GetShadowLevel() == 0, TEXT("A state snapshot should not be captured during a shadow state."));
+
+		Snapshot->VariableIndices = GetVariableIndices(GVs);
+		Snapshot->VariableValues.Reserve(GVs->GetNumVariables());
+		for (int32 Index = 0; Index < GVs->GetNumVariables(); ++Index)
+		{
+			Snapshot->VariableValues.Add(GetVariableValue(GVs->GetVariableByIndex(Index)));
+		}
+
+		if (Request.bSeenCounters)
+		{
+			for (int32 Slot = 0; Slot < GVs->VisitStates.Num(); ++Slot)
+			{
+				if (GVs->VisitStates[Slot].SeenCounter != 0)
+				{
+					Snapshot->SeenCounters.Add(FArticySeenCounterSlots::GetId(Slot), GVs->VisitStates[Slot].SeenCounter);
+				}
+			}
+		}
+	}
+
+	if (Database && (Request.Objects.Num() > 0 || Request.Classes.Num() > 0))
+	{
+		ensureMsgf(!Database->IsInShadowState(), TEXT("A state snapshot should not be captured during a shadow state."));
+
+		TArray<UArticyObject*> Objects;
+		for (const FArticyId& Id : Request.Objects)
+		{
+			if (UArticyObject* Object = Database->GetObject(Id))
+			{
+				Objects.Add(Object);
+			}
+			else
+			{
+				UE_LOG(LogArticyRuntime, Warning, TEXT("State snapshot: there is no object with id %s."), *Id.ToString());
+			}
+		}
+		for (const TSubclassOf<UArticyObject>& Class : Request.Classes)
+		{
+			Objects.Append(Database->GetObjectsOfClass(Class));
+		}
+
+		Snapshot->Properties = Request.Properties;
+		const int32 NumProperties = Snapshot->Properties.Num();
+
+		Snapshot->ObjectIds.Reserve(Objects.Num());
+		Snapshot->PropertyValues.Reserve(Objects.Num() * NumProperties);
+		for (UArticyObject* Object : Objects)
+		{
+			const FArticyId Id = Object->GetId();
+			if (Snapshot->ObjectIndices.Contains(Id))
+			{
+				// requested by id and by class, or by more than one class
+				continue;
+			}
+
+			Snapshot->ObjectIndices.Add(Id, Snapshot->ObjectIds.Add(Id));
+			for (const FString& Property : Snapshot->Properties)
+			{
+				Snapshot->PropertyValues.Add(ExpressoType(Object, Property));
+			}
+		}
+	}
+
+	return Snapshot;
+}
+
+/**
+ * Returns the value of a variable by its full name.
+ *
+ * @param FullName The name of the variable, Namespace.Variable.
+ * @return The value, undefined if there is no such variable.
+ */
+const ExpressoType& FArticyStateSnapshot::GetVariable(FName FullName) const
+{
+	const int32* Index = VariableIndices.IsValid() ? VariableIndices->Find(FullName) : nullptr;
+	return Index ? GetVariableByIndex(*Index) : Undefined;
+}
+
+/**
+ * Returns the seen counter of a flow node.
+ *
+ * @param Id The id of the flow node.
+ * @return The seen counter, 0 if the node was not seen or the seen counters were not captured.
+ */
+int32 FArticyStateSnapshot::GetSeenCounter(const FArticyId& Id) const
+{
+	const int32* Counter = SeenCounters.Find(Id);
+	return Counter ? *Counter : 0;
+}
+
+/**
+ * Returns the value of a property of an object.
+ *
+ * @param Id The id of the object.
+ * @param PropertyIndex The index of the property, see GetPropertyIndex.
+ * @return The value, undefined if the object or property was not captured or the object has no such property.
+ */
+const ExpressoType& FArticyStateSnapshot::GetProperty(const FArticyId& Id, int32 PropertyIndex) const
+{
+	const int32* ObjectIndex = ObjectIndices.Find(Id);
+	if (!ObjectIndex || !Properties.IsValidIndex(PropertyIndex))
+	{
+		return Undefined;
+	}
+	return PropertyValues[*ObjectIndex * Properties.Num() + PropertyIndex];
+}
@@ -7,137 +7,635 @@
 #include "ArticyGlobalVariables.h"
 #include "ArticyTypeSystem.h"
 #include "ArticyHelpers.h"
-
-UArticyTextExtension* UArticyTextExtension::Get()
+#include "ArticyStats.h"
+#include "Internationalization/Culture.h"
+#include "Internationalization/Internationalization.h"
+#include "Misc/ScopeRWLock.h"
+
+/**
+ * The source of a token, split into its parts once and cached by UArticyTextExtension.
+ * A source is a method call (Object.Method(Args)), a type property ($Type.Type.Property)
+ * or a global variable (Namespace.Variable), which is resolved as an object property (Object<Instance>.Property) otherwise.
+ */
+struct FArticyTextSource
 {
-	static TWeakObjectPtr<UArticyTextExtension> ArticyTextExtension;
+	enum class EKind : uint8
+	{
+		None,
+		Method,
+		TypeProperty,
+		Variable
+	};
 
-	if (!ArticyTextExtension.IsValid())
+	/** The built-in methods, and the ones added by UArticyTextExtension::AddUserMethod. */
+	enum class EMethod : uint8
 	{
-		ArticyTextExtension = TWeakObjectPtr<UArticyTextExtension>(NewObject<UArticyTextExtension>());
-	}
+		User,
+		If,
+		Not
+	};
 
-	return ArticyTextExtension.Get();
-}
+	EKind Kind = EKind::None;
 
-// Retrieve string from specified source
-FString UArticyTextExtension::GetSource(UObject* Outer, const FString& SourceName) const
+	/** The name and arguments of a method call, the name is interned for the lookup of user methods. */
+	EMethod MethodKind = EMethod::User;
+	FName Method;
+	TArray<FString> Args;
+
+	/** The type of a type property. */
+	FString TypeName;
+
+	/** The property of a type or object, without a trailing $Type. */
+	FString PropertyName;
+
+	/** The global variable, it caches its index in the current global variables. */
+	FArticyGvName GvName;
+
+	/** The object, by id if bById, otherwise by technical name. */
+	bool bById = false;
+	FArticyId ObjectId;
+	FName ObjectName;
+	int32 CloneId = 0;
+
+	/** Whether the type of the object property is requested instead of its value. */
+	bool bRequestType = false;
+
+	/**
+	 * Compiles a token source.
+	 * @param SourceName The source, the part of the token before the number format.
+	 * @return The compiled source.
+	 */
+	static FArticyTextSource Compile(const FString& SourceName);
+};
+
+/**
+ * A C# custom numeric format string, compiled into the pieces it prints.
+ */
+struct FArticyNumberFormat
 {
-	// Split the SourceName by dots
-	TArray<FString> SourceParts;
-	SourceName.ParseIntoArray(SourceParts, TEXT("."));
-	FString RemValue = TEXT("");
-	FString Result = TEXT("");
-	bool bSuccess = false;
+	enum class EOp : uint8
+	{
+		/** The rounded value with Count zero padded digits (0). */
+		Integer,
+		/** The value with Count fractional digits (# or .#). */
+		Fraction,
+		/** Literal text. */
+		Literal
+	};
+
+	struct FPiece
+	{
+		EOp Op = EOp::Literal;
+		int32 Count = 0;
+		FString Text;
+	};
+
+	TArray<FPiece> Pieces;
+
+	/**
+	 * Compiles a number format.
+	 * @param NumberFormat The format, e.g. 000 or #.##.
+	 * @return The compiled format.
+	 */
+	static FArticyNumberFormat Compile(const FString& NumberFormat);
+};
+
+namespace
+{
+	/** Texts only differing in case are different keys. */
+	template<typename ValueType>
+	struct TCaseSensitiveKeyFuncs : TDefaultMapKeyFuncs<FString, ValueType, false>
+	{
+		static bool Matches(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+		static uint32 GetKeyHash(const FString& Key) { return FCrc::StrCrc32(*Key); }
+	};
 
-	if (SourceParts.Num() > 0)
+	/**
+	 * Texts compiled into T, by text. Read-mostly: texts are compiled once, then only looked up.
+	 * The cache is cleared once it gets too big, it only needs to hold the texts currently on screen.
+	 */
+	template<typename T>
+	class TArticyTextCache
 	{
-		FString MethodName = SourceParts[0];
-        
-		FString Parameters;
-		for (int32 Index = 1; Index < SourceParts.Num(); ++Index)
+	public:
+		using FRef = TSharedRef<const T, ESPMode::ThreadSafe>;
+
+		FRef FindOrAdd(const FString& Text, T (*Compile)(const FString&))
 		{
-			if (!Parameters.IsEmpty())
 			{
-				Parameters += TEXT(",");
+				FReadScopeLock ReadLock(Lock);
+				if (const FRef* Entry = Entries.Find(Text))
+					return *Entry;
 			}
-			Parameters += SourceParts[Index];
+
+			FRef Entry = MakeShared<T, ESPMode::ThreadSafe>(Compile(Text));
+
+			FWriteScopeLock WriteLock(Lock);
+			if (Entries.Num() >= MaxEntries)
+				Entries.Reset();
+
+			Entries.Add(Text, Entry);
+			return Entry;
 		}
-        
-		if (Parameters.Contains(TEXT("(")) && Parameters.Contains(TEXT(")")))
+
+	private:
+		static constexpr int32 MaxEntries = 4096;
+
+		TMap<FString, FRef, FDefaultSetAllocator, TCaseSensitiveKeyFuncs<FRef>> Entries;
+		FRWLock Lock;
+	};
+
+	TArticyTextCache<FArticyTextTemplate> Templates;
+	TArticyTextCache<FArticyTextSource> Sources;
+	TArticyTextCache<FArticyNumberFormat> NumberFormats;
+
+	/**
+	 * The localized true and false strings of the boolean variables and properties, by source name.
+	 * They are localized once per culture, the cache is cleared when the culture changes.
+	 */
+	class FArticyBooleanStrings
+	{
+	public:
+		template<typename LocalizeType>
+		FString FindOrAdd(const FString& SourceName, bool bValue, LocalizeType&& Localize)
 		{
-			FString Method;
-			FString ArgsString;
-			Parameters.Split(TEXT("("), &Method, &ArgsString);
+			const FCultureRef Culture = FInternationalization::Get().GetCurrentCulture();
+			{
+				FReadScopeLock ReadLock(Lock);
+				const FEntry* Entry = Culture->GetName() == EntriesCulture ? Entries.Find(SourceName) : nullptr;
+				if (Entry && Entry->bLocalized[bValue])
+					return Entry->Strings[bValue];
+			}
 
-			ArgsString.RemoveFromEnd(TEXT(")"));
-			TArray<FString> Args;
-			ArgsString.ParseIntoArray(Args, TEXT(","), true);
+			FString Localized = Localize();
 
-			// Execute the method
-			return ExecuteMethod(Outer, FText::FromString(Method), Args);
+			FWriteScopeLock WriteLock(Lock);
+			if (Culture->GetName() != EntriesCulture || Entries.Num() >= MaxEntries)
+			{
+				Entries.Reset();
+				EntriesCulture = Culture->GetName();
+			}
+
+			FEntry& Entry = Entries.FindOrAdd(SourceName);
+			Entry.Strings[bValue] = Localized;
+			Entry.bLocalized[bValue] = true;
+			return Localized;
 		}
+
+	private:
+		static constexpr int32 MaxEntries = 4096;
+
+		struct FEntry
+		{
+			FString Strings[2];
+			bool bLocalized[2] = {false, false};
+		};
+
+		TMap<FString, FEntry, FDefaultSetAllocator, TCaseSensitiveKeyFuncs<FEntry>> Entries;
+		FString EntriesCulture;
+		FRWLock Lock;
+	};
+
+	FArticyBooleanStrings BooleanStrings;
+
+	// Append a formatted string without a temporary where the engine allows it
+	template<typename FmtType, typename... Types>
+	void AppendFormatted(FString& Out, const FmtType& Fmt, Types... Args)
+	{
+#if ENGINE_MAJOR_VERSION >= 5
+		Out.Appendf(Fmt, Args...);
+#else
+		Out += FString::Printf(Fmt, Args...);
+#endif
 	}
-	else
+
+	/** A text resolved in a culture against one GV instance. */
+	struct FResolvedTextKey
 	{
-		// No source
+		FString Text;
+		FString Culture;
+		TWeakObjectPtr<const UArticyGlobalVariables> GVs;
+
+		bool operator==(const FResolvedTextKey& Other) const
+		{
+			return GVs == Other.GVs && Text.Equals(Other.Text, ESearchCase::CaseSensitive) && Culture == Other.Culture;
+		}
+
+		friend uint32 GetTypeHash(const FResolvedTextKey& Key)
+		{
+			return HashCombine(HashCombine(FCrc::StrCrc32(*Key.Text), GetTypeHash(Key.Culture)), GetTypeHash(Key.GVs));
+		}
+	};
+
+	/** The result of a resolve, with everything it read. */
+	struct FResolvedText
+	{
+		FText Text;
+		FArticyGvReadSet Reads;
+		bool bReadObjects = false;
+		uint32 ObjectStateVersion = 0;
+
+		// The result is still valid if none of the variables or objects it read changed since
+		bool IsUpToDate() const
+		{
+			if (bReadObjects && ObjectStateVersion != UArticyDatabase::GetObjectStateVersion())
+				return false;
+
+			for (const auto& Read : Reads.Variables)
+			{
+				const UArticyVariable* Variable = Read.Key.Get();
+				if (!Variable || Variable->GetChangeVersion() != Read.Value)
+					return false;
+			}
+
+			return true;
+		}
+	};
+
+	/** The results of ResolveCached, only accessed on the game thread. */
+	TMap<FResolvedTextKey, FResolvedText> ResolvedTexts;
+
+	/** The resolved texts are cleared once they reach this number, see ResolvedTexts. */
+	constexpr int32 MaxResolvedTexts = 4096;
+
+	// Concatenate the segments of a template into one pre-sized string
+	FString BuildText(const FArticyTextTemplate& Template, const TArray<FString>& Args, FArticyTokenResolver ResolveToken)
+	{
+		using EType = FArticyTextTemplate::FSegment::EType;
+
+		// evaluate the tokens first, so the length of the result is known
+		TArray<FString, TInlineAllocator<8>> TokenValues;
+		int32 Length = Template.LiteralLength;
+		for (const auto& Segment : Template.Segments)
+		{
+			if (Segment.Type == EType::Token)
+				Length += TokenValues.Add_GetRef(ResolveToken(Segment)).Len();
+			else if (Segment.Type == EType::Placeholder)
+				Length += Args.IsValidIndex(Segment.ArgIndex) ? Args[Segment.ArgIndex].Len() : Segment.Text.Len();
+		}
+
+		FString Result;
+		Result.Reserve(Length);
+
+		int32 NextToken = 0;
+		for (const auto& Segment : Template.Segments)
+		{
+			switch (Segment.Type)
+			{
+			case EType::Literal:
+				Result += Segment.Text;
+				break;
+			case EType::Placeholder:
+				// placeholders without an argument are kept as they are
+				Result += Args.IsValidIndex(Segment.ArgIndex) ? Args[Segment.ArgIndex] : Segment.Text;
+				break;
+			case EType::Token:
+				Result += TokenValues[NextToken++];
+				break;
+			}
+		}
+
 		return Result;
 	}
+}
+
+// Split a text into literals, placeholders and tokens
+FArticyTextTemplate FArticyTextTemplate::Parse(const FString& Source)
+{
+	FArticyTextTemplate Template;
+	FString Literal;
+
+	const auto FlushLiteral = [&]()
+	{
+		if (Literal.IsEmpty())
+			return;
+
+		Template.LiteralLength += Literal.Len();
+		Template.Segments.AddDefaulted_GetRef().Text = MoveTemp(Literal);
+		Literal.Reset();
+	};
+
+	// an unclosed token ends the token replacement, the rest of the text is kept as it is
+	bool bTokensEnded = false;
 
-	if (SourceParts.Num() > 1)
+	const int32 Len = Source.Len();
+	int32 Index = 0;
+	while (Index < Len)
 	{
-		for (int32 Index = 1; Index < SourceParts.Num(); ++Index)
+		const TCHAR Char = Source[Index];
+		if (Char == TEXT('{'))
+		{
+			// {N}, without leading zeros
+			int32 End = Index + 1;
+			while (End < Len && FChar::IsDigit(Source[End]))
+				++End;
+
+			const int32 NumDigits = End - Index - 1;
+			if (NumDigits > 0 && End < Len && Source[End] == TEXT('}') && (NumDigits == 1 || Source[Index + 1] != TEXT('0')))
+			{
+				FlushLiteral();
+
+				FSegment& Segment = Template.Segments.AddDefaulted_GetRef();
+				Segment.Type = FSegment::EType::Placeholder;
+				Segment.Text = Source.Mid(Index, NumDigits + 2);
+				Segment.ArgIndex = FCString::Atoi(*Source.Mid(Index + 1, NumDigits));
+				++Template.NumPlaceholders;
+
+				Index = End + 1;
+				continue;
+			}
+		}
+		else if (Char == TEXT('[') && !bTokensEnded)
 		{
-			if (!RemValue.IsEmpty())
+			const int32 End = Source.Find(TEXT("]"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Index);
+			if (End == INDEX_NONE)
+			{
+				bTokensEnded = true;
+			}
+			else
 			{
-				RemValue += TEXT(".");
+				const FString Token = Source.Mid(Index + 1, End - Index - 1);
+				FString SourceName, Formatting;
+
+				Token.Split(TEXT(":"), &SourceName, &Formatting);
+				if (SourceName.IsEmpty())
+				{
+					SourceName = Token;
+				}
+
+				Template.bPlaceholderInToken |= Token.Contains(TEXT("{"));
+
+				// invalid tokens with an empty source name are removed
+				if (!SourceName.IsEmpty())
+				{
+					FlushLiteral();
+
+					FSegment& Segment = Template.Segments.AddDefaulted_GetRef();
+					Segment.Type = FSegment::EType::Token;
+					Segment.Text = MoveTemp(SourceName);
+					Segment.Formatting = MoveTemp(Formatting);
+					Segment.Source = Sources.FindOrAdd(Segment.Text, &FArticyTextSource::Compile);
+				}
+
+				Index = End + 1;
+				continue;
 			}
-			RemValue += SourceParts[Index];
 		}
+
+		Literal.AppendChar(Char);
+		++Index;
+	}
+
+	FlushLiteral();
+	return Template;
+}
+
+// Resolve a text through its cached template, only the tokens get evaluated
+FString UArticyTextExtension::ResolveTemplate(const FString& Source, const TArray<FString>& Args, FArticyTokenResolver ResolveToken)
+{
+	const TSharedRef<const FArticyTextTemplate, ESPMode::ThreadSafe> Template = Templates.FindOrAdd(Source, &FArticyTextTemplate::Parse);
+
+	// tokens built from arguments, and arguments containing tokens or placeholders, need the arguments substituted before parsing
+	bool bSubstituteFirst = false;
+	if (Template->NumPlaceholders > 0 || Template->bPlaceholderInToken)
+	{
+		bSubstituteFirst = Template->bPlaceholderInToken && Args.Num() > 0;
+		for (int32 ArgIndex = 0; ArgIndex < Args.Num() && !bSubstituteFirst; ++ArgIndex)
+			bSubstituteFirst = Args[ArgIndex].Contains(TEXT("[")) || Args[ArgIndex].Contains(TEXT("{"));
+	}
+
+	if (!bSubstituteFirst)
+		return BuildText(*Template, Args, ResolveToken);
+
+	FString FormattedString = Source;
+	for (int32 ArgIndex = 0; ArgIndex < Args.Num(); ++ArgIndex)
+	{
+		const FString Placeholder = FString::Printf(TEXT("{%d}"), ArgIndex);
+		FormattedString.ReplaceInline(*Placeholder, *Args[ArgIndex]);
+	}
+
+	return BuildText(FArticyTextTemplate::Parse(FormattedString), TArray<FString>(), ResolveToken);
+}
+
+UArticyTextExtension* UArticyTextExtension::Get()
+{
+	static TWeakObjectPtr<UArticyTextExtension> ArticyTextExtension;
+
+	if (!ArticyTextExtension.IsValid())
+	{
+		ArticyTextExtension = TWeakObjectPtr<UArticyTextExtension>(NewObject<UArticyTextExtension>());
+	}
+
+	return ArticyTextExtension.Get();
+}
+
+// Split a token source into its parts
+FArticyTextSource FArticyTextSource::Compile(const FString& SourceName)
+{
+	FArticyTextSource Source;
+
+	// Split the SourceName by dots
+	TArray<FString> SourceParts;
+	SourceName.ParseIntoArray(SourceParts, TEXT("."));
+	if (SourceParts.Num() == 0)
+	{
+		// No source
+		return Source;
 	}
 
-	// Process types
-	if (SourceParts[0].StartsWith(TEXT("$Type.")))
+	FString Parameters;
+	FString RemValue;
+	for (int32 Index = 1; Index < SourceParts.Num(); ++Index)
 	{
-		const FString TypeName = SourceParts[0].Mid(6);
-		GetTypeProperty(TypeName, RemValue, Result, bSuccess);
-		
-		if (bSuccess)
+		if (!Parameters.IsEmpty())
 		{
-			return Result;
+			Parameters += TEXT(",");
+			RemValue += TEXT(".");
 		}
+		Parameters += SourceParts[Index];
+		RemValue += SourceParts[Index];
+	}
 
-		return SourceName;
+	// Methods
+	if (Parameters.Contains(TEXT("(")) && Parameters.Contains(TEXT(")")))
+	{
+		FString MethodName, ArgsString;
+		Parameters.Split(TEXT("("), &MethodName, &ArgsString);
+
+		ArgsString.RemoveFromEnd(TEXT(")"));
+		ArgsString.ParseIntoArray(Source.Args, TEXT(","), true);
+
+		Source.Method = FName(*MethodName);
+		if (MethodName == TEXT("if"))
+			Source.MethodKind = EMethod::If;
+		else if (MethodName == TEXT("not"))
+			Source.MethodKind = EMethod::Not;
+
+		Source.Kind = EKind::Method;
+		return Source;
 	}
 
-	// Process Global Variables
-	const FArticyGvName GvName = FArticyGvName(FName(SourceParts[0]), FName(RemValue));
-	GetGlobalVariable(Outer, SourceName, GvName, Result, bSuccess);
-	if (bSuccess)
+	// Types, $Type.TypeName.Property
+	if (SourceParts[0] == TEXT("$Type") && SourceParts.Num() > 1)
 	{
-		return Result;
+		Source.TypeName = SourceParts[1];
+		Source.PropertyName = RemValue.Mid(Source.TypeName.Len() + 1);
+		Source.Kind = EKind::TypeProperty;
+		return Source;
 	}
 
+	// Global Variables, or Objects & Script Properties
+	Source.Kind = EKind::Variable;
+	Source.GvName = FArticyGvName(FName(SourceParts[0]), FName(RemValue));
+
 	// Type for object
-	bool bRequestType = false;
 	if (RemValue.EndsWith(TEXT(".$Type")))
 	{
 		RemValue = RemValue.Left(RemValue.Len() - 6);
-		bRequestType = true;
+		Source.bRequestType = true;
 	}
+	Source.PropertyName = RemValue;
 
-	// Process Objects & Script Properties
-	GetObjectProperty(Outer, SourceName, SourceParts[0], RemValue, bRequestType, Result, bSuccess);
-	if (bSuccess)
+	const FString& NameOrId = SourceParts[0];
+	FString ObjectName, ObjectInstance;
+	UArticyTextExtension::SplitInstance(NameOrId, ObjectName, ObjectInstance);
+	Source.CloneId = FCString::Atoi(*ObjectInstance);
+	if (NameOrId.StartsWith(TEXT("0x")))
 	{
-		return Result;
+		Source.bById = true;
+		Source.ObjectId = FArticyId{ArticyHelpers::HexToUint64(ObjectName)};
 	}
-	
-	return SourceName;
+	else if (NameOrId.IsNumeric())
+	{
+		Source.bById = true;
+		Source.ObjectId = FArticyId{FCString::Strtoui64(*ObjectName, nullptr, 10)};
+	}
+	else
+	{
+		Source.ObjectName = *ObjectName;
+	}
+
+	return Source;
 }
 
-// Process SourceValue with NumberFormat according to C# Custom Number Formatting rules
-FString UArticyTextExtension::FormatNumber(const FString& SourceValue, const FString& NumberFormat) const
+// Resolve a text, reusing the last result while the variables and objects it read are unchanged
+FText UArticyTextExtension::ResolveCached(UObject* Outer, const FText* Format)
 {
-	double Value;
-	// Handle booleans
-	if (SourceValue.Equals(TEXT("true")))
+	SCOPE_CYCLE_COUNTER(STAT_ArticyResolveText);
+
+	if (Format == nullptr)
 	{
-		Value = 1.f;
+		return FText::GetEmpty();
 	}
-	else if (SourceValue.Equals(TEXT("false")))
+
+	UArticyGlobalVariables* GVs = nullptr;
+	if (IsInGameThread() && GEngine && GEngine->GetWorldFromContextObject(Outer, EGetWorldErrorMode::ReturnNull))
 	{
-		Value = 0.f;
+		if (UArticyDatabase* DB = UArticyDatabase::Get(Outer))
+			GVs = DB->GetGVs();
 	}
-	else
+
+	// shadow states don't change the versions, and another recorder (e.g. of an exploration) needs to see the reads
+	if (!GVs || GVs->GetShadowLevel() > 0 || GVs->GetReadRecorder() || ReadRecorder)
 	{
-		Value = FCString::Atof(*SourceValue);
+		return Resolve(Outer, Format);
 	}
-	
-	FString FormattedValue;
 
-	int32 FormatIndex = 0;
+	FResolvedTextKey Key{Format->ToString(), FInternationalization::Get().GetCurrentCulture()->GetName(), GVs};
+	if (const FResolvedText* Cached = ResolvedTexts.Find(Key))
+	{
+		if (Cached->IsUpToDate())
+			return Cached->Text;
+	}
+
+	FResolvedText Entry;
+	Entry.ObjectStateVersion = UArticyDatabase::GetObjectStateVersion();
+
+	FArticyTextReadSet TextReads;
+	ReadRecorder = &TextReads;
+	GVs->SetReadRecorder(&Entry.Reads);
+	Entry.Text = Resolve(Outer, Format);
+	GVs->SetReadRecorder(nullptr);
+	ReadRecorder = nullptr;
+
+	const FText Result = Entry.Text;
+	if (TextReads.bCalledUserMethods)
+	{
+		// user methods may depend on anything
+		ResolvedTexts.Remove(Key);
+		return Result;
+	}
+
+	Entry.bReadObjects = TextReads.bReadObjects;
+	if (ResolvedTexts.Num() >= MaxResolvedTexts)
+		ResolvedTexts.Reset();
+
+	ResolvedTexts.Add(MoveTemp(Key), MoveTemp(Entry));
+	return Result;
+}
+
+// Retrieve string from specified source, the source is compiled the first time it is used
+FString UArticyTextExtension::GetSource(UObject* Outer, const FString& SourceName) const
+{
+	return GetSource(Outer, SourceName, *Sources.FindOrAdd(SourceName, &FArticyTextSource::Compile));
+}
+
+// Retrieve string from the source of a token, which its template compiled when it was parsed
+FString UArticyTextExtension::GetSource(UObject* Outer, const FArticyTextTemplate::FSegment& Token) const
+{
+	if (Token.Source)
+	{
+		return GetSource(Outer, Token.Text, *Token.Source);
+	}
+
+	return GetSource(Outer, Token.Text);
+}
+
+// Retrieve string from a compiled source
+FString UArticyTextExtension::GetSource(UObject* Outer, const FString& SourceName, const FArticyTextSource& Source) const
+{
+	FString Result;
+	bool bSuccess = false;
+
+	switch (Source.Kind)
+	{
+	case FArticyTextSource::EKind::Method:
+		{
+			// Execute the method
+			return ExecuteMethod(Outer, Source);
+		}
+	case FArticyTextSource::EKind::TypeProperty:
+		{
+			GetTypeProperty(Source.TypeName, Source.PropertyName, Result, bSuccess);
+			return bSuccess ? Result : SourceName;
+		}
+	case FArticyTextSource::EKind::Variable:
+		{
+			// Process Global Variables
+			GetGlobalVariable(Outer, SourceName, Source.GvName, Result, bSuccess);
+			if (bSuccess)
+			{
+				return Result;
+			}
 
+			// Process Objects & Script Properties
+			GetObjectProperty(Outer, SourceName, Source, Result, bSuccess);
+			return bSuccess ? Result : SourceName;
+		}
+	default:
+		{
+			// No source
+			return Result;
+		}
+	}
+}
+
+// Split a number format into the pieces printed by FormatNumber
+FArticyNumberFormat FArticyNumberFormat::Compile(const FString& NumberFormat)
+{
+	FArticyNumberFormat Format;
+
+	int32 FormatIndex = 0;
 	while (FormatIndex < NumberFormat.Len())
 	{
 		const TCHAR CurrentChar = NumberFormat[FormatIndex];
@@ -147,7 +645,7 @@ FString UArticyTextExtension::FormatNumber(const FString& SourceValue, const FSt
 			while (FormatIndex + ZeroCount < NumberFormat.Len() && NumberFormat[FormatIndex + ZeroCount] == '0')
 				ZeroCount++;
 
-			FormattedValue += FString::Printf(TEXT("%0*lld"), ZeroCount, FMath::RoundToInt(Value));
+			Format.Pieces.Add({EOp::Integer, ZeroCount});
 			FormatIndex += ZeroCount;
 		}
 		else if (CurrentChar == '#')
@@ -156,7 +654,7 @@ FString UArticyTextExtension::FormatNumber(const FString& SourceValue, const FSt
 			while (FormatIndex + DigitCount < NumberFormat.Len() && NumberFormat[FormatIndex + DigitCount] == '#')
 				DigitCount++;
 
-			FormattedValue += FString::Printf(TEXT("%.*f"), DigitCount, Value);
+			Format.Pieces.Add({EOp::Fraction, DigitCount});
 			FormatIndex += DigitCount;
 		}
 		else if (CurrentChar == '.')
@@ -165,21 +663,69 @@ FString UArticyTextExtension::FormatNumber(const FString& SourceValue, const FSt
 			while (FormatIndex + FractionalPartCount < NumberFormat.Len() && NumberFormat[FormatIndex + FractionalPartCount] == '#')
 				FractionalPartCount++;
 
-			FormattedValue += FString::Printf(TEXT("%.*f"), FractionalPartCount, Value);
+			Format.Pieces.Add({EOp::Fraction, FractionalPartCount});
 			FormatIndex += FractionalPartCount;
 		}
 		else
 		{
-			FormattedValue += CurrentChar;
+			// consecutive literal characters are printed at once
+			if (Format.Pieces.Num() == 0 || Format.Pieces.Last().Op != EOp::Literal)
+				Format.Pieces.AddDefaulted();
+
+			Format.Pieces.Last().Text.AppendChar(CurrentChar);
 			FormatIndex++;
 		}
 	}
 
+	return Format;
+}
+
+// Process SourceValue with NumberFormat according to C# Custom Number Formatting rules
+FString UArticyTextExtension::FormatNumber(const FString& SourceValue, const FString& NumberFormat) const
+{
+	FString FormattedValue;
+	FormatNumber(SourceValue, NumberFormat, FormattedValue);
 	return FormattedValue;
 }
 
+// Append SourceValue formatted with NumberFormat to OutFormatted, the format is compiled the first time it is used
+void UArticyTextExtension::FormatNumber(const FString& SourceValue, const FString& NumberFormat, FString& OutFormatted) const
+{
+	double Value;
+	// Handle booleans
+	if (SourceValue.Equals(TEXT("true")))
+	{
+		Value = 1.f;
+	}
+	else if (SourceValue.Equals(TEXT("false")))
+	{
+		Value = 0.f;
+	}
+	else
+	{
+		Value = FCString::Atof(*SourceValue);
+	}
+
+	const TSharedRef<const FArticyNumberFormat, ESPMode::ThreadSafe> Format = NumberFormats.FindOrAdd(NumberFormat, &FArticyNumberFormat::Compile);
+	for (const FArticyNumberFormat::FPiece& Piece : Format->Pieces)
+	{
+		switch (Piece.Op)
+		{
+		case FArticyNumberFormat::EOp::Integer:
+			AppendFormatted(OutFormatted, TEXT("%0*lld"), Piece.Count, static_cast<long long>(FMath::RoundToDouble(Value)));
+			break;
+		case FArticyNumberFormat::EOp::Fraction:
+			AppendFormatted(OutFormatted, TEXT("%.*f"), Piece.Count, Value);
+			break;
+		case FArticyNumberFormat::EOp::Literal:
+			OutFormatted += Piece.Text;
+			break;
+		}
+	}
+}
+
 // Process Global Variables
-void UArticyTextExtension::GetGlobalVariable(UObject* Outer, const FString& SourceName, FArticyGvName GvName, FString& OutString, bool& OutSuccess) const
+void UArticyTextExtension::GetGlobalVariable(UObject* Outer, const FString& SourceName, const FArticyGvName& GvName, FString& OutString, bool& OutSuccess) const
 {
 	const auto& WorldContext = GEngine->GetWorldFromContextObject(Outer, EGetWorldErrorMode::ReturnNull);
 	if (!WorldContext)
@@ -192,33 +738,27 @@ void UArticyTextExtension::GetGlobalVariable(UObject* Outer, const FString& Sour
 
 	const auto& DB = UArticyDatabase::Get(Outer);
 	const auto& GlobalVariables = DB->GetGVs();
-	const auto& Set = GlobalVariables->GetNamespace(GvName.GetNamespace());
-	if (!Set)
-	{
-		OutSuccess = false;
-		return;
-	}
-	
-	UArticyVariable** Variable = Set->GetPropPtr<UArticyVariable*>(GvName.GetVariable());
+
+	// the name caches the index of the variable, so this is an array access after the first resolve
+	const UArticyVariable* Variable = GlobalVariables->GetVariableByIndex(GlobalVariables->GetVariableIndex(GvName));
 	switch (GetObjectType(Variable))
 	{
 	case EArticyObjectType::UArticyBool:
 		{
-			const auto boolValue = GlobalVariables->GetBoolVariable(GvName, OutSuccess);
-			if (OutSuccess)
-			{
-				OutString = ResolveBoolean(Outer, SourceName, boolValue);
-			}
+			OutString = ResolveBoolean(Outer, SourceName, static_cast<const UArticyBool*>(Variable)->Get());
+			OutSuccess = true;
 			break;
 		}
 	case EArticyObjectType::UArticyInt:
 		{
-			OutString = FString::FromInt(GlobalVariables->GetIntVariable(GvName, OutSuccess));
+			OutString = FString::FromInt(static_cast<const UArticyInt*>(Variable)->Get());
+			OutSuccess = true;
 			break;
 		}
 	case EArticyObjectType::UArticyString:
 		{
-			OutString = GlobalVariables->GetStringVariable(GvName, OutSuccess);
+			OutString = static_cast<const UArticyString*>(Variable)->Get();
+			OutSuccess = true;
 			break;
 		}
 	default:
@@ -229,7 +769,7 @@ void UArticyTextExtension::GetGlobalVariable(UObject* Outer, const FString& Sour
 	}
 }
 
-void UArticyTextExtension::GetObjectProperty(UObject* Outer, const FString& SourceName, const FString& NameOrId, const FString& PropertyName, const bool bRequestType, FString& OutString, bool& OutSuccess) const
+void UArticyTextExtension::GetObjectProperty(UObject* Outer, const FString& SourceName, const FArticyTextSource& Source, FString& OutString, bool& OutSuccess) const
 {
 	const auto& WorldContext = GEngine->GetWorldFromContextObject(Outer, EGetWorldErrorMode::ReturnNull);
 	if (!WorldContext)
@@ -242,30 +782,23 @@ void UArticyTextExtension::GetObjectProperty(UObject* Outer, const FString& Sour
 
 	// Get the object
 	const auto& DB = UArticyDatabase::Get(this);
-	UArticyObject* Object;
-
-	FString ObjectName, ObjectInstance;
-	SplitInstance(NameOrId, ObjectName, ObjectInstance);
-	if (NameOrId.StartsWith(TEXT("0x")))
-	{
-		Object = DB->GetObject<UArticyObject>(FArticyId{ArticyHelpers::HexToUint64(ObjectName)}, FCString::Atod(*ObjectInstance));
-	}
-	else if (NameOrId.IsNumeric())
-	{
-		Object = DB->GetObject<UArticyObject>(FArticyId{FCString::Strtoui64(*ObjectName, nullptr, 10)}, FCString::Atod(*ObjectInstance));
-	}
-	else
+	if (ReadRecorder)
 	{
-		Object = DB->GetObjectByName(*ObjectName, FCString::Atod(*ObjectInstance));
+		ReadRecorder->bReadObjects = true;
 	}
 
+	UArticyObject* Object = Source.bById
+		? DB->GetObject<UArticyObject>(Source.ObjectId, Source.CloneId)
+		: DB->GetObjectByName(Source.ObjectName, Source.CloneId);
+	const FString& PropertyName = Source.PropertyName;
+
 	if (!Object)
 	{
 		OutSuccess = false;
 		return;
 	}
 
-	if (bRequestType)
+	if (Source.bRequestType)
 	{
 		OutString = Object->ArticyType.GetProperty(PropertyName).PropertyType;
 		OutSuccess = true;
@@ -299,6 +832,12 @@ void UArticyTextExtension::GetObjectProperty(UObject* Outer, const FString& Sour
 			OutSuccess = true;
 			break;
 		}
+	case ExpressoType::Object:
+		{
+			OutString = PropertyType.ToString();
+			OutSuccess = true;
+			break;
+		}
 	default:
 		{
 			OutSuccess = false;
@@ -309,85 +848,76 @@ void UArticyTextExtension::GetObjectProperty(UObject* Outer, const FString& Sour
 void UArticyTextExtension::GetTypeProperty(const FString& TypeName, const FString& PropertyName, FString& OutString,
 	bool& OutSuccess)
 {
-	UArticyTypeSystem* TypeSystem = UArticyTypeSystem::Get();
-	FArticyType TypeData = TypeSystem->GetArticyType(TypeName);
-	FArticyPropertyInfo PropertyInfo{};
-	bool bFoundProperty = false;
-	
-	for (const auto& Property : TypeData.Properties)
-	{
-		if (Property.TechnicalName.Equals(PropertyName))
-		{
-			PropertyInfo = Property;
-			bFoundProperty = true;
-			break;
-		}
-	}
-
-	if (!bFoundProperty)
+	const FArticyType* TypeData = UArticyTypeSystem::Get()->FindArticyType(TypeName);
+	const FArticyPropertyInfo* PropertyInfo = TypeData ? TypeData->FindPropertyByTechnicalName(PropertyName) : nullptr;
+	if (!PropertyInfo)
 	{
 		OutSuccess = false;
 		return;
 	}
 
-	OutString = PropertyInfo.PropertyType;
+	OutString = PropertyInfo->PropertyType;
 	OutSuccess = true;
 }
 
-FString UArticyTextExtension::ExecuteMethod(UObject* Outer, const FText& Method, const TArray<FString>& Args) const
+// Execute a built-in or user method, dispatched by the kind and interned name compiled into the source
+FString UArticyTextExtension::ExecuteMethod(UObject* Outer, const FArticyTextSource& Source) const
 {
-	if (Method.ToString() == TEXT("if"))
+	const TArray<FString>& Args = Source.Args;
+	switch (Source.MethodKind)
 	{
-		if (Args.Num() >= 3)
+	case FArticyTextSource::EMethod::If:
+	case FArticyTextSource::EMethod::Not:
 		{
-			const FText& ResolveString = FText::FromString(Args[0]);
-			const FText& ResolveResult = Resolve(Outer, &ResolveString, *Args[1], TEXT("0"));
-            
-			if (ResolveResult.ToString() == TEXT("1"))
+			if (Args.Num() < 3)
 			{
-				return Args[2];
+				return TEXT("");
 			}
-			return Args[3];
+
+			// if returns the third argument when the condition resolves to 1 and the fourth otherwise, not the other way round
+			const bool bConditionMet = ResolveCondition(Outer, Args[0], Args[1]) == TEXT("1");
+			const int32 ResultIndex = bConditionMet == (Source.MethodKind == FArticyTextSource::EMethod::If) ? 2 : 3;
+			return Args.IsValidIndex(ResultIndex) ? Args[ResultIndex] : FString();
 		}
-	}
-	else if (Method.ToString() == TEXT("not"))
-	{
-		if (Args.Num() >= 3)
+	default:
 		{
-			const FText& ResolveString = FText::FromString(Args[0]);
-			const FText& ResolveResult = Resolve(Outer, &ResolveString, *Args[1], TEXT("0"));
-            
-			if (ResolveResult.ToString() == TEXT("1"))
+			if (const FArticyUserMethodCallback* Callback = UserMethodMap.Find(Source.Method))
 			{
-				return Args[3];
+				if (ReadRecorder)
+				{
+					ReadRecorder->bCalledUserMethods = true;
+				}
+				return (*Callback)(Args);
 			}
-			return Args[2];
+			return TEXT("");
 		}
 	}
-	else
+}
+
+// Resolve the condition of if and not with its value as argument {0}, without going through FText
+FString UArticyTextExtension::ResolveCondition(UObject* Outer, const FString& Condition, const FString& Value) const
+{
+	const TArray<FString> ArgumentValues = {Value, TEXT("0")};
+
+	return ResolveTemplate(Condition, ArgumentValues, [&](const FArticyTextTemplate::FSegment& Token)
 	{
-		if (UserMethodMap.Contains(Method.ToString()))
-		{
-			const FArticyUserMethodCallback Callback = UserMethodMap[Method.ToString()];
-			return Callback(Args);
-		}
-	}
-    
-	return TEXT("");
+		const FString SourceValue = GetSource(Outer, Token);
+		return Token.Formatting.IsEmpty() ? SourceValue : FormatNumber(SourceValue, Token.Formatting);
+	});
 }
 
-EArticyObjectType UArticyTextExtension::GetObjectType(UArticyVariable** Object) const
+EArticyObjectType UArticyTextExtension::GetObjectType(const UArticyVariable* Object) const
 {
 	// TODO: Use type system
-	if (Cast<UArticyBool>(*Object))
+	if (Cast<UArticyBool>(Object))
 	{
 		return EArticyObjectType::UArticyBool;
 	}
-	if (Cast<UArticyInt>(*Object))
+	if (Cast<UArticyInt>(Object))
 	{
 		return EArticyObjectType::UArticyInt;
 	}
-	if (Cast<UArticyString>(*Object))
+	if (Cast<UArticyString>(Object))
 	{
 		return EArticyObjectType::UArticyString;
 	}
@@ -395,7 +925,13 @@ EArticyObjectType UArticyTextExtension::GetObjectType(UArticyVariable** Object)
 	return EArticyObjectType::Other;
 }
 
+// Localize a boolean by its source name or the variable constants, once per culture
 FString UArticyTextExtension::ResolveBoolean(UObject* Outer, const FString &SourceName, const bool Value) const
+{
+	return BooleanStrings.FindOrAdd(SourceName, Value, [&]() { return LocalizeBoolean(Outer, SourceName, Value); });
+}
+
+FString UArticyTextExtension::LocalizeBoolean(UObject* Outer, const FString &SourceName, const bool Value) const
 {
 	FString SourceValue;
 	FString SourceInput[2];
@@ -472,6 +1008,6 @@ void UArticyTextExtension::SplitInstance(const FString& InString, FString& OutNa
 
 void UArticyTextExtension::AddUserMethod(const FString& MethodName, const FArticyUserMethodCallback Callback)
 {
-	// Add the callback to the user method map
-	UserMethodMap.Add(MethodName, Callback);
+	// Add the callback to the user method map, the name is interned once here
+	UserMethodMap.Add(FName(*MethodName), Callback);
 }
@@ -5,7 +5,20 @@
 #include "ArticyType.h"
 #include "ArticyHelpers.h"
 
-FArticyEnumValueInfo FArticyType::GetEnumValue(int Value) const
+namespace
+{
+	const FArticyEnumValueInfo EmptyEnumValue;
+	const FArticyPropertyInfo EmptyProperty;
+
+	/** Looks a property up by name, the match must be exact as the lookup ignores the case. */
+	const FArticyPropertyInfo* FindInLookup(const TArray<FArticyPropertyInfo>& Properties, const TMap<FString, int32>& Lookup, const FString& Name, FString FArticyPropertyInfo::* Key)
+	{
+		const int32* Index = Lookup.Find(Name);
+		return Index && (Properties[*Index].*Key).Equals(Name) ? &Properties[*Index] : nullptr;
+	}
+}
+
+const FArticyEnumValueInfo& FArticyType::GetEnumValue(int Value) const
 {
 	for (const auto& EnumInfo : EnumValues)
 	{
@@ -14,10 +27,10 @@ FArticyEnumValueInfo FArticyType::GetEnumValue(int Value) const
 			return EnumInfo;
 		}
 	}
-	return {};
+	return EmptyEnumValue;
 }
 
-FArticyEnumValueInfo FArticyType::GetEnumValue(const FString& ValueName) const
+const FArticyEnumValueInfo& FArticyType::GetEnumValue(const FString& ValueName) const
 {
 	for (const auto& EnumInfo : EnumValues)
 	{
@@ -26,7 +39,7 @@ FArticyEnumValueInfo FArticyType::GetEnumValue(const FString& ValueName) const
 			return EnumInfo;
 		}
 	}
-	return {};
+	return EmptyEnumValue;
 }
 
 FString FArticyType::GetFeatureDisplayName(UObject* Outer, const FString& FeatureName) const
@@ -39,27 +52,78 @@ FString FArticyType::GetFeatureDisplayNameLocaKey(const FString& FeatureName) co
 	return FeatureName;
 }
 
-TArray<FArticyPropertyInfo> FArticyType::GetProperties() const
-{
-	return Properties;
-}
-
 TArray<FArticyPropertyInfo> FArticyType::GetPropertiesInFeature(const FString& FeatureName) const
 {
 	// TODO: Implement this functionality
 	return {};
 }
 
-FArticyPropertyInfo FArticyType::GetProperty(const FString& PropertyName) const
+const FArticyPropertyInfo& FArticyType::GetProperty(const FString& PropertyName) const
 {
+	const FArticyPropertyInfo* PropertyInfo = FindProperty(PropertyName);
+	return PropertyInfo ? *PropertyInfo : EmptyProperty;
+}
+
+const FArticyPropertyInfo* FArticyType::FindProperty(const FString& PropertyName) const
+{
+	if (bLookupsBuilt)
+	{
+		return FindInLookup(Properties, PropertiesByLocaKey, PropertyName, &FArticyPropertyInfo::LocaKey_DisplayName);
+	}
+
 	for (const auto& PropertyInfo : Properties)
 	{
 		if (PropertyInfo.LocaKey_DisplayName.Equals(PropertyName))
 		{
-			return PropertyInfo;
+			return &PropertyInfo;
 		}
 	}
-	return {};
+	return nullptr;
+}
+
+const FArticyPropertyInfo* FArticyType::FindPropertyByTechnicalName(const FString& PropertyName) const
+{
+	if (bLookupsBuilt)
+	{
+		return FindInLookup(Properties, PropertiesByTechnicalName, PropertyName, &FArticyPropertyInfo::TechnicalName);
+	}
+
+	for (const auto& PropertyInfo : Properties)
+	{
+		if (PropertyInfo.TechnicalName.Equals(PropertyName))
+		{
+			return &PropertyInfo;
+		}
+	}
+	return nullptr;
+}
+
+void FArticyType::BuildLookups()
+{
+	PropertiesByLocaKey.Reset();
+	PropertiesByTechnicalName.Reset();
+
+	// The first property of a name wins, like the search does
+	for (int32 Index = 0; Index < Properties.Num(); ++Index)
+	{
+		if (!PropertiesByLocaKey.Contains(Properties[Index].LocaKey_DisplayName))
+		{
+			PropertiesByLocaKey.Add(Properties[Index].LocaKey_DisplayName, Index);
+		}
+		if (!PropertiesByTechnicalName.Contains(Properties[Index].TechnicalName))
+		{
+			PropertiesByTechnicalName.Add(Properties[Index].TechnicalName, Index);
+		}
+	}
+	bLookupsBuilt = true;
+}
+
+void FArticyType::PostSerialize(const FArchive& Ar)
+{
+	if (Ar.IsLoading())
+	{
+		BuildLookups();
+	}
 }
 
 FString FArticyType::GetDisplayName(UObject* Outer)
@@ -74,6 +138,7 @@ FString FArticyType::LocalizeString(UObject* Outer, const FString& Input)
 
 void FArticyType::MergeChild(const FArticyType& Child)
 {
+	bLookupsBuilt = false;
 	HasTemplate |= Child.HasTemplate;
 	IsEnum |= Child.IsEnum;
 	if (!Child.CPPType.IsEmpty())
@@ -104,6 +169,7 @@ void FArticyType::MergeChild(const FArticyType& Child)
 
 void FArticyType::MergeParent(const FArticyType& Parent)
 {
+	bLookupsBuilt = false;
 	HasTemplate |= Parent.HasTemplate;
 	IsEnum |= Parent.IsEnum;
 	if (CPPType.IsEmpty())
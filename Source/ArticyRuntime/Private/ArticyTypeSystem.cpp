@@ -21,10 +21,11 @@ UArticyTypeSystem* UArticyTypeSystem::Get()
 
 FArticyType UArticyTypeSystem::GetArticyType(const FString& TypeName) const
 {
-	if (Types.Contains(TypeName))
-	{
-		return Types[TypeName];
-	}
+	const FArticyType* Type = FindArticyType(TypeName);
+	return Type ? *Type : FArticyType();
+}
 
-	return {};
+void UArticyTypeSystem::AddType(const FString& TypeName, const FArticyType& Type)
+{
+	Types.Add(TypeName, Type).BuildLookups();
 }
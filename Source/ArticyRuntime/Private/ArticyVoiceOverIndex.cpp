@@ -0,0 +1,74 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "ArticyVoiceOverIndex.h"
+#include "Internationalization/Culture.h"
+#include "Internationalization/Internationalization.h"
+
+/**
+ * Returns the voice over asset of a text in the current culture.
+ * The table of the culture is selected once per culture switch: the one of the locale, otherwise one of the same
+ * language, otherwise none, so only the invariant table is used.
+ * @param TextKey The key of the text.
+ * @return The object path of the asset, or nullptr if the text has no indexed voice over.
+ */
+const FSoftObjectPath* FArticyVoiceOverIndex::Find(const FString& TextKey) const
+{
+	if (Cultures.Num() == 0)
+		return nullptr;
+
+	const FCultureRef Culture = FInternationalization::Get().GetCurrentCulture();
+	if (ActiveCulture.Get() != &Culture.Get())
+	{
+		ActiveCulture = Culture;
+		ActiveTable.Reset();
+
+		const FString& LocaleName = Culture->GetName();
+		if (Cultures.Contains(LocaleName))
+		{
+			ActiveTable = LocaleName;
+		}
+		else
+		{
+			const FString LangName = Culture->GetTwoLetterISOLanguageName();
+			for (const auto& Table : Cultures)
+			{
+				if (!Table.Key.IsEmpty() && Table.Key.Left(2) == LangName)
+				{
+					ActiveTable = Table.Key;
+					break;
+				}
+			}
+		}
+	}
+
+	if (!ActiveTable.IsEmpty())
+	{
+		if (const FSoftObjectPath* Path = Cultures.FindChecked(ActiveTable).Paths.Find(TextKey))
+			return Path;
+	}
+
+	const FArticyVoiceOverTable* Invariant = Cultures.Find(FString());
+	return Invariant ? Invariant->Paths.Find(TextKey) : nullptr;
+}
+
+/**
+ * Adds the voice over asset of a text, unless the culture would store the same one as the invariant culture.
+ * @param Culture The culture, empty for the invariant one.
+ * @param TextKey The key of the text.
+ * @param Path The object path of the asset.
+ */
+void FArticyVoiceOverIndex::Add(const FString& Culture, const FString& TextKey, const FSoftObjectPath& Path)
+{
+	if (!Culture.IsEmpty())
+	{
+		const FArticyVoiceOverTable* Invariant = Cultures.Find(FString());
+		const FSoftObjectPath* InvariantPath = Invariant ? Invariant->Paths.Find(TextKey) : nullptr;
+		if (InvariantPath && *InvariantPath == Path)
+			return;
+	}
+
+	Cultures.FindOrAdd(Culture).Paths.Add(TextKey, Path);
+	ActiveCulture.Reset();
+}
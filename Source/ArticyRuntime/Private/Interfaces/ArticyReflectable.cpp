@@ -0,0 +1,133 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#include "Interfaces/ArticyReflectable.h"
+#include "ArticyRuntimeModule.h"
+#include "ArticyObjectNotificationManager.h"
+#include "ArticyObject.h"
+#include "Misc/ScopeRWLock.h"
+#include "Templates/UniquePtr.h"
+#include "UObject/UObjectIterator.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Reflected classes"), STAT_ArticyPropertyTableClasses, STATGROUP_Articy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Reflected properties"), STAT_ArticyPropertyTableProperties, STATGROUP_Articy);
+DECLARE_MEMORY_STAT(TEXT("Property tables"), STAT_ArticyPropertyTableMemory, STATGROUP_Articy);
+
+namespace
+{
+	/** The property tables by class. They are held by pointer, so references to them stay valid when the map grows. */
+	TMap<const UClass*, TUniquePtr<FArticyPropertyTable>> PropertyTables;
+
+	/** Read-mostly: after the warm up, lookups only take the read lock. */
+	FRWLock PropertyTablesLock;
+}
+
+/**
+ * @brief Returns the (cached) property table of a class.
+ *
+ * The table is built the first time a class is accessed (see WarmPropertyTables), because the properties can
+ * only be found by iterating over them with a TFieldIterator. The properties of the super class are added first,
+ * so the slots of inherited properties match the ones of the super class.
+ *
+ * @param Class The class to get the property table of.
+ * @return The property table of the class.
+ */
+const FArticyPropertyTable& IArticyReflectable::GetPropertyTable(const UClass* Class)
+{
+	{
+		FReadScopeLock ReadLock(PropertyTablesLock);
+		if (const TUniquePtr<FArticyPropertyTable>* Table = PropertyTables.Find(Class))
+			return **Table;
+	}
+
+	//build the table outside of the lock, the super class table takes it on its own
+	TUniquePtr<FArticyPropertyTable> Table = MakeUnique<FArticyPropertyTable>();
+	if (Class)
+	{
+		if (const UClass* SuperClass = Class->GetSuperClass())
+			*Table = GetPropertyTable(SuperClass);
+
+		for (TFieldIterator<FProperty> It(Class, EFieldIteratorFlags::ExcludeSuper); It; ++It)
+			Table->Slots.Add(*It->GetNameCPP(), Table->Properties.Add(*It));
+	}
+
+	FWriteScopeLock WriteLock(PropertyTablesLock);
+
+	//another thread might have built the same table in the meantime
+	if (const TUniquePtr<FArticyPropertyTable>* Existing = PropertyTables.Find(Class))
+		return **Existing;
+
+	INC_DWORD_STAT(STAT_ArticyPropertyTableClasses);
+	INC_DWORD_STAT_BY(STAT_ArticyPropertyTableProperties, Table->Properties.Num());
+	INC_MEMORY_STAT_BY(STAT_ArticyPropertyTableMemory, sizeof(FArticyPropertyTable) + Table->Properties.GetAllocatedSize() + Table->Slots.GetAllocatedSize());
+
+	return *PropertyTables.Add(Class, MoveTemp(Table));
+}
+
+/**
+ * @brief Builds the property tables of all loaded classes implementing IArticyReflectable.
+ *
+ * Called when the database is initialized, at which point the generated classes are loaded.
+ */
+void IArticyReflectable::WarmPropertyTables()
+{
+	int32 NumClasses = 0;
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		const UClass* Class = *It;
+		if (Class->HasAnyClassFlags(CLASS_NewerVersionExists) || !Class->ImplementsInterface(UArticyReflectable::StaticClass()))
+			continue;
+
+		GetPropertyTable(Class);
+		++NumClasses;
+	}
+
+	UE_LOG(LogArticyRuntime, Verbose, TEXT("Warmed the property tables of %d reflectable classes."), NumClasses);
+}
+
+/**
+ * @brief Returns true if this object, or the object owning this feature, is a shadow copy.
+ *
+ * Shadow copies are outered to the object they were copied from (see FArticyShadowableObject::GetForWrite), while
+ * the originals are outered to the database or their package. Clones are outered to clone 0 as well, but have
+ * another clone id. The writes of shadow copies are undone when the shadow state is popped.
+ *
+ * @return True if this is a shadow copy or one of its features.
+ */
+bool IArticyReflectable::IsShadowCopy() const
+{
+	const UObject* Object = _getUObject();
+	const UArticyObject* Owner = Object->IsA<UArticyObject>() ? static_cast<const UArticyObject*>(Object) : Object->GetTypedOuter<UArticyObject>();
+	const UArticyObject* Source = Owner ? Cast<UArticyObject>(Owner->GetOuter()) : nullptr;
+	return Source && Source->GetCloneId() == Owner->GetCloneId();
+}
+
+bool IArticyReflectable::bDispatchPropertyChanges = false;
+
+/**
+ * @brief Reports a write of the writable instance to ReportChanged and the notification manager.
+ *
+ * The written property is marked as modified (see UArticyBaseObject::IsModified). The notification manager
+ * dispatches the write at the end of the frame, it is only called while it has subscriptions.
+ * Writes to shadow copies are neither marked nor reported, as they are undone when the shadow state is popped.
+ *
+ * @param Property The written property.
+ * @param Slot The slot of the property, or INDEX_NONE if it is not known.
+ */
+void IArticyReflectable::NotifyPropertyChanged(const FProperty* Property, int32 Slot)
+{
+	if (!Property || IsShadowCopy())
+		return;
+
+	if (UArticyBaseObject* Object = Cast<UArticyBaseObject>(_getUObject()))
+		Object->MarkModified(Property, Slot);
+
+	FArticyChangedProperty ChangedProperty;
+	ChangedProperty.Property = Property->GetFName();
+	ChangedProperty.SetObjectReference(this);
+	ReportChanged.Broadcast(ChangedProperty);
+
+	if (bDispatchPropertyChanges)
+		UArticyObjectNotificationManager::Get()->ReportPropertyChanged(this, Property, Slot);
+}
@@ -5,15 +5,24 @@
 
 #include "ShadowStateManager.h"
 
-void IShadowStateManager::UnregisterOnPopState(FDelegateHandle Delegate)
+void IShadowStateManager::RecordUndo(FUndoFunction Undo, void* Context, int32 Payload)
 {
-	OnPopStateDelegates.Last().Remove(Delegate);
+	if(!ensureMsgf(StateStarts.Num() > 0, TEXT("Recording an undo entry outside of a shadow state!")))
+		return;
+
+	const FUndoEntry Entry{ Undo, Context, Payload };
+	if(NumUndoEntries < UndoLog.Num())
+		UndoLog[NumUndoEntries] = Entry;
+	else
+		UndoLog.Add(Entry);
+
+	++NumUndoEntries;
 }
 
 void IShadowStateManager::PushState(uint32 NewShadowLevel)
 {
-	//create a new delegate just for this new shadow state
-	OnPopStateDelegates.Emplace();
+	//the new state starts at the current end of the undo log
+	StateStarts.Push(NumUndoEntries);
 	++ShadowLevel;
 
 	ensureMsgf(ShadowLevel == NewShadowLevel, TEXT("ShadowLevels do not match in PushState!"));
@@ -23,14 +32,37 @@ void IShadowStateManager::PopState(uint32 CurrShadowLevel)
 {
 	ensureMsgf(ShadowLevel == CurrShadowLevel, TEXT("ShadowLevels do not match in PopState!"));
 
-	if(ensureMsgf(OnPopStateDelegates.Num() > 0, TEXT("InPopStateDelegates empty while popping a state!")))
+	if(ensureMsgf(StateStarts.Num() > 0, TEXT("No shadow state to pop!")))
 	{
-		//notify only the variables that registered during THIS operation
-		auto onPop = OnPopStateDelegates.Pop();
-		if(onPop.IsBound())
-			onPop.Broadcast();
+		//undo only the changes recorded during THIS operation, most recent first
+		const int32 Start = StateStarts.Pop();
+
+		for(int32 i = NumUndoEntries - 1; i >= Start; --i)
+		{
+			const FUndoEntry& Entry = UndoLog[i];
+			Entry.Undo(Entry.Context, Entry.Payload, ShadowLevel);
+		}
+
+		NumUndoEntries = Start;
 	}
 
 	if(ensureMsgf(ShadowLevel > 0, TEXT("Trying to pop state when ShadowLevel is 0!")))
 		--ShadowLevel;
 }
+
+void IShadowStateManager::PopAllStates()
+{
+	while(ShadowLevel > 0)
+		PopState(ShadowLevel);
+}
+
+void IShadowStateManager::InvokePopCallback(void* Context, int32 Payload, uint32 ShadowLevel)
+{
+	auto Manager = static_cast<IShadowStateManager*>(Context);
+
+	//callbacks are undone in reverse order, so this is always the last one
+	TFunction<void()> Callback = MoveTemp(Manager->PopCallbacks[Payload]);
+	Manager->PopCallbacks.RemoveAt(Payload);
+	if(Callback)
+		Callback();
+}
@@ -20,4 +20,14 @@ class ARTICYRUNTIME_API UArticyAlternativeGlobalVariables : public UDataAsset
     GENERATED_BODY()
 
 public:
+
+    /** Returns the key of the runtime clone of these variables, see UArticyGlobalVariables::GetRuntimeClone. */
+    FName GetCloneKey() const;
+
+    virtual void PostRename(UObject* OldOuter, const FName OldName) override;
+
+private:
+
+    /** See GetCloneKey, cached because building it from the full name allocates. */
+    mutable FName CloneKey;
 };
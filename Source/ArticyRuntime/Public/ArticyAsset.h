@@ -9,8 +9,11 @@
 #include "FileMediaSource.h"
 #include "Sound/SoundWave.h"
 #include "Engine/Texture2D.h"
+#include "UObject/SoftObjectPath.h"
 #include "ArticyAsset.generated.h"
 
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnArticyAssetLoaded, UObject*, LoadedAsset);
+
 /**
  * Enum to categorize different types of assets.
  */
@@ -52,6 +55,31 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Load Asset")
 	UObject* LoadAsset() const;
 
+	/**
+	 * Loads the asset referenced by this Articy asset in the background.
+	 * The callback is invoked on the game thread once the asset is loaded, or right away if it already is.
+	 *
+	 * @param OnLoaded Called with the loaded UObject, or nullptr if the asset could not be loaded.
+	 */
+	void LoadAssetAsync(TFunction<void(UObject*)> OnLoaded) const;
+
+	/**
+	 * Loads the asset referenced by this Articy asset in the background.
+	 *
+	 * @param OnLoaded Called with the loaded UObject, or nullptr if the asset could not be loaded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Load Asset", meta = (DisplayName = "Load Asset Async"))
+	void K2_LoadAssetAsync(FOnArticyAssetLoaded OnLoaded) const;
+
+	/** Returns the object path of the referenced asset, derived from AssetRef. */
+	FSoftObjectPath GetAssetPath() const;
+
+	/** Returns the object path of an asset imported from articy, e.g. by ImportAudioAssets, by its AssetRef. */
+	static FSoftObjectPath GetAssetPathFromRef(const FString& InAssetRef);
+
+	/** Updates AssetPath from AssetRef, called on import. */
+	void UpdateAssetPath();
+
 	/**
 	 * Loads the asset as a texture.
 	 *
@@ -90,6 +118,9 @@ public:
 	/** The category of the referenced asset. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Meta Data")
 	EArticyAssetCategory Category;
+	/** The object path of the referenced asset, computed from AssetRef on import. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Meta Data")
+	FSoftObjectPath AssetPath;
 
 private:
 	/** A transient pointer to the asset, used to cache the loaded asset. */
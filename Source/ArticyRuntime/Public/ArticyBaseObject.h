@@ -16,6 +16,8 @@
 #include "ArticyBaseObject.generated.h"
 
 class UArticyPrimitive;
+class UArticyDatabase;
+class UArticyBaseFeature;
 
 /**
  * Base class for all Articy objects.
@@ -49,9 +51,65 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Articy")
 	FArticyType GetArticyType() const;
 
+	/**
+	 * Resolves the references of this object and its subobjects to the objects loaded into a database, so following
+	 * them doesn't look the objects up by id. Called by the link pass of the database, see UArticyDatabase::LinkObjects.
+	 *
+	 * @param Database The database the object is loaded into, or nullptr to unlink the references.
+	 */
+	virtual void LinkReferences(const UArticyDatabase* Database);
+
+	/**
+	 * Returns a feature of this object for modification.
+	 * A feature that is shared with clones (see UArticyPluginSettings::bShareFeaturesBetweenClones) is copied into
+	 * this object first, so the change does not reach the other objects sharing it.
+	 *
+	 * @param Feature The name of the feature property, e.g. DisplayName.
+	 * @return The feature of this object, or nullptr if there is no such feature.
+	 */
+	UArticyBaseFeature* GetFeatureForWrite(FName Feature);
+
+	/** Returns a feature of this object for modification, see GetFeatureForWrite(FName). */
+	UArticyBaseFeature* GetFeatureForWrite(const FProperty* FeatureProperty);
+
+	/**
+	 * Returns true if a property of this object, or of one of its features, was written since the object was loaded
+	 * or reset. Clones start with the modified properties of the object they were cloned from.
+	 * Only objects of a database are tracked, and writes in shadow states are not.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	bool IsModified() const { return ModifiedSlots.Contains(true); }
+
+	/**
+	 * Returns the names of the properties written since the object was loaded or reset, see IsModified.
+	 * The properties of features are returned as Feature.Property, like the paths of getProp.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	TArray<FString> GetModifiedProperties() const;
+
+	/**
+	 * For internal use only: marks a property as modified, called for each write reported by NotifyPropertyChanged.
+	 * The first write to a feature also marks the property holding it on its owner.
+	 *
+	 * @param Property The written property.
+	 * @param Slot The slot of the property, or INDEX_NONE if it is not known.
+	 */
+	void MarkModified(const FProperty* Property, int32 Slot);
+
+	/** For internal use only: forgets the modified properties of this object and its features. */
+	void ClearModified();
+
+	/** For internal use only: takes the modified properties of the object this one was duplicated from. */
+	void CopyModifiedState(const UArticyBaseObject* Source);
+
 	/** The Articy type of this object. */
 	FArticyType ArticyType;
 
+#if WITH_EDITOR
+	/** Leaves the presentation properties out when cooking for dedicated servers, see UArticyPluginSettings::bStripPresentationForServer. */
+	virtual void Serialize(FArchive& Ar) override;
+#endif
+
 protected:
 	/**
 	 * Initializes the object from a JSON value.
@@ -62,6 +120,7 @@ protected:
 
 	template<typename Type, typename PropType>
 	friend struct ArticyObjectTypeInfo;
+	friend class FArticyRuntimeBenchmark;
 
 	/**
 	 * Adds a subobject to this Articy object.
@@ -83,7 +142,18 @@ protected:
 	UFUNCTION(BlueprintPure, Category = "Articy")
 	FText GetPropertyText(const FText Property);
 
+	/**
+	 * Copies the modified properties back from the object this one was created from, and forgets them.
+	 * Features owned by this object are restored property by property as well.
+	 *
+	 * @param Original The object to copy the values from, of the same class.
+	 */
+	void RestoreModifiedProperties(const UArticyBaseObject* Original);
+
 private:
+	/** The slots of the properties written, see IsModified. Not a property, so duplicates start out unmodified. */
+	TBitArray<> ModifiedSlots;
+
 	/** Initialized with false, changed to true by InitFromJson (and later by deserialization). */
 	UPROPERTY(VisibleAnywhere, Category = "Articy")
 	bool bWasDeserialized = false;
@@ -94,4 +164,23 @@ UCLASS(BlueprintType)
 class ARTICYRUNTIME_API UArticyBaseFeature : public UArticyBaseObject
 {
 	GENERATED_BODY()
+
+public:
+
+	/**
+	 * Returns true if clones share this feature with the object they were cloned from.
+	 * Changes made through one of the objects copy the feature first, see UArticyBaseObject::GetFeatureForWrite.
+	 */
+	bool IsSharedWithClones() const { return bSharedWithClones; }
+
+	/** For internal use only: marks the feature as shared when a clone is created. */
+	void SetSharedWithClones() { bSharedWithClones = true; }
+
+	virtual IArticyReflectable* GetWritableInstance() override;
+	virtual IArticyReflectable* GetReadableInstance() override;
+
+private:
+
+	/** Not a property, so copies of the feature start out not shared. */
+	bool bSharedWithClones = false;
 };
@@ -101,7 +101,14 @@ public:
 	 */
 	friend uint32 GetTypeHash(const FArticyId& Id)
 	{
-		return Id.Low ^ Id.High;
+		//the high words of articy ids are highly correlated, so mix all 64 bit (murmur3 finalizer)
+		uint64 Hash = static_cast<uint64>(static_cast<uint32>(Id.High)) << 32 | static_cast<uint32>(Id.Low);
+		Hash ^= Hash >> 33;
+		Hash *= 0xff51afd7ed558ccdull;
+		Hash ^= Hash >> 33;
+		Hash *= 0xc4ceb9fe1a85ec53ull;
+		Hash ^= Hash >> 33;
+		return static_cast<uint32>(Hash);
 	}
 
 	/** Checks if the ID is null (both Low and High are zero). */
@@ -60,6 +60,9 @@ public:
 	/** Can be an InputPin (next node) or an OutputPin (emerge to parent node). */
 	UArticyFlowPin* GetTargetPin() const;
 	FArticyId GetTargetPinID() const { return TargetPin;  }
+
+	/** Links the target and the target pin. */
+	void LinkReferences(const UArticyDatabase* Database) override;
 	
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Articy", meta=(DisplayName="TargetPin"))
@@ -68,10 +71,8 @@ protected:
 	FArticyId Target;
 
 private:
-	UPROPERTY(VisibleAnywhere, Transient, Category = "Articy")
-	mutable UArticyFlowPin* TargetPinObj;
-	UPROPERTY(VisibleAnywhere, Transient, Category = "Articy")
-	mutable UArticyPrimitive* TargetObj;
+	/** The target and the target pin, see LinkReferences. */
+	FArticyPinLink TargetLink;
 
 	template<typename Type, typename PropType>
 	friend struct ArticyObjectTypeInfo;
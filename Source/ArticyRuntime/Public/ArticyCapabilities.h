@@ -0,0 +1,84 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+class IArticyFlowObject;
+class IArticyInputPinsProvider;
+class IArticyOutputPinsProvider;
+class IArticyObjectWithSpeaker;
+class IArticyObjectWithText;
+class IArticyObjectWithPreviewImage;
+class UArticyFlowPin;
+
+/** The interfaces and base classes of articy objects the runtime looks for while exploring and playing the flow. */
+enum class EArticyCapability : uint8
+{
+	FlowObject,
+	FlowPin,
+	InputPinsProvider,
+	OutputPinsProvider,
+	ObjectWithSpeaker,
+	ObjectWithText,
+	ObjectWithPreviewImage,
+
+	Num
+};
+
+/** The capability of a type, e.g. TArticyCapability<IArticyObjectWithSpeaker>::Value. */
+template<typename Type> struct TArticyCapability;
+template<> struct TArticyCapability<IArticyFlowObject> { static constexpr EArticyCapability Value = EArticyCapability::FlowObject; };
+template<> struct TArticyCapability<UArticyFlowPin> { static constexpr EArticyCapability Value = EArticyCapability::FlowPin; };
+template<> struct TArticyCapability<IArticyInputPinsProvider> { static constexpr EArticyCapability Value = EArticyCapability::InputPinsProvider; };
+template<> struct TArticyCapability<IArticyOutputPinsProvider> { static constexpr EArticyCapability Value = EArticyCapability::OutputPinsProvider; };
+template<> struct TArticyCapability<IArticyObjectWithSpeaker> { static constexpr EArticyCapability Value = EArticyCapability::ObjectWithSpeaker; };
+template<> struct TArticyCapability<IArticyObjectWithText> { static constexpr EArticyCapability Value = EArticyCapability::ObjectWithText; };
+template<> struct TArticyCapability<IArticyObjectWithPreviewImage> { static constexpr EArticyCapability Value = EArticyCapability::ObjectWithPreviewImage; };
+
+/**
+ * @struct FArticyCapabilities
+ * @brief The capabilities of a class, and where their interfaces are in the objects of the class.
+ *
+ * A cast to an interface walks the class hierarchy and the interfaces of each class. As the offsets of the
+ * interfaces are the same for all objects of a class, they are found once per class by casting its first object,
+ * after which testing for a capability is a mask test and getting its interface an addition.
+ * See UArticyPrimitive::GetCapability, which caches the capabilities of the class on the object.
+ */
+struct ARTICYRUNTIME_API FArticyCapabilities
+{
+	/**
+	 * Returns the capabilities of the class of an object, finding them on first use. Thread-safe.
+	 * @param Object The object, must not be null.
+	 */
+	static const FArticyCapabilities& Find(const UObject* Object);
+
+	bool Has(EArticyCapability Capability) const { return (Mask & (1u << static_cast<uint8>(Capability))) != 0; }
+
+	/**
+	 * Returns an interface or base class of an object of this class, like a Cast.
+	 * @param Object An object of the class.
+	 * @return The interface, or null if the class doesn't have it.
+	 */
+	template<typename Type>
+	Type* Get(const UObject* Object) const
+	{
+		constexpr uint8 Index = static_cast<uint8>(TArticyCapability<Type>::Value);
+		return Has(TArticyCapability<Type>::Value) ? reinterpret_cast<Type*>(const_cast<uint8*>(reinterpret_cast<const uint8*>(Object)) + Offsets[Index]) : nullptr;
+	}
+
+private:
+
+	/** Adds a capability if the object has it, with the offset of its interface. */
+	template<typename Type>
+	void Add(const UObject* Object);
+
+	uint32 Mask = 0;
+	int32 Offsets[static_cast<uint8>(EArticyCapability::Num)] = {};
+
+	/** The class, to tell a reloaded class at the address of a collected one apart. */
+	TWeakObjectPtr<const UClass> Class;
+};
@@ -9,13 +9,25 @@
 #include "ShadowStateManager.h"
 #include "ArticyObject.h"
 #include "ArticyPackage.h"
+#include "ArticyFlowGraph.h"
+#include "ArticyPropertyIndex.h"
+#include "ArticyHierarchy.h"
+#include "ArticyLocationIndex.h"
+#include "ArticyVoiceOverIndex.h"
+#include "ArticyDialogueTable.h"
 #include "AssetRegistry/AssetData.h"
+#include "Containers/Ticker.h"
+#include <atomic>
 #include "ArticyDatabase.generated.h"
 
 class UArticyExpressoScripts;
 struct FArticyId;
 class UArticyGlobalVariables;
 class UArticyAlternativeGlobalVariables;
+class IArticyConditionProvider;
+class FArticyObjectOfClassIterator;
+
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnArticyPackageLoaded, const FString&, PackageName);
 
 /**
  * Structure representing a shadow of an Articy object.
@@ -57,6 +69,8 @@ private:
 	TWeakObjectPtr<UObject> Outer; /**< The outer object context. */
 
 	int32 CloneId; /**< The clone ID of the object. */
+
+	friend struct FArticyShadowableObject;
 };
 
 /**
@@ -80,12 +94,54 @@ public:
 
 	/**
 	 * Returns the requested shadow.
+	 * Shadow copies are only created by writes (see GetForWrite), reads return the most recent copy at or below
+	 * the current shadow level.
 	 * @param ShadowManager The manager for shadow states.
 	 * @param ForceUnshadowed Force retrieval of the unshadowed version.
 	 * @return A pointer to the shadowed or unshadowed UArticyObject.
 	 */
 	UArticyObject* Get(const IShadowStateManager* ShadowManager, bool ForceUnshadowed = false) const;
 
+	/**
+	 * Returns the copy of the current shadow level, creating it if the object was not modified in this level yet.
+	 * The caller is responsible for removing a newly created copy when the state is popped (see PopShadow).
+	 * @param ShadowManager The manager for shadow states.
+	 * @param bCreated Set to true if a new shadow copy was created.
+	 * @return A pointer to the writable UArticyObject.
+	 */
+	UArticyObject* GetForWrite(const IShadowStateManager* ShadowManager, bool& bCreated) const;
+
+	/**
+	 * Removes the most recent shadow copy.
+	 * @param ShadowLevel The shadow level that is popped.
+	 */
+	void PopShadow(uint32 ShadowLevel);
+
+	/**
+	 * Replaces the original [0] object, used when a shared object gets its own copy.
+	 * @param NewOriginal The new unshadowed object.
+	 */
+	void ReplaceOriginal(UArticyObject* NewOriginal);
+
+	/** Removes all clones except clone 0, used when a reused database is reset (see UArticyDatabase::ResetToOriginal). */
+	void RemoveClones();
+
+	/** Returns true if this slot holds an object (default constructed slots are empty). */
+	bool IsValid() const { return ShadowCopies.Num() > 0; }
+
+	/**
+	 * Calls Visitor for the original object and each of its shadow copies, e.g. to measure their memory.
+	 * @param Visitor Called with the object and its shadow level, 0 for the original.
+	 */
+	void ForEachCopy(TFunctionRef<void(const UArticyObject*, uint32)> Visitor) const;
+
+	/**
+	 * Reports the original object and its shadow copies to the garbage collector.
+	 * @param Collector The collector of the references.
+	 * @param Referencer The database that holds the object.
+	 */
+	void AddReferencedObjects(FReferenceCollector& Collector, const UObject* Referencer);
+
 private:
 
 	/**
@@ -99,13 +155,19 @@ private:
 
 /**
  * Contains a reference to a UArticyObject, and to its clones if any.
+ * Containers are plain objects owned by their database, which reports the clones to the garbage collector
+ * (see UArticyDatabase::AddReferencedObjects), so a loaded object adds no UObject besides its copies.
  */
-UCLASS(BlueprintType)
-class ARTICYRUNTIME_API UArticyCloneableObject : public UObject
+class ARTICYRUNTIME_API FArticyCloneableObject
 {
-	GENERATED_BODY()
-
 public:
+	/**
+	 * Creates an empty container.
+	 * @param InDatabase The database that owns the container.
+	 * @param InSlot The index of the container in the container slots of the database.
+	 */
+	FArticyCloneableObject(UArticyDatabase* InDatabase, int32 InSlot) : Database(InDatabase), Slot(InSlot) {}
+
 	/**
 	 * Initializes the cloneable object with the initial clone.
 	 * @param InitialClone The initial clone to add.
@@ -123,6 +185,14 @@ public:
 	 * @return A pointer to the clone or nullptr if not found.
 	 */
 	UArticyObject* Get(const IShadowStateManager* ShadowManager, int32 CloneId = 0, bool bForceUnshadowed = false) const;
+	/**
+	 * Get the clone of this object with a certain CloneId for modification.
+	 * In a shadow state, this creates a shadow copy on the first write, which is removed when the state is popped.
+	 * @param ShadowManager The manager for shadow states.
+	 * @param CloneId The clone ID to retrieve.
+	 * @return A pointer to the writable clone or nullptr if not found.
+	 */
+	UArticyObject* GetForWrite(const IShadowStateManager* ShadowManager, int32 CloneId);
 	/**
 	 * Clone the original object and assign it the id CloneId.
 	 * If bFailIfExists is true, nullptr is returned if the clone already exists.
@@ -134,21 +204,140 @@ public:
 	 */
 	UArticyObject* Clone(const IShadowStateManager* ShadowManager, int32 CloneId, bool bFailIfExists = true);
 
+	/**
+	 * Creates Count new clones of the original object, using the next free clone ids.
+	 * The clone slots are allocated up front, and the duplication parameters are shared by all clones.
+	 * @param ShadowManager The manager for shadow states.
+	 * @param Count The number of clones to create.
+	 * @param OutClones The new clones are appended to this array.
+	 */
+	void CloneBatch(const IShadowStateManager* ShadowManager, int32 Count, TArray<UArticyObject*>& OutClones);
+
+	/**
+	 * Removes a clone, its id is handed out again by the next clone with id -1.
+	 * @param CloneId The id of the clone, clone 0 cannot be removed.
+	 * @return True if the clone existed.
+	 */
+	bool RemoveClone(int32 CloneId);
+
+	/** Releases the empty slots after the last clone, and the memory the clone slots do not use anymore. */
+	void Compact();
+
+	/**
+	 * Replaces the unshadowed clone 0, used when a shared object gets its own copy.
+	 * @param NewOriginal The new clone 0.
+	 */
+	void ReplaceOriginal(UArticyObject* NewOriginal);
+
+	/**
+	 * Calls Visitor for every clone and each of its shadow copies, see FArticyShadowableObject::ForEachCopy.
+	 * @param Visitor Called with the object and its shadow level, 0 for the clones themselves.
+	 */
+	void ForEachCopy(TFunctionRef<void(const UArticyObject*, uint32)> Visitor) const;
+
+	/**
+	 * Returns the number of times the container was released, links compare it to detect a container that was
+	 * reused for another object (see FArticyObjectLink).
+	 */
+	uint32 GetGeneration() const { return Generation; }
+
 private:
 
+	/** The database that owns the container. */
+	UArticyDatabase* Database = nullptr;
+
+	/** The index of the container in UArticyDatabase::ContainerSlots. */
+	int32 Slot = INDEX_NONE;
+
+	/** See GetGeneration. */
+	uint32 Generation = 0;
+
 	/**
-	 * The copied instances of the same object.
+	 * The copied instances of the same object, indexed by their clone id.
 	 * Clones[0] is the one that is created at startup from the object assets.
+	 * Slots of unused clone ids are empty (see FArticyShadowableObject::IsValid).
 	 */
-	UPROPERTY(VisibleAnywhere, Category = "Articy")
-	TMap<int32, FArticyShadowableObject> Clones;
+	TArray<FArticyShadowableObject> Clones;
+
+	/** Unused clone ids below Clones.Num() as a min-heap, the lowest is handed out when cloning with id -1. */
+	TArray<int32> FreeCloneIds;
 
 	/**
-	 * Adds a clone to the Clones map.
+	 * Adds a clone to the Clones slots.
 	 * @param Clone The clone to add.
-	 * @param CloneId The ID for the clone.
+	 * @param CloneId The ID for the clone, or -1 to use the next free id.
+	 * @return The clone id that was used, or -1 if the clone was not added.
+	 */
+	int32 AddClone(UArticyObject* Clone, int32 CloneId);
+
+	/** Replaces clone 0 by a private copy if it is a package asset shared by the database, before it is copied. */
+	void UnshareOriginal();
+
+	/**
+	 * Undo function for shadow copies recorded by GetForWrite, removes the copy of the popped level.
+	 * @param Context The container of the clone.
+	 * @param CloneId The ID of the clone.
+	 * @param ShadowLevel The shadow level that is popped.
 	 */
-	void AddClone(UArticyObject* Clone, int32 CloneId);
+	static void UndoShadow(void* Context, int32 CloneId, uint32 ShadowLevel);
+
+	/** Drops the clones when the object is unloaded, so the database can reuse the container. */
+	void Release();
+
+	friend class UArticyDatabase;
+
+	/** The number of loaded packages that contain this object, maintained by the database. */
+	int32 PackageRefCount = 0;
+
+	/** The index of this container in the class bucket of the database, maintained by the database. */
+	int32 ClassBucketIndex = INDEX_NONE;
+
+	/** The package whose use this object counts for, see UArticyPluginSettings::PackageResidencyBudgetMB. */
+	int32 PackageUsageIndex = INDEX_NONE;
+
+	/**
+	 * The package asset shared as clone 0 (see bShareUnmodifiedObjectsWithPackages), kept once it was replaced by a
+	 * copy until the object is unloaded, maintained by the database.
+	 */
+	UArticyObject* SharedAsset = nullptr;
+};
+
+/**
+ * The state of the objects before they were changed, recorded by a database while the log is registered with it
+ * (see UArticyDatabase::AddObjectUndoLog), so UArticyDatabase::ApplyObjectUndoLog can revert them.
+ * Each clone is recorded once, when it is first written or created, with the properties which differed from its
+ * package asset at that time, so the log grows with the number of changed objects, not with the number of writes.
+ */
+struct ARTICYRUNTIME_API FArticyObjectUndoLog
+{
+	/** The state of one clone of an object before its first change. */
+	struct FRecord
+	{
+		FArticyId Id;
+		int32 CloneId = 0;
+
+		/** False if the clone was created while recording, it is destroyed again when the log is applied. */
+		bool bExisted = true;
+
+		/** The serialized values of the properties which differed from the package asset, by path index. */
+		TArray<TPair<int32, TArray<uint8>>> Values;
+	};
+
+	/** The paths (Property or Feature.Property) and types of the recorded properties, referenced by index. */
+	TArray<FString> Paths;
+	TArray<FString> Types;
+	TMap<FString, int32> PathIndices;
+
+	/** The records in the order of the changes, and the clones recorded already. */
+	TArray<FRecord> Records;
+	TSet<TPair<FArticyId, int32>> Recorded;
+
+	bool IsEmpty() const { return Records.Num() == 0; }
+
+	void Reset();
+
+	/** Returns the memory held by the log, in bytes. */
+	SIZE_T GetAllocatedSize() const;
 };
 
 /**
@@ -160,8 +349,26 @@ struct ARTICYRUNTIME_API FArticyDatabaseObjectArray
 	GENERATED_BODY()
 
 public:
-	UPROPERTY()
-	TArray<UArticyCloneableObject*> Objects; /**< The array of Articy cloneable objects. */
+	TArray<FArticyCloneableObject*> Objects; /**< The array of Articy cloneable objects, owned by the database. */
+};
+
+/**
+ * A package imported from articy:draft, referenced softly so it is only loaded once it is needed.
+ */
+USTRUCT(BlueprintType)
+struct ARTICYRUNTIME_API FArticyPackageEntry
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(VisibleAnywhere, Category = "Articy")
+	TSoftObjectPtr<UArticyPackage> Package; /**< The package asset. */
+
+	UPROPERTY(VisibleAnywhere, Category = "Articy")
+	bool bIsDefaultPackage = false; /**< Copy of the flag of the package, so it is known without loading the package. */
+
+	UPROPERTY(VisibleAnywhere, Category = "Articy")
+	int32 ChunkId = INDEX_NONE; /**< The chunk the package is cooked into, INDEX_NONE if unassigned. */
 };
 
 /**
@@ -240,6 +447,14 @@ public:
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "Is package default package?"), Category = "Articy")
 	bool IsPackageDefaultPackage(FString PackageName);
 
+	/**
+	 * Gets the chunk a package is cooked into, so it can be installed on demand before it is loaded.
+	 * @param PackageName The name of the package.
+	 * @return The chunk id of the package, or -1 if the package is unknown or has no assigned chunk.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Articy")
+	int32 GetPackageChunkId(FString PackageName) const;
+
 	//---------------------------------------------------------------------------//
 
 	/**
@@ -254,6 +469,12 @@ public:
 	 */
 	virtual void SetLoadedPackages(const TArray<UArticyPackage*> Packages);
 
+	/** Sets the flattened project hierarchy, written by the import. */
+	void SetHierarchy(const FArticyHierarchy& NewHierarchy) { Hierarchy = NewHierarchy; }
+
+	/** Sets the voice over assets of the texts by culture, written by the import. */
+	void SetVoiceOverIndex(const FArticyVoiceOverIndex& NewIndex) { VoiceOverIndex = NewIndex; }
+
 	/** Load all packages which have the IsDefaultPackage flag set to true. */
 	virtual void LoadDefaultPackages();
 
@@ -268,14 +489,83 @@ public:
 	virtual void LoadPackage(FString PackageName);
 
 	/**
-	 * Load a package of a given name.
+	 * Load several packages at once.
+	 * The lookup tables are sized for the objects of all packages up front, and the objects are linked once
+	 * after all packages are loaded, instead of once per package as with LoadPackage.
+	 * @param PackageNames The names of the packages to load.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	void LoadPackages(const TArray<FString>& PackageNames);
+
+	/**
+	 * Load a package of a given name without blocking the game thread.
+	 * The objects of the package are duplicated in slices, limited by the AsyncPackageLoadBudgetMs
+	 * plugin setting. GetObject resolves objects of a package that is still loading on demand,
+	 * while name and class queries only see the objects that have been loaded so far.
+	 * Calling LoadPackage or UnloadPackage on a loading package finishes loading it immediately.
+	 * @param PackageName The name of the package to load.
+	 * @param OnLoaded Called once the package is fully loaded (immediately, if it already is).
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy", meta = (AutoCreateRefTerm = "OnLoaded"))
+	virtual void LoadPackageAsync(FString PackageName, const FOnArticyPackageLoaded& OnLoaded);
+
+	/**
+	 * Checks if a package is currently being loaded by LoadPackageAsync.
+	 * @param PackageName The name of the package to check.
+	 * @return True if the package is still loading, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Articy")
+	bool IsPackageLoading(const FString& PackageName) const;
+
+	/** Returns true if any package is still being loaded by LoadPackageAsync. */
+	bool HasPendingPackageLoads() const { return PendingPackageLoads.Num() > 0; }
+
+	/**
+	 * Unload a package of a given name.
+	 * Objects which are also contained in other loaded packages stay loaded, unless bQuickUnload is set. This is
+	 * tracked with per-object reference counts, so unloading only touches the objects of the package itself.
 	 * @param PackageName The name of the package to unload.
-	 * @param bQuickUnload If true, perform a quick unload.
+	 * @param bQuickUnload If true, all objects of the package are unloaded, even the ones other loaded packages contain too.
 	 * @return True if the package was successfully unloaded, false otherwise.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Articy")
 	virtual bool UnloadPackage(const FString PackageName, const bool bQuickUnload);
 
+	/**
+	 * Keeps a package from being evicted by the package residency budget (see UArticyPluginSettings::PackageResidencyBudgetMB).
+	 * Pins are counted, every pin needs an UnpinPackage. Flow players pin the package of their cursor.
+	 * @param PackageName The name of the package, it does not need to be loaded yet.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	void PinPackage(const FString& PackageName);
+
+	/**
+	 * Removes a pin of PinPackage.
+	 * @param PackageName The name of the package.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	void UnpinPackage(const FString& PackageName);
+
+	/**
+	 * Returns the non-default package an object was loaded with, only tracked with a package residency budget.
+	 * @param Id The ID of the object.
+	 * @return The name of the package, or an empty string.
+	 */
+	FString FindPackageOfObject(const FArticyId& Id) const;
+
+#if WITH_EDITOR
+	/**
+	 * Unloads packages from the databases of the running game, before an import during play regenerates their assets.
+	 * The clone ids of their objects are remembered, so EndPackageHotPatch can clone the regenerated objects again.
+	 * The global variables are not touched.
+	 * @param Packages The regenerated packages, by the name the databases loaded them with, with their new name.
+	 */
+	static void BeginPackageHotPatch(const TMap<FString, FString>& Packages);
+
+	/** Loads the packages unloaded by BeginPackageHotPatch from their regenerated assets, and restores the clones. */
+	static void EndPackageHotPatch();
+#endif
+
 	//---------------------------------------------------------------------------//
 
 	/**
@@ -332,8 +622,8 @@ public:
 
 	/**
 	 * Get all objects with a given TechnicalName.
-	 * If a CloneId other than 0 is provided, copies of the objects with this index must exist,
-	 * otherwise null-pointers are returned instead.
+	 * If a CloneId other than 0 is provided, the missing copies of the objects with this index are
+	 * created on the game thread, like GetOrClone does.
 	 * Note: this allocates a new TArray, use the other variant if you already have an array
 	 * to fill the objects with!
 	 * @param TechnicalName The technical name of the objects to retrieve.
@@ -344,8 +634,8 @@ public:
 	TArray<T*> GetObjects(FName TechnicalName, int32 CloneId = 0) const;
 	/**
 	 * Get all objects with a given TechnicalName.
-	 * If a CloneId other than 0 is provided, copies of the objects with this index must exist,
-	 * otherwise null-pointers are returned instead.
+	 * If a CloneId other than 0 is provided, the missing copies of the objects with this index are
+	 * created on the game thread, like GetOrClone does.
 	 * @param TechnicalName The technical name of the objects to retrieve.
 	 * @param CloneId The clone ID of the objects.
 	 * @param CastTo The class to cast the objects to.
@@ -375,6 +665,133 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Articy", meta = (DeterminesOutputType = "Class", AdvancedDisplay = "CloneId"))
 	TArray<UArticyObject*> GetObjectsOfClass(TSubclassOf<class UArticyObject> Class, int32 CloneId = 0) const;
 
+	/**
+	* Creates an iterator over all objects of a class (including subclasses), which does not allocate.
+	* Only the objects of the requested class are visited, by means of a per-class index.
+	* Loading or unloading packages invalidates the iterator.
+	* @param Class The class of the objects to iterate.
+	* @param CloneId The clone ID of the objects, objects without this clone are skipped.
+	* @param bForceUnshadowed If true, the unshadowed objects are returned.
+	* @return The iterator.
+	*/
+	FArticyObjectOfClassIterator CreateObjectOfClassIterator(const UClass* Class, int32 CloneId = 0, bool bForceUnshadowed = false) const;
+
+	/**
+	* Calls Visitor for every loaded object of a class (including subclasses), without allocating.
+	* Objects that have no clone with the given CloneId are skipped.
+	* Must not load or unload packages from within the visitor.
+	* @param Class The class of the objects to visit, or nullptr to visit all objects.
+	* @param CloneId The clone ID of the objects.
+	* @param Visitor Called with each UArticyObject*.
+	*/
+	template<typename TVisitor>
+	void ForEachObject(const UClass* Class, int32 CloneId, TVisitor&& Visitor) const;
+
+	/**
+	* Calls Visitor for every loaded object with a given TechnicalName, without allocating.
+	* Objects that have no clone with the given CloneId are skipped.
+	* @param TechnicalName The technical name of the objects to visit.
+	* @param CloneId The clone ID of the objects.
+	* @param Visitor Called with each UArticyObject*.
+	*/
+	template<typename TVisitor>
+	void ForEachObjectByName(FName TechnicalName, int32 CloneId, TVisitor&& Visitor) const;
+
+	/**
+	* Returns a view of the containers of all loaded objects with a given TechnicalName.
+	* The view is invalidated by loading or unloading packages.
+	* @param TechnicalName The technical name of the objects.
+	* @return The containers, or an empty view if there are none.
+	*/
+	TConstArrayView<FArticyCloneableObject*> GetObjectContainersByName(FName TechnicalName) const;
+
+	/**
+	* Calls Visitor for every clone of the loaded objects and each of its shadow copies, e.g. to measure their memory.
+	* @param Visitor Called with the object and its shadow level, 0 for the clones themselves.
+	*/
+	void ForEachObjectCopy(TFunctionRef<void(const UArticyObject*, uint32)> Visitor) const;
+
+	/**
+	* Returns the project hierarchy of all imported objects in depth-first order, in which the descendants of an
+	* object are a contiguous range. Empty if the database was generated before the hierarchy was stored.
+	*/
+	const FArticyHierarchy& GetHierarchy() const { return Hierarchy; }
+
+	/**
+	* Returns the voice over assets of the imported texts by culture and text key, see IArticyObjectWithText::GetVOAssetPath.
+	* Empty if the database was generated before the voice over assets were stored.
+	*/
+	const FArticyVoiceOverIndex& GetVoiceOverIndex() const { return VoiceOverIndex; }
+
+	/**
+	* Calls Visitor for every loaded descendant of an object in depth-first order, without allocating.
+	* Descendants which are not loaded, or have no clone with the given CloneId, are skipped.
+	* @param Id The id of the ancestor.
+	* @param CloneId The clone ID of the objects.
+	* @param Visitor Called with each UArticyObject*.
+	*/
+	template<typename TVisitor>
+	void ForEachDescendant(const FArticyId& Id, int32 CloneId, TVisitor&& Visitor) const;
+
+	/**
+	* Returns the spatial index of the zones and spots of a location, built on first use and rebuilt after
+	* packages were loaded or unloaded. The index is valid until then, or until InvalidateLocationIndices.
+	* @param LocationId The id of the location.
+	* @return The index, or nullptr if the location is not loaded.
+	*/
+	const FArticyLocationIndex* GetLocationIndex(const FArticyId& LocationId) const;
+
+	/** Drops the location indices, so they are rebuilt with vertices or positions changed at runtime. */
+	void InvalidateLocationIndices() { LocationIndices.Reset(); }
+
+	/**
+	* Returns the table of the texts, speakers and preview images of the dialogue fragments of a loaded package,
+	* for dialogue UIs and lookahead code reading them for many fragments. Built on first use, rebuilt after packages
+	* were loaded or unloaded, and updated with the fragments written since the last call.
+	* @param PackageName The name of the package.
+	* @return The table, or nullptr if the package is not loaded.
+	*/
+	const FArticyDialogueTable* GetDialogueTable(const FString& PackageName) const;
+
+	/**
+	* Returns the references to an object from the loaded packages: incoming connections, jumps, properties like
+	* speakers and reference strips, and scripts naming it. The references are indexed by the import (see
+	* FArticyReferenceIndex), so this is a lookup per package rather than a scan of the objects.
+	* @param Target The id of the referenced object, which does not have to be loaded.
+	* @param PackageName Only the references from this package, or from all loaded packages if empty.
+	* @return The references, grouped by package.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	TArray<FArticyIncomingReference> GetIncomingReferences(FArticyId Target, const FString& PackageName = TEXT("")) const;
+
+	/**
+	* Returns the loaded objects referring to an object, each once, see GetIncomingReferences.
+	* @param Target The id of the referenced object.
+	* @param PackageName Only the objects of this package, or of all loaded packages if empty.
+	* @return Clone 0 of the referring objects.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	TArray<UArticyObject*> GetReferencingObjects(FArticyId Target, const FString& PackageName = TEXT("")) const;
+
+	/**
+	* Returns the zone of a location which contains a point, see FArticyLocationIndex::FindZoneAt.
+	* @param Location The location.
+	* @param Point The point, in location coordinates.
+	* @return The zone with the highest z-index containing the point, or nullptr.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	UArticyObject* FindZoneAt(const UArticyObject* Location, FVector2D Point) const;
+
+	/**
+	* Returns the spot of a location closest to a point, see FArticyLocationIndex::FindNearestSpot.
+	* @param Location The location.
+	* @param Point The point, in location coordinates.
+	* @param MaxDistance Spots further away are ignored, 0 for no limit.
+	* @return The spot, or nullptr.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	UArticyObject* FindNearestSpot(const UArticyObject* Location, FVector2D Point, float MaxDistance = 0.f) const;
+
 	/**
 	* Get all objects.
 	* @return An array of pointers to all Articy objects.
@@ -384,8 +801,8 @@ public:
 
 	/**
 	 * Get all objects with a given TechnicalName.
-	 * If a CloneId other than 0 is provided, copies of the objects with this index must exist,
-	 * otherwise null-pointers are returned instead.
+	 * If a CloneId other than 0 is provided, the missing copies of the objects with this index are
+	 * created on the game thread, like GetOrClone does.
 	 * @param Array The array to fill with pointers to the Articy objects.
 	 * @param TechnicalName The technical name of the objects to retrieve.
 	 * @param CloneId The clone ID of the objects.
@@ -423,6 +840,15 @@ public:
 	template<typename T>
 	T* CloneFrom(FName TechnicalName, int32 NewCloneId = -1) { return Cast<T>(CloneFromByName(TechnicalName, NewCloneId)); }
 
+	/**
+	 * Clones each of the given objects Count times, using the next free clone ids.
+	 * Much faster than calling CloneFrom in a loop when instancing many objects at once.
+	 * @param Ids The IDs of the objects to clone.
+	 * @param Count The number of clones to create per object.
+	 * @return The new clones, all clones of Ids[0] first. Unknown ids are skipped.
+	 */
+	TArray<UArticyObject*> CloneBatch(TConstArrayView<FArticyId> Ids, int32 Count);
+
 	/**
 	 * Clone an existing object, and assign the NewCloneId to it.
 	 * @param Id The ID of the object to retrieve or clone.
@@ -445,6 +871,71 @@ public:
 	template<typename T>
 	T* GetOrClone(const FName& TechnicalName, int32 NewCloneId) { return Cast<T>(GetOrCloneByName(TechnicalName, NewCloneId)); }
 
+	/**
+	 * Destroys a clone of an object, e.g. when the instance it was created for despawns.
+	 * The clone id is free again for the next clone of the object with id -1.
+	 * Clones cannot be destroyed in a shadow state, and clone 0 cannot be destroyed at all.
+	 * @param Id The ID of the object.
+	 * @param CloneId The clone ID of the clone to destroy.
+	 * @return True if the clone existed and was destroyed.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	bool DestroyClone(FArticyId Id, int32 CloneId);
+
+	/**
+	 * Destroys the clones with a clone ID of all loaded objects, e.g. all objects cloned for one instance.
+	 * @param CloneId The clone ID of the clones to destroy, must not be 0.
+	 * @return The number of destroyed clones.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	int32 DestroyAllClones(int32 CloneId);
+
+	/**
+	 * Releases the memory of the clone slots which are not used anymore after clones were destroyed.
+	 * Destroying clones only empties their slots, so call this now and then, e.g. on level transitions.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	void CompactClones();
+
+	/**
+	 * Writes the state of the loaded objects which differs from their package assets into a binary snapshot, e.g. for
+	 * a save game: the properties of each object and clone which differ (including the ones of their features), and
+	 * the clones which exist. Only the state outside of shadow states can be saved.
+	 * @return false if the snapshot could not be written.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Snapshot")
+	bool SaveObjectChanges(TArray<uint8>& OutSnapshot) const;
+
+	/**
+	 * Applies the object changes of a snapshot written by SaveObjectChanges, creating the clones which do not exist.
+	 * The changes are applied on top of the current state, so load them into a database with the state of the
+	 * packages, e.g. right after a new game was started. Changes of objects which are not loaded, and of properties
+	 * which were removed or changed their type since the snapshot was written, are skipped.
+	 * @return false if the snapshot is invalid, in which case nothing is changed.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Snapshot")
+	bool LoadObjectChanges(const TArray<uint8>& Snapshot);
+
+	/**
+	 * Starts recording the state of the objects into a log before they are written or cloned outside of shadow
+	 * states, e.g. for the checkpoints of a flow player (see UArticyFlowPlayer::MaxCheckpoints). The log must stay
+	 * valid until it is removed. Loading and unloading packages, and resetting a reused world clone, are not recorded.
+	 * @param Log The log to record into.
+	 */
+	void AddObjectUndoLog(FArticyObjectUndoLog* Log);
+
+	/** Stops recording into a log added with AddObjectUndoLog. */
+	void RemoveObjectUndoLog(FArticyObjectUndoLog* Log);
+
+	/**
+	 * Reverts the objects recorded in a log to the state they had when recording started: the recorded clones get
+	 * their recorded values, and the clones created since are destroyed. Apply the logs of later changes first.
+	 * Recording into other logs continues, so the reverted objects are recorded in them like any other write.
+	 * @param Log The log, which should not be recorded into anymore.
+	 * @return false if a shadow state is active, in which case nothing is changed.
+	 */
+	bool ApplyObjectUndoLog(const FArticyObjectUndoLog& Log);
+
 	//---------------------------------------------------------------------------//
 
 	/**
@@ -454,6 +945,121 @@ public:
 	 */
 	UArticyExpressoScripts* GetExpressoInstance() const;
 
+	/**
+	 * Gets an additional UArticyExpressoScripts instance, for explorations which run in parallel
+	 * to each other (see UArticyFlowPlayer::UpdateAvailableBranchesInParallel).
+	 * Each of them keeps its own current object, speaker and global variables while executing.
+	 * Must be called on the game thread.
+	 * @param Index The index of the parallel exploration.
+	 * @return A pointer to the UArticyExpressoScripts instance.
+	 */
+	UArticyExpressoScripts* GetParallelExpressoInstance(int32 Index) const;
+
+	/**
+	 * Evaluates many conditions at once, e.g. the availability of all entries of a quest log.
+	 * The context of the scripts is set up once for all of them, instead of once per Evaluate call, and the results
+	 * of the pure user methods are memoized across them. Providers without a script condition are evaluated with
+	 * their own Evaluate, null providers evaluate to true.
+	 * If WorkerGVs are passed (e.g. forks of GV, see UArticyGlobalVariables::Fork), the conditions are split across
+	 * that many workers, each evaluating with its own instance of the global variables; the user methods of the
+	 * methods provider must be safe to call from worker threads then. Must be called on the game thread.
+	 * @param Providers The conditions to evaluate.
+	 * @param GV The global variables, nullptr for the current ones.
+	 * @param MethodProvider The methods provider, nullptr for the default one.
+	 * @param OutResults Receives the result of each condition, at the index of its provider.
+	 * @param WorkerGVs The global variables of each worker, with the same state as GV.
+	 */
+	void EvaluateConditions(TConstArrayView<IArticyConditionProvider*> Providers, UArticyGlobalVariables* GV, UObject* MethodProvider,
+		TArray<bool>& OutResults, TConstArrayView<UArticyGlobalVariables*> WorkerGVs = {}) const;
+
+	/**
+	 * Returns the object that writes to Object should go to.
+	 * If Object is a package asset which a database shares as clone 0 (see bShareUnmodifiedObjectsWithPackages),
+	 * that database duplicates it now and returns the copy, which also replaces clone 0 from then on.
+	 * In a shadow state, the shadow copy of the current level is returned (and created on the first write).
+	 * Objects are only modified on the game thread, elsewhere nullptr is returned.
+	 * @param Object The object that is about to be modified.
+	 * @return The object to modify, or nullptr.
+	 */
+	static UArticyObject* GetWritableObject(UArticyObject* Object);
+
+	/**
+	 * Returns the object that reads of Object should go to, the counterpart of GetWritableObject.
+	 * In a shadow state, this is the most recent shadow copy at or below the current level, so reads see the writes
+	 * made in the state even through a pointer to the original.
+	 * @param Object Any copy of the object (original or shadow).
+	 * @return The object to read.
+	 */
+	static UArticyObject* GetReadableObject(UArticyObject* Object);
+
+	/**
+	 * Returns a counter which changes whenever objects are modified, loaded, unloaded or cloned outside of
+	 * shadow states, in any database. Used to invalidate results derived from the object state.
+	 */
+	static uint32 GetObjectStateVersion() { return ObjectStateVersion; }
+
+	/**
+	 * Returns a counter which changes whenever a resolved object may not be the one a lookup returns anymore, in any
+	 * database: objects are loaded or unloaded, clones are destroyed, a shared clone 0 gets its own copy, or the
+	 * database of a world is reset or unloaded. Writes don't change it, unlike GetObjectStateVersion.
+	 * Used by FArticyRef to cache the object it resolves.
+	 */
+	static uint32 GetObjectResolveVersion() { return ObjectResolveVersion; }
+
+	/**
+	 * Registers a secondary index on a property of the objects of a class (including subclasses), or returns the
+	 * index if the same one is registered already. Queries on the index find the objects with a value or within a
+	 * range without reading the property of every object, see FArticyPropertyIndex.
+	 * The index covers the unshadowed clone 0 of the loaded objects, and is kept up to date as they are written,
+	 * loaded and unloaded. Objects modified other than through SetProp, the generated setters or scripts, e.g.
+	 * through a reference returned by GetProp, must be reported with ReportObjectChanged.
+	 * @param Class The class of the indexed objects.
+	 * @param Property The indexed property, its name or Feature.Property, like in getProp.
+	 * @param Kind Whether equal values are looked up by hash or by binary search.
+	 * @return The index, or nullptr if the class has no such property.
+	 */
+	const FArticyPropertyIndex* RegisterPropertyIndex(TSubclassOf<UArticyObject> Class, const FString& Property, EArticyPropertyIndexKind Kind = EArticyPropertyIndexKind::Hashed);
+
+	/**
+	 * Returns a registered property index, updated with the changes since the last call.
+	 * The index and its views stay valid until objects are changed, loaded or unloaded.
+	 * @param Class The class of the indexed objects.
+	 * @param Property The indexed property.
+	 * @return The index, or nullptr if it is not registered.
+	 */
+	const FArticyPropertyIndex* GetPropertyIndex(TSubclassOf<UArticyObject> Class, const FString& Property) const;
+
+	/** Removes a registered property index. */
+	void UnregisterPropertyIndex(TSubclassOf<UArticyObject> Class, const FString& Property);
+
+	/**
+	 * Reports that an object was modified, so the property indices of its database read it again.
+	 * Writes through SetProp, the generated setters and scripts report themselves.
+	 * @param Object The modified object, any clone or shadow copy of it.
+	 */
+	static void ReportObjectChanged(const UArticyObject* Object);
+
+	/**
+	 * Returns the flow graph of the loaded packages, which the flow player explores instead of the objects.
+	 * The graph is built on first use, and rebuilt after packages were loaded or unloaded. While the default packages
+	 * of a cooked database are loaded, the graph is restored from the image built when it was cooked instead.
+	 * @return The flow graph of this database.
+	 */
+	const FArticyFlowGraph& GetFlowGraph() const;
+
+	/**
+	 * Returns the flow graph if it was built for the loaded packages, without building it.
+	 * @return The flow graph, or nullptr if it was not built yet or packages were loaded or unloaded since.
+	 */
+	const FArticyFlowGraph* FindFlowGraph() const;
+
+	/**
+	 * Returns the shadow copy of the current shadow level of an object, creating it if needed.
+	 * @param Object Any copy of the object (original or shadow).
+	 * @return The writable shadow copy.
+	 */
+	UArticyObject* GetShadowForWrite(UArticyObject* Object);
+
 	/** Retrieves a mutable original instance of the Articy database.
 	 * @return A weak pointer to the mutable UArticyDatabase instance.
 	 */
@@ -473,32 +1079,431 @@ protected:
 
 	/** A list of all packages that were imported from articy:draft. */
 	UPROPERTY(VisibleAnywhere, Category = "Articy")
-	TMap<FString, UArticyPackage*> ImportedPackages;
-
-	UPROPERTY(VisibleAnywhere, transient, Category = "Articy")
-	TArray<FString> LoadedPackages;
+	TMap<FString, FArticyPackageEntry> ImportedPackageEntries;
 
+	/** See GetHierarchy. */
 	UPROPERTY()
-	TMap<FArticyId, UArticyCloneableObject*> LoadedObjectsById;
+	FArticyHierarchy Hierarchy;
+
+	/** See GetVoiceOverIndex. */
 	UPROPERTY()
+	FArticyVoiceOverIndex VoiceOverIndex;
+
+	/** The package assets of the loaded (and loading) packages, which keeps them in memory. */
+	UPROPERTY(Transient)
+	TMap<FString, UArticyPackage*> ResidentPackages;
+
+	UPROPERTY(VisibleAnywhere, transient, Category = "Articy")
+	TSet<FString> LoadedPackages;
+
+	/** The containers of the loaded objects, which are owned by ContainerSlots. */
+	TMap<FArticyId, FArticyCloneableObject*> LoadedObjectsById;
 	TMap<FName, FArticyDatabaseObjectArray> LoadedObjectsByName;
 
 	void UnloadAllPackages();
 
+	/** Reports the clones and shadow copies of the loaded objects, which are held by the containers. */
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+	virtual void BeginDestroy() override;
+	virtual void PostLoad() override;
+
+	/** Saves and loads the flow graph image of cooked databases, see GetFlowGraph. */
+	virtual void Serialize(FArchive& Ar) override;
+
+#if WITH_EDITOR
+#if ENGINE_MAJOR_VERSION >= 5
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+#else
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+#endif
+
+	/** Builds the flow graph image of the default packages, with a transient copy of this database which loads them. */
+	void BuildFlowGraphImage();
+#endif
+
+	/**
+	 * Returns the asset of an imported package.
+	 * @param PackageName The name of the package.
+	 * @param bLoad Whether to load the package asset if it is not in memory yet.
+	 * @return The package asset, or nullptr if the package is unknown or not loaded.
+	 */
+	UArticyPackage* GetPackageAsset(const FString& PackageName, bool bLoad = true) const;
+
 private:
 
+	/** The hard package references of databases saved before the packages were referenced softly. */
+	UPROPERTY()
+	TMap<FString, UArticyPackage*> ImportedPackages_DEPRECATED;
+
+	friend class FArticyObjectOfClassIterator;
+	friend class FArticyCloneableObject;
+	friend class FArticyFlowGraph;
+	friend class FArticyDialogueTable;
+	friend class FArticyRuntimeBenchmark;
+	friend class UArticyObject;
+	friend struct FArticyObjectLink;
+
+	/** See GetObjectStateVersion, atomic as the flow players read it while exploring in parallel. */
+	static std::atomic<uint32> ObjectStateVersion;
+
+	/** See GetObjectResolveVersion. */
+	static std::atomic<uint32> ObjectResolveVersion;
+
 	static TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<UArticyDatabase>> Clones;
 	static TWeakObjectPtr<UArticyDatabase> PersistentClone;
 
+	/** The world Get resolved last and its clone, which saves the clones map lookup for repeated calls. */
+	static TWeakObjectPtr<UWorld> LastResolvedWorld;
+	static TWeakObjectPtr<UArticyDatabase> LastResolvedClone;
+
 	UPROPERTY()
 	mutable UArticyExpressoScripts* CachedExpressoScripts;
 
+	/** See GetParallelExpressoInstance. */
+	UPROPERTY(Transient)
+	mutable TArray<UArticyExpressoScripts*> ParallelExpressoScripts;
+
 	/** An instance of this class will be used to execute script fragments. */
 	UPROPERTY(Config, VisibleAnywhere, Category = "Articy")
 	TSubclassOf<UArticyExpressoScripts> ExpressoScriptsClass;
 
 	UArticyObject* GetObjectInternal(FArticyId Id, int32 CloneId = 0, bool bForceUnshadowed = false) const;
 
+	/**
+	 * Duplicates an object asset into the database and registers it in all lookup tables.
+	 * @param ArticyObject The object asset of a package.
+	 * @param bAddToNameIndex False if the caller adds the object to LoadedObjectsByName, see LoadPackage.
+	 * @return The unshadowed clone 0 of the object, or nullptr if an object with the same id is already loaded.
+	 */
+	UArticyObject* LoadObjectFromAsset(UArticyObject* ArticyObject, bool bAddToNameIndex = true);
+
+	/**
+	 * Package assets that are shared as clone 0, and the database that shares them.
+	 * An asset is shared by at most one database, others duplicate it as usual. The entry is kept once the asset was
+	 * replaced by a private copy, until the object is unloaded, so pointers to the asset resolve to the copy.
+	 */
+	static TMap<const UArticyObject*, TWeakObjectPtr<UArticyDatabase>> SharedObjectOwners;
+
+	/**
+	 * Replaces a shared package asset by a private copy, outered to the database, in all tables of the database.
+	 * @param Shared The shared package asset.
+	 * @return The private copy, also if the asset was replaced already.
+	 */
+	UArticyObject* MaterializeSharedObject(UArticyObject* Shared);
+
+	/**
+	 * Stops sharing the package asset of a container, if it shares one.
+	 * @param Container The container of the object that gets unloaded.
+	 */
+	void ReleaseSharedObject(FArticyCloneableObject* Container);
+
+	/** Stops sharing all package assets shared by this database. */
+	void ReleaseSharedObjects();
+
+#if WITH_EDITOR
+	/** The packages BeginPackageHotPatch unloaded, by their new name, and the clone ids of their objects. */
+	TArray<FString> HotPatchedPackages;
+	TMap<FArticyId, TArray<int32>> HotPatchedCloneIds;
+
+	/** Returns the world clones and the persistent clone of the running game. */
+	static TArray<UArticyDatabase*> GetRuntimeClones();
+#endif
+
+	/**
+	 * Resets a world clone to the state of a new clone, so the next world can reuse it (see bReuseWorldClones).
+	 * Loads the default packages only, removes the clones of the objects, and restores the objects which were
+	 * written since the clone was created or last reset from their package assets.
+	 */
+	void ResetToOriginal();
+
+	/** Whether GetWritableObject records the written objects in ModifiedObjectIds, set for reused world clones. */
+	bool bTrackModifiedObjects = false;
+
+	/** The objects whose clone 0 was written outside of shadow states, restored by ResetToOriginal. */
+	TSet<FArticyId> ModifiedObjectIds;
+
+	/** See AddObjectUndoLog. */
+	TArray<FArticyObjectUndoLog*> ObjectUndoLogs;
+
+	/**
+	 * Records the state of a clone in the undo logs which did not record it yet, see AddObjectUndoLog.
+	 * @param Object The clone which is about to be written, or which was just created.
+	 * @param bCreated Whether the clone was just created.
+	 */
+	void RecordObjectUndo(const UArticyObject* Object, bool bCreated) const;
+
+	/** Returns the package asset of an object from the resident packages, or nullptr if none is resident. */
+	const UArticyObject* FindPackageAsset(const FArticyId& Id) const;
+
+	/** See RegisterPropertyIndex, and the objects which changed since the indices were last updated. */
+	mutable TArray<TSharedPtr<FArticyPropertyIndex>> PropertyIndices;
+	mutable TSet<FArticyId> PendingIndexUpdates;
+
+	/** Marks an object for the property indices and the dialogue tables, if there are any. */
+	void MarkForPropertyIndices(const FArticyId& Id)
+	{
+		if (PropertyIndices.Num() > 0)
+			PendingIndexUpdates.Add(Id);
+		if (DialogueTables.Num() > 0)
+			PendingDialogueUpdates.Add(Id);
+	}
+
+	/** Updates the property indices with the pending changes. */
+	void UpdatePropertyIndices() const;
+
+	/** State of a package that is being loaded by LoadPackageAsync. */
+	struct FPendingPackageLoad
+	{
+		FString PackageName;
+		/** The assets of the package, owned by the package in ResidentPackages. */
+		TArray<UArticyObject*> Assets;
+		int32 NextAsset = 0;
+		TArray<FOnArticyPackageLoaded> Callbacks;
+	};
+
+	/** The packages that are still loading, in the order they were requested. */
+	TArray<FPendingPackageLoad> PendingPackageLoads;
+
+	/** The use of a non-default package, see UArticyPluginSettings::PackageResidencyBudgetMB. */
+	struct FPackageUsage
+	{
+		FString Name;
+		/** The memory of the objects of the package, measured when it is first loaded. */
+		int64 Bytes = 0;
+		uint64 LastUseFrame = 0;
+		int32 PinCount = 0;
+		bool bResident = false;
+		/** The objects of the package if it was evicted, which load it again when they are requested. */
+		TArray<FArticyId> EvictedIds;
+	};
+
+	TArray<FPackageUsage> PackageUsage;
+	TMap<FString, int32> PackageUsageIndices;
+	/** The objects of the evicted packages, and the index of their package in PackageUsage. */
+	TMap<FArticyId, int32> EvictedObjects;
+	/** The memory of the resident non-default packages. */
+	int64 ResidentPackageBytes = 0;
+	/** Set once a non-default package is loaded with a residency budget, GetObject tracks the use of the packages then. */
+	bool bTrackPackageUsage = false;
+
+	FTSTicker::FDelegateHandle EvictionTickerHandle;
+
+	/** Returns the usage entry of a package, adding it if needed. */
+	int32 FindOrAddPackageUsage(const FString& PackageName);
+
+	/**
+	 * Starts tracking the use of a package that was loaded, if there is a residency budget.
+	 * @param PackageName The name of the package.
+	 * @param Assets The object assets of the package.
+	 */
+	void OnPackageResident(const FString& PackageName, TConstArrayView<UArticyObject*> Assets);
+
+	/** Stops tracking a package that was unloaded, before its objects are removed. */
+	void OnPackageNotResident(const FString& PackageName);
+
+	/** Schedules EvictPackages for the end of the frame, if the resident packages exceed the budget. */
+	void ScheduleEviction();
+
+	/** Returns true if one of the objects has clones or was written, which keeps its package from being evicted. */
+	bool HasRuntimeState(TConstArrayView<FArticyId> Ids) const;
+
+	/**
+	 * Unloads the least recently used, unpinned packages until the resident packages fit into the budget again.
+	 * Packages used in this frame, and packages whose objects have clones or were written, are kept.
+	 * Nothing is evicted inside a shadow state.
+	 * @param DeltaTime The time since the last tick.
+	 * @return False, the ticker runs once.
+	 */
+	bool EvictPackages(float DeltaTime);
+
+	/** The tracked path of GetObjectInternal: marks the package of the object as used, and starts loading evicted packages again. */
+	UArticyObject* GetResidentObject(FArticyId Id, int32 CloneId, bool bForceUnshadowed);
+
+	/** The not yet duplicated assets of all loading packages, used to resolve GetObject on demand. */
+	TMap<FArticyId, UArticyObject*> PendingObjectsById;
+
+	FTSTicker::FDelegateHandle AsyncLoadTickerHandle;
+
+	/**
+	 * Loads the next slice of the pending packages.
+	 * @param DeltaTime The time since the last tick.
+	 * @return True while there are pending packages left.
+	 */
+	bool TickAsyncLoads(float DeltaTime);
+
+	/**
+	 * Loads the remaining objects of a pending package up to a deadline.
+	 * Does not finish the package, see FinishPendingLoad.
+	 * @param Load The pending package load.
+	 * @param Deadline The platform time at which to stop, or 0 to load all remaining objects.
+	 * @return True if all objects of the package are loaded.
+	 */
+	bool ContinuePendingLoad(FPendingPackageLoad& Load, double Deadline);
+
+	/**
+	 * Marks the pending package load at the given index as loaded and fires its callbacks.
+	 * @param Index The index into PendingPackageLoads.
+	 */
+	void FinishPendingLoad(int32 Index);
+
+	/**
+	 * Synchronously finishes loading a pending package, if it is pending.
+	 * @param PackageName The name of the package.
+	 */
+	void FlushPendingLoad(const FString& PackageName);
+
+	/** Drops all pending package loads without loading them. */
+	void CancelPendingLoads();
+
+	/**
+	 * Loads an object of a package which is still loading out of order, so GetObject can return it.
+	 * @param Id The id of the object.
+	 * @return The unshadowed clone 0 of the object, or nullptr if no loading package contains it.
+	 */
+	UArticyObject* ResolvePendingObject(const FArticyId& Id);
+
+	/**
+	 * The storage of the object containers. Containers of unloaded objects are released and reused rather than
+	 * freed, so the pointers links and undo records hold stay valid as long as the database exists.
+	 */
+	TArray<TUniquePtr<FArticyCloneableObject>> ContainerSlots;
+
+	/** The indices of the released containers in ContainerSlots. */
+	TArray<int32> FreeContainerSlots;
+
+	/** Returns an empty container for an object that is loaded. */
+	FArticyCloneableObject* AllocateContainer();
+
+	/**
+	 * Releases the container of an object that is unloaded.
+	 * @param Container The container, which may be reused by the next object that is loaded.
+	 */
+	void ReleaseContainer(FArticyCloneableObject* Container);
+
+	/** All loaded objects, bucketed by the exact class of their clone 0. */
+	TMap<const UClass*, TArray<FArticyCloneableObject*>> ObjectsByClass;
+
+	/**
+	 * For each queried class, the classes in ObjectsByClass which are the class itself or a subclass of it.
+	 * The arrays are heap allocated, so iterators can keep referencing them while other classes are queried.
+	 */
+	mutable TMap<const UClass*, TUniquePtr<TArray<const UClass*>>> MatchingClassesCache;
+
+	/**
+	 * Adds a loaded object to the class index.
+	 * @param Container The container of the object.
+	 * @param Class The class of the object.
+	 */
+	void AddToClassIndex(FArticyCloneableObject* Container, const UClass* Class);
+
+	/**
+	 * Removes an unloaded object from the class index.
+	 * @param Container The container of the object.
+	 * @param Class The class of the object.
+	 */
+	void RemoveFromClassIndex(FArticyCloneableObject* Container, const UClass* Class);
+
+	/**
+	 * Removes an unloaded object from the name index.
+	 * @param Container The container of the object.
+	 * @param TechnicalName The technical name of the object.
+	 */
+	void RemoveFromNameIndex(FArticyCloneableObject* Container, FName TechnicalName);
+
+	/**
+	 * Adds a reference from a loaded package to one of its objects, loading the object if necessary.
+	 * @param ArticyObject The object asset of the package.
+	 */
+	void AddPackageReference(UArticyObject* ArticyObject);
+
+	/**
+	 * Returns the classes in ObjectsByClass which are Class or a subclass of it.
+	 * @param Class The queried class.
+	 * @return The matching classes.
+	 */
+	const TArray<const UClass*>& GetMatchingClasses(const UClass* Class) const;
+
+	/** A single slot of the flat object table. */
+	struct FObjectTableSlot
+	{
+		FArticyId Id;
+		UArticyObject* Object = nullptr;
+	};
+
+	/**
+	 * Open-addressed table (linear probing, power-of-two capacity) which maps the id of
+	 * every loaded object to its unshadowed clone 0. This is the hot path of GetObject,
+	 * all other clones and shadow levels are resolved through LoadedObjectsById.
+	 * The objects are kept alive by LoadedObjectsById, so this table does not need to be a UPROPERTY.
+	 */
+	TArray<FObjectTableSlot> ObjectTable;
+
+	/** Changes whenever an object is added to or removed from the object table. */
+	uint32 ObjectTableVersion = 0;
+
+	/** Changes whenever an id is added to or removed from the object table, but not if only the object of an id is replaced. */
+	uint32 ObjectTableIdsVersion = 0;
+
+	/** See GetLocationIndex, and the object table version they were built from. */
+	mutable TMap<FArticyId, TSharedPtr<const FArticyLocationIndex>> LocationIndices;
+	mutable uint32 LocationIndicesVersion = 0;
+
+	/** See GetDialogueTable, the object table version they were built from, and the objects written since they were updated. */
+	mutable TMap<FString, TSharedPtr<FArticyDialogueTable>> DialogueTables;
+	mutable uint32 DialogueTablesVersion = 0;
+	mutable TSet<FArticyId> PendingDialogueUpdates;
+
+	/** See GetFlowGraph, the object table ids version it was built from, and the objects replaced since it was updated. */
+	mutable TUniquePtr<FArticyFlowGraph> FlowGraph;
+	mutable uint32 FlowGraphVersion = 0;
+	mutable TSet<FArticyId> PendingFlowGraphUpdates;
+
+	/** The flow graph of the default packages of a cooked database, shared with its clones. See GetFlowGraph. */
+	TSharedPtr<FArticyFlowGraphImage> FlowGraphImage;
+
+	/**
+	 * Rebuilds the object table from LoadedObjectsById.
+	 * @param MinNum The minimum number of objects the table should have room for.
+	 */
+	void RebuildObjectTable(int32 MinNum = 0);
+
+	/**
+	 * Makes sure the object table can hold NumObjects objects without exceeding its load factor.
+	 * @param NumObjects The number of objects the table must be able to hold.
+	 */
+	void ReserveObjectTable(int32 NumObjects);
+
+	/**
+	 * Inserts an object into the object table, the table must have enough room left.
+	 * @param Id The id of the object.
+	 * @param Object The unshadowed clone 0 of the object.
+	 */
+	void AddToObjectTable(const FArticyId& Id, UArticyObject* Object);
+
+	/**
+	 * Removes an object from the object table (backward shift deletion).
+	 * @param Id The id of the object.
+	 */
+	void RemoveFromObjectTable(const FArticyId& Id);
+
+	/**
+	 * Looks up the unshadowed clone 0 of an object in the object table.
+	 * @param Id The id of the object.
+	 * @return The object, or nullptr if it is not in the table.
+	 */
+	UArticyObject* FindInObjectTable(const FArticyId& Id) const;
+
+	/**
+	 * The link pass: resolves the references between the loaded objects (connections, jumps, parents) to the loaded
+	 * objects in one sweep, see UArticyBaseObject::LinkReferences. Run after packages were loaded or unloaded,
+	 * references to objects of packages which are not loaded are unlinked and still looked up by id.
+	 */
+	void LinkObjects();
+
+	/** Set while LoadAllPackages loads the packages, which links the objects once instead of after each package. */
+	bool bDeferLinking = false;
+
 	/** Get the original asset (on disk) of the database.
 	 * @param bLoadDefaultPackages If true, loads all packages.
 	 * @return A pointer to the original UArticyDatabase asset.
@@ -520,41 +1525,102 @@ private:
 	static FAssetId ResolveIDs(const FString& articyAssetFileName);
 };
 
+/**
+ * Iterates over all objects of a class (including subclasses) in a database, without allocating.
+ * Usage: for (auto It = Database->CreateObjectOfClassIterator(Class); It; ++It) { UArticyObject* Object = *It; }
+ */
+class ARTICYRUNTIME_API FArticyObjectOfClassIterator
+{
+public:
+	/**
+	 * Creates the iterator and moves it to the first object.
+	 * @param Database The database to iterate.
+	 * @param Class The class of the objects to iterate.
+	 * @param CloneId The clone ID of the objects.
+	 * @param bForceUnshadowed If true, the unshadowed objects are returned.
+	 */
+	FArticyObjectOfClassIterator(const UArticyDatabase* Database, const UClass* Class, int32 CloneId, bool bForceUnshadowed);
+
+	/** Advances to the next object. */
+	FArticyObjectOfClassIterator& operator++() { Advance(); return *this; }
+
+	/** Returns true while the iterator points to an object. */
+	explicit operator bool() const { return Current != nullptr; }
+
+	UArticyObject* operator*() const { return Current; }
+	UArticyObject* operator->() const { return Current; }
+
+private:
+	void Advance();
+
+	const UArticyDatabase* Database;
+	const TArray<const UClass*>& Classes;
+	int32 CloneId;
+	bool bForceUnshadowed;
+
+	int32 ClassIndex = 0;
+	int32 ObjectIndex = -1;
+	const TArray<FArticyCloneableObject*>* Bucket = nullptr;
+	UArticyObject* Current = nullptr;
+};
+
 template<typename T>
 TArray<T*> UArticyDatabase::GetObjects(FName TechnicalName, int32 CloneId) const
 {
-	static TArray<T*> Array;
-	Array.Reset();
-
+	TArray<T*> Array;
 	GetObjects(Array, TechnicalName, CloneId);
 
 	return Array;
 }
 
-template<typename T>
-TArray<T*> UArticyDatabase::GetObjectsOfClass(int32 CloneId) const
+template<typename TVisitor>
+void UArticyDatabase::ForEachObject(const UClass* Class, int32 CloneId, TVisitor&& Visitor) const
 {
-	TArray<T*> arr;
+	if (Class)
+	{
+		for (auto It = CreateObjectOfClassIterator(Class, CloneId); It; ++It)
+			Visitor(*It);
+		return;
+	}
 
-	TArray<UArticyCloneableObject*> ArticyObjects;
-	LoadedObjectsById.GenerateValueArray(ArticyObjects);
+	for (const auto& Pair : LoadedObjectsById)
+	{
+		UArticyObject* Object = Pair.Value ? Pair.Value->Get(this, CloneId) : nullptr;
+		if (Object)
+			Visitor(Object);
+	}
+}
 
-	for (auto obj : ArticyObjects)
+template<typename TVisitor>
+void UArticyDatabase::ForEachDescendant(const FArticyId& Id, int32 CloneId, TVisitor&& Visitor) const
+{
+	for (const FArticyId& Descendant : Hierarchy.GetDescendants(Id))
 	{
-		/*if (obj->GetCloneId() == CloneId && Cast<T>(obj))
-		{
-			arr.Add(obj);
-		}*/
+		UArticyObject* Object = GetObject(Descendant, CloneId);
+		if (Object)
+			Visitor(Object);
+	}
+}
 
-		UArticyObject* Object = obj->Get(this, CloneId, false);
+template<typename TVisitor>
+void UArticyDatabase::ForEachObjectByName(FName TechnicalName, int32 CloneId, TVisitor&& Visitor) const
+{
+	for (FArticyCloneableObject* Container : GetObjectContainersByName(TechnicalName))
+	{
+		UArticyObject* Object = Container ? Container->Get(this, CloneId) : nullptr;
 		if (Object)
-		{
-			T* TypedObject = Cast<T>(Object);
-			if (TypedObject)
-			{
-				arr.Add(TypedObject);
-			}
-		}
+			Visitor(Object);
+	}
+}
+
+template<typename T>
+TArray<T*> UArticyDatabase::GetObjectsOfClass(int32 CloneId) const
+{
+	TArray<T*> arr;
+
+	for (auto It = CreateObjectOfClassIterator(T::StaticClass(), CloneId); It; ++It)
+	{
+		arr.Add(static_cast<T*>(*It));
 	}
 	return arr;
 }
@@ -562,15 +1628,15 @@ TArray<T*> UArticyDatabase::GetObjectsOfClass(int32 CloneId) const
 template<typename T>
 void UArticyDatabase::GetObjects(TArray<T*>& Array, FName TechnicalName, int32 CloneId) const
 {
-	//find all objects with this name
-	auto arr = LoadedObjectsByName.Find(TechnicalName);
-	if (arr)
+	//find all objects with this name, cloning the ones without the clone
+	const bool bCreateClones = CloneId != 0 && IsInGameThread();
+	for (FArticyCloneableObject* Container : GetObjectContainersByName(TechnicalName))
 	{
-		for (auto obj : arr->Objects)
-		{
-			auto clone = Cast<T>(obj->Clone(this, CloneId));
-			if (clone)
-				Array.Add(clone);
-		}
+		UArticyObject* Object = nullptr;
+		if (Container)
+			Object = bCreateClones ? Container->Clone(this, CloneId, false) : Container->Get(this, CloneId);
+
+		if (T* TypedObject = Cast<T>(Object))
+			Array.Add(TypedObject);
 	}
 }
@@ -0,0 +1,85 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+
+class UArticyDatabase;
+class UArticyObject;
+
+/**
+ * @class FArticyDialogueTable
+ * @brief The fields dialogue UIs read from the dialogue fragments of a package, as arrays by row.
+ *
+ * Each field is an array with one entry per dialogue fragment, so reading e.g. the texts of a long dialogue history
+ * reads a contiguous array instead of hundreds of objects. The row of a fragment is found with FindRow; rows are in
+ * the order of the assets of the package, and GetNodeIndices maps them to the dense indices of the flow graph (see
+ * FArticyFlowGraph::FindNode), e.g. for lookahead code exploring the graph.
+ *
+ * The texts are the values of the properties, as GetProperty returns them; they still need to be localized like
+ * IArticyObjectWithText::GetText does (see ArticyHelpers::LocalizeString) when the text extension is used.
+ *
+ * The database builds the table of a package on first use, rebuilds it after packages were loaded or unloaded, and
+ * updates the rows of the fragments written through SetProp, the generated setters or scripts before returning it
+ * again, see UArticyDatabase::GetDialogueTable. Fragments modified otherwise are picked up after
+ * UArticyDatabase::ReportObjectChanged. The views are valid until then.
+ */
+class ARTICYRUNTIME_API FArticyDialogueTable
+{
+public:
+
+	/**
+	 * Builds the table of the dialogue fragments of a loaded package.
+	 * @param Database The database the package is loaded into.
+	 * @param PackageName The name of the package.
+	 */
+	FArticyDialogueTable(const UArticyDatabase* Database, const FString& PackageName);
+
+	/** Returns the number of rows, i.e. dialogue fragments. */
+	int32 Num() const { return Ids.Num(); }
+
+	/** Returns the row of a dialogue fragment, or INDEX_NONE if it is not part of the package. */
+	int32 FindRow(const FArticyId& Id) const;
+
+	TConstArrayView<FArticyId> GetIds() const { return Ids; }
+
+	/** The index of each fragment in the flow graph of the database, INDEX_NONE if it is not part of it. */
+	TConstArrayView<int32> GetNodeIndices() const { return NodeIndices; }
+
+	TConstArrayView<FText> GetTexts() const { return Texts; }
+	TConstArrayView<FText> GetMenuTexts() const { return MenuTexts; }
+	TConstArrayView<FText> GetStageDirections() const { return StageDirections; }
+
+	/** The id of the speaker of each fragment, null if it has none. */
+	TConstArrayView<FArticyId> GetSpeakers() const { return Speakers; }
+
+	/** The id of the asset of the preview image of each fragment, null if it has none. */
+	TConstArrayView<FArticyId> GetPreviewImageAssets() const { return PreviewImageAssets; }
+
+private:
+
+	friend class UArticyDatabase;
+
+	TArray<FArticyId> Ids;
+	TArray<int32> NodeIndices;
+	TArray<FText> Texts;
+	TArray<FText> MenuTexts;
+	TArray<FText> StageDirections;
+	TArray<FArticyId> Speakers;
+	TArray<FArticyId> PreviewImageAssets;
+
+	TMap<FArticyId, int32> RowById;
+
+	/**
+	 * Reads the row of a fragment again after it was written.
+	 * @param Id The id of the fragment.
+	 * @param Object The current unshadowed clone 0 of the fragment.
+	 */
+	void Update(const FArticyId& Id, const UArticyObject* Object);
+
+	/** Reads the fields of a fragment into a row. */
+	void ReadRow(int32 Row, const UArticyObject* Object);
+};
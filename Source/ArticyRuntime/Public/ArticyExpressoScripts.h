@@ -5,8 +5,11 @@
 #pragma once
 
 #include "Internationalization/Regex.h"
+#include "HAL/CriticalSection.h"
+#include "Algo/BinarySearch.h"
 #include "ArticyObject.h"
 #include "ArticyDatabase.h"
+#include "ArticyFlowReplay.h"
 
 #include "ArticyExpressoScripts.generated.h"
 
@@ -34,87 +37,112 @@ struct ARTICYRUNTIME_API ExpressoType
 
     /**
      * @brief Enumeration for the type of the ExpressoType.
+     *
+     * Objects are held as their id (in IntValue) and clone id, and only formatted as "Id_CloneId" strings
+     * when they are converted to strings, e.g. to be stored in a string variable.
      */
-    enum EType
+    enum EType : uint8
     {
-        Undefined, Bool, Int, Float, String
+        Undefined, Bool, Int, Float, String, Object
     } Type = Undefined;   ///< The type of the ExpressoType
 
+    int32 CloneIdValue = 0;   ///< Clone id of an Object value
+
     /**
      * @brief Retrieves the boolean value of the ExpressoType.
      *
      * @return The boolean value.
      */
-    virtual bool& GetBool();
+    FORCEINLINE bool& GetBool() { return BoolValue; }
 
     /**
      * @brief Retrieves the boolean value of the ExpressoType.
      *
      * @return The boolean value.
      */
-    virtual const bool& GetBool() const;
+    FORCEINLINE const bool& GetBool() const { return BoolValue; }
 
     /**
      * @brief Retrieves the int64 value of the ExpressoType.
      *
      * @return The int64 value.
      */
-    virtual int64& GetInt();
+    FORCEINLINE int64& GetInt() { return IntValue; }
 
     /**
      * @brief Retrieves the int64 value of the ExpressoType.
      *
      * @return The int64 value.
      */
-    virtual const int64& GetInt() const;
+    FORCEINLINE const int64& GetInt() const { return IntValue; }
 
     /**
      * @brief Retrieves the double value of the ExpressoType.
      *
      * @return The double value.
      */
-    virtual double& GetFloat();
+    FORCEINLINE double& GetFloat() { return FloatValue; }
 
     /**
      * @brief Retrieves the double value of the ExpressoType.
      *
      * @return The double value.
      */
-    virtual const double& GetFloat() const;
+    FORCEINLINE const double& GetFloat() const { return FloatValue; }
 
     /**
      * @brief Retrieves the string value of the ExpressoType.
      *
      * @return The string value.
      */
-    virtual FString& GetString();
+    FORCEINLINE FString& GetString() { return StringValue; }
 
     /**
      * @brief Retrieves the string value of the ExpressoType.
      *
      * @return The string value.
      */
-    virtual const FString& GetString() const;
+    FORCEINLINE const FString& GetString() const { return StringValue; }
+
+    /**
+     * @brief Retrieves the id of an Object value.
+     *
+     * @return The id of the object.
+     */
+    FORCEINLINE FArticyId GetObjectId() const { return FArticyId{ static_cast<uint64>(IntValue) }; }
+
+    /**
+     * @brief Retrieves the clone id of an Object value.
+     *
+     * @return The clone id of the object.
+     */
+    FORCEINLINE int32 GetCloneId() const { return CloneIdValue; }
 
     /**
      * @brief Converts the ExpressoType instance to a string representation.
      *
      * @return The string representation of the ExpressoType.
      */
-    virtual FString ToString() const;
+    FString ToString() const;
 
 
     //---------------------------------------------------------------------------//
 
     /**
      * @brief Default constructor for ExpressoType.
+     *
+     * The type has no virtual members, and an empty FString does not allocate,
+     * so numeric values (the usual temporaries of conditions) never touch the heap.
      */
-    ExpressoType();
+    ExpressoType() = default;
 
     /**
-     * @brief Virtual destructor for ExpressoType.
+     * @brief Copy and move are defaulted, so temporaries (and their strings) are moved instead of copied.
      */
-    virtual ~ExpressoType();
+    ExpressoType(const ExpressoType&) = default;
+    ExpressoType(ExpressoType&&) = default;
+    ExpressoType& operator=(const ExpressoType&) = default;
+    ExpressoType& operator=(ExpressoType&&) = default;
 
     /**
      * @brief Constructs an ExpressoType from an object and a property name.
@@ -214,6 +242,13 @@ struct ARTICYRUNTIME_API ExpressoType
      */
     ExpressoType(const FString& Value);
 
+    /**
+     * @brief Constructs an ExpressoType from a temporary string, taking over its storage.
+     *
+     * @param Value The string value to initialize the ExpressoType with.
+     */
+    ExpressoType(FString&& Value);
+
     /**
      * @brief Constructs an ExpressoType from an FText value.
      *
@@ -620,9 +655,10 @@ struct ARTICYRUNTIME_API ExpressoType
      *
      * @param Object The object containing the property.
      * @param Property The name of the property.
+     * @param bForWrite If true, a feature shared with clones is copied into Object first.
      * @return The feature object, if rerouted, or the original object if not rerouted.
      */
-    static UArticyBaseObject* TryFeatureReroute(UArticyBaseObject* Object, FString& Property);
+    static UArticyBaseObject* TryFeatureReroute(UArticyBaseObject* Object, FString& Property, bool bForWrite = false);
 };
 
 /**
@@ -681,6 +717,113 @@ void ExpressoType::AddDefinition(const FName& CppType)
     Definitions.Add(CppType, def);
 }
 
+/**
+ * @brief A property path of getProp/setProp which is known when the scripts are generated.
+ *
+ * The path is split into feature and property name once, and the reflected property and its type
+ * definition are cached for the class the path was last used with. The script generator emits one
+ * instance per call site (see ARTICY_EXPRESSO_PROPERTY), dynamic paths still use the FString overloads.
+ */
+class ARTICYRUNTIME_API ExpressoProperty
+{
+public:
+    /**
+     * @brief Constructs a property access from a path.
+     *
+     * @param InPath The property name, or Feature.Property for feature properties.
+     */
+    explicit ExpressoProperty(const FString& InPath);
+
+    /**
+     * @brief Retrieves the value of the property on an object.
+     *
+     * @param Object The object containing the property (or its feature).
+     * @return The value of the property.
+     */
+    ExpressoType Get(UArticyBaseObject* Object) const;
+
+    /**
+     * @brief Sets the value of the property on an object.
+     *
+     * @param Object The object containing the property (or its feature).
+     * @param Value The value to set.
+     */
+    void Set(UArticyBaseObject* Object, const ExpressoType& Value) const;
+
+    /** @brief Returns the path this access was constructed from. */
+    const FString& GetPath() const { return Path; }
+
+private:
+    /**
+     * @brief Finds the object holding the property, and the property with its type definition.
+     *
+     * @param Object The object containing the property (or its feature).
+     * @param OutProperty The reflected property.
+     * @param OutDefinition The type definition of the property.
+     * @param bForWrite If true, a feature shared with clones is copied into Object first.
+     * @return The object holding the property (the feature for feature properties), or nullptr.
+     */
+    UArticyBaseObject* Resolve(UArticyBaseObject* Object, FProperty*& OutProperty, const ExpressoType::Definition*& OutDefinition, bool bForWrite = false) const;
+
+    /** A reflected property, cached for one class. */
+    struct FCachedProperty
+    {
+        const UClass* Class = nullptr;
+        FProperty* Property = nullptr;
+        const ExpressoType::Definition* Definition = nullptr;
+    };
+
+    FString Path;
+    FName Feature;
+    FName Property;
+
+    /** The feature property on the object, and the property on the feature (or object). */
+    mutable FCachedProperty CachedFeature;
+    mutable FCachedProperty CachedProperty;
+
+    /** Scripts may be evaluated by parallel flow exploration. */
+    mutable FRWLock CacheLock;
+};
+
+/**
+ * @brief Creates a static ExpressoProperty for a literal property path, once per call site.
+ */
+#define ARTICY_EXPRESSO_PROPERTY(Path) ([]() -> const ExpressoProperty& { static const ExpressoProperty StaticExpressoProperty(Path); return StaticExpressoProperty; }())
+
+/**
+ * @brief An object reference of getObj/getSeenCounter/setSeenCounter which was resolved when the scripts were generated.
+ *
+ * The script generator resolves literal names and ids to the id of the object, so the call looks the object up by id
+ * instead of parsing the string or searching it by name. The seen counter slot (see FArticySeenCounterSlots) is
+ * assigned once, so reading the seen counter is an array access. Literals the generator could not resolve, e.g.
+ * technical names of several objects, still use the FString overloads.
+ */
+class ARTICYRUNTIME_API ExpressoObjectId
+{
+public:
+    /**
+     * @brief Constructs an object reference from an id.
+     *
+     * @param InId The id of the object.
+     */
+    explicit ExpressoObjectId(uint64 InId);
+
+    /** @brief Returns the id of the object. */
+    const FArticyId& GetId() const { return Id; }
+
+    /** @brief Returns the seen counter slot of the object. */
+    int32 GetSeenCounterSlot() const { return SeenCounterSlot; }
+
+private:
+    FArticyId Id;
+    int32 SeenCounterSlot;
+};
+
+/**
+ * @brief Creates a static ExpressoObjectId for an object id resolved by the script generator, once per call site.
+ */
+#define ARTICY_EXPRESSO_OBJECT(Id) ([]() -> const ExpressoObjectId& { static const ExpressoObjectId StaticExpressoObjectId(Id); return StaticExpressoObjectId; }())
+
 /**
  * @brief Addition operator for int and ExpressoType.
  *
@@ -807,6 +950,61 @@ FORCEINLINE float operator/(const float& Lhs, const ExpressoType& Rhs)
     return Lhs / (float)Rhs;
 }
 
+/**
+ * @brief What a script accesses besides the global variables, see FArticyScriptAccess.
+ */
+enum class EArticyScriptAccess : uint8
+{
+    None = 0,
+    /** Reads or writes seen counters: seen, unseen, getSeenCounter, setSeenCounter, resetAllSeenCounters or fallback. */
+    SeenCounters = 1 << 0,
+    /** Reads or writes properties of objects: getProp, setProp, incrementProp, decrementProp or isPropInRange. */
+    ObjectProperties = 1 << 1,
+    /** Calls user methods, which may access anything. */
+    UserMethods = 1 << 2,
+    /** The accesses are not known, e.g. for scripts the importer could not parse: the script may access anything. */
+    Unknown = 1 << 3,
+};
+ENUM_CLASS_FLAGS(EArticyScriptAccess);
+
+/**
+ * @brief An entry of the generated access tables: the range of the variable table holding the variables a script
+ * reads, followed by the ones it writes.
+ */
+struct FArticyScriptAccessEntry
+{
+    int32 Begin;
+    uint16 NumReads;
+    uint16 NumWrites;
+    uint8 Flags;
+};
+
+/**
+ * @brief What a script reads and writes, found by the importer and generated with the scripts (see
+ * UArticyExpressoScripts::GetScriptAccess).
+ *
+ * The variables are the ones the script itself accesses; user methods and builtins may access more, see Flags.
+ */
+struct ARTICYRUNTIME_API FArticyScriptAccess
+{
+    /** The dense indices (see UArticyGlobalVariables::GetVariableIndex) of the variables read, in ascending order. */
+    TConstArrayView<int32> ReadVariables;
+
+    /** The dense indices of the variables written, in ascending order. Variables incremented or compound assigned are read too. */
+    TConstArrayView<int32> WrittenVariables;
+
+    EArticyScriptAccess Flags = EArticyScriptAccess::Unknown;
+
+    /** Returns true if all accesses are known, i.e. the script accesses no other variables than the listed ones. */
+    bool IsKnown() const { return !EnumHasAnyFlags(Flags, EArticyScriptAccess::Unknown | EArticyScriptAccess::UserMethods); }
+
+    /** Returns true if the script may read a variable. */
+    bool MayRead(int32 VariableIndex) const { return !IsKnown() || Algo::BinarySearch(ReadVariables, VariableIndex) != INDEX_NONE; }
+
+    /** Returns true if the script may write a variable. */
+    bool MayWrite(int32 VariableIndex) const { return !IsKnown() || Algo::BinarySearch(WrittenVariables, VariableIndex) != INDEX_NONE; }
+};
+
 /**
  * @brief The UArticyExpressoScripts class manages script conditions and instructions.
  *
@@ -823,13 +1021,12 @@ public:
 
     /**
      * @brief Default constructor for UArticyExpressoScripts.
+     *
+     * The scripts are compiled into the static tables of the generated class, which all instances share, and the
+     * empty scripts are handled without a table, so an instance only holds its per-context state (see SetGV)
+     * and constructing one does not depend on the number of scripts.
      */
-    UArticyExpressoScripts()
-    {
-        //add empty condition and instruction
-        Conditions.Add(GetTypeHash(FString{ "" }), [&] { return true; });
-        Instructions.Add(GetTypeHash(FString{ "" }), [&] { return; });
-    }
+    UArticyExpressoScripts() = default;
 
     /**
      * @brief Retrieves the user methods provider interface.
@@ -903,6 +1100,59 @@ public:
      */
     bool Execute(const int& InstructionFragmentHash, UArticyGlobalVariables* GV, UObject* MethodProvider) const;
 
+    /**
+     * @brief Returns the index of a condition in the generated script table.
+     *
+     * The index is the same for all instances of a class, so it can be resolved once and passed to EvaluateByIndex.
+     *
+     * @param ConditionFragmentHash The hash of the condition fragment.
+     * @return The index of the condition, or INDEX_NONE if it is not part of the table.
+     */
+    int32 GetConditionIndex(const int& ConditionFragmentHash) const { return FindCondition(static_cast<uint32>(ConditionFragmentHash)); }
+
+    /**
+     * @brief Returns the index of an instruction in the generated script table, see GetConditionIndex.
+     *
+     * @param InstructionFragmentHash The hash of the instruction fragment.
+     * @return The index of the instruction, or INDEX_NONE if it is not part of the table.
+     */
+    int32 GetInstructionIndex(const int& InstructionFragmentHash) const { return FindInstruction(static_cast<uint32>(InstructionFragmentHash)); }
+
+    /**
+     * @brief Evaluates a condition by its table index, without looking it up.
+     *
+     * @param ConditionIndex The index from GetConditionIndex, or INDEX_NONE to look the condition up by its hash.
+     * @param ConditionFragmentHash The hash of the condition fragment.
+     * @param GV The global variables used in the evaluation.
+     * @param MethodProvider The method provider used in the evaluation.
+     * @return The result of the evaluation.
+     */
+    bool EvaluateByIndex(int32 ConditionIndex, const int& ConditionFragmentHash, UArticyGlobalVariables* GV, UObject* MethodProvider) const;
+
+    /**
+     * @brief Executes an instruction by its table index, without looking it up.
+     *
+     * @param InstructionIndex The index from GetInstructionIndex, or INDEX_NONE to look the instruction up by its hash.
+     * @param InstructionFragmentHash The hash of the instruction fragment.
+     * @param GV The global variables used in the execution.
+     * @param MethodProvider The method provider used in the execution.
+     * @return True if the execution was successful, false otherwise.
+     */
+    bool ExecuteByIndex(int32 InstructionIndex, const int& InstructionFragmentHash, UArticyGlobalVariables* GV, UObject* MethodProvider) const;
+
+    /**
+     * @brief Evaluates several conditions with the same global variables and methods provider.
+     *
+     * The context is set up once for all of them, and the results of the pure user methods are memoized
+     * across them. See UArticyDatabase::EvaluateConditions.
+     *
+     * @param ConditionFragmentHashes The hashes of the condition fragments.
+     * @param GV The global variables used in the evaluation.
+     * @param MethodProvider The method provider used in the evaluation.
+     * @param OutResults Receives the result of each condition, at the index of its hash.
+     */
+    void EvaluateMany(TConstArrayView<int32> ConditionFragmentHashes, UArticyGlobalVariables* GV, UObject* MethodProvider, TArrayView<bool> OutResults) const;
+
     /**
      * @brief Sets a default method provider for script evaluation and execution.
      *
@@ -941,8 +1191,98 @@ public:
      */
     virtual UArticyGlobalVariables* GetGV() { return nullptr; }
 
+    /**
+     * @brief Memoizes the results of the pure user methods while it exists (see UArticyPluginSettings::PureScriptMethods).
+     *
+     * The flow player opens one per exploration of the available branches, so a pure method called with the same
+     * arguments on several branches is only called once. Scopes may be nested, the results are discarded when
+     * the outermost one ends.
+     */
+    struct ARTICYRUNTIME_API FMethodMemoScope
+    {
+        explicit FMethodMemoScope(const UArticyExpressoScripts* InScripts);
+        ~FMethodMemoScope();
+
+        FMethodMemoScope(const FMethodMemoScope&) = delete;
+        FMethodMemoScope& operator=(const FMethodMemoScope&) = delete;
+
+    private:
+        const UArticyExpressoScripts* Scripts;
+    };
+
+    /** @brief Returns true while the results of the pure user methods are memoized. */
+    bool IsMemoizingMethods() const { return MethodMemoDepth > 0; }
+
+    /**
+     * @brief Sets the log the results of the user methods are recorded to or replayed from, see FArticyFlowReplay.
+     *
+     * @param Log The log, nullptr to call the methods without recording them.
+     */
+    void SetMethodLog(FArticyMethodResultLog* Log) const { MethodLog = Log; }
+
+    /** @brief Returns the log set by SetMethodLog. */
+    FArticyMethodResultLog* GetMethodLog() const { return MethodLog; }
+
+    /** @brief Returns true while the user methods return the results of a method log instead of being called. */
+    bool IsReplayingMethods() const { return MethodLog && MethodLog->IsReplaying(); }
+
+    /**
+     * @brief Sets a method log while it exists, and restores the previous one when it ends.
+     */
+    struct FMethodLogScope
+    {
+        FMethodLogScope(const UArticyExpressoScripts* InScripts, FArticyMethodResultLog* Log)
+            : Scripts(Log ? InScripts : nullptr), Previous(Scripts ? Scripts->GetMethodLog() : nullptr)
+        {
+            if (Scripts)
+                Scripts->SetMethodLog(Log);
+        }
+
+        ~FMethodLogScope()
+        {
+            if (Scripts)
+                Scripts->SetMethodLog(Previous);
+        }
+
+        FMethodLogScope(const FMethodLogScope&) = delete;
+        FMethodLogScope& operator=(const FMethodLogScope&) = delete;
+
+    private:
+        const UArticyExpressoScripts* Scripts;
+        FArticyMethodResultLog* Previous;
+    };
+
 protected:
 
+    /** @brief Generated: discards the memoized results of the pure user methods. */
+    virtual void ResetMethodMemos() const { }
+
+    /**
+     * @brief Generated: calls a user method, recording its result to the method log if one is set, or returns the
+     * recorded result instead if the log is replayed.
+     *
+     * @param Method The name of the method.
+     * @param Call Calls the method.
+     * @return The result of Call, or the recorded one.
+     */
+    template<typename TCall>
+    auto CallUserMethod(const TCHAR* Method, TCall&& Call) const -> typename TDecay<decltype(Call())>::Type
+    {
+        if (!MethodLog)
+            return Call();
+
+        typename TDecay<decltype(Call())>::Type Value{};
+        if (MethodLog->IsReplaying())
+        {
+            MethodLog->Replay(Method, Value);
+            return Value;
+        }
+
+        Value = Call();
+        MethodLog->Record(Method, Value);
+        return Value;
+    }
+
     /**
      * @brief Sets the global variables instance for script execution.
      *
@@ -982,6 +1322,83 @@ protected:
      */
     TMap<uint32, TFunction<void()>> Instructions;
 
+    /**
+     * @brief Generated script table: finds a condition by its hash.
+     *
+     * The generated class stores its scripts as member functions in a table sorted by hash, instead of
+     * adding them to Conditions and Instructions in its constructor. The maps remain for classes generated before.
+     *
+     * @param Hash The hash of the condition fragment.
+     * @return The index of the condition, or INDEX_NONE.
+     */
+    virtual int32 FindCondition(uint32 Hash) const { return INDEX_NONE; }
+
+    /** @brief Generated script table: finds an instruction by its hash, see FindCondition. */
+    virtual int32 FindInstruction(uint32 Hash) const { return INDEX_NONE; }
+
+    /** @brief Generated script table: evaluates the condition with the given index. */
+    virtual bool EvaluateCondition(int32 Index) const { return true; }
+
+    /** @brief Generated script table: executes the instruction with the given index. */
+    virtual void ExecuteInstruction(int32 Index) const { }
+
+    /**
+     * @brief Returns whether a script may change state when it runs: global variables, properties or seen counters.
+     *
+     * Subgraphs of scripts which only read state are explored without a shadow state. Empty scripts never change
+     * state, scripts which are not part of the generated table are assumed to.
+     *
+     * @param ScriptIndex The index from GetConditionIndex or GetInstructionIndex, or INDEX_NONE.
+     * @param FragmentHash The hash of the fragment.
+     * @param bIsInstruction Whether the script is an instruction.
+     * @return False if the script only reads state.
+     */
+    bool ScriptWritesState(int32 ScriptIndex, const int& FragmentHash, bool bIsInstruction) const;
+
+    /** @brief Generated script table: whether the condition with the given index may change state, see ScriptWritesState. */
+    virtual bool ConditionWritesState(int32 Index) const { return true; }
+
+    /** @brief Generated script table: whether the instruction with the given index may change state. */
+    virtual bool InstructionWritesState(int32 Index) const { return true; }
+
+    /**
+     * @brief Returns the global variables a script reads and writes, and whether it accesses seen counters, object
+     * properties or user methods.
+     *
+     * Exploration caches, change driven refreshes and parallel explorations can tell from this which scripts a change
+     * of a variable affects, without tracing the scripts at runtime. Empty scripts access nothing, the accesses of
+     * scripts which are not part of the generated table are unknown.
+     *
+     * @param ScriptIndex The index from GetConditionIndex or GetInstructionIndex, or INDEX_NONE.
+     * @param FragmentHash The hash of the fragment.
+     * @param bIsInstruction Whether the script is an instruction.
+     * @return The accesses of the script.
+     */
+    FArticyScriptAccess GetScriptAccess(int32 ScriptIndex, const int& FragmentHash, bool bIsInstruction) const;
+
+    /** @brief Generated script table: the accesses of the condition with the given index, see GetScriptAccess. */
+    virtual FArticyScriptAccess GetConditionAccess(int32 Index) const { return FArticyScriptAccess(); }
+
+    /** @brief Generated script table: the accesses of the instruction with the given index. */
+    virtual FArticyScriptAccess GetInstructionAccess(int32 Index) const { return FArticyScriptAccess(); }
+
+    /**
+     * @brief Returns an entry of a generated access table, as views into its variable table.
+     *
+     * @param Variables The variable table.
+     * @param Entry The entry of the script.
+     */
+    static FArticyScriptAccess MakeScriptAccess(TConstArrayView<int32> Variables, const FArticyScriptAccessEntry& Entry);
+
+    /**
+     * @brief Finds a hash in a sorted hash table of the generated scripts.
+     *
+     * @param SortedHashes The hashes of the scripts, in ascending order.
+     * @param Hash The hash to find.
+     * @return The index of the hash, or INDEX_NONE.
+     */
+    static int32 FindScriptIndex(TConstArrayView<uint32> SortedHashes, uint32 Hash);
+
     /**
      * @brief Retrieves an Articy object by name or ID.
      *
@@ -993,6 +1410,15 @@ protected:
      */
     UArticyObject* getObj(const FString& NameOrId, const uint32& CloneId = 0) const;
 
+    /**
+     * @brief Retrieves an Articy object by an id resolved when the scripts were generated.
+     *
+     * @param Object The object reference of the call site.
+     * @param CloneId The clone ID of the object.
+     * @return The Articy object.
+     */
+    UArticyObject* getObj(const ExpressoObjectId& Object, const uint32& CloneId = 0) const;
+
     /**
      * @brief Sets the value of a property on an Articy object.
      *
@@ -1037,6 +1463,42 @@ protected:
      */
     ExpressoType getProp(const ExpressoType& Id_CloneId, const FString& Property) const;
 
+    /**
+     * @brief Sets the value of a property on an Articy object, for a property path known at generation time.
+     *
+     * @param Object The Articy object containing the property.
+     * @param Property The property access of the call site.
+     * @param Value The value to set.
+     */
+    static void setProp(UArticyBaseObject* Object, const ExpressoProperty& Property, const ExpressoType& Value);
+
+    /**
+     * @brief Sets the value of a property on an Articy object, for a property path known at generation time.
+     *
+     * @param Id_CloneId The compound ID of the object.
+     * @param Property The property access of the call site.
+     * @param Value The value to set.
+     */
+    void setProp(const ExpressoType& Id_CloneId, const ExpressoProperty& Property, const ExpressoType& Value) const;
+
+    /**
+     * @brief Retrieves the value of a property on an Articy object, for a property path known at generation time.
+     *
+     * @param Object The Articy object containing the property.
+     * @param Property The property access of the call site.
+     * @return The value of the property.
+     */
+    static ExpressoType getProp(UArticyBaseObject* Object, const ExpressoProperty& Property);
+
+    /**
+     * @brief Retrieves the value of a property on an Articy object, for a property path known at generation time.
+     *
+     * @param Id_CloneId The compound ID of the object.
+     * @param Property The property access of the call site.
+     * @return The value of the property.
+     */
+    ExpressoType getProp(const ExpressoType& Id_CloneId, const ExpressoProperty& Property) const;
+
     /**
      * @brief Generates a random integer between Min and Max.
      *
@@ -1247,6 +1709,16 @@ protected:
      */
     int getSeenCounter(const FString& NameOrId);
 
+    /**
+     * @brief Retrieves the seen counter for an Articy object resolved when the scripts were generated.
+     *
+     * The counter is read from the seen counter slot of the object, without looking the object up.
+     *
+     * @param Object The object reference of the call site.
+     * @return The seen counter value.
+     */
+    int getSeenCounter(const ExpressoObjectId& Object);
+
     /**
      * @brief Sets the seen counter for the current object.
      *
@@ -1279,6 +1751,15 @@ protected:
      */
     int setSeenCounter(const FString& NameOrId, const int Value = 1);
 
+    /**
+     * @brief Sets the seen counter for an Articy object resolved when the scripts were generated.
+     *
+     * @param Object The object reference of the call site.
+     * @param Value The value to set.
+     * @return The updated seen counter value.
+     */
+    int setSeenCounter(const ExpressoObjectId& Object, const int Value = 1);
+
     /**
      * @brief Performs a fallback operation for an Articy object.
      *
@@ -1381,6 +1862,12 @@ protected:
 
 private:
 
+    /** The number of open FMethodMemoScopes. */
+    mutable int32 MethodMemoDepth = 0;
+
+    /** See SetMethodLog. */
+    mutable FArticyMethodResultLog* MethodLog = nullptr;
+
     /**
      * @brief Articy database associated with the expresso scripts.
      *
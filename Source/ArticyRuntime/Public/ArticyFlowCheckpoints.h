@@ -0,0 +1,106 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+#include "ArticyDatabase.h"
+#include "ArticyGlobalVariables.h"
+
+/**
+ * @class FArticyFlowCheckpoints
+ * @brief The checkpoints of a flow player, one per Play, so the dialogue can be rewound, see UArticyFlowPlayer::RewindTo.
+ *
+ * A checkpoint is the state right before a branch was played: the cursor, the global variables and seen counters,
+ * and the articy objects with their clones. The state is not copied per checkpoint. The variables of the newest
+ * checkpoint are kept in full, and every other checkpoint holds the previous values of the variables which changed
+ * until the checkpoint after it. The objects are recorded by the database into an undo log per checkpoint (see
+ * UArticyDatabase::AddObjectUndoLog) when they are first written or cloned after it, so objects which are not
+ * changed cost nothing. The checkpoints are kept in a ring buffer, the oldest one is dropped once it is full.
+ *
+ * Changes to the objects and variables outside of the flow are rewound as well, the database records all writes.
+ * Loading and unloading packages is not, and neither is resetting a reused world clone.
+ */
+class ARTICYRUNTIME_API FArticyFlowCheckpoints
+{
+public:
+
+	/**
+	 * @param InDatabase The database whose objects are recorded.
+	 * @param InGVs The global variables whose values are recorded.
+	 * @param MaxCheckpoints The number of checkpoints kept, at least 1.
+	 */
+	FArticyFlowCheckpoints(UArticyDatabase* InDatabase, UArticyGlobalVariables* InGVs, int32 MaxCheckpoints);
+
+	/** Stops recording the objects. */
+	~FArticyFlowCheckpoints();
+
+	FArticyFlowCheckpoints(const FArticyFlowCheckpoints&) = delete;
+	FArticyFlowCheckpoints& operator=(const FArticyFlowCheckpoints&) = delete;
+
+	/** Returns true if the checkpoints record the state of this database and these global variables, with this size. */
+	bool Matches(const UArticyDatabase* InDatabase, const UArticyGlobalVariables* InGVs, int32 MaxCheckpoints) const;
+
+	/**
+	 * Adds a checkpoint with the current state, dropping the oldest one if the ring buffer is full.
+	 * @param Cursor The node the flow player is at.
+	 */
+	void Record(const FArticyId& Cursor);
+
+	/**
+	 * Restores the state of a checkpoint. The checkpoint and the ones after it are dropped, the next Record adds it again.
+	 * Not possible while a shadow state is active.
+	 * @param CheckpointIndex The checkpoint, 0 for the oldest one.
+	 * @param OutCursor Receives the node the flow player was at.
+	 * @return false if there is no such checkpoint or the state could not be restored.
+	 */
+	bool RewindTo(int32 CheckpointIndex, FArticyId& OutCursor);
+
+	/** Drops all checkpoints. */
+	void Reset();
+
+	/** Returns the number of checkpoints. */
+	int32 Num() const { return NumCheckpoints; }
+
+	/** Returns the node the flow player was at when a checkpoint was recorded, 0 is the oldest one. */
+	FArticyId GetCursor(int32 CheckpointIndex) const;
+
+	/** Returns the memory held by the checkpoints, in bytes. */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	struct FCheckpoint
+	{
+		FArticyId Cursor;
+
+		/** The previous values of the variables which changed since the checkpoint before, empty for the oldest one. */
+		FArticyGvDelta GvUndo;
+
+		/** The state of the objects changed after this checkpoint, before they were changed. */
+		FArticyObjectUndoLog ObjectUndo;
+	};
+
+	/** Returns the checkpoint with an index, 0 is the oldest one. */
+	FCheckpoint& Get(int32 CheckpointIndex) { return Ring[(Head + CheckpointIndex) % Ring.Num()]; }
+	const FCheckpoint& Get(int32 CheckpointIndex) const { return Ring[(Head + CheckpointIndex) % Ring.Num()]; }
+
+	/** Registers the undo log of the newest checkpoint with the database, or unregisters it. */
+	void SetRecording(bool bInRecording);
+
+	TWeakObjectPtr<UArticyDatabase> Database;
+	TWeakObjectPtr<UArticyGlobalVariables> GVs;
+
+	/** The checkpoints, allocated once so the database can keep pointers to their undo logs. */
+	TArray<FCheckpoint> Ring;
+	int32 Head = 0;
+	int32 NumCheckpoints = 0;
+
+	/** The values of the variables at the newest checkpoint. */
+	FArticyGvState NewestState;
+
+	/** Whether the undo log of the newest checkpoint is registered with the database. */
+	bool bRecording = false;
+};
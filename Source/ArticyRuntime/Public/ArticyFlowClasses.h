@@ -125,6 +125,12 @@ public:
      */
     void Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
 
+    /**
+     * Links the target and the target pin, in addition to the references of the node.
+     * @param Database The database the jump is loaded into, or nullptr to unlink the references.
+     */
+    void LinkReferences(const UArticyDatabase* Database) override;
+
 protected:
 
     /** The ID of the target pin. */
@@ -137,11 +143,6 @@ protected:
 
 private:
 
-    /** Cached pointer to the target pin object. */
-    UPROPERTY(VisibleAnywhere, Transient, Category = "Articy")
-    mutable UArticyFlowPin* TargetPinObj;
-
-    /** Cached pointer to the target object. */
-    UPROPERTY(VisibleAnywhere, Transient, Category = "Articy")
-    mutable UArticyPrimitive* TargetObj;
+    /** The target and the target pin, see LinkReferences. */
+    FArticyPinLink TargetLink;
 };
@@ -0,0 +1,197 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+
+class UArticyDatabase;
+class UArticyPrimitive;
+class FArticyCloneableObject;
+class IArticyFlowObject;
+class UArticyExpressoScripts;
+
+/** How a node of the flow graph is explored, mirroring the Explore implementations of the flow classes. */
+enum class EArticyFlowGraphNodeKind : uint8
+{
+	/** A node that continues on its output pins. */
+	Node,
+	/** A condition with a true and a false output pin. */
+	Condition,
+	/** An instruction, which continues on its output pins. */
+	Instruction,
+	/** A jump to a target pin. */
+	Jump,
+	InputPin,
+	OutputPin
+};
+
+/** A node or pin of the flow graph. */
+struct FArticyFlowGraphNode
+{
+	/** The unshadowed object of this node. */
+	UArticyPrimitive* Object = nullptr;
+	IArticyFlowObject* FlowObject = nullptr;
+
+	/** The container of the node, or of the owner for pins, to find the current shadow copy. */
+	FArticyCloneableObject* Container = nullptr;
+
+	EArticyFlowGraphNodeKind Kind = EArticyFlowGraphNodeKind::Node;
+
+	/** 1 << EArticyPausableType of the node, to test it against a PauseOn mask. */
+	uint8 PauseMask = 0;
+
+	/** Whether the node (or the owner for pins) has a speaker. */
+	bool bHasSpeaker = false;
+
+	/** Whether the node has a script, and the hash the expresso scripts know it by. */
+	bool bHasScript = false;
+	int32 ScriptHash = 0;
+
+	/** The index of the script in the tables of the expresso scripts class, or INDEX_NONE to look it up by hash. */
+	int32 ScriptIndex = INDEX_NONE;
+
+	/** The input pins of a node. */
+	int32 FirstInput = 0;
+	int32 NumInputs = 0;
+
+	/** The output pins of a node. */
+	int32 FirstOutput = 0;
+	int32 NumOutputs = 0;
+
+	/** The pins a pin is connected to, or the target pin of a jump. Unresolved targets are INDEX_NONE. */
+	int32 FirstTarget = 0;
+	int32 NumTargets = 0;
+
+	/** The node owning a pin. */
+	int32 Owner = INDEX_NONE;
+
+	/**
+	 * Whether no script reachable from the node, including its own, may change state (see
+	 * UArticyExpressoScripts::ScriptWritesState), so exploring it needs no shadow state.
+	 */
+	bool bReadOnly = false;
+	/**
+	 * Whether a script reachable from the node, including its own, may write objects: an instruction or condition
+	 * which may change state and accesses object properties, seen counters or user methods, or whose accesses are
+	 * unknown. Only nodes without are explored in parallel (see UArticyFlowPlayer::CanExploreInParallel).
+	 */
+	bool bMayWriteObjects = true;
+
+	/**
+	 * The only child of a node which is explored without running a script or branching (e.g. a jump, a hub with a
+	 * single output pin or an output pin without instruction), and the depth it is explored with relative to the
+	 * node. INDEX_NONE for all other nodes.
+	 */
+	int32 PassChild = INDEX_NONE;
+	uint8 PassDepth = 0;
+
+	/**
+	 * The skip-ahead of a node with a PassChild, if the child has one too: the flow player jumps over the NumSkipped
+	 * nodes of the chain of pass children (starting at PassChild) to the first node which is not part of it, the
+	 * SkipTarget, as long as none of the skipped nodes pauses (SkipPauseMask). SkipDepth is the depth the target is
+	 * explored with relative to the node. Chains which loop are not skipped.
+	 */
+	int32 SkipTarget = INDEX_NONE;
+	int32 NumSkipped = 0;
+	int32 SkipDepth = 0;
+	uint8 SkipPauseMask = 0;
+};
+
+/**
+ * A flow graph saved without its object pointers, see FArticyFlowGraph::SaveImage. Cooked databases carry the image of
+ * their default packages (see UArticyDatabase::GetFlowGraph), so the graph is restored instead of built at startup.
+ */
+struct ARTICYRUNTIME_API FArticyFlowGraphImage
+{
+	/** The packages the graph was built from, sorted, and the number of objects loaded from them. */
+	TArray<FString> Packages;
+	int32 NumObjects = 0;
+
+	/** The path of the expresso scripts class the script indices of the nodes refer to. */
+	FString ExpressoScriptsClass;
+
+	/** The id of the object of each node. */
+	TArray<FArticyId> Ids;
+
+	/** The nodes without their object pointers, and the links. */
+	TArray<FArticyFlowGraphNode> Nodes;
+	TArray<int32> Links;
+
+	friend ARTICYRUNTIME_API FArchive& operator<<(FArchive& Ar, FArticyFlowGraphImage& Image);
+};
+
+/**
+ * An index based copy of the flow of all loaded packages: nodes, pins and connections are stored in
+ * arrays and refer to each other by index, and the script hashes are resolved up front.
+ * The flow player explores it without casts, reflection or database lookups.
+ * It is built by the database (see UArticyDatabase::GetFlowGraph), and rebuilt when packages change.
+ */
+class ARTICYRUNTIME_API FArticyFlowGraph
+{
+public:
+
+	/**
+	 * Builds the graph from the unshadowed objects of a database.
+	 * @param Database The database to build the graph from.
+	 */
+	void Build(const UArticyDatabase* Database);
+
+	/**
+	 * Saves the graph with the ids of its objects instead of the pointers.
+	 * @param Database The database the graph was built from.
+	 * @param OutImage Receives the image.
+	 */
+	void SaveImage(const UArticyDatabase* Database, FArticyFlowGraphImage& OutImage) const;
+
+	/**
+	 * Restores the graph from an image, resolving the objects of the nodes by id.
+	 * @param Database The database to restore the graph for, which must have the packages of the image loaded.
+	 * @param Image The image.
+	 * @return False if the image does not match the loaded packages or an object is missing; the graph is then empty.
+	 */
+	bool LoadImage(const UArticyDatabase* Database, const FArticyFlowGraphImage& Image);
+
+	/**
+	 * Points the node of an object and its pins at the current clone 0 of the object, after the database replaced it.
+	 * @param Database The database the graph was built from.
+	 * @param Id The id of the object.
+	 * @return False if the pins of the object don't match the graph anymore, the graph then has to be built again.
+	 */
+	bool UpdateObject(const UArticyDatabase* Database, const FArticyId& Id);
+
+	/**
+	 * Finds the node of an object.
+	 * @param Object A flow node or pin.
+	 * @return The index of the node, or INDEX_NONE if the object is not part of the graph.
+	 */
+	int32 FindNode(const UArticyPrimitive* Object) const;
+
+	const FArticyFlowGraphNode& GetNode(int32 Index) const { return Nodes[Index]; }
+
+	TConstArrayView<int32> GetInputs(const FArticyFlowGraphNode& Node) const { return MakeArrayView(Links.GetData() + Node.FirstInput, Node.NumInputs); }
+	TConstArrayView<int32> GetOutputs(const FArticyFlowGraphNode& Node) const { return MakeArrayView(Links.GetData() + Node.FirstOutput, Node.NumOutputs); }
+	TConstArrayView<int32> GetTargets(const FArticyFlowGraphNode& Node) const { return MakeArrayView(Links.GetData() + Node.FirstTarget, Node.NumTargets); }
+
+	int32 Num() const { return Nodes.Num(); }
+
+private:
+
+	TArray<FArticyFlowGraphNode> Nodes;
+
+	/** The pin and target indices of all nodes. */
+	TArray<int32> Links;
+
+	TMap<FArticyId, int32> IndexById;
+
+	/**
+	 * Sets bReadOnly of the nodes from which no script that may change state can be reached, and bMayWriteObjects
+	 * of the nodes from which a script that may write objects can be reached.
+	 */
+	void FindReadOnlySubgraphs(const UArticyExpressoScripts* ExpressoScripts);
+
+	/** Sets the pass children and the skip-aheads of the nodes. */
+	void FindSkipAheadChains(const UArticyExpressoScripts* ExpressoScripts);
+};
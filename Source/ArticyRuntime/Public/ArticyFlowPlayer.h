@@ -5,15 +5,21 @@
 #pragma once
 
 #include "ArticyRuntimeModule.h"
+#include "ArticyStats.h"
 #include "ArticyDatabase.h"
 #include "ArticyGlobalVariables.h"
 #include "ArticyRef.h"
 #include "Components/BillboardComponent.h"
 #include "Containers/Queue.h"
+#include "HAL/CriticalSection.h"
 #include "ArticyFlowPlayer.generated.h"
 
 class IArticyNode;
 class IArticyFlowObject;
+class FArticyFlowCapture;
+class FArticyFlowCheckpoints;
+class FArticyMethodResultLog;
+class UPackageMap;
 
 /**
  * Enum representing the various types of Articy flow nodes that can be paused on.
@@ -55,10 +61,98 @@ public:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
     int32 Index = -1;
 
+    /**
+     * While the branch is being explored, the index of its last node in the shared path nodes of
+     * the flow player. Path is only filled once the exploration is done.
+     */
+    int32 PathTail = INDEX_NONE;
+
     /** Retrieve the last object in the path. */
     TScriptInterface<IArticyFlowObject> GetTarget() const;
 };
 
+/**
+ * The result of the script of a node on the way to where a budgeted exploration stopped: the result of a condition,
+ * or the values an instruction wrote. Continuing the exploration uses it instead of running the script again.
+ */
+struct FArticyExploreScriptResult
+{
+    /** The node the result belongs to, only compared. No result is recorded for nodes without a script. */
+    const UArticyPrimitive* Object = nullptr;
+    bool bResult = false;
+
+    TArray<TPair<TWeakObjectPtr<UArticyInt>, int32>> Ints;
+    TArray<TPair<TWeakObjectPtr<UArticyBool>, bool>> Bools;
+    TArray<TPair<TWeakObjectPtr<UArticyString>, FString>> Strings;
+
+    void Reset()
+    {
+        Object = nullptr;
+        bResult = false;
+        Ints.Reset();
+        Bools.Reset();
+        Strings.Reset();
+    }
+};
+
+/**
+ * Where a budgeted exploration stopped (see UArticyFlowPlayer::ExploreNodeBudget).
+ * Passing it to Explore again continues the exploration after the branches it already returned.
+ */
+struct FArticyExploreContinuation
+{
+    /** The child indices leading from the explored node to the first node that was not explored. */
+    TArray<int32> ChildPath;
+
+    /** The results of the scripts of the nodes along ChildPath, by their level. */
+    TArray<FArticyExploreScriptResult> ScriptResults;
+
+    /** Whether the exploration stopped early, and there are more branches to explore. */
+    bool bPending = false;
+};
+
+/**
+ * The state of a flow player the server replicates to the clients, see UArticyFlowPlayer::bReplicateFlow.
+ * The available branches are replicated as their targets and a validity bit each, the ids as packed ints.
+ */
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyFlowReplicationState
+{
+    GENERATED_BODY()
+
+public:
+
+    /** The id of the cursor. */
+    FArticyId Cursor;
+
+    /** The index of the branch played last, as passed to Play, INDEX_NONE if the cursor was set. */
+    int32 ChosenBranch = INDEX_NONE;
+
+    /** The id of the target of each available branch. */
+    TArray<FArticyId> Targets;
+
+    /** Whether each available branch is valid, by index of Targets. */
+    TBitArray<> ValidBits;
+
+    /** Incremented with each update on the server, so the same branches are replicated again after e.g. a choice leading back. */
+    uint32 Version = 0;
+
+    bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+    /** The states are compared by version only, it changes with each update. */
+    bool operator==(const FArticyFlowReplicationState& Other) const { return Version == Other.Version; }
+};
+
+template<>
+struct TStructOpsTypeTraits<FArticyFlowReplicationState> : public TStructOpsTypeTraitsBase2<FArticyFlowReplicationState>
+{
+    enum
+    {
+        WithNetSerializer = true,
+        WithIdenticalViaEquality = true,
+    };
+};
+
 /**
  * This component handles traversal of the flow, starting and halting at specific nodes.
  * The GlobalVariables instance and the UserMethodProvider used for this flow player
@@ -73,6 +167,7 @@ public:
 
     void BeginPlay() override;
     void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
     //---------------------------------------------------------------------------//
 
@@ -141,8 +236,10 @@ public:
      * Gather all branches that start from this node.
      * The explore can be performed as shadowed operation.
      * If the node is submergeable, a submerge is performed.
+     * Only a call with Depth 0 fills the Path of the returned branches, nested calls return PathTail only.
+     * If a Continuation is passed, the explore budget applies and the exploration may stop early (see ExploreNodeBudget).
      */
-    TArray<FArticyBranch> Explore(IArticyFlowObject* Node, bool bShadowed, int32 Depth, bool IncludeCurrent = true);
+    TArray<FArticyBranch> Explore(IArticyFlowObject* Node, bool bShadowed, int32 Depth, bool IncludeCurrent = true, FArticyExploreContinuation* Continuation = nullptr);
 
     void SetPauseOn(EArticyPausableType Types);
     /** Returns true if Node is one of the PauseOn types. */
@@ -151,6 +248,13 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Flow")
     bool ShouldPauseOn(TScriptInterface<IArticyFlowObject> Node) const;
 
+    /**
+     * Called by an input pin whose condition is false around the exploration of its targets, so only branches with
+     * the same validity are merged (see bMergeConvergingBranches).
+     */
+    void BeginInvalidExplorePath() { ++ExploreInvalidDepth; }
+    void EndInvalidExplorePath() { --ExploreInvalidDepth; }
+
     /**
      * Get the GV instance used for expresso script execution.
      */
@@ -159,10 +263,18 @@ public:
 
     /**
      * Get the UserMethodsProvider used for resolving user defined methods.
+     * If none is set, it is searched on this component and its owner once, and cached.
      */
     UFUNCTION(BlueprintPure, Category = "Setup")
     UObject* GetMethodsProvider();
 
+    /**
+     * Discards the cached methods provider, e.g. after components were added to or removed from the owner,
+     * or the default methods provider of the database changed.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Setup")
+    void InvalidateMethodsProvider();
+
     //---------------------------------------------------------------------------//
 
     /** Explore branches starting from the current StartOn node. */
@@ -173,18 +285,123 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Flow")
     const TArray<FArticyBranch>& GetAvailableBranches() const { return AvailableBranches; }
 
+    /**
+     * The accessors below read single available branches, so Blueprints don't copy the AvailableBranches array
+     * (including the paths) on every access. The indices are the ones of GetAvailableBranches, which Play accepts.
+     */
+
+    /** Get the number of available branches. */
+    UFUNCTION(BlueprintPure, Category = "Flow|Branches")
+    int32 GetBranchCount() const { return AvailableBranches.Num(); }
+
+    /** Get the last node of an available branch, or nullptr if there is no branch with this index. */
+    UFUNCTION(BlueprintPure, Category = "Flow|Branches")
+    TScriptInterface<IArticyFlowObject> GetBranchTarget(int32 Index) const;
+
+    /** Whether all conditions along an available branch evaluate to true, false if there is no branch with this index. */
+    UFUNCTION(BlueprintPure, Category = "Flow|Branches")
+    bool IsBranchValid(int32 Index) const { return AvailableBranches.IsValidIndex(Index) && AvailableBranches[Index].bIsValid; }
+
+    /** Get the number of nodes in the path of an available branch. */
+    UFUNCTION(BlueprintPure, Category = "Flow|Branches")
+    int32 GetBranchPathLength(int32 Index) const { return AvailableBranches.IsValidIndex(Index) ? AvailableBranches[Index].Path.Num() : 0; }
+
+    /** Get a node in the path of an available branch, or nullptr if there is no such node. */
+    UFUNCTION(BlueprintPure, Category = "Flow|Branches")
+    TScriptInterface<IArticyFlowObject> GetBranchPathNode(int32 Index, int32 NodeIndex) const;
+
+    /**
+     * Updates the available branches of several flow players at once.
+     * Players with bAllowParallelExploration explore on worker threads, the ones sharing a GV instance
+     * one after another. All results are broadcast on the game thread once every exploration is done.
+     * Players which cannot explore in parallel update their branches on the game thread as usual.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Flow")
+    static void UpdateAvailableBranchesInParallel(const TArray<UArticyFlowPlayer*>& Players);
+
+    /**
+     * Whether the available branches are still being explored over multiple frames (see ExploreNodeBudget).
+     * OnBranchesUpdated is broadcast once they are complete.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Flow")
+    bool IsExplorationPending() const { return PendingExploration.bPending; }
+
+    /**
+     * Discards all cached exploration results (see bCacheExploration).
+     * Call this if state that user methods read during exploration has changed.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Flow")
+    void InvalidateExplorationCache() { ExplorationCache.Reset(); }
+
+    /**
+     * Discards the exploration results shared by the players (see bShareExplorationCache).
+     * Call this if state that user methods read during exploration has changed.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Flow")
+    static void InvalidateSharedExplorationCache();
+
+    /**
+     * Starts capturing the flow of this player for a replay (see FArticyFlowReplay): the state of the global variables,
+     * the branches played, the cursor changes and the results of the user methods. The available branches are explored
+     * again, so the results of the methods they call are part of the capture. Parallel explorations are disabled while
+     * capturing.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Debug")
+    void StartCapture();
+
+    /**
+     * Stops capturing and saves the capture.
+     * @param FilePath The file, relative paths are relative to Saved/Articy/Captures. Empty to discard the capture.
+     * @return True if the capture was saved.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Debug")
+    bool StopCapture(const FString& FilePath);
+
+    /** Stops capturing and returns the capture, or nullptr if the player was not capturing. */
+    TSharedPtr<FArticyFlowCapture> TakeCapture();
+
+    /** Whether the flow of this player is captured, see StartCapture. */
+    UFUNCTION(BlueprintCallable, Category = "Debug")
+    bool IsCapturing() const { return Capture.IsValid(); }
+
+    /**
+     * Restores the state before a branch was played with Play, see MaxCheckpoints: the global variables and seen
+     * counters, the objects and their clones, and the cursor. The checkpoint and the ones after it are dropped, so
+     * playing a branch from the restored cursor records it again. Not possible on the clients of a replicated flow
+     * or while a shadow state is active.
+     * @param CheckpointIndex The checkpoint, 0 for the oldest one, GetNumCheckpoints() - 1 for the last Play.
+     * @return True if the checkpoint was restored.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Flow")
+    bool RewindTo(int32 CheckpointIndex);
+
+    /** Returns the number of checkpoints RewindTo can restore. */
+    UFUNCTION(BlueprintPure, Category = "Flow")
+    int32 GetNumCheckpoints() const;
+
+    /** Drops all checkpoints, e.g. when the dialogue ends. */
+    UFUNCTION(BlueprintCallable, Category = "Flow")
+    void ClearCheckpoints();
+
     //---------------------------------------------------------------------------//
 
     /** Wether bIgnoreInvalidBranches is set. */
     UFUNCTION(BlueprintCallable, Category = "Setup")
     bool IgnoresInvalidBranches() const { return bIgnoreInvalidBranches; }
 
+    /**
+     * Traverses the branches queued by Play and continues a budgeted exploration of the available branches.
+     * Players taking part in play are ticked by UArticyFlowPlayerSubsystem when they have something to do,
+     * players outside of a world must call this themselves.
+     */
     bool OnTick(float DeltaTime);
 
     DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnPushState);
     DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnPopState);
     DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPlayerPaused, TScriptInterface<IArticyFlowObject>, PausedOn);
     DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBranchesUpdated, const TArray<FArticyBranch>&, AvailableBranches);
+    DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnBranchCountUpdated, int32, NumBranches);
+    DECLARE_MULTICAST_DELEGATE_OneParam(FOnBranchesUpdatedNative, const TArray<FArticyBranch>&);
 
 
     /** This event is broadcast whenever a new ShadowedOperation starts. */
@@ -208,6 +425,16 @@ public:
     UPROPERTY(BlueprintAssignable, Category = "Flow")
     FOnBranchesUpdated OnBranchesUpdated;
 
+    /**
+     * Broadcast together with OnBranchesUpdated, without the branches: Blueprint copies the array of OnBranchesUpdated
+     * for each listener. Use GetBranchCount, GetBranchTarget and IsBranchValid to read the branches.
+     */
+    UPROPERTY(BlueprintAssignable, Category = "Flow")
+    FOnBranchCountUpdated OnBranchCountUpdated;
+
+    /** Broadcast together with OnBranchesUpdated, passing the AvailableBranches by reference to native listeners. */
+    FOnBranchesUpdatedNative OnBranchesUpdatedNative;
+
 protected:
 
     //========================================//
@@ -238,6 +465,121 @@ protected:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
     bool bIgnoreInvalidBranches = true;
 
+    /**
+     * Merge the branches which end at the same target with the same validity, e.g. the ones converging through hubs
+     * or pins with several connections, into the first of them.
+     * A node which an exploration reaches again on a path with the same validity is not explored again, so the
+     * conditions below it are evaluated once. Only enable this if the scripts along converging paths don't change
+     * the outcome of the conditions after the node they converge on, as the first path reaching it decides.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+    bool bMergeConvergingBranches = false;
+
+    /**
+     * Reuse the branches explored from a node as long as none of the global variables, seen counters
+     * and objects the exploration read have changed.
+     * Only enable this if the user methods called by conditions don't depend on other game state,
+     * or call InvalidateExplorationCache when it changes.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+    bool bCacheExploration = false;
+
+    /** The maximum number of nodes whose exploration results are cached. */
+    UPROPERTY(EditAnywhere, Category = "Setup", meta = (ClampMin = 1))
+    int32 ExplorationCacheSize = 16;
+
+    /**
+     * Share the cached exploration results with the other players sharing them, e.g. the ambient NPCs of a crowd
+     * running the same barks: a player exploring from a node another player explored from with the same global
+     * variables, PauseOn and explore settings reuses its branches while they are valid, so the exploration runs
+     * once instead of once per player. Requires bCacheExploration.
+     * Only enable this if the user methods called by conditions return the same for all of these players.
+     * The size of the shared cache is set by the console variable Articy.SharedExplorationCacheSize.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (EditCondition = "bCacheExploration"))
+    bool bShareExplorationCache = false;
+
+    /**
+     * The maximum number of nodes UpdateAvailableBranches explores per frame, 0 for no limit.
+     * If a budget is set, the exploration continues on the next frames and OnBranchesUpdated is broadcast
+     * once all branches are explored. The budget applies to flow graph explorations only (see bUseFlowGraph).
+     * The scripts of the nodes explored already are not run again on the next frames, their recorded results are used.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (ClampMin = 0))
+    int32 ExploreNodeBudget = 0;
+
+    /** The maximum time UpdateAvailableBranches explores per frame, 0 for no limit. See ExploreNodeBudget. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (ClampMin = 0, Units = "ms"))
+    float ExploreTimeBudget = 0.f;
+
+    /**
+     * Allow UpdateAvailableBranchesInParallel to explore this player on a worker thread.
+     * Only enable this if the user methods called by the flow of this player are thread safe. Players whose
+     * cursor can reach a script which may write objects (including any script calling user methods) still explore
+     * on the game thread. OnShadowOpStart and OnShadowOpEnd are not broadcast by parallel explorations.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+    bool bAllowParallelExploration = false;
+
+    /**
+     * Explore the flow graph of the database (see UArticyDatabase::GetFlowGraph) instead of calling
+     * Explore on the flow objects. The graph follows the Explore implementations of the built-in flow classes,
+     * so only enable this if no custom flow class overrides Explore.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+    bool bUseFlowGraph = false;
+
+    /**
+     * Let the server own the flow, e.g. for co-op dialogues: the component is replicated, and the server replicates
+     * the cursor, the branch played last and the targets and validity of the available branches to the clients
+     * (see FArticyFlowReplicationState). Clients neither explore nor execute scripts; the path of their available
+     * branches holds the target only. Play and SetCursorTo on a client are sent to the server, which requires the
+     * client to own the actor. Use UArticyGVReplicationComponent to replicate the variables the scripts change.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Setup")
+    bool bReplicateFlow = false;
+
+    /**
+     * Load the media of the available branches in the background whenever they are updated: the preview images
+     * and speaker portraits of the nodes, and the voice over of their texts. They are resident by the time a
+     * branch is picked. See PrefetchDepth and PrefetchMemoryBudget.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+    bool bPrefetchBranchMedia = false;
+
+    /** The number of nodes at the end of each available branch whose media is prefetched, starting with its target. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (ClampMin = 1))
+    int32 PrefetchDepth = 1;
+
+    /** The memory the prefetched media may use, the least recently used media are released above it. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (ClampMin = 0, Units = "MB"))
+    float PrefetchMemoryBudget = 64.f;
+
+    /**
+     * Resolve the texts and menu texts of the targets of the available branches in the frames after they are updated,
+     * so the choice menu finds them in the cache of UArticyTextExtension::ResolveCached. See PrewarmTextDepth and
+     * PrewarmTextsPerFrame.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup")
+    bool bPrewarmBranchTexts = false;
+
+    /** 1 resolves the texts of the branch targets, 2 also the ones of the nodes they are connected to, and so on. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (ClampMin = 1, ClampMax = 4))
+    int32 PrewarmTextDepth = 1;
+
+    /** The number of objects whose texts are resolved per frame, 0 to resolve all of them right after the update. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (ClampMin = 0))
+    int32 PrewarmTextsPerFrame = 4;
+
+    /**
+     * The number of checkpoints kept for RewindTo, 0 to record none. Each Play records one, the oldest is dropped
+     * once there are this many. A checkpoint holds the values which changed until the next one, and the objects
+     * written or cloned after it, so its cost grows with what changed, not with the size of the project.
+     * While checkpoints are recorded, the database records the state of every object before its first write.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Setup", meta = (ClampMin = 0))
+    int32 MaxCheckpoints = 0;
+
     UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Setup", meta = (ArticyClassRestriction = "ArticyNode"))
     FArticyRef StartOn;
 
@@ -268,15 +610,201 @@ protected:
     mutable UObject* UserMethodsProvider;
 
 private:
+    friend class FArticyRuntimeBenchmark;
+    friend class FArticyFlowSimulator;
+    friend class FArticyFlowReplay;
+    friend class UArticyFlowPlayerSubsystem;
+
     /** The current shadow level (0 == live state). */
     UPROPERTY(Transient, VisibleAnywhere, Category = "Debug")
     mutable uint32 ShadowLevel = 0;
 
     TQueue<FArticyBranch> BranchQueue;
-    FTSTicker::FDelegateHandle TickerHandle;
+
+    /** Whether the player is ticked by UArticyFlowPlayerSubsystem, and whether it is scheduled for a tick. */
+    bool bRegisteredWithScheduler = false;
+    bool bScheduled = false;
+
+    /** Schedules a tick of UArticyFlowPlayerSubsystem, as there are branches to traverse or an exploration to continue. */
+    void WakeScheduler();
+
+    /** Returns true if OnTick has something to do. */
+    bool HasPendingWork() const { return !BranchQueue.IsEmpty() || PendingExploration.bPending || PendingTextWarmups.Num() > 0; }
+
+    /**
+     * Traverses the queued branches. The available branches are updated between two queued branches,
+     * but not after the last one.
+     * @return True if a branch was traversed, and the available branches need to be updated.
+     */
+    bool TraverseQueuedBranches();
+
+    /** Executes the nodes of a branch, counts them as seen and moves the cursor to its end. */
+    void TraverseBranch(const FArticyBranch& Branch);
+
+    /**
+     * Maps the index of a branch as passed to Play to its index in AvailableBranches, skipping the invalid
+     * branches if they are ignored. Returns INDEX_NONE if there is no such branch.
+     */
+    int32 GetPlayableBranchIndex(int32 Index) const;
+
+    /** The capture started by StartCapture. */
+    TSharedPtr<FArticyFlowCapture> Capture;
+
+    /** The checkpoints recorded by Play, see MaxCheckpoints. */
+    TSharedPtr<FArticyFlowCheckpoints> Checkpoints;
+
+    /** Records a checkpoint for Play, creating the checkpoints if MaxCheckpoints, the database or the GVs changed. */
+    void RecordCheckpoint();
+
+    /** The log the user methods record their results to or replay them from while this player explores or traverses. */
+    FArticyMethodResultLog* MethodLog = nullptr;
+
+    /** Adds a step to the capture: a branch played by Play, or the cursor set by SetCursorTo if BranchIndex is INDEX_NONE. */
+    void AddCaptureStep(const TScriptInterface<IArticyFlowObject>& Node, int32 BranchIndex);
 
     UArticyExpressoScripts* CachedExpressoInstance = nullptr;
 
+    /** The methods provider GetMethodsProvider resolved last, it is resolved again if UserMethodsProvider differs. */
+    const UObject* ResolvedMethodsProvider = nullptr;
+    bool bMethodsProviderResolved = false;
+
+    /** The branches explored from a node, and the state they were derived from. */
+    struct FCachedExploration
+    {
+        TWeakObjectPtr<UObject> Node;
+        bool bIncludeCurrent = false;
+        uint8 PauseOn = 0;
+        TWeakObjectPtr<UArticyGlobalVariables> GVs;
+        uint32 ObjectStateVersion = 0;
+        uint32 SeenVersion = 0;
+        FArticyGvReadSet Reads;
+        TArray<FArticyBranch> Branches;
+
+        /** The settings of the player which change the branches, for the shared cache. */
+        int32 ExploreLimit = 0;
+        uint8 ShadowLevelLimit = 0;
+        bool bIgnoreInvalidBranches = true;
+        bool bMergeConvergingBranches = false;
+        bool bUseFlowGraph = false;
+    };
+
+    /** Cached exploration results, the most recently used last. */
+    TArray<FCachedExploration> ExplorationCache;
+
+    /** The exploration results shared by the players, the most recently used last, and the lock for parallel explorations. */
+    static TArray<FCachedExploration> SharedExplorationCache;
+    static FCriticalSection SharedExplorationLock;
+
+    /**
+     * Copies the cached branches from the cursor to OutBranches, if they are still valid.
+     * Invalid entries for the cursor are removed.
+     * @return True if a valid entry was found.
+     */
+    bool FindCachedExploration(TArray<FCachedExploration>& Cache, bool bIncludeCurrent, TArray<FArticyBranch>& OutBranches) const;
+
+    /** Adds an entry to a cache, evicting the least recently used one if it is full. */
+    static void AddCachedExploration(TArray<FCachedExploration>& Cache, int32 MaxSize, const FCachedExploration& Entry);
+
+    /**
+     * Explores the branches from the cursor and appends them to OutBranches, including the fallback
+     * exploration if no branch is found. A Continuation enables the explore budget.
+     */
+    void ExploreFromCursor(bool bIncludeCurrent, TArray<FArticyBranch>& OutBranches, FArticyExploreContinuation* Continuation = nullptr);
+
+    /** The exploration of the available branches which continues on the next tick, and whether it started up. */
+    FArticyExploreContinuation PendingExploration;
+    bool bPendingStartup = false;
+
+    /** Explores the next part of the pending exploration, and finishes the available branches once it is complete. */
+    void ContinuePendingExploration();
+
+    /**
+     * Explores the available branches from the cursor, using the exploration cache if enabled.
+     * Returns false if the cursor or PauseOn are not set.
+     */
+    bool ExploreAvailableBranches(bool Startup, FArticyExploreContinuation* Continuation);
+
+    /** Indexes the available branches, fast-forwards on startup and broadcasts them. */
+    void FinishAvailableBranches(bool Startup);
+
+    /** Prefetches and prewarms the available branches as set up, and broadcasts them and the cursor. */
+    void BroadcastAvailableBranches();
+
+    /** The state replicated to the clients if bReplicateFlow is set. */
+    UPROPERTY(ReplicatedUsing = OnRep_FlowState)
+    FArticyFlowReplicationState ReplicatedFlowState;
+
+    /** Whether this is a client of a flow replicated from the server, which does not explore itself. */
+    bool IsReplicatedClient() const;
+
+    /** Writes the cursor and the available branches to the replicated state, on the server. */
+    void UpdateReplicatedFlowState();
+
+    /** Sets the cursor and the available branches of a client from the replicated state, and broadcasts them. */
+    UFUNCTION()
+    void OnRep_FlowState();
+
+    /** Plays a branch on the server, for Play on a client. */
+    UFUNCTION(Server, Reliable)
+    void ServerPlay(int32 BranchIndex);
+
+    /** Sets the cursor on the server, for SetCursorTo on a client. */
+    UFUNCTION(Server, Reliable)
+    void ServerSetCursorTo(FArticyId NodeId);
+
+    /**
+     * The shared state an exploration resolves once up front instead of looking it up, while it
+     * runs on a worker thread. Unset outside UpdateAvailableBranchesInParallel.
+     */
+    struct FExploreContext
+    {
+        UArticyDatabase* Database = nullptr;
+        UArticyGlobalVariables* GVs = nullptr;
+        UArticyExpressoScripts* ExpressoInstance = nullptr;
+        UObject* MethodsProvider = nullptr;
+        /**
+         * Whether shadowed operations push shadow states of the database too, for a context used on the game thread
+         * only whose scripts may write objects (see FArticyFlowSimulator).
+         */
+        bool bShadowDatabase = false;
+        /**
+         * The shadow level of the database the shadowed operations of this player start from, set when the whole
+         * flow runs in a shadow state of the database (see FArticyFlowReplay).
+         */
+        uint32 DatabaseShadowLevel = 0;
+    };
+    FExploreContext ExploreContext;
+
+    /** Whether this player can explore on a worker thread right now. */
+    bool CanExploreInParallel() const;
+
+    /** The expresso scripts instance explorations of this player use. */
+    UArticyExpressoScripts* GetExpressoInstance() const;
+
+    /** The prefetched media, the most recently used last. They are referenced so they stay resident until evicted. */
+    UPROPERTY(Transient)
+    TArray<UObject*> PrefetchedMedia;
+
+    /** The estimated resource size of each of the PrefetchedMedia, and their sum. */
+    TArray<SIZE_T> PrefetchedMediaSizes;
+    SIZE_T PrefetchedMediaSize = 0;
+
+    /** Issues the asynchronous loads of the media of the available branches, see bPrefetchBranchMedia. */
+    void PrefetchBranchMedia();
+
+    /** Marks a prefetched media as most recently used, and evicts the least recently used above the budget. */
+    void AddPrefetchedMedia(UObject* Media);
+
+    /** The objects whose texts are resolved next, see bPrewarmBranchTexts, and the index of the next one. */
+    TArray<TWeakObjectPtr<UObject>> PendingTextWarmups;
+    int32 NextTextWarmup = 0;
+
+    /** Queues the objects whose texts are resolved after the available branches were updated, see bPrewarmBranchTexts. */
+    void QueueTextWarmups();
+
+    /** Resolves the texts of the next PrewarmTextsPerFrame queued objects. */
+    void ContinueTextWarmups();
+
 private:
     /**
      * Updates the list of available branches.
@@ -286,6 +814,13 @@ private:
      */
     void UpdateAvailableBranchesInternal(bool Startup);
 
+    /** The package of the cursor, pinned so the package residency budget does not evict it while it is played. */
+    FString PinnedPackage;
+    TWeakObjectPtr<UArticyDatabase> PinnedDatabase;
+
+    /** Pins the package of the cursor object, and unpins the one of the previous cursor. */
+    void PinCursorPackage();
+
     /** The current position in the flow. */
     UPROPERTY(Transient)
     TScriptInterface<IArticyFlowObject> Cursor = nullptr;
@@ -302,6 +837,87 @@ private:
     /** Returns a ptr to the unshadowed object of this node */
     IArticyFlowObject* GetUnshadowedNode(IArticyFlowObject* Node);
 
+    /** A node of an explored path, linked to the node before it. Branches with a common prefix share its nodes. */
+    struct FExplorePathNode
+    {
+        TScriptInterface<IArticyFlowObject> Node;
+        int32 Previous = INDEX_NONE;
+    };
+
+    /** The path nodes of the current exploration, and the last node of the path currently explored. */
+    TArray<FExplorePathNode> ExplorePathNodes;
+    int32 ExplorePathTail = INDEX_NONE;
+
+    /** The nodes the current exploration reached, tagged with the validity of their path (see bMergeConvergingBranches). */
+    TSet<UPTRINT> ExploreVisited;
+
+    /** The number of input pins with a false condition on the path currently explored. */
+    int32 ExploreInvalidDepth = 0;
+
+    /** Returns false if the current exploration reached a node on a path with the same validity already. */
+    bool MarkExploreVisited(const UObject* Node);
+
+    /** Removes the branches ending at the same target with the same validity as an earlier one. */
+    static void MergeConvergingBranches(TArray<FArticyBranch>& Branches);
+
+    /** Appends the unshadowed node to the current explore path, and returns the index of the new path node. */
+    int32 AddExplorePathNode(IArticyFlowObject* Node);
+
+    /** Fills the Path of a branch from its chain of explore path nodes. */
+    void MaterializePath(FArticyBranch& Branch) const;
+
+    /**
+     * The flow graph counterpart of Explore: explores a node of the graph and appends the branches to OutBranches.
+     * An Index of INDEX_NONE is a missing node, which ends the branch.
+     */
+    void ExploreGraphNode(const FArticyFlowGraph& Graph, int32 Index, bool bShadowed, int32 Depth, bool IncludeCurrent, TArray<FArticyBranch>& OutBranches);
+
+    /** Sets the current object and speaker of the expresso scripts to the ones of a graph node. */
+    void SetScriptContext(const FArticyFlowGraph& Graph, const FArticyFlowGraphNode& Node);
+
+    /**
+     * Runs the script of a graph node, a condition if bIsCondition is set. A budgeted exploration records the result,
+     * and takes the recorded one on the way to where it continues instead of running the script again.
+     */
+    bool RunGraphScript(const FArticyFlowGraphNode& Node, bool bIsCondition);
+
+    /**
+     * Explores the ChildIndex'th child of a graph node. Children which a continued exploration explored
+     * already are skipped.
+     */
+    void ExploreGraphChild(const FArticyFlowGraph& Graph, int32 ChildIndex, int32 Index, bool bShadowed, int32 Depth, TArray<FArticyBranch>& OutBranches);
+
+    /** The budget of the current flow graph exploration. */
+    struct FExploreBudget
+    {
+        bool bActive = false;
+        bool bExhausted = false;
+        int32 NumVisited = 0;
+        double Deadline = 0.0;
+
+        /** The child indices leading to the node being explored, and to the node the exploration continues at. */
+        TArray<int32> ChildPath;
+        TArray<int32> ResumePath;
+        bool bOnResumePath = false;
+
+        /** The script results of the nodes along ChildPath and ResumePath, see FArticyExploreScriptResult. */
+        TArray<FArticyExploreScriptResult> PathResults;
+        TArray<FArticyExploreScriptResult> ResumeResults;
+    };
+    FExploreBudget ExploreBudget;
+
+    /** Counts a visited node against the budget, returns false if the node must not be explored anymore. */
+    bool ConsumeExploreBudget();
+
+    /** The counterpart of IArticyFlowObject::Explore for a node of the flow graph. */
+    void ExploreGraphTargets(const FArticyFlowGraph& Graph, const FArticyFlowGraphNode& Node, int32 Depth, TArray<FArticyBranch>& OutBranches);
+
+    /** Explores the skip-ahead target of a graph node (see FArticyFlowGraphNode::SkipTarget), returns false if it can't be skipped to. */
+    bool ExploreGraphSkipAhead(const FArticyFlowGraph& Graph, const FArticyFlowGraphNode& Node, int32 Depth, TArray<FArticyBranch>& OutBranches);
+
+    /** Appends a graph node to the current explore path, and returns the index of the new path node. */
+    int32 AddExplorePathNode(const FArticyFlowGraphNode& Node);
+
     UArticyDatabase* GetDB() const;
 };
 
@@ -331,27 +947,43 @@ void UArticyFlowPlayer::ShadowedOperation(Lambda Operation) const
         return;
     }
 
-    //push shadow state
-    ++ShadowLevel;
+    //parallel explorations share the database, which stays in the live state as they don't modify objects
+    const bool bParallel = ExploreContext.Database != nullptr;
+    const bool bShadowDatabase = !bParallel || ExploreContext.bShadowDatabase;
 
-    //notify on push
-    GetGVs()->PushState(ShadowLevel);
-    GetGVs()->PushSeen();
-    UArticyDatabase::Get(this)->PushState(ShadowLevel);
-    OnShadowOpStart.Broadcast();
+    {
+        SCOPE_CYCLE_COUNTER(STAT_ArticyShadowPush);
+
+        //push shadow state
+        ++ShadowLevel;
+
+        //notify on push
+        GetGVs()->PushState(ShadowLevel);
+        GetGVs()->PushSeen();
+        if (bShadowDatabase)
+            GetDB()->PushState(ExploreContext.DatabaseShadowLevel + ShadowLevel);
+        if (!bParallel)
+            OnShadowOpStart.Broadcast();
+    }
 
     //execute the operation
     Operation();
 
-    //notify on pop
-    OnShadowOpEnd.Broadcast();
-    UArticyDatabase::Get(this)->PopState(ShadowLevel);
-    GetGVs()->PopSeen();
-    GetGVs()->PopState(ShadowLevel);
-
-    //pop shadow state
-    if (ensure(ShadowLevel > 0))
-        --ShadowLevel;
+    {
+        SCOPE_CYCLE_COUNTER(STAT_ArticyShadowPop);
+
+        //notify on pop
+        if (!bParallel)
+            OnShadowOpEnd.Broadcast();
+        if (bShadowDatabase)
+            GetDB()->PopState(ExploreContext.DatabaseShadowLevel + ShadowLevel);
+        GetGVs()->PopSeen();
+        GetGVs()->PopState(ShadowLevel);
+
+        //pop shadow state
+        if (ensure(ShadowLevel > 0))
+            --ShadowLevel;
+    }
 }
 
 /**
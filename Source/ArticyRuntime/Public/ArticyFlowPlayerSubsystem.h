@@ -0,0 +1,59 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ArticyFlowPlayerSubsystem.generated.h"
+
+class UArticyFlowPlayer;
+
+/**
+ * Ticks the flow players of a world, instead of each player ticking on its own.
+ *
+ * A player is only ticked while it has something to do: branches queued by Play, or a budgeted exploration to
+ * continue. The queued branches of all woken players are traversed first, those of the players sharing a GV
+ * instance in one change batch, then their available branches are updated together, in parallel if
+ * UArticyPluginSettings::bUpdateFlowPlayersInParallel is set (see UArticyFlowPlayer::UpdateAvailableBranchesInParallel).
+ */
+UCLASS()
+class ARTICYRUNTIME_API UArticyFlowPlayerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the subsystem of the world of an object, or null if the object is not part of a world. */
+	static UArticyFlowPlayerSubsystem* Get(const UObject* WorldContext);
+
+	/** Called by the players when they begin and end play. */
+	void Register(UArticyFlowPlayer* Player);
+	void Unregister(UArticyFlowPlayer* Player);
+
+	/** Schedules a registered player for the next tick. */
+	void Wake(UArticyFlowPlayer* Player);
+
+	/** Returns the number of players taking part in play. */
+	int32 GetNumPlayers() const { return NumPlayers; }
+
+	void Tick(float DeltaTime) override;
+	TStatId GetStatId() const override;
+
+	/** The players traversed while the game is paused, like they did on the core ticker. */
+	bool IsTickableWhenPaused() const override { return true; }
+
+private:
+
+	/** Traverses the branches of the players and updates their available branches, once. */
+	void TickPlayers(const TArray<UArticyFlowPlayer*>& Players, TSet<UArticyFlowPlayer*>& Continued);
+
+	/** The players to tick, in the order they were woken. */
+	TArray<TWeakObjectPtr<UArticyFlowPlayer>> ScheduledPlayers;
+
+	/** The players whose budgeted exploration continues on the next tick. */
+	TArray<TWeakObjectPtr<UArticyFlowPlayer>> NextTickPlayers;
+
+	int32 NumPlayers = 0;
+};
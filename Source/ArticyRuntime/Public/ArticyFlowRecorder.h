@@ -0,0 +1,99 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ArrayView.h"
+
+/** What a flow record stands for. */
+enum class EArticyFlowRecordType : uint8
+{
+	/** A branch was picked to be played, the node is its target. */
+	Choice,
+	/** A node was executed while a branch was traversed. */
+	Visit,
+};
+
+/**
+ * One event recorded by FArticyFlowRecorder, written to the record file as it is.
+ */
+struct FArticyFlowRecord
+{
+	/** FPlatformTime::Seconds when the event was recorded. */
+	double Timestamp = 0.0;
+
+	/**
+	 * The dense index of the node in the flow graph (see FArticyFlowGraph::FindNode), INDEX_NONE if it is not part of it
+	 * or the graph is not built, e.g. for players that don't use it (see UArticyFlowPlayer::bUseFlowGraph).
+	 */
+	int32 NodeIndex = INDEX_NONE;
+
+	/** The index of the branch among the available branches, INDEX_NONE for branches not played by index (e.g. fast-forwards). */
+	int16 BranchIndex = INDEX_NONE;
+
+	EArticyFlowRecordType Type = EArticyFlowRecordType::Visit;
+
+	uint8 Reserved = 0;
+};
+
+static_assert(sizeof(FArticyFlowRecord) == 16, "The record file stores the records as they are.");
+
+/**
+ * Receives the flow records in batches, e.g. to forward them to an analytics provider. See FArticyFlowRecorder::AddSink.
+ */
+class IArticyFlowRecordSink
+{
+public:
+
+	virtual ~IArticyFlowRecordSink() = default;
+
+	/** Called on the writer thread with the records in the order they were recorded. */
+	virtual void ConsumeRecords(TConstArrayView<FArticyFlowRecord> Records) = 0;
+};
+
+/**
+ * @class FArticyFlowRecorder
+ * @brief Records which flow nodes are visited and which branches are picked by the flow players.
+ *
+ * Recording is off by default and enabled with the console variable Articy.RecordFlow. The flow players record on
+ * the game thread into a lock-free single producer ring buffer, without allocating or formatting strings; a record
+ * is dropped if the buffer is full (see GetNumDropped). A writer thread takes the records out in batches, appends
+ * them to the file set by Articy.RecordFlowFile and passes them to the sinks.
+ *
+ * The file starts with a header (the magic "AFRC", the format version and the size of a record, as uint32 each),
+ * followed by the FArticyFlowRecord structs in the byte order of the platform.
+ */
+class ARTICYRUNTIME_API FArticyFlowRecorder
+{
+public:
+
+	/** @brief Returns true if flow events are recorded. */
+	static bool IsEnabled();
+
+	/**
+	 * @brief Adds an event to the ring buffer, starting the writer thread on first use. Only records on the game thread.
+	 *
+	 * @param Type What the event stands for.
+	 * @param NodeIndex The dense index of the node in the flow graph.
+	 * @param BranchIndex The index of the branch, or INDEX_NONE.
+	 */
+	static void Record(EArticyFlowRecordType Type, int32 NodeIndex, int32 BranchIndex);
+
+	/**
+	 * @brief Adds a sink, which receives all records written from then on.
+	 *
+	 * @param Sink The sink, kept until it is removed.
+	 */
+	static void AddSink(const TSharedRef<IArticyFlowRecordSink, ESPMode::ThreadSafe>& Sink);
+
+	/** @brief Removes a sink; it receives no more batches once this returns. */
+	static void RemoveSink(const TSharedRef<IArticyFlowRecordSink, ESPMode::ThreadSafe>& Sink);
+
+	/** @brief Returns the number of records dropped because the ring buffer was full. */
+	static uint64 GetNumDropped();
+
+	/** @brief Stops the writer thread after it wrote the remaining records, and closes the file. */
+	static void Shutdown();
+};
@@ -0,0 +1,212 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+#include "UObject/WeakObjectPtr.h"
+
+class UArticyDatabase;
+class UArticyPrimitive;
+
+/**
+ * @class FArticyMethodResultLog
+ * @brief The return values of the user methods called by the scripts, recorded while a flow is captured and returned
+ * again while it is replayed, so a replay does not need the methods provider of the game.
+ *
+ * The values are kept in a stream per method in the order of the calls, so a replay only diverges for the methods
+ * whose calls changed. Results served from the memos of pure methods are neither recorded nor replayed.
+ * Objects are stored by id and looked up in the database of the replay.
+ */
+class ARTICYRUNTIME_API FArticyMethodResultLog
+{
+public:
+
+	/** @brief Appends the result of a call of a method. */
+	void Record(const TCHAR* Method, bool Value);
+	void Record(const TCHAR* Method, int32 Value);
+	void Record(const TCHAR* Method, float Value);
+	void Record(const TCHAR* Method, const FString& Value);
+	void Record(const TCHAR* Method, const UArticyPrimitive* Value);
+
+	/**
+	 * @brief Returns the next recorded result of a method while replaying.
+	 *
+	 * If the method has no results left or was recorded with another type, the replay diverged: OutValue is left
+	 * as it is and the divergence is counted, see GetNumDivergences.
+	 */
+	void Replay(const TCHAR* Method, bool& OutValue);
+	void Replay(const TCHAR* Method, int32& OutValue);
+	void Replay(const TCHAR* Method, float& OutValue);
+	void Replay(const TCHAR* Method, FString& OutValue);
+	void Replay(const TCHAR* Method, UArticyPrimitive*& OutValue);
+
+	/**
+	 * @brief Rewinds the streams and switches to replaying.
+	 *
+	 * @param InDatabase The database the recorded objects are looked up in.
+	 */
+	void StartReplay(const UArticyDatabase* InDatabase);
+
+	/** @brief Returns true while the results are replayed instead of recorded. */
+	bool IsReplaying() const { return bReplaying; }
+
+	/** @brief Returns the number of results recorded. */
+	int32 GetNumResults() const;
+
+	/** @brief Returns the number of calls the replay had no matching result for. */
+	int32 GetNumDivergences() const { return NumDivergences; }
+
+	void Serialize(FArchive& Ar);
+
+private:
+
+	/** The type of the results of a method, stored once per stream. */
+	enum class EValueType : uint8
+	{
+		Bool,
+		Int,
+		Float,
+		String,
+		Object,
+	};
+
+	/** The results of one method. */
+	struct FStream
+	{
+		EValueType Type = EValueType::Bool;
+		int32 NumValues = 0;
+		TArray<uint8> Bytes;
+
+		/** The offset of the next result to replay. */
+		int64 ReadOffset = 0;
+	};
+
+	template<typename T>
+	void Write(const TCHAR* Method, EValueType Type, T& Value);
+
+	template<typename T>
+	bool Read(const TCHAR* Method, EValueType Type, T& OutValue);
+
+	TMap<FName, FStream> Streams;
+
+	TWeakObjectPtr<const UArticyDatabase> Database;
+	bool bReplaying = false;
+	int32 NumDivergences = 0;
+};
+
+/** An action of the player of a capture: a branch was played, or the cursor was set. */
+struct ARTICYRUNTIME_API FArticyFlowCaptureStep
+{
+	/** The target of the played branch, or the node the cursor was set to. */
+	FArticyId NodeId;
+
+	/** The index of the played branch as passed to UArticyFlowPlayer::Play, INDEX_NONE if the cursor was set. */
+	int32 BranchIndex = INDEX_NONE;
+
+	/** The state of the global variables before the step if they were changed outside of the flow since the previous one. */
+	TArray<uint8> State;
+};
+
+/**
+ * @class FArticyFlowCapture
+ * @brief Everything needed to replay the dialogue of a flow player exactly, see UArticyFlowPlayer::StartCapture and
+ * FArticyFlowReplay.
+ *
+ * Holds the state of the global variables and seen counters when the capture started, the settings of the player
+ * which change the exploration, the branches played and the cursor changes, and the results of the user methods.
+ */
+class ARTICYRUNTIME_API FArticyFlowCapture
+{
+public:
+
+	/** The schema hash of the global variables, see UArticyGlobalVariables::GetSchemaHash. */
+	uint32 SchemaHash = 0;
+
+	/** The snapshot of the global variables when the capture started, see UArticyGlobalVariables::SaveSnapshot. */
+	TArray<uint8> InitialState;
+
+	/** The cursor when the capture started, and whether the available branches then included it (see UArticyFlowPlayer::SetCursorTo). */
+	FArticyId StartId;
+	bool bStartup = false;
+
+	/** The settings of the player. */
+	uint8 PauseOn = 0;
+	int32 ExploreLimit = 0;
+	uint8 ShadowLevelLimit = 0;
+	bool bIgnoreInvalidBranches = true;
+	bool bMergeConvergingBranches = false;
+	bool bCacheExploration = false;
+	int32 ExplorationCacheSize = 0;
+	bool bUseFlowGraph = false;
+
+	TArray<FArticyFlowCaptureStep> Steps;
+
+	FArticyMethodResultLog MethodResults;
+
+	/** The values version of the global variables after the last step, to detect changes outside of the flow. Not saved. */
+	uint32 ValuesVersion = 0;
+
+	void Serialize(FArchive& Ar);
+
+	/**
+	 * @brief Saves the capture to a file.
+	 *
+	 * @param Filename The file, relative paths are relative to Saved/Articy/Captures.
+	 * @return True if the file was written.
+	 */
+	bool SaveToFile(const FString& Filename);
+
+	/** @brief Loads a capture written by SaveToFile, returns false if the file is missing or invalid. */
+	bool LoadFromFile(const FString& Filename);
+
+	/** @brief Returns the path of a capture file, relative paths are relative to Saved/Articy/Captures. */
+	static FString GetCapturePath(const FString& Filename);
+};
+
+/** The outcome of a replay. */
+struct ARTICYRUNTIME_API FArticyFlowReplayResult
+{
+	/** The number of steps replayed, and the number of them whose branch was missing or had another target. */
+	int32 NumSteps = 0;
+	int32 NumFailedSteps = 0;
+
+	/** The number of user method calls without a matching recorded result, see FArticyMethodResultLog. */
+	int32 NumDivergences = 0;
+
+	/** The cursor after each step. */
+	TArray<FArticyId> Cursors;
+
+	/** The CRC of the snapshot of the global variables after the last step. */
+	uint32 FinalStateHash = 0;
+
+	/** The time the steps took, including the explorations. */
+	double Seconds = 0.0;
+};
+
+/**
+ * @class FArticyFlowReplay
+ * @brief Replays a flow capture with a headless flow player, e.g. to profile the exact workload of a playtest
+ * session offline or to compare two builds.
+ *
+ * The player explores with a fork of the global variables of the world, restored to the state the capture started
+ * with, and the user methods return the recorded results instead of being called. Methods without a result are not
+ * called, so void methods are skipped. The objects are written in a shadow state of the database, which is popped
+ * once the replay is done, so the live objects keep their state.
+ */
+class ARTICYRUNTIME_API FArticyFlowReplay
+{
+public:
+
+	/**
+	 * @brief Replays a capture, and logs the result.
+	 *
+	 * @param WorldContext The world whose database and global variables are used.
+	 * @param Capture The capture to replay.
+	 * @param OutResult Receives the outcome.
+	 * @return False if the capture could not be replayed, e.g. because its start node is missing.
+	 */
+	static bool Run(const UObject* WorldContext, const FArticyFlowCapture& Capture, FArticyFlowReplayResult& OutResult);
+};
@@ -0,0 +1,136 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FArticyFlowGraph;
+class FJsonObject;
+class UArticyDatabase;
+class UArticyFlowPlayer;
+class UArticyGlobalVariables;
+
+/**
+ * @struct FArticyFlowSimulatorConfig
+ * @brief Where the random playthroughs of the flow simulator start, how many there are and how long they may take.
+ */
+struct ARTICYRUNTIME_API FArticyFlowSimulatorConfig
+{
+	/** The node the playthroughs start at: its id (decimal or 0x hex) or technical name. */
+	FString Start;
+
+	/** The number of playthroughs. */
+	int32 Playthroughs = 10000;
+
+	/** The maximum number of branches a playthrough plays before it is stopped. */
+	int32 MaxSteps = 1000;
+
+	/** The number of worker threads, 0 for as many as the task graph has. */
+	int32 Workers = 0;
+
+	/** The seed of the branch choices, a playthrough always takes the same branches for the same seed and state. */
+	int32 Seed = 1;
+
+	/** The time after which no more playthroughs are started, 0 for no limit. */
+	double MaxSeconds = 0.0;
+
+	/** The base path of the results files, without extension. Defaults to Saved/Articy/Simulation/FlowSimulationResults. */
+	FString ResultsPath;
+
+	/**
+	 * Reads the configuration from the arguments of the console command or the command line,
+	 * e.g. Start=0x0100000000001234 Playthroughs=1000000 MaxSeconds=28800. Values out of range are clamped with a warning.
+	 */
+	static FArticyFlowSimulatorConfig FromArgs(const TCHAR* Params);
+
+	TSharedRef<FJsonObject> ToJson() const;
+};
+
+/**
+ * @class FArticyFlowSimulator
+ * @brief Walks random playthroughs of the flow headlessly, to find dead ends and unreachable content and to measure
+ * what the flow costs at runtime.
+ *
+ * Every playthrough starts at the configured node with the global variables and seen counters of the world, and
+ * plays random valid branches until the flow ends, no branch is left or the step limit is reached. The playthroughs
+ * run on worker threads, each worker with a flow player, a fork of the global variables and an expresso scripts
+ * instance of its own, like UArticyFlowPlayer::UpdateAvailableBranchesInParallel. The flow graph is explored and
+ * traversed, so the start node must be part of it.
+ *
+ * Reported are the coverage of the flow nodes, how often each node ended a playthrough, split into dead ends (the
+ * node has connections, but none was valid) and endings (the node has none), and per node the time spent exploring
+ * the branches from it and executing its scripts. The results are logged and written to
+ * Saved/Articy/Simulation/FlowSimulationResults.json and .csv.
+ *
+ * As the workers share the database, user methods must be thread safe, like for bAllowParallelExploration. If a
+ * script reachable from the start may write objects (see FArticyFlowGraphNode::bMayWriteObjects), the playthroughs
+ * run one after another on the game thread instead, each in a shadow state of the database, so the objects of the
+ * game are left as they were.
+ */
+class ARTICYRUNTIME_API FArticyFlowSimulator
+{
+public:
+
+	/**
+	 * Runs the playthroughs and writes the results. Blocks the game thread until all of them are done.
+	 * @param WorldContext The object to get the database and global variables from.
+	 * @param Config The start node and number of playthroughs.
+	 * @return False if the simulation could not be run, e.g. without a start node in the flow graph.
+	 */
+	static bool Run(const UObject* WorldContext, const FArticyFlowSimulatorConfig& Config);
+
+private:
+
+	/** What the playthroughs of a worker recorded for a flow graph node. */
+	struct FNodeStats
+	{
+		int64 Visits = 0;
+		int64 DeadEnds = 0;
+		int64 Endings = 0;
+
+		/** How often the branches from the node were explored, and the cycles that took. */
+		int64 Explorations = 0;
+		uint64 ExploreCycles = 0;
+
+		/** The cycles the scripts of the node and of its output pins took while being traversed. */
+		uint64 ExecuteCycles = 0;
+	};
+
+	/** The totals of the playthroughs, and the node stats indexed like the flow graph. */
+	struct FStats
+	{
+		int64 Playthroughs = 0;
+		int64 Steps = 0;
+		int64 DeadEnds = 0;
+		int64 Endings = 0;
+		int64 StepLimits = 0;
+		TArray<FNodeStats> Nodes;
+
+		void Append(const FStats& Other);
+	};
+
+	/** What a worker needs to run playthroughs, resolved on the game thread. */
+	struct FWorker
+	{
+		UArticyFlowPlayer* Player = nullptr;
+		UArticyGlobalVariables* GVs = nullptr;
+		FStats Stats;
+
+		/** Whether each playthrough runs in a shadow state of the database, so its object writes are undone. */
+		bool bShadowObjects = false;
+	};
+
+	/**
+	 * Walks one playthrough and records it in the stats of the worker.
+	 * @param Seed The seed of the branch choices of this playthrough.
+	 */
+	static void RunPlaythrough(const FArticyFlowGraph& Graph, int32 StartIndex, const UArticyGlobalVariables* InitialGVs, const FArticyFlowSimulatorConfig& Config, int32 Seed, FWorker& Worker);
+
+	/** Returns true if a graph node continues somewhere, so that not finding a branch from it is a dead end. */
+	static bool HasConnections(const FArticyFlowGraph& Graph, int32 Index);
+
+	/** Logs the results, with the coverage of the nodes reachable from the start, and writes them to the results files. */
+	static void WriteResults(const FArticyFlowGraph& Graph, int32 StartIndex, const FArticyFlowSimulatorConfig& Config, const FStats& Stats, double Seconds);
+};
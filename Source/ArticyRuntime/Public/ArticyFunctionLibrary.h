@@ -26,7 +26,7 @@ public:
      * @return The UArticyObject referenced by the ArticyRef.
      */
     UFUNCTION(BlueprintPure, meta = (DisplayName = "Get Object", DefaultToSelf = "WorldContext", DeterminesOutputType = "CastTo"), Category = "ArticyRef")
-    static UArticyObject* ArticyRef_GetObject(FArticyRef Ref, TSubclassOf<class UArticyObject> CastTo, const UObject* WorldContext);
+    static UArticyObject* ArticyRef_GetObject(const FArticyRef& Ref, TSubclassOf<class UArticyObject> CastTo, const UObject* WorldContext);
 
     /**
      * Sets the referenced object of an ArticyRef.
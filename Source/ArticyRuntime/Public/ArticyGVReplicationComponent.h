@@ -0,0 +1,86 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/NetSerialization.h"
+#include "ArticyGVReplicationComponent.generated.h"
+
+class UArticyGlobalVariables;
+class UArticyAlternativeGlobalVariables;
+
+/**
+ * The replicated state of a GV instance, which is serialized as the changes of its variables since the last update
+ * sent to a connection (see NetDeltaSerialize).
+ *
+ * The first update of a connection contains the values of all variables in the order of their dense indices. Later
+ * updates contain the dense index (delta encoded) and value of each variable whose change version changed since, so
+ * several changes of a variable within a net update are sent once, and the bandwidth is proportional to the number
+ * of changed variables. Bools are sent as single bits, ints as zigzag var-ints and strings as strings.
+ */
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyGvReplicationState
+{
+	GENERATED_BODY()
+
+public:
+
+	/** The GV instance the state is read from on the server, and written to on the clients. */
+	TWeakObjectPtr<UArticyGlobalVariables> GlobalVariables;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+
+private:
+
+	/** On clients: whether the schema hash of the last full update matches the one of GlobalVariables. */
+	bool bSchemaMatches = false;
+};
+
+template<>
+struct TStructOpsTypeTraits<FArticyGvReplicationState> : public TStructOpsTypeTraitsBase2<FArticyGvReplicationState>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/**
+ * This component replicates the global variables from the server to the clients, e.g. for co-op games. Add it to an
+ * actor which is replicated to all clients, like the game state.
+ *
+ * Only the variables are replicated, not the seen counters. The server is authoritative: changes made on a client
+ * are overwritten by the next update which contains the variable. The server and the clients need the same generated
+ * global variables; if the schema hash differs, a client ignores the updates.
+ */
+UCLASS(BlueprintType, ClassGroup = "Articy", meta = (BlueprintSpawnableComponent))
+class ARTICYRUNTIME_API UArticyGVReplicationComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UArticyGVReplicationComponent();
+
+	void BeginPlay() override;
+	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Returns the replicated GV instance: the runtime clone of OverrideGV if it is set, the default instance otherwise. */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	UArticyGlobalVariables* GetGVs() const;
+
+	/**
+	 * The alternative global variables to replicate, like UArticyFlowPlayer::OverrideGV.
+	 * Keep as nullptr to replicate the default shared global variables.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Setup")
+	UArticyAlternativeGlobalVariables* OverrideGV = nullptr;
+
+private:
+
+	UPROPERTY(Replicated)
+	FArticyGvReplicationState ReplicatedState;
+};
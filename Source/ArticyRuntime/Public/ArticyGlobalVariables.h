@@ -5,6 +5,7 @@
 #pragma once
 
 #include "ArticyRuntimeModule.h"
+#include "ArticyStats.h"
 #include "Interfaces/ArticyReflectable.h"
 #if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >0 
 #include "AssetRegistry/AssetRegistryModule.h"
@@ -13,6 +14,7 @@
 #endif
 #include "ShadowStateManager.h"
 #include "ArticyExpressoScripts.h"
+#include "ArticyGvProfiler.h"
 #include "ArticyGlobalVariables.generated.h"
 
 class UArticyAlternativeGlobalVariables;
@@ -27,17 +29,109 @@ class UArticyAlternativeGlobalVariables;
 	}										\
 	const T& Get() const					\
 	{										\
-		/*just return the value*/			\
+		/*return the value, and let an exploration know it depends on it*/	\
+		NotifyRead();						\
 		return Value;						\
 	}										\
 	operator const T &() const				\
 	{										\
 		/*just return the value*/			\
 		return Get();						\
+	}										\
+	const T& GetUnshadowed() const			\
+	{										\
+		/*the value outside of the shadow states, the oldest shadow holds it*/	\
+		return Shadows.Num() > 0 ? Shadows[0].Value : Value;	\
 	}
 	
 
 class UArticyFlowPlayer;
+
+/** The seen counter and fallback evaluation state of a flow node. */
+struct FArticyNodeVisitState
+{
+	int SeenCounter = 0;
+	bool bFallbackEvaluation = false;
+};
+
+/** What is needed to restore the node visit states when a shadow level is popped. */
+struct FArticyNodeVisitLayer
+{
+	/** The slots changed in this layer with their previous states, restored in reverse order. */
+	TArray<TPair<int32, FArticyNodeVisitState>> Undo;
+
+	/** If ResetVisited was called in this layer: all states from before the layer, which replace the current ones. */
+	TArray<FArticyNodeVisitState> SavedStates;
+	bool bSavedAll = false;
+
+	/** The number of nodes with an active fallback evaluation when the layer was pushed. */
+	int32 NumFallbackEvaluations = 0;
+};
+
+/**
+ * The initial values of the variables of a generated GV class, by type in the order of their dense indices.
+ * Built once from the class default object and shared by all instances, see UArticyGlobalVariables::ResetToDefaults.
+ */
+struct FArticyGvDefaults
+{
+	TArray<int32> Ints;
+	TArray<bool> Bools;
+	TArray<FString> Strings;
+};
+
+/**
+ * The values of an FArticyGvState which changed, with the values they had before, see UArticyGlobalVariables::UpdateState.
+ */
+struct ARTICYRUNTIME_API FArticyGvDelta
+{
+	/** The previous values by their index in the arrays of the state. */
+	TArray<TPair<int32, int32>> Ints;
+	TArray<TPair<int32, bool>> Bools;
+	TArray<TPair<int32, FString>> Strings;
+	TArray<TPair<int32, FArticyNodeVisitState>> VisitStates;
+
+	/** The previous number of visit states and of nodes with an active fallback evaluation. */
+	int32 NumVisitStates = 0;
+	int32 NumFallbackEvaluations = 0;
+
+	bool IsEmpty() const { return Ints.Num() == 0 && Bools.Num() == 0 && Strings.Num() == 0 && VisitStates.Num() == 0; }
+
+	/** Returns the memory held by the delta, in bytes. */
+	SIZE_T GetAllocatedSize() const;
+};
+
+/**
+ * The values of the variables and the node visit states of a GV instance, by type in the order of their dense indices
+ * like FArticyGvDefaults. Captured outside of shadow states, see UArticyGlobalVariables::CaptureState.
+ */
+struct ARTICYRUNTIME_API FArticyGvState
+{
+	TArray<int32> Ints;
+	TArray<bool> Bools;
+	TArray<FString> Strings;
+	TArray<FArticyNodeVisitState> VisitStates;
+	int32 NumFallbackEvaluations = 0;
+
+	/** Sets the previous values recorded in a delta, which turns the state into the one the delta was recorded from. */
+	void Apply(const FArticyGvDelta& Delta);
+
+	/** Returns the memory held by the state, in bytes. */
+	SIZE_T GetAllocatedSize() const;
+};
+
+/**
+ * Assigns each flow node a dense, process wide slot for its seen counter, so the visit states can be stored in arrays.
+ * The slots of all nodes in the flow graph are assigned when it is built, other objects get one when they are first
+ * counted. Slots are never reused, so they are valid for all GV instances.
+ */
+struct ARTICYRUNTIME_API FArticySeenCounterSlots
+{
+	/** Returns the slot of an id, assigning a new one if it has none yet. */
+	static int32 FindOrAdd(const FArticyId& Id);
+
+	/** Returns the id a slot was assigned to. */
+	static FArticyId GetId(int32 Slot);
+};
 class UArticyGlobalVariables;
 class UArticyVariable;
 class UArticyBaseVariableSet;
@@ -45,6 +139,45 @@ class IArticyFlowObject;
 struct ExpressoType;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGVChanged, UArticyVariable*, Variable);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGVsChanged, const TArray<UArticyVariable*>&, Variables);
+
+/**
+ * Collects the global state read while it is set as read recorder of a GV instance,
+ * e.g. by the scripts evaluated during a branch exploration.
+ */
+struct FArticyGvReadSet
+{
+	/** The variables that were read, with their change version at the time of the read. */
+	TMap<TWeakObjectPtr<const UArticyVariable>, uint32> Variables;
+
+	/** Whether any seen counter was read. */
+	bool bReadSeenCounters = false;
+
+	void Reset()
+	{
+		Variables.Reset();
+		bReadSeenCounters = false;
+	}
+};
+
+/**
+ * Collects the global state written while it is set as write recorder of a GV instance,
+ * e.g. by the scripts a budgeted exploration records the results of (see UArticyFlowPlayer::ExploreNodeBudget).
+ */
+struct FArticyGvWriteSet
+{
+	/** The variables that were written, each once. */
+	TArray<UArticyVariable*> Variables;
+
+	/** Whether any seen counter was written. */
+	bool bWroteSeenCounters = false;
+
+	void Reset()
+	{
+		Variables.Reset();
+		bWroteSeenCounters = false;
+	}
+};
 
 /**
  * This struct stores a shadow copy that is restored once the given shadow
@@ -82,6 +215,16 @@ public:
 	const FName& GetNamespace();
 	const FName& GetVariable();
 	const FName& GetFullName();
+
+private:
+
+	friend class UArticyGlobalVariables;
+
+	/** The dense index of the variable, cached by UArticyGlobalVariables::GetVariableIndex. */
+	mutable int32 CachedIndex = INDEX_NONE;
+
+	/** The schema hash of the GV instance the cached index belongs to. */
+	mutable uint32 CachedSchemaHash = 0;
 };
 
 UCLASS(Abstract, BlueprintType)
@@ -103,6 +246,12 @@ public:
 	/** Returns the name of this variable in the form Namespace.Variable */
 	const FName& GetGVName() const { return GVName; }
 
+	/** Returns a counter which is incremented whenever the (layer zero) value of this variable changes. */
+	uint32 GetChangeVersion() const { return ChangeVersion; }
+
+	/** Returns the memory allocated for the values of the shadow states, see FArticyMemoryReport. */
+	virtual SIZE_T GetShadowsAllocatedSize() const { return 0; }
+
 protected:
 	virtual ~UArticyVariable() {}
 
@@ -120,6 +269,7 @@ protected:
 		if(storeLevel > shadowLevel)
 		{																						
 			Instance->Shadows.Push(ArticyShadowState<ValueType>{storeLevel, Instance->Value});
+			INC_DWORD_STAT(STAT_ArticyVariableShadowStates);
 
 			//get notified when the state is popped again
 			RegisterOnStorePop(Instance);												
@@ -131,8 +281,14 @@ protected:
 		}
 		
 		Instance->Value = NewValue;															
+		NotifyWrite();
+		if (FArticyGvProfiler::IsEnabled())
+			ProfileAccess(true);
 		if(storeLevel == 0)
-			OnVariableChanged.Broadcast(this);
+		{
+			++ChangeVersion;
+			BroadcastChanged();
+		}
 
 		return Instance->Value;
 	}																							
@@ -144,10 +300,30 @@ protected:
 			Instance->Value = Instance->Shadows.Pop().Value;
 	}
 
+	/** Undo function recorded with the store, restores the value of the popped state. */
+	template<typename Type>
+	static void UndoShadow(void* Context, int32 Payload, uint32 ShadowLevel)
+	{
+		auto Instance = static_cast<Type*>(Context);
+		Instance->PopState(Instance);
+	}
+
 	template<typename Type>
 	static uint32 GetShadowLevel(Type* Instance);
 	uint32 GetStoreShadowLevel() const;
 
+	/** Records the read in the read recorder of the store, if any. */
+	void NotifyRead() const;
+
+	/** Records the write in the write recorder of the store, if any. */
+	void NotifyWrite();
+
+	/** Counts a read or write with FArticyGvProfiler, as shadowed if the store is in a shadow state. */
+	void ProfileAccess(bool bWrite) const;
+
+	/** Broadcasts OnVariableChanged, or lets the store defer it if it batches changes. */
+	void BroadcastChanged();
+
 	/** The name of this variable in the form Namespace.Variable */
 	UPROPERTY(BlueprintReadOnly, Category = "Articy")
 	FName GVName;
@@ -157,6 +333,9 @@ private:
 	UPROPERTY()
 	UArticyGlobalVariables* Store = nullptr;
 
+	/** See GetChangeVersion. */
+	uint32 ChangeVersion = 0;
+
 	template<typename Type>
 	void RegisterOnStorePop(Type* Instance);
 };
@@ -204,9 +383,9 @@ public:
 	int& operator=(const ExpressoType &NewVal)
 	{
 		if (NewVal.Type == ExpressoType::Float)
-			return Value = NewVal.GetFloat();
+			return *this = (int)NewVal.GetFloat();
 		else
-			return Value = NewVal.GetInt();
+			return *this = (int)NewVal.GetInt();
 	}
 
 	int& operator+=(const ExpressoType &Val)
@@ -253,6 +432,9 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Articy")
 	int Value = -1;
 
+public:
+	virtual SIZE_T GetShadowsAllocatedSize() const override { return Shadows.GetAllocatedSize(); }
+
 private:
 	TArray<ArticyShadowState<int>> Shadows;
 };
@@ -332,7 +514,7 @@ public:
 
 	bool& operator=(const ExpressoType &NewValue)
 	{
-		return Value = NewValue.GetBool();
+		return *this = NewValue.GetBool();
 	}
 
 	/**
@@ -348,6 +530,9 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Articy")
 	bool Value = false;
 
+public:
+	virtual SIZE_T GetShadowsAllocatedSize() const override { return Shadows.GetAllocatedSize(); }
+
 private:
 	TArray<ArticyShadowState<bool>> Shadows;
 };
@@ -372,21 +557,23 @@ public:
 	//other operators
 	//FString& operator+=(const FString &Val) { return Setter<UArticyString>(Value + Val); }
 
-	FString& operator+=(const ExpressoType &Val) { return Setter<UArticyString>(Value + Val.GetString()); }
+	FString& operator+=(const ExpressoType &Val) { return Setter<UArticyString>(Value + (Val.Type == ExpressoType::Object ? Val.ToString() : Val.GetString())); }
 
 	FString& operator=(const ExpressoType &NewValue)
 	{
 		if (NewValue.Type == ExpressoType::Int) // used to store a string representation of an articy object
-			return Value = ArticyHelpers::Uint64ToObjectString(NewValue.GetInt());
+			return *this = ArticyHelpers::Uint64ToObjectString(NewValue.GetInt());
+		else if (NewValue.Type == ExpressoType::Object)
+			return *this = NewValue.ToString();
 		else
-			return Value = NewValue.GetString();
+			return *this = NewValue.GetString();
 	}
 
-	bool operator ==(const FString& text) const { return Value.Equals(text); }
+	bool operator ==(const FString& text) const { return Get().Equals(text); }
 	bool operator !=(const FString& text) const { return !this->operator==(text); }
-	bool operator ==(const FString&& text) const { return Value.Equals(text); }
+	bool operator ==(const FString&& text) const { return Get().Equals(text); }
 	bool operator !=(const FString&& text) const { return !this->operator==(text); }
-	bool operator ==(const char* const text) const { return Value.Equals(text); }
+	bool operator ==(const char* const text) const { return Get().Equals(text); }
 	bool operator !=(const char* const text) const { return !this->operator==(text); }
 
 	/**
@@ -401,6 +588,15 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Articy")
 	FString Value;
 
+public:
+	virtual SIZE_T GetShadowsAllocatedSize() const override
+	{
+		SIZE_T Bytes = Shadows.GetAllocatedSize();
+		for (const auto& Shadow : Shadows)
+			Bytes += Shadow.Value.GetAllocatedSize();
+		return Bytes;
+	}
+
 private:
 	TArray<ArticyShadowState<FString>> Shadows;
 };
@@ -424,46 +620,28 @@ public:
 	FOnGVChanged OnVariableChanged;
 
 	UFUNCTION(BlueprintCallable, Category = "ArticyGlobalVariables", meta = (keywords = "global variables"))
-	const TArray<UArticyVariable*> GetVariables() const { return Variables; }
+	const TArray<UArticyVariable*>& GetVariables() const { return Variables; }
 	
-	UFUNCTION(BlueprintCallable, Category = "ArticyGlobalVariables", meta =(DeterminesOutputType = "Type", keywords = "global variables"))
-	const TArray<UArticyVariable*> GetVariablesOfType(TSubclassOf<UArticyVariable> Type)
-	{
-		TArray<UObject*> subobjects;
-		GetDefaultSubobjects(subobjects);
-		TArray<UArticyVariable*> articyVars;
-		for (int i = 0; i < subobjects.Num(); i++)
-		{
-			const bool bIsA = subobjects[i]->IsA(Type);
-			if (bIsA)
-			{
-				UArticyVariable* Var = Cast<UArticyVariable>(subobjects[i]);
-				articyVars.Add(Var);
-			}
-		}
-		
-		return articyVars;
-	}
+	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "ArticyGlobalVariables", meta =(DeterminesOutputType = "Type", keywords = "global variables"))
+	const TArray<UArticyVariable*>& GetVariablesOfType(TSubclassOf<UArticyVariable> Type) const;
 
 	template<class T>
-	const TArray<T*> GetVariables()
+	const TArray<T*>& GetVariables() const
 	{
-		TArray<UObject*> subobjects;
-		GetDefaultSubobjects(subobjects);
-		TArray<T*> articyVars;
-		for (int i = 0; i < subobjects.Num(); i++)
-		{
-			T* isT = Cast<T>(subobjects[i]);
-			if (isT != nullptr)
-			{
-				articyVars.Add(isT);
-			}
-		}
-		return articyVars;
+		static_assert(TIsDerivedFrom<T, UArticyVariable>::IsDerived, "T must be a variable type.");
+
+		//the lists only contain variables of the class they are stored for
+		return reinterpret_cast<const TArray<T*>&>(GetVariablesOfType(T::StaticClass()));
 	}
+
+	/** Rebuilds the variable lists by type from Variables, called once the generated Init filled it. */
+	void BuildVariablesByType();
 	
 private:
 
+	/** The variables by each of their classes below UArticyVariable, see GetVariablesOfType. */
+	TMap<const UClass*, TArray<UArticyVariable*>> VariablesByType;
+
 	UFUNCTION()
 	void BroadcastOnVariableChanged(UArticyVariable* Variable);
 
@@ -483,6 +661,10 @@ public:
 
 	virtual FPrimaryAssetId GetPrimaryAssetId() const override { return FPrimaryAssetId(FName(TEXT("ArticyGlobalVariables")), GetFName()); }
 
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+	virtual void PostDuplicate(bool bDuplicateForPIE) override;
+
 	/**
 	 * Get a reference to the ArticyGlobalVariables asset.
 	 * Creates a temporary copy if the 
@@ -497,6 +679,45 @@ public:
 	 */
 	static UArticyGlobalVariables* GetRuntimeClone(const UObject* WorldContext, UArticyAlternativeGlobalVariables* GVs);
 
+	/**
+	 * Creates a new instance with the current state of this one, outside of its shadow states.
+	 * The instance is constructed with the initial values, and only the values that differ from them are copied, which is
+	 * much cheaper than duplicating the whole object graph.
+	 */
+	UArticyGlobalVariables* Fork(UObject* Outer, const FName Name) const;
+
+	/**
+	 * Sets the values and seen counters to the ones of another instance of the same class, e.g. to reset a fork
+	 * to the state it was forked from. Only the values which differ are set. The values of the source are the ones
+	 * outside of its shadow states, this instance must not be in a shadow state.
+	 */
+	void CopyStateFrom(const UArticyGlobalVariables* Source);
+
+	/**
+	 * Restores the initial values of all variables and resets the seen counters, e.g. when a new game is started.
+	 * Active shadow states are dropped, and the changed variables are broadcast in one change batch.
+	 * Unlike UnloadGlobalVariables, the instance and the listeners of its variables are kept.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Snapshot")
+	void ResetToDefaults();
+
+	/** Copies the values and the node visit states (outside of shadow states) into a state. */
+	void CaptureState(FArticyGvState& OutState) const;
+
+	/**
+	 * Updates a state captured from this instance to the current values, and records the values which changed with
+	 * their previous ones, so applying the delta to the updated state turns it back into the previous one.
+	 * @param State The state captured by CaptureState, which is updated.
+	 * @param OutUndo Receives the previous values of the changed ones.
+	 */
+	void UpdateState(FArticyGvState& State, FArticyGvDelta& OutUndo) const;
+
+	/**
+	 * Sets the values and the node visit states to the ones of a state captured from this instance.
+	 * Only the values which differ are set, and the changed variables are broadcast in one change batch.
+	 */
+	void RestoreState(const FArticyGvState& State);
+
 	/* Unloads the global variables, which causes that all changes get removed. */
 	UFUNCTION(BlueprintCallable, Category = "Packages")
 	void UnloadGlobalVariables();
@@ -527,6 +748,72 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Setter")
 	void SetStringVariable(FArticyGvName GvName, const FString Value);
 
+	/**
+	 * Returns the dense index of a variable, or INDEX_NONE if there is no such variable.
+	 * The variables are indexed in the order of their namespaces and their order inside of them, so the
+	 * generated code knows the index of each variable at compile time (see <Variable>Index of the namespace class).
+	 */
+	int32 GetVariableIndex(const FName Namespace, const FName Variable) const;
+
+	/**
+	 * Returns the dense index of a variable, or INDEX_NONE if there is no such variable.
+	 * The index is cached in the name, so later lookups with it (or copies of it) are array accesses.
+	 */
+	int32 GetVariableIndex(const FArticyGvName& GvName) const;
+
+	/** Returns the index of a namespace in GetVariableSets, or INDEX_NONE if there is no such namespace. */
+	int32 GetNamespaceIndex(const FName Namespace) const;
+
+	/** Returns the variable with the given dense index, or nullptr if the index is invalid. */
+	UArticyVariable* GetVariableByIndex(const int32 Index) const { return IndexedVariables.IsValidIndex(Index) ? IndexedVariables[Index] : nullptr; }
+
+	/** Returns the variable with the given dense index, or nullptr if the index is invalid or the variable is not a T. */
+	template<typename T>
+	T* GetVariableByIndex(const int32 Index) const { return Cast<T>(GetVariableByIndex(Index)); }
+
+	/** Returns the number of variables in all namespaces. */
+	int32 GetNumVariables() const { return IndexedVariables.Num(); }
+
+	/**
+	 * Writes the values of all variables and the seen counters into a binary snapshot, e.g. for a save game.
+	 * Only the state outside of shadow states can be saved.
+	 * @return false if the snapshot could not be written.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Snapshot")
+	bool SaveSnapshot(TArray<uint8>& OutSnapshot) const;
+
+	/**
+	 * Restores the values of all variables and the seen counters from a snapshot written by SaveSnapshot.
+	 * If the variables changed since the snapshot was written, the values are restored by name, and the ones
+	 * of removed variables or variables with another type are skipped.
+	 * @return false if the snapshot is invalid, in which case nothing is changed.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Snapshot")
+	bool LoadSnapshot(const TArray<uint8>& Snapshot);
+
+	/** Returns a hash of the names and types of all variables, which changes whenever the generated variables change. */
+	uint32 GetSchemaHash() const { return SchemaHash; }
+
+	/**
+	 * This delegate is broadcast with all variables whose (layer zero) value changed in a change batch once it ends,
+	 * and with the single changed variable for changes outside of batches.
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "Callback")
+	FOnGVsChanged OnVariablesChanged;
+
+	/**
+	 * Starts a change batch: until it ends, the OnVariableChanged delegates of the changed variables are deferred.
+	 * They are broadcast once per variable when the batch ends, followed by OnVariablesChanged. Batches can be nested.
+	 */
+	void BeginChangeBatch() { ++ChangeBatchDepth; }
+	void EndChangeBatch();
+
+	/** Called by the variables when their layer zero value changed. */
+	void NotifyVariableChanged(UArticyVariable* Variable);
+
+	/** Returns a counter which is incremented whenever the (layer zero) value of any variable changes. */
+	uint32 GetValuesVersion() const { return ValuesVersion; }
+
 	UFUNCTION(BlueprintCallable, Category="Debug")
 	void EnableDebugLogging();
 	UFUNCTION(BlueprintCallable, Category="Debug")
@@ -534,6 +821,8 @@ public:
 
 	void ResetVisited();
 	int GetSeenCounter(const IArticyFlowObject* Object) const;
+	/** Returns the seen counter of a slot (see FArticySeenCounterSlots), for callers which know the slot but not the object. */
+	int GetSeenCounterOfSlot(int32 Slot) const;
 	int SetSeenCounter(const IArticyFlowObject* Object, int Value);
 	int IncrementSeenCounter(const IArticyFlowObject* Object);
 	bool Fallback(const IArticyFlowObject* Object);
@@ -542,6 +831,23 @@ public:
 	void PushSeen();
 	void PopSeen();
 
+	/** Returns a counter which is incremented whenever a seen counter changes outside of shadow states. */
+	uint32 GetSeenVersion() const { return SeenVersion; }
+
+	/**
+	 * Sets the read set that records all variables and seen counters read from now on, or nullptr to stop recording.
+	 * The read set must stay valid until recording is stopped.
+	 */
+	void SetReadRecorder(FArticyGvReadSet* Recorder) { ReadRecorder = Recorder; }
+	FArticyGvReadSet* GetReadRecorder() const { return ReadRecorder; }
+
+	/**
+	 * Sets the write set that records all variables and seen counters written from now on, or nullptr to stop recording.
+	 * The write set must stay valid until recording is stopped.
+	 */
+	void SetWriteRecorder(FArticyGvWriteSet* Recorder) { WriteRecorder = Recorder; }
+	FArticyGvWriteSet* GetWriteRecorder() const { return WriteRecorder; }
+
 protected:
 
 	UPROPERTY()
@@ -552,23 +858,121 @@ protected:
 
 private:
 
+	friend class FArticyStateSnapshot;
+
 	static TWeakObjectPtr<UArticyGlobalVariables> Clone;
+	/** The world Clone was created or last reset for, and whether it is reused by the next world (see bReuseWorldClones). */
+	static TWeakObjectPtr<UWorld> CloneWorld;
+	static bool bCloneReused;
 
 	// Runtime clones of non-default global variable assets managed by GetRuntimeClone
 	static TMap<FName, TWeakObjectPtr<UArticyGlobalVariables>> OtherClones;
 
-	TArray<TMap<FArticyId, int>> VisitedNodes;
-	TArray<TMap<FArticyId, bool>> bIsFallbackEvaluation;
+	/** The current node visit states by seen counter slot (see FArticySeenCounterSlots), including shadow states. */
+	TArray<FArticyNodeVisitState> VisitStates;
+
+	/** The number of nodes with an active fallback evaluation. */
+	int32 NumFallbackEvaluations = 0;
+
+	/**
+	 * The undo layers of the pushed seen states, one per shadow level. Layers at and above
+	 * NumVisitLayers belong to popped states and are empty, they are kept to reuse their memory.
+	 */
+	TArray<FArticyNodeVisitLayer> VisitLayers;
+	int32 NumVisitLayers = 0;
+
+	FArticyNodeVisitState GetNodeVisitState(const int32 Slot) const { return VisitStates.IsValidIndex(Slot) ? VisitStates[Slot] : FArticyNodeVisitState(); }
+	FArticyNodeVisitState& GetNodeVisitStateForWrite(const int32 Slot);
+
+	/** Returns the node visit states outside of the pushed seen states, and their number of fallback evaluations. */
+	void GetUnshadowedVisitStates(TArray<FArticyNodeVisitState>& OutStates, int32& OutNumFallbackEvaluations) const;
+
+	/** See GetSeenVersion. */
+	uint32 SeenVersion = 0;
+
+	/** See GetValuesVersion. */
+	uint32 ValuesVersion = 0;
+
+	/** See SetReadRecorder. */
+	FArticyGvReadSet* ReadRecorder = nullptr;
+
+	/** See SetWriteRecorder. */
+	FArticyGvWriteSet* WriteRecorder = nullptr;
+
+	/** The nesting depth of the change batches, see BeginChangeBatch. */
+	int32 ChangeBatchDepth = 0;
+
+	/** The variables changed in the current change batch, in the order of their first change. */
+	TArray<UArticyVariable*> PendingChanges;
+
+	/** All variables by their dense index, see GetVariableIndex. */
+	TArray<UArticyVariable*> IndexedVariables;
+
+	/** The dense variable indices by namespace and variable name. */
+	TMap<TPair<FName, FName>, int32> VariableIndices;
+
+	/** The dense variable indices by full name (Namespace.Variable). */
+	TMap<FName, int32> FullNameIndices;
+
+	/** The index of the namespace of each variable, by dense index. */
+	TArray<int32> VariableNamespaces;
+
+	/** The indices of the namespaces in VariableSets by name. */
+	TMap<FName, int32> NamespaceIndices;
+
+	/** The dense indices of the variables of each type, the sections of a snapshot. */
+	TArray<int32> IntVariableIndices;
+	TArray<int32> BoolVariableIndices;
+	TArray<int32> StringVariableIndices;
+
+	/** See GetSchemaHash. */
+	uint32 SchemaHash = 0;
+
+	/** The initial values of the class, see ResetToDefaults. */
+	mutable TSharedPtr<const FArticyGvDefaults> Defaults;
+
+	/** Returns the initial values of the class, built from the class default object on first use. */
+	const FArticyGvDefaults& GetDefaults() const;
+
+	/** Rebuilds the index tables from VariableSets, which the generated Init fills. */
+	void BuildVariableIndex();
 
 	template <typename ArticyVariableType, typename VariablePayloadType>
 	void SetVariableValue(const FName Namespace, const FName Variable, const VariablePayloadType Value);
 	template <typename ArticyVariableType, typename VariablePayloadType>
-	void SetVariableValue(const FName FullVariableName, const VariablePayloadType Value);
+	void SetVariableValue(FArticyGvName& GvName, const VariablePayloadType Value);
 
 	template<typename ArticyVariableType, typename VariablePayloadType>
 	const VariablePayloadType& GetVariableValue(const FName Namespace, const FName Variable, bool& bSucceeded);
 	template<typename ArticyVariableType, typename VariablePayloadType>
-	const VariablePayloadType& GetVariableValue(const FName FullVariableName, bool& bSucceeded);
+	const VariablePayloadType& GetVariableValue(FArticyGvName& GvName, bool& bSucceeded);
+
+	/** Returns true if the variable at Index has the name of GvName, i.e. a cached index is still valid. */
+	bool MatchesVariable(const FArticyGvName& GvName, const int32 Index) const;
+};
+
+/**
+ * Batches the variable change notifications of a GV instance for its lifetime, see UArticyGlobalVariables::BeginChangeBatch.
+ */
+struct FArticyGvChangeBatch
+{
+	explicit FArticyGvChangeBatch(UArticyGlobalVariables* InGV) : GV(InGV)
+	{
+		if (GV)
+			GV->BeginChangeBatch();
+	}
+
+	~FArticyGvChangeBatch()
+	{
+		if (GV)
+			GV->EndChangeBatch();
+	}
+
+	FArticyGvChangeBatch(const FArticyGvChangeBatch&) = delete;
+	FArticyGvChangeBatch& operator=(const FArticyGvChangeBatch&) = delete;
+
+private:
+	UArticyGlobalVariables* GV;
 };
 
 //---------------------------------------------------------------------------//
@@ -591,6 +995,20 @@ void UArticyVariable::Init(UArticyBaseVariableSet* Set, UArticyGlobalVariables*
 	OnVariableChanged.AddDynamic(Set, &UArticyBaseVariableSet::BroadcastOnVariableChanged);
 }
 
+FORCEINLINE void UArticyVariable::NotifyRead() const
+{
+	if (Store && Store->GetReadRecorder())
+		Store->GetReadRecorder()->Variables.Add(this, ChangeVersion);
+	if (FArticyGvProfiler::IsEnabled())
+		ProfileAccess(false);
+}
+
+FORCEINLINE void UArticyVariable::NotifyWrite()
+{
+	if (Store && Store->GetWriteRecorder())
+		Store->GetWriteRecorder()->Variables.AddUnique(this);
+}
+
 template <typename Type>
 uint32 UArticyVariable::GetShadowLevel(Type* Instance)
 {
@@ -600,37 +1018,24 @@ uint32 UArticyVariable::GetShadowLevel(Type* Instance)
 template <typename Type>
 void UArticyVariable::RegisterOnStorePop(Type* Instance)
 {
-#if __cplusplus >= 202002L
-	Store->RegisterOnPopState([=, this] { this->PopState(Instance); });
-#else
-	Store->RegisterOnPopState([=] { this->PopState(Instance); });
-#endif
+	Store->RecordUndo(&UArticyVariable::UndoShadow<Type>, Instance);
 }
 
 template <typename ArticyVariableType, typename VariablePayloadType>
 void UArticyGlobalVariables::SetVariableValue(const FName Namespace, const FName Variable, const VariablePayloadType Value)
 {
-	auto set = GetNamespace(Namespace);
-	if (set)
+	ArticyVariableType* typedPtr = GetVariableByIndex<ArticyVariableType>(GetVariableIndex(Namespace, Variable));
+	if (typedPtr)
 	{
-		UArticyVariable** basePtr = set->GetPropPtr<UArticyVariable*>(Variable);
+		auto& propValue = (*typedPtr);
+		propValue = Value;
 
-		if (basePtr) {
-		
-			ArticyVariableType* typedPtr = dynamic_cast<ArticyVariableType*>(*basePtr);
-			if (typedPtr)
-			{
-				auto& propValue = (*typedPtr);
-				propValue = Value;
-
-				if (bLogVariableAccess)
-				{
-					UE_LOG(LogArticyRuntime, Display, TEXT("Set variable %s::%s : Success"), *Namespace.ToString(), *Variable.ToString());
-				}
-
-				return;
-			}
+		if (bLogVariableAccess)
+		{
+			UE_LOG(LogArticyRuntime, Display, TEXT("Set variable %s::%s : Success"), *Namespace.ToString(), *Variable.ToString());
 		}
+
+		return;
 	}
 
 	if (bLogVariableAccess)
@@ -642,25 +1047,18 @@ void UArticyGlobalVariables::SetVariableValue(const FName Namespace, const FName
 template<typename ArticyVariableType, typename VariablePayloadType>
 const VariablePayloadType& UArticyGlobalVariables::GetVariableValue(const FName Namespace, const FName Variable, bool& bSucceeded)
 {
-	auto set = GetNamespace(Namespace);
-	if (set)
+	ArticyVariableType* typedPtr = GetVariableByIndex<ArticyVariableType>(GetVariableIndex(Namespace, Variable));
+	if (typedPtr)
 	{
-		UArticyVariable** basePtr = set->GetPropPtr<UArticyVariable*>(Variable);
+		auto& propValue = (*typedPtr);
+		bSucceeded = true;
 
-		ArticyVariableType* typedPtr = dynamic_cast<ArticyVariableType*>(*basePtr);
-
-		if (typedPtr)
+		if (bLogVariableAccess)
 		{
-			auto& propValue = (*typedPtr);
-			bSucceeded = true;
-
-			if (bLogVariableAccess)
-			{
-				UE_LOG(LogArticyRuntime, Display, TEXT("Get variable %s::%s : Success"), *Namespace.ToString(), *Variable.ToString());
-			}
-
-			return propValue.Get();
+			UE_LOG(LogArticyRuntime, Display, TEXT("Get variable %s::%s : Success"), *Namespace.ToString(), *Variable.ToString());
 		}
+
+		return propValue.Get();
 	}
 
 	if(bLogVariableAccess)
@@ -672,3 +1070,42 @@ const VariablePayloadType& UArticyGlobalVariables::GetVariableValue(const FName
 	static VariablePayloadType empty = VariablePayloadType();
 	return empty;
 }
+
+template <typename ArticyVariableType, typename VariablePayloadType>
+void UArticyGlobalVariables::SetVariableValue(FArticyGvName& GvName, const VariablePayloadType Value)
+{
+	ArticyVariableType* typedPtr = GetVariableByIndex<ArticyVariableType>(GetVariableIndex(GvName));
+	if (!typedPtr)
+	{
+		//fall back to the lookup by name, which logs the failure
+		SetVariableValue<ArticyVariableType>(GvName.GetNamespace(), GvName.GetVariable(), Value);
+		return;
+	}
+
+	(*typedPtr) = Value;
+
+	if (bLogVariableAccess)
+	{
+		UE_LOG(LogArticyRuntime, Display, TEXT("Set variable %s : Success"), *typedPtr->GetGVName().ToString());
+	}
+}
+
+template<typename ArticyVariableType, typename VariablePayloadType>
+const VariablePayloadType& UArticyGlobalVariables::GetVariableValue(FArticyGvName& GvName, bool& bSucceeded)
+{
+	ArticyVariableType* typedPtr = GetVariableByIndex<ArticyVariableType>(GetVariableIndex(GvName));
+	if (!typedPtr)
+	{
+		//fall back to the lookup by name, which logs the failure
+		return GetVariableValue<ArticyVariableType, VariablePayloadType>(GvName.GetNamespace(), GvName.GetVariable(), bSucceeded);
+	}
+
+	bSucceeded = true;
+
+	if (bLogVariableAccess)
+	{
+		UE_LOG(LogArticyRuntime, Display, TEXT("Get variable %s : Success"), *typedPtr->GetGVName().ToString());
+	}
+
+	return typedPtr->Get();
+}
@@ -0,0 +1,131 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/IConsoleManager.h"
+
+class UArticyDatabase;
+
+/**
+ * @class FArticyGvProfiler
+ * @brief Counts the reads and writes of each global variable, e.g. to find the variables worth caching.
+ *
+ * Recording is off by default and enabled with the console variable Articy.ProfileGVs. The accesses are split by
+ * the live state and the shadow states of explorations, and attributed to the expresso script fragment running at
+ * the time of the access; accesses from Blueprints and C++ outside of the scripts are attributed to no fragment.
+ * Variables are identified by their name, so the accesses of all GV instances are summed up.
+ * Articy.DumpGVProfile writes the counts to a CSV file, and the editor shows them in the Articy GV Profiler tab.
+ */
+class ARTICYRUNTIME_API FArticyGvProfiler
+{
+public:
+
+	/** The accesses of a variable, by the live state and the shadow states. */
+	struct FAccessCounts
+	{
+		uint64 Reads = 0;
+		uint64 ShadowedReads = 0;
+		uint64 Writes = 0;
+		uint64 ShadowedWrites = 0;
+
+		uint64 GetTotal() const { return Reads + ShadowedReads + Writes + ShadowedWrites; }
+	};
+
+	/** The accesses of a variable from one script fragment, or from outside of the scripts. */
+	struct FRow
+	{
+		/** The name of the variable in the form Namespace.Variable. */
+		FName Variable;
+
+		/** Whether the accesses were made by a script fragment, and its hash and kind. */
+		bool bInScript = false;
+		int32 FragmentHash = 0;
+		bool bInstruction = false;
+
+		FAccessCounts Counts;
+	};
+
+	/**
+	 * @brief Attributes the accesses on this thread to a script fragment while it is evaluated or executed, if
+	 * profiling is enabled.
+	 */
+	class FFragmentScope
+	{
+	public:
+		FFragmentScope(int32 Hash, bool bInstruction);
+		~FFragmentScope();
+
+	private:
+		bool bActive;
+	};
+
+	/** @brief Returns true if the accesses are recorded. */
+	static bool IsEnabled() { return bEnabled; }
+
+	/**
+	 * @brief Counts a read of a variable.
+	 *
+	 * @param Variable The name of the variable.
+	 * @param bShadowed Whether the variable was read in a shadow state.
+	 */
+	static void RecordRead(const FName& Variable, bool bShadowed);
+
+	/**
+	 * @brief Counts a write of a variable.
+	 *
+	 * @param Variable The name of the variable.
+	 * @param bShadowed Whether the variable was written in a shadow state.
+	 */
+	static void RecordWrite(const FName& Variable, bool bShadowed);
+
+	/** @brief Discards all recorded counts. */
+	static void Reset();
+
+	/** @brief Returns the counts by variable and fragment, the most accessed first. */
+	static TArray<FRow> GetRows();
+
+	/**
+	 * @brief Writes the counts to a CSV file, with the text and owning object of each fragment.
+	 *
+	 * @param FilePath The file, relative paths are relative to Saved/Articy/Profiles.
+	 * @param Database The database to look up the fragments in, may be null.
+	 * @return True if the file was written.
+	 */
+	static bool WriteCsv(const FString& FilePath, const UArticyDatabase* Database);
+
+	/** @brief Returns the path of a profile file, relative paths are relative to Saved/Articy/Profiles. */
+	static FString GetProfilePath(const FString& FilePath);
+
+private:
+
+	/** The counts of one variable from one fragment. */
+	struct FFragmentCounts
+	{
+		bool bInstruction = false;
+		FAccessCounts Counts;
+	};
+
+	/** The counts of one variable, by fragment hash. */
+	struct FVariableCounts
+	{
+		TMap<int32, FFragmentCounts> Fragments;
+		FAccessCounts OutsideScripts;
+	};
+
+	/** Returns the counts of the current fragment of this thread for a variable. Requires VariablesLock. */
+	static FAccessCounts& FindOrAddCounts(const FName& Variable);
+
+	/** Set by the console variable Articy.ProfileGVs. */
+	static bool bEnabled;
+	static FAutoConsoleVariableRef CVarProfileGVs;
+
+	/** The counts by variable name. */
+	static TMap<FName, FVariableCounts> Variables;
+
+	/** Variables are accessed on worker threads during parallel flow exploration. */
+	static FCriticalSection VariablesLock;
+};
@@ -14,6 +14,10 @@
 #endif
 #include "Dom/JsonValue.h"
 #include "Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
 #include "ArticyTextExtension.h"
 #include "ArticyRuntimeModule.h"
 #include "ArticyLocalizerSystem.h"
@@ -114,6 +118,58 @@ namespace ArticyHelpers
 		return UTF8_TO_TCHAR(stream.str().c_str());
 	}
 
+	/** Formats an id with all 16 hex digits, the way the reports and the synthetic exports write them. */
+	inline FString Uint64ToPaddedHex(uint64 Id)
+	{
+		return FString::Printf(TEXT("0x%016llX"), Id);
+	}
+
+	/**
+	 * Clamps a parameter of a console command or commandlet to its range, and warns if it was out of it.
+	 * @param Context What the parameter is for in the warning, e.g. "Benchmark".
+	 */
+	inline int32 ClampParameter(const TCHAR* Context, const TCHAR* Name, int32 Value, int32 Min, int32 Max)
+	{
+		const int32 Clamped = FMath::Clamp(Value, Min, Max);
+		if (Clamped != Value)
+		{
+			UE_LOG(LogArticyRuntime, Warning, TEXT("%s parameter %s=%d is out of range, using %d."), Context, Name, Value, Clamped);
+		}
+		return Clamped;
+	}
+
+	/** Returns the path of a file in Saved/Articy of the project, in a subfolder if it is not empty. Absolute paths are kept. */
+	inline FString GetSavedPath(const TCHAR* Subfolder, const FString& Filename)
+	{
+		if (!FPaths::IsRelative(Filename))
+			return Filename;
+
+		const FString Directory = FPaths::ProjectSavedDir() / TEXT("Articy");
+		return (*Subfolder ? Directory / Subfolder : Directory) / Filename;
+	}
+
+	/**
+	 * Writes a report, e.g. the results of a benchmark, and warns if the file cannot be written.
+	 * @param Description What the file holds in the warning, e.g. "benchmark results".
+	 */
+	inline bool SaveReport(const FString& Contents, const FString& Path, const TCHAR* Description)
+	{
+		if (FFileHelper::SaveStringToFile(Contents, *Path))
+			return true;
+
+		UE_LOG(LogArticyRuntime, Warning, TEXT("Could not write the %s to '%s'."), Description, *Path);
+		return false;
+	}
+
+	/** Writes a report as json, see SaveReport. */
+	inline bool SaveJsonReport(const TSharedRef<FJsonObject>& Json, const FString& Path, const TCHAR* Description)
+	{
+		FString Contents;
+		const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Contents);
+		FJsonSerializer::Serialize(Json, Writer);
+		return SaveReport(Contents, Path, Description);
+	}
+
 	inline FVector2D ParseFVector2DFromJson(const TSharedPtr<FJsonValue> Json)
 	{
 		if(!Json.IsValid() || !ensure(Json->Type == EJson::Object))
@@ -181,6 +237,12 @@ namespace ArticyHelpers
 		return ArticyLocalizerSystem->LocalizeString(Outer, Key, ResolveTextExtension, BackupText);
 	}
 
+	inline TArray<FText> LocalizeMany(UObject* Outer, const TArray<FText>& Keys, bool ResolveTextExtension = true)
+	{
+		UArticyLocalizerSystem* ArticyLocalizerSystem = UArticyLocalizerSystem::Get();
+		return ArticyLocalizerSystem->LocalizeMany(Outer, Keys, ResolveTextExtension);
+	}
+
 }
 
 
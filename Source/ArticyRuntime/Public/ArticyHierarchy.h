@@ -0,0 +1,84 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+#include "ArticyHierarchy.generated.h"
+
+/**
+ * The project hierarchy of all imported objects, flattened into a depth-first order by the import.
+ * The subtree of a node is the contiguous range from its index to its subtree end, so the descendants of an object
+ * are a view into the order, and whether an object is a descendant of another takes two lookups.
+ * Covers the objects of all packages, whether they are loaded or not.
+ */
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyHierarchy
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns true if the hierarchy was not imported, e.g. by databases generated before it was stored. */
+	bool IsEmpty() const { return Nodes.Num() == 0; }
+
+	/** Returns the number of nodes. */
+	int32 Num() const { return Nodes.Num(); }
+
+	/** Returns the index of an object in the depth-first order, or INDEX_NONE if it is not in the hierarchy. */
+	int32 Find(const FArticyId& Id) const
+	{
+		const int32* Index = NodeIndices.Find(Id);
+		return Index ? *Index : INDEX_NONE;
+	}
+
+	/** Returns the object at an index of the depth-first order. */
+	const FArticyId& GetNode(int32 Index) const { return Nodes[Index]; }
+
+	/** Returns the end of the subtree of the node at an index, the index after its last descendant. */
+	int32 GetSubtreeEnd(int32 Index) const { return SubtreeEnds[Index]; }
+
+	/** Returns the descendants of an object in depth-first order, without the object itself. */
+	TConstArrayView<FArticyId> GetDescendants(const FArticyId& Id) const
+	{
+		const int32 Index = Find(Id);
+		return Index == INDEX_NONE ? TConstArrayView<FArticyId>() : TConstArrayView<FArticyId>(Nodes.GetData() + Index + 1, SubtreeEnds[Index] - Index - 1);
+	}
+
+	/** Returns true if an object is a descendant (not only a child) of another. An object is no descendant of itself. */
+	bool IsDescendantOf(const FArticyId& Id, const FArticyId& Ancestor) const
+	{
+		const int32 AncestorIndex = Find(Ancestor);
+		const int32 Index = AncestorIndex == INDEX_NONE ? INDEX_NONE : Find(Id);
+		return Index != INDEX_NONE && AncestorIndex < Index && Index < SubtreeEnds[AncestorIndex];
+	}
+
+	//========================================//
+
+	/** Removes all nodes, before the import adds them again. */
+	void Reset();
+
+	/**
+	 * Adds a node in depth-first order; its descendants are added after it, followed by EndNode.
+	 * @param Id The object of the node.
+	 * @return The index of the node, to pass to EndNode.
+	 */
+	int32 BeginNode(const FArticyId& Id);
+
+	/** Ends the subtree of a node after all its descendants were added. */
+	void EndNode(int32 Index) { SubtreeEnds[Index] = Nodes.Num(); }
+
+private:
+
+	/** The objects in depth-first order, and the end of the subtree of each. */
+	UPROPERTY()
+	TArray<FArticyId> Nodes;
+	UPROPERTY()
+	TArray<int32> SubtreeEnds;
+
+	/** The index of each object in Nodes. */
+	UPROPERTY()
+	TMap<FArticyId, int32> NodeIndices;
+};
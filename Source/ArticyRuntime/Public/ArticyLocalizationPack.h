@@ -0,0 +1,232 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Templates/UniquePtr.h"
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * The binary layout of a localization pack, shared by the importer (which writes the packs) and the runtime.
+ *
+ * A pack holds all string tables of one culture. It starts with a header and the table directory, followed by one
+ * section per table. A section is an open-addressed (linear probing) hash table of the keys of the table, followed
+ * by the UTF-16 keys and texts it points to. Identical texts of a table are stored once and shared by their buckets,
+ * so a text must not be assumed to follow its key. All values are little endian.
+ *
+ * Since version 2, the texts of a pack with the CompressedTexts flag are stored in zlib compressed blocks, see
+ * FCompressedSection; the keys stay uncompressed, so only the block of the text that is found is decompressed.
+ * Since version 3, packs with the TokensMarked flag flag the texts with tokens or placeholders in their buckets.
+ */
+namespace ArticyLocalizationPackFormat
+{
+	/** "ALTP" */
+	constexpr uint32 Magic = 0x50544C41;
+	constexpr uint32 Version = 3;
+
+	/** The alignment of the table sections in the file. */
+	constexpr uint32 SectionAlignment = 16;
+
+	/** The flags of the header, always 0 in version 1. */
+	enum EFlags : uint32
+	{
+		/** The sections start with an FCompressedSection and store their texts in compressed blocks. */
+		CompressedTexts = 1,
+		/** The text lengths of the buckets have TextHasTokens set for texts with tokens, see FArticyTextTemplate::HasTokens. */
+		TokensMarked = 2,
+	};
+
+	/** The bit of FBucket::TextLength which flags a text with tokens in packs with the TokensMarked flag. */
+	constexpr uint32 TextHasTokens = 1u << 31;
+
+	/** The number of UTF-16 code units of the texts a compressed block holds at most, unless a single text is longer. */
+	constexpr uint32 TextBlockChars = 4096;
+
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 NumTables;
+		uint32 Flags;
+	};
+
+	/** A table in the directory, the directory directly follows the header. */
+	struct FTable
+	{
+		uint32 NameHash;
+		uint32 NameLength;
+		/** The offset of the UTF-16 name, from the start of the file. */
+		uint64 NameOffset;
+		/** The number of buckets of the key index, a power of two. */
+		uint32 NumBuckets;
+		uint32 NumEntries;
+		/** The offset of the section, from the start of the file. */
+		uint64 SectionOffset;
+		uint64 SectionSize;
+	};
+
+	/** A bucket of the key index of a section. Empty buckets have a key length of 0. */
+	struct FBucket
+	{
+		uint32 KeyHash;
+		uint32 KeyLength;
+		/** The offsets of the key and text, in UTF-16 code units from the end of the buckets. */
+		uint32 KeyOffset;
+		uint32 TextOffset;
+		uint32 TextLength;
+	};
+
+	/**
+	 * The start of a section of a pack with compressed texts. It is followed by the buckets, the UTF-16 keys, the blocks
+	 * (aligned to 4 bytes) and their compressed data. The key offsets of the buckets are in code units from the end of
+	 * the buckets, the text offsets in code units of the decompressed texts of the table. No text spans two blocks.
+	 */
+	struct FCompressedSection
+	{
+		uint32 NumKeyChars;
+		uint32 NumBlocks;
+		uint32 NumTextChars;
+		uint32 Reserved;
+	};
+
+	/** A compressed block of the texts of a section, the blocks are sorted by their first code unit. */
+	struct FBlock
+	{
+		/** The first code unit of the block in the decompressed texts, and the number of code units. */
+		uint32 FirstChar;
+		uint32 NumChars;
+		/** The offset of the compressed data from the start of the section, and its size in bytes. */
+		uint32 DataOffset;
+		uint32 DataSize;
+	};
+
+	static_assert(sizeof(FHeader) == 16 && sizeof(FTable) == 40 && sizeof(FBucket) == 20, "The localization pack layout must not depend on the compiler.");
+	static_assert(sizeof(FCompressedSection) == 16 && sizeof(FBlock) == 16, "The localization pack layout must not depend on the compiler.");
+
+	/** Hashes a key or table name (FNV-1a over the UTF-16 code units), the hash is part of the file format. */
+	inline uint32 Hash(const TCHAR* Chars, int32 Length)
+	{
+		uint32 Result = 2166136261u;
+		for (int32 Index = 0; Index < Length; ++Index)
+		{
+			Result = (Result ^ static_cast<uint16>(Chars[Index])) * 16777619u;
+		}
+		return Result;
+	}
+
+	/**
+	 * Returns the path of the pack of a culture, relative to the project content directory.
+	 * The packs live next to the generated string tables, so they are staged with them.
+	 */
+	inline FString GetRelativePath(const FString& Culture)
+	{
+		return FString(TEXT("ArticyContent/Generated/Localization")) / Culture + TEXT(".artloc");
+	}
+}
+
+/**
+ * @class FArticyLocalizationPack
+ * @brief A read-only binary localization pack of one culture, see ArticyLocalizationPackFormat.
+ *
+ * Only the header and the table directory are read when the pack is opened. The section of a table is paged in
+ * the first time one of its keys is looked up: as a mapped region if the platform can map the file, otherwise by
+ * reading the section. The texts are used directly from the mapped (or read) memory, or, if the pack compresses
+ * its texts, from the blocks decompressed into a small cache of the most recently used ones (see
+ * UArticyPluginSettings::LocalizationPackCachedBlocks), so the memory of the texts scales with the texts shown.
+ */
+class ARTICYRUNTIME_API FArticyLocalizationPack
+{
+public:
+
+	~FArticyLocalizationPack();
+
+	/**
+	 * Opens the pack of a culture.
+	 * @param Culture The culture name, as used by the importer (e.g. "en" or "pt-BR").
+	 * @return The pack, or null if there is no valid pack for the culture.
+	 */
+	static TSharedPtr<FArticyLocalizationPack> Open(const FString& Culture);
+
+	/** @brief Returns the culture of the pack. */
+	const FString& GetCulture() const { return Culture; }
+
+	/**
+	 * Looks up a text.
+	 * @param TableName The string table of the key.
+	 * @param Key The key of the text.
+	 * @param OutText Receives the text, if the key is found.
+	 * @return True if the key is in the pack.
+	 */
+	bool Find(const FString& TableName, const FString& Key, FString& OutText) const;
+
+	/**
+	 * Looks up a text, and whether it has tokens that need to be resolved.
+	 * @param TableName The string table of the key.
+	 * @param Key The key of the text.
+	 * @param OutText Receives the text, if the key is found.
+	 * @param bOutHasTokens Receives false if the text is known to have no tokens, true for the texts of older packs.
+	 * @return True if the key is in the pack.
+	 */
+	bool Find(const FString& TableName, const FString& Key, FString& OutText, bool& bOutHasTokens) const;
+
+	/** Returns the memory allocated by the pack, the mapped sections are not counted as they are paged by the OS. */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+
+	/** A table of the directory, with its section once it is paged in. */
+	struct FTableSlot
+	{
+		ArticyLocalizationPackFormat::FTable Table;
+		FString Name;
+		const uint8* Section = nullptr;
+		IMappedFileRegion* Region = nullptr;
+		TArray<uint8> Data;
+		bool bPagingFailed = false;
+	};
+
+	FArticyLocalizationPack();
+
+	/** A decompressed block of texts. */
+	struct FCachedBlock
+	{
+		int32 TableIndex = INDEX_NONE;
+		int32 BlockIndex = INDEX_NONE;
+		TArray<TCHAR> Chars;
+	};
+
+	/** Returns the section of a table, paging it in if needed, or null if it cannot be read. */
+	const uint8* GetSection(FTableSlot& Slot) const;
+
+	/** Copies a text of a section with compressed texts, decompressing its block unless it is cached. */
+	bool ReadCompressedText(int32 TableIndex, const uint8* Section, const ArticyLocalizationPackFormat::FBucket& Bucket, FString& OutText) const;
+
+	FString Culture;
+	int64 FileSize = 0;
+
+	/** Whether the texts are compressed, see ArticyLocalizationPackFormat::CompressedTexts. */
+	bool bCompressedTexts = false;
+
+	/** Whether the buckets flag the texts with tokens, see ArticyLocalizationPackFormat::TokensMarked. */
+	bool bTokensMarked = false;
+
+	/** The decompressed blocks, the most recently used last, and the maximum number of them. Guarded by PagingLock. */
+	mutable TArray<FCachedBlock> BlockCache;
+	int32 MaxCachedBlocks = 1;
+
+	/** The mapped file, or the open file if the platform cannot map it. */
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IFileHandle> File;
+
+	/** The slots are filled once on open, only their sections are paged in later. */
+	mutable TArray<FTableSlot> Tables;
+
+	/** Lookups may happen from worker threads, e.g. when texts are resolved in parallel. */
+	mutable FCriticalSection PagingLock;
+};
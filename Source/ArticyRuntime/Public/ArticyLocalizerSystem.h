@@ -6,6 +6,8 @@
 
 #include "CoreMinimal.h"
 #include "ArticyType.h"
+#include "ArticyLocalizationPack.h"
+#include "ArticyPluginSettings.h"
 #include "ArticyTextExtension.h"
 #include "Internationalization/StringTableRegistry.h"
 #include "UObject/UObjectIterator.h"
@@ -27,80 +29,324 @@ public:
 			return ArticyLocalizerSystem.Get();
 		}
 
-		UClass* ParentClass = UArticyLocalizerSystem::StaticClass();
-
-		// Iterate over all classes
-		for (TObjectIterator<UClass> It; It; ++It)
+		// The generated subclass is found once, the system itself is recreated after it got garbage collected
+		static TWeakObjectPtr<UClass> GeneratedClass;
+		if (!GeneratedClass.IsValid() || GeneratedClass->HasAnyClassFlags(CLASS_NewerVersionExists))
 		{
-			UClass* Class = *It;
-			// Check if the class is derived from the parent class
-			if (Class->IsChildOf(ParentClass) && Class != ParentClass)
-			{
-				// Create an instance of the found subclass
-				UArticyLocalizerSystem* NewLocalizerSystem = NewObject<UArticyLocalizerSystem>(GetTransientPackage(), Class);
-
-				// Assign the instance to the TWeakObjectPtr
-				ArticyLocalizerSystem = NewLocalizerSystem;
-
-				return ArticyLocalizerSystem.Get();
-			}
+			GeneratedClass = UArticyPluginSettings::FindGeneratedClass(UArticyPluginSettings::Get()->LocalizerSystemClassPath, UArticyLocalizerSystem::StaticClass());
 		}
 
 		// Handle case where no subclass is found
-		return nullptr;
+		if (!GeneratedClass.IsValid())
+		{
+			return nullptr;
+		}
+
+		// Create an instance of the found subclass
+		ArticyLocalizerSystem = NewObject<UArticyLocalizerSystem>(GetTransientPackage(), GeneratedClass.Get());
+		return ArticyLocalizerSystem.Get();
 	}
 
 	virtual void Reload() {};
 
 	inline FText ResolveText(UObject* Outer, const FText* SourceText)
 	{
-		return UArticyTextExtension::Get()->Resolve(Outer, SourceText);
+		return UArticyTextExtension::Get()->ResolveCached(Outer, SourceText);
 	}
 
 	inline FText LocalizeString(UObject* Outer, const FText& Key, bool ResolveTextExtension = true, const FText* BackupText = nullptr)
 	{
+		if (UsesKeysOnly())
+		{
+			return Key;
+		}
+
 		if (!bDataLoaded)
 		{
 			Reload();
 		}
 
-		const FText MissingEntry = FText::FromString("<MISSING STRING TABLE ENTRY>");
+		const FString TableName = GetTableName(Key);
+		bool bTableMarksTokens = false;
+		const FStringTableConstPtr TablePtr = LocalizationPack.IsValid() ? nullptr : FindStringTable(TableName, bTableMarksTokens);
+		return LocalizeFromTable(Outer, Key, TableName, TablePtr.Get(), bTableMarksTokens, ResolveTextExtension, BackupText);
+	}
+
+	/**
+	 * Looks up the source string of a key, in the localization pack if one is in use or in its string table.
+	 * @param TableName The string table of the key.
+	 * @param Key The key to look up.
+	 * @param OutSourceString Receives the source string, if the key is found.
+	 * @return True if the key is found.
+	 */
+	inline bool FindSourceString(const FString& TableName, const FString& Key, FString& OutSourceString)
+	{
+		if (UsesKeysOnly())
+		{
+			return false;
+		}
+
+		if (!bDataLoaded)
+		{
+			Reload();
+		}
+
+		if (LocalizationPack.IsValid())
+		{
+			return LocalizationPack->Find(TableName, Key, OutSourceString);
+		}
+
+		bool bTableMarksTokens;
+		const FStringTableConstPtr TablePtr = FindStringTable(TableName, bTableMarksTokens);
+		const FStringTableEntryConstPtr EntryPtr = TablePtr.IsValid() ? TablePtr->FindEntry(FTextKey(Key)) : nullptr;
+		if (!EntryPtr.IsValid())
+		{
+			return false;
+		}
+
+		OutSourceString = EntryPtr->GetSourceString();
+		return true;
+	}
+
+	/**
+	 * Localizes many keys at once, e.g. for list UIs. Consecutive keys of the same string table share one table lookup.
+	 * @param Outer The world context to resolve the texts in.
+	 * @param Keys The keys to localize.
+	 * @param ResolveTextExtension Whether to resolve the text extension tokens of the localized texts.
+	 * @return The localized texts, in the order of the keys.
+	 */
+	inline TArray<FText> LocalizeMany(UObject* Outer, const TArray<FText>& Keys, bool ResolveTextExtension = true)
+	{
+		if (UsesKeysOnly())
+		{
+			return Keys;
+		}
+
+		if (!bDataLoaded)
+		{
+			Reload();
+		}
+
+		TArray<FText> Results;
+		Results.Reserve(Keys.Num());
+
+		FString TableName;
+		FStringTableConstPtr TablePtr;
+		bool bTableMarksTokens = false;
+		for (int32 Index = 0; Index < Keys.Num(); ++Index)
+		{
+			FString KeyTableName = GetTableName(Keys[Index]);
+			if (Index == 0 || !KeyTableName.Equals(TableName, ESearchCase::CaseSensitive))
+			{
+				TableName = MoveTemp(KeyTableName);
+				TablePtr = LocalizationPack.IsValid() ? nullptr : FindStringTable(TableName, bTableMarksTokens);
+			}
+
+			Results.Add(LocalizeFromTable(Outer, Keys[Index], TableName, TablePtr.Get(), bTableMarksTokens, ResolveTextExtension, nullptr));
+		}
+
+		return Results;
+	}
+
+	/**
+	 * Registers the string table of a package when a database loads it, so its texts don't load the table on first use.
+	 * Nothing is registered if a localization pack is in use.
+	 * @param PackageName The name of the package.
+	 */
+	void OnPackageLoaded(const FString& PackageName);
+
+	/**
+	 * Unregisters the string table of a package once no database has it loaded anymore.
+	 * A text of the package which is localized afterwards registers the table again.
+	 * @param PackageName The name of the package.
+	 */
+	void OnPackageUnloaded(const FString& PackageName);
+
+protected:
+	bool bDataLoaded = false;
+	bool bListenerSet = false;
+
+	/**
+	 * Switches to the localization pack of the current culture, if localization packs are enabled.
+	 * Called by the generated Reload, which only registers the CSV string tables if no pack is found.
+	 * @param LocaleName The name of the current culture (e.g. "pt-BR").
+	 * @param LangName The two letter language of the current culture, the fallback if there is no pack of the locale.
+	 * @return True if a pack is in use.
+	 */
+	bool LoadLocalizationPack(const FString& LocaleName, const FString& LangName)
+	{
+		if (!UArticyPluginSettings::Get()->bUseLocalizationPacks)
+		{
+			LocalizationPack.Reset();
+			return false;
+		}
+
+		// Switching the culture just opens another pack, the previous one is unmapped once it is released
+		for (const FString& Culture : { LocaleName, LangName })
+		{
+			if (LocalizationPack.IsValid() && LocalizationPack->GetCulture().Equals(Culture, ESearchCase::IgnoreCase))
+			{
+				return true;
+			}
+
+			if (TSharedPtr<FArticyLocalizationPack> Pack = FArticyLocalizationPack::Open(Culture))
+			{
+				LocalizationPack = MoveTemp(Pack);
+				return true;
+			}
+		}
+
+		LocalizationPack.Reset();
+		return false;
+	}
+
+	/**
+	 * Returns true if the texts are not localized, as dedicated servers don't load the string tables or localization
+	 * packs when their cook strips the presentation data (see UArticyPluginSettings::bStripPresentationForServer).
+	 */
+	static bool UsesKeysOnly()
+	{
+		return IsRunningDedicatedServer() && UArticyPluginSettings::Get()->bStripPresentationForServer;
+	}
+
+	/**
+	 * Removes the string table files, called by the generated Reload before it adds them again, so a reimport
+	 * refreshes them. In the editor, the warm tables whose files changed since they were loaded are released too.
+	 */
+	void ResetStringTableFiles();
+
+	/**
+	 * Adds a generated string table file, called by the generated Reload.
+	 * @param Culture The culture of the file, empty for the default tables which are used when a culture has no table of that name.
+	 * @param TableName The name of the string table.
+	 * @param RelativePath The path of the CSV file, relative to the project content directory.
+	 * @param bMarksTokens Whether the file has the Tokens metadata column, see FArticyTextTemplate::TokensMetaData.
+	 */
+	void AddStringTableFile(const FString& Culture, const FString& TableName, const FString& RelativePath, bool bMarksTokens = false);
 
-		// Default to key
-		FText SourceString = Key;
+	/**
+	 * Switches the registered string tables to a culture.
+	 *
+	 * ARTICY and the tables which were in use before are registered right away, the others when they are first
+	 * looked up, so only the tables of loaded packages get loaded. The tables of the previous culture are kept,
+	 * switching back to it registers them without parsing their files again.
+	 * The time of the switch is reported with the "Localization culture switch" stats.
+	 * @param LocaleName The name of the current culture (e.g. "pt-BR").
+	 * @param LangName The two letter language of the current culture, used if there are no tables of the locale.
+	 */
+	void SwitchCulture(const FString& LocaleName, const FString& LangName);
 
-		// Look up entry in specified string table
+	/**
+	 * Returns the memory of the loaded string tables of the active and the previous culture, see FArticyMemoryReport.
+	 * @param OutNumTables Receives the number of loaded tables.
+	 * @return The size of the keys and source strings of the tables.
+	 */
+	SIZE_T GetStringTablesAllocatedSize(int32& OutNumTables) const;
+
+	/** Returns the memory allocated by the localization pack of the current culture, if one is in use. */
+	SIZE_T GetLocalizationPackAllocatedSize() const { return LocalizationPack.IsValid() ? LocalizationPack->GetAllocatedSize() : 0; }
+
+private:
+	/** Returns the name of the string table of a key, its namespace or ARTICY. */
+	static FString GetTableName(const FText& Key)
+	{
 		TOptional<FString> TableName = FTextInspector::GetNamespace(Key);
-		if (!TableName.IsSet())
+		return TableName.IsSet() ? MoveTemp(TableName.GetValue()) : FString(TEXT("ARTICY"));
+	}
+
+	/** A string table found by FindStringTable. */
+	struct FCachedStringTable
+	{
+		TWeakPtr<const FStringTable, ESPMode::ThreadSafe> Table;
+		/** Whether the table was loaded from a file with the Tokens metadata column. */
+		bool bMarksTokens = false;
+	};
+
+	/**
+	 * Finds a string table, the tables are cached by name until they get unregistered.
+	 * @param TableName The name of the table.
+	 * @param bOutMarksTokens Receives whether the entries of the table flag their tokens, see FArticyTextTemplate::TokensMetaData.
+	 * @return The table, or null if there is none.
+	 */
+	FStringTableConstPtr FindStringTable(const FString& TableName, bool& bOutMarksTokens)
+	{
+		if (const FCachedStringTable* Cached = StringTables.Find(TableName))
 		{
-			TableName = TEXT("ARTICY");
+			if (FStringTableConstPtr TablePtr = Cached->Table.Pin())
+			{
+				bOutMarksTokens = Cached->bMarksTokens;
+				return TablePtr;
+			}
 		}
 
-		// Find the table
-		FStringTableConstPtr TablePtr = FStringTableRegistry::Get().FindStringTable(FName(TableName.GetValue()));
+		FStringTableConstPtr TablePtr = FStringTableRegistry::Get().FindStringTable(FName(TableName));
+		if (!TablePtr.IsValid())
+		{
+			TablePtr = RegisterStringTable(TableName);
+		}
+
+		// Tables which are not registered from a generated file (e.g. by the game) are resolved like before
+		bOutMarksTokens = TablePtr.IsValid() && RegisteredTables.Contains(TableName) && MarksTokens(TableName);
 		if (TablePtr.IsValid())
 		{
-			// Find the entry
-			const FStringTable* Table = TablePtr.Get();
-			FStringTableEntryConstPtr EntryPtr = Table->FindEntry(FTextKey(Key.ToString()));
+			StringTables.Add(TableName, { TablePtr, bOutMarksTokens });
+		}
+		return TablePtr;
+	}
+
+	/** Returns true if the file of a table of the active culture has the Tokens metadata column. */
+	bool MarksTokens(const FString& TableName) const
+	{
+		const FString* File = ActiveTableFiles.Find(TableName);
+		return File && TokenMarkedFiles.Contains(*File);
+	}
+
+	/**
+	 * Localizes a key with the localization pack if one is in use, otherwise with its string table, which may be null.
+	 * Texts the importer did not flag as having tokens are returned without resolving them.
+	 */
+	FText LocalizeFromTable(UObject* Outer, const FText& Key, const FString& TableName, const FStringTable* Table, bool bTableMarksTokens, bool ResolveTextExtension, const FText* BackupText)
+	{
+		static const FString MissingEntry = TEXT("<MISSING STRING TABLE ENTRY>");
+		static const FName TokensMetaDataId(FArticyTextTemplate::TokensMetaData);
+
+		const FString& KeyString = Key.ToString();
+
+		// Find the entry
+		FString PackString;
+		FStringTableEntryConstPtr EntryPtr;
+		const FString* SourceString = nullptr;
+		bool bHasTokens = true;
+		if (LocalizationPack.IsValid())
+		{
+			if (LocalizationPack->Find(TableName, KeyString, PackString, bHasTokens))
+			{
+				SourceString = &PackString;
+			}
+		}
+		else if (Table)
+		{
+			const FTextKey EntryKey(KeyString);
+			EntryPtr = Table->FindEntry(EntryKey);
 			if (EntryPtr.IsValid())
 			{
-				const FStringTableEntry* TableEntry = EntryPtr.Get();
-				SourceString = FText::FromString(TableEntry->GetSourceString());
+				SourceString = &EntryPtr->GetSourceString();
+				bHasTokens = !bTableMarksTokens || !Table->GetMetaData(EntryKey, TokensMetaDataId).IsEmpty();
 			}
 		}
 
-		if (!SourceString.IsEmpty() && !SourceString.EqualTo(MissingEntry) && !SourceString.EqualTo(Key))
+		if (SourceString && !SourceString->IsEmpty() && !SourceString->Equals(MissingEntry, ESearchCase::CaseSensitive) && !SourceString->Equals(KeyString, ESearchCase::CaseSensitive))
 		{
-			if (ResolveTextExtension)
+			const FText SourceText = FText::FromString(*SourceString);
+			if (ResolveTextExtension && bHasTokens)
 			{
-				return ResolveText(Outer, &SourceString);
+				return ResolveText(Outer, &SourceText);
 			}
-			return FText(SourceString);
+			return SourceText;
 		}
 
 		// By default, return via the key
-		if (ResolveTextExtension && !Key.ToString().EndsWith(".PreviewText"))
+		if (ResolveTextExtension && !KeyString.EndsWith(".PreviewText"))
 		{
 			return ResolveText(Outer, &Key);
 		}
@@ -114,7 +360,45 @@ public:
 		return Key;
 	}
 
-protected:
-	bool bDataLoaded = false;
-	bool bListenerSet = false;
+	/** The string tables by name, see FindStringTable. */
+	TMap<FString, FCachedStringTable> StringTables;
+
+	/** The localization pack of the current culture, see LoadLocalizationPack. */
+	TSharedPtr<FArticyLocalizationPack> LocalizationPack;
+
+	/** Registers a string table of the active culture, loading it unless it is still warm. Returns null if the culture has no such table. */
+	FStringTableConstPtr RegisterStringTable(const FString& TableName);
+
+	/** Unregisters a string table and releases it, see OnPackageUnloaded. */
+	void UnregisterStringTable(const FString& TableName);
+
+	/** Returns the name of the string table of a package, see StringTableGenerator. */
+	static FString GetPackageTableName(const FString& PackageName) { return PackageName.Replace(TEXT(" "), TEXT("_")); }
+
+	/** The number of databases which have loaded the package of each table, by table name. */
+	TMap<FString, int32> LoadedPackageTables;
+
+	/** The generated string table files, by culture and table name, see AddStringTableFile. */
+	TMap<FString, TMap<FString, FString>> StringTableFiles;
+
+	/** The string table files of the active culture, by table name. */
+	TMap<FString, FString> ActiveTableFiles;
+
+	/** The files with the Tokens metadata column, see AddStringTableFile. */
+	TSet<FString> TokenMarkedFiles;
+
+	/** The culture whose tables are registered, and the one before it. */
+	TOptional<FString> ActiveCulture;
+	TOptional<FString> PreviousCulture;
+
+	/** The names of the tables registered by SwitchCulture and RegisterStringTable. */
+	TSet<FString> RegisteredTables;
+
+	/** The loaded tables of the active and previous culture, by file path. */
+	TMap<FString, FStringTablePtr> WarmTables;
+
+#if WITH_EDITOR
+	/** The time stamps of the files of the warm tables when they were loaded, to release them once reimported. */
+	TMap<FString, FDateTime> WarmTableTimestamps;
+#endif
 };
@@ -0,0 +1,110 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+
+class UArticyDatabase;
+class UArticyObject;
+
+/**
+ * @class FArticyLocationIndex
+ * @brief A spatial index of the zones and spots of a location, for point-in-zone and nearest-spot queries.
+ *
+ * The zones (objects with vertices deriving from UArticyZone) and spots (objects with a position deriving from
+ * UArticySpot) below the location are sorted into a uniform grid over their bounds, so a query only tests the few
+ * zones whose bounds overlap the cell of the point instead of every polygon of the location. Coordinates are the ones
+ * of GetVertices and GetPosition.
+ *
+ * The database builds the index on first use and rebuilds it after packages were loaded or unloaded, see
+ * UArticyDatabase::GetLocationIndex. Vertices or positions changed at runtime are picked up by InvalidateLocationIndices.
+ */
+class ARTICYRUNTIME_API FArticyLocationIndex
+{
+public:
+
+	/**
+	 * Builds the index of the loaded zones and spots below a location.
+	 * @param Database The database the location is loaded into.
+	 * @param LocationId The id of the location.
+	 */
+	FArticyLocationIndex(const UArticyDatabase* Database, const FArticyId& LocationId);
+
+	/** Returns the zone containing a point, the one with the highest z-index (then the smallest one) if several do. */
+	UArticyObject* FindZoneAt(const FVector2D& Point) const;
+
+	/**
+	 * Adds all zones containing a point to OutZones, ordered by z-index from highest to lowest.
+	 * @return The number of zones added.
+	 */
+	int32 FindZonesAt(const FVector2D& Point, TArray<UArticyObject*>& OutZones) const;
+
+	/**
+	 * Returns the spot closest to a point.
+	 * @param Point The point.
+	 * @param MaxDistance Spots further away are ignored, 0 for no limit.
+	 * @return The spot, or nullptr if there is none within MaxDistance.
+	 */
+	UArticyObject* FindNearestSpot(const FVector2D& Point, float MaxDistance = 0.f) const;
+
+	int32 GetNumZones() const { return Zones.Num(); }
+	int32 GetNumSpots() const { return Spots.Num(); }
+
+private:
+
+	struct FZone
+	{
+		UArticyObject* Object = nullptr;
+		FBox2D Bounds;
+		float ZIndex = 0.f;
+		float Area = 0.f;
+		/** The range of the vertices of the zone in Vertices. */
+		int32 FirstVertex = 0;
+		int32 NumVertices = 0;
+	};
+
+	struct FSpot
+	{
+		UArticyObject* Object = nullptr;
+		FVector2D Position;
+	};
+
+	/** A uniform grid over the bounds, with the items overlapping each cell stored contiguously. */
+	struct FGrid
+	{
+		FBox2D Bounds = FBox2D(ForceInit);
+		FVector2D CellSize = FVector2D::UnitVector;
+		int32 NumX = 0;
+		int32 NumY = 0;
+
+		/** The items of cell i are Items[CellStarts[i]] to Items[CellStarts[i + 1]]. */
+		TArray<int32> CellStarts;
+		TArray<int32> Items;
+
+		/** Builds the grid from the bounds of the items, with roughly one item per cell. */
+		void Build(const TArray<FBox2D>& ItemBounds);
+
+		/** Returns the cell coordinates of a point, clamped to the grid. */
+		FIntPoint GetCell(const FVector2D& Point) const;
+
+		/** Returns the items of a cell. */
+		TConstArrayView<int32> GetItems(int32 X, int32 Y) const
+		{
+			const int32 Cell = Y * NumX + X;
+			return TConstArrayView<int32>(Items.GetData() + CellStarts[Cell], CellStarts[Cell + 1] - CellStarts[Cell]);
+		}
+	};
+
+	TArray<FZone> Zones;
+	TArray<FVector2D> Vertices;
+	FGrid ZoneGrid;
+
+	TArray<FSpot> Spots;
+	FGrid SpotGrid;
+
+	/** Returns true if a point is inside of a zone (even-odd rule). */
+	bool Contains(const FZone& Zone, const FVector2D& Point) const;
+};
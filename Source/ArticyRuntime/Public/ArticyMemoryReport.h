@@ -0,0 +1,88 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "UObject/UnrealType.h"
+
+/**
+ * @class FArticyMemoryReport
+ * @brief The memory used by the articy data, by category, as logged by Articy.MemReport and shown by "stat Articy".
+ *
+ * The sizes are estimates: objects are measured with FArchiveCountMem like "obj list" does, structs by walking their
+ * reflected properties, and native containers by their allocated size. Objects referenced by properties are not
+ * followed, each category measures its own objects.
+ */
+class ARTICYRUNTIME_API FArticyMemoryReport
+{
+public:
+
+	/** The memory of one category. */
+	struct FEntry
+	{
+		FString Category;
+
+		/** The number of items of the category, e.g. objects or tables. */
+		int32 Count = 0;
+		SIZE_T Bytes = 0;
+	};
+
+	/** Executed by Collect, so the editor can add the import data, which the runtime does not know about. */
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnCollect, FArticyMemoryReport&);
+	static FOnCollect OnCollect;
+
+	/**
+	 * Measures the memory of the loaded articy data: the generated packages, the database clones and their shadow
+	 * copies, the global variables and the string tables, and whatever the OnCollect listeners add.
+	 * Also updates the memory stats of the Articy stats group.
+	 */
+	static FArticyMemoryReport Collect();
+
+	/** Adds a category, or adds to it if it was added before. */
+	void Add(const FString& Category, int32 Count, SIZE_T Bytes);
+
+	const TArray<FEntry>& GetEntries() const { return Entries; }
+	SIZE_T GetTotalBytes() const;
+
+	/** Logs the categories, largest first. */
+	void Log(FOutputDevice& Ar) const;
+
+	/**
+	 * Measures an object like "obj list" does: its native size and what its serialized properties allocate.
+	 * @param Object The object, may be null.
+	 * @return The estimated size in bytes.
+	 */
+	static SIZE_T GetObjectSize(const UObject* Object);
+
+	/**
+	 * Measures the memory allocated by the reflected properties of a struct or object, excluding its own size.
+	 * @param Struct The type of the data.
+	 * @param Data The struct or object.
+	 * @return The estimated size in bytes.
+	 */
+	static SIZE_T GetAllocatedSize(const UStruct* Struct, const void* Data);
+
+	/**
+	 * Measures the memory allocated by a property value, excluding the size of the value itself.
+	 * @param Property The property.
+	 * @param Value The value of the property.
+	 * @return The estimated size in bytes.
+	 */
+	static SIZE_T GetAllocatedSize(const FProperty* Property, const void* Value);
+
+	/**
+	 * Updates the memory stats of the Articy stats group once a second while stats are collected.
+	 * Called by the runtime module.
+	 */
+	static void StartStatsUpdates();
+	static void StopStatsUpdates();
+
+private:
+
+	TArray<FEntry> Entries;
+
+	static FTSTicker::FDelegateHandle StatsTickerHandle;
+};
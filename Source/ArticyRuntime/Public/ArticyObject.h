@@ -11,6 +11,40 @@
 #include "Dom/JsonValue.h"
 #include "ArticyObject.generated.h"
 
+class FArticyCloneableObject;
+class UArticyDatabase;
+class UArticyObject;
+
+/**
+ * A reference to another object of the same database, resolved by the link pass of the database
+ * (see UArticyDatabase::LinkObjects) so following it doesn't look the object up by id.
+ * It refers to the loaded object rather than to one of its copies, and returns the copy of clone 0 which is current
+ * in the shadow state of the database, like GetObject does.
+ */
+struct ARTICYRUNTIME_API FArticyObjectLink
+{
+	/**
+	 * Links the object with the given id, or unlinks if the database has not loaded it.
+	 * @param InDatabase The database to link to, or nullptr to unlink.
+	 * @param Id The id of the referenced object.
+	 */
+	void Link(const UArticyDatabase* InDatabase, FArticyId Id);
+
+	/** @return The current copy of the linked object, or nullptr if not linked (the caller looks it up by id then). */
+	UArticyObject* Get() const;
+
+private:
+
+	/** The container of the linked object, owned by the database. */
+	const FArticyCloneableObject* Container = nullptr;
+
+	/** The generation of the container when it was linked, it changes when the object is unloaded. */
+	uint32 Generation = 0;
+
+	/** Weak, as objects outlive the database they were linked in when they are shared with their package. */
+	TWeakObjectPtr<const UArticyDatabase> Database;
+};
+
 /**
  * Base UCLASS for all articy objects.
  */
@@ -30,15 +64,52 @@ public:
 	/** Includes all children IDs regardless of type (including pins etc.) */
 	TArray<FArticyId> GetChildrenIDs() const;
 
+	/**
+	 * Returns true if this object is a descendant (not only a child) of another in the project hierarchy.
+	 * Uses the flattened hierarchy of the database (see UArticyDatabase::GetHierarchy), and follows the parents
+	 * for objects which are not part of it.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	bool IsDescendantOf(const UArticyObject* Ancestor) const;
+
+	/** Returns the database's private copy if this object is a package asset shared by a database. */
+	virtual IArticyReflectable* GetWritableInstance() override;
+
+	/** Returns the shadow copy of the current shadow state of the database, if this object was written in it. */
+	virtual IArticyReflectable* GetReadableInstance() override;
+
+	/** Links the parent and the references of the subobjects. */
+	virtual void LinkReferences(const UArticyDatabase* Database) override;
+
+	/**
+	 * Copies the properties written since the object was loaded or reset (see GetModifiedProperties) back from its
+	 * package asset, leaving all others as they are. Works for clones as well, they are reset to the package asset
+	 * rather than to clone 0. Not possible in a shadow state.
+	 *
+	 * @return false if the object was not modified or its package asset is not loaded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Articy")
+	bool ResetToOriginal();
+
 #if WITH_EDITOR
 	/** Includes all children IDs that map to articy objects (excluding pins etc.) */
 	TArray<FArticyId> GetArticyObjectChildrenIDs() const;
+
+	/** Whether the reachability analysis of the import excludes the object from cooked builds. */
+	bool IsStrippedFromCook() const { return bStrippedFromCook; }
+	void SetStrippedFromCook(bool bStripped) { bStrippedFromCook = bStripped; }
+
+	/** Stripped objects are editor only, which leaves them out of cooked packages. */
+	virtual bool IsEditorOnly() const override { return bStrippedFromCook || Super::IsEditorOnly(); }
 	
 	/** Find Asset fast maintains a transient database of all articy objects */
 	static UArticyObject* FindAsset(const FArticyId& Id);
 	static UArticyObject* FindAsset(const FString& TechnicalName);// MM_CHANGE
 
 private:
+	/** Caches the package assets of the original database. */
+	static void CachePackages();
+
 	static TSet<TWeakObjectPtr<class UArticyPackage>> CachedPackages;
 	static TMap<FArticyId, TWeakObjectPtr<UArticyObject>> ArticyIdCache;
 	static TMap<FName, TWeakObjectPtr<UArticyObject>> ArticyNameCache;
@@ -50,8 +121,15 @@ protected:
 	FArticyId Parent;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
 	TArray<FArticyId> Children;
+	/** Stored as a name, so looking objects up by it doesn't hash the string every time. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
-	FString TechnicalName;
+	FName TechnicalName;
+
+#if WITH_EDITORONLY_DATA
+	/** Set by the reachability analysis of the import, see UArticyPluginSettings::bStripUnreachableObjects. */
+	UPROPERTY(VisibleAnywhere, Category = "Articy")
+	bool bStrippedFromCook = false;
+#endif
 
 	/** Used internally by ArticyImporter. */
 	void InitFromJson(TSharedPtr<FJsonValue> Json) override;
@@ -59,4 +137,7 @@ protected:
 private:
 
 	mutable TArray<TWeakObjectPtr<UArticyObject>> CachedChildren;
+
+	/** The parent, see LinkReferences. */
+	FArticyObjectLink ParentLink;
 };
@@ -5,9 +5,14 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
 #include "ArticyChangedProperty.h"
+#include "Containers/Ticker.h"
 #include "ArticyObjectNotificationManager.generated.h"
 
+class UArticyObject;
+class IArticyReflectable;
+
 /**
  * Function pointer type for handling changes in Articy properties.
  * @param ChangedProperty The property that has changed.
@@ -25,8 +30,37 @@ enum class EArticyTypeProperties : uint8 {
     All = 15                 ///< Includes all types of properties.
 };
 
+/**
+ * A property of an object which was written through SetProp, see UArticyObjectNotificationManager::Subscribe.
+ */
+struct FArticyPropertyChange
+{
+    /** The object and clone which was written. */
+    FArticyId Id;
+    int32 CloneId = 0;
+
+    /** The written object, nullptr if it was destroyed before the change was dispatched. */
+    UArticyObject* Object = nullptr;
+
+    /** The written property, and its slot in the property table of the class it belongs to (see IArticyReflectable::GetPropertySlot). */
+    FName Property;
+    int32 Slot = INDEX_NONE;
+
+    /** Whether the property belongs to a feature of the object, rather than to the object itself. */
+    bool bFeature = false;
+};
+
+/** Called once per frame with the changes matching a subscription, in the order of their first write. */
+DECLARE_DELEGATE_OneParam(FOnArticyPropertiesChanged, const TArray<FArticyPropertyChange>&);
+
 /**
  * Manager class for handling notifications about changes in Articy objects.
+ *
+ * SetProp reports every write outside of shadow states (i.e. not the ones of explorations looking ahead) with the id
+ * and clone id of the object and the slot of the property. The writes are collected, written properties once per
+ * frame, and dispatched at the end of the frame to the subscriptions of the object, of its template (its exact class)
+ * and of its classes, which are found by hash lookups. Subscriptions are kept by id, so they keep working when an object
+ * is copied for a clone or a shadow state, or when a shared package asset is copied on its first write.
  */
 UCLASS(BlueprintType)
 class ARTICYRUNTIME_API UArticyObjectNotificationManager : public UObject
@@ -40,6 +74,45 @@ public:
      */
     static UArticyObjectNotificationManager* Get();
 
+    /**
+     * Subscribes to the property changes of an object.
+     * @param Id The id of the object.
+     * @param CloneId The clone to subscribe to, or -1 for all clones.
+     * @param OnChanged Called once per frame with the changes of the object.
+     * @return The handle to unsubscribe with.
+     */
+    int32 SubscribeToObject(const FArticyId& Id, int32 CloneId, FOnArticyPropertiesChanged OnChanged);
+
+    /**
+     * Subscribes to the property changes of all objects of a template, i.e. of exactly the generated class.
+     * @param Template The class of the objects.
+     * @param OnChanged Called once per frame with the changes of the objects.
+     * @return The handle to unsubscribe with.
+     */
+    int32 SubscribeToTemplate(const UClass* Template, FOnArticyPropertiesChanged OnChanged);
+
+    /**
+     * Subscribes to the property changes of all objects of a class, including the objects of its subclasses.
+     * @param Class The class of the objects.
+     * @param OnChanged Called once per frame with the changes of the objects.
+     * @return The handle to unsubscribe with.
+     */
+    int32 SubscribeToClass(const UClass* Class, FOnArticyPropertiesChanged OnChanged);
+
+    /** Removes a subscription. */
+    void Unsubscribe(int32 Handle);
+
+    /**
+     * Called by SetProp for a write, only while there are subscriptions (see IArticyReflectable::bDispatchPropertyChanges).
+     * @param Written The object or feature which was written.
+     * @param Property The written property.
+     * @param Slot The slot of the property, or INDEX_NONE to look it up.
+     */
+    void ReportPropertyChanged(IArticyReflectable* Written, const FProperty* Property, int32 Slot);
+
+    /** Dispatches the collected changes now, instead of at the end of the frame. */
+    void DispatchPendingChanges();
+
     /**
      * Adds a listener for changes to Articy objects matching the given filter.
      * @param Filter The filter string for identifying Articy objects.
@@ -82,4 +155,50 @@ protected:
      * @param OutInstanceNumber The resulting instance number.
      */
     void SplitInstance(const FString& InString, FString& OutName, FString& OutInstanceNumber);
+
+    /** Resolves an object filter (a technical name or an id, with an optional <CloneId>), see AddListener. */
+    UArticyObject* ResolveFilter(const FString& Filter);
+
+    virtual void BeginDestroy() override;
+
+private:
+
+    enum class ESubscriptionKind : uint8 { Object, Template, Class };
+
+    struct FSubscription
+    {
+        FOnArticyPropertiesChanged OnChanged;
+        ESubscriptionKind Kind = ESubscriptionKind::Object;
+        FArticyId Id;
+        int32 CloneId = INDEX_NONE;
+        const UClass* Class = nullptr;
+    };
+
+    /** The subscriptions by handle, and their handles by object id, by template and by class. */
+    TMap<int32, FSubscription> Subscriptions;
+    TMap<FArticyId, TArray<int32>> ObjectSubscriptions;
+    TMap<const UClass*, TArray<int32>> TemplateSubscriptions;
+    TMap<const UClass*, TArray<int32>> ClassSubscriptions;
+    int32 NextHandle = 1;
+
+    /** A written property of a clone. */
+    struct FPendingChange
+    {
+        FArticyId Id;
+        int32 CloneId = 0;
+        const FProperty* Property = nullptr;
+
+        bool operator==(const FPendingChange& Other) const { return Id == Other.Id && CloneId == Other.CloneId && Property == Other.Property; }
+        friend uint32 GetTypeHash(const FPendingChange& Change) { return HashCombine(GetTypeHash(Change.Id), HashCombine(GetTypeHash(Change.CloneId), GetTypeHash(Change.Property))); }
+    };
+
+    /** The changes of this frame in the order of their first write, and the written properties to collect them once. */
+    TArray<FArticyPropertyChange> PendingChanges;
+    TArray<TWeakObjectPtr<UArticyObject>> PendingObjects;
+    TSet<FPendingChange> PendingKeys;
+
+    FTSTicker::FDelegateHandle DispatchTickerHandle;
+
+    int32 AddSubscription(FSubscription&& Subscription);
+    bool DispatchTick(float DeltaTime);
 };
@@ -6,9 +6,26 @@
 
 #include "CoreMinimal.h"
 #include "ArticyObject.h"
+#include "ArticyReferenceIndex.h"
 #include "UObject/UObjectHash.h"
 #include "ArticyPackage.generated.h"
 
+/**
+ * The assets of a package with the same technical name, see UArticyPackage::GetNameIndex.
+ */
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyPackageNameIndexEntry
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	FName TechnicalName;
+
+	/** The indices of the assets in UArticyPackage::Assets, in the order of the assets. */
+	UPROPERTY()
+	TArray<int32> Assets;
+};
 
 UCLASS(BlueprintType)
 class ARTICYRUNTIME_API UArticyPackage : public UDataAsset
@@ -25,10 +42,30 @@ protected:
 
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "Articy")
 	TMap<FArticyId, TSoftObjectPtr<UArticyObject>> AssetsById;
+
+	/** The assets grouped by technical name, built at import so the database can index them by name in bulk. */
+	UPROPERTY()
+	TArray<FArticyPackageNameIndexEntry> NameIndex;
+
+	/** The references from the assets to other objects, see GetReferenceIndex. */
+	UPROPERTY()
+	FArticyReferenceIndex ReferenceIndex;
 public: 
 
 	virtual FPrimaryAssetId GetPrimaryAssetId() const override { return FPrimaryAssetId(FName(TEXT("ArticyPackage")), GetFName()); }
 
+	/**
+	 * Cooked packages are loaded as one garbage collection cluster with their assets and all of their subobjects
+	 * (features, pins, connections), which reachability analysis handles like a single object. The assets are
+	 * not modified at runtime, databases write to their own copies (see UArticyDatabase::GetWritableObject).
+	 */
+	virtual bool CanBeClusterRoot() const override { return true; }
+
+#if WITH_EDITOR
+	/** Leaves the objects stripped by the reachability analysis of the import out when cooking. */
+	virtual void Serialize(FArchive& Ar) override;
+#endif
+
 	void AddAsset(UArticyObject* ArticyObject);
 
 	UFUNCTION()
@@ -53,12 +90,33 @@ public:
 
 	const bool IsAssetContained(const FArticyId& Id) const;
 
+	/** Groups the assets by technical name, called by the import once all assets are added. */
+	void BuildNameIndex();
+
+	/** Returns the assets grouped by technical name, with one entry per name (NAME_None included). */
+	const TArray<FArticyPackageNameIndexEntry>& GetNameIndex() const { return NameIndex; }
+
+	/** Returns true if the name index was built for the current assets, packages created at runtime have none. */
+	bool HasNameIndex() const;
+
+	/**
+	 * Returns the references from the assets of this package to any imported object, by the object they refer to.
+	 * Written by the import, empty for packages created at runtime or imported before the index was written.
+	 */
+	const FArticyReferenceIndex& GetReferenceIndex() const { return ReferenceIndex; }
+
+	/** For ArticyImporter internal use only: sets the reference index, see GetReferenceIndex. */
+	void SetReferenceIndex(FArticyReferenceIndex&& NewIndex) { ReferenceIndex = MoveTemp(NewIndex); }
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Package")
 	FString Name;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Package")
 	FString Description;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Package")
 	bool bIsDefaultPackage = false;
+	/** The chunk the package is cooked into (see UArticyPluginSettings::PackageChunkIds), INDEX_NONE if unassigned. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Package")
+	int32 ChunkId = INDEX_NONE;
 
 private:
 	// used to determine which objects are still parented to this package, which may include outdated articy objects that have to be deleted
@@ -75,6 +133,8 @@ inline void UArticyPackage::Clear()
 	Assets.Empty();
 	AssetsById.Empty();
 	AssetsByTechnicalName.Empty();
+	NameIndex.Empty();
+	ReferenceIndex.Reset();
 }
 
 inline const TArray<UArticyObject*> UArticyPackage::GetAssets()
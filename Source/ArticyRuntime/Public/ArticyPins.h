@@ -14,6 +14,39 @@
 #include "ArticyPins.generated.h"
 
 class UArticyOutgoingConnection;
+class UArticyFlowPin;
+
+/**
+ * A reference to a pin and the object owning it, like the target of a connection or a jump, see FArticyObjectLink.
+ */
+struct ARTICYRUNTIME_API FArticyPinLink
+{
+	/**
+	 * Links the target, and its pin with the given id.
+	 * @param Database The database to link to, or nullptr to unlink.
+	 * @param TargetId The id of the object owning the pin.
+	 * @param PinId The id of the pin.
+	 */
+	void Link(const UArticyDatabase* Database, FArticyId TargetId, FArticyId PinId);
+
+	/** @return The current copy of the target, or nullptr if not linked. */
+	UArticyObject* GetTarget() const { return Target.Get(); }
+
+	/**
+	 * Returns the pin of a copy of the target. Only the copy which was current when linking has the linked pin,
+	 * the pins of the other copies (clones and shadow copies) are looked up in their subobjects.
+	 * @param CurrentTarget The copy of the target, as returned by GetTarget.
+	 * @param PinId The id of the pin.
+	 * @return The pin, or nullptr if the target has no such pin.
+	 */
+	UArticyFlowPin* GetPin(const UArticyPrimitive* CurrentTarget, FArticyId PinId) const;
+
+private:
+
+	FArticyObjectLink Target;
+	TWeakObjectPtr<UArticyFlowPin> Pin;
+};
+
 /**
  * A flow fragment input- or output pin.
  */
@@ -37,15 +70,36 @@ public:
 
 	void InitFromJson(TSharedPtr<FJsonValue> Json) override;
 
+	/** Returns the hash of the script fragment, which the expresso scripts know the script by. */
+	int32 GetScriptHash() const
+	{
+		if (!ScriptHash)
+			ScriptHash = GetTypeHash(Text);
+		return ScriptHash;
+	}
+
+	/** Returns the object owning this pin, which is the copy (clone or shadow copy) the pin belongs to. */
 	UFUNCTION(BlueprintCallable, Category = "Articy")
 	UArticyObject* GetOwner();
 
+	/** Links the connections. */
+	void LinkReferences(const UArticyDatabase* Database) override;
+
 	//---------------------------------------------------------------------------//
 
 	EArticyPausableType GetType() override { return EArticyPausableType::Pin; }
 
 	//stub implementation
 	void Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override { ensure(false); }
+
+private:
+
+	/**
+	 * Hash of the script fragment, computed on import so evaluations don't hash the script string.
+	 * Assets imported before it existed compute it on first use.
+	 */
+	UPROPERTY()
+	mutable int32 ScriptHash = 0;
 };
 
 /**
@@ -64,6 +118,12 @@ public:
 
 	bool Evaluate(class UArticyGlobalVariables* GV = nullptr, class UObject* MethodProvider = nullptr) override;
 
+	bool GetConditionScript(int& OutHash) const override
+	{
+		OutHash = GetScriptHash();
+		return true;
+	}
+
 	void Explore(UArticyFlowPlayer* Player, TArray<FArticyBranch>& OutBranches, const uint32& Depth) override;
 };
 
@@ -54,6 +54,90 @@ public:
 	UPROPERTY(EditAnywhere, Config, Category = ImportSettings, meta = (DisplayName = "Use legacy importer (prev. Articy 3.2.3)"))
 	bool bUseLegacyImporter;
 
+	/**
+	 * The number of .cpp files the generated expresso scripts are split into, so they compile in parallel.
+	 * Scripts are assigned to a file by their hash. Takes effect when the scripts are generated the next time.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Number of generated script files", ClampMin = "1", ClampMax = "64"))
+	int32 ExpressoScriptShards;
+
+	/**
+	 * The script methods which don't change anything and return the same for the same arguments, by name.
+	 * While the flow player explores the available branches, their results are memoized, so a method called with
+	 * the same arguments on several branches is only called once, and scripts calling them are explored without
+	 * a shadow state. Takes effect when the scripts are generated the next time.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Pure script methods"))
+	TArray<FString> PureScriptMethods;
+
+	/**
+	 * If true and Live Coding is enabled, imports which only change the bodies of the generated scripts patch them
+	 * into the running editor with Live Coding, instead of a hot reload or a restart of the editor.
+	 * The generated headers must be the same, i.e. the object definitions, global variables and script methods.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Patch script changes with Live Coding"))
+	bool bPatchScriptsWithLiveCoding;
+
+	/**
+	 * If true, the objects which cannot be reached from the reachability entry points by connections, jumps,
+	 * references or the object names in scripts are excluded from cooked builds. They stay available in the editor.
+	 * The stripped objects are listed in Saved/Articy/ReachabilityReport.json. Takes effect with the next import.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Strip unreachable objects from cooked builds"))
+	bool bStripUnreachableObjects;
+
+	/**
+	 * Where the reachability analysis starts: ids (0x hex or decimal), technical names, or names of packages, all of
+	 * whose objects are entry points. Everything the game looks up by id or name must be reachable from them.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Reachability entry points", EditCondition = "bStripUnreachableObjects"))
+	TArray<FString> ReachabilityEntryPoints;
+
+	/**
+	 * If true, the generated properties listed in the editor-only properties are wrapped in WITH_EDITORONLY_DATA, so
+	 * cooked builds neither load nor allocate them. Their interface getters (e.g. GetPosition) return default values
+	 * in cooked builds, which also affects the location index and preview images. Takes effect with the next import.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Generate editor-only properties"))
+	bool bGenerateEditorOnlyProperties;
+
+	/**
+	 * The technical names of the properties of generated classes and features which are only available in the editor,
+	 * e.g. the flow layout (Position, Size, Color, ZIndex) and the preview images.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Editor-only properties", EditCondition = "bGenerateEditorOnlyProperties"))
+	TArray<FString> EditorOnlyProperties;
+
+	/**
+	 * If true, cooking for dedicated servers saves the presentation properties listed below with their default values,
+	 * and the localizer system of dedicated servers returns the keys of the texts instead of loading the string tables
+	 * or localization packs. The flow, the scripts and the global variables are kept. Takes effect with the next cook.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Strip presentation data from dedicated server cooks"))
+	bool bStripPresentationForServer;
+
+	/**
+	 * The technical names of the properties of generated classes and features which dedicated servers don't need,
+	 * e.g. the texts, the preview images and the flow layout.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Server stripped properties", EditCondition = "bStripPresentationForServer"))
+	TArray<FString> ServerStrippedProperties;
+
+	/**
+	 * The number of worker threads which read and parse the files of the export at the same time during import.
+	 * 0 uses all task graph workers, 1 parses the files one after another.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Import worker count", ClampMin = "0", ClampMax = "64"))
+	int32 ImportWorkerCount;
+
+	/**
+	 * The memory (in MB) the parsed export files may take at the same time during import, 0 for no limit.
+	 * The files which do not fit are parsed one after another when they are imported, and freed once integrated,
+	 * which keeps the peak memory of large projects down at the cost of parsing them on the game thread.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Import memory budget (MB)", ClampMin = "0"))
+	int32 ImportMemoryBudgetMB;
+
 	/**
 	 * The directory where ArticyContent will be generated and assets are looked for
 	 * (when using ArticyAsset). Also used to search for the .articyue file to regenerate
@@ -63,6 +147,66 @@ public:
 	UPROPERTY(VisibleAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Articy Directory", ContentDir, LongPackageName))
 	FDirectoryPath ArticyDirectory;
 
+	/**
+	 * The generated database asset. Automatically set during import, so the database is loaded directly
+	 * instead of being searched for in the asset registry, which may not be fully scanned in cooked builds.
+	 * If it is not set or the asset is missing, the asset registry is searched as before.
+	 */
+	UPROPERTY(VisibleAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Database Asset", AllowedClasses = "/Script/ArticyRuntime.ArticyDatabase"))
+	FSoftObjectPath DatabaseAssetPath;
+
+	/**
+	 * The generated global variables asset. Automatically set during import, like the database asset.
+	 */
+	UPROPERTY(VisibleAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Global Variables Asset", AllowedClasses = "/Script/ArticyRuntime.ArticyGlobalVariables"))
+	FSoftObjectPath GlobalVariablesAssetPath;
+
+	/**
+	 * The generated expresso scripts class. Automatically set during import, so the database finds it
+	 * without iterating all classes.
+	 */
+	UPROPERTY(VisibleAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Expresso Scripts Class", MetaClass = "/Script/ArticyRuntime.ArticyExpressoScripts"))
+	FSoftClassPath ExpressoScriptsClassPath;
+
+	/**
+	 * The generated localizer system class. Automatically set during import, like the expresso scripts class.
+	 */
+	UPROPERTY(VisibleAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Localizer System Class", MetaClass = "/Script/ArticyRuntime.ArticyLocalizerSystem"))
+	FSoftClassPath LocalizerSystemClassPath;
+
+	/**
+	 * If true, the changes of the export in the articy directory are imported automatically, like "Import Changes".
+	 * The import starts once the export has not been written to for the settle time. During play, it waits until play
+	 * ends, unless the changes can be hot-patched into the running game (see bHotPatchPackagesDuringPlay).
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Import changes of the export automatically"))
+	bool bAutoImportExportChanges;
+
+	/**
+	 * The time in seconds the export must not change before it is imported automatically,
+	 * so articy:draft writing the export in several bursts causes a single import.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Automatic import settle time (s)", ClampMin = "0.1", EditCondition = "bAutoImportExportChanges"))
+	float AutoImportSettleTime;
+
+	/**
+	 * If true, an import during play which only changes the content of packages (no generated code changes) is not
+	 * queued until play ends. The changed packages are regenerated and reloaded into the running databases instead,
+	 * keeping the state of the global variables and the clones of the objects.
+	 * Off by default: the clones of the changed objects are cloned again from the patched objects, which discards
+	 * their runtime modifications.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Hot-patch changed packages during play"))
+	bool bHotPatchPackagesDuringPlay;
+
+	/**
+	 * The chunk each articy:draft package is cooked into, by package name. Packages without an entry
+	 * end up in the chunks of the assets referencing them. Used to split the dialogue data for pak/IoStore chunks
+	 * and install-on-demand. Hit "Import Changes" anytime you change this setting.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = ImportSettings, meta = (DisplayName = "Package chunk ids"))
+	TMap<FString, int32> PackageChunkIds;
+
 	/**
 	 * Keeps one instance of the database for the whole game alive, even if the world changes.
 	 */
@@ -75,6 +219,58 @@ public:
 	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Keep global variables between worlds"))
 	bool bKeepGlobalVariablesBetweenWorlds;
 
+	/**
+	 * If the database or global variables are not kept between worlds, the instance of a world that is gone is reset
+	 * to the state of the asset and reused by the next world, instead of duplicating the asset again.
+	 * Only writes made through the generated setters, SetProp and scripts are undone by the reset.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Reuse instances of previous worlds"))
+	bool bReuseWorldClones;
+
+	/**
+	 * If true, the database does not duplicate the objects of a package when loading it.
+	 * Instead, the package assets are used directly until something changes them via SetProp,
+	 * at which point the database creates its own copy. Saves memory for read-only objects, but objects
+	 * modified by other means than SetProp (e.g. through references returned by GetProp) will change the asset.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Share unmodified objects with packages (copy on write)"))
+	bool bShareUnmodifiedObjectsWithPackages;
+
+	/**
+	 * If true, clones share the features of the object they are cloned from instead of duplicating them.
+	 * A clone gets its own copy of a feature when it is first changed through the clone, by scripts or with
+	 * UArticyBaseObject::GetFeatureForWrite, and the original gets one when it changes a feature its clones share.
+	 * Saves memory for many clones of one entity, but features modified by other means (e.g. through the pointer
+	 * returned by GetProp) change the feature of all clones sharing it.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Share features between clones (copy on write)"))
+	bool bShareFeaturesBetweenClones;
+
+	/**
+	 * Time in milliseconds that LoadPackageAsync may spend per frame duplicating package objects.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Async package load budget per frame (ms)", ClampMin = "0.1"))
+	float AsyncPackageLoadBudgetMs;
+
+	/**
+	 * The memory (in MB) the loaded non-default packages of a database may take, 0 for no limit.
+	 * Above the budget, the least recently used packages (by GetObject) are unloaded at the end of the frame,
+	 * except the ones of the cursors of flow players and the ones whose objects have clones or were written.
+	 * An evicted package starts loading asynchronously when one of its objects is requested by id, which returns nullptr until then;
+	 * pin packages (UArticyDatabase::PinPackage) whose objects must always resolve.
+	 * Tracking the use of the packages takes the slower lookup path of GetObject.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Package residency budget (MB)", ClampMin = "0"))
+	int32 PackageResidencyBudgetMB;
+
+	/**
+	 * If true, the flow players which traverse a branch in the same tick update their available branches together
+	 * with UArticyFlowPlayer::UpdateAvailableBranchesInParallel, so the ones allowing parallel exploration explore
+	 * on worker threads. Off by default: it only pays off for many players, and their user methods must be thread safe.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Update flow players in parallel"))
+	bool bUpdateFlowPlayersInParallel;
+
 	/**
 	 * If true, converts Unity formatting in the exported articy:draft project into Unreal's rich text format.
 	 * Hit "Import Changes" anytime you change this setting.
@@ -82,6 +278,26 @@ public:
 	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Convert Unity formatting to Unreal Rich Text"))
 	bool bConvertUnityToUnrealRichText;
 
+	/**
+	 * If true, the importer also writes one binary localization pack per culture, and the localizer system reads
+	 * the texts from the pack of the current culture instead of registering the CSV string tables.
+	 * Hit "Import Changes" anytime you change this setting.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Use binary localization packs"))
+	bool bUseLocalizationPacks;
+
+	/**
+	 * If true, the localization packs store the texts of each string table in compressed blocks, which are decompressed
+	 * when one of their texts is looked up and kept in a small cache, so the memory of the texts scales with the texts
+	 * shown instead of the size of the packages. Hit "Import Changes" anytime you change this setting.
+	 */
+	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Compress localization pack texts", EditCondition = "bUseLocalizationPacks"))
+	bool bCompressLocalizationPacks;
+
+	/** The number of decompressed text blocks (of up to 4096 characters each) a compressed localization pack keeps. */
+	UPROPERTY(EditAnywhere, config, Category = RuntimeSettings, meta = (DisplayName = "Cached localization pack blocks", ClampMin = "1", EditCondition = "bCompressLocalizationPacks"))
+	int32 LocalizationPackCachedBlocks;
+
 	/**
 	 * Internal cached data for data consistency between imports (setting restoration etc.).
 	 */
@@ -96,6 +312,14 @@ public:
 	 */
 	bool DoesPackageSettingExist(FString packageName);
 
+	/**
+	 * Gets the chunk a package is cooked into.
+	 *
+	 * @param PackageName The name of the package.
+	 * @return The chunk id of the package, or INDEX_NONE if it has no assigned chunk.
+	 */
+	int32 GetPackageChunkId(const FString& PackageName) const;
+
 	/**
 	 * Retrieves the singleton instance of UArticyPluginSettings.
 	 *
@@ -103,6 +327,16 @@ public:
 	 */
 	static const UArticyPluginSettings* Get();
 
+	/**
+	 * Finds a generated class, using the class path stored by the import.
+	 * Only if the path is not set or its class is not loaded, all classes are iterated for a subclass of BaseClass.
+	 *
+	 * @param ClassPath The class path stored by the import.
+	 * @param BaseClass The runtime class the generated class derives from.
+	 * @return The generated class, or nullptr if none is loaded.
+	 */
+	static UClass* FindGeneratedClass(const FSoftClassPath& ClassPath, const UClass* BaseClass);
+
 	/**
 	 * Updates package settings based on the currently imported packages.
 	 */
@@ -6,6 +6,8 @@
 
 #include "ArticyBaseObject.h"
 #include "ArticyBaseTypes.h"
+#include "ArticyCapabilities.h"
+#include <atomic>
 
 #include "ArticyPrimitive.generated.h"
 
@@ -23,6 +25,19 @@ public:
 	
 	void SetCloneID(uint32 cCloneId) { CloneId = cCloneId; }
 
+	/** Returns the dense slot of the seen counter of this object, see FArticySeenCounterSlots. */
+	int32 GetSeenCounterSlot() const;
+
+	/** Returns the capabilities of the class of this object, see FArticyCapabilities. */
+	const FArticyCapabilities& GetCapabilities() const;
+
+	/**
+	 * Returns an interface or base class of this object listed in EArticyCapability, e.g. IArticyObjectWithSpeaker.
+	 * Same as a Cast, but without walking the class hierarchy.
+	 */
+	template<typename Type>
+	Type* GetCapability() const { return GetCapabilities().Get<Type>(this); }
+
 protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
 	FArticyId Id;
@@ -52,4 +67,10 @@ protected:
 	
 private:
 	mutable FString Path = "";
+
+	/** See GetSeenCounterSlot, cached as it is needed whenever a seen counter is accessed. */
+	mutable std::atomic<int32> SeenCounterSlot { INDEX_NONE };
+
+	/** See GetCapabilities, cached so only the first use looks up the class. */
+	mutable std::atomic<const FArticyCapabilities*> Capabilities { nullptr };
 };
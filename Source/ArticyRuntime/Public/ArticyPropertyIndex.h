@@ -0,0 +1,122 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+#include "ArticyExpressoScripts.h"
+
+class UArticyDatabase;
+class UArticyObject;
+
+/** How a property index answers equality queries, see UArticyDatabase::RegisterPropertyIndex. */
+enum class EArticyPropertyIndexKind : uint8
+{
+	/** Equality queries are answered by a hash map in O(1), range queries by binary search. */
+	Hashed,
+	/** All queries are answered by binary search in O(log N), without the memory of the hash map. */
+	Sorted
+};
+
+/**
+ * @class FArticyPropertyIndex
+ * @brief A secondary index on a property of the objects of a class, e.g. the Stage of all quests or the Rarity of
+ * all items, which finds the objects with a value without reading the property of every object.
+ *
+ * The index holds the unshadowed clone 0 of each object, sorted by the value of the property and then by id, so the
+ * objects with a value or within a range are a contiguous view into the index and queries do not allocate. The
+ * property is read like getProp, by its name or as Feature.Property; objects whose value cannot be read are left out.
+ *
+ * Indices are registered with and kept up to date by the database (see UArticyDatabase::RegisterPropertyIndex):
+ * writes through SetProp, the generated setters and scripts, as well as loading and unloading packages, mark the
+ * object, and the database updates the marked objects before it returns the index again. The returned views are
+ * valid until then.
+ */
+class ARTICYRUNTIME_API FArticyPropertyIndex
+{
+public:
+
+	FArticyPropertyIndex(const UClass* InClass, const FString& InProperty, EArticyPropertyIndexKind InKind)
+		: Class(InClass), Property(InProperty), Kind(InKind) {}
+
+	const UClass* GetClass() const { return Class; }
+	const FString& GetPropertyPath() const { return Property; }
+	EArticyPropertyIndexKind GetKind() const { return Kind; }
+
+	/** Returns the number of indexed objects. */
+	int32 Num() const { return Objects.Num(); }
+
+	/** Returns all indexed objects, ordered by value. */
+	TConstArrayView<UArticyObject*> GetAll() const { return Objects; }
+
+	/** Returns the objects whose property equals Value. */
+	TConstArrayView<UArticyObject*> FindEqual(const ExpressoType& Value) const;
+
+	/** Returns the objects whose property is in [Min, Max], ordered by value. */
+	TConstArrayView<UArticyObject*> FindInRange(const ExpressoType& Min, const ExpressoType& Max) const;
+
+	/** Returns the objects whose property is at least Value, ordered by value. */
+	TConstArrayView<UArticyObject*> FindAtLeast(const ExpressoType& Value) const;
+
+	/** Returns the objects whose property is at most Value, ordered by value. */
+	TConstArrayView<UArticyObject*> FindAtMost(const ExpressoType& Value) const;
+
+	/** Returns the indexed value of an object, undefined if the object is not indexed. */
+	const ExpressoType& GetIndexedValue(const FArticyId& Id) const;
+
+private:
+
+	friend class UArticyDatabase;
+
+	const UClass* Class;
+	FString Property;
+	EArticyPropertyIndexKind Kind;
+
+	/** The indexed objects with their ids and values, sorted by value and id. */
+	TArray<ExpressoType> Values;
+	TArray<FArticyId> Ids;
+	TArray<UArticyObject*> Objects;
+
+	/** The value of each indexed object, to find its entry when it changes. */
+	TMap<FArticyId, ExpressoType> ValuesById;
+
+	/** For hashed indices: the start of the entries of each distinct value, and their number. */
+	struct FBucketKeyFuncs : BaseKeyFuncs<TPair<ExpressoType, TPair<int32, int32>>, ExpressoType>
+	{
+		static const ExpressoType& GetSetKey(const TPair<ExpressoType, TPair<int32, int32>>& Element) { return Element.Key; }
+		static bool Matches(const ExpressoType& A, const ExpressoType& B);
+		static uint32 GetKeyHash(const ExpressoType& Key);
+	};
+	TMap<ExpressoType, TPair<int32, int32>, FDefaultSetAllocator, FBucketKeyFuncs> Buckets;
+
+	/** Rebuilds the index from all loaded objects of the class. */
+	void Rebuild(const UArticyDatabase* Database);
+
+	/**
+	 * Updates the entry of an object after it was written, loaded or unloaded.
+	 * @param Id The id of the object.
+	 * @param Object The current unshadowed clone 0 of the object, nullptr if it is not loaded anymore.
+	 * @return True if the entries changed.
+	 */
+	bool Update(const FArticyId& Id, UArticyObject* Object);
+
+	/** Rebuilds the buckets of a hashed index from the sorted entries. */
+	void RebuildBuckets();
+
+	/** Reads the indexed value of an object, undefined if it cannot be read. */
+	ExpressoType ReadValue(UArticyObject* Object) const;
+
+	/** Returns the first entry whose value is not less than Value, or for UpperBound greater than Value. */
+	int32 LowerBound(const ExpressoType& Value) const;
+	int32 UpperBound(const ExpressoType& Value) const;
+
+	/** Returns true if a query value can be compared with the indexed values. */
+	bool IsComparable(const ExpressoType& Value) const;
+
+	TConstArrayView<UArticyObject*> View(int32 Begin, int32 End) const
+	{
+		return Begin < End ? TConstArrayView<UArticyObject*>(Objects.GetData() + Begin, End - Begin) : TConstArrayView<UArticyObject*>();
+	}
+};
@@ -115,12 +115,21 @@ private:
 	UPROPERTY(EditAnywhere, Category="Setup")
 	mutable FArticyId Id = 0;
 
-	/** The single-instance object copy of this ArticyRef. */
+	/**
+	 * The single-instance object copy of this ArticyRef, resolved for CachedWorldContext.
+	 * It is resolved again once UArticyDatabase::GetObjectResolveVersion changes.
+	 */
 	mutable TWeakObjectPtr<UArticyObject> CachedObject = nullptr;
 	mutable FArticyId CachedId = 0;
 	mutable int32 CachedCloneId = 0;
+	mutable TWeakObjectPtr<const UObject> CachedWorldContext = nullptr;
+	mutable uint32 CachedResolveVersion = 0;
+
+	/** Returns the cached object if it is still valid for the context, otherwise resolves it again. */
+	UArticyObject* GetCachedObject(const UObject* WorldContext) const;
 
-	UArticyObject* GetObjectInternal(const UObject* WorldContext) const;
+	/** Resolves the object in the database of the context, bOutCacheable is false if it is a shadow copy. */
+	UArticyObject* GetObjectInternal(const UObject* WorldContext, bool& bOutCacheable) const;
 
 private:
 
@@ -140,14 +149,7 @@ private:
 template<typename T>
 T* FArticyRef::GetObject(const UObject* WorldContext) const
 {
-	if (!CachedObject.IsValid() || CachedId != Id || CloneId != CachedCloneId)
-	{
-		CachedId = Id;
-		CachedCloneId = CloneId;
-		CachedObject = GetObjectInternal(WorldContext);
-	}
-
-	return Cast<T>(CachedObject.Get());
+	return Cast<T>(GetCachedObject(WorldContext));
 }
 
 //template<>
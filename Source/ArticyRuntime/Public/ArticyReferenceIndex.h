@@ -0,0 +1,114 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+#include "ArticyReferenceIndex.generated.h"
+
+/** How an object refers to another, see FArticyIncomingReference. */
+UENUM(BlueprintType)
+enum class EArticyReferenceKind : uint8
+{
+	/** An outgoing connection of the source ends at the target, or at one of its pins. */
+	Connection,
+	/** The source is a jump to the target. */
+	Jump,
+	/** A property of the source holds the id of the target, e.g. the speaker of a dialogue fragment or a reference strip. */
+	Property,
+	/** A script of the source names the target by technical name or id, e.g. getObj("Chr_Manfred"). */
+	Script
+};
+
+/** A reference to an object from another object of a package. */
+USTRUCT(BlueprintType)
+struct ARTICYRUNTIME_API FArticyIncomingReference
+{
+	GENERATED_BODY()
+
+	/** The object holding the reference. References of pins, connections and features are the ones of their object. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
+	FArticyId Source;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
+	EArticyReferenceKind Kind = EArticyReferenceKind::Property;
+
+	/** The property holding the reference, Feature.Property for the properties of features; None for connections and scripts. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
+	FName Property;
+
+	bool operator==(const FArticyIncomingReference& Other) const
+	{
+		return Source == Other.Source && Kind == Other.Kind && Property == Other.Property;
+	}
+};
+
+/** The references to one object. */
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyIncomingReferences
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FArticyIncomingReference> References;
+};
+
+/**
+ * The references between the objects of the import, by the object they refer to, written into each package by the
+ * import (see UArticyPackage::GetReferenceIndex).
+ *
+ * The index of a package holds the references from its objects, to objects of any package: incoming connections,
+ * jumps, the properties holding ids (like speakers and reference strips), and the scripts naming an object. Pins and
+ * connections are resolved to their objects on both ends, and the hierarchy (parent and children) is left out.
+ * Finding the references to an object is a hash lookup per package instead of a scan of all objects.
+ */
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyReferenceIndex
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns true if no references were indexed, e.g. for packages imported before the index was written. */
+	bool IsEmpty() const { return Targets.Num() == 0; }
+
+	/** Returns the number of objects which are referenced. */
+	int32 Num() const { return Targets.Num(); }
+
+	/**
+	 * Returns the references to an object.
+	 * @param Target The id of the referenced object.
+	 * @return The references in the order they were added, or nullptr if there are none.
+	 */
+	const TArray<FArticyIncomingReference>* Find(const FArticyId& Target) const;
+
+	/** Returns true if both indices hold the same references, in the same order. */
+	bool operator==(const FArticyReferenceIndex& Other) const;
+	bool operator!=(const FArticyReferenceIndex& Other) const { return !(*this == Other); }
+
+	//========================================//
+
+	/** Removes all references, before the import adds them again. */
+	void Reset() { Targets.Reset(); }
+
+	/**
+	 * Adds a reference to an object, unless the same one was added already.
+	 * @param Target The id of the referenced object.
+	 * @param Reference The reference.
+	 */
+	void Add(const FArticyId& Target, const FArticyIncomingReference& Reference);
+
+	/**
+	 * Removes the references of some sources, used to leave the objects stripped from cooked builds out.
+	 * @param Predicate Returns true for the sources to remove.
+	 */
+	void RemoveSources(TFunctionRef<bool(const FArticyId&)> Predicate);
+
+private:
+
+	/** The references by the id of the object they refer to. */
+	UPROPERTY()
+	TMap<FArticyId, FArticyIncomingReferences> Targets;
+};
@@ -0,0 +1,155 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+
+class UWorld;
+
+#define LOCTEXT_NAMESPACE "ArticyRuntime"
+
+/**
+ * @class FArticyRuntimeConsoleCommands
+ * @brief Provides console commands for the Articy Runtime module.
+ *
+ * These commands are meant for profiling and diagnostics of the runtime data structures,
+ * and are available in editor and packaged builds alike.
+ */
+class FArticyRuntimeConsoleCommands
+{
+public:
+
+	/** Constructor that registers the console commands. */
+	FArticyRuntimeConsoleCommands()
+		: BenchmarkIdMapsCommand(
+			TEXT("Articy.BenchmarkIdMaps"),
+			*LOCTEXT("CommandText_BenchmarkIdMaps", "Benchmarks the FArticyId hash on a synthetic set of ids. Usage: Articy.BenchmarkIdMaps [NumObjects=100000]").ToString(),
+			FConsoleCommandWithArgsDelegate::CreateStatic(&FArticyRuntimeConsoleCommands::BenchmarkIdMaps))
+		, DumpScriptProfileCommand(
+			TEXT("Articy.DumpScriptProfile"),
+			*LOCTEXT("CommandText_DumpScriptProfile", "Logs the most expensive expresso script fragments. Usage: Articy.DumpScriptProfile [NumFragments=20] [reset]").ToString(),
+			FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&FArticyRuntimeConsoleCommands::DumpScriptProfile))
+		, DumpGVProfileCommand(
+			TEXT("Articy.DumpGVProfile"),
+			*LOCTEXT("CommandText_DumpGVProfile", "Writes the reads and writes of the global variables by script fragment to a CSV file, relative to Saved/Articy/Profiles. Usage: Articy.DumpGVProfile [File=GVProfile.csv] [reset]").ToString(),
+			FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&FArticyRuntimeConsoleCommands::DumpGVProfile))
+		, MemReportCommand(
+			TEXT("Articy.MemReport"),
+			*LOCTEXT("CommandText_MemReport", "Logs the memory used by the articy data, by category. See also 'stat Articy'.").ToString(),
+			FConsoleCommandDelegate::CreateStatic(&FArticyRuntimeConsoleCommands::MemReport))
+		, BenchmarkRuntimeCommand(
+			TEXT("Articy.BenchmarkRuntime"),
+			*LOCTEXT("CommandText_BenchmarkRuntime", "Measures the database, flow player, texts and global variables with synthetic flows, and writes the results to Saved/Articy/Benchmark. Usage: Articy.BenchmarkRuntime [Objects=100000] [ChainLength=200] [HubWidth=256] [TreeDepth=12] [Iterations=100000] [Passes=100] [Clones=10000] [Seed=1]").ToString(),
+			FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&FArticyRuntimeConsoleCommands::BenchmarkRuntime))
+		, SimulateFlowCommand(
+			TEXT("Articy.SimulateFlow"),
+			*LOCTEXT("CommandText_SimulateFlow", "Walks random playthroughs from a node on worker threads, and writes the coverage, dead ends and node costs to Saved/Articy/Simulation. Usage: Articy.SimulateFlow Start=<id or technical name> [Playthroughs=10000] [MaxSteps=1000] [Workers=0] [Seed=1] [MaxSeconds=0]").ToString(),
+			FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&FArticyRuntimeConsoleCommands::SimulateFlow))
+		, ReplayFlowCommand(
+			TEXT("Articy.ReplayFlow"),
+			*LOCTEXT("CommandText_ReplayFlow", "Replays a flow capture saved by UArticyFlowPlayer::StopCapture with a headless flow player, and logs the time it took and where it diverged. Usage: Articy.ReplayFlow <File, relative to Saved/Articy/Captures>").ToString(),
+			FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&FArticyRuntimeConsoleCommands::ReplayFlow))
+	{}
+
+	/**
+	 * @brief Benchmarks the id maps used by the database and the global variables.
+	 *
+	 * Generates a synthetic package worth of ids (sequential and correlated high/low words, like articy
+	 * does), and reports the probe lengths of the flat object table layout and the lookup throughput of a
+	 * TMap keyed by FArticyId, both for the current hash and for the legacy Low ^ High hash.
+	 *
+	 * @param Args Optional number of objects to generate.
+	 */
+	static void BenchmarkIdMaps(const TArray<FString>& Args);
+
+	/**
+	 * @brief Logs the most expensive expresso script fragments.
+	 *
+	 * Lists the fragments by cumulative time, with their call counts, text and owning object,
+	 * as recorded by FArticyScriptProfiler. Passing "reset" discards the statistics afterwards.
+	 *
+	 * @param Args Optional number of fragments, and "reset".
+	 * @param World The world to get the database from.
+	 */
+	static void DumpScriptProfile(const TArray<FString>& Args, UWorld* World);
+
+	/**
+	 * @brief Writes the accesses of the global variables to a CSV file.
+	 *
+	 * Lists the reads and writes of each variable by script fragment, split by live and shadowed accesses, as
+	 * recorded by FArticyGvProfiler. Passing "reset" discards the counts afterwards.
+	 *
+	 * @param Args Optional file, and "reset".
+	 * @param World The world to get the database from.
+	 */
+	static void DumpGVProfile(const TArray<FString>& Args, UWorld* World);
+
+	/**
+	 * @brief Logs the memory used by the articy data.
+	 *
+	 * Lists the categories of FArticyMemoryReport, largest first: the generated packages, the database clones and
+	 * shadow copies, the global variables and the string tables, and in the editor the import data.
+	 */
+	static void MemReport();
+
+	/**
+	 * @brief Measures the hot paths of the runtime with synthetic flows.
+	 *
+	 * Builds a package with a linear chain, a wide hub and a deep tree in a database of its own, and measures object
+	 * lookups, clones, explorations, plays, text resolves and variable accesses. See FArticyRuntimeBenchmark.
+	 *
+	 * @param Args The size of the flows, e.g. Objects=20000 TreeDepth=8.
+	 * @param World The world whose global variables and texts are measured.
+	 */
+	static void BenchmarkRuntime(const TArray<FString>& Args, UWorld* World);
+
+	/**
+	 * @brief Walks random playthroughs of the flow to find dead ends and unreachable content.
+	 *
+	 * Runs the playthroughs from a start node on worker threads, each with its own fork of the global variables, and
+	 * reports the node coverage, the dead ends and the exploration and script times per node. See FArticyFlowSimulator.
+	 *
+	 * @param Args The start node and number of playthroughs, e.g. Start=0x0100000000001234 Playthroughs=100000.
+	 * @param World The world whose database and global variables are used.
+	 */
+	static void SimulateFlow(const TArray<FString>& Args, UWorld* World);
+
+	/**
+	 * @brief Replays a flow capture, e.g. to profile the evaluation workload of a playtest session offline.
+	 *
+	 * Restores the state of the global variables the capture started with on a fork, plays the captured branches and
+	 * returns the recorded results of the user methods. See FArticyFlowReplay.
+	 *
+	 * @param Args The capture file.
+	 * @param World The world whose database and global variables are used.
+	 */
+	static void ReplayFlow(const TArray<FString>& Args, UWorld* World);
+
+private:
+
+	/** Console command for benchmarking the id maps. */
+	FAutoConsoleCommand BenchmarkIdMapsCommand;
+
+	/** Console command for dumping the script profile. */
+	FAutoConsoleCommandWithWorldAndArgs DumpScriptProfileCommand;
+
+	/** Console command for writing the GV profile. */
+	FAutoConsoleCommandWithWorldAndArgs DumpGVProfileCommand;
+
+	/** Console command for logging the memory report. */
+	FAutoConsoleCommand MemReportCommand;
+
+	/** Console command for benchmarking the runtime. */
+	FAutoConsoleCommandWithWorldAndArgs BenchmarkRuntimeCommand;
+
+	/** Console command for simulating playthroughs of the flow. */
+	FAutoConsoleCommandWithWorldAndArgs SimulateFlowCommand;
+
+	/** Console command for replaying a flow capture. */
+	FAutoConsoleCommandWithWorldAndArgs ReplayFlowCommand;
+};
+
+#undef LOCTEXT_NAMESPACE
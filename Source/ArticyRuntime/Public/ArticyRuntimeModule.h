@@ -6,9 +6,14 @@
 
 #include "Modules/ModuleInterface.h"
 #include "Modules/ModuleManager.h"
+#include "Stats/Stats.h"
+
+class FArticyRuntimeConsoleCommands;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogArticyRuntime, Log, All)
 
+DECLARE_STATS_GROUP(TEXT("Articy"), STATGROUP_Articy, STATCAT_Advanced);
+
 /**
  * Module for the Articy Runtime.
  *
@@ -30,4 +35,9 @@ public:
 	 * This method is called when the module is unloaded from memory.
 	 */
 	virtual void ShutdownModule() override;
+
+private:
+
+	/** The runtime console commands, owned by the module. */
+	FArticyRuntimeConsoleCommands* ConsoleCommands = nullptr;
 };
@@ -36,14 +36,15 @@ protected:
     FString Expression = "";
 
     /**
-     * Returns a cached hash of the expression.
+     * Returns the hash of the expression, which the expresso scripts know the script by.
      *
-     * @return The cached hash of the expression.
+     * @return The hash of the expression.
      */
     int GetExpressionHash() const;
 
     template<typename Type, typename PropType>
     friend struct ArticyObjectTypeInfo;
+    friend class FArticyFlowGraph;
 
     /**
      * Initializes the script fragment from a JSON value.
@@ -55,9 +56,11 @@ protected:
 private:
 
     /**
-     * Cached hash of the expression to optimize performance.
+     * Hash of the expression, computed on import so evaluations don't hash the expression string.
+     * Assets imported before it existed compute it on first use.
      */
-    mutable int CachedExpressionHash;
+    UPROPERTY()
+    mutable int32 ExpressionHash = 0;
 };
 
 /** -------------------------------------------------------------------------------- */
@@ -80,6 +83,12 @@ public:
      * @return True if the condition evaluates to true, false otherwise.
      */
     bool Evaluate(class UArticyGlobalVariables* GV = nullptr, class UObject* MethodProvider = nullptr) override;
+
+    bool GetConditionScript(int& OutHash) const override
+    {
+        OutHash = GetExpressionHash();
+        return true;
+    }
 };
 
 /**
@@ -115,6 +124,9 @@ public:
      */
     bool Evaluate(class UArticyGlobalVariables* GV = nullptr, class UObject* MethodProvider = nullptr) override;
 
+    /** Returns the script of the script condition, a node without one is evaluated by Evaluate. */
+    bool GetConditionScript(int& OutHash) const override;
+
     /**
      * Explores the condition node and appends the resulting branches to the output array.
      *
@@ -0,0 +1,120 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/PlatformTime.h"
+#include "Runtime/Launch/Resources/Version.h"
+#if ENGINE_MAJOR_VERSION >= 5 || ENGINE_MINOR_VERSION >= 26
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#endif
+
+class UArticyDatabase;
+
+#if defined(UE_TRACE_ENABLED) && UE_TRACE_ENABLED
+/** Trace channel of the expresso script scopes, enable it in Unreal Insights (or with -trace=cpu,ArticyScripts). */
+UE_TRACE_CHANNEL_EXTERN(ArticyScriptsChannel, ARTICYRUNTIME_API);
+
+#define ARTICY_SCRIPT_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(Name, ArticyScriptsChannel)
+#else
+#define ARTICY_SCRIPT_TRACE_SCOPE(Name)
+#endif
+
+/**
+ * @class FArticyScriptProfiler
+ * @brief Collects call counts and timings of the expresso script fragments.
+ *
+ * Recording is off by default and enabled with the console variable Articy.ProfileScripts.
+ * Articy.DumpScriptProfile logs the most expensive fragments, with their text and owning object.
+ */
+class ARTICYRUNTIME_API FArticyScriptProfiler
+{
+public:
+
+	/** The statistics of one script fragment. */
+	struct FFragmentStats
+	{
+		/** Whether the fragment is an instruction (or condition). */
+		bool bInstruction = false;
+
+		/** How often the fragment was evaluated or executed. */
+		uint64 Calls = 0;
+
+		/** The cumulative time spent in the fragment, in cycles. */
+		uint64 Cycles = 0;
+	};
+
+	/**
+	 * @brief Measures one evaluation or execution of a fragment, if profiling is enabled.
+	 */
+	class FScope
+	{
+	public:
+		FScope(int32 InHash, bool bInInstruction)
+			: Hash(InHash), bInstruction(bInInstruction), StartCycles(IsEnabled() ? FPlatformTime::Cycles64() : 0)
+		{}
+
+		~FScope()
+		{
+			if (StartCycles != 0)
+				Record(Hash, bInstruction, FPlatformTime::Cycles64() - StartCycles);
+		}
+
+	private:
+		int32 Hash;
+		bool bInstruction;
+		uint64 StartCycles;
+	};
+
+	/** @brief Returns true if script fragments are recorded. */
+	static bool IsEnabled();
+
+	/**
+	 * @brief Adds one call of a fragment to its statistics.
+	 *
+	 * @param Hash The hash of the fragment.
+	 * @param bInstruction Whether the fragment is an instruction.
+	 * @param Cycles The time spent in the call, in cycles.
+	 */
+	static void Record(int32 Hash, bool bInstruction, uint64 Cycles);
+
+	/** @brief Discards all recorded statistics. */
+	static void Reset();
+
+	/**
+	 * @brief Returns the fragments with the most cumulative time, most expensive first.
+	 *
+	 * @param Num The maximum number of fragments to return.
+	 * @return The hashes and statistics of the fragments.
+	 */
+	static TArray<TPair<int32, FFragmentStats>> GetTopFragments(int32 Num);
+
+	/**
+	 * @brief Logs the most expensive fragments, with their text and owning object in the database.
+	 *
+	 * @param Database The database to look up fragments in, may be null.
+	 * @param Num The maximum number of fragments to log.
+	 */
+	static void DumpTopFragments(const UArticyDatabase* Database, int32 Num);
+
+	/**
+	 * @brief Finds the owning object and text of fragments in the flow graph of a database.
+	 *
+	 * @param Database The database to look up fragments in.
+	 * @param Hashes The hashes of the fragments.
+	 * @return The name of the owner and the text of each fragment found, by hash.
+	 */
+	static TMap<int32, TPair<FString, FString>> FindSources(const UArticyDatabase* Database, const TSet<int32>& Hashes);
+
+private:
+
+	/** The statistics by fragment hash. */
+	static TMap<int32, FFragmentStats> Fragments;
+
+	/** Scripts may run on worker threads during parallel flow exploration. */
+	static FCriticalSection FragmentsLock;
+};
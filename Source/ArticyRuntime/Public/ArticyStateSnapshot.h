@@ -0,0 +1,131 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArticyBaseTypes.h"
+#include "ArticyExpressoScripts.h"
+#include "Templates/SubclassOf.h"
+
+class UArticyDatabase;
+class UArticyGlobalVariables;
+class UArticyObject;
+
+/**
+ * @struct FArticyStateSnapshotRequest
+ * @brief Which objects and properties a state snapshot captures, besides the global variables.
+ */
+struct ARTICYRUNTIME_API FArticyStateSnapshotRequest
+{
+	/** The objects to capture, by id. */
+	TArray<FArticyId> Objects;
+
+	/** The classes whose objects are captured, including the objects of subclasses. */
+	TArray<TSubclassOf<UArticyObject>> Classes;
+
+	/** The properties captured of each object, the property name or Feature.Property like in getProp. */
+	TArray<FString> Properties;
+
+	/** Whether the seen counters of the flow nodes are captured. */
+	bool bSeenCounters = true;
+};
+
+/**
+ * @class FArticyStateSnapshot
+ * @brief An immutable copy of the global variables and of selected object properties, which any number of threads
+ * can read without locks, e.g. the jobs of an AI utility system scoring options on worker threads.
+ *
+ * The database and the global variables must only be used on the game thread: object lookups fill caches, the
+ * property tables are built on first access and shadow states change the values during explorations. A snapshot is
+ * captured on the game thread, outside of shadow states, and copies the values into flat arrays. Afterwards it does
+ * not reference any UObject, so it can be handed to worker threads and outlive the world.
+ *
+ * The snapshot is the state of the frame it was captured in. Capture a new one every frame the jobs run, and drop the
+ * old one once the jobs of the frame are done, see IsFromCurrentFrame.
+ */
+class ARTICYRUNTIME_API FArticyStateSnapshot
+{
+public:
+
+	/**
+	 * Captures the global variables and the requested objects of the database of a world. Game thread only.
+	 * @param WorldContext The object to get the database and its global variables from.
+	 * @param Request The objects and properties to capture.
+	 * @return The snapshot, empty if there is no database.
+	 */
+	static TSharedRef<const FArticyStateSnapshot, ESPMode::ThreadSafe> Capture(const UObject* WorldContext, const FArticyStateSnapshotRequest& Request);
+
+	/**
+	 * Captures the global variables and the requested objects. Game thread only.
+	 * @param Database The database to capture the objects of, may be null to capture the variables only.
+	 * @param GVs The global variables to capture, may be null to capture the objects only.
+	 * @param Request The objects and properties to capture.
+	 * @return The snapshot.
+	 */
+	static TSharedRef<const FArticyStateSnapshot, ESPMode::ThreadSafe> Capture(const UArticyDatabase* Database, const UArticyGlobalVariables* GVs, const FArticyStateSnapshotRequest& Request);
+
+	/** Returns the frame the snapshot was captured in. */
+	uint64 GetFrameNumber() const { return FrameNumber; }
+
+	/** Returns true if the snapshot was captured in the current frame. */
+	bool IsFromCurrentFrame() const { return FrameNumber == GFrameCounter; }
+
+	//========================================//
+
+	/** Returns the value of a variable by its full name (Namespace.Variable), undefined if there is no such variable. */
+	const ExpressoType& GetVariable(FName FullName) const;
+
+	/** Returns the number of captured variables, which are indexed like UArticyGlobalVariables::GetVariableIndex. */
+	int32 GetNumVariables() const { return VariableValues.Num(); }
+
+	/** Returns the value of a variable by its dense index, undefined if the index is invalid. */
+	const ExpressoType& GetVariableByIndex(int32 Index) const { return VariableValues.IsValidIndex(Index) ? VariableValues[Index] : Undefined; }
+
+	/** Returns the seen counter of a flow node, 0 if it was not seen or the seen counters were not captured. */
+	int32 GetSeenCounter(const FArticyId& Id) const;
+
+	//========================================//
+
+	/** Returns true if the object was captured. */
+	bool HasObject(const FArticyId& Id) const { return ObjectIndices.Contains(Id); }
+
+	/** Returns the ids of the captured objects, in the order they were captured in. */
+	const TArray<FArticyId>& GetObjects() const { return ObjectIds; }
+
+	/** Returns the index of a requested property, or INDEX_NONE if it was not requested. */
+	int32 GetPropertyIndex(const FString& Property) const { return Properties.IndexOfByKey(Property); }
+
+	/**
+	 * Returns the value of a property of an object, undefined if the object or property was not captured
+	 * or the object has no such property.
+	 * @param Id The id of the object.
+	 * @param PropertyIndex The index of the property, see GetPropertyIndex.
+	 */
+	const ExpressoType& GetProperty(const FArticyId& Id, int32 PropertyIndex) const;
+
+	/** Returns the value of a property of an object by its path, see GetProperty. */
+	const ExpressoType& GetProperty(const FArticyId& Id, const FString& Property) const { return GetProperty(Id, GetPropertyIndex(Property)); }
+
+private:
+
+	/** The frame the snapshot was captured in. */
+	uint64 FrameNumber = 0;
+
+	/** The values of the variables by their dense index, and the indices by full name. */
+	TArray<ExpressoType> VariableValues;
+	TSharedPtr<const TMap<FName, int32>, ESPMode::ThreadSafe> VariableIndices;
+
+	/** The seen counters of the flow nodes which were seen. */
+	TMap<FArticyId, int32> SeenCounters;
+
+	/** The requested properties, and the values of the captured objects, Properties.Num() per object. */
+	TArray<FString> Properties;
+	TArray<FArticyId> ObjectIds;
+	TMap<FArticyId, int32> ObjectIndices;
+	TArray<ExpressoType> PropertyValues;
+
+	/** Returned for values which were not captured. */
+	static const ExpressoType Undefined;
+};
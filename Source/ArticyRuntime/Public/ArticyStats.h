@@ -0,0 +1,37 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "Stats/Stats.h"
+
+/**
+ * The stats of the flow player, the database, the text extension and the expresso scripts, shown with "stat ArticyFlow".
+ * The cycle stats show up as CPU scopes and the counters as counters in Unreal Insights as well (-trace=cpu,stats).
+ */
+DECLARE_STATS_GROUP(TEXT("ArticyFlow"), STATGROUP_ArticyFlow, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FlowPlayer Explore"), STAT_ArticyFlowExplore, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FlowPlayer UpdateAvailableBranches"), STAT_ArticyFlowUpdateBranches, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FlowPlayer execute branch"), STAT_ArticyFlowExecuteBranch, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FlowPlayer scheduler tick"), STAT_ArticyFlowScheduler, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ShadowedOperation push"), STAT_ArticyShadowPush, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ShadowedOperation pop"), STAT_ArticyShadowPop, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Database GetObject"), STAT_ArticyGetObject, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Database CloneFrom"), STAT_ArticyCloneFrom, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Database LoadPackage"), STAT_ArticyLoadPackage, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Database LinkObjects"), STAT_ArticyLinkObjects, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TextExtension Resolve"), STAT_ArticyResolveText, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Evaluate condition"), STAT_ArticyEvaluateCondition, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Execute instruction"), STAT_ArticyExecuteInstruction, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+
+/** Counted per frame. */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Explored nodes"), STAT_ArticyExploredNodes, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Object shadow copies created"), STAT_ArticyObjectShadowCopies, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Shared feature copies created"), STAT_ArticySharedFeatureCopies, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Variable shadow states created"), STAT_ArticyVariableShadowStates, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Seen map copies"), STAT_ArticySeenMapCopies, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Seen map undo entries"), STAT_ArticySeenMapUndoEntries, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Database GetObject calls"), STAT_ArticyGetObjectCalls, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Database Get calls"), STAT_ArticyDatabaseGetCalls, STATGROUP_ArticyFlow, ARTICYRUNTIME_API);
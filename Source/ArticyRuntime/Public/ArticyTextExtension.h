@@ -11,8 +11,84 @@
 using FArticyUserMethodCallback = TFunction<FString(const TArray<FString>&)>;
 
 struct FArticyGvName;
+struct FArticyTextSource;
 class UArticyVariable;
 
+/**
+ * A text parsed into its literal segments, argument placeholders ({N}) and tokens ([Source:Format]).
+ * Texts are parsed once and cached by UArticyTextExtension, resolving them only evaluates the tokens.
+ */
+struct ARTICYRUNTIME_API FArticyTextTemplate
+{
+	struct FSegment
+	{
+		enum class EType : uint8
+		{
+			Literal,
+			Placeholder,
+			Token
+		};
+
+		EType Type = EType::Literal;
+		/** The literal text, the placeholder as written or the source name of the token. */
+		FString Text;
+		/** The number format of a token, may be empty. */
+		FString Formatting;
+		/** The argument index of a placeholder. */
+		int32 ArgIndex = INDEX_NONE;
+		/** The compiled source of a token, with the method and its arguments split up. */
+		TSharedPtr<const FArticyTextSource, ESPMode::ThreadSafe> Source;
+	};
+
+	TArray<FSegment> Segments;
+
+	/** The summed length of all literal segments. */
+	int32 LiteralLength = 0;
+
+	/** The number of placeholder segments. */
+	int32 NumPlaceholders = 0;
+
+	/** Whether a token contains a placeholder, in which case the arguments have to be substituted before parsing. */
+	bool bPlaceholderInToken = false;
+
+	/**
+	 * Parses a text into a template.
+	 * @param Source The text to parse.
+	 * @return The template of the text.
+	 */
+	static FArticyTextTemplate Parse(const FString& Source);
+
+	/**
+	 * Returns true if a text may contain tokens or placeholders, i.e. if it contains a [ or a {.
+	 * Other texts resolve to themselves, so the importer flags the texts that need resolving in the string tables
+	 * (see TokensMetaData) and localization packs, and the localizer returns the others as they are.
+	 * @param Source The text.
+	 * @return False if resolving the text would return it unchanged.
+	 */
+	static bool HasTokens(const FString& Source)
+	{
+		int32 Index;
+		return Source.FindChar(TEXT('['), Index) || Source.FindChar(TEXT('{'), Index);
+	}
+
+	/** The string table metadata column the importer sets to 1 for the texts with tokens, see HasTokens. */
+	static constexpr const TCHAR* TokensMetaData = TEXT("Tokens");
+};
+
+using FArticyTokenResolver = TFunctionRef<FString(const FArticyTextTemplate::FSegment&)>;
+
+/**
+ * Collects what a text resolve read besides global variables, which the GV read recorder collects.
+ */
+struct FArticyTextReadSet
+{
+	/** Whether any object property was read. */
+	bool bReadObjects = false;
+
+	/** Whether a user method was called, which may depend on anything. */
+	bool bCalledUserMethods = false;
+};
+
 UENUM()
 enum class EArticyObjectType : uint8
 {
@@ -46,24 +122,54 @@ public:
 		Types... Args
 	) const;
 
+	/**
+	 * Resolves a text like Resolve without arguments, but reuses the previous result while nothing it read changed.
+	 * The global variables a text reads are recorded along with their change versions, as are reads of objects.
+	 * Texts calling user methods, and resolves in shadow states or off the game thread, are not cached.
+	 * @param Outer The world context to resolve the text in.
+	 * @param Format The text to resolve.
+	 * @return The resolved text.
+	 */
+	FText ResolveCached(UObject* Outer, const FText* Format);
+
 	void AddUserMethod(const FString& MethodName, FArticyUserMethodCallback Callback);
 
 protected:
 	FString GetSource(UObject* Outer, const FString &SourceName) const;
+	FString GetSource(UObject* Outer, const FArticyTextTemplate::FSegment& Token) const;
+	FString GetSource(UObject* Outer, const FString& SourceName, const FArticyTextSource& Source) const;
 	FString FormatNumber(const FString &SourceValue, const FString &NumberFormat) const;
-	void GetGlobalVariable(UObject* Outer, const FString& SourceName, const FArticyGvName GvName, FString& OutString, bool& OutSuccess) const;
-	void GetObjectProperty(UObject* Outer, const FString& SourceName, const FString& NameOrId, const FString& PropertyName, const bool bRequestType, FString& OutString, bool& OutSuccess) const;
+	void FormatNumber(const FString& SourceValue, const FString& NumberFormat, FString& OutFormatted) const;
+	void GetGlobalVariable(UObject* Outer, const FString& SourceName, const FArticyGvName& GvName, FString& OutString, bool& OutSuccess) const;
+	void GetObjectProperty(UObject* Outer, const FString& SourceName, const FArticyTextSource& Source, FString& OutString, bool& OutSuccess) const;
 	static void GetTypeProperty(const FString& TypeName, const FString& PropertyName, FString& OutString, bool& OutSuccess);
-	FString ExecuteMethod(UObject* Outer, const FText& Method, const TArray<FString>& Args) const;
-	EArticyObjectType GetObjectType(UArticyVariable** Object) const;
+	FString ExecuteMethod(UObject* Outer, const FArticyTextSource& Source) const;
+	FString ResolveCondition(UObject* Outer, const FString& Condition, const FString& Value) const;
+	EArticyObjectType GetObjectType(const UArticyVariable* Object) const;
 	FString ResolveBoolean(UObject* Outer, const FString &SourceName, const bool Value) const;
+	FString LocalizeBoolean(UObject* Outer, const FString &SourceName, const bool Value) const;
 	FString LocalizeString(UObject* Outer, const FString &Input) const;
 	static void SplitInstance(const FString& InString, FString& OutName, FString& OutInstanceNumber);
 
-	TMap<FString, FArticyUserMethodCallback> UserMethodMap;
+	/**
+	 * Resolves a text with its cached template.
+	 * @param Source The text to resolve.
+	 * @param Args The values of the argument placeholders.
+	 * @param ResolveToken Returns the value of a token segment.
+	 * @return The resolved text.
+	 */
+	static FString ResolveTemplate(const FString& Source, const TArray<FString>& Args, FArticyTokenResolver ResolveToken);
+
+	/** The callbacks added by AddUserMethod, by name. */
+	TMap<FName, FArticyUserMethodCallback> UserMethodMap;
+
+	/** Records the reads of the current ResolveCached, if any. */
+	FArticyTextReadSet* ReadRecorder = nullptr;
+
+	friend struct FArticyTextSource;
 };
 
-template<typename ... Types>
+template<typename... Types>
 FText UArticyTextExtension::Resolve(UObject* Outer, const FText* Format, Types... Args) const
 {
 	// Do not try to process null values
@@ -72,118 +178,26 @@ FText UArticyTextExtension::Resolve(UObject* Outer, const FText* Format, Types..
 		return FText::GetEmpty();
 	}
 
-	TArray<FString> ArgumentValues = {FString::Printf(TEXT("%s"), Args)...};
-    
-	FString FormattedString = Format->ToString();
+	const TArray<FString> ArgumentValues = {FString::Printf(TEXT("%s"), Args)...};
 
-	// Regular placeholder replacement
-	for (int32 ArgIndex = 0; ArgIndex < ArgumentValues.Num(); ++ArgIndex)
+	return FText::FromString(ResolveTemplate(Format->ToString(), ArgumentValues, [&](const FArticyTextTemplate::FSegment& Token)
 	{
-		const FString Placeholder = FString::Printf(TEXT("{%d}"), ArgIndex);
-		FormattedString = FormattedString.Replace(*Placeholder, *ArgumentValues[ArgIndex]);
-	}
-
-	// Token replacement
-	while (true)
-	{
-		const int32 TokenStartIndex = FormattedString.Find(TEXT("["), ESearchCase::CaseSensitive);
-		if (TokenStartIndex == INDEX_NONE)
-			break;
-
-		const int32 TokenEndIndex = FormattedString.Find(TEXT("]"), ESearchCase::CaseSensitive, ESearchDir::FromStart, TokenStartIndex);
-		if (TokenEndIndex == INDEX_NONE)
-			break;
-
-		FString Token = FormattedString.Mid(TokenStartIndex + 1, TokenEndIndex - TokenStartIndex - 1);
-		FString FullToken = FormattedString.Mid(TokenStartIndex, TokenEndIndex - TokenStartIndex + 1);
-		FString SourceName, Formatting;
-		
-		Token.Split(TEXT(":"), &SourceName, &Formatting);
-		if (SourceName.IsEmpty())
-		{
-			SourceName = Token;
-		}
-		
-		if (!SourceName.IsEmpty())
-		{
-			// Get value from source
-			FString SourceValue = GetSource(Outer, SourceName);
-            
-			if (!Formatting.IsEmpty())
-			{
-				// Custom format the SourceValue based on the rules of C#'s custom numeric format strings
-				FString FormattedValue = FormatNumber(SourceValue, Formatting);
-				FormattedString = FormattedString.Replace(*FullToken, *FormattedValue);
-			}
-			else
-			{
-				FormattedString = FormattedString.Replace(*FullToken, *SourceValue);
-			}
-		}
-		else
-		{
-			// Remove invalid token if source name is empty
-			FormattedString = FormattedString.Replace(*FullToken, TEXT(""));
-		}
-	}
+		// Get value from source
+		const FString SourceValue = GetSource(Outer, Token);
 
-	return FText::FromString(FormattedString);
+		// Custom format the SourceValue based on the rules of C#'s custom numeric format strings
+		return Token.Formatting.IsEmpty() ? SourceValue : FormatNumber(SourceValue, Token.Formatting);
+	}));
 }
 
-template<typename ... Types>
+template<typename... Types>
 FText UArticyTextExtension::ResolveAdvance(const FText& Format, TMap<FString, TFunction<FString(Types...)>> CallbackMap, Types... Args) const
 {
-	TArray<FString> ArgumentValues = {FString::Printf(TEXT("%s"), Args)...};
-    
-	FString FormattedString = Format.ToString();
-
-	// Regular placeholder replacement
-	for (int32 ArgIndex = 0; ArgIndex < ArgumentValues.Num(); ++ArgIndex)
-	{
-		const FString Placeholder = FString::Printf(TEXT("{%d}"), ArgIndex);
-		FormattedString = FormattedString.Replace(*Placeholder, *ArgumentValues[ArgIndex]);
-	}
+	const TArray<FString> ArgumentValues = {FString::Printf(TEXT("%s"), Args)...};
 
-	// Token replacement
-	while (true)
+	return FText::FromString(ResolveTemplate(Format.ToString(), ArgumentValues, [&](const FArticyTextTemplate::FSegment& Token)
 	{
-		const int32 TokenStartIndex = FormattedString.Find(TEXT("["), ESearchCase::CaseSensitive);
-		if (TokenStartIndex == INDEX_NONE)
-			break;
-
-		const int32 TokenEndIndex = FormattedString.Find(TEXT("]"), ESearchCase::CaseSensitive, ESearchDir::FromStart, TokenStartIndex);
-		if (TokenEndIndex == INDEX_NONE)
-			break;
-
-		FString Token = FormattedString.Mid(TokenStartIndex + 1, TokenEndIndex - TokenStartIndex - 1);
-		FString FullToken = FormattedString.Mid(TokenStartIndex, TokenEndIndex - TokenStartIndex + 1);
-		FString SourceName, Formatting;
-		
-		Token.Split(TEXT(":"), &SourceName, &Formatting);
-		if (SourceName.IsEmpty())
-		{
-			SourceName = Token;
-		}
-
-		if (!SourceName.IsEmpty())
-		{
-			TFunction<FString(Types...)> Callback;
-			if (CallbackMap.Contains(SourceName))
-			{
-				Callback = CallbackMap[SourceName];
-				FString ReplacementValue = Callback(Args...);
-				FormattedString = FormattedString.Replace(*FullToken, *ReplacementValue);
-			}
-			else
-			{
-				FormattedString = FormattedString.Replace(*FullToken, TEXT(""));
-			}
-		}
-		else
-		{
-			FormattedString = FormattedString.Replace(*FullToken, TEXT(""));
-		}
-	}
-
-	return FText::FromString(FormattedString);
+		const TFunction<FString(Types...)>* Callback = CallbackMap.Find(Token.Text);
+		return Callback ? (*Callback)(Args...) : FString();
+	}));
 }
@@ -53,18 +53,32 @@ struct ARTICYRUNTIME_API FArticyType
 	GENERATED_BODY()
 
 public:
-	FArticyEnumValueInfo GetEnumValue(int Value) const;
-	FArticyEnumValueInfo GetEnumValue(const FString& ValueName) const;
+	const FArticyEnumValueInfo& GetEnumValue(int Value) const;
+	const FArticyEnumValueInfo& GetEnumValue(const FString& ValueName) const;
 	FString GetFeatureDisplayName(UObject* Outer, const FString& FeatureName) const;
 	FString GetFeatureDisplayNameLocaKey(const FString& FeatureName) const;
-	TArray<FArticyPropertyInfo> GetProperties() const;
+	const TArray<FArticyPropertyInfo>& GetProperties() const { return Properties; }
 	TArray<FArticyPropertyInfo> GetPropertiesInFeature(const FString& FeatureName) const;
-	FArticyPropertyInfo GetProperty(const FString& PropertyName) const;
+	/** Returns the property with a display name loca key, or an empty property info if there is none. */
+	const FArticyPropertyInfo& GetProperty(const FString& PropertyName) const;
+	/** Returns the property with a display name loca key, or nullptr if there is none. */
+	const FArticyPropertyInfo* FindProperty(const FString& PropertyName) const;
+	/** Returns the property with a technical name, or nullptr if there is none. */
+	const FArticyPropertyInfo* FindPropertyByTechnicalName(const FString& PropertyName) const;
 	static FString LocalizeString(UObject* Outer, const FString& Input);
 	FString GetDisplayName(UObject* WorldContext);
 
 	void MergeChild(const FArticyType& Child);
 	void MergeParent(const FArticyType& Parent);
+
+	/**
+	 * Builds the hashed lookups of the properties, once the type is complete (see UArticyTypeSystem::AddType).
+	 * The lookups are not saved, loaded types build them in PostSerialize; types without them search the properties.
+	 */
+	void BuildLookups();
+
+	/** Builds the lookups of a loaded type, e.g. the one of an object asset. */
+	void PostSerialize(const FArchive& Ar);
 	
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
 	FString CPPType;
@@ -89,4 +103,19 @@ public:
 	
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Articy")
 	FString TechnicalName;
+
+private:
+	/** The indices of the properties by display name loca key and by technical name, see BuildLookups. */
+	TMap<FString, int32> PropertiesByLocaKey;
+	TMap<FString, int32> PropertiesByTechnicalName;
+	bool bLookupsBuilt = false;
+};
+
+template<>
+struct TStructOpsTypeTraits<FArticyType> : public TStructOpsTypeTraitsBase2<FArticyType>
+{
+	enum
+	{
+		WithPostSerialize = true,
+	};
 };
@@ -16,5 +16,12 @@ class ARTICYRUNTIME_API UArticyTypeSystem : public UObject
 public:
 	static UArticyTypeSystem* Get();
 	FArticyType GetArticyType(const FString& TypeName) const;
+
+	/** Returns a type by name without copying it, or nullptr if there is none. */
+	const FArticyType* FindArticyType(const FString& TypeName) const { return Types.Find(TypeName); }
+
+	/** Adds a complete type, building its property lookups (see FArticyType::BuildLookups). */
+	void AddType(const FString& TypeName, const FArticyType& Type);
+
 	TMap<FString, FArticyType> Types;
 };
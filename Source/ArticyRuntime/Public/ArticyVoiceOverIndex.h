@@ -0,0 +1,69 @@
+//  
+// Copyright (c) 2023 articy Software GmbH & Co. KG. All rights reserved.  
+//
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Internationalization/CulturePointer.h"
+#include "UObject/SoftObjectPath.h"
+#include "ArticyVoiceOverIndex.generated.h"
+
+/** The voice over assets of one culture, by text key. */
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyVoiceOverTable
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TMap<FString, FSoftObjectPath> Paths;
+};
+
+/**
+ * The voice over assets of the imported texts, by culture and text key, written by the import.
+ *
+ * The invariant culture holds the assets of all texts, the other cultures only the ones which differ from it, so
+ * a culture switch only selects the table of the new culture (see Find) instead of resolving the assets again.
+ * A lookup is a hash lookup in the table of the current culture, then in the invariant one.
+ */
+USTRUCT()
+struct ARTICYRUNTIME_API FArticyVoiceOverIndex
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns true if no voice over assets were imported, e.g. by databases generated before they were stored. */
+	bool IsEmpty() const { return Cultures.Num() == 0; }
+
+	/**
+	 * Returns the voice over asset of a text in the current culture.
+	 * @param TextKey The key of the text, e.g. "FFr_0x01000001000010C6.Text".
+	 * @return The object path of the asset, or nullptr if the text has no indexed voice over.
+	 */
+	const FSoftObjectPath* Find(const FString& TextKey) const;
+
+	//========================================//
+
+	/** Removes all entries, before the import adds them again. */
+	void Reset() { Cultures.Reset(); }
+
+	/**
+	 * Adds the voice over asset of a text. The invariant culture has to be added first, the other cultures only
+	 * store the assets which differ from it.
+	 * @param Culture The culture, empty for the invariant one.
+	 * @param TextKey The key of the text.
+	 * @param Path The object path of the asset.
+	 */
+	void Add(const FString& Culture, const FString& TextKey, const FSoftObjectPath& Path);
+
+private:
+
+	/** The tables by culture, the invariant one by the empty string. */
+	UPROPERTY()
+	TMap<FString, FArticyVoiceOverTable> Cultures;
+
+	/** The current culture when the active table was selected, and the name of the table, see Find. */
+	mutable FCulturePtr ActiveCulture;
+	mutable FString ActiveTable;
+};
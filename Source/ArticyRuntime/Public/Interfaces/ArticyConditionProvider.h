@@ -22,6 +22,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Condition", meta=(AdvancedDisplay="GV, MethodProvider"))
 	virtual bool Evaluate(class UArticyGlobalVariables* GV = nullptr, class UObject* MethodProvider = nullptr) { return true; }
 
+	/**
+	 * Returns the expresso script of the condition, so batches of conditions can be evaluated without calling
+	 * Evaluate on each of them (see UArticyDatabase::EvaluateConditions).
+	 * @param OutHash Receives the hash of the condition fragment.
+	 * @return False if the condition is evaluated otherwise, in which case Evaluate is called.
+	 */
+	virtual bool GetConditionScript(int& OutHash) const { return false; }
+
 	/*virtual bool Execute(class UArticyGlobalVariables* GV = nullptr, class UObject* MethodProvider = nullptr)
 	{
 		//evaluate condition and return result
@@ -48,6 +48,32 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "ArticyObjectWithText")
 	virtual USoundWave* GetVOAsset(UObject* WorldContext)
+	{
+		const FSoftObjectPath Path = GetVOAssetPath(WorldContext);
+		return Path.IsNull() ? nullptr : Cast<USoundWave>(Path.TryLoad());
+	}
+
+	/**
+	 * Returns the path of the voice over asset of the text in the current culture without loading it, from the
+	 * voice over index of the database. Databases generated before the index was stored resolve the articy asset
+	 * of the text instead, see GetVOAssetObject.
+	 */
+	virtual FSoftObjectPath GetVOAssetPath(UObject* WorldContext)
+	{
+		const UArticyDatabase* Database = UArticyDatabase::Get(WorldContext);
+		if (Database && !Database->GetVoiceOverIndex().IsEmpty())
+		{
+			static const auto& PropName = FName("Text");
+			const FSoftObjectPath* Path = Database->GetVoiceOverIndex().Find(GetProperty<FText>(PropName).ToString());
+			return Path ? *Path : FSoftObjectPath();
+		}
+
+		const UArticyAsset* AssetObject = GetVOAssetObject(WorldContext);
+		return AssetObject ? AssetObject->GetAssetPath() : FSoftObjectPath();
+	}
+
+	/** Returns the articy asset of the voice over of the text without loading it, see GetVOAsset. */
+	virtual const UArticyAsset* GetVOAssetObject(UObject* WorldContext)
 	{
 		static const auto& PropName = FName("Text");
 		FText& Key = GetProperty<FText>(PropName);
@@ -61,23 +87,15 @@ public:
 			TableName = TEXT("ARTICY");
 		}
 
-		// Find the table
-		FStringTableConstPtr TablePtr = FStringTableRegistry::Get().FindStringTable(FName(TableName.GetValue()));
-		if (!TablePtr.IsValid())
-		{
-			return nullptr;
-		}
-
-		// Find the entry
-		const FStringTable* Table = TablePtr.Get();
-		FStringTableEntryConstPtr EntryPtr = Table->FindEntry(FTextKey(Key.ToString() + ".VOAsset"));
-		if (!EntryPtr.IsValid())
+		// Find the entry, in the string table or the localization pack
+		FString Entry;
+		UArticyLocalizerSystem* LocalizerSystem = UArticyLocalizerSystem::Get();
+		if (!LocalizerSystem || !LocalizerSystem->FindSourceString(TableName.GetValue(), Key.ToString() + ".VOAsset", Entry))
 		{
 			return nullptr;
 		}
 
-		const FStringTableEntry* TableEntry = EntryPtr.Get();
-		FText SourceString = FText::FromString(TableEntry->GetSourceString());
+		FText SourceString = FText::FromString(Entry);
 
 		if (!SourceString.IsEmpty() && !SourceString.EqualTo(MissingEntry))
 		{
@@ -94,12 +112,7 @@ public:
 		{
 			return nullptr;
 		}
-		const UArticyObject* AssetObject = Database->GetObject(AssetId);
-		if (!AssetObject)
-		{
-			return nullptr;
-		}
-		return (Cast<UArticyAsset>(AssetObject))->LoadAsSoundWave();
+		return Cast<UArticyAsset>(Database->GetObject(AssetId));
 	}
 
 	virtual FText ResolveText(UObject* Outer, const FText* SourceText)
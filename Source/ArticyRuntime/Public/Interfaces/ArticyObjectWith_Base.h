@@ -34,15 +34,19 @@ protected:
 	{
 		auto prop = GetPropPtr<PropType>(PropName);
 
-		if(ensure(prop))
+		if(prop)
 			return *prop;
-		else
-		{
-			UE_LOG(LogTemp, Warning, TEXT("Cannot get property %s from object %s!"),
-				   *PropName.ToString(), _getUObject() ? *_getUObject()->GetName() : TEXT("(nullptr)"));
-		}
 
+#if WITH_EDITORONLY_DATA
+		//cooked builds do not have the properties generated as editor-only (see UArticyPluginSettings::EditorOnlyProperties)
+		ensure(false);
+		UE_LOG(LogTemp, Warning, TEXT("Cannot get property %s from object %s!"),
+			   *PropName.ToString(), _getUObject() ? *_getUObject()->GetName() : TEXT("(nullptr)"));
+#endif
+
+		//reset, as the setters write into it
 		static PropType Empty;
+		Empty = PropType();
 		return Empty;
 	}
 
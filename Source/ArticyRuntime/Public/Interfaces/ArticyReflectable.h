@@ -12,6 +12,39 @@
 
 DECLARE_MULTICAST_DELEGATE_OneParam(FReportChangedDelegate, FArticyChangedProperty&);
 
+/**
+ * The reflected properties of a class, addressable by name or by a slot index.
+ * The properties of the super class come first, so a property has the same slot in all derived classes.
+ */
+struct ARTICYRUNTIME_API FArticyPropertyTable
+{
+	/** The properties, indexed by slot. */
+	TArray<FProperty*> Properties;
+
+	/** The slot of each property, by its cpp name. */
+	TMap<FName, int32> Slots;
+
+	/** Returns the slot of a property, or INDEX_NONE. */
+	int32 FindSlot(FName Name) const
+	{
+		const int32* slot = Slots.Find(Name);
+		return slot ? *slot : INDEX_NONE;
+	}
+
+	/** Returns the property with the given name, or nullptr. */
+	FProperty* Find(FName Name) const
+	{
+		const int32* slot = Slots.Find(Name);
+		return slot ? Properties[*slot] : nullptr;
+	}
+
+	/** Returns the property in a slot, or nullptr. */
+	FProperty* Get(int32 Slot) const
+	{
+		return Properties.IsValidIndex(Slot) ? Properties[Slot] : nullptr;
+	}
+};
+
 UINTERFACE()
 class UArticyReflectable : public UInterface { GENERATED_BODY() };
 
@@ -29,6 +62,10 @@ public:
 	template<typename TValue>
 	TValue SetProp(FName Property, TValue Value, int32 ArrayIndex = 0);
 
+	/** Set the property in a slot of the property table of this class, see GetPropertySlot. */
+	template<typename TValue>
+	TValue SetPropBySlot(int32 Slot, TValue Value, int32 ArrayIndex = 0);
+
 	/** Get the property with a given name. */
 	template<typename TValue>
 	TValue& GetProp(FName Property, int32 ArrayIndex = 0);
@@ -45,60 +82,96 @@ public:
 	template<typename TValue>
 	TValue* GetPropPtr(FName Property, int32 ArrayIndex = 0) const
 	{
-		//look up the (hopefully already cached) property pointers
-		auto propPointers = GetPropertyPointers();
-		auto prop = propPointers.Find(Property);
+		FProperty* prop = GetProperty(Property);
 		if(prop)
-			return (*prop)->ContainerPtrToValuePtr<TValue>(_getUObject(), ArrayIndex);
+			return prop->ContainerPtrToValuePtr<TValue>(_getUObject(), ArrayIndex);
 
 		return nullptr;
 	}
 
-	/** Returns the pointer to a property of a given name. */
-	FProperty* GetProperty(FName Property) const
+	/** Returns the pointer to the property in a slot of the property table of this class. */
+	template<typename TValue>
+	TValue* GetPropPtrBySlot(int32 Slot, int32 ArrayIndex = 0) const
 	{
-		//look up the (hopefully already cached) property pointers
-		auto propPointers = GetPropertyPointers();
-		auto prop = propPointers.Find(Property);
+		FProperty* prop = GetPropertyBySlot(Slot);
 		if(prop)
-			return *prop;
+			return prop->ContainerPtrToValuePtr<TValue>(_getUObject(), ArrayIndex);
 
 		return nullptr;
 	}
 
+	/** Returns the pointer to a property of a given name. */
+	FProperty* GetProperty(FName Property) const
+	{
+		return GetPropertyTable().Find(Property);
+	}
+
+	/** Returns the property in a slot of the property table of this class. */
+	FProperty* GetPropertyBySlot(int32 Slot) const
+	{
+		return GetPropertyTable().Get(Slot);
+	}
+
+	/** Returns the slot of a property in the property table of this class, or INDEX_NONE. */
+	int32 GetPropertySlot(FName Property) const
+	{
+		return GetPropertyTable().FindSlot(Property);
+	}
+
 	/** Returns true if the Property can be found on the given Class. */
 	static bool HasProperty(const UClass* Class, const FName &Property)
 	{
-		return GetPropertyPointers(Class).Find(Property) != nullptr;
+		return GetPropertyTable(Class).FindSlot(Property) != INDEX_NONE;
 	}
 
+	/**
+	 * Returns the (cached) property table of a class.
+	 * The returned table stays valid, and the slots of a class stay the same, for the lifetime of the module.
+	 * Safe to call from any thread.
+	 */
+	ARTICYRUNTIME_API static const FArticyPropertyTable& GetPropertyTable(const UClass* Class);
+
+	/**
+	 * Builds the property tables of all loaded classes implementing this interface,
+	 * so they don't have to be built on first access during gameplay.
+	 */
+	ARTICYRUNTIME_API static void WarmPropertyTables();
+
 	virtual UClass* GetObjectClass() const { return _getUObject()->GetClass(); }
 
+	/**
+	 * Returns the instance SetProp writes to.
+	 * Objects which are shared with their package asset are copied here on the first write.
+	 * Returns nullptr if the write is refused, e.g. off the game thread (see UArticyDatabase::GetWritableObject).
+	 */
+	virtual IArticyReflectable* GetWritableInstance() { return this; }
+
+	/**
+	 * Returns the instance reads of the scripts go to, the counterpart of GetWritableInstance.
+	 * In a shadow state, this is the shadow copy the writes of the state went to.
+	 */
+	virtual IArticyReflectable* GetReadableInstance() { return this; }
+
 	FReportChangedDelegate ReportChanged;
 
-private:
+	/** Returns true if this object, or the object owning this feature, is a shadow copy written by a shadow state of its database. */
+	ARTICYRUNTIME_API bool IsShadowCopy() const;
+
+	/** Set while UArticyObjectNotificationManager has subscriptions, so SetProp only reports writes then. */
+	ARTICYRUNTIME_API static bool bDispatchPropertyChanges;
+
 	/**
-	 * Caches and returns all UProperty pointers of this UClass.
-	 * They are cached because they can only be found by iterating over
-	 * them, using the TFieldIterator.
+	 * Reports a write of the writable instance to ReportChanged and UArticyObjectNotificationManager, and marks the
+	 * property as modified (see UArticyBaseObject::IsModified).
+	 * Writes to shadow copies are undone when their shadow state is popped, so they are not reported.
 	 */
-	TMap<FName, FProperty*>& GetPropertyPointers() const
-	{
-		return GetPropertyPointers(GetObjectClass());
-	}
+	ARTICYRUNTIME_API void NotifyPropertyChanged(const FProperty* Property, int32 Slot);
 
-	static TMap<FName, FProperty*>& GetPropertyPointers(const UClass* Class)
+private:
+	/** Returns the property table of the runtime class of this object. */
+	const FArticyPropertyTable& GetPropertyTable() const
 	{
-		static TMap<const UClass*, TMap<FName, FProperty*>> PropertyPointers;
-		auto& pp = PropertyPointers.FindOrAdd(Class);
-		if(pp.Num() == 0)
-		{
-			//cache property pointers
-			for(TFieldIterator<FProperty> It(Class); It; ++It)
-				pp.Add(*It->GetNameCPP(), *It);
-		}
-
-		return pp;
+		return GetPropertyTable(GetObjectClass());
 	}
 };
 
@@ -107,16 +180,43 @@ private:
 template <typename TValue>
 TValue IArticyReflectable::SetProp(FName Property, TValue Value, int32 ArrayIndex)
 {
+	//redirect the write if this object is shared and got copied
+	IArticyReflectable* Writable = GetWritableInstance();
+	if(!Writable)
+		return Value;
+	if(Writable != this)
+		return Writable->SetProp<TValue>(Property, Value, ArrayIndex);
+
 	TValue* valPtr = GetPropPtr<TValue>(Property, ArrayIndex);
 	if(valPtr)
 	{
-		FArticyChangedProperty ChangedProperty;
-		ChangedProperty.Property = Property;
-		ChangedProperty.SetObjectReference(this);
+		(*valPtr) = Value;
+
+		NotifyPropertyChanged(GetProperty(Property), INDEX_NONE);
+		return (*valPtr);
+	}
+
+	return Value;
+}
+
+template <typename TValue>
+TValue IArticyReflectable::SetPropBySlot(int32 Slot, TValue Value, int32 ArrayIndex)
+{
+	//redirect the write if this object is shared and got copied
+	IArticyReflectable* Writable = GetWritableInstance();
+	if(!Writable)
+		return Value;
+	if(Writable != this)
+		return Writable->SetPropBySlot<TValue>(Slot, Value, ArrayIndex);
+
+	FProperty* prop = GetPropertyBySlot(Slot);
+	if(prop)
+	{
+		TValue* valPtr = prop->ContainerPtrToValuePtr<TValue>(_getUObject(), ArrayIndex);
 
 		(*valPtr) = Value;
 
-		ReportChanged.Broadcast(ChangedProperty);
+		NotifyPropertyChanged(prop, Slot);
 		return (*valPtr);
 	}
 
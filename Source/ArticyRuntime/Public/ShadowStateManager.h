@@ -16,9 +16,9 @@ class UShadowStateManager : public UInterface
 
 /**
  * This interface can be used for all classes that need to keep track of shadow
- * states. It provides PushState and PopState methods, which push/pop on an array
- * of FOnPopState delegates, where interested objects can register themselves to
- * know when a state they were cloned in is destroyed.
+ * states. It provides PushState and PopState methods, which maintain an undo log:
+ * interested objects record an undo entry when they are modified in a shadow state,
+ * and PopState runs the entries of the popped state in reverse order.
  */
 class IShadowStateManager
 {
@@ -26,31 +26,76 @@ class IShadowStateManager
 
 	// Add interface functions to this class. This is the class that will be inherited to implement this interface.
 public:
-	
-	DECLARE_MULTICAST_DELEGATE(FOnPopState)
 
+	/**
+	 * An undo function, called when the state it was recorded in is popped.
+	 * @param Context The context pointer passed to RecordUndo.
+	 * @param Payload The payload passed to RecordUndo.
+	 * @param ShadowLevel The shadow level that is popped.
+	 */
+	typedef void (*FUndoFunction)(void* Context, int32 Payload, uint32 ShadowLevel);
+
+	/**
+	 * Records an undo entry for the current shadow state, without any allocation once the log has grown.
+	 * @param Undo The function to call when the state is popped.
+	 * @param Context The object to undo, must outlive the state.
+	 * @param Payload Additional data for the undo function.
+	 */
+	void RecordUndo(FUndoFunction Undo, void* Context, int32 Payload = 0);
+
+	/**
+	 * Registers a callable that is invoked when the current state is popped.
+	 * This allocates per call, prefer RecordUndo on hot paths.
+	 */
 	template<typename LambdaType>
-	FDelegateHandle RegisterOnPopState(LambdaType Lambda);
-	void UnregisterOnPopState(FDelegateHandle Delegate);
+	void RegisterOnPopState(LambdaType Lambda);
 
 	uint32 GetShadowLevel() const { return ShadowLevel; }
 
+protected:
+
+	/** Pops all active states, which undoes all changes made in them. */
+	void PopAllStates();
+
 private:
 
+	/** An entry of the undo log. */
+	struct FUndoEntry
+	{
+		FUndoFunction Undo;
+		void* Context;
+		int32 Payload;
+	};
+
 	/** The current shadow level of this GV instance. */
 	uint32 ShadowLevel = 0;
 
-	/** A stack of OnPopState delegates. The last one is the one for the current shadow level. */
-	TArray<FOnPopState> OnPopStateDelegates;
+	/**
+	 * The undo log of all active states. Only the first NumUndoEntries are in use,
+	 * the array is never shrunk so that deep explorations do not reallocate.
+	 */
+	TArray<FUndoEntry> UndoLog;
+	int32 NumUndoEntries = 0;
+
+	/** For each active state, the index of its first entry in the undo log. */
+	TArray<int32> StateStarts;
+
+	/** Callables registered via RegisterOnPopState, referenced by the payload of their undo entry. */
+	TArray<TFunction<void()>> PopCallbacks;
 
 	friend class UArticyFlowPlayer;
+	friend class FArticyFlowReplay;
 
 	void PushState(uint32 NewShadowLevel);
 	void PopState(uint32 CurrShadowLevel);
+
+	/** Undo function which invokes and removes a callable registered via RegisterOnPopState. */
+	static void InvokePopCallback(void* Context, int32 Payload, uint32 ShadowLevel);
 };
 
 template <typename LambdaType>
-FDelegateHandle IShadowStateManager::RegisterOnPopState(LambdaType Lambda)
+void IShadowStateManager::RegisterOnPopState(LambdaType Lambda)
 {
-	return OnPopStateDelegates.Last().AddLambda(Lambda);
+	const int32 Index = PopCallbacks.Add(TFunction<void()>(MoveTemp(Lambda)));
+	RecordUndo(&IShadowStateManager::InvokePopCallback, this, Index);
 }